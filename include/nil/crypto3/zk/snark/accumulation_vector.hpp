@@ -26,8 +26,16 @@
 #ifndef CRYPTO3_ZK_SNARK_ACCUMULATION_VECTOR_HPP
 #define CRYPTO3_ZK_SNARK_ACCUMULATION_VECTOR_HPP
 
+#include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <vector>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+#include <nil/crypto3/algebra/multiexp/policies.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
 
 #include <nil/crypto3/zk/snark/sparse_vector.hpp>
 
@@ -94,6 +102,137 @@ namespace nil {
                         return accumulation_vector<Type>(std::move(new_first), std::move(acc_result.second));
                     }
                 };
+
+                /**
+                 * A cursor accumulating the sparse part of an accumulation vector over consecutive chunks
+                 * of scalars, as they arrive, the first chunk standing for index offset.
+                 *
+                 * Unlike accumulate_chunk, absorbing a chunk does not rebuild the remainder of the
+                 * vector: the cursor only keeps the running sum and its position in the indices, so a
+                 * whole input is accumulated in a single pass. The vector is referenced, not copied, and
+                 * has to outlive the cursor.
+                 */
+                template<typename Type>
+                class accumulation_cursor {
+                    using underlying_value_type = typename Type::value_type;
+
+                    const accumulation_vector<Type> *vector;
+                    underlying_value_type accumulated_value;
+                    std::size_t first_position;
+                    std::size_t position;
+                    std::size_t start_offset;
+                    std::size_t next_offset;
+
+                public:
+                    explicit accumulation_cursor(const accumulation_vector<Type> &vector, std::size_t offset = 0) :
+                        vector(&vector), accumulated_value(vector.first),
+                        first_position(std::lower_bound(vector.rest.indices.begin(), vector.rest.indices.end(),
+                                                        offset) -
+                                       vector.rest.indices.begin()),
+                        position(first_position), start_offset(offset), next_offset(offset) {
+                    }
+
+                    /**
+                     * Absorbs the chunk [begin, end) of random access scalars, which continues right after
+                     * the previous one.
+                     */
+                    template<typename InputIterator>
+                    accumulation_cursor<Type> &accumulate(InputIterator begin, InputIterator end) {
+                        typedef typename std::iterator_traits<InputIterator>::value_type scalar_value_type;
+
+                        const std::vector<std::size_t> &indices = vector->rest.indices;
+                        const std::vector<underlying_value_type> &values = vector->rest.values;
+
+                        const std::size_t chunk_size = std::distance(begin, end);
+                        const std::size_t last_position =
+                            std::lower_bound(indices.begin() + position, indices.end(), next_offset + chunk_size) -
+                            indices.begin();
+
+                        if (position != last_position) {
+                            const std::size_t chunks = executor::current().concurrency();
+                            const std::size_t first_index = indices[position] - next_offset;
+
+                            if (indices[last_position - 1] - indices[position] == last_position - position - 1) {
+                                // the entries are consecutive: their scalars are a subrange of the chunk
+                                accumulated_value =
+                                    accumulated_value +
+                                    dispatch_multiexp<multiexp_method_auto>(
+                                        values.begin() + position, values.begin() + last_position, begin + first_index,
+                                        begin + (first_index + last_position - position), chunks);
+                            } else {
+                                std::vector<scalar_value_type> scalars(last_position - position);
+                                for (std::size_t i = position; i < last_position; ++i) {
+                                    scalars[i - position] = *(begin + (indices[i] - next_offset));
+                                }
+                                accumulated_value =
+                                    accumulated_value +
+                                    dispatch_multiexp<multiexp_method_auto>(
+                                        values.begin() + position, values.begin() + last_position, scalars.begin(),
+                                        scalars.end(), chunks);
+                            }
+                        }
+
+                        position = last_position;
+                        next_offset += chunk_size;
+                        return *this;
+                    }
+
+                    /**
+                     * The accumulated value so far, including the first element of the vector.
+                     */
+                    const underlying_value_type &value() const {
+                        return accumulated_value;
+                    }
+
+                    /**
+                     * Index which the next chunk starts at.
+                     */
+                    std::size_t offset() const {
+                        return next_offset;
+                    }
+
+                    /**
+                     * Index which the first chunk started at.
+                     */
+                    std::size_t start() const {
+                        return start_offset;
+                    }
+
+                    /**
+                     * Number of entries of the vector from offset() on, which no chunk has reached yet.
+                     */
+                    std::size_t remaining() const {
+                        return vector->rest.indices.size() - position;
+                    }
+
+                    bool is_fully_accumulated() const {
+                        return first_position == 0 && position == vector->rest.indices.size();
+                    }
+
+                    /**
+                     * The accumulation vector accumulate_chunk would have produced for the chunks absorbed
+                     * so far.
+                     */
+                    accumulation_vector<Type> result() const {
+                        const sparse_vector<Type> &rest = vector->rest;
+
+                        sparse_vector<Type> remainder;
+                        remainder.domain_size_ = rest.domain_size_;
+                        remainder.indices.reserve(rest.indices.size() - (position - first_position));
+                        remainder.values.reserve(rest.indices.size() - (position - first_position));
+                        remainder.indices.insert(remainder.indices.end(), rest.indices.begin(),
+                                                 rest.indices.begin() + first_position);
+                        remainder.indices.insert(remainder.indices.end(), rest.indices.begin() + position,
+                                                 rest.indices.end());
+                        remainder.values.insert(remainder.values.end(), rest.values.begin(),
+                                                rest.values.begin() + first_position);
+                        remainder.values.insert(remainder.values.end(), rest.values.begin() + position,
+                                                rest.values.end());
+
+                        return accumulation_vector<Type>(underlying_value_type(accumulated_value),
+                                                         std::move(remainder));
+                    }
+                };
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -22,11 +22,30 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //---------------------------------------------------------------------------//
+// @file Declaration of an incremental accumulator of an accumulation vector.
+//
+// The accumulator is initialized with an accumulation vector, such as the
+// gamma_ABC_g1 query of a verification key, and absorbs chunks of scalars one at
+// a time: each chunk is multiplied with the entries of the sparse part of the
+// vector falling into its window and added to a running group sum. The entries
+// are never copied while chunks are absorbed; the residual vector of the entries
+// which have not met a scalar yet is only built when the result is extracted.
+//
+//     accumulator_set<std::vector<scalar_value_type>, features<tag::sparse<g1_type>>> acc(
+//         accumulators::bases = vk.gamma_ABC_g1);
+//     acc(first_chunk, accumulators::offset = 0);
+//     acc(second_chunk);    // continues right after the previous chunk
+//     accumulation_vector<g1_type> result = extract::sparse<g1_type>(acc);
+//---------------------------------------------------------------------------//
 
 #ifndef CRYPTO3_ACCUMULATORS_ZK_SPARSE_HPP
 #define CRYPTO3_ACCUMULATORS_ZK_SPARSE_HPP
 
-#include <boost/container/static_vector.hpp>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <boost/assert.hpp>
 
 #include <boost/parameter/value_type.hpp>
 
@@ -35,102 +54,109 @@
 #include <boost/accumulators/framework/depends_on.hpp>
 #include <boost/accumulators/framework/parameters/sample.hpp>
 
+#include <nil/crypto3/zk/snark/accumulators/parameters/bases.hpp>
 #include <nil/crypto3/zk/snark/accumulators/parameters/offset.hpp>
 
 #include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+#include <nil/crypto3/algebra/multiexp/policies.hpp>
+
+#include <nil/crypto3/zk/snark/accumulation_vector.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
 
 namespace nil {
     namespace crypto3 {
         namespace accumulators {
             namespace detail {
+                /**
+                 * The accumulation vector passed with the bases keyword is referenced, not copied,
+                 * so it has to outlive the accumulator.
+                 */
                 template<typename T>
                 struct sparse_impl : boost::accumulators::accumulator_base {
                     typedef typename T::value_type value_type;
-                    typedef std::vector<std::size_t> indicies_type;
+                    typedef zk::snark::sparse_vector<T> sparse_vector_type;
 
-                    typedef std::pair<value_type, std::pair<indicies_type, std::vector<T>>> result_type;
+                    typedef zk::snark::accumulation_vector<T> result_type;
 
                     template<typename Args>
-                    sparse_impl(const Args &args) : in_block(false), accumulated_value(value_type::zero()) {
+                    sparse_impl(const Args &args) :
+                        bases(&args[::nil::crypto3::accumulators::bases].rest),
+                        accumulated_value(args[::nil::crypto3::accumulators::bases].first),
+                        consumed(bases->size(), false), next_offset(0) {
                     }
 
+                    /**
+                     * Absorbs the scalars of the sample range, the first of them standing for index
+                     * offset of the vector. Without an offset the chunk continues right after the
+                     * previous one.
+                     */
                     template<typename ArgumentPack>
                     inline void operator()(const ArgumentPack &args) {
-                        resolve_type(args[boost::accumulators::sample], args[::nil::crypto3::accumulators::offset]);
+                        resolve_type(args[boost::accumulators::sample],
+                                     args[::nil::crypto3::accumulators::offset | next_offset]);
                     }
 
                     inline result_type result(boost::accumulators::dont_care) const {
+                        sparse_vector_type rest;
+                        rest.domain_size_ = bases->domain_size();
+
+                        const std::size_t remaining = std::count(consumed.begin(), consumed.end(), false);
+                        rest.indices.reserve(remaining);
+                        rest.values.reserve(remaining);
+                        for (std::size_t i = 0; i < consumed.size(); ++i) {
+                            if (!consumed[i]) {
+                                rest.indices.emplace_back(bases->indices[i]);
+                                rest.values.emplace_back(bases->values[i]);
+                            }
+                        }
+
+                        return result_type(value_type(accumulated_value), std::move(rest));
                     }
 
                 protected:
                     template<typename SinglePassRange>
-                    inline result_type resolve_type(const SinglePassRange r, std::size_t offset) {
-                        const std::size_t chunks = 1;
-
-                        std::pair<indicies_type, std::vector<T>> resulting_vector;
-                        resulting_vector.domain_size_ = domain_size_;
-
-                        const std::size_t range_len = r.size();
-                        std::size_t first_pos = -1, last_pos = -1;
-                        for (std::size_t i = 0; i < indices.size(); ++i) {
-                            const bool matching_pos = (offset <= indices[i] && indices[i] < offset + range_len);
-                            bool copy_over;
-
-                            if (in_block) {
-                                if (matching_pos && last_pos == i - 1) {
-                                    // block can be extended, do it
-                                    last_pos = i;
-                                    copy_over = false;
-                                } else {
-                                    // block has ended here
-                                    in_block = false;
-                                    copy_over = true;
-
-                                    accumulated_value =
-                                        accumulated_value +
-                                        algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                            values.begin() + first_pos, values.begin() + last_pos + 1,
-                                            std::begin(r) + (indices[first_pos] - offset),
-                                            std::begin(r) + (indices[last_pos] - offset) + 1, chunks);
-                                }
-                            } else {
-                                if (matching_pos) {
-                                    // block can be started
-                                    first_pos = i;
-                                    last_pos = i;
-                                    in_block = true;
-                                    copy_over = false;
-                                } else {
-                                    copy_over = true;
-                                }
-                            }
-
-                            if (copy_over) {
-                                resulting_vector.first.emplace_back(indices[i]);
-                                resulting_vector.second.emplace_back(values[i]);
+                    inline void resolve_type(const SinglePassRange &r, std::size_t offset) {
+                        typedef typename std::iterator_traits<decltype(std::begin(r))>::value_type scalar_value_type;
+
+                        const std::size_t range_len = std::distance(std::begin(r), std::end(r));
+                        next_offset = offset + range_len;
+
+                        const std::vector<std::size_t> &indices = bases->indices;
+                        // indices are sorted, so the matching entries are one contiguous run
+                        const std::size_t first_pos =
+                            std::lower_bound(indices.begin(), indices.end(), offset) - indices.begin();
+                        const std::size_t last_pos =
+                            std::lower_bound(indices.begin() + first_pos, indices.end(), offset + range_len) -
+                            indices.begin();
+
+                        // entries met by an earlier chunk overlapping this one are not accumulated twice
+                        std::vector<value_type> values;
+                        std::vector<scalar_value_type> scalars;
+                        values.reserve(last_pos - first_pos);
+                        scalars.reserve(last_pos - first_pos);
+                        for (std::size_t i = first_pos; i < last_pos; ++i) {
+                            if (!consumed[i]) {
+                                values.emplace_back(bases->values[i]);
+                                scalars.emplace_back(*(std::begin(r) + (indices[i] - offset)));
+                                consumed[i] = true;
                             }
                         }
 
-                        if (in_block) {
+                        if (!values.empty()) {
                             accumulated_value =
-                                accumulated_value + algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                                        values.begin() + first_pos,
-                                                        values.begin() + last_pos + 1,
-                                                        std::begin(r) + (indices[first_pos] - offset),
-                                                        std::begin(r) + (indices[last_pos] - offset) + 1,
-                                                        chunks);
+                                accumulated_value + zk::snark::dispatch_multiexp<zk::snark::multiexp_method_auto>(
+                                                        values.begin(), values.end(), scalars.begin(), scalars.end(),
+                                                        zk::snark::executor::current().concurrency());
                         }
-
-                        return std::make_pair(accumulated_value, resulting_vector);
                     }
 
-                    bool in_block;
+                    const sparse_vector_type *bases;
 
                     value_type accumulated_value;
 
-                    indicies_type indices;
-                    std::vector<value_type> values;
-                    std::size_t domain_size_;
+                    std::vector<bool> consumed;
+                    std::size_t next_offset;
                 };
             }    // namespace detail
 
@@ -157,4 +183,4 @@ namespace nil {
     }            // namespace crypto3
 }    // namespace nil
 
-#endif    // CRYPTO3_ACCUMULATORS_SNARK_HPP
+#endif    // CRYPTO3_ACCUMULATORS_ZK_SPARSE_HPP
@@ -0,0 +1,164 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a packed vector of affine points.
+//
+// A point of a query vector is held in projective or Jacobian coordinates, three
+// base field elements, even though the generator already normalizes it to Z = 1
+// for mixed addition. The affine point vector stores the (X, Y) coordinates of
+// its points only, back to back in a single buffer, which takes a third less
+// memory and lets a multi-exponentiation stream its bases. The normalization is
+// done once, when the vector is built; the points are expanded again, with
+// Z = 1, window by window when they are read.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_AFFINE_POINT_VECTOR_HPP
+#define CRYPTO3_ZK_SNARK_AFFINE_POINT_VECTOR_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A vector of points of GroupType stored as their affine coordinates.
+                 *
+                 * The point at infinity has no affine coordinates and is stored as (0, 0), which
+                 * is not on any of the short Weierstrass curves y^2 = x^3 + b, b != 0, used here.
+                 */
+                template<typename GroupType>
+                class affine_point_vector {
+                    typedef typename GroupType::value_type group_value_type;
+                    typedef typename GroupType::field_type::value_type coordinate_type;
+
+                    static constexpr const std::size_t conversion_block_size = std::size_t(1) << 16;
+
+                    std::vector<coordinate_type> coordinates;
+
+                public:
+                    typedef GroupType group_type;
+                    typedef group_value_type value_type;
+
+                    affine_point_vector() = default;
+                    affine_point_vector(const affine_point_vector &other) = default;
+                    affine_point_vector(affine_point_vector &&other) = default;
+                    affine_point_vector &operator=(const affine_point_vector &other) = default;
+                    affine_point_vector &operator=(affine_point_vector &&other) = default;
+
+                    /**
+                     * Packs the points of the random access range [first, last), which are normalized
+                     * in blocks split across the current executor.
+                     */
+                    template<typename InputIterator>
+                    affine_point_vector(InputIterator first, InputIterator last) :
+                        coordinates(2 * std::distance(first, last)) {
+                        const std::size_t n = size();
+                        const std::size_t num_blocks = (n + conversion_block_size - 1) / conversion_block_size;
+
+                        executor::current().parallel_for(num_blocks, [&](const std::size_t block) {
+                            const std::size_t block_first = block * conversion_block_size;
+                            const std::size_t block_last = std::min(n, block_first + conversion_block_size);
+
+                            std::vector<group_value_type> points(first + block_first, first + block_last);
+                            algebra::batch_to_special<GroupType>(points);
+
+                            for (std::size_t i = block_first; i < block_last; ++i) {
+                                const group_value_type &point = points[i - block_first];
+                                if (point.is_zero()) {
+                                    coordinates[2 * i] = coordinate_type::zero();
+                                    coordinates[2 * i + 1] = coordinate_type::zero();
+                                } else {
+                                    coordinates[2 * i] = point.X;
+                                    coordinates[2 * i + 1] = point.Y;
+                                }
+                            }
+                        });
+                    }
+
+                    explicit affine_point_vector(const std::vector<group_value_type> &points) :
+                        affine_point_vector(points.begin(), points.end()) {
+                    }
+
+                    std::size_t size() const {
+                        return coordinates.size() / 2;
+                    }
+
+                    bool empty() const {
+                        return coordinates.empty();
+                    }
+
+                    group_value_type operator[](const std::size_t i) const {
+                        BOOST_ASSERT(i < size());
+                        const coordinate_type &X = coordinates[2 * i];
+                        const coordinate_type &Y = coordinates[2 * i + 1];
+                        if (X.is_zero() && Y.is_zero()) {
+                            return group_value_type::zero();
+                        }
+                        return group_value_type(X, Y, coordinate_type::one());
+                    }
+
+                    /**
+                     * Expands the points [first, last) into out, with Z = 1. The storage of out is
+                     * reused, so a caller walking the vector window after window allocates once.
+                     */
+                    void decode(const std::size_t first, const std::size_t last,
+                                std::vector<group_value_type> &out) const {
+                        BOOST_ASSERT(first <= last && last <= size());
+                        out.clear();
+                        out.reserve(last - first);
+                        for (std::size_t i = first; i < last; ++i) {
+                            out.emplace_back((*this)[i]);
+                        }
+                    }
+
+                    std::vector<group_value_type> to_vector() const {
+                        std::vector<group_value_type> result;
+                        decode(0, size(), result);
+                        return result;
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return coordinates.size() * GroupType::field_type::value_bits;
+                    }
+
+                    bool operator==(const affine_point_vector &other) const {
+                        return this->coordinates == other.coordinates;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_AFFINE_POINT_VECTOR_HPP
@@ -0,0 +1,77 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_ALGORITHMS_ASYNC_HPP
+#define CRYPTO3_ZK_SNARK_ALGORITHMS_ASYNC_HPP
+
+#include <future>
+#include <utility>
+
+#include <nil/crypto3/zk/snark/job_control.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /**
+                 * Generates the keys of constraint_system on a thread of its own under a job control with
+                 * the given options (see job_control.hpp). The future throws operation_cancelled if the
+                 * job was cancelled. constraint_system must outlive the future.
+                 */
+                template<typename ProofSystemType>
+                std::future<typename ProofSystemType::keypair_type>
+                    generate_async(const typename ProofSystemType::constraint_system_type &constraint_system,
+                                   job_options options = job_options()) {
+
+                    return std::async(std::launch::async, [&constraint_system, options = std::move(options)]() {
+                        return job_control::run(options,
+                                                [&]() { return ProofSystemType::generate(constraint_system); });
+                    });
+                }
+
+                /**
+                 * Proves (primary_input, auxiliary_input) for any proving key of the scheme on a thread of
+                 * its own under a job control with the given options. The future throws operation_cancelled
+                 * if the job was cancelled. pk must outlive the future.
+                 */
+                template<typename ProofSystemType, typename ProvingKey>
+                std::future<typename ProofSystemType::proof_type>
+                    prove_async(const ProvingKey &pk, typename ProofSystemType::primary_input_type primary_input,
+                                typename ProofSystemType::auxiliary_input_type auxiliary_input,
+                                job_options options = job_options()) {
+
+                    return std::async(std::launch::async, [&pk, primary_input = std::move(primary_input),
+                                                           auxiliary_input = std::move(auxiliary_input),
+                                                           options = std::move(options)]() {
+                        return job_control::run(
+                            options, [&]() { return ProofSystemType::prove(pk, primary_input, auxiliary_input); });
+                    });
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_ALGORITHMS_ASYNC_HPP
@@ -27,6 +27,9 @@
 #ifndef CRYPTO3_ZK_SNARK_ALGORITHMS_GENERATE_HPP
 #define CRYPTO3_ZK_SNARK_ALGORITHMS_GENERATE_HPP
 
+#include <string>
+#include <utility>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -38,6 +41,31 @@ namespace nil {
                     return ProofSystemType::generate(constraint_system);
                 }
 
+                /**
+                 * Generates the keys of constraint_system, storing the proving key in the file at path.
+                 */
+                template<typename ProofSystemType>
+                std::pair<typename ProofSystemType::mapped_proving_key_type,
+                          typename ProofSystemType::verification_key_type>
+                    generate(const typename ProofSystemType::constraint_system_type &constraint_system,
+                             const std::string &path) {
+
+                    return ProofSystemType::generate(constraint_system, path);
+                }
+
+                /**
+                 * Same as above, resuming the generation recorded in the checkpoint file at
+                 * checkpoint_path, if any, and recording its progress there.
+                 */
+                template<typename ProofSystemType>
+                std::pair<typename ProofSystemType::mapped_proving_key_type,
+                          typename ProofSystemType::verification_key_type>
+                    generate(const typename ProofSystemType::constraint_system_type &constraint_system,
+                             const std::string &path, const std::string &checkpoint_path) {
+
+                    return ProofSystemType::generate(constraint_system, path, checkpoint_path);
+                }
+
                 template<typename ProofSystemType>
                 typename ProofSystemType::keypair_type generate(const typename ProofSystemType::circuit_type &circuit) {
 
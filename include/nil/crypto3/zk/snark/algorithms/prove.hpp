@@ -27,6 +27,9 @@
 #ifndef CRYPTO3_ZK_SNARK_ALGORITHMS_PROVE_HPP
 #define CRYPTO3_ZK_SNARK_ALGORITHMS_PROVE_HPP
 
+#include <iterator>
+#include <vector>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -40,6 +43,101 @@ namespace nil {
                     return ProofSystemType::prove(pk, primary_input, auxiliary_input);
                 }
 
+                template<typename ProofSystemType>
+                typename ProofSystemType::proof_type
+                    prove(const typename ProofSystemType::processed_proving_key_type &ppk,
+                          const typename ProofSystemType::primary_input_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(ppk, primary_input, auxiliary_input);
+                }
+
+                template<typename ProofSystemType>
+                typename ProofSystemType::proof_type
+                    prove(const typename ProofSystemType::compact_proving_key_type &cpk,
+                          const typename ProofSystemType::primary_input_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(cpk, primary_input, auxiliary_input);
+                }
+
+                template<typename ProofSystemType>
+                typename ProofSystemType::proof_type
+                    prove(const typename ProofSystemType::bytecode_proving_key_type &bpk,
+                          const typename ProofSystemType::primary_input_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(bpk, primary_input, auxiliary_input);
+                }
+
+                template<typename ProofSystemType>
+                typename ProofSystemType::proof_type
+                    prove(const typename ProofSystemType::mapped_proving_key_type &mpk,
+                          const typename ProofSystemType::primary_input_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(mpk, primary_input, auxiliary_input);
+                }
+
+                template<typename ProofSystemType>
+                typename ProofSystemType::proof_type
+                    prove(const typename ProofSystemType::affine_proving_key_type &apk,
+                          const typename ProofSystemType::primary_input_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(apk, primary_input, auxiliary_input);
+                }
+
+                template<typename ProofSystemType>
+                typename ProofSystemType::proof_type
+                    prove(const typename ProofSystemType::sparse_proving_key_type &spk,
+                          const typename ProofSystemType::primary_input_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(spk, primary_input, auxiliary_input);
+                }
+
+                template<typename ProofSystemType>
+                typename ProofSystemType::proof_type
+                    prove(const typename ProofSystemType::lagrange_proving_key_type &lpk,
+                          const typename ProofSystemType::primary_input_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(lpk, primary_input, auxiliary_input);
+                }
+
+                /**
+                 * Same as the above for inputs viewed in place, e.g. in a network buffer, by a proof
+                 * system taking input spans; std::vector inputs take the overloads above.
+                 */
+                template<typename ProofSystemType, typename ProvingKey>
+                typename ProofSystemType::proof_type
+                    prove(const ProvingKey &pk,
+                          const typename ProofSystemType::primary_input_span_type &primary_input,
+                          const typename ProofSystemType::auxiliary_input_span_type &auxiliary_input) {
+
+                    return ProofSystemType::prove(pk, primary_input, auxiliary_input);
+                }
+
+                /**
+                 * Proves every element of [witnesses_first, witnesses_last), each an
+                 * std::pair of primary and auxiliary input, for the same (processed) proving key.
+                 */
+                template<typename ProofSystemType, typename ProvingKey, typename InputWitnessIterator>
+                std::vector<typename ProofSystemType::proof_type> prove_batch(const ProvingKey &pk,
+                                                                              InputWitnessIterator witnesses_first,
+                                                                              InputWitnessIterator witnesses_last) {
+
+                    return ProofSystemType::prove_batch(pk, witnesses_first, witnesses_last);
+                }
+
+                template<typename ProofSystemType, typename ProvingKey, typename WitnessRange>
+                std::vector<typename ProofSystemType::proof_type> prove_batch(const ProvingKey &pk,
+                                                                              const WitnessRange &witnesses) {
+
+                    return ProofSystemType::prove_batch(pk, std::begin(witnesses), std::end(witnesses));
+                }
+
                 template<typename ProofSystemType,
                          typename Hash,
                          typename InputTranscriptIncludeIterator,
@@ -54,6 +152,46 @@ namespace nil {
                     return ProofSystemType::template prove<Hash>(
                         srs, transcript_include_first, transcript_include_last, proofs_first, proofs_last);
                 }
+
+                template<typename ProofSystemType,
+                         typename Hash,
+                         typename InputTranscriptIncludeIterator,
+                         typename InputProofIterator>
+                typename ProofSystemType::aggregate_proof_type
+                    prove(const typename ProofSystemType::prepared_proving_srs_type &srs,
+                          InputTranscriptIncludeIterator transcript_include_first,
+                          InputTranscriptIncludeIterator transcript_include_last,
+                          InputProofIterator proofs_first,
+                          InputProofIterator proofs_last) {
+
+                    return ProofSystemType::template prove<Hash>(
+                        srs, transcript_include_first, transcript_include_last, proofs_first, proofs_last);
+                }
+
+                /**
+                 * Same as the above for the proofs of a batch, kept as arrays of A, B and C.
+                 */
+                template<typename ProofSystemType, typename Hash, typename InputTranscriptIncludeIterator>
+                typename ProofSystemType::aggregate_proof_type
+                    prove(const typename ProofSystemType::proving_srs_type &srs,
+                          InputTranscriptIncludeIterator transcript_include_first,
+                          InputTranscriptIncludeIterator transcript_include_last,
+                          const typename ProofSystemType::proof_batch_type &proofs) {
+
+                    return ProofSystemType::template prove<Hash>(srs, transcript_include_first,
+                                                                 transcript_include_last, proofs);
+                }
+
+                template<typename ProofSystemType, typename Hash, typename InputTranscriptIncludeIterator>
+                typename ProofSystemType::aggregate_proof_type
+                    prove(const typename ProofSystemType::prepared_proving_srs_type &srs,
+                          InputTranscriptIncludeIterator transcript_include_first,
+                          InputTranscriptIncludeIterator transcript_include_last,
+                          const typename ProofSystemType::proof_batch_type &proofs) {
+
+                    return ProofSystemType::template prove<Hash>(srs, transcript_include_first,
+                                                                 transcript_include_last, proofs);
+                }
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
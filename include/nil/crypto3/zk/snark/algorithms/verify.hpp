@@ -27,6 +27,8 @@
 #ifndef CRYPTO3_ZK_SNARK_ALGORITHMS_VERIFY_HPP
 #define CRYPTO3_ZK_SNARK_ALGORITHMS_VERIFY_HPP
 
+#include <iterator>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -47,6 +49,70 @@ namespace nil {
                     return ProofSystemType::verify(pvk, primary_input, proof);
                 }
 
+                /**
+                 * Same as the above for a primary input viewed in place, e.g. in a network buffer, by a
+                 * proof system taking input spans; a std::vector input takes the overloads above.
+                 */
+                template<typename ProofSystemType, typename VerificationKey>
+                bool verify(const VerificationKey &vk,
+                            const typename ProofSystemType::primary_input_span_type &primary_input,
+                            const typename ProofSystemType::proof_type &proof) {
+
+                    return ProofSystemType::verify(vk, primary_input, proof);
+                }
+
+                /**
+                 * Verifies proof against the verification key of digest key_digest held by registry,
+                 * see r1cs_gg_ppzksnark_verification_key_registry.
+                 */
+                template<typename ProofSystemType, typename Registry>
+                bool verify(const Registry &registry,
+                            const typename Registry::digest_type &key_digest,
+                            const typename ProofSystemType::primary_input_type &primary_input,
+                            const typename ProofSystemType::proof_type &proof) {
+
+                    return ProofSystemType::verify(registry, key_digest, primary_input, proof);
+                }
+
+                /**
+                 * Verifies every element of [proofs_first, proofs_last) against the primary input at
+                 * the same position of [primary_inputs_first, primary_inputs_last), for the same
+                 * (processed) verification key.
+                 */
+                template<typename ProofSystemType, typename VerificationKey, typename InputPrimaryInputIterator,
+                         typename InputProofIterator>
+                bool verify_batch(const VerificationKey &vk,
+                                  InputPrimaryInputIterator primary_inputs_first,
+                                  InputPrimaryInputIterator primary_inputs_last,
+                                  InputProofIterator proofs_first,
+                                  InputProofIterator proofs_last) {
+
+                    return ProofSystemType::verify_batch(vk, primary_inputs_first, primary_inputs_last, proofs_first,
+                                                         proofs_last);
+                }
+
+                template<typename ProofSystemType, typename VerificationKey, typename PrimaryInputRange,
+                         typename ProofRange>
+                bool verify_batch(const VerificationKey &vk,
+                                  const PrimaryInputRange &primary_inputs,
+                                  const ProofRange &proofs) {
+
+                    return ProofSystemType::verify_batch(vk, std::begin(primary_inputs), std::end(primary_inputs),
+                                                         std::begin(proofs), std::end(proofs));
+                }
+
+                /**
+                 * Same as the above for the proofs of a batch, kept as arrays of A, B and C.
+                 */
+                template<typename ProofSystemType, typename VerificationKey, typename InputPrimaryInputIterator>
+                bool verify_batch(const VerificationKey &vk,
+                                  InputPrimaryInputIterator primary_inputs_first,
+                                  InputPrimaryInputIterator primary_inputs_last,
+                                  const typename ProofSystemType::proof_batch_type &proofs) {
+
+                    return ProofSystemType::verify_batch(vk, primary_inputs_first, primary_inputs_last, proofs);
+                }
+
                 template<typename ProofSystemType,
                          typename DistributionType,
                          typename GeneratorType,
@@ -63,6 +129,73 @@ namespace nil {
                     return ProofSystemType::template verify<DistributionType, GeneratorType, Hash>(
                         ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first, transcript_include_last);
                 }
+
+                template<typename ProofSystemType,
+                         typename DistributionType,
+                         typename GeneratorType,
+                         typename Hash,
+                         typename InputPrimaryInputRange,
+                         typename InputIterator>
+                bool verify(const typename ProofSystemType::prepared_verification_srs_type &ip_verifier_srs,
+                            const typename ProofSystemType::verification_key_type &pvk,
+                            const InputPrimaryInputRange &public_inputs,
+                            const typename ProofSystemType::aggregate_proof_type &proof,
+                            InputIterator transcript_include_first,
+                            InputIterator transcript_include_last) {
+
+                    return ProofSystemType::template verify<DistributionType, GeneratorType, Hash>(
+                        ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                }
+
+                template<typename ProofSystemType,
+                         typename DistributionType,
+                         typename GeneratorType,
+                         typename Hash,
+                         typename VerificationSrs,
+                         typename InputPrimaryInputRange,
+                         typename InputIterator>
+                bool verify(const VerificationSrs &ip_verifier_srs,
+                            const typename ProofSystemType::verification_key_type &pvk,
+                            const InputPrimaryInputRange &public_inputs,
+                            const typename ProofSystemType::compressed_aggregate_proof_type &proof,
+                            InputIterator transcript_include_first,
+                            InputIterator transcript_include_last) {
+
+                    return ProofSystemType::template verify<DistributionType, GeneratorType, Hash>(
+                        ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                }
+
+                template<typename ProofSystemType,
+                         typename DistributionType,
+                         typename GeneratorType,
+                         typename Hash,
+                         typename InputPrimaryInputRange,
+                         typename InputIterator>
+                bool verify(const typename ProofSystemType::processed_aggregate_verification_key_type &processed_vk,
+                            const InputPrimaryInputRange &public_inputs,
+                            const typename ProofSystemType::aggregate_proof_type &proof,
+                            InputIterator transcript_include_first,
+                            InputIterator transcript_include_last) {
+
+                    return ProofSystemType::template verify<DistributionType, GeneratorType, Hash>(
+                        processed_vk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                }
+
+                template<typename ProofSystemType,
+                         typename DistributionType,
+                         typename GeneratorType,
+                         typename Hash,
+                         typename InputPrimaryInputRange,
+                         typename InputIterator>
+                bool verify(const typename ProofSystemType::processed_aggregate_verification_key_type &processed_vk,
+                            const InputPrimaryInputRange &public_inputs,
+                            const typename ProofSystemType::compressed_aggregate_proof_type &proof,
+                            InputIterator transcript_include_first,
+                            InputIterator transcript_include_last) {
+
+                    return ProofSystemType::template verify<DistributionType, GeneratorType, Hash>(
+                        processed_vk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                }
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -0,0 +1,379 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the bucket multi-exponentiation with batched affine additions.
+//
+// The bucket method adds every base into the bucket of its window digit. With the buckets
+// in projective coordinates each of these is a mixed addition. Kept in affine coordinates, a
+// bucket addition is a handful of multiplications and one inversion. Montgomery's trick
+// shares that inversion between a whole batch of additions into distinct buckets, at three
+// more multiplications each, which brings an addition well below the cost of a mixed one.
+//
+// A base whose bucket already takes part in the pending batch, or which equals the bucket
+// or its opposite, is a collision: it goes to a projective accumulator of the bucket instead,
+// so a batch never waits on itself. So do the bases not in special form. The two halves of
+// every bucket are only merged for the running sums at the end of a window.
+//
+// The method is chosen by multiexp_method_auto for calls with enough terms per chunk, see
+// multiexp_dispatch.hpp, and can be named as multiexp_method_batch_affine.
+//
+// The same trick sums a plain set of affine points, the terms of unit scalars, as a tree:
+// batch_affine_tree_sum adds them in pairs, level by level, with one inversion per level.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_BATCH_AFFINE_MULTIEXP_HPP
+#define CRYPTO3_ZK_BATCH_AFFINE_MULTIEXP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Multi-exponentiation method of the bucket method with batched affine additions.
+                 */
+                struct multiexp_method_batch_affine { };
+
+                namespace detail {
+                    /* Upper bound of the number of additions sharing an inversion. */
+                    constexpr static const std::size_t batch_affine_max_batch_size = 256;
+
+                    /**
+                     * The window of a bucket pass over num_terms terms of bits bits, which minimizes the
+                     * additions of the buckets, at about half the cost of a projective one, plus the two
+                     * projective additions per bucket of the running sums.
+                     */
+                    inline std::size_t batch_affine_window(const std::size_t num_terms, const std::size_t bits) {
+                        std::size_t best_window = 1;
+                        std::size_t best_cost = 0;
+                        for (std::size_t window = 1; window <= 16; ++window) {
+                            const std::size_t cost =
+                                ((bits + window - 1) / window) * (num_terms + (std::size_t(4) << window));
+                            if (window == 1 || cost < best_cost) {
+                                best_window = window;
+                                best_cost = cost;
+                            }
+                        }
+                        return best_window;
+                    }
+
+                    /* The window digit at bit shift of the little-endian limbs [words, words + num_words). */
+                    inline std::size_t batch_affine_digit(const std::uint64_t *words, const std::size_t num_words,
+                                                          const std::size_t shift, const std::size_t window) {
+                        const std::size_t word = shift / 64, bit = shift % 64;
+                        if (word >= num_words) {
+                            return 0;
+                        }
+                        std::uint64_t value = words[word] >> bit;
+                        if (bit + window > 64 && word + 1 < num_words) {
+                            value |= words[word + 1] << (64 - bit);
+                        }
+                        return static_cast<std::size_t>(value & ((std::uint64_t(1) << window) - 1));
+                    }
+
+                    /**
+                     * The buckets of one window: the affine halves, with the additions pending on them,
+                     * and the projective halves taking the collisions.
+                     */
+                    template<typename ValueType>
+                    class batch_affine_buckets {
+                        typedef typename std::decay<decltype(std::declval<ValueType>().X)>::type coordinate_type;
+
+                        std::vector<coordinate_type> x, y;
+                        std::vector<std::uint8_t> occupied, pending;
+                        std::vector<ValueType> projective;
+
+                        std::size_t batch_size;
+                        std::vector<std::size_t> batch_buckets;
+                        std::vector<coordinate_type> batch_x, batch_y, products;
+
+                    public:
+                        explicit batch_affine_buckets(const std::size_t num_buckets) :
+                            x(num_buckets), y(num_buckets), occupied(num_buckets), pending(num_buckets),
+                            projective(num_buckets),
+                            batch_size(std::max<std::size_t>(
+                                1, std::min(batch_affine_max_batch_size, num_buckets / 4))) {
+                            batch_buckets.reserve(batch_size);
+                            batch_x.reserve(batch_size);
+                            batch_y.reserve(batch_size);
+                            products.reserve(batch_size);
+                        }
+
+                        void clear() {
+                            std::fill(occupied.begin(), occupied.end(), 0);
+                            std::fill(projective.begin(), projective.end(), ValueType::zero());
+                        }
+
+                        /* Adds the non-zero base to bucket d. */
+                        void add(const std::size_t d, const ValueType &base) {
+                            if (!base.is_special()) {
+                                projective[d] = projective[d] + base;
+                            } else if (!occupied[d]) {
+                                x[d] = base.X;
+                                y[d] = base.Y;
+                                occupied[d] = 1;
+                            } else if (pending[d] || x[d] == base.X) {
+                                projective[d] = projective[d].mixed_add(base);
+                            } else {
+                                pending[d] = 1;
+                                batch_buckets.emplace_back(d);
+                                batch_x.emplace_back(base.X);
+                                batch_y.emplace_back(base.Y);
+                                if (batch_buckets.size() == batch_size) {
+                                    flush();
+                                }
+                            }
+                        }
+
+                        /* Runs the pending affine additions with a single inversion. */
+                        void flush() {
+                            const std::size_t n = batch_buckets.size();
+                            if (!n) {
+                                return;
+                            }
+
+                            products.clear();
+                            coordinate_type product = coordinate_type::one();
+                            for (std::size_t j = 0; j < n; ++j) {
+                                products.emplace_back(product);
+                                product = product * (batch_x[j] - x[batch_buckets[j]]);
+                            }
+
+                            coordinate_type inverse = product.inversed();
+                            for (std::size_t j = n; j-- > 0;) {
+                                const std::size_t d = batch_buckets[j];
+                                const coordinate_type denominator = batch_x[j] - x[d];
+                                const coordinate_type lambda = (batch_y[j] - y[d]) * (inverse * products[j]);
+                                inverse = inverse * denominator;
+
+                                const coordinate_type x3 = lambda.squared() - x[d] - batch_x[j];
+                                y[d] = lambda * (x[d] - x3) - y[d];
+                                x[d] = x3;
+                                pending[d] = 0;
+                            }
+
+                            batch_buckets.clear();
+                            batch_x.clear();
+                            batch_y.clear();
+                        }
+
+                        /* Bucket d, both halves merged; the pending additions must have been flushed. */
+                        ValueType get(const std::size_t d) const {
+                            if (!occupied[d]) {
+                                return projective[d];
+                            }
+                            return projective[d].mixed_add(ValueType(x[d], y[d], coordinate_type::one()));
+                        }
+                    };
+
+                    /**
+                     * rest plus the sum of the affine points (x[i], y[i]), as a tree of batched affine
+                     * additions: the points are added in pairs, all the pairs of a level sharing one
+                     * inversion, until a single one is left. A pair of points with the same x, equal
+                     * or opposite, which the affine formula cannot add, goes onto rest instead. x and
+                     * y are overwritten.
+                     */
+                    template<typename ValueType, typename CoordinateType>
+                    ValueType batch_affine_tree_sum(std::vector<CoordinateType> &x, std::vector<CoordinateType> &y,
+                                                    ValueType rest) {
+                        std::size_t n = std::min(x.size(), y.size());
+                        std::vector<CoordinateType> inverses;
+                        while (n > 1) {
+                            const std::size_t num_pairs = n / 2;
+
+                            inverses.resize(num_pairs);
+                            CoordinateType product = CoordinateType::one();
+                            for (std::size_t j = 0; j < num_pairs; ++j) {
+                                inverses[j] = product;
+                                const CoordinateType denominator = x[2 * j + 1] - x[2 * j];
+                                if (!denominator.is_zero()) {
+                                    product = product * denominator;
+                                }
+                            }
+                            CoordinateType inverse = product.inversed();
+                            for (std::size_t j = num_pairs; j-- > 0;) {
+                                const CoordinateType denominator = x[2 * j + 1] - x[2 * j];
+                                if (!denominator.is_zero()) {
+                                    inverses[j] = inverse * inverses[j];
+                                    inverse = inverse * denominator;
+                                }
+                            }
+
+                            /* the sums are written in front of the pairs not read yet */
+                            std::size_t m = 0;
+                            for (std::size_t j = 0; j < num_pairs; ++j) {
+                                const CoordinateType &x1 = x[2 * j], &y1 = y[2 * j];
+                                const CoordinateType &x2 = x[2 * j + 1], &y2 = y[2 * j + 1];
+                                if (x1 == x2) {
+                                    rest = rest.mixed_add(ValueType(x1, y1, CoordinateType::one()))
+                                               .mixed_add(ValueType(x2, y2, CoordinateType::one()));
+                                    continue;
+                                }
+                                const CoordinateType lambda = (y2 - y1) * inverses[j];
+                                const CoordinateType x3 = lambda.squared() - x1 - x2;
+                                const CoordinateType y3 = lambda * (x1 - x3) - y1;
+                                x[m] = x3;
+                                y[m] = y3;
+                                ++m;
+                            }
+                            if (n % 2) {
+                                x[m] = x[n - 1];
+                                y[m] = y[n - 1];
+                                ++m;
+                            }
+                            n = m;
+                        }
+                        if (n) {
+                            rest = rest.mixed_add(ValueType(x[0], y[0], CoordinateType::one()));
+                        }
+                        return rest;
+                    }
+
+                    /**
+                     * sum_i scalar_i * base_i over [bases_first, bases_first + (last - first)) and the
+                     * scalars given as the num_words little-endian limbs of each term, on one thread.
+                     */
+                    template<typename InputBaseIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        batch_affine_chunk_multiexp(InputBaseIterator bases_first, const std::uint64_t *words,
+                                                    const std::size_t num_terms, const std::size_t num_words,
+                                                    const std::size_t bits) {
+                        typedef typename std::iterator_traits<InputBaseIterator>::value_type value_type;
+
+                        const std::size_t window = batch_affine_window(num_terms, bits);
+                        const std::size_t num_windows = (bits + window - 1) / window;
+
+                        batch_affine_buckets<value_type> buckets(std::size_t(1) << window);
+                        value_type result = value_type::zero();
+                        for (std::size_t w = num_windows; w-- > 0;) {
+                            for (std::size_t k = 0; k < window; ++k) {
+                                result = result.doubled();
+                            }
+
+                            buckets.clear();
+                            for (std::size_t i = 0; i < num_terms; ++i) {
+                                const std::size_t digit =
+                                    batch_affine_digit(words + i * num_words, num_words, w * window, window);
+                                if (digit) {
+                                    const value_type &base = *(bases_first + i);
+                                    if (!base.is_zero()) {
+                                        buckets.add(digit, base);
+                                    }
+                                }
+                            }
+                            buckets.flush();
+
+                            // sum_d d * buckets[d] via running sums
+                            value_type running = value_type::zero();
+                            value_type window_sum = value_type::zero();
+                            for (std::size_t d = (std::size_t(1) << window) - 1; d > 0; --d) {
+                                running = running + buckets.get(d);
+                                window_sum = window_sum + running;
+                            }
+                            result = result + window_sum;
+                        }
+                        return result;
+                    }
+                }    // namespace detail
+
+                /**
+                 * sum_i scalar_i * base_i over [bases_first, bases_last) and [scalars_first, scalars_last),
+                 * split into chunks chunks run on the current executor. The windows only cover the bits
+                 * of the largest scalar of each chunk.
+                 */
+                template<typename InputBaseIterator, typename InputFieldIterator>
+                typename std::iterator_traits<InputBaseIterator>::value_type
+                    batch_affine_multiexp(InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                          InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                          const std::size_t chunks) {
+                    typedef typename std::iterator_traits<InputBaseIterator>::value_type value_type;
+                    typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+
+                    const std::size_t n =
+                        std::min<std::size_t>(std::distance(bases_first, bases_last),
+                                              std::distance(scalars_first, scalars_last));
+                    if (!n) {
+                        return value_type::zero();
+                    }
+
+                    const std::size_t num_chunks = std::max<std::size_t>(1, std::min(chunks, n));
+                    const std::size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+
+                    std::vector<value_type> partial(num_chunks, value_type::zero());
+                    executor::current().bulk(num_chunks, [&](const std::size_t chunk) {
+                        const std::size_t begin = std::min(n, chunk * chunk_size);
+                        const std::size_t end = std::min(n, begin + chunk_size);
+                        if (begin == end) {
+                            return;
+                        }
+
+                        std::vector<integral_type> values;
+                        values.reserve(end - begin);
+                        std::size_t bits = 0;
+                        for (std::size_t i = begin; i < end; ++i) {
+                            values.emplace_back((*(scalars_first + i)).data);
+                            if (!values.back().is_zero()) {
+                                bits = std::max<std::size_t>(bits, multiprecision::msb(values.back()) + 1);
+                            }
+                        }
+                        if (!bits) {
+                            return;
+                        }
+
+                        const std::size_t num_words = (bits + 63) / 64;
+                        std::vector<std::uint64_t> words(values.size() * num_words, 0);
+                        for (std::size_t i = 0; i < values.size(); ++i) {
+                            multiprecision::export_bits(values[i], words.begin() + i * num_words, 64, false);
+                        }
+                        values.clear();
+                        values.shrink_to_fit();
+
+                        partial[chunk] = detail::batch_affine_chunk_multiexp(bases_first + begin, words.data(),
+                                                                             end - begin, num_words, bits);
+                    });
+
+                    value_type result = value_type::zero();
+                    for (const value_type &p : partial) {
+                        result = result + p;
+                    }
+                    return result;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_BATCH_AFFINE_MULTIEXP_HPP
@@ -0,0 +1,167 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the affine normalization stage of the key generators.
+//
+// The multi-exponentiations of the provers add the bases of a proving key with
+// mixed additions, which need the points in special form, Z = 1. Normalizing a
+// point takes a field inversion; Montgomery's trick turns the inversions of a
+// batch of points into a single one and three multiplications per point. The
+// generators therefore do not normalize query by query: they register every query
+// of a key with a key_normalizer, G1 and G2 halves of the knowledge commitments
+// included, and run it once. The registered points of each group are then split
+// into one block per thread of the current executor, with one batch inversion for
+// each block, whatever the number and size of the queries:
+//
+//     key_normalizer<g1_type, g2_type> normalizer;
+//     normalizer.add(A_query);
+//     normalizer.add(B_query);
+//     normalizer.add(H_query);
+//     normalizer.run();
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_BATCH_NORMALIZER_HPP
+#define CRYPTO3_ZK_BATCH_NORMALIZER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * The points of GroupType to be brought to special form together. Only pointers are
+                 * kept, so the registered points must stay in place until run() is called.
+                 */
+                template<typename GroupType>
+                class batch_normalizer {
+                public:
+                    typedef GroupType group_type;
+                    typedef typename GroupType::value_type value_type;
+
+                    /* the point at infinity has no special form and is left as it is */
+                    void add(value_type &point) {
+                        if (!point.is_zero()) {
+                            points.emplace_back(&point);
+                        }
+                    }
+
+                    void add(std::vector<value_type> &v) {
+                        points.reserve(points.size() + v.size());
+                        for (value_type &point : v) {
+                            add(point);
+                        }
+                    }
+
+                    std::size_t size() const {
+                        return points.size();
+                    }
+
+                    /**
+                     * Brings the registered points to special form, in one block per thread of the current
+                     * executor, each block with a single batch inversion.
+                     */
+                    void run() {
+                        const std::size_t n = points.size();
+                        if (!n) {
+                            return;
+                        }
+
+                        const std::size_t num_blocks = std::min(n, executor::current().concurrency());
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t first = std::min(n, block * block_size);
+                            const std::size_t last = std::min(n, first + block_size);
+                            if (first == last) {
+                                return;
+                            }
+
+                            std::vector<value_type> block_points;
+                            block_points.reserve(last - first);
+                            for (std::size_t i = first; i < last; ++i) {
+                                block_points.emplace_back(*points[i]);
+                            }
+                            algebra::batch_to_special<GroupType>(block_points);
+                            for (std::size_t i = first; i < last; ++i) {
+                                *points[i] = block_points[i - first];
+                            }
+                        });
+
+                        points.clear();
+                    }
+
+                private:
+                    std::vector<value_type *> points;
+                };
+
+                /**
+                 * The normalization stage of a key over the groups G1Type and G2Type.
+                 */
+                template<typename G1Type, typename G2Type>
+                class key_normalizer {
+                    std::tuple<batch_normalizer<G1Type>, batch_normalizer<G2Type>> normalizers;
+
+                public:
+                    template<typename GroupType>
+                    batch_normalizer<GroupType> &get() {
+                        return std::get<batch_normalizer<GroupType>>(normalizers);
+                    }
+
+                    void add(std::vector<typename G1Type::value_type> &v) {
+                        get<G1Type>().add(v);
+                    }
+
+                    void add(std::vector<typename G2Type::value_type> &v) {
+                        get<G2Type>().add(v);
+                    }
+
+                    /* the two halves of every stored commitment go to the normalizers of their groups */
+                    template<typename Type1, typename Type2>
+                    void add(knowledge_commitment_vector<Type1, Type2> &v) {
+                        for (typename knowledge_commitment<Type1, Type2>::value_type &value : v.values) {
+                            get<Type1>().add(value.g);
+                            get<Type2>().add(value.h);
+                        }
+                    }
+
+                    void run() {
+                        get<G1Type>().run();
+                        get<G2Type>().run();
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_BATCH_NORMALIZER_HPP
@@ -0,0 +1,139 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the batch scalar multiplication of points by scalars of their own.
+//
+// Scaling every point of a vector by a scalar of its own, as the aggregation prover does
+// with B_i * r^i, has no common base to precompute for: the products are independent
+// variable-base multiplications. batch_scalar_mul splits them into one block per thread
+// of the current executor, and computes every product with a fixed-window method: the
+// multiples 1, ..., 2^window - 1 of the point, then one doubling per bit and one addition
+// per non-zero window digit, instead of an addition per set bit.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_BATCH_SCALAR_MUL_HPP
+#define CRYPTO3_ZK_BATCH_SCALAR_MUL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    /**
+                     * scalar * point with windows of window bits; multiples holds the 2^window - 1 multiples
+                     * of the point and is reused between calls.
+                     */
+                    template<typename GroupType, typename ScalarFieldType>
+                    typename GroupType::value_type
+                        windowed_scalar_mul(const typename GroupType::value_type &point,
+                                            const typename ScalarFieldType::value_type &scalar,
+                                            const std::size_t window,
+                                            std::vector<typename GroupType::value_type> &multiples) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+                        typedef typename GroupType::value_type group_value_type;
+
+                        if (scalar.is_zero() || point.is_zero()) {
+                            return group_value_type::zero();
+                        }
+
+                        const std::size_t num_multiples = (std::size_t(1) << window) - 1;
+                        multiples.resize(num_multiples);
+                        multiples[0] = point;
+                        for (std::size_t d = 1; d < num_multiples; ++d) {
+                            multiples[d] = multiples[d - 1] + point;
+                        }
+
+                        const integral_type value(scalar.data);
+                        const std::size_t digits = (ScalarFieldType::value_bits + window - 1) / window;
+                        group_value_type result = group_value_type::zero();
+                        for (std::size_t j = digits; j-- > 0;) {
+                            for (std::size_t k = 0; k < window; ++k) {
+                                result = result.doubled();
+                            }
+
+                            std::size_t digit = 0;
+                            for (std::size_t k = 0; k < window; ++k) {
+                                if (multiprecision::bit_test(value, j * window + k)) {
+                                    digit |= std::size_t(1) << k;
+                                }
+                            }
+                            if (digit) {
+                                result = result + multiples[digit - 1];
+                            }
+                        }
+
+                        return result;
+                    }
+                }    // namespace detail
+
+                /**
+                 * Returns the products *(points_first + i) * *(scalars_first + i) for the points in
+                 * [points_first, points_last), computed in blocks on the current executor.
+                 */
+                template<typename GroupType, typename ScalarFieldType, typename InputPointIterator,
+                         typename InputFieldIterator>
+                std::vector<typename GroupType::value_type> batch_scalar_mul(InputPointIterator points_first,
+                                                                             InputPointIterator points_last,
+                                                                             InputFieldIterator scalars_first,
+                                                                             const std::size_t window = 4) {
+                    BOOST_ASSERT(window > 0);
+
+                    const std::size_t n = std::distance(points_first, points_last);
+                    std::vector<typename GroupType::value_type> result(n);
+                    if (!n) {
+                        return result;
+                    }
+
+                    const std::size_t num_blocks = std::min(n, executor::current().concurrency());
+                    const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                    executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                        const std::size_t first = std::min(n, block * block_size);
+                        const std::size_t last = std::min(n, first + block_size);
+
+                        std::vector<typename GroupType::value_type> multiples;
+                        for (std::size_t i = first; i < last; ++i) {
+                            result[i] = detail::windowed_scalar_mul<GroupType, ScalarFieldType>(
+                                *(points_first + i), *(scalars_first + i), window, multiples);
+                        }
+                    });
+
+                    return result;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_BATCH_SCALAR_MUL_HPP
@@ -0,0 +1,114 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the randomized batch check of prime order subgroup membership.
+//
+// Checking that a point P lies in the subgroup of prime order q takes one full
+// scalar multiplication q * P, which is costly on G2 and adds up over many incoming
+// proofs. The batch check draws random subsets of the points instead and checks
+// q * (sum of the subset) = 0 for every subset. A point with a component outside the
+// subgroup makes a subset sum leave the subgroup for at least one of the two choices
+// of its own selection bit, so it passes a round with probability at most 1/2, and
+// all the rounds with probability at most 2^-rounds, whatever the cofactor. A round
+// costs n / 2 additions on average and a single scalar multiplication; the rounds
+// run on the threads of the current executor. The subsets must not be known to whoever
+// chose the points, so they are drawn from the entropy of the system by default.
+//
+// The check assumes the points lie on the curve, see is_well_formed().
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_BATCH_SUBGROUP_CHECK_HPP
+#define CRYPTO3_ZK_BATCH_SUBGROUP_CHECK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /* the rounds of batch_subgroup_check, bounding the probability of a false pass by 2^-64 */
+                constexpr const std::size_t default_subgroup_check_rounds = 64;
+
+                /**
+                 * Whether every point of [first, last) lies in the subgroup of order the modulus of
+                 * ScalarFieldType, with a false pass probability of at most 2^-rounds. The subsets
+                 * are selected by the low bits of random elements drawn with GeneratorType through
+                 * DistributionType, the higher ones being slightly biased.
+                 */
+                template<typename GroupType, typename ScalarFieldType,
+                         typename DistributionType =
+                             boost::random::uniform_int_distribution<typename ScalarFieldType::modulus_type>,
+                         typename GeneratorType = random_device_generator, typename InputIterator>
+                bool batch_subgroup_check(InputIterator first, InputIterator last,
+                                          const std::size_t rounds = default_subgroup_check_rounds) {
+                    typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+                    typedef typename GroupType::value_type group_value_type;
+
+                    const std::size_t n = std::distance(first, last);
+                    if (!n) {
+                        return true;
+                    }
+
+                    // selection bit i of round r is bit (r * n + i) of the selectors
+                    const std::size_t bits_per_selector = 128;
+                    std::vector<integral_type> selectors((rounds * n + bits_per_selector - 1) / bits_per_selector);
+                    for (integral_type &selector : selectors) {
+                        selector = integral_type(
+                            algebra::random_element<ScalarFieldType, DistributionType, GeneratorType>().data);
+                    }
+
+                    std::vector<char> passed(rounds, 0);
+                    executor::current().bulk(rounds, [&](const std::size_t round) {
+                        group_value_type sum = group_value_type::zero();
+                        InputIterator it = first;
+                        for (std::size_t i = 0; i < n; ++i, ++it) {
+                            const std::size_t bit = round * n + i;
+                            if (multiprecision::bit_test(selectors[bit / bits_per_selector], bit % bits_per_selector)) {
+                                sum = sum + *it;
+                            }
+                        }
+                        passed[round] =
+                            (sum * typename ScalarFieldType::modulus_type(ScalarFieldType::modulus)).is_zero();
+                    });
+
+                    return std::all_of(passed.begin(), passed.end(), [](const char p) { return p != 0; });
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_BATCH_SUBGROUP_CHECK_HPP
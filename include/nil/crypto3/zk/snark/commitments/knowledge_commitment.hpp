@@ -26,6 +26,8 @@
 #ifndef CRYPTO3_ZK_KNOWLEDGE_COMMITMENT_HPP
 #define CRYPTO3_ZK_KNOWLEDGE_COMMITMENT_HPP
 
+#include <vector>
+
 #include <nil/crypto3/zk/snark/commitments/detail/element_knowledge_commitment.hpp>
 
 #include <nil/crypto3/zk/snark/sparse_vector.hpp>
@@ -62,6 +64,73 @@ namespace nil {
                 template<typename Type1, typename Type2>
                 using knowledge_commitment_vector = sparse_vector<knowledge_commitment<Type1, Type2>>;
 
+                /**
+                 * A knowledge commitment vector laid out as a structure of arrays: the g and h halves
+                 * of its values are held in two contiguous arrays sharing a single index array, so a
+                 * multi-exponentiation over one half does not read the other.
+                 */
+                template<typename Type1, typename Type2>
+                struct split_knowledge_commitment_vector {
+                    std::vector<std::size_t> indices;
+                    std::vector<typename Type1::value_type> g_values;
+                    std::vector<typename Type2::value_type> h_values;
+                    std::size_t domain_size_ = 0;
+
+                    split_knowledge_commitment_vector() = default;
+                    split_knowledge_commitment_vector(const split_knowledge_commitment_vector &other) = default;
+                    split_knowledge_commitment_vector(split_knowledge_commitment_vector &&other) = default;
+                    split_knowledge_commitment_vector &
+                        operator=(const split_knowledge_commitment_vector &other) = default;
+                    split_knowledge_commitment_vector &operator=(split_knowledge_commitment_vector &&other) = default;
+
+                    explicit split_knowledge_commitment_vector(
+                        const knowledge_commitment_vector<Type1, Type2> &other) :
+                        indices(other.indices), domain_size_(other.domain_size_) {
+                        g_values.reserve(other.values.size());
+                        h_values.reserve(other.values.size());
+                        for (const auto &value : other.values) {
+                            g_values.emplace_back(value.g);
+                            h_values.emplace_back(value.h);
+                        }
+                    }
+
+                    /**
+                     * Interleaves the two halves back into a knowledge commitment vector.
+                     */
+                    knowledge_commitment_vector<Type1, Type2> to_knowledge_commitment_vector() const {
+                        knowledge_commitment_vector<Type1, Type2> result;
+                        result.indices = indices;
+                        result.domain_size_ = domain_size_;
+                        result.values.reserve(size());
+                        for (std::size_t i = 0; i < size(); ++i) {
+                            result.values.emplace_back(g_values[i], h_values[i]);
+                        }
+                        return result;
+                    }
+
+                    std::size_t size() const {
+                        return indices.size();
+                    }
+
+                    std::size_t domain_size() const {
+                        return domain_size_;
+                    }
+
+                    bool empty() const {
+                        return indices.empty();
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return indices.size() *
+                               (sizeof(std::size_t) * 8 + knowledge_commitment<Type1, Type2>::value_bits);
+                    }
+
+                    bool operator==(const split_knowledge_commitment_vector &other) const {
+                        return this->domain_size_ == other.domain_size_ && this->indices == other.indices &&
+                               this->g_values == other.g_values && this->h_values == other.h_values;
+                    }
+                };
+
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
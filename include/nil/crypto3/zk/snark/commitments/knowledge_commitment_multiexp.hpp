@@ -35,9 +35,22 @@
   Will probably go away in more general exp refactoring.
 */
 
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <nil/crypto3/algebra/multiexp/multiexp.hpp>
 
+#include <nil/crypto3/zk/snark/batch_affine_multiexp.hpp>
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/prefetch.hpp>
+#include <nil/crypto3/zk/snark/scalar_size_multiexp.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -54,6 +67,123 @@ namespace nil {
                         opt_window_wnaf_exp(base.h, scalar, scalar_bits));
                 }
 
+                namespace detail {
+
+                    /*
+                     * Sum of the affine parts of the values at [positions_first, positions_last), the
+                     * others added onto rest, as a tree of batched affine additions.
+                     */
+                    template<typename ValueType, typename Values, typename Part>
+                    ValueType kc_sum_part(const Values &values, const std::size_t *positions_first,
+                                          const std::size_t *positions_last, Part part) {
+                        typedef typename std::decay<decltype(std::declval<ValueType>().X)>::type coordinate_type;
+
+                        ValueType rest = ValueType::zero();
+                        std::vector<coordinate_type> x, y;
+                        x.reserve(positions_last - positions_first);
+                        y.reserve(positions_last - positions_first);
+                        prefetched_gather(positions_first, positions_last, values.begin(), 0,
+                                          [&](std::size_t, const typename Values::value_type &value) {
+                                              const ValueType &point = part(value);
+                                              if (point.is_zero()) {
+                                                  return;
+                                              }
+                                              if (!point.is_special()) {
+                                                  rest = rest + point;
+                                                  return;
+                                              }
+                                              x.emplace_back(point.X);
+                                              y.emplace_back(point.Y);
+                                          });
+                        return batch_affine_tree_sum(x, y, rest);
+                    }
+
+                    /*
+                     * Sum of the parts of the values at positions, split into one block per chunk, each
+                     * summing its terms as a tree of batched affine additions, see
+                     * batch_affine_multiexp.hpp; the block sums are added at the end.
+                     */
+                    template<typename ValueType, typename Values, typename Part>
+                    ValueType kc_sum_terms(const Values &values, const std::vector<std::size_t> &positions,
+                                           const std::size_t chunks, Part part) {
+                        const std::size_t num_blocks =
+                            std::max<std::size_t>(1, std::min(positions.size(), chunks));
+                        const std::size_t block_size = (positions.size() + num_blocks - 1) / num_blocks;
+
+                        std::vector<ValueType> partial_sums(num_blocks, ValueType::zero());
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            partial_sums[block] = kc_sum_part<ValueType>(
+                                values, positions.data() + std::min(positions.size(), block * block_size),
+                                positions.data() + std::min(positions.size(), (block + 1) * block_size), part);
+                        });
+
+                        ValueType result = ValueType::zero();
+                        for (const ValueType &partial_sum : partial_sums) {
+                            result = result + partial_sum;
+                        }
+                        return result;
+                    }
+
+                    /* Sum of the values at positions, the terms of a multi-exponentiation with a unit scalar. */
+                    template<typename T1, typename T2>
+                    typename knowledge_commitment<T1, T2>::value_type
+                        kc_sum_unit_terms(const std::vector<typename knowledge_commitment<T1, T2>::value_type> &values,
+                                          const std::vector<std::size_t> &positions, const std::size_t chunks) {
+                        typedef typename knowledge_commitment<T1, T2>::value_type value_type;
+                        return value_type(
+                            kc_sum_terms<typename T1::value_type>(
+                                values, positions, chunks,
+                                [](const value_type &value) -> const typename T1::value_type & { return value.g; }),
+                            kc_sum_terms<typename T2::value_type>(
+                                values, positions, chunks,
+                                [](const value_type &value) -> const typename T2::value_type & { return value.h; }));
+                    }
+
+                    /*
+                     * Gathers the scalars of the stored indices [first, last) of vec, those equal to one
+                     * being replaced by zero and their positions appended to unit_positions. Returns the
+                     * number of zero scalars that were gathered as they are.
+                     */
+                    template<typename KCVector, typename InputFieldIterator, typename FieldValueType>
+                    std::size_t kc_gather_scalars(const KCVector &vec, const std::size_t first, const std::size_t last,
+                                                  const std::size_t min_idx, InputFieldIterator scalar_start,
+                                                  const std::size_t scalar_length, std::vector<FieldValueType> &scalars,
+                                                  std::vector<std::size_t> &unit_positions) {
+                        const FieldValueType zero = FieldValueType::zero();
+                        const FieldValueType one = FieldValueType::one();
+
+                        scalars.reserve(last - first);
+                        std::size_t num_zero = 0;
+                        prefetched_gather(vec.indices.begin() + first, vec.indices.begin() + last, scalar_start,
+                                          min_idx, [&](const std::size_t k, const FieldValueType &scalar) {
+                                              assert(vec.indices[first + k] - min_idx < scalar_length);
+                                              if (scalar == one) {
+                                                  unit_positions.emplace_back(first + k);
+                                                  scalars.emplace_back(zero);
+                                              } else {
+                                                  num_zero += scalar.is_zero() ? 1 : 0;
+                                                  scalars.emplace_back(scalar);
+                                              }
+                                          });
+                        return num_zero;
+                    }
+                }    // namespace detail
+
+                /* terms of which at most one in kc_max_skipped_share may have a zero or unit scalar for
+                   the multi-exponentiation to run over the stored values in place */
+                constexpr static const std::size_t kc_max_skipped_share = 4;
+
+                /**
+                 * Multi-exponentiation over the terms of vec with indices in [min_idx, max_idx).
+                 *
+                 * The scalars of the stored indices are gathered. The terms of a zero scalar are dropped
+                 * and those of a unit scalar are summed on their own, as trees of batched affine additions.
+                 * If these are few, the stored values are fed to the multi-exponentiation in place, with
+                 * the scalars of the dropped and summed terms set to zero; otherwise the other terms are
+                 * copied out, as many terms being dropped makes that cheaper than running over them. The
+                 * scalars of at most 64 bits are evaluated over the windows of their width, see
+                 * scalar_size_multiexp.hpp. The gathers are prefetched, see prefetch.hpp.
+                 */
                 template<typename MultiexpMethod, typename T1, typename T2, typename InputFieldIterator>
                 typename knowledge_commitment<T1, T2>::value_type
                     kc_multiexp_with_mixed_addition(const knowledge_commitment_vector<T1, T2> &vec,
@@ -61,83 +191,187 @@ namespace nil {
                                                     InputFieldIterator scalar_start, InputFieldIterator scalar_end,
                                                     const std::size_t chunks) {
                     typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
-                    typedef typename std::iterator_traits<InputFieldIterator>::value_type::field_type field_type;
+                    typedef typename knowledge_commitment<T1, T2>::value_type value_type;
 
                     const size_t scalar_length = std::distance(scalar_start, scalar_end);
                     assert((size_t)(scalar_length) <= vec.domain_size_);
 
-                    auto index_it = std::lower_bound(vec.indices.begin(), vec.indices.end(), min_idx);
-                    const std::size_t offset = index_it - vec.indices.begin();
+                    const std::size_t first =
+                        std::lower_bound(vec.indices.begin(), vec.indices.end(), min_idx) - vec.indices.begin();
+                    const std::size_t last =
+                        std::lower_bound(vec.indices.begin() + first, vec.indices.end(), max_idx) -
+                        vec.indices.begin();
+
+                    std::vector<field_value_type> scalars;
+                    std::vector<std::size_t> unit_positions;
+                    const std::size_t num_zero = detail::kc_gather_scalars(vec, first, last, min_idx, scalar_start,
+                                                                           scalar_length, scalars, unit_positions);
+
+                    const value_type unit_sum = detail::kc_sum_unit_terms<T1, T2>(vec.values, unit_positions, chunks);
+                    const std::size_t num_skipped = num_zero + unit_positions.size();
+                    std::vector<std::size_t>().swap(unit_positions);
+
+                    const auto multiexp = [&](auto bases_first, auto bases_last, auto scalars_first,
+                                              auto scalars_last) {
+                        return scalar_size_multiexp(bases_first, scalars_first, scalars_last,
+                                                    scalar_size_partition::classify(scalars_first, scalars_last),
+                                                    chunks, [&](auto wide_first, auto wide_last) {
+                                                        return dispatch_multiexp<MultiexpMethod>(
+                                                            bases_first, bases_last, wide_first, wide_last, chunks);
+                                                    });
+                    };
+
+                    if (num_skipped * kc_max_skipped_share <= scalars.size()) {
+                        return unit_sum + multiexp(vec.values.begin() + first, vec.values.begin() + last,
+                                                   scalars.cbegin(), scalars.cend());
+                    }
 
-                    auto value_it = vec.values.begin() + offset;
+                    /* the scalars are compacted in place, the bases of their terms copied out */
+                    std::vector<value_type> bases;
+                    bases.reserve(scalars.size() - num_skipped);
+                    std::size_t num_terms = 0;
+                    for (std::size_t k = 0; k < scalars.size(); ++k) {
+                        if (!scalars[k].is_zero()) {
+                            bases.emplace_back(vec.values[first + k]);
+                            scalars[num_terms++] = scalars[k];
+                        }
+                    }
+                    scalars.resize(num_terms);
+                    return unit_sum + multiexp(bases.cbegin(), bases.cend(), scalars.cbegin(), scalars.cend());
+                }
 
-                    const field_value_type zero = field_value_type::zero();
-                    const field_value_type one = field_value_type::one();
+                /**
+                 * Multi-exponentiation over the terms of vec with indices in [min_idx, max_idx), of a
+                 * vector split into its two halves.
+                 *
+                 * The scalars of the stored indices are gathered once, the terms of zero and unit scalars
+                 * being dropped and summed on their own as in the overload above; the T1 and T2 halves
+                 * are then two independent multi-exponentiations over contiguous bases, run concurrently
+                 * on the current executor, with the threads split after the relative cost of the groups.
+                 */
+                template<typename MultiexpMethod, typename T1, typename T2, typename InputFieldIterator>
+                typename knowledge_commitment<T1, T2>::value_type
+                    kc_multiexp_with_mixed_addition(const split_knowledge_commitment_vector<T1, T2> &vec,
+                                                    const std::size_t min_idx, const std::size_t max_idx,
+                                                    InputFieldIterator scalar_start, InputFieldIterator scalar_end,
+                                                    const std::size_t chunks) {
+                    typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
 
-                    std::vector<field_value_type> p;
-                    std::vector<typename knowledge_commitment<T1, T2>::value_type> g;
+                    const size_t scalar_length = std::distance(scalar_start, scalar_end);
+                    assert((size_t)(scalar_length) <= vec.domain_size_);
 
-                    typename knowledge_commitment<T1, T2>::value_type acc =
-                        knowledge_commitment<T1, T2>::value_type::zero();
+                    const std::size_t first =
+                        std::lower_bound(vec.indices.begin(), vec.indices.end(), min_idx) - vec.indices.begin();
+                    const std::size_t last =
+                        std::lower_bound(vec.indices.begin() + first, vec.indices.end(), max_idx) -
+                        vec.indices.begin();
+
+                    std::vector<field_value_type> scalars;
+                    std::vector<std::size_t> unit_positions;
+                    const std::size_t num_zero = detail::kc_gather_scalars(vec, first, last, min_idx, scalar_start,
+                                                                           scalar_length, scalars, unit_positions);
+
+                    /* with many terms dropped, the scalars are compacted and the bases of each half gathered */
+                    const bool in_place = (num_zero + unit_positions.size()) * kc_max_skipped_share <= scalars.size();
+                    std::vector<std::size_t> term_positions;
+                    if (!in_place) {
+                        term_positions.reserve(scalars.size() - num_zero - unit_positions.size());
+                        for (std::size_t k = 0; k < scalars.size(); ++k) {
+                            if (!scalars[k].is_zero()) {
+                                scalars[term_positions.size()] = scalars[k];
+                                term_positions.emplace_back(first + k);
+                            }
+                        }
+                        scalars.resize(term_positions.size());
+                    }
 
-                    while (index_it != vec.indices.end() && *index_it < max_idx) {
-                        const std::size_t scalar_position = (*index_it) - min_idx;
-                        assert(scalar_position < scalar_length);
-
-                        const field_value_type scalar = *(scalar_start + scalar_position);
-
-                        if (scalar == zero) {
-                            // do nothing
-                        } else if (scalar == one) {
-#ifdef USE_MIXED_ADDITION
-                            acc.g = acc.g.mixed_add(value_it->g);
-                            acc.h = acc.h.mixed_add(value_it->h);
-#else
-                            acc.g = acc.g + value_it->g;
-                            acc.h = acc.h + value_it->h;
-#endif
-                        } else {
-                            p.emplace_back(scalar);
-                            g.emplace_back(*value_it);
+                    const auto half_multiexp = [&](const auto &values, const std::size_t half_chunks) {
+                        const auto unit_sum = detail::kc_sum_terms<typename std::decay<decltype(values[0])>::type>(
+                            values, unit_positions, half_chunks, [](const auto &value) -> const auto & {
+                                return value;
+                            });
+                        if (in_place) {
+                            return unit_sum + dispatch_multiexp<MultiexpMethod>(values.begin() + first,
+                                                                                values.begin() + last,
+                                                                                scalars.begin(), scalars.end(),
+                                                                                half_chunks);
                         }
+                        std::vector<typename std::decay<decltype(values[0])>::type> bases;
+                        bases.reserve(term_positions.size());
+                        for (const std::size_t position : term_positions) {
+                            bases.emplace_back(values[position]);
+                        }
+                        return unit_sum + dispatch_multiexp<MultiexpMethod>(bases.begin(), bases.end(),
+                                                                            scalars.begin(), scalars.end(),
+                                                                            half_chunks);
+                    };
 
-                        ++index_it;
-                        ++value_it;
-                    }
+                    // an addition in T1 (G2) costs about three in T2 (G1)
+                    const std::size_t g_chunks = std::max<std::size_t>(1, chunks * 3 / 4);
+                    const std::size_t h_chunks = std::max<std::size_t>(1, chunks - g_chunks);
+
+                    typename knowledge_commitment<T1, T2>::value_type result =
+                        knowledge_commitment<T1, T2>::value_type::zero();
+                    executor::current().bulk(2, [&](const std::size_t half) {
+                        if (half == 0) {
+                            result.g = half_multiexp(vec.g_values, g_chunks);
+                        } else {
+                            result.h = half_multiexp(vec.h_values, h_chunks);
+                        }
+                    });
 
-                    return acc + algebra::multiexp<MultiexpMethod>(g.begin(), g.end(), p.begin(), p.end(), chunks);
+                    return result;
                 }
 
-                template<typename T1, typename T2, typename FieldType>
-                knowledge_commitment_vector<T1, T2>
-                    kc_batch_exp_internal(const std::size_t scalar_size,
-                                          const std::size_t T1_window,
-                                          const std::size_t T2_window,
-                                          const algebra::window_table<T1> &T1_table,
-                                          const algebra::window_table<T2> &T2_table,
-                                          const typename FieldType::value_type &T1_coeff,
-                                          const typename FieldType::value_type &T2_coeff,
-                                          const std::vector<typename FieldType::value_type> &v,
-                                          const std::size_t start_pos,
-                                          const std::size_t end_pos,
-                                          const std::size_t expected_size) {
-                    knowledge_commitment_vector<T1, T2> res;
+                /* scalars exponentiated with one window table before switching to the other */
+                constexpr static const std::size_t kc_batch_exp_tile_size = 64;
 
-                    res.values.reserve(expected_size);
-                    res.indices.reserve(expected_size);
+                /**
+                 * Writes the knowledge commitments of the count non-zero entries of v from start_pos on
+                 * to values, and their positions to indices. The T1 and T2 exponentiations of a tile
+                 * of kc_batch_exp_tile_size entries run one after the other, so each window table
+                 * stays in cache across the tile.
+                 */
+                template<typename T1, typename T2, typename FieldType>
+                void kc_batch_exp_internal(const std::size_t scalar_size,
+                                           const std::size_t T1_window,
+                                           const std::size_t T2_window,
+                                           const algebra::window_table<T1> &T1_table,
+                                           const algebra::window_table<T2> &T2_table,
+                                           const typename FieldType::value_type &T1_coeff,
+                                           const typename FieldType::value_type &T2_coeff,
+                                           const std::vector<typename FieldType::value_type> &v,
+                                           const std::size_t start_pos,
+                                           const std::size_t count,
+                                           typename knowledge_commitment<T1, T2>::value_type *values,
+                                           std::size_t *indices) {
+                    std::size_t pos = start_pos;
+                    for (std::size_t tile = 0; tile < count; tile += kc_batch_exp_tile_size) {
+                        const std::size_t tile_end = std::min(count, tile + kc_batch_exp_tile_size);
+                        for (std::size_t k = tile; k < tile_end; ++k, ++pos) {
+                            while (v[pos].is_zero()) {
+                                ++pos;
+                            }
+                            indices[k] = pos;
+                        }
 
-                    for (std::size_t pos = start_pos; pos != end_pos; ++pos) {
-                        if (!v[pos].is_zero()) {
-                            res.values.emplace_back(typename knowledge_commitment<T1, T2>::value_type(
-                                algebra::windowed_exp<T1, FieldType>(scalar_size, T1_window, T1_table, T1_coeff * v[pos]),
-                                algebra::windowed_exp<T2, FieldType>(scalar_size, T2_window, T2_table, T2_coeff * v[pos])));
-                            res.indices.emplace_back(pos);
+                        for (std::size_t k = tile; k < tile_end; ++k) {
+                            values[k].g = algebra::windowed_exp<T1, FieldType>(scalar_size, T1_window, T1_table,
+                                                                               T1_coeff * v[indices[k]]);
+                        }
+                        for (std::size_t k = tile; k < tile_end; ++k) {
+                            values[k].h = algebra::windowed_exp<T2, FieldType>(scalar_size, T2_window, T2_table,
+                                                                               T2_coeff * v[indices[k]]);
                         }
                     }
-
-                    return res;
                 }
 
+                /**
+                 * The knowledge commitments of the non-zero entries of v, in two passes: the non-zero
+                 * entries of fixed blocks of v are counted in parallel, then every chunk of an equal
+                 * number of them is written straight to its place in the result, which is allocated
+                 * once.
+                 */
                 template<typename T1, typename T2, typename FieldType>
                 knowledge_commitment_vector<T1, T2> kc_batch_exp(const std::size_t scalar_size,
                                                                  const std::size_t T1_window,
@@ -151,57 +385,65 @@ namespace nil {
                     knowledge_commitment_vector<T1, T2> res;
                     res.domain_size_ = v.size();
 
-                    std::size_t nonzero = 0;
-                    for (std::size_t i = 0; i < v.size(); ++i) {
-                        nonzero += (v[i].is_zero() ? 0 : 1);
-                    }
-
-                    const std::size_t num_chunks = std::max((std::size_t)1, std::min(nonzero, suggested_num_chunks));
-
-                    std::vector<knowledge_commitment_vector<T1, T2>> tmp(num_chunks);
-                    std::vector<std::size_t> chunk_pos(num_chunks + 1);
-
-                    const std::size_t chunk_size = nonzero / num_chunks;
-                    const std::size_t last_chunk = nonzero - chunk_size * (num_chunks - 1);
-
-                    chunk_pos[0] = 0;
-
-                    std::size_t cnt = 0;
-                    std::size_t chunkno = 1;
+                    // blocks_nonzero[b] is the number of non-zero entries before block b
+                    const std::size_t max_chunks = std::max<std::size_t>(1, suggested_num_chunks);
+                    const std::size_t num_blocks = std::max<std::size_t>(1, std::min(v.size(), 8 * max_chunks));
+                    const std::size_t block_size = (v.size() + num_blocks - 1) / num_blocks;
+                    std::vector<std::size_t> blocks_nonzero(num_blocks + 1, 0);
+                    executor::current().parallel_for(num_blocks, [&](const std::size_t b) {
+                        const std::size_t last = std::min(v.size(), (b + 1) * block_size);
+                        for (std::size_t pos = std::min(v.size(), b * block_size); pos < last; ++pos) {
+                            blocks_nonzero[b + 1] += (v[pos].is_zero() ? 0 : 1);
+                        }
+                    });
+                    std::partial_sum(blocks_nonzero.begin(), blocks_nonzero.end(), blocks_nonzero.begin());
+
+                    const std::size_t nonzero = blocks_nonzero.back();
+                    res.values.resize(nonzero);
+                    res.indices.resize(nonzero);
+
+                    const std::size_t num_chunks = std::max<std::size_t>(1, std::min(nonzero, max_chunks));
+                    executor::current().bulk(num_chunks, [&](const std::size_t i) {
+                        const std::size_t first = nonzero * i / num_chunks;
+                        const std::size_t last = nonzero * (i + 1) / num_chunks;
+                        if (first == last) {
+                            return;
+                        }
 
-                    for (std::size_t i = 0; i < v.size(); ++i) {
-                        cnt += (v[i].is_zero() ? 0 : 1);
-                        if (cnt == chunk_size && chunkno < num_chunks) {
-                            chunk_pos[chunkno] = i;
-                            cnt = 0;
-                            ++chunkno;
+                        // the position of the non-zero entry of rank first, found from its block
+                        const std::size_t b =
+                            std::upper_bound(blocks_nonzero.begin(), blocks_nonzero.end(), first) -
+                            blocks_nonzero.begin() - 1;
+                        std::size_t start_pos = b * block_size;
+                        for (std::size_t rank = blocks_nonzero[b];; ++start_pos) {
+                            if (!v[start_pos].is_zero() && rank++ == first) {
+                                break;
+                            }
                         }
-                    }
 
-                    chunk_pos[num_chunks] = v.size();
-
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                    for (std::size_t i = 0; i < num_chunks; ++i) {
-                        tmp[i] = kc_batch_exp_internal<T1, T2, FieldType>(
-                            scalar_size, T1_window, T2_window, T1_table, T2_table, T1_coeff, T2_coeff, v, chunk_pos[i],
-                            chunk_pos[i + 1], i == num_chunks - 1 ? last_chunk : chunk_size);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename commitments<T1, T2>::value_type>(tmp[i].values);
-#endif
-                    }
+                        kc_batch_exp_internal<T1, T2, FieldType>(scalar_size, T1_window, T2_window, T1_table,
+                                                                 T2_table, T1_coeff, T2_coeff, v, start_pos,
+                                                                 last - first, res.values.data() + first,
+                                                                 res.indices.data() + first);
+                    });
 
-                    if (num_chunks == 1) {
-                        tmp[0].domain_size_ = v.size();
-                        return tmp[0];
-                    } else {
-                        for (std::size_t i = 0; i < num_chunks; ++i) {
-                            res.values.insert(res.values.end(), tmp[i].values.begin(), tmp[i].values.end());
-                            res.indices.insert(res.indices.end(), tmp[i].indices.begin(), tmp[i].indices.end());
-                        }
-                        return res;
-                    }
+                    return res;
+                }
+
+                /**
+                 * The knowledge commitments (T1_coeff * v[i] * T1_base, T2_coeff * v[i] * T2_base) of the
+                 * non-zero entries of v, through the window tables of two fixed-base engines.
+                 */
+                template<typename T1, typename T2, typename FieldType>
+                knowledge_commitment_vector<T1, T2> kc_batch_exp(const fixed_base_engine<T1, FieldType> &T1_engine,
+                                                                 const fixed_base_engine<T2, FieldType> &T2_engine,
+                                                                 const typename FieldType::value_type &T1_coeff,
+                                                                 const typename FieldType::value_type &T2_coeff,
+                                                                 const std::vector<typename FieldType::value_type> &v) {
+                    return kc_batch_exp<T1, T2, FieldType>(FieldType::value_bits, T1_engine.window_size(),
+                                                           T2_engine.window_size(), T1_engine.table(),
+                                                           T2_engine.table(), T1_coeff, T2_coeff, v,
+                                                           executor::current().concurrency());
                 }
             }    // namespace snark
         }        // namespace zk
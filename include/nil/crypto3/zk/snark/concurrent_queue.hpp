@@ -0,0 +1,176 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the queues handing work from one thread to another.
+//
+// A bounded_queue connects two pipeline stages: it holds at most a fixed number of
+// elements, blocking the producer while it is full and the consumer while it is empty,
+// see r1cs_gg_ppzksnark/pipelined_prover.hpp. An mpsc_queue lets any number of threads
+// hand elements to a single consumer without a lock: a push is one exchange and one
+// store, wait-free, and a pop by the consumer never waits on a producer. The consumer
+// cannot block on an mpsc_queue; a service waking its consumer on a push does so on the
+// side, see r1cs_gg_ppzksnark/ipp2/aggregation_service.hpp.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_CONCURRENT_QUEUE_HPP
+#define CRYPTO3_ZK_CONCURRENT_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+#include <boost/assert.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    /**
+                     * FIFO queue of at most capacity elements between two pipeline stages. push blocks
+                     * while the queue is full, pop while it is empty and open; once closed, pop drains the
+                     * remaining elements and then returns false.
+                     */
+                    template<typename T>
+                    class bounded_queue {
+                    public:
+                        explicit bounded_queue(const std::size_t capacity) :
+                            capacity(std::max<std::size_t>(1, capacity)), closed(false) {
+                        }
+
+                        void push(T &&value) {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            not_full.wait(lock, [&] { return elements.size() < capacity || closed; });
+                            BOOST_ASSERT(!closed);
+                            elements.emplace_back(std::move(value));
+                            not_empty.notify_one();
+                        }
+
+                        bool pop(T &value) {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            not_empty.wait(lock, [&] { return !elements.empty() || closed; });
+                            if (elements.empty()) {
+                                return false;
+                            }
+                            value = std::move(elements.front());
+                            elements.pop_front();
+                            not_full.notify_one();
+                            return true;
+                        }
+
+                        void close() {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            closed = true;
+                            not_empty.notify_all();
+                            not_full.notify_all();
+                        }
+
+                    private:
+                        const std::size_t capacity;
+                        bool closed;
+                        std::deque<T> elements;
+                        std::mutex mutex;
+                        std::condition_variable not_empty, not_full;
+                    };
+
+                    /**
+                     * Unbounded FIFO queue of many producers and a single consumer, the intrusive queue of
+                     * D. Vyukov. The elements are kept in a linked list whose first node is a dummy one,
+                     * whose value has been popped already, hence T must be default constructible.
+                     *
+                     * A push exchanges the last node of the list and then links the previous one to it; a
+                     * pop in between, by the consumer, sees the queue empty up to that link. The elements
+                     * of each producer are popped in the order it pushed them.
+                     */
+                    template<typename T>
+                    class mpsc_queue {
+                        struct node_type {
+                            node_type() : next(nullptr) {
+                            }
+
+                            explicit node_type(T &&value) : next(nullptr), value(std::move(value)) {
+                            }
+
+                            std::atomic<node_type *> next;
+                            T value;
+                        };
+
+                    public:
+                        mpsc_queue() : last(new node_type()), first(last.load(std::memory_order_relaxed)) {
+                        }
+
+                        mpsc_queue(const mpsc_queue &) = delete;
+                        mpsc_queue &operator=(const mpsc_queue &) = delete;
+
+                        ~mpsc_queue() {
+                            while (first) {
+                                node_type *next = first->next.load(std::memory_order_relaxed);
+                                delete first;
+                                first = next;
+                            }
+                        }
+
+                        /* Any thread. */
+                        void push(T &&value) {
+                            node_type *node = new node_type(std::move(value));
+                            node_type *previous = last.exchange(node, std::memory_order_acq_rel);
+                            previous->next.store(node, std::memory_order_release);
+                        }
+
+                        /* The consumer only. */
+                        bool try_pop(T &value) {
+                            node_type *next = first->next.load(std::memory_order_acquire);
+                            if (!next) {
+                                return false;
+                            }
+                            value = std::move(next->value);
+                            delete first;
+                            first = next;
+                            return true;
+                        }
+
+                        /**
+                         * The consumer only: whether every push started so far has been popped. A queue
+                         * that is not empty may still fail a try_pop, until a push links its node in.
+                         */
+                        bool empty() const {
+                            return last.load(std::memory_order_acquire) == first;
+                        }
+
+                    private:
+                        std::atomic<node_type *> last;
+                        /* the dummy node, owned by the consumer */
+                        node_type *first;
+                    };
+                }    // namespace detail
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_CONCURRENT_QUEUE_HPP
@@ -0,0 +1,143 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a deferred settlement of pairing product equations.
+//
+// A verifier that only needs to learn periodically that a whole set of proofs is
+// valid records the pairing checks of every proof in its own pairing_check and
+// settles them all at an explicit checkpoint: settle() merges every recorded check,
+// randomized, into a single pairing_check, that is one multi Miller loop and one
+// final exponentiation for all the proofs. When settlement fails, the proofs are
+// bisected: a failing half is split again down to the single proofs, a half is only
+// checked when its sibling failed as well, so k invalid proofs among n cost
+// O(k log n) settlements.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_DEFERRED_PAIRING_CHECK_HPP
+#define CRYPTO3_ZK_DEFERRED_PAIRING_CHECK_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <nil/crypto3/zk/snark/pairing_check.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /**
+                 * The pairing checks of the proofs recorded since the last settlement, each proof
+                 * being identified by its position in recording order.
+                 */
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = random_device_generator>
+                class deferred_pairing_check {
+                public:
+                    typedef CurveType curve_type;
+                    typedef pairing_check<CurveType, DistributionType, GeneratorType> pairing_check_type;
+
+                    /**
+                     * Records the checks of one more proof, merged by merge(pc) into an empty
+                     * pairing_check pc with merge_random or merge_nonrandom on pairs, or invalidated,
+                     * and returns the position of the proof.
+                     */
+                    template<typename Merge>
+                    std::size_t add(Merge merge) {
+                        entries.emplace_back();
+                        merge(entries.back());
+                        return entries.size() - 1;
+                    }
+
+                    /**
+                     * Settles all the recorded proofs at once, returning whether they are all valid. The
+                     * positions of the invalid ones are then listed by failed(). The recorded proofs are
+                     * forgotten either way, the next settlement starting from position 0 again.
+                     */
+                    bool settle() {
+                        failures.clear();
+                        if (!entries.empty() && !check(0, entries.size())) {
+                            bisect(0, entries.size());
+                        }
+                        entries.clear();
+                        return failures.empty();
+                    }
+
+                    /**
+                     * The positions, in increasing order, of the invalid proofs of the last settlement.
+                     */
+                    const std::vector<std::size_t> &failed() const {
+                        return failures;
+                    }
+
+                    /* the number of proofs recorded for the next settlement */
+                    std::size_t size() const {
+                        return entries.size();
+                    }
+
+                    void clear() {
+                        entries.clear();
+                        failures.clear();
+                    }
+
+                private:
+                    /* fresh coefficients are drawn for every settlement of a range */
+                    bool check(const std::size_t first, const std::size_t last) const {
+                        pairing_check_type pc;
+                        for (std::size_t i = first; i < last; ++i) {
+                            pc.merge_random(entries[i]);
+                        }
+                        return pc.verify();
+                    }
+
+                    /* [first, last) is known to hold at least one invalid proof */
+                    void bisect(const std::size_t first, const std::size_t last) {
+                        if (last - first == 1) {
+                            failures.emplace_back(first);
+                            return;
+                        }
+
+                        const std::size_t middle = first + (last - first) / 2;
+                        if (check(first, middle)) {
+                            bisect(middle, last);
+                            return;
+                        }
+                        bisect(first, middle);
+                        if (!check(middle, last)) {
+                            bisect(middle, last);
+                        }
+                    }
+
+                    std::vector<pairing_check_type> entries;
+                    std::vector<std::size_t> failures;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_DEFERRED_PAIRING_CHECK_HPP
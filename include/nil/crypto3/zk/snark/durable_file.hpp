@@ -0,0 +1,86 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the helpers replacing files durably.
+//
+// A file written under a temporary name and renamed over its final name is replaced
+// atomically, but neither the contents nor the rename survive a crash until they reach
+// the disk: the contents have to be synced before the rename, or the new name may point
+// to an empty file, and the directory after it, or the old name may come back.
+//
+//     write(temporary_path);
+//     if (!durable_rename(temporary_path, path)) { ... }
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_DURABLE_FILE_HPP
+#define CRYPTO3_ZK_DURABLE_FILE_HPP
+
+#include <cstdio>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Makes the contents of the file, or of the directory, at path durable.
+                 */
+                inline bool sync_path(const std::string &path) {
+                    const int fd = ::open(path.c_str(), O_RDONLY);
+                    if (fd < 0) {
+                        return false;
+                    }
+                    const bool synced = ::fsync(fd) == 0;
+                    ::close(fd);
+                    return synced;
+                }
+
+                /**
+                 * Makes the entries of the directory holding path durable, such as a rename to path.
+                 */
+                inline bool sync_parent_directory(const std::string &path) {
+                    const std::string::size_type slash = path.find_last_of('/');
+                    return sync_path(slash == std::string::npos ? std::string(".") :
+                                     slash == 0                 ? std::string("/") :
+                                                                  path.substr(0, slash));
+                }
+
+                /**
+                 * Syncs the file at from, renames it to to and syncs their directory. Returns false
+                 * when any of them fails, from being left in place unless the rename was done.
+                 */
+                inline bool durable_rename(const std::string &from, const std::string &to) {
+                    return sync_path(from) && std::rename(from.c_str(), to.c_str()) == 0 &&
+                           sync_parent_directory(to);
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_DURABLE_FILE_HPP
@@ -0,0 +1,169 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the execution policies of the multi-exponentiations and scalar
+// multiplications over secret and over public scalars.
+//
+// The fastest group algorithms are variable-time: they skip zero scalars and zero window
+// digits, pick their method from the number of non-trivial terms and add the bases of unit
+// scalars directly. That is what a verifier or an aggregator wants for public data, such as
+// the primary input accumulated into gamma_ABC_g1 or the challenges of IPP2, and it is what
+// variable_time_execution selects.
+//
+// constant_time_execution is for secret scalars, such as the randomness r and s of a proof.
+// Its multi-exponentiations are planned from their length alone, see multiexp_dispatch.hpp,
+// and its scalar multiplications run a fixed number of doublings and additions, reading
+// the whole table of multiples at every window. The policy fixes the sequence of group
+// operations. The timing of each group operation comes from the algebra library. Over a
+// base precomputed as a fixed_base_comb the doublings go away, and several scalars share
+// one pass over the comb.
+//
+// A call site names the policy of its data:
+//
+//     dispatch_multiexp<variable_time_execution::multiexp_method>(...);
+//     constant_time_execution::scalar_mul<scalar_field_type>(delta_g1, r);
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_EXECUTION_POLICY_HPP
+#define CRYPTO3_ZK_EXECUTION_POLICY_HPP
+
+#include <array>
+#include <cstddef>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Execution over public scalars: the fastest methods, whose running time depends on
+                 * the scalars.
+                 */
+                struct variable_time_execution {
+                    typedef multiexp_method_auto multiexp_method;
+
+                    template<typename ScalarFieldType, typename GroupValueType>
+                    static GroupValueType scalar_mul(const GroupValueType &point,
+                                                     const typename ScalarFieldType::value_type &scalar) {
+                        return scalar * point;
+                    }
+                };
+
+                /**
+                 * Execution over secret scalars: the sequence of group operations only depends on the
+                 * sizes of the inputs.
+                 */
+                struct constant_time_execution {
+                    typedef multiexp_method_uniform multiexp_method;
+
+                    /* width of the windows of scalar_mul */
+                    static constexpr std::size_t window = 4;
+
+                    /**
+                     * scalar * point with windows of window bits. Every window takes window doublings
+                     * and one addition of a multiple read by a scan of the whole table, the multiple of
+                     * a zero digit being the zero point.
+                     */
+                    template<typename ScalarFieldType, typename GroupValueType>
+                    static GroupValueType scalar_mul(const GroupValueType &point,
+                                                     const typename ScalarFieldType::value_type &scalar) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+
+                        std::array<GroupValueType, std::size_t(1) << window> multiples;
+                        multiples[0] = GroupValueType::zero();
+                        for (std::size_t d = 1; d < multiples.size(); ++d) {
+                            multiples[d] = multiples[d - 1] + point;
+                        }
+
+                        const integral_type value(scalar.data);
+                        const std::size_t digits = (ScalarFieldType::value_bits + window - 1) / window;
+                        GroupValueType result = GroupValueType::zero();
+                        for (std::size_t j = digits; j-- > 0;) {
+                            for (std::size_t k = 0; k < window; ++k) {
+                                result = result.doubled();
+                            }
+
+                            std::size_t digit = 0;
+                            for (std::size_t k = 0; k < window; ++k) {
+                                digit |= std::size_t(multiprecision::bit_test(value, j * window + k)) << k;
+                            }
+                            GroupValueType multiple = multiples[0];
+                            for (std::size_t d = 1; d < multiples.size(); ++d) {
+                                multiple = d == digit ? multiples[d] : multiple;
+                            }
+                            result = result + multiple;
+                        }
+
+                        return result;
+                    }
+
+                    /**
+                     * scalars[k] * P for every k over the comb of P, in one pass over it. Every window
+                     * takes one addition per scalar of a multiple read by a scan of the whole row.
+                     */
+                    template<typename ScalarFieldType, typename GroupType, std::size_t N>
+                    static std::array<typename GroupType::value_type, N>
+                        scalar_mul(const fixed_base_comb<GroupType> &comb,
+                                   const std::array<typename ScalarFieldType::value_type, N> &scalars) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+                        typedef typename GroupType::value_type group_value_type;
+
+                        std::array<integral_type, N> values;
+                        std::array<group_value_type, N> results;
+                        for (std::size_t k = 0; k < N; ++k) {
+                            values[k] = integral_type(scalars[k].data);
+                            results[k] = group_value_type::zero();
+                        }
+
+                        const std::size_t row_size = std::size_t(1) << comb.window;
+                        for (std::size_t j = 0; j < comb.digits; ++j) {
+                            const group_value_type *row = comb.row(j);
+                            for (std::size_t k = 0; k < N; ++k) {
+                                std::size_t digit = 0;
+                                for (std::size_t b = 0; b < comb.window; ++b) {
+                                    digit |= std::size_t(multiprecision::bit_test(values[k], j * comb.window + b))
+                                             << b;
+                                }
+                                group_value_type multiple = row[0];
+                                for (std::size_t d = 1; d < row_size; ++d) {
+                                    multiple = d == digit ? row[d] : multiple;
+                                }
+                                results[k] = results[k] + multiple;
+                            }
+                        }
+
+                        return results;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_EXECUTION_POLICY_HPP
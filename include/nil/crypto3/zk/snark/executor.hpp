@@ -0,0 +1,289 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the executor running the parallel loops of generators, provers and reductions.
+//
+// An executor is a thread budget together with a bulk function, which runs
+// f(0), ..., f(n - 1), possibly concurrently. The default executor uses OpenMP
+// when MULTICORE is defined and runs sequentially otherwise; a caller with its
+// own thread pool installs an executor forwarding to that pool for the duration
+// of a call:
+//
+//     executor pool_executor(4, [&](std::size_t n, const executor::task_type &f) { my_pool.bulk(n, f); });
+//     executor::scope guard(pool_executor);
+//     proof = prove<scheme_type>(pk, primary_input, auxiliary_input);
+//
+// The parallel code reads the executor of the calling thread with executor::current().
+// Tasks run by an executor see the sequential executor as current, so nested
+// parallel loops do not oversubscribe the budget, and the stage sink and path, the
+// operation counter and the memory budget of the thread starting them (see
+// stage_profiler.hpp, operation_counter.hpp and memory_budget.hpp).
+//
+// An executor over several memory domains may also take a placed bulk function, which is
+// given the position in [0, 1) of the data every task reads, so that a task runs next to
+// its data; bulk(n, f, positions) uses it and the other executors ignore the positions,
+// see numa.hpp.
+//
+// part(k) is an executor on k of the threads of an executor, for work running on a thread
+// of its own alongside the work of the others, see multiexp_tasks.hpp.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_EXECUTOR_HPP
+#define CRYPTO3_ZK_EXECUTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/memory_budget.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                class executor {
+                public:
+                    typedef std::function<void(std::size_t)> task_type;
+                    typedef std::function<void(std::size_t, const task_type &)> bulk_type;
+                    typedef std::function<void(std::size_t, const std::vector<double> &, const task_type &)>
+                        placed_bulk_type;
+
+                    /**
+                     * Executor of the built-in OpenMP pool, limited to concurrency threads.
+                     */
+                    explicit executor(const std::size_t concurrency = default_concurrency()) :
+                        concurrency_(std::max<std::size_t>(1, concurrency)), bulk_(openmp_bulk(concurrency_)),
+                        builtin_(true) {
+                    }
+
+                    /**
+                     * Executor forwarding to a caller-supplied pool. bulk(n, f) must call f(i) once for every
+                     * i in [0, n) and return when all calls are complete; concurrency is the number of
+                     * threads the work is split for.
+                     */
+                    executor(const std::size_t concurrency, bulk_type bulk) :
+                        concurrency_(std::max<std::size_t>(1, concurrency)), bulk_(std::move(bulk)), builtin_(false) {
+                    }
+
+                    /**
+                     * Executor forwarding to a pool over several memory domains: placed_bulk(n, positions, f)
+                     * is bulk(n, f), with positions[i] the position in [0, 1) of the data task i reads.
+                     */
+                    executor(const std::size_t concurrency, bulk_type bulk, placed_bulk_type placed_bulk) :
+                        concurrency_(std::max<std::size_t>(1, concurrency)), bulk_(std::move(bulk)),
+                        placed_bulk_(std::move(placed_bulk)), builtin_(false) {
+                    }
+
+                    std::size_t concurrency() const {
+                        return concurrency_;
+                    }
+
+                    /**
+                     * An executor on concurrency of the threads of this one, at least one and at most all:
+                     * an executor of the built-in pool starts no more threads, one forwarding to a
+                     * caller-supplied pool splits its work for that many.
+                     */
+                    executor part(std::size_t concurrency) const {
+                        concurrency = std::max<std::size_t>(1, std::min(concurrency, concurrency_));
+                        if (builtin_) {
+                            return executor(concurrency);
+                        }
+                        return executor(concurrency, bulk_, placed_bulk_);
+                    }
+
+                    /**
+                     * Calls f(task) for every task in [0, num_tasks), possibly concurrently.
+                     */
+                    template<typename Function>
+                    void bulk(const std::size_t num_tasks, Function f) const {
+                        run_tasks(num_tasks, f, [this](const std::size_t n, const task_type &task) { bulk_(n, task); });
+                    }
+
+                    /**
+                     * bulk(num_tasks, f), where positions[task] is the position in [0, 1) of the data read by
+                     * f(task) within the vectors it reads, for an executor that places its tasks.
+                     */
+                    template<typename Function>
+                    void bulk(const std::size_t num_tasks, Function f, const std::vector<double> &positions) const {
+                        if (!placed_bulk_) {
+                            bulk(num_tasks, f);
+                            return;
+                        }
+                        run_tasks(num_tasks, f, [&](const std::size_t n, const task_type &task) {
+                            placed_bulk_(n, positions, task);
+                        });
+                    }
+
+                    /**
+                     * Calls f(i) for every i in [0, n), the range being split into one contiguous block
+                     * per thread.
+                     */
+                    template<typename Function>
+                    void parallel_for(const std::size_t n, Function f) const {
+                        const std::size_t num_blocks = std::min(n, concurrency_);
+                        if (!num_blocks) {
+                            return;
+                        }
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+
+                        bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t end = std::min(n, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                f(i);
+                            }
+                        });
+                    }
+
+                    /**
+                     * Installs an executor as the current one of the calling thread for the lifetime
+                     * of the scope.
+                     */
+                    class scope {
+                    public:
+                        explicit scope(const executor &e) : previous(current_pointer()) {
+                            current_pointer() = &e;
+                        }
+
+                        scope(const scope &) = delete;
+                        scope &operator=(const scope &) = delete;
+
+                        ~scope() {
+                            current_pointer() = previous;
+                        }
+
+                    private:
+                        const executor *previous;
+                    };
+
+                    /**
+                     * The executor installed by the innermost scope of the calling thread, or the default one.
+                     * Unlike the executor, the process-wide settings of the library, such as
+                     * multiexp_tuning::current(), prefetch_tuning::current() and huge_page_policy::current(),
+                     * are shared by all the threads; they are meant to be set once, before proving.
+                     */
+                    static const executor &current() {
+                        const executor *e = current_pointer();
+                        return e ? *e : default_executor();
+                    }
+
+                    static const executor &default_executor() {
+                        static const executor e;
+                        return e;
+                    }
+
+                    static const executor &sequential() {
+                        static const executor e(1);
+                        return e;
+                    }
+
+                    /**
+                     * Whether the calling thread runs a task of a concurrent bulk call, from which no exception
+                     * may escape.
+                     */
+                    static bool in_task() {
+                        return task_depth() > 0;
+                    }
+
+                    static std::size_t default_concurrency() {
+#ifdef MULTICORE
+                        return omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
+                                                         // var or call omp_set_num_threads()
+#else
+                        return 1;
+#endif
+                    }
+
+                private:
+                    template<typename Function, typename Runner>
+                    void run_tasks(const std::size_t num_tasks, Function &f, Runner runner) const {
+                        if (num_tasks == 1 || concurrency_ == 1) {
+                            for (std::size_t task = 0; task < num_tasks; ++task) {
+                                f(task);
+                            }
+                            return;
+                        }
+
+                        const stage_profiler::context stages;
+                        operation_counter *const counter = operation_counter::current();
+                        const memory_budget &budget = memory_budget::current();
+                        runner(num_tasks, [&](const std::size_t task) {
+                            scope guard(sequential());
+                            stage_profiler::context::scope stages_guard(stages);
+                            operation_counter::scope counter_guard(counter);
+                            memory_budget::scope budget_guard(budget);
+                            task_scope task_guard;
+                            f(task);
+                        });
+                    }
+
+                    struct task_scope {
+                        task_scope() {
+                            ++task_depth();
+                        }
+                        ~task_scope() {
+                            --task_depth();
+                        }
+                    };
+
+                    static std::size_t &task_depth() {
+                        thread_local std::size_t depth = 0;
+                        return depth;
+                    }
+
+                    static const executor *&current_pointer() {
+                        thread_local const executor *current = nullptr;
+                        return current;
+                    }
+
+                    static bulk_type openmp_bulk(const std::size_t concurrency) {
+                        return [concurrency](const std::size_t num_tasks, const task_type &f) {
+#ifdef MULTICORE
+#pragma omp parallel for num_threads(concurrency) schedule(dynamic)
+#endif
+                            for (std::size_t task = 0; task < num_tasks; ++task) {
+                                f(task);
+                            }
+                        };
+                    }
+
+                    std::size_t concurrency_;
+                    bulk_type bulk_;
+                    placed_bulk_type placed_bulk_;
+                    /* whether bulk_ runs on the built-in OpenMP pool */
+                    bool builtin_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_EXECUTOR_HPP
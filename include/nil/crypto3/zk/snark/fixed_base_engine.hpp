@@ -0,0 +1,182 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the fixed-base exponentiation engine used by the generators.
+//
+// The key generators raise one base, a generator of G1 or G2, to many scalars.
+// A fixed_base_engine holds the window table of such a base, with the window size
+// chosen after the expected number of exponentiations, and computes batches of
+// exponentiations in blocks on the current executor:
+//
+//     const fixed_base_engine<g1_type, scalar_field_type> g1_engine(g1_generator, g1_exp_count);
+//     std::vector<g1_value_type> H_query = g1_engine.batch_exp(Ht);
+//
+// A generator holding a whole key normalizes it through a key_normalizer afterwards;
+// one writing its queries out block by block asks for the blocks in special form.
+//
+// Bases that are not drawn afresh, like the group generators, can share one table
+// between the calls of a process through fixed_base_engine::shared.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_FIXED_BASE_ENGINE_HPP
+#define CRYPTO3_ZK_FIXED_BASE_ENGINE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                template<typename GroupType, typename ScalarFieldType>
+                class fixed_base_engine {
+                public:
+                    typedef GroupType group_type;
+                    typedef ScalarFieldType scalar_field_type;
+                    typedef typename GroupType::value_type value_type;
+                    typedef typename ScalarFieldType::value_type scalar_value_type;
+
+                    /* the number of tables fixed_base_engine::shared keeps alive */
+                    static constexpr const std::size_t shared_capacity = 8;
+
+                    fixed_base_engine(const value_type &base, const std::size_t expected_exp_count) :
+                        base_(base), window_size_(algebra::get_exp_window_size<GroupType>(expected_exp_count)),
+                        table_(algebra::get_window_table<GroupType>(ScalarFieldType::value_bits, window_size_, base)) {
+                    }
+
+                    /**
+                     * An engine for base with a window at least as large as expected_exp_count calls for,
+                     * shared with the previous callers asking for the same base when one is still cached.
+                     */
+                    static std::shared_ptr<const fixed_base_engine> shared(const value_type &base,
+                                                                           const std::size_t expected_exp_count) {
+                        static std::mutex mutex;
+                        static std::vector<std::shared_ptr<const fixed_base_engine>> cache;
+
+                        const std::size_t window_size = algebra::get_exp_window_size<GroupType>(expected_exp_count);
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            for (const std::shared_ptr<const fixed_base_engine> &engine : cache) {
+                                if (engine->window_size() >= window_size && engine->base() == base) {
+                                    return engine;
+                                }
+                            }
+                        }
+
+                        /* the table is built outside the lock; a concurrent caller may build the same one */
+                        std::shared_ptr<const fixed_base_engine> engine =
+                            std::make_shared<const fixed_base_engine>(base, expected_exp_count);
+
+                        std::lock_guard<std::mutex> lock(mutex);
+                        cache.erase(std::remove_if(cache.begin(), cache.end(),
+                                                   [&](const std::shared_ptr<const fixed_base_engine> &other) {
+                                                       return other->window_size() <= window_size &&
+                                                              other->base() == base;
+                                                   }),
+                                    cache.end());
+                        if (cache.size() == shared_capacity) {
+                            cache.erase(cache.begin());
+                        }
+                        cache.emplace_back(engine);
+                        return engine;
+                    }
+
+                    const value_type &base() const {
+                        return base_;
+                    }
+
+                    std::size_t window_size() const {
+                        return window_size_;
+                    }
+
+                    const algebra::window_table<GroupType> &table() const {
+                        return table_;
+                    }
+
+                    /* scalar * base */
+                    value_type exp(const scalar_value_type &scalar) const {
+                        return algebra::windowed_exp<GroupType, ScalarFieldType>(ScalarFieldType::value_bits,
+                                                                                 window_size_, table_, scalar);
+                    }
+
+                    std::vector<value_type> batch_exp(const std::vector<scalar_value_type> &v,
+                                                      const bool special_form = false) const {
+                        return batch_exp(scalar_value_type::one(), v, 0, v.size(), special_form);
+                    }
+
+                    /**
+                     * (coeff * v[i]) * base for i in [first, last), split into blocks across the current
+                     * executor. With special_form set, every block converts its points to special form.
+                     */
+                    std::vector<value_type> batch_exp(const scalar_value_type &coeff,
+                                                      const std::vector<scalar_value_type> &v, const std::size_t first,
+                                                      const std::size_t last, const bool special_form = false) const {
+                        const std::size_t n = last - first;
+                        std::vector<value_type> result(n);
+                        if (!n) {
+                            return result;
+                        }
+
+                        const std::size_t num_blocks = std::min(n, executor::current().concurrency());
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t block_first = std::min(n, block * block_size);
+                            const std::size_t block_last = std::min(n, block_first + block_size);
+
+                            for (std::size_t i = block_first; i < block_last; ++i) {
+                                result[i] = exp(coeff * v[first + i]);
+                            }
+
+                            if (special_form && block_first < block_last) {
+                                std::vector<value_type> block_values(
+                                    std::make_move_iterator(result.begin() + block_first),
+                                    std::make_move_iterator(result.begin() + block_last));
+                                algebra::batch_to_special<GroupType>(block_values);
+                                std::move(block_values.begin(), block_values.end(), result.begin() + block_first);
+                            }
+                        });
+
+                        return result;
+                    }
+
+                private:
+                    value_type base_;
+                    std::size_t window_size_;
+                    algebra::window_table<GroupType> table_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_FIXED_BASE_ENGINE_HPP
@@ -0,0 +1,394 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of interfaces for a fixed-base multi-exponentiation.
+//
+// When the same vector of bases is used for many multi-exponentiations (e.g. the
+// queries of a proving key), each base P can be expanded once into the table
+// P, 2^c * P, 2^{2c} * P, ... of its window-shifted multiples. A multi-exponentiation
+// over such a table then reduces to a single bucket pass over c-bit digits, with no
+// doublings and no per-window bucket reduction.
+//
+// A single base multiplied by many scalars, such as delta of a proving key by the randomness
+// of every proof, is expanded instead into the comb of all the digit multiples
+// d * 2^{jc} * P of each window j, so a multiplication takes one addition per window.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_FIXED_BASE_MULTIEXP_HPP
+#define CRYPTO3_ZK_FIXED_BASE_MULTIEXP_HPP
+
+#include <algorithm>
+#include <vector>
+#include <iterator>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Precomputed window-shifted multiples of a vector of bases.
+                 *
+                 * For base P_i the table holds 2^{j * window} * P_i, j = 0, ..., digits - 1, laid
+                 * out contiguously, so a fixed-base multi-exponentiation walks the table linearly.
+                 */
+                template<typename GroupType>
+                struct fixed_base_precomputation {
+                    typedef GroupType group_type;
+                    typedef typename group_type::value_type group_value_type;
+
+                    std::size_t window;
+                    std::size_t digits;
+                    std::vector<group_value_type> table;
+
+                    fixed_base_precomputation() : window(0), digits(0) {};
+                    fixed_base_precomputation(const fixed_base_precomputation &other) = default;
+                    fixed_base_precomputation(fixed_base_precomputation &&other) = default;
+                    fixed_base_precomputation &operator=(const fixed_base_precomputation &other) = default;
+                    fixed_base_precomputation &operator=(fixed_base_precomputation &&other) = default;
+
+                    std::size_t size() const {
+                        return digits ? table.size() / digits : 0;
+                    }
+
+                    bool empty() const {
+                        return table.empty();
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return table.size() * group_type::value_bits;
+                    }
+
+                    bool operator==(const fixed_base_precomputation &other) const {
+                        return window == other.window && digits == other.digits && table == other.table;
+                    }
+                };
+
+                /**
+                 * Returns the largest window for which the precomputation of num_bases bases, together
+                 * with the buckets of chunks concurrent passes over it, fits into memory_budget_in_bits.
+                 * A wider window means fewer digits, so a smaller table and fewer additions per base, but
+                 * twice the buckets: windows above log2(num_bases) bits, where the buckets outnumber the
+                 * bases, are not considered. Returns 0 if no window fits.
+                 */
+                template<typename GroupType, typename FieldType>
+                std::size_t fixed_base_window_for_budget(const std::size_t num_bases,
+                                                         const std::size_t memory_budget_in_bits,
+                                                         const std::size_t chunks = 1) {
+                    constexpr const std::size_t max_window = 20;
+                    const std::size_t scalar_bits = FieldType::value_bits;
+
+                    std::size_t widest_window = 1;
+                    while (widest_window < max_window && (std::size_t(2) << widest_window) <= num_bases) {
+                        ++widest_window;
+                    }
+
+                    for (std::size_t window = widest_window; window > 0; --window) {
+                        const std::size_t digits = (scalar_bits + window - 1) / window;
+                        const std::size_t entries = num_bases * digits + chunks * (std::size_t(1) << window);
+                        if (entries * GroupType::value_bits <= memory_budget_in_bits) {
+                            return window;
+                        }
+                    }
+
+                    return 0;
+                }
+
+                /**
+                 * Expands the bases [bases_first, bases_last) into their window-shifted multiples
+                 * for scalars of FieldType.
+                 */
+                template<typename GroupType, typename FieldType, typename InputBaseIterator>
+                fixed_base_precomputation<GroupType> fixed_base_precompute(InputBaseIterator bases_first,
+                                                                           InputBaseIterator bases_last,
+                                                                           const std::size_t window,
+                                                                           const std::size_t chunks) {
+                    BOOST_ASSERT(window > 0);
+
+                    fixed_base_precomputation<GroupType> result;
+                    result.window = window;
+                    result.digits = (FieldType::value_bits + window - 1) / window;
+
+                    const std::size_t num_bases = std::distance(bases_first, bases_last);
+                    result.table.resize(num_bases * result.digits);
+
+                    const std::size_t num_chunks = std::max<std::size_t>(1, std::min(chunks, num_bases));
+                    const std::size_t chunk_size = (num_bases + num_chunks - 1) / num_chunks;
+
+                    executor::current().bulk(num_chunks, [&](const std::size_t chunk) {
+                        const std::size_t end = std::min(num_bases, (chunk + 1) * chunk_size);
+                        for (std::size_t i = chunk * chunk_size; i < end; ++i) {
+                            typename GroupType::value_type current = *(bases_first + i);
+                            for (std::size_t j = 0; j < result.digits; ++j) {
+                                result.table[i * result.digits + j] = current;
+                                for (std::size_t k = 0; k < window && j + 1 < result.digits; ++k) {
+                                    current = current.doubled();
+                                }
+                            }
+                        }
+                    });
+
+                    return result;
+                }
+
+                /**
+                 * Precomputed digit multiples of a single base.
+                 *
+                 * For window j the table holds d * 2^{j * window} * P, d = 0, ..., 2^window - 1, laid
+                 * out contiguously by window, so scalar * P is the sum of one entry per window.
+                 */
+                template<typename GroupType>
+                struct fixed_base_comb {
+                    typedef GroupType group_type;
+                    typedef typename group_type::value_type group_value_type;
+
+                    std::size_t window;
+                    std::size_t digits;
+                    std::vector<group_value_type> table;
+
+                    fixed_base_comb() : window(0), digits(0) {};
+                    fixed_base_comb(const fixed_base_comb &other) = default;
+                    fixed_base_comb(fixed_base_comb &&other) = default;
+                    fixed_base_comb &operator=(const fixed_base_comb &other) = default;
+                    fixed_base_comb &operator=(fixed_base_comb &&other) = default;
+
+                    /* The multiples of window j. */
+                    const group_value_type *row(const std::size_t j) const {
+                        return &table[j << window];
+                    }
+
+                    bool empty() const {
+                        return table.empty();
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return table.size() * group_type::value_bits;
+                    }
+
+                    bool operator==(const fixed_base_comb &other) const {
+                        return window == other.window && digits == other.digits && table == other.table;
+                    }
+                };
+
+                /**
+                 * Expands base into the digit multiples of its windows for scalars of FieldType.
+                 */
+                template<typename GroupType, typename FieldType>
+                fixed_base_comb<GroupType> fixed_base_comb_precompute(const typename GroupType::value_type &base,
+                                                                      const std::size_t window) {
+                    BOOST_ASSERT(window > 0);
+
+                    fixed_base_comb<GroupType> result;
+                    result.window = window;
+                    result.digits = (FieldType::value_bits + window - 1) / window;
+
+                    const std::size_t row_size = std::size_t(1) << window;
+                    result.table.resize(result.digits * row_size);
+
+                    /* the first multiple of every row is 2^{j * window} * P */
+                    typename GroupType::value_type shifted = base;
+                    for (std::size_t j = 0; j < result.digits; ++j) {
+                        result.table[j * row_size + 1] = shifted;
+                        for (std::size_t k = 0; k < window; ++k) {
+                            shifted = shifted.doubled();
+                        }
+                    }
+
+                    executor::current().parallel_for(result.digits, [&](const std::size_t j) {
+                        typename GroupType::value_type *row = &result.table[j * row_size];
+                        row[0] = GroupType::value_type::zero();
+                        for (std::size_t d = 2; d < row_size; ++d) {
+                            row[d] = row[d - 1] + row[1];
+                        }
+                    });
+
+                    return result;
+                }
+
+                namespace detail {
+                    /**
+                     * Runs one bucket pass over the rows [first_row, first_row + num_terms) of the
+                     * precomputation for every scalar sequence in scalar_firsts at once, so each
+                     * precomputed base is read from memory once per call regardless of how many
+                     * multi-exponentiations share it.
+                     */
+                    template<typename GroupType, typename InputFieldIterator, typename IndexFunction>
+                    std::vector<typename GroupType::value_type>
+                        fixed_base_multiexp_internal(const fixed_base_precomputation<GroupType> &precomputation,
+                                                     const std::size_t first_row, const std::size_t num_terms,
+                                                     const std::vector<InputFieldIterator> &scalar_firsts,
+                                                     IndexFunction index_of, const std::size_t chunks) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+                        typedef typename GroupType::value_type group_value_type;
+
+                        const std::size_t window = precomputation.window;
+                        const std::size_t digits = precomputation.digits;
+                        const std::size_t num_buckets = std::size_t(1) << window;
+                        const std::size_t batch_size = scalar_firsts.size();
+                        const std::size_t num_chunks = std::max<std::size_t>(1, std::min(chunks, num_terms));
+                        const std::size_t chunk_size = (num_terms + num_chunks - 1) / num_chunks;
+
+                        std::vector<std::vector<group_value_type>> partial(
+                            num_chunks, std::vector<group_value_type>(batch_size, group_value_type::zero()));
+
+                        executor::current().bulk(num_chunks, [&](const std::size_t chunk) {
+                            std::vector<group_value_type> buckets(batch_size * num_buckets,
+                                                                  group_value_type::zero());
+                            const std::size_t begin = chunk * chunk_size;
+                            const std::size_t end = std::min(num_terms, begin + chunk_size);
+
+                            for (std::size_t term = begin; term < end; ++term) {
+                                const group_value_type *row = &precomputation.table[(first_row + term) * digits];
+                                const std::size_t scalar_index = index_of(term);
+
+                                for (std::size_t b = 0; b < batch_size; ++b) {
+                                    const auto &scalar = *(scalar_firsts[b] + scalar_index);
+                                    if (scalar.is_zero()) {
+                                        continue;
+                                    }
+
+                                    const integral_type value(scalar.data);
+                                    group_value_type *batch_buckets = &buckets[b * num_buckets];
+
+                                    for (std::size_t j = 0; j < digits; ++j) {
+                                        std::size_t digit = 0;
+                                        for (std::size_t k = 0; k < window; ++k) {
+                                            if (multiprecision::bit_test(value, j * window + k)) {
+                                                digit |= std::size_t(1) << k;
+                                            }
+                                        }
+                                        if (digit) {
+                                            batch_buckets[digit] = batch_buckets[digit] + row[j];
+                                        }
+                                    }
+                                }
+                            }
+
+                            // sum_d d * buckets[d] via running sums
+                            for (std::size_t b = 0; b < batch_size; ++b) {
+                                group_value_type running = group_value_type::zero();
+                                group_value_type acc = group_value_type::zero();
+                                for (std::size_t d = num_buckets - 1; d > 0; --d) {
+                                    running = running + buckets[b * num_buckets + d];
+                                    acc = acc + running;
+                                }
+                                partial[chunk][b] = acc;
+                            }
+                        });
+
+                        std::vector<group_value_type> result(batch_size, group_value_type::zero());
+                        for (const std::vector<group_value_type> &p : partial) {
+                            for (std::size_t b = 0; b < batch_size; ++b) {
+                                result[b] = result[b] + p[b];
+                            }
+                        }
+
+                        return result;
+                    }
+                }    // namespace detail
+
+                /**
+                 * Computes sum_i scalar_i * P_i for the first std::distance(scalar_first, scalar_last)
+                 * precomputed bases.
+                 */
+                template<typename GroupType, typename InputFieldIterator>
+                typename GroupType::value_type
+                    fixed_base_multiexp(const fixed_base_precomputation<GroupType> &precomputation,
+                                        InputFieldIterator scalar_first, InputFieldIterator scalar_last,
+                                        const std::size_t chunks) {
+                    const std::size_t num_terms = std::distance(scalar_first, scalar_last);
+                    BOOST_ASSERT(num_terms <= precomputation.size());
+
+                    return detail::fixed_base_multiexp_internal(
+                        precomputation, 0, num_terms, std::vector<InputFieldIterator> {scalar_first},
+                        [](std::size_t term) { return term; }, chunks)[0];
+                }
+
+                /**
+                 * Computes sum_i scalar_{b,i} * P_i for every scalar sequence b starting at
+                 * scalar_firsts[b], each of length num_terms, in a single pass over the bases.
+                 */
+                template<typename GroupType, typename InputFieldIterator>
+                std::vector<typename GroupType::value_type>
+                    fixed_base_multiexp_batch(const fixed_base_precomputation<GroupType> &precomputation,
+                                              const std::vector<InputFieldIterator> &scalar_firsts,
+                                              const std::size_t num_terms, const std::size_t chunks) {
+                    BOOST_ASSERT(num_terms <= precomputation.size());
+
+                    return detail::fixed_base_multiexp_internal(
+                        precomputation, 0, num_terms, scalar_firsts, [](std::size_t term) { return term; }, chunks);
+                }
+
+                /**
+                 * Computes sum_k scalar_{indices[k] - min_idx} * P_k over the precomputed bases P_k of a
+                 * sparse vector, for the indices lying in [min_idx, max_idx), for every scalar sequence
+                 * starting at scalar_firsts[b].
+                 */
+                template<typename GroupType, typename InputFieldIterator>
+                std::vector<typename GroupType::value_type>
+                    fixed_base_sparse_multiexp_batch(const fixed_base_precomputation<GroupType> &precomputation,
+                                                     const std::vector<std::size_t> &indices,
+                                                     const std::size_t min_idx, const std::size_t max_idx,
+                                                     const std::vector<InputFieldIterator> &scalar_firsts,
+                                                     const std::size_t chunks) {
+                    BOOST_ASSERT(indices.size() == precomputation.size());
+
+                    const std::size_t first = std::lower_bound(indices.begin(), indices.end(), min_idx) -
+                                              indices.begin();
+                    const std::size_t last = std::lower_bound(indices.begin(), indices.end(), max_idx) -
+                                             indices.begin();
+
+                    return detail::fixed_base_multiexp_internal(
+                        precomputation, first, last - first, scalar_firsts,
+                        [&](std::size_t term) { return indices[first + term] - min_idx; }, chunks);
+                }
+
+                /**
+                 * Computes sum_k scalar_{indices[k] - min_idx} * P_k over the precomputed bases P_k of a
+                 * sparse vector, for the indices lying in [min_idx, max_idx).
+                 */
+                template<typename GroupType, typename InputFieldIterator>
+                typename GroupType::value_type
+                    fixed_base_sparse_multiexp(const fixed_base_precomputation<GroupType> &precomputation,
+                                               const std::vector<std::size_t> &indices, const std::size_t min_idx,
+                                               const std::size_t max_idx, InputFieldIterator scalar_first,
+                                               InputFieldIterator scalar_last, const std::size_t chunks) {
+                    BOOST_ASSERT(max_idx - min_idx <= std::size_t(std::distance(scalar_first, scalar_last)));
+
+                    return fixed_base_sparse_multiexp_batch(precomputation, indices, min_idx, max_idx,
+                                                            std::vector<InputFieldIterator> {scalar_first},
+                                                            chunks)[0];
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_FIXED_BASE_MULTIEXP_HPP
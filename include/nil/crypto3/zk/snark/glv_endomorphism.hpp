@@ -0,0 +1,300 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the GLV endomorphism multi-exponentiation.
+//
+// The G1 groups of the BLS12 and BN curves have the efficient endomorphism
+// phi(x, y) = (beta * x, y), beta a cube root of unity of the base field, which acts as the
+// multiplication by a cube root of unity lambda of the scalar field. A scalar k splits into
+// k1 + k2 * lambda with k1 and k2 of half the bit length, up to sign, by rounding k onto a
+// reduced basis of the lattice of the (a, b) with a + b * lambda = 0 mod r. A
+// multi-exponentiation of n full-length terms is then one of 2n half-length terms over the
+// bases and their images, which halves the doublings of every bucket method. The bucket
+// additions stay the same in number.
+//
+// glv_endomorphism<GroupType> describes the endomorphism of a group and is available for the
+// G1 groups of BLS12-381 and BN254 only. The images of the bases of a query take one
+// multiplication each. glv_bases computes them once, so they can be kept with the query
+// across proofs. endomorphism_multiexp falls back to dispatch_multiexp for the other groups.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_GLV_ENDOMORPHISM_HPP
+#define CRYPTO3_ZK_GLV_ENDOMORPHISM_HPP
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/algebra/curves/alt_bn128.hpp>
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> glv_integral_type;
+
+                    /* n / d rounded to the nearest integer, d > 0 */
+                    inline glv_integral_type glv_rounded_div(const glv_integral_type &n, const glv_integral_type &d) {
+                        return n >= 0 ? glv_integral_type((n + d / 2) / d) : glv_integral_type(-((-n + d / 2) / d));
+                    }
+                }    // namespace detail
+
+                /**
+                 * The endomorphism phi(x, y) = (beta * x, y) = lambda * (x, y) of GroupType, if it has one.
+                 *
+                 * An available endomorphism provides scalar_field_type, beta() and basis(), the reduced
+                 * basis (a1, b1), (a2, b2) of the lattice of the (a, b) with a + b * lambda = 0 mod r.
+                 */
+                template<typename GroupType>
+                struct glv_endomorphism {
+                    constexpr static const bool available = false;
+                };
+
+                template<>
+                struct glv_endomorphism<algebra::curves::bls12<381>::g1_type> {
+                    typedef algebra::curves::bls12<381>::g1_type group_type;
+                    typedef algebra::curves::bls12<381>::scalar_field_type scalar_field_type;
+
+                    constexpr static const bool available = true;
+
+                    static const group_type::field_type::value_type &beta() {
+                        static const group_type::field_type::value_type value(group_type::field_type::modulus_type(
+                            "4002409555221667392624310435006688643935503118305586438271171395842971157480381377015405"
+                            "980053539358417135540939436"));
+                        return value;
+                    }
+
+                    /* lambda = z^2 - 1, z the parameter of the curve, and r = lambda^2 + lambda + 1 */
+                    static const std::array<detail::glv_integral_type, 4> &basis() {
+                        static const std::array<detail::glv_integral_type, 4> value = {
+                            detail::glv_integral_type("228988810152649578064853576960394133503"),
+                            detail::glv_integral_type(-1), detail::glv_integral_type(1),
+                            detail::glv_integral_type("228988810152649578064853576960394133504")};
+                        return value;
+                    }
+                };
+
+                template<>
+                struct glv_endomorphism<algebra::curves::alt_bn128<254>::g1_type> {
+                    typedef algebra::curves::alt_bn128<254>::g1_type group_type;
+                    typedef algebra::curves::alt_bn128<254>::scalar_field_type scalar_field_type;
+
+                    constexpr static const bool available = true;
+
+                    static const group_type::field_type::value_type &beta() {
+                        static const group_type::field_type::value_type value(group_type::field_type::modulus_type(
+                            "21888242871839275220042445260109153167277707414472061641714758635765020556616"));
+                        return value;
+                    }
+
+                    /* lambda = 21888242871839275217838484774961031246154997185409878258781734729429964517155 */
+                    static const std::array<detail::glv_integral_type, 4> &basis() {
+                        static const std::array<detail::glv_integral_type, 4> value = {
+                            detail::glv_integral_type("147946756881789319000765030803803410728"),
+                            detail::glv_integral_type("-9931322734385697763"),
+                            detail::glv_integral_type("9931322734385697763"),
+                            detail::glv_integral_type("147946756881789319010696353538189108491")};
+                        return value;
+                    }
+                };
+
+                /**
+                 * A scalar k of GroupType as k1 + k2 * lambda, k1 and k2 being the half-length magnitudes
+                 * of signed halves.
+                 */
+                template<typename GroupType>
+                struct glv_decomposition {
+                    typedef typename glv_endomorphism<GroupType>::scalar_field_type scalar_field_type;
+
+                    typename scalar_field_type::value_type k1, k2;
+                    bool negative1, negative2;
+                };
+
+                /* phi(point), which is in special form when point is */
+                template<typename GroupType>
+                typename GroupType::value_type glv_image(const typename GroupType::value_type &point) {
+                    return typename GroupType::value_type(glv_endomorphism<GroupType>::beta() * point.X, point.Y,
+                                                          point.Z);
+                }
+
+                template<typename GroupType>
+                glv_decomposition<GroupType>
+                    glv_decompose(const typename glv_endomorphism<GroupType>::scalar_field_type::value_type &scalar) {
+                    typedef typename glv_endomorphism<GroupType>::scalar_field_type scalar_field_type;
+                    typedef detail::glv_integral_type integral_type;
+
+                    const std::array<integral_type, 4> &basis = glv_endomorphism<GroupType>::basis();
+                    const integral_type &a1 = basis[0], &b1 = basis[1], &a2 = basis[2], &b2 = basis[3];
+
+                    const integral_type k(scalar.data);
+                    const integral_type r(scalar_field_type::modulus);
+                    const integral_type c1 = detail::glv_rounded_div(b2 * k, r);
+                    const integral_type c2 = detail::glv_rounded_div(-b1 * k, r);
+                    const integral_type k1 = k - c1 * a1 - c2 * a2;
+                    const integral_type k2 = -c1 * b1 - c2 * b2;
+
+                    glv_decomposition<GroupType> result;
+                    result.negative1 = k1 < 0;
+                    result.negative2 = k2 < 0;
+                    result.k1 = typename scalar_field_type::value_type(
+                        typename scalar_field_type::modulus_type(result.negative1 ? integral_type(-k1) : k1));
+                    result.k2 = typename scalar_field_type::value_type(
+                        typename scalar_field_type::modulus_type(result.negative2 ? integral_type(-k2) : k2));
+                    return result;
+                }
+
+                /**
+                 * The bases of a multi-exponentiation together with their images under the endomorphism,
+                 * computed once on the current executor.
+                 */
+                template<typename GroupType>
+                class glv_bases {
+                    typedef typename GroupType::value_type value_type;
+
+                    std::vector<value_type> points;
+
+                public:
+                    typedef GroupType group_type;
+
+                    glv_bases() = default;
+
+                    template<typename InputBaseIterator>
+                    glv_bases(InputBaseIterator bases_first, InputBaseIterator bases_last) :
+                        points(2 * std::distance(bases_first, bases_last)) {
+                        executor::current().parallel_for(size(), [&](const std::size_t i) {
+                            points[2 * i] = *(bases_first + i);
+                            points[2 * i + 1] = glv_image<GroupType>(points[2 * i]);
+                        });
+                    }
+
+                    explicit glv_bases(const std::vector<value_type> &bases) : glv_bases(bases.begin(), bases.end()) {
+                    }
+
+                    std::size_t size() const {
+                        return points.size() / 2;
+                    }
+
+                    const value_type &base(const std::size_t i) const {
+                        BOOST_ASSERT(i < size());
+                        return points[2 * i];
+                    }
+
+                    const value_type &image(const std::size_t i) const {
+                        BOOST_ASSERT(i < size());
+                        return points[2 * i + 1];
+                    }
+                };
+
+                /**
+                 * sum_i scalar_i * base_i over the bases [first, last) of bases and the scalars from
+                 * scalars_first, as a multi-exponentiation with MultiexpMethod of 2 * (last - first)
+                 * half-length terms.
+                 */
+                template<typename MultiexpMethod, typename GroupType, typename InputFieldIterator>
+                typename GroupType::value_type glv_multiexp(const glv_bases<GroupType> &bases, const std::size_t first,
+                                                            const std::size_t last, InputFieldIterator scalars_first,
+                                                            const std::size_t chunks) {
+                    typedef typename GroupType::value_type value_type;
+                    typedef typename glv_endomorphism<GroupType>::scalar_field_type scalar_field_type;
+
+                    BOOST_ASSERT(first <= last && last <= bases.size());
+                    const std::size_t n = last - first;
+
+                    /* a negative half takes the opposite of its base; the buffers of the calling thread are
+                     * kept across its calls, and bound here so that the workers fill those very buffers */
+                    thread_local std::vector<value_type> terms_buffer;
+                    thread_local std::vector<typename scalar_field_type::value_type> halves_buffer;
+                    std::vector<value_type> &terms = terms_buffer;
+                    std::vector<typename scalar_field_type::value_type> &halves = halves_buffer;
+                    terms.resize(2 * n);
+                    halves.resize(2 * n);
+                    executor::current().parallel_for(n, [&](const std::size_t i) {
+                        const glv_decomposition<GroupType> decomposition =
+                            glv_decompose<GroupType>(*(scalars_first + i));
+                        const value_type &base = bases.base(first + i), &image = bases.image(first + i);
+                        terms[2 * i] = decomposition.negative1 ? -base : base;
+                        terms[2 * i + 1] = decomposition.negative2 ? -image : image;
+                        halves[2 * i] = decomposition.k1;
+                        halves[2 * i + 1] = decomposition.k2;
+                    });
+
+                    return dispatch_multiexp<MultiexpMethod>(terms.cbegin(), terms.cend(), halves.cbegin(),
+                                                             halves.cend(), chunks);
+                }
+
+                namespace detail {
+                    template<typename MultiexpMethod, typename GroupType, typename InputBaseIterator,
+                             typename InputFieldIterator>
+                    typename GroupType::value_type
+                        endomorphism_multiexp(std::true_type, InputBaseIterator bases_first,
+                                              InputBaseIterator bases_last, InputFieldIterator scalars_first,
+                                              InputFieldIterator scalars_last, const std::size_t chunks) {
+                        const glv_bases<GroupType> bases(bases_first, bases_last);
+                        BOOST_ASSERT(std::size_t(std::distance(scalars_first, scalars_last)) == bases.size());
+                        return glv_multiexp<MultiexpMethod>(bases, 0, bases.size(), scalars_first, chunks);
+                    }
+
+                    template<typename MultiexpMethod, typename GroupType, typename InputBaseIterator,
+                             typename InputFieldIterator>
+                    typename GroupType::value_type
+                        endomorphism_multiexp(std::false_type, InputBaseIterator bases_first,
+                                              InputBaseIterator bases_last, InputFieldIterator scalars_first,
+                                              InputFieldIterator scalars_last, const std::size_t chunks) {
+                        return dispatch_multiexp<MultiexpMethod>(bases_first, bases_last, scalars_first,
+                                                                 scalars_last, chunks);
+                    }
+                }    // namespace detail
+
+                /**
+                 * dispatch_multiexp with MultiexpMethod, split by the endomorphism of GroupType when it has
+                 * one. The images of the bases are computed by the call.
+                 */
+                template<typename GroupType, typename MultiexpMethod, typename InputBaseIterator,
+                         typename InputFieldIterator>
+                typename GroupType::value_type endomorphism_multiexp(InputBaseIterator bases_first,
+                                                                     InputBaseIterator bases_last,
+                                                                     InputFieldIterator scalars_first,
+                                                                     InputFieldIterator scalars_last,
+                                                                     const std::size_t chunks) {
+                    return detail::endomorphism_multiexp<MultiexpMethod, GroupType>(
+                        std::integral_constant<bool, glv_endomorphism<GroupType>::available>(), bases_first,
+                        bases_last, scalars_first, scalars_last, chunks);
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_GLV_ENDOMORPHISM_HPP
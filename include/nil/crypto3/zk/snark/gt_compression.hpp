@@ -0,0 +1,269 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the torus compression of Gt elements.
+//
+// The elements of Gt, outputs of a final exponentiation, lie in the cyclotomic subgroup
+// of the extension field Fqk = Fqk/2[w], w^2 = v. They all have norm one over Fqk/2,
+// x = a + b w with a^2 - v b^2 = 1, which is the algebraic torus T2 of the subfield:
+// such an x is determined by the single element c = (1 + a) / b of Fqk/2 and is
+// recovered as x = (c + w) / (c - w). A compressed element takes half the size of the
+// full one, 288 instead of 576 bytes on BLS12-381. Since -1 is not an element of the
+// prime order Gt, c = 0 is left free to encode the identity, for which b = 0.
+//
+// Both directions take a field inversion. The batch versions share a single inversion
+// between all the elements with Montgomery's trick.
+//
+// Every c decompresses into a norm one element, but the torus is much larger than Gt, so
+// the bytes of an untrusted c may stand for an element outside of it. Decompression
+// therefore checks x^r = 1 for the order r of Gt, an exponentiation by r per element,
+// split across the current executor by the batch version.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_GT_COMPRESSION_HPP
+#define CRYPTO3_ZK_GT_COMPRESSION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/algebra/marshalling.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    /**
+                     * Replaces every element of values by its inverse, with a single field inversion.
+                     * None of the elements may be zero.
+                     */
+                    template<typename FieldValueType>
+                    void batch_inverse(std::vector<FieldValueType> &values) {
+                        if (values.empty()) {
+                            return;
+                        }
+
+                        std::vector<FieldValueType> prefix;
+                        prefix.reserve(values.size());
+                        FieldValueType acc = FieldValueType::one();
+                        for (const FieldValueType &value : values) {
+                            prefix.emplace_back(acc);
+                            acc = acc * value;
+                        }
+
+                        FieldValueType inv = acc.inversed();
+                        for (std::size_t i = values.size(); i-- > 0;) {
+                            const FieldValueType value = values[i];
+                            values[i] = inv * prefix[i];
+                            inv = inv * value;
+                        }
+                    }
+                }    // namespace detail
+
+                /**
+                 * Torus compression of the elements of the target group of CurveType.
+                 */
+                template<typename CurveType>
+                struct gt_compression {
+                    typedef CurveType curve_type;
+                    typedef typename curve_type::gt_type gt_type;
+                    typedef typename gt_type::value_type gt_value_type;
+                    typedef typename gt_type::underlying_field_type compressed_field_type;
+                    typedef typename compressed_field_type::value_type compressed_type;
+
+                    typedef typename curve_type::base_field_type base_field_type;
+                    typedef typename curve_type::scalar_field_type scalar_field_type;
+                    typedef marshalling::curve_bincode<curve_type> bincode;
+
+                    /**
+                     * The square v of the generator w of Gt over the compressed field.
+                     */
+                    static compressed_type non_residue() {
+                        const gt_value_type w(compressed_type::zero(), compressed_type::one());
+                        return (w * w).data[0];
+                    }
+
+                    static compressed_type compress(const gt_value_type &x) {
+                        if (x.data[1] == compressed_type::zero()) {
+                            BOOST_ASSERT(x == gt_value_type::one());
+                            return compressed_type::zero();
+                        }
+                        return (compressed_type::one() + x.data[0]) * x.data[1].inversed();
+                    }
+
+                    /**
+                     * Whether x lies in Gt, the subgroup of order r of the cyclotomic subgroup.
+                     */
+                    static bool is_in_subgroup(const gt_value_type &x) {
+                        return x.pow(typename scalar_field_type::modulus_type(scalar_field_type::modulus)) ==
+                               gt_value_type::one();
+                    }
+
+                    /**
+                     * The element c stands for, and whether it lies in Gt.
+                     */
+                    static std::pair<bool, gt_value_type> decompress(const compressed_type &c) {
+                        if (c == compressed_type::zero()) {
+                            return std::make_pair(true, gt_value_type::one());
+                        }
+                        const gt_value_type x = expand(c, (c.squared() - non_residue()).inversed());
+                        return std::make_pair(is_in_subgroup(x), x);
+                    }
+
+                    /**
+                     * Compresses [first, last) into out, with a single field inversion.
+                     */
+                    template<typename InputIterator, typename OutputIterator>
+                    static OutputIterator compress(InputIterator first, InputIterator last, OutputIterator out) {
+                        std::vector<compressed_type> b;
+                        b.reserve(std::distance(first, last));
+                        for (InputIterator it = first; it != last; ++it) {
+                            BOOST_ASSERT(it->data[1] != compressed_type::zero() || *it == gt_value_type::one());
+                            b.emplace_back(it->data[1] == compressed_type::zero() ? compressed_type::one() :
+                                                                                    it->data[1]);
+                        }
+                        detail::batch_inverse(b);
+
+                        std::size_t i = 0;
+                        for (InputIterator it = first; it != last; ++it, ++i) {
+                            *out++ = it->data[1] == compressed_type::zero() ?
+                                         compressed_type::zero() :
+                                         (compressed_type::one() + it->data[0]) * b[i];
+                        }
+                        return out;
+                    }
+
+                    /**
+                     * Decompresses [first, last) into the random access range starting at out, with a
+                     * single field inversion, and returns whether all the elements lie in Gt.
+                     */
+                    template<typename InputIterator, typename RandomAccessIterator>
+                    static bool decompress(InputIterator first, InputIterator last, RandomAccessIterator out) {
+                        const compressed_type v = non_residue();
+                        std::vector<compressed_type> d;
+                        d.reserve(std::distance(first, last));
+                        for (InputIterator it = first; it != last; ++it) {
+                            // v is not a square in the compressed field, so c^2 - v never vanishes
+                            d.emplace_back(it->squared() - v);
+                        }
+                        detail::batch_inverse(d);
+
+                        std::size_t i = 0;
+                        for (InputIterator it = first; it != last; ++it, ++i) {
+                            out[i] = *it == compressed_type::zero() ? gt_value_type::one() : expand(*it, d[i]);
+                        }
+
+                        std::vector<char> in_subgroup(d.size());
+                        executor::current().parallel_for(d.size(), [&](const std::size_t j) {
+                            in_subgroup[j] = is_in_subgroup(out[j]);
+                        });
+                        return std::find(in_subgroup.begin(), in_subgroup.end(), 0) == in_subgroup.end();
+                    }
+
+                    /**
+                     * The number of bytes of a compressed element: its coefficients over the base field,
+                     * each encoded as the base field elements of the transcript.
+                     */
+                    static std::size_t element_size() {
+                        return compressed_field_type::arity * bincode::template get_element_size<base_field_type>();
+                    }
+
+                    template<typename OutputIterator>
+                    static void to_bytes(const compressed_type &c, OutputIterator first, OutputIterator last) {
+                        BOOST_ASSERT(std::distance(first, last) == element_size());
+                        coefficients_to_bytes<compressed_field_type>(c, first);
+                    }
+
+                    /**
+                     * Reads a compressed element, checking only its encoding: whether it stands for an
+                     * element of Gt is checked by its decompression.
+                     */
+                    template<typename InputIterator>
+                    static std::pair<bool, compressed_type> from_bytes(InputIterator first, InputIterator last) {
+                        BOOST_ASSERT(std::distance(first, last) == element_size());
+                        compressed_type c;
+                        bool valid = coefficients_from_bytes<compressed_field_type>(c, first);
+                        return std::make_pair(valid, c);
+                    }
+
+                private:
+                    /* (c + w) / (c - w) = (c^2 + v + 2 c w) / (c^2 - v), given the inverse of c^2 - v */
+                    static gt_value_type expand(const compressed_type &c, const compressed_type &d_inv) {
+                        const compressed_type c2 = c.squared();
+                        return gt_value_type((c2 + non_residue()) * d_inv, (c + c) * d_inv);
+                    }
+
+                    template<typename FieldType, typename OutputIterator>
+                    static typename std::enable_if<std::is_same<base_field_type, FieldType>::value>::type
+                        coefficients_to_bytes(const typename FieldType::value_type &x, OutputIterator &out) {
+                        const std::size_t size = bincode::template get_element_size<base_field_type>();
+                        bincode::template field_element_to_bytes<base_field_type>(x, out, out + size);
+                        out += size;
+                    }
+
+                    template<typename FieldType, typename OutputIterator>
+                    static typename std::enable_if<!std::is_same<base_field_type, FieldType>::value>::type
+                        coefficients_to_bytes(const typename FieldType::value_type &x, OutputIterator &out) {
+                        typedef typename FieldType::underlying_field_type underlying_field_type;
+                        for (std::size_t i = 0; i < FieldType::arity / underlying_field_type::arity; ++i) {
+                            coefficients_to_bytes<underlying_field_type>(x.data[i], out);
+                        }
+                    }
+
+                    template<typename FieldType, typename InputIterator>
+                    static typename std::enable_if<std::is_same<base_field_type, FieldType>::value, bool>::type
+                        coefficients_from_bytes(typename FieldType::value_type &x, InputIterator &in) {
+                        const std::size_t size = bincode::template get_element_size<base_field_type>();
+                        std::pair<bool, typename base_field_type::value_type> read =
+                            bincode::template field_element_from_bytes<base_field_type>(in, in + size);
+                        in += size;
+                        x = read.second;
+                        return read.first;
+                    }
+
+                    template<typename FieldType, typename InputIterator>
+                    static typename std::enable_if<!std::is_same<base_field_type, FieldType>::value, bool>::type
+                        coefficients_from_bytes(typename FieldType::value_type &x, InputIterator &in) {
+                        typedef typename FieldType::underlying_field_type underlying_field_type;
+                        bool valid = true;
+                        for (std::size_t i = 0; i < FieldType::arity / underlying_field_type::arity; ++i) {
+                            valid = coefficients_from_bytes<underlying_field_type>(x.data[i], in) && valid;
+                        }
+                        return valid;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_GT_COMPRESSION_HPP
@@ -0,0 +1,255 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the multi-exponentiation in Gt.
+//
+//
+// The aggregate verifier raises elements of Gt, outputs of a final exponentiation, to
+// transcript challenges and random coefficients. They lie in the cyclotomic subgroup of
+// the extension field, where a squaring is much cheaper than a general one, and all the
+// products of a check are multiplied together in the end. gt_multiexp computes such a
+// product with Straus' method: the multiples 1, ..., 2^window - 1 of every base, then one
+// cyclotomic squaring per bit shared by all the bases, and one multiplication per non-zero
+// window digit of every exponent. Several products whose bases share the exponents, such
+// as the commitments folded by one challenge per round, share the window digits as well.
+//
+// The bases may come from a proof, and cyclotomic squaring gives wrong results outside of
+// the cyclotomic subgroup, so every base is first checked to be in it: x^{Phi_k(p)} = 1
+// for the embedding degree k, which costs two Frobenius maps and a multiplication. When
+// a base is not, or k is not one of 4, 6 and 12, the squarings are generic ones.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_GT_MULTIEXP_HPP
+#define CRYPTO3_ZK_GT_MULTIEXP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    /* the degree of a field element type over its prime field, 1 for the prime field */
+                    template<typename FieldValueType, typename = void>
+                    struct extension_degree : std::integral_constant<std::size_t, 1> { };
+
+                    template<typename FieldValueType>
+                    struct extension_degree<
+                        FieldValueType,
+                        typename std::enable_if<std::is_class<typename FieldValueType::underlying_type>::value>::type>
+                        : std::integral_constant<
+                              std::size_t,
+                              std::tuple_size<typename FieldValueType::data_type>::value *
+                                  extension_degree<typename FieldValueType::underlying_type>::value> { };
+
+                    /* whether x lies in the cyclotomic subgroup, of order Phi_k(p) for the degree k of x */
+                    template<typename GTValueType>
+                    bool is_cyclotomic(const GTValueType &x, std::integral_constant<std::size_t, 4>) {
+                        return x.Frobenius_map(2) * x == GTValueType::one();
+                    }
+
+                    template<typename GTValueType>
+                    bool is_cyclotomic(const GTValueType &x, std::integral_constant<std::size_t, 6>) {
+                        return x.Frobenius_map(2) * x == x.Frobenius_map(1);
+                    }
+
+                    template<typename GTValueType>
+                    bool is_cyclotomic(const GTValueType &x, std::integral_constant<std::size_t, 12>) {
+                        return x.Frobenius_map(4) * x == x.Frobenius_map(2);
+                    }
+
+                    template<typename GTValueType, std::size_t Degree>
+                    bool is_cyclotomic(const GTValueType &, std::integral_constant<std::size_t, Degree>) {
+                        return false;
+                    }
+
+                    template<typename GTValueType>
+                    bool is_cyclotomic(const GTValueType &x) {
+                        return is_cyclotomic(x, extension_degree<GTValueType>());
+                    }
+
+                    /**
+                     * Stores the num_digits window digits of scalar, the most significant first, in digits.
+                     */
+                    template<typename ScalarFieldType>
+                    void gt_window_digits(const typename ScalarFieldType::value_type &scalar, const std::size_t window,
+                                          const std::size_t num_digits, std::uint8_t *digits) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+
+                        const integral_type value(scalar.data);
+                        for (std::size_t j = 0; j < num_digits; ++j) {
+                            const std::size_t bit = (num_digits - 1 - j) * window;
+                            std::uint8_t digit = 0;
+                            for (std::size_t k = 0; k < window; ++k) {
+                                if (multiprecision::bit_test(value, bit + k)) {
+                                    digit |= std::uint8_t(1) << k;
+                                }
+                            }
+                            digits[j] = digit;
+                        }
+                    }
+
+                    /**
+                     * Straus' method over the bases [bases_first, bases_last), the digits of the i-th
+                     * exponent starting at digits + i * num_digits. The squarings are cyclotomic ones
+                     * when the bases all lie in the cyclotomic subgroup.
+                     */
+                    template<typename InputGTIterator>
+                    typename std::iterator_traits<InputGTIterator>::value_type
+                        gt_straus(InputGTIterator bases_first, InputGTIterator bases_last, const std::uint8_t *digits,
+                                  const std::size_t num_digits, const std::size_t window, const bool cyclotomic) {
+                        typedef typename std::iterator_traits<InputGTIterator>::value_type gt_value_type;
+
+                        const std::size_t n = std::distance(bases_first, bases_last);
+                        const std::size_t num_multiples = (std::size_t(1) << window) - 1;
+                        std::vector<gt_value_type> multiples(n * num_multiples);
+                        for (std::size_t i = 0; i < n; ++i) {
+                            gt_value_type *base_multiples = multiples.data() + i * num_multiples;
+                            base_multiples[0] = *(bases_first + i);
+                            for (std::size_t d = 1; d < num_multiples; ++d) {
+                                base_multiples[d] = base_multiples[d - 1] * base_multiples[0];
+                            }
+                        }
+
+                        gt_value_type result = gt_value_type::one();
+                        bool started = false;
+                        for (std::size_t j = 0; j < num_digits; ++j) {
+                            if (started) {
+                                for (std::size_t k = 0; k < window; ++k) {
+                                    result = cyclotomic ? result.cyclotomic_squared() : result.squared();
+                                }
+                            }
+                            for (std::size_t i = 0; i < n; ++i) {
+                                const std::uint8_t digit = digits[i * num_digits + j];
+                                if (digit) {
+                                    result = result * multiples[i * num_multiples + digit - 1];
+                                    started = true;
+                                }
+                            }
+                        }
+
+                        return result;
+                    }
+                }    // namespace detail
+
+                /**
+                 * Returns, for every range bases[k], the product of *(bases[k].begin() + i) raised to
+                 * *(scalars_first + i). All the ranges have the same size. Their elements are expected
+                 * in the cyclotomic subgroup, as the outputs of a final exponentiation are, and are
+                 * checked to be; any that is not makes the squarings generic. The bases are split into
+                 * blocks run on the current executor.
+                 */
+                template<typename ScalarFieldType, typename BasesRange, typename InputFieldIterator>
+                std::vector<typename std::iterator_traits<typename BasesRange::value_type::const_iterator>::value_type>
+                    gt_multiexp(const BasesRange &bases, InputFieldIterator scalars_first,
+                                const std::size_t window = 4) {
+                    typedef typename std::iterator_traits<typename BasesRange::value_type::const_iterator>::value_type
+                        gt_value_type;
+
+                    BOOST_ASSERT(window > 0 && window <= 8);
+
+                    const std::size_t num_products = std::distance(std::begin(bases), std::end(bases));
+                    std::vector<gt_value_type> result(num_products, gt_value_type::one());
+                    if (!num_products) {
+                        return result;
+                    }
+                    const std::size_t n = std::begin(bases)->size();
+                    for (const auto &range : bases) {
+                        BOOST_ASSERT(range.size() == n);
+                    }
+                    if (!n) {
+                        return result;
+                    }
+
+                    std::vector<char> in_subgroup(num_products * n);
+                    executor::current().parallel_for(in_subgroup.size(), [&](const std::size_t task) {
+                        in_subgroup[task] =
+                            detail::is_cyclotomic(*(std::next(std::begin(bases), task / n)->begin() + task % n));
+                    });
+                    const bool cyclotomic =
+                        std::all_of(in_subgroup.begin(), in_subgroup.end(), [](const char c) { return c != 0; });
+
+                    const std::size_t num_digits = (ScalarFieldType::value_bits + window - 1) / window;
+                    std::vector<std::uint8_t> digits(n * num_digits);
+                    executor::current().parallel_for(n, [&](const std::size_t i) {
+                        detail::gt_window_digits<ScalarFieldType>(*(scalars_first + i), window, num_digits,
+                                                                  digits.data() + i * num_digits);
+                    });
+
+                    /* enough blocks per product to occupy the threads, every block sharing its squarings */
+                    const std::size_t concurrency = executor::current().concurrency();
+                    const std::size_t num_blocks =
+                        std::min(n, std::max<std::size_t>(1, (concurrency + num_products - 1) / num_products));
+                    const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                    std::vector<gt_value_type> parts(num_products * num_blocks, gt_value_type::one());
+                    executor::current().bulk(parts.size(), [&](const std::size_t task) {
+                        const std::size_t first = std::min(n, (task % num_blocks) * block_size);
+                        const std::size_t last = std::min(n, first + block_size);
+                        if (first == last) {
+                            return;
+                        }
+                        const auto range_first = std::next(std::begin(bases), task / num_blocks)->begin();
+                        parts[task] = detail::gt_straus(range_first + first, range_first + last,
+                                                        digits.data() + first * num_digits, num_digits, window,
+                                                        cyclotomic);
+                    });
+
+                    for (std::size_t task = 0; task < parts.size(); ++task) {
+                        result[task / num_blocks] = result[task / num_blocks] * parts[task];
+                    }
+                    return result;
+                }
+
+                /**
+                 * Returns the product of *(bases_first + i) raised to *(scalars_first + i) for the bases
+                 * in [bases_first, bases_last), expected in the cyclotomic subgroup.
+                 */
+                template<typename ScalarFieldType, typename InputGTIterator, typename InputFieldIterator>
+                typename std::iterator_traits<InputGTIterator>::value_type
+                    gt_multiexp(InputGTIterator bases_first, InputGTIterator bases_last,
+                                InputFieldIterator scalars_first, const std::size_t window = 4) {
+                    typedef typename std::iterator_traits<InputGTIterator>::value_type gt_value_type;
+
+                    const std::vector<std::vector<gt_value_type>> bases = {
+                        std::vector<gt_value_type>(bases_first, bases_last)};
+                    return gt_multiexp<ScalarFieldType>(bases, scalars_first, window).front();
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_GT_MULTIEXP_HPP
@@ -0,0 +1,219 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the huge page backing of proving key queries and reduction buffers.
+//
+// The bucket accumulation of a multi-exponentiation reads its bases over gigabytes of
+// H_query and L_query, and the butterflies of an FFT stride across the whole domain; with
+// 4 KB pages most of these accesses miss the TLB. Backed by huge pages of 2 MB or 1 GB, the
+// same vectors take a few hundred TLB entries.
+//
+// Vectors the library allocates itself, the evaluation vectors of the witness maps and the
+// coefficients of H among them, are reserved with reserve_with_huge_pages, which asks the
+// kernel for transparent huge pages (madvise(MADV_HUGEPAGE)) before any element is written.
+// It only acts while huge_page_policy::current() is enabled, so the default leaves the
+// allocations as they are:
+//
+//     huge_page_policy::current().enabled = true;
+//     advise_proving_key_huge_pages(pk);
+//     proof = prove<scheme_type>(pk, primary_input, auxiliary_input);
+//
+// Containers of a type of their own can take huge_page_allocator, which maps explicit huge
+// pages (MAP_HUGETLB) from the reserved pool of the host and falls back to transparent huge
+// pages, then to normal pages, when the pool is empty. Everything falls back to normal
+// pages outside Linux. A memory-mapped proving key is advised in the same way, see
+// mapped_proving_key.hpp.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_HUGE_PAGES_HPP
+#define CRYPTO3_ZK_HUGE_PAGES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                constexpr const std::size_t huge_page_2mb = std::size_t(1) << 21;
+                constexpr const std::size_t huge_page_1gb = std::size_t(1) << 30;
+
+                /**
+                 * Whether the library backs its own large vectors with huge pages, and from which size.
+                 */
+                struct huge_page_policy {
+                    bool enabled = false;
+                    std::size_t min_size = huge_page_2mb;
+
+                    static huge_page_policy &current() {
+                        static huge_page_policy policy;
+                        return policy;
+                    }
+                };
+
+                /**
+                 * Asks for transparent huge pages over the 2 MB aligned part of [data, data + size).
+                 * Returns whether the kernel accepted the advice; the data is unchanged either way.
+                 */
+                inline bool advise_huge_pages(const void *data, const std::size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+                    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data);
+                    const std::uintptr_t first = (address + huge_page_2mb - 1) / huge_page_2mb * huge_page_2mb;
+                    const std::uintptr_t last = (address + size) / huge_page_2mb * huge_page_2mb;
+                    return first < last && madvise(reinterpret_cast<void *>(first), last - first, MADV_HUGEPAGE) == 0;
+#else
+                    (void)data;
+                    (void)size;
+                    return false;
+#endif
+                }
+
+                template<typename ValueType>
+                bool advise_huge_pages(const std::vector<ValueType> &values) {
+                    return advise_huge_pages(values.data(), values.capacity() * sizeof(ValueType));
+                }
+
+                /**
+                 * Makes room for size elements in values, to be written next, with huge pages when
+                 * huge_page_policy::current() asks for them. A vector already holding that room is left
+                 * as it is; otherwise it is emptied first, so that no element is written before the
+                 * advice.
+                 */
+                template<typename ValueType>
+                void reserve_with_huge_pages(std::vector<ValueType> &values, const std::size_t size) {
+                    const huge_page_policy &policy = huge_page_policy::current();
+                    if (!policy.enabled || values.capacity() >= size || size * sizeof(ValueType) < policy.min_size) {
+                        return;
+                    }
+                    std::vector<ValueType>().swap(values);
+                    values.reserve(size);
+                    advise_huge_pages(values);
+                }
+
+                /**
+                 * Asks for transparent huge pages over the queries of a proving key with A_query,
+                 * B_query, H_query and L_query members, such as the one of r1cs_gg_ppzksnark. The
+                 * kernel collapses their pages in the background.
+                 */
+                template<typename ProvingKeyType>
+                bool advise_proving_key_huge_pages(const ProvingKeyType &proving_key) {
+                    bool result = advise_huge_pages(proving_key.A_query);
+                    result &= advise_huge_pages(proving_key.B_query.values);
+                    result &= advise_huge_pages(proving_key.H_query);
+                    result &= advise_huge_pages(proving_key.L_query);
+                    return result;
+                }
+
+                /**
+                 * Allocator of explicit huge pages of PageSize bytes, 2 MB or 1 GB, for allocations of
+                 * at least one page; smaller ones, and those the pool of the host cannot serve, fall
+                 * back to transparent huge pages or to operator new.
+                 */
+                template<typename ValueType, std::size_t PageSize = huge_page_2mb>
+                struct huge_page_allocator {
+                    typedef ValueType value_type;
+
+                    template<typename OtherType>
+                    struct rebind {
+                        typedef huge_page_allocator<OtherType, PageSize> other;
+                    };
+
+                    huge_page_allocator() = default;
+
+                    template<typename OtherType>
+                    huge_page_allocator(const huge_page_allocator<OtherType, PageSize> &) {
+                    }
+
+                    ValueType *allocate(const std::size_t n) {
+                        const std::size_t size = n * sizeof(ValueType);
+#ifdef __linux__
+                        if (size >= PageSize) {
+                            const std::size_t length = mapped_length(size);
+                            void *data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+                            data = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_size_flag(), -1, 0);
+#endif
+                            if (data == MAP_FAILED) {
+                                data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                                            0);
+                                if (data != MAP_FAILED) {
+                                    advise_huge_pages(data, length);
+                                }
+                            }
+                            if (data == MAP_FAILED) {
+                                throw std::bad_alloc();
+                            }
+                            return static_cast<ValueType *>(data);
+                        }
+#endif
+                        return static_cast<ValueType *>(::operator new(size));
+                    }
+
+                    void deallocate(ValueType *data, const std::size_t n) {
+                        const std::size_t size = n * sizeof(ValueType);
+#ifdef __linux__
+                        if (size >= PageSize) {
+                            munmap(data, mapped_length(size));
+                            return;
+                        }
+#endif
+                        ::operator delete(data);
+                    }
+
+                    bool operator==(const huge_page_allocator &) const {
+                        return true;
+                    }
+
+                    bool operator!=(const huge_page_allocator &) const {
+                        return false;
+                    }
+
+                private:
+                    static std::size_t mapped_length(const std::size_t size) {
+                        return (size + PageSize - 1) / PageSize * PageSize;
+                    }
+
+                    /* the page size of MAP_HUGETLB, log2(PageSize) << MAP_HUGE_SHIFT */
+                    static int page_size_flag() {
+                        int log_page_size = 0;
+                        while ((std::size_t(1) << log_page_size) < PageSize) {
+                            ++log_page_size;
+                        }
+                        return log_page_size << 26;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_HUGE_PAGES_HPP
@@ -0,0 +1,138 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a read-only view of contiguous field elements.
+//
+// Primary and auxiliary inputs often live in memory the prover or the verifier
+// does not own: a network buffer, a shared memory segment or one slice of a
+// larger assignment. An input span refers to such elements in place, and any
+// contiguous container converts to it, so a function taking spans serves
+// std::vector arguments as before and foreign buffers without a copy.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_INPUT_SPAN_HPP
+#define CRYPTO3_ZK_SNARK_INPUT_SPAN_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <boost/assert.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A view of count elements of type T stored back to back from data. The elements are
+                 * neither owned nor copied, so they have to outlive the span.
+                 */
+                template<typename T>
+                class input_span {
+                public:
+                    typedef T value_type;
+                    typedef std::size_t size_type;
+                    typedef const T &reference;
+                    typedef const T &const_reference;
+                    typedef const T *pointer;
+                    typedef const T *iterator;
+                    typedef const T *const_iterator;
+
+                    input_span() : elements(nullptr), count(0) {
+                    }
+
+                    input_span(const T *data, std::size_t size) : elements(data), count(size) {
+                    }
+
+                    input_span(const T *first, const T *last) : elements(first), count(last - first) {
+                    }
+
+                    /**
+                     * View of a contiguous container such as std::vector or std::array.
+                     */
+                    template<typename Container,
+                             typename = typename std::enable_if<std::is_convertible<
+                                 decltype(std::declval<const Container &>().data()), const T *>::value>::type>
+                    input_span(const Container &container) : elements(container.data()), count(container.size()) {
+                    }
+
+                    const T *data() const {
+                        return elements;
+                    }
+
+                    std::size_t size() const {
+                        return count;
+                    }
+
+                    bool empty() const {
+                        return count == 0;
+                    }
+
+                    const T *begin() const {
+                        return elements;
+                    }
+
+                    const T *end() const {
+                        return elements + count;
+                    }
+
+                    const T &operator[](std::size_t i) const {
+                        return elements[i];
+                    }
+
+                    /**
+                     * The n elements from offset on, or all those after offset if n is left out.
+                     */
+                    input_span subspan(std::size_t offset, std::size_t n = std::size_t(-1)) const {
+                        BOOST_ASSERT(offset <= count);
+                        return input_span(elements + offset, std::min(n, count - offset));
+                    }
+
+                private:
+                    const T *elements;
+                    std::size_t count;
+                };
+
+                /**
+                 * Sets joined to the view of first followed by second and returns true when the two
+                 * are adjacent in memory, e.g. the primary and the auxiliary part of one assignment
+                 * buffer. Returns false, leaving joined unchanged, otherwise.
+                 */
+                template<typename T>
+                bool join_adjacent(const input_span<T> &first, const input_span<T> &second, input_span<T> &joined) {
+                    if (first.empty() || second.empty() || first.end() == second.begin()) {
+                        joined = first.empty() ? second :
+                                 input_span<T>(first.data(), first.size() + second.size());
+                        return true;
+                    }
+                    return false;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_INPUT_SPAN_HPP
@@ -27,50 +27,182 @@
 #define CRYPTO3_ZK_SNARK_INTEGER_PERMUTATION_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <vector>
-#include <unordered_set>
 #include <numeric>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
             namespace snark {
-                class integer_permutation {
+                template<typename IndexType>
+                class basic_integer_permutation;
+
+                /**
+                 * Non-owning view of a permutation of [min_element .. max_element] whose image of
+                 * position p is contents[p - min_element]. Slicing a view does not copy the elements.
+                 */
+                template<typename IndexType>
+                class integer_permutation_view {
+                private:
+                    const IndexType *contents;
+
+                public:
+                    typedef IndexType index_type;
+
+                    std::size_t min_element;
+                    std::size_t max_element;
+
+                    integer_permutation_view(const IndexType *contents, const std::size_t min_element,
+                                             const std::size_t max_element) :
+                        contents(contents),
+                        min_element(min_element), max_element(max_element) {
+                        assert(min_element <= max_element);
+                    }
+
+                    std::size_t size() const {
+                        return max_element - min_element + 1;
+                    }
+
+                    const IndexType *data() const {
+                        return contents;
+                    }
+
+                    std::size_t get(const std::size_t position) const {
+                        assert(min_element <= position && position <= max_element);
+                        return contents[position - min_element];
+                    }
+
+                    integer_permutation_view slice(const std::size_t slice_min_element,
+                                                   const std::size_t slice_max_element) const {
+                        assert(min_element <= slice_min_element && slice_min_element <= slice_max_element &&
+                               slice_max_element <= max_element);
+                        return integer_permutation_view(contents + (slice_min_element - min_element),
+                                                        slice_min_element, slice_max_element);
+                    }
+
+                    /**
+                     * Whether every element lies in [min_element .. max_element] and appears once. The
+                     * elements are split across the current executor, which share one bitmap of seen
+                     * elements.
+                     */
+                    bool is_valid() const {
+                        const std::size_t n = size();
+                        std::vector<std::atomic<std::uint64_t>> seen((n + 63) / 64);
+
+                        const std::size_t num_blocks =
+                            std::max<std::size_t>(1, std::min(n, executor::current().concurrency()));
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                        std::vector<char> valid(num_blocks, true);
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t end = std::min(n, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                const std::size_t element = contents[i];
+                                if (element < min_element || element > max_element) {
+                                    valid[block] = false;
+                                    return;
+                                }
+                                const std::size_t bit = element - min_element;
+                                const std::uint64_t mask = std::uint64_t(1) << (bit % 64);
+                                if (seen[bit / 64].fetch_or(mask, std::memory_order_relaxed) & mask) {
+                                    valid[block] = false;
+                                    return;
+                                }
+                            }
+                        });
+
+                        return std::find(valid.begin(), valid.end(), false) == valid.end();
+                    }
+
+                    /**
+                     * Writes the inverse permutation, offset by min_element as well, to the size()
+                     * elements at out, across the current executor.
+                     */
+                    template<typename OutputIndexType>
+                    void inverse(OutputIndexType *out) const {
+                        executor::current().parallel_for(size(), [&](const std::size_t i) {
+                            out[contents[i] - min_element] = OutputIndexType(min_element + i);
+                        });
+                    }
+
+                    basic_integer_permutation<IndexType> inverse() const {
+                        basic_integer_permutation<IndexType> result(min_element, max_element);
+                        inverse(result.data().data());
+#ifdef DEBUG
+                        assert(result.is_valid());
+#endif
+
+                        return result;
+                    }
+                };
+
+                /**
+                 * Permutation of [min_element .. max_element] storing its elements as IndexType,
+                 * which must be wide enough for max_element. integer_permutation has std::size_t
+                 * elements and compact_integer_permutation has 32-bit ones, half the memory for up
+                 * to 2^32 packets.
+                 */
+                template<typename IndexType>
+                class basic_integer_permutation {
                 private:
-                    std::vector<std::size_t> contents; /* offset by min_element */
+                    std::vector<IndexType> contents; /* offset by min_element */
 
                 public:
+                    typedef IndexType index_type;
+                    typedef integer_permutation_view<IndexType> view_type;
+
                     std::size_t min_element;
                     std::size_t max_element;
 
-                    integer_permutation(const std::size_t size = 0) : min_element(0), max_element(size - 1) {
+                    basic_integer_permutation(const std::size_t size = 0) : min_element(0), max_element(size - 1) {
+                        assert(!size || max_element <= std::numeric_limits<IndexType>::max());
                         contents.resize(size);
                         std::iota(contents.begin(), contents.end(), 0);
                     }
-                    integer_permutation(const std::size_t min_element, const std::size_t max_element) :
+                    basic_integer_permutation(const std::size_t min_element, const std::size_t max_element) :
                         min_element(min_element), max_element(max_element) {
                         assert(min_element <= max_element);
+                        assert(max_element <= std::numeric_limits<IndexType>::max());
                         const std::size_t size = max_element - min_element + 1;
                         contents.resize(size);
                         std::iota(contents.begin(), contents.end(), min_element);
                     }
 
-                    integer_permutation &operator=(const integer_permutation &other) = default;
+                    /**
+                     * Copy of a permutation with another element width, which must hold its elements.
+                     */
+                    template<typename OtherIndexType>
+                    explicit basic_integer_permutation(const basic_integer_permutation<OtherIndexType> &other) :
+                        contents(other.data().begin(), other.data().end()), min_element(other.min_element),
+                        max_element(other.max_element) {
+                        assert(!contents.size() || max_element <= std::numeric_limits<IndexType>::max());
+                    }
+
+                    basic_integer_permutation &operator=(const basic_integer_permutation &other) = default;
 
                     std::size_t size() const {
                         return max_element - min_element + 1;
                     }
 
-                    std::vector<std::size_t> &data() {
+                    std::vector<IndexType> &data() {
                         return contents;
                     }
 
-                    const std::vector<std::size_t> &data() const {
+                    const std::vector<IndexType> &data() const {
                         return contents;
                     }
 
-                    bool operator==(const integer_permutation &other) const {
+                    view_type view() const {
+                        return view_type(contents.data(), min_element, max_element);
+                    }
+
+                    bool operator==(const basic_integer_permutation &other) const {
                         return (this->min_element == other.min_element && this->max_element == other.max_element &&
                                 this->contents == other.contents);
                     }
@@ -85,38 +217,18 @@ namespace nil {
                     }
 
                     bool is_valid() const {
-                        std::unordered_set<std::size_t> elems;
-
-                        for (auto &el : contents) {
-                            if (el < min_element || el > max_element || elems.find(el) != elems.end()) {
-                                return false;
-                            }
-
-                            elems.insert(el);
-                        }
-
-                        return true;
+                        return view().is_valid();
                     }
 
-                    integer_permutation inverse() const {
-                        integer_permutation result(min_element, max_element);
-
-                        for (std::size_t position = min_element; position <= max_element; ++position) {
-                            result.contents[this->contents[position - min_element] - min_element] = position;
-                        }
-
-#ifdef DEBUG
-                        assert(result.is_valid());
-#endif
-
-                        return result;
+                    basic_integer_permutation inverse() const {
+                        return view().inverse();
                     }
 
-                    integer_permutation slice(const std::size_t slice_min_element,
-                                              const std::size_t slice_max_element) const {
+                    basic_integer_permutation slice(const std::size_t slice_min_element,
+                                                    const std::size_t slice_max_element) const {
                         assert(min_element <= slice_min_element && slice_min_element <= slice_max_element &&
                                slice_max_element <= max_element);
-                        integer_permutation result(slice_min_element, slice_max_element);
+                        basic_integer_permutation result(slice_min_element, slice_max_element);
                         std::copy(this->contents.begin() + (slice_min_element - min_element),
                                   this->contents.begin() + (slice_max_element - min_element) + 1,
                                   result.contents.begin());
@@ -127,6 +239,15 @@ namespace nil {
                         return result;
                     }
 
+                    /**
+                     * The elements of [slice_min_element .. slice_max_element], as a view into this
+                     * permutation instead of the copy slice makes.
+                     */
+                    view_type slice_view(const std::size_t slice_min_element,
+                                         const std::size_t slice_max_element) const {
+                        return view().slice(slice_min_element, slice_max_element);
+                    }
+
                     /* Similarly to std::next_permutation this transforms the current
                     integer permutation into the next lexicographically ordered
                     permutation; returns false if the last permutation was reached and
@@ -139,6 +260,9 @@ namespace nil {
                         return std::random_shuffle(contents.begin(), contents.end());
                     }
                 };
+
+                typedef basic_integer_permutation<std::size_t> integer_permutation;
+                typedef basic_integer_permutation<std::uint32_t> compact_integer_permutation;
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -0,0 +1,173 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the job control cancelling and reporting the progress of long-running calls.
+//
+// Generating keys or proving a large circuit takes minutes. A job_control is a stage sink
+// (see stage_profiler.hpp) installed for the duration of such a call, which
+// - abandons the call by throwing operation_cancelled at the next stage boundary or after
+//   the next multi-exponentiation task list, once its cancellation token is cancelled or
+//   its deadline has passed; the pending tasks of a task list are skipped right away;
+// - reports the progress of the call to a callback, with the completed and total units of
+//   work of a stage, from the multi-exponentiation task lists and at the end of every stage.
+//
+//     job_options options;
+//     options.deadline = job_options::clock_type::now() + std::chrono::seconds(30);
+//     options.progress = [](const std::string &stage, std::size_t completed, std::size_t total) { ... };
+//     proof = job_control::run(options, [&]() { return prove<scheme_type>(pk, primary_input, auxiliary_input); });
+//
+// The options also carry the memory budget the call runs within, see memory_budget.hpp.
+// The asynchronous calls of algorithms/async.hpp run under a job control on a thread of
+// their own. The progress callback may be called concurrently from the threads of the
+// current executor, though never twice at once. Nothing is checked or reported with
+// CRYPTO3_ZK_DISABLE_STAGE_PROFILER, except by the task lists.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_JOB_CONTROL_HPP
+#define CRYPTO3_ZK_JOB_CONTROL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/memory_budget.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Thrown out of a call run under a job control that was cancelled or ran past its deadline.
+                 */
+                class operation_cancelled : public std::runtime_error {
+                public:
+                    using std::runtime_error::runtime_error;
+                };
+
+                /**
+                 * A flag shared by its copies: the scheduler keeps one copy to cancel the jobs given the
+                 * others.
+                 */
+                class cancellation_token {
+                public:
+                    cancellation_token() : flag(std::make_shared<std::atomic<bool>>(false)) {
+                    }
+
+                    void cancel() const {
+                        flag->store(true);
+                    }
+
+                    bool cancelled() const {
+                        return flag->load();
+                    }
+
+                private:
+                    std::shared_ptr<std::atomic<bool>> flag;
+                };
+
+                struct job_options {
+                    typedef std::chrono::steady_clock clock_type;
+                    typedef std::function<void(const std::string &, std::size_t, std::size_t)> progress_type;
+
+                    cancellation_token token;
+                    clock_type::time_point deadline = clock_type::time_point::max();
+                    /* called with the stage path and its completed and total units of work, if set */
+                    progress_type progress;
+                    /* installed as the current memory budget of the job, see memory_budget.hpp */
+                    memory_budget memory;
+                };
+
+                class job_control : public stage_sink {
+                public:
+                    explicit job_control(job_options options) : options(std::move(options)) {
+                    }
+
+                    job_control(const job_control &) = delete;
+                    job_control &operator=(const job_control &) = delete;
+
+                    /**
+                     * Runs f() under a job control with the given options, on the calling thread.
+                     */
+                    template<typename Function>
+                    static auto run(job_options options, Function f) -> decltype(f()) {
+                        job_control control(std::move(options));
+                        stage_profiler::scope guard(control);
+                        memory_budget::scope budget_guard(control.options.memory);
+                        control.checkpoint();
+                        auto result = f();
+                        // the tasks skipped once cancelled may have left the result incomplete
+                        control.checkpoint();
+                        return result;
+                    }
+
+                    void begin(const std::string &, std::size_t) override {
+                        checkpoint();
+                    }
+
+                    void end(const std::string &path, const std::size_t size, double) override {
+                        report(path, size ? size : 1, size ? size : 1);
+                    }
+
+                    void progress(const std::string &path, const std::size_t completed,
+                                  const std::size_t total) override {
+                        report(path, completed, total);
+                    }
+
+                    bool cancelled() const override {
+                        return options.token.cancelled() || job_options::clock_type::now() >= options.deadline;
+                    }
+
+                    void checkpoint() override {
+                        if (executor::in_task() || !cancelled()) {
+                            return;
+                        }
+                        throw operation_cancelled(options.token.cancelled() ? "operation cancelled" :
+                                                                              "deadline exceeded");
+                    }
+
+                private:
+                    void report(const std::string &path, const std::size_t completed, const std::size_t total) {
+                        if (options.progress) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            options.progress(path, completed, total);
+                        }
+                    }
+
+                    const job_options options;
+                    std::mutex mutex;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_JOB_CONTROL_HPP
@@ -0,0 +1,531 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a Merkle tree stored in a memory-mapped file.
+//
+// A binary Merkle tree of depth 32 over hundreds of millions of leaves does not fit
+// in memory as maps or flat arrays of digests. mapped_merkle_tree keeps the nodes in
+// a file laid out in heap order, one packed digest per node, and maps it. The levels
+// down to memory_depth are small and read on every update, so they are also held in
+// memory; the lower levels are only read from the mapping. The file is created
+// sparse: a node never written reads as zero and stands for the default digest of
+// its level, so untouched subtrees take no disk space.
+//
+// Updates are batched and crash-safe. A batch computes every node it changes first,
+// writes them to a journal under a temporary name, syncs it and renames it next to
+// the tree file, then writes them into the tree and removes the journal. Opening a
+// tree replays a journal left over by a crash, after checking its checksum and that
+// every entry lies in the tree, so the file always holds the tree before or after a
+// whole batch. A new tree file is created the same way, under a temporary name, so a
+// crash never leaves one without its header. Reopening reads the upper levels and
+// nothing is rehashed.
+//
+// The layout is tied to the digest size and to the byte order of the build that
+// produced the file.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_MAPPED_MERKLE_TREE_HPP
+#define CRYPTO3_ZK_SNARK_MAPPED_MERKLE_TREE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nil/crypto3/zk/snark/durable_file.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/merkle_tree.hpp>
+#include <nil/crypto3/zk/snark/multi_buffer_hash.hpp>
+#include <nil/crypto3/zk/snark/packed_digest.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A binary Merkle tree with the interface of flat_merkle_tree, whose nodes live in the
+                 * file at path. Constructing it over an existing file reopens the tree stored there,
+                 * which must have the same depth and value size. Addresses outside the tree throw
+                 * std::out_of_range rather than asserting, since a stray write would persist in the file.
+                 */
+                template<typename Hash>
+                class mapped_merkle_tree {
+                public:
+                    typedef typename Hash::digest_type digest_type;
+                    typedef typename Hash::merkle_authentication_path_type merkle_authentication_path_type;
+                    typedef packed_digest<Hash::digest_bits> packed_digest_type;
+
+                    static_assert(std::is_trivially_copyable<packed_digest_type>::value,
+                                  "packed digests must be trivially copyable to be memory-mapped");
+
+                    /* the default number of levels below the root held in memory */
+                    static constexpr const std::size_t default_memory_depth = 20;
+
+                    std::vector<digest_type> hash_defaults;
+
+                    std::size_t depth;
+                    std::size_t value_size;
+                    std::size_t digest_size;
+
+                    mapped_merkle_tree(const std::string &path, const std::size_t depth, const std::size_t value_size,
+                                       const std::size_t memory_depth = default_memory_depth) :
+                        depth(depth),
+                        value_size(value_size), digest_size(Hash::digest_bits),
+                        memory_depth(std::min(depth, memory_depth)), path(path) {
+                        assert(depth < sizeof(std::size_t) * 8 - 1);
+                        assert(value_size <= digest_size);
+
+                        digest_type last(digest_size);
+                        hash_defaults.reserve(depth + 1);
+                        hash_defaults.emplace_back(last);
+                        for (std::size_t i = 0; i < depth; ++i) {
+                            last = two_to_one_CRH<Hash>(last, last);
+                            hash_defaults.emplace_back(last);
+                        }
+                        std::reverse(hash_defaults.begin(), hash_defaults.end());
+
+                        packed_defaults.reserve(depth + 1);
+                        for (std::size_t layer = 0; layer <= depth; ++layer) {
+                            packed_defaults.emplace_back(hash_defaults[layer]);
+                        }
+
+                        open();
+                    }
+
+                    mapped_merkle_tree(const mapped_merkle_tree &) = delete;
+                    mapped_merkle_tree &operator=(const mapped_merkle_tree &) = delete;
+                    mapped_merkle_tree(mapped_merkle_tree &&other) = default;
+                    mapped_merkle_tree &operator=(mapped_merkle_tree &&other) = default;
+
+                    std::vector<bool> get_value(const std::size_t address) const {
+                        check_address(address);
+                        return node(depth, address).to_bits(value_size);
+                    }
+
+                    void set_value(const std::size_t address, const std::vector<bool> &value) {
+                        assert(value.size() == value_size);
+                        set_value(address, packed_digest_type(value));
+                    }
+
+                    /**
+                     * Sets the value at address to the leading value_size bits of value, the other
+                     * bits being zero. Every call is a batch of its own, see set_values.
+                     */
+                    void set_value(const std::size_t address, const packed_digest_type &value) {
+                        check_address(address);
+
+                        std::unordered_map<std::size_t, packed_digest_type> staged;
+                        staged.emplace(node_index(depth, address), value);
+                        update(std::move(staged), {address});
+                    }
+
+                    /**
+                     * Sets every (address, value) of batch as one crash-safe update, hashing each
+                     * ancestor shared by the updated leaves once.
+                     */
+                    void set_values(const std::map<std::size_t, std::vector<bool>> &batch) {
+                        std::unordered_map<std::size_t, packed_digest_type> staged;
+                        std::vector<std::size_t> positions;
+                        positions.reserve(batch.size());
+                        for (const auto &content : batch) {
+                            check_address(content.first);
+                            assert(content.second.size() == value_size);
+                            staged[node_index(depth, content.first)] = packed_digest_type(content.second);
+                            positions.emplace_back(content.first);
+                        }
+                        update(std::move(staged), std::move(positions));
+                    }
+
+                    digest_type get_root() const {
+                        return node(0, 0).to_bits();
+                    }
+
+                    packed_digest_type get_packed_root() const {
+                        return node(0, 0);
+                    }
+
+                    merkle_authentication_path_type get_path(const std::size_t address) const {
+                        const std::vector<packed_digest_type> path = get_packed_path(address);
+                        merkle_authentication_path_type result(depth);
+                        for (std::size_t layer = 0; layer < depth; ++layer) {
+                            result[layer] = path[layer].to_bits();
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Authentication path of address in packed form, ordered as get_path orders it.
+                     */
+                    std::vector<packed_digest_type> get_packed_path(const std::size_t address) const {
+                        check_address(address);
+                        std::vector<packed_digest_type> result(depth);
+
+                        std::size_t position = address;
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            result[layer - 1] = node(layer, position ^ 1);
+                            position /= 2;
+                        }
+
+                        return result;
+                    }
+
+                    /**
+                     * Deduplicated authentication path of the leaves at addresses, see
+                     * merkle_multi_path_root.
+                     */
+                    merkle_authentication_multi_path get_multi_path(std::vector<std::size_t> addresses) const {
+                        std::sort(addresses.begin(), addresses.end());
+                        addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+                        for (const std::size_t address : addresses) {
+                            check_address(address);
+                        }
+
+                        merkle_authentication_multi_path result;
+                        merkle_multi_path_positions(depth, std::move(addresses),
+                                                    [&](const std::size_t layer, const std::size_t position) {
+                                                        result.emplace_back(node(layer, position).to_bits());
+                                                    });
+                        return result;
+                    }
+
+                private:
+                    static constexpr const std::uint64_t magic = 0x45455254454d4e5aULL;            // "ZNMETREE"
+                    static constexpr const std::uint64_t journal_magic = 0x4c4e524a544d4e5aULL;    // "ZNMTJRNL"
+                    static constexpr const std::uint64_t version = 1;
+                    static constexpr const std::size_t alignment = 64;
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t depth;
+                        std::uint64_t value_size;
+                        std::uint64_t digest_bytes;
+                        std::uint64_t file_size;
+                    };
+
+                    /* the journal header is committed, by writing its magic, once its entries are on disk */
+                    struct journal_header_type {
+                        std::uint64_t magic;
+                        std::uint64_t count;
+                        std::uint64_t checksum;
+                    };
+
+                    struct journal_entry_type {
+                        std::uint64_t index;
+                        packed_digest_type digest;
+                    };
+
+                    static std::uint64_t align(std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    /* FNV-1a over the journal entries, so a torn journal is never replayed */
+                    static std::uint64_t checksum(const journal_entry_type *entries, const std::size_t count) {
+                        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(entries);
+                        std::uint64_t result = 0xcbf29ce484222325ULL;
+                        for (std::size_t i = 0; i < count * sizeof(journal_entry_type); ++i) {
+                            result = (result ^ bytes[i]) * 0x100000001b3ULL;
+                        }
+                        return result;
+                    }
+
+                    /* creates a file of size bytes, sparse where it is never written */
+                    static void create_file(const std::string &file_path, const std::uint64_t size) {
+                        std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+                        out.seekp(size - 1);
+                        out.put(0);
+                        out.close();
+                        if (!out) {
+                            throw std::runtime_error("mapped_merkle_tree: cannot write " + file_path);
+                        }
+                    }
+
+                    static bool file_exists(const std::string &file_path) {
+                        return std::ifstream(file_path).good();
+                    }
+
+                    std::string journal_path() const {
+                        return path + ".journal";
+                    }
+
+                    void check_address(const std::size_t address) const {
+                        if (address >= (std::size_t(1) << depth)) {
+                            throw std::out_of_range("mapped_merkle_tree: address out of range");
+                        }
+                    }
+
+                    std::size_t num_nodes() const {
+                        return (std::size_t(2) << depth) - 1;
+                    }
+
+                    std::size_t node_index(const std::size_t layer, const std::size_t position) const {
+                        return (std::size_t(1) << layer) - 1 + position;
+                    }
+
+                    std::uint64_t nodes_offset() const {
+                        return align(sizeof(header_type));
+                    }
+
+                    packed_digest_type *stored_nodes() {
+                        return reinterpret_cast<packed_digest_type *>(static_cast<char *>(region.get_address()) +
+                                                                      nodes_offset());
+                    }
+
+                    const packed_digest_type *stored_nodes() const {
+                        return reinterpret_cast<const packed_digest_type *>(
+                            static_cast<const char *>(region.get_address()) + nodes_offset());
+                    }
+
+                    /* maps the tree file, creating it if needed, and recovers from an interrupted batch */
+                    void open() {
+                        const std::uint64_t file_size =
+                            align(nodes_offset() + num_nodes() * sizeof(packed_digest_type));
+
+                        std::remove((path + ".tmp").c_str());
+                        std::remove((journal_path() + ".tmp").c_str());
+                        if (!file_exists(path)) {
+                            header_type h;
+                            std::memset(&h, 0, sizeof(h));
+                            h.magic = magic;
+                            h.version = version;
+                            h.depth = depth;
+                            h.value_size = value_size;
+                            h.digest_bytes = sizeof(packed_digest_type);
+                            h.file_size = file_size;
+
+                            // a journal left next to an older tree must not be replayed into the new one
+                            const std::string temporary = path + ".tmp";
+                            create_file(temporary, file_size);
+                            std::fstream out(temporary, std::ios::binary | std::ios::in | std::ios::out);
+                            out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+                            out.close();
+                            std::remove(journal_path().c_str());
+                            if (!out || !durable_rename(temporary, path)) {
+                                std::remove(temporary.c_str());
+                                throw std::runtime_error("mapped_merkle_tree: cannot write " + path);
+                            }
+                        }
+
+                        mapping = boost::interprocess::file_mapping(path.c_str(), boost::interprocess::read_write);
+                        region = boost::interprocess::mapped_region(mapping, boost::interprocess::read_write);
+
+                        if (region.get_size() < sizeof(header_type)) {
+                            throw std::runtime_error("mapped_merkle_tree: incompatible file " + path);
+                        }
+                        const header_type &h = *static_cast<const header_type *>(region.get_address());
+                        if (h.magic != magic || h.version != version || h.depth != depth ||
+                            h.value_size != value_size || h.digest_bytes != sizeof(packed_digest_type) ||
+                            h.file_size != file_size || h.file_size != region.get_size()) {
+                            throw std::runtime_error("mapped_merkle_tree: incompatible file " + path);
+                        }
+
+                        replay_journal();
+
+                        const packed_digest_type *nodes = stored_nodes();
+                        upper_nodes.assign(nodes, nodes + node_index(memory_depth + 1, 0));
+                    }
+
+                    /* true if every entry addresses a node of the tree, within the mapped file */
+                    bool entries_in_range(const journal_entry_type *entries, const std::size_t count) const {
+                        const std::uint64_t capacity =
+                            (region.get_size() - nodes_offset()) / sizeof(packed_digest_type);
+                        for (std::size_t i = 0; i < count; ++i) {
+                            if (entries[i].index >= num_nodes() || entries[i].index >= capacity) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    /*
+                     * Applies a journal left over by an interrupted batch, and drops any journal. A
+                     * journal that is torn, or addresses nodes outside the tree, is dropped unapplied.
+                     */
+                    void replay_journal() {
+                        if (!file_exists(journal_path())) {
+                            return;
+                        }
+
+                        const std::uint64_t offset = align(sizeof(journal_header_type));
+                        boost::interprocess::file_mapping journal(journal_path().c_str(),
+                                                                  boost::interprocess::read_only);
+                        boost::interprocess::mapped_region journal_region;
+                        try {
+                            journal_region =
+                                boost::interprocess::mapped_region(journal, boost::interprocess::read_only);
+                        } catch (const boost::interprocess::interprocess_exception &) {
+                            // an empty journal cannot be mapped, and holds nothing to replay
+                        }
+
+                        const std::size_t size = journal_region.get_size();
+                        if (size >= offset) {
+                            const journal_header_type &h =
+                                *static_cast<const journal_header_type *>(journal_region.get_address());
+                            const journal_entry_type *entries = reinterpret_cast<const journal_entry_type *>(
+                                static_cast<const char *>(journal_region.get_address()) + offset);
+
+                            if (h.magic == journal_magic && h.count <= (size - offset) / sizeof(journal_entry_type) &&
+                                h.checksum == checksum(entries, h.count) && entries_in_range(entries, h.count)) {
+                                write_entries(entries, h.count);
+                            }
+                        }
+                        std::remove(journal_path().c_str());
+                    }
+
+                    /* writes journal entries into the tree and waits for them to reach the file */
+                    void write_entries(const journal_entry_type *entries, const std::size_t count) {
+                        if (!entries_in_range(entries, count)) {
+                            throw std::out_of_range("mapped_merkle_tree: node index out of range in " + path);
+                        }
+
+                        packed_digest_type *nodes = stored_nodes();
+                        for (std::size_t i = 0; i < count; ++i) {
+                            nodes[entries[i].index] = entries[i].digest;
+                        }
+                        if (!region.flush(0, 0, false)) {
+                            throw std::runtime_error("mapped_merkle_tree: flush failed for " + path);
+                        }
+                    }
+
+                    /* the rename commits the journal, once the whole of it is on disk */
+                    void write_journal(const std::vector<journal_entry_type> &entries) const {
+                        const std::string temporary = journal_path() + ".tmp";
+                        const std::uint64_t offset = align(sizeof(journal_header_type));
+                        create_file(temporary, offset + entries.size() * sizeof(journal_entry_type));
+
+                        bool flushed;
+                        {
+                            boost::interprocess::file_mapping journal(temporary.c_str(),
+                                                                      boost::interprocess::read_write);
+                            boost::interprocess::mapped_region journal_region(journal,
+                                                                              boost::interprocess::read_write);
+                            char *data = static_cast<char *>(journal_region.get_address());
+
+                            journal_header_type h;
+                            h.magic = journal_magic;
+                            h.count = entries.size();
+                            h.checksum = checksum(entries.data(), entries.size());
+                            std::memcpy(data, &h, sizeof(h));
+                            std::memcpy(data + offset, entries.data(), entries.size() * sizeof(journal_entry_type));
+                            flushed = journal_region.flush(0, 0, false);
+                        }
+                        if (!flushed || !durable_rename(temporary, journal_path())) {
+                            std::remove(temporary.c_str());
+                            throw std::runtime_error("mapped_merkle_tree: cannot write " + journal_path());
+                        }
+                    }
+
+                    packed_digest_type node(const std::size_t layer, const std::size_t position) const {
+                        const std::size_t idx = node_index(layer, position);
+                        const packed_digest_type &stored =
+                            layer <= memory_depth ? upper_nodes[idx] : stored_nodes()[idx];
+                        return stored == packed_digest_type() ? packed_defaults[layer] : stored;
+                    }
+
+                    /* the node as set by the batch being staged, or as stored */
+                    packed_digest_type staged_node(const std::unordered_map<std::size_t, packed_digest_type> &staged,
+                                                   const std::size_t layer, const std::size_t position) const {
+                        auto it = staged.find(node_index(layer, position));
+                        return it == staged.end() ? node(layer, position) : it->second;
+                    }
+
+                    /*
+                     * Hashes the ancestors of the leaves at positions, whose new values are staged, one
+                     * level at a time on the current executor, then commits every staged node through
+                     * the journal.
+                     */
+                    void update(std::unordered_map<std::size_t, packed_digest_type> staged,
+                                std::vector<std::size_t> positions) {
+                        std::sort(positions.begin(), positions.end());
+                        std::vector<packed_digest_type> hashes;
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            for (std::size_t &position : positions) {
+                                position /= 2;
+                            }
+                            positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+                            hashes.resize(positions.size());
+                            multi_buffer_hash_each<Hash>(
+                                positions.size(),
+                                [&](const std::size_t i) {
+                                    return two_to_one_CRH_input<Hash>(
+                                        staged_node(staged, layer, 2 * positions[i]).to_bits(),
+                                        staged_node(staged, layer, 2 * positions[i] + 1).to_bits());
+                                },
+                                [&](const std::size_t i, const typename Hash::digest_type &digest) {
+                                    hashes[i] = packed_digest_type(digest);
+                                });
+                            for (std::size_t i = 0; i < positions.size(); ++i) {
+                                staged[node_index(layer - 1, positions[i])] = hashes[i];
+                            }
+                        }
+
+                        std::vector<journal_entry_type> entries;
+                        entries.reserve(staged.size());
+                        for (const auto &node : staged) {
+                            entries.push_back(journal_entry_type {node.first, node.second});
+                        }
+                        std::sort(entries.begin(), entries.end(),
+                                  [](const journal_entry_type &a, const journal_entry_type &b) {
+                                      return a.index < b.index;
+                                  });
+
+                        write_journal(entries);
+                        write_entries(entries.data(), entries.size());
+                        for (const journal_entry_type &entry : entries) {
+                            if (entry.index < upper_nodes.size()) {
+                                upper_nodes[entry.index] = entry.digest;
+                            }
+                        }
+                        std::remove(journal_path().c_str());
+                    }
+
+                    std::size_t memory_depth;
+                    std::string path;
+
+                    std::vector<packed_digest_type> packed_defaults;
+                    std::vector<packed_digest_type> upper_nodes;
+
+                    boost::interprocess::file_mapping mapping;
+                    boost::interprocess::mapped_region region;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_MAPPED_MERKLE_TREE_HPP
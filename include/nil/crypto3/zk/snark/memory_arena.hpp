@@ -0,0 +1,140 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the memory arena of a proving request.
+//
+// A service proving one request after another allocates the same transient objects
+// every time: the inputs and assignment of the request and, for circuits built per
+// request, the constraint system and its linear combinations. A memory arena is a
+// std::pmr::memory_resource taking these allocations from large blocks that are only
+// given back together, when the arena is released or destroyed:
+//
+//     {
+//         memory_arena arena;
+//         pmr::r1cs_auxiliary_input<field_type> auxiliary_input(&arena);
+//         generate_witness(request, auxiliary_input);
+//         proof = prove<scheme_type>(pk, primary_input, auxiliary_input);
+//     }    // all the blocks of the request go back at once
+//
+// The relation types and the QAP witness take their allocator as a template parameter, see
+// variable.hpp, r1cs.hpp and qap.hpp, and their pmr:: aliases take it from a memory resource
+// such as an arena. The provers read inputs through spans, so inputs allocated in an arena
+// need no copy. The witness map taking an allocator leaves the witness of a request, its
+// assignment and H, in the arena; the FFTs of the evaluation domain run on std::vector, so
+// their buffers stay in a workspace kept across requests, which the witness map reuses:
+//
+//     typename r1cs_to_qap<field_type>::workspace scratch;    // one per proving thread
+//     ...
+//     {
+//         memory_arena arena;
+//         const pmr::qap_witness<field_type> qap_wit = r1cs_to_qap<field_type>::witness_map(
+//             cs, primary_input, auxiliary_input, context, scratch,
+//             std::pmr::polymorphic_allocator<field_value_type>(&arena));
+//         proof = prover_type::process_witness(pk, qap_wit);
+//     }
+//
+// Unlike std::pmr::monotonic_buffer_resource, an arena can be shared by the threads of the
+// current executor.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_MEMORY_ARENA_HPP
+#define CRYPTO3_ZK_MEMORY_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A monotonic memory resource safe to allocate from concurrently: deallocation is a
+                 * no-op, and all the memory goes back to the upstream resource at once on release.
+                 */
+                class memory_arena : public std::pmr::memory_resource {
+                public:
+                    static constexpr const std::size_t default_block_size = std::size_t(1) << 20;
+
+                    /**
+                     * An arena whose first block takes block_size bytes from upstream; the later blocks
+                     * grow geometrically.
+                     */
+                    explicit memory_arena(const std::size_t block_size = default_block_size,
+                                          std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) :
+                        blocks(std::max<std::size_t>(block_size, 1), upstream),
+                        allocated_(0) {
+                    }
+
+                    memory_arena(const memory_arena &) = delete;
+                    memory_arena &operator=(const memory_arena &) = delete;
+
+                    /**
+                     * Gives all the memory of the arena back to the upstream resource, for the arena to
+                     * serve the next request. The objects allocated from it, their destructors included,
+                     * must be done with before.
+                     */
+                    void release() {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        blocks.release();
+                        allocated_ = 0;
+                    }
+
+                    /* The bytes allocated from the arena since it was built or last released. */
+                    std::size_t allocated() const {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        return allocated_;
+                    }
+
+                    std::pmr::memory_resource *upstream_resource() const {
+                        return blocks.upstream_resource();
+                    }
+
+                private:
+                    void *do_allocate(const std::size_t bytes, const std::size_t alignment) override {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        void *result = blocks.allocate(bytes, alignment);
+                        allocated_ += bytes;
+                        return result;
+                    }
+
+                    void do_deallocate(void *, std::size_t, std::size_t) override {
+                    }
+
+                    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+                        return this == &other;
+                    }
+
+                    mutable std::mutex mutex;
+                    std::pmr::monotonic_buffer_resource blocks;
+                    std::size_t allocated_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_MEMORY_ARENA_HPP
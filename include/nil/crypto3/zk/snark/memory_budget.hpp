@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the memory budget bounding the working memory of provers.
+//
+// The peak memory of a prover grows with the circuit: the witness map holds three
+// domain-sized vectors besides H, and the multi-exponentiations hold working memory
+// in proportion to the terms they run at once. A memory budget installed as the
+// current one of the calling thread bounds that working memory, not counting the
+// proving key and the inputs:
+//
+//     memory_budget budget(std::size_t(4) << 30);
+//     memory_budget::scope guard(budget);
+//     proof = prove<scheme_type>(pk, primary_input, auxiliary_input);
+//
+// Within a limited budget the witness map releases its evaluation vectors as soon as
+// they are consumed and computes H in place, the GG prover runs the witness map
+// before the multi-exponentiations rather than alongside them when both do not fit,
+// splits the multi-exponentiations into parts whose working memory fits together,
+// and streams the sections of a memory-mapped proving key in windows sized to the
+// budget. The budget is a target rather than a hard limit: every part keeps a minimum
+// size, so that the work progresses under a budget too small for it. The default
+// budget is unlimited and leaves every prover as it is.
+//
+// Like the stage sink, the current budget is inherited by the tasks run by the
+// current executor.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_MEMORY_BUDGET_HPP
+#define CRYPTO3_ZK_MEMORY_BUDGET_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                class memory_budget {
+                public:
+                    static constexpr const std::size_t unlimited = std::numeric_limits<std::size_t>::max();
+
+                    explicit memory_budget(const std::size_t bytes = unlimited) : bytes_(bytes) {
+                    }
+
+                    std::size_t bytes() const {
+                        return bytes_;
+                    }
+
+                    bool limited() const {
+                        return bytes_ != unlimited;
+                    }
+
+                    bool fits(const std::size_t size) const {
+                        return size <= bytes_;
+                    }
+
+                    /* The budget left once size bytes are taken out of it, empty if they do not fit. */
+                    memory_budget remaining(const std::size_t size) const {
+                        return limited() ? memory_budget(bytes_ - std::min(bytes_, size)) : *this;
+                    }
+
+                    /**
+                     * The number of items of item_size bytes the budget holds, but at least minimum, and
+                     * unlimited if the budget is.
+                     */
+                    std::size_t items(const std::size_t item_size, const std::size_t minimum = 1) const {
+                        return limited() ? std::max(minimum, bytes_ / std::max<std::size_t>(1, item_size)) :
+                                           unlimited;
+                    }
+
+                    /**
+                     * Installs a budget as the current one of the calling thread for the lifetime of the
+                     * scope.
+                     */
+                    class scope {
+                    public:
+                        explicit scope(const memory_budget &budget) : previous(current_pointer()) {
+                            current_pointer() = &budget;
+                        }
+
+                        scope(const scope &) = delete;
+                        scope &operator=(const scope &) = delete;
+
+                        ~scope() {
+                            current_pointer() = previous;
+                        }
+
+                    private:
+                        const memory_budget *previous;
+                    };
+
+                    static const memory_budget &current() {
+                        static const memory_budget unlimited_budget;
+                        const memory_budget *budget = current_pointer();
+                        return budget ? *budget : unlimited_budget;
+                    }
+
+                private:
+                    static const memory_budget *&current_pointer() {
+                        thread_local const memory_budget *current = nullptr;
+                        return current;
+                    }
+
+                    std::size_t bytes_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_MEMORY_BUDGET_HPP
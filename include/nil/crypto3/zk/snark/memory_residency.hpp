@@ -0,0 +1,161 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the prefaulting and locking of proving key memory.
+//
+// A proving key freshly read or mapped from disk is not resident yet: the first proofs take a
+// page fault for every page of the queries they read, and a key under memory pressure can be
+// paged out again between proofs. prefault_memory touches every page of a range, in one block
+// of pages per thread of the current executor, so that the faults are taken up front, and
+// lock_memory keeps the pages resident with mlock:
+//
+//     const memory_residency residency = prefault_memory(key.H_query, true);
+//
+// Locking is limited by RLIMIT_MEMLOCK and fails, leaving the memory as it is, beyond it; the
+// pages are unlocked when the process unmaps or frees them, or by unlock_memory. Nothing is
+// locked outside Linux.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_MEMORY_RESIDENCY_HPP
+#define CRYPTO3_ZK_MEMORY_RESIDENCY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * What prefault_memory made resident: the bytes it touched, and whether all of them
+                 * are locked when locking was asked for.
+                 */
+                struct memory_residency {
+                    std::size_t bytes = 0;
+                    bool locked = true;
+
+                    memory_residency &operator+=(const memory_residency &other) {
+                        bytes += other.bytes;
+                        locked = locked && other.locked;
+                        return *this;
+                    }
+                };
+
+                inline std::size_t memory_page_size() {
+#ifdef __linux__
+                    static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+                    return page_size;
+#else
+                    return 4096;
+#endif
+                }
+
+                /**
+                 * Locks the pages of [data, data + size) in memory. Returns whether the kernel locked
+                 * them all.
+                 */
+                inline bool lock_memory(const void *data, const std::size_t size) {
+#ifdef __linux__
+                    return !size || mlock(data, size) == 0;
+#else
+                    (void)data;
+                    return !size;
+#endif
+                }
+
+                inline bool unlock_memory(const void *data, const std::size_t size) {
+#ifdef __linux__
+                    return !size || munlock(data, size) == 0;
+#else
+                    (void)data;
+                    return !size;
+#endif
+                }
+
+                /**
+                 * Reads one byte of every page of [data, data + size), the pages being split across the
+                 * current executor, then locks them if lock is set. Mapped file pages are read ahead with
+                 * madvise(MADV_WILLNEED) first.
+                 */
+                inline memory_residency prefault_memory(const void *data, const std::size_t size,
+                                                        const bool lock = false) {
+                    memory_residency residency;
+                    if (!size) {
+                        return residency;
+                    }
+
+                    const std::size_t page_size = memory_page_size();
+                    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data);
+                    const std::uintptr_t first = address / page_size * page_size;
+                    const std::size_t num_pages = (address + size - first + page_size - 1) / page_size;
+#if defined(__linux__) && defined(MADV_WILLNEED)
+                    madvise(reinterpret_cast<void *>(first), num_pages * page_size, MADV_WILLNEED);
+#endif
+
+                    const volatile char *bytes = static_cast<const volatile char *>(data);
+                    executor::current().parallel_for(num_pages, [&](const std::size_t page) {
+                        /* the first byte of the range within the page */
+                        const std::uintptr_t offset = page ? first + page * page_size - address : 0;
+                        (void)bytes[offset];
+                    });
+
+                    residency.bytes = size;
+                    residency.locked = !lock || lock_memory(data, size);
+                    return residency;
+                }
+
+                template<typename ValueType, typename Allocator>
+                memory_residency prefault_memory(const std::vector<ValueType, Allocator> &values,
+                                                 const bool lock = false) {
+                    return prefault_memory(values.data(), values.size() * sizeof(ValueType), lock);
+                }
+
+                template<typename ValueType, typename Allocator>
+                bool unlock_memory(const std::vector<ValueType, Allocator> &values) {
+                    return unlock_memory(values.data(), values.size() * sizeof(ValueType));
+                }
+
+                /**
+                 * Runs an empty task on every thread of the current executor, so that a thread pool
+                 * started lazily, such as the OpenMP one, is up before the first proof.
+                 */
+                inline void warm_up_executor() {
+                    const executor &e = executor::current();
+                    e.bulk(e.concurrency(), [](std::size_t) {});
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_MEMORY_RESIDENCY_HPP
@@ -0,0 +1,255 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of an append-only Merkle tree that keeps only its frontier.
+//
+// When leaves are only ever appended, as in a set commitment, the root of a binary
+// Merkle tree only depends on the frontier: for every level, the last node written
+// whose position is even. merkle_frontier keeps these depth nodes instead of the
+// whole tree. An append walks from the new leaf to the root, hashing it with either
+// its left sibling from the frontier or the default digest of its empty right
+// sibling, so it costs exactly depth hashes and yields the new root.
+//
+// Authentication paths are only kept for the leaves asked for when they are
+// appended, like the incremental witnesses of note commitment trees. The left
+// siblings of a tracked leaf are final when it is appended; its right siblings
+// start as default digests and are replaced by the nodes of the later appends as
+// they are computed.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_MERKLE_FRONTIER_HPP
+#define CRYPTO3_ZK_SNARK_MERKLE_FRONTIER_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/merkle_tree.hpp>
+#include <nil/crypto3/zk/snark/packed_digest.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * An append-only binary Merkle tree of depth depth holding O(depth) nodes, plus the
+                 * paths of its tracked leaves. It can stand for the flat_merkle_tree of a
+                 * set_commitment_accumulator: set_value and set_values only append, at position
+                 * size() onwards, and throw std::invalid_argument otherwise. Paths are only known for
+                 * the tracked leaves; asking for another throws std::out_of_range.
+                 */
+                template<typename Hash>
+                class merkle_frontier {
+                public:
+                    typedef typename Hash::digest_type digest_type;
+                    typedef typename Hash::merkle_authentication_path_type merkle_authentication_path_type;
+                    typedef packed_digest<Hash::digest_bits> packed_digest_type;
+
+                    std::vector<digest_type> hash_defaults;
+
+                    std::size_t depth;
+                    std::size_t value_size;
+                    std::size_t digest_size;
+
+                    merkle_frontier(const std::size_t depth, const std::size_t value_size) :
+                        depth(depth), value_size(value_size), digest_size(Hash::digest_bits), num_leaves(0),
+                        frontier(depth) {
+                        assert(depth < sizeof(std::size_t) * 8);
+                        assert(value_size <= digest_size);
+
+                        digest_type last(digest_size);
+                        hash_defaults.reserve(depth + 1);
+                        hash_defaults.emplace_back(last);
+                        for (std::size_t i = 0; i < depth; ++i) {
+                            last = two_to_one_CRH<Hash>(last, last);
+                            hash_defaults.emplace_back(last);
+                        }
+                        std::reverse(hash_defaults.begin(), hash_defaults.end());
+
+                        packed_defaults.reserve(depth + 1);
+                        for (std::size_t layer = 0; layer <= depth; ++layer) {
+                            packed_defaults.emplace_back(hash_defaults[layer]);
+                        }
+                        root = packed_defaults[0];
+                    }
+
+                    merkle_frontier(const std::size_t depth, const std::size_t value_size,
+                                    const std::vector<std::vector<bool>> &contents_as_vector) :
+                        merkle_frontier(depth, value_size) {
+                        for (const std::vector<bool> &value : contents_as_vector) {
+                            append(packed_digest_type(value));
+                        }
+                    }
+
+                    /* the number of leaves appended so far */
+                    std::size_t size() const {
+                        return num_leaves;
+                    }
+
+                    /**
+                     * Appends value as the leaf at position size(), hashing one node per level. With
+                     * track set, the authentication path of the new leaf is kept up to date from then on.
+                     */
+                    void append(const packed_digest_type &value, const bool track = false) {
+                        if (num_leaves == (std::size_t(1) << depth)) {
+                            throw std::out_of_range("merkle_frontier: the tree is full");
+                        }
+
+                        const std::size_t address = num_leaves++;
+                        packed_digest_type node = value;
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            const std::size_t position = address >> (depth - layer);
+                            update_witnesses(layer, position, node);
+
+                            if (position & 1) {
+                                node = hash(frontier[layer - 1], node);
+                            } else {
+                                frontier[layer - 1] = node;
+                                node = hash(node, packed_defaults[layer]);
+                            }
+                        }
+                        root = node;
+
+                        if (track) {
+                            track_last();
+                        }
+                    }
+
+                    void set_value(const std::size_t address, const std::vector<bool> &value) {
+                        assert(value.size() == value_size);
+                        set_value(address, packed_digest_type(value));
+                    }
+
+                    /* Appends value, address being the next position. */
+                    void set_value(const std::size_t address, const packed_digest_type &value) {
+                        if (address != num_leaves) {
+                            throw std::invalid_argument("merkle_frontier: only the next position can be set");
+                        }
+                        append(value);
+                    }
+
+                    /* Appends the values of batch, whose addresses are the next positions. */
+                    void set_values(const std::map<std::size_t, std::vector<bool>> &batch) {
+                        if (!batch.empty() && (batch.begin()->first != num_leaves ||
+                                               batch.rbegin()->first != num_leaves + batch.size() - 1)) {
+                            throw std::invalid_argument("merkle_frontier: only the next positions can be set");
+                        }
+                        for (const auto &content : batch) {
+                            assert(content.second.size() == value_size);
+                            set_value(content.first, packed_digest_type(content.second));
+                        }
+                    }
+
+                    /* Starts tracking the last appended leaf, whose siblings are all still known. */
+                    void track_last() {
+                        if (num_leaves == 0) {
+                            throw std::out_of_range("merkle_frontier: no leaf to track");
+                        }
+                        const std::size_t address = num_leaves - 1;
+                        if (witnesses.count(address)) {
+                            return;
+                        }
+
+                        /* the right siblings of the last leaf are empty, its left ones are in the frontier
+                           except on the levels where it is itself the left child */
+                        std::vector<packed_digest_type> &path = witnesses[address];
+                        path.resize(depth);
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            const std::size_t position = address >> (depth - layer);
+                            path[layer - 1] = (position & 1) ? frontier[layer - 1] : packed_defaults[layer];
+                        }
+                    }
+
+                    /* Stops tracking the leaf at address. */
+                    void untrack(const std::size_t address) {
+                        witnesses.erase(address);
+                    }
+
+                    bool is_tracked(const std::size_t address) const {
+                        return witnesses.count(address) != 0;
+                    }
+
+                    digest_type get_root() const {
+                        return root.to_bits();
+                    }
+
+                    const packed_digest_type &get_packed_root() const {
+                        return root;
+                    }
+
+                    /**
+                     * Authentication path of the tracked leaf at address, ordered as get_path of
+                     * flat_merkle_tree orders it. Throws std::out_of_range if the leaf is not tracked.
+                     */
+                    std::vector<packed_digest_type> get_packed_path(const std::size_t address) const {
+                        auto it = witnesses.find(address);
+                        if (it == witnesses.end()) {
+                            throw std::out_of_range("merkle_frontier: the leaf is not tracked");
+                        }
+                        return it->second;
+                    }
+
+                    merkle_authentication_path_type get_path(const std::size_t address) const {
+                        const std::vector<packed_digest_type> path = get_packed_path(address);
+                        merkle_authentication_path_type result(depth);
+                        for (std::size_t layer = 0; layer < depth; ++layer) {
+                            result[layer] = path[layer].to_bits();
+                        }
+                        return result;
+                    }
+
+                private:
+                    packed_digest_type hash(const packed_digest_type &left, const packed_digest_type &right) const {
+                        return packed_digest_type(two_to_one_CRH<Hash>(left.to_bits(), right.to_bits()));
+                    }
+
+                    /* node is the new value of the node at (layer, position), the sibling of some tracked paths */
+                    void update_witnesses(const std::size_t layer, const std::size_t position,
+                                          const packed_digest_type &node) {
+                        for (auto &witness : witnesses) {
+                            if ((witness.first >> (depth - layer)) == (position ^ 1)) {
+                                witness.second[layer - 1] = node;
+                            }
+                        }
+                    }
+
+                    std::size_t num_leaves;
+
+                    /* frontier[layer - 1] is the last node written at an even position of layer */
+                    std::vector<packed_digest_type> frontier;
+                    std::vector<packed_digest_type> packed_defaults;
+                    packed_digest_type root;
+
+                    std::map<std::size_t, std::vector<packed_digest_type>> witnesses;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_MERKLE_FRONTIER_HPP
@@ -26,18 +26,30 @@
 #ifndef CRYPTO3_ZK_SNARK_MERKLE_TREE_HPP
 #define CRYPTO3_ZK_SNARK_MERKLE_TREE_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <cmath>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multi_buffer_hash.hpp>
+#include <nil/crypto3/zk/snark/packed_digest.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
             namespace snark {
+                /**
+                 * The message hashed by two_to_one_CRH, which multi_buffer_hash_each hashes along with
+                 * those of the other nodes of a level.
+                 */
                 template<typename Hash>
-                typename Hash::digest_type two_to_one_CRH(const typename Hash::digest_type &l,
-                                                          const typename Hash::digest_type &r) {
+                typename Hash::digest_type two_to_one_CRH_input(const typename Hash::digest_type &l,
+                                                                const typename Hash::digest_type &r) {
                     typename Hash::digest_type new_input;
                     new_input.insert(new_input.end(), l.begin(), l.end());
                     new_input.insert(new_input.end(), r.begin(), r.end());
@@ -46,13 +58,150 @@ namespace nil {
                     assert(l.size() == digest_size);
                     assert(r.size() == digest_size);
 
-                    return Hash::get_hash(new_input);
+                    return new_input;
+                }
+
+                template<typename Hash>
+                typename Hash::digest_type two_to_one_CRH(const typename Hash::digest_type &l,
+                                                          const typename Hash::digest_type &r) {
+                    return Hash::get_hash(two_to_one_CRH_input<Hash>(l, r));
+                }
+
+                /* The message hashed by n_to_one_CRH. */
+                template<typename Hash, typename InputIterator>
+                typename Hash::digest_type n_to_one_CRH_input(InputIterator first, InputIterator last) {
+                    typename Hash::digest_type new_input;
+                    for (InputIterator it = first; it != last; ++it) {
+                        // the empty digest is the default leaf of merkle_default_leaf::empty_digest
+                        assert(it->empty() || it->size() == Hash::get_digest_len());
+                        new_input.insert(new_input.end(), it->begin(), it->end());
+                    }
+
+                    return new_input;
                 }
 
+                /**
+                 * Compression of the digests of [first, last) into one, the node of a tree of arity
+                 * last - first over them.
+                 */
+                template<typename Hash, typename InputIterator>
+                typename Hash::digest_type n_to_one_CRH(InputIterator first, InputIterator last) {
+                    return Hash::get_hash(n_to_one_CRH_input<Hash>(first, last));
+                }
+
+                typedef std::vector<bool> merkle_authentication_node;
+                typedef std::vector<merkle_authentication_node> merkle_authentication_path;
+
+                /**
+                 * An authentication multi-path of a set of leaves: the nodes that the computation of
+                 * the root from these leaves needs but cannot derive from them, ordered by layer from
+                 * the leaves up and by position within a layer.
+                 */
+                typedef std::vector<merkle_authentication_node> merkle_authentication_multi_path;
+
+                /**
+                 * Sibling positions of a multi-path: calls emit(layer, position) for every node of the
+                 * multi-path of the leaves at sorted, distinct positions, in multi-path order. The
+                 * nodes of layer have arities[layer] children, the root being layer 0.
+                 */
+                template<typename Function>
+                void merkle_multi_path_positions(const std::vector<std::size_t> &arities,
+                                                 std::vector<std::size_t> positions, Function emit) {
+                    for (std::size_t layer = arities.size(); layer > 0; --layer) {
+                        const std::size_t arity = arities[layer - 1];
+                        for (std::size_t i = 0; i < positions.size();) {
+                            const std::size_t first_child = positions[i] - positions[i] % arity;
+                            for (std::size_t child = first_child; child < first_child + arity; ++child) {
+                                if (i < positions.size() && positions[i] == child) {
+                                    ++i;
+                                } else {
+                                    emit(layer, child);
+                                }
+                            }
+                        }
+
+                        for (std::size_t &position : positions) {
+                            position /= arity;
+                        }
+                        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+                    }
+                }
+
+                template<typename Function>
+                void merkle_multi_path_positions(const std::size_t depth, std::vector<std::size_t> positions,
+                                                 Function emit) {
+                    merkle_multi_path_positions(std::vector<std::size_t>(depth, 2), std::move(positions), emit);
+                }
+
+                /**
+                 * Root of a Merkle tree with the given layer arities recomputed from some of its leaves
+                 * and their multi-path; an empty digest is returned if the multi-path is too short or
+                 * has nodes left over.
+                 */
+                template<typename Hash>
+                typename Hash::digest_type
+                    merkle_multi_path_root(const std::vector<std::size_t> &arities, const std::size_t digest_size,
+                                           const std::map<std::size_t, std::vector<bool>> &leaves,
+                                           const merkle_authentication_multi_path &multi_path) {
+                    typedef typename Hash::digest_type digest_type;
+
+                    std::vector<std::pair<std::size_t, digest_type>> layer_nodes;
+                    for (const auto &leaf : leaves) {
+                        digest_type digest(leaf.second.begin(), leaf.second.end());
+                        digest.resize(digest_size);
+                        layer_nodes.emplace_back(leaf.first, std::move(digest));
+                    }
+
+                    auto path_it = multi_path.begin();
+                    std::vector<digest_type> children;
+                    for (std::size_t layer = arities.size(); layer > 0; --layer) {
+                        const std::size_t arity = arities[layer - 1];
+                        std::vector<std::pair<std::size_t, digest_type>> parent_nodes;
+                        for (std::size_t i = 0; i < layer_nodes.size();) {
+                            const std::size_t first_child = layer_nodes[i].first - layer_nodes[i].first % arity;
+                            children.clear();
+                            for (std::size_t child = first_child; child < first_child + arity; ++child) {
+                                if (i < layer_nodes.size() && layer_nodes[i].first == child) {
+                                    children.emplace_back(layer_nodes[i++].second);
+                                } else if (path_it != multi_path.end()) {
+                                    children.emplace_back(*path_it++);
+                                } else {
+                                    return digest_type();
+                                }
+                            }
+                            parent_nodes.emplace_back(first_child / arity,
+                                                      n_to_one_CRH<Hash>(children.begin(), children.end()));
+                        }
+                        layer_nodes = std::move(parent_nodes);
+                    }
+
+                    if (path_it != multi_path.end()) {
+                        return digest_type();
+                    }
+                    return layer_nodes.empty() ? digest_type() : layer_nodes[0].second;
+                }
+
+                template<typename Hash>
+                typename Hash::digest_type
+                    merkle_multi_path_root(const std::size_t depth, const std::size_t digest_size,
+                                           const std::map<std::size_t, std::vector<bool>> &leaves,
+                                           const merkle_authentication_multi_path &multi_path) {
+                    return merkle_multi_path_root<Hash>(std::vector<std::size_t>(depth, 2), digest_size, leaves,
+                                                        multi_path);
+                }
+
+                /**
+                 * The digest an unset leaf of a merkle_tree is hashed as. The original trees hash it as
+                 * the empty digest, which empty_digest keeps, so their roots stay the same; zero_digest
+                 * hashes the all-zero digest that get_value and get_path report for it, as
+                 * flat_merkle_tree and merkle_frontier do, so that its paths verify against the root.
+                 */
+                enum class merkle_default_leaf { empty_digest, zero_digest };
+
                 /**
                  * A Merkle tree is maintained as two maps:
                  * - a map from addresses to values, and
-                 * - a map from addresses to hashes.
+                 * - a map from node indices to hashes.
                  *
                  * The second map maintains the intermediate hashes of a Merkle tree
                  * built atop the values currently stored in the tree (the
@@ -60,125 +209,107 @@ namespace nil {
                  * trees). Besides offering methods to load and store values, the
                  * class offers methods to retrieve the root of the Merkle tree and to
                  * obtain the authentication paths for (the value at) a given address.
+                 *
+                 * The tree is made of depth layers of arity BaseArity over the leaves, topped by
+                 * one layer of arity SubTreeArity combining these base trees, and one of arity
+                 * TopTreeArity combining the sub-trees; an arity of 0 leaves out the sub or top
+                 * layer, and a BaseArity of 0 stands for binary base layers. Nodes are numbered
+                 * layer after layer from the root, so a binary tree keeps the heap numbering. The unset
+                 * leaves are hashed as DefaultLeaf says.
                  */
-
-                typedef std::vector<bool> merkle_authentication_node;
-                typedef std::vector<merkle_authentication_node> merkle_authentication_path;
-
                 template<typename Hash, std::size_t BaseArity = 0, std::size_t SubTreeArity = 0,
-                         std::size_t TopTreeArity = 0>
+                         std::size_t TopTreeArity = 0,
+                         merkle_default_leaf DefaultLeaf = merkle_default_leaf::empty_digest>
                 struct merkle_tree {
                     typedef typename Hash::digest_type digest_type;
                     typedef typename Hash::merkle_authentication_path_type merkle_authentication_path_type;
 
-                    constexpr static const std::size_t base_arity = BaseArity;
+                    constexpr static const std::size_t base_arity = BaseArity ? BaseArity : 2;
                     constexpr static const std::size_t sub_tree_arity = SubTreeArity;
                     constexpr static const std::size_t top_tree_arity = TopTreeArity;
 
+                    static_assert(base_arity >= 2 && sub_tree_arity != 1 && top_tree_arity != 1,
+                                  "a Merkle tree layer needs an arity of at least 2");
+
                     std::vector<digest_type> hash_defaults;
                     std::map<std::size_t, std::vector<bool>> values;
                     std::map<std::size_t, digest_type> hashes;
 
+                    /* arities[layer] is the number of children of the nodes of layer, the root being layer 0 */
+                    std::vector<std::size_t> arities;
+
                     std::size_t depth;
                     std::size_t value_size;
                     std::size_t digest_size;
 
-                    merkle_tree(const std::size_t depth, const std::size_t value_size) :
-                        depth(depth), value_size(value_size) {
-                        assert(depth < sizeof(std::size_t) * 8);
+                    merkle_tree(const std::size_t base_depth, const std::size_t value_size) :
+                        arities(layer_arities(base_depth)), depth(arities.size()), value_size(value_size) {
+                        assert(base_depth < sizeof(std::size_t) * 8);
 
                         digest_size = Hash::digest_bits;
                         assert(value_size <= digest_size);
 
-                        digest_type last;
-                        hash_defaults.reserve(depth + 1);
-                        hash_defaults.emplace_back(last);
-                        for (std::size_t i = 0; i < depth; ++i) {
-                            last = two_to_one_CRH<Hash>(last, last);
-                            hash_defaults.emplace_back(last);
+                        layer_offsets.assign(1, 0);
+                        std::size_t layer_size = 1;
+                        for (std::size_t layer = 0; layer < depth; ++layer) {
+                            layer_offsets.emplace_back(layer_offsets.back() + layer_size);
+                            layer_size *= arities[layer];
+                        }
+                        num_leaves = layer_size;
+
+                        hash_defaults.resize(depth + 1);
+                        hash_defaults[depth] = (DefaultLeaf == merkle_default_leaf::zero_digest ?
+                                                    digest_type(digest_size) :
+                                                    digest_type());
+                        for (std::size_t layer = depth; layer-- > 0;) {
+                            const std::vector<digest_type> children(arities[layer], hash_defaults[layer + 1]);
+                            hash_defaults[layer] = n_to_one_CRH<Hash>(children.begin(), children.end());
                         }
-
-                        std::reverse(hash_defaults.begin(), hash_defaults.end());
                     }
-                    merkle_tree(const std::size_t depth, const std::size_t value_size,
+
+                    merkle_tree(const std::size_t base_depth, const std::size_t value_size,
                                 const std::vector<std::vector<bool>> &contents_as_vector) :
-                        merkle_tree<Hash>(depth, value_size) {
-                        assert(static_cast<std::size_t>(std::ceil(std::log2(contents_as_vector.size()))) <= depth);
+                        merkle_tree(base_depth, value_size) {
+                        assert(contents_as_vector.size() <= num_leaves);
+                        std::vector<digest_type> layer_hashes(contents_as_vector.size());
                         for (std::size_t address = 0; address < contents_as_vector.size(); ++address) {
-                            const std::size_t idx = address + (1ul << depth) - 1;
-                            values[idx] = contents_as_vector[address];
+                            const std::size_t idx = node_index(depth, address);
+                            values[address] = contents_as_vector[address];
                             hashes[idx] = contents_as_vector[address];
                             hashes[idx].resize(digest_size);
+                            layer_hashes[address] = hashes[idx];
                         }
 
-                        std::size_t idx_begin = (1ul << depth) - 1;
-                        std::size_t idx_end = contents_as_vector.size() + ((1ul << depth) - 1);
-
-                        for (int layer = depth; layer > 0; --layer) {
-                            for (std::size_t idx = idx_begin; idx < idx_end; idx += 2) {
-                                digest_type l =
-                                    hashes[idx];    // this is sound, because idx_begin is always a left child
-                                digest_type r = (idx + 1 < idx_end ? hashes[idx + 1] : hash_defaults[layer]);
-
-                                digest_type h = two_to_one_CRH<Hash>(l, r);
-                                hashes[(idx - 1) / 2] = h;
+                        // every layer is hashed in independent batches, then stored in the map
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            const std::size_t arity = arities[layer - 1];
+                            std::vector<digest_type> parent_hashes((layer_hashes.size() + arity - 1) / arity);
+                            multi_buffer_hash_each<Hash>(
+                                parent_hashes.size(),
+                                [&](const std::size_t i) {
+                                    std::vector<digest_type> children(arity, hash_defaults[layer]);
+                                    const std::size_t last = std::min(layer_hashes.size(), (i + 1) * arity);
+                                    std::copy(layer_hashes.begin() + i * arity, layer_hashes.begin() + last,
+                                              children.begin());
+                                    return n_to_one_CRH_input<Hash>(children.begin(), children.end());
+                                },
+                                [&](const std::size_t i, digest_type digest) { parent_hashes[i] = std::move(digest); });
+
+                            for (std::size_t i = 0; i < parent_hashes.size(); ++i) {
+                                hashes[node_index(layer - 1, i)] = parent_hashes[i];
                             }
-
-                            idx_begin = (idx_begin - 1) / 2;
-                            idx_end = (idx_end - 1) / 2;
+                            layer_hashes = std::move(parent_hashes);
                         }
                     }
 
-                    merkle_tree(size_t depth, std::size_t value_size,
+                    merkle_tree(size_t base_depth, std::size_t value_size,
                                 const std::map<std::size_t, std::vector<bool>> &contents) :
-                        merkle_tree<Hash>(depth, value_size) {
-
-                        if (!contents.empty()) {
-                            assert(contents.rbegin()->first < 1ul << depth);
-
-                            for (const auto &content : contents) {
-                                const std::size_t address = content.first;
-                                const std::vector<bool> value = content.second;
-                                const std::size_t idx = address + (1ul << depth) - 1;
-
-                                values[address] = value;
-                                hashes[idx] = value;
-                                hashes[idx].resize(digest_size);
-                            }
-
-                            auto last_it = hashes.end();
-
-                            for (int layer = depth; layer > 0; --layer) {
-                                auto next_last_it = hashes.begin();
-
-                                for (auto it = hashes.begin(); it != last_it; ++it) {
-                                    const std::size_t idx = it->first;
-                                    const digest_type hash = it->second;
-
-                                    if (idx % 2 == 0) {
-                                        // this is the right child of its parent and by invariant we are missing the
-                                        // left child
-                                        hashes[(idx - 1) / 2] = two_to_one_CRH<Hash>(hash_defaults[layer], hash);
-                                    } else {
-                                        if (std::next(it) == last_it || std::next(it)->first != idx + 1) {
-                                            // this is the left child of its parent and is missing its right child
-                                            hashes[(idx - 1) / 2] = two_to_one_CRH<Hash>(hash, hash_defaults[layer]);
-                                        } else {
-                                            // typical case: this is the left child of the parent and adjacent to it
-                                            // there is a right child
-                                            hashes[(idx - 1) / 2] = two_to_one_CRH<Hash>(hash, std::next(it)->second);
-                                            ++it;
-                                        }
-                                    }
-                                }
-
-                                last_it = next_last_it;
-                            }
-                        }
+                        merkle_tree(base_depth, value_size) {
+                        set_values(contents);
                     }
 
                     std::vector<bool> get_value(const std::size_t address) const {
-                        assert(static_cast<std::size_t>(std::ceil(std::log2(address))) <= depth);
+                        assert(address < num_leaves);
 
                         auto it = values.find(address);
                         std::vector<bool> padded_result =
@@ -187,58 +318,112 @@ namespace nil {
 
                         return padded_result;
                     }
-                    void set_value(const std::size_t address, const std::vector<bool> &value) {
-                        assert(static_cast<std::size_t>(std::ceil(std::log2(address))) <= depth);
-                        std::size_t idx = address + (1ul << depth) - 1;
 
+                    void set_value(const std::size_t address, const std::vector<bool> &value) {
+                        assert(address < num_leaves);
                         assert(value.size() == value_size);
-                        values[address] = value;
-                        hashes[idx] = value;
-                        hashes[idx].resize(digest_size);
 
-                        for (int layer = depth - 1; layer >= 0; --layer) {
-                            idx = (idx - 1) / 2;
+                        write_leaf(address, value);
+
+                        std::size_t position = address;
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            position /= arities[layer - 1];
+                            hash_children(layer - 1, position);
+                        }
+                    }
 
-                            auto it = hashes.find(2 * idx + 1);
-                            digest_type l = (it == hashes.end() ? hash_defaults[layer + 1] : it->second);
+                    /**
+                     * Sets every (address, value) of batch, hashing each ancestor shared by the updated
+                     * leaves once.
+                     */
+                    void set_values(const std::map<std::size_t, std::vector<bool>> &batch) {
+                        std::vector<std::size_t> positions;
+                        positions.reserve(batch.size());
+                        for (const auto &content : batch) {
+                            assert(content.first < num_leaves);
+                            assert(content.second.size() == value_size);
+
+                            write_leaf(content.first, content.second);
+                            positions.emplace_back(content.first);
+                        }
 
-                            it = hashes.find(2 * idx + 2);
-                            digest_type r = (it == hashes.end() ? hash_defaults[layer + 1] : it->second);
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            for (std::size_t &position : positions) {
+                                position /= arities[layer - 1];
+                            }
+                            positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
 
-                            digest_type h = two_to_one_CRH<Hash>(l, r);
-                            hashes[idx] = h;
+                            for (const std::size_t position : positions) {
+                                hash_children(layer - 1, position);
+                            }
                         }
                     }
 
                     digest_type get_root() const {
-                        auto it = hashes.find(0);
-                        return (it == hashes.end() ? hash_defaults[0] : it->second);
+                        return node_hash(0, 0);
                     }
+
+                    /**
+                     * Authentication path of the value at address: the siblings of its ancestors, the
+                     * arities[layer] - 1 siblings of a node of layer + 1 in the order of their positions,
+                     * the layers being ordered from the root down to the leaves.
+                     */
                     merkle_authentication_path_type get_path(const std::size_t address) const {
-                        typename Hash::merkle_authentication_path_type result(depth);
-                        assert(static_cast<std::size_t>(std::ceil(std::log2(address))) <= depth);
-                        std::size_t idx = address + (1ul << depth) - 1;
+                        std::size_t path_size = 0;
+                        for (const std::size_t arity : arities) {
+                            path_size += arity - 1;
+                        }
+
+                        merkle_authentication_path_type result(path_size);
+                        assert(address < num_leaves);
 
+                        std::size_t position = address;
                         for (std::size_t layer = depth; layer > 0; --layer) {
-                            std::size_t sibling_idx = ((idx + 1) ^ 1) - 1;
-                            auto it = hashes.find(sibling_idx);
-                            if (layer == depth) {
-                                auto it2 = values.find(sibling_idx - ((1ul << depth) - 1));
-                                result[layer - 1] =
-                                    (it2 == values.end() ? std::vector<bool>(value_size, false) : it2->second);
-                                result[layer - 1].resize(digest_size);
-                            } else {
-                                result[layer - 1] = (it == hashes.end() ? hash_defaults[layer] : it->second);
+                            const std::size_t arity = arities[layer - 1];
+                            path_size -= arity - 1;
+
+                            const std::size_t first_sibling = position - position % arity;
+                            std::size_t j = path_size;
+                            for (std::size_t sibling = first_sibling; sibling < first_sibling + arity; ++sibling) {
+                                if (sibling == position) {
+                                    continue;
+                                }
+                                if (layer == depth) {
+                                    auto it = values.find(sibling);
+                                    result[j] =
+                                        (it == values.end() ? std::vector<bool>(value_size, false) : it->second);
+                                    result[j].resize(digest_size);
+                                } else {
+                                    result[j] = node_hash(layer, sibling);
+                                }
+                                ++j;
                             }
 
-                            idx = (idx - 1) / 2;
+                            position /= arity;
                         }
 
                         return result;
                     }
 
+                    /**
+                     * Deduplicated authentication path of the leaves at addresses: the siblings along
+                     * their paths that are not themselves on one of the paths, see
+                     * merkle_multi_path_root.
+                     */
+                    merkle_authentication_multi_path get_multi_path(std::vector<std::size_t> addresses) const {
+                        std::sort(addresses.begin(), addresses.end());
+                        addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+                        merkle_authentication_multi_path result;
+                        merkle_multi_path_positions(arities, std::move(addresses),
+                                                    [&](const std::size_t layer, const std::size_t position) {
+                                                        result.emplace_back(node_hash(layer, position));
+                                                    });
+                        return result;
+                    }
+
                     void dump() const {
-                        for (std::size_t i = 0; i < 1ul << depth; ++i) {
+                        for (std::size_t i = 0; i < num_leaves; ++i) {
                             auto it = values.find(i);
                             printf("[%zu] -> ", i);
                             const std::vector<bool> value =
@@ -250,6 +435,321 @@ namespace nil {
                         }
                         printf("\n");
                     }
+
+                private:
+                    /* index of the first node of each layer */
+                    std::vector<std::size_t> layer_offsets;
+                    std::size_t num_leaves;
+
+                    static std::vector<std::size_t> layer_arities(const std::size_t base_depth) {
+                        std::vector<std::size_t> result;
+                        if (top_tree_arity) {
+                            result.emplace_back(top_tree_arity);
+                        }
+                        if (sub_tree_arity) {
+                            result.emplace_back(sub_tree_arity);
+                        }
+                        result.insert(result.end(), base_depth, base_arity);
+                        return result;
+                    }
+
+                    std::size_t node_index(const std::size_t layer, const std::size_t position) const {
+                        return layer_offsets[layer] + position;
+                    }
+
+                    digest_type node_hash(const std::size_t layer, const std::size_t position) const {
+                        auto it = hashes.find(node_index(layer, position));
+                        return (it == hashes.end() ? hash_defaults[layer] : it->second);
+                    }
+
+                    void write_leaf(const std::size_t address, const std::vector<bool> &value) {
+                        const std::size_t idx = node_index(depth, address);
+                        values[address] = value;
+                        hashes[idx] = value;
+                        hashes[idx].resize(digest_size);
+                    }
+
+                    void hash_children(const std::size_t layer, const std::size_t position) {
+                        std::vector<digest_type> children;
+                        children.reserve(arities[layer]);
+                        for (std::size_t child = position * arities[layer]; child < (position + 1) * arities[layer];
+                             ++child) {
+                            children.emplace_back(node_hash(layer + 1, child));
+                        }
+                        hashes[node_index(layer, position)] = n_to_one_CRH<Hash>(children.begin(), children.end());
+                    }
+                };
+
+                /**
+                 * A Merkle tree with the interface of merkle_tree, whose nodes are packed digests held
+                 * in one flat array per level instead of maps of bit vectors. Next to the bit vector
+                 * accessors, it reads and writes packed digests directly.
+                 *
+                 * The nodes of a level are stored densely from position 0 up to its populated prefix,
+                 * which grows geometrically as nodes are written; a node far beyond the prefix is kept
+                 * in a per-level map instead, so sparse trees stay small. Nodes never written read as
+                 * the default digest of their level, the default leaf being the all-zero digest. The
+                 * values are the leading value_size bits of the leaf digests, so they take no storage
+                 * of their own.
+                 */
+                template<typename Hash>
+                class flat_merkle_tree {
+                public:
+                    typedef typename Hash::digest_type digest_type;
+                    typedef typename Hash::merkle_authentication_path_type merkle_authentication_path_type;
+                    typedef packed_digest<Hash::digest_bits> packed_digest_type;
+
+                    std::vector<digest_type> hash_defaults;
+
+                    std::size_t depth;
+                    std::size_t value_size;
+                    std::size_t digest_size;
+
+                    flat_merkle_tree(const std::size_t depth, const std::size_t value_size) :
+                        depth(depth), value_size(value_size), digest_size(Hash::digest_bits), levels(depth + 1) {
+                        assert(depth < sizeof(std::size_t) * 8);
+                        assert(value_size <= digest_size);
+
+                        digest_type last(digest_size);
+                        hash_defaults.reserve(depth + 1);
+                        hash_defaults.emplace_back(last);
+                        for (std::size_t i = 0; i < depth; ++i) {
+                            last = two_to_one_CRH<Hash>(last, last);
+                            hash_defaults.emplace_back(last);
+                        }
+
+                        std::reverse(hash_defaults.begin(), hash_defaults.end());
+
+                        packed_defaults.reserve(depth + 1);
+                        for (std::size_t layer = 0; layer <= depth; ++layer) {
+                            packed_defaults.emplace_back(hash_defaults[layer]);
+                        }
+                    }
+
+                    flat_merkle_tree(const std::size_t depth, const std::size_t value_size,
+                                     const std::vector<std::vector<bool>> &contents_as_vector) :
+                        flat_merkle_tree(depth, value_size) {
+                        assert(contents_as_vector.size() <= (std::size_t(1) << depth));
+
+                        std::vector<std::size_t> positions(contents_as_vector.size());
+                        std::size_t size = positions.size();
+                        for (std::size_t layer = depth + 1; layer-- > 0; size = (size + 1) / 2) {
+                            reserve_dense(layer, size);
+                        }
+                        for (std::size_t address = 0; address < contents_as_vector.size(); ++address) {
+                            mutable_node(depth, address) = packed_digest_type(contents_as_vector[address]);
+                            positions[address] = address;
+                        }
+                        rehash(std::move(positions));
+                    }
+
+                    flat_merkle_tree(const std::size_t depth, const std::size_t value_size,
+                                     const std::map<std::size_t, std::vector<bool>> &contents) :
+                        flat_merkle_tree(depth, value_size) {
+                        set_values(contents);
+                    }
+
+                    std::vector<bool> get_value(const std::size_t address) const {
+                        assert(address < (std::size_t(1) << depth));
+                        return node(depth, address).to_bits(value_size);
+                    }
+
+                    void set_value(const std::size_t address, const std::vector<bool> &value) {
+                        assert(value.size() == value_size);
+                        set_value(address, packed_digest_type(value));
+                    }
+
+                    /**
+                     * Sets the value at address to the leading value_size bits of value, the other
+                     * bits being zero.
+                     */
+                    void set_value(const std::size_t address, const packed_digest_type &value) {
+                        assert(address < (std::size_t(1) << depth));
+
+                        mutable_node(depth, address) = value;
+
+                        std::size_t position = address;
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            position /= 2;
+                            mutable_node(layer - 1, position) = hash_children(layer - 1, position);
+                        }
+                    }
+
+                    /**
+                     * Sets every (address, value) of batch, hashing each ancestor shared by the updated
+                     * leaves once.
+                     */
+                    void set_values(const std::map<std::size_t, std::vector<bool>> &batch) {
+                        std::vector<std::size_t> positions;
+                        positions.reserve(batch.size());
+                        for (const auto &content : batch) {
+                            assert(content.first < (std::size_t(1) << depth));
+                            assert(content.second.size() == value_size);
+                            mutable_node(depth, content.first) = packed_digest_type(content.second);
+                            positions.emplace_back(content.first);
+                        }
+                        rehash(std::move(positions));
+                    }
+
+                    digest_type get_root() const {
+                        return node(0, 0).to_bits();
+                    }
+
+                    const packed_digest_type &get_packed_root() const {
+                        return node(0, 0);
+                    }
+
+                    merkle_authentication_path_type get_path(const std::size_t address) const {
+                        const std::vector<packed_digest_type> path = get_packed_path(address);
+                        merkle_authentication_path_type result(depth);
+                        for (std::size_t layer = 0; layer < depth; ++layer) {
+                            result[layer] = path[layer].to_bits();
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Authentication path of address in packed form, ordered as get_path orders it.
+                     */
+                    std::vector<packed_digest_type> get_packed_path(const std::size_t address) const {
+                        std::vector<packed_digest_type> result(depth);
+                        assert(address < (std::size_t(1) << depth));
+
+                        std::size_t position = address;
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            result[layer - 1] = node(layer, position ^ 1);
+                            position /= 2;
+                        }
+
+                        return result;
+                    }
+
+                    /**
+                     * Deduplicated authentication path of the leaves at addresses, see
+                     * merkle_multi_path_root.
+                     */
+                    merkle_authentication_multi_path get_multi_path(std::vector<std::size_t> addresses) const {
+                        std::sort(addresses.begin(), addresses.end());
+                        addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+                        merkle_authentication_multi_path result;
+                        merkle_multi_path_positions(depth, std::move(addresses),
+                                                    [&](const std::size_t layer, const std::size_t position) {
+                                                        result.emplace_back(node(layer, position).to_bits());
+                                                    });
+                        return result;
+                    }
+
+                    void dump() const {
+                        for (std::size_t i = 0; i < std::size_t(1) << depth; ++i) {
+                            printf("[%zu] -> ", i);
+                            for (bool b : get_value(i)) {
+                                printf("%d", b ? 1 : 0);
+                            }
+                            printf("\n");
+                        }
+                        printf("\n");
+                    }
+
+                private:
+                    /* positions a write may lie past the dense prefix and still extend it */
+                    static constexpr const std::size_t min_dense_growth = 64;
+
+                    struct level_type {
+                        std::vector<packed_digest_type> dense;
+                        std::unordered_map<std::size_t, packed_digest_type> sparse;
+                    };
+
+                    std::vector<level_type> levels;
+                    std::vector<packed_digest_type> packed_defaults;
+
+                    /* Extends the dense prefix of layer to size nodes, moving in the sparse nodes it covers. */
+                    void reserve_dense(const std::size_t layer, const std::size_t size) {
+                        level_type &level = levels[layer];
+                        if (size <= level.dense.size()) {
+                            return;
+                        }
+
+                        level.dense.resize(size, packed_defaults[layer]);
+                        for (auto it = level.sparse.begin(); it != level.sparse.end();) {
+                            if (it->first < size) {
+                                level.dense[it->first] = it->second;
+                                it = level.sparse.erase(it);
+                            } else {
+                                ++it;
+                            }
+                        }
+                    }
+
+                    const packed_digest_type &node(const std::size_t layer, const std::size_t position) const {
+                        const level_type &level = levels[layer];
+                        if (position < level.dense.size()) {
+                            return level.dense[position];
+                        }
+                        if (!level.sparse.empty()) {
+                            auto it = level.sparse.find(position);
+                            if (it != level.sparse.end()) {
+                                return it->second;
+                            }
+                        }
+                        return packed_defaults[layer];
+                    }
+
+                    packed_digest_type &mutable_node(const std::size_t layer, const std::size_t position) {
+                        level_type &level = levels[layer];
+                        const std::size_t size = level.dense.size();
+                        if (position >= size && position < 2 * size + min_dense_growth) {
+                            reserve_dense(layer, std::min(std::max(position + 1, 2 * size),
+                                                          std::size_t(1) << layer));
+                        }
+                        if (position < level.dense.size()) {
+                            return level.dense[position];
+                        }
+
+                        return level.sparse.emplace(position, packed_defaults[layer]).first->second;
+                    }
+
+                    /* the hash is fed bit vectors, so the children are only expanded at this boundary */
+                    digest_type children_input(const std::size_t layer, const std::size_t position) const {
+                        return two_to_one_CRH_input<Hash>(node(layer + 1, 2 * position).to_bits(),
+                                                          node(layer + 1, 2 * position + 1).to_bits());
+                    }
+
+                    packed_digest_type hash_children(const std::size_t layer, const std::size_t position) const {
+                        return packed_digest_type(Hash::get_hash(children_input(layer, position)));
+                    }
+
+                    /*
+                     * Recomputes the ancestors of the given leaf positions, one level at a time. The
+                     * nodes of a level are allocated first, then hashed in independent batches on the
+                     * current executor.
+                     */
+                    void rehash(std::vector<std::size_t> positions) {
+                        std::vector<packed_digest_type *> outputs;
+                        std::sort(positions.begin(), positions.end());
+                        for (std::size_t layer = depth; layer > 0; --layer) {
+                            for (std::size_t &position : positions) {
+                                position /= 2;
+                            }
+                            positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+                            // growing the dense prefix moves it, so the outputs are taken once it is final
+                            for (const std::size_t position : positions) {
+                                mutable_node(layer - 1, position);
+                            }
+                            outputs.resize(positions.size());
+                            for (std::size_t i = 0; i < positions.size(); ++i) {
+                                outputs[i] = &mutable_node(layer - 1, positions[i]);
+                            }
+
+                            multi_buffer_hash_each<Hash>(
+                                positions.size(),
+                                [&](const std::size_t i) { return children_input(layer - 1, positions[i]); },
+                                [&](const std::size_t i, const digest_type &digest) {
+                                    *outputs[i] = packed_digest_type(digest);
+                                });
+                        }
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
@@ -0,0 +1,325 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the multi-buffer hashing of independent messages.
+//
+// The Merkle trees and set commitments hash many independent messages: the
+// children of every node of a level, or the values inserted at once. A hash
+// whose get_hashes(inputs) digests a batch of bit vectors together, next to
+// get_hash, is given whole batches by multi_buffer_hash_each; other hashes are
+// called once per message. sha256_multi_buffer is such a hash: it compresses
+// the blocks of multi_buffer_lanes messages in one pass over lane-interleaved
+// state, a loop over the lanes that the compiler maps onto the SIMD registers
+// of the target (4 lanes by default, 8 with AVX2 and 16 with AVX-512).
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_MULTI_BUFFER_HASH_HPP
+#define CRYPTO3_ZK_SNARK_MULTI_BUFFER_HASH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+#if defined(__AVX512F__)
+                constexpr static const std::size_t multi_buffer_lanes = 16;
+#elif defined(__AVX2__)
+                constexpr static const std::size_t multi_buffer_lanes = 8;
+#else
+                constexpr static const std::size_t multi_buffer_lanes = 4;
+#endif
+
+                namespace detail {
+
+                    template<typename Hash, typename = void>
+                    struct has_multi_buffer_hash : std::false_type { };
+
+                    template<typename Hash>
+                    struct has_multi_buffer_hash<Hash, decltype(void(Hash::get_hashes(
+                                                           std::declval<const std::vector<std::vector<bool>> &>())))>
+                        : std::true_type { };
+
+                    /* messages per task: enough full groups of lanes to amortize the batch */
+                    template<typename Hash>
+                    constexpr std::size_t multi_buffer_batch_size() {
+                        return has_multi_buffer_hash<Hash>::value ? 8 * multi_buffer_lanes : 1;
+                    }
+
+                    template<typename Hash>
+                    std::vector<typename Hash::digest_type> hash_batch(const std::vector<std::vector<bool>> &inputs,
+                                                                       std::true_type) {
+                        return Hash::get_hashes(inputs);
+                    }
+
+                    template<typename Hash>
+                    std::vector<typename Hash::digest_type> hash_batch(const std::vector<std::vector<bool>> &inputs,
+                                                                       std::false_type) {
+                        std::vector<typename Hash::digest_type> result;
+                        result.reserve(inputs.size());
+                        for (const std::vector<bool> &input : inputs) {
+                            result.emplace_back(Hash::get_hash(input));
+                        }
+                        return result;
+                    }
+
+                    /*
+                     * SHA-256 of Lanes messages at once. The state and the message schedule are stored
+                     * word by word with the lanes innermost, so every step of the compression is a loop
+                     * over the lanes without dependencies between them.
+                     */
+                    template<std::size_t Lanes>
+                    struct sha256_lanes {
+                        typedef std::array<std::array<std::uint32_t, Lanes>, 8> state_type;
+
+                        static void init(state_type &state) {
+                            constexpr static const std::uint32_t iv[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                                                          0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                                                          0x1f83d9ab, 0x5be0cd19};
+                            for (std::size_t word = 0; word < 8; ++word) {
+                                state[word].fill(iv[word]);
+                            }
+                        }
+
+                        /* compresses the 64-byte block blocks[lane] into the state of every lane */
+                        static void compress(state_type &state, const std::uint8_t *const *blocks) {
+                            constexpr static const std::uint32_t k[64] = {
+                                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+                                0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+                                0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+                                0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+                                0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+                                0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+                                0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+                                0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+                                0xc67178f2};
+
+                            std::uint32_t w[64][Lanes];
+                            for (std::size_t t = 0; t < 16; ++t) {
+                                for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                                    const std::uint8_t *word = blocks[lane] + 4 * t;
+                                    w[t][lane] = std::uint32_t(word[0]) << 24 | std::uint32_t(word[1]) << 16 |
+                                                 std::uint32_t(word[2]) << 8 | std::uint32_t(word[3]);
+                                }
+                            }
+                            for (std::size_t t = 16; t < 64; ++t) {
+                                for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                                    const std::uint32_t s0 = rotr(w[t - 15][lane], 7) ^ rotr(w[t - 15][lane], 18) ^
+                                                             (w[t - 15][lane] >> 3);
+                                    const std::uint32_t s1 = rotr(w[t - 2][lane], 17) ^ rotr(w[t - 2][lane], 19) ^
+                                                             (w[t - 2][lane] >> 10);
+                                    w[t][lane] = w[t - 16][lane] + s0 + w[t - 7][lane] + s1;
+                                }
+                            }
+
+                            state_type v = state;
+                            for (std::size_t t = 0; t < 64; ++t) {
+                                for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                                    const std::uint32_t a = v[0][lane], b = v[1][lane], c = v[2][lane],
+                                                        d = v[3][lane], e = v[4][lane], f = v[5][lane],
+                                                        g = v[6][lane], h = v[7][lane];
+                                    const std::uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) +
+                                                             ((e & f) ^ (~e & g)) + k[t] + w[t][lane];
+                                    const std::uint32_t t2 =
+                                        (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                                    v[7][lane] = g;
+                                    v[6][lane] = f;
+                                    v[5][lane] = e;
+                                    v[4][lane] = d + t1;
+                                    v[3][lane] = c;
+                                    v[2][lane] = b;
+                                    v[1][lane] = a;
+                                    v[0][lane] = t1 + t2;
+                                }
+                            }
+                            for (std::size_t word = 0; word < 8; ++word) {
+                                for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                                    state[word][lane] += v[word][lane];
+                                }
+                            }
+                        }
+
+                    private:
+                        static std::uint32_t rotr(const std::uint32_t x, const unsigned n) {
+                            return (x >> n) | (x << (32 - n));
+                        }
+                    };
+                }    // namespace detail
+
+                /**
+                 * Calls output(i, digest) with the digest of input(i) by Hash for every i in [0, n), the
+                 * messages being hashed in batches on the current executor. A Hash providing get_hashes
+                 * is given multi_buffer_lanes messages at a time or more.
+                 */
+                template<typename Hash, typename InputFunction, typename OutputFunction>
+                void multi_buffer_hash_each(const std::size_t n, InputFunction input, OutputFunction output) {
+                    constexpr const std::size_t batch_size = detail::multi_buffer_batch_size<Hash>();
+                    const std::size_t num_batches = (n + batch_size - 1) / batch_size;
+
+                    executor::current().parallel_for(num_batches, [&](const std::size_t batch) {
+                        const std::size_t first = batch * batch_size;
+                        const std::size_t last = std::min(n, first + batch_size);
+
+                        std::vector<std::vector<bool>> inputs;
+                        inputs.reserve(last - first);
+                        for (std::size_t i = first; i < last; ++i) {
+                            inputs.emplace_back(input(i));
+                        }
+
+                        std::vector<typename Hash::digest_type> digests = detail::hash_batch<Hash>(
+                            inputs, std::integral_constant<bool, detail::has_multi_buffer_hash<Hash>::value>());
+                        for (std::size_t i = first; i < last; ++i) {
+                            output(i, std::move(digests[i - first]));
+                        }
+                    });
+                }
+
+                /**
+                 * SHA-256 of bit strings of any length, the bits of each byte being taken most
+                 * significant first, as a hash of the Merkle trees and set commitments. Independent
+                 * messages are hashed multi_buffer_lanes at a time by get_hashes.
+                 */
+                struct sha256_multi_buffer {
+                    typedef std::vector<bool> hash_value_type;
+                    typedef std::vector<bool> digest_type;
+                    typedef std::vector<digest_type> merkle_authentication_path_type;
+
+                    constexpr static const std::size_t digest_bits = 256;
+                    constexpr static const std::size_t block_bytes = 64;
+
+                    static std::size_t get_digest_len() {
+                        return digest_bits;
+                    }
+
+                    static digest_type get_hash(const hash_value_type &input) {
+                        return get_hashes(std::vector<hash_value_type>(1, input))[0];
+                    }
+
+                    static std::vector<digest_type> get_hashes(const std::vector<hash_value_type> &inputs) {
+                        typedef detail::sha256_lanes<multi_buffer_lanes> lanes_type;
+
+                        std::vector<message_type> messages(inputs.size());
+                        for (std::size_t i = 0; i < inputs.size(); ++i) {
+                            messages[i].bits = inputs[i].size();
+                            messages[i].bytes.resize((inputs[i].size() + 7) / 8);
+                            for (std::size_t j = 0; j < inputs[i].size(); ++j) {
+                                if (inputs[i][j]) {
+                                    messages[i].bytes[j / 8] |= std::uint8_t(0x80 >> (j % 8));
+                                }
+                            }
+                        }
+
+                        std::vector<digest_type> result(inputs.size(), digest_type(digest_bits));
+                        std::array<std::array<std::uint8_t, block_bytes>, multi_buffer_lanes> padded;
+                        std::array<const std::uint8_t *, multi_buffer_lanes> blocks;
+                        typename lanes_type::state_type state, final_state;
+
+                        for (std::size_t first = 0; first < messages.size(); first += multi_buffer_lanes) {
+                            const std::size_t count = std::min(multi_buffer_lanes, messages.size() - first);
+                            std::size_t num_blocks = 0;
+                            for (std::size_t lane = 0; lane < count; ++lane) {
+                                num_blocks = std::max(num_blocks, messages[first + lane].num_blocks());
+                            }
+
+                            // a lane past its last block, or without a message, goes on over a zero block
+                            lanes_type::init(state);
+                            for (std::size_t block = 0; block < num_blocks; ++block) {
+                                for (std::size_t lane = 0; lane < multi_buffer_lanes; ++lane) {
+                                    if (lane < count && block < messages[first + lane].num_blocks()) {
+                                        blocks[lane] = messages[first + lane].block(block, padded[lane]);
+                                    } else {
+                                        padded[lane].fill(0);
+                                        blocks[lane] = padded[lane].data();
+                                    }
+                                }
+                                lanes_type::compress(state, blocks.data());
+                                for (std::size_t lane = 0; lane < count; ++lane) {
+                                    if (block + 1 == messages[first + lane].num_blocks()) {
+                                        for (std::size_t word = 0; word < 8; ++word) {
+                                            final_state[word][lane] = state[word][lane];
+                                        }
+                                    }
+                                }
+                            }
+
+                            for (std::size_t lane = 0; lane < count; ++lane) {
+                                digest_type &digest = result[first + lane];
+                                for (std::size_t i = 0; i < digest_bits; ++i) {
+                                    digest[i] = (final_state[i / 32][lane] >> (31 - i % 32)) & 1;
+                                }
+                            }
+                        }
+                        return result;
+                    }
+
+                private:
+                    struct message_type {
+                        std::vector<std::uint8_t> bytes;
+                        std::size_t bits = 0;
+
+                        /* the message, a one bit, zeros, and the 64-bit length fill whole blocks */
+                        std::size_t num_blocks() const {
+                            return (bits + 1 + 64 + 8 * block_bytes - 1) / (8 * block_bytes);
+                        }
+
+                        /* the padded block of the message, in place when it holds message bytes only */
+                        const std::uint8_t *block(const std::size_t index,
+                                                  std::array<std::uint8_t, block_bytes> &padded) const {
+                            const std::size_t offset = index * block_bytes;
+                            if (8 * (offset + block_bytes) <= bits) {
+                                return bytes.data() + offset;
+                            }
+
+                            padded.fill(0);
+                            for (std::size_t i = offset; i < std::min(bytes.size(), offset + block_bytes); ++i) {
+                                padded[i - offset] = bytes[i];
+                            }
+                            const std::size_t end = bits / 8;
+                            if (end >= offset && end < offset + block_bytes) {
+                                padded[end - offset] |= std::uint8_t(0x80 >> (bits % 8));
+                            }
+                            if (index + 1 == num_blocks()) {
+                                for (std::size_t i = 0; i < 8; ++i) {
+                                    padded[block_bytes - 1 - i] = std::uint8_t(std::uint64_t(bits) >> (8 * i));
+                                }
+                            }
+                            return padded.data();
+                        }
+                    };
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_MULTI_BUFFER_HASH_HPP
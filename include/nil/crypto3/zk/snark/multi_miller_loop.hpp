@@ -0,0 +1,129 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a multi-Miller loop computing products of pairings.
+//
+// A product of pairings \prod_i e(P_i, Q_i) only needs a single final
+// exponentiation, applied to the product of the Miller loops. The Miller loops
+// themselves are run two at a time through the double Miller loop of the pairing
+// policy, which advances both loops in lockstep and shares the squarings of their
+// accumulator, and the pairs are split across the current executor.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_MULTI_MILLER_LOOP_HPP
+#define CRYPTO3_ZK_MULTI_MILLER_LOOP_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+
+                    template<typename CurveType>
+                    struct miller_loop_operand {
+                        typedef typename CurveType::pairing pairing_policy;
+
+                        static typename pairing_policy::g1_precomp
+                            precompute(const typename CurveType::g1_type::value_type &P) {
+                            return pairing_policy::precompute_g1(P);
+                        }
+
+                        static const typename pairing_policy::g1_precomp &
+                            precompute(const typename pairing_policy::g1_precomp &P) {
+                            return P;
+                        }
+
+                        static typename pairing_policy::g2_precomp
+                            precompute(const typename CurveType::g2_type::value_type &Q) {
+                            return pairing_policy::precompute_g2(Q);
+                        }
+
+                        static const typename pairing_policy::g2_precomp &
+                            precompute(const typename pairing_policy::g2_precomp &Q) {
+                            return Q;
+                        }
+                    };
+                }    // namespace detail
+
+                /**
+                 * Product of the Miller loops of (*(g1_first + i), *(g2_first + i)) for i in
+                 * [0, g1_last - g1_first), the final exponentiation being left to the caller.
+                 *
+                 * Both iterators are random access; their elements are either points or precomputed
+                 * points of the pairing policy, so fixed operands such as verification key elements
+                 * are precomputed once by the caller.
+                 */
+                template<typename CurveType, typename InputG1Iterator, typename InputG2Iterator>
+                typename CurveType::pairing::fqk_type::value_type
+                    multi_miller_loop(InputG1Iterator g1_first, InputG1Iterator g1_last, InputG2Iterator g2_first) {
+                    typedef typename CurveType::pairing pairing_policy;
+                    typedef typename pairing_policy::fqk_type::value_type fqk_value_type;
+                    typedef detail::miller_loop_operand<CurveType> operand;
+
+                    const std::size_t n = std::distance(g1_first, g1_last);
+                    const std::size_t num_pairs = n / 2;
+                    operation_counter::add(operation_counter::miller_loop, n);
+
+                    const std::size_t num_blocks = std::max<std::size_t>(
+                        1, std::min(num_pairs, executor::current().concurrency()));
+                    const std::size_t block_size = (num_pairs + num_blocks - 1) / num_blocks;
+
+                    std::vector<fqk_value_type> products(num_blocks, fqk_value_type::one());
+                    executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                        const std::size_t end = std::min(num_pairs, (block + 1) * block_size);
+                        for (std::size_t i = block * block_size; i < end; ++i) {
+                            products[block] =
+                                products[block] *
+                                pairing_policy::double_miller_loop(
+                                    operand::precompute(*(g1_first + 2 * i)), operand::precompute(*(g2_first + 2 * i)),
+                                    operand::precompute(*(g1_first + 2 * i + 1)),
+                                    operand::precompute(*(g2_first + 2 * i + 1)));
+                        }
+                    });
+
+                    fqk_value_type result = products[0];
+                    for (std::size_t block = 1; block < num_blocks; ++block) {
+                        result = result * products[block];
+                    }
+
+                    if (n % 2) {
+                        result = result * pairing_policy::miller_loop(operand::precompute(*(g1_first + (n - 1))),
+                                                                      operand::precompute(*(g2_first + (n - 1))));
+                    }
+
+                    return result;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_MULTI_MILLER_LOOP_HPP
@@ -0,0 +1,376 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the dispatcher choosing the multi-exponentiation method of every call.
+//
+// The best method of the algebra library depends on the call: naive exponentiation wins for
+// a handful of terms, Bos-Coster for small ones, the bucket method BDLO12 for large ones and
+// its batched affine variant for the largest, see batch_affine_multiexp.hpp. Splitting a call
+// into chunks for the threads of the executor only pays once every chunk has enough terms to
+// amortize its final additions. The zero scalars, which every method skips, and the unit
+// ones, which the mixed-addition variants add directly, do not count as terms.
+//
+// The library calls the multi-exponentiation through dispatch_multiexp, or
+// dispatch_multiexp_with_mixed_addition, with a method: an algebra method is used as is,
+// while multiexp_method_auto counts the non-trivial scalars and plans the call with the
+// multiexp_tuning of the group of the bases, one for G1 and one for G2. BDLO12 derives its
+// window from the length of the chunks it runs over, so the chunk count is what tunes it.
+//
+// multiexp_method_uniform plans the call from its length alone and never takes the
+// mixed-addition shortcut, so neither the method nor the chunking depends on the values of
+// the scalars. Nor does it take the batched affine additions, whose collisions do. It is the
+// method of the constant-time execution policy, see execution_policy.hpp.
+//
+// The default thresholds suit the curves of the library on a common x86-64 machine; a
+// calibration benchmark measures them on the target and installs them before proving:
+//
+//     multiexp_tuning<g1_value_type>::current() =
+//         multiexp_tuning<g1_value_type>::calibrate(bases.begin(), scalars.begin(), 1 << 16);
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_MULTIEXP_DISPATCH_HPP
+#define CRYPTO3_ZK_MULTIEXP_DISPATCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+#include <nil/crypto3/algebra/multiexp/policies.hpp>
+
+#include <nil/crypto3/zk/snark/batch_affine_multiexp.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Multi-exponentiation method chosen per call by the multiexp_tuning of the group.
+                 */
+                struct multiexp_method_auto { };
+
+                /**
+                 * Multi-exponentiation method chosen per call from the number of terms only, every
+                 * scalar counting as non-trivial.
+                 */
+                struct multiexp_method_uniform { };
+
+                enum class multiexp_algorithm { naive, bos_coster, BDLO12, batch_affine };
+
+                struct multiexp_plan {
+                    multiexp_algorithm algorithm;
+                    std::size_t chunks;
+                };
+
+                /**
+                 * The thresholds of multiexp_method_auto for the group whose elements are of GroupValueType.
+                 *
+                 * A call of at most naive_max_terms non-trivial terms is evaluated naively, one of at
+                 * most bos_coster_max_terms by Bos-Coster and a larger one by BDLO12. The call is split
+                 * into as many chunks as the caller allows, but into no more than one per
+                 * min_terms_per_chunk non-trivial terms. A BDLO12 call whose chunks have at least
+                 * batch_affine_min_terms non-trivial terms each takes the batched affine additions.
+                 */
+                template<typename GroupValueType>
+                struct multiexp_tuning {
+                    std::size_t naive_max_terms = 4;
+                    std::size_t bos_coster_max_terms = 1024;
+                    std::size_t min_terms_per_chunk = 1024;
+                    std::size_t batch_affine_min_terms = std::size_t(1) << 14;
+
+                    static multiexp_tuning &current() {
+                        static multiexp_tuning tuning;
+                        return tuning;
+                    }
+
+                    /* Plan of a call of num_terms terms, of which num_nontrivial are non-trivial. */
+                    multiexp_plan plan(const std::size_t num_terms, const std::size_t num_nontrivial,
+                                       const std::size_t max_chunks) const {
+                        multiexp_plan result;
+                        result.algorithm = num_nontrivial <= naive_max_terms      ? multiexp_algorithm::naive :
+                                           num_nontrivial <= bos_coster_max_terms ? multiexp_algorithm::bos_coster :
+                                                                                    multiexp_algorithm::BDLO12;
+                        result.chunks = std::max<std::size_t>(
+                            1, std::min({max_chunks, num_terms, num_nontrivial / std::max<std::size_t>(
+                                                                                      1, min_terms_per_chunk)}));
+                        if (result.algorithm == multiexp_algorithm::BDLO12 &&
+                            num_nontrivial / result.chunks >= batch_affine_min_terms) {
+                            result.algorithm = multiexp_algorithm::batch_affine;
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Thresholds measured on this machine with the terms [bases_first, bases_first + max_terms)
+                     * and [scalars_first, scalars_first + max_terms), which should be random, on the current
+                     * executor. Every method is timed over 2, 4, ..., max_terms terms, the best of repetitions
+                     * runs, until it has lost to the next one. The batched affine additions take over from
+                     * the first number of terms at which they beat BDLO12, if any.
+                     */
+                    template<typename InputBaseIterator, typename InputFieldIterator>
+                    static multiexp_tuning calibrate(InputBaseIterator bases_first, InputFieldIterator scalars_first,
+                                                     const std::size_t max_terms,
+                                                     const std::size_t repetitions = 3) {
+                        const std::size_t concurrency = executor::current().concurrency();
+                        const auto seconds = [&](auto multiexp) {
+                            double best = 0;
+                            for (std::size_t r = 0; r < repetitions; ++r) {
+                                const auto start = std::chrono::steady_clock::now();
+                                const GroupValueType sum = multiexp();
+                                const double elapsed =
+                                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                                (void)sum;
+                                best = r ? std::min(best, elapsed) : elapsed;
+                            }
+                            return best;
+                        };
+
+                        multiexp_tuning result;
+                        bool naive_wins = true, bos_coster_wins = true;
+                        result.naive_max_terms = result.bos_coster_max_terms = 1;
+                        result.min_terms_per_chunk = max_terms;
+                        result.batch_affine_min_terms = std::numeric_limits<std::size_t>::max();
+                        for (std::size_t n = 2; n <= max_terms; n *= 2) {
+                            const auto bases_last = bases_first + n;
+                            const auto scalars_last = scalars_first + n;
+                            const auto time = [&](auto method, const std::size_t chunks) {
+                                return seconds([&]() {
+                                    return algebra::multiexp<decltype(method)>(bases_first, bases_last,
+                                                                               scalars_first, scalars_last, chunks);
+                                });
+                            };
+
+                            const double bos_coster = time(algebra::policies::multiexp_method_bos_coster(), 1);
+                            if (naive_wins) {
+                                naive_wins = time(algebra::policies::multiexp_method_naive_plain(), 1) < bos_coster;
+                                if (naive_wins) {
+                                    result.naive_max_terms = n;
+                                }
+                            }
+                            const double BDLO12 = time(algebra::policies::multiexp_method_BDLO12(), 1);
+                            if (bos_coster_wins) {
+                                bos_coster_wins = bos_coster < BDLO12;
+                                if (bos_coster_wins) {
+                                    result.bos_coster_max_terms = n;
+                                }
+                            }
+                            if (result.batch_affine_min_terms > max_terms &&
+                                seconds([&]() {
+                                    return batch_affine_multiexp(bases_first, bases_last, scalars_first,
+                                                                 scalars_last, 1);
+                                }) < BDLO12) {
+                                result.batch_affine_min_terms = n;
+                            }
+                            if (concurrency > 1 && result.min_terms_per_chunk == max_terms &&
+                                time(algebra::policies::multiexp_method_BDLO12(), concurrency) < BDLO12) {
+                                result.min_terms_per_chunk = std::max<std::size_t>(1, n / concurrency);
+                            }
+                        }
+                        return result;
+                    }
+                };
+
+                namespace detail {
+                    template<typename MultiexpMethod>
+                    struct multiexp_method_tag { };
+
+                    /* Number of scalars of [scalars_first, scalars_last) other than zero and one. */
+                    template<typename InputFieldIterator>
+                    std::size_t count_nontrivial_scalars(InputFieldIterator scalars_first,
+                                                         InputFieldIterator scalars_last) {
+                        typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
+
+                        const field_value_type one = field_value_type::one();
+                        return std::count_if(scalars_first, scalars_last, [&](const field_value_type &scalar) {
+                            return !scalar.is_zero() && scalar != one;
+                        });
+                    }
+
+                    template<typename GroupValueType, typename InputFieldIterator>
+                    multiexp_plan plan_multiexp(multiexp_method_tag<multiexp_method_auto>,
+                                                InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                                const std::size_t chunks) {
+                        return multiexp_tuning<GroupValueType>::current().plan(
+                            std::distance(scalars_first, scalars_last),
+                            count_nontrivial_scalars(scalars_first, scalars_last), chunks);
+                    }
+
+                    /* the collisions of the batched affine additions depend on the digits, so BDLO12 runs instead */
+                    template<typename GroupValueType, typename InputFieldIterator>
+                    multiexp_plan plan_multiexp(multiexp_method_tag<multiexp_method_uniform>,
+                                                InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                                const std::size_t chunks) {
+                        const std::size_t num_terms = std::distance(scalars_first, scalars_last);
+                        multiexp_plan result =
+                            multiexp_tuning<GroupValueType>::current().plan(num_terms, num_terms, chunks);
+                        if (result.algorithm == multiexp_algorithm::batch_affine) {
+                            result.algorithm = multiexp_algorithm::BDLO12;
+                        }
+                        return result;
+                    }
+
+                    template<typename MultiexpMethod, typename InputBaseIterator, typename InputFieldIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        algebra_multiexp(std::false_type, InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                         InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                         const std::size_t chunks) {
+                        return algebra::multiexp<MultiexpMethod>(bases_first, bases_last, scalars_first,
+                                                                 scalars_last, chunks);
+                    }
+
+                    template<typename MultiexpMethod, typename InputBaseIterator, typename InputFieldIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        algebra_multiexp(std::true_type, InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                         InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                         const std::size_t chunks) {
+                        return algebra::multiexp_with_mixed_addition<MultiexpMethod>(
+                            bases_first, bases_last, scalars_first, scalars_last, chunks);
+                    }
+
+                    template<typename MultiexpMethod, typename MixedAddition, typename InputBaseIterator,
+                             typename InputFieldIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        dispatch_multiexp(multiexp_method_tag<MultiexpMethod>, MixedAddition mixed_addition,
+                                          InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                          InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                          const std::size_t chunks) {
+                        return algebra_multiexp<MultiexpMethod>(mixed_addition, bases_first, bases_last,
+                                                                scalars_first, scalars_last, chunks);
+                    }
+
+                    /* the bases of unit scalars fall in the buckets of digit one, so mixed addition is implied */
+                    template<typename MixedAddition, typename InputBaseIterator, typename InputFieldIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        dispatch_multiexp(multiexp_method_tag<multiexp_method_batch_affine>, MixedAddition,
+                                          InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                          InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                          const std::size_t chunks) {
+                        return batch_affine_multiexp(bases_first, bases_last, scalars_first, scalars_last, chunks);
+                    }
+
+                    template<typename MixedAddition, typename InputBaseIterator, typename InputFieldIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        dispatch_multiexp(multiexp_method_tag<multiexp_method_auto>, MixedAddition mixed_addition,
+                                          InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                          InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                          const std::size_t chunks) {
+                        typedef typename std::iterator_traits<InputBaseIterator>::value_type value_type;
+
+                        const multiexp_plan plan = plan_multiexp<value_type>(
+                            multiexp_method_tag<multiexp_method_auto>(), scalars_first, scalars_last, chunks);
+                        switch (plan.algorithm) {
+                            case multiexp_algorithm::naive:
+                                return algebra_multiexp<algebra::policies::multiexp_method_naive_plain>(
+                                    mixed_addition, bases_first, bases_last, scalars_first, scalars_last,
+                                    plan.chunks);
+                            case multiexp_algorithm::bos_coster:
+                                return algebra_multiexp<algebra::policies::multiexp_method_bos_coster>(
+                                    mixed_addition, bases_first, bases_last, scalars_first, scalars_last,
+                                    plan.chunks);
+                            case multiexp_algorithm::batch_affine:
+                                return batch_affine_multiexp(bases_first, bases_last, scalars_first, scalars_last,
+                                                             plan.chunks);
+                            default:
+                                return algebra_multiexp<algebra::policies::multiexp_method_BDLO12>(
+                                    mixed_addition, bases_first, bases_last, scalars_first, scalars_last,
+                                    plan.chunks);
+                        }
+                    }
+
+                    /* mixed addition adds the bases of unit scalars directly, so it is never used here */
+                    template<typename MixedAddition, typename InputBaseIterator, typename InputFieldIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        dispatch_multiexp(multiexp_method_tag<multiexp_method_uniform>, MixedAddition,
+                                          InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                          InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                          const std::size_t chunks) {
+                        typedef typename std::iterator_traits<InputBaseIterator>::value_type value_type;
+
+                        const multiexp_plan plan = plan_multiexp<value_type>(
+                            multiexp_method_tag<multiexp_method_uniform>(), scalars_first, scalars_last, chunks);
+                        switch (plan.algorithm) {
+                            case multiexp_algorithm::naive:
+                                return algebra_multiexp<algebra::policies::multiexp_method_naive_plain>(
+                                    std::false_type(), bases_first, bases_last, scalars_first, scalars_last,
+                                    plan.chunks);
+                            case multiexp_algorithm::bos_coster:
+                                return algebra_multiexp<algebra::policies::multiexp_method_bos_coster>(
+                                    std::false_type(), bases_first, bases_last, scalars_first, scalars_last,
+                                    plan.chunks);
+                            default:
+                                return algebra_multiexp<algebra::policies::multiexp_method_BDLO12>(
+                                    std::false_type(), bases_first, bases_last, scalars_first, scalars_last,
+                                    plan.chunks);
+                        }
+                    }
+                }    // namespace detail
+
+                /**
+                 * The plan dispatch_multiexp follows for a call over bases of GroupValueType and the scalars
+                 * [scalars_first, scalars_last), split into at most chunks, with MultiexpMethod, which is
+                 * multiexp_method_auto or multiexp_method_uniform.
+                 */
+                template<typename MultiexpMethod, typename GroupValueType, typename InputFieldIterator>
+                multiexp_plan plan_multiexp(InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                            const std::size_t chunks) {
+                    return detail::plan_multiexp<GroupValueType>(detail::multiexp_method_tag<MultiexpMethod>(),
+                                                                 scalars_first, scalars_last, chunks);
+                }
+
+                /**
+                 * algebra::multiexp with MultiexpMethod, which multiexp_method_auto and
+                 * multiexp_method_uniform choose for the call; multiexp_method_batch_affine runs
+                 * batch_affine_multiexp.
+                 */
+                template<typename MultiexpMethod, typename InputBaseIterator, typename InputFieldIterator>
+                typename std::iterator_traits<InputBaseIterator>::value_type
+                    dispatch_multiexp(InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                      InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                      const std::size_t chunks) {
+                    return detail::dispatch_multiexp(detail::multiexp_method_tag<MultiexpMethod>(), std::false_type(),
+                                                     bases_first, bases_last, scalars_first, scalars_last, chunks);
+                }
+
+                /**
+                 * algebra::multiexp_with_mixed_addition with MultiexpMethod, which multiexp_method_auto
+                 * chooses for the call.
+                 */
+                template<typename MultiexpMethod, typename InputBaseIterator, typename InputFieldIterator>
+                typename std::iterator_traits<InputBaseIterator>::value_type
+                    dispatch_multiexp_with_mixed_addition(InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                                          InputFieldIterator scalars_first,
+                                                          InputFieldIterator scalars_last, const std::size_t chunks) {
+                    return detail::dispatch_multiexp(detail::multiexp_method_tag<MultiexpMethod>(), std::true_type(),
+                                                     bases_first, bases_last, scalars_first, scalars_last, chunks);
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_MULTIEXP_DISPATCH_HPP
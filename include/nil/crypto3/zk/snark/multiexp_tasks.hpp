@@ -0,0 +1,244 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the list of multi-exponentiation tasks run together by the provers.
+//
+// A prover computes several multi-exponentiations of very different sizes, with
+// bases in G1 or G2, and the H polynomial besides. Run one after the other, each
+// of them parallelized on its own, the smaller ones leave most of the threads
+// idle. The provers split them instead into tasks of similar cost, weighting a G2
+// addition at three G1 additions, with about four tasks per thread, and hand all
+// of them to the current executor at once. The witness map runs meanwhile on a
+// thread of its own, with an executor on its share of the threads, so that its
+// FFTs stay parallel loops instead of one sequential task among the multiexps:
+//
+//     multiexp_task_list tasks(total_cost);
+//     tasks.add_alongside([&]() { H = coefficients_for_H(...); }, multiexp_task_list::fft_cost(m, 7));
+//     tasks.add(parts_A, num_variables, multiexp_task_list::g1_cost, [&](std::size_t first, std::size_t last) {
+//         return multiexp of the terms [first, last) of A;
+//     });
+//     tasks.run();
+//     A = multiexp_task_list::sum(parts_A);
+//
+// Every task knows where its range lies within its vector, and the list hands these positions
+// to the executor, so that an executor over several memory domains runs the tasks of a range
+// on the domain its part of the vector was placed on, see numa.hpp.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_MULTIEXP_TASKS_HPP
+#define CRYPTO3_ZK_MULTIEXP_TASKS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <cmath>
+#include <exception>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/memory_budget.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                class multiexp_task_list {
+                public:
+                    /* Relative costs of a G1 and a G2 addition, used to balance the tasks. */
+                    static constexpr const std::size_t g1_cost = 1;
+                    static constexpr const std::size_t g2_cost = 3;
+                    static constexpr const std::size_t tasks_per_thread = 4;
+
+                    /**
+                     * A list for multi-exponentiations costing total_cost altogether, which sets the
+                     * cost of a single task. max_task_cost caps it, so that the working memory of the
+                     * tasks running at once fits a memory budget, see memory_budget.hpp.
+                     */
+                    explicit multiexp_task_list(const std::size_t total_cost,
+                                                const std::size_t max_task_cost = memory_budget::unlimited) :
+                        grain(std::max<std::size_t>(
+                            1, std::min(max_task_cost,
+                                        total_cost / (tasks_per_thread * executor::current().concurrency())))) {
+                    }
+
+                    /**
+                     * Cost of num_ffts FFTs over a domain of domain_size, in G1 multiexp terms: a butterfly
+                     * takes one field multiplication, a term about sixteen additions of twelve.
+                     */
+                    static std::size_t fft_cost(const std::size_t domain_size, const std::size_t num_ffts) {
+                        const std::size_t log_size = std::size_t(std::ceil(std::log2(double(domain_size + 1))));
+                        return std::max<std::size_t>(1, num_ffts * domain_size * log_size / (2 * 16 * 12));
+                    }
+
+                    /**
+                     * Runs f on a thread of its own while run() runs the other tasks, with an executor on
+                     * a share of the threads of the current one in proportion to cost, counted as that of
+                     * the other tasks. f may throw; run() rethrows once the other tasks are done.
+                     */
+                    template<typename Function>
+                    void add_alongside(Function f, const std::size_t cost) {
+                        BOOST_ASSERT(!alongside);
+                        alongside = f;
+                        alongside_cost = cost;
+                    }
+
+                    /**
+                     * A task of its own among the multiexps. A task running a multi-exponentiation of its
+                     * own gives its cost, counted in the progress.
+                     */
+                    template<typename Function>
+                    void add(Function f, const std::size_t cost = 0) {
+                        tasks.emplace_back(f);
+                        costs.emplace_back(cost);
+                        positions.emplace_back(0);
+                    }
+
+                    /**
+                     * Splits [0, size) into consecutive ranges of about grain / weight terms, and adds one
+                     * task computing parts[i] = f(first, last) for each of them.
+                     */
+                    template<typename ValueType, typename Function>
+                    void add(std::vector<ValueType> &parts, const std::size_t size, const std::size_t weight,
+                             Function f) {
+                        const std::size_t num_parts =
+                            std::max<std::size_t>(1, std::min(size, size * weight / grain));
+                        parts.assign(num_parts, ValueType::zero());
+
+                        ValueType *out = parts.data();
+                        for (std::size_t i = 0; i < num_parts; ++i) {
+                            const std::size_t first = i * size / num_parts;
+                            const std::size_t last = (i + 1) * size / num_parts;
+                            tasks.emplace_back([f, out, i, first, last]() { out[i] = f(first, last); });
+                            costs.emplace_back((last - first) * weight);
+                            positions.emplace_back(0.5 * double(first + last) / double(size));
+                        }
+                    }
+
+                    /**
+                     * Runs the tasks added so far on the current executor, the one added with add_alongside
+                     * on a thread of its own, and empties the list.
+                     *
+                     * The completed cost of the multi-exponentiation tasks is reported as the progress of the
+                     * current stage. Once the current sink is cancelled, the pending tasks are skipped and
+                     * the checkpoint of the sink is called when they are done.
+                     */
+                    void run() {
+                        const std::size_t total_cost = std::accumulate(costs.begin(), costs.end(), std::size_t(0));
+                        const executor &current = executor::current();
+                        std::function<void()> alongside_task;
+                        alongside_task.swap(alongside);
+
+                        /* with a single thread, or nothing to run alongside, the task runs first on all of them */
+                        if (alongside_task && (current.concurrency() == 1 || tasks.empty())) {
+                            alongside_task();
+                            alongside_task = nullptr;
+                        }
+                        if (!alongside_task) {
+                            run_tasks(current, total_cost);
+                            stage_profiler::current_checkpoint();
+                            return;
+                        }
+
+                        const std::size_t concurrency = current.concurrency();
+                        const std::size_t alongside_threads = std::min(
+                            concurrency - 1,
+                            std::max<std::size_t>(1, std::size_t(std::llround(double(concurrency) * alongside_cost /
+                                                                              double(alongside_cost + total_cost)))));
+                        const executor alongside_executor = current.part(alongside_threads);
+                        const executor tasks_executor = current.part(concurrency - alongside_threads);
+
+                        const stage_profiler::context stages;
+                        operation_counter *const counter = operation_counter::current();
+                        const memory_budget &budget = memory_budget::current();
+                        std::exception_ptr alongside_error;
+                        std::thread alongside_thread([&]() {
+                            executor::scope guard(alongside_executor);
+                            stage_profiler::context::scope stages_guard(stages);
+                            operation_counter::scope counter_guard(counter);
+                            memory_budget::scope budget_guard(budget);
+                            try {
+                                alongside_task();
+                            } catch (...) {
+                                alongside_error = std::current_exception();
+                            }
+                        });
+                        run_tasks(tasks_executor, total_cost);
+                        alongside_thread.join();
+                        if (alongside_error) {
+                            std::rethrow_exception(alongside_error);
+                        }
+                        stage_profiler::current_checkpoint();
+                    }
+
+                    template<typename ValueType>
+                    static ValueType sum(const std::vector<ValueType> &parts) {
+                        ValueType result = ValueType::zero();
+                        for (const ValueType &part : parts) {
+                            result = result + part;
+                        }
+                        return result;
+                    }
+
+                private:
+                    void run_tasks(const executor &e, const std::size_t total_cost) {
+                        std::atomic<std::size_t> completed_cost(0);
+                        e.bulk(
+                            tasks.size(),
+                            [&](const std::size_t i) {
+                                if (stage_profiler::current_cancelled()) {
+                                    return;
+                                }
+                                tasks[i]();
+                                if (costs[i]) {
+                                    stage_profiler::report_progress(completed_cost += costs[i], total_cost);
+                                }
+                            },
+                            positions);
+                        tasks.clear();
+                        costs.clear();
+                        positions.clear();
+                    }
+
+                    std::size_t grain;
+                    std::vector<std::function<void()>> tasks;
+                    std::vector<std::size_t> costs;
+                    /* position in [0, 1) of the range of each task within its vector */
+                    std::vector<double> positions;
+                    std::function<void()> alongside;
+                    std::size_t alongside_cost = 0;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_MULTIEXP_TASKS_HPP
@@ -0,0 +1,381 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the NUMA-aware executor and of the placement of proving key queries.
+//
+// On a host with several sockets, a page of memory belongs to the node of the thread that
+// first touched it, and the multi-exponentiations of a thread on another socket read it
+// over the interconnect. The proving key queries are written once, when they are generated
+// or read, usually by a single thread, so all of them end up on one node.
+//
+// numa_pool runs the parallel loops on worker threads pinned to the processors of every
+// node. It is given the position in [0, 1) of the data each task reads (see executor.hpp and
+// multiexp_tasks.hpp) and runs the task on node floor(position * num_nodes). A node whose
+// tasks are done takes over those of the other nodes. place_on_nodes moves the pages of a
+// vector with the same split: the k-th of num_nodes consecutive parts goes to node k.
+// With both, every chunk of a multi-exponentiation over a placed query runs on the socket
+// that holds its bases:
+//
+//     numa_pool pool;
+//     place_proving_key_on_nodes(pk, pool.topology());
+//     executor::scope guard(pool.get());
+//     proof = prove<scheme_type>(pk, primary_input, auxiliary_input);
+//
+// The topology is read from /sys/devices/system/node, and the threads are pinned and
+// the pages moved by the Linux scheduler and memory policy interface. On other systems,
+// and on single-node hosts, the topology is a single node and the placement does nothing.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_NUMA_HPP
+#define CRYPTO3_ZK_NUMA_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * The NUMA nodes of the host and the processors of each of them.
+                 */
+                struct numa_topology {
+                    std::vector<int> node_ids;
+                    std::vector<std::vector<int>> cpus;
+
+                    /* a single node of concurrency processors, without pinning */
+                    explicit numa_topology(const std::size_t concurrency = 1) :
+                        node_ids(1, 0), cpus(1, std::vector<int>(std::max<std::size_t>(1, concurrency), -1)) {
+                    }
+
+                    std::size_t num_nodes() const {
+                        return node_ids.size();
+                    }
+
+                    std::size_t concurrency() const {
+                        std::size_t result = 0;
+                        for (const std::vector<int> &node_cpus : cpus) {
+                            result += node_cpus.size();
+                        }
+                        return result;
+                    }
+
+                    /* Node among [0, num_nodes()) of the data at position in [0, 1). */
+                    std::size_t node_of(const double position) const {
+                        const std::size_t node = std::size_t(std::max(0.0, position) * num_nodes());
+                        return std::min(node, num_nodes() - 1);
+                    }
+
+                    /**
+                     * Topology of the host, or a single node of std::thread::hardware_concurrency()
+                     * processors where it cannot be read.
+                     */
+                    static numa_topology detect() {
+                        numa_topology result(std::thread::hardware_concurrency());
+#ifdef __linux__
+                        numa_topology detected;
+                        detected.node_ids.clear();
+                        detected.cpus.clear();
+                        for (int node = 0; node < max_nodes; ++node) {
+                            std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) +
+                                                  "/cpulist");
+                            std::string line;
+                            if (!cpulist || !std::getline(cpulist, line)) {
+                                continue;
+                            }
+                            std::vector<int> node_cpus = parse_cpulist(line);
+                            if (!node_cpus.empty()) {
+                                detected.node_ids.emplace_back(node);
+                                detected.cpus.emplace_back(std::move(node_cpus));
+                            }
+                        }
+                        if (!detected.node_ids.empty()) {
+                            result = std::move(detected);
+                        }
+#endif
+                        return result;
+                    }
+
+                    /* nodes of the masks given to the memory policy interface */
+                    static constexpr const int max_nodes = 64;
+
+                private:
+                    /* Processors of a list such as "0-15,32-47". */
+                    static std::vector<int> parse_cpulist(const std::string &line) {
+                        std::vector<int> result;
+                        std::istringstream ranges(line);
+                        std::string range;
+                        while (std::getline(ranges, range, ',')) {
+                            const std::size_t dash = range.find('-');
+                            try {
+                                const int first = std::stoi(range.substr(0, dash));
+                                const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                                for (int cpu = first; cpu <= last; ++cpu) {
+                                    result.emplace_back(cpu);
+                                }
+                            } catch (const std::exception &) {
+                                return std::vector<int>();
+                            }
+                        }
+                        return result;
+                    }
+                };
+
+                /**
+                 * Moves the pages of [data, data + size) to node node_id. The range is rounded inwards
+                 * to whole pages, which a neighbouring range shares otherwise. Returns whether the pages
+                 * were moved; the placement is a hint and the data stays valid either way.
+                 */
+                inline bool place_on_node(const void *data, const std::size_t size, const int node_id) {
+#if defined(__linux__) && defined(SYS_mbind)
+                    const long page_size = sysconf(_SC_PAGESIZE);
+                    if (page_size <= 0 || node_id < 0 || node_id >= numa_topology::max_nodes) {
+                        return false;
+                    }
+                    const std::uintptr_t page = std::uintptr_t(page_size);
+                    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data);
+                    const std::uintptr_t first = (address + page - 1) / page * page;
+                    const std::uintptr_t last = (address + size) / page * page;
+                    if (first >= last) {
+                        return false;
+                    }
+
+                    /* MPOL_BIND and MPOL_MF_MOVE of <numaif.h> */
+                    const int bind = 2;
+                    const unsigned move = 2;
+                    const unsigned long mask = 1ul << node_id;
+                    return syscall(SYS_mbind, first, last - first, bind, &mask, 8 * sizeof(mask) + 1, move) == 0;
+#else
+                    (void)data;
+                    (void)size;
+                    (void)node_id;
+                    return false;
+#endif
+                }
+
+                /**
+                 * Moves the k-th of topology.num_nodes() consecutive parts of values to the k-th node,
+                 * the split numa_pool runs the tasks of a range with. Returns whether every part was
+                 * moved.
+                 */
+                template<typename ValueType>
+                bool place_on_nodes(const std::vector<ValueType> &values, const numa_topology &topology) {
+                    if (topology.num_nodes() < 2 || values.empty()) {
+                        return false;
+                    }
+
+                    bool result = true;
+                    for (std::size_t node = 0; node < topology.num_nodes(); ++node) {
+                        const std::size_t first = node * values.size() / topology.num_nodes();
+                        const std::size_t last = (node + 1) * values.size() / topology.num_nodes();
+                        result &= place_on_node(values.data() + first, (last - first) * sizeof(ValueType),
+                                                topology.node_ids[node]);
+                    }
+                    return result;
+                }
+
+                /**
+                 * Places every query of a proving key with A_query, B_query, H_query and L_query
+                 * members, such as the one of r1cs_gg_ppzksnark, with place_on_nodes.
+                 */
+                template<typename ProvingKeyType>
+                bool place_proving_key_on_nodes(const ProvingKeyType &proving_key, const numa_topology &topology) {
+                    bool result = place_on_nodes(proving_key.A_query, topology);
+                    result &= place_on_nodes(proving_key.B_query.values, topology);
+                    result &= place_on_nodes(proving_key.H_query, topology);
+                    result &= place_on_nodes(proving_key.L_query, topology);
+                    return result;
+                }
+
+                /**
+                 * A pool of one worker thread per processor of a numa_topology, each pinned to its
+                 * processor, running the bulk calls of the executor it returns with get().
+                 *
+                 * Bulk calls are run one at a time; the calling thread waits for its tasks to complete.
+                 */
+                class numa_pool {
+                public:
+                    explicit numa_pool(const numa_topology &topology = numa_topology::detect()) :
+                        topology_(topology),
+                        executor_(topology_.concurrency(),
+                                  [this](const std::size_t n, const executor::task_type &f) { run(n, nullptr, f); },
+                                  [this](const std::size_t n, const std::vector<double> &positions,
+                                         const executor::task_type &f) { run(n, &positions, f); }),
+                        job_(nullptr), generation_(0), active_(0), stop_(false) {
+                        for (std::size_t node = 0; node < topology_.num_nodes(); ++node) {
+                            for (const int cpu : topology_.cpus[node]) {
+                                workers_.emplace_back([this, node, cpu]() { work(node, cpu); });
+                            }
+                        }
+                    }
+
+                    numa_pool(const numa_pool &) = delete;
+                    numa_pool &operator=(const numa_pool &) = delete;
+
+                    ~numa_pool() {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            stop_ = true;
+                        }
+                        wake_.notify_all();
+                        for (std::thread &worker : workers_) {
+                            worker.join();
+                        }
+                    }
+
+                    const numa_topology &topology() const {
+                        return topology_;
+                    }
+
+                    const executor &get() const {
+                        return executor_;
+                    }
+
+                private:
+                    struct job {
+                        const executor::task_type *f;
+                        /* the tasks of every node and the next one of them to run */
+                        std::vector<std::vector<std::size_t>> tasks;
+                        std::unique_ptr<std::atomic<std::size_t>[]> next;
+                        std::atomic<std::size_t> remaining;
+                    };
+
+                    /* Runs f(i), i in [0, n), task i on the node of positions[i], or of (i + 0.5) / n. */
+                    void run(const std::size_t n, const std::vector<double> *positions,
+                             const executor::task_type &f) {
+                        BOOST_ASSERT(!positions || positions->size() == n);
+                        std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+                        job current;
+                        current.f = &f;
+                        current.tasks.resize(topology_.num_nodes());
+                        current.next.reset(new std::atomic<std::size_t>[topology_.num_nodes()]);
+                        current.remaining = n;
+                        for (std::size_t node = 0; node < topology_.num_nodes(); ++node) {
+                            current.next[node] = 0;
+                        }
+                        for (std::size_t i = 0; i < n; ++i) {
+                            const double position = positions ? (*positions)[i] : (i + 0.5) / double(n);
+                            current.tasks[topology_.node_of(position)].emplace_back(i);
+                        }
+
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        job_ = &current;
+                        ++generation_;
+                        wake_.notify_all();
+                        done_.wait(lock, [&]() { return current.remaining == 0 && active_ == 0; });
+                        job_ = nullptr;
+                    }
+
+                    void work(const std::size_t node, const int cpu) {
+                        pin(cpu);
+
+                        std::size_t seen = 0;
+                        for (;;) {
+                            std::unique_lock<std::mutex> lock(mutex_);
+                            wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+                            if (stop_) {
+                                return;
+                            }
+                            seen = generation_;
+                            job *const current = job_;
+                            if (!current) {
+                                continue;
+                            }
+                            ++active_;
+                            lock.unlock();
+
+                            /* the tasks of this node first, then those left on the others */
+                            for (std::size_t k = 0; k < topology_.num_nodes(); ++k) {
+                                const std::size_t from = (node + k) % topology_.num_nodes();
+                                const std::vector<std::size_t> &tasks = current->tasks[from];
+                                for (std::size_t t = current->next[from]++; t < tasks.size();
+                                     t = current->next[from]++) {
+                                    (*current->f)(tasks[t]);
+                                    --current->remaining;
+                                }
+                            }
+
+                            lock.lock();
+                            if (--active_ == 0) {
+                                done_.notify_all();
+                            }
+                        }
+                    }
+
+                    static void pin(const int cpu) {
+#ifdef __linux__
+                        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                            return;
+                        }
+                        cpu_set_t set;
+                        CPU_ZERO(&set);
+                        CPU_SET(cpu, &set);
+                        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+                        (void)cpu;
+#endif
+                    }
+
+                    numa_topology topology_;
+                    executor executor_;
+
+                    std::mutex run_mutex_;
+                    std::mutex mutex_;
+                    std::condition_variable wake_;
+                    std::condition_variable done_;
+                    job *job_;
+                    std::size_t generation_;
+                    std::size_t active_;
+                    bool stop_;
+                    std::vector<std::thread> workers_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_NUMA_HPP
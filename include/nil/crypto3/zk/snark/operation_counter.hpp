@@ -0,0 +1,177 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the operation counter counting the expensive operations of provers and verifiers.
+//
+// Counts of operations are far more stable than timings when comparing
+// algorithm variants across machines. The counting is opt-in: unless
+// CRYPTO3_ZK_COUNT_OPERATIONS is defined, operation_counter::add compiles to
+// nothing. When it is, the operations are added to the counter installed as the
+// current one of the calling thread, if any:
+//
+//     operation_counter counter;
+//     {
+//         operation_counter::scope guard(counter);
+//         proof = prove<scheme_type>(pk, primary_input, auxiliary_input);
+//     }
+//     counter.write_json(std::cout);
+//
+// Like the stage sink, the current counter is inherited by the tasks run by the
+// current executor, so one counter rolls up all the operations of a call.
+//
+// The operations are counted where this library performs them: the terms of the
+// multi-exponentiations, by group of the bases, the Miller loops and final
+// exponentiations of the pairings, and the bytes absorbed by the Fiat-Shamir
+// transcripts. The group additions and doublings a multi-exponentiation takes
+// depend on the method of the algebra library running it and are not counted.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_OPERATION_COUNTER_HPP
+#define CRYPTO3_ZK_OPERATION_COUNTER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                class operation_counter {
+                public:
+                    enum operation : std::size_t {
+                        g1_exp_term,
+                        g2_exp_term,
+                        miller_loop,
+                        final_exponentiation,
+                        hash_byte,
+                        num_operations
+                    };
+
+                    typedef std::array<std::uint64_t, num_operations> counts_type;
+
+                    static const char *name(const operation op) {
+                        static const char *const names[num_operations] = {
+                            "g1_exp_terms", "g2_exp_terms", "miller_loops", "final_exponentiations", "hash_bytes"};
+                        return names[op];
+                    }
+
+                    operation_counter() {
+                        clear();
+                    }
+
+                    operation_counter(const operation_counter &) = delete;
+                    operation_counter &operator=(const operation_counter &) = delete;
+
+                    counts_type counts() const {
+                        counts_type result;
+                        for (std::size_t op = 0; op < num_operations; ++op) {
+                            result[op] = counts_[op].load(std::memory_order_relaxed);
+                        }
+                        return result;
+                    }
+
+                    std::uint64_t count(const operation op) const {
+                        return counts_[op].load(std::memory_order_relaxed);
+                    }
+
+                    void clear() {
+                        for (std::atomic<std::uint64_t> &c : counts_) {
+                            c.store(0, std::memory_order_relaxed);
+                        }
+                    }
+
+                    /**
+                     * Writes the counts as a JSON object mapping the name of every operation to its count.
+                     */
+                    void write_json(std::ostream &os) const {
+                        const counts_type snapshot = counts();
+
+                        os << "{";
+                        for (std::size_t op = 0; op < num_operations; ++op) {
+                            os << (op ? "," : "") << "\"" << name(operation(op)) << "\":" << snapshot[op];
+                        }
+                        os << "}";
+                    }
+
+                    /**
+                     * Installs a counter, or none if counter is null, as the current one of the calling
+                     * thread for the lifetime of the scope.
+                     */
+                    class scope {
+                    public:
+                        explicit scope(operation_counter &counter) : scope(&counter) {
+                        }
+
+                        explicit scope(operation_counter *counter) : previous(state()) {
+                            state() = counter;
+                        }
+
+                        scope(const scope &) = delete;
+                        scope &operator=(const scope &) = delete;
+
+                        ~scope() {
+                            state() = previous;
+                        }
+
+                    private:
+                        operation_counter *previous;
+                    };
+
+                    /**
+                     * Adds n operations op to the current counter of the calling thread, if counting is
+                     * enabled and a counter is installed.
+                     */
+#ifdef CRYPTO3_ZK_COUNT_OPERATIONS
+                    static void add(const operation op, const std::uint64_t n = 1) {
+                        if (operation_counter *counter = state()) {
+                            counter->counts_[op].fetch_add(n, std::memory_order_relaxed);
+                        }
+                    }
+#else
+                    static void add(const operation, const std::uint64_t = 1) {
+                    }
+#endif
+
+                    static operation_counter *current() {
+                        return state();
+                    }
+
+                private:
+                    static operation_counter *&state() {
+                        thread_local operation_counter *current = nullptr;
+                        return current;
+                    }
+
+                    std::array<std::atomic<std::uint64_t>, num_operations> counts_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_OPERATION_COUNTER_HPP
@@ -0,0 +1,108 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a fixed-size packed representation of digests.
+//
+// Digests flow through the Merkle trees and set commitments as bit vectors,
+// one heap allocation per node. A packed digest holds the same bits, most
+// significant bit of each byte first, in a fixed-size byte array whose length
+// is known at compile time, so nodes are stored, compared and copied without
+// allocating. The bit vector form is only produced where a hash or a caller
+// asks for it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_PACKED_DIGEST_HPP
+#define CRYPTO3_ZK_SNARK_PACKED_DIGEST_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                template<std::size_t Bits>
+                struct packed_digest {
+                    constexpr static const std::size_t bits = Bits;
+                    constexpr static const std::size_t bytes = (Bits + 7) / 8;
+
+                    std::array<std::uint8_t, bytes> data {};
+
+                    packed_digest() = default;
+
+                    /**
+                     * Packs the leading Bits bits of a bit vector, a shorter one being padded with
+                     * zeros.
+                     */
+                    explicit packed_digest(const std::vector<bool> &digest) {
+                        const std::size_t size = std::min(digest.size(), Bits);
+                        for (std::size_t i = 0; i < size; ++i) {
+                            if (digest[i]) {
+                                data[i / 8] |= std::uint8_t(0x80 >> (i % 8));
+                            }
+                        }
+                    }
+
+                    bool bit(const std::size_t i) const {
+                        return (data[i / 8] >> (7 - i % 8)) & 1;
+                    }
+
+                    /**
+                     * The first size bits, Bits by default, as a bit vector.
+                     */
+                    std::vector<bool> to_bits(const std::size_t size = Bits) const {
+                        std::vector<bool> result(size);
+                        for (std::size_t i = 0; i < std::min(size, Bits); ++i) {
+                            result[i] = bit(i);
+                        }
+                        return result;
+                    }
+
+                    bool operator==(const packed_digest &other) const {
+                        return data == other.data;
+                    }
+
+                    bool operator!=(const packed_digest &other) const {
+                        return data != other.data;
+                    }
+                };
+
+                template<std::size_t Bits>
+                std::vector<std::vector<bool>> to_bits(const std::vector<packed_digest<Bits>> &digests) {
+                    std::vector<std::vector<bool>> result;
+                    result.reserve(digests.size());
+                    for (const packed_digest<Bits> &digest : digests) {
+                        result.emplace_back(digest.to_bits());
+                    }
+                    return result;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_PACKED_DIGEST_HPP
@@ -0,0 +1,226 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a packed vector of prime field elements.
+//
+// Assignments, polynomial coefficients and query scalars are vectors of field
+// elements, each carrying the bookkeeping of its multiprecision backend next to
+// its limbs. The packed field vector stores the limbs of its elements only, in
+// canonical (non-Montgomery) form, each element in the same number of 64-bit
+// words, back to back in one buffer. That is the layout a multi-exponentiation
+// reads its scalar digits from and the one the elements are marshalled in, and a
+// vectorized kernel can stream it. Elements are unpacked on access, by index, by
+// iterator or block by block.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SNARK_PACKED_FIELD_VECTOR_HPP
+#define CRYPTO3_ZK_SNARK_PACKED_FIELD_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                template<typename FieldType>
+                class packed_field_vector;
+
+                /**
+                 * Random access iterator unpacking the elements of a packed_field_vector.
+                 */
+                template<typename FieldType>
+                class packed_field_iterator
+                    : public boost::iterator_facade<packed_field_iterator<FieldType>,
+                                                    const typename FieldType::value_type,
+                                                    std::random_access_iterator_tag,
+                                                    const typename FieldType::value_type> {
+                    friend class boost::iterator_core_access;
+
+                    const packed_field_vector<FieldType> *vector;
+                    std::ptrdiff_t position;
+
+                    typename FieldType::value_type dereference() const {
+                        return (*vector)[position];
+                    }
+
+                    bool equal(const packed_field_iterator &other) const {
+                        return position == other.position;
+                    }
+
+                    void increment() {
+                        ++position;
+                    }
+
+                    void decrement() {
+                        --position;
+                    }
+
+                    void advance(const std::ptrdiff_t n) {
+                        position += n;
+                    }
+
+                    std::ptrdiff_t distance_to(const packed_field_iterator &other) const {
+                        return other.position - position;
+                    }
+
+                public:
+                    packed_field_iterator() : vector(nullptr), position(0) {
+                    }
+
+                    packed_field_iterator(const packed_field_vector<FieldType> *vector, const std::ptrdiff_t position) :
+                        vector(vector), position(position) {
+                    }
+                };
+
+                /**
+                 * A vector of elements of the prime field FieldType stored as the words_per_element
+                 * little-endian 64-bit limbs of their canonical representatives.
+                 */
+                template<typename FieldType>
+                class packed_field_vector {
+                    typedef typename FieldType::value_type field_value_type;
+                    typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+
+                    static constexpr const std::size_t conversion_block_size = std::size_t(1) << 16;
+
+                public:
+                    typedef FieldType field_type;
+                    typedef field_value_type value_type;
+                    typedef std::uint64_t word_type;
+                    typedef packed_field_iterator<FieldType> const_iterator;
+                    typedef const_iterator iterator;
+
+                    static constexpr const std::size_t words_per_element = (FieldType::modulus_bits + 63) / 64;
+
+                    packed_field_vector() = default;
+
+                    /**
+                     * Packs the elements of the random access range [first, last), in blocks split
+                     * across the current executor.
+                     */
+                    template<typename InputIterator>
+                    packed_field_vector(InputIterator first, InputIterator last) :
+                        words_(words_per_element * std::distance(first, last), 0) {
+                        const std::size_t n = size();
+                        const std::size_t num_blocks = (n + conversion_block_size - 1) / conversion_block_size;
+
+                        executor::current().parallel_for(num_blocks, [&](const std::size_t block) {
+                            const std::size_t block_first = block * conversion_block_size;
+                            const std::size_t block_last = std::min(n, block_first + conversion_block_size);
+                            for (std::size_t i = block_first; i < block_last; ++i) {
+                                set(i, *(first + i));
+                            }
+                        });
+                    }
+
+                    explicit packed_field_vector(const std::vector<field_value_type> &elements) :
+                        packed_field_vector(elements.begin(), elements.end()) {
+                    }
+
+                    std::size_t size() const {
+                        return words_.size() / words_per_element;
+                    }
+
+                    bool empty() const {
+                        return words_.empty();
+                    }
+
+                    field_value_type operator[](const std::size_t i) const {
+                        BOOST_ASSERT(i < size());
+                        typename FieldType::modulus_type value;
+                        multiprecision::import_bits(value, words_.begin() + i * words_per_element,
+                                                    words_.begin() + (i + 1) * words_per_element, 64, false);
+                        return field_value_type(value);
+                    }
+
+                    void set(const std::size_t i, const field_value_type &element) {
+                        BOOST_ASSERT(i < size());
+                        const auto element_words = words_.begin() + i * words_per_element;
+                        std::fill(element_words, element_words + words_per_element, 0);
+                        multiprecision::export_bits(integral_type(element.data), element_words, 64, false);
+                    }
+
+                    const_iterator begin() const {
+                        return const_iterator(this, 0);
+                    }
+
+                    const_iterator end() const {
+                        return const_iterator(this, size());
+                    }
+
+                    /**
+                     * Unpacks the elements [first, last) into out, whose storage is reused, so a caller
+                     * walking the vector block after block allocates once.
+                     */
+                    void decode(const std::size_t first, const std::size_t last,
+                                std::vector<field_value_type> &out) const {
+                        BOOST_ASSERT(first <= last && last <= size());
+                        out.resize(last - first);
+                        executor::current().parallel_for(last - first,
+                                                         [&](const std::size_t i) { out[i] = (*this)[first + i]; });
+                    }
+
+                    std::vector<field_value_type> to_vector() const {
+                        std::vector<field_value_type> result;
+                        decode(0, size(), result);
+                        return result;
+                    }
+
+                    /**
+                     * The limbs of element i are words()[i * words_per_element + j], least significant
+                     * first.
+                     */
+                    const std::vector<word_type> &words() const {
+                        return words_;
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return words_.size() * 64;
+                    }
+
+                    bool operator==(const packed_field_vector &other) const {
+                        return this->words_ == other.words_;
+                    }
+
+                private:
+                    std::vector<word_type> words_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SNARK_PACKED_FIELD_VECTOR_HPP
@@ -0,0 +1,380 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+// Copyright (c) 2020-2021 Ilias Khairullin <ilias@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a batch checker of pairing product equations.
+//
+// Checks of the form e(A,B)e(C,D)... = T are collected as their pairs and right
+// hand sides, and all verified at once: every randomized check is scaled by its
+// own coefficient, all the pairs go through a single multi Miller loop and the
+// result through a single final exponentiation. The coefficients are either
+// drawn from a random generator, the entropy of the system by default, or are the
+// powers of a seed, e.g. a transcript challenge, which makes the verification
+// deterministic. A check merged with mismatched or empty pairs invalidates the
+// checker rather than being asserted on. The buffers are kept
+// across clear(), so a single checker can be reused proof after proof. The G2
+// elements of the pairs are either points, whose Miller loop lines verify computes
+// in parallel, or lines precomputed once for fixed points, as a prepared SRS holds.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_PAIRING_CHECK_HPP
+#define CRYPTO3_ZK_PAIRING_CHECK_HPP
+
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/gt_multiexp.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /// PairingCheck represents a check of the form e(A,B)e(C,D)... = T. Checks can
+                /// be aggregated together using random linear combination. The efficiency comes
+                /// from keeping the results from the miller loop output before proceding to a final
+                /// exponentiation when verifying if all checks are verified.
+                /// The merges only record the pairs and the right hand side of every check:
+                /// verify scales the pairs of the randomized checks by their coefficients, runs
+                /// a single multi Miller loop over all pairs, one Gt multi-exponentiation of the right
+                /// hand sides, and compares after one final exponentiation.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = random_device_generator>
+                struct pairing_check {
+                    typedef CurveType curve_type;
+
+                    typedef typename curve_type::g1_type g1_type;
+                    typedef typename curve_type::g2_type g2_type;
+                    typedef typename curve_type::gt_type gt_type;
+                    typedef typename curve_type::scalar_field_type scalar_field_type;
+
+                    typedef typename g1_type::value_type g1_value_type;
+                    typedef typename g2_type::value_type g2_value_type;
+                    typedef typename gt_type::value_type gt_value_type;
+                    typedef typename scalar_field_type::value_type scalar_field_value_type;
+
+                    typedef typename curve_type::pairing pairing_policy;
+                    typedef typename pairing_policy::g2_precomp g2_precomp;
+
+                    /// G2 elements of the merged pairs: points, or the Miller loop lines of fixed points
+                    /// precomputed once, such as those of a prepared SRS
+                    template<typename ValueType>
+                    using is_g2_term = std::integral_constant<bool, std::is_same<g2_value_type, ValueType>::value ||
+                                                                        std::is_same<g2_precomp, ValueType>::value>;
+
+                    inline pairing_check() :
+                        left(gt_value_type::one()), right(gt_value_type::one()), num_random_checks(0),
+                        non_random_check_done(false), valid(true) {
+                    }
+
+                    /// returns a pairing tuple that is scaled by a random element.
+                    /// When aggregating pairing checks, this creates a random linear
+                    /// combination of all checks so that it is secure. Specifically
+                    /// we have e(A,B)e(C,D)... = out <=> e(g,h)^{ab + cd} = out
+                    /// We rescale using a random element $r$ to give
+                    /// e(rA,B)e(rC,D) ... = out^r <=>
+                    /// e(A,B)^r e(C,D)^r = out^r <=> e(g,h)^{abr + cdr} = out^r
+                    /// (e(g,h)^{ab + cd})^r = out^r
+                    template<typename InputG1Iterator, typename InputG2Iterator,
+                             typename std::enable_if<
+                                 std::is_same<g1_value_type,
+                                              typename std::iterator_traits<InputG1Iterator>::value_type>::value &&
+                                     is_g2_term<typename std::iterator_traits<InputG2Iterator>::value_type>::value,
+                                 bool>::type = true>
+                    inline pairing_check(InputG1Iterator a_first, InputG1Iterator a_last, InputG2Iterator b_first,
+                                         InputG2Iterator b_last, const gt_value_type &out) :
+                        pairing_check() {
+                        merge_random(a_first, a_last, b_first, b_last, out);
+                    }
+
+                    /// preallocates the buffers for num_checks checks of num_pairs pairs in total
+                    inline void reserve(std::size_t num_checks, std::size_t num_pairs) {
+                        g1_terms.reserve(num_pairs);
+                        g2_terms.reserve(num_pairs);
+                        g2_points.reserve(num_pairs);
+                        g2_pending.reserve(num_pairs);
+                        scaled_g1_terms.reserve(num_pairs);
+                        checks.reserve(num_checks);
+                    }
+
+                    /// forgets all merged checks, keeping the buffers for the next ones
+                    inline void clear() {
+                        g1_terms.clear();
+                        g2_terms.clear();
+                        g2_points.clear();
+                        g2_pending.clear();
+                        checks.clear();
+                        left = gt_value_type::one();
+                        right = gt_value_type::one();
+                        num_random_checks = 0;
+                        non_random_check_done = false;
+                        valid = true;
+                    }
+
+                    template<typename InputG1Iterator, typename InputG2Iterator>
+                    inline typename std::enable_if<
+                        std::is_same<g1_value_type,
+                                     typename std::iterator_traits<InputG1Iterator>::value_type>::value &&
+                        is_g2_term<typename std::iterator_traits<InputG2Iterator>::value_type>::value>::type
+                        merge_random(InputG1Iterator a_first, InputG1Iterator a_last, InputG2Iterator b_first,
+                                     InputG2Iterator b_last, const gt_value_type &out) {
+                        if (!valid) {
+                            return;
+                        }
+                        if (!same_nonzero_length(a_first, a_last, b_first, b_last)) {
+                            invalidate();
+                            return;
+                        }
+
+                        g1_terms.insert(g1_terms.end(), a_first, a_last);
+                        append_g2_terms(b_first, b_last);
+                        checks.push_back({g1_terms.size(), out, true, num_random_checks++});
+                    }
+
+                    /// adds the check e(A,B)e(C,D)... = out without randomizing it, all pairs
+                    /// going into the same multi Miller loop as the randomized checks.
+                    template<typename InputG1Iterator, typename InputG2Iterator>
+                    inline typename std::enable_if<
+                        std::is_same<g1_value_type,
+                                     typename std::iterator_traits<InputG1Iterator>::value_type>::value &&
+                        is_g2_term<typename std::iterator_traits<InputG2Iterator>::value_type>::value>::type
+                        merge_nonrandom(InputG1Iterator a_first, InputG1Iterator a_last, InputG2Iterator b_first,
+                                        InputG2Iterator b_last, const gt_value_type &out) {
+                        BOOST_ASSERT(!non_random_check_done);
+
+                        if (!valid) {
+                            return;
+                        }
+                        if (!same_nonzero_length(a_first, a_last, b_first, b_last)) {
+                            invalidate();
+                            return;
+                        }
+
+                        g1_terms.insert(g1_terms.end(), a_first, a_last);
+                        append_g2_terms(b_first, b_last);
+                        checks.push_back({g1_terms.size(), out, false, 0});
+
+                        non_random_check_done = true;
+                    }
+
+                    /// adds the check a_0 a_1 ... = out on Miller loop outputs, without
+                    /// randomizing it.
+                    template<typename InputGTIterator>
+                    inline typename std::enable_if<std::is_same<
+                        gt_value_type, typename std::iterator_traits<InputGTIterator>::value_type>::value>::type
+                        merge_nonrandom(InputGTIterator a_first, InputGTIterator a_last, const gt_value_type &out) {
+                        BOOST_ASSERT(!non_random_check_done);
+
+                        if (!valid) {
+                            return;
+                        }
+                        if (a_first == a_last) {
+                            invalidate();
+                            return;
+                        }
+
+                        for (auto a_it = a_first; a_it != a_last; ++a_it) {
+                            left = left * (*a_it);
+                        }
+                        right = right * out;
+
+                        non_random_check_done = true;
+                    }
+
+                    /// adds all the checks merged into other, each randomized, e.g. to settle the checks
+                    /// of many proofs together. Checks on Miller loop outputs cannot be carried over, other
+                    /// holding any invalidates this one.
+                    inline void merge_random(const pairing_check &other) {
+                        if (!valid) {
+                            return;
+                        }
+                        if (!other.valid || other.left != gt_value_type::one() || other.right != gt_value_type::one()) {
+                            invalidate();
+                            return;
+                        }
+
+                        const std::size_t offset = g1_terms.size();
+                        g1_terms.insert(g1_terms.end(), other.g1_terms.begin(), other.g1_terms.end());
+                        g2_terms.insert(g2_terms.end(), other.g2_terms.begin(), other.g2_terms.end());
+                        g2_points.insert(g2_points.end(), other.g2_points.begin(), other.g2_points.end());
+                        for (const std::size_t pending : other.g2_pending) {
+                            g2_pending.emplace_back(offset + pending);
+                        }
+                        for (const check_type &check : other.checks) {
+                            checks.push_back({offset + check.end, check.out, true, num_random_checks++});
+                        }
+                    }
+
+                    /// verifies all merged checks, the coefficients of the randomized ones being
+                    /// drawn from GeneratorType through DistributionType
+                    inline bool verify() {
+                        std::vector<scalar_field_value_type> coeffs(num_random_checks);
+                        for (scalar_field_value_type &coeff : coeffs) {
+                            coeff = derive_non_zero();
+                        }
+                        return verify_with(coeffs);
+                    }
+
+                    /// verifies all merged checks, the coefficients of the randomized ones being
+                    /// seed, seed^2, seed^3... in merge order. The seed must not be known to the
+                    /// prover before all the checked elements are fixed, e.g. a transcript challenge
+                    /// derived after they have all been written.
+                    inline bool verify(const scalar_field_value_type &seed) {
+                        BOOST_ASSERT(!seed.is_zero());
+
+                        std::vector<scalar_field_value_type> coeffs(num_random_checks);
+                        scalar_field_value_type coeff = seed;
+                        for (std::size_t i = 0; i < coeffs.size(); ++i) {
+                            coeffs[i] = coeff;
+                            coeff = coeff * seed;
+                        }
+                        return verify_with(coeffs);
+                    }
+
+                    inline void invalidate() {
+                        valid = false;
+                    }
+
+                private:
+                    struct check_type {
+                        std::size_t end;
+                        gt_value_type out;
+                        bool randomized;
+                        std::size_t coeff_index;
+                    };
+
+                    template<typename InputG1Iterator, typename InputG2Iterator>
+                    static inline bool same_nonzero_length(InputG1Iterator a_first, InputG1Iterator a_last,
+                                                           InputG2Iterator b_first, InputG2Iterator b_last) {
+                        const auto len = std::distance(a_first, a_last);
+                        return len > 0 && len == std::distance(b_first, b_last);
+                    }
+
+                    /// the lines of the merged G2 points are computed by verify, all at once
+                    template<typename InputG2Iterator>
+                    inline void append_g2_terms(InputG2Iterator b_first, InputG2Iterator b_last) {
+                        for (InputG2Iterator b_it = b_first; b_it != b_last; ++b_it) {
+                            append_g2_term(*b_it);
+                        }
+                    }
+
+                    inline void append_g2_term(const g2_value_type &b) {
+                        g2_pending.emplace_back(g2_terms.size());
+                        g2_points.emplace_back(b);
+                        g2_terms.emplace_back();
+                    }
+
+                    inline void append_g2_term(const g2_precomp &b) {
+                        g2_terms.emplace_back(b);
+                    }
+
+                    inline bool verify_with(const std::vector<scalar_field_value_type> &coeffs) {
+                        if (!valid) {
+                            return false;
+                        }
+
+                        stage_profiler::timer pairing_timer("pairing_product", g1_terms.size());
+
+                        executor::current().parallel_for(g2_pending.size(), [&](const std::size_t i) {
+                            g2_terms[g2_pending[i]] = pairing_policy::precompute_g2(g2_points[i]);
+                        });
+                        g2_pending.clear();
+                        g2_points.clear();
+
+                        // scale the pairs of every randomized check
+                        scaled_g1_terms.resize(g1_terms.size());
+                        executor::current().parallel_for(checks.size(), [&](const std::size_t i) {
+                            const check_type &check = checks[i];
+                            const std::size_t begin = i == 0 ? 0 : checks[i - 1].end;
+                            for (std::size_t j = begin; j < check.end; ++j) {
+                                scaled_g1_terms[j] =
+                                    check.randomized ? coeffs[check.coeff_index] * g1_terms[j] : g1_terms[j];
+                            }
+                        });
+
+                        // the right hand sides of the randomized checks are raised to their
+                        // coefficients in one Gt multi-exponentiation
+                        gt_value_type expected = right;
+                        std::vector<gt_value_type> outs;
+                        std::vector<scalar_field_value_type> out_coeffs;
+                        for (const check_type &check : checks) {
+                            if (!check.randomized) {
+                                expected = expected * check.out;
+                            } else if (check.out != gt_value_type::one()) {
+                                outs.emplace_back(check.out);
+                                out_coeffs.emplace_back(coeffs[check.coeff_index]);
+                            }
+                        }
+                        if (!outs.empty()) {
+                            expected =
+                                expected * gt_multiexp<scalar_field_type>(outs.begin(), outs.end(), out_coeffs.begin());
+                        }
+
+                        operation_counter::add(operation_counter::final_exponentiation);
+                        return algebra::final_exponentiation<curve_type>(
+                                   left * multi_miller_loop<curve_type>(scaled_g1_terms.begin(),
+                                                                        scaled_g1_terms.end(), g2_terms.begin())) ==
+                               expected;
+                    }
+
+                    inline scalar_field_value_type derive_non_zero() {
+                        scalar_field_value_type coeff =
+                            algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                        while (coeff.is_zero()) {
+                            coeff = algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                        }
+                        return coeff;
+                    }
+
+                    std::vector<g1_value_type> g1_terms;
+                    std::vector<g2_precomp> g2_terms;
+                    std::vector<g2_value_type> g2_points;
+                    std::vector<std::size_t> g2_pending;
+                    std::vector<g1_value_type> scaled_g1_terms;
+                    std::vector<check_type> checks;
+                    gt_value_type left;
+                    gt_value_type right;
+                    std::size_t num_random_checks;
+                    bool non_random_check_done;
+                    bool valid;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_PAIRING_CHECK_HPP
@@ -0,0 +1,132 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the prefetched gathers of the sparse multi-exponentiations.
+//
+// The sparse paths of the provers read their scalars, and the bases of their unit terms,
+// through index arrays: the knowledge commitment multi-exponentiations and the sparse
+// vector ones gather *(scalars + indices[i]), the unit terms add values[positions[i]]. The
+// hardware prefetcher follows strides, not index arrays, so every jump between non-trivial
+// entries waits for memory. The gathers below issue a software prefetch for the entry
+// prefetch_tuning::current().distance positions ahead of the one they read, every
+// cache line of it, so that the loads of a batch of entries are in flight together. The
+// address of an entry is computed once, when it is prefetched, and kept until it is read.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_PREFETCH_HPP
+#define CRYPTO3_ZK_PREFETCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Number of entries a gather prefetches ahead of the one it reads. About the memory
+                 * latency over the time the loop spends on an entry, at most max_distance; zero
+                 * disables the prefetches.
+                 */
+                struct prefetch_tuning {
+                    constexpr static const std::size_t max_distance = 64;
+
+                    std::size_t distance = 16;
+
+                    static prefetch_tuning &current() {
+                        static prefetch_tuning tuning;
+                        return tuning;
+                    }
+                };
+
+                namespace detail {
+                    constexpr const std::size_t cache_line_size = 64;
+
+                    /* Prefetches every cache line of value for reading. */
+                    template<typename ValueType>
+                    inline void prefetch_for_read(const ValueType &value) {
+#if defined(__GNUC__) || defined(__clang__)
+                        const char *const first = reinterpret_cast<const char *>(&value);
+                        for (std::size_t offset = 0; offset < sizeof(ValueType); offset += cache_line_size) {
+                            __builtin_prefetch(first + offset, 0, 3);
+                        }
+#else
+                        (void)value;
+#endif
+                    }
+                }    // namespace detail
+
+                /**
+                 * Calls f(k, *(source + (*(indices_first + k) - offset))) for every k, the entries
+                 * being prefetched ahead. Source is a random access iterator dereferencing to an
+                 * lvalue.
+                 */
+                template<typename InputIndexIterator, typename RandomAccessIterator, typename Function>
+                void prefetched_gather(InputIndexIterator indices_first, InputIndexIterator indices_last,
+                                       RandomAccessIterator source, const std::size_t offset, Function f) {
+                    typedef typename std::remove_reference<decltype(*source)>::type value_type;
+
+                    const std::size_t n = std::distance(indices_first, indices_last);
+                    const std::size_t distance =
+                        std::min({prefetch_tuning::current().distance, prefetch_tuning::max_distance, n});
+
+                    auto entry = [&](const std::size_t k) -> value_type * {
+                        return std::addressof(*(source + (*(indices_first + k) - offset)));
+                    };
+
+                    if (!distance) {
+                        for (std::size_t k = 0; k < n; ++k) {
+                            f(k, *entry(k));
+                        }
+                        return;
+                    }
+
+                    /* the entries prefetched and not read yet, the one of k in slot k % distance */
+                    value_type *pending[prefetch_tuning::max_distance];
+                    for (std::size_t k = 0; k < distance; ++k) {
+                        pending[k] = entry(k);
+                        detail::prefetch_for_read(*pending[k]);
+                    }
+
+                    std::size_t slot = 0;
+                    for (std::size_t k = 0; k < n; ++k) {
+                        value_type *const current = pending[slot];
+                        if (k + distance < n) {
+                            pending[slot] = entry(k + distance);
+                            detail::prefetch_for_read(*pending[slot]);
+                        }
+                        slot = slot + 1 == distance ? 0 : slot + 1;
+                        f(k, *current);
+                    }
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_PREFETCH_HPP
@@ -0,0 +1,69 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the generator of the random coefficients of batched checks.
+//
+// A batched check combines many equations with random coefficients, and an invalid
+// member passes only if the coefficients were known when it was made. A pseudorandom
+// generator default constructed by each draw, as algebra::random_element does with its
+// GeneratorType, repeats the same coefficients on every run, so the batched verifiers
+// and subgroup checks default to random_device_generator instead: a wrapper drawing
+// from one std::random_device per thread, the entropy source of the system.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_RANDOM_DEVICE_GENERATOR_HPP
+#define CRYPTO3_ZK_RANDOM_DEVICE_GENERATOR_HPP
+
+#include <random>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /**
+                 * Uniform random bit generator over the std::random_device of the calling thread;
+                 * cheap to default construct and to copy, as a GeneratorType of algebra::random_element.
+                 */
+                struct random_device_generator {
+                    typedef std::random_device::result_type result_type;
+
+                    static constexpr result_type min() {
+                        return std::random_device::min();
+                    }
+
+                    static constexpr result_type max() {
+                        return std::random_device::max();
+                    }
+
+                    result_type operator()() const {
+                        thread_local std::random_device device;
+                        return device();
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_RANDOM_DEVICE_GENERATOR_HPP
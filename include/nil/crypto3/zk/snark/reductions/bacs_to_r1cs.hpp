@@ -34,7 +34,11 @@
 #ifndef CRYPTO3_ZK_BACS_TO_R1CS_BASIC_POLICY_HPP
 #define CRYPTO3_ZK_BACS_TO_R1CS_BASIC_POLICY_HPP
 
+#include <vector>
+
+#include <nil/crypto3/zk/snark/reductions/detail/compile_circuit.hpp>
 #include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/bacs.hpp>
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/bacs_evaluator.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
 
 namespace nil {
@@ -48,24 +52,17 @@ namespace nil {
                         typedef FieldType field_type;
 
                         /**
-                         * Instance map for the BACS-to-R1CS reduction.
+                         * Instance map for the BACS-to-R1CS reduction. The constraint array is sized up front
+                         * and every constraint is built in place, in parallel over the gates.
                          */
                         static r1cs_constraint_system<FieldType> instance_map(const bacs_circuit<FieldType> &circuit) {
-                            assert(circuit.is_valid());
-                            r1cs_constraint_system<FieldType> result;
-
-                            result.primary_input_size = circuit.primary_input_size;
-                            result.auxiliary_input_size = circuit.auxiliary_input_size + circuit.gates.size();
-
-                            for (auto &g : circuit.gates) {
-                                result.constraints.emplace_back(r1cs_constraint<FieldType>(g.lhs, g.rhs, g.output));
-                            }
+                            r1cs_constraint_system<FieldType> result = allocate(circuit);
+                            const std::vector<std::size_t> outputs = circuit_outputs(circuit);
+                            result.constraints.resize(circuit.gates.size() + outputs.size());
 
-                            for (auto &g : circuit.gates) {
-                                if (g.is_circuit_output) {
-                                    result.constraints.emplace_back(r1cs_constraint<FieldType>(1, g.output, 0));
-                                }
-                            }
+                            detail::compile_circuit(result.constraints.size(), [&](const std::size_t c) {
+                                result.constraints[c] = constraint(circuit, outputs, c);
+                            });
 
                             return result;
                         }
@@ -77,10 +74,68 @@ namespace nil {
                             witness_map(const bacs_circuit<FieldType> &circuit,
                                         const bacs_primary_input<FieldType> &primary_input,
                                         const bacs_auxiliary_input<FieldType> &auxiliary_input) {
-                            const r1cs_variable_assignment<FieldType> result =
-                                circuit.get_all_wires(primary_input, auxiliary_input);
+                            return witness_map(bacs_circuit_evaluator<FieldType>(circuit), primary_input,
+                                               auxiliary_input);
+                        }
+
+                        /**
+                         * Witness map for the BACS-to-R1CS reduction, reusing the level schedule of an
+                         * evaluator precompiled for the circuit.
+                         */
+                        static r1cs_variable_assignment<FieldType>
+                            witness_map(const bacs_circuit_evaluator<FieldType> &evaluator,
+                                        const bacs_primary_input<FieldType> &primary_input,
+                                        const bacs_auxiliary_input<FieldType> &auxiliary_input) {
+                            return evaluator.get_all_wires(primary_input, auxiliary_input);
+                        }
+
+                        /**
+                         * The auxiliary part of the witness map, the wires after the primary input.
+                         */
+                        static r1cs_auxiliary_input<FieldType>
+                            auxiliary_witness_map(const bacs_circuit_evaluator<FieldType> &evaluator,
+                                                  const bacs_primary_input<FieldType> &primary_input,
+                                                  const bacs_auxiliary_input<FieldType> &auxiliary_input) {
+                            r1cs_auxiliary_input<FieldType> result =
+                                evaluator.get_all_wires(primary_input, auxiliary_input);
+                            result.erase(result.begin(), result.begin() + primary_input.size());
+                            return result;
+                        }
+
+                    private:
+                        static r1cs_constraint_system<FieldType> allocate(const bacs_circuit<FieldType> &circuit) {
+                            assert(circuit.is_valid());
+                            r1cs_constraint_system<FieldType> result;
+
+                            result.primary_input_size = circuit.primary_input_size;
+                            result.auxiliary_input_size = circuit.auxiliary_input_size + circuit.gates.size();
+
                             return result;
                         }
+
+                        static std::vector<std::size_t> circuit_outputs(const bacs_circuit<FieldType> &circuit) {
+                            std::vector<std::size_t> outputs;
+                            for (std::size_t i = 0; i < circuit.gates.size(); ++i) {
+                                if (circuit.gates[i].is_circuit_output) {
+                                    outputs.emplace_back(i);
+                                }
+                            }
+                            return outputs;
+                        }
+
+                        /**
+                         * One constraint per gate, then one per circuit output.
+                         */
+                        static r1cs_constraint<FieldType> constraint(const bacs_circuit<FieldType> &circuit,
+                                                                     const std::vector<std::size_t> &outputs,
+                                                                     const std::size_t c) {
+                            if (c < circuit.gates.size()) {
+                                const bacs_gate<FieldType> &g = circuit.gates[c];
+                                return r1cs_constraint<FieldType>(g.lhs, g.rhs, g.output);
+                            }
+                            const bacs_gate<FieldType> &g = circuit.gates[outputs[c - circuit.gates.size()]];
+                            return r1cs_constraint<FieldType>(1, g.output, 0);
+                        }
                     };
                 }    // namespace reductions
             }        // namespace snark
@@ -0,0 +1,86 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the bulk constraint emission shared by the circuit-to-constraint-system reductions.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_REDUCTIONS_COMPILE_CIRCUIT_HPP
+#define CRYPTO3_ZK_REDUCTIONS_COMPILE_CIRCUIT_HPP
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/relations/variable.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace reductions {
+                    namespace detail {
+
+                        /**
+                         * Builds the linear combination sum_i terms[i] in a single allocation. The result equals
+                         * the one obtained by adding the terms with operator+: the terms are sorted by index
+                         * and terms sharing an index are merged into one, zero coefficients being kept.
+                         */
+                        template<typename FieldType, std::size_t N>
+                        linear_combination<FieldType> sorted_combination(std::array<linear_term<FieldType>, N> terms) {
+                            for (std::size_t i = 1; i < N; ++i) {
+                                for (std::size_t j = i; j > 0 && terms[j].index < terms[j - 1].index; --j) {
+                                    std::swap(terms[j], terms[j - 1]);
+                                }
+                            }
+
+                            linear_combination<FieldType> result;
+                            result.terms.reserve(N);
+                            for (std::size_t i = 0; i < N; ++i) {
+                                if (!result.terms.empty() && result.terms.back().index == terms[i].index) {
+                                    result.terms.back().coeff += terms[i].coeff;
+                                } else {
+                                    result.terms.emplace_back(terms[i]);
+                                }
+                            }
+
+                            return result;
+                        }
+
+                        /**
+                         * Calls emit(c) for every constraint index c in [0, num_constraints), possibly
+                         * concurrently. Each call must only write the slot of its own constraint.
+                         */
+                        template<typename EmitFunction>
+                        void compile_circuit(const std::size_t num_constraints, EmitFunction emit) {
+                            executor::current().parallel_for(num_constraints, emit);
+                        }
+                    }    // namespace detail
+                }        // namespace reductions
+            }            // namespace snark
+        }                // namespace zk
+    }                    // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_REDUCTIONS_COMPILE_CIRCUIT_HPP
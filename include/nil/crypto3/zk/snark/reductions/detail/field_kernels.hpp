@@ -0,0 +1,167 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the pointwise field kernels shared by the witness maps of the reductions.
+//
+// Between their FFTs the witness maps only run pointwise passes over domain-sized vectors:
+// A * B - C on the coset, d2 * A + d1 * B for the zero-knowledge patch, the division by Z.
+// The kernels below run such a pass over contiguous arrays, split into one block per
+// executor thread, and accumulate in place so that the generic field type builds no
+// temporaries. A field with a vectorized Montgomery arithmetic (AVX2, AVX-512 IFMA, NEON)
+// plugs it in by specializing field_kernels for its FieldType; the reductions are unchanged.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_REDUCTIONS_FIELD_KERNELS_HPP
+#define CRYPTO3_ZK_REDUCTIONS_FIELD_KERNELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace reductions {
+                    namespace detail {
+
+                        /**
+                         * Pointwise kernels over n consecutive field elements. The output may be any of
+                         * the inputs, but must not partially overlap them.
+                         */
+                        template<typename FieldType>
+                        struct field_kernels {
+                            typedef typename FieldType::value_type value_type;
+
+                            /* out[i] = a[i] * b[i] - c[i] */
+                            static void multiply_subtract(value_type *out, const value_type *a, const value_type *b,
+                                                          const value_type *c, const std::size_t n) {
+                                for_each_block(n, [&](const std::size_t begin, const std::size_t end) {
+                                    for (std::size_t i = begin; i < end; ++i) {
+                                        value_type t = a[i];
+                                        t *= b[i];
+                                        t -= c[i];
+                                        out[i] = t;
+                                    }
+                                });
+                            }
+
+                            /* out[i] = (a[i] * b[i] - c[i]) * s */
+                            static void multiply_subtract_scale(value_type *out, const value_type *a,
+                                                                const value_type *b, const value_type *c,
+                                                                const value_type &s, const std::size_t n) {
+                                for_each_block(n, [&](const std::size_t begin, const std::size_t end) {
+                                    for (std::size_t i = begin; i < end; ++i) {
+                                        value_type t = a[i];
+                                        t *= b[i];
+                                        t -= c[i];
+                                        t *= s;
+                                        out[i] = t;
+                                    }
+                                });
+                            }
+
+                            /* out[i] = a[i]^2 - c[i] */
+                            static void square_subtract(value_type *out, const value_type *a, const value_type *c,
+                                                        const std::size_t n) {
+                                for_each_block(n, [&](const std::size_t begin, const std::size_t end) {
+                                    for (std::size_t i = begin; i < end; ++i) {
+                                        value_type t = a[i].squared();
+                                        t -= c[i];
+                                        out[i] = t;
+                                    }
+                                });
+                            }
+
+                            /* out[i] = alpha * a[i] + beta * b[i] */
+                            static void linear_combination(value_type *out, const value_type &alpha,
+                                                           const value_type *a, const value_type &beta,
+                                                           const value_type *b, const std::size_t n) {
+                                for_each_block(n, [&](const std::size_t begin, const std::size_t end) {
+                                    for (std::size_t i = begin; i < end; ++i) {
+                                        value_type t = a[i];
+                                        t *= alpha;
+                                        value_type u = b[i];
+                                        u *= beta;
+                                        t += u;
+                                        out[i] = t;
+                                    }
+                                });
+                            }
+
+                            /* out[i] = a[i] * s */
+                            static void scale(value_type *out, const value_type *a, const value_type &s,
+                                              const std::size_t n) {
+                                for_each_block(n, [&](const std::size_t begin, const std::size_t end) {
+                                    for (std::size_t i = begin; i < end; ++i) {
+                                        value_type t = a[i];
+                                        t *= s;
+                                        out[i] = t;
+                                    }
+                                });
+                            }
+
+                            /* out[i] *= a[i] */
+                            static void multiply(value_type *out, const value_type *a, const std::size_t n) {
+                                for_each_block(n, [&](const std::size_t begin, const std::size_t end) {
+                                    for (std::size_t i = begin; i < end; ++i) {
+                                        out[i] *= a[i];
+                                    }
+                                });
+                            }
+
+                            /* out[i] += a[i] */
+                            static void add(value_type *out, const value_type *a, const std::size_t n) {
+                                for_each_block(n, [&](const std::size_t begin, const std::size_t end) {
+                                    for (std::size_t i = begin; i < end; ++i) {
+                                        out[i] += a[i];
+                                    }
+                                });
+                            }
+
+                        private:
+                            /* Calls f(begin, end) over one contiguous block of [0, n) per executor thread. */
+                            template<typename Function>
+                            static void for_each_block(const std::size_t n, Function f) {
+                                const std::size_t num_blocks = std::min(n, executor::current().concurrency());
+                                if (num_blocks == 0) {
+                                    return;
+                                }
+                                const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+
+                                executor::current().parallel_for(num_blocks, [&](const std::size_t block) {
+                                    const std::size_t begin = block * block_size;
+                                    f(begin, std::min(n, begin + block_size));
+                                });
+                            }
+                        };
+                    }    // namespace detail
+                }        // namespace reductions
+            }            // namespace snark
+        }                // namespace zk
+    }                    // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_REDUCTIONS_FIELD_KERNELS_HPP
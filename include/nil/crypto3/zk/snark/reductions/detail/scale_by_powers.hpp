@@ -0,0 +1,70 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the coset scaling pass shared by the witness maps of the reductions.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_REDUCTIONS_SCALE_BY_POWERS_HPP
+#define CRYPTO3_ZK_REDUCTIONS_SCALE_BY_POWERS_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace reductions {
+                    namespace detail {
+
+                        /**
+                         * Calls f(i, c^i) for i = 0, ..., n - 1. The powers are computed block-wise, each
+                         * block starting from its own c^start, so the blocks run independently.
+                         */
+                        template<typename FieldValueType, typename Function>
+                        void scale_by_powers(const std::size_t n, const FieldValueType &c, Function f) {
+                            const std::size_t num_blocks = executor::current().concurrency();
+                            const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+
+                            executor::current().parallel_for(num_blocks, [&](const std::size_t block) {
+                                const std::size_t begin = block * block_size;
+                                const std::size_t end = std::min(n, begin + block_size);
+
+                                FieldValueType power = c.pow(begin);
+                                for (std::size_t i = begin; i < end; ++i) {
+                                    f(i, power);
+                                    power *= c;
+                                }
+                            });
+                        }
+                    }    // namespace detail
+                }        // namespace reductions
+            }            // namespace snark
+        }                // namespace zk
+    }                    // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_REDUCTIONS_SCALE_BY_POWERS_HPP
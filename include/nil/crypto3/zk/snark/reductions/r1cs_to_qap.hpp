@@ -48,23 +48,64 @@
 #ifndef CRYPTO3_ZK_R1CS_TO_QAP_BASIC_POLICY_HPP
 #define CRYPTO3_ZK_R1CS_TO_QAP_BASIC_POLICY_HPP
 
+#include <array>
+#include <memory>
+#include <numeric>
+#include <typeinfo>
+
 #include <nil/crypto3/math/coset.hpp>
 #include <nil/crypto3/math/domains/evaluation_domain.hpp>
 #include <nil/crypto3/math/make_evaluation_domain.hpp>
 
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap_fft_backend.hpp>
+#include <nil/crypto3/zk/snark/reductions/reduction_context.hpp>
 #include <nil/crypto3/zk/snark/relations/arithmetic_programs/qap.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_optimizer.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_bytecode.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/static_r1cs.hpp>
 
 #include <nil/crypto3/algebra/fields/params.hpp>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/huge_pages.hpp>
+#include <nil/crypto3/zk/snark/memory_budget.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
             namespace snark {
                 namespace reductions {
-                    template<typename FieldType>
+                    /**
+                     * The polynomial H of the witness map is computed by FFTBackend, see
+                     * r1cs_to_qap_fft_backend.hpp; the default runs the FFTs on the host.
+                     */
+                    template<typename FieldType, typename FFTBackend = r1cs_to_qap_cpu_fft_backend<FieldType>>
                     struct r1cs_to_qap {
                         typedef FieldType field_type;
+                        typedef FFTBackend fft_backend_type;
+
+                        /**
+                         * Scratch buffers of the witness map.
+                         *
+                         * A workspace passed to witness_map keeps the evaluation vectors of A, B and C
+                         * alive between calls, so repeated witness maps over the same domain run on the
+                         * same memory instead of allocating three domain-sized vectors per call. The
+                         * vectors are allocated by the first witness map, when they are needed, not when
+                         * the workspace is built. The default FFT backend computes H in aA, which H is
+                         * copied out of for the workspace to keep all three vectors. Within a limited
+                         * memory budget the backend releases them as soon as they are consumed instead,
+                         * and H is moved out of aA, see memory_budget.hpp.
+                         */
+                        struct workspace {
+                            std::vector<typename FieldType::value_type> aA, aB, aC;
+
+                            std::size_t size_in_bits() const {
+                                return (aA.capacity() + aB.capacity() + aC.capacity()) * FieldType::value_bits;
+                            }
+                        };
 
                         /**
                          * Instance map for the R1CS-to-QAP reduction.
@@ -83,39 +124,69 @@ namespace nil {
                             const std::shared_ptr<fft::evaluation_domain<FieldType>> domain =
                                 fft::make_evaluation_domain<FieldType>(cs.num_constraints() + cs.num_inputs() + 1);
 
-                            std::vector<std::map<std::size_t, typename FieldType::value_type>> A_in_Lagrange_basis(cs.num_variables() + 1);
-                            std::vector<std::map<std::size_t, typename FieldType::value_type>> B_in_Lagrange_basis(cs.num_variables() + 1);
-                            std::vector<std::map<std::size_t, typename FieldType::value_type>> C_in_Lagrange_basis(cs.num_variables() + 1);
+                            std::vector<sparse_lagrange_basis_builder<FieldType>> in_basis(
+                                3, sparse_lagrange_basis_builder<FieldType>(cs.num_variables() + 1));
+                            const std::array<linear_combination<FieldType> r1cs_constraint<FieldType>::*, 3> lcs {
+                                &r1cs_constraint<FieldType>::a, &r1cs_constraint<FieldType>::b,
+                                &r1cs_constraint<FieldType>::c};
 
+                            /* process all constraints, the A, B and C matrices concurrently */
+                            executor::current().bulk(3, [&](const std::size_t matrix) {
+                                for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
+                                    for (const linear_term<FieldType> &term : (cs.constraints[i].*lcs[matrix]).terms) {
+                                        in_basis[matrix].add(term.index, i, term.coeff);
+                                    }
+                                }
+                            });
                             /**
                              * add and process the constraints
                              *     input_i * 0 = 0
                              * to ensure soundness of input consistency
                              */
                             for (std::size_t i = 0; i <= cs.num_inputs(); ++i) {
-                                A_in_Lagrange_basis[i][cs.num_constraints() + i] = FieldType::value_type::one();
+                                in_basis[0].add(i, cs.num_constraints() + i, FieldType::value_type::one());
                             }
-                            /* process all other constraints */
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                for (std::size_t j = 0; j < cs.constraints[i].a.terms.size(); ++j) {
-                                    A_in_Lagrange_basis[cs.constraints[i].a.terms[j].index][i] +=
-                                        cs.constraints[i].a.terms[j].coeff;
-                                }
 
-                                for (std::size_t j = 0; j < cs.constraints[i].b.terms.size(); ++j) {
-                                    B_in_Lagrange_basis[cs.constraints[i].b.terms[j].index][i] +=
-                                        cs.constraints[i].b.terms[j].coeff;
-                                }
+                            return qap_instance<FieldType>(domain, cs.num_variables(), domain->m, cs.num_inputs(),
+                                                           in_basis[0].build(), in_basis[1].build(),
+                                                           in_basis[2].build());
+                        }
 
-                                for (std::size_t j = 0; j < cs.constraints[i].c.terms.size(); ++j) {
-                                    C_in_Lagrange_basis[cs.constraints[i].c.terms[j].index][i] +=
-                                        cs.constraints[i].c.terms[j].coeff;
+                        /**
+                         * Instance map of a compiled witness evaluation program, the same as for the
+                         * constraint system the program was compiled from.
+                         */
+                        static qap_instance<FieldType> instance_map(const r1cs_witness_program<FieldType> &program) {
+
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> domain = get_domain(program);
+
+                            std::vector<sparse_lagrange_basis_builder<FieldType>> in_basis(
+                                3, sparse_lagrange_basis_builder<FieldType>(program.num_variables() + 1));
+                            const std::array<const r1cs_sparse_matrix<FieldType> *, 3> matrices {
+                                &program.a, &program.b, &program.c};
+
+                            /* process all constraints, row by row of the contiguous matrices, concurrently */
+                            executor::current().bulk(3, [&](const std::size_t matrix) {
+                                const r1cs_sparse_matrix<FieldType> &rows = *matrices[matrix];
+                                in_basis[matrix].reserve(rows.num_entries());
+                                for (std::size_t i = 0; i < rows.num_rows(); ++i) {
+                                    for (std::size_t k = rows.row_offsets[i]; k < rows.row_offsets[i + 1]; ++k) {
+                                        in_basis[matrix].add(rows.columns[k], i, rows.coefficients[k]);
+                                    }
                                 }
+                            });
+                            /**
+                             * add and process the constraints
+                             *     input_i * 0 = 0
+                             * to ensure soundness of input consistency
+                             */
+                            for (std::size_t i = 0; i <= program.num_inputs(); ++i) {
+                                in_basis[0].add(i, program.num_constraints() + i, FieldType::value_type::one());
                             }
 
-                            return qap_instance<FieldType>(
-                                domain, cs.num_variables(), domain->m, cs.num_inputs(), std::move(A_in_Lagrange_basis),
-                                std::move(B_in_Lagrange_basis), std::move(C_in_Lagrange_basis));
+                            return qap_instance<FieldType>(domain, program.num_variables(), domain->m,
+                                                           program.num_inputs(), in_basis[0].build(),
+                                                           in_basis[1].build(), in_basis[2].build());
                         }
 
                         /**
@@ -132,56 +203,40 @@ namespace nil {
                          * where
                          *   m = number of variables of the QAP
                          *   n = degree of the QAP
+                         *
+                         * With swap_AB set, the result is the one of cs with the A and B sides of every
+                         * constraint exchanged, without cs being modified.
                          */
                         static qap_instance_evaluation<FieldType>
                             instance_map_with_evaluation(const r1cs_constraint_system<FieldType> &cs,
-                                                         const typename FieldType::value_type &t) {
-                            const std::shared_ptr<fft::evaluation_domain<FieldType>> domain =
-                                fft::make_evaluation_domain<FieldType>(cs.num_constraints() + cs.num_inputs() + 1);
-
-                            std::vector<typename FieldType::value_type> At, Bt, Ct, Ht;
+                                                         const typename FieldType::value_type &t,
+                                                         const bool swap_AB = false) {
+                            const std::size_t num_columns = cs.num_variables() + 1;
 
-                            At.resize(cs.num_variables() + 1, FieldType::value_type::zero());
-                            Bt.resize(cs.num_variables() + 1, FieldType::value_type::zero());
-                            Ct.resize(cs.num_variables() + 1, FieldType::value_type::zero());
-                            Ht.reserve(domain->m + 1);
-
-                            const typename FieldType::value_type Zt = domain->compute_vanishing_polynomial(t);
-
-                            const std::vector<typename FieldType::value_type> u =
-                                domain->evaluate_all_lagrange_polynomials(t);
-                            /**
-                             * add and process the constraints
-                             *     input_i * 0 = 0
-                             * to ensure soundness of input consistency
-                             */
-                            for (std::size_t i = 0; i <= cs.num_inputs(); ++i) {
-                                At[i] = u[cs.num_constraints() + i];
-                            }
-                            /* process all other constraints */
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                for (std::size_t j = 0; j < cs.constraints[i].a.terms.size(); ++j) {
-                                    At[cs.constraints[i].a.terms[j].index] += u[i] * cs.constraints[i].a.terms[j].coeff;
-                                }
-
-                                for (std::size_t j = 0; j < cs.constraints[i].b.terms.size(); ++j) {
-                                    Bt[cs.constraints[i].b.terms[j].index] += u[i] * cs.constraints[i].b.terms[j].coeff;
-                                }
-
-                                for (std::size_t j = 0; j < cs.constraints[i].c.terms.size(); ++j) {
-                                    Ct[cs.constraints[i].c.terms[j].index] += u[i] * cs.constraints[i].c.terms[j].coeff;
-                                }
-                            }
+                            return instance_map_with_evaluation_internal(
+                                cs.num_constraints(), cs.num_inputs(), cs.num_variables(),
+                                column_major(cs, swap_AB ? &r1cs_constraint<FieldType>::b :
+                                                           &r1cs_constraint<FieldType>::a, num_columns),
+                                column_major(cs, swap_AB ? &r1cs_constraint<FieldType>::a :
+                                                           &r1cs_constraint<FieldType>::b, num_columns),
+                                column_major(cs, &r1cs_constraint<FieldType>::c, num_columns), t);
+                        }
 
-                            typename FieldType::value_type ti = FieldType::value_type::one();
-                            for (std::size_t i = 0; i < domain->m + 1; ++i) {
-                                Ht.emplace_back(ti);
-                                ti *= t;
-                            }
+                        /**
+                         * Instance map of a compiled witness evaluation program, the same as for the
+                         * constraint system the program was compiled from.
+                         */
+                        static qap_instance_evaluation<FieldType>
+                            instance_map_with_evaluation(const r1cs_witness_program<FieldType> &program,
+                                                         const typename FieldType::value_type &t,
+                                                         const bool swap_AB = false) {
+                            const std::size_t num_columns = program.num_variables() + 1;
 
-                            return qap_instance_evaluation<FieldType>(domain, cs.num_variables(), domain->m,
-                                                                      cs.num_inputs(), t, std::move(At), std::move(Bt),
-                                                                      std::move(Ct), std::move(Ht), Zt);
+                            return instance_map_with_evaluation_internal(
+                                program.num_constraints(), program.num_inputs(), program.num_variables(),
+                                (swap_AB ? program.b : program.a).transposed(num_columns),
+                                (swap_AB ? program.a : program.b).transposed(num_columns),
+                                program.c.transposed(num_columns), t);
                         }
 
                         /**
@@ -216,107 +271,752 @@ namespace nil {
                          */
                         static qap_witness<FieldType>
                             witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3) {
+                            return witness_map(cs, primary_input, auxiliary_input, d1, d2, d3, *shared_context(cs));
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-QAP reduction of an optimized constraint system, from
+                         * the auxiliary input of the system it was optimized from.
+                         */
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_optimized_constraint_system<FieldType> &optimized,
                                         const r1cs_primary_input<FieldType> &primary_input,
                                         const r1cs_auxiliary_input<FieldType> &auxiliary_input,
                                         const typename FieldType::value_type &d1,
                                         const typename FieldType::value_type &d2,
                                         const typename FieldType::value_type &d3) {
+                            return witness_map(optimized.constraint_system, primary_input,
+                                               optimized.map_auxiliary_input(auxiliary_input), d1, d2, d3);
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-QAP reduction of a constraint system of fixed size.
+                         * The domain only depends on the sizes, so its context is built on the first call
+                         * for each system type and shared by all later ones.
+                         */
+                        template<std::size_t NumConstraints, std::size_t PrimaryInputSize,
+                                 std::size_t AuxiliaryInputSize, std::size_t MaxEntries>
+                        static qap_witness<FieldType> witness_map(
+                            const static_r1cs_constraint_system<FieldType, NumConstraints, PrimaryInputSize,
+                                                                AuxiliaryInputSize, MaxEntries> &cs,
+                            const std::array<typename FieldType::value_type, PrimaryInputSize> &primary_input,
+                            const std::array<typename FieldType::value_type, AuxiliaryInputSize> &auxiliary_input,
+                            const typename FieldType::value_type &d1,
+                            const typename FieldType::value_type &d2,
+                            const typename FieldType::value_type &d3) {
                             /* sanity check */
                             assert(cs.is_satisfied(primary_input, auxiliary_input));
 
-                            const std::shared_ptr<fft::evaluation_domain<FieldType>> domain =
-                                fft::make_evaluation_domain<FieldType>(cs.num_constraints() + cs.num_inputs() + 1);
+                            static const reduction_context<FieldType> context = make_context(cs);
 
-                            r1cs_variable_assignment<FieldType> full_variable_assignment = primary_input;
+                            const auto variables = cs.full_variable_assignment(primary_input, auxiliary_input);
+                            r1cs_variable_assignment<FieldType> full_variable_assignment(variables.begin(),
+                                                                                         variables.end());
+
+                            workspace scratch;
+                            evaluate_ABC_internal(
+                                NumConstraints, PrimaryInputSize, full_variable_assignment,
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return cs.a.evaluate_row(i, assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return cs.b.evaluate_row(i, assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return cs.c.evaluate_row(i, assignment);
+                                },
+                                context, scratch);
+                            std::vector<typename FieldType::value_type> H =
+                                FFTBackend::coefficients_for_H(context, scratch.aA, scratch.aB, scratch.aC, d1, d2, d3);
+
+                            return qap_witness<FieldType>(cs.num_variables(), context.domain()->m, cs.num_inputs(), d1,
+                                                          d2, d3, std::move(full_variable_assignment), std::move(H));
+                        }
+
+                        /**
+                         * Evaluation domain used by the reduction for the constraint system cs.
+                         *
+                         * The domain only depends on the size of cs, so it can be built once and shared by
+                         * any number of witness_map calls for the same constraint system.
+                         */
+                        template<typename ConstraintSystemType>
+                        static std::shared_ptr<fft::evaluation_domain<FieldType>>
+                            get_domain(const ConstraintSystemType &cs) {
+                            return fft::make_evaluation_domain<FieldType>(cs.num_constraints() + cs.num_inputs() + 1);
+                        }
+
+                        /**
+                         * Number of constraints cs can grow by before the domain get_domain picks for it grows.
+                         *
+                         * The domain type depends on the number of points: the radix-2 domains round it up,
+                         * while the sequence domains, picked when the field has no large enough radix-2
+                         * subgroup, have exactly that many points. The headroom is the room left up to the
+                         * size of the domain, when that size still gets a domain of the same type.
+                         */
+                        template<typename ConstraintSystemType>
+                        static std::size_t domain_headroom(const ConstraintSystemType &cs) {
+                            const std::size_t degree = cs.num_constraints() + cs.num_inputs() + 1;
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> domain = get_domain(cs);
+                            if (domain->m <= degree) {
+                                return 0;
+                            }
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> full_domain =
+                                fft::make_evaluation_domain<FieldType>(domain->m);
+                            const fft::evaluation_domain<FieldType> &picked = *domain, &full = *full_domain;
+                            if (full.m != picked.m || typeid(full) != typeid(picked)) {
+                                return 0;
+                            }
+                            return domain->m - degree;
+                        }
+
+                        /**
+                         * Reduction context of the constraint system cs, with the coset shifts and the
+                         * division by Z precomputed once for all the witness maps of cs.
+                         */
+                        template<typename ConstraintSystemType>
+                        static reduction_context<FieldType> make_context(const ConstraintSystemType &cs) {
+                            return reduction_context<FieldType>(get_domain(cs), true);
+                        }
+
+                        /**
+                         * Precomputed context of the domain size of cs from the reduction context pool, shared
+                         * with every other constraint system of that domain size.
+                         */
+                        template<typename ConstraintSystemType>
+                        static std::shared_ptr<const reduction_context<FieldType>>
+                            shared_context(const ConstraintSystemType &cs) {
+                            return reduction_context_pool<FieldType>::get(get_domain(cs));
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-QAP reduction over a domain obtained from get_domain(cs),
+                         * or over the context returned by make_context(cs).
+                         */
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3,
+                                        const reduction_context<FieldType> &context) {
+                            workspace scratch;
+                            return witness_map(cs, primary_input, auxiliary_input, d1, d2, d3, context, scratch);
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-QAP reduction running in the buffers of scratch.
+                         *
+                         * With swap_AB set, the witness is the one of cs with the A and B sides of every
+                         * constraint exchanged, matching instance_map_with_evaluation(cs, t, true).
+                         */
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch,
+                                        const bool swap_AB = false) {
+                            /* sanity check */
+                            assert(cs.is_satisfied(primary_input, auxiliary_input));
+
+                            /* the only copy of the inputs, kept by the witness */
+                            r1cs_variable_assignment<FieldType> full_variable_assignment;
+                            full_variable_assignment.reserve(primary_input.size() + auxiliary_input.size());
+                            full_variable_assignment.insert(full_variable_assignment.end(), primary_input.begin(),
+                                                            primary_input.end());
                             full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
                                                             auxiliary_input.end());
 
-                            std::vector<typename FieldType::value_type> aA(domain->m, FieldType::value_type::zero()),
-                                aB(domain->m, FieldType::value_type::zero());
+                            std::vector<typename FieldType::value_type> H =
+                                coefficients_for_H(cs, full_variable_assignment, d1, d2, d3, context, scratch, swap_AB);
 
-                            /* account for the additional constraints input_i * 0 = 0 */
-                            for (std::size_t i = 0; i <= cs.num_inputs(); ++i) {
-                                aA[i + cs.num_constraints()] =
-                                    (i > 0 ? full_variable_assignment[i - 1] : FieldType::value_type::one());
-                            }
-                            /* account for all other constraints */
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                aA[i] += cs.constraints[i].a.evaluate(full_variable_assignment);
-                                aB[i] += cs.constraints[i].b.evaluate(full_variable_assignment);
+                            return qap_witness<FieldType>(cs.num_variables(), context.domain()->m, cs.num_inputs(), d1,
+                                                          d2, d3, std::move(full_variable_assignment), std::move(H));
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-QAP reduction of the assignment of a witness source,
+                         * such as r1cs_mapped_witness, read in place once it is complete. The witness keeps
+                         * its own copy of the assignment; r1cs_gg_ppzksnark_prover::process_streamed runs
+                         * on the source without one.
+                         */
+                        template<typename WitnessSource>
+                        static qap_witness<FieldType> witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                                                  const WitnessSource &witness,
+                                                                  const typename FieldType::value_type &d1,
+                                                                  const typename FieldType::value_type &d2,
+                                                                  const typename FieldType::value_type &d3,
+                                                                  const reduction_context<FieldType> &context) {
+                            const r1cs_variable_assignment_span<FieldType> full_variable_assignment(
+                                witness.wait_for(witness.num_variables()), witness.num_variables());
+                            return witness_map(cs, full_variable_assignment.subspan(0, witness.num_inputs()),
+                                               full_variable_assignment.subspan(witness.num_inputs()), d1, d2, d3,
+                                               context);
+                        }
+
+                        /**
+                         * Coefficients of the polynomial H of the witness map, computed from the full
+                         * variable assignment (x_1, ..., x_m) alone.
+                         *
+                         * This is the part of witness_map that needs the FFTs; a prover can run it while
+                         * the multi-exponentiations that only depend on the assignment are in flight.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_constraint_system<FieldType> &cs,
+                                               const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                               const typename FieldType::value_type &d1,
+                                               const typename FieldType::value_type &d2,
+                                               const typename FieldType::value_type &d3,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch,
+                                               const bool swap_AB = false) {
+                            evaluate_ABC(cs, full_variable_assignment, context, scratch, swap_AB);
+                            return keep_workspace(scratch, FFTBackend::coefficients_for_H(context, scratch.aA,
+                                                                                          scratch.aB, scratch.aC, d1,
+                                                                                          d2, d3));
+                        }
+
+                        /**
+                         * Witness map with d1 = d2 = d3 = 0, as in the r1cs_gg_ppzksnark provers, which
+                         * randomize the proof with r and s instead. The patch terms of H are then known to
+                         * vanish at compile time, and FFTBackend computes H without them, see
+                         * r1cs_to_qap_fft_backend.hpp. The witness is the one of witness_map with zero d1,
+                         * d2 and d3.
+                         */
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) {
+                            return witness_map(cs, primary_input, auxiliary_input, *shared_context(cs));
+                        }
+
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const reduction_context<FieldType> &context) {
+                            workspace scratch;
+                            return witness_map(cs, primary_input, auxiliary_input, context, scratch);
+                        }
+
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch,
+                                        const bool swap_AB = false) {
+                            /* sanity check */
+                            assert(cs.is_satisfied(primary_input, auxiliary_input));
+
+                            /* the only copy of the inputs, kept by the witness */
+                            r1cs_variable_assignment<FieldType> full_variable_assignment;
+                            full_variable_assignment.reserve(primary_input.size() + auxiliary_input.size());
+                            full_variable_assignment.insert(full_variable_assignment.end(), primary_input.begin(),
+                                                            primary_input.end());
+                            full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
+                                                            auxiliary_input.end());
+
+                            std::vector<typename FieldType::value_type> H =
+                                coefficients_for_H(cs, full_variable_assignment, context, scratch, swap_AB);
+
+                            const typename FieldType::value_type zero = FieldType::value_type::zero();
+                            return qap_witness<FieldType>(cs.num_variables(), context.domain()->m, cs.num_inputs(),
+                                                          zero, zero, zero, std::move(full_variable_assignment),
+                                                          std::move(H));
+                        }
+
+                        /**
+                         * Witness map with d1 = d2 = d3 = 0 whose witness is allocated with allocator, e.g.
+                         * from the memory_arena of a request, for r1cs_gg_ppzksnark_prover::process_witness.
+                         * The FFTs of the domain run on std::vector, so they run in the buffers of scratch,
+                         * which the H coefficients are copied out of: scratch keeps all its buffers for the
+                         * next call, and the request only allocates from allocator.
+                         */
+                        template<typename Allocator>
+                        static qap_witness<FieldType, Allocator>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch,
+                                        const Allocator &allocator) {
+                            typedef typename qap_witness<FieldType, Allocator>::coefficients_type coefficients_type;
+
+                            /* sanity check */
+                            assert(cs.is_satisfied(primary_input, auxiliary_input));
+
+                            coefficients_type full_variable_assignment(allocator);
+                            full_variable_assignment.reserve(primary_input.size() + auxiliary_input.size());
+                            full_variable_assignment.insert(full_variable_assignment.end(), primary_input.begin(),
+                                                            primary_input.end());
+                            full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
+                                                            auxiliary_input.end());
+
+                            evaluate_ABC(cs, full_variable_assignment, context, scratch, false);
+                            std::vector<typename FieldType::value_type> H =
+                                FFTBackend::coefficients_for_H(context, scratch.aA, scratch.aB, scratch.aC);
+                            coefficients_type coefficients_for_H(H.begin(), H.end(), allocator);
+                            if (holds_workspace_buffer(scratch, H)) {
+                                scratch.aA.swap(H);
                             }
 
-                            domain->iFFT(aA);
+                            const typename FieldType::value_type zero = FieldType::value_type::zero();
+                            return qap_witness<FieldType, Allocator>(
+                                cs.num_variables(), context.domain()->m, cs.num_inputs(), zero, zero, zero,
+                                std::move(full_variable_assignment), std::move(coefficients_for_H));
+                        }
 
-                            domain->iFFT(aB);
+                        /**
+                         * One proof of a batch_witness_map: a constraint system, not owned, and its inputs.
+                         */
+                        struct witness_request {
+                            const r1cs_constraint_system<FieldType> *cs;
+                            r1cs_primary_input_span<FieldType> primary_input;
+                            r1cs_auxiliary_input_span<FieldType> auxiliary_input;
+                        };
 
-                            std::vector<typename FieldType::value_type> coefficients_for_H(
-                                domain->m + 1, FieldType::value_type::zero());
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            /* add coefficients of the polynomial (d2*A + d1*B - d3) + d1*d2*Z */
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                coefficients_for_H[i] = d2 * aA[i] + d1 * aB[i];
+                        /**
+                         * Witness maps with d1 = d2 = d3 = 0 of a batch of proofs over any number of
+                         * constraint systems, in the order of requests.
+                         *
+                         * The requests whose domains have the same size run over the same pooled context, see
+                         * shared_context. Every witness map is a task of the current executor with a workspace
+                         * of its own, so the FFTs of the batch run side by side, one per thread, rather than
+                         * one after the other, each split across the threads.
+                         */
+                        static std::vector<qap_witness<FieldType>>
+                            batch_witness_map(const std::vector<witness_request> &requests) {
+                            std::vector<std::shared_ptr<const reduction_context<FieldType>>> contexts;
+                            contexts.reserve(requests.size());
+                            for (const witness_request &request : requests) {
+                                contexts.push_back(shared_context(*request.cs));
                             }
-                            coefficients_for_H[0] -= d3;
-                            domain->add_poly_Z(d1 * d2, coefficients_for_H);
-
-                            fft::multiply_by_coset(aA,
-                                                   typename FieldType::value_type(
-                                                       fields::arithmetic_params<FieldType>::multiplicative_generator));
-                            domain->FFT(aA);
-
-                            fft::multiply_by_coset(aB,
-                                                   typename FieldType::value_type(
-                                                       fields::arithmetic_params<FieldType>::multiplicative_generator));
-                            domain->FFT(aB);
-
-                            std::vector<typename FieldType::value_type> &H_tmp = aA;
-                            // can overwrite aA because it is not used later
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                H_tmp[i] = aA[i] * aB[i];
+
+                            std::vector<std::unique_ptr<qap_witness<FieldType>>> witnesses(requests.size());
+                            executor::current().bulk(requests.size(), [&](const std::size_t i) {
+                                const witness_request &request = requests[i];
+                                workspace scratch;
+                                witnesses[i].reset(new qap_witness<FieldType>(
+                                    witness_map(*request.cs, request.primary_input, request.auxiliary_input,
+                                                *contexts[i], scratch)));
+                            });
+
+                            std::vector<qap_witness<FieldType>> result;
+                            result.reserve(requests.size());
+                            for (std::unique_ptr<qap_witness<FieldType>> &witness : witnesses) {
+                                result.push_back(std::move(*witness));
                             }
-                            std::vector<typename FieldType::value_type>().swap(aB);    // destroy aB
+                            return result;
+                        }
+
+                        /**
+                         * Coefficients of the polynomial H of the witness map with d1 = d2 = d3 = 0.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_constraint_system<FieldType> &cs,
+                                               const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch,
+                                               const bool swap_AB = false) {
+                            evaluate_ABC(cs, full_variable_assignment, context, scratch, swap_AB);
+                            return keep_workspace(scratch, FFTBackend::coefficients_for_H(context, scratch.aA,
+                                                                                          scratch.aB, scratch.aC));
+                        }
 
-                            std::vector<typename FieldType::value_type> aC(domain->m, FieldType::value_type::zero());
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                aC[i] += cs.constraints[i].c.evaluate(full_variable_assignment);
+                        /**
+                         * Evaluations of H = (A * B - C) / Z on the coset g*S of the domain S, for the
+                         * witness map with d1 = d2 = d3 = 0, computed from the full variable assignment.
+                         *
+                         * They are the scalars of an H_query in the Lagrange basis of the coset, so the
+                         * inverse FFT and the coset pass turning them into coefficients are left out. The
+                         * evaluations are copied out of scratch.aA, which keeps its buffer, see workspace.
+                         * FFTBackend has to provide evaluations_for_H_on_coset, see
+                         * r1cs_to_qap_fft_backend.hpp.
+                         */
+                        static std::vector<typename FieldType::value_type> evaluations_for_H_on_coset(
+                            const r1cs_constraint_system<FieldType> &cs,
+                            const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                            const reduction_context<FieldType> &context, workspace &scratch,
+                            const bool swap_AB = false) {
+                            evaluate_ABC(cs, full_variable_assignment, context, scratch, swap_AB);
+                            FFTBackend::evaluations_for_H_on_coset(context, scratch.aA, scratch.aB, scratch.aC);
+                            if (memory_budget::current().limited()) {
+                                return std::move(scratch.aA);
                             }
+                            return std::vector<typename FieldType::value_type>(scratch.aA.begin(), scratch.aA.end());
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-QAP reduction of a compiled witness evaluation
+                         * program. The resulting witness is the same as for the constraint system the
+                         * program was compiled from.
+                         */
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_witness_program<FieldType> &program,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3) {
+                            return witness_map(program, primary_input, auxiliary_input, d1, d2, d3,
+                                               *shared_context(program));
+                        }
+
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_witness_program<FieldType> &program,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3,
+                                        const reduction_context<FieldType> &context) {
+                            workspace scratch;
+                            return witness_map(program, primary_input, auxiliary_input, d1, d2, d3, context, scratch);
+                        }
+
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_witness_program<FieldType> &program,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch) {
+                            /* sanity check */
+                            assert(program.is_satisfied(primary_input, auxiliary_input));
+
+                            /* the only copy of the inputs, kept by the witness */
+                            r1cs_variable_assignment<FieldType> full_variable_assignment;
+                            full_variable_assignment.reserve(primary_input.size() + auxiliary_input.size());
+                            full_variable_assignment.insert(full_variable_assignment.end(), primary_input.begin(),
+                                                            primary_input.end());
+                            full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
+                                                            auxiliary_input.end());
+
+                            std::vector<typename FieldType::value_type> H =
+                                coefficients_for_H(program, full_variable_assignment, d1, d2, d3, context, scratch);
+
+                            return qap_witness<FieldType>(program.num_variables(), context.domain()->m,
+                                                          program.num_inputs(), d1, d2, d3,
+                                                          std::move(full_variable_assignment), std::move(H));
+                        }
+
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_witness_program<FieldType> &program,
+                                               const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                               const typename FieldType::value_type &d1,
+                                               const typename FieldType::value_type &d2,
+                                               const typename FieldType::value_type &d3,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch) {
+                            evaluate_ABC(program, full_variable_assignment, context, scratch);
+                            return keep_workspace(scratch, FFTBackend::coefficients_for_H(context, scratch.aA,
+                                                                                          scratch.aB, scratch.aC, d1,
+                                                                                          d2, d3));
+                        }
+
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_witness_program<FieldType> &program,
+                                               const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch) {
+                            evaluate_ABC(program, full_variable_assignment, context, scratch);
+                            return keep_workspace(scratch, FFTBackend::coefficients_for_H(context, scratch.aA,
+                                                                                          scratch.aB, scratch.aC));
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-QAP reduction of the bytecode of a constraint system,
+                         * see r1cs_bytecode.hpp. The resulting witness is the same as for the constraint
+                         * system the bytecode was compiled from.
+                         */
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_bytecode<FieldType> &bytecode,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3) {
+                            workspace scratch;
+                            return witness_map(bytecode, primary_input, auxiliary_input, d1, d2, d3,
+                                               *shared_context(bytecode), scratch);
+                        }
+
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_bytecode<FieldType> &bytecode,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const typename FieldType::value_type &d3,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch) {
+                            r1cs_variable_assignment<FieldType> full_variable_assignment =
+                                concatenate(primary_input, auxiliary_input);
+                            /* sanity check */
+                            assert(bytecode.is_satisfied(full_variable_assignment));
+
+                            std::vector<typename FieldType::value_type> H =
+                                coefficients_for_H(bytecode, full_variable_assignment, d1, d2, d3, context, scratch);
+
+                            return qap_witness<FieldType>(bytecode.num_variables(), context.domain()->m,
+                                                          bytecode.num_inputs(), d1, d2, d3,
+                                                          std::move(full_variable_assignment), std::move(H));
+                        }
+
+                        /**
+                         * Same as above with d1 = d2 = d3 = 0, as in the r1cs_gg_ppzksnark provers.
+                         */
+                        static qap_witness<FieldType>
+                            witness_map(const r1cs_bytecode<FieldType> &bytecode,
+                                        const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch) {
+                            r1cs_variable_assignment<FieldType> full_variable_assignment =
+                                concatenate(primary_input, auxiliary_input);
+                            /* sanity check */
+                            assert(bytecode.is_satisfied(full_variable_assignment));
 
-                            domain->iFFT(aC);
+                            std::vector<typename FieldType::value_type> H =
+                                coefficients_for_H(bytecode, full_variable_assignment, context, scratch);
 
-                            fft::multiply_by_coset(aC,
-                                                   typename FieldType::value_type(
-                                                       fields::arithmetic_params<FieldType>::multiplicative_generator));
-                            domain->FFT(aC);
+                            const typename FieldType::value_type zero = FieldType::value_type::zero();
+                            return qap_witness<FieldType>(bytecode.num_variables(), context.domain()->m,
+                                                          bytecode.num_inputs(), zero, zero, zero,
+                                                          std::move(full_variable_assignment), std::move(H));
+                        }
+
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_bytecode<FieldType> &bytecode,
+                                               const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                               const typename FieldType::value_type &d1,
+                                               const typename FieldType::value_type &d2,
+                                               const typename FieldType::value_type &d3,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch) {
+                            evaluate_ABC(bytecode, full_variable_assignment, context, scratch);
+                            return keep_workspace(scratch, FFTBackend::coefficients_for_H(context, scratch.aA,
+                                                                                          scratch.aB, scratch.aC, d1,
+                                                                                          d2, d3));
+                        }
+
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_bytecode<FieldType> &bytecode,
+                                               const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch) {
+                            evaluate_ABC(bytecode, full_variable_assignment, context, scratch);
+                            return keep_workspace(scratch, FFTBackend::coefficients_for_H(context, scratch.aA,
+                                                                                          scratch.aB, scratch.aC));
+                        }
 
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                H_tmp[i] = (H_tmp[i] - aC[i]);
+                    private:
+                        /* Whether H was returned in the storage of scratch.aA, to be given back to scratch. */
+                        static bool holds_workspace_buffer(const workspace &scratch,
+                                                           const std::vector<typename FieldType::value_type> &H) {
+                            return !memory_budget::current().limited() && scratch.aA.capacity() < H.capacity();
+                        }
+
+                        /* H returned by FFTBackend, copied out of the buffers of scratch if it is in them. */
+                        static std::vector<typename FieldType::value_type>
+                            keep_workspace(workspace &scratch, std::vector<typename FieldType::value_type> &&H) {
+                            if (!holds_workspace_buffer(scratch, H)) {
+                                return std::move(H);
                             }
+                            std::vector<typename FieldType::value_type> result(H.begin(), H.end());
+                            scratch.aA.swap(H);
+                            return result;
+                        }
+
+                        /* (x_1, ..., x_m) as the only copy of the inputs, kept by the witness */
+                        static r1cs_variable_assignment<FieldType>
+                            concatenate(const r1cs_primary_input_span<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) {
+                            r1cs_variable_assignment<FieldType> full_variable_assignment;
+                            full_variable_assignment.reserve(primary_input.size() + auxiliary_input.size());
+                            full_variable_assignment.insert(full_variable_assignment.end(), primary_input.begin(),
+                                                            primary_input.end());
+                            full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
+                                                            auxiliary_input.end());
+                            return full_variable_assignment;
+                        }
+
+                        /**
+                         * Instance map from the A, B and C matrices in column-major layout: row k of each
+                         * matrix lists the constraints touching variable k.
+                         *
+                         * Every entry of At, Bt and Ct is then an independent dot product of a row with the
+                         * Lagrange coefficients at t, so the variables are split across the current executor
+                         * without any two threads writing the same entry.
+                         */
+                        static qap_instance_evaluation<FieldType> instance_map_with_evaluation_internal(
+                            const std::size_t num_constraints, const std::size_t num_inputs,
+                            const std::size_t num_variables, const r1cs_sparse_matrix<FieldType> &A_columns,
+                            const r1cs_sparse_matrix<FieldType> &B_columns,
+                            const r1cs_sparse_matrix<FieldType> &C_columns, const typename FieldType::value_type &t) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> domain =
+                                fft::make_evaluation_domain<FieldType>(num_constraints + num_inputs + 1);
 
-                            domain->divide_by_Z_on_coset(H_tmp);
+                            std::vector<typename FieldType::value_type> At, Bt, Ct, Ht;
 
-                            domain->iFFT(H_tmp);
+                            At.resize(num_variables + 1, FieldType::value_type::zero());
+                            Bt.resize(num_variables + 1, FieldType::value_type::zero());
+                            Ct.resize(num_variables + 1, FieldType::value_type::zero());
+                            Ht.reserve(domain->m + 1);
 
-                            multiply_by_coset(H_tmp,
-                                              typename FieldType::value_type(
-                                                  fields::arithmetic_params<FieldType>::multiplicative_generator)
-                                                  .inversed());
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                coefficients_for_H[i] += H_tmp[i];
+                            const typename FieldType::value_type Zt = domain->compute_vanishing_polynomial(t);
+
+                            const std::vector<typename FieldType::value_type> u =
+                                domain->evaluate_all_lagrange_polynomials(t);
+                            /* process the constraints */
+                            executor::current().parallel_for(num_variables + 1, [&](const std::size_t i) {
+                                At[i] = A_columns.dot_row(i, u);
+                                Bt[i] = B_columns.dot_row(i, u);
+                                Ct[i] = C_columns.dot_row(i, u);
+                            });
+
+                            /**
+                             * add and process the constraints
+                             *     input_i * 0 = 0
+                             * to ensure soundness of input consistency
+                             */
+                            for (std::size_t i = 0; i <= num_inputs; ++i) {
+                                At[i] += u[num_constraints + i];
+                            }
+
+                            typename FieldType::value_type ti = FieldType::value_type::one();
+                            for (std::size_t i = 0; i < domain->m + 1; ++i) {
+                                Ht.emplace_back(ti);
+                                ti *= t;
                             }
 
-                            return qap_witness<FieldType>(cs.num_variables(), domain->m, cs.num_inputs(), d1, d2, d3,
-                                                          full_variable_assignment, std::move(coefficients_for_H));
+                            return qap_instance_evaluation<FieldType>(domain, num_variables, domain->m, num_inputs, t,
+                                                                      std::move(At), std::move(Bt), std::move(Ct),
+                                                                      std::move(Ht), Zt);
+                        }
+
+                        /* Evaluations of A, B and C of the constraint system cs on the domain, into scratch. */
+                        static void
+                            evaluate_ABC(const r1cs_constraint_system<FieldType> &cs,
+                                         const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                         const reduction_context<FieldType> &context, workspace &scratch,
+                                         const bool swap_AB) {
+                            evaluate_ABC_internal(
+                                cs.num_constraints(), cs.num_inputs(), full_variable_assignment,
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return (swap_AB ? cs.constraints[i].b : cs.constraints[i].a).evaluate(assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return (swap_AB ? cs.constraints[i].a : cs.constraints[i].b).evaluate(assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return cs.constraints[i].c.evaluate(assignment);
+                                },
+                                context, scratch);
+                        }
+
+                        /* Evaluations of A, B and C of the compiled program on the domain, into scratch. */
+                        static void
+                            evaluate_ABC(const r1cs_witness_program<FieldType> &program,
+                                         const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                         const reduction_context<FieldType> &context, workspace &scratch) {
+                            evaluate_ABC_internal(
+                                program.num_constraints(), program.num_inputs(), full_variable_assignment,
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return program.a.evaluate_row(i, assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return program.b.evaluate_row(i, assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return program.c.evaluate_row(i, assignment);
+                                },
+                                context, scratch);
+                        }
+
+                        /*
+                         * Evaluations of A, B and C of the bytecode on the domain, into scratch: the rows
+                         * are run in blocks as for the other systems, then the common subexpressions are
+                         * copied from their first occurrences.
+                         */
+                        static void
+                            evaluate_ABC(const r1cs_bytecode<FieldType> &bytecode,
+                                         const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                                         const reduction_context<FieldType> &context, workspace &scratch) {
+                            evaluate_ABC_internal(
+                                bytecode.num_constraints(), bytecode.num_inputs(), full_variable_assignment,
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return bytecode.a.evaluate_row(i, assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return bytecode.b.evaluate_row(i, assignment);
+                                },
+                                [&](std::size_t i, const r1cs_variable_assignment_span<FieldType> &assignment) {
+                                    return bytecode.c.evaluate_row(i, assignment);
+                                },
+                                context, scratch);
+                            bytecode.a.copy_duplicates(scratch.aA.data());
+                            bytecode.b.copy_duplicates(scratch.aB.data());
+                            bytecode.c.copy_duplicates(scratch.aC.data());
+                        }
+
+                        template<typename EvaluateA, typename EvaluateB, typename EvaluateC>
+                        static void evaluate_ABC_internal(
+                            const std::size_t num_constraints, const std::size_t num_inputs,
+                            const r1cs_variable_assignment_span<FieldType> &full_variable_assignment,
+                            EvaluateA evaluate_a, EvaluateB evaluate_b, EvaluateC evaluate_c,
+                            const reduction_context<FieldType> &context, workspace &scratch) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+                            assert(domain->m >= num_constraints + num_inputs + 1);
+
+                            stage_profiler::timer evaluate_timer("evaluate", num_constraints);
+                            std::vector<typename FieldType::value_type> &aA = scratch.aA, &aB = scratch.aB,
+                                                                         &aC = scratch.aC;
+                            /* room for the last coefficient of H, which may be computed in aA */
+                            reserve_with_huge_pages(aA, domain->m + 1);
+                            reserve_with_huge_pages(aB, domain->m);
+                            reserve_with_huge_pages(aC, domain->m);
+                            aA.assign(domain->m, FieldType::value_type::zero());
+                            aB.assign(domain->m, FieldType::value_type::zero());
+                            aC.assign(domain->m, FieldType::value_type::zero());
+
+                            /* account for the additional constraints input_i * 0 = 0 */
+                            aA[num_constraints] = FieldType::value_type::one();
+                            executor::current().parallel_for(num_inputs, [&](const std::size_t i) {
+                                aA[i + 1 + num_constraints] = full_variable_assignment[i];
+                            });
+                            /* account for all other constraints: A, B and C are evaluated in a single
+                               pass over the constraints, split into contiguous blocks of rows */
+                            executor::current().parallel_for(num_constraints, [&](const std::size_t i) {
+                                aA[i] += evaluate_a(i, full_variable_assignment);
+                                aB[i] += evaluate_b(i, full_variable_assignment);
+                                aC[i] += evaluate_c(i, full_variable_assignment);
+                            });
+                            evaluate_timer.stop();
+                        }
+
+                    public:
+                        /**
+                         * Computes the evaluations of H * Z = A * B - C on the coset g*S of the domain S,
+                         * given the coefficients of A, B and C; the result is written into aA.
+                         */
+                        static void compute_H_on_coset(const reduction_context<FieldType> &context,
+                                                       std::vector<typename FieldType::value_type> &aA,
+                                                       std::vector<typename FieldType::value_type> &aB,
+                                                       std::vector<typename FieldType::value_type> &aC) {
+                            r1cs_to_qap_cpu_fft_backend<FieldType>::compute_H_on_coset(context, aA, aB, aC);
                         }
                     };
                 }    // namespace reductions
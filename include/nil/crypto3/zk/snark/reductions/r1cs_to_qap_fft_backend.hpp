@@ -0,0 +1,462 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the FFT backends computing the polynomial H of the R1CS-to-QAP witness map.
+//
+// The witness map evaluates A, B and C on the domain S on the host; an FFT backend then
+// turns these evaluations into the coefficients of H: the inverse FFTs of A, B and C, their
+// FFTs on the coset g*S, the pointwise A * B - C, the division by Z on the coset and the
+// final inverse FFT. The whole chain goes through a single call, so a backend running on
+// an accelerator uploads the three evaluation vectors once, keeps the intermediates in
+// device memory and only hands back H.
+//
+// A backend is a policy type providing
+//     static std::vector<value_type> coefficients_for_H(context, aA, aB, aC, d1, d2, d3);
+// where context is the reduction_context of the domain, see reduction_context.hpp, and aA,
+// aB and aC are domain-sized and may be used as scratch or released; the default backend
+// releases them within a limited memory budget, see memory_budget.hpp. A backend that also
+// evaluates the H_query multi-exponentiation can keep its device copy of H for that call.
+//
+// A backend also provides
+//     static std::vector<value_type> coefficients_for_H(context, aA, aB, aC);
+// the same with d1 = d2 = d3 = 0, as in the r1cs_gg_ppzksnark provers. The default backend
+// returns H in the storage of aA either way, which the witness map reserves with room for
+// the domain->m + 1 coefficients of H, so the peak is the three evaluation vectors.
+//
+// A backend may also provide
+//     static void evaluations_for_H_on_coset(context, aA, aB, aC);
+// computing the evaluations of H on the coset g*S into aA, for provers whose H_query is in
+// the Lagrange basis of the coset. It is only instantiated by those provers.
+//
+// r1cs_to_qap_six_step_fft_backend runs the chain out of core, for domains whose vectors do
+// not fit in memory together: A, B and C are moved into block storage and transformed
+// there by six-step FFTs, see six_step_fft.hpp.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_TO_QAP_FFT_BACKEND_HPP
+#define CRYPTO3_ZK_R1CS_TO_QAP_FFT_BACKEND_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/math/domains/basic_radix2_domain.hpp>
+#include <nil/crypto3/math/domains/evaluation_domain.hpp>
+
+#include <nil/crypto3/algebra/fields/params.hpp>
+
+#include <nil/crypto3/zk/snark/reductions/detail/field_kernels.hpp>
+#include <nil/crypto3/zk/snark/reductions/detail/scale_by_powers.hpp>
+#include <nil/crypto3/zk/snark/reductions/reduction_context.hpp>
+#include <nil/crypto3/zk/snark/reductions/six_step_fft.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/huge_pages.hpp>
+#include <nil/crypto3/zk/snark/memory_budget.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace reductions {
+                    /**
+                     * Computes H with the FFTs of the evaluation domain, on the current executor.
+                     */
+                    template<typename FieldType>
+                    struct r1cs_to_qap_cpu_fft_backend {
+                        typedef FieldType field_type;
+
+                        /**
+                         * Coefficients of H, given the evaluations aA, aB and aC of A, B and C on the
+                         * domain, with the polynomial (d2*A + d1*B - d3) + d1*d2*Z added to them.
+                         *
+                         * d2*A + d1*B has degree below the domain size, so it is added to the evaluations
+                         * of H on the coset, which are at hand, before the last inverse FFT. H is then
+                         * computed in aA and moved out of it, and the peak is the three evaluation vectors.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const reduction_context<FieldType> &context,
+                                               std::vector<typename FieldType::value_type> &aA,
+                                               std::vector<typename FieldType::value_type> &aB,
+                                               std::vector<typename FieldType::value_type> &aC,
+                                               const typename FieldType::value_type &d1,
+                                               const typename FieldType::value_type &d2,
+                                               const typename FieldType::value_type &d3) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+
+                            stage_profiler::timer fft_timer("fft", domain->m);
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aA); });
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aB); });
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aC); });
+
+                            if (d1.is_zero() && d2.is_zero()) {
+                                compute_H_on_coset(context, aA, aB, aC);
+                            } else {
+                                coset_FFT(context, aA, aB, aC);
+                                /* aC = A * B - C and aA = d2*A + d1*B on the coset, then H plus the latter */
+                                detail::field_kernels<FieldType>::multiply_subtract(aC.data(), aA.data(), aB.data(),
+                                                                                    aC.data(), domain->m);
+                                detail::field_kernels<FieldType>::linear_combination(aA.data(), d2, aA.data(), d1,
+                                                                                     aB.data(), domain->m);
+                                stage_profiler::run_stage("divide_by_Z", domain->m,
+                                                          [&]() { context.divide_by_Z_on_coset(aC); });
+                                detail::field_kernels<FieldType>::add(aA.data(), aC.data(), domain->m);
+                            }
+                            if (memory_budget::current().limited()) {
+                                release(aB);
+                                release(aC);
+                            }
+
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aA); });
+
+                            /* undo the coset shift, then add the polynomial d1*d2*Z - d3 */
+                            context.for_each_inverse_coset_power(
+                                [&](std::size_t i, const typename FieldType::value_type &power) { aA[i] *= power; });
+                            aA.resize(domain->m + 1, FieldType::value_type::zero());
+                            aA[0] -= d3;
+                            domain->add_poly_Z(d1 * d2, aA);
+
+                            return std::move(aA);
+                        }
+
+                        /**
+                         * Coefficients of H = (A * B - C) / Z, given the evaluations aA, aB and aC of A, B
+                         * and C on the domain, with d1 = d2 = d3 = 0.
+                         *
+                         * There is no patch polynomial to add, so H is computed in aA and moved out of it
+                         * once the coset shift is undone, without a buffer and two domain passes of its own.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const reduction_context<FieldType> &context,
+                                               std::vector<typename FieldType::value_type> &aA,
+                                               std::vector<typename FieldType::value_type> &aB,
+                                               std::vector<typename FieldType::value_type> &aC) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+
+                            stage_profiler::timer fft_timer("fft", domain->m);
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aA); });
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aB); });
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aC); });
+
+                            compute_H_on_coset(context, aA, aB, aC);
+                            if (memory_budget::current().limited()) {
+                                release(aB);
+                                release(aC);
+                            }
+
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aA); });
+
+                            /* undo the coset shift */
+                            context.for_each_inverse_coset_power(
+                                [&](std::size_t i, const typename FieldType::value_type &power) { aA[i] *= power; });
+                            aA.resize(domain->m + 1, FieldType::value_type::zero());
+
+                            return std::move(aA);
+                        }
+
+                        /**
+                         * Evaluations of H = (A * B - C) / Z on the coset g*S, given the evaluations aA, aB
+                         * and aC of A, B and C on the domain; the result is written into aA.
+                         */
+                        static void evaluations_for_H_on_coset(const reduction_context<FieldType> &context,
+                                                               std::vector<typename FieldType::value_type> &aA,
+                                                               std::vector<typename FieldType::value_type> &aB,
+                                                               std::vector<typename FieldType::value_type> &aC) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+
+                            stage_profiler::timer fft_timer("fft", domain->m);
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aA); });
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aB); });
+                            stage_profiler::run_stage("iFFT", domain->m, [&]() { domain->iFFT(aC); });
+
+                            compute_H_on_coset(context, aA, aB, aC);
+                            if (memory_budget::current().limited()) {
+                                release(aB);
+                                release(aC);
+                            }
+                        }
+
+                    private:
+                        static void release(std::vector<typename FieldType::value_type> &values) {
+                            std::vector<typename FieldType::value_type>().swap(values);
+                        }
+
+                    public:
+                        /**
+                         * Computes the evaluations of H * Z = A * B - C on the coset g*S of the domain S,
+                         * given the coefficients of A, B and C; the result is written into aA.
+                         *
+                         * A * B - C is formed in one pointwise pass before the division by Z.
+                         */
+                        static void compute_H_on_coset(const reduction_context<FieldType> &context,
+                                                       std::vector<typename FieldType::value_type> &aA,
+                                                       std::vector<typename FieldType::value_type> &aB,
+                                                       std::vector<typename FieldType::value_type> &aC) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+
+                            coset_FFT(context, aA, aB, aC);
+
+                            detail::field_kernels<FieldType>::multiply_subtract(aA.data(), aA.data(), aB.data(),
+                                                                                aC.data(), domain->m);
+
+                            stage_profiler::run_stage("divide_by_Z", domain->m,
+                                                      [&]() { context.divide_by_Z_on_coset(aA); });
+                        }
+
+                        /**
+                         * Replaces the coefficients of A, B and C by their evaluations on the coset g*S, with
+                         * the coset shift of the three polynomials done in one pass.
+                         */
+                        static void coset_FFT(const reduction_context<FieldType> &context,
+                                              std::vector<typename FieldType::value_type> &aA,
+                                              std::vector<typename FieldType::value_type> &aB,
+                                              std::vector<typename FieldType::value_type> &aC) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+
+                            context.for_each_coset_power(
+                                [&](std::size_t i, const typename FieldType::value_type &power) {
+                                    aA[i] *= power;
+                                    aB[i] *= power;
+                                    aC[i] *= power;
+                                });
+
+                            stage_profiler::run_stage("coset_FFT", domain->m, [&]() { domain->FFT(aA); });
+                            stage_profiler::run_stage("coset_FFT", domain->m, [&]() { domain->FFT(aB); });
+                            stage_profiler::run_stage("coset_FFT", domain->m, [&]() { domain->FFT(aC); });
+                        }
+                    };
+
+                    /**
+                     * Computes H in block storage with six-step FFTs, holding about BlockSize field
+                     * elements in memory besides the result.
+                     *
+                     * The evaluation vectors handed in are moved into three Storage vectors and released;
+                     * the transforms run in place, alternating between natural and transposed order, so
+                     * no fourth vector is needed. Every pass over the storage reads and writes contiguous
+                     * blocks. Domains other than basic radix-2 ones are left to the in-memory backend.
+                     */
+                    template<typename FieldType,
+                             typename Storage = fft_file_storage<typename FieldType::value_type>,
+                             std::size_t BlockSize = (std::size_t(1) << 20)>
+                    struct r1cs_to_qap_six_step_fft_backend {
+                        typedef FieldType field_type;
+                        typedef Storage storage_type;
+
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const reduction_context<FieldType> &context,
+                                               std::vector<typename FieldType::value_type> &aA,
+                                               std::vector<typename FieldType::value_type> &aB,
+                                               std::vector<typename FieldType::value_type> &aC,
+                                               const typename FieldType::value_type &d1,
+                                               const typename FieldType::value_type &d2,
+                                               const typename FieldType::value_type &d3) {
+                            typedef typename FieldType::value_type value_type;
+
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+
+                            const fft::basic_radix2_domain<FieldType> *radix2_domain =
+                                dynamic_cast<const fft::basic_radix2_domain<FieldType> *>(domain.get());
+                            const std::size_t m = domain->m;
+                            if (radix2_domain == nullptr || m < 2) {
+                                return r1cs_to_qap_cpu_fft_backend<FieldType>::coefficients_for_H(context, aA, aB,
+                                                                                                   aC, d1, d2, d3);
+                            }
+
+                            std::size_t log_m = 0;
+                            while ((std::size_t(1) << log_m) < m) {
+                                ++log_m;
+                            }
+                            const std::size_t n1 = std::size_t(1) << ((log_m + 1) / 2);
+                            const std::size_t n2 = m / n1;
+
+                            const value_type omega = radix2_domain->omega;
+                            const value_type omega_inverse = omega.inversed();
+                            const value_type m_inverse = value_type(m).inversed();
+                            const value_type g =
+                                value_type(fields::arithmetic_params<FieldType>::multiplicative_generator);
+                            const value_type g_inverse = g.inversed();
+                            const value_type one = value_type::one();
+
+                            Storage A(m), B(m), C(m);
+                            stage_profiler::run_stage("spill", m, [&]() {
+                                spill(aA, A);
+                                spill(aB, B);
+                                spill(aC, C);
+                            });
+
+                            /* the coefficients are in transposed order, the evaluations in natural order */
+                            const auto interpolate = [&](Storage &storage) {
+                                six_step_fft(storage, n1, n2, omega_inverse, m_inverse, BlockSize);
+                            };
+                            const auto evaluate = [&](Storage &storage) {
+                                six_step_fft_transposed(storage, n1, n2, omega, one, BlockSize);
+                            };
+
+                            stage_profiler::timer fft_timer("fft", m);
+                            stage_profiler::run_stage("iFFT", m, [&]() { interpolate(A); });
+                            stage_profiler::run_stage("iFFT", m, [&]() { interpolate(B); });
+                            stage_profiler::run_stage("iFFT", m, [&]() { interpolate(C); });
+
+                            std::vector<typename FieldType::value_type> coefficients_for_H(m + 1, value_type::zero());
+                            /* add coefficients of the polynomial (d2*A + d1*B - d3) + d1*d2*Z */
+                            if (!d1.is_zero() || !d2.is_zero()) {
+                                std::vector<value_type> block_A, block_B;
+                                for_each_block(m, [&](const std::size_t first, const std::size_t count) {
+                                    block_A.resize(count);
+                                    block_B.resize(count);
+                                    A.read(first, count, block_A.data());
+                                    B.read(first, count, block_B.data());
+                                    executor::current().parallel_for(count, [&](const std::size_t i) {
+                                        coefficients_for_H[transposed_index(first + i, n1, n2)] =
+                                            d2 * block_A[i] + d1 * block_B[i];
+                                    });
+                                });
+                            }
+                            coefficients_for_H[0] -= d3;
+                            domain->add_poly_Z(d1 * d2, coefficients_for_H);
+
+                            /* coset shift of the three polynomials in one pass */
+                            {
+                                const value_type g_n1 = g.pow(n1);
+                                std::vector<value_type> block_A, block_B, block_C;
+                                for_each_row_block(n1, n2, [&](const std::size_t first_row, const std::size_t rows) {
+                                    const std::size_t first = first_row * n2, count = rows * n2;
+                                    block_A.resize(count);
+                                    block_B.resize(count);
+                                    block_C.resize(count);
+                                    A.read(first, count, block_A.data());
+                                    B.read(first, count, block_B.data());
+                                    C.read(first, count, block_C.data());
+                                    for (std::size_t row = 0; row < rows; ++row) {
+                                        const value_type row_power = g.pow(first_row + row);
+                                        detail::scale_by_powers(n2, g_n1, [&](std::size_t i, const value_type &power) {
+                                            const value_type shift = row_power * power;
+                                            block_A[row * n2 + i] *= shift;
+                                            block_B[row * n2 + i] *= shift;
+                                            block_C[row * n2 + i] *= shift;
+                                        });
+                                    }
+                                    A.write(first, count, block_A.data());
+                                    B.write(first, count, block_B.data());
+                                    C.write(first, count, block_C.data());
+                                });
+                            }
+
+                            stage_profiler::run_stage("coset_FFT", m, [&]() { evaluate(A); });
+                            stage_profiler::run_stage("coset_FFT", m, [&]() { evaluate(B); });
+                            stage_profiler::run_stage("coset_FFT", m, [&]() { evaluate(C); });
+
+                            /* A * B - C, divided by Z, which is constant on the coset */
+                            stage_profiler::run_stage("divide_by_Z", m, [&]() {
+                                const value_type Z_inverse = domain->compute_vanishing_polynomial(g).inversed();
+                                std::vector<value_type> block_A, block_B, block_C;
+                                for_each_block(m, [&](const std::size_t first, const std::size_t count) {
+                                    block_A.resize(count);
+                                    block_B.resize(count);
+                                    block_C.resize(count);
+                                    A.read(first, count, block_A.data());
+                                    B.read(first, count, block_B.data());
+                                    C.read(first, count, block_C.data());
+                                    detail::field_kernels<FieldType>::multiply_subtract_scale(
+                                        block_A.data(), block_A.data(), block_B.data(), block_C.data(), Z_inverse,
+                                        count);
+                                    A.write(first, count, block_A.data());
+                                });
+                            });
+
+                            stage_profiler::run_stage("iFFT", m, [&]() { interpolate(A); });
+
+                            /* undo the coset shift and add the H coefficients in the same pass */
+                            const value_type g_inverse_n1 = g_inverse.pow(n1);
+                            std::vector<value_type> block_H;
+                            for_each_row_block(n1, n2, [&](const std::size_t first_row, const std::size_t rows) {
+                                block_H.resize(rows * n2);
+                                A.read(first_row * n2, rows * n2, block_H.data());
+                                for (std::size_t row = 0; row < rows; ++row) {
+                                    const std::size_t k1 = first_row + row;
+                                    const value_type row_power = g_inverse.pow(k1);
+                                    detail::scale_by_powers(
+                                        n2, g_inverse_n1, [&](std::size_t i, const value_type &power) {
+                                            coefficients_for_H[k1 + n1 * i] +=
+                                                block_H[row * n2 + i] * (row_power * power);
+                                        });
+                                }
+                            });
+
+                            return coefficients_for_H;
+                        }
+
+                        /**
+                         * Coefficients of H with d1 = d2 = d3 = 0. The patch is already skipped for zero
+                         * scalars, and H is read back from storage into a vector of its own either way.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const reduction_context<FieldType> &context,
+                                               std::vector<typename FieldType::value_type> &aA,
+                                               std::vector<typename FieldType::value_type> &aB,
+                                               std::vector<typename FieldType::value_type> &aC) {
+                            const typename FieldType::value_type zero = FieldType::value_type::zero();
+                            return coefficients_for_H(context, aA, aB, aC, zero, zero, zero);
+                        }
+
+                    private:
+                        /* Calls f(first, count) over the blocks of BlockSize elements of [0, size). */
+                        template<typename Function>
+                        static void for_each_block(const std::size_t size, Function f) {
+                            for (std::size_t first = 0; first < size; first += BlockSize) {
+                                f(first, std::min(BlockSize, size - first));
+                            }
+                        }
+
+                        /*
+                         * Calls f(first_row, rows) over blocks of whole rows of the n1 x n2 matrix, about
+                         * BlockSize elements each.
+                         */
+                        template<typename Function>
+                        static void for_each_row_block(const std::size_t n1, const std::size_t n2, Function f) {
+                            const std::size_t block_rows = std::max<std::size_t>(1, std::min(n1, BlockSize / n2));
+                            for (std::size_t row = 0; row < n1; row += block_rows) {
+                                f(row, std::min(block_rows, n1 - row));
+                            }
+                        }
+
+                        /* Moves values into storage and releases their memory. */
+                        static void spill(std::vector<typename FieldType::value_type> &values, Storage &storage) {
+                            BOOST_ASSERT(values.size() == storage.size());
+                            storage.write(0, values.size(), values.data());
+                            std::vector<typename FieldType::value_type>().swap(values);
+                        }
+                    };
+                }    // namespace reductions
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_TO_QAP_FFT_BACKEND_HPP
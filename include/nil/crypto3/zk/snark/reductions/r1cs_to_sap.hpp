@@ -49,12 +49,19 @@
 #ifndef CRYPTO3_ZK_R1CS_TO_SAP_BASIC_POLICY_HPP
 #define CRYPTO3_ZK_R1CS_TO_SAP_BASIC_POLICY_HPP
 
+#include <numeric>
+
 #include <nil/crypto3/math/coset.hpp>
 #include <nil/crypto3/math/domains/evaluation_domain.hpp>
 #include <nil/crypto3/math/make_evaluation_domain.hpp>
 
+#include <nil/crypto3/zk/snark/reductions/detail/field_kernels.hpp>
+#include <nil/crypto3/zk/snark/reductions/reduction_context.hpp>
 #include <nil/crypto3/zk/snark/relations/arithmetic_programs/sap.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -92,6 +99,48 @@ namespace nil {
                                                                           2 * cs.num_inputs() + 1);
                         }
 
+                        /**
+                         * Reduction context of the constraint system cs, with the coset shifts and the
+                         * division by Z precomputed once for all the witness maps of cs.
+                         */
+                        static reduction_context<FieldType> make_context(const r1cs_constraint_system<FieldType> &cs) {
+                            return reduction_context<FieldType>(get_domain(cs), true);
+                        }
+
+                        /**
+                         * Precomputed context of the domain size of cs from the reduction context pool, shared
+                         * with every other constraint system of that domain size.
+                         */
+                        static std::shared_ptr<const reduction_context<FieldType>>
+                            shared_context(const r1cs_constraint_system<FieldType> &cs) {
+                            return reduction_context_pool<FieldType>::get(get_domain(cs));
+                        }
+
+                        /**
+                         * Scratch buffers of the witness map.
+                         *
+                         * A workspace passed to witness_map keeps the evaluation vectors of A and C alive
+                         * between calls, so repeated witness maps over the same domain run on the same
+                         * memory instead of allocating two domain-sized vectors per call.
+                         */
+                        struct workspace {
+                            std::vector<typename FieldType::value_type> aA, aC;
+
+                            workspace() = default;
+                            explicit workspace(const std::size_t domain_size) {
+                                reserve(domain_size);
+                            }
+
+                            void reserve(const std::size_t domain_size) {
+                                aA.reserve(domain_size);
+                                aC.reserve(domain_size);
+                            }
+
+                            std::size_t size_in_bits() const {
+                                return (aA.capacity() + aC.capacity()) * FieldType::value_bits;
+                            }
+                        };
+
                         /**
                          * Instance map for the R1CS-to-SAP reduction.
                          */
@@ -100,8 +149,8 @@ namespace nil {
 
                             std::size_t sap_num_variables = cs.num_variables() + cs.num_constraints() + cs.num_inputs();
 
-                            std::vector<std::map<std::size_t, typename FieldType::value_type>> A_in_Lagrange_basis(sap_num_variables + 1);
-                            std::vector<std::map<std::size_t, typename FieldType::value_type>> C_in_Lagrange_basis(sap_num_variables + 1);
+                            sparse_lagrange_basis_builder<FieldType> A_in_Lagrange_basis(sap_num_variables + 1);
+                            sparse_lagrange_basis_builder<FieldType> C_in_Lagrange_basis(sap_num_variables + 1);
 
                             /**
                              * process R1CS constraints, converting a constraint of the form
@@ -118,29 +167,31 @@ namespace nil {
                              *   (numbered cs.num_variables() + 1 .. cs.num_variables() + cs.num_constraints())
                              */
                             std::size_t extra_var_offset = cs.num_variables() + 1;
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                for (std::size_t j = 0; j < cs.constraints[i].a.terms.size(); ++j) {
-                                    A_in_Lagrange_basis[cs.constraints[i].a.terms[j].index][2 * i] +=
-                                        cs.constraints[i].a.terms[j].coeff;
-                                    A_in_Lagrange_basis[cs.constraints[i].a.terms[j].index][2 * i + 1] +=
-                                        cs.constraints[i].a.terms[j].coeff;
-                                }
-
-                                for (std::size_t j = 0; j < cs.constraints[i].b.terms.size(); ++j) {
-                                    A_in_Lagrange_basis[cs.constraints[i].b.terms[j].index][2 * i] +=
-                                        cs.constraints[i].b.terms[j].coeff;
-                                    A_in_Lagrange_basis[cs.constraints[i].b.terms[j].index][2 * i + 1] -=
-                                        cs.constraints[i].b.terms[j].coeff;
+                            /* the A and C matrices are collected concurrently */
+                            executor::current().bulk(2, [&](const std::size_t matrix) {
+                                for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
+                                    if (matrix == 0) {
+                                        for (const linear_term<FieldType> &term : cs.constraints[i].a.terms) {
+                                            A_in_Lagrange_basis.add(term.index, 2 * i, term.coeff);
+                                            A_in_Lagrange_basis.add(term.index, 2 * i + 1, term.coeff);
+                                        }
+
+                                        for (const linear_term<FieldType> &term : cs.constraints[i].b.terms) {
+                                            A_in_Lagrange_basis.add(term.index, 2 * i, term.coeff);
+                                            A_in_Lagrange_basis.add(term.index, 2 * i + 1, -term.coeff);
+                                        }
+                                    } else {
+                                        for (const linear_term<FieldType> &term : cs.constraints[i].c.terms) {
+                                            C_in_Lagrange_basis.add(term.index, 2 * i, times_four(term.coeff));
+                                        }
+
+                                        C_in_Lagrange_basis.add(extra_var_offset + i, 2 * i,
+                                                                FieldType::value_type::one());
+                                        C_in_Lagrange_basis.add(extra_var_offset + i, 2 * i + 1,
+                                                                FieldType::value_type::one());
+                                    }
                                 }
-
-                                for (std::size_t j = 0; j < cs.constraints[i].c.terms.size(); ++j) {
-                                    C_in_Lagrange_basis[cs.constraints[i].c.terms[j].index][2 * i] +=
-                                        times_four(cs.constraints[i].c.terms[j].coeff);
-                                }
-
-                                C_in_Lagrange_basis[extra_var_offset + i][2 * i] += FieldType::value_type::one();
-                                C_in_Lagrange_basis[extra_var_offset + i][2 * i + 1] += FieldType::value_type::one();
-                            }
+                            });
 
                             /**
                              * add and convert the extra constraints
@@ -170,31 +221,31 @@ namespace nil {
                              *     1 below
                              */
 
-                            A_in_Lagrange_basis[0][extra_constr_offset] = FieldType::value_type::one();
-                            C_in_Lagrange_basis[0][extra_constr_offset] = FieldType::value_type::one();
+                            A_in_Lagrange_basis.add(0, extra_constr_offset, FieldType::value_type::one());
+                            C_in_Lagrange_basis.add(0, extra_constr_offset, FieldType::value_type::one());
 
                             for (std::size_t i = 1; i <= cs.num_inputs(); ++i) {
-                                A_in_Lagrange_basis[i][extra_constr_offset + 2 * i - 1] +=
-                                    FieldType::value_type::one();
-                                A_in_Lagrange_basis[0][extra_constr_offset + 2 * i - 1] +=
-                                    FieldType::value_type::one();
-                                C_in_Lagrange_basis[i][extra_constr_offset + 2 * i - 1] +=
-                                    times_four(FieldType::value_type::one());
-                                C_in_Lagrange_basis[extra_var_offset2 + i][extra_constr_offset + 2 * i - 1] +=
-                                    FieldType::value_type::one();
-
-                                A_in_Lagrange_basis[i][extra_constr_offset + 2 * i] += FieldType::value_type::one();
-                                A_in_Lagrange_basis[0][extra_constr_offset + 2 * i] -= FieldType::value_type::one();
-                                C_in_Lagrange_basis[extra_var_offset2 + i][2 * cs.num_constraints() + 2 * i] +=
-                                    FieldType::value_type::one();
+                                A_in_Lagrange_basis.add(i, extra_constr_offset + 2 * i - 1,
+                                                        FieldType::value_type::one());
+                                A_in_Lagrange_basis.add(0, extra_constr_offset + 2 * i - 1,
+                                                        FieldType::value_type::one());
+                                C_in_Lagrange_basis.add(i, extra_constr_offset + 2 * i - 1,
+                                                        times_four(FieldType::value_type::one()));
+                                C_in_Lagrange_basis.add(extra_var_offset2 + i, extra_constr_offset + 2 * i - 1,
+                                                        FieldType::value_type::one());
+
+                                A_in_Lagrange_basis.add(i, extra_constr_offset + 2 * i, FieldType::value_type::one());
+                                A_in_Lagrange_basis.add(0, extra_constr_offset + 2 * i, -FieldType::value_type::one());
+                                C_in_Lagrange_basis.add(extra_var_offset2 + i, 2 * cs.num_constraints() + 2 * i,
+                                                        FieldType::value_type::one());
                             }
 
                             return sap_instance<FieldType>(domain,
                                                            sap_num_variables,
                                                            domain->m,
                                                            cs.num_inputs(),
-                                                           std::move(A_in_Lagrange_basis),
-                                                           std::move(C_in_Lagrange_basis));
+                                                           A_in_Lagrange_basis.build(),
+                                                           C_in_Lagrange_basis.build());
                         }
 
                         /**
@@ -220,32 +271,35 @@ namespace nil {
                             const std::vector<typename FieldType::value_type> u =
                                 domain->evaluate_all_lagrange_polynomials(t);
                             /**
-                             * add and process all constraints as in instance_map
+                             * add and process all constraints as in instance_map: constraint i contributes
+                             * (u[2i] + u[2i+1]) * a(x) + (u[2i] - u[2i+1]) * b(x) to At, 4 * u[2i] * c(x) to
+                             * Ct and u[2i] + u[2i+1] to the Ct entry of its extra variable. With these
+                             * weights, every entry of At and Ct is an independent dot product of a column
+                             * of the A, B and C matrices, so the variables are split across the current
+                             * executor without any two threads writing the same entry.
                              */
+                            const std::size_t num_columns = cs.num_variables() + 1;
+                            const r1cs_sparse_matrix<FieldType> A_columns =
+                                column_major(cs, &r1cs_constraint<FieldType>::a, num_columns);
+                            const r1cs_sparse_matrix<FieldType> B_columns =
+                                column_major(cs, &r1cs_constraint<FieldType>::b, num_columns);
+                            const r1cs_sparse_matrix<FieldType> C_columns =
+                                column_major(cs, &r1cs_constraint<FieldType>::c, num_columns);
+
+                            std::vector<typename FieldType::value_type> u_a(cs.num_constraints());
+                            std::vector<typename FieldType::value_type> u_b(cs.num_constraints());
+                            std::vector<typename FieldType::value_type> u_c(cs.num_constraints());
                             std::size_t extra_var_offset = cs.num_variables() + 1;
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                for (std::size_t j = 0; j < cs.constraints[i].a.terms.size(); ++j) {
-                                    At[cs.constraints[i].a.terms[j].index] +=
-                                        u[2 * i] * cs.constraints[i].a.terms[j].coeff;
-                                    At[cs.constraints[i].a.terms[j].index] +=
-                                        u[2 * i + 1] * cs.constraints[i].a.terms[j].coeff;
-                                }
-
-                                for (std::size_t j = 0; j < cs.constraints[i].b.terms.size(); ++j) {
-                                    At[cs.constraints[i].b.terms[j].index] +=
-                                        u[2 * i] * cs.constraints[i].b.terms[j].coeff;
-                                    At[cs.constraints[i].b.terms[j].index] -=
-                                        u[2 * i + 1] * cs.constraints[i].b.terms[j].coeff;
-                                }
-
-                                for (std::size_t j = 0; j < cs.constraints[i].c.terms.size(); ++j) {
-                                    Ct[cs.constraints[i].c.terms[j].index] +=
-                                        times_four(u[2 * i] * cs.constraints[i].c.terms[j].coeff);
-                                }
-
-                                Ct[extra_var_offset + i] += u[2 * i];
-                                Ct[extra_var_offset + i] += u[2 * i + 1];
-                            }
+                            executor::current().parallel_for(cs.num_constraints(), [&](const std::size_t i) {
+                                u_a[i] = u[2 * i] + u[2 * i + 1];
+                                u_b[i] = u[2 * i] - u[2 * i + 1];
+                                u_c[i] = times_four(u[2 * i]);
+                                Ct[extra_var_offset + i] = u_a[i];
+                            });
+                            executor::current().parallel_for(num_columns, [&](const std::size_t k) {
+                                At[k] = A_columns.dot_row(k, u_a) + B_columns.dot_row(k, u_b);
+                                Ct[k] = C_columns.dot_row(k, u_c);
+                            });
 
                             std::size_t extra_constr_offset = 2 * cs.num_constraints();
                             std::size_t extra_var_offset2 = cs.num_variables() + cs.num_constraints();
@@ -316,16 +370,73 @@ namespace nil {
                                         const r1cs_auxiliary_input<FieldType> &auxiliary_input,
                                         const typename FieldType::value_type &d1,
                                         const typename FieldType::value_type &d2) {
+                            return witness_map(cs, primary_input, auxiliary_input, d1, d2, *shared_context(cs));
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-SAP reduction over a domain obtained from get_domain(cs),
+                         * or over the context returned by make_context(cs); either can be shared by any number
+                         * of calls for the same constraint system.
+                         */
+                        static sap_witness<FieldType>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const reduction_context<FieldType> &context) {
+                            workspace scratch;
+                            return witness_map(cs, primary_input, auxiliary_input, d1, d2, context, scratch);
+                        }
+
+                        /**
+                         * Witness map for the R1CS-to-SAP reduction running in the buffers of scratch.
+                         */
+                        static sap_witness<FieldType>
+                            witness_map(const r1cs_constraint_system<FieldType> &cs,
+                                        const r1cs_primary_input<FieldType> &primary_input,
+                                        const r1cs_auxiliary_input<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d1,
+                                        const typename FieldType::value_type &d2,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch) {
                             /* sanity check */
                             assert(cs.is_satisfied(primary_input, auxiliary_input));
 
-                            const std::shared_ptr<fft::evaluation_domain<FieldType>> domain = get_domain(cs);
-
                             std::size_t sap_num_variables = cs.num_variables() + cs.num_constraints() + cs.num_inputs();
 
+                            r1cs_variable_assignment<FieldType> full_variable_assignment =
+                                variable_assignment(cs, primary_input, auxiliary_input);
+                            std::vector<typename FieldType::value_type> H =
+                                coefficients_for_H(cs, full_variable_assignment, d1, d2, context, scratch);
+
+                            return sap_witness<FieldType>(sap_num_variables,
+                                                          context.domain()->m,
+                                                          cs.num_inputs(),
+                                                          d1,
+                                                          d2,
+                                                          full_variable_assignment,
+                                                          std::move(H));
+                        }
+
+                        /**
+                         * Variable assignment of the SAP: the assignment (x_1, ..., x_m) of cs followed by
+                         * the values of the extra variables introduced by the reduction.
+                         *
+                         * This is all the multi-exponentiations of a prover need besides H, and it takes no
+                         * FFT, so they can run while coefficients_for_H is being computed.
+                         */
+                        static r1cs_variable_assignment<FieldType>
+                            variable_assignment(const r1cs_constraint_system<FieldType> &cs,
+                                                const r1cs_primary_input<FieldType> &primary_input,
+                                                const r1cs_auxiliary_input<FieldType> &auxiliary_input) {
+                            const std::size_t num_variables = cs.num_variables();
+                            const std::size_t num_constraints = cs.num_constraints();
+
                             r1cs_variable_assignment<FieldType> full_variable_assignment = primary_input;
                             full_variable_assignment.insert(
                                 full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+                            full_variable_assignment.resize(num_variables + num_constraints + cs.num_inputs());
                             /**
                              * we need to generate values of all the extra variables that we added
                              * during the reduction
@@ -335,138 +446,150 @@ namespace nil {
                              * be a problem, because .evaluate() only accesses the variables that are
                              * actually used in the constraint.
                              */
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
+                            executor::current().parallel_for(num_constraints, [&](const std::size_t i) {
                                 /**
                                  * this is variable (extra_var_offset + i), an extra variable
                                  * we introduced that is not present in the input.
                                  * its value is (a - b)^2
                                  */
-                                typename FieldType::value_type extra_var =
+                                const typename FieldType::value_type extra_var =
                                     cs.constraints[i].a.evaluate(full_variable_assignment) -
                                     cs.constraints[i].b.evaluate(full_variable_assignment);
-                                extra_var = extra_var * extra_var;
-                                full_variable_assignment.push_back(extra_var);
-                            }
+                                full_variable_assignment[num_variables + i] = extra_var.squared();
+                            });
                             for (std::size_t i = 1; i <= cs.num_inputs(); ++i) {
                                 /**
                                  * this is variable (extra_var_offset2 + i), an extra variable
                                  * we introduced that is not present in the input.
                                  * its value is (x_i - 1)^2
                                  */
-                                typename FieldType::value_type extra_var =
+                                const typename FieldType::value_type extra_var =
                                     full_variable_assignment[i - 1] - FieldType::value_type::one();
-                                extra_var = extra_var * extra_var;
-                                full_variable_assignment.push_back(extra_var);
+                                full_variable_assignment[num_variables + num_constraints + i - 1] =
+                                    extra_var.squared();
                             }
 
-                            std::vector<typename FieldType::value_type> aA(domain->m, FieldType::value_type::zero());
+                            return full_variable_assignment;
+                        }
+
+                        /**
+                         * Coefficients of the polynomial H of the witness map, computed from the variable
+                         * assignment of the SAP returned by variable_assignment.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_constraint_system<FieldType> &cs,
+                                               const r1cs_variable_assignment<FieldType> &full_variable_assignment,
+                                               const typename FieldType::value_type &d1,
+                                               const typename FieldType::value_type &d2,
+                                               const reduction_context<FieldType> &context) {
+                            workspace scratch;
+                            return coefficients_for_H(cs, full_variable_assignment, d1, d2, context, scratch);
+                        }
+
+                        /**
+                         * Coefficients of the polynomial H of the witness map, running in the buffers of
+                         * scratch.
+                         *
+                         * The square structure of the SAP leaves two polynomials to transform, A and C, as
+                         * H * Z = A^2 - C. Both are evaluated on S in a single pass over the constraints, which
+                         * reads the extra variables (a - b)^2 from the assignment instead of evaluating the
+                         * constraints again. Their coset shifts share one pass over the powers of the
+                         * multiplicative generator, A^2 - C is formed in place of A, and the inverse shift of
+                         * H is fused with the addition of the zero-knowledge patch.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const r1cs_constraint_system<FieldType> &cs,
+                                               const r1cs_variable_assignment<FieldType> &full_variable_assignment,
+                                               const typename FieldType::value_type &d1,
+                                               const typename FieldType::value_type &d2,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
+                            const std::size_t num_constraints = cs.num_constraints();
+                            const std::size_t num_inputs = cs.num_inputs();
+                            assert(domain->m >= 2 * num_constraints + 2 * num_inputs + 1);
+                            assert(full_variable_assignment.size() ==
+                                   cs.num_variables() + num_constraints + num_inputs);
+
+                            stage_profiler::timer evaluate_timer("evaluate", num_constraints);
+                            std::vector<typename FieldType::value_type> &aA = scratch.aA, &aC = scratch.aC;
+                            aA.assign(domain->m, FieldType::value_type::zero());
+                            aC.assign(domain->m, FieldType::value_type::zero());
 
                             /* account for all constraints, as in instance_map */
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                aA[2 * i] += cs.constraints[i].a.evaluate(full_variable_assignment);
-                                aA[2 * i] += cs.constraints[i].b.evaluate(full_variable_assignment);
+                            const std::size_t extra_var_offset = cs.num_variables();
+                            executor::current().parallel_for(num_constraints, [&](const std::size_t i) {
+                                const typename FieldType::value_type a =
+                                    cs.constraints[i].a.evaluate(full_variable_assignment);
+                                const typename FieldType::value_type b =
+                                    cs.constraints[i].b.evaluate(full_variable_assignment);
+                                const typename FieldType::value_type &extra_var =
+                                    full_variable_assignment[extra_var_offset + i];
 
-                                aA[2 * i + 1] += cs.constraints[i].a.evaluate(full_variable_assignment);
-                                aA[2 * i + 1] -= cs.constraints[i].b.evaluate(full_variable_assignment);
-                            }
+                                aA[2 * i] = a + b;
+                                aA[2 * i + 1] = a - b;
 
-                            std::size_t extra_constr_offset = 2 * cs.num_constraints();
+                                aC[2 * i] = times_four(cs.constraints[i].c.evaluate(full_variable_assignment)) +
+                                            extra_var;
+                                aC[2 * i + 1] = extra_var;
+                            });
 
-                            aA[extra_constr_offset] += FieldType::value_type::one();
+                            const std::size_t extra_constr_offset = 2 * num_constraints;
+                            const std::size_t extra_var_offset2 = cs.num_variables() + num_constraints;
 
-                            for (std::size_t i = 1; i <= cs.num_inputs(); ++i) {
-                                aA[extra_constr_offset + 2 * i - 1] += full_variable_assignment[i - 1];
-                                aA[extra_constr_offset + 2 * i - 1] += FieldType::value_type::one();
+                            aA[extra_constr_offset] = FieldType::value_type::one();
+                            aC[extra_constr_offset] = FieldType::value_type::one();
+
+                            for (std::size_t i = 1; i <= num_inputs; ++i) {
+                                const typename FieldType::value_type &input = full_variable_assignment[i - 1];
+                                const typename FieldType::value_type &extra_var =
+                                    full_variable_assignment[extra_var_offset2 + i - 1];
+
+                                aA[extra_constr_offset + 2 * i - 1] = input + FieldType::value_type::one();
+                                aA[extra_constr_offset + 2 * i] = input - FieldType::value_type::one();
 
-                                aA[extra_constr_offset + 2 * i] += full_variable_assignment[i - 1];
-                                aA[extra_constr_offset + 2 * i] -= FieldType::value_type::one();
+                                aC[extra_constr_offset + 2 * i - 1] = times_four(input) + extra_var;
+                                aC[extra_constr_offset + 2 * i] = extra_var;
                             }
+                            evaluate_timer.stop();
 
+                            stage_profiler::timer fft_timer("fft", domain->m);
                             domain->iFFT(aA);
 
+                            domain->iFFT(aC);
+
                             std::vector<typename FieldType::value_type> coefficients_for_H(
                                 domain->m + 1, FieldType::value_type::zero());
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
                             /* add coefficients of the polynomial (2*d1*A - d2) + d1*d1*Z */
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                coefficients_for_H[i] = (d1 * aA[i]) + (d1 * aA[i]);
-                            }
+                            detail::field_kernels<FieldType>::scale(coefficients_for_H.data(), aA.data(), d1 + d1,
+                                                                    domain->m);
                             coefficients_for_H[0] -= d2;
                             domain->add_poly_Z(d1 * d1, coefficients_for_H);
 
-                            fft::multiply_by_coset(aA,
-                                                   typename FieldType::value_type(
-                                                       fields::arithmetic_params<FieldType>::multiplicative_generator));
-                            domain->FFT(aA);
-
-                            std::vector<typename FieldType::value_type> &H_tmp =
-                                aA;    // can overwrite aA because it is not used later
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                H_tmp[i] = aA[i] * aA[i];
-                            }
-
-                            std::vector<typename FieldType::value_type> aC(domain->m, FieldType::value_type::zero());
-                            /* again, accounting for all constraints */
-                            std::size_t extra_var_offset = cs.num_variables() + 1;
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                aC[2 * i] += times_four(cs.constraints[i].c.evaluate(full_variable_assignment));
-
-                                aC[2 * i] += full_variable_assignment[extra_var_offset + i - 1];
-                                aC[2 * i + 1] += full_variable_assignment[extra_var_offset + i - 1];
-                            }
-
-                            std::size_t extra_var_offset2 = cs.num_variables() + cs.num_constraints();
-                            aC[extra_constr_offset] += FieldType::value_type::one();
-
-                            for (std::size_t i = 1; i <= cs.num_inputs(); ++i) {
-                                aC[extra_constr_offset + 2 * i - 1] += times_four(full_variable_assignment[i - 1]);
+                            context.for_each_coset_power(
+                                [&](std::size_t i, const typename FieldType::value_type &power) {
+                                    aA[i] *= power;
+                                    aC[i] *= power;
+                                });
 
-                                aC[extra_constr_offset + 2 * i - 1] +=
-                                    full_variable_assignment[extra_var_offset2 + i - 1];
-                                aC[extra_constr_offset + 2 * i] += full_variable_assignment[extra_var_offset2 + i - 1];
-                            }
-
-                            domain->iFFT(aC);
-
-                            fft::multiply_by_coset(aC,
-                                                   typename FieldType::value_type(
-                                                       fields::arithmetic_params<FieldType>::multiplicative_generator));
+                            domain->FFT(aA);
                             domain->FFT(aC);
 
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                H_tmp[i] = (H_tmp[i] - aC[i]);
-                            }
+                            /* H_tmp can overwrite aA because it is not used later */
+                            std::vector<typename FieldType::value_type> &H_tmp = aA;
+                            detail::field_kernels<FieldType>::square_subtract(H_tmp.data(), aA.data(), aC.data(),
+                                                                              domain->m);
 
-                            domain->divide_by_Z_on_coset(H_tmp);
+                            context.divide_by_Z_on_coset(H_tmp);
 
                             domain->iFFT(H_tmp);
-                            multiply_by_coset(H_tmp,
-                                              typename FieldType::value_type(
-                                                  fields::arithmetic_params<FieldType>::multiplicative_generator)
-                                                  .inversed());
-
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                coefficients_for_H[i] += H_tmp[i];
-                            }
+                            /* undo the coset shift and add the H coefficients in the same pass */
+                            context.for_each_inverse_coset_power(
+                                [&](std::size_t i, const typename FieldType::value_type &power) {
+                                    coefficients_for_H[i] += H_tmp[i] * power;
+                                });
 
-                            return sap_witness<FieldType>(sap_num_variables,
-                                                          domain->m,
-                                                          cs.num_inputs(),
-                                                          d1,
-                                                          d2,
-                                                          full_variable_assignment,
-                                                          std::move(coefficients_for_H));
+                            return coefficients_for_H;
                         }
                     };
                 }    // namespace reductions
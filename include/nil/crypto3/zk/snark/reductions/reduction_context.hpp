@@ -0,0 +1,284 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the per-circuit context of the witness maps of the QAP, SAP and SSP reductions.
+//
+// Every witness map runs over the evaluation domain of its constraint system, shifts its
+// polynomials to the coset g*S by the powers of the multiplicative generator g, divides by
+// the vanishing polynomial Z there and shifts back by the powers of g^-1. None of this
+// depends on the witness. A reduction context holds the domain, and optionally the powers
+// of g and g^-1 and the inverses of Z on the coset; built once per circuit, it is passed
+// to every witness map of that circuit in place of the domain.
+//
+// A context converts implicitly from a domain, without tables: the powers are then
+// computed on the fly and the division is left to the domain, as without a context.
+//
+// None of the tables depends on the circuit either, only on the field and the domain size.
+// The reduction context pool holds one precomputed context per domain size, shared by every
+// circuit of that size, so that a prover handling many circuits builds each table once. It
+// keeps at most capacity() contexts, the least recently requested ones being released first,
+// so a process that meets many domain sizes does not keep the tables of all of them.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_REDUCTIONS_REDUCTION_CONTEXT_HPP
+#define CRYPTO3_ZK_REDUCTIONS_REDUCTION_CONTEXT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <nil/crypto3/math/domains/evaluation_domain.hpp>
+
+#include <nil/crypto3/algebra/fields/params.hpp>
+
+#include <nil/crypto3/zk/snark/reductions/detail/field_kernels.hpp>
+#include <nil/crypto3/zk/snark/reductions/detail/scale_by_powers.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace reductions {
+                    template<typename FieldType>
+                    class reduction_context {
+                        typedef typename FieldType::value_type value_type;
+
+                        std::shared_ptr<fft::evaluation_domain<FieldType>> domain_;
+
+                        value_type g_;
+                        std::vector<value_type> coset_powers_;
+                        std::vector<value_type> inverse_coset_powers_;
+                        /* empty without tables, a single element when Z is constant on the coset */
+                        std::vector<value_type> Z_inverse_on_coset_;
+
+                    public:
+                        typedef FieldType field_type;
+
+                        /**
+                         * Context over domain, with the tables of the coset shifts and of the division by
+                         * Z when precompute is set.
+                         */
+                        reduction_context(const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain,
+                                          const bool precompute = false) :
+                            domain_(domain),
+                            g_(fields::arithmetic_params<FieldType>::multiplicative_generator) {
+                            if (!precompute) {
+                                return;
+                            }
+
+                            const std::size_t m = domain_->m;
+                            coset_powers_.resize(m);
+                            inverse_coset_powers_.resize(m);
+                            detail::scale_by_powers(m, g_, [&](std::size_t i, const value_type &power) {
+                                coset_powers_[i] = power;
+                            });
+                            detail::scale_by_powers(m, g_.inversed(), [&](std::size_t i, const value_type &power) {
+                                inverse_coset_powers_[i] = power;
+                            });
+
+                            /* the division by Z on the coset scales every point by a fixed factor */
+                            Z_inverse_on_coset_.assign(m, value_type::one());
+                            domain_->divide_by_Z_on_coset(Z_inverse_on_coset_);
+                            if (std::all_of(Z_inverse_on_coset_.begin(), Z_inverse_on_coset_.end(),
+                                            [&](const value_type &z) { return z == Z_inverse_on_coset_[0]; })) {
+                                Z_inverse_on_coset_.resize(1);
+                            }
+                        }
+
+                        const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain() const {
+                            return domain_;
+                        }
+
+                        bool is_precomputed() const {
+                            return !Z_inverse_on_coset_.empty();
+                        }
+
+                        /* Calls f(i, g^i) for i = 0, ..., m - 1. */
+                        template<typename Function>
+                        void for_each_coset_power(Function f) const {
+                            for_each_power(coset_powers_, g_, f);
+                        }
+
+                        /* Calls f(i, g^-i) for i = 0, ..., m - 1. */
+                        template<typename Function>
+                        void for_each_inverse_coset_power(Function f) const {
+                            for_each_power(inverse_coset_powers_, g_.inversed(), f);
+                        }
+
+                        /* Divides the evaluations P on the coset g*S by those of Z. */
+                        void divide_by_Z_on_coset(std::vector<value_type> &P) const {
+                            if (Z_inverse_on_coset_.empty()) {
+                                domain_->divide_by_Z_on_coset(P);
+                            } else if (Z_inverse_on_coset_.size() == 1) {
+                                const value_type &Z_inverse = Z_inverse_on_coset_[0];
+                                detail::field_kernels<FieldType>::scale(P.data(), P.data(), Z_inverse, P.size());
+                            } else {
+                                detail::field_kernels<FieldType>::multiply(P.data(), Z_inverse_on_coset_.data(),
+                                                                           P.size());
+                            }
+                        }
+
+                        std::size_t size_in_bits() const {
+                            return (coset_powers_.size() + inverse_coset_powers_.size() + Z_inverse_on_coset_.size()) *
+                                   FieldType::value_bits;
+                        }
+
+                    private:
+                        template<typename Function>
+                        void for_each_power(const std::vector<value_type> &powers, const value_type &c,
+                                            Function f) const {
+                            if (powers.empty()) {
+                                detail::scale_by_powers(domain_->m, c, f);
+                            } else {
+                                executor::current().parallel_for(powers.size(),
+                                                                 [&](const std::size_t i) { f(i, powers[i]); });
+                            }
+                        }
+                    };
+
+                    /**
+                     * Process-wide pool of the precomputed contexts over the field, one per domain size. The
+                     * domain of a constraint system is chosen by its size alone, so that every system whose
+                     * domain has m points shares the context of the first one. The pool is bounded by
+                     * capacity(); evicting a context only drops the pool's reference to it.
+                     */
+                    template<typename FieldType>
+                    class reduction_context_pool {
+                        struct entry_type {
+                            std::shared_ptr<const reduction_context<FieldType>> context;
+                            /* the value of the request counter when the context was last requested */
+                            std::size_t last_use;
+                        };
+
+                        typedef std::map<std::size_t, entry_type> map_type;
+
+                        struct state {
+                            std::mutex mutex;
+                            map_type contexts;
+                            std::size_t capacity = default_capacity;
+                            std::size_t requests = 0;
+                        };
+
+                        static state &instance() {
+                            static state s;
+                            return s;
+                        }
+
+                        /* drops the least recently requested contexts until at most capacity are left */
+                        static void evict(state &s) {
+                            while (s.contexts.size() > s.capacity) {
+                                typename map_type::iterator oldest = s.contexts.begin();
+                                for (typename map_type::iterator it = s.contexts.begin(); it != s.contexts.end();
+                                     ++it) {
+                                    if (it->second.last_use < oldest->second.last_use) {
+                                        oldest = it;
+                                    }
+                                }
+                                s.contexts.erase(oldest);
+                            }
+                        }
+
+                    public:
+                        /* The number of domain sizes pooled unless set_capacity says otherwise. */
+                        static constexpr const std::size_t default_capacity = 8;
+
+                        /**
+                         * The pooled context of the size of domain, built over domain with its tables on the
+                         * first request for that size, or after it was evicted.
+                         */
+                        static std::shared_ptr<const reduction_context<FieldType>>
+                            get(const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain) {
+                            state &s = instance();
+                            {
+                                std::lock_guard<std::mutex> lock(s.mutex);
+                                typename map_type::iterator it = s.contexts.find(domain->m);
+                                if (it != s.contexts.end()) {
+                                    it->second.last_use = ++s.requests;
+                                    return it->second.context;
+                                }
+                            }
+
+                            /* built outside the lock; a concurrent build of the same size keeps the first */
+                            std::shared_ptr<const reduction_context<FieldType>> context =
+                                std::make_shared<const reduction_context<FieldType>>(domain, true);
+                            std::lock_guard<std::mutex> lock(s.mutex);
+                            entry_type &entry = s.contexts.emplace(domain->m, entry_type {context, 0}).first->second;
+                            entry.last_use = ++s.requests;
+                            context = entry.context;
+                            evict(s);
+                            return context;
+                        }
+
+                        /* The largest number of contexts held by the pool. */
+                        static std::size_t capacity() {
+                            state &s = instance();
+                            std::lock_guard<std::mutex> lock(s.mutex);
+                            return s.capacity;
+                        }
+
+                        /**
+                         * Bounds the pool to capacity contexts, evicting the least recently requested ones
+                         * beyond it. With a capacity of zero, nothing is pooled and every request builds
+                         * its own context.
+                         */
+                        static void set_capacity(const std::size_t capacity) {
+                            state &s = instance();
+                            std::lock_guard<std::mutex> lock(s.mutex);
+                            s.capacity = capacity;
+                            evict(s);
+                        }
+
+                        /* Number of pooled contexts. */
+                        static std::size_t size() {
+                            state &s = instance();
+                            std::lock_guard<std::mutex> lock(s.mutex);
+                            return s.contexts.size();
+                        }
+
+                        /* Whether the context of domain size m is pooled. */
+                        static bool contains(const std::size_t m) {
+                            state &s = instance();
+                            std::lock_guard<std::mutex> lock(s.mutex);
+                            return s.contexts.count(m) != 0;
+                        }
+
+                        /* Releases the pooled contexts; those still held elsewhere stay valid. */
+                        static void clear() {
+                            state &s = instance();
+                            std::lock_guard<std::mutex> lock(s.mutex);
+                            s.contexts.clear();
+                        }
+                    };
+                }    // namespace reductions
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_REDUCTIONS_REDUCTION_CONTEXT_HPP
@@ -0,0 +1,305 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the six-step FFT over block storage, for evaluation domains larger than memory.
+//
+// A vector of size m = n1 * n2 is read as an n1 x n2 row-major matrix. Its FFT is
+// computed in place, in two passes over the storage, each holding about block_size
+// elements in memory at a time:
+// - the n2 columns are transformed by FFTs of size n1 and multiplied by the twiddle
+//   factors, a block of adjacent columns at a time;
+// - the n1 rows are transformed by FFTs of size n2, a block of rows at a time.
+// The result is left in transposed order: position k1 * n2 + k2 holds the output element
+// k1 + n1 * k2. six_step_fft_transposed takes its input in that order and runs the two
+// passes the other way round, leaving the result in natural order, so a chain of
+// transforms alternating between the two never needs the transposition steps, nor a
+// second vector to transpose into. transposed_index maps a position to its element.
+// Every read and write covers a contiguous range of the storage.
+//
+// Storage is anything providing size(), read(first, count, data) and
+// write(first, count, data); fft_memory_storage keeps the vector in memory and
+// fft_file_storage in an anonymous temporary file. A storage spreading the vector over
+// remote nodes plugs into the same interface.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_REDUCTIONS_SIX_STEP_FFT_HPP
+#define CRYPTO3_ZK_REDUCTIONS_SIX_STEP_FFT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace reductions {
+
+                    /**
+                     * Block storage holding the vector in memory.
+                     */
+                    template<typename ValueType>
+                    class fft_memory_storage {
+                        std::vector<ValueType> data_;
+
+                    public:
+                        typedef ValueType value_type;
+
+                        explicit fft_memory_storage(const std::size_t size) : data_(size) {
+                        }
+
+                        std::size_t size() const {
+                            return data_.size();
+                        }
+
+                        void read(const std::size_t first, const std::size_t count, ValueType *data) const {
+                            BOOST_ASSERT(first + count <= data_.size());
+                            std::copy(data_.begin() + first, data_.begin() + first + count, data);
+                        }
+
+                        void write(const std::size_t first, const std::size_t count, const ValueType *data) {
+                            BOOST_ASSERT(first + count <= data_.size());
+                            std::copy(data, data + count, data_.begin() + first);
+                        }
+                    };
+
+                    /**
+                     * Block storage holding the vector in an anonymous temporary file, removed when the
+                     * storage is destroyed. The elements are stored in their native representation.
+                     */
+                    template<typename ValueType>
+                    class fft_file_storage {
+                        static_assert(std::is_trivially_copyable<ValueType>::value,
+                                      "field elements must be trivially copyable to be stored in a file");
+
+                        struct file_closer {
+                            void operator()(std::FILE *file) const {
+                                std::fclose(file);
+                            }
+                        };
+
+                        std::unique_ptr<std::FILE, file_closer> file_;
+                        std::size_t size_;
+
+                        void seek(const std::size_t first) const {
+                            if (std::fseek(file_.get(), static_cast<long>(first * sizeof(ValueType)), SEEK_SET) != 0) {
+                                throw std::runtime_error("fft_file_storage: seek failed");
+                            }
+                        }
+
+                    public:
+                        typedef ValueType value_type;
+
+                        explicit fft_file_storage(const std::size_t size) : file_(std::tmpfile()), size_(size) {
+                            if (!file_) {
+                                throw std::runtime_error("fft_file_storage: cannot create a temporary file");
+                            }
+                        }
+
+                        std::size_t size() const {
+                            return size_;
+                        }
+
+                        void read(const std::size_t first, const std::size_t count, ValueType *data) const {
+                            BOOST_ASSERT(first + count <= size_);
+                            seek(first);
+                            if (std::fread(data, sizeof(ValueType), count, file_.get()) != count) {
+                                throw std::runtime_error("fft_file_storage: read failed");
+                            }
+                        }
+
+                        void write(const std::size_t first, const std::size_t count, const ValueType *data) {
+                            BOOST_ASSERT(first + count <= size_);
+                            seek(first);
+                            if (std::fwrite(data, sizeof(ValueType), count, file_.get()) != count) {
+                                throw std::runtime_error("fft_file_storage: write failed");
+                            }
+                        }
+                    };
+
+                    namespace detail {
+
+                        /**
+                         * In-place radix-2 FFT of a, whose size is a power of two, for the root of unity
+                         * omega of order a.size().
+                         */
+                        template<typename FieldValueType>
+                        void radix2_fft(std::vector<FieldValueType> &a, const FieldValueType &omega) {
+                            const std::size_t n = a.size();
+
+                            for (std::size_t i = 1, j = 0; i < n; ++i) {
+                                std::size_t bit = n >> 1;
+                                for (; j & bit; bit >>= 1) {
+                                    j ^= bit;
+                                }
+                                j ^= bit;
+                                if (i < j) {
+                                    std::swap(a[i], a[j]);
+                                }
+                            }
+
+                            for (std::size_t length = 2; length <= n; length <<= 1) {
+                                const FieldValueType omega_length = omega.pow(n / length);
+                                for (std::size_t first = 0; first < n; first += length) {
+                                    FieldValueType w = FieldValueType::one();
+                                    for (std::size_t k = 0; k < length / 2; ++k) {
+                                        const FieldValueType u = a[first + k];
+                                        const FieldValueType v = a[first + k + length / 2] * w;
+                                        a[first + k] = u + v;
+                                        a[first + k + length / 2] = u - v;
+                                        w *= omega_length;
+                                    }
+                                }
+                            }
+                        }
+                    }    // namespace detail
+
+                    /**
+                     * Element held at position of a vector of size n1 * n2 in transposed order.
+                     */
+                    inline std::size_t transposed_index(const std::size_t position, const std::size_t n1,
+                                                        const std::size_t n2) {
+                        return position / n2 + n1 * (position % n2);
+                    }
+
+                    namespace detail {
+
+                        /**
+                         * Replaces every column j2 of the n1 x n2 matrix held by storage with its FFT for
+                         * root, whose order is n1, and multiplies its element k1 by scale * twiddle^(j2 * k1).
+                         */
+                        template<typename Storage, typename FieldValueType>
+                        void six_step_column_pass(Storage &storage, const std::size_t n1, const std::size_t n2,
+                                                  const FieldValueType &root, const FieldValueType &twiddle,
+                                                  const FieldValueType &scale, const std::size_t block_size) {
+                            const std::size_t block_columns = std::max<std::size_t>(1, std::min(n2, block_size / n1));
+                            std::vector<FieldValueType> block(n1 * block_columns);
+
+                            for (std::size_t column = 0; column < n2; column += block_columns) {
+                                const std::size_t width = std::min(block_columns, n2 - column);
+                                for (std::size_t row = 0; row < n1; ++row) {
+                                    storage.read(row * n2 + column, width, block.data() + row * width);
+                                }
+
+                                executor::current().parallel_for(width, [&](const std::size_t t) {
+                                    std::vector<FieldValueType> values(n1);
+                                    for (std::size_t row = 0; row < n1; ++row) {
+                                        values[row] = block[row * width + t];
+                                    }
+                                    radix2_fft(values, root);
+
+                                    const FieldValueType step = twiddle.pow(column + t);
+                                    FieldValueType power = scale;
+                                    for (std::size_t row = 0; row < n1; ++row) {
+                                        block[row * width + t] = values[row] * power;
+                                        power *= step;
+                                    }
+                                });
+
+                                for (std::size_t row = 0; row < n1; ++row) {
+                                    storage.write(row * n2 + column, width, block.data() + row * width);
+                                }
+                            }
+                        }
+
+                        /**
+                         * Replaces every row j1 of the n1 x n2 matrix held by storage with its FFT for root,
+                         * whose order is n2, and multiplies its element k2 by scale * twiddle^(j1 * k2).
+                         */
+                        template<typename Storage, typename FieldValueType>
+                        void six_step_row_pass(Storage &storage, const std::size_t n1, const std::size_t n2,
+                                               const FieldValueType &root, const FieldValueType &twiddle,
+                                               const FieldValueType &scale, const std::size_t block_size) {
+                            const std::size_t block_rows = std::max<std::size_t>(1, std::min(n1, block_size / n2));
+                            std::vector<FieldValueType> block(n2 * block_rows);
+
+                            for (std::size_t row = 0; row < n1; row += block_rows) {
+                                const std::size_t height = std::min(block_rows, n1 - row);
+                                storage.read(row * n2, height * n2, block.data());
+
+                                executor::current().parallel_for(height, [&](const std::size_t t) {
+                                    std::vector<FieldValueType> values(block.begin() + t * n2,
+                                                                       block.begin() + (t + 1) * n2);
+                                    radix2_fft(values, root);
+
+                                    const FieldValueType step = twiddle.pow(row + t);
+                                    FieldValueType power = scale;
+                                    for (std::size_t column = 0; column < n2; ++column) {
+                                        block[t * n2 + column] = values[column] * power;
+                                        power *= step;
+                                    }
+                                });
+
+                                storage.write(row * n2, height * n2, block.data());
+                            }
+                        }
+                    }    // namespace detail
+
+                    /**
+                     * Replaces the vector held by storage, in natural order, with its FFT for the root of
+                     * unity omega of order n1 * n2, in transposed order and with every element multiplied
+                     * by scale. Both sizes are powers of two.
+                     */
+                    template<typename Storage, typename FieldValueType>
+                    void six_step_fft(Storage &storage, const std::size_t n1, const std::size_t n2,
+                                      const FieldValueType &omega, const FieldValueType &scale,
+                                      const std::size_t block_size) {
+                        BOOST_ASSERT(storage.size() == n1 * n2);
+
+                        const FieldValueType one = FieldValueType::one();
+                        detail::six_step_column_pass(storage, n1, n2, omega.pow(n2), omega, one, block_size);
+                        detail::six_step_row_pass(storage, n1, n2, omega.pow(n1), one, scale, block_size);
+                    }
+
+                    /**
+                     * Replaces the vector held by storage, in transposed order, with its FFT for the root
+                     * of unity omega of order n1 * n2, in natural order and with every element multiplied
+                     * by scale. Both sizes are powers of two.
+                     */
+                    template<typename Storage, typename FieldValueType>
+                    void six_step_fft_transposed(Storage &storage, const std::size_t n1, const std::size_t n2,
+                                                 const FieldValueType &omega, const FieldValueType &scale,
+                                                 const std::size_t block_size) {
+                        BOOST_ASSERT(storage.size() == n1 * n2);
+
+                        const FieldValueType one = FieldValueType::one();
+                        detail::six_step_row_pass(storage, n1, n2, omega.pow(n1), omega, one, block_size);
+                        detail::six_step_column_pass(storage, n1, n2, omega.pow(n2), one, scale, block_size);
+                    }
+                }    // namespace reductions
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_REDUCTIONS_SIX_STEP_FFT_HPP
@@ -45,7 +45,12 @@
 #ifndef CRYPTO3_ZK_TBCS_TO_USCS_BASIC_POLICY_HPP
 #define CRYPTO3_ZK_TBCS_TO_USCS_BASIC_POLICY_HPP
 
+#include <cstdint>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/reductions/detail/compile_circuit.hpp>
 #include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/tbcs.hpp>
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/tbcs_evaluator.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/uscs.hpp>
 
 namespace nil {
@@ -58,120 +63,17 @@ namespace nil {
                         typedef FieldType field_type;
 
                         /**
-                         * Instance map for the TBCS-to-USCS reduction.
+                         * Instance map for the TBCS-to-USCS reduction. The constraint array is sized up front
+                         * and every constraint is built in place, in parallel over the gates and wires.
                          */
                         static uscs_constraint_system<FieldType> instance_map(const tbcs_circuit &circuit) {
-                            assert(circuit.is_valid());
-                            uscs_constraint_system<FieldType> result;
-
-                            result.primary_input_size = circuit.primary_input_size;
-                            result.auxiliary_input_size = circuit.auxiliary_input_size + circuit.gates.size();
-
-                            for (auto &g : circuit.gates) {
-                                const variable<FieldType> x(g.left_wire);
-                                const variable<FieldType> y(g.right_wire);
-                                const variable<FieldType> z(g.output);
-
-                                switch (g.type) {
-                                    case TBCS_GATE_CONSTANT_0:
-                                        /* Truth table (00, 01, 10, 11): (0, 0, 0, 0)
-                                           0 * x + 0 * y + 1 * z + 1 \in {-1, 1} */
-                                        result.add_constraint(0 * x + 0 * y + 1 * z + 1);
-                                        break;
-                                    case TBCS_GATE_AND:
-                                        /* Truth table (00, 01, 10, 11): (0, 0, 0, 1)
-                                           -2 * x + -2 * y + 4 * z + 1 \in {-1, 1} */
-                                        result.add_constraint(-2 * x + -2 * y + 4 * z + 1);
-                                        break;
-                                    case TBCS_GATE_X_AND_NOT_Y:
-                                        /* Truth table (00, 01, 10, 11): (0, 0, 1, 0)
-                                           -2 * x + 2 * y + 4 * z + -1 \in {-1, 1} */
-                                        result.add_constraint(-2 * x + 2 * y + 4 * z + -1);
-                                        break;
-                                    case TBCS_GATE_X:
-                                        /* Truth table (00, 01, 10, 11): (0, 0, 1, 1)
-                                           -1 * x + 0 * y + 1 * z + 1 \in {-1, 1} */
-                                        result.add_constraint(-1 * x + 0 * y + 1 * z + 1);
-                                        break;
-                                    case TBCS_GATE_NOT_X_AND_Y:
-                                        /* Truth table (00, 01, 10, 11): (0, 1, 0, 0)
-                                           2 * x + -2 * y + 4 * z + -1 \in {-1, 1} */
-                                        result.add_constraint(2 * x + -2 * y + 4 * z + -1);
-                                        break;
-                                    case TBCS_GATE_Y:
-                                        /* Truth table (00, 01, 10, 11): (0, 1, 0, 1)
-                                           0 * x + 1 * y + 1 * z + -1 \in {-1, 1} */
-                                        result.add_constraint(0 * x + 1 * y + 1 * z + -1);
-                                        break;
-                                    case TBCS_GATE_XOR:
-                                        /* Truth table (00, 01, 10, 11): (0, 1, 1, 0)
-                                           1 * x + 1 * y + 1 * z + -1 \in {-1, 1} */
-                                        result.add_constraint(1 * x + 1 * y + 1 * z + -1);
-                                        break;
-                                    case TBCS_GATE_OR:
-                                        /* Truth table (00, 01, 10, 11): (0, 1, 1, 1)
-                                           -2 * x + -2 * y + 4 * z + -1 \in {-1, 1} */
-                                        result.add_constraint(-2 * x + -2 * y + 4 * z + -1);
-                                        break;
-                                    case TBCS_GATE_NOR:
-                                        /* Truth table (00, 01, 10, 11): (1, 0, 0, 0)
-                                           2 * x + 2 * y + 4 * z + -3 \in {-1, 1} */
-                                        result.add_constraint(2 * x + 2 * y + 4 * z + -3);
-                                        break;
-                                    case TBCS_GATE_EQUIVALENCE:
-                                        /* Truth table (00, 01, 10, 11): (1, 0, 0, 1)
-                                           1 * x + 1 * y + 1 * z + -2 \in {-1, 1} */
-                                        result.add_constraint(1 * x + 1 * y + 1 * z + -2);
-                                        break;
-                                    case TBCS_GATE_NOT_Y:
-                                        /* Truth table (00, 01, 10, 11): (1, 0, 1, 0)
-                                           0 * x + -1 * y + 1 * z + 0 \in {-1, 1} */
-                                        result.add_constraint(0 * x + -1 * y + 1 * z + 0);
-                                        break;
-                                    case TBCS_GATE_IF_Y_THEN_X:
-                                        /* Truth table (00, 01, 10, 11): (1, 0, 1, 1)
-                                           -2 * x + 2 * y + 4 * z + -3 \in {-1, 1} */
-                                        result.add_constraint(-2 * x + 2 * y + 4 * z + -3);
-                                        break;
-                                    case TBCS_GATE_NOT_X:
-                                        /* Truth table (00, 01, 10, 11): (1, 1, 0, 0)
-                                           -1 * x + 0 * y + 1 * z + 0 \in {-1, 1} */
-                                        result.add_constraint(-1 * x + 0 * y + 1 * z + 0);
-                                        break;
-                                    case TBCS_GATE_IF_X_THEN_Y:
-                                        /* Truth table (00, 01, 10, 11): (1, 1, 0, 1)
-                                           2 * x + -2 * y + 4 * z + -3 \in {-1, 1} */
-                                        result.add_constraint(2 * x + -2 * y + 4 * z + -3);
-                                        break;
-                                    case TBCS_GATE_NAND:
-                                        /* Truth table (00, 01, 10, 11): (1, 1, 1, 0)
-                                           2 * x + 2 * y + 4 * z + -5 \in {-1, 1} */
-                                        result.add_constraint(2 * x + 2 * y + 4 * z + -5);
-                                        break;
-                                    case TBCS_GATE_CONSTANT_1:
-                                        /* Truth table (00, 01, 10, 11): (1, 1, 1, 1)
-                                           0 * x + 0 * y + 1 * z + 0 \in {-1, 1} */
-                                        result.add_constraint(0 * x + 0 * y + 1 * z + 0);
-                                        break;
-                                    default:
-                                        assert(0);
-                                }
-                            }
-
-                            for (std::size_t i = 0;
-                                 i < circuit.primary_input_size + circuit.auxiliary_input_size + circuit.gates.size();
-                                 ++i) {
-                                /* require that 2 * wire - 1 \in {-1,1}, that is wire \in {0,1} */
-                                result.add_constraint(2 * variable<FieldType>(i) - 1);
-                            }
+                            uscs_constraint_system<FieldType> result = allocate(circuit);
+                            const std::vector<std::size_t> outputs = circuit_outputs(circuit);
+                            result.constraints.resize(num_constraints(circuit, outputs));
 
-                            for (auto &g : circuit.gates) {
-                                if (g.is_circuit_output) {
-                                    /* require that output + 1 \in {-1,1}, this together with output binary (above)
-                                     * enforces output = 0 */
-                                    result.add_constraint(variable<FieldType>(g.output) + 1);
-                                }
-                            }
+                            detail::compile_circuit(result.constraints.size(), [&](const std::size_t c) {
+                                result.constraints[c] = constraint(circuit, outputs, c);
+                            });
 
                             return result;
                         }
@@ -190,6 +92,140 @@ namespace nil {
                                 algebra::convert_bit_vector_to_field_element_vector<FieldType>(all_wires);
                             return result;
                         }
+
+                        /**
+                         * Witness map for the TBCS-to-USCS reduction, evaluating the circuit on the bit-packed
+                         * wires of an evaluator precompiled for it.
+                         */
+                        static uscs_variable_assignment<FieldType>
+                            witness_map(const tbcs_circuit_evaluator &evaluator,
+                                        const tbcs_primary_input &primary_input,
+                                        const tbcs_auxiliary_input &auxiliary_input) {
+                            const std::vector<std::uint64_t> words =
+                                evaluator.get_all_wire_words(primary_input, auxiliary_input);
+
+                            uscs_variable_assignment<FieldType> result(
+                                primary_input.size() + auxiliary_input.size() + evaluator.num_gates());
+                            executor::current().parallel_for(result.size(), [&](const std::size_t i) {
+                                result[i] = ((words[(i + 1) / 64] >> ((i + 1) % 64)) & 1u) ?
+                                                FieldType::value_type::one() :
+                                                FieldType::value_type::zero();
+                            });
+                            return result;
+                        }
+
+                        /**
+                         * The auxiliary part of the witness map, the wires after the primary input, in a single
+                         * parallel pass over the bit-packed wires of the evaluator.
+                         */
+                        static uscs_auxiliary_input<FieldType>
+                            auxiliary_witness_map(const tbcs_circuit_evaluator &evaluator,
+                                                  const tbcs_primary_input &primary_input,
+                                                  const tbcs_auxiliary_input &auxiliary_input) {
+                            const std::vector<std::uint64_t> words =
+                                evaluator.get_all_wire_words(primary_input, auxiliary_input);
+
+                            const std::size_t first = 1 + primary_input.size();
+                            uscs_auxiliary_input<FieldType> result(evaluator.num_wires() - primary_input.size());
+                            executor::current().parallel_for(result.size(), [&](const std::size_t i) {
+                                result[i] = ((words[(first + i) / 64] >> ((first + i) % 64)) & 1u) ?
+                                                FieldType::value_type::one() :
+                                                FieldType::value_type::zero();
+                            });
+                            return result;
+                        }
+
+                    private:
+                        typedef typename FieldType::value_type field_value_type;
+
+                        static uscs_constraint_system<FieldType> allocate(const tbcs_circuit &circuit) {
+                            assert(circuit.is_valid());
+                            uscs_constraint_system<FieldType> result;
+
+                            result.primary_input_size = circuit.primary_input_size;
+                            result.auxiliary_input_size = circuit.auxiliary_input_size + circuit.gates.size();
+
+                            return result;
+                        }
+
+                        static std::vector<std::size_t> circuit_outputs(const tbcs_circuit &circuit) {
+                            std::vector<std::size_t> outputs;
+                            for (std::size_t i = 0; i < circuit.gates.size(); ++i) {
+                                if (circuit.gates[i].is_circuit_output) {
+                                    outputs.emplace_back(i);
+                                }
+                            }
+                            return outputs;
+                        }
+
+                        static std::size_t num_wires(const tbcs_circuit &circuit) {
+                            return circuit.primary_input_size + circuit.auxiliary_input_size + circuit.gates.size();
+                        }
+
+                        /**
+                         * One constraint per gate, then one per wire, then one per circuit output.
+                         */
+                        static std::size_t num_constraints(const tbcs_circuit &circuit,
+                                                           const std::vector<std::size_t> &outputs) {
+                            return circuit.gates.size() + num_wires(circuit) + outputs.size();
+                        }
+
+                        static uscs_constraint<FieldType> constraint(const tbcs_circuit &circuit,
+                                                                     const std::vector<std::size_t> &outputs,
+                                                                     std::size_t c) {
+                            if (c < circuit.gates.size()) {
+                                return gate_constraint(circuit.gates[c]);
+                            }
+                            c -= circuit.gates.size();
+
+                            if (c < num_wires(circuit)) {
+                                /* require that 2 * wire - 1 \in {-1,1}, that is wire \in {0,1} */
+                                return detail::sorted_combination<FieldType, 2>(
+                                    {{linear_term<FieldType>(variable<FieldType>(c), 2),
+                                      linear_term<FieldType>(variable<FieldType>(0), -field_value_type::one())}});
+                            }
+                            c -= num_wires(circuit);
+
+                            /* require that output + 1 \in {-1,1}, this together with output binary (above)
+                             * enforces output = 0 */
+                            return detail::sorted_combination<FieldType, 2>(
+                                {{linear_term<FieldType>(variable<FieldType>(circuit.gates[outputs[c]].output)),
+                                  linear_term<FieldType>(variable<FieldType>(0), 1)}});
+                        }
+
+                        /**
+                         * Maps a gate to the constraint a * x + b * y + c * z + k \in {-1, 1}, where x, y are
+                         * its input wires and z its output wire.
+                         */
+                        static uscs_constraint<FieldType> gate_constraint(const tbcs_gate &g) {
+                            /* a, b, c, k per gate type, and the truth table (00, 01, 10, 11) it encodes */
+                            static const integer_coeff_t coefficients[16][4] = {
+                                {0, 0, 1, 1},      /* TBCS_GATE_CONSTANT_0:   (0, 0, 0, 0) */
+                                {-2, -2, 4, 1},    /* TBCS_GATE_AND:          (0, 0, 0, 1) */
+                                {-2, 2, 4, -1},    /* TBCS_GATE_X_AND_NOT_Y:  (0, 0, 1, 0) */
+                                {-1, 0, 1, 1},     /* TBCS_GATE_X:            (0, 0, 1, 1) */
+                                {2, -2, 4, -1},    /* TBCS_GATE_NOT_X_AND_Y:  (0, 1, 0, 0) */
+                                {0, 1, 1, -1},     /* TBCS_GATE_Y:            (0, 1, 0, 1) */
+                                {1, 1, 1, -1},     /* TBCS_GATE_XOR:          (0, 1, 1, 0) */
+                                {-2, -2, 4, -1},   /* TBCS_GATE_OR:           (0, 1, 1, 1) */
+                                {2, 2, 4, -3},     /* TBCS_GATE_NOR:          (1, 0, 0, 0) */
+                                {1, 1, 1, -2},     /* TBCS_GATE_EQUIVALENCE:  (1, 0, 0, 1) */
+                                {0, -1, 1, 0},     /* TBCS_GATE_NOT_Y:        (1, 0, 1, 0) */
+                                {-2, 2, 4, -3},    /* TBCS_GATE_IF_Y_THEN_X:  (1, 0, 1, 1) */
+                                {-1, 0, 1, 0},     /* TBCS_GATE_NOT_X:        (1, 1, 0, 0) */
+                                {2, -2, 4, -3},    /* TBCS_GATE_IF_X_THEN_Y:  (1, 1, 0, 1) */
+                                {2, 2, 4, -5},     /* TBCS_GATE_NAND:         (1, 1, 1, 0) */
+                                {0, 0, 1, 0}};     /* TBCS_GATE_CONSTANT_1:   (1, 1, 1, 1) */
+
+                            assert(g.type <= TBCS_GATE_CONSTANT_1);
+                            const integer_coeff_t *k = coefficients[g.type];
+
+                            return detail::sorted_combination<FieldType, 4>(
+                                {{linear_term<FieldType>(variable<FieldType>(g.left_wire), k[0]),
+                                  linear_term<FieldType>(variable<FieldType>(g.right_wire), k[1]),
+                                  linear_term<FieldType>(variable<FieldType>(g.output), k[2]),
+                                  linear_term<FieldType>(variable<FieldType>(0), k[3])}});
+                        }
                     };
                 }    // namespace reductions
             }        // namespace snark
@@ -48,12 +48,19 @@
 #ifndef CRYPTO3_ZK_USCS_TO_SSP_REDUCTION_HPP
 #define CRYPTO3_ZK_USCS_TO_SSP_REDUCTION_HPP
 
+#include <numeric>
+
 #include <nil/crypto3/math/coset.hpp>
 #include <nil/crypto3/math/domains/evaluation_domain.hpp>
 #include <nil/crypto3/math/make_evaluation_domain.hpp>
 
+#include <nil/crypto3/zk/snark/reductions/detail/field_kernels.hpp>
+#include <nil/crypto3/zk/snark/reductions/reduction_context.hpp>
 #include <nil/crypto3/zk/snark/relations/arithmetic_programs/ssp.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/uscs.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -64,6 +71,54 @@ namespace nil {
                     struct uscs_to_ssp {
                         typedef FieldType field_type;
 
+                        /**
+                         * Scratch buffer of the witness map.
+                         *
+                         * A workspace passed to witness_map keeps the evaluation vector of V alive between
+                         * calls, so repeated witness maps over the same domain run on the same memory.
+                         */
+                        struct workspace {
+                            std::vector<typename FieldType::value_type> aV;
+
+                            workspace() = default;
+                            explicit workspace(const std::size_t domain_size) {
+                                reserve(domain_size);
+                            }
+
+                            void reserve(const std::size_t domain_size) {
+                                aV.reserve(domain_size);
+                            }
+
+                            std::size_t size_in_bits() const {
+                                return aV.capacity() * FieldType::value_bits;
+                            }
+                        };
+
+                        /**
+                         * Evaluation domain used by the reduction for the constraint system cs.
+                         */
+                        static std::shared_ptr<fft::evaluation_domain<FieldType>>
+                            get_domain(const uscs_constraint_system<FieldType> &cs) {
+                            return fft::make_evaluation_domain<FieldType>(cs.num_constraints());
+                        }
+
+                        /**
+                         * Reduction context of the constraint system cs, with the coset shifts and the
+                         * division by Z precomputed once for all the witness maps of cs.
+                         */
+                        static reduction_context<FieldType> make_context(const uscs_constraint_system<FieldType> &cs) {
+                            return reduction_context<FieldType>(get_domain(cs), true);
+                        }
+
+                        /**
+                         * Precomputed context of the domain size of cs from the reduction context pool, shared
+                         * with every other constraint system of that domain size.
+                         */
+                        static std::shared_ptr<const reduction_context<FieldType>>
+                            shared_context(const uscs_constraint_system<FieldType> &cs) {
+                            return reduction_context_pool<FieldType>::get(get_domain(cs));
+                        }
+
                         /**
                          * Instance map for the USCS-to-SSP reduction.
                          *
@@ -77,19 +132,18 @@ namespace nil {
                         static ssp_instance<FieldType> instance_map(const uscs_constraint_system<FieldType> &cs) {
                             const std::shared_ptr<evaluation_domain<FieldType>> domain =
                                 fft::make_evaluation_domain<FieldType>(cs.num_constraints());
-                            std::vector<std::map<std::size_t, typename FieldType::value_type>> V_in_Lagrange_basis(cs.num_variables() + 1);
+                            sparse_lagrange_basis_builder<FieldType> V_in_Lagrange_basis(cs.num_variables() + 1);
                             for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                for (std::size_t j = 0; j < cs.constraints[i].terms.size(); ++j) {
-                                    V_in_Lagrange_basis[cs.constraints[i].terms[j].index][i] +=
-                                        cs.constraints[i].terms[j].coeff;
+                                for (const linear_term<FieldType> &term : cs.constraints[i].terms) {
+                                    V_in_Lagrange_basis.add(term.index, i, term.coeff);
                                 }
                             }
                             for (std::size_t i = cs.num_constraints(); i < domain->m; ++i) {
-                                V_in_Lagrange_basis[0][i] += FieldType::value_type::one();
+                                V_in_Lagrange_basis.add(0, i, FieldType::value_type::one());
                             }
 
                             return ssp_instance<FieldType>(
-                                domain, cs.num_variables(), domain->m, cs.num_inputs(), std::move(V_in_Lagrange_basis));
+                                domain, cs.num_variables(), domain->m, cs.num_inputs(), V_in_Lagrange_basis.build());
                         }
 
                         /**
@@ -119,11 +173,14 @@ namespace nil {
 
                             const std::vector<typename FieldType::value_type> u =
                                 domain->evaluate_all_lagrange_polynomials(t);
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                for (std::size_t j = 0; j < cs.constraints[i].terms.size(); ++j) {
-                                    Vt[cs.constraints[i].terms[j].index] += u[i] * cs.constraints[i].terms[j].coeff;
-                                }
-                            }
+                            /*
+                             * every entry of Vt is an independent dot product of a column of the constraint
+                             * matrix, so the variables are split across the current executor
+                             */
+                            const r1cs_sparse_matrix<FieldType> V_columns = column_major(cs, cs.num_variables() + 1);
+                            executor::current().parallel_for(cs.num_variables() + 1, [&](const std::size_t k) {
+                                Vt[k] = V_columns.dot_row(k, u);
+                            });
                             for (std::size_t i = cs.num_constraints(); i < domain->m; ++i) {
                                 Vt[0] += u[i]; /* dummy constraint: 1^2 = 1 */
                             }
@@ -174,6 +231,22 @@ namespace nil {
                                                            const uscs_primary_input<FieldType> &primary_input,
                                                            const uscs_auxiliary_input<FieldType> &auxiliary_input,
                                                            const typename FieldType::value_type &d) {
+                            workspace scratch;
+                            return witness_map(cs, primary_input, auxiliary_input, d, *shared_context(cs),
+                                               scratch);
+                        }
+
+                        /**
+                         * Witness map for the USCS-to-SSP reduction over a domain obtained from get_domain(cs)
+                         * or over the context returned by make_context(cs), running in the buffer of scratch.
+                         */
+                        static ssp_witness<FieldType>
+                            witness_map(const uscs_constraint_system<FieldType> &cs,
+                                        const uscs_primary_input<FieldType> &primary_input,
+                                        const uscs_auxiliary_input<FieldType> &auxiliary_input,
+                                        const typename FieldType::value_type &d,
+                                        const reduction_context<FieldType> &context,
+                                        workspace &scratch) {
                             /* sanity check */
 
                             assert(cs.is_satisfied(primary_input, auxiliary_input));
@@ -182,63 +255,92 @@ namespace nil {
                             full_variable_assignment.insert(
                                 full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
 
-                            const std::shared_ptr<evaluation_domain<FieldType>> domain =
-                                make_evaluation_domain<FieldType>(cs.num_constraints());
+                            std::vector<typename FieldType::value_type> H =
+                                coefficients_for_H(cs, full_variable_assignment, d, context, scratch);
+
+                            return ssp_witness<FieldType>(cs.num_variables(),
+                                                          context.domain()->m,
+                                                          cs.num_inputs(),
+                                                          d,
+                                                          full_variable_assignment,
+                                                          std::move(H));
+                        }
 
-                            std::vector<typename FieldType::value_type> aA(domain->m, FieldType::value_type::zero());
+                        /**
+                         * Coefficients of the polynomial H of the witness map, computed from the full
+                         * variable assignment (x_1, ..., x_m) alone, in the buffer of scratch.
+                         *
+                         * Every constraint being a square, the only polynomial to transform is V: it is
+                         * evaluated on S, interpolated, shifted to the coset and evaluated there in the one
+                         * buffer, and V^2 - 1 is formed in place before the division by Z. The inverse shift
+                         * of H is fused with the addition of the zero-knowledge patch.
+                         */
+                        static std::vector<typename FieldType::value_type>
+                            coefficients_for_H(const uscs_constraint_system<FieldType> &cs,
+                                               const uscs_variable_assignment<FieldType> &full_variable_assignment,
+                                               const typename FieldType::value_type &d,
+                                               const reduction_context<FieldType> &context,
+                                               workspace &scratch) {
+                            const std::shared_ptr<fft::evaluation_domain<FieldType>> &domain = context.domain();
                             assert(domain->m >= cs.num_constraints());
-                            for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
-                                aA[i] += cs.constraints[i].evaluate(full_variable_assignment);
-                            }
-                            for (std::size_t i = cs.num_constraints(); i < domain->m; ++i) {
-                                aA[i] += FieldType::value_type::one();
-                            }
 
-                            domain->iFFT(aA);
+                            stage_profiler::timer evaluate_timer("evaluate", cs.num_constraints());
+                            std::vector<typename FieldType::value_type> &aV = scratch.aV;
+                            /* the points of S past the constraints pad V with ones, so V^2 - 1 vanishes there */
+                            aV.assign(domain->m, FieldType::value_type::one());
+                            executor::current().parallel_for(cs.num_constraints(), [&](const std::size_t i) {
+                                aV[i] = cs.constraints[i].evaluate(full_variable_assignment);
+                            });
+                            evaluate_timer.stop();
+
+                            stage_profiler::timer fft_timer("fft", domain->m);
+                            domain->iFFT(aV);
 
                             std::vector<typename FieldType::value_type> coefficients_for_H(
                                 domain->m + 1, FieldType::value_type::zero());
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
                             /* add coefficients of the polynomial 2*d*V(z) + d*d*Z(z) */
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                coefficients_for_H[i] = typename FieldType::value_type(2) * d * aA[i];
-                            }
+                            const typename FieldType::value_type two_d = d + d;
+                            detail::field_kernels<FieldType>::scale(coefficients_for_H.data(), aV.data(), two_d,
+                                                                    domain->m);
                             domain->add_poly_Z(d.squared(), coefficients_for_H);
 
-                            fft::multiply_by_coset(aA,
-                                                   typename FieldType::value_type(
-                                                       fields::arithmetic_params<FieldType>::multiplicative_generator));
-                            domain->FFT(aA);
-
-                            std::vector<typename FieldType::value_type> &H_tmp =
-                                aA;    // can overwrite aA because it is not used later
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                H_tmp[i] = aA[i].squared() - FieldType::value_type::one();
-                            }
+                            context.for_each_coset_power(
+                                [&](std::size_t i, const typename FieldType::value_type &power) {
+                                    aV[i] *= power;
+                                });
+                            domain->FFT(aV);
+
+                            /* H_tmp can overwrite aV because it is not used later */
+                            std::vector<typename FieldType::value_type> &H_tmp = aV;
+                            executor::current().parallel_for(domain->m, [&](const std::size_t i) {
+                                H_tmp[i] = aV[i].squared() - FieldType::value_type::one();
+                            });
 
-                            domain->divide_by_Z_on_coset(H_tmp);
+                            context.divide_by_Z_on_coset(H_tmp);
 
                             domain->iFFT(H_tmp);
-                            multiply_by_coset(H_tmp, typename FieldType::value_type(fields::arithmetic_params<FieldType>::multiplicative_generator).inversed());
+                            /* undo the coset shift and add the H coefficients in the same pass */
+                            context.for_each_inverse_coset_power(
+                                [&](std::size_t i, const typename FieldType::value_type &power) {
+                                    coefficients_for_H[i] += H_tmp[i] * power;
+                                });
 
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-                            for (std::size_t i = 0; i < domain->m; ++i) {
-                                coefficients_for_H[i] += H_tmp[i];
-                            }
+                            return coefficients_for_H;
+                        }
 
-                            return ssp_witness<FieldType>(cs.num_variables(),
-                                                          domain->m,
-                                                          cs.num_inputs(),
-                                                          d,
-                                                          full_variable_assignment,
-                                                          std::move(coefficients_for_H));
+                    private:
+                        /**
+                         * The matrix of the constraints of cs in column-major layout: row k lists the
+                         * constraints touching variable k, see r1cs_sparse_matrix::column_major.
+                         */
+                        static r1cs_sparse_matrix<FieldType> column_major(const uscs_constraint_system<FieldType> &cs,
+                                                                          const std::size_t num_columns) {
+                            return r1cs_sparse_matrix<FieldType>::column_major(
+                                cs.num_constraints(), num_columns, [&](const std::size_t i, auto &&f) {
+                                    for (const linear_term<FieldType> &term : cs.constraints[i].terms) {
+                                        f(term.index, term.coeff);
+                                    }
+                                });
                         }
                     };
                 }    // namespace reductions
@@ -38,8 +38,8 @@
 #ifndef CRYPTO3_ZK_QAP_HPP
 #define CRYPTO3_ZK_QAP_HPP
 
-#include <map>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 
 #include <nil/crypto3/algebra/random_element.hpp>
@@ -48,6 +48,8 @@
 #include <nil/crypto3/math/domains/evaluation_domain.hpp>
 #include <nil/crypto3/math/make_evaluation_domain.hpp>
 
+#include <nil/crypto3/zk/snark/relations/arithmetic_programs/sparse_lagrange_basis.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -55,8 +57,8 @@ namespace nil {
 
                 using namespace nil::crypto3::fft;
 
-                template<typename FieldType>
-                struct qap_witness;
+                template<typename FieldType, typename Allocator = std::allocator<typename FieldType::value_type>>
+                class qap_witness;
 
                 template<typename FieldType>
                 struct qap_instance_evaluation;
@@ -69,7 +71,7 @@ namespace nil {
                  * Specifically, the datastructure stores:
                  * - a choice of domain (corresponding to a certain subset of the field);
                  * - the number of variables, the degree, and the number of inputs; and
-                 * - coefficients of the A,B,C polynomials in the Lagrange basis.
+                 * - coefficients of the A,B,C polynomials in the Lagrange basis, one row per variable.
                  *
                  * There is no need to store the Z polynomial because it is uniquely
                  * determined by the domain (as Z is its vanishing polynomial).
@@ -86,17 +88,17 @@ namespace nil {
 
                     std::shared_ptr<evaluation_domain<field_type>> domain;
 
-                    std::vector<std::map<std::size_t, field_value_type>> A_in_Lagrange_basis;
-                    std::vector<std::map<std::size_t, field_value_type>> B_in_Lagrange_basis;
-                    std::vector<std::map<std::size_t, field_value_type>> C_in_Lagrange_basis;
+                    sparse_lagrange_basis<field_type> A_in_Lagrange_basis;
+                    sparse_lagrange_basis<field_type> B_in_Lagrange_basis;
+                    sparse_lagrange_basis<field_type> C_in_Lagrange_basis;
 
                     qap_instance(const std::shared_ptr<evaluation_domain<field_type>> &domain,
                                  const std::size_t num_variables,
                                  const std::size_t degree,
                                  const std::size_t num_inputs,
-                                 const std::vector<std::map<std::size_t, field_value_type>> &A_in_Lagrange_basis,
-                                 const std::vector<std::map<std::size_t, field_value_type>> &B_in_Lagrange_basis,
-                                 const std::vector<std::map<std::size_t, field_value_type>> &C_in_Lagrange_basis) :
+                                 const sparse_lagrange_basis<field_type> &A_in_Lagrange_basis,
+                                 const sparse_lagrange_basis<field_type> &B_in_Lagrange_basis,
+                                 const sparse_lagrange_basis<field_type> &C_in_Lagrange_basis) :
                         num_variables(num_variables),
                         degree(degree), num_inputs(num_inputs), domain(domain),
                         A_in_Lagrange_basis(A_in_Lagrange_basis), B_in_Lagrange_basis(B_in_Lagrange_basis),
@@ -107,9 +109,9 @@ namespace nil {
                                  const std::size_t num_variables,
                                  const std::size_t degree,
                                  const std::size_t num_inputs,
-                                 std::vector<std::map<std::size_t, field_value_type>> &&A_in_Lagrange_basis,
-                                 std::vector<std::map<std::size_t, field_value_type>> &&B_in_Lagrange_basis,
-                                 std::vector<std::map<std::size_t, field_value_type>> &&C_in_Lagrange_basis) :
+                                 sparse_lagrange_basis<field_type> &&A_in_Lagrange_basis,
+                                 sparse_lagrange_basis<field_type> &&B_in_Lagrange_basis,
+                                 sparse_lagrange_basis<field_type> &&C_in_Lagrange_basis) :
                         num_variables(num_variables),
                         degree(degree), num_inputs(num_inputs), domain(domain),
                         A_in_Lagrange_basis(std::move(A_in_Lagrange_basis)),
@@ -122,31 +124,19 @@ namespace nil {
                     qap_instance &operator=(const qap_instance<field_type> &other) = default;
                     qap_instance &operator=(qap_instance<field_type> &&other) = default;
 
-                    bool is_satisfied(const qap_witness<field_type> &witness) const {
+                    template<typename Allocator>
+                    bool is_satisfied(const qap_witness<field_type, Allocator> &witness) const {
                         const field_value_type t = algebra::random_element<field_type>();
 
-                        std::vector<field_value_type> At(this->num_variables + 1, field_value_type::zero());
-                        std::vector<field_value_type> Bt(this->num_variables + 1, field_value_type::zero());
-                        std::vector<field_value_type> Ct(this->num_variables + 1, field_value_type::zero());
                         std::vector<field_value_type> Ht(this->degree + 1);
 
                         const field_value_type Zt = this->domain->compute_vanishing_polynomial(t);
 
                         const std::vector<field_value_type> u = this->domain->evaluate_all_lagrange_polynomials(t);
 
-                        for (size_t i = 0; i < this->num_variables + 1; ++i) {
-                            for (auto &el : A_in_Lagrange_basis[i]) {
-                                At[i] += u[el.first] * el.second;
-                            }
-
-                            for (auto &el : B_in_Lagrange_basis[i]) {
-                                Bt[i] += u[el.first] * el.second;
-                            }
-
-                            for (auto &el : C_in_Lagrange_basis[i]) {
-                                Ct[i] += u[el.first] * el.second;
-                            }
-                        }
+                        std::vector<field_value_type> At = A_in_Lagrange_basis.evaluate(u);
+                        std::vector<field_value_type> Bt = B_in_Lagrange_basis.evaluate(u);
+                        std::vector<field_value_type> Ct = C_in_Lagrange_basis.evaluate(u);
 
                         field_value_type ti = field_value_type::one();
                         for (size_t i = 0; i < this->degree + 1; ++i) {
@@ -234,7 +224,8 @@ namespace nil {
                     qap_instance_evaluation &operator=(const qap_instance_evaluation<field_type> &other) = default;
                     qap_instance_evaluation &operator=(qap_instance_evaluation<field_type> &&other) = default;
 
-                    bool is_satisfied(const qap_witness<field_type> &witness) const {
+                    template<typename Allocator>
+                    bool is_satisfied(const qap_witness<field_type, Allocator> &witness) const {
 
                         if (this->num_variables != witness.num_variables) {
                             return false;
@@ -307,21 +298,27 @@ namespace nil {
 
                 /**
                  * A QAP witness.
+                 *
+                 * The coefficients are allocated with Allocator; pmr::qap_witness takes them from a
+                 * std::pmr::memory_resource, such as the memory_arena of a request, see memory_arena.hpp.
                  */
-                template<typename FieldType>
+                template<typename FieldType, typename Allocator>
                 class qap_witness {
                     using field_type = FieldType;
                     using field_value_type = typename field_type::value_type;
 
                 public:
+                    typedef Allocator allocator_type;
+                    typedef std::vector<field_value_type, Allocator> coefficients_type;
+
                     std::size_t num_variables;
                     std::size_t degree;
                     std::size_t num_inputs;
 
                     field_value_type d1, d2, d3;
 
-                    std::vector<field_value_type> coefficients_for_ABCs;
-                    std::vector<field_value_type> coefficients_for_H;
+                    coefficients_type coefficients_for_ABCs;
+                    coefficients_type coefficients_for_H;
 
                     qap_witness(const std::size_t num_variables,
                                 const std::size_t degree,
@@ -329,8 +326,8 @@ namespace nil {
                                 const field_value_type &d1,
                                 const field_value_type &d2,
                                 const field_value_type &d3,
-                                const std::vector<field_value_type> &coefficients_for_ABCs,
-                                const std::vector<field_value_type> &coefficients_for_H) :
+                                const coefficients_type &coefficients_for_ABCs,
+                                const coefficients_type &coefficients_for_H) :
                         num_variables(num_variables),
                         degree(degree), num_inputs(num_inputs), d1(d1), d2(d2), d3(d3),
                         coefficients_for_ABCs(coefficients_for_ABCs), coefficients_for_H(coefficients_for_H) {
@@ -342,20 +339,44 @@ namespace nil {
                                 const field_value_type &d1,
                                 const field_value_type &d2,
                                 const field_value_type &d3,
-                                const std::vector<field_value_type> &coefficients_for_ABCs,
-                                std::vector<field_value_type> &&coefficients_for_H) :
+                                const coefficients_type &coefficients_for_ABCs,
+                                coefficients_type &&coefficients_for_H) :
                         num_variables(num_variables),
                         degree(degree), num_inputs(num_inputs), d1(d1), d2(d2), d3(d3),
                         coefficients_for_ABCs(coefficients_for_ABCs),
                         coefficients_for_H(std::move(coefficients_for_H)) {
                     }
 
-                    qap_witness(const qap_witness<field_type> &other) = default;
-                    qap_witness(qap_witness<field_type> &&other) = default;
-                    qap_witness &operator=(const qap_witness<field_type> &other) = default;
-                    qap_witness &operator=(qap_witness<field_type> &&other) = default;
+                    qap_witness(const std::size_t num_variables,
+                                const std::size_t degree,
+                                const std::size_t num_inputs,
+                                const field_value_type &d1,
+                                const field_value_type &d2,
+                                const field_value_type &d3,
+                                coefficients_type &&coefficients_for_ABCs,
+                                coefficients_type &&coefficients_for_H) :
+                        num_variables(num_variables),
+                        degree(degree), num_inputs(num_inputs), d1(d1), d2(d2), d3(d3),
+                        coefficients_for_ABCs(std::move(coefficients_for_ABCs)),
+                        coefficients_for_H(std::move(coefficients_for_H)) {
+                    }
+
+                    qap_witness(const qap_witness &other) = default;
+                    qap_witness(qap_witness &&other) = default;
+                    qap_witness &operator=(const qap_witness &other) = default;
+                    qap_witness &operator=(qap_witness &&other) = default;
+
+                    allocator_type get_allocator() const {
+                        return coefficients_for_H.get_allocator();
+                    }
                 };
 
+                namespace pmr {
+                    template<typename FieldType>
+                    using qap_witness =
+                        snark::qap_witness<FieldType, std::pmr::polymorphic_allocator<typename FieldType::value_type>>;
+                }    // namespace pmr
+
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -0,0 +1,257 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a flat binary encoding of a QAP witness.
+//
+// The witness map and the multi-exponentiations of a prover only communicate through
+// the QAP witness: the H coefficients and the variable assignment. The encoding below
+// lays a witness out as a header followed by 64-byte aligned sections holding the native
+// representation of the field elements, so it can be shipped as is from the node running
+// the witness map to the nodes running the multi-exponentiations. A received buffer is
+// read in place through qap_witness_view, without deserialization; deserialize copies it
+// back into a qap_witness. Like the memory-mapped proving key, the encoding is tied to
+// the in-memory representation of the field elements, hence to the build that wrote it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_QAP_WITNESS_BUFFER_HPP
+#define CRYPTO3_ZK_QAP_WITNESS_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/relations/arithmetic_programs/qap.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A QAP witness read in place: the sizes and the d's are copied, the coefficients are
+                 * pointers into the qap_witness or the buffer it was viewed from, which must outlive
+                 * the view.
+                 */
+                template<typename FieldType>
+                struct qap_witness_view {
+                    typedef FieldType field_type;
+                    typedef typename field_type::value_type field_value_type;
+
+                    std::size_t num_variables;
+                    std::size_t degree;
+                    std::size_t num_inputs;
+
+                    field_value_type d1, d2, d3;
+
+                    const field_value_type *coefficients_for_ABCs;
+                    std::size_t coefficients_for_ABCs_size;
+                    const field_value_type *coefficients_for_H;
+                    std::size_t coefficients_for_H_size;
+
+                    qap_witness_view() = default;
+
+                    template<typename Allocator>
+                    qap_witness_view(const qap_witness<field_type, Allocator> &witness) :
+                        num_variables(witness.num_variables), degree(witness.degree), num_inputs(witness.num_inputs),
+                        d1(witness.d1), d2(witness.d2), d3(witness.d3),
+                        coefficients_for_ABCs(witness.coefficients_for_ABCs.data()),
+                        coefficients_for_ABCs_size(witness.coefficients_for_ABCs.size()),
+                        coefficients_for_H(witness.coefficients_for_H.data()),
+                        coefficients_for_H_size(witness.coefficients_for_H.size()) {
+                    }
+                };
+
+                /**
+                 * Writes and reads the flat encoding of a QAP witness over FieldType.
+                 */
+                template<typename FieldType>
+                class qap_witness_buffer {
+                    typedef typename FieldType::value_type field_value_type;
+
+                    static_assert(std::is_trivially_copyable<field_value_type>::value,
+                                  "field elements must be trivially copyable");
+
+                    static constexpr const std::uint64_t magic = 0x5451573631514e5aULL;    // "ZNQ16WQT"
+                    static constexpr const std::uint64_t version = 1;
+                    static constexpr const std::size_t alignment = 64;
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t field_value_size;
+
+                        std::uint64_t num_variables;
+                        std::uint64_t degree;
+                        std::uint64_t num_inputs;
+                        std::uint64_t coefficients_for_ABCs_size;
+                        std::uint64_t coefficients_for_H_size;
+
+                        std::uint64_t ds_offset;
+                        std::uint64_t coefficients_for_ABCs_offset;
+                        std::uint64_t coefficients_for_H_offset;
+                        std::uint64_t buffer_size;
+                    };
+
+                    static_assert(std::is_trivially_copyable<header_type>::value, "header must be trivially copyable");
+
+                    static std::uint64_t align(std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    /* the offsets follow from the sizes */
+                    static header_type layout(header_type h) {
+                        h.ds_offset = align(sizeof(header_type));
+                        h.coefficients_for_ABCs_offset = align(h.ds_offset + 3 * sizeof(field_value_type));
+                        h.coefficients_for_H_offset = align(h.coefficients_for_ABCs_offset +
+                                                            h.coefficients_for_ABCs_size * sizeof(field_value_type));
+                        h.buffer_size =
+                            align(h.coefficients_for_H_offset + h.coefficients_for_H_size * sizeof(field_value_type));
+                        return h;
+                    }
+
+                    static header_type make_header(const qap_witness<FieldType> &witness) {
+                        header_type h;
+                        h.magic = magic;
+                        h.version = version;
+                        h.field_value_size = sizeof(field_value_type);
+                        h.num_variables = witness.num_variables;
+                        h.degree = witness.degree;
+                        h.num_inputs = witness.num_inputs;
+                        h.coefficients_for_ABCs_size = witness.coefficients_for_ABCs.size();
+                        h.coefficients_for_H_size = witness.coefficients_for_H.size();
+                        return layout(h);
+                    }
+
+                    static const header_type &check(const void *data, const std::size_t size) {
+                        if (size < sizeof(header_type) ||
+                            reinterpret_cast<std::uintptr_t>(data) % alignof(field_value_type) != 0) {
+                            throw std::runtime_error("qap_witness_buffer: incompatible buffer");
+                        }
+                        const header_type &h = *static_cast<const header_type *>(data);
+                        /* the sizes are bounded by the buffer first, so that their layout cannot overflow */
+                        const std::uint64_t max_values = size / sizeof(field_value_type);
+                        if (h.coefficients_for_ABCs_size > max_values || h.coefficients_for_H_size > max_values) {
+                            throw std::runtime_error("qap_witness_buffer: incompatible buffer");
+                        }
+                        /* a witness map assigns every variable and gives H its degree + 1 coefficients */
+                        if (h.num_inputs > h.num_variables || h.coefficients_for_ABCs_size != h.num_variables ||
+                            h.degree < 2 || h.coefficients_for_H_size != h.degree + 1) {
+                            throw std::runtime_error("qap_witness_buffer: inconsistent witness sizes");
+                        }
+                        const header_type expected = layout(h);
+                        if (h.magic != magic || h.version != version ||
+                            h.field_value_size != sizeof(field_value_type) || h.ds_offset != expected.ds_offset ||
+                            h.coefficients_for_ABCs_offset != expected.coefficients_for_ABCs_offset ||
+                            h.coefficients_for_H_offset != expected.coefficients_for_H_offset ||
+                            h.buffer_size != expected.buffer_size || h.buffer_size != size) {
+                            throw std::runtime_error("qap_witness_buffer: incompatible buffer");
+                        }
+                        return h;
+                    }
+
+                    template<typename T>
+                    static const T *section(const void *data, std::uint64_t offset) {
+                        return reinterpret_cast<const T *>(static_cast<const char *>(data) + offset);
+                    }
+
+                public:
+                    /* The number of bytes the encoding of witness takes. */
+                    static std::size_t size(const qap_witness<FieldType> &witness) {
+                        return make_header(witness).buffer_size;
+                    }
+
+                    /**
+                     * Encodes witness into the size(witness) bytes at out, which must be aligned to
+                     * the field elements, e.g. memory from operator new or a page.
+                     */
+                    static void write(const qap_witness<FieldType> &witness, void *out) {
+                        const header_type h = make_header(witness);
+                        char *bytes = static_cast<char *>(out);
+
+                        std::memset(bytes, 0, h.buffer_size);
+                        std::memcpy(bytes, &h, sizeof(header_type));
+                        const field_value_type ds[3] = {witness.d1, witness.d2, witness.d3};
+                        std::memcpy(bytes + h.ds_offset, ds, sizeof(ds));
+                        std::memcpy(bytes + h.coefficients_for_ABCs_offset, witness.coefficients_for_ABCs.data(),
+                                    h.coefficients_for_ABCs_size * sizeof(field_value_type));
+                        std::memcpy(bytes + h.coefficients_for_H_offset, witness.coefficients_for_H.data(),
+                                    h.coefficients_for_H_size * sizeof(field_value_type));
+                    }
+
+                    static std::vector<unsigned char> serialize(const qap_witness<FieldType> &witness) {
+                        std::vector<unsigned char> buffer(size(witness));
+                        write(witness, buffer.data());
+                        return buffer;
+                    }
+
+                    /**
+                     * Reads the witness encoded in the size bytes at data in place. Throws
+                     * std::runtime_error if they do not hold an encoding of this build, or if its sizes are
+                     * not those of a witness map.
+                     */
+                    static qap_witness_view<FieldType> view(const void *data, const std::size_t size) {
+                        const header_type &h = check(data, size);
+                        const field_value_type *ds = section<field_value_type>(data, h.ds_offset);
+
+                        qap_witness_view<FieldType> result;
+                        result.num_variables = h.num_variables;
+                        result.degree = h.degree;
+                        result.num_inputs = h.num_inputs;
+                        result.d1 = ds[0];
+                        result.d2 = ds[1];
+                        result.d3 = ds[2];
+                        result.coefficients_for_ABCs = section<field_value_type>(data, h.coefficients_for_ABCs_offset);
+                        result.coefficients_for_ABCs_size = h.coefficients_for_ABCs_size;
+                        result.coefficients_for_H = section<field_value_type>(data, h.coefficients_for_H_offset);
+                        result.coefficients_for_H_size = h.coefficients_for_H_size;
+                        return result;
+                    }
+
+                    static qap_witness_view<FieldType> view(const std::vector<unsigned char> &buffer) {
+                        return view(buffer.data(), buffer.size());
+                    }
+
+                    static qap_witness<FieldType> deserialize(const void *data, const std::size_t size) {
+                        const qap_witness_view<FieldType> w = view(data, size);
+                        return qap_witness<FieldType>(
+                            w.num_variables, w.degree, w.num_inputs, w.d1, w.d2, w.d3,
+                            std::vector<field_value_type>(w.coefficients_for_ABCs,
+                                                          w.coefficients_for_ABCs + w.coefficients_for_ABCs_size),
+                            std::vector<field_value_type>(w.coefficients_for_H,
+                                                          w.coefficients_for_H + w.coefficients_for_H_size));
+                    }
+
+                    static qap_witness<FieldType> deserialize(const std::vector<unsigned char> &buffer) {
+                        return deserialize(buffer.data(), buffer.size());
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_QAP_WITNESS_BUFFER_HPP
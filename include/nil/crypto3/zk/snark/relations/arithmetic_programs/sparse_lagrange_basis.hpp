@@ -0,0 +1,212 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a compressed sparse row storage for the polynomials of an arithmetic
+// program in the Lagrange basis.
+//
+// The instance maps of the QAP, SAP and SSP reductions express every polynomial of the
+// program by its values at the points of the evaluation domain, most of them zero. The
+// matrix below keeps all of the point indices and all of the values of all polynomials in
+// two contiguous arrays, so that evaluating the polynomials at a field element, as
+// is_satisfied does, is one sparse matrix-vector product.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SPARSE_LAGRANGE_BASIS_HPP
+#define CRYPTO3_ZK_SPARSE_LAGRANGE_BASIS_HPP
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Polynomials in the Lagrange basis of an evaluation domain, in compressed sparse row
+                 * layout.
+                 *
+                 * Polynomial i takes the value coefficients[k] at the domain point points[k] for k in
+                 * [row_offsets[i], row_offsets[i + 1]), and zero at every other point. The points of a
+                 * row are strictly increasing.
+                 */
+                template<typename FieldType>
+                struct sparse_lagrange_basis {
+                    typedef FieldType field_type;
+                    typedef typename FieldType::value_type field_value_type;
+
+                    std::vector<std::size_t> row_offsets;
+                    std::vector<std::size_t> points;
+                    std::vector<field_value_type> coefficients;
+
+                    sparse_lagrange_basis() : row_offsets(1, 0) {
+                    }
+
+                    std::size_t num_rows() const {
+                        return row_offsets.size() - 1;
+                    }
+
+                    std::size_t num_entries() const {
+                        return points.size();
+                    }
+
+                    /**
+                     * Value of polynomial i at t, u being the values of the Lagrange polynomials at t.
+                     */
+                    field_value_type evaluate_row(const std::size_t row, const std::vector<field_value_type> &u) const {
+                        field_value_type acc = field_value_type::zero();
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            acc += u[points[k]] * coefficients[k];
+                        }
+                        return acc;
+                    }
+
+                    /**
+                     * Values of all the polynomials at t, u being the values of the Lagrange polynomials
+                     * at t.
+                     */
+                    std::vector<field_value_type> evaluate(const std::vector<field_value_type> &u) const {
+                        std::vector<field_value_type> result(num_rows(), field_value_type::zero());
+                        executor::current().parallel_for(
+                            num_rows(), [&](const std::size_t row) { result[row] = evaluate_row(row, u); });
+                        return result;
+                    }
+
+                    bool operator==(const sparse_lagrange_basis &other) const {
+                        return row_offsets == other.row_offsets && points == other.points &&
+                               coefficients == other.coefficients;
+                    }
+                };
+
+                /**
+                 * Collects the entries of a sparse_lagrange_basis in any order. Entries of the same
+                 * polynomial and point add up.
+                 */
+                template<typename FieldType>
+                struct sparse_lagrange_basis_builder {
+                    typedef FieldType field_type;
+                    typedef typename FieldType::value_type field_value_type;
+
+                    std::size_t num_rows;
+                    std::vector<std::size_t> rows;
+                    std::vector<std::size_t> points;
+                    std::vector<field_value_type> coefficients;
+
+                    explicit sparse_lagrange_basis_builder(const std::size_t num_rows) : num_rows(num_rows) {
+                    }
+
+                    void reserve(const std::size_t num_entries) {
+                        rows.reserve(num_entries);
+                        points.reserve(num_entries);
+                        coefficients.reserve(num_entries);
+                    }
+
+                    void add(const std::size_t row, const std::size_t point, const field_value_type &coeff) {
+                        BOOST_ASSERT(row < num_rows);
+                        rows.emplace_back(row);
+                        points.emplace_back(point);
+                        coefficients.emplace_back(coeff);
+                    }
+
+                    /**
+                     * Buckets the entries by row, then sorts and merges every row in parallel.
+                     */
+                    sparse_lagrange_basis<FieldType> build() const {
+                        const std::size_t num_entries = rows.size();
+
+                        std::vector<std::size_t> offsets(num_rows + 1, 0);
+                        for (const std::size_t row : rows) {
+                            ++offsets[row + 1];
+                        }
+                        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+                        std::vector<std::size_t> order(num_entries);
+                        std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+                        for (std::size_t k = 0; k < num_entries; ++k) {
+                            order[next[rows[k]]++] = k;
+                        }
+
+                        std::vector<std::size_t> merged_points(num_entries);
+                        std::vector<field_value_type> merged_coefficients(num_entries);
+                        std::vector<std::size_t> lengths(num_rows);
+                        executor::current().parallel_for(num_rows, [&](const std::size_t row) {
+                            const auto first = order.begin() + offsets[row];
+                            const auto last = order.begin() + offsets[row + 1];
+                            const auto by_point = [&](const std::size_t i, const std::size_t j) {
+                                return points[i] < points[j];
+                            };
+                            // the reductions mostly add the entries of a polynomial in increasing order
+                            if (!std::is_sorted(first, last, by_point)) {
+                                std::stable_sort(first, last, by_point);
+                            }
+
+                            std::size_t out = offsets[row];
+                            for (auto it = first; it != last; ++it) {
+                                if (out > offsets[row] && merged_points[out - 1] == points[*it]) {
+                                    merged_coefficients[out - 1] += coefficients[*it];
+                                } else {
+                                    merged_points[out] = points[*it];
+                                    merged_coefficients[out] = coefficients[*it];
+                                    ++out;
+                                }
+                            }
+                            lengths[row] = out - offsets[row];
+                        });
+
+                        sparse_lagrange_basis<FieldType> result;
+                        result.row_offsets.resize(num_rows + 1);
+                        for (std::size_t row = 0; row < num_rows; ++row) {
+                            result.row_offsets[row + 1] = result.row_offsets[row] + lengths[row];
+                        }
+
+                        if (result.row_offsets.back() == num_entries) {
+                            result.points = std::move(merged_points);
+                            result.coefficients = std::move(merged_coefficients);
+                            return result;
+                        }
+
+                        result.points.resize(result.row_offsets.back());
+                        result.coefficients.resize(result.row_offsets.back());
+                        executor::current().parallel_for(num_rows, [&](const std::size_t row) {
+                            std::copy(merged_points.begin() + offsets[row],
+                                      merged_points.begin() + offsets[row] + lengths[row],
+                                      result.points.begin() + result.row_offsets[row]);
+                            std::copy(merged_coefficients.begin() + offsets[row],
+                                      merged_coefficients.begin() + offsets[row] + lengths[row],
+                                      result.coefficients.begin() + result.row_offsets[row]);
+                        });
+                        return result;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SPARSE_LAGRANGE_BASIS_HPP
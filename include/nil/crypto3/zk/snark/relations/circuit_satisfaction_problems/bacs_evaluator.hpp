@@ -0,0 +1,181 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of interfaces for a precompiled, level-scheduled BACS circuit evaluator.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_BACS_EVALUATOR_HPP
+#define CRYPTO3_ZK_BACS_EVALUATOR_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/bacs.hpp>
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/detail/gate_levels.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Evaluates a BACS circuit level by level. The level schedule is computed once, when the
+                 * evaluator is constructed; each evaluation then writes the gates of a level in parallel
+                 * into a wire vector sized up front, rather than appending them one after another.
+                 *
+                 * The gates are copied in schedule order, so the evaluator does not refer to the circuit once
+                 * built and can be kept along with it, as the BACS proving key does.
+                 */
+                template<typename FieldType>
+                class bacs_circuit_evaluator {
+                public:
+                    typedef FieldType field_type;
+
+                    /**
+                     * Levels with fewer gates are evaluated on the calling thread.
+                     */
+                    static constexpr std::size_t min_parallel_gates = 64;
+
+                    bacs_circuit_evaluator() : primary_input_size(0), auxiliary_input_size(0), level_begin(1, 0) {
+                    }
+
+                    explicit bacs_circuit_evaluator(const bacs_circuit<FieldType> &circuit) :
+                        primary_input_size(circuit.primary_input_size),
+                        auxiliary_input_size(circuit.auxiliary_input_size) {
+                        assert(circuit.is_valid());
+
+                        const detail::gate_levels levels(circuit.num_inputs(), circuit.num_gates(),
+                                                         [&](const std::size_t i, auto f) {
+                                                             for (auto &t : circuit.gates[i].lhs) {
+                                                                 f(t.index);
+                                                             }
+                                                             for (auto &t : circuit.gates[i].rhs) {
+                                                                 f(t.index);
+                                                             }
+                                                         });
+
+                        gates.reserve(circuit.num_gates());
+                        for (const std::size_t i : levels.gates) {
+                            gates.emplace_back(circuit.gates[i]);
+                        }
+                        level_begin = levels.level_begin;
+
+                        for (auto &g : circuit.gates) {
+                            if (g.is_circuit_output) {
+                                circuit_outputs.emplace_back(g.output.index);
+                            }
+                        }
+                    }
+
+                    std::size_t num_levels() const {
+                        return level_begin.size() - 1;
+                    }
+
+                    std::size_t num_gates() const {
+                        return gates.size();
+                    }
+
+                    std::size_t num_wires() const {
+                        return primary_input_size + auxiliary_input_size + num_gates();
+                    }
+
+                    bacs_variable_assignment<FieldType>
+                        get_all_wires(const bacs_primary_input<FieldType> &primary_input,
+                                      const bacs_auxiliary_input<FieldType> &auxiliary_input) const {
+                        assert(primary_input.size() == primary_input_size);
+                        assert(auxiliary_input.size() == auxiliary_input_size);
+
+                        bacs_variable_assignment<FieldType> result(num_wires());
+                        std::copy(primary_input.begin(), primary_input.end(), result.begin());
+                        std::copy(auxiliary_input.begin(), auxiliary_input.end(),
+                                  result.begin() + primary_input.size());
+
+                        for (std::size_t l = 0; l < num_levels(); ++l) {
+                            const std::size_t first = level_begin[l];
+                            const std::size_t size = level_begin[l + 1] - first;
+
+                            const auto evaluate = [&](const std::size_t k) {
+                                const bacs_gate<FieldType> &g = gates[first + k];
+                                result[g.output.index - 1] = g.evaluate(result);
+                            };
+
+                            if (size < min_parallel_gates) {
+                                for (std::size_t k = 0; k < size; ++k) {
+                                    evaluate(k);
+                                }
+                            } else {
+                                executor::current().parallel_for(size, evaluate);
+                            }
+                        }
+
+                        return result;
+                    }
+
+                    bacs_variable_assignment<FieldType>
+                        get_all_outputs(const bacs_primary_input<FieldType> &primary_input,
+                                        const bacs_auxiliary_input<FieldType> &auxiliary_input) const {
+                        const bacs_variable_assignment<FieldType> all_wires =
+                            get_all_wires(primary_input, auxiliary_input);
+
+                        bacs_variable_assignment<FieldType> all_outputs;
+
+                        for (const std::size_t output : circuit_outputs) {
+                            all_outputs.emplace_back(all_wires[output - 1]);
+                        }
+
+                        return all_outputs;
+                    }
+
+                    bool is_satisfied(const bacs_primary_input<FieldType> &primary_input,
+                                      const bacs_auxiliary_input<FieldType> &auxiliary_input) const {
+                        const bacs_variable_assignment<FieldType> all_outputs =
+                            get_all_outputs(primary_input, auxiliary_input);
+
+                        for (std::size_t i = 0; i < all_outputs.size(); ++i) {
+                            if (!all_outputs[i].is_zero()) {
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                private:
+                    std::size_t primary_input_size;
+                    std::size_t auxiliary_input_size;
+
+                    /* the gates in schedule order, those of level l from level_begin[l] on */
+                    std::vector<bacs_gate<FieldType>> gates;
+                    std::vector<std::size_t> level_begin;
+
+                    std::vector<std::size_t> circuit_outputs;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_BACS_EVALUATOR_HPP
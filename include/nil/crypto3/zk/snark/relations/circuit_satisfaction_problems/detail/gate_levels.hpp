@@ -0,0 +1,101 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the level schedule shared by the precompiled circuit evaluators.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_CIRCUIT_GATE_LEVELS_HPP
+#define CRYPTO3_ZK_CIRCUIT_GATE_LEVELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+
+                    /**
+                     * Gates of a topologically sorted circuit grouped by level. A gate is placed one level
+                     * after the latest gate whose output it reads, so the gates of a level only read inputs
+                     * and outputs of earlier levels and can be evaluated in any order.
+                     *
+                     * The gates of level l are gates[level_begin[l]], ..., gates[level_begin[l + 1] - 1],
+                     * in increasing order.
+                     */
+                    struct gate_levels {
+                        std::vector<std::size_t> gates;
+                        std::vector<std::size_t> level_begin;
+
+                        gate_levels() : level_begin(1, 0) {
+                        }
+
+                        /**
+                         * for_each_input(i, f) must call f(wire) for every input wire of gate i; gate i
+                         * outputs wire 1 + num_inputs + i.
+                         */
+                        template<typename InputFunction>
+                        gate_levels(const std::size_t num_inputs, const std::size_t num_gates,
+                                    InputFunction for_each_input) {
+                            std::vector<std::size_t> wire_level(1 + num_inputs + num_gates, 0);
+                            std::size_t num_levels = 0;
+
+                            for (std::size_t i = 0; i < num_gates; ++i) {
+                                std::size_t level = 0;
+                                for_each_input(i, [&](const std::size_t wire) {
+                                    level = std::max(level, wire_level[wire]);
+                                });
+                                wire_level[1 + num_inputs + i] = ++level;
+                                num_levels = std::max(num_levels, level);
+                            }
+
+                            /* counting sort by level, which keeps the gates of a level in increasing order */
+                            level_begin.assign(num_levels + 1, 0);
+                            for (std::size_t i = 0; i < num_gates; ++i) {
+                                ++level_begin[wire_level[1 + num_inputs + i]];
+                            }
+                            for (std::size_t l = 1; l <= num_levels; ++l) {
+                                level_begin[l] += level_begin[l - 1];
+                            }
+
+                            gates.resize(num_gates);
+                            std::vector<std::size_t> next(level_begin.begin(), level_begin.end() - 1);
+                            for (std::size_t i = 0; i < num_gates; ++i) {
+                                gates[next[wire_level[1 + num_inputs + i] - 1]++] = i;
+                            }
+                        }
+
+                        std::size_t num_levels() const {
+                            return level_begin.size() - 1;
+                        }
+                    };
+                }    // namespace detail
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_CIRCUIT_GATE_LEVELS_HPP
@@ -0,0 +1,258 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of interfaces for a precompiled, level-scheduled and bit-packed TBCS circuit evaluator.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_TBCS_EVALUATOR_HPP
+#define CRYPTO3_ZK_TBCS_EVALUATOR_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/tbcs.hpp>
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/detail/gate_levels.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Evaluates a TBCS circuit level by level on bit-packed wires: wire w is bit w % 64 of
+                 * word w / 64, the constant wire 0 included.
+                 *
+                 * When the evaluator is constructed, the gates of every level are grouped by the word their
+                 * output falls into, and the opcodes of each group are turned into four truth-table masks.
+                 * Evaluating a group then gathers its input bits into two words X and Y and computes up to
+                 * 64 outputs at once as
+                 *
+                 *     (T00 & ~X & ~Y) | (T01 & ~X & Y) | (T10 & X & ~Y) | (T11 & X & Y).
+                 *
+                 * Distinct groups of a level write distinct words, so they are evaluated in parallel.
+                 *
+                 * The wires read and written by the gates are copied into flat arrays in schedule order, so
+                 * the evaluator does not refer to the circuit once built and can be kept along with it, as
+                 * the TBCS proving key does.
+                 */
+                class tbcs_circuit_evaluator {
+                public:
+                    /**
+                     * Levels with fewer groups are evaluated on the calling thread.
+                     */
+                    static constexpr std::size_t min_parallel_blocks = 16;
+
+                    tbcs_circuit_evaluator() : primary_input_size(0), auxiliary_input_size(0), level_begin(1, 0) {
+                    }
+
+                    explicit tbcs_circuit_evaluator(const tbcs_circuit &circuit) :
+                        primary_input_size(circuit.primary_input_size),
+                        auxiliary_input_size(circuit.auxiliary_input_size) {
+                        assert(circuit.is_valid());
+
+                        const detail::gate_levels levels(circuit.num_inputs(), circuit.num_gates(),
+                                                         [&](const std::size_t i, auto f) {
+                                                             f(circuit.gates[i].left_wire);
+                                                             f(circuit.gates[i].right_wire);
+                                                         });
+
+                        left_wires.reserve(circuit.num_gates());
+                        right_wires.reserve(circuit.num_gates());
+                        output_wires.reserve(circuit.num_gates());
+                        for (const std::size_t i : levels.gates) {
+                            left_wires.emplace_back(circuit.gates[i].left_wire);
+                            right_wires.emplace_back(circuit.gates[i].right_wire);
+                            output_wires.emplace_back(circuit.gates[i].output);
+                        }
+                        for (const tbcs_gate &g : circuit.gates) {
+                            if (g.is_circuit_output) {
+                                circuit_outputs.emplace_back(g.output);
+                            }
+                        }
+
+                        level_begin.reserve(levels.num_levels() + 1);
+                        for (std::size_t l = 0; l < levels.num_levels(); ++l) {
+                            level_begin.emplace_back(blocks.size());
+                            for (std::size_t j = levels.level_begin[l]; j < levels.level_begin[l + 1]; ++j) {
+                                const tbcs_gate &g = circuit.gates[levels.gates[j]];
+                                if (blocks.size() == level_begin.back() || blocks.back().word != g.output / 64) {
+                                    blocks.emplace_back(block {g.output / 64, {0, 0, 0, 0}, j, j});
+                                }
+
+                                /* OPCODE(g) = (g(0,0), g(0,1), g(1,0), g(1,1)), most significant bit first */
+                                for (std::size_t xy = 0; xy < 4; ++xy) {
+                                    if (((std::size_t)g.type >> (3 - xy)) & 1u) {
+                                        blocks.back().truth_table[xy] |= std::uint64_t(1) << (g.output % 64);
+                                    }
+                                }
+                                blocks.back().last = j + 1;
+                            }
+                        }
+                        level_begin.emplace_back(blocks.size());
+                    }
+
+                    std::size_t num_gates() const {
+                        return output_wires.size();
+                    }
+
+                    std::size_t num_wires() const {
+                        return primary_input_size + auxiliary_input_size + num_gates();
+                    }
+
+                    std::size_t num_levels() const {
+                        return level_begin.size() - 1;
+                    }
+
+                    /**
+                     * Returns the bit-packed values of all wires, the constant wire 0 included.
+                     */
+                    std::vector<std::uint64_t> get_all_wire_words(const tbcs_primary_input &primary_input,
+                                                                  const tbcs_auxiliary_input &auxiliary_input) const {
+                        assert(primary_input.size() == primary_input_size);
+                        assert(auxiliary_input.size() == auxiliary_input_size);
+
+                        /* the words are only written through fetch_or, one group per word and level, while
+                           the groups of the same level read other bits of them */
+                        std::vector<std::atomic<std::uint64_t>> words(num_wires() / 64 + 1);
+
+                        std::vector<std::uint64_t> inputs(words.size(), 0);
+                        inputs[0] = 1;
+                        for (std::size_t i = 0; i < primary_input.size(); ++i) {
+                            inputs[(1 + i) / 64] |= std::uint64_t(primary_input[i]) << ((1 + i) % 64);
+                        }
+                        for (std::size_t i = 0, w = 1 + primary_input.size(); i < auxiliary_input.size(); ++i, ++w) {
+                            inputs[w / 64] |= std::uint64_t(auxiliary_input[i]) << (w % 64);
+                        }
+                        for (std::size_t k = 0; k < words.size(); ++k) {
+                            words[k].store(inputs[k], std::memory_order_relaxed);
+                        }
+
+                        const auto bit = [&](const std::size_t wire) {
+                            return (words[wire / 64].load(std::memory_order_relaxed) >> (wire % 64)) & 1u;
+                        };
+
+                        for (std::size_t l = 0; l < num_levels(); ++l) {
+                            const std::size_t first = level_begin[l];
+                            const std::size_t size = level_begin[l + 1] - first;
+
+                            const auto evaluate = [&](const std::size_t k) {
+                                const block &b = blocks[first + k];
+
+                                std::uint64_t X = 0, Y = 0;
+                                for (std::size_t j = b.first; j < b.last; ++j) {
+                                    X |= bit(left_wires[j]) << (output_wires[j] % 64);
+                                    Y |= bit(right_wires[j]) << (output_wires[j] % 64);
+                                }
+
+                                const std::uint64_t *T = b.truth_table;
+                                words[b.word].fetch_or((T[0] & ~X & ~Y) | (T[1] & ~X & Y) | (T[2] & X & ~Y) |
+                                                           (T[3] & X & Y),
+                                                       std::memory_order_relaxed);
+                            };
+
+                            if (size < min_parallel_blocks) {
+                                for (std::size_t k = 0; k < size; ++k) {
+                                    evaluate(k);
+                                }
+                            } else {
+                                executor::current().parallel_for(size, evaluate);
+                            }
+                        }
+
+                        std::vector<std::uint64_t> result(words.size());
+                        for (std::size_t k = 0; k < words.size(); ++k) {
+                            result[k] = words[k].load(std::memory_order_relaxed);
+                        }
+                        return result;
+                    }
+
+                    tbcs_variable_assignment get_all_wires(const tbcs_primary_input &primary_input,
+                                                           const tbcs_auxiliary_input &auxiliary_input) const {
+                        const std::vector<std::uint64_t> words = get_all_wire_words(primary_input, auxiliary_input);
+
+                        tbcs_variable_assignment result(num_wires());
+                        for (std::size_t w = 1; w <= result.size(); ++w) {
+                            result[w - 1] = (words[w / 64] >> (w % 64)) & 1u;
+                        }
+                        return result;
+                    }
+
+                    tbcs_variable_assignment get_all_outputs(const tbcs_primary_input &primary_input,
+                                                             const tbcs_auxiliary_input &auxiliary_input) const {
+                        const std::vector<std::uint64_t> words = get_all_wire_words(primary_input, auxiliary_input);
+                        tbcs_variable_assignment all_outputs;
+
+                        for (const std::size_t output : circuit_outputs) {
+                            all_outputs.push_back((words[output / 64] >> (output % 64)) & 1u);
+                        }
+
+                        return all_outputs;
+                    }
+
+                    bool is_satisfied(const tbcs_primary_input &primary_input,
+                                      const tbcs_auxiliary_input &auxiliary_input) const {
+                        const tbcs_variable_assignment all_outputs = get_all_outputs(primary_input, auxiliary_input);
+                        for (std::size_t i = 0; i < all_outputs.size(); ++i) {
+                            if (all_outputs[i]) {
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                private:
+                    /**
+                     * The gates first, ..., last - 1 of the schedule, of one level, whose outputs fall into the
+                     * same word; truth_table[2 * x + y] has the bits of the gates g with g(x, y) = 1.
+                     */
+                    struct block {
+                        std::size_t word;
+                        std::uint64_t truth_table[4];
+                        std::size_t first;
+                        std::size_t last;
+                    };
+
+                    std::size_t primary_input_size;
+                    std::size_t auxiliary_input_size;
+
+                    /* the wires of the gates in schedule order */
+                    std::vector<std::size_t> left_wires;
+                    std::vector<std::size_t> right_wires;
+                    std::vector<std::size_t> output_wires;
+
+                    std::vector<std::size_t> circuit_outputs;
+                    std::vector<block> blocks;
+                    std::vector<std::size_t> level_begin;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_TBCS_EVALUATOR_HPP
@@ -29,18 +29,32 @@
 // - a R1CS constraint system.
 //
 // Above, R1CS stands for "Rank-1 Constraint System".
+//
+// Constraints and constraint systems take the allocator of their linear combinations as a
+// template parameter, std::allocator by default. The pmr:: aliases allocate a whole system
+// and the inputs of a request from one std::pmr::memory_resource, which releases them
+// together, see memory_arena.hpp.
 //---------------------------------------------------------------------------//
 
 #ifndef CRYPTO3_ZK_R1CS_HPP
 #define CRYPTO3_ZK_R1CS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <random>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
+#include <nil/crypto3/zk/snark/input_span.hpp>
 #include <nil/crypto3/zk/snark/relations/variable.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -59,22 +73,42 @@ namespace nil {
                  *
                  * A R1CS constraint is used to construct a R1CS constraint system (see below).
                  */
-                template<typename FieldType>
+                template<typename FieldType, typename Allocator = std::allocator<linear_term<FieldType>>>
                 struct r1cs_constraint {
+                    typedef Allocator allocator_type;
+                    typedef linear_combination<FieldType, Allocator> linear_combination_type;
 
-                    linear_combination<FieldType> a, b, c;
+                    linear_combination_type a, b, c;
 
                     r1cs_constraint() {};
-                    r1cs_constraint(const linear_combination<FieldType> &a,
-                                    const linear_combination<FieldType> &b,
-                                    const linear_combination<FieldType> &c) :
+                    explicit r1cs_constraint(const allocator_type &allocator) :
+                        a(allocator), b(allocator), c(allocator) {
+                    }
+                    r1cs_constraint(const linear_combination_type &a,
+                                    const linear_combination_type &b,
+                                    const linear_combination_type &c) :
                         a(a),
                         b(b), c(c) {
                     }
+                    r1cs_constraint(const linear_combination_type &a, const linear_combination_type &b,
+                                    const linear_combination_type &c, const allocator_type &allocator) :
+                        a(a, allocator),
+                        b(b, allocator), c(c, allocator) {
+                    }
+                    template<typename OtherAllocator>
+                    r1cs_constraint(const r1cs_constraint<FieldType, OtherAllocator> &other,
+                                    const allocator_type &allocator) :
+                        a(other.a, allocator),
+                        b(other.b, allocator), c(other.c, allocator) {
+                    }
+                    r1cs_constraint(r1cs_constraint &&other, const allocator_type &allocator) :
+                        a(std::move(other.a), allocator), b(std::move(other.b), allocator),
+                        c(std::move(other.c), allocator) {
+                    }
 
-                    r1cs_constraint(const std::initializer_list<linear_combination<FieldType>> &A,
-                                    const std::initializer_list<linear_combination<FieldType>> &B,
-                                    const std::initializer_list<linear_combination<FieldType>> &C) {
+                    r1cs_constraint(const std::initializer_list<linear_combination_type> &A,
+                                    const std::initializer_list<linear_combination_type> &B,
+                                    const std::initializer_list<linear_combination_type> &C) {
                         for (auto lc_A : A) {
                             a.terms.insert(a.terms.end(), lc_A.terms.begin(), lc_A.terms.end());
                         }
@@ -86,7 +120,7 @@ namespace nil {
                         }
                     }
 
-                    bool operator==(const r1cs_constraint<FieldType> &other) const {
+                    bool operator==(const r1cs_constraint &other) const {
                         return (this->a == other.a && this->b == other.b && this->c == other.c);
                     }
                 };
@@ -108,6 +142,19 @@ namespace nil {
                 template<typename FieldType>
                 using r1cs_variable_assignment = std::vector<typename FieldType::value_type>;
 
+                /**
+                 * Read-only views of inputs and assignments held elsewhere, e.g. in a network buffer.
+                 * The vectors above convert to them, see input_span.
+                 */
+                template<typename FieldType>
+                using r1cs_primary_input_span = input_span<typename FieldType::value_type>;
+
+                template<typename FieldType>
+                using r1cs_auxiliary_input_span = input_span<typename FieldType::value_type>;
+
+                template<typename FieldType>
+                using r1cs_variable_assignment_span = input_span<typename FieldType::value_type>;
+
                 /************************* R1CS constraint system ****************************/
 
                 /**
@@ -121,18 +168,53 @@ namespace nil {
                  * NOTE:
                  * The 0-th variable (i.e., "x_{0}") always represents the constant 1.
                  * Thus, the 0-th variable is not included in num_variables.
+                 *
+                 * The constraints and their linear combinations are allocated with Allocator, rebound
+                 * to each of them. The reductions, generators and provers take systems with the default
+                 * allocator; one built with another allocator is copied into such a system, or compiled
+                 * into a r1cs_witness_program, to go through them.
                  */
-                template<typename FieldType>
+                template<typename FieldType, typename Allocator = std::allocator<linear_term<FieldType>>>
                 struct r1cs_constraint_system {
+                    typedef Allocator allocator_type;
+                    typedef r1cs_constraint<FieldType, Allocator> constraint_type;
+                    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<constraint_type>
+                        constraints_allocator_type;
+                    typedef std::vector<constraint_type, constraints_allocator_type> constraints_type;
 
                     std::size_t primary_input_size;
                     std::size_t auxiliary_input_size;
 
-                    std::vector<r1cs_constraint<FieldType>> constraints;
+                    constraints_type constraints;
 
                     r1cs_constraint_system() : primary_input_size(0), auxiliary_input_size(0) {
                     }
 
+                    explicit r1cs_constraint_system(const allocator_type &allocator) :
+                        primary_input_size(0), auxiliary_input_size(0),
+                        constraints(constraints_allocator_type(allocator)) {
+                    }
+
+                    /**
+                     * Copy of a system allocated with another allocator, e.g. of one allocated in the
+                     * arena of a request into a system the generators and provers take.
+                     */
+                    template<typename OtherAllocator>
+                    explicit r1cs_constraint_system(const r1cs_constraint_system<FieldType, OtherAllocator> &other,
+                                                    const allocator_type &allocator = allocator_type()) :
+                        primary_input_size(other.primary_input_size),
+                        auxiliary_input_size(other.auxiliary_input_size),
+                        constraints(constraints_allocator_type(allocator)) {
+                        constraints.reserve(other.constraints.size());
+                        for (const auto &constraint : other.constraints) {
+                            constraints.push_back(constraint_type(constraint, allocator));
+                        }
+                    }
+
+                    allocator_type get_allocator() const {
+                        return allocator_type(constraints.get_allocator());
+                    }
+
                     std::size_t num_inputs() const {
                         return primary_input_size;
                     }
@@ -160,36 +242,111 @@ namespace nil {
                         return true;
                     }
 
-                    bool is_satisfied(const r1cs_primary_input<FieldType> &primary_input,
-                                      const r1cs_auxiliary_input<FieldType> &auxiliary_input) const {
+                    bool is_satisfied(const r1cs_primary_input_span<FieldType> &primary_input,
+                                      const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) const {
+                        return first_unsatisfied_constraint(primary_input, auxiliary_input) == num_constraints();
+                    }
+
+                    /**
+                     * Whether the c-th constraint holds for (primary_input, auxiliary_input).
+                     */
+                    bool is_satisfied(const std::size_t c,
+                                      const r1cs_primary_input_span<FieldType> &primary_input,
+                                      const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) const {
+                        return constraints[c].a.evaluate(primary_input, auxiliary_input) *
+                                   constraints[c].b.evaluate(primary_input, auxiliary_input) ==
+                               constraints[c].c.evaluate(primary_input, auxiliary_input);
+                    }
+
+                    /**
+                     * Index of the first constraint that (primary_input, auxiliary_input) violates, or
+                     * num_constraints() if it satisfies them all.
+                     *
+                     * The constraints are checked in parallel, directly on the two inputs; a block of
+                     * constraints stops as soon as a constraint before it is known to fail.
+                     */
+                    std::size_t first_unsatisfied_constraint(
+                        const r1cs_primary_input_span<FieldType> &primary_input,
+                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) const {
                         assert(primary_input.size() == num_inputs());
                         assert(primary_input.size() + auxiliary_input.size() == num_variables());
 
-                        r1cs_variable_assignment<FieldType> full_variable_assignment = primary_input;
-                        full_variable_assignment.insert(
-                            full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
-
-                        for (std::size_t c = 0; c < constraints.size(); ++c) {
-                            const typename FieldType::value_type ares =
-                                constraints[c].a.evaluate(full_variable_assignment);
-                            const typename FieldType::value_type bres =
-                                constraints[c].b.evaluate(full_variable_assignment);
-                            const typename FieldType::value_type cres =
-                                constraints[c].c.evaluate(full_variable_assignment);
-
-                            if (!(ares * bres == cres)) {
-                                return false;
+                        std::atomic<std::size_t> first_failure(constraints.size());
+                        executor::current().parallel_for(constraints.size(), [&](const std::size_t c) {
+                            if (c < first_failure.load(std::memory_order_relaxed) &&
+                                !is_satisfied(c, primary_input, auxiliary_input)) {
+                                record_failure(first_failure, c);
                             }
+                        });
+                        return first_failure.load();
+                    }
+
+                    /**
+                     * Same as first_unsatisfied_constraint, checking only num_samples distinct constraints
+                     * drawn at random from seed: the index of the first of them that fails, or
+                     * num_constraints() if none does. With num_samples >= num_constraints() every
+                     * constraint is checked.
+                     *
+                     * A witness violating k of the n constraints passes with probability below
+                     * (1 - k / n) ^ num_samples, which makes the sampled check a cheap guard against
+                     * wrong witnesses, but no proof that a witness is right.
+                     */
+                    std::size_t first_unsatisfied_constraint(
+                        const r1cs_primary_input_span<FieldType> &primary_input,
+                        const r1cs_auxiliary_input_span<FieldType> &auxiliary_input, const std::size_t num_samples,
+                        const std::uint64_t seed) const {
+                        if (num_samples >= constraints.size()) {
+                            return first_unsatisfied_constraint(primary_input, auxiliary_input);
                         }
+                        assert(primary_input.size() == num_inputs());
+                        assert(primary_input.size() + auxiliary_input.size() == num_variables());
 
-                        return true;
+                        /* Floyd's algorithm draws the distinct samples without a pass over all indices */
+                        std::mt19937_64 generator(seed);
+                        std::unordered_set<std::size_t> drawn;
+                        std::vector<std::size_t> samples;
+                        samples.reserve(num_samples);
+                        for (std::size_t j = constraints.size() - num_samples; j < constraints.size(); ++j) {
+                            const std::size_t c = std::uniform_int_distribution<std::size_t>(0, j)(generator);
+                            const std::size_t sample = drawn.count(c) ? j : c;
+                            drawn.insert(sample);
+                            samples.emplace_back(sample);
+                        }
+                        std::sort(samples.begin(), samples.end());
+
+                        std::atomic<std::size_t> first_failure(constraints.size());
+                        executor::current().parallel_for(samples.size(), [&](const std::size_t i) {
+                            if (samples[i] < first_failure.load(std::memory_order_relaxed) &&
+                                !is_satisfied(samples[i], primary_input, auxiliary_input)) {
+                                record_failure(first_failure, samples[i]);
+                            }
+                        });
+                        return first_failure.load();
                     }
 
-                    void add_constraint(const r1cs_constraint<FieldType> &c) {
+                    void add_constraint(const constraint_type &c) {
                         constraints.emplace_back(c);
                     }
 
-                    void swap_AB_if_beneficial() {
+                    /**
+                     * Canonicalizes the A, B and C sides of every constraint, in parallel, see
+                     * linear_combination::canonicalize. The constraints keep their meaning; the ones
+                     * with unsorted or repeated terms become valid, and the witness map, instance map
+                     * and keys no longer pay for duplicate or zero terms.
+                     */
+                    void canonicalize() {
+                        executor::current().parallel_for(constraints.size(), [&](const std::size_t i) {
+                            constraints[i].a.canonicalize();
+                            constraints[i].b.canonicalize();
+                            constraints[i].c.canonicalize();
+                        });
+                    }
+
+                    /**
+                     * Whether exchanging the A and B sides of every constraint makes B touch fewer
+                     * variables, which makes the B query of the proving keys "lighter".
+                     */
+                    bool is_AB_swap_beneficial() const {
                         std::vector<bool> touched_by_A(this->num_variables() + 1, false),
                             touched_by_B(this->num_variables() + 1, false);
 
@@ -209,20 +366,54 @@ namespace nil {
                             non_zero_B_count += touched_by_B[i] ? 1 : 0;
                         }
 
-                        if (non_zero_B_count > non_zero_A_count) {
-                            for (std::size_t i = 0; i < this->constraints.size(); ++i) {
-                                std::swap(this->constraints[i].a, this->constraints[i].b);
-                            }
+                        return non_zero_B_count > non_zero_A_count;
+                    }
+
+                    void swap_AB() {
+                        for (std::size_t i = 0; i < this->constraints.size(); ++i) {
+                            std::swap(this->constraints[i].a, this->constraints[i].b);
+                        }
+                    }
+
+                    void swap_AB_if_beneficial() {
+                        if (is_AB_swap_beneficial()) {
+                            swap_AB();
                         }
                     }
 
-                    bool operator==(const r1cs_constraint_system<FieldType> &other) const {
+                    bool operator==(const r1cs_constraint_system &other) const {
                         return (this->constraints == other.constraints &&
                                 this->primary_input_size == other.primary_input_size &&
                                 this->auxiliary_input_size == other.auxiliary_input_size);
                     }
+
+                private:
+                    static void record_failure(std::atomic<std::size_t> &first_failure, const std::size_t c) {
+                        std::size_t current = first_failure.load();
+                        while (c < current && !first_failure.compare_exchange_weak(current, c)) {
+                        }
+                    }
                 };
 
+                namespace pmr {
+                    template<typename FieldType>
+                    using r1cs_constraint =
+                        snark::r1cs_constraint<FieldType, std::pmr::polymorphic_allocator<linear_term<FieldType>>>;
+
+                    template<typename FieldType>
+                    using r1cs_constraint_system =
+                        snark::r1cs_constraint_system<FieldType,
+                                                      std::pmr::polymorphic_allocator<linear_term<FieldType>>>;
+
+                    template<typename FieldType>
+                    using r1cs_primary_input = std::pmr::vector<typename FieldType::value_type>;
+
+                    template<typename FieldType>
+                    using r1cs_auxiliary_input = std::pmr::vector<typename FieldType::value_type>;
+
+                    template<typename FieldType>
+                    using r1cs_variable_assignment = std::pmr::vector<typename FieldType::value_type>;
+                }    // namespace pmr
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -0,0 +1,422 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of interfaces for the bytecode of the A, B and C matrices of a R1CS.
+//
+// The bytecode of a matrix is a straight-line program per row: one instruction per term,
+// with 32-bit operands, evaluated by a single switch loop. Coefficients 1 and -1 compile to
+// an addition or a subtraction, coefficients 2 to 4 and their opposites to an addition
+// chain, all other coefficients to a multiplication by an entry of a constant pool, and the
+// constant terms of a row to a single addition. A row identical to an earlier one of the
+// same matrix is a common subexpression: it has no instruction and its value is copied from
+// the first one once the rows are evaluated.
+//
+// The bytecode only evaluates the constraints, it is compiled once per constraint system
+// and passed to the witness map of r1cs_to_qap in place of the system. The GG prover runs it
+// through a bytecode proving key, whose constraint system is replaced by its bytecode.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_BYTECODE_HPP
+#define CRYPTO3_ZK_R1CS_BYTECODE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * The rows of a matrix of a R1CS compiled into straight-line programs.
+                 *
+                 * Row i runs the instructions [row_offsets[i], row_offsets[i + 1]) over the assignment
+                 * (x_1, ..., x_m), the variable of an instruction being the index of x_k in the
+                 * assignment, that is k - 1. The rows listed in duplicates run no instruction.
+                 */
+                template<typename FieldType>
+                struct r1cs_linear_bytecode {
+                    typedef FieldType field_type;
+                    typedef typename FieldType::value_type field_value_type;
+
+                    enum opcode : std::uint8_t {
+                        /* adds x */
+                        add,
+                        /* subtracts x */
+                        subtract,
+                        /* adds operand * x, operand being 2, 3 or 4 */
+                        add_multiple,
+                        /* subtracts operand * x, operand being 2, 3 or 4 */
+                        subtract_multiple,
+                        /* adds x * constants[operand] */
+                        multiply_add,
+                        /* adds constants[operand], without variable */
+                        add_constant
+                    };
+
+                    struct instruction {
+                        std::uint32_t variable;
+                        std::uint32_t operand;
+                        opcode code;
+
+                        bool operator==(const instruction &other) const {
+                            return variable == other.variable && operand == other.operand && code == other.code;
+                        }
+                    };
+
+                    /* a row equal to an earlier row, the source */
+                    struct duplicate {
+                        std::size_t row;
+                        std::size_t source;
+                    };
+
+                    std::vector<std::size_t> row_offsets;
+                    std::vector<instruction> instructions;
+                    std::vector<field_value_type> constants;
+                    /* in increasing order of row */
+                    std::vector<duplicate> duplicates;
+
+                    r1cs_linear_bytecode() : row_offsets(1, 0) {
+                    }
+
+                    /**
+                     * The bytecode of the rows of matrix.
+                     */
+                    explicit r1cs_linear_bytecode(const r1cs_sparse_matrix<FieldType> &matrix) :
+                        r1cs_linear_bytecode() {
+                        compile(matrix.num_rows(), [&](const std::size_t row, const auto &emit) {
+                            for (std::size_t k = matrix.row_offsets[row]; k < matrix.row_offsets[row + 1]; ++k) {
+                                emit(matrix.columns[k], matrix.coefficients[k]);
+                            }
+                        });
+                    }
+
+                    /**
+                     * The bytecode of the rows rows(0), ..., rows(num_rows - 1), given as linear combinations.
+                     */
+                    template<typename Rows>
+                    r1cs_linear_bytecode(const std::size_t num_rows, Rows rows) : r1cs_linear_bytecode() {
+                        compile(num_rows, [&](const std::size_t row, const auto &emit) {
+                            for (const auto &term : rows(row).terms) {
+                                emit(term.index, term.coeff);
+                            }
+                        });
+                    }
+
+                    std::size_t num_rows() const {
+                        return row_offsets.size() - 1;
+                    }
+
+                    /**
+                     * Runs row i on the assignment (x_1, ..., x_m); a duplicate row evaluates to zero, see
+                     * copy_duplicates.
+                     */
+                    field_value_type evaluate_row(const std::size_t row,
+                                                  const r1cs_variable_assignment_span<FieldType> &assignment) const {
+                        field_value_type acc = field_value_type::zero();
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            const instruction &op = instructions[k];
+                            switch (op.code) {
+                                case add:
+                                    acc += assignment[op.variable];
+                                    break;
+                                case subtract:
+                                    acc -= assignment[op.variable];
+                                    break;
+                                case add_multiple:
+                                    acc += multiple(assignment[op.variable], op.operand);
+                                    break;
+                                case subtract_multiple:
+                                    acc -= multiple(assignment[op.variable], op.operand);
+                                    break;
+                                case multiply_add:
+                                    acc += assignment[op.variable] * constants[op.operand];
+                                    break;
+                                case add_constant:
+                                    acc += constants[op.operand];
+                                    break;
+                            }
+                        }
+                        return acc;
+                    }
+
+                    /**
+                     * Value of row i on the assignment, duplicate rows included.
+                     */
+                    field_value_type evaluate(const std::size_t row,
+                                              const r1cs_variable_assignment_span<FieldType> &assignment) const {
+                        const auto it = std::lower_bound(
+                            duplicates.begin(), duplicates.end(), row,
+                            [](const duplicate &entry, const std::size_t value) { return entry.row < value; });
+                        return evaluate_row(it != duplicates.end() && it->row == row ? it->source : row, assignment);
+                    }
+
+                    /**
+                     * Sets the entry of every duplicate row of values to the one of its source, once every
+                     * other row i has been evaluated into values[i].
+                     */
+                    void copy_duplicates(field_value_type *values) const {
+                        for (const duplicate &entry : duplicates) {
+                            values[entry.row] = values[entry.source];
+                        }
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return 8 * (row_offsets.size() * sizeof(std::size_t) +
+                                    instructions.size() * sizeof(instruction) + duplicates.size() * sizeof(duplicate)) +
+                               constants.size() * FieldType::value_bits;
+                    }
+
+                    bool operator==(const r1cs_linear_bytecode &other) const {
+                        return row_offsets == other.row_offsets && instructions == other.instructions &&
+                               constants == other.constants && duplicates.size() == other.duplicates.size() &&
+                               std::equal(duplicates.begin(), duplicates.end(), other.duplicates.begin(),
+                                          [](const duplicate &x, const duplicate &y) {
+                                              return x.row == y.row && x.source == y.source;
+                                          });
+                    }
+
+                private:
+                    static field_value_type multiple(const field_value_type &x, const std::uint32_t k) {
+                        const field_value_type twice = x + x;
+                        return k == 2 ? twice : (k == 3 ? twice + x : twice + twice);
+                    }
+
+                    /* the operand of the constant pushed next to the pool */
+                    std::uint32_t next_constant() const {
+                        if (constants.size() > std::numeric_limits<std::uint32_t>::max()) {
+                            throw std::length_error("r1cs_linear_bytecode: constant pool exceeds a 32-bit operand");
+                        }
+                        return static_cast<std::uint32_t>(constants.size());
+                    }
+
+                    /**
+                     * Compiles the rows, terms(i, emit) calling emit(column, coefficient) for every term of
+                     * row i, column 0 standing for the constant 1.
+                     */
+                    template<typename Terms>
+                    void compile(const std::size_t num_rows, Terms terms) {
+                        const field_value_type one = field_value_type::one();
+                        const std::array<field_value_type, 3> multiples {one + one, one + one + one,
+                                                                         one + one + one + one};
+
+                        /* the rows hashed on their instructions, constants aside */
+                        std::unordered_multimap<std::size_t, std::size_t> rows_by_hash;
+                        row_offsets.reserve(num_rows + 1);
+
+                        for (std::size_t row = 0; row < num_rows; ++row) {
+                            const std::size_t first = instructions.size(), first_constant = constants.size();
+
+                            field_value_type constant = field_value_type::zero();
+                            bool has_constant = false;
+                            const auto emit = [&](const std::size_t column, const field_value_type &coeff) {
+                                if (coeff.is_zero()) {
+                                    return;
+                                }
+                                if (column == 0) {
+                                    constant += coeff;
+                                    has_constant = true;
+                                    return;
+                                }
+                                if (column - 1 > std::numeric_limits<std::uint32_t>::max()) {
+                                    throw std::out_of_range(
+                                        "r1cs_linear_bytecode: variable index does not fit a 32-bit operand");
+                                }
+                                const std::uint32_t variable = column - 1;
+                                if (coeff == one) {
+                                    instructions.push_back({variable, 0, add});
+                                } else if (coeff == -one) {
+                                    instructions.push_back({variable, 0, subtract});
+                                } else {
+                                    for (std::uint32_t k = 2; k <= 4; ++k) {
+                                        if (coeff == multiples[k - 2]) {
+                                            instructions.push_back({variable, k, add_multiple});
+                                            return;
+                                        }
+                                        if (coeff == -multiples[k - 2]) {
+                                            instructions.push_back({variable, k, subtract_multiple});
+                                            return;
+                                        }
+                                    }
+                                    instructions.push_back({variable, next_constant(), multiply_add});
+                                    constants.push_back(coeff);
+                                }
+                            };
+                            terms(row, emit);
+                            if (has_constant && !constant.is_zero()) {
+                                instructions.push_back({0, next_constant(), add_constant});
+                                constants.push_back(constant);
+                            }
+
+                            std::size_t hash = instructions.size() - first;
+                            for (std::size_t k = first; k < instructions.size(); ++k) {
+                                const instruction &op = instructions[k];
+                                const std::size_t operand =
+                                    op.code == multiply_add || op.code == add_constant ? 0 : op.operand;
+                                hash = hash * 1000003 ^ ((std::size_t(op.variable) << 8) ^ (operand << 3) ^ op.code);
+                            }
+
+                            const auto range = rows_by_hash.equal_range(hash);
+                            const auto source = std::find_if(range.first, range.second, [&](const auto &entry) {
+                                return same_instructions(entry.second, first, instructions.size());
+                            });
+                            if (first != instructions.size() && source != range.second) {
+                                duplicates.push_back({row, source->second});
+                                instructions.resize(first);
+                                constants.resize(first_constant);
+                            } else {
+                                rows_by_hash.emplace(hash, row);
+                            }
+                            row_offsets.push_back(instructions.size());
+                        }
+                    }
+
+                    /* whether row computes the same value as the instructions [first, last) */
+                    bool same_instructions(const std::size_t row, const std::size_t first,
+                                           const std::size_t last) const {
+                        if (row_offsets[row + 1] - row_offsets[row] != last - first) {
+                            return false;
+                        }
+                        for (std::size_t k = 0; k < last - first; ++k) {
+                            const instruction &x = instructions[row_offsets[row] + k], &y = instructions[first + k];
+                            if (x.code != y.code || x.variable != y.variable) {
+                                return false;
+                            }
+                            if (x.code == multiply_add || x.code == add_constant ?
+                                    !(constants[x.operand] == constants[y.operand]) :
+                                    x.operand != y.operand) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+                };
+
+                /**
+                 * The A, B and C matrices of a R1CS compiled into bytecode, along with the input and
+                 * variable counts the witness map needs.
+                 */
+                template<typename FieldType>
+                struct r1cs_bytecode {
+                    typedef FieldType field_type;
+
+                    std::size_t primary_input_size;
+                    std::size_t auxiliary_input_size;
+
+                    r1cs_linear_bytecode<FieldType> a, b, c;
+
+                    r1cs_bytecode() : primary_input_size(0), auxiliary_input_size(0) {
+                    }
+
+                    /**
+                     * The bytecode of cs, with the A and B sides of every constraint exchanged when swap_AB is
+                     * set, as for the witness map of r1cs_to_qap with swap_AB.
+                     */
+                    template<typename Allocator>
+                    explicit r1cs_bytecode(const r1cs_constraint_system<FieldType, Allocator> &cs,
+                                           const bool swap_AB = false) :
+                        primary_input_size(cs.primary_input_size),
+                        auxiliary_input_size(cs.auxiliary_input_size),
+                        a(cs.num_constraints(),
+                          [&](const std::size_t i) -> const linear_combination<FieldType, Allocator> & {
+                              return swap_AB ? cs.constraints[i].b : cs.constraints[i].a;
+                          }),
+                        b(cs.num_constraints(),
+                          [&](const std::size_t i) -> const linear_combination<FieldType, Allocator> & {
+                              return swap_AB ? cs.constraints[i].a : cs.constraints[i].b;
+                          }),
+                        c(cs.num_constraints(),
+                          [&](const std::size_t i) -> const linear_combination<FieldType, Allocator> & {
+                              return cs.constraints[i].c;
+                          }) {
+                    }
+
+                    explicit r1cs_bytecode(const r1cs_witness_program<FieldType> &program) :
+                        primary_input_size(program.primary_input_size),
+                        auxiliary_input_size(program.auxiliary_input_size), a(program.a), b(program.b),
+                        c(program.c) {
+                    }
+
+                    std::size_t num_inputs() const {
+                        return primary_input_size;
+                    }
+
+                    std::size_t num_variables() const {
+                        return primary_input_size + auxiliary_input_size;
+                    }
+
+                    std::size_t num_constraints() const {
+                        return a.num_rows();
+                    }
+
+                    bool is_satisfied(const r1cs_variable_assignment_span<FieldType> &full_variable_assignment) const {
+                        assert(full_variable_assignment.size() == num_variables());
+
+                        for (std::size_t i = 0; i < num_constraints(); ++i) {
+                            if (!(a.evaluate(i, full_variable_assignment) * b.evaluate(i, full_variable_assignment) ==
+                                  c.evaluate(i, full_variable_assignment))) {
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                    bool is_satisfied(const r1cs_primary_input_span<FieldType> &primary_input,
+                                      const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) const {
+                        r1cs_variable_assignment<FieldType> full_variable_assignment;
+                        full_variable_assignment.reserve(primary_input.size() + auxiliary_input.size());
+                        full_variable_assignment.insert(full_variable_assignment.end(), primary_input.begin(),
+                                                        primary_input.end());
+                        full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
+                                                        auxiliary_input.end());
+                        return is_satisfied(full_variable_assignment);
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return a.size_in_bits() + b.size_in_bits() + c.size_in_bits();
+                    }
+
+                    bool operator==(const r1cs_bytecode &other) const {
+                        return this->a == other.a && this->b == other.b && this->c == other.c &&
+                               this->primary_input_size == other.primary_input_size &&
+                               this->auxiliary_input_size == other.auxiliary_input_size;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_BYTECODE_HPP
@@ -0,0 +1,144 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a constant-padded view of a R1CS variable assignment.
+//
+// Provers run their multi-exponentiations over (1, x_1, ..., x_m): the variable
+// assignment with the constant 1 in front. The view below exposes that sequence
+// over the assignment in place, so it never has to be copied.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_CONST_PADDED_ASSIGNMENT_HPP
+#define CRYPTO3_ZK_R1CS_CONST_PADDED_ASSIGNMENT_HPP
+
+#include <cstddef>
+#include <iterator>
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Random access iterator over the sequence (1, *first, *(first + 1), ...).
+                 */
+                template<typename InputFieldIterator>
+                class r1cs_const_padded_iterator
+                    : public boost::iterator_facade<r1cs_const_padded_iterator<InputFieldIterator>,
+                                                    const typename std::iterator_traits<InputFieldIterator>::value_type,
+                                                    std::random_access_iterator_tag> {
+                    typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
+
+                    friend class boost::iterator_core_access;
+
+                    InputFieldIterator first;
+                    std::ptrdiff_t position;
+
+                    static const field_value_type &one() {
+                        static const field_value_type value = field_value_type::one();
+                        return value;
+                    }
+
+                    const field_value_type &dereference() const {
+                        return position == 0 ? one() : *(first + (position - 1));
+                    }
+
+                    bool equal(const r1cs_const_padded_iterator &other) const {
+                        return position == other.position;
+                    }
+
+                    void increment() {
+                        ++position;
+                    }
+
+                    void decrement() {
+                        --position;
+                    }
+
+                    void advance(const std::ptrdiff_t n) {
+                        position += n;
+                    }
+
+                    std::ptrdiff_t distance_to(const r1cs_const_padded_iterator &other) const {
+                        return other.position - position;
+                    }
+
+                public:
+                    r1cs_const_padded_iterator() : first(), position(0) {
+                    }
+
+                    r1cs_const_padded_iterator(InputFieldIterator first, const std::ptrdiff_t position) :
+                        first(first), position(position) {
+                    }
+                };
+
+                /**
+                 * The variable assignment (x_1, ..., x_m) seen as (1, x_1, ..., x_m), without copying it.
+                 *
+                 * Element 0 is the constant 1 and element i > 0 is x_i, which matches the indexing of
+                 * the A, B and C queries of the proving keys.
+                 */
+                template<typename FieldType>
+                class r1cs_const_padded_assignment {
+                    typedef typename r1cs_variable_assignment<FieldType>::const_iterator assignment_iterator;
+
+                public:
+                    typedef FieldType field_type;
+                    typedef typename FieldType::value_type value_type;
+                    typedef r1cs_const_padded_iterator<assignment_iterator> const_iterator;
+                    typedef const_iterator iterator;
+
+                    explicit r1cs_const_padded_assignment(const r1cs_variable_assignment<FieldType> &assignment) :
+                        assignment(assignment) {
+                    }
+
+                    std::size_t size() const {
+                        return assignment.size() + 1;
+                    }
+
+                    const_iterator begin() const {
+                        return const_iterator(assignment.cbegin(), 0);
+                    }
+
+                    const_iterator end() const {
+                        return const_iterator(assignment.cbegin(), size());
+                    }
+
+                    const value_type &operator[](const std::size_t i) const {
+                        return *(begin() + i);
+                    }
+
+                private:
+                    const r1cs_variable_assignment<FieldType> &assignment;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_CONST_PADDED_ASSIGNMENT_HPP
@@ -0,0 +1,150 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a content digest of R1CS constraint systems.
+//
+// The digest identifies a constraint system by its content, so that a key generated for
+// it can be looked up again instead of being regenerated. It is the Hash digest of the
+// input sizes, the number of constraints and the digests of consecutive blocks of
+// r1cs_digest_block_size constraints, each block digest hashing the A, B and C linear
+// combinations of its constraints as term counts followed by (index, coefficient) pairs.
+// Sizes and indices are written as 64-bit little-endian integers and coefficients as
+// little-endian integers of the byte size of the field modulus, so the digest is the
+// same across runs, platforms and numbers of threads. The blocks are hashed concurrently
+// on the current executor.
+//
+// Annotations are not part of the digest, and linear combinations are hashed as they are
+// stored: equivalent systems whose terms are ordered differently have different digests.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_DIGEST_HPP
+#define CRYPTO3_ZK_R1CS_DIGEST_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/hash/algorithm/hash.hpp>
+#include <nil/crypto3/hash/sha2.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /* part of the digest format: changing it changes the digest of every system */
+                constexpr static const std::size_t r1cs_digest_block_size = 1024;
+
+                namespace detail {
+
+                    template<typename Hash>
+                    typename Hash::digest_type extract_r1cs_digest(accumulator_set<Hash> &acc) {
+                        return boost::accumulators::extract_result<
+                            typename boost::mpl::front<typename accumulator_set<Hash>::features_type>::type>(acc);
+                    }
+
+                    inline void append_r1cs_digest_size(const std::uint64_t size, std::vector<std::uint8_t> &out) {
+                        for (std::size_t i = 0; i < sizeof(std::uint64_t); ++i) {
+                            out.push_back(static_cast<std::uint8_t>(size >> (8 * i)));
+                        }
+                    }
+
+                    template<typename FieldType>
+                    void append_r1cs_digest_combination(const linear_combination<FieldType> &combination,
+                                                        std::vector<std::uint8_t> &out) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+                        constexpr static const std::size_t coeff_bytes = (FieldType::modulus_bits + 7) / 8;
+
+                        append_r1cs_digest_size(combination.terms.size(), out);
+                        for (const linear_term<FieldType> &term : combination.terms) {
+                            append_r1cs_digest_size(term.index, out);
+                            const std::size_t coeff_first = out.size();
+                            out.resize(coeff_first + coeff_bytes, 0);
+                            std::vector<std::uint8_t> coeff;
+                            multiprecision::export_bits(integral_type(term.coeff.data), std::back_inserter(coeff),
+                                                        8, false);
+                            BOOST_ASSERT(coeff.size() <= coeff_bytes);
+                            std::copy(coeff.begin(), coeff.end(), out.begin() + coeff_first);
+                        }
+                    }
+                }    // namespace detail
+
+                /**
+                 * The Hash digest of the content of constraint_system, see the file comment. Equal
+                 * systems have equal digests; a digest computed by another build or on another
+                 * platform can be compared with it.
+                 */
+                template<typename Hash = hashes::sha2<256>, typename FieldType>
+                typename Hash::digest_type r1cs_constraint_system_digest(
+                    const r1cs_constraint_system<FieldType> &constraint_system) {
+
+                    const std::size_t num_constraints = constraint_system.constraints.size();
+                    const std::size_t num_blocks =
+                        (num_constraints + r1cs_digest_block_size - 1) / r1cs_digest_block_size;
+
+                    std::vector<typename Hash::digest_type> block_digests(num_blocks);
+                    executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                        const std::size_t first = block * r1cs_digest_block_size;
+                        const std::size_t last = std::min(num_constraints, first + r1cs_digest_block_size);
+
+                        std::vector<std::uint8_t> bytes;
+                        accumulator_set<Hash> acc;
+                        for (std::size_t i = first; i < last; ++i) {
+                            const r1cs_constraint<FieldType> &constraint = constraint_system.constraints[i];
+                            bytes.clear();
+                            detail::append_r1cs_digest_combination(constraint.a, bytes);
+                            detail::append_r1cs_digest_combination(constraint.b, bytes);
+                            detail::append_r1cs_digest_combination(constraint.c, bytes);
+                            hash<Hash>(bytes.begin(), bytes.end(), acc);
+                        }
+                        block_digests[block] = detail::extract_r1cs_digest(acc);
+                    });
+
+                    std::vector<std::uint8_t> header;
+                    detail::append_r1cs_digest_size(constraint_system.primary_input_size, header);
+                    detail::append_r1cs_digest_size(constraint_system.auxiliary_input_size, header);
+                    detail::append_r1cs_digest_size(num_constraints, header);
+
+                    accumulator_set<Hash> acc;
+                    hash<Hash>(header.begin(), header.end(), acc);
+                    for (const typename Hash::digest_type &block_digest : block_digests) {
+                        hash<Hash>(block_digest.begin(), block_digest.end(), acc);
+                    }
+                    return detail::extract_r1cs_digest(acc);
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_DIGEST_HPP
@@ -0,0 +1,276 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a memory-mapped R1CS witness, streamed in by another process.
+//
+// A witness generator running as a separate process writes the variable assignment
+// (x_1, ..., x_m), primary input first, into a file of fixed binary layout: a header
+// followed by a 64-byte aligned section holding the native representation of the field
+// elements, back to back. The writer sizes the file up front and publishes, in the
+// header, how many leading elements are final, so a prover mapping the same file reads
+// every element in place, as soon as it is committed, and never copies the assignment.
+// As for the mapped proving key, the layout is tied to the build that produced it.
+//
+// A witness source is any type with num_inputs(), num_variables() and wait_for(n), the
+// latter returning a pointer to the assignment once its first n elements are available;
+// r1cs_mapped_witness is the one reading such a file.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_MAPPED_WITNESS_HPP
+#define CRYPTO3_ZK_R1CS_MAPPED_WITNESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <boost/assert.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                template<typename FieldType>
+                class r1cs_mapped_witness {
+                    typedef typename FieldType::value_type field_value_type;
+
+                    static constexpr const std::uint64_t magic = 0x5457534331524e5aULL;    // "ZNR1CSWT"
+                    static constexpr const std::uint64_t version = 1;
+                    static constexpr const std::size_t alignment = 64;
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t value_size;
+                        std::uint64_t num_inputs;
+                        std::uint64_t num_variables;
+                        std::uint64_t assignment_offset;
+                        std::uint64_t file_size;
+                        /* the number of leading elements of the assignment that are final */
+                        std::uint64_t committed;
+                    };
+
+                    static_assert(std::is_trivially_copyable<header_type>::value, "header must be trivially copyable");
+                    static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t) &&
+                                      std::atomic<std::uint64_t>::is_always_lock_free,
+                                  "the commit counter is shared by the processes mapping the file");
+
+                    static std::uint64_t align(std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    static const header_type &header(const boost::interprocess::mapped_region &region) {
+                        return *static_cast<const header_type *>(region.get_address());
+                    }
+
+                    static std::atomic<std::uint64_t> &committed(const boost::interprocess::mapped_region &region) {
+                        return *reinterpret_cast<std::atomic<std::uint64_t> *>(
+                            &static_cast<header_type *>(region.get_address())->committed);
+                    }
+
+                    /*
+                     * Checks the header, then that the assignment it announces lies in the mapping, the
+                     * number of variables being bounded by the file size before anything is multiplied.
+                     */
+                    static void check(const boost::interprocess::mapped_region &region, const std::string &path) {
+                        if (region.get_size() < sizeof(header_type)) {
+                            throw std::runtime_error("r1cs_mapped_witness: incompatible file " + path);
+                        }
+                        const header_type &h = header(region);
+                        const std::uint64_t file_size = region.get_size();
+                        if (h.magic != magic || h.version != version || h.value_size != sizeof(field_value_type) ||
+                            h.file_size != file_size || h.num_inputs > h.num_variables ||
+                            h.num_variables > file_size / sizeof(field_value_type) ||
+                            h.assignment_offset != align(sizeof(header_type)) ||
+                            align(h.assignment_offset + h.num_variables * sizeof(field_value_type)) != file_size ||
+                            committed(region).load(std::memory_order_acquire) > h.num_variables) {
+                            throw std::runtime_error("r1cs_mapped_witness: incompatible file " + path);
+                        }
+                    }
+
+                    boost::interprocess::file_mapping mapping;
+                    boost::interprocess::mapped_region region;
+
+                public:
+                    typedef FieldType field_type;
+
+                    /* How long wait_for sleeps between two looks at the commit counter. */
+                    static constexpr const std::chrono::microseconds poll_interval = std::chrono::microseconds(200);
+
+                    r1cs_mapped_witness() = default;
+                    r1cs_mapped_witness(r1cs_mapped_witness &&other) = default;
+                    r1cs_mapped_witness &operator=(r1cs_mapped_witness &&other) = default;
+
+                    /**
+                     * Maps the witness file at path, created by a writer that may still be filling it.
+                     */
+                    explicit r1cs_mapped_witness(const std::string &path) :
+                        mapping(path.c_str(), boost::interprocess::read_only),
+                        region(mapping, boost::interprocess::read_only) {
+                        check(region, path);
+                    }
+
+                    std::size_t num_inputs() const {
+                        return header(region).num_inputs;
+                    }
+
+                    std::size_t num_variables() const {
+                        return header(region).num_variables;
+                    }
+
+                    /* The number of leading elements of the assignment committed so far. */
+                    std::size_t available() const {
+                        return committed(region).load(std::memory_order_acquire);
+                    }
+
+                    bool complete() const {
+                        return available() == num_variables();
+                    }
+
+                    /**
+                     * The assignment, once its first n elements are committed. Waiting goes through the
+                     * checkpoints of the stage sink of the calling thread, so cancelling a job also
+                     * stops a prover waiting for a witness that does not come.
+                     */
+                    const field_value_type *wait_for(const std::size_t n) const {
+                        BOOST_ASSERT(n <= num_variables());
+                        while (available() < n) {
+                            stage_profiler::current_checkpoint();
+                            std::this_thread::sleep_for(poll_interval);
+                        }
+                        return reinterpret_cast<const field_value_type *>(
+                            static_cast<const char *>(region.get_address()) + header(region).assignment_offset);
+                    }
+
+                    /* The primary input, waiting for it if need be. */
+                    r1cs_primary_input_span<FieldType> primary_input() const {
+                        return r1cs_primary_input_span<FieldType>(wait_for(num_inputs()), num_inputs());
+                    }
+
+                    /* The auxiliary input, waiting for the whole witness if need be. */
+                    r1cs_auxiliary_input_span<FieldType> auxiliary_input() const {
+                        return r1cs_auxiliary_input_span<FieldType>(wait_for(num_variables()) + num_inputs(),
+                                                                    num_variables() - num_inputs());
+                    }
+
+                    /**
+                     * Writer of a witness file, run by the witness generator.
+                     *
+                     * The sizes fix the layout, so the file is created at its full size and mapped for
+                     * writing. Elements can be written in any order; commit(n) then tells the readers
+                     * that the first n are final.
+                     */
+                    class writer {
+                    public:
+                        writer(const std::string &path, const std::size_t num_inputs,
+                               const std::size_t num_variables) {
+                            static_assert(std::is_trivially_copyable<field_value_type>::value,
+                                          "field elements must be trivially copyable to be memory-mapped");
+                            BOOST_ASSERT(num_inputs <= num_variables);
+
+                            header_type h;
+                            std::memset(&h, 0, sizeof(h));
+                            h.magic = magic;
+                            h.version = version;
+                            h.value_size = sizeof(field_value_type);
+                            h.num_inputs = num_inputs;
+                            h.num_variables = num_variables;
+                            h.assignment_offset = align(sizeof(header_type));
+                            h.file_size = align(h.assignment_offset + num_variables * sizeof(field_value_type));
+
+                            {
+                                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                                out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+                                // pad the file up to its announced size
+                                out.seekp(h.file_size - 1);
+                                out.put(0);
+                                out.close();
+                                if (!out) {
+                                    throw std::runtime_error("r1cs_mapped_witness: cannot write " + path);
+                                }
+                            }
+
+                            mapping = boost::interprocess::file_mapping(path.c_str(), boost::interprocess::read_write);
+                            region = boost::interprocess::mapped_region(mapping, boost::interprocess::read_write);
+                        }
+
+                        /* Writes the elements [first, first + count) of the assignment. */
+                        void write(const std::size_t first, const field_value_type *values, const std::size_t count) {
+                            BOOST_ASSERT(first + count <= header(region).num_variables);
+                            std::memcpy(static_cast<char *>(region.get_address()) + header(region).assignment_offset +
+                                            first * sizeof(field_value_type),
+                                        values, count * sizeof(field_value_type));
+                        }
+
+                        /**
+                         * Publishes the first n elements, which have all been written. The count only
+                         * grows: readers rely on the committed elements never changing.
+                         */
+                        void commit(const std::size_t n) {
+                            BOOST_ASSERT(n <= header(region).num_variables);
+                            BOOST_ASSERT(n >= committed(region).load(std::memory_order_relaxed));
+                            committed(region).store(n, std::memory_order_release);
+                        }
+
+                        /* Writes the mapped pages back to the file. */
+                        void flush() {
+                            if (!region.flush(0, 0, false)) {
+                                throw std::runtime_error("r1cs_mapped_witness: flush failed");
+                            }
+                        }
+
+                    private:
+                        boost::interprocess::file_mapping mapping;
+                        boost::interprocess::mapped_region region;
+                    };
+
+                    /**
+                     * Writes the whole assignment primary_input || auxiliary_input to path.
+                     */
+                    static void write(const std::string &path, const r1cs_primary_input_span<FieldType> &primary_input,
+                                      const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) {
+                        writer w(path, primary_input.size(), primary_input.size() + auxiliary_input.size());
+                        w.write(0, primary_input.data(), primary_input.size());
+                        w.write(primary_input.size(), auxiliary_input.data(), auxiliary_input.size());
+                        w.commit(primary_input.size() + auxiliary_input.size());
+                        w.flush();
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_MAPPED_WITNESS_HPP
@@ -0,0 +1,402 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of an optimizer pass over R1CS constraint systems.
+//
+// The evaluation domain of the R1CS-to-QAP reduction has at least
+// num_constraints + num_inputs + 1 points, rounded up to a power of two for the radix-2
+// domains, so a system just past a power of two pays twice the FFT and H_query cost of a
+// system just below it. The pass below removes the constraints a prover does not need:
+//
+// - a constraint whose A or B side is a constant is linear; when it involves an auxiliary
+//   variable, that variable is substituted by the rest of the constraint everywhere and
+//   both the constraint and the variable are removed,
+// - a linear constraint left with constants and primary inputs only is folded: dropped when
+//   it holds for every input, kept in a normal form otherwise,
+// - constraints identical to an earlier one are removed.
+//
+// The optimized system is over the primary input of the original one and a subset of its
+// auxiliary variables; map_auxiliary_input selects that subset from an original witness.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_OPTIMIZER_HPP
+#define CRYPTO3_ZK_R1CS_OPTIMIZER_HPP
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A R1CS constraint system with its linear constraints eliminated and its duplicate
+                 * constraints removed, together with the table mapping a witness of the system it was
+                 * optimized from to a witness of the optimized one.
+                 *
+                 * The original system is satisfied by (primary_input, auxiliary_input) if and only if
+                 * the optimized system is satisfied by (primary_input, map_auxiliary_input(auxiliary_input)):
+                 * every removed variable is determined by the remaining ones through the constraint it
+                 * was eliminated with. Primary inputs are never eliminated.
+                 */
+                template<typename FieldType>
+                class r1cs_optimized_constraint_system {
+                    typedef typename FieldType::value_type field_value_type;
+
+                public:
+                    typedef FieldType field_type;
+
+                    r1cs_constraint_system<FieldType> constraint_system;
+
+                    /**
+                     * auxiliary_variables[j] is the position, in the auxiliary input of the original
+                     * system, of the j-th auxiliary variable of the optimized system.
+                     */
+                    std::vector<std::size_t> auxiliary_variables;
+
+                    std::size_t original_num_constraints;
+                    std::size_t original_auxiliary_input_size;
+
+                    r1cs_optimized_constraint_system() : original_num_constraints(0), original_auxiliary_input_size(0) {
+                    }
+
+                    /**
+                     * Optimizes cs. A variable is only eliminated when its substitution has at most
+                     * max_substitution_size terms, which bounds how much the substitutions can grow the
+                     * remaining constraints, and with them the cost of the reduction.
+                     */
+                    explicit r1cs_optimized_constraint_system(const r1cs_constraint_system<FieldType> &cs,
+                                                              const std::size_t max_substitution_size = 8) :
+                        constraint_system(cs), auxiliary_variables(cs.auxiliary_input_size),
+                        original_num_constraints(cs.num_constraints()),
+                        original_auxiliary_input_size(cs.auxiliary_input_size) {
+                        std::iota(auxiliary_variables.begin(), auxiliary_variables.end(), 0);
+
+                        constraint_system.canonicalize();
+                        /* a pass can turn quadratic constraints linear, so eliminate until none is left */
+                        while (eliminate_linear_constraints(max_substitution_size)) {
+                        }
+                        remove_duplicate_constraints();
+                    }
+
+                    /**
+                     * Auxiliary input of the optimized system from the auxiliary input of the original one.
+                     */
+                    r1cs_auxiliary_input<FieldType>
+                        map_auxiliary_input(const r1cs_auxiliary_input<FieldType> &auxiliary_input) const {
+                        BOOST_ASSERT(auxiliary_input.size() == original_auxiliary_input_size);
+
+                        r1cs_auxiliary_input<FieldType> result;
+                        result.reserve(auxiliary_variables.size());
+                        for (const std::size_t j : auxiliary_variables) {
+                            result.emplace_back(auxiliary_input[j]);
+                        }
+                        return result;
+                    }
+
+                    std::size_t num_eliminated_constraints() const {
+                        return original_num_constraints - constraint_system.num_constraints();
+                    }
+
+                    std::size_t num_eliminated_variables() const {
+                        return original_auxiliary_input_size - constraint_system.auxiliary_input_size;
+                    }
+
+                    /**
+                     * Number of points num_constraints + num_inputs + 1 the QAP evaluation domain of the
+                     * optimized system needs, and the same for the original system.
+                     */
+                    std::size_t qap_degree() const {
+                        return constraint_system.num_constraints() + constraint_system.num_inputs() + 1;
+                    }
+
+                    std::size_t original_qap_degree() const {
+                        return original_num_constraints + constraint_system.num_inputs() + 1;
+                    }
+
+                    /**
+                     * Size of the basic radix-2 QAP domain of the optimized system, the power of two
+                     * qap_degree is rounded up to. The reduction only picks that domain while the field
+                     * has a subgroup of that order; r1cs_to_qap::domain_headroom checks the domain it
+                     * actually picks.
+                     */
+                    std::size_t power_of_two_domain_size() const {
+                        std::size_t size = 1;
+                        while (size < qap_degree()) {
+                            size <<= 1;
+                        }
+                        return size;
+                    }
+
+                    /**
+                     * Number of constraints the optimized system can grow by before its basic radix-2
+                     * domain, and with it the FFT and H_query cost of the prover, doubles.
+                     */
+                    std::size_t power_of_two_headroom() const {
+                        return power_of_two_domain_size() - qap_degree();
+                    }
+
+                private:
+                    /**
+                     * Replaces the eliminated variables of lc by their substitutions until none is left.
+                     * A substitution only refers to variables that were not yet eliminated when it was
+                     * recorded, so this terminates.
+                     */
+                    static void substitute(linear_combination<FieldType> &lc,
+                                           const std::vector<linear_combination<FieldType>> &substitutions,
+                                           const std::vector<bool> &eliminated) {
+                        const auto is_eliminated = [&eliminated](const linear_term<FieldType> &term) {
+                            return eliminated[term.index];
+                        };
+                        while (std::any_of(lc.terms.begin(), lc.terms.end(), is_eliminated)) {
+                            std::vector<linear_term<FieldType>> terms;
+                            terms.reserve(lc.terms.size());
+                            for (const linear_term<FieldType> &term : lc.terms) {
+                                if (!eliminated[term.index]) {
+                                    terms.emplace_back(term);
+                                    continue;
+                                }
+                                for (const linear_term<FieldType> &substituted : substitutions[term.index].terms) {
+                                    terms.emplace_back(substituted.index, substituted.coeff * term.coeff);
+                                }
+                            }
+                            lc.terms = std::move(terms);
+                            lc.canonicalize();
+                        }
+                    }
+
+                    static bool is_constant(const linear_combination<FieldType> &lc) {
+                        return lc.terms.empty() || (lc.terms.size() == 1 && lc.terms[0].index == 0);
+                    }
+
+                    static field_value_type constant_value(const linear_combination<FieldType> &lc) {
+                        return lc.terms.empty() ? field_value_type::zero() : lc.terms[0].coeff;
+                    }
+
+                    /**
+                     * For a canonical constraint k * <B, X> = <C, X> (or <A, X> * k = <C, X>), the linear
+                     * combination k * B - C that the constraint requires to vanish.
+                     */
+                    static bool linear_form(const r1cs_constraint<FieldType> &constraint,
+                                            linear_combination<FieldType> &result) {
+                        const linear_combination<FieldType> *scaled;
+                        field_value_type k;
+                        if (is_constant(constraint.a)) {
+                            k = constant_value(constraint.a);
+                            scaled = &constraint.b;
+                        } else if (is_constant(constraint.b)) {
+                            k = constant_value(constraint.b);
+                            scaled = &constraint.a;
+                        } else {
+                            return false;
+                        }
+
+                        result.terms.clear();
+                        result.terms.reserve(scaled->terms.size() + constraint.c.terms.size());
+                        for (const linear_term<FieldType> &term : scaled->terms) {
+                            result.terms.emplace_back(term.index, k * term.coeff);
+                        }
+                        for (const linear_term<FieldType> &term : constraint.c.terms) {
+                            result.terms.emplace_back(term.index, -term.coeff);
+                        }
+                        result.canonicalize();
+                        return true;
+                    }
+
+                    /**
+                     * Folds a linear constraint lc = 0 on constants and primary inputs only, such as 2 * 3 = 6,
+                     * or a constraint whose auxiliary variables were all substituted by constants. It is
+                     * dropped when lc is zero, as it then holds for every input. Otherwise it is kept as
+                     * 1 * lc = 0, scaled so that its last coefficient is one: the constraints that differ
+                     * by a factor become duplicates, and so do all the constant ones, which fail, and
+                     * become 1 * 1 = 0.
+                     */
+                    static void fold_constant_constraint(linear_combination<FieldType> &lc,
+                                                         std::vector<r1cs_constraint<FieldType>> &constraints) {
+                        if (lc.terms.empty()) {
+                            return;
+                        }
+                        const field_value_type scale = lc.terms.back().coeff.inversed();
+                        for (linear_term<FieldType> &term : lc.terms) {
+                            term.coeff *= scale;
+                        }
+                        constraints.emplace_back(linear_combination<FieldType>(field_value_type::one()), lc,
+                                                 linear_combination<FieldType>());
+                    }
+
+                    /**
+                     * One pass over the constraints in order, eliminating an auxiliary variable through
+                     * every linear constraint that has one with a small enough substitution, then
+                     * renumbering the remaining variables. Returns whether any variable was eliminated.
+                     */
+                    bool eliminate_linear_constraints(const std::size_t max_substitution_size) {
+                        const std::size_t num_inputs = constraint_system.num_inputs();
+                        const std::size_t num_variables = constraint_system.num_variables();
+
+                        std::vector<linear_combination<FieldType>> substitutions(num_variables + 1);
+                        std::vector<bool> eliminated(num_variables + 1, false);
+                        std::size_t num_eliminated = 0;
+
+                        std::vector<r1cs_constraint<FieldType>> constraints;
+                        constraints.reserve(constraint_system.constraints.size());
+                        linear_combination<FieldType> lc;
+                        for (r1cs_constraint<FieldType> &constraint : constraint_system.constraints) {
+                            substitute(constraint.a, substitutions, eliminated);
+                            substitute(constraint.b, substitutions, eliminated);
+                            substitute(constraint.c, substitutions, eliminated);
+
+                            if (!linear_form(constraint, lc)) {
+                                constraints.emplace_back(std::move(constraint));
+                                continue;
+                            }
+
+                            /* the terms are sorted, so this is the last auxiliary variable of lc */
+                            auto pivot = lc.terms.end();
+                            if (!lc.terms.empty() && lc.terms.back().index > num_inputs) {
+                                pivot = lc.terms.end() - 1;
+                            }
+                            if (pivot == lc.terms.end()) {
+                                fold_constant_constraint(lc, constraints);
+                                continue;
+                            }
+                            if (lc.terms.size() - 1 > max_substitution_size) {
+                                constraints.emplace_back(std::move(constraint));
+                                continue;
+                            }
+
+                            /* x_p = -(1 / c_p) * (lc - c_p * x_p) */
+                            const var_index_t index = pivot->index;
+                            const field_value_type scale = -pivot->coeff.inversed();
+                            lc.terms.erase(pivot);
+                            for (linear_term<FieldType> &term : lc.terms) {
+                                term.coeff *= scale;
+                            }
+                            substitutions[index] = lc;
+                            eliminated[index] = true;
+                            ++num_eliminated;
+                        }
+                        constraint_system.constraints = std::move(constraints);
+
+                        if (num_eliminated == 0) {
+                            return false;
+                        }
+
+                        std::vector<var_index_t> renumbered(num_variables + 1);
+                        std::vector<std::size_t> remaining_auxiliary_variables;
+                        remaining_auxiliary_variables.reserve(auxiliary_variables.size() - num_eliminated);
+                        var_index_t next_index = 0;
+                        for (std::size_t i = 0; i <= num_variables; ++i) {
+                            if (eliminated[i]) {
+                                continue;
+                            }
+                            renumbered[i] = next_index++;
+                            if (i > num_inputs) {
+                                remaining_auxiliary_variables.emplace_back(auxiliary_variables[i - num_inputs - 1]);
+                            }
+                        }
+
+                        /* constraints kept before a later elimination may still refer to its variable */
+                        for (r1cs_constraint<FieldType> &constraint : constraint_system.constraints) {
+                            for (linear_combination<FieldType> *side : {&constraint.a, &constraint.b, &constraint.c}) {
+                                substitute(*side, substitutions, eliminated);
+                                for (linear_term<FieldType> &term : side->terms) {
+                                    term.index = renumbered[term.index];
+                                }
+                            }
+                        }
+
+                        auxiliary_variables = std::move(remaining_auxiliary_variables);
+                        constraint_system.auxiliary_input_size = auxiliary_variables.size();
+                        return true;
+                    }
+
+                    /**
+                     * Removes every constraint equal to an earlier one. Constraints are grouped by the
+                     * variables they refer to first, so only constraints of a group are compared.
+                     */
+                    void remove_duplicate_constraints() {
+                        const std::vector<r1cs_constraint<FieldType>> &constraints = constraint_system.constraints;
+
+                        const auto indices_less = [](const linear_combination<FieldType> &x,
+                                                     const linear_combination<FieldType> &y) {
+                            return std::lexicographical_compare(
+                                x.terms.begin(), x.terms.end(), y.terms.begin(), y.terms.end(),
+                                [](const linear_term<FieldType> &s, const linear_term<FieldType> &t) {
+                                    return s.index < t.index;
+                                });
+                        };
+                        const auto structure_less = [&](const std::size_t i, const std::size_t j) {
+                            const r1cs_constraint<FieldType> &x = constraints[i], &y = constraints[j];
+                            if (indices_less(x.a, y.a) || indices_less(y.a, x.a)) {
+                                return indices_less(x.a, y.a);
+                            }
+                            if (indices_less(x.b, y.b) || indices_less(y.b, x.b)) {
+                                return indices_less(x.b, y.b);
+                            }
+                            return indices_less(x.c, y.c);
+                        };
+
+                        std::vector<std::size_t> order(constraints.size());
+                        std::iota(order.begin(), order.end(), 0);
+                        std::stable_sort(order.begin(), order.end(), structure_less);
+
+                        std::vector<bool> duplicate(constraints.size(), false);
+                        for (std::size_t group_begin = 0, group_end; group_begin < order.size();
+                             group_begin = group_end) {
+                            for (group_end = group_begin + 1; group_end < order.size() &&
+                                                              !structure_less(order[group_begin], order[group_end]);
+                                 ++group_end) {
+                            }
+                            /* the sort is stable, so the first of equal constraints is kept */
+                            for (std::size_t i = group_begin; i < group_end; ++i) {
+                                for (std::size_t j = i + 1; j < group_end && !duplicate[order[i]]; ++j) {
+                                    if (!duplicate[order[j]] && constraints[order[i]] == constraints[order[j]]) {
+                                        duplicate[order[j]] = true;
+                                    }
+                                }
+                            }
+                        }
+
+                        std::vector<r1cs_constraint<FieldType>> unique_constraints;
+                        unique_constraints.reserve(constraints.size());
+                        for (std::size_t i = 0; i < constraints.size(); ++i) {
+                            if (!duplicate[i]) {
+                                unique_constraints.emplace_back(constraints[i]);
+                            }
+                        }
+                        constraint_system.constraints = std::move(unique_constraints);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_OPTIMIZER_HPP
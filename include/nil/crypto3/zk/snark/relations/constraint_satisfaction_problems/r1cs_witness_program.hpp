@@ -0,0 +1,408 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of interfaces for a R1CS witness evaluation program.
+//
+// A witness evaluation program is a compiled form of a R1CS constraint system:
+// the A, B and C matrices stored in compressed sparse row (CSR) layout. It holds
+// exactly what the witness map needs (the matrices and the input/variable counts)
+// and evaluates every constraint as a row of a sparse matrix-vector product.
+//
+// Each matrix keeps all of its indices and all of its coefficients in two
+// contiguous arrays, instead of one heap-allocated term vector per linear
+// combination, so the program also serves as a columnar constraint system:
+// constraints are appended to it and read back through the r1cs_constraint_system
+// interface.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_WITNESS_PROGRAM_HPP
+#define CRYPTO3_ZK_R1CS_WITNESS_PROGRAM_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <numeric>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A sparse matrix in compressed sparse row layout.
+                 *
+                 * Row i holds the entries [row_offsets[i], row_offsets[i + 1]) of columns and
+                 * coefficients. Column 0 stands for the constant 1, column k > 0 for the variable x_k.
+                 */
+                template<typename FieldType>
+                struct r1cs_sparse_matrix {
+                    typedef FieldType field_type;
+                    typedef typename FieldType::value_type field_value_type;
+
+                    std::vector<std::size_t> row_offsets;
+                    std::vector<std::size_t> columns;
+                    std::vector<field_value_type> coefficients;
+
+                    r1cs_sparse_matrix() : row_offsets(1, 0) {
+                    }
+
+                    std::size_t num_rows() const {
+                        return row_offsets.size() - 1;
+                    }
+
+                    std::size_t num_entries() const {
+                        return columns.size();
+                    }
+
+                    template<typename Allocator>
+                    void add_row(const linear_combination<FieldType, Allocator> &lc) {
+                        for (const linear_term<FieldType> &term : lc.terms) {
+                            columns.emplace_back(term.index);
+                            coefficients.emplace_back(term.coeff);
+                        }
+                        row_offsets.emplace_back(columns.size());
+                    }
+
+                    /**
+                     * Row i as a linear combination.
+                     */
+                    linear_combination<FieldType> row(const std::size_t row) const {
+                        linear_combination<FieldType> result;
+                        result.terms.reserve(row_offsets[row + 1] - row_offsets[row]);
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            result.terms.emplace_back(variable<FieldType>(columns[k]), coefficients[k]);
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Whether the columns of row i are strictly increasing and below num_variables, as
+                     * linear_combination::is_valid checks for its terms.
+                     */
+                    bool is_valid_row(const std::size_t row, const std::size_t num_variables) const {
+                        for (std::size_t k = row_offsets[row] + 1; k < row_offsets[row + 1]; ++k) {
+                            if (columns[k - 1] >= columns[k]) {
+                                return false;
+                            }
+                        }
+                        return row_offsets[row] == row_offsets[row + 1] ||
+                               columns[row_offsets[row + 1] - 1] < num_variables;
+                    }
+
+                    /**
+                     * Evaluates row i on the assignment (x_1, ..., x_m), the constant 1 being implicit.
+                     * Entries with coefficient 1 or -1 need no multiplication.
+                     */
+                    field_value_type evaluate_row(const std::size_t row,
+                                                  const r1cs_variable_assignment_span<FieldType> &assignment) const {
+                        const field_value_type one = field_value_type::one();
+                        const field_value_type minus_one = -one;
+                        field_value_type acc = field_value_type::zero();
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            if (columns[k] == 0) {
+                                acc += coefficients[k];
+                            } else if (coefficients[k] == one) {
+                                acc += assignment[columns[k] - 1];
+                            } else if (coefficients[k] == minus_one) {
+                                acc -= assignment[columns[k] - 1];
+                            } else {
+                                acc += assignment[columns[k] - 1] * coefficients[k];
+                            }
+                        }
+                        return acc;
+                    }
+
+                    /**
+                     * Same as evaluate_row on the assignment first_part || second_part, without
+                     * concatenating the two parts.
+                     */
+                    field_value_type evaluate_row(const std::size_t row,
+                                                  const r1cs_variable_assignment_span<FieldType> &first_part,
+                                                  const r1cs_variable_assignment_span<FieldType> &second_part) const {
+                        const field_value_type one = field_value_type::one();
+                        const field_value_type minus_one = -one;
+                        field_value_type acc = field_value_type::zero();
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            if (columns[k] == 0) {
+                                acc += coefficients[k];
+                                continue;
+                            }
+                            const field_value_type &value = columns[k] <= first_part.size() ?
+                                                                first_part[columns[k] - 1] :
+                                                                second_part[columns[k] - 1 - first_part.size()];
+                            if (coefficients[k] == one) {
+                                acc += value;
+                            } else if (coefficients[k] == minus_one) {
+                                acc -= value;
+                            } else {
+                                acc += value * coefficients[k];
+                            }
+                        }
+                        return acc;
+                    }
+
+                    /**
+                     * Dot product of row i with values, column k standing for values[k].
+                     */
+                    field_value_type dot_row(const std::size_t row, const std::vector<field_value_type> &values) const {
+                        field_value_type acc = field_value_type::zero();
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            acc += values[columns[k]] * coefficients[k];
+                        }
+                        return acc;
+                    }
+
+                    /**
+                     * The matrix with its rows and columns exchanged, num_columns being the number of
+                     * columns of this matrix. Row k of the result lists the rows of this matrix with an
+                     * entry in column k, in increasing order.
+                     */
+                    r1cs_sparse_matrix transposed(const std::size_t num_columns) const {
+                        return column_major(num_rows(), num_columns, [this](const std::size_t row, auto &&f) {
+                            for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                                f(columns[k], coefficients[k]);
+                            }
+                        });
+                    }
+
+                    /**
+                     * The matrix of num_rows rows, whose row i has the entries for_each_entry(i, f) passes to
+                     * f(column, coefficient), in column-major layout, num_columns being its number of columns:
+                     * row k of the result lists the rows with an entry in column k, in increasing order.
+                     */
+                    template<typename ForEachEntry>
+                    static r1cs_sparse_matrix column_major(const std::size_t num_rows, const std::size_t num_columns,
+                                                           ForEachEntry for_each_entry) {
+                        r1cs_sparse_matrix result;
+                        result.row_offsets.assign(num_columns + 1, 0);
+                        for (std::size_t row = 0; row < num_rows; ++row) {
+                            for_each_entry(row, [&](const std::size_t column, const field_value_type &) {
+                                ++result.row_offsets[column + 1];
+                            });
+                        }
+                        std::partial_sum(result.row_offsets.begin(), result.row_offsets.end(),
+                                         result.row_offsets.begin());
+
+                        result.columns.resize(result.row_offsets.back());
+                        result.coefficients.resize(result.row_offsets.back());
+                        std::vector<std::size_t> next(result.row_offsets.begin(), result.row_offsets.end() - 1);
+                        for (std::size_t row = 0; row < num_rows; ++row) {
+                            for_each_entry(row, [&](const std::size_t column, const field_value_type &coefficient) {
+                                const std::size_t position = next[column]++;
+                                result.columns[position] = row;
+                                result.coefficients[position] = coefficient;
+                            });
+                        }
+
+                        return result;
+                    }
+
+                    bool operator==(const r1cs_sparse_matrix &other) const {
+                        return row_offsets == other.row_offsets && columns == other.columns &&
+                               coefficients == other.coefficients;
+                    }
+                };
+
+                /**
+                 * The matrix of the linear combinations cs.constraints[i].*side in column-major layout,
+                 * see r1cs_sparse_matrix::column_major.
+                 */
+                template<typename FieldType>
+                r1cs_sparse_matrix<FieldType>
+                    column_major(const r1cs_constraint_system<FieldType> &cs,
+                                 linear_combination<FieldType> r1cs_constraint<FieldType>::*side,
+                                 const std::size_t num_columns) {
+                    return r1cs_sparse_matrix<FieldType>::column_major(
+                        cs.num_constraints(), num_columns, [&](const std::size_t i, auto &&f) {
+                            for (const linear_term<FieldType> &term : (cs.constraints[i].*side).terms) {
+                                f(term.index, term.coeff);
+                            }
+                        });
+                }
+
+                /**
+                 * A R1CS constraint system compiled into its A, B and C matrices.
+                 *
+                 * It exposes the r1cs_constraint_system interface (num_inputs, num_variables,
+                 * num_constraints, is_valid, is_satisfied, add_constraint and the A/B swap), so it can
+                 * stand in for the constraint system of a proving key, and be built constraint by
+                 * constraint without one allocation per linear combination.
+                 */
+                template<typename FieldType>
+                struct r1cs_witness_program {
+                    typedef FieldType field_type;
+
+                    std::size_t primary_input_size;
+                    std::size_t auxiliary_input_size;
+
+                    r1cs_sparse_matrix<FieldType> a, b, c;
+
+                    r1cs_witness_program() : primary_input_size(0), auxiliary_input_size(0) {
+                    }
+
+                    /**
+                     * The program of cs, whatever the allocator of cs, so that a system built in the arena
+                     * of a request compiles directly into a program with the default allocator.
+                     */
+                    template<typename Allocator>
+                    r1cs_witness_program(const r1cs_constraint_system<FieldType, Allocator> &cs) :
+                        primary_input_size(cs.primary_input_size), auxiliary_input_size(cs.auxiliary_input_size) {
+                        a.row_offsets.reserve(cs.num_constraints() + 1);
+                        b.row_offsets.reserve(cs.num_constraints() + 1);
+                        c.row_offsets.reserve(cs.num_constraints() + 1);
+
+                        for (const auto &constraint : cs.constraints) {
+                            a.add_row(constraint.a);
+                            b.add_row(constraint.b);
+                            c.add_row(constraint.c);
+                        }
+                    }
+
+                    std::size_t num_inputs() const {
+                        return primary_input_size;
+                    }
+
+                    std::size_t num_variables() const {
+                        return primary_input_size + auxiliary_input_size;
+                    }
+
+                    std::size_t num_constraints() const {
+                        return a.num_rows();
+                    }
+
+                    /**
+                     * Constraint i, rebuilt from the rows of the matrices.
+                     */
+                    r1cs_constraint<FieldType> constraint(const std::size_t i) const {
+                        return r1cs_constraint<FieldType>(a.row(i), b.row(i), c.row(i));
+                    }
+
+                    /**
+                     * The constraint system the program stands for.
+                     */
+                    r1cs_constraint_system<FieldType> to_constraint_system() const {
+                        r1cs_constraint_system<FieldType> result;
+                        result.primary_input_size = primary_input_size;
+                        result.auxiliary_input_size = auxiliary_input_size;
+                        result.constraints.reserve(num_constraints());
+                        for (std::size_t i = 0; i < num_constraints(); ++i) {
+                            result.constraints.emplace_back(constraint(i));
+                        }
+                        return result;
+                    }
+
+                    template<typename Allocator>
+                    void add_constraint(const r1cs_constraint<FieldType, Allocator> &constraint) {
+                        a.add_row(constraint.a);
+                        b.add_row(constraint.b);
+                        c.add_row(constraint.c);
+                    }
+
+                    /**
+                     * Reserves room for num_constraints constraints of num_entries terms per matrix.
+                     */
+                    void reserve(const std::size_t num_constraints, const std::size_t num_entries) {
+                        for (r1cs_sparse_matrix<FieldType> *matrix : {&a, &b, &c}) {
+                            matrix->row_offsets.reserve(num_constraints + 1);
+                            matrix->columns.reserve(num_entries);
+                            matrix->coefficients.reserve(num_entries);
+                        }
+                    }
+
+                    bool is_valid() const {
+                        if (this->num_inputs() > this->num_variables()) {
+                            return false;
+                        }
+
+                        for (std::size_t i = 0; i < num_constraints(); ++i) {
+                            if (!(a.is_valid_row(i, this->num_variables()) &&
+                                  b.is_valid_row(i, this->num_variables()) &&
+                                  c.is_valid_row(i, this->num_variables()))) {
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                    bool is_satisfied(const r1cs_primary_input_span<FieldType> &primary_input,
+                                      const r1cs_auxiliary_input_span<FieldType> &auxiliary_input) const {
+                        assert(primary_input.size() == num_inputs());
+                        assert(primary_input.size() + auxiliary_input.size() == num_variables());
+
+                        for (std::size_t i = 0; i < num_constraints(); ++i) {
+                            if (!(a.evaluate_row(i, primary_input, auxiliary_input) *
+                                      b.evaluate_row(i, primary_input, auxiliary_input) ==
+                                  c.evaluate_row(i, primary_input, auxiliary_input))) {
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                    /**
+                     * Whether exchanging the A and B matrices makes B touch fewer variables, see
+                     * r1cs_constraint_system::is_AB_swap_beneficial.
+                     */
+                    bool is_AB_swap_beneficial() const {
+                        std::vector<bool> touched_by_A(this->num_variables() + 1, false),
+                            touched_by_B(this->num_variables() + 1, false);
+
+                        for (const std::size_t column : a.columns) {
+                            touched_by_A[column] = true;
+                        }
+                        for (const std::size_t column : b.columns) {
+                            touched_by_B[column] = true;
+                        }
+
+                        return std::count(touched_by_B.begin(), touched_by_B.end(), true) >
+                               std::count(touched_by_A.begin(), touched_by_A.end(), true);
+                    }
+
+                    void swap_AB() {
+                        std::swap(a, b);
+                    }
+
+                    void swap_AB_if_beneficial() {
+                        if (is_AB_swap_beneficial()) {
+                            swap_AB();
+                        }
+                    }
+
+                    bool operator==(const r1cs_witness_program &other) const {
+                        return (this->a == other.a && this->b == other.b && this->c == other.c &&
+                                this->primary_input_size == other.primary_input_size &&
+                                this->auxiliary_input_size == other.auxiliary_input_size);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_WITNESS_PROGRAM_HPP
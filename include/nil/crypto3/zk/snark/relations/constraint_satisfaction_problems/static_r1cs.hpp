@@ -0,0 +1,289 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of R1CS constraint systems whose sizes are fixed at compile time.
+//
+// Gadgets such as a single hash compression or a range check have a handful of
+// constraints, fixed by the gadget. For them the heap-allocated term vectors of
+// r1cs_constraint_system cost more than the arithmetic: every linear combination is an
+// allocation of its own, and evaluating a constraint chases a pointer per side.
+//
+// static_r1cs_constraint_system takes the number of constraints, of primary and
+// auxiliary inputs and the capacity of its matrices as template parameters. The A, B and
+// C matrices are kept in compressed sparse row layout, as in r1cs_witness_program.hpp, but
+// in std::arrays, and assignments are std::arrays too, so satisfaction checks and the
+// evaluations of the witness map run over fixed trip counts without any allocation. The
+// size of the QAP domain is a compile-time constant, which lets the reduction build the
+// domain once per system type, see r1cs_to_qap.hpp.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_STATIC_R1CS_HPP
+#define CRYPTO3_ZK_STATIC_R1CS_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A sparse matrix of NumRows rows and at most MaxEntries entries in compressed sparse
+                 * row layout, with the same conventions as r1cs_sparse_matrix: row i holds the entries
+                 * [row_offsets[i], row_offsets[i + 1]), column 0 stands for the constant 1.
+                 */
+                template<typename FieldType, std::size_t NumRows, std::size_t MaxEntries>
+                struct static_r1cs_sparse_matrix {
+                    typedef FieldType field_type;
+                    typedef typename FieldType::value_type field_value_type;
+
+                    std::array<std::size_t, NumRows + 1> row_offsets;
+                    std::array<std::size_t, MaxEntries> columns;
+                    std::array<field_value_type, MaxEntries> coefficients;
+                    /* the rows [0, num_rows_set) are set */
+                    std::size_t num_rows_set;
+
+                    static_r1cs_sparse_matrix() : row_offsets(), columns(), coefficients(), num_rows_set(0) {
+                    }
+
+                    static constexpr std::size_t num_rows() {
+                        return NumRows;
+                    }
+
+                    std::size_t num_entries() const {
+                        return row_offsets[NumRows];
+                    }
+
+                    /**
+                     * Sets row i to lc. Rows are set in increasing order, each once. Throws
+                     * std::out_of_range for a row past NumRows or out of order, and std::length_error when
+                     * the terms overflow MaxEntries.
+                     */
+                    void set_row(const std::size_t row, const linear_combination<FieldType> &lc) {
+                        if (row >= NumRows || row != num_rows_set) {
+                            throw std::out_of_range("static_r1cs_sparse_matrix: rows must be set in order");
+                        }
+                        if (lc.terms.size() > MaxEntries - row_offsets[row]) {
+                            throw std::length_error("static_r1cs_sparse_matrix: more than MaxEntries terms");
+                        }
+
+                        std::size_t k = row_offsets[row];
+                        for (const linear_term<FieldType> &term : lc.terms) {
+                            columns[k] = term.index;
+                            coefficients[k] = term.coeff;
+                            ++k;
+                        }
+                        row_offsets[row + 1] = k;
+                        ++num_rows_set;
+                    }
+
+                    linear_combination<FieldType> row(const std::size_t row) const {
+                        check_row(row);
+                        linear_combination<FieldType> result;
+                        result.terms.reserve(row_offsets[row + 1] - row_offsets[row]);
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            result.terms.emplace_back(variable<FieldType>(columns[k]), coefficients[k]);
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Evaluates row i on the assignment (x_1, ..., x_m), the constant 1 being implicit.
+                     * Assignment is any container indexed from 0, a std::array or a std::vector.
+                     */
+                    template<typename Assignment>
+                    field_value_type evaluate_row(const std::size_t row, const Assignment &assignment) const {
+                        check_row(row);
+                        const field_value_type one = field_value_type::one();
+                        const field_value_type minus_one = -one;
+                        field_value_type acc = field_value_type::zero();
+                        for (std::size_t k = row_offsets[row]; k < row_offsets[row + 1]; ++k) {
+                            if (columns[k] == 0) {
+                                acc += coefficients[k];
+                            } else if (coefficients[k] == one) {
+                                acc += assignment[columns[k] - 1];
+                            } else if (coefficients[k] == minus_one) {
+                                acc -= assignment[columns[k] - 1];
+                            } else {
+                                acc += assignment[columns[k] - 1] * coefficients[k];
+                            }
+                        }
+                        return acc;
+                    }
+
+                    /* Throws std::out_of_range for a row past NumRows; the rows not set yet are empty. */
+                    static void check_row(const std::size_t row) {
+                        if (row >= NumRows) {
+                            throw std::out_of_range("static_r1cs_sparse_matrix: row out of range");
+                        }
+                    }
+                };
+
+                /**
+                 * A R1CS constraint system of NumConstraints constraints over PrimaryInputSize primary
+                 * and AuxiliaryInputSize auxiliary variables, each of the A, B and C matrices holding at
+                 * most MaxEntries terms.
+                 *
+                 * It is built from an r1cs_constraint_system of these sizes, typically the one a gadget
+                 * generates, and converts back with to_constraint_system for the key generator. The sizes
+                 * and the variable indices of the system are checked when it is built, so the evaluations
+                 * only index assignments of num_variables() values.
+                 */
+                template<typename FieldType,
+                         std::size_t NumConstraints,
+                         std::size_t PrimaryInputSize,
+                         std::size_t AuxiliaryInputSize,
+                         std::size_t MaxEntries>
+                class static_r1cs_constraint_system {
+                    typedef typename FieldType::value_type field_value_type;
+
+                public:
+                    typedef FieldType field_type;
+                    typedef static_r1cs_sparse_matrix<FieldType, NumConstraints, MaxEntries> matrix_type;
+
+                    typedef std::array<field_value_type, PrimaryInputSize> primary_input_type;
+                    typedef std::array<field_value_type, AuxiliaryInputSize> auxiliary_input_type;
+                    typedef std::array<field_value_type, PrimaryInputSize + AuxiliaryInputSize>
+                        variable_assignment_type;
+
+                    /**
+                     * Number of points num_constraints + num_inputs + 1 of the QAP evaluation domain, and
+                     * the power of two it is rounded up to by the radix-2 domains.
+                     */
+                    static constexpr std::size_t qap_degree = NumConstraints + PrimaryInputSize + 1;
+
+                    static constexpr std::size_t power_of_two_domain_size() {
+                        std::size_t size = 1;
+                        while (size < qap_degree) {
+                            size <<= 1;
+                        }
+                        return size;
+                    }
+
+                    matrix_type a, b, c;
+
+                    static_r1cs_constraint_system() = default;
+
+                    explicit static_r1cs_constraint_system(const r1cs_constraint_system<FieldType> &cs) {
+                        if (cs.num_constraints() != NumConstraints || cs.primary_input_size != PrimaryInputSize ||
+                            cs.auxiliary_input_size != AuxiliaryInputSize) {
+                            throw std::invalid_argument("static_r1cs_constraint_system: the sizes of the system "
+                                                        "are not those of the type");
+                        }
+                        for (const r1cs_constraint<FieldType> &constraint : cs.constraints) {
+                            check_variables(constraint.a);
+                            check_variables(constraint.b);
+                            check_variables(constraint.c);
+                        }
+
+                        for (std::size_t i = 0; i < NumConstraints; ++i) {
+                            a.set_row(i, cs.constraints[i].a);
+                            b.set_row(i, cs.constraints[i].b);
+                            c.set_row(i, cs.constraints[i].c);
+                        }
+                    }
+
+                    static constexpr std::size_t num_constraints() {
+                        return NumConstraints;
+                    }
+
+                    static constexpr std::size_t num_inputs() {
+                        return PrimaryInputSize;
+                    }
+
+                    static constexpr std::size_t num_variables() {
+                        return PrimaryInputSize + AuxiliaryInputSize;
+                    }
+
+                    static variable_assignment_type
+                        full_variable_assignment(const primary_input_type &primary_input,
+                                                 const auxiliary_input_type &auxiliary_input) {
+                        variable_assignment_type result;
+                        for (std::size_t i = 0; i < PrimaryInputSize; ++i) {
+                            result[i] = primary_input[i];
+                        }
+                        for (std::size_t i = 0; i < AuxiliaryInputSize; ++i) {
+                            result[PrimaryInputSize + i] = auxiliary_input[i];
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Whether constraint holds on assignment, which has num_variables() values. Throws
+                     * std::invalid_argument for an assignment of another size.
+                     */
+                    template<typename Assignment>
+                    bool is_satisfied(const std::size_t constraint, const Assignment &assignment) const {
+                        if (assignment.size() != num_variables()) {
+                            throw std::invalid_argument("static_r1cs_constraint_system: wrong assignment size");
+                        }
+                        return a.evaluate_row(constraint, assignment) * b.evaluate_row(constraint, assignment) ==
+                               c.evaluate_row(constraint, assignment);
+                    }
+
+                    bool is_satisfied(const primary_input_type &primary_input,
+                                      const auxiliary_input_type &auxiliary_input) const {
+                        const variable_assignment_type assignment =
+                            full_variable_assignment(primary_input, auxiliary_input);
+                        for (std::size_t i = 0; i < NumConstraints; ++i) {
+                            if (!is_satisfied(i, assignment)) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    /**
+                     * The same system as an r1cs_constraint_system, for the key generator.
+                     */
+                    r1cs_constraint_system<FieldType> to_constraint_system() const {
+                        r1cs_constraint_system<FieldType> result;
+                        result.primary_input_size = PrimaryInputSize;
+                        result.auxiliary_input_size = AuxiliaryInputSize;
+                        result.constraints.reserve(NumConstraints);
+                        for (std::size_t i = 0; i < NumConstraints; ++i) {
+                            result.add_constraint(r1cs_constraint<FieldType>(a.row(i), b.row(i), c.row(i)));
+                        }
+                        return result;
+                    }
+
+                private:
+                    static void check_variables(const linear_combination<FieldType> &lc) {
+                        for (const linear_term<FieldType> &term : lc.terms) {
+                            if (term.index > num_variables()) {
+                                throw std::out_of_range("static_r1cs_constraint_system: variable out of range");
+                            }
+                        }
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_STATIC_R1CS_HPP
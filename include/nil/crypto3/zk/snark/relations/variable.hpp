@@ -26,16 +26,26 @@
 // - a variable (i.e., x_i),
 // - a linear term (i.e., a_i * x_i), and
 // - a linear combination (i.e., sum_i a_i * x_i).
+//
+// A linear combination keeps its terms with the allocator it is given, std::allocator by
+// default; pmr::linear_combination takes them from a std::pmr::memory_resource, such as the
+// memory_arena of a request, see memory_arena.hpp.
 //---------------------------------------------------------------------------//
 
 #ifndef CRYPTO3_ZK_VARIABLE_HPP
 #define CRYPTO3_ZK_VARIABLE_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <nil/crypto3/zk/snark/input_span.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -56,8 +66,8 @@ namespace nil {
                 /**
                  * Forward declaration.
                  */
-                template<typename FieldType>
-                struct linear_combination;
+                template<typename FieldType, typename Allocator = std::allocator<linear_term<FieldType>>>
+                class linear_combination;
 
                 /********************************* Variable **********************************/
 
@@ -226,16 +236,33 @@ namespace nil {
 
                 /**
                  * A linear combination represents a formal expression of the form "sum_i coeff_i * x_{index_i}".
+                 *
+                 * The terms are allocated with Allocator. The arithmetic operators give their results
+                 * the allocator of the left operand, and the constructors taking an allocator are used
+                 * by the containers of constraints that propagate theirs, as std::pmr containers do.
                  */
-                template<typename FieldType>
+                template<typename FieldType, typename Allocator>
                 class linear_combination {
                     typedef FieldType field_type;
                     typedef typename field_type::value_type field_value_type;
 
                 public:
-                    std::vector<linear_term<FieldType>> terms;
+                    typedef Allocator allocator_type;
+                    typedef std::vector<linear_term<FieldType>, Allocator> terms_type;
+
+                    terms_type terms;
 
                     linear_combination() {};
+                    explicit linear_combination(const allocator_type &allocator) : terms(allocator) {
+                    }
+                    template<typename OtherAllocator>
+                    linear_combination(const linear_combination<FieldType, OtherAllocator> &other,
+                                       const allocator_type &allocator) :
+                        terms(other.terms.begin(), other.terms.end(), allocator) {
+                    }
+                    linear_combination(linear_combination &&other, const allocator_type &allocator) :
+                        terms(std::move(other.terms), allocator) {
+                    }
                     linear_combination(const integer_coeff_t int_coeff) {
                         this->add_term(linear_term<FieldType>(0, int_coeff));
                     }
@@ -253,7 +280,7 @@ namespace nil {
                             return;
                         }
 
-                        terms = all_terms;
+                        terms.assign(all_terms.begin(), all_terms.end());
                         std::sort(terms.begin(), terms.end(),
                                   [](linear_term<FieldType> a, linear_term<FieldType> b) { return a.index < b.index; });
 
@@ -269,14 +296,18 @@ namespace nil {
                     }
 
                     /* for supporting range-based for loops over linear_combination */
-                    typename std::vector<linear_term<FieldType>>::const_iterator begin() const {
+                    typename terms_type::const_iterator begin() const {
                         return terms.begin();
                     }
 
-                    typename std::vector<linear_term<FieldType>>::const_iterator end() const {
+                    typename terms_type::const_iterator end() const {
                         return terms.end();
                     }
 
+                    allocator_type get_allocator() const {
+                        return terms.get_allocator();
+                    }
+
                     void add_term(const variable<FieldType> &var) {
                         this->terms.emplace_back(linear_term<FieldType>(var.index, field_value_type::one()));
                     }
@@ -290,10 +321,89 @@ namespace nil {
                         this->terms.emplace_back(lt);
                     }
 
-                    field_value_type evaluate(const std::vector<field_value_type> &assignment) const {
+                    /**
+                     * Sorts the terms by index, merges the terms of the same variable and drops the
+                     * terms whose coefficient is zero, which leaves the terms is_valid expects.
+                     */
+                    void canonicalize() {
+                        const auto by_index = [](const linear_term<FieldType> &a, const linear_term<FieldType> &b) {
+                            return a.index < b.index;
+                        };
+                        if (!std::is_sorted(terms.begin(), terms.end(), by_index)) {
+                            std::stable_sort(terms.begin(), terms.end(), by_index);
+                        }
+
+                        auto result_it = terms.begin();
+                        for (auto it = terms.begin(); it != terms.end();) {
+                            const var_index_t index = it->index;
+                            field_value_type coeff = it->coeff;
+                            for (++it; it != terms.end() && it->index == index; ++it) {
+                                coeff += it->coeff;
+                            }
+                            if (!coeff.is_zero()) {
+                                result_it->index = index;
+                                result_it->coeff = coeff;
+                                ++result_it;
+                            }
+                        }
+                        terms.erase(result_it, terms.end());
+                    }
+
+                    /**
+                     * Whether the terms are sorted by strictly increasing index and none of their
+                     * coefficients is zero.
+                     */
+                    bool is_canonical() const {
+                        for (std::size_t i = 0; i < terms.size(); ++i) {
+                            if (terms[i].coeff.is_zero() || (i > 0 && terms[i - 1].index >= terms[i].index)) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    /**
+                     * Terms with coefficient 1 or -1, as canonical constraints mostly have, are added
+                     * or subtracted without a multiplication.
+                     */
+                    field_value_type evaluate(const input_span<field_value_type> &assignment) const {
+                        const field_value_type one = field_value_type::one();
+                        const field_value_type minus_one = -one;
                         field_value_type acc = field_value_type::zero();
                         for (auto &lt : terms) {
-                            acc += (lt.index == 0 ? field_value_type::one() : assignment[lt.index - 1]) * lt.coeff;
+                            const field_value_type &value = lt.index == 0 ? one : assignment[lt.index - 1];
+                            if (lt.coeff == one) {
+                                acc += value;
+                            } else if (lt.coeff == minus_one) {
+                                acc -= value;
+                            } else {
+                                acc += value * lt.coeff;
+                            }
+                        }
+                        return acc;
+                    }
+
+                    /**
+                     * Same as evaluate on the assignment (x_1, ..., x_m) = first_part || second_part,
+                     * without concatenating the two parts.
+                     */
+                    field_value_type evaluate(const input_span<field_value_type> &first_part,
+                                              const input_span<field_value_type> &second_part) const {
+                        const field_value_type one = field_value_type::one();
+                        const field_value_type minus_one = -one;
+                        field_value_type acc = field_value_type::zero();
+                        for (auto &lt : terms) {
+                            const field_value_type &value =
+                                lt.index == 0 ? one :
+                                lt.index <= first_part.size() ? first_part[lt.index - 1] :
+                                                                second_part[lt.index - 1 - first_part.size()];
+                            if (lt.coeff == one) {
+                                acc += value;
+                            } else if (lt.coeff == minus_one) {
+                                acc -= value;
+                            } else {
+                                acc += value * lt.coeff;
+                            }
                         }
                         return acc;
                     }
@@ -302,7 +412,7 @@ namespace nil {
                         return (*this) * field_value_type(int_coeff);
                     }
                     linear_combination operator*(const field_value_type &field_coeff) const {
-                        linear_combination result;
+                        linear_combination result(get_allocator());
                         result.terms.reserve(this->terms.size());
                         for (const linear_term<FieldType> &lt : this->terms) {
                             result.terms.emplace_back(lt * field_coeff);
@@ -310,7 +420,7 @@ namespace nil {
                         return result;
                     }
                     linear_combination operator+(const linear_combination &other) const {
-                        linear_combination result;
+                        linear_combination result(get_allocator());
 
                         auto it1 = this->terms.begin();
                         auto it2 = other.terms.begin();
@@ -351,11 +461,11 @@ namespace nil {
 
                     bool operator==(const linear_combination &other) const {
 
-                        std::vector<linear_term<FieldType>> thisterms = this->terms;
+                        terms_type thisterms = this->terms;
                         std::sort(thisterms.begin(), thisterms.end(),
                                   [](linear_term<FieldType> a, linear_term<FieldType> b) { return a.index < b.index; });
 
-                        std::vector<linear_term<FieldType>> otherterms = other.terms;
+                        terms_type otherterms = other.terms;
                         std::sort(otherterms.begin(), otherterms.end(),
                                   [](linear_term<FieldType> a, linear_term<FieldType> b) { return a.index < b.index; });
 
@@ -370,9 +480,9 @@ namespace nil {
                             }
                         }
 
-                        /* check that the variables are in proper range. as the variables
-                           are sorted, it suffices to check the last term */
-                        if ((--terms.end())->index >= num_variables) {
+                        /* check that the variables are in proper range, [0, num_variables] with the
+                           constant at 0. as the variables are sorted, it suffices to check the last term */
+                        if (!terms.empty() && (--terms.end())->index > num_variables) {
                             return false;
                         }
 
@@ -380,41 +490,51 @@ namespace nil {
                     }
                 };
 
-                template<typename FieldType>
-                linear_combination<FieldType> operator*(integer_coeff_t int_coeff,
-                                                        const linear_combination<FieldType> &lc) {
+                template<typename FieldType, typename Allocator>
+                linear_combination<FieldType, Allocator> operator*(integer_coeff_t int_coeff,
+                                                                   const linear_combination<FieldType, Allocator> &lc) {
                     return lc * int_coeff;
                 }
 
-                template<typename FieldType>
-                linear_combination<FieldType> operator*(const typename FieldType::value_type &field_coeff,
-                                                        const linear_combination<FieldType> &lc) {
+                template<typename FieldType, typename Allocator>
+                linear_combination<FieldType, Allocator>
+                    operator*(const typename FieldType::value_type &field_coeff,
+                              const linear_combination<FieldType, Allocator> &lc) {
                     return lc * field_coeff;
                 }
 
-                template<typename FieldType>
-                linear_combination<FieldType> operator+(integer_coeff_t int_coeff,
-                                                        const linear_combination<FieldType> &lc) {
-                    return linear_combination<FieldType>(int_coeff) + lc;
+                /* the results of the sums below take the allocator of lc, their left operand */
+                template<typename FieldType, typename Allocator>
+                linear_combination<FieldType, Allocator> operator+(integer_coeff_t int_coeff,
+                                                                   const linear_combination<FieldType, Allocator> &lc) {
+                    return lc + linear_combination<FieldType, Allocator>(int_coeff);
                 }
 
-                template<typename FieldType>
-                linear_combination<FieldType> operator+(const typename FieldType::value_type &field_coeff,
-                                                        const linear_combination<FieldType> &lc) {
-                    return linear_combination<FieldType>(field_coeff) + lc;
+                template<typename FieldType, typename Allocator>
+                linear_combination<FieldType, Allocator>
+                    operator+(const typename FieldType::value_type &field_coeff,
+                              const linear_combination<FieldType, Allocator> &lc) {
+                    return lc + linear_combination<FieldType, Allocator>(field_coeff);
                 }
 
-                template<typename FieldType>
-                linear_combination<FieldType> operator-(integer_coeff_t int_coeff,
-                                                        const linear_combination<FieldType> &lc) {
-                    return linear_combination<FieldType>(int_coeff) - lc;
+                template<typename FieldType, typename Allocator>
+                linear_combination<FieldType, Allocator> operator-(integer_coeff_t int_coeff,
+                                                                   const linear_combination<FieldType, Allocator> &lc) {
+                    return -lc + linear_combination<FieldType, Allocator>(int_coeff);
                 }
 
-                template<typename FieldType>
-                linear_combination<FieldType> operator-(const typename FieldType::value_type &field_coeff,
-                                                        const linear_combination<FieldType> &lc) {
-                    return linear_combination<FieldType>(field_coeff) - lc;
+                template<typename FieldType, typename Allocator>
+                linear_combination<FieldType, Allocator>
+                    operator-(const typename FieldType::value_type &field_coeff,
+                              const linear_combination<FieldType, Allocator> &lc) {
+                    return -lc + linear_combination<FieldType, Allocator>(field_coeff);
                 }
+
+                namespace pmr {
+                    template<typename FieldType>
+                    using linear_combination =
+                        snark::linear_combination<FieldType, std::pmr::polymorphic_allocator<linear_term<FieldType>>>;
+                }    // namespace pmr
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
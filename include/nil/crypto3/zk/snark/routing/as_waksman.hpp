@@ -43,6 +43,10 @@
 // the graph and alternating the color at every step. For performance reasons
 // the graph in our implementation is implicitly represented.
 //
+// The top and bottom sub-networks are independent, so get_as_waksman_routing
+// routes all the sub-networks of one level of the recursion at once, split
+// across the current executor.
+//
 // References:
 //
 // \[BD02]:
@@ -54,11 +58,20 @@
 #ifndef CRYPTO3_ZK_AS_WAKSMAN_ROUTING_ALGORITHM_HPP
 #define CRYPTO3_ZK_AS_WAKSMAN_ROUTING_ALGORITHM_HPP
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <limits>
 #include <map>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
 #include <nil/crypto3/zk/snark/integer_permutation.hpp>
+#include <nil/crypto3/zk/snark/routing/packed_routing.hpp>
+#include <nil/crypto3/zk/snark/routing/routing_topology.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -135,17 +148,35 @@ namespace nil {
                  */
                 as_waksman_topology generate_as_waksman_topology(size_t num_packets);
 
+                /**
+                 * Return the topology of an AS-Waksman network for a given number of packets in flat
+                 * layout, built once per size for the whole process and shared by all its callers.
+                 */
+                std::shared_ptr<const routing_topology> get_as_waksman_topology(size_t num_packets);
+
                 /**
                  * Route the given permutation on an AS-Waksman network of suitable size.
                  */
                 as_waksman_routing get_as_waksman_routing(const integer_permutation &permutation);
 
+                /**
+                 * Route the given permutation on an AS-Waksman network of suitable size, as
+                 * get_as_waksman_routing does, into a packed routing: both positions occupied by a switch
+                 * hold its setting, and the positions with no switch hold false.
+                 */
+                packed_routing get_as_waksman_packed_routing(const integer_permutation &permutation);
+
                 /**
                  * Check if a routing "implements" the given permutation.
                  */
                 bool valid_as_waksman_routing(const integer_permutation &permutation,
                                               const as_waksman_routing &routing);
 
+                /**
+                 * Check if a packed routing "implements" the given permutation.
+                 */
+                bool valid_as_waksman_routing(const integer_permutation &permutation, const packed_routing &routing);
+
                 /**
                  * Return the height of the AS-Waksman network's top sub-network.
                  */
@@ -314,6 +345,17 @@ namespace nil {
                     return neighbors;
                 }
 
+                /**
+                 * Tag of the AS-Waksman topologies in routing_topology_cache.
+                 */
+                struct as_waksman_network_tag { };
+
+                std::shared_ptr<const routing_topology> get_as_waksman_topology(size_t num_packets) {
+                    return routing_topology_cache<as_waksman_network_tag>::get(num_packets, [](std::size_t n) {
+                        return routing_topology(generate_as_waksman_topology(n));
+                    });
+                }
+
                 /**
                  * Given either a position occupied either by its top or bottom ports,
                  * return the row index of its canonical position.
@@ -609,13 +651,292 @@ namespace nil {
                     }
                 }
 
-                as_waksman_routing get_as_waksman_routing(const integer_permutation &permutation) {
+                /**
+                 * Scratch buffers of the iterative AS-Waksman router, allocated once per routing.
+                 *
+                 * All the subnetworks at one level of the recursion occupy the same switch columns
+                 * [left, right] and disjoint packet ranges [lo, hi] which cover all the packets, so a
+                 * level is routed over whole-network arrays: the permutation of the level and its
+                 * inverse, those of the next level, the settings of the switches in columns left and
+                 * right (-1 while not assigned), and the routed flags of the left-hand side packets.
+                 * The flags are bytes rather than bits, so that disjoint ranges are routed concurrently.
+                 * The permutations have the 32-bit elements of compact_integer_permutation.
+                 */
+                struct as_waksman_routing_workspace {
+                    typedef compact_integer_permutation::index_type index_type;
+
+                    std::vector<index_type> permutation, permutation_inv;
+                    std::vector<index_type> new_permutation, new_permutation_inv;
+                    std::vector<signed char> lhs_settings, rhs_settings;
+                    std::vector<char> lhs_routed;
+                    std::vector<std::pair<std::size_t, std::size_t>> ranges, new_ranges;
+
+                    explicit as_waksman_routing_workspace(const integer_permutation &pi) :
+                        permutation(pi.data().begin(), pi.data().end()), permutation_inv(pi.size()),
+                        new_permutation(pi.size()), new_permutation_inv(pi.size()),
+                        lhs_settings(pi.size(), -1), rhs_settings(pi.size(), -1), lhs_routed(pi.size(), false) {
+                        assert(pi.min_element == 0 && pi.max_element <= std::numeric_limits<index_type>::max());
+                        pi.view().inverse(permutation_inv.data());
+                        ranges.reserve(pi.size());
+                        new_ranges.reserve(pi.size());
+                    }
+
+                    std::size_t size_in_bytes() const {
+                        return (permutation.capacity() + permutation_inv.capacity() + new_permutation.capacity() +
+                                new_permutation_inv.capacity()) *
+                                   sizeof(index_type) +
+                               lhs_settings.capacity() + rhs_settings.capacity() + lhs_routed.capacity() +
+                               (ranges.capacity() + new_ranges.capacity()) *
+                                   sizeof(std::pair<std::size_t, std::size_t>);
+                    }
+                };
+
+                /**
+                 * Compute the switch settings of columns left and right for the subnetwork routing
+                 * [lo, hi] whose permutation is held by scratch, writing them to scratch.lhs_settings
+                 * and scratch.rhs_settings and the permutation of its two subnetworks to
+                 * scratch.new_permutation. This is the loop of as_waksman_route_inner over the scratch
+                 * arrays; it only touches the entries [lo, hi] of them.
+                 */
+                void as_waksman_route_level(size_t lo, std::size_t hi, as_waksman_routing_workspace &scratch) {
+                    const std::size_t subnetwork_size = (hi - lo + 1);
+                    typedef as_waksman_routing_workspace::index_type index_type;
+                    const std::vector<index_type> &permutation = scratch.permutation;
+                    const std::vector<index_type> &permutation_inv = scratch.permutation_inv;
+                    std::vector<index_type> &new_permutation = scratch.new_permutation;
+                    std::vector<index_type> &new_permutation_inv = scratch.new_permutation_inv;
+                    std::vector<signed char> &lhs_settings = scratch.lhs_settings;
+                    std::vector<signed char> &rhs_settings = scratch.rhs_settings;
+                    std::vector<char> &lhs_routed = scratch.lhs_routed;
+
+                    std::fill(lhs_routed.begin() + lo, lhs_routed.begin() + hi + 1, false);
+
+                    std::size_t to_route;
+                    std::size_t max_unrouted;
+                    bool route_left;
+
+                    if (subnetwork_size % 2 == 1) {
+                        /* ODD CASE: the bottom-most straight wire goes into the lower subnetwork. */
+                        if (permutation[hi] == hi) {
+                            new_permutation[hi] = hi;
+                            new_permutation_inv[hi] = hi;
+                            to_route = hi - 1;
+                            route_left = true;
+                        } else {
+                            const std::size_t rhs_switch = as_waksman_get_canonical_row_idx(lo, permutation[hi]);
+                            rhs_settings[rhs_switch] =
+                                as_waksman_get_switch_setting_from_top_bottom_decision(lo, permutation[hi], false);
+                            const std::size_t tprime = as_waksman_switch_input(subnetwork_size, lo, rhs_switch, false);
+                            new_permutation[hi] = tprime;
+                            new_permutation_inv[tprime] = hi;
+
+                            to_route = as_waksman_other_output_position(lo, permutation[hi]);
+                            route_left = false;
+                        }
+
+                        lhs_routed[hi] = true;
+                        max_unrouted = hi - 1;
+                    } else {
+                        /* EVEN CASE: the bottom-most switch is fixed to a constant straight setting. */
+                        lhs_settings[hi - 1] = false;
+                        to_route = hi;
+                        route_left = true;
+                        max_unrouted = hi;
+                    }
+
+                    while (true) {
+                        if (route_left) {
+                            const std::size_t lhs_switch = as_waksman_get_canonical_row_idx(lo, to_route);
+                            if (lhs_settings[lhs_switch] < 0) {
+                                lhs_settings[lhs_switch] = false;
+                            }
+                            const bool use_top = as_waksman_get_top_bottom_decision_from_switch_setting(
+                                lo, to_route, lhs_settings[lhs_switch]);
+                            const std::size_t t = as_waksman_switch_output(subnetwork_size, lo, lhs_switch, use_top);
+                            if (permutation[to_route] == hi) {
+                                new_permutation[t] = hi;
+                                new_permutation_inv[hi] = t;
+                                lhs_routed[to_route] = true;
+                                to_route = max_unrouted;
+                                route_left = true;
+                            } else {
+                                const std::size_t rhs_switch =
+                                    as_waksman_get_canonical_row_idx(lo, permutation[to_route]);
+                                assert(rhs_settings[rhs_switch] < 0);
+                                rhs_settings[rhs_switch] = as_waksman_get_switch_setting_from_top_bottom_decision(
+                                    lo, permutation[to_route], use_top);
+                                const std::size_t tprime =
+                                    as_waksman_switch_input(subnetwork_size, lo, rhs_switch, use_top);
+                                new_permutation[t] = tprime;
+                                new_permutation_inv[tprime] = t;
+
+                                lhs_routed[to_route] = true;
+                                to_route = as_waksman_other_output_position(lo, permutation[to_route]);
+                                route_left = false;
+                            }
+                        } else {
+                            const std::size_t rhs_switch = as_waksman_get_canonical_row_idx(lo, to_route);
+                            const std::size_t lhs_switch =
+                                as_waksman_get_canonical_row_idx(lo, permutation_inv[to_route]);
+                            assert(rhs_settings[rhs_switch] >= 0);
+                            const bool use_top = as_waksman_get_top_bottom_decision_from_switch_setting(
+                                lo, to_route, rhs_settings[rhs_switch]);
+                            const bool lhs_switch_setting = as_waksman_get_switch_setting_from_top_bottom_decision(
+                                lo, permutation_inv[to_route], use_top);
+
+                            assert(lhs_settings[lhs_switch] < 0 ||
+                                   bool(lhs_settings[lhs_switch]) == lhs_switch_setting);
+                            lhs_settings[lhs_switch] = lhs_switch_setting;
+
+                            const std::size_t t = as_waksman_switch_input(subnetwork_size, lo, rhs_switch, use_top);
+                            const std::size_t tprime =
+                                as_waksman_switch_output(subnetwork_size, lo, lhs_switch, use_top);
+                            new_permutation[tprime] = t;
+                            new_permutation_inv[t] = tprime;
+
+                            lhs_routed[permutation_inv[to_route]] = true;
+                            to_route = as_waksman_other_input_position(lo, permutation_inv[to_route]);
+                            route_left = true;
+                        }
+
+                        /* If the next packet to be routed hasn't been routed before, then try routing it. */
+                        if (!route_left || !lhs_routed[to_route]) {
+                            continue;
+                        }
+
+                        /* Otherwise just find the next unrouted packet. */
+                        while (max_unrouted > lo && lhs_routed[max_unrouted]) {
+                            --max_unrouted;
+                        }
+
+                        if (max_unrouted < lo || (max_unrouted == lo && lhs_routed[lo])) {
+                            /* All routed! */
+                            break;
+                        } else {
+                            to_route = max_unrouted;
+                            route_left = true;
+                        }
+                    }
+
+                    if (subnetwork_size % 2 == 0) {
+                        /* Remove the AS-Waksman switch with the fixed value. */
+                        lhs_settings[hi - 1] = -1;
+                    }
+                }
+
+                /**
+                 * Route permutation level by level, handing the settings of every switch column to
+                 * store(column_idx, settings) once they are computed. settings holds one entry per
+                 * packet, the setting of the switch at that canonical position or -1, and is reset to
+                 * -1 by store; the two columns of a level are stored concurrently.
+                 */
+                template<typename StoreColumn>
+                void route_as_waksman_levels(const integer_permutation &permutation, StoreColumn store) {
                     const std::size_t num_packets = permutation.size();
                     const std::size_t width = as_waksman_num_columns(num_packets);
 
-                    as_waksman_routing routing(width);
-                    as_waksman_route_inner(0, width - 1, 0, num_packets - 1, permutation, permutation.inversed(),
-                                           routing);
+                    if (width == 0) {
+                        return;
+                    }
+
+                    /**
+                     * The recursion of as_waksman_route_inner is unrolled level by level: every level
+                     * routes its subnetworks in columns [left, right] and queues their halves for
+                     * [left + 1, right - 1], the permutations of the next level being built in place of
+                     * the ones of the current level. The subnetworks of a level are independent, so they
+                     * are split across the current executor, and their settings are then moved to the
+                     * maps of the two columns.
+                     */
+                    as_waksman_routing_workspace scratch(permutation);
+                    scratch.ranges.emplace_back(0, num_packets - 1);
+
+                    for (std::size_t left = 0, right = width - 1; left <= right && !scratch.ranges.empty();
+                         ++left, --right) {
+                        const std::size_t level_width = right - left + 1;
+
+                        scratch.new_ranges.clear();
+                        for (const std::pair<std::size_t, std::size_t> &range : scratch.ranges) {
+                            const std::size_t subnetwork_size = range.second - range.first + 1;
+                            assert(level_width >= as_waksman_num_columns(subnetwork_size));
+
+                            if (level_width > as_waksman_num_columns(subnetwork_size)) {
+                                scratch.new_ranges.emplace_back(range);
+                            } else if (subnetwork_size > 2) {
+                                const std::size_t d = as_waksman_top_height(subnetwork_size);
+                                scratch.new_ranges.emplace_back(range.first, range.first + d - 1);
+                                scratch.new_ranges.emplace_back(range.first + d, range.second);
+                            }
+                        }
+
+                        executor::current().parallel_for(scratch.ranges.size(), [&](const std::size_t i) {
+                            const std::size_t lo = scratch.ranges[i].first, hi = scratch.ranges[i].second;
+                            const std::size_t subnetwork_size = (hi - lo + 1);
+
+                            if (level_width > as_waksman_num_columns(subnetwork_size)) {
+                                /* straight edges along the sides, the permutation is passed down as it is */
+                                std::copy(scratch.permutation.begin() + lo, scratch.permutation.begin() + hi + 1,
+                                          scratch.new_permutation.begin() + lo);
+                                std::copy(scratch.permutation_inv.begin() + lo,
+                                          scratch.permutation_inv.begin() + hi + 1,
+                                          scratch.new_permutation_inv.begin() + lo);
+                            } else if (subnetwork_size == 2) {
+                                assert(scratch.permutation[lo] != scratch.permutation[lo + 1]);
+                                scratch.lhs_settings[lo] = scratch.permutation[lo] != lo;
+                            } else {
+                                as_waksman_route_level(lo, hi, scratch);
+                            }
+                        });
+
+                        executor::current().bulk(left == right ? 1 : 2, [&](const std::size_t side) {
+                            store(side ? right : left, side ? scratch.rhs_settings : scratch.lhs_settings);
+                        });
+
+                        std::swap(scratch.ranges, scratch.new_ranges);
+                        std::swap(scratch.permutation, scratch.new_permutation);
+                        std::swap(scratch.permutation_inv, scratch.new_permutation_inv);
+                        if (left == right) {
+                            break;
+                        }
+                    }
+                }
+
+                as_waksman_routing get_as_waksman_routing(const integer_permutation &permutation) {
+                    const std::size_t num_packets = permutation.size();
+                    as_waksman_routing routing(as_waksman_num_columns(num_packets));
+
+                    /* the rows are scanned in increasing order, so the settings are appended to the maps */
+                    route_as_waksman_levels(permutation, [&](const std::size_t column_idx,
+                                                             std::vector<signed char> &settings) {
+                        std::map<std::size_t, bool> &column = routing[column_idx];
+                        for (std::size_t row_idx = 0; row_idx < num_packets; ++row_idx) {
+                            if (settings[row_idx] >= 0) {
+                                column.emplace_hint(column.end(), row_idx, bool(settings[row_idx]));
+                                settings[row_idx] = -1;
+                            }
+                        }
+                    });
+
+                    return routing;
+                }
+
+                packed_routing get_as_waksman_packed_routing(const integer_permutation &permutation) {
+                    const std::size_t num_packets = permutation.size();
+                    packed_routing routing(as_waksman_num_columns(num_packets), num_packets);
+
+                    /* a switch in canonical position row_idx also occupies row_idx + 1 */
+                    route_as_waksman_levels(permutation, [&](const std::size_t column_idx,
+                                                             std::vector<signed char> &settings) {
+                        for (std::size_t row_idx = 0; row_idx < num_packets; ++row_idx) {
+                            if (settings[row_idx] >= 0) {
+                                if (settings[row_idx]) {
+                                    routing.set(column_idx, row_idx, true);
+                                    routing.set(column_idx, row_idx + 1, true);
+                                }
+                                settings[row_idx] = -1;
+                            }
+                        }
+                    });
+
                     return routing;
                 }
 
@@ -623,7 +944,8 @@ namespace nil {
                                               const as_waksman_routing &routing) {
                     const std::size_t num_packets = permutation.size();
                     const std::size_t width = as_waksman_num_columns(num_packets);
-                    as_waksman_topology neighbors = generate_as_waksman_topology(num_packets);
+                    const std::shared_ptr<const routing_topology> topology = get_as_waksman_topology(num_packets);
+                    const routing_topology &neighbors = *topology;
 
                     integer_permutation curperm(num_packets);
 
@@ -631,8 +953,8 @@ namespace nil {
                         integer_permutation nextperm(num_packets);
                         for (std::size_t packet_idx = 0; packet_idx < num_packets; ++packet_idx) {
                             std::size_t routed_packet_idx;
-                            if (neighbors[column_idx][packet_idx].first == neighbors[column_idx][packet_idx].second) {
-                                routed_packet_idx = neighbors[column_idx][packet_idx].first;
+                            if (neighbors(column_idx, packet_idx).first == neighbors(column_idx, packet_idx).second) {
+                                routed_packet_idx = neighbors(column_idx, packet_idx).first;
                             } else {
                                 auto it = routing[column_idx].find(packet_idx);
                                 auto it2 = routing[column_idx].find(packet_idx - 1);
@@ -640,8 +962,8 @@ namespace nil {
                                 const bool switch_setting =
                                     (it != routing[column_idx].end() ? it->second : it2->second);
 
-                                routed_packet_idx = (switch_setting ? neighbors[column_idx][packet_idx].second :
-                                                                      neighbors[column_idx][packet_idx].first);
+                                routed_packet_idx = (switch_setting ? neighbors(column_idx, packet_idx).second :
+                                                                      neighbors(column_idx, packet_idx).first);
                             }
 
                             nextperm.set(routed_packet_idx, curperm.get(packet_idx));
@@ -650,7 +972,62 @@ namespace nil {
                         curperm = nextperm;
                     }
 
-                    return (curperm == permutation.inversed());
+                    return (curperm == permutation.inverse());
+                }
+
+                bool valid_as_waksman_routing(const integer_permutation &permutation, const packed_routing &routing) {
+                    typedef packed_routing::word_type word_type;
+
+                    const std::size_t num_packets = permutation.size();
+                    const std::size_t width = as_waksman_num_columns(num_packets);
+                    if (routing.num_columns() != width || routing.num_packets() != num_packets) {
+                        return false;
+                    }
+                    const std::shared_ptr<const routing_topology> topology = get_as_waksman_topology(num_packets);
+                    const routing_topology &neighbors = *topology;
+
+                    /* curperm[packet_idx] is the input packet at packet_idx after the columns routed so far */
+                    std::vector<std::size_t> curperm(num_packets), nextperm(num_packets);
+                    for (std::size_t packet_idx = 0; packet_idx < num_packets; ++packet_idx) {
+                        curperm[packet_idx] = packet_idx;
+                    }
+
+                    for (std::size_t column_idx = 0; column_idx < width; ++column_idx) {
+                        /* positions nothing is routed to hold num_packets, which is no input packet */
+                        std::fill(nextperm.begin(), nextperm.end(), num_packets);
+                        const word_type *column = routing.column(column_idx);
+                        for (std::size_t word_idx = 0; word_idx < routing.words_per_column(); ++word_idx) {
+                            const std::size_t begin = word_idx * packed_routing::word_bits;
+                            const std::size_t end = std::min(num_packets, begin + packed_routing::word_bits);
+                            const word_type word = column[word_idx];
+
+                            if (word == 0) {
+                                /* every position of the word is routed straight */
+                                for (std::size_t packet_idx = begin; packet_idx < end; ++packet_idx) {
+                                    nextperm[neighbors(column_idx, packet_idx).first] = curperm[packet_idx];
+                                }
+                                continue;
+                            }
+
+                            for (std::size_t packet_idx = begin; packet_idx < end; ++packet_idx) {
+                                const bool switch_setting = (word >> (packet_idx - begin)) & 1;
+                                const std::size_t routed_packet_idx = switch_setting ?
+                                                                          neighbors(column_idx, packet_idx).second :
+                                                                          neighbors(column_idx, packet_idx).first;
+                                nextperm[routed_packet_idx] = curperm[packet_idx];
+                            }
+                        }
+
+                        std::swap(curperm, nextperm);
+                    }
+
+                    for (std::size_t packet_idx = 0; packet_idx < num_packets; ++packet_idx) {
+                        if (curperm[permutation.get(packet_idx)] != packet_idx) {
+                            return false;
+                        }
+                    }
+
+                    return true;
                 }
             }    // namespace snark
         }        // namespace zk
@@ -28,7 +28,9 @@
 // routing by first computing the switch settings for the left and right
 // columns of the network and then recursively computing routings for
 // the top half and the bottom half of the network (each of which is a
-// Benes network of smaller size).
+// Benes network of smaller size). The two halves are independent, so
+// get_benes_routing routes all the subnetworks of one level of the recursion
+// at once, split across the current executor.
 //
 // References:
 //
@@ -41,9 +43,18 @@
 #ifndef CRYPTO3_ZK_BENES_ROUTING_ALGORITHM_HPP
 #define CRYPTO3_ZK_BENES_ROUTING_ALGORITHM_HPP
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
 #include <nil/crypto3/zk/snark/integer_permutation.hpp>
+#include <nil/crypto3/zk/snark/routing/packed_routing.hpp>
+#include <nil/crypto3/zk/snark/routing/routing_topology.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -94,6 +105,12 @@ namespace nil {
                  */
                 benes_topology generate_benes_topology(std::size_t num_packets);
 
+                /**
+                 * Return the topology of a Benes network for a given number of packets in flat layout,
+                 * built once per size for the whole process and shared by all its callers.
+                 */
+                std::shared_ptr<const routing_topology> get_benes_topology(std::size_t num_packets);
+
                 /**
                  * Route the given permutation on a Benes network of suitable size.
                  */
@@ -226,6 +243,27 @@ namespace nil {
                     return result;
                 }
 
+                /**
+                 * Tag of the Benes topologies in routing_topology_cache.
+                 */
+                struct benes_network_tag { };
+
+                std::shared_ptr<const routing_topology> get_benes_topology(std::size_t num_packets) {
+                    return routing_topology_cache<benes_network_tag>::get(num_packets, [](std::size_t n) {
+                        const std::size_t num_columns = benes_num_columns(n);
+                        const std::size_t dimension = static_cast<std::size_t>(std::ceil(std::log2(n)));
+
+                        routing_topology result(num_columns, n);
+                        for (std::size_t column_idx = 0; column_idx < num_columns; ++column_idx) {
+                            for (std::size_t packet_idx = 0; packet_idx < n; ++packet_idx) {
+                                result(column_idx, packet_idx) = routing_topology::destinations_type(
+                                    packet_idx, benes_packet_cross_destination(dimension, column_idx, packet_idx));
+                            }
+                        }
+                        return result;
+                    });
+                }
+
                 /**
                  * Auxiliary function used in get_benes_routing (see below).
                  *
@@ -247,7 +285,7 @@ namespace nil {
                                        benes_routing &routing) {
                     assert(permutation.size() == subnetwork_size);
                     assert(permutation.is_valid());
-                    assert(permutation.inversed() == permutation_inv);
+                    assert(permutation.inverse() == permutation_inv);
 
                     if (column_idx_start == column_idx_end) {
                         /* nothing to route */
@@ -341,15 +379,171 @@ namespace nil {
                                       routing);
                 }
 
-                benes_routing get_benes_routing(const integer_permutation &permutation) {
+                /**
+                 * Scratch buffers of the level-by-level Benes router, allocated once per routing.
+                 *
+                 * The subnetworks at one level of the recursion occupy the same columns and disjoint,
+                 * aligned packet ranges covering all the packets, so a level is routed over
+                 * whole-network arrays: the permutation of the level and its inverse, those of the next
+                 * level, the settings of the two outer columns of the level and the routed flags of the
+                 * left-hand side packets. Settings and flags are bytes, so that the subnetworks of a
+                 * level are routed concurrently. The permutations have the 32-bit elements of
+                 * compact_integer_permutation.
+                 */
+                struct benes_routing_workspace {
+                    typedef compact_integer_permutation::index_type index_type;
+
+                    std::vector<index_type> permutation, permutation_inv;
+                    std::vector<index_type> new_permutation, new_permutation_inv;
+                    std::vector<char> lhs_settings, rhs_settings;
+                    std::vector<char> lhs_routed;
+
+                    explicit benes_routing_workspace(const integer_permutation &pi) :
+                        permutation(pi.data().begin(), pi.data().end()), permutation_inv(pi.size()),
+                        new_permutation(pi.size()), new_permutation_inv(pi.size()), lhs_settings(pi.size()),
+                        rhs_settings(pi.size()), lhs_routed(pi.size()) {
+                        assert(pi.min_element == 0 && pi.max_element <= std::numeric_limits<index_type>::max());
+                        pi.view().inverse(permutation_inv.data());
+                    }
+                };
+
+                /**
+                 * Compute the settings of the columns column_idx_start and column_idx_end - 1 for the
+                 * subnetwork [subnetwork_offset, subnetwork_offset + subnetwork_size) whose permutation
+                 * is held by scratch, writing the permutations of its two subnetworks to
+                 * scratch.new_permutation. This is the loop of route_benes_inner over the scratch
+                 * arrays; it only touches the entries of the subnetwork.
+                 */
+                void route_benes_level(size_t dimension,
+                                       std::size_t column_idx_start,
+                                       std::size_t column_idx_end,
+                                       std::size_t subnetwork_offset,
+                                       std::size_t subnetwork_size,
+                                       benes_routing_workspace &scratch) {
+                    typedef benes_routing_workspace::index_type index_type;
+                    const std::vector<index_type> &permutation = scratch.permutation;
+                    const std::vector<index_type> &permutation_inv = scratch.permutation_inv;
+                    std::vector<index_type> &new_permutation = scratch.new_permutation;
+                    std::vector<index_type> &new_permutation_inv = scratch.new_permutation_inv;
+                    std::vector<char> &lhs_routed = scratch.lhs_routed;
+
+                    std::fill(lhs_routed.begin() + subnetwork_offset,
+                              lhs_routed.begin() + subnetwork_offset + subnetwork_size, false);
+
+                    std::size_t w = subnetwork_offset; /* left-hand-side vertex to be routed. */
+                    std::size_t last_unrouted = subnetwork_offset;
+
+                    while (true) {
+                        /* route w to its target on RHS, wprime = pi[w], using upper network */
+                        const std::size_t wprime = permutation[w];
+                        const std::size_t w_destination =
+                            benes_lhs_packet_destination(dimension, column_idx_start, w, true);
+                        const std::size_t wprime_source =
+                            benes_rhs_packet_source(dimension, column_idx_end, wprime, true);
+
+                        scratch.lhs_settings[w] =
+                            benes_get_switch_setting_from_subnetwork(dimension, column_idx_start, w, true);
+                        scratch.rhs_settings[wprime_source] =
+                            benes_get_switch_setting_from_subnetwork(dimension, column_idx_end - 1, wprime, true);
+                        new_permutation[w_destination] = wprime_source;
+                        new_permutation_inv[wprime_source] = w_destination;
+                        lhs_routed[w] = true;
+
+                        /* back-route the other neighbor vprime of wprime via the lower network */
+                        const std::size_t vprime = benes_packet_cross_source(dimension, column_idx_end, wprime);
+                        const std::size_t v = permutation_inv[vprime];
+                        assert(!lhs_routed[v]);
+                        const std::size_t v_destination =
+                            benes_lhs_packet_destination(dimension, column_idx_start, v, false);
+                        const std::size_t vprime_source =
+                            benes_rhs_packet_source(dimension, column_idx_end, vprime, false);
+
+                        scratch.rhs_settings[vprime_source] =
+                            benes_get_switch_setting_from_subnetwork(dimension, column_idx_end - 1, vprime, false);
+                        scratch.lhs_settings[v] =
+                            benes_get_switch_setting_from_subnetwork(dimension, column_idx_start, v, false);
+                        new_permutation[v_destination] = vprime_source;
+                        new_permutation_inv[vprime_source] = v_destination;
+                        lhs_routed[v] = true;
+
+                        /* if the other neighbor of v is not routed, route it; otherwise, find the next unrouted node */
+                        if (!lhs_routed[benes_packet_cross_destination(dimension, column_idx_start, v)]) {
+                            w = benes_packet_cross_destination(dimension, column_idx_start, v);
+                        } else {
+                            while ((last_unrouted < subnetwork_offset + subnetwork_size) &&
+                                   lhs_routed[last_unrouted]) {
+                                ++last_unrouted;
+                            }
+
+                            if (last_unrouted == subnetwork_offset + subnetwork_size) {
+                                break; /* all routed! */
+                            } else {
+                                w = last_unrouted;
+                            }
+                        }
+                    }
+                }
+
+                /**
+                 * Route permutation level by level, handing the byte settings of every column to
+                 * store(column_idx, settings) once they are computed; the two columns of a level are
+                 * stored concurrently.
+                 */
+                template<typename StoreColumn>
+                void route_benes_levels(const integer_permutation &permutation, StoreColumn store) {
                     std::size_t num_packets = permutation.size();
                     std::size_t num_columns = benes_num_columns(num_packets);
                     std::size_t dimension = static_cast<std::size_t>(std::ceil(std::log2(num_packets)));
 
-                    benes_routing routing(num_columns, std::vector<bool>(num_packets));
+                    /**
+                     * The recursion of route_benes_inner is unrolled level by level: level l routes the
+                     * 2^l subnetworks of columns [l, num_columns - l), which are independent and split
+                     * across the current executor.
+                     */
+                    benes_routing_workspace scratch(permutation);
+                    for (std::size_t level = 0; level < dimension; ++level) {
+                        const std::size_t column_idx_start = level, column_idx_end = num_columns - level;
+                        const std::size_t subnetwork_size = num_packets >> level;
+
+                        executor::current().parallel_for(std::size_t(1) << level, [&](const std::size_t i) {
+                            route_benes_level(dimension, column_idx_start, column_idx_end, i * subnetwork_size,
+                                              subnetwork_size, scratch);
+                        });
+
+                        executor::current().bulk(2, [&](const std::size_t side) {
+                            store(side ? column_idx_end - 1 : column_idx_start,
+                                  side ? scratch.rhs_settings : scratch.lhs_settings);
+                        });
+
+                        std::swap(scratch.permutation, scratch.new_permutation);
+                        std::swap(scratch.permutation_inv, scratch.new_permutation_inv);
+                    }
+                }
 
-                    route_benes_inner(dimension, permutation, permutation.inversed(), 0, num_columns, 0, num_packets,
-                                      routing);
+                benes_routing get_benes_routing(const integer_permutation &permutation) {
+                    const std::size_t num_packets = permutation.size();
+                    benes_routing routing(benes_num_columns(num_packets), std::vector<bool>(num_packets));
+
+                    route_benes_levels(permutation,
+                                       [&](const std::size_t column_idx, const std::vector<char> &settings) {
+                                           std::copy(settings.begin(), settings.end(), routing[column_idx].begin());
+                                       });
+
+                    return routing;
+                }
+
+                /**
+                 * Route the given permutation on a Benes network, as get_benes_routing does, into a
+                 * packed routing.
+                 */
+                packed_routing get_benes_packed_routing(const integer_permutation &permutation) {
+                    const std::size_t num_packets = permutation.size();
+                    packed_routing routing(benes_num_columns(num_packets), num_packets);
+
+                    route_benes_levels(permutation,
+                                       [&](const std::size_t column_idx, const std::vector<char> &settings) {
+                                           routing.assign_column(column_idx, settings.begin());
+                                       });
 
                     return routing;
                 }
@@ -397,6 +591,64 @@ namespace nil {
                     return true;
                 }
 
+                /**
+                 * Check if a packed routing "implements" the given permutation. Column column_idx sends
+                 * the packet at packet_idx to packet_idx ^ benes_cross_edge_mask(column_idx) when its bit
+                 * is set, so a word that is all straight, or all cross with a mask of at least a word,
+                 * moves its packets as one block.
+                 */
+                bool valid_benes_routing(const integer_permutation &permutation, const packed_routing &routing) {
+                    typedef packed_routing::word_type word_type;
+
+                    const std::size_t num_packets = permutation.size();
+                    const std::size_t num_columns = benes_num_columns(num_packets);
+                    const std::size_t dimension = static_cast<std::size_t>(std::ceil(std::log2(num_packets)));
+                    if (routing.num_columns() != num_columns || routing.num_packets() != num_packets) {
+                        return false;
+                    }
+
+                    std::vector<std::size_t> packets(num_packets), next_packets(num_packets);
+                    for (std::size_t packet_idx = 0; packet_idx < num_packets; ++packet_idx) {
+                        packets[packet_idx] = packet_idx;
+                    }
+
+                    for (std::size_t column_idx = 0; column_idx < num_columns; ++column_idx) {
+                        const std::size_t mask = benes_cross_edge_mask(dimension, column_idx);
+                        /* positions nothing is routed to hold num_packets, which is no input packet */
+                        std::fill(next_packets.begin(), next_packets.end(), num_packets);
+                        const word_type *column = routing.column(column_idx);
+
+                        for (std::size_t word_idx = 0; word_idx < routing.words_per_column(); ++word_idx) {
+                            const std::size_t begin = word_idx * packed_routing::word_bits;
+                            const std::size_t end = std::min(num_packets, begin + packed_routing::word_bits);
+                            const word_type word = column[word_idx];
+
+                            if (word == 0) {
+                                std::copy(packets.begin() + begin, packets.begin() + end,
+                                          next_packets.begin() + begin);
+                            } else if (mask >= packed_routing::word_bits && word == ~word_type(0)) {
+                                std::copy(packets.begin() + begin, packets.begin() + end,
+                                          next_packets.begin() + (begin ^ mask));
+                            } else {
+                                for (std::size_t packet_idx = begin; packet_idx < end; ++packet_idx) {
+                                    const bool cross = (word >> (packet_idx - begin)) & 1;
+                                    next_packets[cross ? packet_idx ^ mask : packet_idx] = packets[packet_idx];
+                                }
+                            }
+                        }
+
+                        std::swap(packets, next_packets);
+                    }
+
+                    for (std::size_t packet_idx = 0; packet_idx < num_packets; ++packet_idx) {
+                        if (packets[permutation.get(packet_idx)] != packet_idx) {
+                            return false;
+                        }
+                    }
+
+                    return true;
+                }
+
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
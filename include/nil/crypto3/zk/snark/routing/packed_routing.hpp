@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a bit-packed routing of a switching network.
+//
+// A packed routing holds one setting bit per column and packet, false for the
+// straight setting and true for the cross one. Each column is a fixed bitset of
+// 64-bit words and all the columns share one contiguous allocation, so the
+// witness of a switching network is read off a column a word at a time.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_PACKED_ROUTING_HPP
+#define CRYPTO3_ZK_PACKED_ROUTING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Setting bits of a network of num_columns columns of num_packets packets. Bit
+                 * (column_idx, packet_idx) is bit packet_idx % 64 of word packet_idx / 64 of the column;
+                 * the padding bits of the last word of a column are zero.
+                 */
+                class packed_routing {
+                public:
+                    typedef std::uint64_t word_type;
+                    static constexpr const std::size_t word_bits = 64;
+
+                    packed_routing() : num_columns_(0), num_packets_(0), words_per_column_(0) {
+                    }
+
+                    packed_routing(const std::size_t num_columns, const std::size_t num_packets) :
+                        num_columns_(num_columns), num_packets_(num_packets),
+                        words_per_column_((num_packets + word_bits - 1) / word_bits),
+                        words(num_columns * words_per_column_, 0) {
+                    }
+
+                    std::size_t num_columns() const {
+                        return num_columns_;
+                    }
+
+                    std::size_t num_packets() const {
+                        return num_packets_;
+                    }
+
+                    std::size_t words_per_column() const {
+                        return words_per_column_;
+                    }
+
+                    bool get(const std::size_t column_idx, const std::size_t packet_idx) const {
+                        return (column(column_idx)[packet_idx / word_bits] >> (packet_idx % word_bits)) & 1;
+                    }
+
+                    void set(const std::size_t column_idx, const std::size_t packet_idx, const bool value) {
+                        const word_type bit = word_type(1) << (packet_idx % word_bits);
+                        word_type &word = column(column_idx)[packet_idx / word_bits];
+                        word = value ? word | bit : word & ~bit;
+                    }
+
+                    /**
+                     * The words_per_column() words of column column_idx.
+                     */
+                    const word_type *column(const std::size_t column_idx) const {
+                        return words.data() + column_idx * words_per_column_;
+                    }
+
+                    word_type *column(const std::size_t column_idx) {
+                        return words.data() + column_idx * words_per_column_;
+                    }
+
+                    /**
+                     * Packs the byte settings [first, first + num_packets()) into column column_idx.
+                     */
+                    template<typename InputIterator>
+                    void assign_column(const std::size_t column_idx, InputIterator first) {
+                        word_type *column_words = column(column_idx);
+                        for (std::size_t word_idx = 0; word_idx < words_per_column_; ++word_idx) {
+                            const std::size_t end = std::min(num_packets_, (word_idx + 1) * word_bits);
+                            word_type word = 0;
+                            for (std::size_t packet_idx = word_idx * word_bits; packet_idx < end;
+                                 ++packet_idx, ++first) {
+                                word |= word_type(bool(*first)) << (packet_idx % word_bits);
+                            }
+                            column_words[word_idx] = word;
+                        }
+                    }
+
+                    std::size_t size_in_bytes() const {
+                        return words.capacity() * sizeof(word_type);
+                    }
+
+                    bool operator==(const packed_routing &other) const {
+                        return num_columns_ == other.num_columns_ && num_packets_ == other.num_packets_ &&
+                               words == other.words;
+                    }
+
+                private:
+                    std::size_t num_columns_;
+                    std::size_t num_packets_;
+                    std::size_t words_per_column_;
+                    std::vector<word_type> words;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_PACKED_ROUTING_HPP
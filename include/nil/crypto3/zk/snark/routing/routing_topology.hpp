@@ -0,0 +1,178 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a flat routing network topology and of its process-wide cache.
+//
+// A topology lists, for every column and packet of a routing network, the
+// destinations of the packet in the next column in straight and cross settings.
+// The flat layout keeps all of them in a single array. The topology only depends
+// on the network and its number of packets, so routing_topology_cache builds it
+// once per size and shares it, read-only, between all the routers and circuit
+// builders of the process.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_ROUTING_TOPOLOGY_HPP
+#define CRYPTO3_ZK_ROUTING_TOPOLOGY_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * The topology of a routing network with num_columns columns of num_packets packets,
+                 * entry (column_idx, packet_idx) being stored at column_idx * num_packets + packet_idx.
+                 */
+                class routing_topology {
+                public:
+                    typedef std::pair<std::size_t, std::size_t> destinations_type;
+
+                    routing_topology() : num_columns_(0), num_packets_(0) {
+                    }
+
+                    routing_topology(const std::size_t num_columns, const std::size_t num_packets) :
+                        num_columns_(num_columns), num_packets_(num_packets),
+                        destinations(num_columns * num_packets, destinations_type(-1, -1)) {
+                    }
+
+                    /**
+                     * Flattens a topology in the nested layout of as_waksman_topology and
+                     * benes_topology.
+                     */
+                    explicit routing_topology(const std::vector<std::vector<destinations_type>> &topology) :
+                        num_columns_(topology.size()), num_packets_(topology.empty() ? 0 : topology[0].size()) {
+                        destinations.reserve(num_columns_ * num_packets_);
+                        for (const std::vector<destinations_type> &column : topology) {
+                            destinations.insert(destinations.end(), column.begin(), column.end());
+                        }
+                    }
+
+                    std::size_t num_columns() const {
+                        return num_columns_;
+                    }
+
+                    std::size_t num_packets() const {
+                        return num_packets_;
+                    }
+
+                    const destinations_type &operator()(const std::size_t column_idx,
+                                                        const std::size_t packet_idx) const {
+                        return destinations[column_idx * num_packets_ + packet_idx];
+                    }
+
+                    destinations_type &operator()(const std::size_t column_idx, const std::size_t packet_idx) {
+                        return destinations[column_idx * num_packets_ + packet_idx];
+                    }
+
+                    /**
+                     * The topology in the nested layout.
+                     */
+                    std::vector<std::vector<destinations_type>> to_nested() const {
+                        std::vector<std::vector<destinations_type>> result(num_columns_);
+                        for (std::size_t column_idx = 0; column_idx < num_columns_; ++column_idx) {
+                            result[column_idx].assign(destinations.begin() + column_idx * num_packets_,
+                                                      destinations.begin() + (column_idx + 1) * num_packets_);
+                        }
+                        return result;
+                    }
+
+                    std::size_t size_in_bytes() const {
+                        return destinations.capacity() * sizeof(destinations_type);
+                    }
+
+                    bool operator==(const routing_topology &other) const {
+                        return num_columns_ == other.num_columns_ && num_packets_ == other.num_packets_ &&
+                               destinations == other.destinations;
+                    }
+
+                private:
+                    std::size_t num_columns_;
+                    std::size_t num_packets_;
+                    std::vector<destinations_type> destinations;
+                };
+
+                /**
+                 * Process-wide cache of the topologies of the network tagged NetworkTag, by number of
+                 * packets. Lookups are thread-safe; a missing topology is built outside of the lock,
+                 * so building a large network does not hold up lookups of other sizes.
+                 */
+                template<typename NetworkTag>
+                class routing_topology_cache {
+                public:
+                    typedef std::shared_ptr<const routing_topology> topology_pointer;
+
+                    /**
+                     * The topology for num_packets packets, built by build(num_packets) on the first
+                     * request for this size.
+                     */
+                    template<typename Builder>
+                    static topology_pointer get(const std::size_t num_packets, Builder build) {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex());
+                            const typename std::map<std::size_t, topology_pointer>::const_iterator it =
+                                entries().find(num_packets);
+                            if (it != entries().end()) {
+                                return it->second;
+                            }
+                        }
+
+                        topology_pointer topology = std::make_shared<const routing_topology>(build(num_packets));
+
+                        std::lock_guard<std::mutex> lock(mutex());
+                        // another thread may have built the same size meanwhile: keep the first one
+                        return entries().emplace(num_packets, std::move(topology)).first->second;
+                    }
+
+                    /**
+                     * Releases the cached topologies; those still referenced stay alive with their owners.
+                     */
+                    static void clear() {
+                        std::lock_guard<std::mutex> lock(mutex());
+                        entries().clear();
+                    }
+
+                private:
+                    static std::mutex &mutex() {
+                        static std::mutex m;
+                        return m;
+                    }
+
+                    static std::map<std::size_t, topology_pointer> &entries() {
+                        static std::map<std::size_t, topology_pointer> e;
+                        return e;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_ROUTING_TOPOLOGY_HPP
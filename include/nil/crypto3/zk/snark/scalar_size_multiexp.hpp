@@ -0,0 +1,244 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the scalar-size-aware multi-exponentiation.
+//
+// Many witness values are bits or small integers, the output of range checks and bit
+// decompositions, yet a multi-exponentiation runs the bucket passes of the full scalar
+// width over all of them. A scalar_size_partition sorts the terms into classes of at most
+// 8, 16, 32 and 64 bits; each class is evaluated with a bucket method over as many windows
+// as its width needs, and the wider scalars, together with the zero and unit ones, are
+// left to the full-width multi-exponentiation, which skips the former and adds the latter.
+//
+// The partition is computed from the scalars by classify, so that every classified scalar
+// is known to fit in the width of its class.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SCALAR_SIZE_MULTIEXP_HPP
+#define CRYPTO3_ZK_SCALAR_SIZE_MULTIEXP_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * The positions of the terms of a multi-exponentiation whose scalars have at most 8, 16, 32
+                 * or 64 bits, one class per width. Scalars of at most one bit and wider ones belong to no
+                 * class.
+                 */
+                struct scalar_size_partition {
+                    static constexpr const std::size_t num_classes = 4;
+
+                    std::array<std::vector<std::size_t>, num_classes> positions;
+
+                    /* Bit width of class c. */
+                    static constexpr std::size_t class_bits(const std::size_t c) {
+                        return std::size_t(8) << c;
+                    }
+
+                    /* Class of a scalar of the given bit length, num_classes if it belongs to none. */
+                    static std::size_t class_of(const std::size_t bits) {
+                        if (bits <= 1) {
+                            return num_classes;
+                        }
+                        for (std::size_t c = 0; c < num_classes; ++c) {
+                            if (bits <= class_bits(c)) {
+                                return c;
+                            }
+                        }
+                        return num_classes;
+                    }
+
+                    /* Number of terms in some class. */
+                    std::size_t size() const {
+                        std::size_t result = 0;
+                        for (const std::vector<std::size_t> &class_positions : positions) {
+                            result += class_positions.size();
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Partition of the scalars [scalars_first, scalars_last) after their bit lengths, on
+                     * the current executor.
+                     */
+                    template<typename InputFieldIterator>
+                    static scalar_size_partition classify(InputFieldIterator scalars_first,
+                                                          InputFieldIterator scalars_last) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+
+                        const std::size_t n = std::distance(scalars_first, scalars_last);
+                        std::vector<std::uint8_t> classes(n);
+                        executor::current().parallel_for(n, [&](const std::size_t i) {
+                            const auto &scalar = *(scalars_first + i);
+                            classes[i] = scalar.is_zero() ?
+                                             num_classes :
+                                             class_of(multiprecision::msb(integral_type(scalar.data)) + 1);
+                        });
+
+                        scalar_size_partition result;
+                        for (std::size_t i = 0; i < n; ++i) {
+                            if (classes[i] < num_classes) {
+                                result.positions[classes[i]].emplace_back(i);
+                            }
+                        }
+                        return result;
+                    }
+                };
+
+                namespace detail {
+                    /**
+                     * sum_i scalar_i * base_i over the terms at positions, all of whose scalars fit in bits
+                     * bits, by a bucket method over ceil(bits / window) windows.
+                     */
+                    template<typename InputBaseIterator, typename InputFieldIterator>
+                    typename std::iterator_traits<InputBaseIterator>::value_type
+                        small_scalar_multiexp(InputBaseIterator bases_first, InputFieldIterator scalars_first,
+                                              const std::vector<std::size_t> &positions, const std::size_t bits,
+                                              const std::size_t chunks) {
+                        typedef typename std::iterator_traits<InputBaseIterator>::value_type value_type;
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+
+                        const std::size_t num_chunks =
+                            std::max<std::size_t>(1, std::min(chunks, positions.size() / 64 + 1));
+                        const std::size_t chunk_size = (positions.size() + num_chunks - 1) / num_chunks;
+
+                        std::vector<value_type> partial(num_chunks, value_type::zero());
+                        executor::current().bulk(num_chunks, [&](const std::size_t chunk) {
+                            const std::size_t begin = std::min(positions.size(), chunk * chunk_size);
+                            const std::size_t end = std::min(positions.size(), begin + chunk_size);
+                            if (begin == end) {
+                                return;
+                            }
+
+                            std::vector<std::uint64_t> values(end - begin);
+                            for (std::size_t i = begin; i < end; ++i) {
+                                const integral_type value((*(scalars_first + positions[i])).data);
+                                BOOST_ASSERT(bits == 64 || value >> bits == 0);
+                                values[i - begin] = static_cast<std::uint64_t>(value);
+                            }
+
+                            /* about log2 of the number of terms, as for a full-width bucket method */
+                            std::size_t window = 1;
+                            while (window < bits && (std::size_t(4) << window) < values.size()) {
+                                ++window;
+                            }
+                            window = std::min<std::size_t>(window, 16);
+                            const std::size_t num_windows = (bits + window - 1) / window;
+                            const std::uint64_t mask = (std::uint64_t(1) << window) - 1;
+
+                            std::vector<value_type> buckets(std::size_t(1) << window);
+                            value_type result = value_type::zero();
+                            for (std::size_t w = num_windows; w-- > 0;) {
+                                for (std::size_t k = 0; k < window; ++k) {
+                                    result = result.doubled();
+                                }
+
+                                std::fill(buckets.begin(), buckets.end(), value_type::zero());
+                                for (std::size_t i = begin; i < end; ++i) {
+                                    const std::size_t shift = w * window;
+                                    const std::size_t digit =
+                                        shift < 64 ? static_cast<std::size_t>((values[i - begin] >> shift) & mask) : 0;
+                                    if (digit) {
+                                        buckets[digit] = buckets[digit] + *(bases_first + positions[i]);
+                                    }
+                                }
+
+                                // sum_d d * buckets[d] via running sums
+                                value_type running = value_type::zero();
+                                value_type window_sum = value_type::zero();
+                                for (std::size_t d = buckets.size() - 1; d > 0; --d) {
+                                    running = running + buckets[d];
+                                    window_sum = window_sum + running;
+                                }
+                                result = result + window_sum;
+                            }
+                            partial[chunk] = result;
+                        });
+
+                        value_type result = value_type::zero();
+                        for (const value_type &p : partial) {
+                            result = result + p;
+                        }
+                        return result;
+                    }
+                }    // namespace detail
+
+                /**
+                 * sum_i scalar_i * base_i over [bases_first, bases_first + n), n being the number of
+                 * scalars, the terms of every class of partition being evaluated over the windows of its
+                 * width. The other terms are handed to full_width_multiexp(scalars_first, scalars_last) with
+                 * the scalars of the classified terms replaced by zero, which it has to skip.
+                 */
+                template<typename InputBaseIterator, typename InputFieldIterator, typename FullWidthMultiexp>
+                typename std::iterator_traits<InputBaseIterator>::value_type
+                    scalar_size_multiexp(InputBaseIterator bases_first, InputFieldIterator scalars_first,
+                                         InputFieldIterator scalars_last, const scalar_size_partition &partition,
+                                         const std::size_t chunks, FullWidthMultiexp full_width_multiexp) {
+                    typedef typename std::iterator_traits<InputBaseIterator>::value_type value_type;
+                    typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
+
+                    if (!partition.size()) {
+                        return full_width_multiexp(scalars_first, scalars_last);
+                    }
+
+                    thread_local std::vector<field_value_type> wide_scalars;
+                    wide_scalars.assign(scalars_first, scalars_last);
+                    for (const std::vector<std::size_t> &class_positions : partition.positions) {
+                        for (const std::size_t position : class_positions) {
+                            wide_scalars[position] = field_value_type::zero();
+                        }
+                    }
+
+                    value_type result = full_width_multiexp(wide_scalars.cbegin(), wide_scalars.cend());
+                    for (std::size_t c = 0; c < scalar_size_partition::num_classes; ++c) {
+                        if (!partition.positions[c].empty()) {
+                            result = result + detail::small_scalar_multiexp(bases_first, scalars_first,
+                                                                            partition.positions[c],
+                                                                            scalar_size_partition::class_bits(c),
+                                                                            chunks);
+                        }
+                    }
+                    return result;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SCALAR_SIZE_MULTIEXP_HPP
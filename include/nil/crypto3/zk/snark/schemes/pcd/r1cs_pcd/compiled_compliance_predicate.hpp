@@ -0,0 +1,266 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a compiled form of a compliance predicate for R1CS PCD.
+//
+// r1cs_pcd_compliance_predicate::is_satisfied concatenates the messages, the
+// local data and the witness into a full variable assignment before checking
+// the constraint system. The compiled predicate instead keeps the constraints as
+// flat A, B and C matrices (see r1cs_witness_program.hpp), and resolves every
+// entry once to the segment of the assignment holding its variable and its
+// offset there: the types and the arity, the outgoing payload, every incoming
+// payload, the local data or the witness. It then evaluates the constraints
+// directly over the payload buffers of the messages.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_COMPILED_COMPLIANCE_PREDICATE_HPP
+#define CRYPTO3_ZK_COMPILED_COMPLIANCE_PREDICATE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/input_span.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/compliance_predicate.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * A message for R1CS PCD as its type and a view of its payload.
+                 */
+                template<typename FieldType>
+                struct r1cs_pcd_message_view {
+                    std::size_t type;
+                    r1cs_variable_assignment_span<FieldType> payload;
+                };
+
+                /**
+                 * A compliance predicate compiled for evaluation over message payload buffers.
+                 *
+                 * The variables of the predicate are looked up in segments: segment 0 is the header
+                 * (1, outgoing type, arity, incoming types), the constant 1 standing first so that
+                 * column 0 needs no special case, segment 1 the outgoing payload, segments 2 to
+                 * 1 + max_arity the incoming payloads, then the local data and the witness.
+                 */
+                template<typename FieldType>
+                class r1cs_pcd_compiled_compliance_predicate {
+                public:
+                    typedef typename FieldType::value_type field_value_type;
+                    typedef r1cs_variable_assignment_span<FieldType> span_type;
+                    typedef r1cs_pcd_message_view<FieldType> message_view_type;
+
+                    /* the element offset of a variable in its segment */
+                    struct location_type {
+                        std::uint32_t segment;
+                        std::uint32_t offset;
+                    };
+
+                    std::size_t type;
+                    std::size_t outgoing_message_payload_length;
+                    std::vector<std::size_t> incoming_message_payload_lengths;
+                    std::size_t local_data_length;
+                    std::size_t witness_length;
+
+                    r1cs_witness_program<FieldType> program;
+                    /* locations of the entries of program.a, program.b and program.c */
+                    std::vector<location_type> a_locations, b_locations, c_locations;
+
+                    explicit r1cs_pcd_compiled_compliance_predicate(
+                        const r1cs_pcd_compliance_predicate<FieldType> &predicate) :
+                        type(predicate.type),
+                        outgoing_message_payload_length(predicate.outgoing_message_payload_length),
+                        incoming_message_payload_lengths(predicate.incoming_message_payload_lengths),
+                        local_data_length(predicate.local_data_length), witness_length(predicate.witness_length),
+                        program(predicate.constraint_system),
+                        zeros(incoming_message_payload_lengths.empty() ?
+                                  0 :
+                                  *std::max_element(incoming_message_payload_lengths.begin(),
+                                                    incoming_message_payload_lengths.end()),
+                              field_value_type::zero()) {
+                        assert(predicate.is_well_formed());
+
+                        const std::vector<location_type> layout = assignment_layout();
+                        a_locations = locate(program.a, layout);
+                        b_locations = locate(program.b, layout);
+                        c_locations = locate(program.c, layout);
+                    }
+
+                    std::size_t max_arity() const {
+                        return incoming_message_payload_lengths.size();
+                    }
+
+                    std::size_t num_segments() const {
+                        return 4 + max_arity();
+                    }
+
+                    /**
+                     * Whether the predicate accepts the outgoing message given the incoming messages, fewer
+                     * than max_arity of them being padded with zero messages, the local data and the witness,
+                     * as r1cs_pcd_compliance_predicate::is_satisfied does.
+                     */
+                    bool is_satisfied(const message_view_type &outgoing_message,
+                                      const input_span<message_view_type> &incoming_messages,
+                                      const span_type &local_data,
+                                      const span_type &witness) const {
+                        assert(outgoing_message.payload.size() == outgoing_message_payload_length);
+                        assert(incoming_messages.size() <= max_arity());
+                        assert(local_data.size() == local_data_length);
+                        assert(witness.size() == witness_length);
+
+                        std::vector<field_value_type> header(3 + max_arity(), field_value_type::zero());
+                        std::vector<const field_value_type *> segments(num_segments());
+
+                        header[0] = field_value_type::one();
+                        header[1] = field_value_type(outgoing_message.type);
+                        header[2] = field_value_type(incoming_messages.size());
+                        segments[0] = header.data();
+                        segments[1] = outgoing_message.payload.data();
+                        for (std::size_t i = 0; i < max_arity(); ++i) {
+                            if (i < incoming_messages.size()) {
+                                assert(incoming_messages[i].payload.size() == incoming_message_payload_lengths[i]);
+                                header[3 + i] = field_value_type(incoming_messages[i].type);
+                                segments[2 + i] = incoming_messages[i].payload.data();
+                            } else {
+                                segments[2 + i] = zeros.data();
+                            }
+                        }
+                        segments[2 + max_arity()] = local_data.data();
+                        segments[3 + max_arity()] = witness.data();
+
+                        for (std::size_t i = 0; i < program.num_constraints(); ++i) {
+                            if (!(evaluate_row(program.a, a_locations, i, segments) *
+                                      evaluate_row(program.b, b_locations, i, segments) ==
+                                  evaluate_row(program.c, c_locations, i, segments))) {
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                    /**
+                     * Same as above for the messages and the local data of a PCD node, whose payloads are
+                     * each produced once and then evaluated in place.
+                     */
+                    bool
+                        is_satisfied(const std::shared_ptr<r1cs_pcd_message<FieldType>> &outgoing_message,
+                                     const std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> &incoming_messages,
+                                     const std::shared_ptr<r1cs_pcd_local_data<FieldType>> &local_data,
+                                     const r1cs_pcd_witness<FieldType> &witness) const {
+                        const r1cs_variable_assignment<FieldType> outgoing_payload =
+                            outgoing_message->payload_as_r1cs_variable_assignment();
+                        std::vector<r1cs_variable_assignment<FieldType>> incoming_payloads;
+                        std::vector<message_view_type> incoming_views;
+                        incoming_payloads.reserve(incoming_messages.size());
+                        incoming_views.reserve(incoming_messages.size());
+                        for (const std::shared_ptr<r1cs_pcd_message<FieldType>> &message : incoming_messages) {
+                            incoming_payloads.emplace_back(message->payload_as_r1cs_variable_assignment());
+                            incoming_views.push_back(message_view_type {message->type, incoming_payloads.back()});
+                        }
+                        const r1cs_variable_assignment<FieldType> local_data_values =
+                            local_data->as_r1cs_variable_assignment();
+
+                        return is_satisfied(message_view_type {outgoing_message->type, outgoing_payload},
+                                            incoming_views, local_data_values, witness);
+                    }
+
+                private:
+                    /* zero payload of the incoming messages beyond the arity */
+                    std::vector<field_value_type> zeros;
+
+                    /**
+                     * The location of every variable of the predicate, the constant 1 first, in the order
+                     * documented by r1cs_pcd_compliance_predicate.
+                     */
+                    std::vector<location_type> assignment_layout() const {
+                        std::vector<location_type> layout;
+                        layout.reserve(1 + program.num_variables());
+
+                        const auto append = [&layout](const std::size_t segment, const std::size_t count) {
+                            for (std::size_t offset = 0; offset < count; ++offset) {
+                                layout.push_back(location_type {static_cast<std::uint32_t>(segment),
+                                                                static_cast<std::uint32_t>(offset)});
+                            }
+                        };
+
+                        /* 1 and the outgoing message type */
+                        append(0, 2);
+                        append(1, outgoing_message_payload_length);
+                        /* arity */
+                        layout.push_back(location_type {0, 2});
+                        for (std::size_t i = 0; i < max_arity(); ++i) {
+                            layout.push_back(location_type {0, static_cast<std::uint32_t>(3 + i)});
+                            append(2 + i, incoming_message_payload_lengths[i]);
+                        }
+                        append(2 + max_arity(), local_data_length);
+                        append(3 + max_arity(), witness_length);
+
+                        assert(layout.size() == 1 + program.num_variables());
+                        return layout;
+                    }
+
+                    static std::vector<location_type> locate(const r1cs_sparse_matrix<FieldType> &matrix,
+                                                             const std::vector<location_type> &layout) {
+                        std::vector<location_type> locations;
+                        locations.reserve(matrix.num_entries());
+                        for (const std::size_t column : matrix.columns) {
+                            locations.push_back(layout[column]);
+                        }
+                        return locations;
+                    }
+
+                    /* entries with coefficient 1 or -1 need no multiplication, as in r1cs_sparse_matrix */
+                    static field_value_type evaluate_row(const r1cs_sparse_matrix<FieldType> &matrix,
+                                                         const std::vector<location_type> &locations,
+                                                         const std::size_t row,
+                                                         const std::vector<const field_value_type *> &segments) {
+                        const field_value_type one = field_value_type::one();
+                        const field_value_type minus_one = -one;
+                        field_value_type acc = field_value_type::zero();
+                        for (std::size_t k = matrix.row_offsets[row]; k < matrix.row_offsets[row + 1]; ++k) {
+                            const field_value_type &value = segments[locations[k].segment][locations[k].offset];
+                            if (matrix.coefficients[k] == one) {
+                                acc += value;
+                            } else if (matrix.coefficients[k] == minus_one) {
+                                acc -= value;
+                            } else {
+                                acc += value * matrix.coefficients[k];
+                            }
+                        }
+                        return acc;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_COMPILED_COMPLIANCE_PREDICATE_HPP
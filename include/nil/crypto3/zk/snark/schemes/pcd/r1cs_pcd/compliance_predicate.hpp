@@ -259,14 +259,14 @@ namespace nil {
                     const std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> &incoming_messages,
                     const std::shared_ptr<r1cs_pcd_local_data<FieldType>> &local_data,
                     const r1cs_pcd_witness<FieldType> &witness) const {
-                    assert(outgoing_message.payload_as_r1cs_variable_assignment().size() ==
+                    assert(outgoing_message->payload_as_r1cs_variable_assignment().size() ==
                            outgoing_message_payload_length);
                     assert(incoming_messages.size() <= max_arity);
                     for (std::size_t i = 0; i < incoming_messages.size(); ++i) {
-                        assert(incoming_messages[i].payload_as_r1cs_variable_assignment().size() ==
+                        assert(incoming_messages[i]->payload_as_r1cs_variable_assignment().size() ==
                                incoming_message_payload_lengths[i]);
                     }
-                    assert(local_data.as_r1cs_variable_assignment().size() == local_data_length);
+                    assert(local_data->as_r1cs_variable_assignment().size() == local_data_length);
 
                     r1cs_pcd_compliance_predicate_primary_input<FieldType> cp_primary_input(outgoing_message);
                     r1cs_pcd_compliance_predicate_auxiliary_input<FieldType> cp_auxiliary_input(incoming_messages,
@@ -0,0 +1,168 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+//---------------------------------------------------------------------------//
+// @file Declaration of a scheduler proving the nodes of a PCD computation in parallel.
+//
+// A PCD computation is a DAG: a node is proven from the proofs of the nodes whose
+// outgoing messages it consumes, and nodes with no path between them are
+// independent. The scheduler keeps the nodes whose inputs are all proven in a
+// ready queue, from which the workers of the current executor take them, and a
+// node becomes ready as soon as its last input is proven. Its latency thus
+// follows the depth of the DAG rather than its number of nodes, and a parent is
+// proven while unrelated subtrees are still in progress.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_PCD_DAG_SCHEDULER_HPP
+#define CRYPTO3_ZK_PCD_DAG_SCHEDULER_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Proves the nodes of the PCD DAG where node node_idx consumes the messages of the nodes
+                 * incoming_nodes[node_idx], and returns their proofs.
+                 *
+                 * Every worker of the current executor calls make_node_prover() once and proves its nodes
+                 * through the returned callable by node_prover(node_idx, incoming_proofs), incoming_proofs
+                 * being the proofs of incoming_nodes[node_idx] in that order. The node provers own the
+                 * state that is not shared across threads, such as a prover context and the handler of
+                 * the compliance predicate. Everything a node prover writes while proving a node, e.g.
+                 * its outgoing message, is visible to the provers of the nodes consuming it.
+                 *
+                 * An exception thrown by make_node_prover() or by a node prover stops the scheduling and is
+                 * rethrown once all the workers are done.
+                 */
+                template<typename ProofType, typename MakeNodeProver>
+                std::vector<ProofType> prove_pcd_dag(const std::vector<std::vector<std::size_t>> &incoming_nodes,
+                                                     MakeNodeProver make_node_prover) {
+                    const std::size_t num_nodes = incoming_nodes.size();
+
+                    std::vector<ProofType> proofs(num_nodes);
+                    std::vector<std::size_t> num_pending_inputs(num_nodes);
+                    std::vector<std::vector<std::size_t>> outgoing_nodes(num_nodes);
+                    std::deque<std::size_t> ready;
+                    for (std::size_t node_idx = 0; node_idx < num_nodes; ++node_idx) {
+                        num_pending_inputs[node_idx] = incoming_nodes[node_idx].size();
+                        for (const std::size_t input_idx : incoming_nodes[node_idx]) {
+                            assert(input_idx < num_nodes);
+                            outgoing_nodes[input_idx].emplace_back(node_idx);
+                        }
+                        if (incoming_nodes[node_idx].empty()) {
+                            ready.emplace_back(node_idx);
+                        }
+                    }
+
+                    std::mutex mutex;
+                    std::condition_variable progress;
+                    std::size_t num_unproven = num_nodes, num_in_progress = 0;
+                    std::exception_ptr failure;
+
+                    /**
+                     * A worker only waits while another one is proving a node, so workers which the
+                     * executor runs one after the other never wait for each other, and a cycle stops
+                     * the workers once nothing is in progress.
+                     */
+                    const std::size_t num_workers =
+                        std::max<std::size_t>(1, std::min(num_nodes, executor::current().concurrency()));
+                    executor::current().bulk(num_workers, [&](std::size_t) {
+                        boost::optional<decltype(make_node_prover())> node_prover;
+                        try {
+                            node_prover.emplace(make_node_prover());
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            failure = std::current_exception();
+                            progress.notify_all();
+                            return;
+                        }
+
+                        std::unique_lock<std::mutex> lock(mutex);
+                        while (true) {
+                            progress.wait(lock, [&] { return !ready.empty() || !num_in_progress || failure; });
+                            if (ready.empty() || failure) {
+                                break;
+                            }
+
+                            const std::size_t node_idx = ready.front();
+                            ready.pop_front();
+                            ++num_in_progress;
+
+                            std::vector<ProofType> incoming_proofs;
+                            incoming_proofs.reserve(incoming_nodes[node_idx].size());
+                            for (const std::size_t input_idx : incoming_nodes[node_idx]) {
+                                incoming_proofs.emplace_back(proofs[input_idx]);
+                            }
+
+                            lock.unlock();
+                            ProofType proof;
+                            try {
+                                proof = (*node_prover)(node_idx, incoming_proofs);
+                            } catch (...) {
+                                lock.lock();
+                                failure = std::current_exception();
+                                progress.notify_all();
+                                break;
+                            }
+                            lock.lock();
+
+                            proofs[node_idx] = std::move(proof);
+                            --num_unproven;
+                            --num_in_progress;
+                            for (const std::size_t output_idx : outgoing_nodes[node_idx]) {
+                                if (!--num_pending_inputs[output_idx]) {
+                                    ready.emplace_back(output_idx);
+                                }
+                            }
+                            progress.notify_all();
+                        }
+                    });
+
+                    if (failure) {
+                        std::rethrow_exception(failure);
+                    }
+                    assert(!num_unproven); /* otherwise the graph has a cycle */
+
+                    return proofs;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_PCD_DAG_SCHEDULER_HPP
@@ -0,0 +1,563 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+//---------------------------------------------------------------------------//
+// @file Declaration of a memory-mapped storage of the R1CS (multi-predicate) ppzkPCD keypair.
+//
+// The keypair produced by r1cs_mp_ppzkpcd_generator is written once into a file
+// with a fixed binary layout: a header, the verification keys of all the steps
+// along with the commitment to the translation step verification keys and its
+// membership proofs, the proving keys of the steps of every compliance
+// predicate, and a directory of the latter. Arrays are stored as a count followed
+// by a 64-byte aligned copy of the native representation of their elements, and
+// the constraint systems of the proving keys in compressed sparse row layout.
+//
+// Opening the file maps it and copies the verification part, which is small, out of
+// it. The proving keys of a compliance predicate are copied out of the mapping by
+// load(), which the caller runs for every predicate it proves before proving with
+// it; nothing is loaded implicitly. A service thus starts without running the
+// generator, and neither reads nor holds in memory the keys of the predicates it
+// does not prove. The layout is tied to the in-memory representation of the group
+// and field elements, hence to the build that produced it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_MP_PPZKPCD_MAPPED_KEYPAIR_HPP
+#define CRYPTO3_R1CS_MP_PPZKPCD_MAPPED_KEYPAIR_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/r1cs_mp_ppzkpcd.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+
+                    constexpr static const std::size_t mapped_keypair_alignment = 64;
+
+                    /**
+                     * Sequential writer of the sections of a mapped keypair file.
+                     */
+                    class mapped_keypair_writer {
+                    public:
+                        explicit mapped_keypair_writer(const std::string &path) :
+                            out(path, std::ios::binary | std::ios::trunc), offset(0) {
+                            if (!out) {
+                                throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: cannot write " + path);
+                            }
+                        }
+
+                        std::uint64_t position() const {
+                            return offset;
+                        }
+
+                        /* Pads the file up to the next aligned offset */
+                        void align() {
+                            while (offset % mapped_keypair_alignment) {
+                                out.put(0);
+                                ++offset;
+                            }
+                        }
+
+                        /* Writes value unframed at offset at, which may lie before the current position */
+                        template<typename T>
+                        void write_raw(std::uint64_t at, const T &value) {
+                            static_assert(std::is_trivially_copyable<T>::value, "value must be trivially copyable");
+                            out.seekp(at);
+                            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+                            if (at + sizeof(T) > offset) {
+                                offset = at + sizeof(T);
+                            }
+                            out.seekp(offset);
+                        }
+
+                        template<typename T>
+                        void write_array(const T *data, const std::size_t count) {
+                            static_assert(std::is_trivially_copyable<T>::value,
+                                          "elements must be trivially copyable to be memory-mapped");
+                            const std::uint64_t size = count;
+                            out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+                            offset += sizeof(size);
+                            align();
+                            out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+                            offset += count * sizeof(T);
+                        }
+
+                        template<typename T>
+                        void write_value(const T &value) {
+                            write_array(&value, 1);
+                        }
+
+                        template<typename T>
+                        void write(const std::vector<T> &v) {
+                            write_array(v.data(), v.size());
+                        }
+
+                        void write(const std::vector<bool> &v) {
+                            const std::vector<std::uint8_t> bytes(v.begin(), v.end());
+                            write(bytes);
+                        }
+
+                        void write(const std::vector<std::vector<bool>> &v) {
+                            write_value<std::uint64_t>(v.size());
+                            for (const std::vector<bool> &bits : v) {
+                                write(bits);
+                            }
+                        }
+
+                        template<typename Type>
+                        void write(const sparse_vector<Type> &v) {
+                            write_value<std::uint64_t>(v.domain_size_);
+                            write(std::vector<std::uint64_t>(v.indices.begin(), v.indices.end()));
+                            write(v.values);
+                        }
+
+                        template<typename Type>
+                        void write(const accumulation_vector<Type> &v) {
+                            write_value(v.first);
+                            write(v.rest);
+                        }
+
+                        template<typename FieldType>
+                        void write(const r1cs_sparse_matrix<FieldType> &m) {
+                            write(std::vector<std::uint64_t>(m.row_offsets.begin(), m.row_offsets.end()));
+                            write(std::vector<std::uint64_t>(m.columns.begin(), m.columns.end()));
+                            write(m.coefficients);
+                        }
+
+                        template<typename FieldType>
+                        void write(const r1cs_constraint_system<FieldType> &cs) {
+                            const r1cs_witness_program<FieldType> program(cs);
+                            write_value<std::uint64_t>(program.primary_input_size);
+                            write_value<std::uint64_t>(program.auxiliary_input_size);
+                            write(program.a);
+                            write(program.b);
+                            write(program.c);
+                        }
+
+                        template<typename CurveType, typename ConstraintSystemType>
+                        void write(const r1cs_ppzksnark_proving_key<CurveType, ConstraintSystemType> &pk) {
+                            write(pk.A_query);
+                            write(pk.B_query);
+                            write(pk.C_query);
+                            write(pk.H_query);
+                            write(pk.K_query);
+                            write(pk.constraint_system);
+                        }
+
+                        template<typename CurveType>
+                        void write(const r1cs_ppzksnark_verification_key<CurveType> &vk) {
+                            write_value(vk.alphaA_g2);
+                            write_value(vk.alphaB_g1);
+                            write_value(vk.alphaC_g2);
+                            write_value(vk.gamma_g2);
+                            write_value(vk.gamma_beta_g1);
+                            write_value(vk.gamma_beta_g2);
+                            write_value(vk.rC_Z_g2);
+                            write(vk.encoded_IC_query);
+                        }
+
+                        void write(const set_membership_proof &proof) {
+                            write_value<std::uint64_t>(proof.address);
+                            write(proof.merkle_path);
+                        }
+
+                        void close() {
+                            align();
+                            out.close();
+                            if (!out) {
+                                throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: write failed");
+                            }
+                        }
+
+                    private:
+                        std::ofstream out;
+                        std::uint64_t offset;
+                    };
+
+                    /**
+                     * Reader of the sections of a mapped keypair file, copying them out of the mapping
+                     * in the order mapped_keypair_writer wrote them.
+                     */
+                    class mapped_keypair_reader {
+                    public:
+                        mapped_keypair_reader(const char *data, const std::uint64_t size, const std::uint64_t offset) :
+                            data(data), size(size), offset(offset) {
+                        }
+
+                        template<typename T>
+                        void read_array(std::vector<T> &v) {
+                            const std::uint64_t count = *section<std::uint64_t>(sizeof(std::uint64_t));
+                            offset += sizeof(std::uint64_t);
+                            offset = (offset + mapped_keypair_alignment - 1) / mapped_keypair_alignment *
+                                     mapped_keypair_alignment;
+                            // the padding may already run past the end of a truncated file
+                            if (offset > size || count > (size - offset) / sizeof(T)) {
+                                throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: truncated file");
+                            }
+                            const T *first = reinterpret_cast<const T *>(data + offset);
+                            v.assign(first, first + count);
+                            offset += count * sizeof(T);
+                        }
+
+                        template<typename T>
+                        T read_value() {
+                            std::vector<T> v;
+                            read_array(v);
+                            if (v.size() != 1) {
+                                throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: malformed file");
+                            }
+                            return v[0];
+                        }
+
+                        template<typename T>
+                        void read(std::vector<T> &v) {
+                            read_array(v);
+                        }
+
+                        void read(std::vector<bool> &v) {
+                            std::vector<std::uint8_t> bytes;
+                            read(bytes);
+                            v.assign(bytes.begin(), bytes.end());
+                        }
+
+                        void read(std::vector<std::vector<bool>> &v) {
+                            v.resize(read_value<std::uint64_t>());
+                            for (std::vector<bool> &bits : v) {
+                                read(bits);
+                            }
+                        }
+
+                        template<typename Type>
+                        void read(sparse_vector<Type> &v) {
+                            v.domain_size_ = read_value<std::uint64_t>();
+                            std::vector<std::uint64_t> indices;
+                            read(indices);
+                            v.indices.assign(indices.begin(), indices.end());
+                            read(v.values);
+                        }
+
+                        template<typename Type>
+                        void read(accumulation_vector<Type> &v) {
+                            v.first = read_value<typename accumulation_vector<Type>::underlying_value_type>();
+                            read(v.rest);
+                        }
+
+                        template<typename FieldType>
+                        void read(r1cs_sparse_matrix<FieldType> &m) {
+                            std::vector<std::uint64_t> row_offsets, columns;
+                            read(row_offsets);
+                            read(columns);
+                            m.row_offsets.assign(row_offsets.begin(), row_offsets.end());
+                            m.columns.assign(columns.begin(), columns.end());
+                            read(m.coefficients);
+                        }
+
+                        template<typename FieldType>
+                        void read(r1cs_constraint_system<FieldType> &cs) {
+                            r1cs_witness_program<FieldType> program;
+                            program.primary_input_size = read_value<std::uint64_t>();
+                            program.auxiliary_input_size = read_value<std::uint64_t>();
+                            read(program.a);
+                            read(program.b);
+                            read(program.c);
+                            if (!program.is_valid()) {
+                                throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: malformed constraint system");
+                            }
+                            cs = program.to_constraint_system();
+                        }
+
+                        template<typename CurveType, typename ConstraintSystemType>
+                        void read(r1cs_ppzksnark_proving_key<CurveType, ConstraintSystemType> &pk) {
+                            read(pk.A_query);
+                            read(pk.B_query);
+                            read(pk.C_query);
+                            read(pk.H_query);
+                            read(pk.K_query);
+                            read(pk.constraint_system);
+                        }
+
+                        template<typename CurveType>
+                        void read(r1cs_ppzksnark_verification_key<CurveType> &vk) {
+                            typedef typename CurveType::g1_type::value_type g1_value_type;
+                            typedef typename CurveType::g2_type::value_type g2_value_type;
+
+                            vk.alphaA_g2 = read_value<g2_value_type>();
+                            vk.alphaB_g1 = read_value<g1_value_type>();
+                            vk.alphaC_g2 = read_value<g2_value_type>();
+                            vk.gamma_g2 = read_value<g2_value_type>();
+                            vk.gamma_beta_g1 = read_value<g1_value_type>();
+                            vk.gamma_beta_g2 = read_value<g2_value_type>();
+                            vk.rC_Z_g2 = read_value<g2_value_type>();
+                            read(vk.encoded_IC_query);
+                        }
+
+                        void read(set_membership_proof &proof) {
+                            proof.address = read_value<std::uint64_t>();
+                            read(proof.merkle_path);
+                        }
+
+                    private:
+                        template<typename T>
+                        const T *section(const std::uint64_t length) const {
+                            if (offset > size || length > size - offset) {
+                                throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: truncated file");
+                            }
+                            return reinterpret_cast<const T *>(data + offset);
+                        }
+
+                        const char *data;
+                        std::uint64_t size;
+                        std::uint64_t offset;
+                    };
+                }    // namespace detail
+
+                /**
+                 * A keypair of the R1CS (multi-predicate) ppzkPCD stored in a memory-mapped file, whose
+                 * step proving keys are loaded per compliance predicate.
+                 *
+                 * The compliance predicates are not part of the file: the prover builds its step
+                 * circuits from them, so they are provided by the caller when opening the file and
+                 * checked against the names it records. Until a predicate is loaded, its entries of
+                 * compliance_step_r1cs_pks and translation_step_r1cs_pks in pk() are empty; the
+                 * verification keys, the commitment and the membership proofs are always present.
+                 * Loading is not synchronized, so the predicates proven concurrently are loaded
+                 * before the provers start.
+                 */
+                template<typename PCD_ppT>
+                class r1cs_mp_ppzkpcd_mapped_keypair {
+                    typedef typename PCD_ppT::curve_A_pp curve_A_pp;
+                    typedef typename PCD_ppT::curve_B_pp curve_B_pp;
+
+                    static constexpr const std::uint64_t magic = 0x4b50504450504d5aULL;    // "ZMPPDPPK"
+                    static constexpr const std::uint64_t version = 1;
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t curve_A_g1_value_size;
+                        std::uint64_t curve_A_g2_value_size;
+                        std::uint64_t curve_B_g1_value_size;
+                        std::uint64_t curve_B_g2_value_size;
+
+                        std::uint64_t num_predicates;
+                        std::uint64_t verification_offset;
+                        std::uint64_t directory_offset;
+                        std::uint64_t file_size;
+                    };
+
+                    /* Where the step proving keys of one compliance predicate start */
+                    struct directory_entry_type {
+                        std::uint64_t name;
+                        std::uint64_t compliance_step_pk_offset;
+                        std::uint64_t translation_step_pk_offset;
+                    };
+
+                    static_assert(std::is_trivially_copyable<header_type>::value, "header must be trivially copyable");
+
+                    const char *address() const {
+                        return static_cast<const char *>(region.get_address());
+                    }
+
+                    detail::mapped_keypair_reader reader(const std::uint64_t offset) const {
+                        return detail::mapped_keypair_reader(address(), region.get_size(), offset);
+                    }
+
+                    static header_type expected_header() {
+                        header_type h;
+                        std::memset(&h, 0, sizeof(h));
+                        h.magic = magic;
+                        h.version = version;
+                        h.curve_A_g1_value_size = sizeof(typename curve_A_pp::g1_type::value_type);
+                        h.curve_A_g2_value_size = sizeof(typename curve_A_pp::g2_type::value_type);
+                        h.curve_B_g1_value_size = sizeof(typename curve_B_pp::g1_type::value_type);
+                        h.curve_B_g2_value_size = sizeof(typename curve_B_pp::g2_type::value_type);
+                        return h;
+                    }
+
+                    boost::interprocess::file_mapping mapping;
+                    boost::interprocess::mapped_region region;
+
+                    std::vector<directory_entry_type> directory;
+                    std::vector<bool> loaded;
+                    r1cs_mp_ppzkpcd_proving_key<PCD_ppT> pk_;
+                    r1cs_mp_ppzkpcd_verification_key<PCD_ppT> vk_;
+
+                public:
+                    typedef r1cs_mp_ppzkpcd_keypair<PCD_ppT> keypair_type;
+                    typedef r1cs_mp_ppzkpcd_proving_key<PCD_ppT> proving_key_type;
+                    typedef r1cs_mp_ppzkpcd_verification_key<PCD_ppT> verification_key_type;
+
+                    r1cs_mp_ppzkpcd_mapped_keypair() = default;
+                    r1cs_mp_ppzkpcd_mapped_keypair(r1cs_mp_ppzkpcd_mapped_keypair &&other) = default;
+                    r1cs_mp_ppzkpcd_mapped_keypair &operator=(r1cs_mp_ppzkpcd_mapped_keypair &&other) = default;
+
+                    /**
+                     * Maps the keypair file at path, previously produced by write() for the given compliance
+                     * predicates, and reads its verification part.
+                     */
+                    r1cs_mp_ppzkpcd_mapped_keypair(
+                        const std::string &path,
+                        const std::vector<r1cs_mp_ppzkpcd_compliance_predicate<PCD_ppT>> &compliance_predicates) :
+                        mapping(path.c_str(), boost::interprocess::read_only),
+                        region(mapping, boost::interprocess::read_only) {
+                        const header_type expected = expected_header();
+                        header_type h;
+                        if (region.get_size() < sizeof(header_type)) {
+                            throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: incompatible file " + path);
+                        }
+                        std::memcpy(&h, address(), sizeof(h));
+                        if (h.magic != expected.magic || h.version != expected.version ||
+                            h.curve_A_g1_value_size != expected.curve_A_g1_value_size ||
+                            h.curve_A_g2_value_size != expected.curve_A_g2_value_size ||
+                            h.curve_B_g1_value_size != expected.curve_B_g1_value_size ||
+                            h.curve_B_g2_value_size != expected.curve_B_g2_value_size ||
+                            h.file_size != region.get_size() || h.num_predicates != compliance_predicates.size()) {
+                            throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: incompatible file " + path);
+                        }
+
+                        reader(h.directory_offset).read(directory);
+                        if (directory.size() != h.num_predicates) {
+                            throw std::runtime_error("r1cs_mp_ppzkpcd_mapped_keypair: malformed file " + path);
+                        }
+
+                        const std::size_t num_predicates = h.num_predicates;
+                        pk_.compliance_predicates = compliance_predicates;
+                        pk_.compliance_step_r1cs_pks.resize(num_predicates);
+                        pk_.translation_step_r1cs_pks.resize(num_predicates);
+                        pk_.compliance_step_r1cs_vks.resize(num_predicates);
+                        pk_.translation_step_r1cs_vks.resize(num_predicates);
+                        pk_.compliance_step_r1cs_vk_membership_proofs.resize(num_predicates);
+                        loaded.assign(num_predicates, false);
+
+                        detail::mapped_keypair_reader verification = reader(h.verification_offset);
+                        verification.read(pk_.commitment_to_translation_step_r1cs_vks);
+                        for (std::size_t i = 0; i < num_predicates; ++i) {
+                            if (directory[i].name != compliance_predicates[i].name) {
+                                throw std::runtime_error(
+                                    "r1cs_mp_ppzkpcd_mapped_keypair: compliance predicates do not match " + path);
+                            }
+                            pk_.compliance_predicate_name_to_idx[directory[i].name] = i;
+                            verification.read(pk_.compliance_step_r1cs_vks[i]);
+                            verification.read(pk_.translation_step_r1cs_vks[i]);
+                            verification.read(pk_.compliance_step_r1cs_vk_membership_proofs[i]);
+                        }
+
+                        vk_.compliance_step_r1cs_vks = pk_.compliance_step_r1cs_vks;
+                        vk_.translation_step_r1cs_vks = pk_.translation_step_r1cs_vks;
+                        vk_.commitment_to_translation_step_r1cs_vks = pk_.commitment_to_translation_step_r1cs_vks;
+                    }
+
+                    /**
+                     * Writes keypair to path in the layout expected by the mapping constructor.
+                     */
+                    static void write(const std::string &path, const keypair_type &keypair) {
+                        const proving_key_type &pk = keypair.pk;
+                        const std::size_t num_predicates = pk.compliance_predicates.size();
+
+                        detail::mapped_keypair_writer out(path);
+                        header_type h = expected_header();
+                        h.num_predicates = num_predicates;
+                        out.write_raw(0, h);
+                        out.align();
+
+                        h.verification_offset = out.position();
+                        out.write(pk.commitment_to_translation_step_r1cs_vks);
+                        for (std::size_t i = 0; i < num_predicates; ++i) {
+                            out.write(pk.compliance_step_r1cs_vks[i]);
+                            out.write(pk.translation_step_r1cs_vks[i]);
+                            out.write(pk.compliance_step_r1cs_vk_membership_proofs[i]);
+                        }
+
+                        std::vector<directory_entry_type> entries(num_predicates);
+                        for (std::size_t i = 0; i < num_predicates; ++i) {
+                            entries[i].name = pk.compliance_predicates[i].name;
+                            entries[i].compliance_step_pk_offset = out.position();
+                            out.write(pk.compliance_step_r1cs_pks[i]);
+                            entries[i].translation_step_pk_offset = out.position();
+                            out.write(pk.translation_step_r1cs_pks[i]);
+                        }
+
+                        h.directory_offset = out.position();
+                        out.write(entries);
+                        out.align();
+
+                        h.file_size = out.position();
+                        out.write_raw(0, h);
+                        out.close();
+                    }
+
+                    /**
+                     * Reads the step proving keys of the compliance predicate named compliance_predicate_name
+                     * into pk(), unless they are already there.
+                     */
+                    void load(const std::size_t compliance_predicate_name) {
+                        const auto it = pk_.compliance_predicate_name_to_idx.find(compliance_predicate_name);
+                        if (it == pk_.compliance_predicate_name_to_idx.end()) {
+                            throw std::invalid_argument("r1cs_mp_ppzkpcd_mapped_keypair: unknown compliance predicate");
+                        }
+                        const std::size_t idx = it->second;
+                        if (loaded[idx]) {
+                            return;
+                        }
+
+                        reader(directory[idx].compliance_step_pk_offset).read(pk_.compliance_step_r1cs_pks[idx]);
+                        reader(directory[idx].translation_step_pk_offset).read(pk_.translation_step_r1cs_pks[idx]);
+                        loaded[idx] = true;
+                    }
+
+                    bool is_loaded(const std::size_t compliance_predicate_name) const {
+                        const auto it = pk_.compliance_predicate_name_to_idx.find(compliance_predicate_name);
+                        return it != pk_.compliance_predicate_name_to_idx.end() && loaded[it->second];
+                    }
+
+                    const proving_key_type &pk() const {
+                        return pk_;
+                    }
+
+                    const verification_key_type &vk() const {
+                        return vk_;
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return region.get_size() * 8;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_MP_PPZKPCD_MAPPED_KEYPAIR_HPP
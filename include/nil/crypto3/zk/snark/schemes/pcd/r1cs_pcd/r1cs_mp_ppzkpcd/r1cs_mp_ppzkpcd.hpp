@@ -32,6 +32,7 @@
 // - class for proof
 // - generator algorithm
 // - prover algorithm
+// - prover context, reusing the step circuits across the steps of a PCD computation
 // - verifier algorithm
 // - online verifier algorithm
 //
@@ -58,6 +59,7 @@
 #include <vector>
 
 #include <nil/crypto3/zk/snark/set_commitment.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/ppzkpcd_compliance_predicate.hpp>
 #include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/r1cs_mp_ppzkpcd_params.hpp>
@@ -252,6 +254,54 @@ namespace nil {
                     bool operator==(const r1cs_mp_ppzkpcd_proof<PCD_ppT> &other) const;
                 };
 
+                /****************************** Prover context *******************************/
+
+                /**
+                 * A prover context for the R1CS (multi-predicate) ppzkPCD.
+                 *
+                 * The compliance step and translation step circuits of a compliance predicate only
+                 * depend on the proving key, so the context builds those of a predicate the first time
+                 * it proves a step of it and keeps them. Every call to prove() then only regenerates
+                 * the witness of both circuits for the new message before running the ppzkSNARK
+                 * provers. The context keeps a reference to the proving key, which must outlive it.
+                 */
+                template<typename PCD_ppT>
+                class r1cs_mp_ppzkpcd_prover_context {
+                    typedef typename PCD_ppT::curve_A_pp curve_A_pp;
+                    typedef typename PCD_ppT::curve_B_pp curve_B_pp;
+
+                    /* the components of a circuit refer to its blueprint, so the circuits are never moved */
+                    struct step_circuits_type {
+                        mp_compliance_step_pcd_circuit_maker<curve_A_pp> compliance_step_pcd_circuit;
+                        mp_translation_step_pcd_circuit_maker<curve_B_pp> translation_step_pcd_circuit;
+
+                        step_circuits_type(const r1cs_mp_ppzkpcd_proving_key<PCD_ppT> &pk,
+                                           const std::size_t compliance_predicate_idx) :
+                            compliance_step_pcd_circuit(pk.compliance_predicates[compliance_predicate_idx],
+                                                        pk.compliance_predicates.size()),
+                            translation_step_pcd_circuit(pk.compliance_step_r1cs_vks[compliance_predicate_idx]) {
+                        }
+                    };
+
+                    const r1cs_mp_ppzkpcd_proving_key<PCD_ppT> &pk;
+                    std::vector<std::unique_ptr<step_circuits_type>> step_circuits;
+
+                public:
+                    explicit r1cs_mp_ppzkpcd_prover_context(const r1cs_mp_ppzkpcd_proving_key<PCD_ppT> &pk) :
+                        pk(pk), step_circuits(pk.compliance_predicates.size()) {
+                    }
+
+                    /**
+                     * Produces the proof r1cs_mp_ppzkpcd_prover(pk, compliance_predicate_name,
+                     * primary_input, auxiliary_input, prev_proofs) would.
+                     */
+                    r1cs_mp_ppzkpcd_proof<PCD_ppT>
+                        prove(const std::size_t compliance_predicate_name,
+                              const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
+                              const r1cs_mp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
+                              const std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> &prev_proofs);
+                };
+
                 /***************************** Main algorithms *******************************/
 
                 /**
@@ -271,6 +321,9 @@ namespace nil {
                  * compliance predicate, and proofs for the predicate's input messages, this
                  * algorithm produces a proof (of knowledge) that attests to the compliance of
                  * the output message.
+                 *
+                 * Every call builds the step circuits anew; the steps of a long computation are proven
+                 * through one r1cs_mp_ppzkpcd_prover_context instead.
                  */
                 template<typename PCD_ppT>
                 r1cs_mp_ppzkpcd_proof<PCD_ppT>
@@ -313,6 +366,21 @@ namespace nil {
                                                      const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
                                                      const r1cs_mp_ppzkpcd_proof<PCD_ppT> &proof);
 
+                /**
+                 * A batch verifier algorithm for the R1CS (multi-predicate) ppzkPCD that
+                 * accepts a processed verification key.
+                 *
+                 * Verifies every proof of proofs against the primary input at the same position of
+                 * primary_inputs. The proofs are grouped by compliance predicate, the translation step
+                 * checks of every group sharing their Miller loops, and all the groups share a single
+                 * final exponentiation (see r1cs_ppzksnark_verifier_weak_input_consistency).
+                 */
+                template<typename PCD_ppT>
+                bool r1cs_mp_ppzkpcd_online_batch_verifier(
+                    const r1cs_mp_ppzkpcd_processed_verification_key<PCD_ppT> &pvk,
+                    const std::vector<r1cs_mp_ppzkpcd_primary_input<PCD_ppT>> &primary_inputs,
+                    const std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> &proofs);
+
                 template<typename PCD_ppT>
                 std::size_t r1cs_mp_ppzkpcd_proving_key<PCD_ppT>::size_in_bits() const {
                     const std::size_t num_predicates = compliance_predicates.size();
@@ -525,15 +593,11 @@ namespace nil {
                 }
 
                 template<typename PCD_ppT>
-                r1cs_mp_ppzkpcd_proof<PCD_ppT>
-                    r1cs_mp_ppzkpcd_prover(const r1cs_mp_ppzkpcd_proving_key<PCD_ppT> &pk,
-                                           const std::size_t compliance_predicate_name,
-                                           const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
-                                           const r1cs_mp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
-                                           const std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> &prev_proofs) {
-                    typedef typename PCD_ppT::curve_A_pp curve_A_pp;
-                    typedef typename PCD_ppT::curve_B_pp curve_B_pp;
-
+                r1cs_mp_ppzkpcd_proof<PCD_ppT> r1cs_mp_ppzkpcd_prover_context<PCD_ppT>::prove(
+                    const std::size_t compliance_predicate_name,
+                    const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
+                    const r1cs_mp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
+                    const std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> &prev_proofs) {
                     typedef typename curve_A_pp::scalar_field_type FieldT_A;
                     typedef typename curve_B_pp::scalar_field_type FieldT_B;
 
@@ -593,9 +657,17 @@ namespace nil {
                         membership_proofs.emplace_back(pk.compliance_step_r1cs_vk_membership_proofs[0]);
                     }
 
-                    mp_compliance_step_pcd_circuit_maker<curve_A_pp> mp_compliance_step_pcd_circuit(
-                        pk.compliance_predicates[compliance_predicate_idx], pk.compliance_predicates.size());
+                    if (!step_circuits[compliance_predicate_idx]) {
+                        stage_profiler::timer circuits_timer("circuits");
+                        step_circuits[compliance_predicate_idx].reset(
+                            new step_circuits_type(pk, compliance_predicate_idx));
+                    }
+                    mp_compliance_step_pcd_circuit_maker<curve_A_pp> &mp_compliance_step_pcd_circuit =
+                        step_circuits[compliance_predicate_idx]->compliance_step_pcd_circuit;
+                    mp_translation_step_pcd_circuit_maker<curve_B_pp> &mp_translation_step_pcd_circuit =
+                        step_circuits[compliance_predicate_idx]->translation_step_pcd_circuit;
 
+                    stage_profiler::timer compliance_witness_timer("compliance_step.witness");
                     mp_compliance_step_pcd_circuit.generate_r1cs_witness(pk.commitment_to_translation_step_r1cs_vks,
                                                                          translation_step_vks,
                                                                          membership_proofs,
@@ -607,10 +679,14 @@ namespace nil {
                         mp_compliance_step_pcd_circuit.get_primary_input();
                     const r1cs_auxiliary_input<FieldT_A> compliance_step_auxiliary_input =
                         mp_compliance_step_pcd_circuit.get_auxiliary_input();
+                    compliance_witness_timer.stop();
+
+                    stage_profiler::timer compliance_prover_timer("compliance_step.prover");
                     const typename r1cs_ppzksnark<curve_A_pp>::proof_type compliance_step_proof =
                         r1cs_ppzksnark<curve_A_pp>::prover(pk.compliance_step_r1cs_pks[compliance_predicate_idx],
                                                            compliance_step_primary_input,
                                                            compliance_step_auxiliary_input);
+                    compliance_prover_timer.stop();
 
 #ifdef DEBUG
                     const r1cs_primary_input<FieldT_A> compliance_step_input =
@@ -624,9 +700,8 @@ namespace nil {
 #endif
 
                     std::cout << "Prove translation step" << std::endl;
-                    mp_translation_step_pcd_circuit_maker<curve_B_pp> mp_translation_step_pcd_circuit(
-                        pk.compliance_step_r1cs_vks[compliance_predicate_idx]);
 
+                    stage_profiler::timer translation_witness_timer("translation_step.witness");
                     const r1cs_primary_input<FieldT_B> translation_step_primary_input =
                         get_mp_translation_step_pcd_circuit_input<curve_B_pp>(
                             pk.commitment_to_translation_step_r1cs_vks, primary_input);
@@ -634,11 +709,14 @@ namespace nil {
                                                                           compliance_step_proof);
                     const r1cs_auxiliary_input<FieldT_B> translation_step_auxiliary_input =
                         mp_translation_step_pcd_circuit.get_auxiliary_input();
+                    translation_witness_timer.stop();
 
+                    stage_profiler::timer translation_prover_timer("translation_step.prover");
                     const typename r1cs_ppzksnark<curve_B_pp>::proof_type translation_step_proof =
                         r1cs_ppzksnark<curve_B_pp>::prover(pk.translation_step_r1cs_pks[compliance_predicate_idx],
                                                            translation_step_primary_input,
                                                            translation_step_auxiliary_input);
+                    translation_prover_timer.stop();
 
 #ifdef DEBUG
                     const bool translation_step_ok = r1cs_ppzksnark<curve_B_pp>::verifier_strong_input_consistency(
@@ -654,6 +732,17 @@ namespace nil {
                     return result;
                 }
 
+                template<typename PCD_ppT>
+                r1cs_mp_ppzkpcd_proof<PCD_ppT>
+                    r1cs_mp_ppzkpcd_prover(const r1cs_mp_ppzkpcd_proving_key<PCD_ppT> &pk,
+                                           const std::size_t compliance_predicate_name,
+                                           const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
+                                           const r1cs_mp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
+                                           const std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> &prev_proofs) {
+                    return r1cs_mp_ppzkpcd_prover_context<PCD_ppT>(pk).prove(compliance_predicate_name, primary_input,
+                                                                             auxiliary_input, prev_proofs);
+                }
+
                 template<typename PCD_ppT>
                 bool r1cs_mp_ppzkpcd_online_verifier(const r1cs_mp_ppzkpcd_processed_verification_key<PCD_ppT> &pvk,
                                                      const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
@@ -670,6 +759,48 @@ namespace nil {
                     return result;
                 }
 
+                template<typename PCD_ppT>
+                bool r1cs_mp_ppzkpcd_online_batch_verifier(
+                    const r1cs_mp_ppzkpcd_processed_verification_key<PCD_ppT> &pvk,
+                    const std::vector<r1cs_mp_ppzkpcd_primary_input<PCD_ppT>> &primary_inputs,
+                    const std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> &proofs) {
+                    typedef typename PCD_ppT::curve_B_pp curve_B_pp;
+                    typedef r1cs_ppzksnark_verifier_strong_input_consistency<curve_B_pp> translation_step_verifier;
+                    typedef typename curve_B_pp::pairing::fqk_type::value_type fqk_value_type;
+
+                    if (primary_inputs.size() != proofs.size()) {
+                        return false;
+                    }
+
+                    const std::size_t num_predicates = pvk.translation_step_r1cs_pvks.size();
+                    std::vector<std::vector<r1cs_primary_input<typename curve_B_pp::scalar_field_type>>> r1cs_inputs(
+                        num_predicates);
+                    std::vector<std::vector<typename r1cs_ppzksnark<curve_B_pp>::proof_type>> r1cs_proofs(
+                        num_predicates);
+                    for (std::size_t i = 0; i < proofs.size(); ++i) {
+                        const std::size_t compliance_predicate_idx = proofs[i].compliance_predicate_idx;
+                        if (compliance_predicate_idx >= num_predicates) {
+                            return false;
+                        }
+                        r1cs_inputs[compliance_predicate_idx].emplace_back(
+                            get_mp_translation_step_pcd_circuit_input<curve_B_pp>(
+                                pvk.commitment_to_translation_step_r1cs_vks, primary_inputs[i]));
+                        r1cs_proofs[compliance_predicate_idx].emplace_back(proofs[i].r1cs_proof);
+                    }
+
+                    fqk_value_type miller_loop_product = fqk_value_type::one();
+                    for (std::size_t i = 0; i < num_predicates; ++i) {
+                        if (!translation_step_verifier::accumulate_batch(
+                                pvk.translation_step_r1cs_pvks[i], r1cs_inputs[i].begin(), r1cs_inputs[i].end(),
+                                r1cs_proofs[i].begin(), r1cs_proofs[i].end(), miller_loop_product)) {
+                            return false;
+                        }
+                    }
+
+                    return curve_B_pp::pairing::final_exponentiation(miller_loop_product) ==
+                           curve_B_pp::gt_type::value_type::one();
+                }
+
                 template<typename PCD_ppT>
                 r1cs_mp_ppzkpcd_processed_verification_key<PCD_ppT>
                     r1cs_mp_ppzkpcd_process_vk(const r1cs_mp_ppzkpcd_verification_key<PCD_ppT> &vk) {
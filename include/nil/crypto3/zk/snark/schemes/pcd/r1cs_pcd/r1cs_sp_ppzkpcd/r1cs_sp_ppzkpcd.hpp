@@ -32,6 +32,7 @@
 // - class for proof
 // - generator algorithm
 // - prover algorithm
+// - prover context, reusing the step circuits across the steps of a PCD computation
 // - verifier algorithm
 // - online verifier algorithm
 //
@@ -57,8 +58,12 @@
 #define CRYPTO3_ZK_R1CS_SP_PPZKPCD_HPP
 
 #include <memory>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_sp_ppzkpcd/r1cs_sp_ppzkpcd_params.hpp>
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_sp_ppzkpcd/sp_pcd_circuits.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_ppzksnark.hpp>
 
 namespace nil {
@@ -224,6 +229,46 @@ namespace nil {
                 template<typename PCD_ppT>
                 using r1cs_sp_ppzkpcd_proof = typename r1cs_ppzksnark<typename PCD_ppT::curve_B_pp>::proof_type;
 
+                /****************************** Prover context *******************************/
+
+                /**
+                 * A prover context for the R1CS (single-predicate) ppzkPCD.
+                 *
+                 * The compliance step and translation step circuits only depend on the proving key,
+                 * so the context builds them, the bits of the translation step verification key and the
+                 * compliance step witness of that key once. Every call to prove() then only regenerates
+                 * the witness depending on the new message and proofs before running the ppzkSNARK
+                 * provers. The context keeps a reference to the proving key, which must outlive it, and
+                 * is neither copyable nor movable since the components of a circuit refer to its blueprint.
+                 */
+                template<typename PCD_ppT>
+                class r1cs_sp_ppzkpcd_prover_context {
+                    typedef typename PCD_ppT::curve_A_pp curve_A_pp;
+                    typedef typename PCD_ppT::curve_B_pp curve_B_pp;
+
+                    const r1cs_sp_ppzkpcd_proving_key<PCD_ppT> &pk;
+                    const std::vector<bool> translation_step_r1cs_vk_bits;
+
+                    sp_compliance_step_pcd_circuit_maker<curve_A_pp> compliance_step_pcd_circuit;
+                    sp_translation_step_pcd_circuit_maker<curve_B_pp> translation_step_pcd_circuit;
+
+                public:
+                    explicit r1cs_sp_ppzkpcd_prover_context(const r1cs_sp_ppzkpcd_proving_key<PCD_ppT> &pk);
+
+                    r1cs_sp_ppzkpcd_prover_context(const r1cs_sp_ppzkpcd_prover_context<PCD_ppT> &other) = delete;
+                    r1cs_sp_ppzkpcd_prover_context<PCD_ppT> &
+                        operator=(const r1cs_sp_ppzkpcd_prover_context<PCD_ppT> &other) = delete;
+
+                    /**
+                     * Produces the proof r1cs_sp_ppzkpcd_prover(pk, primary_input, auxiliary_input,
+                     * incoming_proofs) would.
+                     */
+                    r1cs_sp_ppzkpcd_proof<PCD_ppT>
+                        prove(const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
+                              const r1cs_sp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
+                              const std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> &incoming_proofs);
+                };
+
                 /***************************** Main algorithms *******************************/
 
                 /**
@@ -242,6 +287,9 @@ namespace nil {
                  * Given a proving key, inputs for the compliance predicate, and proofs for
                  * the predicate's input messages, this algorithm produces a proof (of knowledge)
                  * that attests to the compliance of the output message.
+                 *
+                 * Every call builds the step circuits anew; the steps of a long computation are proven
+                 * through one r1cs_sp_ppzkpcd_prover_context instead.
                  */
                 template<typename PCD_ppT>
                 r1cs_sp_ppzkpcd_proof<PCD_ppT>
@@ -283,6 +331,20 @@ namespace nil {
                                                      const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
                                                      const r1cs_sp_ppzkpcd_proof<PCD_ppT> &proof);
 
+                /**
+                 * A batch verifier algorithm for the R1CS (single-predicate) ppzkPCD that
+                 * accepts a processed verification key.
+                 *
+                 * Verifies every proof of proofs against the primary input at the same position of
+                 * primary_inputs, the translation step checks of all of them sharing their Miller loops
+                 * and a single final exponentiation (see r1cs_ppzksnark_verifier_weak_input_consistency).
+                 */
+                template<typename PCD_ppT>
+                bool r1cs_sp_ppzkpcd_online_batch_verifier(
+                    const r1cs_sp_ppzkpcd_processed_verification_key<PCD_ppT> &pvk,
+                    const std::vector<r1cs_sp_ppzkpcd_primary_input<PCD_ppT>> &primary_inputs,
+                    const std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> &proofs);
+
                 template<typename PCD_ppT>
                 bool r1cs_sp_ppzkpcd_proving_key<PCD_ppT>::operator==(
                     const r1cs_sp_ppzkpcd_proving_key<PCD_ppT> &other) const {
@@ -370,38 +432,41 @@ namespace nil {
                 }
 
                 template<typename PCD_ppT>
-                r1cs_sp_ppzkpcd_proof<PCD_ppT>
-                    r1cs_sp_ppzkpcd_prover(const r1cs_sp_ppzkpcd_proving_key<PCD_ppT> &pk,
-                                           const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
-                                           const r1cs_sp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
-                                           const std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> &incoming_proofs) {
+                r1cs_sp_ppzkpcd_prover_context<PCD_ppT>::r1cs_sp_ppzkpcd_prover_context(
+                    const r1cs_sp_ppzkpcd_proving_key<PCD_ppT> &pk) :
+                    pk(pk),
+                    translation_step_r1cs_vk_bits(
+                        r1cs_ppzksnark_verification_key_variable<curve_A_pp>::get_verification_key_bits(
+                            pk.translation_step_r1cs_vk)),
+                    compliance_step_pcd_circuit(pk.compliance_predicate),
+                    translation_step_pcd_circuit(pk.compliance_step_r1cs_vk) {
+                    compliance_step_pcd_circuit.cache_verification_key_witness(pk.translation_step_r1cs_vk);
+                }
+
+                template<typename PCD_ppT>
+                r1cs_sp_ppzkpcd_proof<PCD_ppT> r1cs_sp_ppzkpcd_prover_context<PCD_ppT>::prove(
+                    const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
+                    const r1cs_sp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
+                    const std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> &incoming_proofs) {
                     typedef algebra::Fr<typename PCD_ppT::curve_A_pp> FieldT_A;
                     typedef algebra::Fr<typename PCD_ppT::curve_B_pp> FieldT_B;
 
-                    typedef typename PCD_ppT::curve_A_pp curve_A_pp;
-                    typedef typename PCD_ppT::curve_B_pp curve_B_pp;
-
-                    const std::vector<bool> translation_step_r1cs_vk_bits =
-                        r1cs_ppzksnark_verification_key_variable<curve_A_pp>::get_verification_key_bits(
-                            pk.translation_step_r1cs_vk);
-
-                    sp_compliance_step_pcd_circuit_maker<curve_A_pp> compliance_step_pcd_circuit(
-                        pk.compliance_predicate);
-                    compliance_step_pcd_circuit.generate_r1cs_witness(
-                        pk.translation_step_r1cs_vk, primary_input, auxiliary_input, incoming_proofs);
+                    stage_profiler::timer compliance_witness_timer("compliance_step.witness");
+                    compliance_step_pcd_circuit.generate_r1cs_witness(primary_input, auxiliary_input, incoming_proofs);
 
                     const r1cs_primary_input<FieldT_A> compliance_step_primary_input =
                         compliance_step_pcd_circuit.get_primary_input();
                     const r1cs_auxiliary_input<FieldT_A> compliance_step_auxiliary_input =
                         compliance_step_pcd_circuit.get_auxiliary_input();
+                    compliance_witness_timer.stop();
 
+                    stage_profiler::timer compliance_prover_timer("compliance_step.prover");
                     const typename r1cs_ppzksnark<curve_A_pp>::proof_type compliance_step_proof =
                         r1cs_ppzksnark<curve_A_pp>::prover(
                             pk.compliance_step_r1cs_pk, compliance_step_primary_input, compliance_step_auxiliary_input);
+                    compliance_prover_timer.stop();
 
-                    sp_translation_step_pcd_circuit_maker<curve_B_pp> translation_step_pcd_circuit(
-                        pk.compliance_step_r1cs_vk);
-
+                    stage_profiler::timer translation_witness_timer("translation_step.witness");
                     const r1cs_primary_input<FieldT_B> translation_step_primary_input =
                         get_sp_translation_step_pcd_circuit_input<curve_B_pp>(translation_step_r1cs_vk_bits,
                                                                               primary_input);
@@ -410,14 +475,28 @@ namespace nil {
 
                     const r1cs_auxiliary_input<FieldT_B> translation_step_auxiliary_input =
                         translation_step_pcd_circuit.get_auxiliary_input();
+                    translation_witness_timer.stop();
+
+                    stage_profiler::timer translation_prover_timer("translation_step.prover");
                     const typename r1cs_ppzksnark<curve_B_pp>::proof_type translation_step_proof =
                         r1cs_ppzksnark<curve_B_pp>::prover(pk.translation_step_r1cs_pk,
                                                            translation_step_primary_input,
                                                            translation_step_auxiliary_input);
+                    translation_prover_timer.stop();
 
                     return translation_step_proof;
                 }
 
+                template<typename PCD_ppT>
+                r1cs_sp_ppzkpcd_proof<PCD_ppT>
+                    r1cs_sp_ppzkpcd_prover(const r1cs_sp_ppzkpcd_proving_key<PCD_ppT> &pk,
+                                           const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
+                                           const r1cs_sp_ppzkpcd_auxiliary_input<PCD_ppT> &auxiliary_input,
+                                           const std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> &incoming_proofs) {
+                    return r1cs_sp_ppzkpcd_prover_context<PCD_ppT>(pk).prove(primary_input, auxiliary_input,
+                                                                             incoming_proofs);
+                }
+
                 template<typename PCD_ppT>
                 bool r1cs_sp_ppzkpcd_online_verifier(const r1cs_sp_ppzkpcd_processed_verification_key<PCD_ppT> &pvk,
                                                      const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> &primary_input,
@@ -435,6 +514,29 @@ namespace nil {
                     return result;
                 }
 
+                template<typename PCD_ppT>
+                bool r1cs_sp_ppzkpcd_online_batch_verifier(
+                    const r1cs_sp_ppzkpcd_processed_verification_key<PCD_ppT> &pvk,
+                    const std::vector<r1cs_sp_ppzkpcd_primary_input<PCD_ppT>> &primary_inputs,
+                    const std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> &proofs) {
+                    typedef typename PCD_ppT::curve_B_pp curve_B_pp;
+
+                    if (primary_inputs.size() != proofs.size()) {
+                        return false;
+                    }
+
+                    std::vector<r1cs_primary_input<typename curve_B_pp::scalar_field_type>> r1cs_inputs;
+                    r1cs_inputs.reserve(primary_inputs.size());
+                    for (const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> &primary_input : primary_inputs) {
+                        r1cs_inputs.emplace_back(get_sp_translation_step_pcd_circuit_input<curve_B_pp>(
+                            pvk.translation_step_r1cs_vk_bits, primary_input));
+                    }
+
+                    return r1cs_ppzksnark_verifier_strong_input_consistency<curve_B_pp>::process_batch(
+                        pvk.translation_step_r1cs_pvk, r1cs_inputs.begin(), r1cs_inputs.end(), proofs.begin(),
+                        proofs.end());
+                }
+
                 template<typename PCD_ppT>
                 r1cs_sp_ppzkpcd_processed_verification_key<PCD_ppT>
                     r1cs_sp_ppzkpcd_process_vk(const r1cs_sp_ppzkpcd_verification_key<PCD_ppT> &vk) {
@@ -118,6 +118,10 @@ namespace nil {
                     variable<FieldType> verification_result;
                     std::vector<r1cs_ppzksnark_verifier_component<CurveType>> verifiers;
 
+                    /* (index, value) of the nonzero variables only depending on the translation step key */
+                    std::vector<std::pair<std::size_t, typename FieldType::value_type>> verification_key_witness;
+                    bool has_verification_key_witness = false;
+
                     sp_compliance_step_pcd_circuit_maker(
                         const r1cs_pcd_compliance_predicate<FieldType> &compliance_predicate);
                     void generate_r1cs_constraints();
@@ -130,6 +134,20 @@ namespace nil {
                         const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType>
                             &compliance_predicate_auxiliary_input,
                         const std::vector<r1cs_ppzksnark_proof<other_curve<CurveType>>> &incoming_proofs);
+
+                    /**
+                     * Generates the part of the witness that only depends on the translation step verification
+                     * key, i.e. its bits and coordinates and the key processed by every verifier, and keeps it
+                     * for the calls to generate_r1cs_witness without a key, which restore it instead.
+                     */
+                    void cache_verification_key_witness(
+                        const r1cs_ppzksnark_verification_key<other_curve<CurveType>> &translation_step_pcd_circuit_vk);
+                    void generate_r1cs_witness(
+                        const r1cs_pcd_compliance_predicate_primary_input<FieldType>
+                            &compliance_predicate_primary_input,
+                        const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType>
+                            &compliance_predicate_auxiliary_input,
+                        const std::vector<r1cs_ppzksnark_proof<other_curve<CurveType>>> &incoming_proofs);
                     r1cs_primary_input<FieldType> get_primary_input() const;
                     r1cs_auxiliary_input<FieldType> get_auxiliary_input() const;
 
@@ -422,8 +440,45 @@ namespace nil {
                     const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType>
                         &compliance_predicate_auxiliary_input,
                     const std::vector<r1cs_ppzksnark_proof<other_curve<CurveType>>> &incoming_proofs) {
+                    cache_verification_key_witness(sp_translation_step_pcd_circuit_vk);
+                    generate_r1cs_witness(compliance_predicate_primary_input, compliance_predicate_auxiliary_input,
+                                          incoming_proofs);
+                }
+
+                template<typename CurveType>
+                void sp_compliance_step_pcd_circuit_maker<CurveType>::cache_verification_key_witness(
+                    const r1cs_ppzksnark_verification_key<other_curve<CurveType>> &sp_translation_step_pcd_circuit_vk) {
+                    this->bp.clear_values();
+                    sp_translation_step_vk->generate_r1cs_witness(sp_translation_step_pcd_circuit_vk);
+                    for (std::size_t i = 0; i < compliance_predicate.max_arity; ++i) {
+                        verifiers[i].compute_pvk->generate_r1cs_witness();
+                    }
+
+                    /* the values are cleared to zero, so only the nonzero ones need restoring */
+                    const r1cs_variable_assignment<FieldType> assignment = this->bp.full_variable_assignment();
+                    verification_key_witness.clear();
+                    for (std::size_t i = 0; i < assignment.size(); ++i) {
+                        if (assignment[i] != FieldType::value_type::zero()) {
+                            verification_key_witness.emplace_back(i + 1, assignment[i]);
+                        }
+                    }
+                    has_verification_key_witness = true;
+                }
+
+                template<typename CurveType>
+                void sp_compliance_step_pcd_circuit_maker<CurveType>::generate_r1cs_witness(
+                    const r1cs_pcd_compliance_predicate_primary_input<FieldType> &compliance_predicate_primary_input,
+                    const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType>
+                        &compliance_predicate_auxiliary_input,
+                    const std::vector<r1cs_ppzksnark_proof<other_curve<CurveType>>> &incoming_proofs) {
+                    assert(has_verification_key_witness);
+
                     const std::size_t compliance_predicate_arity = compliance_predicate.max_arity;
                     this->bp.clear_values();
+                    for (const std::pair<std::size_t, typename FieldType::value_type> &entry :
+                         verification_key_witness) {
+                        this->bp.val(variable<FieldType>(entry.first)) = entry.second;
+                    }
                     this->bp.val(zero) = FieldType::value_type::zero();
 
                     compliance_predicate_as_component->generate_r1cs_witness(
@@ -436,7 +491,7 @@ namespace nil {
                         unpack_incoming_messages[i].generate_r1cs_witness_from_packed();
                     }
 
-                    sp_translation_step_vk->generate_r1cs_witness(sp_translation_step_pcd_circuit_vk);
+                    /* the hashed blocks lead with the restored key bits */
                     hash_outgoing_message->generate_r1cs_witness();
                     for (std::size_t i = 0; i < compliance_predicate_arity; ++i) {
                         hash_incoming_messages[i].generate_r1cs_witness();
@@ -446,7 +501,7 @@ namespace nil {
 
                     for (std::size_t i = 0; i < compliance_predicate_arity; ++i) {
                         proof[i].generate_r1cs_witness(incoming_proofs[i]);
-                        verifiers[i].generate_r1cs_witness();
+                        verifiers[i].online_verifier->generate_r1cs_witness();
                     }
 
                     if (this->bp.val(incoming_message_types[0]) != FieldType::value_type::zero()) {
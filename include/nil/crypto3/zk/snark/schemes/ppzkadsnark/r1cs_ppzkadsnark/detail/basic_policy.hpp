@@ -59,22 +59,39 @@
 #ifndef CRYPTO3_R1CS_PPZKADSNARK_BASIC_POLICY_HPP
 #define CRYPTO3_R1CS_PPZKADSNARK_BASIC_POLICY_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
 
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
 
+#include <nil/crypto3/zk/snark/schemes/ppzkadsnark/r1cs_ppzkadsnark/mapped_proving_key.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzkadsnark/r1cs_ppzkadsnark/prf.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzkadsnark/r1cs_ppzkadsnark/signature.hpp>
 
 #include <nil/crypto3/algebra/multiexp/multiexp.hpp>
 #include <nil/crypto3/algebra/multiexp/policies.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/zk/snark/batch_normalizer.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
 
@@ -417,6 +434,10 @@ namespace nil {
                             typename pairing_policy::g2_precomp::value_type vk_gamma_beta_g2_precomp;
                             typename pairing_policy::g2_precomp::value_type vk_rC_i_g2_precomp;
 
+                            /* the G1 elements of the key paired with g_B, which the online checks scale */
+                            typename CurveType::g1_type::value_type vk_alphaB_g1;
+                            typename CurveType::g1_type::value_type vk_gamma_beta_g1;
+
                             typename CurveType::g1_type::value_type A0;
                             typename std::vector<typename CurveType::g1_type::value_type> Ain;
 
@@ -432,6 +453,8 @@ namespace nil {
                                                this->vk_gamma_beta_g1_precomp == other.vk_gamma_beta_g1_precomp &&
                                                this->vk_gamma_beta_g2_precomp == other.vk_gamma_beta_g2_precomp &&
                                                this->vk_rC_i_g2_precomp == other.vk_rC_i_g2_precomp &&
+                                               this->vk_alphaB_g1 == other.vk_alphaB_g1 &&
+                                               this->vk_gamma_beta_g1 == other.vk_gamma_beta_g1 &&
                                                this->A0 == other.A0 && this->Ain == other.Ain &&
                                                this->proof_g_vki_precomp.size() == other.proof_g_vki_precomp.size());
                                 if (result) {
@@ -559,26 +582,36 @@ namespace nil {
 
                         /**
                          * R1CS ppZKADSNARK authentication algorithm.
+                         *
+                         * The inputs are signed independently of each other, so the PRF evaluations, the
+                         * Lambda values and the signatures are computed across the current executor, each
+                         * thread writing its entries of the result in place. All the Lambda = lambda * g2
+                         * values share one fixed-base engine for the G2 generator, kept between calls.
                          */
                         static std::vector<auth_data<CurveType>>
                             auth_sign(const std::vector<typename CurveType::scalar_field_type::value_type> &ins,
                                       const sec_auth_key<CurveType> &sk,
-                                      const std::vector<label_type>
-                                          labels) {
+                                      const std::vector<label_type> &labels) {
+                            using scalar_field_type = typename CurveType::scalar_field_type;
+                            using g2_type = typename CurveType::g2_type;
+
                             assert(labels.size() == ins.size());
-                            std::vector<auth_data<CurveType>> res;
-                            res.reserve(ins.size());
-                            for (std::size_t i = 0; i < ins.size(); i++) {
-                                typename CurveType::scalar_field_type::value_type lambda =
+
+                            const std::shared_ptr<const fixed_base_engine<g2_type, scalar_field_type>> g2_engine =
+                                fixed_base_engine<g2_type, scalar_field_type>::shared(g2_type::value_type::one(),
+                                                                                      ins.size());
+
+                            std::vector<auth_data<CurveType>> res(ins.size());
+                            executor::current().parallel_for(ins.size(), [&](const std::size_t i) {
+                                const typename scalar_field_type::value_type lambda =
                                     prfCompute<CurveType>(sk.S, labels[i]);
-                                typename CurveType::g2_type::value_type Lambda =
-                                    lambda * CurveType::g2_type::value_type::one();
-                                signature<CurveType> sig = sigSign<CurveType>(sk.skp, labels[i], Lambda);
-                                auth_data<CurveType> val(std::move(lambda + sk.i * ins[i]), std::move(Lambda),
-                                                         std::move(sig));
-                                res.emplace_back(val);
-                            }
-                            return std::move(res);
+
+                                auth_data<CurveType> &val = res[i];
+                                val.mu = lambda + sk.i * ins[i];
+                                val.Lambda = g2_engine->exp(lambda);
+                                val.sigma = sigSign<CurveType>(sk.skp, labels[i], val.Lambda);
+                            });
+                            return res;
                         }
 
                         /**
@@ -620,171 +653,477 @@ namespace nil {
                         }
 
                         /**
-                         * A generator algorithm for the R1CS ppzkADSNARK.
+                         * Public authentication verification of a whole batch with a random linear combination.
                          *
-                         * Given a R1CS constraint system CS, this algorithm produces proving and verification keys for
-                         * CS.
+                         * With random non-zero weights r_i, the N equalities mu_i * g2 == Lambda_i - data_i * minusI2
+                         * are replaced by the single one
+                         *     (sum r_i mu_i) * g2 == sum r_i Lambda_i - (sum r_i data_i) * minusI2,
+                         * whose right-hand side is one multi-exponentiation over the Lambda values; a batch with a
+                         * wrong term passes with probability at most 1/|Fr| over weights drawn from GeneratorType,
+                         * the entropy of the system by default. The signatures are checked together through
+                         * sigBatchVerif, which signature schemes with a batch verifier implement with it. Returns
+                         * false when data, auth_data and labels differ in length.
                          */
-                        static keypair<CurveType> generator(const constraint_system<CurveType> &cs,
-                                                            const pub_auth_prms<CurveType> &prms) {
+                        template<typename DistributionType = boost::random::uniform_int_distribution<
+                                     typename CurveType::scalar_field_type::modulus_type>,
+                                 typename GeneratorType = random_device_generator>
+                        static bool auth_verify_batch(
+                            const std::vector<typename CurveType::scalar_field_type::value_type> &data,
+                            const std::vector<auth_data<CurveType>> &auth_data,
+                            const pub_auth_key<CurveType> &pak,
+                            const std::vector<label_type> &labels) {
+                            using scalar_field_type = typename CurveType::scalar_field_type;
+                            using g2_type = typename CurveType::g2_type;
+
+                            if ((data.size() != labels.size()) || (data.size() != auth_data.size())) {
+                                return false;
+                            }
+                            const std::size_t batch_size = auth_data.size();
+                            if (!batch_size) {
+                                return true;
+                            }
+
+                            /* the weights are drawn up front, in the order of the batch */
+                            std::vector<typename scalar_field_type::value_type> coefficients;
+                            std::vector<typename g2_type::value_type> Lambdas;
+                            std::vector<signature<CurveType>> sigs;
+                            coefficients.reserve(batch_size);
+                            Lambdas.reserve(batch_size);
+                            sigs.reserve(batch_size);
+
+                            typename scalar_field_type::value_type mu_sum = scalar_field_type::value_type::zero(),
+                                                                   data_sum = scalar_field_type::value_type::zero();
+                            for (std::size_t i = 0; i < batch_size; ++i) {
+                                typename scalar_field_type::value_type coefficient =
+                                    algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                while (coefficient.is_zero()) {
+                                    coefficient =
+                                        algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                }
+                                mu_sum += coefficient * auth_data[i].mu;
+                                data_sum += coefficient * data[i];
+                                coefficients.emplace_back(coefficient);
+                                Lambdas.emplace_back(auth_data[i].Lambda);
+                                sigs.emplace_back(auth_data[i].sigma);
+                            }
+
+                            const typename g2_type::value_type Lambda_sum = dispatch_multiexp<multiexp_method_auto>(
+                                Lambdas.begin(), Lambdas.end(), coefficients.begin(), coefficients.end(),
+                                executor::current().concurrency());
+
+                            if (mu_sum * g2_type::value_type::one() != Lambda_sum - data_sum * pak.minusI2) {
+                                return false;
+                            }
+                            return sigBatchVerif<CurveType>(pak.vkp, labels, Lambdas, sigs);
+                        }
+
+                        typedef typename CurveType::scalar_field_type key_field_type;
+                        typedef fixed_base_engine<typename CurveType::g1_type, key_field_type> g1_engine_type;
+                        typedef fixed_base_engine<typename CurveType::g2_type, key_field_type> g2_engine_type;
+                        typedef r1cs_ppzkadsnark_mapped_proving_key<CurveType, constraint_system<CurveType>>
+                            mapped_proving_key_type;
+
+                        /**
+                         * The scalars of a key pair: the QAP evaluated at a random point, the random
+                         * trapdoors and the same-coefficient-check query, together with the constraint
+                         * system of the keys.
+                         */
+                        struct key_scalars {
+                            typedef typename CurveType::scalar_field_type::value_type scalar_value_type;
+
+                            constraint_system<CurveType> cs;
+                            std::size_t num_inputs;
+
+                            algebra::Fr_vector<snark_pp<CurveType>> At, Bt, Ct, Ht, Kt;
+
+                            scalar_value_type Zt;
+                            scalar_value_type alphaA, alphaB, alphaC, rA, rB, beta, gamma, rC;
+                        };
+
+                        static std::size_t count_non_zero(const algebra::Fr_vector<snark_pp<CurveType>> &v) {
+                            const std::size_t num_blocks = std::max<std::size_t>(
+                                1, std::min(v.size(), executor::current().concurrency()));
+                            const std::size_t block_size = (v.size() + num_blocks - 1) / num_blocks;
+
+                            std::vector<std::size_t> counts(num_blocks, 0);
+                            executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                                const std::size_t end = std::min(v.size(), (block + 1) * block_size);
+                                for (std::size_t i = block * block_size; i < end; ++i) {
+                                    counts[block] += v[i].is_zero() ? 0 : 1;
+                                }
+                            });
+
+                            return std::accumulate(counts.begin(), counts.end(), std::size_t(0));
+                        }
+
+                        /**
+                         * Draws the trapdoors and evaluates the QAP of cs, with the per-variable loops
+                         * split across the current executor. The random draws keep their original order.
+                         */
+                        static key_scalars generate_scalars(const constraint_system<CurveType> &cs) {
+                            typedef typename CurveType::scalar_field_type scalar_field_type;
+
+                            key_scalars result;
 
                             /* make the B_query "lighter" if possible */
-                            constraint_system<CurveType> cs_copy(cs);
-                            cs_copy.swap_AB_if_beneficial();
+                            result.cs = cs;
+                            result.cs.swap_AB_if_beneficial();
 
                             /* draw random element at which the QAP is evaluated */
-                            const typename CurveType::scalar_field_type::value_type t =
-                                algebra::random_element<typename CurveType::scalar_field_type>();
+                            const typename scalar_field_type::value_type t =
+                                algebra::random_element<scalar_field_type>();
 
-                            qap_instance_evaluation<typename CurveType::scalar_field_type::value_type> qap_inst =
-                                r1cs_to_qap::instance_map_with_evaluation(cs_copy, t);
+                            qap_instance_evaluation<typename scalar_field_type::value_type> qap_inst =
+                                r1cs_to_qap::instance_map_with_evaluation(result.cs, t);
 
                             printf("* QAP number of variables: %zu\n", qap_inst.num_variables());
-                            printf("* QAP pre degree: %zu\n", cs_copy.constraints.size());
+                            printf("* QAP pre degree: %zu\n", result.cs.constraints.size());
                             printf("* QAP degree: %zu\n", qap_inst.degree());
                             printf("* QAP number of input variables: %zu\n", qap_inst.num_inputs());
 
-                            std::size_t non_zero_At = 0, non_zero_Bt = 0, non_zero_Ct = 0, non_zero_Ht = 0;
-                            for (std::size_t i = 0; i < qap_inst.num_variables() + 1; ++i) {
-                                if (!qap_inst.At[i].is_zero()) {
-                                    ++non_zero_At;
-                                }
-                                if (!qap_inst.Bt[i].is_zero()) {
-                                    ++non_zero_Bt;
-                                }
-                                if (!qap_inst.Ct[i].is_zero()) {
-                                    ++non_zero_Ct;
-                                }
-                            }
-                            for (std::size_t i = 0; i < qap_inst.degree() + 1; ++i) {
-                                if (!qap_inst.Ht[i].is_zero()) {
-                                    ++non_zero_Ht;
-                                }
-                            }
+                            const std::size_t num_variables = qap_inst.num_variables();
+                            result.num_inputs = qap_inst.num_inputs();
+                            result.Zt = qap_inst.Zt;
 
-                            algebra::Fr_vector<snark_pp<CurveType>> At = std::move(
-                                qap_inst.At);    // qap_inst.At is now in unspecified state, but we do not use it later
-                            algebra::Fr_vector<snark_pp<CurveType>> Bt = std::move(
-                                qap_inst.Bt);    // qap_inst.Bt is now in unspecified state, but we do not use it later
-                            algebra::Fr_vector<snark_pp<CurveType>> Ct = std::move(
-                                qap_inst.Ct);    // qap_inst.Ct is now in unspecified state, but we do not use it later
-                            algebra::Fr_vector<snark_pp<CurveType>> Ht = std::move(
-                                qap_inst.Ht);    // qap_inst.Ht is now in unspecified state, but we do not use it later
+                            // qap_inst.At, Bt, Ct and Ht are now in unspecified state, but we do not use them later
+                            result.At = std::move(qap_inst.At);
+                            result.Bt = std::move(qap_inst.Bt);
+                            result.Ct = std::move(qap_inst.Ct);
+                            result.Ht = std::move(qap_inst.Ht);
 
                             /* append Zt to At,Bt,Ct with */
-                            At.emplace_back(qap_inst.Zt);
-                            Bt.emplace_back(qap_inst.Zt);
-                            Ct.emplace_back(qap_inst.Zt);
-
-                            const typename CurveType::scalar_field_type::value_type
-                                alphaA = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                alphaB = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                alphaC = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                rA = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                rB = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                beta = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                gamma = algebra::random_element<typename CurveType::scalar_field_type>();
-                            const typename CurveType::scalar_field_type::value_type rC = rA * rB;
+                            result.At.emplace_back(result.Zt);
+                            result.Bt.emplace_back(result.Zt);
+                            result.Ct.emplace_back(result.Zt);
+
+                            result.alphaA = algebra::random_element<scalar_field_type>();
+                            result.alphaB = algebra::random_element<scalar_field_type>();
+                            result.alphaC = algebra::random_element<scalar_field_type>();
+                            result.rA = algebra::random_element<scalar_field_type>();
+                            result.rB = algebra::random_element<scalar_field_type>();
+                            result.beta = algebra::random_element<scalar_field_type>();
+                            result.gamma = algebra::random_element<scalar_field_type>();
+                            result.rC = result.rA * result.rB;
 
                             // construct the same-coefficient-check query (must happen before zeroing out the prefix of
                             // At)
-                            algebra::Fr_vector<snark_pp<CurveType>> Kt;
-                            Kt.reserve(qap_inst.num_variables() + 4);
-                            for (std::size_t i = 0; i < qap_inst.num_variables() + 1; ++i) {
-                                Kt.emplace_back(beta * (rA * At[i] + rB * Bt[i] + rC * Ct[i]));
-                            }
-                            Kt.emplace_back(beta * rA * qap_inst.Zt);
-                            Kt.emplace_back(beta * rB * qap_inst.Zt);
-                            Kt.emplace_back(beta * rC * qap_inst.Zt);
-
-                            const std::size_t g1_exp_count = 2 * (non_zero_At - qap_inst.num_inputs() + non_zero_Ct) +
-                                                             non_zero_Bt + non_zero_Ht + Kt.size();
-                            const std::size_t g2_exp_count = non_zero_Bt;
-
-                            std::size_t g1_window =
-                                algebra::get_exp_window_size<typename CurveType::g1_type::value_type>(g1_exp_count);
-                            std::size_t g2_window =
-                                algebra::get_exp_window_size<typename CurveType::g2_type::value_type>(g2_exp_count);
-                            printf("* G1 window: %zu\n", g1_window);
-                            printf("* G2 window: %zu\n", g2_window);
-
-#ifdef MULTICORE
-                            const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                                 // var or call omp_set_num_threads()
-#else
-                            const std::size_t chunks = 1;
-#endif
-
-                            algebra::window_table<typename CurveType::g1_type> g1_table =
-                                algebra::get_window_table<typename CurveType::g1_type>(CurveType::scalar_field_type::value_bits, g1_window,
-                                                 CurveType::g1_type::value_type::one());
-
-                            algebra::window_table<typename algebra::CurveType::g2_type> g2_table =
-                                algebra::get_window_table<typename CurveType::g2_type>(CurveType::scalar_field_type::value_bits, g2_window,
-                                                 CurveType::g2_type::value_type::one());
+                            const key_scalars &r = result;
+                            result.Kt.resize(num_variables + 4);
+                            executor::current().parallel_for(num_variables + 1, [&](const std::size_t i) {
+                                result.Kt[i] = r.beta * (r.rA * r.At[i] + r.rB * r.Bt[i] + r.rC * r.Ct[i]);
+                            });
+                            result.Kt[num_variables + 1] = r.beta * r.rA * r.Zt;
+                            result.Kt[num_variables + 2] = r.beta * r.rB * r.Zt;
+                            result.Kt[num_variables + 3] = r.beta * r.rC * r.Zt;
+
+                            return result;
+                        }
+
+                        /**
+                         * The verification key of scalars, Ain being the G1 parts of the input terms of A_query.
+                         */
+                        static verification_key<CurveType>
+                            make_verification_key(const key_scalars &scalars,
+                                                  const typename CurveType::g1_type::value_type &A0,
+                                                  const std::vector<typename CurveType::g1_type::value_type> &Ain) {
+                            typedef typename CurveType::g1_type::value_type g1_value_type;
+                            typedef typename CurveType::g2_type::value_type g2_value_type;
+
+                            g2_value_type alphaA_g2 = scalars.alphaA * g2_value_type::one();
+                            g1_value_type alphaB_g1 = scalars.alphaB * g1_value_type::one();
+                            g2_value_type alphaC_g2 = scalars.alphaC * g2_value_type::one();
+                            g2_value_type gamma_g2 = scalars.gamma * g2_value_type::one();
+                            g1_value_type gamma_beta_g1 = (scalars.gamma * scalars.beta) * g1_value_type::one();
+                            g2_value_type gamma_beta_g2 = (scalars.gamma * scalars.beta) * g2_value_type::one();
+                            g2_value_type rC_Z_g2 = (scalars.rC * scalars.Zt) * g2_value_type::one();
+
+                            return verification_key<CurveType>(alphaA_g2, alphaB_g1, alphaC_g2, gamma_g2,
+                                                               gamma_beta_g1, gamma_beta_g2, rC_Z_g2, A0, Ain);
+                        }
+
+                        /**
+                         * A generator algorithm for the R1CS ppzkADSNARK.
+                         *
+                         * Given a R1CS constraint system CS, this algorithm produces proving and verification keys for
+                         * CS. The QAP evaluation, the same-coefficient-check query and the exponentiations are
+                         * split across the current executor.
+                         */
+                        static keypair<CurveType> generator(const constraint_system<CurveType> &cs,
+                                                            const pub_auth_prms<CurveType> &prms) {
+                            key_scalars scalars = generate_scalars(cs);
+
+                            const std::size_t g1_exp_count =
+                                2 * (count_non_zero(scalars.At) - scalars.num_inputs + count_non_zero(scalars.Ct)) +
+                                count_non_zero(scalars.Bt) + count_non_zero(scalars.Ht) + scalars.Kt.size();
+                            const std::size_t g2_exp_count = count_non_zero(scalars.Bt);
+
+                            /* the tables of the group generators are shared with the other generator calls */
+                            const std::shared_ptr<const g1_engine_type> g1_engine =
+                                g1_engine_type::shared(CurveType::g1_type::value_type::one(), g1_exp_count);
+                            const std::shared_ptr<const g2_engine_type> g2_engine =
+                                g2_engine_type::shared(CurveType::g2_type::value_type::one(), g2_exp_count);
+                            printf("* G1 window: %zu\n", g1_engine->window_size());
+                            printf("* G2 window: %zu\n", g2_engine->window_size());
 
                             knowledge_commitment_vector<typename CurveType::g1_type, typename CurveType::g1_type>
-                                A_query = kc_batch_exp(CurveType::scalar_field_type::value_bits, g1_window, g1_window,
-                                                       g1_table, g1_table, rA, rA * alphaA, At, chunks);
+                                A_query = kc_batch_exp(*g1_engine, *g1_engine, scalars.rA, scalars.rA * scalars.alphaA,
+                                                       scalars.At);
 
                             knowledge_commitment_vector<typename CurveType::g2_type, typename CurveType::g1_type>
-                                B_query = kc_batch_exp(CurveType::scalar_field_type::value_bits, g2_window, g1_window,
-                                                       g2_table, g1_table, rB, rB * alphaB, Bt, chunks);
+                                B_query = kc_batch_exp(*g2_engine, *g1_engine, scalars.rB, scalars.rB * scalars.alphaB,
+                                                       scalars.Bt);
 
                             knowledge_commitment_vector<typename CurveType::g1_type, typename CurveType::g1_type>
-                                C_query = kc_batch_exp(CurveType::scalar_field_type::value_bits, g1_window, g1_window,
-                                                       g1_table, g1_table, rC, rC * alphaC, Ct, chunks);
+                                C_query = kc_batch_exp(*g1_engine, *g1_engine, scalars.rC, scalars.rC * scalars.alphaC,
+                                                       scalars.Ct);
 
                             typename std::vector<typename CurveType::g1_type::value_type> H_query =
-                                batch_exp(CurveType::scalar_field_type::value_bits, g1_window, g1_table, Ht);
-#ifdef USE_MIXED_ADDITION
-                            algebra::batch_to_special<typename CurveType::g1_type>(H_query);
-#endif
+                                g1_engine->batch_exp(scalars.Ht);
 
                             typename std::vector<typename CurveType::g1_type::value_type> K_query =
-                                batch_exp(CurveType::scalar_field_type::value_bits, g1_window, g1_table, Kt);
-#ifdef USE_MIXED_ADDITION
-                            algebra::batch_to_special<typename CurveType::g1_type>(K_query);
-#endif
-
-                            typename CurveType::g2_type::value_type alphaA_g2 =
-                                alphaA * CurveType::g2_type::value_type::one();
-                            typename CurveType::g1_type::value_type alphaB_g1 =
-                                alphaB * CurveType::g1_type::value_type::one();
-                            typename CurveType::g2_type::value_type alphaC_g2 =
-                                alphaC * CurveType::g2_type::value_type::one();
-                            typename CurveType::g2_type::value_type gamma_g2 =
-                                gamma * CurveType::g2_type::value_type::one();
-                            typename CurveType::g1_type::value_type gamma_beta_g1 =
-                                (gamma * beta) * CurveType::g1_type::value_type::one();
-                            typename CurveType::g2_type::value_type gamma_beta_g2 =
-                                (gamma * beta) * CurveType::g2_type::value_type::one();
-                            typename CurveType::g2_type::value_type rC_Z_g2 =
-                                (rC * qap_inst.Zt) * CurveType::g2_type::value_type::one();
-
-                            typename CurveType::g1_type::value_type rA_i_Z_g1 = (rA * qap_inst.Zt) * prms.I1;
+                                g1_engine->batch_exp(scalars.Kt);
+
+                            key_normalizer<typename CurveType::g1_type, typename CurveType::g2_type> normalizer;
+                            normalizer.add(A_query);
+                            normalizer.add(B_query);
+                            normalizer.add(C_query);
+                            normalizer.add(H_query);
+                            normalizer.add(K_query);
+                            normalizer.run();
+
+                            typename CurveType::g1_type::value_type rA_i_Z_g1 = (scalars.rA * scalars.Zt) * prms.I1;
 
                             typename CurveType::g1_type::value_type A0 = A_query[0].g;
                             typename std::vector<typename CurveType::g1_type::value_type> Ain;
-                            Ain.reserve(qap_inst.num_inputs());
-                            for (std::size_t i = 0; i < qap_inst.num_inputs(); ++i) {
+                            Ain.reserve(scalars.num_inputs);
+                            for (std::size_t i = 0; i < scalars.num_inputs; ++i) {
                                 Ain.emplace_back(A_query[1 + i].g);
                             }
 
-                            verification_key<CurveType> vk =
-                                verification_key<CurveType>(alphaA_g2, alphaB_g1, alphaC_g2, gamma_g2, gamma_beta_g1,
-                                                            gamma_beta_g2, rC_Z_g2, A0, Ain);
+                            verification_key<CurveType> vk = make_verification_key(scalars, A0, Ain);
                             proving_key<CurveType> pk = proving_key<CurveType>(std::move(A_query),
                                                                                std::move(B_query),
                                                                                std::move(C_query),
                                                                                std::move(H_query),
                                                                                std::move(K_query),
                                                                                std::move(rA_i_Z_g1),
-                                                                               std::move(cs_copy));
+                                                                               std::move(scalars.cs));
 
                             return keypair<CurveType>(std::move(pk), std::move(vk));
                         }
 
+                        /**
+                         * The generator writing the proving key straight into the memory-mapped file at path,
+                         * which is opened and returned together with the verification key.
+                         *
+                         * The queries are computed in blocks of stream_block_size entries, each block being
+                         * converted to special form and written as soon as it is complete, so no group element
+                         * query is ever held in memory as a whole.
+                         */
+                        static std::pair<mapped_proving_key_type, verification_key<CurveType>>
+                            generator(const constraint_system<CurveType> &cs, const pub_auth_prms<CurveType> &prms,
+                                      const std::string &path) {
+                            typedef typename CurveType::g1_type g1_type;
+                            typedef typename CurveType::g2_type g2_type;
+
+                            key_scalars scalars = generate_scalars(cs);
+
+                            const std::size_t non_zero_At = count_non_zero(scalars.At),
+                                              non_zero_Bt = count_non_zero(scalars.Bt),
+                                              non_zero_Ct = count_non_zero(scalars.Ct);
+                            const std::size_t g1_exp_count = 2 * (non_zero_At + non_zero_Ct) + non_zero_Bt +
+                                                             scalars.Ht.size() + scalars.Kt.size();
+
+                            const std::shared_ptr<const g1_engine_type> g1_engine =
+                                g1_engine_type::shared(g1_type::value_type::one(), g1_exp_count);
+                            const std::shared_ptr<const g2_engine_type> g2_engine =
+                                g2_engine_type::shared(g2_type::value_type::one(), non_zero_Bt);
+
+                            typename mapped_proving_key_type::writer out(
+                                path, non_zero_At, scalars.At.size(), non_zero_Bt, scalars.Bt.size(), non_zero_Ct,
+                                scalars.Ct.size(), scalars.Ht.size(), scalars.Kt.size());
+
+                            const typename g1_type::value_type rA_i_Z_g1 = (scalars.rA * scalars.Zt) * prms.I1;
+                            out.write_rA_i_Z_g1(rA_i_Z_g1);
+
+                            stream_kc_query(*g1_engine, *g1_engine, scalars.rA, scalars.rA * scalars.alphaA,
+                                            scalars.At, [&](auto... block) { out.write_A_query(block...); });
+                            stream_kc_query(*g2_engine, *g1_engine, scalars.rB, scalars.rB * scalars.alphaB,
+                                            scalars.Bt, [&](auto... block) { out.write_B_query(block...); });
+                            stream_kc_query(*g1_engine, *g1_engine, scalars.rC, scalars.rC * scalars.alphaC,
+                                            scalars.Ct, [&](auto... block) { out.write_C_query(block...); });
+                            stream_query(*g1_engine, scalars.Ht, [&](auto... block) { out.write_H_query(block...); });
+                            stream_query(*g1_engine, scalars.Kt, [&](auto... block) { out.write_K_query(block...); });
+                            out.close();
+
+                            /* the G1 parts of the first terms of A_query, computed again for the verification key */
+                            const std::vector<typename g1_type::value_type> A0_in =
+                                g1_engine->batch_exp(scalars.rA, scalars.At, 0, 1 + scalars.num_inputs);
+                            const std::vector<typename g1_type::value_type> Ain(A0_in.begin() + 1, A0_in.end());
+
+                            verification_key<CurveType> vk = make_verification_key(scalars, A0_in[0], Ain);
+                            return {mapped_proving_key_type(path, std::move(scalars.cs)), std::move(vk)};
+                        }
+
+                        static constexpr const std::size_t stream_block_size = std::size_t(1) << 16;
+
+                        /**
+                         * Computes the knowledge commitments (T1_coeff * v[i] * T1_base, T2_coeff * v[i] * T2_base)
+                         * of the non-zero entries of v in blocks, and hands every block to write as the position
+                         * of its first stored entry, its indices, g and h values and its size.
+                         */
+                        template<typename T1, typename T2, typename Write>
+                        static void stream_kc_query(const fixed_base_engine<T1, key_field_type> &T1_engine,
+                                                    const fixed_base_engine<T2, key_field_type> &T2_engine,
+                                                    const typename CurveType::scalar_field_type::value_type &T1_coeff,
+                                                    const typename CurveType::scalar_field_type::value_type &T2_coeff,
+                                                    const algebra::Fr_vector<snark_pp<CurveType>> &v, Write write) {
+                            std::size_t position = 0;
+                            for (std::size_t first = 0; first < v.size(); first += stream_block_size) {
+                                const std::size_t last = std::min(v.size(), first + stream_block_size);
+
+                                std::vector<std::uint64_t> indices;
+                                for (std::size_t i = first; i < last; ++i) {
+                                    if (!v[i].is_zero()) {
+                                        indices.emplace_back(i);
+                                    }
+                                }
+
+                                std::vector<typename T1::value_type> g_block(indices.size());
+                                std::vector<typename T2::value_type> h_block(indices.size());
+                                executor::current().parallel_for(indices.size(), [&](const std::size_t i) {
+                                    g_block[i] = T1_engine.exp(T1_coeff * v[indices[i]]);
+                                    h_block[i] = T2_engine.exp(T2_coeff * v[indices[i]]);
+                                });
+                                algebra::batch_to_special<T1>(g_block);
+                                algebra::batch_to_special<T2>(h_block);
+
+                                write(position, indices.data(), g_block.data(), h_block.data(), indices.size());
+                                position += indices.size();
+                            }
+                        }
+
+                        /* v[i] * base in blocks, each handed to write as its first index, values and size */
+                        template<typename Write>
+                        static void stream_query(const g1_engine_type &engine,
+                                                 const algebra::Fr_vector<snark_pp<CurveType>> &v, Write write) {
+                            for (std::size_t first = 0; first < v.size(); first += stream_block_size) {
+                                const std::size_t last = std::min(v.size(), first + stream_block_size);
+                                const std::vector<typename CurveType::g1_type::value_type> block = engine.batch_exp(
+                                    CurveType::scalar_field_type::value_type::one(), v, first, last, true);
+                                write(first, block.data(), block.size());
+                            }
+                        }
+
+                        /**
+                         * State of the prover that outlives a single proof for one proving key.
+                         *
+                         * The evaluation domain, the witness map buffers and the variable assignment are
+                         * kept between proofs, and the G1 parts of the input terms of A_query, the bases
+                         * of the authentication term muA, are gathered once. A workspace serves one prover
+                         * call at a time.
+                         *
+                         * The input terms Ain and muA are kept per block of input_block_size input
+                         * positions, keyed by a hash of the values and the mu of the authenticated data
+                         * points they commit to and of the position of the block. The bases of an input
+                         * term depend on its position, so the position is part of the key. A block whose
+                         * data points were already committed to at the same position in one of the last
+                         * input_block_lifetime proofs is not committed to again, so that proofs over
+                         * overlapping or recurring authenticated data only run the multi-exponentiations
+                         * of the blocks holding new data points.
+                         */
+                        class prover_workspace {
+                            using scalar_field_type = typename CurveType::scalar_field_type;
+                            using g1_type = typename CurveType::g1_type;
+                            using g1_value_type = typename g1_type::value_type;
+                            using g1g1_value_type = typename knowledge_commitment<g1_type, g1_type>::value_type;
+
+                        public:
+                            static constexpr const std::size_t input_block_size = 64;
+                            /* number of proofs a block of input terms is kept for after its last use */
+                            static constexpr const std::size_t input_block_lifetime = 4;
+
+                            /* the committed data points of a block and their terms, empty until computed */
+                            struct input_block {
+                                std::size_t first = 0;
+                                std::vector<typename scalar_field_type::value_type> values;
+                                std::vector<typename scalar_field_type::value_type> mus;
+                                g1g1_value_type Ain = g1g1_value_type::zero();
+                                g1_value_type muA = g1_value_type::zero();
+                                std::size_t last_used = 0;
+
+                                template<typename InputIterator>
+                                bool commits_to(const std::size_t first, InputIterator values_first,
+                                                InputIterator values_last, InputIterator mus_first) const {
+                                    return this->first == first &&
+                                           std::size_t(std::distance(values_first, values_last)) == values.size() &&
+                                           std::equal(values.begin(), values.end(), values_first) &&
+                                           std::equal(mus.begin(), mus.end(), mus_first);
+                                }
+                            };
+
+                            /* the key of the block of the data points [values_first, values_last) at first */
+                            template<typename InputIterator>
+                            static std::size_t input_block_key(const std::size_t first, InputIterator values_first,
+                                                               InputIterator values_last, InputIterator mus_first) {
+                                typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>>
+                                    integral_type;
+
+                                std::size_t key = first;
+                                std::vector<std::uint64_t> words;
+                                const auto combine = [&](const typename scalar_field_type::value_type &value) {
+                                    words.clear();
+                                    multiprecision::export_bits(integral_type(value.data), std::back_inserter(words),
+                                                                64, false);
+                                    for (const std::uint64_t word : words) {
+                                        key ^= std::size_t(word) + 0x9e3779b97f4a7c15ull + (key << 6) + (key >> 2);
+                                    }
+                                };
+                                for (; values_first != values_last; ++values_first, ++mus_first) {
+                                    combine(*values_first);
+                                    combine(*mus_first);
+                                }
+                                return key;
+                            }
+
+                            std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain;
+                            typename reductions::r1cs_to_qap<scalar_field_type>::workspace qap_scratch;
+
+                            std::vector<g1_value_type> A_in_g;
+                            r1cs_variable_assignment<scalar_field_type> full_variable_assignment;
+                            std::vector<typename scalar_field_type::value_type> mus;
+                            std::unordered_map<std::size_t, input_block> input_blocks;
+                            std::size_t num_proofs = 0;
+
+                            explicit prover_workspace(const proving_key<CurveType> &pk) :
+                                domain(reductions::r1cs_to_qap<scalar_field_type>::get_domain(pk.constraint_system)) {
+                                const std::size_t num_inputs = pk.constraint_system.num_inputs();
+
+                                A_in_g.reserve(num_inputs);
+                                for (std::size_t i = 0; i < num_inputs; ++i) {
+                                    A_in_g.emplace_back(pk.A_query[1 + i].g);
+                                }
+                                full_variable_assignment.reserve(pk.constraint_system.num_variables());
+                                mus.reserve(num_inputs);
+                            }
+
+                            /* drops the cached input terms, e.g. to bound the memory kept between proofs */
+                            void clear_input_blocks() {
+                                input_blocks.clear();
+                            }
+
+                            /* drops the blocks not used in the last input_block_lifetime proofs */
+                            void evict_input_blocks() {
+                                for (auto it = input_blocks.begin(); it != input_blocks.end();) {
+                                    if (num_proofs - it->second.last_used >= input_block_lifetime) {
+                                        it = input_blocks.erase(it);
+                                    } else {
+                                        ++it;
+                                    }
+                                }
+                            }
+                        };
+
                         /**
                          * A prover algorithm for the R1CS ppzkADSNARK.
                          *
@@ -797,137 +1136,205 @@ namespace nil {
                                                        const primary_input<CurveType> &primary_input,
                                                        const auxiliary_input<CurveType> &auxiliary_input,
                                                        const std::vector<auth_data<CurveType>> &auth_data) {
+                            prover_workspace workspace(pk);
+                            return prover(pk, primary_input, auxiliary_input, auth_data, workspace);
+                        }
+
+                        /**
+                         * The prover running in the buffers of a workspace built for pk.
+                         *
+                         * The multi-exponentiations over the variable assignment (A with its input part Ain,
+                         * B, C and K) and the one of the authentication term muA are split into tasks of
+                         * similar cost and run together on the current executor, alongside a task computing
+                         * the coefficients of H. The H_query tasks follow once H is known. The input terms
+                         * Ain and muA are only computed for the blocks whose authenticated data points are
+                         * not among the recent blocks of the workspace.
+                         */
+                        static proof<CurveType> prover(const proving_key<CurveType> &pk,
+                                                       const primary_input<CurveType> &primary_input,
+                                                       const auxiliary_input<CurveType> &auxiliary_input,
+                                                       const std::vector<auth_data<CurveType>> &auth_data,
+                                                       prover_workspace &workspace) {
+                            using scalar_field_type = typename CurveType::scalar_field_type;
+                            using g1_type = typename CurveType::g1_type;
+                            using g2_type = typename CurveType::g2_type;
+                            using g1_value_type = typename g1_type::value_type;
+                            using g1g1_value_type = typename knowledge_commitment<g1_type, g1_type>::value_type;
+                            using g2g1_value_type = typename knowledge_commitment<g2_type, g1_type>::value_type;
+
+                            /* sanity check */
+                            assert(pk.constraint_system.is_satisfied(primary_input, auxiliary_input));
+                            assert(auth_data.size() >= primary_input.size());
+
+                            const typename scalar_field_type::value_type
+                                d1 = algebra::random_element<scalar_field_type>(),
+                                d2 = algebra::random_element<scalar_field_type>(),
+                                d3 = algebra::random_element<scalar_field_type>(),
+                                dauth = algebra::random_element<scalar_field_type>();
+
+                            const std::size_t num_inputs = pk.constraint_system.num_inputs();
+                            const std::size_t num_variables = pk.constraint_system.num_variables();
+                            const std::size_t degree = workspace.domain->m;
+
+                            r1cs_variable_assignment<scalar_field_type> &assignment =
+                                workspace.full_variable_assignment;
+                            assignment.assign(primary_input.begin(), primary_input.end());
+                            assignment.insert(assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+
+                            workspace.mus.clear();
+                            for (std::size_t i = 0; i < num_inputs; ++i) {
+                                workspace.mus.emplace_back(auth_data[i].mu);
+                            }
 
-                            const typename CurveType::scalar_field_type::value_type
-                                d1 = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                d2 = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                d3 = algebra::random_element<typename CurveType::scalar_field_type>(),
-                                dauth = algebra::random_element<typename CurveType::scalar_field_type>();
-
-                            const qap_witness<typename CurveType::scalar_field_type> qap_wit = reductions::r1cs_to_qap<typename CurveType::scalar_field_type>::witness_map(
-                                pk.constraint_system, primary_input, auxiliary_input, d1 + dauth, d2, d3);
-
-                            typename knowledge_commitment<typename CurveType::g1_type,
-                                                          typename CurveType::g1_type>::value_type g_A =
-                                /* pk.A_query[0] + */ d1 * pk.A_query[qap_wit.num_variables + 1];
-                            typename knowledge_commitment<typename CurveType::g2_type,
-                                                          typename CurveType::g1_type>::value_type g_B =
-                                pk.B_query[0] + qap_wit.d2 * pk.B_query[qap_wit.num_variables + 1];
-                            typename knowledge_commitment<typename CurveType::g1_type,
-                                                          typename CurveType::g1_type>::value_type g_C =
-                                pk.C_query[0] + qap_wit.d3 * pk.C_query[qap_wit.num_variables + 1];
-
-                            typename knowledge_commitment<typename CurveType::g1_type,
-                                                          typename CurveType::g1_type>::value_type g_Ain =
-                                dauth * pk.A_query[qap_wit.num_variables + 1];
-
-                            typename CurveType::g1_type::value_type g_H =
-                                CurveType::g1_type::value_type::zero();
-                            typename CurveType::g1_type::value_type g_K =
-                                (pk.K_query[0] + qap_wit.d1 * pk.K_query[qap_wit.num_variables + 1] +
-                                 qap_wit.d2 * pk.K_query[qap_wit.num_variables + 2] +
-                                 qap_wit.d3 * pk.K_query[qap_wit.num_variables + 3]);
-
-#ifdef MULTICORE
-                            const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                                 // var or call omp_set_num_threads()
-#else
-                            const std::size_t chunks = 1;
-#endif
-
-                            g_A = g_A + kc_multiexp_with_mixed_addition<
-                                            typename CurveType::g1_type, typename CurveType::g1_type,
-                                            typename CurveType::scalar_field_type,
-                                            algebra::policies::multiexp_method_bos_coster<
-                                                typename knowledge_commitment<typename CurveType::g1_type,
-                                                                              typename CurveType::g1_type>::value_type,
-                                                typename CurveType::scalar_field_type>>(
-                                            pk.A_query, 1 + qap_wit.num_inputs, 1 + qap_wit.num_variables,
-                                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_inputs,
-                                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables, chunks);
-
-                            g_Ain = g_Ain +
-                                    kc_multiexp_with_mixed_addition<
-                                        typename CurveType::g1_type, typename CurveType::g1_type,
-                                        typename CurveType::scalar_field_type,
-                                        algebra::policies::multiexp_method_bos_coster<
-                                            typename knowledge_commitment<typename CurveType::g1_type,
-                                                                          typename CurveType::g1_type>::value_type,
-                                            typename CurveType::scalar_field_type>>(
-                                        pk.A_query, 1, 1 + qap_wit.num_inputs, qap_wit.coefficients_for_ABCs.begin(),
-                                        qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_inputs, chunks);
-                            // std :: cout << "The input proof term: " << g_Ain << "\n";
-
-                            g_B = g_B + kc_multiexp_with_mixed_addition<
-                                            typename CurveType::g2_type, typename CurveType::g1_type,
-                                            typename CurveType::scalar_field_type,
-                                            algebra::policies::multiexp_method_bos_coster<
-                                                typename knowledge_commitment<typename CurveType::g1_type,
-                                                                              typename CurveType::g1_type>::value_type,
-                                                typename CurveType::scalar_field_type>>(
-                                            pk.B_query, 1, 1 + qap_wit.num_variables,
-                                            qap_wit.coefficients_for_ABCs.begin(),
-                                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables, chunks);
-
-                            g_C = g_C + kc_multiexp_with_mixed_addition<
-                                            typename CurveType::g1_type, typename CurveType::g1_type,
-                                            typename CurveType::scalar_field_type,
-                                            algebra::policies::multiexp_method_bos_coster<
-                                                typename knowledge_commitment<typename CurveType::g1_type,
-                                                                              typename CurveType::g1_type>::value_type,
-                                                typename CurveType::scalar_field_type>>(
-                                            pk.C_query, 1, 1 + qap_wit.num_variables,
-                                            qap_wit.coefficients_for_ABCs.begin(),
-                                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables, chunks);
-
-                            g_H = g_H +
-                                  algebra::multiexp<
-                                      typename CurveType::g1_type, typename CurveType::scalar_field_type,
-                                      algebra::policies::multiexp_method_BDLO12<typename CurveType::g1_type,
-                                                                                typename CurveType::scalar_field_type>>(
-                                      pk.H_query.begin(),
-                                      pk.H_query.begin() + qap_wit.degree + 1,
-                                      qap_wit.coefficients_for_H.begin(),
-                                      qap_wit.coefficients_for_H.begin() + qap_wit.degree + 1,
-                                      chunks);
-
-                            g_K = g_K + algebra::multiexp_with_mixed_addition<
-                                            typename CurveType::g1_type, typename CurveType::scalar_field_type,
-                                            algebra::policies::multiexp_method_bos_coster<
-                                                typename CurveType::g1_type, typename CurveType::scalar_field_type>>(
-                                            pk.K_query.begin() + 1,
-                                            pk.K_query.begin() + 1 + qap_wit.num_variables,
-                                            qap_wit.coefficients_for_ABCs.begin(),
-                                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables,
-                                            chunks);
-
-                            std::vector<typename CurveType::scalar_field_type::value_type> mus;
-                            std::vector<typename CurveType::g1_type::value_type> Ains;
-                            mus.reserve(qap_wit.num_inputs);
-                            Ains.reserve(qap_wit.num_inputs);
-                            for (std::size_t i = 0; i < qap_wit.num_inputs; i++) {
-                                mus.emplace_back(auth_data[i].mu);
-                                Ains.emplace_back(pk.A_query[i + 1].g);
+                            /* the blocks of input terms of this proof, and those with new data points among them */
+                            using input_block = typename prover_workspace::input_block;
+                            const std::size_t block_size = prover_workspace::input_block_size;
+                            const std::size_t num_blocks = (num_inputs + block_size - 1) / block_size;
+                            std::vector<input_block *> blocks(num_blocks);
+                            std::vector<std::size_t> stale_blocks;
+                            std::size_t num_stale_inputs = 0;
+                            ++workspace.num_proofs;
+                            for (std::size_t b = 0; b < num_blocks; ++b) {
+                                const std::size_t first = b * block_size;
+                                const std::size_t last = std::min(first + block_size, num_inputs);
+                                std::size_t key = prover_workspace::input_block_key(
+                                    first, assignment.cbegin() + first, assignment.cbegin() + last,
+                                    workspace.mus.cbegin() + first);
+
+                                /* pointers into an unordered_map stay valid as the blocks are inserted; a key
+                                   taken by another block of this proof is a collision, probed past */
+                                for (;; ++key) {
+                                    input_block &block = workspace.input_blocks[key];
+                                    if (block.commits_to(first, assignment.cbegin() + first,
+                                                         assignment.cbegin() + last, workspace.mus.cbegin() + first)) {
+                                        blocks[b] = &block;
+                                        break;
+                                    }
+                                    if (block.last_used != workspace.num_proofs) {
+                                        block = input_block();
+                                        blocks[b] = &block;
+                                        stale_blocks.emplace_back(b);
+                                        num_stale_inputs += last - first;
+                                        break;
+                                    }
+                                }
+                                blocks[b]->last_used = workspace.num_proofs;
+                            }
+                            workspace.evict_input_blocks();
+
+                            const std::size_t g1 = multiexp_task_list::g1_cost, g2 = multiexp_task_list::g2_cost;
+                            multiexp_task_list tasks(num_variables * (2 * g1 + (g2 + g1) + 2 * g1 + g1) -
+                                                     num_inputs * 2 * g1 + num_stale_inputs * 3 * g1 +
+                                                     (degree + 1) * g1);
+
+                            std::vector<typename scalar_field_type::value_type> coefficients_for_H;
+                            std::vector<g1g1_value_type> parts_A, parts_C;
+                            std::vector<g2g1_value_type> parts_B;
+                            std::vector<g1_value_type> parts_H, parts_K;
+
+                            /* the witness map, seven FFTs, runs on its own executor alongside the
+                               assignment-only multiexps */
+                            tasks.add_alongside(
+                                [&]() {
+                                    coefficients_for_H =
+                                        reductions::r1cs_to_qap<scalar_field_type>::coefficients_for_H(
+                                            pk.constraint_system, assignment, d1 + dauth, d2, d3, workspace.domain,
+                                            workspace.qap_scratch);
+                                },
+                                multiexp_task_list::fft_cost(degree, 7));
+
+                            /* variable i + 1 of the queries is scaled by assignment[i] */
+                            tasks.add(
+                                parts_B, num_variables, g2 + g1,
+                                [&](std::size_t first, std::size_t last) {
+                                    return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                        pk.B_query, 1 + first, 1 + last, assignment.begin() + first,
+                                        assignment.begin() + last, 1);
+                                });
+
+                            tasks.add(
+                                parts_A, num_variables - num_inputs, 2 * g1,
+                                [&](std::size_t first, std::size_t last) {
+                                    return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                        pk.A_query, 1 + num_inputs + first, 1 + num_inputs + last,
+                                        assignment.begin() + num_inputs + first, assignment.begin() + num_inputs + last,
+                                        1);
+                                });
+
+                            tasks.add(
+                                parts_C, num_variables, 2 * g1,
+                                [&](std::size_t first, std::size_t last) {
+                                    return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                        pk.C_query, 1 + first, 1 + last, assignment.begin() + first,
+                                        assignment.begin() + last, 1);
+                                });
+
+                            tasks.add(
+                                parts_K, num_variables, g1,
+                                [&](std::size_t first, std::size_t last) {
+                                    return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                        pk.K_query.begin() + 1 + first, pk.K_query.begin() + 1 + last,
+                                        assignment.begin() + first, assignment.begin() + last, 1);
+                                });
+
+                            /* a block records its data points once its terms are known, so that it stays
+                               consistent if the proof is abandoned */
+                            for (const std::size_t b : stale_blocks) {
+                                const std::size_t first = b * block_size;
+                                const std::size_t last = std::min(first + block_size, num_inputs);
+                                tasks.add(
+                                    [&, b, first, last]() {
+                                        input_block &block = *blocks[b];
+
+                                        block.Ain = kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                            pk.A_query, 1 + first, 1 + last, assignment.begin() + first,
+                                            assignment.begin() + last, 1);
+                                        block.muA = dispatch_multiexp<multiexp_method_auto>(
+                                            workspace.A_in_g.begin() + first, workspace.A_in_g.begin() + last,
+                                            workspace.mus.begin() + first, workspace.mus.begin() + last, 1);
+                                        block.first = first;
+                                        block.values.assign(assignment.begin() + first, assignment.begin() + last);
+                                        block.mus.assign(workspace.mus.begin() + first,
+                                                         workspace.mus.begin() + last);
+                                    },
+                                    (last - first) * (2 * g1 + g1));
                             }
-                            typename CurveType::g1_type::value_type muA = dauth * pk.rA_i_Z_g1;
-                            muA = muA + algebra::multiexp<
-                                            typename CurveType::g1_type, typename CurveType::scalar_field_type,
-                                            algebra::policies::multiexp_method_bos_coster<
-                                                typename CurveType::g1_type, typename CurveType::scalar_field_type>>(
-                                            Ains.begin(), Ains.begin() + qap_wit.num_inputs, mus.begin(),
-                                            mus.begin() + qap_wit.num_inputs, chunks);
 
-                            // To Do: Decide whether to include relevant parts of auth_data in proof
+                            stage_profiler::timer multiexp_timer("multiexp");
+                            tasks.run();
+                            multiexp_timer.stop();
+
+                            tasks.add(parts_H, degree + 1, g1, [&](std::size_t first, std::size_t last) {
+                                return dispatch_multiexp<multiexp_method_auto>(
+                                    pk.H_query.begin() + first, pk.H_query.begin() + last,
+                                    coefficients_for_H.begin() + first, coefficients_for_H.begin() + last, 1);
+                            });
+
+                            stage_profiler::timer multiexp_H_timer("multiexp_H");
+                            tasks.run();
+                            multiexp_H_timer.stop();
+
+                            g1g1_value_type g_A = /* pk.A_query[0] + */ d1 * pk.A_query[num_variables + 1] +
+                                                  multiexp_task_list::sum(parts_A);
+                            g2g1_value_type g_B =
+                                pk.B_query[0] + d2 * pk.B_query[num_variables + 1] + multiexp_task_list::sum(parts_B);
+                            g1g1_value_type g_C =
+                                pk.C_query[0] + d3 * pk.C_query[num_variables + 1] + multiexp_task_list::sum(parts_C);
+                            g1_value_type g_H = multiexp_task_list::sum(parts_H);
+                            g1_value_type g_K = pk.K_query[0] + (d1 + dauth) * pk.K_query[num_variables + 1] +
+                                                d2 * pk.K_query[num_variables + 2] +
+                                                d3 * pk.K_query[num_variables + 3] + multiexp_task_list::sum(parts_K);
+                            g1g1_value_type g_Ain = dauth * pk.A_query[num_variables + 1];
+                            g1_value_type muA = dauth * pk.rA_i_Z_g1;
+                            for (const input_block *block : blocks) {
+                                g_Ain = g_Ain + block->Ain;
+                                muA = muA + block->muA;
+                            }
 
-                            proof<CurveType> proof = proof<CurveType>(std::move(g_A),
-                                                                      std::move(g_B),
-                                                                      std::move(g_C),
-                                                                      std::move(g_H),
-                                                                      std::move(g_K),
-                                                                      std::move(g_Ain),
-                                                                      std::move(muA));
+                            // To Do: Decide whether to include relevant parts of auth_data in proof
 
-                            return proof;
+                            return proof<CurveType>(std::move(g_A), std::move(g_B), std::move(g_C), std::move(g_H),
+                                                    std::move(g_K), std::move(g_Ain), std::move(muA));
                         }
 
                         /*
@@ -961,6 +1368,8 @@ namespace nil {
                             pvk.vk_gamma_g2_precomp = pairing_policy::precompute_g2(vk.gamma_g2);
                             pvk.vk_gamma_beta_g1_precomp = pairing_policy::precompute_g1(vk.gamma_beta_g1);
                             pvk.vk_gamma_beta_g2_precomp = pairing_policy::precompute_g2(vk.gamma_beta_g2);
+                            pvk.vk_alphaB_g1 = vk.alphaB_g1;
+                            pvk.vk_gamma_beta_g1 = vk.gamma_beta_g1;
 
                             typename pairing_policy::g2_precomp::value_type vk_rC_z_g2_precomp =
                                 pairing_policy::precompute_g2(vk.rC_Z_g2);
@@ -976,135 +1385,233 @@ namespace nil {
                             return pvk;
                         }
 
+                        /**
+                         * The number of pairing checks of the online verifier for one proof: the knowledge
+                         * commitments of Aau, A, B and C, the divisibility and the same-coefficient checks.
+                         */
+                        static constexpr const std::size_t online_num_checks = 6;
+
+                        /**
+                         * The G1 sides of the pairings of the online checks with the fixed G2 elements of a
+                         * processed verification key, summed over the checks and the proofs of a batch.
+                         */
+                        struct online_check_sums {
+                            typedef typename CurveType::g1_type::value_type g1_value_type;
+
+                            g1_value_type alphaA, one, alphaC, rC_Z, gamma, gamma_beta;
+
+                            online_check_sums() :
+                                alphaA(g1_value_type::zero()), one(g1_value_type::zero()),
+                                alphaC(g1_value_type::zero()), rC_Z(g1_value_type::zero()),
+                                gamma(g1_value_type::zero()), gamma_beta(g1_value_type::zero()) {
+                            }
+
+                            online_check_sums &operator+=(const online_check_sums &other) {
+                                alphaA = alphaA + other.alphaA;
+                                one = one + other.one;
+                                alphaC = alphaC + other.alphaC;
+                                rC_Z = rC_Z + other.rC_Z;
+                                gamma = gamma + other.gamma;
+                                gamma_beta = gamma_beta + other.gamma_beta;
+                                return *this;
+                            }
+                        };
+
+                        /**
+                         * Random non-zero coefficients for a batch of batch_size proofs, 1 + online_num_checks
+                         * per proof: the weight of its authentication check, then those of its pairing checks.
+                         * The first weight is 1, a random linear combination only needs the others random.
+                         */
+                        template<typename DistributionType, typename GeneratorType>
+                        static std::vector<typename CurveType::scalar_field_type::value_type>
+                            online_check_coefficients(const std::size_t batch_size) {
+                            using scalar_field_type = typename CurveType::scalar_field_type;
+
+                            std::vector<typename scalar_field_type::value_type> coefficients;
+                            coefficients.reserve((1 + online_num_checks) * batch_size);
+                            coefficients.emplace_back(scalar_field_type::value_type::one());
+                            while (coefficients.size() < (1 + online_num_checks) * batch_size) {
+                                typename scalar_field_type::value_type coefficient =
+                                    algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                if (!coefficient.is_zero()) {
+                                    coefficients.emplace_back(coefficient);
+                                }
+                            }
+                            return coefficients;
+                        }
+
+                        /**
+                         * Adds to sums the pairing checks of every proof raised to its coefficients, a check
+                         * e(P, Q) = e(P', Q') becoming e(r P, Q) e(-r P', Q') = 1. The only G2 element of the
+                         * checks outside of the key is g_B.g, whose G1 side is returned in B_sides for each
+                         * proof. The proofs are accumulated by blocks across the current executor.
+                         */
+                        static void accumulate_online_checks(
+                            const processed_verification_key<CurveType> &pvk,
+                            const std::vector<proof<CurveType>> &proofs,
+                            const std::vector<typename CurveType::scalar_field_type::value_type> &coefficients,
+                            online_check_sums &sums,
+                            std::vector<typename CurveType::g1_type::value_type> &B_sides) {
+                            const std::size_t batch_size = proofs.size();
+                            const std::size_t num_blocks = std::min(batch_size, executor::current().concurrency());
+                            const std::size_t block_size = (batch_size + num_blocks - 1) / num_blocks;
+
+                            B_sides.resize(batch_size);
+                            std::vector<online_check_sums> block_sums(num_blocks);
+                            executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                                online_check_sums &s = block_sums[block];
+                                const std::size_t end = std::min(batch_size, (block + 1) * block_size);
+                                for (std::size_t j = block * block_size; j < end; ++j) {
+                                    const proof<CurveType> &pi = proofs[j];
+                                    const typename CurveType::scalar_field_type::value_type *r =
+                                        &coefficients[(1 + online_num_checks) * j + 1];
+                                    const typename CurveType::g1_type::value_type Aacc =
+                                        pvk.A0 + pi.g_Aau.g + pi.g_A.g;
+
+                                    /* e(Aau.g, alphaA) = e(Aau.h, 1), e(A.g, alphaA) = e(A.h, 1),
+                                       e(alphaB, B.g) = e(B.h, 1), e(C.g, alphaC) = e(C.h, 1) */
+                                    s.alphaA = s.alphaA + r[0] * pi.g_Aau.g + r[1] * pi.g_A.g;
+                                    s.one = s.one - (r[0] * pi.g_Aau.h + r[1] * pi.g_A.h + r[2] * pi.g_B.h +
+                                                     r[3] * pi.g_C.h + r[4] * pi.g_C.g);
+                                    s.alphaC = s.alphaC + r[3] * pi.g_C.g;
+                                    /* e(Aacc, B.g) = e(H, rC_Z) e(C.g, 1) */
+                                    s.rC_Z = s.rC_Z - r[4] * pi.g_H;
+                                    /* e(K, gamma) = e(Aacc + C.g, gamma_beta) e(gamma_beta_g1, B.g) */
+                                    s.gamma = s.gamma + r[5] * pi.g_K;
+                                    s.gamma_beta = s.gamma_beta - r[5] * (Aacc + pi.g_C.g);
+
+                                    B_sides[j] = r[2] * pvk.vk_alphaB_g1 + r[4] * Aacc - r[5] * pvk.vk_gamma_beta_g1;
+                                }
+                            });
+
+                            for (const online_check_sums &s : block_sums) {
+                                sums += s;
+                            }
+                        }
+
+                        /**
+                         * Product of the Miller loops of the sums with the fixed G2 elements of the key.
+                         */
+                        static typename snark_pp<CurveType>::pairing::fqk_type::value_type
+                            online_fixed_miller_loops(const processed_verification_key<CurveType> &pvk,
+                                                      const online_check_sums &sums) {
+                            using pairing_policy = typename snark_pp<CurveType>::pairing;
+
+                            return pairing_policy::double_miller_loop(pairing_policy::precompute_g1(sums.alphaA),
+                                                                      pvk.vk_alphaA_g2_precomp,
+                                                                      pairing_policy::precompute_g1(sums.one),
+                                                                      pvk.pp_G2_one_precomp) *
+                                   pairing_policy::double_miller_loop(pairing_policy::precompute_g1(sums.alphaC),
+                                                                      pvk.vk_alphaC_g2_precomp,
+                                                                      pairing_policy::precompute_g1(sums.rC_Z),
+                                                                      pvk.vk_rC_Z_g2_precomp) *
+                                   pairing_policy::double_miller_loop(pairing_policy::precompute_g1(sums.gamma),
+                                                                      pvk.vk_gamma_g2_precomp,
+                                                                      pairing_policy::precompute_g1(sums.gamma_beta),
+                                                                      pvk.vk_gamma_beta_g2_precomp);
+                        }
+
                         /**
                          * A symmetric verifier algorithm for the R1CS ppzkADSNARK that
                          * accepts a processed verification key.
+                         *
+                         * The proof is checked as a batch of one, see online_batch_verifier.
                          */
                         // symmetric
                         static bool online_verifier(const processed_verification_key<CurveType> &pvk,
-                                                    const proof<CurveType> &proof,
+                                                    const proof<CurveType> &pi,
                                                     const sec_auth_key<CurveType> &sak,
                                                     const std::vector<label_type> &labels) {
+                            return online_batch_verifier(pvk, std::vector<proof<CurveType>>(1, pi), sak,
+                                                         std::vector<std::vector<label_type>>(1, labels));
+                        }
 
+                        /**
+                         * A symmetric online verifier for a batch of proofs of the R1CS ppzkADSNARK under one
+                         * processed verification key, labels[j] being the labels of the data of proofs[j].
+                         *
+                         * The checks of every proof are raised to random non-zero coefficients. The
+                         * authentication checks i * Aau.g + \sum_k lambda_k Ain_k = muA of the batch become a
+                         * single multi-exponentiation over the PRF values combined per label position. The
+                         * pairing checks become one multi-pairing: the G1 sides paired with the same element
+                         * of the key are summed, which leaves six Miller loops for the key and one per proof
+                         * for its g_B, and a single final exponentiation. A batch with an invalid proof passes
+                         * with negligible probability over the choice of the coefficients, drawn from
+                         * GeneratorType, the entropy of the system by default. A batch with more labels than the
+                         * key or than proofs is rejected.
+                         */
+                        template<typename DistributionType = boost::random::uniform_int_distribution<
+                                     typename CurveType::scalar_field_type::modulus_type>,
+                                 typename GeneratorType = random_device_generator>
+                        static bool online_batch_verifier(const processed_verification_key<CurveType> &pvk,
+                                                          const std::vector<proof<CurveType>> &proofs,
+                                                          const sec_auth_key<CurveType> &sak,
+                                                          const std::vector<std::vector<label_type>> &labels) {
+                            using scalar_field_type = typename CurveType::scalar_field_type;
+                            using g1_type = typename CurveType::g1_type;
                             using pairing_policy = typename snark_pp<CurveType>::pairing;
 
-                            bool result = true;
-
-                            if (!proof.is_well_formed()) {
-                                result = false;
+                            if (labels.size() != proofs.size()) {
+                                return false;
                             }
-
-                            std::vector<typename CurveType::scalar_field_type::value_type> lambdas;
-                            lambdas.reserve(labels.size());
-                            for (std::size_t i = 0; i < labels.size(); i++) {
-                                lambdas.emplace_back(prfCompute<CurveType>(sak.S, labels[i]));
+                            const std::size_t batch_size = proofs.size();
+                            if (!batch_size) {
+                                return true;
                             }
-                            typename CurveType::g1_type::value_type prodA = sak.i * proof.g_Aau.g;
-                            prodA =
-                                prodA + algebra::multiexp<
-                                            typename CurveType::g1_type, typename CurveType::scalar_field_type,
-                                            algebra::policies::multiexp_method_bos_coster<
-                                                typename CurveType::g1_type, typename CurveType::scalar_field_type>>(
-                                            pvk.Ain.begin(), pvk.Ain.begin() + labels.size(), lambdas.begin(),
-                                            lambdas.begin() + labels.size(), 1);
-
-                            bool result_auth = true;
-
-                            if (!(prodA == proof.muA)) {
-                                result_auth = false;
+                            for (const proof<CurveType> &pi : proofs) {
+                                if (!pi.is_well_formed()) {
+                                    return false;
+                                }
                             }
 
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aau_g_precomp =
-                                pairing_policy::precompute_g1(proof.g_Aau.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aau_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_Aau.h);
-
-                            typename pairing_policy::fqk_type::value_type kc_Aau_1 =
-                                pairing_policy:: ::miller_loop(proof_g_Aau_g_precomp, pvk.vk_alphaA_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_Aau_2 =
-                                pairing_policy::miller_loop(proof_g_Aau_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_Aau =
-                                pairing_policy::final_exponentiation(kc_Aau_1 * kc_Aau_2.unitary_inversed());
-                            if (kc_Aau != pairing_policy::gt_type::one()) {
-                                result_auth = false;
-                            }
+                            const std::vector<typename scalar_field_type::value_type> coefficients =
+                                online_check_coefficients<DistributionType, GeneratorType>(batch_size);
 
-                            result &= result_auth;
-
-                            typename pairing_policy::g1_precomp::value_type proof_g_A_g_precomp =
-                                pairing_policy::precompute_g1(proof.g_A.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_A_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_A.h);
-                            typename pairing_policy::fqk_type::value_type kc_A_1 =
-                                pairing_policy::miller_loop(proof_g_A_g_precomp, pvk.vk_alphaA_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_A_2 =
-                                pairing_policy::miller_loop(proof_g_A_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_A =
-                                pairing_policy::final_exponentiation(kc_A_1 * kc_A_2.unitary_inversed());
-                            if (kc_A != pairing_policy::gt_type::one()) {
-                                result = false;
+                            std::size_t num_labels = 0;
+                            for (const std::vector<label_type> &proof_labels : labels) {
+                                num_labels = std::max(num_labels, proof_labels.size());
                             }
-
-                            typename pairing_policy::g2_precomp::value_type proof_g_B_g_precomp =
-                                pairing_policy::precompute_g2(proof.g_B.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_B_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_B.h);
-                            typename pairing_policy::fqk_type::value_type kc_B_1 =
-                                pairing_policy::miller_loop(pvk.vk_alphaB_g1_precomp, proof_g_B_g_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_B_2 =
-                                pairing_policy::miller_loop(proof_g_B_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_B =
-                                pairing_policy::final_exponentiation(kc_B_1 * kc_B_2.unitary_inversed());
-                            if (kc_B != pairing_policy::gt_type::one()) {
-                                result = false;
+                            if (num_labels > pvk.Ain.size()) {
+                                return false;
                             }
 
-                            typename pairing_policy::g1_precomp::value_type proof_g_C_g_precomp =
-                                pairing_policy::precompute_g1(proof.g_C.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_C_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_C.h);
-                            typename pairing_policy::fqk_type::value_type kc_C_1 =
-                                pairing_policy::miller_loop(proof_g_C_g_precomp, pvk.vk_alphaC_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_C_2 =
-                                pairing_policy::miller_loop(proof_g_C_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_C =
-                                pairing_policy::final_exponentiation(kc_C_1 * kc_C_2.unitary_inversed());
-                            if (kc_C != pairing_policy::gt_type::one()) {
-                                result = false;
+                            std::vector<typename scalar_field_type::value_type> combined_lambdas(
+                                num_labels, scalar_field_type::value_type::zero());
+                            typename g1_type::value_type Aau_sum = g1_type::value_type::zero(),
+                                                         muA_sum = g1_type::value_type::zero();
+                            for (std::size_t j = 0; j < batch_size; ++j) {
+                                const typename scalar_field_type::value_type &t =
+                                    coefficients[(1 + online_num_checks) * j];
+                                for (std::size_t k = 0; k < labels[j].size(); ++k) {
+                                    combined_lambdas[k] += t * prfCompute<CurveType>(sak.S, labels[j][k]);
+                                }
+                                Aau_sum = Aau_sum + t * proofs[j].g_Aau.g;
+                                muA_sum = muA_sum + t * proofs[j].muA;
                             }
 
-                            typename CurveType::g1_type::value_type Aacc = pvk.A0 + proof.g_Aau.g + proof.g_A.g;
-
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aacc_precomp =
-                                pairing_policy::precompute_g1(Aacc);
-                            typename pairing_policy::g1_precomp::value_type proof_g_H_precomp =
-                                pairing_policy::precompute_g1(proof.g_H);
-                            typename pairing_policy::fqk_type::value_type QAP_1 =
-                                pairing_policy::miller_loop(proof_g_Aacc_precomp, proof_g_B_g_precomp);
-                            typename pairing_policy::fqk_type::value_type QAP_23 = pairing_policy::double_miller_loop(
-                                proof_g_H_precomp, pvk.vk_rC_Z_g2_precomp, proof_g_C_g_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type QAP =
-                                pairing_policy::final_exponentiation(QAP_1 * QAP_23.unitary_inversed());
-                            if (QAP != pairing_policy::gt_type::one()) {
-                                result = false;
+                            const typename g1_type::value_type prodA =
+                                sak.i * Aau_sum + dispatch_multiexp<multiexp_method_auto>(
+                                                      pvk.Ain.begin(), pvk.Ain.begin() + num_labels,
+                                                      combined_lambdas.begin(), combined_lambdas.end(),
+                                                      executor::current().concurrency());
+                            if (!(prodA == muA_sum)) {
+                                return false;
                             }
 
-                            typename pairing_policy::g1_precomp::value_type proof_g_K_precomp =
-                                pairing_policy::precompute_g1(proof.g_K);
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aacc_C_precomp =
-                                pairing_policy::precompute_g1(Aacc + proof.g_C.g);
-                            typename pairing_policy::fqk_type::value_type K_1 =
-                                pairing_policy::miller_loop(proof_g_K_precomp, pvk.vk_gamma_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type K_23 =
-                                pairing_policy::double_miller_loop(proof_g_Aacc_C_precomp, pvk.vk_gamma_beta_g2_precomp,
-                                                                   pvk.vk_gamma_beta_g1_precomp, proof_g_B_g_precomp);
-                            typename pairing_policy::gt_type K =
-                                pairing_policy::final_exponentiation(K_1 * K_23.unitary_inversed());
-                            if (K != pairing_policy::gt_type::one()) {
-                                result = false;
+                            online_check_sums sums;
+                            std::vector<typename g1_type::value_type> B_sides;
+                            accumulate_online_checks(pvk, proofs, coefficients, sums, B_sides);
+
+                            std::vector<typename CurveType::g2_type::value_type> B_g;
+                            B_g.reserve(batch_size);
+                            for (const proof<CurveType> &pi : proofs) {
+                                B_g.emplace_back(pi.g_B.g);
                             }
 
-                            return result;
+                            const typename pairing_policy::fqk_type::value_type product =
+                                online_fixed_miller_loops(pvk, sums) *
+                                multi_miller_loop<snark_pp<CurveType>>(B_sides.begin(), B_sides.end(), B_g.begin());
+                            return pairing_policy::final_exponentiation(product) == pairing_policy::gt_type::one();
                         }
 
                         /**
@@ -1123,161 +1630,129 @@ namespace nil {
                         /**
                          * A verifier algorithm for the R1CS ppzkADSNARK that
                          * accepts a processed verification key.
+                         *
+                         * The proof is checked as a batch of one, see online_batch_verifier.
                          */
                         // public
                         static bool online_verifier(const processed_verification_key<CurveType> &pvk,
-                                                    const std::vector<auth_data<CurveType>> &auth_data,
-                                                    const proof<CurveType> &proof,
+                                                    const std::vector<auth_data<CurveType>> &authenticated_data,
+                                                    const proof<CurveType> &pi,
                                                     const pub_auth_key<CurveType> &pak,
                                                     const std::vector<label_type> &labels) {
+                            return online_batch_verifier(
+                                pvk, std::vector<std::vector<auth_data<CurveType>>>(1, authenticated_data),
+                                std::vector<proof<CurveType>>(1, pi), pak,
+                                std::vector<std::vector<label_type>>(1, labels));
+                        }
 
+                        /**
+                         * A public online verifier for a batch of proofs of the R1CS ppzkADSNARK under one
+                         * processed verification key, auth_data[j] and labels[j] being the authenticated data
+                         * of proofs[j] and its labels.
+                         *
+                         * The signatures of all the data are checked at once through sigBatchVerif. The checks
+                         * of every proof are raised to random non-zero coefficients t_j for the authentication
+                         * check \prod_k e(Ain_k, Lambda_k) = e(muA, 1) e(Aau.g, minusI2) and r_j for the others.
+                         * All of them then become one multi-pairing with a single final exponentiation: the
+                         * Lambda values at the same label position are combined into \sum_j t_j Lambda_{j,k},
+                         * paired with the precomputed Ain_k, and the G1 sides paired with the same fixed
+                         * element are summed, which leaves one Miller loop per label position, seven for the
+                         * keys and one per proof for its g_B. With a single proof t_0 = 1 and the Lambda values
+                         * are paired as they are. A batch with an invalid proof passes with negligible
+                         * probability over the choice of the coefficients, drawn from GeneratorType, the entropy
+                         * of the system by default. A batch whose labels, authenticated data and proofs do not
+                         * match in number is rejected.
+                         */
+                        template<typename DistributionType = boost::random::uniform_int_distribution<
+                                     typename CurveType::scalar_field_type::modulus_type>,
+                                 typename GeneratorType = random_device_generator>
+                        static bool
+                            online_batch_verifier(const processed_verification_key<CurveType> &pvk,
+                                                  const std::vector<std::vector<auth_data<CurveType>>> &auth_data,
+                                                  const std::vector<proof<CurveType>> &proofs,
+                                                  const pub_auth_key<CurveType> &pak,
+                                                  const std::vector<std::vector<label_type>> &labels) {
+                            using scalar_field_type = typename CurveType::scalar_field_type;
+                            using g1_type = typename CurveType::g1_type;
+                            using g2_type = typename CurveType::g2_type;
                             using pairing_policy = typename snark_pp<CurveType>::pairing;
 
-                            bool result = true;
-
-                            if (!proof.is_well_formed()) {
-                                result = false;
-                            }
-
-                            assert(labels.size() == auth_data.size());
-
-                            std::vector<typename CurveType::g2_type> Lambdas;
-                            std::vector<signature<CurveType>> sigs;
-                            Lambdas.reserve(labels.size());
-                            sigs.reserve(labels.size());
-                            for (std::size_t i = 0; i < labels.size(); i++) {
-                                Lambdas.emplace_back(auth_data[i].Lambda);
-                                sigs.emplace_back(auth_data[i].sigma);
-                            }
-                            bool result_auth = sigBatchVerif<CurveType>(pak.vkp, labels, Lambdas, sigs);
-                            if (!result_auth) {
-                            }
-
-                            // To Do: Decide whether to move pak and lambda preprocessing to offline
-                            std::vector<pairing_policy::g2_precomp> g_Lambdas_precomp;
-                            g_Lambdas_precomp.reserve(auth_data.size());
-                            for (std::size_t i = 0; i < auth_data.size(); i++)
-                                g_Lambdas_precomp.emplace_back(pairing_policy::precompute_g2(auth_data[i].Lambda));
-                            typename pairing_policy::g2_precomp::value_type g_minusi_precomp =
-                                pairing_policy::precompute_g2(pak.minusI2);
-
-                            typename pairing_policy::fqk_type::value_type accum;
-                            if (auth_data.size() % 2 == 1) {
-                                pairing_policy::miller_loop(pvk.proof_g_vki_precomp[0], g_Lambdas_precomp[0]);
-                            } else {
-                                accum = pairing_policy::fqk_type::value_type::one();
-                            }
-                            for (std::size_t i = auth_data.size() % 2; i < labels.size(); i = i + 2) {
-                                accum = accum * pairing_policy::double_miller_loop(
-                                                    pvk.proof_g_vki_precomp[i], g_Lambdas_precomp[i],
-                                                    pvk.proof_g_vki_precomp[i + 1], g_Lambdas_precomp[i + 1]);
-                            }
-
-                            typename pairing_policy::g1_precomp::value_type proof_g_muA_precomp =
-                                pairing_policy::precompute_g1(proof.muA);
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aau_precomp =
-                                pairing_policy::precompute_g1(proof.g_Aau.g);
-                            typename pairing_policy::fqk_type::value_type accum2 = pairing_policy::double_miller_loop(
-                                proof_g_muA_precomp, pvk.pp_G2_one_precomp, proof_g_Aau_precomp, g_minusi_precomp);
-                            typename pairing_policy::gt_type authPair =
-                                pairing_policy::final_exponentiation(accum * accum2.unitary_inversed());
-                            if (authPair != pairing_policy::gt_type::one()) {
-                                result_auth = false;
-                            }
-
-                            if (!(result_auth)) {
+                            if (labels.size() != proofs.size() || auth_data.size() != proofs.size()) {
+                                return false;
                             }
-
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aau_g_precomp =
-                                pairing_policy::precompute_g1(proof.g_Aau.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aau_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_Aau.h);
-                            typename pairing_policy::fqk_type::value_type kc_Aau_1 =
-                                pairing_policy::miller_loop(proof_g_Aau_g_precomp, pvk.vk_alphaA_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_Aau_2 =
-                                pairing_policy::miller_loop(proof_g_Aau_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_Aau =
-                                typename ::final_exponentiation(kc_Aau_1 * kc_Aau_2.unitary_inversed());
-                            if (kc_Aau != pairing_policy::gt_type::one()) {
-                                result_auth = false;
+                            const std::size_t batch_size = proofs.size();
+                            if (!batch_size) {
+                                return true;
                             }
-
-                            result &= result_auth;
-
-                            typename pairing_policy::g1_precomp::value_type proof_g_A_g_precomp =
-                                pairing_policy::precompute_g1(proof.g_A.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_A_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_A.h);
-                            typename pairing_policy::fqk_type::value_type kc_A_1 =
-                                pairing_policy::miller_loop(proof_g_A_g_precomp, pvk.vk_alphaA_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_A_2 =
-                                pairing_policy::miller_loop(proof_g_A_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_A =
-                                pairing_policy::final_exponentiation(kc_A_1 * kc_A_2.unitary_inversed());
-                            if (kc_A != pairing_policy::gt_type::one()) {
-                                result = false;
+                            for (const proof<CurveType> &pi : proofs) {
+                                if (!pi.is_well_formed()) {
+                                    return false;
+                                }
                             }
 
-                            typename pairing_policy::g2_precomp::value_type proof_g_B_g_precomp =
-                                pairing_policy::precompute_g2(proof.g_B.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_B_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_B.h);
-                            typename pairing_policy::fqk_type::value_type kc_B_1 =
-                                pairing_policy::miller_loop(pvk.vk_alphaB_g1_precomp, proof_g_B_g_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_B_2 =
-                                pairing_policy::miller_loop(proof_g_B_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_B =
-                                pairing_policy::final_exponentiation(kc_B_1 * kc_B_2.unitary_inversed());
-                            if (kc_B != pairing_policy::gt_type::one()) {
-                                result = false;
+                            std::size_t num_labels = 0;
+                            std::vector<label_type> all_labels;
+                            std::vector<typename g2_type::value_type> Lambdas;
+                            std::vector<signature<CurveType>> sigs;
+                            for (std::size_t j = 0; j < batch_size; ++j) {
+                                if (labels[j].size() != auth_data[j].size()) {
+                                    return false;
+                                }
+                                num_labels = std::max(num_labels, labels[j].size());
+                                all_labels.insert(all_labels.end(), labels[j].begin(), labels[j].end());
+                                for (std::size_t k = 0; k < auth_data[j].size(); ++k) {
+                                    Lambdas.emplace_back(auth_data[j][k].Lambda);
+                                    sigs.emplace_back(auth_data[j][k].sigma);
+                                }
                             }
-
-                            typename pairing_policy::g1_precomp::value_type proof_g_C_g_precomp =
-                                pairing_policy::precompute_g1(proof.g_C.g);
-                            typename pairing_policy::g1_precomp::value_type proof_g_C_h_precomp =
-                                pairing_policy::precompute_g1(proof.g_C.h);
-                            typename pairing_policy::fqk_type::value_type kc_C_1 =
-                                pairing_policy::miller_loop(proof_g_C_g_precomp, pvk.vk_alphaC_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type kc_C_2 =
-                                pairing_policy::miller_loop(proof_g_C_h_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type kc_C =
-                                pairing_policy::final_exponentiation(kc_C_1 * kc_C_2.unitary_inversed());
-                            if (kc_C != pairing_policy::gt_type::one()) {
-                                result = false;
+                            if (num_labels > pvk.proof_g_vki_precomp.size()) {
+                                return false;
                             }
-
-                            typename CurveType::g1_type::value_type Aacc = pvk.A0 + proof.g_Aau.g + proof.g_A.g;
-
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aacc_precomp =
-                                pairing_policy::precompute_g1(Aacc);
-                            typename pairing_policy::g1_precomp::value_type proof_g_H_precomp =
-                                pairing_policy::precompute_g1(proof.g_H);
-                            typename pairing_policy::fqk_type::value_type QAP_1 =
-                                pairing_policy::miller_loop(proof_g_Aacc_precomp, proof_g_B_g_precomp);
-                            typename pairing_policy::fqk_type::value_type QAP_23 = pairing_policy::double_miller_loop(
-                                proof_g_H_precomp, pvk.vk_rC_Z_g2_precomp, proof_g_C_g_precomp, pvk.pp_G2_one_precomp);
-                            typename pairing_policy::gt_type QAP =
-                                pairing_policy::final_exponentiation(QAP_1 * QAP_23.unitary_inversed());
-                            if (QAP != pairing_policy::gt_type::one()) {
-                                result = false;
+                            if (!sigBatchVerif<CurveType>(pak.vkp, all_labels, Lambdas, sigs)) {
+                                return false;
                             }
 
-                            typename pairing_policy::g1_precomp::value_type proof_g_K_precomp =
-                                pairing_policy::precompute_g1(proof.g_K);
-                            typename pairing_policy::g1_precomp::value_type proof_g_Aacc_C_precomp =
-                                pairing_policy::precompute_g1(Aacc + proof.g_C.g);
-                            typename pairing_policy::fqk_type::value_type K_1 =
-                                pairing_policy::miller_loop(proof_g_K_precomp, pvk.vk_gamma_g2_precomp);
-                            typename pairing_policy::fqk_type::value_type K_23 =
-                                pairing_policy::double_miller_loop(proof_g_Aacc_C_precomp, pvk.vk_gamma_beta_g2_precomp,
-                                                                   pvk.vk_gamma_beta_g1_precomp, proof_g_B_g_precomp);
-                            typename pairing_policy::gt_type K =
-                                pairing_policy::final_exponentiation(K_1 * K_23.unitary_inversed());
-                            if (K != pairing_policy::gt_type::one()) {
-                                result = false;
+                            const std::vector<typename scalar_field_type::value_type> coefficients =
+                                online_check_coefficients<DistributionType, GeneratorType>(batch_size);
+
+                            /* \sum_j t_j Lambda_{j,k} per label position, by positions across the executor */
+                            std::vector<typename g2_type::value_type> combined_Lambdas(num_labels,
+                                                                                      g2_type::value_type::zero());
+                            executor::current().parallel_for(num_labels, [&](const std::size_t k) {
+                                for (std::size_t j = 0; j < batch_size; ++j) {
+                                    if (k < auth_data[j].size()) {
+                                        combined_Lambdas[k] =
+                                            combined_Lambdas[k] +
+                                            (j ? coefficients[(1 + online_num_checks) * j] * auth_data[j][k].Lambda :
+                                                 auth_data[j][k].Lambda);
+                                    }
+                                }
+                            });
+
+                            online_check_sums sums;
+                            std::vector<typename g1_type::value_type> B_sides;
+                            accumulate_online_checks(pvk, proofs, coefficients, sums, B_sides);
+
+                            typename g1_type::value_type minusI2_side = g1_type::value_type::zero();
+                            std::vector<typename g2_type::value_type> B_g;
+                            B_g.reserve(batch_size);
+                            for (std::size_t j = 0; j < batch_size; ++j) {
+                                const typename scalar_field_type::value_type &t =
+                                    coefficients[(1 + online_num_checks) * j];
+                                sums.one = sums.one - t * proofs[j].muA;
+                                minusI2_side = minusI2_side - t * proofs[j].g_Aau.g;
+                                B_g.emplace_back(proofs[j].g_B.g);
                             }
 
-                            return result;
+                            const typename pairing_policy::fqk_type::value_type product =
+                                online_fixed_miller_loops(pvk, sums) *
+                                pairing_policy::miller_loop(pairing_policy::precompute_g1(minusI2_side),
+                                                            pairing_policy::precompute_g2(pak.minusI2)) *
+                                multi_miller_loop<snark_pp<CurveType>>(pvk.proof_g_vki_precomp.begin(),
+                                                                       pvk.proof_g_vki_precomp.begin() + num_labels,
+                                                                       combined_Lambdas.begin()) *
+                                multi_miller_loop<snark_pp<CurveType>>(B_sides.begin(), B_sides.end(), B_g.begin());
+                            return pairing_policy::final_exponentiation(product) == pairing_policy::gt_type::one();
                         }
 
                         /**
@@ -0,0 +1,442 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a memory-mapped storage of the R1CS ppzkADSNARK proving key.
+//
+// The queries of the proving key are written once into a file with a fixed binary
+// layout: a header followed by 64-byte aligned sections holding the native
+// representation of the group elements. The knowledge commitment queries A, B and C
+// are stored as their index array followed by the arrays of their g and h halves.
+// The layout is tied to the in-memory representation of the group elements, hence to
+// the build that produced it.
+//
+// The generator writes the file block by block, see r1cs_ppzkadsnark_basic_policy::
+// generator, so a large key never needs to be held in memory whole. The prover works
+// on a proving key in memory, which load() copies out of the mapping. Opening a file
+// checks every section against the file size and every stored index against the
+// domain of its query before anything is read out of it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_PPZKADSNARK_MAPPED_PROVING_KEY_HPP
+#define CRYPTO3_R1CS_PPZKADSNARK_MAPPED_PROVING_KEY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/huge_pages.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType, typename ConstraintSystem>
+                class r1cs_ppzkadsnark_mapped_proving_key {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef typename g1_type::value_type g1_value_type;
+                    typedef typename g2_type::value_type g2_value_type;
+
+                    static constexpr const std::uint64_t magic = 0x4b504e5344414e5aULL;    // "ZNADSNPK"
+                    static constexpr const std::uint64_t version = 1;
+                    static constexpr const std::size_t alignment = 64;
+
+                    /* the stored entries of a knowledge commitment query */
+                    struct kc_section_type {
+                        std::uint64_t size;
+                        std::uint64_t domain_size;
+                        std::uint64_t indices_offset;
+                        std::uint64_t g_offset;
+                        std::uint64_t h_offset;
+                    };
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t g1_value_size;
+                        std::uint64_t g2_value_size;
+
+                        kc_section_type A_query;
+                        kc_section_type B_query;
+                        kc_section_type C_query;
+
+                        std::uint64_t H_query_size;
+                        std::uint64_t K_query_size;
+
+                        std::uint64_t rA_i_Z_g1_offset;
+                        std::uint64_t H_query_offset;
+                        std::uint64_t K_query_offset;
+                        std::uint64_t file_size;
+                    };
+
+                    static_assert(std::is_trivially_copyable<header_type>::value, "header must be trivially copyable");
+
+                    static std::uint64_t align(std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    /* the sections of a file whose queries have the sizes given in h, laid out by the writer */
+                    static header_type layout(const header_type &h) {
+                        header_type result = h;
+                        result.rA_i_Z_g1_offset = align(sizeof(header_type));
+                        std::uint64_t offset = result.rA_i_Z_g1_offset + sizeof(g1_value_type);
+                        offset = place(result.A_query, h.A_query.size, h.A_query.domain_size, sizeof(g1_value_type),
+                                       sizeof(g1_value_type), offset);
+                        offset = place(result.B_query, h.B_query.size, h.B_query.domain_size, sizeof(g2_value_type),
+                                       sizeof(g1_value_type), offset);
+                        offset = place(result.C_query, h.C_query.size, h.C_query.domain_size, sizeof(g1_value_type),
+                                       sizeof(g1_value_type), offset);
+                        result.H_query_offset = align(offset);
+                        result.K_query_offset = align(result.H_query_offset + h.H_query_size * sizeof(g1_value_type));
+                        result.file_size = align(result.K_query_offset + h.K_query_size * sizeof(g1_value_type));
+                        return result;
+                    }
+
+                    static bool same_section(const kc_section_type &a, const kc_section_type &b) {
+                        return a.indices_offset == b.indices_offset && a.g_offset == b.g_offset &&
+                               a.h_offset == b.h_offset;
+                    }
+
+                    /*
+                     * Whether the header describes a file of file_size bytes in the writer's layout.
+                     * Every query size is bounded by file_size first, so the layout cannot overflow.
+                     */
+                    static bool well_formed(const header_type &h, const std::uint64_t file_size) {
+                        for (const std::uint64_t size :
+                             {h.A_query.size, h.B_query.size, h.C_query.size, h.H_query_size, h.K_query_size}) {
+                            if (size > file_size) {
+                                return false;
+                            }
+                        }
+                        const header_type expected = layout(h);
+                        return expected.file_size == file_size && h.file_size == file_size &&
+                               h.rA_i_Z_g1_offset == expected.rA_i_Z_g1_offset &&
+                               same_section(h.A_query, expected.A_query) &&
+                               same_section(h.B_query, expected.B_query) &&
+                               same_section(h.C_query, expected.C_query) &&
+                               h.H_query_offset == expected.H_query_offset &&
+                               h.K_query_offset == expected.K_query_offset;
+                    }
+
+                    /* whether the stored indices of the query at s increase and lie in its domain */
+                    bool valid_indices(const kc_section_type &s) const {
+                        const std::uint64_t *indices = section<std::uint64_t>(s.indices_offset);
+                        for (std::size_t i = 0; i < s.size; ++i) {
+                            if (indices[i] >= s.domain_size || (i > 0 && indices[i] <= indices[i - 1])) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    /* lays out a query of size stored entries of g_size and h_size bytes from offset on */
+                    static std::uint64_t place(kc_section_type &section, const std::size_t size,
+                                               const std::size_t domain_size, const std::size_t g_size,
+                                               const std::size_t h_size, const std::uint64_t offset) {
+                        section.size = size;
+                        section.domain_size = domain_size;
+                        section.indices_offset = align(offset);
+                        section.g_offset = align(section.indices_offset + size * sizeof(std::uint64_t));
+                        section.h_offset = align(section.g_offset + size * g_size);
+                        return section.h_offset + size * h_size;
+                    }
+
+                    template<typename T>
+                    const T *section(std::uint64_t offset) const {
+                        return reinterpret_cast<const T *>(static_cast<const char *>(region.get_address()) + offset);
+                    }
+
+                    const header_type &header() const {
+                        return *section<header_type>(0);
+                    }
+
+                    template<typename T1, typename T2>
+                    knowledge_commitment_vector<T1, T2> kc_query(const kc_section_type &s) const {
+                        const std::uint64_t *indices = section<std::uint64_t>(s.indices_offset);
+                        const typename T1::value_type *g = section<typename T1::value_type>(s.g_offset);
+                        const typename T2::value_type *h = section<typename T2::value_type>(s.h_offset);
+
+                        knowledge_commitment_vector<T1, T2> result;
+                        result.domain_size_ = s.domain_size;
+                        result.indices.assign(indices, indices + s.size);
+                        result.values.reserve(s.size);
+                        for (std::size_t i = 0; i < s.size; ++i) {
+                            result.values.emplace_back(g[i], h[i]);
+                        }
+                        return result;
+                    }
+
+                    template<typename T>
+                    static void write_section(std::ofstream &out, std::uint64_t offset, const T *data,
+                                              std::size_t count) {
+                        out.seekp(offset);
+                        out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+                    }
+
+                    boost::interprocess::file_mapping mapping;
+                    boost::interprocess::mapped_region region;
+
+                public:
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+
+                    /**
+                     * The constraint system is not part of the mapped file, it is provided by the caller.
+                     */
+                    constraint_system_type constraint_system;
+
+                    r1cs_ppzkadsnark_mapped_proving_key() = default;
+                    r1cs_ppzkadsnark_mapped_proving_key(r1cs_ppzkadsnark_mapped_proving_key &&other) = default;
+                    r1cs_ppzkadsnark_mapped_proving_key &
+                        operator=(r1cs_ppzkadsnark_mapped_proving_key &&other) = default;
+
+                    /**
+                     * Maps the proving key file at path, previously produced by a writer.
+                     */
+                    r1cs_ppzkadsnark_mapped_proving_key(const std::string &path,
+                                                        constraint_system_type &&constraint_system) :
+                        mapping(path.c_str(), boost::interprocess::read_only),
+                        region(mapping, boost::interprocess::read_only),
+                        constraint_system(std::move(constraint_system)) {
+                        if (region.get_size() < sizeof(header_type)) {
+                            throw std::runtime_error("r1cs_ppzkadsnark_mapped_proving_key: incompatible file " + path);
+                        }
+                        const header_type &h = header();
+                        if (h.magic != magic || h.version != version || h.g1_value_size != sizeof(g1_value_type) ||
+                            h.g2_value_size != sizeof(g2_value_type) || !well_formed(h, region.get_size()) ||
+                            !valid_indices(h.A_query) || !valid_indices(h.B_query) || !valid_indices(h.C_query)) {
+                            throw std::runtime_error("r1cs_ppzkadsnark_mapped_proving_key: incompatible file " + path);
+                        }
+                    }
+
+                    /**
+                     * Incremental writer of a proving key file.
+                     *
+                     * The numbers of stored entries of the queries fix the layout, so they are given up
+                     * front; the sections can then be written piecewise and in any order.
+                     */
+                    class writer {
+                    public:
+                        writer(const std::string &path, const std::size_t A_query_size,
+                               const std::size_t A_query_domain_size, const std::size_t B_query_size,
+                               const std::size_t B_query_domain_size, const std::size_t C_query_size,
+                               const std::size_t C_query_domain_size, const std::size_t H_query_size,
+                               const std::size_t K_query_size) :
+                            out(path, std::ios::binary | std::ios::trunc) {
+                            static_assert(std::is_trivially_copyable<g1_value_type>::value &&
+                                              std::is_trivially_copyable<g2_value_type>::value,
+                                          "group elements must be trivially copyable to be memory-mapped");
+
+                            if (!out) {
+                                throw std::runtime_error("r1cs_ppzkadsnark_mapped_proving_key: cannot write " + path);
+                            }
+
+                            std::memset(&h, 0, sizeof(h));
+                            h.magic = magic;
+                            h.version = version;
+                            h.g1_value_size = sizeof(g1_value_type);
+                            h.g2_value_size = sizeof(g2_value_type);
+                            h.A_query.size = A_query_size;
+                            h.A_query.domain_size = A_query_domain_size;
+                            h.B_query.size = B_query_size;
+                            h.B_query.domain_size = B_query_domain_size;
+                            h.C_query.size = C_query_size;
+                            h.C_query.domain_size = C_query_domain_size;
+                            h.H_query_size = H_query_size;
+                            h.K_query_size = K_query_size;
+                            h = layout(h);
+
+                            write_section(out, 0, &h, 1);
+                            // pad the file up to its announced size
+                            out.seekp(h.file_size - 1);
+                            out.put(0);
+                        }
+
+                        void write_rA_i_Z_g1(const g1_value_type &rA_i_Z_g1) {
+                            write_section(out, h.rA_i_Z_g1_offset, &rA_i_Z_g1, 1);
+                        }
+
+                        /* Writes the stored entries [first, first + count) of A_query */
+                        void write_A_query(const std::size_t first, const std::uint64_t *indices,
+                                           const g1_value_type *g_values, const g1_value_type *h_values,
+                                           const std::size_t count) {
+                            write_kc_query(h.A_query, first, indices, g_values, h_values, count);
+                        }
+
+                        /* Writes the stored entries [first, first + count) of B_query */
+                        void write_B_query(const std::size_t first, const std::uint64_t *indices,
+                                           const g2_value_type *g_values, const g1_value_type *h_values,
+                                           const std::size_t count) {
+                            write_kc_query(h.B_query, first, indices, g_values, h_values, count);
+                        }
+
+                        /* Writes the stored entries [first, first + count) of C_query */
+                        void write_C_query(const std::size_t first, const std::uint64_t *indices,
+                                           const g1_value_type *g_values, const g1_value_type *h_values,
+                                           const std::size_t count) {
+                            write_kc_query(h.C_query, first, indices, g_values, h_values, count);
+                        }
+
+                        /* Writes H_query[first, first + count) */
+                        void write_H_query(const std::size_t first, const g1_value_type *values,
+                                           const std::size_t count) {
+                            check_range(first, count, h.H_query_size);
+                            write_section(out, h.H_query_offset + first * sizeof(g1_value_type), values, count);
+                        }
+
+                        /* Writes K_query[first, first + count) */
+                        void write_K_query(const std::size_t first, const g1_value_type *values,
+                                           const std::size_t count) {
+                            check_range(first, count, h.K_query_size);
+                            write_section(out, h.K_query_offset + first * sizeof(g1_value_type), values, count);
+                        }
+
+                        void close() {
+                            out.close();
+                            if (!out) {
+                                throw std::runtime_error("r1cs_ppzkadsnark_mapped_proving_key: write failed");
+                            }
+                        }
+
+                    private:
+                        /* entries [first, first + count) of a section of size entries, checked in release too */
+                        static void check_range(const std::size_t first, const std::size_t count,
+                                                const std::uint64_t size) {
+                            if (count > size || first > size - count) {
+                                throw std::out_of_range("r1cs_ppzkadsnark_mapped_proving_key: write out of range");
+                            }
+                        }
+
+                        template<typename GValueType, typename HValueType>
+                        void write_kc_query(const kc_section_type &s, const std::size_t first,
+                                            const std::uint64_t *indices, const GValueType *g_values,
+                                            const HValueType *h_values, const std::size_t count) {
+                            check_range(first, count, s.size);
+                            write_section(out, s.indices_offset + first * sizeof(std::uint64_t), indices, count);
+                            write_section(out, s.g_offset + first * sizeof(GValueType), g_values, count);
+                            write_section(out, s.h_offset + first * sizeof(HValueType), h_values, count);
+                        }
+
+                        std::ofstream out;
+                        header_type h;
+                    };
+
+                    /**
+                     * Writes the queries of proving_key to path in the layout expected by the mapping
+                     * constructor.
+                     */
+                    template<typename ProvingKeyType>
+                    static void write(const std::string &path, const ProvingKeyType &proving_key) {
+                        writer w(path, proving_key.A_query.size(), proving_key.A_query.domain_size(),
+                                 proving_key.B_query.size(), proving_key.B_query.domain_size(),
+                                 proving_key.C_query.size(), proving_key.C_query.domain_size(),
+                                 proving_key.H_query.size(), proving_key.K_query.size());
+
+                        w.write_rA_i_Z_g1(proving_key.rA_i_Z_g1);
+                        write_kc_query(proving_key.A_query, [&](auto... args) { w.write_A_query(0, args...); });
+                        write_kc_query(proving_key.B_query, [&](auto... args) { w.write_B_query(0, args...); });
+                        write_kc_query(proving_key.C_query, [&](auto... args) { w.write_C_query(0, args...); });
+                        w.write_H_query(0, proving_key.H_query.data(), proving_key.H_query.size());
+                        w.write_K_query(0, proving_key.K_query.data(), proving_key.K_query.size());
+                        w.close();
+                    }
+
+                    /**
+                     * The proving key copied out of the mapping, with the constraint system moved
+                     * into it.
+                     */
+                    template<typename ProvingKeyType>
+                    ProvingKeyType load() {
+                        std::vector<g1_value_type> H_query(H_query_begin(), H_query_end());
+                        std::vector<g1_value_type> K_query(K_query_begin(), K_query_end());
+                        g1_value_type rA_i_Z_g1 = this->rA_i_Z_g1();
+
+                        return ProvingKeyType(kc_query<g1_type, g1_type>(header().A_query),
+                                              kc_query<g2_type, g1_type>(header().B_query),
+                                              kc_query<g1_type, g1_type>(header().C_query), std::move(H_query),
+                                              std::move(K_query), std::move(rA_i_Z_g1), std::move(constraint_system));
+                    }
+
+                    const g1_value_type &rA_i_Z_g1() const {
+                        return *section<g1_value_type>(header().rA_i_Z_g1_offset);
+                    }
+
+                    const g1_value_type *H_query_begin() const {
+                        return section<g1_value_type>(header().H_query_offset);
+                    }
+
+                    const g1_value_type *H_query_end() const {
+                        return H_query_begin() + header().H_query_size;
+                    }
+
+                    const g1_value_type *K_query_begin() const {
+                        return section<g1_value_type>(header().K_query_offset);
+                    }
+
+                    const g1_value_type *K_query_end() const {
+                        return K_query_begin() + header().K_query_size;
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return region.get_size() * 8;
+                    }
+
+                    /**
+                     * Asks for transparent huge pages over the mapping. Returns whether the kernel
+                     * accepted the advice.
+                     */
+                    bool advise_huge_pages() const {
+                        return snark::advise_huge_pages(region.get_address(), region.get_size());
+                    }
+
+                private:
+                    /* splits query into the index, g and h arrays of its section for write */
+                    template<typename T1, typename T2, typename Write>
+                    static void write_kc_query(const knowledge_commitment_vector<T1, T2> &query, Write write) {
+                        std::vector<std::uint64_t> indices(query.indices.begin(), query.indices.end());
+                        std::vector<typename T1::value_type> g_values;
+                        std::vector<typename T2::value_type> h_values;
+                        g_values.reserve(query.size());
+                        h_values.reserve(query.size());
+                        for (const auto &value : query.values) {
+                            g_values.emplace_back(value.g);
+                            h_values.emplace_back(value.h);
+                        }
+                        write(indices.data(), g_values.data(), h_values.data(), indices.size());
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_PPZKADSNARK_MAPPED_PROVING_KEY_HPP
@@ -59,8 +59,11 @@ namespace nil {
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof proof_type;
+                    typedef typename policy_type::prover_workspace prover_workspace_type;
+                    typedef typename policy_type::mapped_proving_key_type mapped_proving_key_type;
 
                     using policy_type::generator;
+                    using policy_type::online_batch_verifier;
                     using policy_type::online_verifier;
                     using policy_type::prover;
                     using policy_type::verifier;
@@ -68,6 +71,7 @@ namespace nil {
                     using policy_type::auth_generator;
                     using policy_type::auth_sign;
                     using policy_type::auth_verify;
+                    using policy_type::auth_verify_batch;
                 };
 
             }    // namespace snark
@@ -69,11 +69,10 @@ namespace nil {
 
                         typedef typename CurveType::scalar_field_type field_type;
 
-                        const r1cs_variable_assignment<field_type> r1cs_va =
-                            reductions::bacs_to_r1cs<field_type>::witness_map(proving_key.circuit, primary_input, auxiliary_input);
-                        const r1cs_auxiliary_input<field_type> r1cs_ai(
-                            r1cs_va.begin() + primary_input.size(),
-                            r1cs_va.end());    // TODO: faster to just change bacs_to_r1cs<field_type>::witness_map into two :(
+                        /* the evaluator compiled into the proving key maps the circuit to the R1CS variables */
+                        const r1cs_auxiliary_input<field_type> r1cs_ai =
+                            reductions::bacs_to_r1cs<field_type>::auxiliary_witness_map(proving_key.evaluator,
+                                                                                        primary_input, auxiliary_input);
 
                         return prove<r1cs_ppzksnark<CurveType>>(
                             proving_key.r1cs_pk, primary_input, r1cs_ai);
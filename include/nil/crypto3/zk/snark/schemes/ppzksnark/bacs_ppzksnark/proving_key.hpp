@@ -27,12 +27,19 @@
 #define CRYPTO3_ZK_BACS_PPZKSNARK_PROVING_KEY_HPP
 
 #include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/bacs.hpp>
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/bacs_evaluator.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_ppzksnark.hpp>
 
 namespace nil {
     namespace crypto3 {
         namespace zk {
             namespace snark {
+                /**
+                 * A proving key for the BACS ppzkSNARK.
+                 *
+                 * Along with the circuit, the key holds an evaluator compiled for it once, whose level
+                 * schedule of the gates maps the circuit to the R1CS variables in every proof.
+                 */
                 template<typename CurveType, typename CircuitType>
                 struct bacs_ppzksnark_proving_key {
                     typedef CurveType curve_type;
@@ -41,6 +48,7 @@ namespace nil {
 
                     circuit_type circuit;
                     r1cs_proving_key_type r1cs_pk;
+                    bacs_circuit_evaluator<typename CurveType::scalar_field_type> evaluator;
 
                     bacs_ppzksnark_proving_key() {};
 
@@ -50,12 +58,12 @@ namespace nil {
 
                     bacs_ppzksnark_proving_key(const circuit_type &circuit, 
                                                const r1cs_proving_key_type &r1cs_pk) :
-                        circuit(circuit), r1cs_pk(r1cs_pk) {
+                        circuit(circuit), r1cs_pk(r1cs_pk), evaluator(this->circuit) {
                     }
 
                     bacs_ppzksnark_proving_key(circuit_type &&circuit, 
                                                r1cs_proving_key_type &&r1cs_pk) :
-                        circuit(std::move(circuit)), r1cs_pk(std::move(r1cs_pk)) {
+                        circuit(std::move(circuit)), r1cs_pk(std::move(r1cs_pk)), evaluator(this->circuit) {
                     }
 
                     bacs_ppzksnark_proving_key &operator=(const bacs_ppzksnark_proving_key &other) = default;
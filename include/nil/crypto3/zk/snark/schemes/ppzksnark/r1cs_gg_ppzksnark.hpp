@@ -27,14 +27,21 @@
 #ifndef CRYPTO3_R1CS_GG_PPZKSNARK_HPP
 #define CRYPTO3_R1CS_GG_PPZKSNARK_HPP
 
+#include <string>
 #include <type_traits>
+#include <utility>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/detail/basic_policy.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/modes.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/generator.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/delta_update.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/distributed_prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/incremental_prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/pipelined_prover.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verifier.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/warm_up.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/generator.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/verifier.hpp>
@@ -106,31 +113,168 @@ namespace nil {
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
+                    typedef typename policy_type::compact_proving_key_type compact_proving_key_type;
+                    typedef typename policy_type::bytecode_proving_key_type bytecode_proving_key_type;
+                    typedef typename policy_type::mapped_proving_key_type mapped_proving_key_type;
+                    typedef typename policy_type::affine_proving_key_type affine_proving_key_type;
+                    typedef typename policy_type::sparse_proving_key_type sparse_proving_key_type;
+                    typedef typename policy_type::lagrange_proving_key_type lagrange_proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
                     typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
+                    typedef typename policy_type::proof_batch_type proof_batch_type;
 
                     static inline keypair_type generate(const constraint_system_type &constraint_system) {
                         return Generator::process(constraint_system);
                     }
 
+                    static inline keypair_type generate(constraint_system_type &&constraint_system) {
+                        return Generator::process(std::move(constraint_system));
+                    }
+
+                    static inline std::pair<mapped_proving_key_type, verification_key_type>
+                        generate(const constraint_system_type &constraint_system, const std::string &path) {
+                        return Generator::process(constraint_system, path);
+                    }
+
+                    static inline std::pair<mapped_proving_key_type, verification_key_type>
+                        generate(const constraint_system_type &constraint_system, const std::string &path,
+                                 const std::string &checkpoint_path) {
+                        return Generator::process(constraint_system, path, checkpoint_path);
+                    }
+
+                    static inline r1cs_gg_ppzksnark_keypair<sparse_proving_key_type, verification_key_type>
+                        generate_sparse(const constraint_system_type &constraint_system) {
+                        return Generator::process_sparse(constraint_system);
+                    }
+
+                    static inline r1cs_gg_ppzksnark_keypair<lagrange_proving_key_type, verification_key_type>
+                        generate_lagrange(const constraint_system_type &constraint_system) {
+                        return Generator::process_lagrange(constraint_system);
+                    }
+
                     static inline proof_type prove(const proving_key_type &pk,
-                                                   const primary_input_type &primary_input,
-                                                   const auxiliary_input_type &auxiliary_input) {
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
 
                         return Prover::process(pk, primary_input, auxiliary_input);
                     }
 
+                    static inline proof_type prove(const processed_proving_key_type &ppk,
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
+
+                        return Prover::process(ppk, primary_input, auxiliary_input);
+                    }
+
+                    static inline proof_type prove(const compact_proving_key_type &cpk,
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
+
+                        return Prover::process(cpk, primary_input, auxiliary_input);
+                    }
+
+                    static inline proof_type prove(const bytecode_proving_key_type &bpk,
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
+
+                        return Prover::process(bpk, primary_input, auxiliary_input);
+                    }
+
+                    static inline proof_type prove(const mapped_proving_key_type &mpk,
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
+
+                        return Prover::process(mpk, primary_input, auxiliary_input);
+                    }
+
+                    static inline proof_type prove(const affine_proving_key_type &apk,
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
+
+                        return Prover::process(apk, primary_input, auxiliary_input);
+                    }
+
+                    static inline proof_type prove(const sparse_proving_key_type &spk,
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
+
+                        return Prover::process(spk, primary_input, auxiliary_input);
+                    }
+
+                    static inline proof_type prove(const lagrange_proving_key_type &lpk,
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
+
+                        return Prover::process(lpk, primary_input, auxiliary_input);
+                    }
+
+                    /**
+                     * Proves the witness of a witness source, e.g. an r1cs_mapped_witness still being
+                     * written by another process, see r1cs_gg_ppzksnark_prover::process_streamed.
+                     */
+                    template<typename WitnessSource>
+                    static inline proof_type prove_streamed(const proving_key_type &pk, const WitnessSource &witness) {
+                        return Prover::process_streamed(pk, witness);
+                    }
+
+                    template<typename MultiexpBackend>
+                    static inline proof_type
+                        prove(const r1cs_gg_ppzksnark_resident_proving_key<CurveType, MultiexpBackend> &rpk,
+                              const primary_input_span_type &primary_input,
+                              const auxiliary_input_span_type &auxiliary_input) {
+                        return Prover::process(rpk, primary_input, auxiliary_input);
+                    }
+
+                    template<typename ProvingKey, typename InputWitnessIterator>
+                    static inline std::vector<proof_type> prove_batch(const ProvingKey &pk,
+                                                                      InputWitnessIterator witnesses_first,
+                                                                      InputWitnessIterator witnesses_last) {
+
+                        return Prover::process_batch(pk, witnesses_first, witnesses_last);
+                    }
+
                     template<typename VerificationKey>
                     static inline bool verify(const VerificationKey &vk,
-                                              const primary_input_type &primary_input,
+                                              const primary_input_span_type &primary_input,
                                               const proof_type &proof) {
                         return Verifier::process(vk, primary_input, proof);
                     }
+
+                    template<typename Hash>
+                    static inline bool
+                        verify(const r1cs_gg_ppzksnark_verification_key_registry<CurveType, Hash> &registry,
+                               const typename r1cs_gg_ppzksnark_verification_key_registry<CurveType,
+                                                                                          Hash>::digest_type &digest,
+                               const primary_input_span_type &primary_input,
+                               const proof_type &proof) {
+                        return Verifier::process(registry, digest, primary_input, proof);
+                    }
+
+                    template<typename VerificationKey, typename InputPrimaryInputIterator, typename InputProofIterator>
+                    static inline bool verify_batch(const VerificationKey &vk,
+                                                    InputPrimaryInputIterator primary_inputs_first,
+                                                    InputPrimaryInputIterator primary_inputs_last,
+                                                    InputProofIterator proofs_first,
+                                                    InputProofIterator proofs_last) {
+                        return Verifier::process_batch(vk, primary_inputs_first, primary_inputs_last, proofs_first,
+                                                       proofs_last);
+                    }
+
+                    template<typename VerificationKey, typename InputPrimaryInputIterator>
+                    static inline bool verify_batch(const VerificationKey &vk,
+                                                    InputPrimaryInputIterator primary_inputs_first,
+                                                    InputPrimaryInputIterator primary_inputs_last,
+                                                    const proof_batch_type &proofs) {
+                        return Verifier::process_batch(vk, primary_inputs_first, primary_inputs_last, proofs);
+                    }
                 };
 
                 template<typename CurveType, typename Generator, typename Prover, typename Verifier>
@@ -143,6 +287,8 @@ namespace nil {
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
@@ -150,12 +296,22 @@ namespace nil {
                     typedef typename policy_type::srs_type srs_type;
                     typedef typename policy_type::proving_srs_type proving_srs_type;
                     typedef typename policy_type::verification_srs_type verification_srs_type;
+                    typedef typename policy_type::prepared_proving_srs_type prepared_proving_srs_type;
+                    typedef typename policy_type::prepared_verification_srs_type prepared_verification_srs_type;
+                    typedef typename policy_type::processed_aggregate_verification_key_type
+                        processed_aggregate_verification_key_type;
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::srs_pair_type srs_pair_type;
 
                     typedef typename policy_type::proof_type proof_type;
+                    typedef typename policy_type::proof_batch_type proof_batch_type;
                     typedef typename policy_type::aggregate_proof_type aggregate_proof_type;
+                    typedef typename policy_type::compressed_aggregate_proof_type compressed_aggregate_proof_type;
+
+                    // Incremental aggregate prover
+                    template<typename Hash>
+                    using aggregator_type = typename Prover::template aggregator_type<Hash>;
 
                     // Generate key pair
                     template<typename DistributionType = boost::random::uniform_int_distribution<
@@ -175,8 +331,8 @@ namespace nil {
 
                     // Basic proove
                     static inline proof_type prove(const proving_key_type &pk,
-                                                   const primary_input_type &primary_input,
-                                                   const auxiliary_input_type &auxiliary_input) {
+                                                   const primary_input_span_type &primary_input,
+                                                   const auxiliary_input_span_type &auxiliary_input) {
 
                         return Prover::process(pk, primary_input, auxiliary_input);
                     }
@@ -193,10 +349,41 @@ namespace nil {
                                                               proofs_first, proofs_last);
                     }
 
+                    template<typename Hash, typename InputTranscriptIncludeIterator, typename InputProofIterator>
+                    static inline aggregate_proof_type prove(const prepared_proving_srs_type &srs,
+                                                             InputTranscriptIncludeIterator transcript_include_first,
+                                                             InputTranscriptIncludeIterator transcript_include_last,
+                                                             InputProofIterator proofs_first,
+                                                             InputProofIterator proofs_last) {
+
+                        return Prover::template process<Hash>(srs, transcript_include_first, transcript_include_last,
+                                                              proofs_first, proofs_last);
+                    }
+
+                    template<typename Hash, typename InputTranscriptIncludeIterator>
+                    static inline aggregate_proof_type prove(const proving_srs_type &srs,
+                                                             InputTranscriptIncludeIterator transcript_include_first,
+                                                             InputTranscriptIncludeIterator transcript_include_last,
+                                                             const proof_batch_type &proofs) {
+
+                        return Prover::template process<Hash>(srs, transcript_include_first, transcript_include_last,
+                                                              proofs);
+                    }
+
+                    template<typename Hash, typename InputTranscriptIncludeIterator>
+                    static inline aggregate_proof_type prove(const prepared_proving_srs_type &srs,
+                                                             InputTranscriptIncludeIterator transcript_include_first,
+                                                             InputTranscriptIncludeIterator transcript_include_last,
+                                                             const proof_batch_type &proofs) {
+
+                        return Prover::template process<Hash>(srs, transcript_include_first, transcript_include_last,
+                                                              proofs);
+                    }
+
                     // Basic verify
                     template<typename VerificationKey>
                     static inline bool verify(const VerificationKey &vk,
-                                              const primary_input_type &primary_input,
+                                              const primary_input_span_type &primary_input,
                                               const proof_type &proof) {
                         return Verifier::process(vk, primary_input, proof);
                     }
@@ -216,6 +403,62 @@ namespace nil {
                             ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first,
                             transcript_include_last);
                     }
+
+                    template<typename DistributionType = boost::random::uniform_int_distribution<
+                                 typename CurveType::scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                             typename InputPrimaryInputRange, typename InputIterator>
+                    static inline bool verify(const prepared_verification_srs_type &ip_verifier_srs,
+                                              const verification_key_type &pvk,
+                                              const InputPrimaryInputRange &public_inputs,
+                                              const aggregate_proof_type &proof,
+                                              InputIterator transcript_include_first,
+                                              InputIterator transcript_include_last) {
+                        return Verifier::template process<DistributionType, GeneratorType, Hash>(
+                            ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first,
+                            transcript_include_last);
+                    }
+
+                    template<typename DistributionType = boost::random::uniform_int_distribution<
+                                 typename CurveType::scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                             typename VerificationSrs, typename InputPrimaryInputRange, typename InputIterator>
+                    static inline bool verify(const VerificationSrs &ip_verifier_srs,
+                                              const verification_key_type &pvk,
+                                              const InputPrimaryInputRange &public_inputs,
+                                              const compressed_aggregate_proof_type &proof,
+                                              InputIterator transcript_include_first,
+                                              InputIterator transcript_include_last) {
+                        return Verifier::template process<DistributionType, GeneratorType, Hash>(
+                            ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first,
+                            transcript_include_last);
+                    }
+
+                    template<typename DistributionType = boost::random::uniform_int_distribution<
+                                 typename CurveType::scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                             typename InputPrimaryInputRange, typename InputIterator>
+                    static inline bool verify(const processed_aggregate_verification_key_type &processed_vk,
+                                              const InputPrimaryInputRange &public_inputs,
+                                              const aggregate_proof_type &proof,
+                                              InputIterator transcript_include_first,
+                                              InputIterator transcript_include_last) {
+                        return Verifier::template process<DistributionType, GeneratorType, Hash>(
+                            processed_vk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                    }
+
+                    template<typename DistributionType = boost::random::uniform_int_distribution<
+                                 typename CurveType::scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                             typename InputPrimaryInputRange, typename InputIterator>
+                    static inline bool verify(const processed_aggregate_verification_key_type &processed_vk,
+                                              const InputPrimaryInputRange &public_inputs,
+                                              const compressed_aggregate_proof_type &proof,
+                                              InputIterator transcript_include_first,
+                                              InputIterator transcript_include_last) {
+                        return Verifier::template process<DistributionType, GeneratorType, Hash>(
+                            processed_vk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
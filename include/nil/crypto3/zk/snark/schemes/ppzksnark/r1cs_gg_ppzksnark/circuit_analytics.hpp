@@ -0,0 +1,407 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Density and cost analytics of circuits for the R1CS GG-ppzkSNARK.
+//
+// The analytics of a constraint system project what its keys and proofs will cost before the
+// keys are generated: the density of each query, that is the share of the terms whose bases
+// are not zero, the padding of the evaluation domain, the memory of the proving key and of
+// the witness map, and the group additions of the multi-exponentiations of a proof under
+// the cost model of the bucket method, together with the window minimizing it. The analytics
+// of a proving key report the same from the queries it holds. Both are computed concurrently
+// on the current executor.
+//
+// The scalar sizes of a witness complete the picture: the share of zero, unit and small
+// scalars, which the multi-exponentiation dispatcher skips, adds directly or evaluates over
+// fewer windows, see multiexp_dispatch.hpp and scalar_size_multiexp.hpp. A caller picks the
+// backend and the multiexp_tuning of a circuit from them:
+//
+//     const auto analytics = r1cs_gg_ppzksnark_circuit_analytics<curve_type>::of(constraint_system);
+//     const auto sizes = r1cs_scalar_size_histogram::of(auxiliary_input.begin(), auxiliary_input.end());
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_CIRCUIT_ANALYTICS_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_CIRCUIT_ANALYTICS_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/math/make_evaluation_domain.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/scalar_size_multiexp.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proving_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Number of terms of a query and of those with a non-zero base.
+                 */
+                struct r1cs_query_density {
+                    std::size_t size = 0;
+                    std::size_t non_zero = 0;
+
+                    double density() const {
+                        return size ? double(non_zero) / size : 0;
+                    }
+                };
+
+                /**
+                 * Projected cost of a bucket multi-exponentiation: the window minimizing it, and the group
+                 * additions and doublings taken with that window.
+                 */
+                struct multiexp_cost_estimate {
+                    std::size_t window = 0;
+                    std::size_t additions = 0;
+                    std::size_t doublings = 0;
+
+                    /**
+                     * Cost of num_terms terms of scalars of bits bits: every window adds each term to its
+                     * bucket and sums its 2^window buckets with twice as many additions.
+                     */
+                    static multiexp_cost_estimate of(const std::size_t num_terms, const std::size_t bits) {
+                        multiexp_cost_estimate result;
+                        if (!num_terms || !bits) {
+                            return result;
+                        }
+                        for (std::size_t window = 1; window <= 20; ++window) {
+                            const std::size_t num_windows = (bits + window - 1) / window;
+                            const std::size_t additions = num_windows * (num_terms + (std::size_t(2) << window));
+                            if (window == 1 || additions < result.additions) {
+                                result.window = window;
+                                result.additions = additions;
+                                result.doublings = bits;
+                            }
+                        }
+                        return result;
+                    }
+                };
+
+                /**
+                 * Number of scalars of a witness in each size class: zero, one, the classes of
+                 * scalar_size_partition, and the wider ones.
+                 */
+                struct r1cs_scalar_size_histogram {
+                    std::size_t zero = 0;
+                    std::size_t one = 0;
+                    std::array<std::size_t, scalar_size_partition::num_classes> small {};
+                    std::size_t wide = 0;
+
+                    std::size_t size() const {
+                        return zero + one + wide + std::accumulate(small.begin(), small.end(), std::size_t(0));
+                    }
+
+                    template<typename InputFieldIterator>
+                    static r1cs_scalar_size_histogram of(InputFieldIterator scalars_first,
+                                                         InputFieldIterator scalars_last) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+                        typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
+
+                        const std::size_t n = std::distance(scalars_first, scalars_last);
+                        const std::size_t num_blocks = std::max<std::size_t>(1, executor::current().concurrency());
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+
+                        std::vector<r1cs_scalar_size_histogram> blocks(num_blocks);
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            r1cs_scalar_size_histogram &histogram = blocks[block];
+                            const std::size_t end = std::min(n, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                const field_value_type &scalar = *(scalars_first + i);
+                                if (scalar.is_zero()) {
+                                    ++histogram.zero;
+                                } else if (scalar == field_value_type::one()) {
+                                    ++histogram.one;
+                                } else {
+                                    const std::size_t c = scalar_size_partition::class_of(
+                                        multiprecision::msb(integral_type(scalar.data)) + 1);
+                                    ++(c < scalar_size_partition::num_classes ? histogram.small[c] : histogram.wide);
+                                }
+                            }
+                        });
+
+                        r1cs_scalar_size_histogram result;
+                        for (const r1cs_scalar_size_histogram &histogram : blocks) {
+                            result.zero += histogram.zero;
+                            result.one += histogram.one;
+                            result.wide += histogram.wide;
+                            for (std::size_t c = 0; c < scalar_size_partition::num_classes; ++c) {
+                                result.small[c] += histogram.small[c];
+                            }
+                        }
+                        return result;
+                    }
+                };
+
+                /**
+                 * Densities, padding, memory and multi-exponentiation costs of a circuit, projected from
+                 * its constraint system or read from its proving key.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_circuit_analytics {
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef r1cs_constraint_system<scalar_field_type> constraint_system_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType> proving_key_type;
+
+                    std::size_t num_constraints = 0;
+                    std::size_t num_inputs = 0;
+                    std::size_t num_variables = 0;
+
+                    /* The queries of the proving key; the G1 and G2 halves of B_query have the same density. */
+                    r1cs_query_density A_query, B_query, H_query, L_query;
+
+                    /* Whether exchanging the A and B sides would make B_query sparser. */
+                    bool AB_swap_beneficial = false;
+
+                    /* Size of the evaluation domain, and the points of it no constraint fills. */
+                    std::size_t domain_size = 0;
+                    std::size_t domain_padding = 0;
+
+                    std::size_t proving_key_bytes = 0;
+                    std::size_t witness_map_bytes = 0;
+
+                    multiexp_cost_estimate A_cost, B_g1_cost, B_g2_cost, H_cost, L_cost;
+
+                    double padding_waste() const {
+                        return domain_size ? double(domain_padding) / domain_size : 0;
+                    }
+
+                    /* Projected G1 additions of the multi-exponentiations of a proof. */
+                    std::size_t g1_additions() const {
+                        return A_cost.additions + B_g1_cost.additions + H_cost.additions + L_cost.additions;
+                    }
+
+                    /* Projected G2 additions of the multi-exponentiations of a proof. */
+                    std::size_t g2_additions() const {
+                        return B_g2_cost.additions;
+                    }
+
+                    /**
+                     * Projects the analytics of the keys which the generator will make for constraint_system,
+                     * with its A and B sides exchanged if that is beneficial, as the generator does.
+                     */
+                    static r1cs_gg_ppzksnark_circuit_analytics of(const constraint_system_type &constraint_system) {
+                        r1cs_gg_ppzksnark_circuit_analytics result;
+                        result.num_constraints = constraint_system.num_constraints();
+                        result.num_inputs = constraint_system.num_inputs();
+                        result.num_variables = constraint_system.num_variables();
+
+                        const column_counts counts = count_columns(constraint_system);
+                        std::size_t non_zero_A = counts.non_zero_A, non_zero_B = counts.touched_by_B;
+
+                        /* as r1cs_constraint_system::is_AB_swap_beneficial, over the constraints only */
+                        result.AB_swap_beneficial = counts.touched_by_B > counts.touched_by_A;
+                        if (result.AB_swap_beneficial) {
+                            non_zero_A = counts.swapped_non_zero_A;
+                            non_zero_B = counts.touched_by_A;
+                        }
+
+                        result.domain_size =
+                            fft::make_evaluation_domain<scalar_field_type>(result.num_constraints +
+                                                                           result.num_inputs + 1)
+                                ->m;
+                        result.domain_padding = result.domain_size - (result.num_constraints + result.num_inputs + 1);
+
+                        result.A_query = {result.num_variables + 1, non_zero_A};
+                        result.B_query = {result.num_variables + 1, non_zero_B};
+                        result.H_query = {result.domain_size - 1, result.domain_size - 1};
+                        result.L_query = {result.num_variables - result.num_inputs,
+                                          result.num_variables - result.num_inputs};
+                        result.estimate();
+                        return result;
+                    }
+
+                    /**
+                     * Reads the analytics of the queries held by proving_key. The generator has already
+                     * exchanged the A and B sides of the constraint system it stores when that paid, so
+                     * AB_swap_beneficial reports whether that stored layout would still gain from a swap.
+                     */
+                    static r1cs_gg_ppzksnark_circuit_analytics of(const proving_key_type &proving_key) {
+                        r1cs_gg_ppzksnark_circuit_analytics result;
+                        const constraint_system_type &constraint_system = proving_key.constraint_system;
+                        result.num_constraints = constraint_system.num_constraints();
+                        result.num_inputs = constraint_system.num_inputs();
+                        result.num_variables = constraint_system.num_variables();
+                        const column_counts counts = count_columns(constraint_system);
+                        result.AB_swap_beneficial = counts.touched_by_B > counts.touched_by_A;
+
+                        result.domain_size = proving_key.H_query.size() + 1;
+                        result.domain_padding =
+                            result.domain_size - std::min(result.domain_size,
+                                                          result.num_constraints + result.num_inputs + 1);
+
+                        const std::size_t num_blocks = std::max<std::size_t>(1, executor::current().concurrency());
+                        const std::size_t n = proving_key.A_query.size();
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                        std::vector<std::size_t> counts(num_blocks, 0);
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t end = std::min(n, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                counts[block] += proving_key.A_query[i].is_zero() ? 0 : 1;
+                            }
+                        });
+
+                        result.A_query = {n, std::accumulate(counts.begin(), counts.end(), std::size_t(0))};
+                        result.B_query = {proving_key.B_query.domain_size(), proving_key.B_query.size()};
+                        result.H_query = {proving_key.H_query.size(), proving_key.H_query.size()};
+                        result.L_query = {proving_key.L_query.size(), proving_key.L_query.size()};
+                        result.estimate();
+                        return result;
+                    }
+
+                private:
+                    /* Numbers of columns of a constraint system by the sides of the constraints touching them. */
+                    struct column_counts {
+                        std::size_t touched_by_A = 0;
+                        std::size_t touched_by_B = 0;
+                        /* the columns of the A query: those touched by A, and the inputs */
+                        std::size_t non_zero_A = 0;
+                        /* the same once A and B are exchanged */
+                        std::size_t swapped_non_zero_A = 0;
+                    };
+
+                    /**
+                     * Counts the columns touched by the A and B sides of constraint_system, as
+                     * r1cs_constraint_system::is_AB_swap_beneficial does. Every block of constraints lists its
+                     * touched columns as sorted pairs of a column and its sides, so the memory is that of the
+                     * terms rather than a column vector per block, and the lists are merged by column ranges.
+                     */
+                    static column_counts count_columns(const constraint_system_type &constraint_system) {
+                        typedef std::pair<std::size_t, std::uint8_t> touched_column;
+
+                        const std::size_t num_constraints = constraint_system.num_constraints();
+                        const std::size_t num_inputs = constraint_system.num_inputs();
+                        const std::size_t num_columns = constraint_system.num_variables() + 1;
+                        const std::size_t num_blocks = std::max<std::size_t>(1, executor::current().concurrency());
+
+                        /* sorts touched by column and merges the sides of each column into its first entry */
+                        const auto combine = [](std::vector<touched_column> &touched) {
+                            std::sort(touched.begin(), touched.end());
+                            std::size_t n = 0;
+                            for (std::size_t i = 0; i < touched.size(); ++i) {
+                                if (n && touched[n - 1].first == touched[i].first) {
+                                    touched[n - 1].second |= touched[i].second;
+                                } else {
+                                    touched[n++] = touched[i];
+                                }
+                            }
+                            touched.resize(n);
+                        };
+
+                        const std::size_t block_size = (num_constraints + num_blocks - 1) / num_blocks;
+                        std::vector<std::vector<touched_column>> touched(num_blocks);
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t end = std::min(num_constraints, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                const r1cs_constraint<scalar_field_type> &constraint = constraint_system.constraints[i];
+                                for (const linear_term<scalar_field_type> &term : constraint.a.terms) {
+                                    touched[block].emplace_back(term.index, 1);
+                                }
+                                for (const linear_term<scalar_field_type> &term : constraint.b.terms) {
+                                    touched[block].emplace_back(term.index, 2);
+                                }
+                            }
+                            combine(touched[block]);
+                        });
+
+                        std::vector<column_counts> counts(num_blocks);
+                        const std::size_t column_block_size = (num_columns + num_blocks - 1) / num_blocks;
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t first = std::min(num_columns, block * column_block_size);
+                            const std::size_t last = std::min(num_columns, (block + 1) * column_block_size);
+                            const auto by_column = [](const touched_column &entry, const std::size_t column) {
+                                return entry.first < column;
+                            };
+                            std::vector<touched_column> columns;
+                            for (const std::vector<touched_column> &block_touched : touched) {
+                                columns.insert(
+                                    columns.end(),
+                                    std::lower_bound(block_touched.begin(), block_touched.end(), first, by_column),
+                                    std::lower_bound(block_touched.begin(), block_touched.end(), last, by_column));
+                            }
+                            combine(columns);
+
+                            column_counts &count = counts[block];
+                            /* the input consistency constraints put every input in A */
+                            const std::size_t inputs_in_block =
+                                std::min(last, num_inputs + 1) - std::min(first, num_inputs + 1);
+                            count.non_zero_A = count.swapped_non_zero_A = inputs_in_block;
+                            for (const touched_column &column : columns) {
+                                const bool input = column.first <= num_inputs;
+                                count.touched_by_A += (column.second & 1) ? 1 : 0;
+                                count.touched_by_B += (column.second & 2) ? 1 : 0;
+                                count.non_zero_A += !input && (column.second & 1) ? 1 : 0;
+                                count.swapped_non_zero_A += !input && (column.second & 2) ? 1 : 0;
+                            }
+                        });
+
+                        column_counts result;
+                        for (const column_counts &count : counts) {
+                            result.touched_by_A += count.touched_by_A;
+                            result.touched_by_B += count.touched_by_B;
+                            result.non_zero_A += count.non_zero_A;
+                            result.swapped_non_zero_A += count.swapped_non_zero_A;
+                        }
+                        return result;
+                    }
+
+                    void estimate() {
+                        typedef typename g1_type::value_type g1_value_type;
+                        typedef typename g2_type::value_type g2_value_type;
+                        typedef typename scalar_field_type::value_type field_value_type;
+
+                        const std::size_t bits = scalar_field_type::modulus_bits;
+                        A_cost = multiexp_cost_estimate::of(A_query.non_zero, bits);
+                        B_g1_cost = multiexp_cost_estimate::of(B_query.non_zero, bits);
+                        B_g2_cost = multiexp_cost_estimate::of(B_query.non_zero, bits);
+                        H_cost = multiexp_cost_estimate::of(H_query.non_zero, bits);
+                        L_cost = multiexp_cost_estimate::of(L_query.non_zero, bits);
+
+                        proving_key_bytes = (A_query.size + B_query.non_zero + H_query.size + L_query.size) *
+                                                sizeof(g1_value_type) +
+                                            B_query.non_zero * sizeof(g2_value_type);
+                        /* the A, B and C evaluations of the witness map, over the whole domain */
+                        witness_map_bytes = 3 * domain_size * sizeof(field_value_type);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_CIRCUIT_ANALYTICS_HPP
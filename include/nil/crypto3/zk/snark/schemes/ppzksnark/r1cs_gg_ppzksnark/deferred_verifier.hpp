@@ -0,0 +1,171 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the deferred-settlement verifier of the R1CS GG-ppzkSNARK.
+//
+// Proofs and aggregates of proofs are not verified when they are added: their
+// pairing checks are recorded in a deferred_pairing_check and all settled together
+// at an explicit settle() checkpoint, with a single multi Miller loop and a single
+// final exponentiation for the whole set. A Groth16 proof records one check of four
+// pairs, the G2 element of its proof being precomputed when it is added; an IPP2
+// aggregate records its KZG, TIPP and MIPP checks and its Groth16 equation, all
+// randomized. A failed settlement lists the positions of the invalid additions.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_DEFERRED_VERIFIER_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_DEFERRED_VERIFIER_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <nil/crypto3/hash/sha2.hpp>
+
+#include <nil/crypto3/zk/snark/deferred_pairing_check.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verifier.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/verifier.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = random_device_generator, typename Hash = hashes::sha2<256>>
+                class r1cs_gg_ppzksnark_deferred_verifier {
+                    typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
+
+                    typedef typename CurveType::pairing pairing_policy;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename pairing_policy::g2_precomp g2_precomp;
+
+                public:
+                    typedef typename policy_type::primary_input_type primary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
+                    typedef typename policy_type::proof_type proof_type;
+
+                    typedef r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType>
+                        processed_aggregate_verification_key_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_proof<CurveType> aggregate_proof_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> compressed_aggregate_proof_type;
+
+                    typedef deferred_pairing_check<CurveType, DistributionType, GeneratorType> deferred_check_type;
+                    typedef typename deferred_check_type::pairing_check_type pairing_check_type;
+
+                    /**
+                     * Records the check e(A, B) = e(alpha, beta) e(acc, gamma) e(C, delta) of proof, with
+                     * strong input consistency, and returns its position.
+                     */
+                    std::size_t add(const processed_verification_key_type &processed_verification_key,
+                                    const primary_input_span_type &primary_input,
+                                    const proof_type &proof) {
+                        return deferred.add([&](pairing_check_type &pc) {
+                            if (processed_verification_key.gamma_ABC_g1.domain_size() != primary_input.size()) {
+                                pc.invalidate();
+                                return;
+                            }
+
+                            const typename g1_type::value_type accumulated_input =
+                                r1cs_gg_ppzksnark_process_verification_key<CurveType>::accumulate_primary_input(
+                                    processed_verification_key, primary_input);
+                            const std::vector<typename g1_type::value_type> a_input {proof.g_A, -accumulated_input,
+                                                                                      -proof.g_C};
+                            const std::vector<g2_precomp> b_input {pairing_policy::precompute_g2(proof.g_B),
+                                                                   processed_verification_key.vk_gamma_g2_precomp,
+                                                                   processed_verification_key.vk_delta_g2_precomp};
+                            pc.merge_random(a_input.begin(), a_input.end(), b_input.begin(), b_input.end(),
+                                            processed_verification_key.vk_alpha_g1_beta_g2);
+                        });
+                    }
+
+                    /**
+                     * Records the checks of an aggregate of proofs, see verify_aggregate_proof, and
+                     * returns its position.
+                     */
+                    template<typename InputRangesRange, typename InputIterator>
+                    std::size_t add(const processed_aggregate_verification_key_type &processed_vk,
+                                    const InputRangesRange &public_inputs,
+                                    const aggregate_proof_type &proof,
+                                    InputIterator transcript_include_first,
+                                    InputIterator transcript_include_last) {
+                        return deferred.add([&](pairing_check_type &pc) {
+                            // the coefficients are drawn at settlement: the transcript seed is not needed
+                            merge_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                                processed_vk, public_inputs, proof, transcript_include_first,
+                                transcript_include_last, pc, true);
+                        });
+                    }
+
+                    template<typename InputRangesRange, typename InputIterator>
+                    std::size_t add(const processed_aggregate_verification_key_type &processed_vk,
+                                    const InputRangesRange &public_inputs,
+                                    const compressed_aggregate_proof_type &proof,
+                                    InputIterator transcript_include_first,
+                                    InputIterator transcript_include_last) {
+                        if (!proof.has_correct_len()) {
+                            return deferred.add([](pairing_check_type &pc) { pc.invalidate(); });
+                        }
+                        const std::pair<bool, aggregate_proof_type> decompressed = proof.decompress();
+                        if (!decompressed.first) {
+                            return deferred.add([](pairing_check_type &pc) { pc.invalidate(); });
+                        }
+                        return add(processed_vk, public_inputs, decompressed.second, transcript_include_first,
+                                   transcript_include_last);
+                    }
+
+                    /**
+                     * Settles everything added since the last settlement, see deferred_pairing_check.
+                     */
+                    bool settle() {
+                        return deferred.settle();
+                    }
+
+                    /* the positions of the invalid additions of the last settlement */
+                    const std::vector<std::size_t> &failed() const {
+                        return deferred.failed();
+                    }
+
+                    /* the number of additions waiting for the next settlement */
+                    std::size_t size() const {
+                        return deferred.size();
+                    }
+
+                    void clear() {
+                        deferred.clear();
+                    }
+
+                private:
+                    deferred_check_type deferred;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_DEFERRED_VERIFIER_HPP
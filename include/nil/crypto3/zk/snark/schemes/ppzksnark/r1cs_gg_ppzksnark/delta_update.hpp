@@ -0,0 +1,217 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the delta update of R1CS GG-ppzkSNARK keys, applying a phase-2 contribution.
+//
+// A phase-2 contribution replaces delta by delta' = x * delta. Only delta_g1 and delta_g2,
+// which are multiplied by x, and H_query and L_query, whose elements all carry the factor
+// 1 / delta and are multiplied by 1 / x, depend on delta, so a contribution is applied to an
+// existing key instead of generating it again:
+//
+//     r1cs_gg_ppzksnark_delta_update<CurveType>::update(keypair, x);
+//     r1cs_gg_ppzksnark_delta_update<CurveType>::update_file(path, x);
+//
+// The queries are multiplied in blocks on the current executor and every block is brought
+// back to special form with one batch inversion, as the provers add the bases of a key with
+// mixed additions. A memory-mapped key file is updated in place, in one streaming pass over
+// its H_query and L_query sections, window by window.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_DELTA_UPDATE_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_DELTA_UPDATE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/detail/basic_policy.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_proving_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    /**
+                     * Multiplies the points [first, first + n) by scalar in place, in one block per thread of
+                     * the current executor. With special_form set, the non-zero points of every block are
+                     * brought to special form with one batch inversion.
+                     */
+                    template<typename GroupType, typename ScalarValueType>
+                    void batch_scale(typename GroupType::value_type *first, const std::size_t n,
+                                     const ScalarValueType &scalar, const bool special_form) {
+                        typedef typename GroupType::value_type value_type;
+
+                        if (!n) {
+                            return;
+                        }
+
+                        const std::size_t num_blocks = std::min(n, executor::current().concurrency());
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t block_first = std::min(n, block * block_size);
+                            const std::size_t block_last = std::min(n, block_first + block_size);
+
+                            std::vector<value_type> block_points;
+                            std::vector<std::size_t> block_indices;
+                            for (std::size_t i = block_first; i < block_last; ++i) {
+                                first[i] = scalar * first[i];
+                                if (special_form && !first[i].is_zero()) {
+                                    block_points.emplace_back(first[i]);
+                                    block_indices.emplace_back(i);
+                                }
+                            }
+
+                            if (!block_points.empty()) {
+                                algebra::batch_to_special<GroupType>(block_points);
+                                for (std::size_t k = 0; k < block_indices.size(); ++k) {
+                                    first[block_indices[k]] = block_points[k];
+                                }
+                            }
+                        });
+                    }
+                }    // namespace detail
+
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_delta_update {
+                    typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
+
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
+                public:
+                    typedef typename scalar_field_type::value_type scalar_type;
+
+                    typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
+                    typedef typename policy_type::mapped_proving_key_type mapped_proving_key_type;
+                    typedef typename policy_type::verification_key_type verification_key_type;
+                    typedef typename policy_type::keypair_type keypair_type;
+
+                    /* Number of bases of a mapped section multiplied at once by update_file. */
+                    static constexpr const std::size_t stream_window_size = std::size_t(1) << 16;
+
+                    /**
+                     * Replaces the delta of proving_key by ratio * delta.
+                     */
+                    static inline void update(proving_key_type &proving_key, const scalar_type &ratio) {
+                        BOOST_ASSERT(!ratio.is_zero());
+
+                        const scalar_type ratio_inverse = ratio.inversed();
+
+                        stage_profiler::timer update_timer("delta_update",
+                                                           proving_key.H_query.size() + proving_key.L_query.size());
+                        proving_key.delta_g1 = ratio * proving_key.delta_g1;
+                        proving_key.delta_g2 = ratio * proving_key.delta_g2;
+                        detail::batch_scale<g1_type>(proving_key.H_query.data(), proving_key.H_query.size(),
+                                                     ratio_inverse, true);
+                        detail::batch_scale<g1_type>(proving_key.L_query.data(), proving_key.L_query.size(),
+                                                     ratio_inverse, true);
+                    }
+
+                    /**
+                     * Replaces the delta of a processed proving key by ratio * delta. The fixed-base tables of
+                     * H_query and L_query are linear in their bases and are multiplied along with them, so
+                     * the key need not be processed again. The combs of delta, which take fewer group
+                     * additions to build than scalar multiplications to scale, are built again.
+                     */
+                    static inline void update(processed_proving_key_type &processed_proving_key,
+                                              const scalar_type &ratio) {
+                        update(processed_proving_key.proving_key, ratio);
+
+                        const scalar_type ratio_inverse = ratio.inversed();
+                        detail::batch_scale<g1_type>(processed_proving_key.H_query_precomp.table.data(),
+                                                     processed_proving_key.H_query_precomp.table.size(),
+                                                     ratio_inverse, false);
+                        detail::batch_scale<g1_type>(processed_proving_key.L_query_precomp.table.data(),
+                                                     processed_proving_key.L_query_precomp.table.size(),
+                                                     ratio_inverse, false);
+                        if (!processed_proving_key.delta_g1_comb.empty() ||
+                            !processed_proving_key.delta_g2_comb.empty()) {
+                            processed_proving_key.precompute_delta_combs();
+                        }
+                    }
+
+                    /**
+                     * Replaces the delta of verification_key by ratio * delta.
+                     */
+                    static inline void update(verification_key_type &verification_key, const scalar_type &ratio) {
+                        BOOST_ASSERT(!ratio.is_zero());
+
+                        verification_key.delta_g2 = ratio * verification_key.delta_g2;
+                    }
+
+                    static inline void update(keypair_type &keypair, const scalar_type &ratio) {
+                        update(keypair.first, ratio);
+                        update(keypair.second, ratio);
+                    }
+
+                    /**
+                     * Replaces the delta of the memory-mapped proving key file at path by ratio * delta, in
+                     * place. The file must not be mapped by a prover while it is updated.
+                     */
+                    static inline void update_file(const std::string &path, const scalar_type &ratio) {
+                        BOOST_ASSERT(!ratio.is_zero());
+
+                        const scalar_type ratio_inverse = ratio.inversed();
+
+                        typename mapped_proving_key_type::updater key(path);
+                        stage_profiler::timer update_timer(
+                            "delta_update", (key.H_query_end() - key.H_query_begin()) +
+                                                (key.L_query_end() - key.L_query_begin()));
+                        key.delta_g1() = ratio * key.delta_g1();
+                        key.delta_g2() = ratio * key.delta_g2();
+                        update_section(key.H_query_begin(), key.H_query_end(), ratio_inverse);
+                        update_section(key.L_query_begin(), key.L_query_end(), ratio_inverse);
+                        key.flush();
+                    }
+
+                private:
+                    static inline void update_section(typename g1_type::value_type *first,
+                                                      typename g1_type::value_type *last,
+                                                      const scalar_type &ratio_inverse) {
+                        const std::size_t size = last - first;
+                        for (std::size_t window = 0; window < size; window += stream_window_size) {
+                            detail::batch_scale<g1_type>(first + window,
+                                                         std::min(stream_window_size, size - window),
+                                                         ratio_inverse, true);
+                        }
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_DELTA_UPDATE_HPP
@@ -61,10 +61,14 @@
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/modes.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proving_key.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_proving_key.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verification_key.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_verification_key.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/keypair.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof_batch.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/proof.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/compressed_proof.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/verification_key.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
 
@@ -92,6 +96,12 @@ namespace nil {
 
                         typedef r1cs_auxiliary_input<typename curve_type::scalar_field_type> auxiliary_input_type;
 
+                        typedef r1cs_primary_input_span<typename curve_type::scalar_field_type>
+                            primary_input_span_type;
+
+                        typedef r1cs_auxiliary_input_span<typename curve_type::scalar_field_type>
+                            auxiliary_input_span_type;
+
                         /******************************** Proving key ********************************/
 
                         /**
@@ -99,6 +109,76 @@ namespace nil {
                          */
                         typedef r1cs_gg_ppzksnark_proving_key<curve_type, constraint_system_type> proving_key_type;
 
+                        /************************** Processed proving key ****************************/
+
+                        /**
+                         * A processed proving key for the R1CS GG-ppzkSNARK.
+                         *
+                         * Compared to a (non-processed) proving key, a processed proving key contains
+                         * fixed-base precomputation of the query vectors that trades memory for a
+                         * faster proving time.
+                         */
+                        typedef r1cs_gg_ppzksnark_processed_proving_key<curve_type, constraint_system_type>
+                            processed_proving_key_type;
+
+                        /**************************** Compact proving key ******************************/
+
+                        /**
+                         * A proving key for the R1CS GG-ppzkSNARK that carries the compiled witness
+                         * evaluation program of the constraint system instead of the constraint system
+                         * itself. It is obtained by converting a proving key.
+                         */
+                        typedef r1cs_gg_ppzksnark_proving_key<
+                            curve_type, r1cs_witness_program<typename curve_type::scalar_field_type>>
+                            compact_proving_key_type;
+
+                        /**************************** Bytecode proving key *****************************/
+
+                        /**
+                         * A proving key for the R1CS GG-ppzkSNARK that carries the bytecode of the A, B and
+                         * C matrices of the constraint system, see r1cs_bytecode.hpp, which the witness map
+                         * runs in place of the constraint system. It is obtained by converting a proving key.
+                         */
+                        typedef r1cs_gg_ppzksnark_proving_key<curve_type,
+                                                              r1cs_bytecode<typename curve_type::scalar_field_type>>
+                            bytecode_proving_key_type;
+
+                        /************************** Memory-mapped proving key ***************************/
+
+                        /**
+                         * A proving key for the R1CS GG-ppzkSNARK whose query vectors are memory-mapped
+                         * from a file instead of being held in memory.
+                         */
+                        typedef r1cs_gg_ppzksnark_mapped_proving_key<curve_type, constraint_system_type>
+                            mapped_proving_key_type;
+
+                        /*************************** Affine proving key *******************************/
+
+                        /**
+                         * A proving key for the R1CS GG-ppzkSNARK whose G1 queries are packed affine
+                         * points. It is obtained by converting a proving key.
+                         */
+                        typedef r1cs_gg_ppzksnark_affine_proving_key<curve_type, constraint_system_type>
+                            affine_proving_key_type;
+
+                        /*************************** Sparse proving key *******************************/
+
+                        /**
+                         * A proving key for the R1CS GG-ppzkSNARK whose A_query only holds its non-zero
+                         * points. It is obtained by converting a proving key.
+                         */
+                        typedef r1cs_gg_ppzksnark_sparse_proving_key<curve_type, constraint_system_type>
+                            sparse_proving_key_type;
+
+                        /************************** Lagrange-basis proving key *************************/
+
+                        /**
+                         * A proving key for the R1CS GG-ppzkSNARK whose H_query is in the Lagrange basis
+                         * of the coset of the QAP domain. It is produced by the generator.
+                         */
+                        typedef r1cs_gg_ppzksnark_lagrange_proving_key<curve_type, constraint_system_type>
+                            lagrange_proving_key_type;
+
                         /******************************* Verification key ****************************/
 
                         /**
@@ -106,6 +186,11 @@ namespace nil {
                          */
                         typedef r1cs_gg_ppzksnark_verification_key<curve_type> verification_key_type;
 
+                        /**
+                         * A verification key for the R1CS GG-ppzkSNARK stored in a memory-mapped file.
+                         */
+                        typedef r1cs_gg_ppzksnark_mapped_verification_key<curve_type> mapped_verification_key_type;
+
                         /************************ Processed verification key *************************/
 
                         /**
@@ -135,6 +220,12 @@ namespace nil {
                          * about the structure for statistics purposes.
                          */
                         typedef r1cs_gg_ppzksnark_proof<CurveType> proof_type;
+
+                        /**
+                         * Proofs stored as separate vectors of their A, B and C elements, for the batch
+                         * verifier and the aggregation.
+                         */
+                        typedef r1cs_gg_ppzksnark_proof_batch<CurveType> proof_batch_type;
                     };
 
                     template<typename CurveType>
@@ -153,6 +244,12 @@ namespace nil {
 
                         typedef r1cs_auxiliary_input<typename curve_type::scalar_field_type> auxiliary_input_type;
 
+                        typedef r1cs_primary_input_span<typename curve_type::scalar_field_type>
+                            primary_input_span_type;
+
+                        typedef r1cs_auxiliary_input_span<typename curve_type::scalar_field_type>
+                            auxiliary_input_span_type;
+
                         /******************************** Proving key ********************************/
 
                         /**
@@ -200,6 +297,11 @@ namespace nil {
                          */
                         typedef typename srs_type::proving_srs_type proving_srs_type;
 
+                        /**
+                         * A proving SRS with the precomputed Miller loop lines of its commitment key.
+                         */
+                        typedef r1cs_gg_ppzksnark_aggregate_prepared_proving_srs<CurveType> prepared_proving_srs_type;
+
                         /**************************** Verification SRS for aggregation ********************************/
 
                         /**
@@ -207,6 +309,20 @@ namespace nil {
                          */
                         typedef typename srs_type::verification_srs_type verification_srs_type;
 
+                        /**
+                         * A verification SRS with the precomputed Miller loop lines of its G2 elements.
+                         */
+                        typedef r1cs_gg_ppzksnark_aggregate_prepared_verification_srs<CurveType>
+                            prepared_verification_srs_type;
+
+                        /**
+                         * A Groth16 verifying key processed together with a verification SRS, with the
+                         * precomputed Miller loop lines of all their G2 elements and optional fixed-base
+                         * tables of gamma_ABC_g1.
+                         */
+                        typedef r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType>
+                            processed_aggregate_verification_key_type;
+
                         /********************************** Aggregation SRS pair *********************************/
 
                         /**
@@ -226,6 +342,12 @@ namespace nil {
                          */
                         typedef r1cs_gg_ppzksnark_proof<CurveType> proof_type;
 
+                        /**
+                         * Proofs stored as separate vectors of their A, B and C elements, for the batch
+                         * verifier and the aggregation.
+                         */
+                        typedef r1cs_gg_ppzksnark_proof_batch<CurveType> proof_batch_type;
+
                         /*********************************** Aggregated proof ***********************************/
 
                         /**
@@ -236,6 +358,11 @@ namespace nil {
                          * about the structure for statistics purposes.
                          */
                         typedef r1cs_gg_ppzksnark_aggregate_proof<CurveType> aggregate_proof_type;
+
+                        /**
+                         * The same proof with its Gt elements in compressed form, for storage and transfer.
+                         */
+                        typedef r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> compressed_aggregate_proof_type;
                     };
                 }    // namespace detail
             }        // namespace snark
@@ -0,0 +1,399 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the distributed R1CS GG-ppzkSNARK prover, sharding the query multi-exponentiations.
+//
+// The query multi-exponentiations dominate proving, and on large circuits the queries alone
+// outgrow a single host. The distributed prover splits the index ranges of A_query, B_query,
+// H_query and L_query into shards:
+// - every worker holds the shard proving key of its shard, that is its slice of the queries;
+// - the coordinator runs the witness map and sends each worker the scalars of its shard;
+// - each worker returns the partial sums over its slice;
+// - the coordinator adds them up into g1_A, g2_B and g1_C.
+//
+// Moving jobs and partial evaluations between hosts is left to the caller, through an
+// exchange function taking the jobs and returning the partial evaluations:
+//
+//     auto proof = r1cs_gg_ppzksnark_distributed_prover<CurveType>::process(
+//         pk, primary_input, auxiliary_input, workers.size(),
+//         [&](const std::vector<job_type> &jobs) { return my_transport.run(jobs); });
+//
+// A job is its shard and three field element vectors, and its partial evaluation is four
+// group elements, both serializable with the marshalling of the scheme. The coordinator only
+// reads the constraint system and the alpha, beta and delta elements, so its proving key
+// may have empty queries. Shards, jobs and partial evaluations arrive from other hosts, so
+// their ranges and sizes are checked in every build, and a mismatch throws
+// std::invalid_argument.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_DISTRIBUTED_PROVER_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_DISTRIBUTED_PROVER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+#include <nil/crypto3/algebra/multiexp/policies.hpp>
+
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_const_padded_assignment.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/prover.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Index ranges of the queries covered by one shard. A_query and B_query are indexed by
+                 * the constant-padded assignment, H_query by the coefficients of H and L_query by the
+                 * auxiliary input.
+                 */
+                struct r1cs_gg_ppzksnark_shard {
+                    std::size_t index;
+                    std::size_t variables_first, variables_last;
+                    std::size_t H_first, H_last;
+                    std::size_t L_first, L_last;
+
+                    bool operator==(const r1cs_gg_ppzksnark_shard &other) const {
+                        return index == other.index && variables_first == other.variables_first &&
+                               variables_last == other.variables_last && H_first == other.H_first &&
+                               H_last == other.H_last && L_first == other.L_first && L_last == other.L_last;
+                    }
+                };
+
+                /**
+                 * The slice of the queries of a proving key a worker needs for its shard. B_query keeps
+                 * the original indices of its terms.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_shard_proving_key {
+                    typedef CurveType curve_type;
+
+                    r1cs_gg_ppzksnark_shard shard;
+
+                    std::vector<typename CurveType::g1_type::value_type> A_query;
+                    knowledge_commitment_vector<typename CurveType::g2_type, typename CurveType::g1_type> B_query;
+                    std::vector<typename CurveType::g1_type::value_type> H_query;
+                    std::vector<typename CurveType::g1_type::value_type> L_query;
+                };
+
+                /**
+                 * The scalars a worker needs for its shard, in the order of the shard ranges.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_shard_job {
+                    typedef CurveType curve_type;
+
+                    r1cs_gg_ppzksnark_shard shard;
+
+                    std::vector<typename CurveType::scalar_field_type::value_type> assignment;
+                    std::vector<typename CurveType::scalar_field_type::value_type> H;
+                    std::vector<typename CurveType::scalar_field_type::value_type> L;
+                };
+
+                /**
+                 * The partial sums of the query multi-exponentiations over one shard.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_partial_evaluation {
+                    typedef CurveType curve_type;
+
+                    std::size_t shard_index;
+
+                    typename CurveType::g1_type::value_type evaluation_At;
+                    typename knowledge_commitment<typename CurveType::g2_type,
+                                                  typename CurveType::g1_type>::value_type evaluation_Bt;
+                    typename CurveType::g1_type::value_type evaluation_Ht;
+                    typename CurveType::g1_type::value_type evaluation_Lt;
+
+                    bool operator==(const r1cs_gg_ppzksnark_partial_evaluation &other) const {
+                        return shard_index == other.shard_index && evaluation_At == other.evaluation_At &&
+                               evaluation_Bt == other.evaluation_Bt && evaluation_Ht == other.evaluation_Ht &&
+                               evaluation_Lt == other.evaluation_Lt;
+                    }
+                };
+
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_distributed_prover {
+                    typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
+
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
+                public:
+                    typedef typename policy_type::primary_input_type primary_input_type;
+                    typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::proof_type proof_type;
+
+                    typedef r1cs_gg_ppzksnark_shard shard_type;
+                    typedef r1cs_gg_ppzksnark_shard_proving_key<CurveType> shard_proving_key_type;
+                    typedef r1cs_gg_ppzksnark_shard_job<CurveType> job_type;
+                    typedef r1cs_gg_ppzksnark_partial_evaluation<CurveType> partial_evaluation_type;
+
+                    /**
+                     * Splits every query of the proving key into num_shards ranges of equal length.
+                     */
+                    static inline std::vector<shard_type> plan(const proving_key_type &proving_key,
+                                                               const std::size_t num_shards) {
+                        if (num_shards == 0) {
+                            throw std::invalid_argument("r1cs_gg_ppzksnark_distributed_prover: no shards");
+                        }
+
+                        const std::size_t num_variables = proving_key.constraint_system.num_variables();
+                        const std::size_t num_inputs = proving_key.constraint_system.num_inputs();
+                        const std::size_t degree =
+                            reductions::r1cs_to_qap<scalar_field_type>::get_domain(proving_key.constraint_system)->m;
+
+                        std::vector<shard_type> shards(num_shards);
+                        for (std::size_t i = 0; i < num_shards; ++i) {
+                            shards[i].index = i;
+                            shards[i].variables_first = split(num_variables + 1, num_shards, i);
+                            shards[i].variables_last = split(num_variables + 1, num_shards, i + 1);
+                            shards[i].H_first = split(degree - 1, num_shards, i);
+                            shards[i].H_last = split(degree - 1, num_shards, i + 1);
+                            shards[i].L_first = split(num_variables - num_inputs, num_shards, i);
+                            shards[i].L_last = split(num_variables - num_inputs, num_shards, i + 1);
+                        }
+
+                        return shards;
+                    }
+
+                    /**
+                     * Cuts the slice of shard out of the queries of a full proving key.
+                     */
+                    static inline shard_proving_key_type shard_proving_key(const proving_key_type &proving_key,
+                                                                           const shard_type &shard) {
+                        check_shard(shard, proving_key.A_query.size(), proving_key.H_query.size(),
+                                    proving_key.L_query.size());
+
+                        shard_proving_key_type result;
+                        result.shard = shard;
+
+                        result.A_query.assign(proving_key.A_query.begin() + shard.variables_first,
+                                              proving_key.A_query.begin() + shard.variables_last);
+                        result.H_query.assign(proving_key.H_query.begin() + shard.H_first,
+                                              proving_key.H_query.begin() + shard.H_last);
+                        result.L_query.assign(proving_key.L_query.begin() + shard.L_first,
+                                              proving_key.L_query.begin() + shard.L_last);
+
+                        const std::vector<std::size_t> &indices = proving_key.B_query.indices;
+                        const std::size_t first =
+                            std::lower_bound(indices.begin(), indices.end(), shard.variables_first) - indices.begin();
+                        const std::size_t last =
+                            std::lower_bound(indices.begin() + first, indices.end(), shard.variables_last) -
+                            indices.begin();
+                        result.B_query.indices.assign(indices.begin() + first, indices.begin() + last);
+                        result.B_query.values.assign(proving_key.B_query.values.begin() + first,
+                                                     proving_key.B_query.values.begin() + last);
+                        result.B_query.domain_size_ = proving_key.B_query.domain_size_;
+
+                        return result;
+                    }
+
+                    /**
+                     * Runs the witness map and cuts its scalars into one job per shard.
+                     */
+                    static inline std::vector<job_type> jobs(const proving_key_type &proving_key,
+                                                             const std::vector<shard_type> &shards,
+                                                             const primary_input_type &primary_input,
+                                                             const auxiliary_input_type &auxiliary_input) {
+                        const std::size_t num_variables = proving_key.constraint_system.num_variables();
+                        if (primary_input.size() != proving_key.constraint_system.num_inputs() ||
+                            primary_input.size() + auxiliary_input.size() != num_variables) {
+                            throw std::invalid_argument(
+                                "r1cs_gg_ppzksnark_distributed_prover: the assignment does not fit the proving key");
+                        }
+                        BOOST_ASSERT(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
+
+                        r1cs_variable_assignment<scalar_field_type> full_variable_assignment = primary_input;
+                        full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
+                                                        auxiliary_input.end());
+                        const r1cs_const_padded_assignment<scalar_field_type> const_padded_assignment(
+                            full_variable_assignment);
+                        const std::size_t num_inputs = primary_input.size();
+
+                        stage_profiler::timer witness_timer("witness_map",
+                                                            proving_key.constraint_system.num_constraints());
+                        const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain =
+                            reductions::r1cs_to_qap<scalar_field_type>::get_domain(proving_key.constraint_system);
+                        typename reductions::r1cs_to_qap<scalar_field_type>::workspace scratch;
+                        const std::vector<typename scalar_field_type::value_type> coefficients_for_H =
+                            reductions::r1cs_to_qap<scalar_field_type>::coefficients_for_H(
+                                proving_key.constraint_system, full_variable_assignment, domain, scratch);
+                        witness_timer.stop();
+
+                        for (const shard_type &shard : shards) {
+                            check_shard(shard, num_variables + 1, domain->m - 1, num_variables - num_inputs);
+                        }
+
+                        std::vector<job_type> result(shards.size());
+                        for (std::size_t i = 0; i < shards.size(); ++i) {
+                            const shard_type &shard = shards[i];
+                            result[i].shard = shard;
+                            result[i].assignment.assign(const_padded_assignment.begin() + shard.variables_first,
+                                                        const_padded_assignment.begin() + shard.variables_last);
+                            result[i].H.assign(coefficients_for_H.begin() + shard.H_first,
+                                               coefficients_for_H.begin() + shard.H_last);
+                            result[i].L.assign(full_variable_assignment.begin() + num_inputs + shard.L_first,
+                                               full_variable_assignment.begin() + num_inputs + shard.L_last);
+                        }
+
+                        return result;
+                    }
+
+                    /**
+                     * The worker side: the partial sums of a job over the shard proving key of its shard.
+                     * Throws std::invalid_argument for a job of another shard or whose scalars do not
+                     * cover its ranges.
+                     */
+                    static inline partial_evaluation_type evaluate(const shard_proving_key_type &shard_key,
+                                                                   const job_type &job) {
+                        const shard_type &shard = job.shard;
+                        if (!(shard_key.shard == shard)) {
+                            throw std::invalid_argument("r1cs_gg_ppzksnark_distributed_prover: job of another shard");
+                        }
+                        check_shard(shard, shard.variables_last, shard.H_last, shard.L_last);
+                        if (shard_key.A_query.size() != shard.variables_last - shard.variables_first ||
+                            shard_key.H_query.size() != shard.H_last - shard.H_first ||
+                            shard_key.L_query.size() != shard.L_last - shard.L_first ||
+                            job.assignment.size() != shard.variables_last - shard.variables_first ||
+                            job.H.size() != shard.H_last - shard.H_first ||
+                            job.L.size() != shard.L_last - shard.L_first) {
+                            throw std::invalid_argument(
+                                "r1cs_gg_ppzksnark_distributed_prover: job does not cover its shard");
+                        }
+
+                        const std::size_t chunks = executor::current().concurrency();
+                        stage_profiler::timer multiexp_timer("multiexp", job.assignment.size());
+
+                        partial_evaluation_type result;
+                        result.shard_index = job.shard.index;
+                        result.evaluation_At =
+                            dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                shard_key.A_query.begin(), shard_key.A_query.end(), job.assignment.begin(),
+                                job.assignment.end(), chunks);
+                        result.evaluation_Bt =
+                            kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                shard_key.B_query, job.shard.variables_first, job.shard.variables_last,
+                                job.assignment.begin(), job.assignment.end(), chunks);
+                        result.evaluation_Ht = dispatch_multiexp<multiexp_method_auto>(
+                            shard_key.H_query.begin(), shard_key.H_query.end(), job.H.begin(), job.H.end(), chunks);
+                        result.evaluation_Lt =
+                            dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                shard_key.L_query.begin(), shard_key.L_query.end(), job.L.begin(), job.L.end(),
+                                chunks);
+
+                        return result;
+                    }
+
+                    /**
+                     * Adds up the partial evaluations of every shard, in any order, into a proof. Throws
+                     * std::invalid_argument unless there is exactly one partial evaluation per shard.
+                     */
+                    static inline proof_type combine(const proving_key_type &proving_key, const std::size_t num_shards,
+                                                     const std::vector<partial_evaluation_type> &partials) {
+                        if (partials.size() != num_shards) {
+                            throw std::invalid_argument(
+                                "r1cs_gg_ppzksnark_distributed_prover: a partial evaluation per shard is needed");
+                        }
+
+                        std::vector<bool> seen(num_shards, false);
+                        typename g1_type::value_type evaluation_At = g1_type::value_type::zero();
+                        typename knowledge_commitment<g2_type, g1_type>::value_type evaluation_Bt =
+                            knowledge_commitment<g2_type, g1_type>::value_type::zero();
+                        typename g1_type::value_type evaluation_Ht = g1_type::value_type::zero();
+                        typename g1_type::value_type evaluation_Lt = g1_type::value_type::zero();
+
+                        for (const partial_evaluation_type &partial : partials) {
+                            if (partial.shard_index >= num_shards || seen[partial.shard_index]) {
+                                throw std::invalid_argument(
+                                    "r1cs_gg_ppzksnark_distributed_prover: unknown or repeated shard");
+                            }
+                            seen[partial.shard_index] = true;
+
+                            evaluation_At = evaluation_At + partial.evaluation_At;
+                            evaluation_Bt = evaluation_Bt + partial.evaluation_Bt;
+                            evaluation_Ht = evaluation_Ht + partial.evaluation_Ht;
+                            evaluation_Lt = evaluation_Lt + partial.evaluation_Lt;
+                        }
+
+                        return r1cs_gg_ppzksnark_prover<CurveType>::make_proof(proving_key, evaluation_At,
+                                                                               evaluation_Bt, evaluation_Ht,
+                                                                               evaluation_Lt);
+                    }
+
+                    /**
+                     * Proves with num_shards workers reached through exchange, which takes the jobs
+                     * and returns the partial evaluation of every one of them.
+                     */
+                    template<typename Exchange>
+                    static inline proof_type process(const proving_key_type &proving_key,
+                                                     const primary_input_type &primary_input,
+                                                     const auxiliary_input_type &auxiliary_input,
+                                                     const std::size_t num_shards, Exchange exchange) {
+                        const std::vector<job_type> shard_jobs =
+                            jobs(proving_key, plan(proving_key, num_shards), primary_input, auxiliary_input);
+
+                        stage_profiler::timer exchange_timer("exchange", num_shards);
+                        const std::vector<partial_evaluation_type> partials = exchange(shard_jobs);
+                        exchange_timer.stop();
+
+                        return combine(proving_key, num_shards, partials);
+                    }
+
+                private:
+                    /* Throws std::invalid_argument unless the ranges of shard lie in queries of these sizes. */
+                    static inline void check_shard(const shard_type &shard, const std::size_t variables_size,
+                                                   const std::size_t H_size, const std::size_t L_size) {
+                        if (shard.variables_first > shard.variables_last || shard.variables_last > variables_size ||
+                            shard.H_first > shard.H_last || shard.H_last > H_size || shard.L_first > shard.L_last ||
+                            shard.L_last > L_size) {
+                            throw std::invalid_argument("r1cs_gg_ppzksnark_distributed_prover: shard out of range");
+                        }
+                    }
+
+                    /* The first index of part i when a range of the given size is cut into num_parts. */
+                    static inline std::size_t split(const std::size_t size, const std::size_t num_parts,
+                                                    const std::size_t i) {
+                        return size / num_parts * i + std::min(i, size % num_parts);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_DISTRIBUTED_PROVER_HPP
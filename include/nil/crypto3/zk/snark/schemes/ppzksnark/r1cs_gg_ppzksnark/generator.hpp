@@ -27,8 +27,15 @@
 #ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_BASIC_GENERATOR_HPP
 #define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_BASIC_GENERATOR_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <numeric>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
@@ -39,13 +46,15 @@
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/zk/snark/batch_normalizer.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
 
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/detail/basic_policy.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/generator_checkpoint.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -74,157 +83,377 @@ namespace nil {
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::mapped_proving_key_type mapped_proving_key_type;
+                    typedef typename policy_type::sparse_proving_key_type sparse_proving_key_type;
+                    typedef typename policy_type::lagrange_proving_key_type lagrange_proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
                     typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
 
+                    /**
+                     * The keys are computed on constraint_system itself: the A/B swap making the B_query
+                     * "lighter" is applied as a flag of the reduction, and the constraint system is only
+                     * copied for the proving key once the queries are complete.
+                     */
                     template<typename DistributionType =
                                  boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
                              typename GeneratorType = boost::random::mt19937>
                     static inline auto basic_process(const constraint_system_type &constraint_system) {
+                        const bool swap_AB = constraint_system.is_AB_swap_beneficial();
 
-                        /* Make the B_query "lighter" if possible */
-                        constraint_system_type r1cs_copy(constraint_system);
-                        r1cs_copy.swap_AB_if_beneficial();
-
-                        /* Generate secret randomness */
-                        const typename scalar_field_type::value_type t =
-                            algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
-                        const typename scalar_field_type::value_type alpha =
-                            algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
-                        const typename scalar_field_type::value_type beta =
-                            algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
-                        const typename scalar_field_type::value_type gamma =
-                            algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
-                        const typename scalar_field_type::value_type delta =
-                            algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
-                        const typename scalar_field_type::value_type gamma_inverse = gamma.inversed();
-                        const typename scalar_field_type::value_type delta_inverse = delta.inversed();
+                        return basic_process<DistributionType, GeneratorType>(constraint_system, swap_AB, [&]() {
+                            constraint_system_type r1cs_copy(constraint_system);
+                            if (swap_AB) {
+                                r1cs_copy.swap_AB();
+                            }
+                            return r1cs_copy;
+                        });
+                    }
 
-                        /* A quadratic arithmetic program evaluated at t. */
-                        qap_instance_evaluation<scalar_field_type> qap =
-                            reductions::r1cs_to_qap<scalar_field_type>::instance_map_with_evaluation(r1cs_copy, t);
+                    /**
+                     * Same as above, the constraint system being moved into the proving key instead of
+                     * copied.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937>
+                    static inline auto basic_process(constraint_system_type &&constraint_system) {
+                        const bool swap_AB = constraint_system.is_AB_swap_beneficial();
 
-                        std::size_t non_zero_At = 0;
-                        std::size_t non_zero_Bt = 0;
-                        for (std::size_t i = 0; i < qap.num_variables + 1; ++i) {
-                            if (!qap.At[i].is_zero()) {
-                                ++non_zero_At;
+                        return basic_process<DistributionType, GeneratorType>(constraint_system, swap_AB, [&]() {
+                            if (swap_AB) {
+                                constraint_system.swap_AB();
                             }
-                            if (!qap.Bt[i].is_zero()) {
-                                ++non_zero_Bt;
-                            }
-                        }
+                            return constraint_system_type(std::move(constraint_system));
+                        });
+                    }
 
-                        /* qap.{At,Bt,Ct,Ht} are now in unspecified state, but we do not use them later */
-                        std::vector<typename scalar_field_type::value_type> At = std::move(qap.At);
-                        std::vector<typename scalar_field_type::value_type> Bt = std::move(qap.Bt);
-                        std::vector<typename scalar_field_type::value_type> Ct = std::move(qap.Ct);
-                        std::vector<typename scalar_field_type::value_type> Ht = std::move(qap.Ht);
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937>
+                    static inline keypair_type process(const constraint_system_type &constraint_system) {
+                        return make_keypair(basic_process<DistributionType, GeneratorType>(constraint_system));
+                    }
 
-                        /* The gamma inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * gamma^{-1}.
-                         */
-                        std::vector<typename scalar_field_type::value_type> gamma_ABC;
-                        gamma_ABC.reserve(qap.num_inputs);
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937>
+                    static inline keypair_type process(constraint_system_type &&constraint_system) {
+                        return make_keypair(
+                            basic_process<DistributionType, GeneratorType>(std::move(constraint_system)));
+                    }
+
+                    /**
+                     * Generates the keys for constraint_system with a sparse A_query, holding only the points
+                     * of the variables used on the A side of some constraint.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937>
+                    static inline r1cs_gg_ppzksnark_keypair<sparse_proving_key_type, verification_key_type>
+                        process_sparse(const constraint_system_type &constraint_system) {
+                        keypair_type keypair = process<DistributionType, GeneratorType>(constraint_system);
+
+                        return {sparse_proving_key_type(std::move(keypair.first)), std::move(keypair.second)};
+                    }
 
-                        const typename scalar_field_type::value_type gamma_ABC_0 =
-                            (beta * At[0] + alpha * Bt[0] + Ct[0]) * gamma_inverse;
-                        for (std::size_t i = 1; i < qap.num_inputs + 1; ++i) {
-                            gamma_ABC.emplace_back((beta * At[i] + alpha * Bt[i] + Ct[i]) * gamma_inverse);
+                    /**
+                     * Generates the keys for constraint_system with the H_query of the proving key in the
+                     * Lagrange basis of the coset of the QAP domain, see r1cs_gg_ppzksnark_lagrange_proving_key.
+                     * The verification key is the same as for the other proving keys.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937>
+                    static inline r1cs_gg_ppzksnark_keypair<lagrange_proving_key_type, verification_key_type>
+                        process_lagrange(const constraint_system_type &constraint_system) {
+                        const bool swap_AB = constraint_system.is_AB_swap_beneficial();
+
+                        keypair_type keypair = make_keypair(basic_process<DistributionType, GeneratorType>(
+                            constraint_system, swap_AB,
+                            [&]() {
+                                constraint_system_type r1cs_copy(constraint_system);
+                                if (swap_AB) {
+                                    r1cs_copy.swap_AB();
+                                }
+                                return r1cs_copy;
+                            },
+                            true));
+
+                        return {lagrange_proving_key_type(std::move(keypair.first)), std::move(keypair.second)};
+                    }
+
+                    /**
+                     * Generates the keys for constraint_system and writes the proving key straight into the
+                     * memory-mapped file at path, which is opened and returned together with the
+                     * verification key.
+                     *
+                     * The queries are computed in blocks of stream_block_size elements, each block being
+                     * written as soon as it is complete, so no query is ever held in memory as a whole.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937>
+                    static inline std::pair<mapped_proving_key_type, verification_key_type>
+                        process(const constraint_system_type &constraint_system, const std::string &path) {
+                        return stream_process<DistributionType, GeneratorType>(constraint_system, path, nullptr);
+                    }
+
+                    /**
+                     * Same as above, the progress being recorded in the checkpoint file at checkpoint_path
+                     * after every block (see generator_checkpoint.hpp). When the checkpoint holds the
+                     * state of an interrupted generation for constraint_system and the key file at path
+                     * it was written along, the generation resumes from its next block, with the
+                     * randomness it was started with; otherwise a new one is started. The checkpoint is
+                     * erased once the key is complete.
+                     *
+                     * Run under a job control (see job_control.hpp), a cancelled generation stops after
+                     * the block it is writing, and can be resumed from the next one.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = boost::random::mt19937>
+                    static inline std::pair<mapped_proving_key_type, verification_key_type>
+                        process(const constraint_system_type &constraint_system, const std::string &path,
+                                const std::string &checkpoint_path) {
+                        const checkpoint_type checkpoint(checkpoint_path);
+                        return stream_process<DistributionType, GeneratorType>(constraint_system, path, &checkpoint);
+                    }
+
+                private:
+                    typedef r1cs_gg_ppzksnark_generator_checkpoint<CurveType> checkpoint_type;
+                    typedef typename checkpoint_type::state_type checkpoint_state_type;
+
+                    static constexpr const std::size_t stream_block_size = std::size_t(1) << 16;
+
+                    template<typename DistributionType, typename GeneratorType>
+                    static inline std::pair<mapped_proving_key_type, verification_key_type>
+                        stream_process(const constraint_system_type &constraint_system, const std::string &path,
+                                       const checkpoint_type *checkpoint) {
+
+                        /* Make the B_query "lighter" if possible */
+                        const bool swap_AB = constraint_system.is_AB_swap_beneficial();
+
+                        const typename checkpoint_type::digest_type digest =
+                            checkpoint ? checkpoint_type::digest(constraint_system) :
+                                         typename checkpoint_type::digest_type();
+                        checkpoint_state_type state = checkpoint_type::make_state(digest);
+                        key_scalars scalars;
+                        /* the toxic waste is cleared however the generation ends */
+                        const auto toxic_waste_guard = checkpoint_type::make_guard([&]() {
+                            checkpoint_type::clear(state);
+                            clear_scalars(scalars);
+                        });
+
+                        bool resume = checkpoint && checkpoint->load(digest, state);
+                        if (resume) {
+                            typename mapped_proving_key_type::source_digest_type key_digest;
+                            resume = mapped_proving_key_type::prefix_digest(path, key_digest) &&
+                                     std::equal(key_digest.begin(), key_digest.end(), state.key_digest);
+                            if (!resume) {
+                                checkpoint_type::clear(state);
+                                state = checkpoint_type::make_state(digest);
+                            }
+                        }
+                        if (!resume) {
+                            key_secrets secrets = generate_secrets<DistributionType, GeneratorType>();
+                            state.t = secrets.t;
+                            state.alpha = secrets.alpha;
+                            state.beta = secrets.beta;
+                            state.gamma = secrets.gamma;
+                            state.delta = secrets.delta;
+                            checkpoint_type::clear(secrets);
+                            state.g1_generator = algebra::random_element<g1_type>();
+                            state.g2_generator = algebra::random_element<g2_type>();
                         }
 
-                        /* The delta inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * delta^{-1}.
+                        scalars = evaluate_scalars(
+                            constraint_system, swap_AB, {state.t, state.alpha, state.beta, state.gamma, state.delta});
+                        stage_profiler::timer tables_timer("fixed_base_tables");
+                        const key_bases bases(scalars, state.g1_generator, state.g2_generator);
+                        tables_timer.stop();
+
+                        typename mapped_proving_key_type::writer out(path, scalars.At.size(), scalars.non_zero_Bt,
+                                                                     scalars.Bt.size(), scalars.Ht.size(),
+                                                                     scalars.Lt.size(), resume);
+
+                        /* the blocks of section before position next are in the file */
+                        const auto completed = [&](const std::uint64_t section, const std::size_t first) {
+                            return state.section > section || (state.section == section && first < state.next);
+                        };
+                        /*
+                         * The next state is saved from a copy, which replaces state only once it is durable,
+                         * so a failed save leaves state at the last checkpoint. A cancelled generation stops
+                         * once its last block is recorded, see job_control.hpp.
                          */
-                        std::vector<typename scalar_field_type::value_type> Lt;
-                        Lt.reserve(qap.num_variables - qap.num_inputs);
+                        const auto record = [&](const std::uint64_t section, const std::size_t next,
+                                                const std::size_t B_query_position) {
+                            if (checkpoint) {
+                                checkpoint_state_type recorded = state;
+                                const auto recorded_guard =
+                                    checkpoint_type::make_guard([&]() { checkpoint_type::clear(recorded); });
+                                recorded.section = section;
+                                recorded.next = next;
+                                recorded.B_query_position = B_query_position;
+                                out.sync();
+                                checkpoint->save(recorded);
+                                state = recorded;
+                            }
+                            stage_profiler::current_checkpoint();
+                        };
+
+                        const typename g2_type::value_type beta_g2 = scalars.beta * bases.g2_generator;
+                        const typename g2_type::value_type delta_g2 = scalars.delta * bases.g2_generator;
+                        out.write_points(scalars.alpha * bases.g1_generator, scalars.beta * bases.g1_generator,
+                                         scalars.delta * bases.g1_generator, beta_g2, delta_g2);
+                        if (!resume && checkpoint) {
+                            typename mapped_proving_key_type::source_digest_type key_digest;
+                            out.sync();
+                            if (!mapped_proving_key_type::prefix_digest(path, key_digest)) {
+                                throw std::runtime_error("r1cs_gg_ppzksnark_generator: cannot read back " + path);
+                            }
+                            std::copy(key_digest.begin(), key_digest.end(), state.key_digest);
+                            record(checkpoint_type::A_query_section, 0, 0);
+                        }
 
-                        const std::size_t Lt_offset = qap.num_inputs + 1;
-                        for (std::size_t i = 0; i < qap.num_variables - qap.num_inputs; ++i) {
-                            Lt.emplace_back((beta * At[Lt_offset + i] + alpha * Bt[Lt_offset + i] + Ct[Lt_offset + i]) *
-                                            delta_inverse);
+                        stage_profiler::timer exponentiate_timer("exponentiate",
+                                                                 scalars.At.size() + scalars.Bt.size() +
+                                                                     scalars.Ht.size() + scalars.Lt.size());
+                        for (std::size_t first = 0; first < scalars.At.size(); first += stream_block_size) {
+                            if (completed(checkpoint_type::A_query_section, first)) {
+                                continue;
+                            }
+                            const std::size_t last = std::min(scalars.At.size(), first + stream_block_size);
+                            std::vector<typename g1_type::value_type> block =
+                                bases.g1_batch_exp(scalar_field_type::value_type::one(), scalars.At, first, last, true);
+                            out.write_A_query(first, block.data(), block.size());
+                            record(checkpoint_type::A_query_section, last, state.B_query_position);
                         }
 
-                        /**
-                         * Note that H for Groth's proof system is degree d-2, but the QAP
-                         * reduction returns coefficients for degree d polynomial H (in
-                         * style of PGHR-type proof systems)
-                         */
-                        Ht.resize(Ht.size() - 2);
+                        std::size_t B_query_position = state.B_query_position;
+                        for (std::size_t first = 0; first < scalars.Bt.size(); first += stream_block_size) {
+                            if (completed(checkpoint_type::B_query_section, first)) {
+                                continue;
+                            }
+                            const std::size_t last = std::min(scalars.Bt.size(), first + stream_block_size);
+
+                            std::vector<std::uint64_t> indices;
+                            for (std::size_t i = first; i < last; ++i) {
+                                if (!scalars.Bt[i].is_zero()) {
+                                    indices.emplace_back(i);
+                                }
+                            }
 
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                             // var or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
+                            std::vector<typename g2_type::value_type> g_block(indices.size());
+                            std::vector<typename g1_type::value_type> h_block(indices.size());
+                            executor::current().parallel_for(indices.size(), [&](const std::size_t i) {
+                                g_block[i] = bases.g2_engine.exp(scalars.Bt[indices[i]]);
+                                h_block[i] = bases.g1_engine.exp(scalars.Bt[indices[i]]);
+                            });
+                            algebra::batch_to_special<g2_type>(g_block);
+                            algebra::batch_to_special<g1_type>(h_block);
+
+                            out.write_B_query(B_query_position, indices.data(), g_block.data(), h_block.data(),
+                                              indices.size());
+                            B_query_position += indices.size();
+                            record(checkpoint_type::B_query_section, last, B_query_position);
+                        }
 
-                        const typename g1_type::value_type g1_generator = algebra::random_element<g1_type>();
+                        for (std::size_t first = 0; first < scalars.Ht.size(); first += stream_block_size) {
+                            if (completed(checkpoint_type::H_query_section, first)) {
+                                continue;
+                            }
+                            const std::size_t last = std::min(scalars.Ht.size(), first + stream_block_size);
+                            std::vector<typename g1_type::value_type> block = bases.g1_batch_exp(
+                                scalars.Zt * scalars.delta_inverse, scalars.Ht, first, last, true);
+                            out.write_H_query(first, block.data(), block.size());
+                            record(checkpoint_type::H_query_section, last, state.B_query_position);
+                        }
 
-                        const std::size_t g1_scalar_count = non_zero_At + non_zero_Bt + qap.num_variables;
-                        const std::size_t g1_scalar_size = scalar_field_type::value_bits;
-                        const std::size_t g1_window_size = algebra::get_exp_window_size<g1_type>(g1_scalar_count);
+                        for (std::size_t first = 0; first < scalars.Lt.size(); first += stream_block_size) {
+                            if (completed(checkpoint_type::L_query_section, first)) {
+                                continue;
+                            }
+                            const std::size_t last = std::min(scalars.Lt.size(), first + stream_block_size);
+                            std::vector<typename g1_type::value_type> block =
+                                bases.g1_batch_exp(scalar_field_type::value_type::one(), scalars.Lt, first, last, true);
+                            out.write_L_query(first, block.data(), block.size());
+                            record(checkpoint_type::L_query_section, last, state.B_query_position);
+                        }
 
-                        algebra::window_table<g1_type> g1_table =
-                            algebra::get_window_table<g1_type>(g1_scalar_size, g1_window_size, g1_generator);
+                        out.close();
+                        exponentiate_timer.stop();
 
-                        const typename g2_type::value_type G2_gen = algebra::random_element<g2_type>();
+                        verification_key_type vk = verification_key_type(
+                            pairing_policy::pair_reduced(scalars.alpha * bases.g1_generator, beta_g2),
+                            scalars.gamma * bases.g2_generator, delta_g2, bases.gamma_ABC_g1(scalars));
 
-                        const std::size_t g2_scalar_count = non_zero_Bt;
-                        const std::size_t g2_scalar_size = scalar_field_type::value_bits;
-                        std::size_t g2_window_size = algebra::get_exp_window_size<g2_type>(g2_scalar_count);
+                        if (checkpoint) {
+                            checkpoint->erase();
+                        }
 
-                        algebra::window_table<g2_type> g2_table =
-                            algebra::get_window_table<g2_type>(g2_scalar_size, g2_window_size, G2_gen);
+                        constraint_system_type r1cs_copy(constraint_system);
+                        if (swap_AB) {
+                            r1cs_copy.swap_AB();
+                        }
 
-                        typename g1_type::value_type alpha_g1 = alpha * g1_generator;
-                        typename g1_type::value_type beta_g1 = beta * g1_generator;
-                        typename g2_type::value_type beta_g2 = beta * G2_gen;
-                        typename g1_type::value_type delta_g1 = delta * g1_generator;
-                        typename g2_type::value_type delta_g2 = delta * G2_gen;
+                        return {mapped_proving_key_type(path, std::move(r1cs_copy)), std::move(vk)};
+                    }
 
-                        typename std::vector<typename g1_type::value_type> A_query =
-                            algebra::batch_exp<g1_type, scalar_field_type>(g1_scalar_size, g1_window_size, g1_table,
-                                                                           At);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<g1_type>(A_query);
-#endif
+                    template<typename DistributionType, typename GeneratorType, typename MakeConstraintSystem>
+                    static inline auto basic_process(const constraint_system_type &constraint_system,
+                                                     const bool swap_AB,
+                                                     MakeConstraintSystem make_constraint_system,
+                                                     const bool lagrange_H_query = false) {
+                        key_scalars scalars = generate_scalars<DistributionType, GeneratorType>(
+                            constraint_system, swap_AB, lagrange_H_query);
+                        stage_profiler::timer tables_timer("fixed_base_tables");
+                        const key_bases bases(scalars);
+                        tables_timer.stop();
+
+                        typename g1_type::value_type alpha_g1 = scalars.alpha * bases.g1_generator;
+                        typename g1_type::value_type beta_g1 = scalars.beta * bases.g1_generator;
+                        typename g2_type::value_type beta_g2 = scalars.beta * bases.g2_generator;
+                        typename g1_type::value_type delta_g1 = scalars.delta * bases.g1_generator;
+                        typename g2_type::value_type delta_g2 = scalars.delta * bases.g2_generator;
+
+                        stage_profiler::timer exponentiate_timer("exponentiate",
+                                                                 scalars.At.size() + scalars.Bt.size() +
+                                                                     scalars.Ht.size() + scalars.Lt.size());
+                        typename std::vector<typename g1_type::value_type> A_query = bases.g1_batch_exp(
+                            scalar_field_type::value_type::one(), scalars.At, 0, scalars.At.size(), false);
 
                         knowledge_commitment_vector<g2_type, g1_type> B_query =
-                            kc_batch_exp<g2_type, g1_type, scalar_field_type>(
-                                scalar_field_type::value_bits, g2_window_size, g1_window_size, g2_table, g1_table,
-                                scalar_field_type::value_type::one(), scalar_field_type::value_type::one(), Bt, chunks);
+                            kc_batch_exp(bases.g2_engine, bases.g1_engine, scalar_field_type::value_type::one(),
+                                         scalar_field_type::value_type::one(), scalars.Bt);
 
-                        // NOTE: if USE_MIXED_ADDITION is defined,
-                        // kc_batch_exp will convert its output to special form internally
+                        typename std::vector<typename g1_type::value_type> H_query = bases.g1_batch_exp(
+                            scalars.Zt * scalars.delta_inverse, scalars.Ht, 0, scalars.Ht.size(), false);
 
-                        typename std::vector<typename g1_type::value_type> H_query =
-                            algebra::batch_exp_with_coeff<g1_type, scalar_field_type>(
-                                g1_scalar_size, g1_window_size, g1_table, qap.Zt * delta_inverse, Ht);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<g1_type>(H_query);
-#endif
+                        typename std::vector<typename g1_type::value_type> L_query = bases.g1_batch_exp(
+                            scalar_field_type::value_type::one(), scalars.Lt, 0, scalars.Lt.size(), false);
 
-                        typename std::vector<typename g1_type::value_type> L_query =
-                            algebra::batch_exp<g1_type, scalar_field_type>(g1_scalar_size, g1_window_size, g1_table,
-                                                                           Lt);
+                        exponentiate_timer.stop();
 
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<g1_type>(L_query);
-#endif
+                        stage_profiler::timer normalize_timer("normalize");
+                        key_normalizer<g1_type, g2_type> normalizer;
+                        normalizer.add(A_query);
+                        normalizer.add(B_query);
+                        normalizer.add(H_query);
+                        normalizer.add(L_query);
+                        normalizer.run();
+                        normalize_timer.stop();
 
+                        stage_profiler::timer pairing_timer("pairing", 1);
                         typename gt_type::value_type alpha_g1_beta_g2 = pairing_policy::pair_reduced(alpha_g1, beta_g2);
-                        typename g2_type::value_type gamma_g2 = gamma * G2_gen;
+                        pairing_timer.stop();
+                        typename g2_type::value_type gamma_g2 = scalars.gamma * bases.g2_generator;
 
-                        typename g1_type::value_type gamma_ABC_g1_0 = gamma_ABC_0 * g1_generator;
+                        accumulation_vector<g1_type> gamma_ABC_g1 = bases.gamma_ABC_g1(scalars);
 
-                        typename std::vector<typename g1_type::value_type> gamma_ABC_g1_values =
-                            algebra::batch_exp<g1_type, scalar_field_type>(g1_scalar_size, g1_window_size, g1_table,
-                                                                           gamma_ABC);
-
-                        accumulation_vector<g1_type> gamma_ABC_g1(std::move(gamma_ABC_g1_0),
-                                                                  std::move(gamma_ABC_g1_values));
+                        constraint_system_type r1cs_copy = make_constraint_system();
 
                         return std::make_tuple(std::move(alpha_g1), std::move(beta_g1), std::move(beta_g2),
                                                std::move(delta_g1), std::move(delta_g2), std::move(gamma_g2),
@@ -233,13 +462,11 @@ namespace nil {
                                                std::move(gamma_ABC_g1));
                     }
 
-                    template<typename DistributionType =
-                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
-                             typename GeneratorType = boost::random::mt19937>
-                    static inline keypair_type process(const constraint_system_type &constraint_system) {
+                    template<typename Keys>
+                    static inline keypair_type make_keypair(Keys &&keys) {
 
                         auto [alpha_g1, beta_g1, beta_g2, delta_g1, delta_g2, gamma_g2, A_query, B_query, H_query,
-                              L_query, r1cs_copy, alpha_g1_beta_g2, gamma_ABC_g1] = basic_process(constraint_system);
+                              L_query, r1cs_copy, alpha_g1_beta_g2, gamma_ABC_g1] = std::move(keys);
 
                         verification_key_type vk =
                             verification_key_type(alpha_g1_beta_g2, gamma_g2, delta_g2, gamma_ABC_g1);
@@ -257,6 +484,181 @@ namespace nil {
 
                         return {std::move(pk), std::move(vk)};
                     }
+
+                    /**
+                     * The secret randomness of the setup and the QAP evaluations derived from it, which the
+                     * queries of the keys are exponentiated with.
+                     */
+                    struct key_scalars {
+                        typename scalar_field_type::value_type alpha, beta, gamma, delta, delta_inverse, Zt;
+                        typename scalar_field_type::value_type gamma_ABC_0;
+                        std::vector<typename scalar_field_type::value_type> At, Bt, Ht, Lt, gamma_ABC;
+                        std::size_t non_zero_At, non_zero_Bt;
+                    };
+
+                    /**
+                     * The secret randomness of the setup: the evaluation point t of the QAP and the
+                     * trapdoors of the keys.
+                     */
+                    struct key_secrets {
+                        typename scalar_field_type::value_type t, alpha, beta, gamma, delta;
+                    };
+
+                    static inline void clear_scalars(key_scalars &scalars) {
+                        for (typename scalar_field_type::value_type *value :
+                             {&scalars.alpha, &scalars.beta, &scalars.gamma, &scalars.delta, &scalars.delta_inverse,
+                              &scalars.Zt, &scalars.gamma_ABC_0}) {
+                            checkpoint_type::clear(*value);
+                        }
+                        for (std::vector<typename scalar_field_type::value_type> *values :
+                             {&scalars.At, &scalars.Bt, &scalars.Ht, &scalars.Lt, &scalars.gamma_ABC}) {
+                            checkpoint_type::clear(*values);
+                        }
+                    }
+
+                    template<typename DistributionType, typename GeneratorType>
+                    static inline key_secrets generate_secrets() {
+                        key_secrets result;
+                        result.t = algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                        result.alpha = algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                        result.beta = algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                        result.gamma = algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                        result.delta = algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                        return result;
+                    }
+
+                    template<typename DistributionType, typename GeneratorType>
+                    static inline key_scalars generate_scalars(const constraint_system_type &r1cs, const bool swap_AB,
+                                                               const bool lagrange_H_query = false) {
+                        return evaluate_scalars(r1cs, swap_AB, generate_secrets<DistributionType, GeneratorType>(),
+                                                lagrange_H_query);
+                    }
+
+                    static inline key_scalars evaluate_scalars(const constraint_system_type &r1cs, const bool swap_AB,
+                                                               const key_secrets &secrets,
+                                                               const bool lagrange_H_query = false) {
+                        key_scalars result;
+
+                        const typename scalar_field_type::value_type &t = secrets.t;
+                        result.alpha = secrets.alpha;
+                        result.beta = secrets.beta;
+                        result.gamma = secrets.gamma;
+                        result.delta = secrets.delta;
+                        const typename scalar_field_type::value_type gamma_inverse = result.gamma.inversed();
+                        result.delta_inverse = result.delta.inversed();
+
+                        /* A quadratic arithmetic program evaluated at t. */
+                        stage_profiler::timer instance_timer("instance_map", r1cs.num_constraints());
+                        qap_instance_evaluation<scalar_field_type> qap =
+                            reductions::r1cs_to_qap<scalar_field_type>::instance_map_with_evaluation(r1cs, t, swap_AB);
+                        instance_timer.stop();
+
+                        result.non_zero_At = count_non_zero(qap.At, qap.num_variables + 1);
+                        result.non_zero_Bt = count_non_zero(qap.Bt, qap.num_variables + 1);
+                        result.Zt = qap.Zt;
+
+                        /* qap.{At,Bt,Ct,Ht} are now in unspecified state, but we do not use them later */
+                        result.At = std::move(qap.At);
+                        result.Bt = std::move(qap.Bt);
+                        const std::vector<typename scalar_field_type::value_type> Ct = std::move(qap.Ct);
+                        result.Ht = std::move(qap.Ht);
+
+                        const std::vector<typename scalar_field_type::value_type> &At = result.At;
+                        const std::vector<typename scalar_field_type::value_type> &Bt = result.Bt;
+                        const typename scalar_field_type::value_type &alpha = result.alpha;
+                        const typename scalar_field_type::value_type &beta = result.beta;
+
+                        /* The gamma inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * gamma^{-1}.
+                         */
+                        result.gamma_ABC_0 = (beta * At[0] + alpha * Bt[0] + Ct[0]) * gamma_inverse;
+                        result.gamma_ABC.resize(qap.num_inputs);
+                        executor::current().parallel_for(qap.num_inputs, [&](const std::size_t i) {
+                            result.gamma_ABC[i] = (beta * At[i + 1] + alpha * Bt[i + 1] + Ct[i + 1]) * gamma_inverse;
+                        });
+
+                        /* The delta inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * delta^{-1}.
+                         */
+                        const std::size_t Lt_offset = qap.num_inputs + 1;
+                        result.Lt.resize(qap.num_variables - qap.num_inputs);
+                        executor::current().parallel_for(result.Lt.size(), [&](const std::size_t i) {
+                            result.Lt[i] = (beta * At[Lt_offset + i] + alpha * Bt[Lt_offset + i] + Ct[Lt_offset + i]) *
+                                           result.delta_inverse;
+                        });
+
+                        /**
+                         * Note that H for Groth's proof system is degree d-2, but the QAP
+                         * reduction returns coefficients for degree d polynomial H (in
+                         * style of PGHR-type proof systems)
+                         */
+                        result.Ht.resize(result.Ht.size() - 2);
+
+                        /* in the Lagrange basis of the coset g*S, H(t) = sum_j H(g*x_j) * L_j(t / g) */
+                        if (lagrange_H_query) {
+                            const typename scalar_field_type::value_type g(
+                                fields::arithmetic_params<scalar_field_type>::multiplicative_generator);
+                            result.Ht = qap.domain->evaluate_all_lagrange_polynomials(t * g.inversed());
+                        }
+
+                        return result;
+                    }
+
+                    static inline std::size_t count_non_zero(const std::vector<typename scalar_field_type::value_type> &v,
+                                                             const std::size_t n) {
+                        const std::size_t num_blocks = executor::current().concurrency();
+                        const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+
+                        std::vector<std::size_t> counts(num_blocks, 0);
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            const std::size_t end = std::min(n, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                counts[block] += v[i].is_zero() ? 0 : 1;
+                            }
+                        });
+
+                        return std::accumulate(counts.begin(), counts.end(), std::size_t(0));
+                    }
+
+                    /**
+                     * The random generators of G1 and G2 together with their fixed-base engines.
+                     */
+                    struct key_bases {
+                        typename g1_type::value_type g1_generator;
+                        fixed_base_engine<g1_type, scalar_field_type> g1_engine;
+
+                        typename g2_type::value_type g2_generator;
+                        fixed_base_engine<g2_type, scalar_field_type> g2_engine;
+
+                        explicit key_bases(const key_scalars &scalars) :
+                            key_bases(scalars, algebra::random_element<g1_type>(), algebra::random_element<g2_type>()) {
+                        }
+
+                        key_bases(const key_scalars &scalars, const typename g1_type::value_type &g1_generator,
+                                  const typename g2_type::value_type &g2_generator) :
+                            g1_generator(g1_generator),
+                            g1_engine(g1_generator, scalars.non_zero_At + scalars.non_zero_Bt + scalars.Lt.size() +
+                                                        scalars.gamma_ABC.size()),
+                            g2_generator(g2_generator),
+                            g2_engine(g2_generator, scalars.non_zero_Bt) {
+                        }
+
+                        /**
+                         * (coeff * v[i]) * g1_generator for i in [first, last), split across the current
+                         * executor. The streamed queries ask for special form at once; the queries of a key
+                         * held in memory are normalized together afterwards.
+                         */
+                        std::vector<typename g1_type::value_type>
+                            g1_batch_exp(const typename scalar_field_type::value_type &coeff,
+                                         const std::vector<typename scalar_field_type::value_type> &v,
+                                         const std::size_t first, const std::size_t last,
+                                         const bool special_form) const {
+                            return g1_engine.batch_exp(coeff, v, first, last, special_form);
+                        }
+
+                        accumulation_vector<g1_type> gamma_ABC_g1(const key_scalars &scalars) const {
+                            return accumulation_vector<g1_type>(scalars.gamma_ABC_0 * g1_generator,
+                                                                g1_engine.batch_exp(scalars.gamma_ABC));
+                        }
+                    };
                 };
             }    // namespace snark
         }        // namespace zk
@@ -0,0 +1,302 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the checkpoint of a streaming R1CS GG-ppzkSNARK key generation.
+//
+// The streaming generator writes the proving key file block after block. With a
+// checkpoint file, it records after every block the secret randomness of the setup, the
+// generators of G1 and G2 and the position of the next block; a generation interrupted
+// at any point is then resumed from that block by running the generator again with the
+// same constraint system, key path and checkpoint path. The checkpoint is only resumed
+// for the constraint system it was written for, identified by its content digest (see
+// r1cs_digest.hpp), by the build that wrote it, since it holds the native representation
+// of the elements, and with the key file it was written along, identified by the digest of
+// its header and points. A checkpoint whose key file is missing or belongs to another
+// generation starts a new generation.
+//
+// The checkpoint holds the toxic waste of the setup. It is created readable by its owner
+// only, replaced atomically and durably, and overwritten with zeros before it is removed
+// at the end of the generation; it should still live on storage no one else can read, and
+// a checkpoint left by a generation which is abandoned must be erased like the key would be.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_GENERATOR_CHECKPOINT_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_GENERATOR_CHECKPOINT_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/hash/sha2.hpp>
+
+#include <nil/crypto3/zk/snark/durable_file.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_digest.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_generator_checkpoint {
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename scalar_field_type::value_type scalar_value_type;
+                    typedef typename CurveType::g1_type::value_type g1_value_type;
+                    typedef typename CurveType::g2_type::value_type g2_value_type;
+
+                    static constexpr const std::uint64_t magic = 0x4b43363147474e5aULL;    // "ZNGG16CK"
+                    static constexpr const std::uint64_t version = 2;
+                    static constexpr const std::size_t digest_size = 32;
+
+                public:
+                    typedef hashes::sha2<256> hash_type;
+                    typedef typename hash_type::digest_type digest_type;
+
+                    /* the query sections of the proving key, in the order the generator writes them */
+                    enum section_type : std::uint64_t {
+                        A_query_section,
+                        B_query_section,
+                        H_query_section,
+                        L_query_section,
+                    };
+
+                    /**
+                     * What a generation needs to resume: the randomness it was started with, and the
+                     * next block of the current section, the blocks before it being written. B_query
+                     * has the stored entries of the completed blocks at [0, B_query_position). The
+                     * key file is the one whose header and points have key_digest, see
+                     * r1cs_gg_ppzksnark_mapped_proving_key::prefix_digest.
+                     */
+                    struct state_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t scalar_value_size;
+                        std::uint64_t g1_value_size;
+                        std::uint64_t g2_value_size;
+                        std::uint8_t constraint_system_digest[digest_size];
+                        std::uint8_t key_digest[digest_size];
+
+                        scalar_value_type t, alpha, beta, gamma, delta;
+                        g1_value_type g1_generator;
+                        g2_value_type g2_generator;
+
+                        std::uint64_t section;
+                        std::uint64_t next;
+                        std::uint64_t B_query_position;
+                    };
+
+                    static_assert(std::is_trivially_copyable<state_type>::value,
+                                  "the checkpoint state must be trivially copyable to be stored");
+
+                    explicit r1cs_gg_ppzksnark_generator_checkpoint(const std::string &path) : path(path) {
+                    }
+
+                    /**
+                     * The digest the checkpoints of constraint_system are identified by.
+                     */
+                    template<typename ConstraintSystem>
+                    static digest_type digest(const ConstraintSystem &constraint_system) {
+                        return r1cs_constraint_system_digest<hash_type>(constraint_system);
+                    }
+
+                    /**
+                     * A fresh state of the generation of the constraint system of digest
+                     * constraint_system_digest, positioned at the start of A_query.
+                     */
+                    static state_type make_state(const digest_type &constraint_system_digest) {
+                        BOOST_ASSERT(constraint_system_digest.size() == digest_size);
+
+                        state_type state;
+                        clear(state);
+                        state.magic = magic;
+                        state.version = version;
+                        state.scalar_value_size = sizeof(scalar_value_type);
+                        state.g1_value_size = sizeof(g1_value_type);
+                        state.g2_value_size = sizeof(g2_value_type);
+                        std::copy(constraint_system_digest.begin(), constraint_system_digest.end(),
+                                  state.constraint_system_digest);
+                        state.section = A_query_section;
+                        return state;
+                    }
+
+                    /**
+                     * Reads the checkpoint into state. Returns false, leaving state unchanged, when
+                     * there is no checkpoint, or when it was written for another constraint system or
+                     * by another build.
+                     */
+                    bool load(const digest_type &constraint_system_digest, state_type &state) const {
+                        BOOST_ASSERT(constraint_system_digest.size() == digest_size);
+
+                        std::ifstream in(path, std::ios::binary);
+                        state_type stored;
+                        if (!in.read(reinterpret_cast<char *>(&stored), sizeof(stored))) {
+                            return false;
+                        }
+
+                        const bool compatible =
+                            stored.magic == magic && stored.version == version &&
+                            stored.scalar_value_size == sizeof(scalar_value_type) &&
+                            stored.g1_value_size == sizeof(g1_value_type) &&
+                            stored.g2_value_size == sizeof(g2_value_type) && stored.section <= L_query_section &&
+                            std::equal(constraint_system_digest.begin(), constraint_system_digest.end(),
+                                       stored.constraint_system_digest);
+                        if (compatible) {
+                            state = stored;
+                        }
+                        clear(stored);
+                        return compatible;
+                    }
+
+                    /**
+                     * Replaces the checkpoint by state. The new checkpoint is made durable under a
+                     * temporary name first and renamed over the old one, the rename being made
+                     * durable too, so a crash leaves either.
+                     */
+                    void save(const state_type &state) const {
+                        const std::string temporary_path = path + ".tmp";
+                        const int fd = ::open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+                        if (fd < 0) {
+                            throw std::runtime_error("r1cs_gg_ppzksnark_generator_checkpoint: cannot write " +
+                                                     temporary_path);
+                        }
+                        const bool written = ::fchmod(fd, S_IRUSR | S_IWUSR) == 0 &&
+                                             write_all(fd, &state, sizeof(state)) && ::fsync(fd) == 0;
+                        ::close(fd);
+                        if (!written || !durable_rename(temporary_path, path)) {
+                            ::unlink(temporary_path.c_str());
+                            throw std::runtime_error("r1cs_gg_ppzksnark_generator_checkpoint: cannot write " +
+                                                     path);
+                        }
+                    }
+
+                    /**
+                     * Overwrites the checkpoint with zeros and removes it. A missing checkpoint is not
+                     * an error.
+                     */
+                    void erase() const {
+                        const int fd = ::open(path.c_str(), O_WRONLY);
+                        if (fd >= 0) {
+                            state_type zeros;
+                            clear(zeros);
+                            const bool overwritten = write_all(fd, &zeros, sizeof(zeros)) && ::fsync(fd) == 0;
+                            ::close(fd);
+                            if (!overwritten) {
+                                throw std::runtime_error("r1cs_gg_ppzksnark_generator_checkpoint: cannot erase " +
+                                                         path);
+                            }
+                        }
+                        if (::unlink(path.c_str()) != 0 && errno != ENOENT) {
+                            throw std::runtime_error("r1cs_gg_ppzksnark_generator_checkpoint: cannot remove " + path);
+                        }
+                    }
+
+                    /**
+                     * Overwrites value, such as a state or a secret scalar, with zeros, through a volatile
+                     * pointer so the stores to a value going out of scope are not elided.
+                     */
+                    template<typename T>
+                    static void clear(T &value) {
+                        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be cleared");
+                        volatile std::uint8_t *bytes = reinterpret_cast<volatile std::uint8_t *>(&value);
+                        for (std::size_t i = 0; i < sizeof(T); ++i) {
+                            bytes[i] = 0;
+                        }
+                    }
+
+                    template<typename T>
+                    static void clear(std::vector<T> &values) {
+                        for (T &value : values) {
+                            clear(value);
+                        }
+                    }
+
+                    /**
+                     * Clears the values it is given when it goes out of scope, an exception unwinding it
+                     * included.
+                     */
+                    template<typename Function>
+                    class guard {
+                    public:
+                        explicit guard(Function clear_values) : clear_values(std::move(clear_values)) {
+                        }
+
+                        guard(const guard &) = delete;
+                        guard &operator=(const guard &) = delete;
+
+                        ~guard() {
+                            clear_values();
+                        }
+
+                    private:
+                        Function clear_values;
+                    };
+
+                    template<typename Function>
+                    static guard<Function> make_guard(Function clear_values) {
+                        return guard<Function>(std::move(clear_values));
+                    }
+
+                    const std::string &file_path() const {
+                        return path;
+                    }
+
+                private:
+                    static bool write_all(const int fd, const void *data, std::size_t size) {
+                        const char *bytes = static_cast<const char *>(data);
+                        while (size) {
+                            const ssize_t written = ::write(fd, bytes, size);
+                            if (written < 0 && errno == EINTR) {
+                                continue;
+                            }
+                            if (written <= 0) {
+                                return false;
+                            }
+                            bytes += written;
+                            size -= static_cast<std::size_t>(written);
+                        }
+                        return true;
+                    }
+
+                    std::string path;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_GENERATOR_CHECKPOINT_HPP
@@ -0,0 +1,308 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the incremental R1CS GG-ppzkSNARK prover, updating the previous proof of a circuit.
+//
+// When consecutive proofs for the same circuit differ in a small part of the witness, as
+// the states of a channel do, the assignment-only multi-exponentiations need not be redone.
+// Since sum_i a'_i * Q_i = sum_i a_i * Q_i + sum_{i : a'_i != a_i} (a'_i - a_i) * Q_i, the
+// incremental prover keeps the evaluations of A_query, B_query and L_query together with
+// their assignment in an incremental state and updates them by multi-exponentiations over
+// the changed variables only:
+//
+//     r1cs_gg_ppzksnark_incremental_state<CurveType> state;
+//     proof_1 = r1cs_gg_ppzksnark_incremental_prover<CurveType>::process(pk, primary_1, auxiliary_1, state);
+//     proof_2 = r1cs_gg_ppzksnark_incremental_prover<CurveType>::process(pk, primary_2, auxiliary_2, state);
+//
+// H does not depend linearly on the assignment, so the witness map and the H_query
+// multi-exponentiation are redone for every proof, and every proof is randomized with fresh
+// r and s. A state records the proving key of its last proof, and a proof under another key
+// starts over from scratch. A proof that throws leaves the state as it was before it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_INCREMENTAL_PROVER_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_INCREMENTAL_PROVER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_const_padded_assignment.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/prover.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * The assignment of the last proof of an incremental prover, with the evaluations of the
+                 * assignment-only queries against it and the reduction buffers reused by the next proof.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_incremental_state {
+                    typedef CurveType curve_type;
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename r1cs_gg_ppzksnark_prover<CurveType>::proving_key_type proving_key_type;
+
+                    bool initialized = false;
+                    r1cs_variable_assignment<scalar_field_type> full_variable_assignment;
+
+                    typename CurveType::g1_type::value_type evaluation_At;
+                    typename knowledge_commitment<typename CurveType::g2_type,
+                                                  typename CurveType::g1_type>::value_type evaluation_Bt;
+                    typename CurveType::g1_type::value_type evaluation_Lt;
+
+                    /*
+                     * The proving key of the last proof: its address, its delta_g1, which is drawn afresh by
+                     * every setup, and the sizes of its constraint system.
+                     */
+                    const proving_key_type *key = nullptr;
+                    typename CurveType::g1_type::value_type key_delta_g1;
+                    std::size_t key_num_constraints = 0;
+                    std::size_t key_num_variables = 0;
+
+                    std::shared_ptr<const reductions::reduction_context<scalar_field_type>> context;
+                    typename reductions::r1cs_to_qap<scalar_field_type>::workspace scratch;
+
+                    /* Whether the last proof of the state was made with proving_key. */
+                    bool belongs_to(const proving_key_type &proving_key) const {
+                        return initialized && key == &proving_key && key_delta_g1 == proving_key.delta_g1 &&
+                               key_num_constraints == proving_key.constraint_system.num_constraints() &&
+                               key_num_variables == proving_key.constraint_system.num_variables();
+                    }
+
+                    /* Forgets the last proof and its key, so the next one is computed from scratch. */
+                    void reset() {
+                        initialized = false;
+                        full_variable_assignment.clear();
+                        key = nullptr;
+                        context.reset();
+                    }
+                };
+
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_incremental_prover {
+                    typedef r1cs_gg_ppzksnark_prover<CurveType> prover_type;
+
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
+                public:
+                    typedef typename prover_type::primary_input_type primary_input_type;
+                    typedef typename prover_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename prover_type::proving_key_type proving_key_type;
+                    typedef typename prover_type::proof_type proof_type;
+                    typedef r1cs_gg_ppzksnark_incremental_state<CurveType> state_type;
+
+                    /**
+                     * Proves (primary_input, auxiliary_input), updating the evaluations of state by the
+                     * variables that changed since its last proof, or computing them in full for a state
+                     * with no proof under proving_key of the same number of variables yet. The new
+                     * evaluations are computed aside and swapped into state once the proof is complete, so
+                     * an exception leaves state at its last proof.
+                     */
+                    static inline proof_type process(const proving_key_type &proving_key,
+                                                     const primary_input_type &primary_input,
+                                                     const auxiliary_input_type &auxiliary_input,
+                                                     state_type &state) {
+
+                        if (primary_input.size() != proving_key.constraint_system.num_inputs() ||
+                            primary_input.size() + auxiliary_input.size() !=
+                                proving_key.constraint_system.num_variables()) {
+                            throw std::invalid_argument(
+                                "r1cs_gg_ppzksnark_incremental_prover: the assignment does not fit the proving key");
+                        }
+                        BOOST_ASSERT(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
+
+                        r1cs_variable_assignment<scalar_field_type> full_variable_assignment = primary_input;
+                        full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(),
+                                                        auxiliary_input.end());
+                        const std::size_t num_variables = full_variable_assignment.size();
+                        const std::size_t num_inputs = primary_input.size();
+
+                        const bool same_key = state.belongs_to(proving_key);
+                        std::shared_ptr<const reductions::reduction_context<scalar_field_type>> context =
+                            same_key && state.context ?
+                                state.context :
+                                reductions::r1cs_to_qap<scalar_field_type>::shared_context(
+                                    proving_key.constraint_system);
+
+                        /* the workspace only holds buffers, so a throwing witness map leaves nothing to undo */
+                        stage_profiler::timer witness_timer("witness_map",
+                                                            proving_key.constraint_system.num_constraints());
+                        const qap_witness<scalar_field_type> qap_wit =
+                            reductions::r1cs_to_qap<scalar_field_type>::witness_map(
+                                proving_key.constraint_system, primary_input, auxiliary_input, *context,
+                                state.scratch);
+                        witness_timer.stop();
+
+                        BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree - 1].is_zero());
+                        BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree].is_zero());
+
+                        const std::size_t chunks = executor::current().concurrency();
+                        evaluations_type evaluations;
+                        if (!same_key || state.full_variable_assignment.size() != num_variables) {
+                            evaluate(proving_key, full_variable_assignment, num_inputs, evaluations);
+                        } else {
+                            evaluations = {state.evaluation_At, state.evaluation_Bt, state.evaluation_Lt};
+                            update(proving_key, full_variable_assignment, num_inputs, state, evaluations);
+                        }
+
+                        stage_profiler::timer multiexp_H_timer("multiexp_H", qap_wit.degree - 1);
+                        operation_counter::add(operation_counter::g1_exp_term, qap_wit.degree - 1);
+                        const typename g1_type::value_type evaluation_Ht = dispatch_multiexp<multiexp_method_auto>(
+                            proving_key.H_query.begin(), proving_key.H_query.begin() + (qap_wit.degree - 1),
+                            qap_wit.coefficients_for_H.begin(),
+                            qap_wit.coefficients_for_H.begin() + (qap_wit.degree - 1), chunks);
+                        multiexp_H_timer.stop();
+
+                        proof_type proof = prover_type::make_proof(proving_key, evaluations.At, evaluations.Bt,
+                                                                   evaluation_Ht, evaluations.Lt);
+
+                        /* nothing below throws: the proof is complete and state moves to it as a whole */
+                        using std::swap;
+                        swap(state.evaluation_At, evaluations.At);
+                        swap(state.evaluation_Bt, evaluations.Bt);
+                        swap(state.evaluation_Lt, evaluations.Lt);
+                        state.full_variable_assignment.swap(full_variable_assignment);
+                        state.context.swap(context);
+                        state.key = &proving_key;
+                        state.key_delta_g1 = proving_key.delta_g1;
+                        state.key_num_constraints = proving_key.constraint_system.num_constraints();
+                        state.key_num_variables = proving_key.constraint_system.num_variables();
+                        state.initialized = true;
+                        return proof;
+                    }
+
+                private:
+                    /* The evaluations of a proof in progress, swapped into the state once it is complete. */
+                    struct evaluations_type {
+                        typename g1_type::value_type At;
+                        typename knowledge_commitment<g2_type, g1_type>::value_type Bt;
+                        typename g1_type::value_type Lt;
+                    };
+
+                    /* The assignment-only evaluations in full. */
+                    static inline void evaluate(const proving_key_type &proving_key,
+                                                const r1cs_variable_assignment<scalar_field_type> &assignment,
+                                                const std::size_t num_inputs, evaluations_type &evaluations) {
+                        const std::size_t num_variables = assignment.size();
+                        const std::size_t chunks = executor::current().concurrency();
+
+                        stage_profiler::timer multiexp_timer("multiexp", num_variables + 1);
+                        operation_counter::add(operation_counter::g1_exp_term,
+                                               2 * (num_variables + 1) + (num_variables - num_inputs));
+                        operation_counter::add(operation_counter::g2_exp_term, num_variables + 1);
+
+                        const r1cs_const_padded_assignment<scalar_field_type> const_padded_assignment(assignment);
+                        evaluations.At = dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            proving_key.A_query.begin(), proving_key.A_query.begin() + num_variables + 1,
+                            const_padded_assignment.begin(), const_padded_assignment.begin() + num_variables + 1,
+                            chunks);
+                        evaluations.Bt = kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            proving_key.B_query, 0, num_variables + 1, const_padded_assignment.begin(),
+                            const_padded_assignment.begin() + num_variables + 1, chunks);
+                        evaluations.Lt = dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            proving_key.L_query.begin(), proving_key.L_query.begin() + (num_variables - num_inputs),
+                            assignment.begin() + num_inputs, assignment.end(), chunks);
+                    }
+
+                    /**
+                     * Adds (a'_i - a_i) * Q_i to evaluations, a copy of those of state, for every variable i
+                     * whose value a'_i in assignment differs from its value a_i in the last proof.
+                     */
+                    static inline void update(const proving_key_type &proving_key,
+                                              const r1cs_variable_assignment<scalar_field_type> &assignment,
+                                              const std::size_t num_inputs, const state_type &state,
+                                              evaluations_type &evaluations) {
+                        const std::size_t chunks = executor::current().concurrency();
+                        const std::vector<std::size_t> &B_indices = proving_key.B_query.indices;
+
+                        std::vector<typename scalar_field_type::value_type> scalars_A, scalars_B, scalars_L;
+                        std::vector<typename g1_type::value_type> bases_A, bases_B_h, bases_L;
+                        std::vector<typename g2_type::value_type> bases_B_g;
+                        for (std::size_t i = 0; i < assignment.size(); ++i) {
+                            if (assignment[i] == state.full_variable_assignment[i]) {
+                                continue;
+                            }
+                            const typename scalar_field_type::value_type difference =
+                                assignment[i] - state.full_variable_assignment[i];
+
+                            /* A_query and B_query are indexed by the constant-padded assignment */
+                            bases_A.emplace_back(proving_key.A_query[i + 1]);
+                            scalars_A.emplace_back(difference);
+
+                            const auto B_it = std::lower_bound(B_indices.begin(), B_indices.end(), i + 1);
+                            if (B_it != B_indices.end() && *B_it == i + 1) {
+                                bases_B_g.emplace_back(proving_key.B_query.values[B_it - B_indices.begin()].g);
+                                bases_B_h.emplace_back(proving_key.B_query.values[B_it - B_indices.begin()].h);
+                                scalars_B.emplace_back(difference);
+                            }
+
+                            if (i >= num_inputs) {
+                                bases_L.emplace_back(proving_key.L_query[i - num_inputs]);
+                                scalars_L.emplace_back(difference);
+                            }
+                        }
+
+                        stage_profiler::timer multiexp_timer("multiexp", scalars_A.size());
+                        operation_counter::add(operation_counter::g1_exp_term,
+                                               scalars_A.size() + scalars_B.size() + scalars_L.size());
+                        operation_counter::add(operation_counter::g2_exp_term, scalars_B.size());
+
+                        evaluations.At = evaluations.At + dispatch_multiexp<multiexp_method_auto>(
+                                                              bases_A.begin(), bases_A.end(), scalars_A.begin(),
+                                                              scalars_A.end(), chunks);
+                        evaluations.Bt.g = evaluations.Bt.g + dispatch_multiexp<multiexp_method_auto>(
+                                                                  bases_B_g.begin(), bases_B_g.end(),
+                                                                  scalars_B.begin(), scalars_B.end(), chunks);
+                        evaluations.Bt.h = evaluations.Bt.h + dispatch_multiexp<multiexp_method_auto>(
+                                                                  bases_B_h.begin(), bases_B_h.end(),
+                                                                  scalars_B.begin(), scalars_B.end(), chunks);
+                        evaluations.Lt = evaluations.Lt + dispatch_multiexp<multiexp_method_auto>(
+                                                              bases_L.begin(), bases_L.end(), scalars_L.begin(),
+                                                              scalars_L.end(), chunks);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_INCREMENTAL_PROVER_HPP
@@ -0,0 +1,333 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the aggregation service collecting the proofs of many provers.
+//
+// Prover threads submit their finished proofs, with their primary inputs, to the service
+// without taking any lock: a submission is a push to a lock-free queue (see
+// concurrent_queue.hpp), plus a wake-up of the collector only when it is asleep. The
+// collector appends every proof to an incremental aggregator as it arrives, running its
+// Miller loops then, and seals the batch once it holds max_batch_size proofs or once
+// max_delay has passed since its first proof. A sealed batch is finalized, its GIPA rounds
+// included, on a thread of its own while the collector fills the next batch:
+//
+//     r1cs_gg_ppzksnark_ipp2_aggregation_service<curve_type> service(prepared_srs, tr_include);
+//     std::future<submission_type> submitted = service.submit(proof, primary_input);
+//     const submission_type &submission = submitted.get();
+//     verify_aggregate_proof(..., submission.batch->public_inputs, submission.batch->aggregate, ...);
+//
+// A batch of fewer proofs than the SRS is specialized for is padded with copies of its
+// last proof, and its public inputs with as many copies of the last primary input. At most
+// one sealed batch waits behind the one being finalized, the collector blocking on the
+// next one until then. The destructor aggregates the proofs already submitted.
+//
+// A single bad proof would spoil the aggregate of its whole batch, so submit validates
+// every proof on the thread of its prover first, see proof_validation.hpp: a proof with an
+// element off its curve, outside its prime order subgroup or at infinity fails its future
+// at once and never enters a batch. When appending a proof still throws, the open batch
+// is failed, with the proof, and the collector goes on with a new one.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATION_SERVICE_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATION_SERVICE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/concurrent_queue.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof_validation.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /// When the collector of an aggregation service seals its batch.
+                struct r1cs_gg_ppzksnark_ipp2_aggregation_options {
+                    typedef std::chrono::steady_clock clock_type;
+
+                    /// Number of proofs of a full batch, at most the capacity of the SRS; 0 for the capacity.
+                    std::size_t max_batch_size = 0;
+                    /// Time a batch is kept open after its first proof.
+                    clock_type::duration max_delay = std::chrono::milliseconds(100);
+                };
+
+                /// Aggregates the proofs submitted by any number of threads by batches of at most the
+                /// capacity of the proving SRS, which must outlive the service, as must the prepared SRS
+                /// whose vkey lines it uses.
+                template<typename CurveType, typename Hash = hashes::sha2<256>>
+                class r1cs_gg_ppzksnark_ipp2_aggregation_service {
+                    typedef r1cs_gg_ppzksnark_ipp2_aggregator<CurveType, Hash> aggregator_type;
+                    typedef r1cs_gg_ppzksnark_ipp2_aggregation_options::clock_type clock_type;
+
+                public:
+                    typedef typename aggregator_type::proving_srs_type proving_srs_type;
+                    typedef typename aggregator_type::prepared_proving_srs_type prepared_proving_srs_type;
+                    typedef typename aggregator_type::proof_type proof_type;
+                    typedef typename aggregator_type::aggregate_proof_type aggregate_proof_type;
+                    typedef std::vector<typename CurveType::scalar_field_type::value_type> primary_input_type;
+
+                    /// An aggregate and the primary inputs to verify it with, padding included.
+                    struct batch_type {
+                        aggregate_proof_type aggregate;
+                        std::vector<primary_input_type> public_inputs;
+                    };
+
+                    /// The batch a submitted proof went into, at position in its public inputs.
+                    struct submission_type {
+                        std::shared_ptr<const batch_type> batch;
+                        std::size_t position;
+                    };
+
+                    /// Starts the collector and the finalizer, which runs on finalize_executor. tr_include is
+                    /// the transcript inclusion of every aggregate, see aggregate_proofs.
+                    r1cs_gg_ppzksnark_ipp2_aggregation_service(
+                        const proving_srs_type &srs, std::vector<std::uint8_t> tr_include,
+                        const r1cs_gg_ppzksnark_ipp2_aggregation_options &options = {},
+                        const executor &finalize_executor = executor::current()) :
+                        r1cs_gg_ppzksnark_ipp2_aggregation_service(&srs, nullptr, std::move(tr_include), options,
+                                                                   finalize_executor) {
+                    }
+
+                    r1cs_gg_ppzksnark_ipp2_aggregation_service(
+                        const prepared_proving_srs_type &prepared_srs, std::vector<std::uint8_t> tr_include,
+                        const r1cs_gg_ppzksnark_ipp2_aggregation_options &options = {},
+                        const executor &finalize_executor = executor::current()) :
+                        r1cs_gg_ppzksnark_ipp2_aggregation_service(&prepared_srs.srs, &prepared_srs,
+                                                                   std::move(tr_include), options,
+                                                                   finalize_executor) {
+                    }
+
+                    r1cs_gg_ppzksnark_ipp2_aggregation_service(const r1cs_gg_ppzksnark_ipp2_aggregation_service &) =
+                        delete;
+                    r1cs_gg_ppzksnark_ipp2_aggregation_service &
+                        operator=(const r1cs_gg_ppzksnark_ipp2_aggregation_service &) = delete;
+
+                    /// Aggregates the proofs submitted so far, then stops the threads.
+                    ~r1cs_gg_ppzksnark_ipp2_aggregation_service() {
+                        closing.store(true);
+                        {
+                            std::lock_guard<std::mutex> lock(wake_mutex);
+                            wake.notify_one();
+                        }
+                        collector_thread.join();
+                        finalizer_thread.join();
+                    }
+
+                    /// Hands proof over to the collector without blocking, once validated; any thread. The
+                    /// future of an invalid proof holds a std::runtime_error.
+                    std::future<submission_type> submit(proof_type proof, primary_input_type primary_input) {
+                        BOOST_ASSERT(!closing.load(std::memory_order_relaxed));
+
+                        submission_request request;
+                        request.proof = std::move(proof);
+                        request.primary_input = std::move(primary_input);
+                        std::future<submission_type> result = request.submission.get_future();
+                        if (request.proof.g_A.is_zero() || request.proof.g_B.is_zero() ||
+                            request.proof.g_C.is_zero() ||
+                            !validate_proofs<CurveType>(&request.proof, &request.proof + 1).empty()) {
+                            request.submission.set_exception(std::make_exception_ptr(std::runtime_error(
+                                "r1cs_gg_ppzksnark_ipp2_aggregation_service: invalid proof")));
+                            return result;
+                        }
+                        submissions.push(std::move(request));
+                        // pairs with the fence of the collector going to sleep: either it sees the
+                        // submission or this sees it asleep
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        if (sleeping.exchange(false)) {
+                            std::lock_guard<std::mutex> lock(wake_mutex);
+                            wake.notify_one();
+                        }
+                        return result;
+                    }
+
+                    /// Number of proofs of a full batch.
+                    std::size_t max_batch_size() const {
+                        return batch_size;
+                    }
+
+                private:
+                    struct submission_request {
+                        proof_type proof;
+                        primary_input_type primary_input;
+                        std::promise<submission_type> submission;
+                    };
+
+                    struct open_batch {
+                        std::unique_ptr<aggregator_type> aggregator;
+                        std::vector<primary_input_type> public_inputs;
+                        std::vector<std::promise<submission_type>> submissions;
+                        clock_type::time_point deadline;
+                    };
+
+                    r1cs_gg_ppzksnark_ipp2_aggregation_service(
+                        const proving_srs_type *srs, const prepared_proving_srs_type *prepared_srs,
+                        std::vector<std::uint8_t> &&tr_include,
+                        const r1cs_gg_ppzksnark_ipp2_aggregation_options &options,
+                        const executor &finalize_executor) :
+                        srs(srs), prepared_srs(prepared_srs), tr_include(std::move(tr_include)),
+                        batch_size(options.max_batch_size ? options.max_batch_size : srs->vkey.a.size()),
+                        max_delay(options.max_delay), finalize_executor(finalize_executor), sealed(1),
+                        closing(false), sleeping(false) {
+                        BOOST_ASSERT(batch_size >= 1 && batch_size <= srs->vkey.a.size());
+
+                        collector_thread = std::thread([this] { collect(); });
+                        finalizer_thread = std::thread([this] { finalize(); });
+                    }
+
+                    std::unique_ptr<aggregator_type> make_aggregator() const {
+                        return std::unique_ptr<aggregator_type>(prepared_srs ? new aggregator_type(*prepared_srs) :
+                                                                               new aggregator_type(*srs));
+                    }
+
+                    void seal(std::unique_ptr<open_batch> &batch) {
+                        const std::size_t capacity = batch->aggregator->capacity();
+                        while (batch->public_inputs.size() < capacity) {
+                            const primary_input_type last = batch->public_inputs.back();
+                            batch->public_inputs.push_back(last);
+                        }
+                        sealed.push(std::move(batch));
+                    }
+
+                    /// Appends every submission to the open batch, sealing it when full or late, and sleeps
+                    /// while there is nothing to do.
+                    void collect() {
+                        std::unique_ptr<open_batch> batch;
+                        submission_request request;
+                        for (;;) {
+                            if (submissions.try_pop(request)) {
+                                try {
+                                    if (!batch) {
+                                        batch.reset(new open_batch());
+                                        batch->aggregator = make_aggregator();
+                                        batch->deadline = clock_type::now() + max_delay;
+                                    }
+                                    batch->aggregator->append(request.proof);
+                                } catch (...) {
+                                    // the aggregator may be left halfway through the proof
+                                    request.submission.set_exception(std::current_exception());
+                                    if (batch) {
+                                        for (std::promise<submission_type> &submission : batch->submissions) {
+                                            submission.set_exception(std::current_exception());
+                                        }
+                                        batch.reset();
+                                    }
+                                    continue;
+                                }
+                                batch->public_inputs.emplace_back(std::move(request.primary_input));
+                                batch->submissions.emplace_back(std::move(request.submission));
+                                if (batch->submissions.size() == batch_size) {
+                                    seal(batch);
+                                }
+                                continue;
+                            }
+                            if (batch && clock_type::now() >= batch->deadline) {
+                                seal(batch);
+                                continue;
+                            }
+                            if (closing.load()) {
+                                // a submission pushed before closing may still be linking its node in
+                                if (submissions.empty()) {
+                                    break;
+                                }
+                                continue;
+                            }
+
+                            std::unique_lock<std::mutex> lock(wake_mutex);
+                            sleeping.store(true);
+                            std::atomic_thread_fence(std::memory_order_seq_cst);
+                            if (submissions.empty() && !closing.load()) {
+                                if (batch) {
+                                    wake.wait_until(lock, batch->deadline);
+                                } else {
+                                    wake.wait(lock);
+                                }
+                            }
+                            sleeping.store(false);
+                        }
+                        if (batch) {
+                            seal(batch);
+                        }
+                        sealed.close();
+                    }
+
+                    void finalize() {
+                        executor::scope guard(finalize_executor);
+
+                        std::unique_ptr<open_batch> batch;
+                        while (sealed.pop(batch)) {
+                            try {
+                                const std::shared_ptr<const batch_type> result = std::make_shared<batch_type>(
+                                    batch_type {batch->aggregator->finalize(tr_include.begin(), tr_include.end()),
+                                                std::move(batch->public_inputs)});
+                                for (std::size_t i = 0; i < batch->submissions.size(); ++i) {
+                                    batch->submissions[i].set_value(submission_type {result, i});
+                                }
+                            } catch (...) {
+                                for (std::promise<submission_type> &submission : batch->submissions) {
+                                    submission.set_exception(std::current_exception());
+                                }
+                            }
+                        }
+                    }
+
+                    const proving_srs_type *const srs;
+                    const prepared_proving_srs_type *const prepared_srs;
+                    const std::vector<std::uint8_t> tr_include;
+                    const std::size_t batch_size;
+                    const clock_type::duration max_delay;
+                    const executor finalize_executor;
+
+                    detail::mpsc_queue<submission_request> submissions;
+                    detail::bounded_queue<std::unique_ptr<open_batch>> sealed;
+
+                    std::atomic<bool> closing;
+                    /// whether the collector is asleep, or about to be, on wake
+                    std::atomic<bool> sleeping;
+                    std::mutex wake_mutex;
+                    std::condition_variable wake;
+
+                    std::thread collector_thread, finalizer_thread;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATION_SERVICE_HPP
@@ -0,0 +1,224 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the per-request trace of the aggregation and its verification.
+//
+// An aggregation runs through deep template call trees: the GIPA rounds, each with
+// its pairing products, multi-exponentiations and folds, the KZG openings of the
+// commitment keys and the transcript. A trace installed for one call records where
+// its time goes without any parameter being threaded through them:
+//
+//     auto [proof, report] = trace_aggregation([&] {
+//         return aggregate_proofs<curve_type>(srs, tr_include_first, tr_include_last, proofs);
+//     });
+//     report.write_json(std::cout);
+//
+// The report holds the stages of the call by path (see stage_profiler.hpp), the
+// operations counted while it ran (see operation_counter.hpp, which counts only with
+// CRYPTO3_ZK_COUNT_OPERATIONS defined), and a record per GIPA round of the prover
+// with its input size, time and operations. Like the stage sink and the counter it
+// installs, a trace belongs to the calling thread and the tasks it starts, so
+// concurrent requests on other threads are traced separately.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATION_TRACE_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATION_TRACE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /// Where the time of a traced aggregation or verification went.
+                struct aggregation_report {
+                    struct round_type {
+                        /// Number of values folded by the round, halved from one round to the next.
+                        std::size_t size;
+                        double seconds;
+                        operation_counter::counts_type operations;
+                    };
+
+                    double seconds = 0;
+                    stage_profiler::stages_type stages;
+                    operation_counter::counts_type operations {};
+                    std::vector<round_type> rounds;
+
+                    /// Writes the report as a JSON object with the total time, the stages as written by
+                    /// stage_profiler::write_json, the operations and the rounds in order.
+                    void write_json(std::ostream &os) const {
+                        const auto write_operations = [&](const operation_counter::counts_type &counts) {
+                            os << "{";
+                            for (std::size_t op = 0; op < operation_counter::num_operations; ++op) {
+                                os << (op ? "," : "") << "\""
+                                   << operation_counter::name(operation_counter::operation(op))
+                                   << "\":" << counts[op];
+                            }
+                            os << "}";
+                        };
+
+                        os << "{\"seconds\":" << seconds << ",\"stages\":";
+                        stage_profiler::write_json(os, stages);
+                        os << ",\"operations\":";
+                        write_operations(operations);
+                        os << ",\"rounds\":[";
+                        for (std::size_t i = 0; i < rounds.size(); ++i) {
+                            os << (i ? "," : "") << "{\"size\":" << rounds[i].size
+                               << ",\"seconds\":" << rounds[i].seconds << ",\"operations\":";
+                            write_operations(rounds[i].operations);
+                            os << "}";
+                        }
+                        os << "]}";
+                    }
+                };
+
+                /// The trace of one aggregation or verification, see the file comment.
+                class aggregation_trace {
+                public:
+                    typedef std::chrono::steady_clock clock_type;
+
+                    aggregation_trace() = default;
+                    aggregation_trace(const aggregation_trace &) = delete;
+                    aggregation_trace &operator=(const aggregation_trace &) = delete;
+
+                    /// Installs the trace, its stage profiler and its operation counter on the calling thread
+                    /// for the lifetime of the scope. The stages are recorded from the root path, apart from
+                    /// those of a sink the caller installed before.
+                    class scope {
+                    public:
+                        explicit scope(aggregation_trace &trace) :
+                            previous(state()), profiler_guard(trace.profiler), counter_guard(trace.counter),
+                            start(clock_type::now()), trace(trace) {
+                            state() = &trace;
+                        }
+
+                        scope(const scope &) = delete;
+                        scope &operator=(const scope &) = delete;
+
+                        ~scope() {
+                            const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+                            std::lock_guard<std::mutex> lock(trace.mutex);
+                            trace.seconds += seconds;
+                            state() = previous;
+                        }
+
+                    private:
+                        aggregation_trace *previous;
+                        stage_profiler::scope profiler_guard;
+                        operation_counter::scope counter_guard;
+                        clock_type::time_point start;
+                        aggregation_trace &trace;
+                    };
+
+                    /// Records the round from its construction to its destruction, if a trace is installed on
+                    /// the calling thread. The rounds are sequential, so the operations counted meanwhile are
+                    /// those of the round.
+                    class round_timer {
+                    public:
+                        explicit round_timer(const std::size_t size) : trace(state()), size(size) {
+                            if (trace) {
+                                operations = trace->counter.counts();
+                                start = clock_type::now();
+                            }
+                        }
+
+                        round_timer(const round_timer &) = delete;
+                        round_timer &operator=(const round_timer &) = delete;
+
+                        ~round_timer() {
+                            if (!trace) {
+                                return;
+                            }
+                            aggregation_report::round_type round {
+                                size, std::chrono::duration<double>(clock_type::now() - start).count(),
+                                trace->counter.counts()};
+                            for (std::size_t op = 0; op < operation_counter::num_operations; ++op) {
+                                round.operations[op] -= operations[op];
+                            }
+                            std::lock_guard<std::mutex> lock(trace->mutex);
+                            trace->rounds.emplace_back(round);
+                        }
+
+                    private:
+                        aggregation_trace *trace;
+                        std::size_t size;
+                        operation_counter::counts_type operations;
+                        clock_type::time_point start;
+                    };
+
+                    static aggregation_trace *current() {
+                        return state();
+                    }
+
+                    /// The report of everything traced so far.
+                    aggregation_report report() const {
+                        aggregation_report result;
+                        result.stages = profiler.stages();
+                        result.operations = counter.counts();
+                        std::lock_guard<std::mutex> lock(mutex);
+                        result.seconds = seconds;
+                        result.rounds = rounds;
+                        return result;
+                    }
+
+                private:
+                    static aggregation_trace *&state() {
+                        thread_local aggregation_trace *current = nullptr;
+                        return current;
+                    }
+
+                    stage_profiler profiler;
+                    operation_counter counter;
+
+                    mutable std::mutex mutex;
+                    double seconds = 0;
+                    std::vector<aggregation_report::round_type> rounds;
+                };
+
+                /// Runs f, an aggregation or a verification of aggregates, under a trace of its own, and
+                /// returns its result together with the report of the trace.
+                template<typename Function>
+                std::pair<std::invoke_result_t<Function>, aggregation_report> trace_aggregation(Function f) {
+                    aggregation_trace trace;
+                    std::invoke_result_t<Function> result = [&] {
+                        aggregation_trace::scope guard(trace);
+                        return f();
+                    }();
+                    return {std::move(result), trace.report()};
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATION_TRACE_HPP
@@ -54,18 +54,26 @@
 #ifndef CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_COMMITMENT_HPP
 #define CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_COMMITMENT_HPP
 
+#include <algorithm>
 #include <tuple>
 #include <vector>
 #include <type_traits>
 
 #include <boost/assert.hpp>
 #include <boost/iterator/zip_iterator.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <boost/accumulators/accumulators.hpp>
 
 #include <nil/crypto3/algebra/type_traits.hpp>
 
 #include <nil/crypto3/algebra/algorithms/pair.hpp>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -75,6 +83,9 @@ namespace nil {
                 using r1cs_gg_ppzksnark_ipp2_commitment_output =
                     std::pair<typename CurveType::gt_type::value_type, typename CurveType::gt_type::value_type>;
 
+                template<typename GroupType>
+                struct r1cs_gg_ppzksnark_ipp2_commitment_key_span;
+
                 /// Key is a generic commitment key that is instantiated with g and h as basis,
                 /// and a and b as powers.
                 template<typename GroupType>
@@ -110,13 +121,12 @@ namespace nil {
                         BOOST_ASSERT(has_correct_len(std::distance(s_first, s_last)));
 
                         r1cs_gg_ppzksnark_ipp2_commitment_key<group_type> result;
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(s_first, a.begin(), b.begin())),
-                                      boost::make_zip_iterator(boost::make_tuple(s_last, a.end(), b.end())),
-                                      [&](const boost::tuple<const field_value_type &, const group_value_type &,
-                                                             const group_value_type &> &t) {
-                                          result.a.emplace_back(t.template get<1>() * t.template get<0>());
-                                          result.b.emplace_back(t.template get<2>() * t.template get<0>());
-                                      });
+                        result.a.resize(a.size());
+                        result.b.resize(b.size());
+                        executor::current().parallel_for(a.size(), [&](const std::size_t i) {
+                            result.a[i] = a[i] * *(s_first + i);
+                            result.b[i] = b[i] * *(s_first + i);
+                        });
 
                         return result;
                     }
@@ -149,6 +159,21 @@ namespace nil {
                         return std::make_pair(result_l, result_r);
                     }
 
+                    /// Returns the left and right commitment key part as views on this key, without copies.
+                    /// They are invalidated by any change to the key, fold included.
+                    std::pair<r1cs_gg_ppzksnark_ipp2_commitment_key_span<group_type>,
+                              r1cs_gg_ppzksnark_ipp2_commitment_key_span<group_type>>
+                        split_view(std::size_t at) const {
+                        BOOST_ASSERT(a.size() == b.size());
+                        BOOST_ASSERT(at > 0 && at < a.size());
+
+                        return std::make_pair(
+                            r1cs_gg_ppzksnark_ipp2_commitment_key_span<group_type>(a.begin(), a.begin() + at,
+                                                                                   b.begin(), b.begin() + at),
+                            r1cs_gg_ppzksnark_ipp2_commitment_key_span<group_type>(a.begin() + at, a.end(),
+                                                                                   b.begin() + at, b.end()));
+                    }
+
                     /// Takes a left and right commitment key and returns a commitment
                     /// key $left \circ right^{scale} = (left_i*right_i^{scale} ...)$. This is
                     /// required step during GIPA recursion.
@@ -160,20 +185,31 @@ namespace nil {
                         BOOST_ASSERT(a.size() == b.size());
 
                         r1cs_gg_ppzksnark_ipp2_commitment_key<group_type> result;
-
-                        std::for_each(
-                            boost::make_zip_iterator(
-                                boost::make_tuple(a.begin(), b.begin(), right.a.begin(), right.b.begin())),
-                            boost::make_zip_iterator(boost::make_tuple(a.end(), b.end(), right.a.end(), right.b.end())),
-                            [&](const boost::tuple<const group_value_type &, const group_value_type &,
-                                                   const group_value_type &, const group_value_type &> &t) {
-                                result.a.emplace_back(t.template get<0>() + t.template get<2>() * scale);
-                                result.b.emplace_back(t.template get<1>() + t.template get<3>() * scale);
-                            });
+                        result.a.resize(a.size());
+                        result.b.resize(b.size());
+                        executor::current().parallel_for(a.size(), [&](const std::size_t i) {
+                            result.a[i] = a[i] + right.a[i] * scale;
+                            result.b[i] = b[i] + right.b[i] * scale;
+                        });
 
                         return result;
                     }
 
+                    /// In-place version of compress: sets the key to $left \circ right^{scale}$, left being
+                    /// the first split values and right the remaining ones. The key is half of its size
+                    /// after this call, without any allocation.
+                    void fold(std::size_t split, const field_value_type &scale) {
+                        BOOST_ASSERT(a.size() == b.size());
+                        BOOST_ASSERT(2 * split == a.size());
+
+                        executor::current().parallel_for(split, [&](const std::size_t i) {
+                            a[i] = a[i] + a[i + split] * scale;
+                            b[i] = b[i] + b[i + split] * scale;
+                        });
+                        a.resize(split);
+                        b.resize(split);
+                    }
+
                     /// Returns the first values in the vector of v1 and v2 (respectively
                     /// w1 and w2). When commitment key is of size one, it's a proxy to get the
                     /// final values.
@@ -182,6 +218,187 @@ namespace nil {
                     }
                 };
 
+                /// Read-only view on a contiguous part of a commitment key. Commitments take their keys as
+                /// spans, so that the halves of a key are used during GIPA recursion without copying them.
+                template<typename GroupType>
+                struct r1cs_gg_ppzksnark_ipp2_commitment_key_span {
+                    typedef GroupType group_type;
+                    typedef typename group_type::value_type group_value_type;
+                    typedef typename std::vector<group_value_type>::const_iterator iterator;
+
+                    r1cs_gg_ppzksnark_ipp2_commitment_key_span(iterator a_first, iterator a_last, iterator b_first,
+                                                               iterator b_last) :
+                        a(a_first, a_last),
+                        b(b_first, b_last) {
+                    }
+
+                    r1cs_gg_ppzksnark_ipp2_commitment_key_span(
+                        const r1cs_gg_ppzksnark_ipp2_commitment_key<group_type> &key) :
+                        a(key.a.begin(), key.a.end()),
+                        b(key.b.begin(), key.b.end()) {
+                    }
+
+                    /// Exponent is a
+                    boost::iterator_range<iterator> a;
+                    /// Exponent is b
+                    boost::iterator_range<iterator> b;
+
+                    inline bool has_correct_len(std::size_t n) const {
+                        return a.size() == n && n == b.size();
+                    }
+                };
+
+                /// Commitment key folded by the rounds of GIPA, which materialises its values only once it holds at
+                /// most max_size of them. Until then, after folds by the scales $x_1, ..., x_k$, its i-th value is
+                /// derived from the base key of size n as
+                /// $\sum_{m=0}^{2^k-1} base_{i + m n / 2^k} \prod_{j : m_{k-j} = 1} x_j$, m_l being the l-th
+                /// bit of m. Only the $2^k$ coefficients of this sum are kept, the rounds deriving the values
+                /// they need by chunks of at most max_size / 2 of them from each half of the key.
+                template<typename GroupType>
+                struct r1cs_gg_ppzksnark_ipp2_folded_commitment_key {
+                    typedef GroupType group_type;
+                    typedef r1cs_gg_ppzksnark_ipp2_commitment_key<group_type> key_type;
+                    typedef r1cs_gg_ppzksnark_ipp2_commitment_key_span<group_type> span_type;
+
+                    typedef typename key_type::group_value_type group_value_type;
+                    typedef typename key_type::field_value_type field_value_type;
+
+                    /// Folds base, scaled entrywise by scales when given. Both must outlive the key.
+                    r1cs_gg_ppzksnark_ipp2_folded_commitment_key(
+                        const key_type &base, std::size_t max_size,
+                        const std::vector<field_value_type> *scales = nullptr) :
+                        base(&base),
+                        scales(scales), max_size(std::max<std::size_t>(max_size, 1)), size_(base.a.size()),
+                        coefficients(1, field_value_type::one()) {
+                        BOOST_ASSERT(base.a.size() == base.b.size());
+                        BOOST_ASSERT(!scales || scales->size() == base.a.size());
+
+                        if (size_ <= this->max_size) {
+                            derive(0, size_, key);
+                        }
+                    }
+
+                    inline std::size_t size() const {
+                        return size_;
+                    }
+
+                    inline bool is_materialized() const {
+                        return !key.a.empty();
+                    }
+
+                    /// Number of values of each half of the key the chunks of a round hold at most.
+                    inline std::size_t chunk_size(std::size_t split) const {
+                        return is_materialized() ? split : std::min(split, std::max<std::size_t>(max_size / 2, 1));
+                    }
+
+                    /// Returns views on the values [first, last) of the left and right key parts, the left one
+                    /// holding the first split values. They are invalidated by the next call and by fold.
+                    std::pair<span_type, span_type> split_view(std::size_t split, std::size_t first,
+                                                               std::size_t last) {
+                        BOOST_ASSERT(2 * split == size_);
+                        BOOST_ASSERT(first < last && last <= split);
+
+                        if (is_materialized()) {
+                            return split_view(key, split, first, last);
+                        }
+                        if (coefficients.size() == 1 && !scales) {
+                            return split_view(*base, split, first, last);
+                        }
+
+                        stage_profiler::timer derive_timer("derive_key", 2 * (last - first) * coefficients.size());
+                        derive(first, last, left);
+                        derive(split + first, split + last, right);
+                        return std::make_pair(span_type(left), span_type(right));
+                    }
+
+                    /// Sets the key to $left \circ right^{scale}$ as commitment_key::fold does, materialising its
+                    /// values if it holds at most max_size of them afterwards.
+                    void fold(std::size_t split, const field_value_type &scale) {
+                        BOOST_ASSERT(2 * split == size_);
+
+                        size_ = split;
+                        if (is_materialized()) {
+                            key.fold(split, scale);
+                            return;
+                        }
+
+                        // the new fold is the lowest bit of m, as right is the odd multiples of the new size
+                        std::vector<field_value_type> folded(2 * coefficients.size());
+                        for (std::size_t m = 0; m < coefficients.size(); ++m) {
+                            folded[2 * m] = coefficients[m];
+                            folded[2 * m + 1] = coefficients[m] * scale;
+                        }
+                        coefficients.swap(folded);
+
+                        if (size_ <= max_size) {
+                            left = key_type();
+                            right = key_type();
+                            stage_profiler::timer derive_timer("derive_key", 2 * size_ * coefficients.size());
+                            derive(0, size_, key);
+                        }
+                    }
+
+                    /// Returns the first values of the materialised key, see commitment_key::first.
+                    std::pair<group_value_type, group_value_type> first() const {
+                        BOOST_ASSERT(is_materialized());
+                        return key.first();
+                    }
+
+                private:
+                    static std::pair<span_type, span_type> split_view(const key_type &values, std::size_t split,
+                                                                      std::size_t first, std::size_t last) {
+                        return std::make_pair(
+                            span_type(values.a.begin() + first, values.a.begin() + last, values.b.begin() + first,
+                                      values.b.begin() + last),
+                            span_type(values.a.begin() + split + first, values.a.begin() + split + last,
+                                      values.b.begin() + split + first, values.b.begin() + split + last));
+                    }
+
+                    /// Sets result to the values [first, last) of the folded key.
+                    void derive(std::size_t first, std::size_t last, key_type &result) const {
+                        result.a.resize(last - first);
+                        result.b.resize(last - first);
+
+                        // the base key itself, whose copy needs no exponentiation
+                        if (coefficients.size() == 1 && !scales) {
+                            std::copy(base->a.begin() + first, base->a.begin() + last, result.a.begin());
+                            std::copy(base->b.begin() + first, base->b.begin() + last, result.b.begin());
+                            return;
+                        }
+
+                        // each value is a multi-exponentiation of the base values strided by the key size,
+                        // gathered per thread
+                        executor::current().parallel_for(last - first, [&](const std::size_t i) {
+                            thread_local std::vector<group_value_type> bases_a, bases_b;
+                            thread_local std::vector<field_value_type> exponents;
+                            bases_a.resize(coefficients.size());
+                            bases_b.resize(coefficients.size());
+                            exponents.resize(coefficients.size());
+                            for (std::size_t m = 0; m < coefficients.size(); ++m) {
+                                const std::size_t j = first + i + m * size_;
+                                bases_a[m] = base->a[j];
+                                bases_b[m] = base->b[j];
+                                exponents[m] = scales ? coefficients[m] * (*scales)[j] : coefficients[m];
+                            }
+                            result.a[i] = dispatch_multiexp<multiexp_method_auto>(
+                                bases_a.cbegin(), bases_a.cend(), exponents.cbegin(), exponents.cend(), 1);
+                            result.b[i] = dispatch_multiexp<multiexp_method_auto>(
+                                bases_b.cbegin(), bases_b.cend(), exponents.cbegin(), exponents.cend(), 1);
+                        });
+                    }
+
+                    const key_type *base;
+                    const std::vector<field_value_type> *scales;
+                    std::size_t max_size;
+                    std::size_t size_;
+                    /// coefficient of the base values $i + m n / 2^k$ in the i-th value
+                    std::vector<field_value_type> coefficients;
+                    /// the values once materialised
+                    key_type key;
+                    /// the last chunks derived from the left and right parts
+                    key_type left, right;
+                };
+
                 /// Commitment key used by the "single" commitment on G1 values as
                 /// well as in the "pair" commitment.
                 /// It contains $\{h^a^i\}_{i=1}^n$ and $\{h^b^i\}_{i=1}^n$
@@ -194,6 +411,37 @@ namespace nil {
                 template<typename CurveType>
                 using r1cs_gg_ppzksnark_ipp2_wkey = r1cs_gg_ppzksnark_ipp2_commitment_key<typename CurveType::g1_type>;
 
+                /// Miller loop lines of the points of a fixed vkey, computed once for all the commitments
+                /// with this key in the same way as processed_verification_key holds those of gamma and
+                /// delta.
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_ipp2_prepared_vkey {
+                    typedef CurveType curve_type;
+                    typedef typename curve_type::pairing pairing_policy;
+                    typedef typename pairing_policy::g2_precomp g2_precomp;
+
+                    r1cs_gg_ppzksnark_ipp2_prepared_vkey() = default;
+
+                    explicit r1cs_gg_ppzksnark_ipp2_prepared_vkey(const r1cs_gg_ppzksnark_ipp2_vkey<CurveType> &vkey) :
+                        a(vkey.a.size()), b(vkey.b.size()) {
+                        BOOST_ASSERT(vkey.a.size() == vkey.b.size());
+
+                        executor::current().parallel_for(a.size(), [&](const std::size_t i) {
+                            a[i] = pairing_policy::precompute_g2(vkey.a[i]);
+                            b[i] = pairing_policy::precompute_g2(vkey.b[i]);
+                        });
+                    }
+
+                    inline bool has_correct_len(std::size_t n) const {
+                        return a.size() == n && n == b.size();
+                    }
+
+                    /// Lines of the points with exponent a
+                    std::vector<g2_precomp> a;
+                    /// Lines of the points with exponent b
+                    std::vector<g2_precomp> b;
+                };
+
                 template<typename CurveType>
                 struct r1cs_gg_ppzksnark_ipp2_commitment {
                     typedef CurveType curve_type;
@@ -206,82 +454,100 @@ namespace nil {
                     typedef typename vkey_type::group_value_type g2_value_type;
                     typedef typename curve_type::gt_type::value_type gt_value_type;
 
+                    typedef r1cs_gg_ppzksnark_ipp2_commitment_key_span<typename wkey_type::group_type> wkey_span_type;
+                    typedef r1cs_gg_ppzksnark_ipp2_commitment_key_span<typename vkey_type::group_type> vkey_span_type;
+
+                    typedef r1cs_gg_ppzksnark_ipp2_prepared_vkey<CurveType> prepared_vkey_type;
+
                     typedef r1cs_gg_ppzksnark_ipp2_commitment_output<CurveType> output_type;
 
                     /// Commits to a tuple of G1 vector and G2 vector in the following way:
                     /// $T = \prod_{i=0}^n e(A_i, v_{1,i})e(B_i,w_{1,i})$
                     /// $U = \prod_{i=0}^n e(A_i, v_{2,i})e(B_i,w_{2,i})$
                     /// Output is $(T,U)$
+                    /// A and B may be shorter than the keys: their missing values are the identity, whose
+                    /// pairings are one, so only the given values are paired with the first keys.
                     template<typename InputG1Iterator, typename InputG2Iterator,
                              typename ValueType1 = typename std::iterator_traits<InputG1Iterator>::value_type,
                              typename ValueType2 = typename std::iterator_traits<InputG2Iterator>::value_type,
                              typename std::enable_if<std::is_same<g1_value_type, ValueType1>::value, bool>::type = true,
                              typename std::enable_if<std::is_same<g2_value_type, ValueType2>::value, bool>::type = true>
-                    static output_type pair(const vkey_type &vkey, const wkey_type &wkey, InputG1Iterator a_first,
+                    static output_type pair(const vkey_span_type &vkey, const wkey_span_type &wkey, InputG1Iterator a_first,
                                             InputG1Iterator a_last, InputG2Iterator b_first, InputG2Iterator b_last) {
-                        BOOST_ASSERT(vkey.has_correct_len(std::distance(a_first, a_last)));
-                        BOOST_ASSERT(wkey.has_correct_len(std::distance(b_first, b_last)));
-                        BOOST_ASSERT(std::distance(a_first, a_last) == std::distance(b_first, b_last));
-
-                        // (A * v)
-                        gt_value_type t1 = gt_value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(a_first, vkey.a.begin())),
-                                      boost::make_zip_iterator(boost::make_tuple(a_last, vkey.a.end())),
-                                      [&](const boost::tuple<const g1_value_type &, const g2_value_type &> &t) {
-                                          t1 = t1 * algebra::pair<curve_type>(t.template get<0>(), t.template get<1>());
-                                      });
-
-                        // (B * v)
-                        gt_value_type t2 = gt_value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(wkey.a.begin(), b_first)),
-                                      boost::make_zip_iterator(boost::make_tuple(wkey.a.end(), b_last)),
-                                      [&](const boost::tuple<const g1_value_type &, const g2_value_type &> &t) {
-                                          t2 = t2 * algebra::pair<curve_type>(t.template get<0>(), t.template get<1>());
-                                      });
-
-                        gt_value_type u1 = gt_value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(a_first, vkey.b.begin())),
-                                      boost::make_zip_iterator(boost::make_tuple(a_last, vkey.b.end())),
-                                      [&](const boost::tuple<const g1_value_type &, const g2_value_type &> &t) {
-                                          u1 = u1 * algebra::pair<curve_type>(t.template get<0>(), t.template get<1>());
-                                      });
-
-                        gt_value_type u2 = gt_value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(wkey.b.begin(), b_first)),
-                                      boost::make_zip_iterator(boost::make_tuple(wkey.b.end(), b_last)),
-                                      [&](const boost::tuple<const g1_value_type &, const g2_value_type &> &t) {
-                                          u2 = u2 * algebra::pair<curve_type>(t.template get<0>(), t.template get<1>());
-                                      });
+                        return pair_with(vkey, wkey, a_first, a_last, b_first, b_last);
+                    }
 
-                        // (A * v)(w * B)
-                        return std::make_pair(algebra::final_exponentiation<curve_type>(t1 * t2),
-                                              algebra::final_exponentiation<curve_type>(u1 * u2));
+                    /// Same as above, with the lines of a fixed vkey precomputed.
+                    template<typename InputG1Iterator, typename InputG2Iterator,
+                             typename ValueType1 = typename std::iterator_traits<InputG1Iterator>::value_type,
+                             typename ValueType2 = typename std::iterator_traits<InputG2Iterator>::value_type,
+                             typename std::enable_if<std::is_same<g1_value_type, ValueType1>::value, bool>::type = true,
+                             typename std::enable_if<std::is_same<g2_value_type, ValueType2>::value, bool>::type = true>
+                    static output_type pair(const prepared_vkey_type &vkey, const wkey_span_type &wkey,
+                                            InputG1Iterator a_first, InputG1Iterator a_last, InputG2Iterator b_first,
+                                            InputG2Iterator b_last) {
+                        return pair_with(vkey, wkey, a_first, a_last, b_first, b_last);
                     }
 
                     /// Commits to a single vector of G1 elements in the following way:
                     /// $T = \prod_{i=0}^n e(A_i, v_{1,i})$
                     /// $U = \prod_{i=0}^n e(A_i, v_{2,i})$
                     /// Output is $(T,U)$
+                    /// As for pair, A may be shorter than the key.
                     template<typename InputG1Iterator,
                              typename ValueType1 = typename std::iterator_traits<InputG1Iterator>::value_type,
                              typename std::enable_if<std::is_same<g1_value_type, ValueType1>::value, bool>::type = true>
-                    static output_type single(const vkey_type &vkey, InputG1Iterator a_first, InputG1Iterator a_last) {
-                        BOOST_ASSERT(vkey.has_correct_len(std::distance(a_first, a_last)));
-
-                        gt_value_type t1 = gt_value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(a_first, vkey.a.begin())),
-                                      boost::make_zip_iterator(boost::make_tuple(a_last, vkey.a.end())),
-                                      [&](const boost::tuple<const g1_value_type &, const g2_value_type &> &t) {
-                                          t1 = t1 * algebra::pair<curve_type>(t.template get<0>(), t.template get<1>());
-                                      });
-
-                        gt_value_type u1 = gt_value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(a_first, vkey.b.begin())),
-                                      boost::make_zip_iterator(boost::make_tuple(a_last, vkey.b.end())),
-                                      [&](const boost::tuple<const g1_value_type &, const g2_value_type &> &t) {
-                                          u1 = u1 * algebra::pair<curve_type>(t.template get<0>(), t.template get<1>());
-                                      });
+                    static output_type single(const vkey_span_type &vkey, InputG1Iterator a_first, InputG1Iterator a_last) {
+                        return single_with(vkey, a_first, a_last);
+                    }
+
+                    /// Same as above, with the lines of a fixed vkey precomputed.
+                    template<typename InputG1Iterator,
+                             typename ValueType1 = typename std::iterator_traits<InputG1Iterator>::value_type,
+                             typename std::enable_if<std::is_same<g1_value_type, ValueType1>::value, bool>::type = true>
+                    static output_type single(const prepared_vkey_type &vkey, InputG1Iterator a_first,
+                                              InputG1Iterator a_last) {
+                        return single_with(vkey, a_first, a_last);
+                    }
+
+                private:
+                    template<typename VKey, typename InputG1Iterator, typename InputG2Iterator>
+                    static output_type pair_with(const VKey &vkey, const wkey_span_type &wkey, InputG1Iterator a_first,
+                                                 InputG1Iterator a_last, InputG2Iterator b_first,
+                                                 InputG2Iterator b_last) {
+                        const std::size_t len_a = std::distance(a_first, a_last);
+                        const std::size_t len_b = std::distance(b_first, b_last);
+                        BOOST_ASSERT(vkey.a.size() == vkey.b.size() && len_a <= vkey.a.size());
+                        BOOST_ASSERT(wkey.a.size() == wkey.b.size() && len_b <= wkey.a.size());
+
+                        // (A * v)
+                        const gt_value_type t1 = multi_miller_loop<curve_type>(a_first, a_last, vkey.a.begin());
+
+                        // (B * v)
+                        const gt_value_type t2 =
+                            multi_miller_loop<curve_type>(wkey.a.begin(), wkey.a.begin() + len_b, b_first);
+
+                        const gt_value_type u1 = multi_miller_loop<curve_type>(a_first, a_last, vkey.b.begin());
+
+                        const gt_value_type u2 =
+                            multi_miller_loop<curve_type>(wkey.b.begin(), wkey.b.begin() + len_b, b_first);
+
+                        // (A * v)(w * B)
+                        operation_counter::add(operation_counter::final_exponentiation, 2);
+                        return std::make_pair(algebra::final_exponentiation<curve_type>(t1 * t2),
+                                              algebra::final_exponentiation<curve_type>(u1 * u2));
+                    }
+
+                    template<typename VKey, typename InputG1Iterator>
+                    static output_type single_with(const VKey &vkey, InputG1Iterator a_first, InputG1Iterator a_last) {
+                        BOOST_ASSERT(vkey.a.size() == vkey.b.size());
+                        BOOST_ASSERT(std::size_t(std::distance(a_first, a_last)) <= vkey.a.size());
+
+                        const gt_value_type t1 = multi_miller_loop<curve_type>(a_first, a_last, vkey.a.begin());
+
+                        const gt_value_type u1 = multi_miller_loop<curve_type>(a_first, a_last, vkey.b.begin());
 
+                        operation_counter::add(operation_counter::final_exponentiation, 2);
                         return std::make_pair(algebra::final_exponentiation<curve_type>(t1),
                                               algebra::final_exponentiation<curve_type>(u1));
                     }
@@ -0,0 +1,162 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the aggregate proof with torus-compressed Gt elements.
+//
+// Most of the size of an aggregate proof is taken by its Gt elements: the commitments
+// to A, B and C, the inner product and, for every GIPA round, four commitments and two
+// cross products, each 576 bytes on BLS12-381. The compressed proof keeps them at half
+// that size (see gt_compression.hpp) next to the group elements of the proof, and the
+// verifier expands them all at once with a single field inversion when it verifies.
+// The transcript still absorbs the full encoding, so that compressed and plain proofs
+// share their challenges and the same verifier checks both.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATE_COMPRESSED_PROOF_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATE_COMPRESSED_PROOF_HPP
+
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/gt_compression.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/proof.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    /// Applies f to every Gt element of proof, always in the same order: com_ab, com_c,
+                    /// ip_ab, then comms_ab, comms_c and z_ab round by round.
+                    template<typename ProofType, typename Function>
+                    void for_each_gt_element(ProofType &proof, Function f) {
+                        f(proof.com_ab.first);
+                        f(proof.com_ab.second);
+                        f(proof.com_c.first);
+                        f(proof.com_c.second);
+                        f(proof.ip_ab);
+                        for (std::size_t i = 0; i < proof.tmipp.gipa.comms_ab.size(); ++i) {
+                            f(proof.tmipp.gipa.comms_ab[i].first.first);
+                            f(proof.tmipp.gipa.comms_ab[i].first.second);
+                            f(proof.tmipp.gipa.comms_ab[i].second.first);
+                            f(proof.tmipp.gipa.comms_ab[i].second.second);
+                        }
+                        for (std::size_t i = 0; i < proof.tmipp.gipa.comms_c.size(); ++i) {
+                            f(proof.tmipp.gipa.comms_c[i].first.first);
+                            f(proof.tmipp.gipa.comms_c[i].first.second);
+                            f(proof.tmipp.gipa.comms_c[i].second.first);
+                            f(proof.tmipp.gipa.comms_c[i].second.second);
+                        }
+                        for (std::size_t i = 0; i < proof.tmipp.gipa.z_ab.size(); ++i) {
+                            f(proof.tmipp.gipa.z_ab[i].first);
+                            f(proof.tmipp.gipa.z_ab[i].second);
+                        }
+                    }
+
+                    /// Applies g1 and g2 to the G1 and G2 elements of proof, always in the same order: agg_c,
+                    /// z_c round by round, final_a, final_b, final_c, final_vkey, final_wkey, vkey_opening and
+                    /// wkey_opening.
+                    template<typename ProofType, typename G1Function, typename G2Function>
+                    void for_each_group_element(ProofType &proof, G1Function g1, G2Function g2) {
+                        g1(proof.agg_c);
+                        for (std::size_t i = 0; i < proof.tmipp.gipa.z_c.size(); ++i) {
+                            g1(proof.tmipp.gipa.z_c[i].first);
+                            g1(proof.tmipp.gipa.z_c[i].second);
+                        }
+                        g1(proof.tmipp.gipa.final_a);
+                        g2(proof.tmipp.gipa.final_b);
+                        g1(proof.tmipp.gipa.final_c);
+                        g2(proof.tmipp.gipa.final_vkey.first);
+                        g2(proof.tmipp.gipa.final_vkey.second);
+                        g1(proof.tmipp.gipa.final_wkey.first);
+                        g1(proof.tmipp.gipa.final_wkey.second);
+                        g2(proof.tmipp.vkey_opening.first);
+                        g2(proof.tmipp.vkey_opening.second);
+                        g1(proof.tmipp.wkey_opening.first);
+                        g1(proof.tmipp.wkey_opening.second);
+                    }
+                }    // namespace detail
+
+                /// An aggregate proof whose Gt elements are torus-compressed.
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_aggregate_compressed_proof {
+                    typedef CurveType curve_type;
+                    typedef gt_compression<curve_type> compression_type;
+                    typedef typename compression_type::compressed_type compressed_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_proof<curve_type> proof_type;
+
+                    /// The group elements of the proof; its Gt elements are left to one.
+                    proof_type body;
+                    /// The compressed Gt elements, in the order of detail::for_each_gt_element.
+                    std::vector<compressed_type> gt_elements;
+
+                    r1cs_gg_ppzksnark_aggregate_compressed_proof() = default;
+
+                    explicit r1cs_gg_ppzksnark_aggregate_compressed_proof(const proof_type &proof) : body(proof) {
+                        std::vector<typename curve_type::gt_type::value_type> full;
+                        full.reserve(num_gt_elements(proof));
+                        detail::for_each_gt_element(body, [&](typename curve_type::gt_type::value_type &x) {
+                            full.emplace_back(x);
+                            x = curve_type::gt_type::value_type::one();
+                        });
+                        gt_elements.reserve(full.size());
+                        compression_type::compress(full.begin(), full.end(), std::back_inserter(gt_elements));
+                    }
+
+                    /// The number of Gt elements of an aggregate proof of the same number of rounds.
+                    static std::size_t num_gt_elements(const proof_type &proof) {
+                        return 5 + 4 * (proof.tmipp.gipa.comms_ab.size() + proof.tmipp.gipa.comms_c.size()) +
+                               2 * proof.tmipp.gipa.z_ab.size();
+                    }
+
+                    bool has_correct_len() const {
+                        return gt_elements.size() == num_gt_elements(body);
+                    }
+
+                    /// The aggregate proof, with all its Gt elements expanded with a single inversion, and
+                    /// whether they all lie in Gt.
+                    std::pair<bool, proof_type> decompress() const {
+                        BOOST_ASSERT(has_correct_len());
+
+                        std::vector<typename curve_type::gt_type::value_type> full(gt_elements.size());
+                        const bool in_subgroup =
+                            compression_type::decompress(gt_elements.begin(), gt_elements.end(), full.begin());
+
+                        proof_type proof = body;
+                        std::size_t i = 0;
+                        detail::for_each_gt_element(proof, [&](typename curve_type::gt_type::value_type &x) {
+                            x = full[i++];
+                        });
+                        return std::make_pair(in_subgroup, proof);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_AGGREGATE_COMPRESSED_PROOF_HPP
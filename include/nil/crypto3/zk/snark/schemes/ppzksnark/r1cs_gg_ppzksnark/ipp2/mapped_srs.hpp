@@ -0,0 +1,261 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+// Copyright (c) 2020-2021 Ilias Khairullin <ilias@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a memory-mapped storage of the generic SRS of the Groth16 aggregation.
+//
+// The four power vectors of the generic SRS are written once into a file with a
+// fixed binary layout, the same as the one of the mapped proving key: a header
+// followed by 64-byte aligned sections holding the native representation of the
+// group elements. Opening the file maps it into memory, so an aggregator starts
+// without regenerating or deserializing the powers, and specializes the SRS for
+// its number of proofs straight from the mapping. Opening a file checks that every
+// section lies where write puts it, within the file.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_MAPPED_SRS_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_MAPPED_SRS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType>
+                class r1cs_gg_pp_zksnark_aggregate_mapped_srs {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef typename g1_type::value_type g1_value_type;
+                    typedef typename g2_type::value_type g2_value_type;
+
+                    static constexpr const std::uint64_t magic = 0x5253325050494b5aULL;    // "ZKIPP2SR"
+                    static constexpr const std::uint64_t version = 1;
+                    static constexpr const std::size_t alignment = 64;
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t g1_value_size;
+                        std::uint64_t g2_value_size;
+
+                        std::uint64_t g_alpha_powers_size;
+                        std::uint64_t h_alpha_powers_size;
+                        std::uint64_t g_beta_powers_size;
+                        std::uint64_t h_beta_powers_size;
+
+                        std::uint64_t g_alpha_powers_offset;
+                        std::uint64_t h_alpha_powers_offset;
+                        std::uint64_t g_beta_powers_offset;
+                        std::uint64_t h_beta_powers_offset;
+                        std::uint64_t file_size;
+                    };
+
+                    static_assert(std::is_trivially_copyable<header_type>::value, "header must be trivially copyable");
+
+                    static std::uint64_t align(std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    /* the sections of a file whose power vectors have the sizes given in h, laid out by write */
+                    static header_type layout(const header_type &h) {
+                        header_type result = h;
+                        result.g_alpha_powers_offset = align(sizeof(header_type));
+                        result.h_alpha_powers_offset =
+                            align(result.g_alpha_powers_offset + h.g_alpha_powers_size * sizeof(g1_value_type));
+                        result.g_beta_powers_offset =
+                            align(result.h_alpha_powers_offset + h.h_alpha_powers_size * sizeof(g2_value_type));
+                        result.h_beta_powers_offset =
+                            align(result.g_beta_powers_offset + h.g_beta_powers_size * sizeof(g1_value_type));
+                        result.file_size =
+                            align(result.h_beta_powers_offset + h.h_beta_powers_size * sizeof(g2_value_type));
+                        return result;
+                    }
+
+                    /*
+                     * Whether the header describes a file of size bytes in the layout of write. The sizes
+                     * are bounded by the file size first, so the layout cannot overflow.
+                     */
+                    static bool well_formed(const header_type &h, const std::uint64_t size) {
+                        if (h.magic != magic || h.version != version || h.g1_value_size != sizeof(g1_value_type) ||
+                            h.g2_value_size != sizeof(g2_value_type) || h.file_size != size ||
+                            h.g_alpha_powers_size > size || h.h_alpha_powers_size > size ||
+                            h.g_beta_powers_size > size || h.h_beta_powers_size > size) {
+                            return false;
+                        }
+                        const header_type expected = layout(h);
+                        return expected.file_size == size &&
+                               h.g_alpha_powers_offset == expected.g_alpha_powers_offset &&
+                               h.h_alpha_powers_offset == expected.h_alpha_powers_offset &&
+                               h.g_beta_powers_offset == expected.g_beta_powers_offset &&
+                               h.h_beta_powers_offset == expected.h_beta_powers_offset;
+                    }
+
+                    template<typename T>
+                    const T *section(std::uint64_t offset) const {
+                        return reinterpret_cast<const T *>(static_cast<const char *>(region.get_address()) + offset);
+                    }
+
+                    const header_type &header() const {
+                        return *section<header_type>(0);
+                    }
+
+                    template<typename T>
+                    static void write_section(std::ofstream &out, std::uint64_t offset, const T *data,
+                                              std::size_t count) {
+                        out.seekp(offset);
+                        out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+                    }
+
+                    boost::interprocess::file_mapping mapping;
+                    boost::interprocess::mapped_region region;
+
+                public:
+                    typedef CurveType curve_type;
+                    typedef r1cs_gg_pp_zksnark_aggregate_srs<CurveType> srs_type;
+                    typedef typename srs_type::srs_pair_type srs_pair_type;
+
+                    r1cs_gg_pp_zksnark_aggregate_mapped_srs() = default;
+                    r1cs_gg_pp_zksnark_aggregate_mapped_srs(r1cs_gg_pp_zksnark_aggregate_mapped_srs &&other) = default;
+                    r1cs_gg_pp_zksnark_aggregate_mapped_srs &
+                        operator=(r1cs_gg_pp_zksnark_aggregate_mapped_srs &&other) = default;
+
+                    /**
+                     * Maps the SRS file at path, previously produced by write().
+                     */
+                    explicit r1cs_gg_pp_zksnark_aggregate_mapped_srs(const std::string &path) :
+                        mapping(path.c_str(), boost::interprocess::read_only),
+                        region(mapping, boost::interprocess::read_only) {
+                        if (region.get_size() < sizeof(header_type) || !well_formed(header(), region.get_size())) {
+                            throw std::runtime_error("r1cs_gg_pp_zksnark_aggregate_mapped_srs: incompatible file " +
+                                                     path);
+                        }
+                    }
+
+                    /**
+                     * Writes the power vectors of srs to path in the layout expected by the mapping
+                     * constructor.
+                     */
+                    static void write(const std::string &path, const srs_type &srs) {
+                        static_assert(std::is_trivially_copyable<g1_value_type>::value &&
+                                          std::is_trivially_copyable<g2_value_type>::value,
+                                      "group elements must be trivially copyable to be memory-mapped");
+
+                        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                        if (!out) {
+                            throw std::runtime_error("r1cs_gg_pp_zksnark_aggregate_mapped_srs: cannot write " + path);
+                        }
+
+                        header_type h;
+                        std::memset(&h, 0, sizeof(h));
+                        h.magic = magic;
+                        h.version = version;
+                        h.g1_value_size = sizeof(g1_value_type);
+                        h.g2_value_size = sizeof(g2_value_type);
+                        h.g_alpha_powers_size = srs.g_alpha_powers.size();
+                        h.h_alpha_powers_size = srs.h_alpha_powers.size();
+                        h.g_beta_powers_size = srs.g_beta_powers.size();
+                        h.h_beta_powers_size = srs.h_beta_powers.size();
+                        h = layout(h);
+
+                        write_section(out, 0, &h, 1);
+                        write_section(out, h.g_alpha_powers_offset, srs.g_alpha_powers.data(),
+                                      srs.g_alpha_powers.size());
+                        write_section(out, h.h_alpha_powers_offset, srs.h_alpha_powers.data(),
+                                      srs.h_alpha_powers.size());
+                        write_section(out, h.g_beta_powers_offset, srs.g_beta_powers.data(), srs.g_beta_powers.size());
+                        write_section(out, h.h_beta_powers_offset, srs.h_beta_powers.data(), srs.h_beta_powers.size());
+                        // pad the file up to its announced size
+                        out.seekp(h.file_size - 1);
+                        out.put(0);
+
+                        out.close();
+                        if (!out) {
+                            throw std::runtime_error("r1cs_gg_pp_zksnark_aggregate_mapped_srs: write failed");
+                        }
+                    }
+
+                    /**
+                     * Returns the prover and verifier SRS for num_proofs proofs, as
+                     * r1cs_gg_pp_zksnark_aggregate_srs::specialize does.
+                     */
+                    srs_pair_type specialize(std::size_t num_proofs) const {
+                        return srs_type::specialize(num_proofs, g_alpha_powers_begin(), g_alpha_powers_end(),
+                                                    h_alpha_powers_begin(), h_alpha_powers_end(),
+                                                    g_beta_powers_begin(), g_beta_powers_end(), h_beta_powers_begin(),
+                                                    h_beta_powers_end());
+                    }
+
+                    const g1_value_type *g_alpha_powers_begin() const {
+                        return section<g1_value_type>(header().g_alpha_powers_offset);
+                    }
+
+                    const g1_value_type *g_alpha_powers_end() const {
+                        return g_alpha_powers_begin() + header().g_alpha_powers_size;
+                    }
+
+                    const g2_value_type *h_alpha_powers_begin() const {
+                        return section<g2_value_type>(header().h_alpha_powers_offset);
+                    }
+
+                    const g2_value_type *h_alpha_powers_end() const {
+                        return h_alpha_powers_begin() + header().h_alpha_powers_size;
+                    }
+
+                    const g1_value_type *g_beta_powers_begin() const {
+                        return section<g1_value_type>(header().g_beta_powers_offset);
+                    }
+
+                    const g1_value_type *g_beta_powers_end() const {
+                        return g_beta_powers_begin() + header().g_beta_powers_size;
+                    }
+
+                    const g2_value_type *h_beta_powers_begin() const {
+                        return section<g2_value_type>(header().h_beta_powers_offset);
+                    }
+
+                    const g2_value_type *h_beta_powers_end() const {
+                        return h_beta_powers_begin() + header().h_beta_powers_size;
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return region.get_size() * 8;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_MAPPED_SRS_HPP
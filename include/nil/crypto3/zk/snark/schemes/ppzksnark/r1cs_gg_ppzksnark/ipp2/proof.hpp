@@ -120,8 +120,9 @@ namespace nil {
                         if (tmipp.gipa.comms_ab.size() != std::ceil(std::log2(tmipp.gipa.nproofs))) {
                             return false;
                         }
-                        if (!(tmipp.gipa.comms_ab.size() == tmipp.gipa.comms_c &&
-                              tmipp.gipa.comms_ab == tmipp.gipa.z_ab && tmipp.gipa.comms_ab == tmipp.gipa.z_c)) {
+                        if (!(tmipp.gipa.comms_ab.size() == tmipp.gipa.comms_c.size() &&
+                              tmipp.gipa.comms_ab.size() == tmipp.gipa.z_ab.size() &&
+                              tmipp.gipa.comms_ab.size() == tmipp.gipa.z_c.size())) {
                             return false;
                         }
 
@@ -28,10 +28,12 @@
 #define CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_PROVE_HPP
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <tuple>
 #include <string>
+#include <utility>
 
 #include <boost/iterator/zip_iterator.hpp>
 
@@ -45,6 +47,7 @@
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/detail/basic_policy.hpp>
 
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/aggregation_trace.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/proof.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/transcript.hpp>
@@ -54,6 +57,15 @@
 
 #include <nil/crypto3/algebra/algorithms/pair.hpp>
 
+#include <nil/crypto3/zk/snark/batch_scalar_mul.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/glv_endomorphism.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -62,19 +74,35 @@ namespace nil {
                 /// between A and B for the Groth16 aggregation: A^r * B. It is required as it
                 /// is not enough to simply prove the ipp of A*B, we need a random linear
                 /// combination of those.
+                ///
+                /// The powers are computed in one block per thread of the current executor, every block
+                /// starting from its own first power.
                 template<typename FieldType>
                 std::vector<typename FieldType::value_type>
                     structured_scalar_power(std::size_t num, const typename FieldType::value_type &s) {
-                    std::vector<typename FieldType::value_type> powers = {FieldType::value_type::one()};
-                    for (int i = 1; i < num; i++) {
-                        powers.emplace_back(powers.back() * s);
-                    }
+                    std::vector<typename FieldType::value_type> powers(std::max<std::size_t>(1, num));
+
+                    const std::size_t num_blocks = std::min(powers.size(), executor::current().concurrency());
+                    const std::size_t block_size = (powers.size() + num_blocks - 1) / num_blocks;
+                    executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                        const std::size_t first = std::min(powers.size(), block * block_size);
+                        const std::size_t last = std::min(powers.size(), first + block_size);
+
+                        typename FieldType::value_type power = s.pow(first);
+                        for (std::size_t i = first; i < last; ++i) {
+                            powers[i] = power;
+                            power = power * s;
+                        }
+                    });
+
                     return powers;
                 }
 
                 /// compress is similar to commit::{V,W}KEY::compress: it modifies the `vec`
                 /// vector by setting the value at index $i:0 -> split$  $vec[i] = vec[i] +
                 /// vec[i+split]^scaler$. The `vec` vector is half of its size after this call.
+                /// The values past the end of a shorter `vec` are the identity: they leave the
+                /// first ones unchanged and `vec` keeps at most split values.
                 template<typename CurveType, typename InputRange,
                          typename ValueType = typename std::iterator_traits<typename InputRange::iterator>::value_type>
                 typename std::enable_if<
@@ -83,12 +111,11 @@ namespace nil {
                     std::is_same<typename CurveType::scalar_field_type::value_type, ValueType>::value>::type
                     compress(InputRange &vec, std::size_t split,
                              const typename CurveType::scalar_field_type::value_type &scalar) {
-                    std::for_each(boost::make_zip_iterator(boost::make_tuple(vec.begin(), vec.begin() + split)),
-                                  boost::make_zip_iterator(boost::make_tuple(vec.begin() + split, vec.end())),
-                                  [&](const boost::tuple<ValueType &, ValueType &> &t) {
-                                      t.template get<0>() = t.template get<0>() + t.template get<1>() * scalar;
-                                  });
-                    vec.resize(split);
+                    BOOST_ASSERT(vec.size() <= 2 * split);
+                    const std::size_t tail = vec.size() > split ? vec.size() - split : 0;
+                    executor::current().parallel_for(
+                        tail, [&](const std::size_t i) { vec[i] = vec[i] + vec[i + split] * scalar; });
+                    vec.resize(std::min(vec.size(), split));
                 }
 
                 /// It returns the evaluation of the polynomial $\prod (1 + x_{l-j}(rX)^{2j}$ at
@@ -144,14 +171,16 @@ namespace nil {
                                                             InputFieldValueIterator transcript_last,
                                                             const typename FieldType::value_type &r_shift) {
                     std::vector<typename FieldType::value_type> coefficients = {FieldType::value_type::one()};
+                    coefficients.reserve(std::size_t(1) << std::distance(transcript_first, transcript_last));
                     typename FieldType::value_type power_2_r = r_shift;
 
                     InputFieldValueIterator transcript_iter = transcript_first;
                     while (transcript_iter != transcript_last) {
-                        std::size_t n = coefficients.size();
-                        for (int j = 0; j < n; j++) {
-                            coefficients.emplace_back(coefficients[j] * (*transcript_iter * power_2_r));
-                        }
+                        const std::size_t n = coefficients.size();
+                        const typename FieldType::value_type factor = *transcript_iter * power_2_r;
+                        coefficients.resize(2 * n);
+                        executor::current().parallel_for(
+                            n, [&](const std::size_t j) { coefficients[n + j] = coefficients[j] * factor; });
                         power_2_r = power_2_r * power_2_r;
 
                         ++transcript_iter;
@@ -160,6 +189,114 @@ namespace nil {
                     return coefficients;
                 }
 
+                /// Divides poly by (X - z) and returns the quotient, padded with zeros to the size of
+                /// poly, the remainder $poly(z)$ being stored in remainder. The division runs in
+                /// blocks: each block first runs Horner's rule on its own coefficients, the carries
+                /// between the blocks are then chained from the highest block down, and each block
+                /// finally adds $z^{k}$ times its incoming carry to its partial values.
+                template<typename FieldType, typename InputScalarRange>
+                std::vector<typename FieldType::value_type>
+                    synthetic_division(const InputScalarRange &poly, const typename FieldType::value_type &z,
+                                       typename FieldType::value_type &remainder) {
+                    typedef typename FieldType::value_type value_type;
+
+                    const std::size_t size = poly.size();
+                    BOOST_ASSERT(size > 0);
+                    const std::size_t block_size =
+                        (size + executor::current().concurrency() - 1) / executor::current().concurrency();
+                    const std::size_t num_blocks = (size + block_size - 1) / block_size;
+
+                    // horner[k] is $\sum_{j \geq k} poly_j z^{j-k}$, so that the quotient is horner[1...]
+                    std::vector<value_type> horner(size);
+                    executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                        const std::size_t first = block * block_size;
+                        const std::size_t last = std::min(size, first + block_size);
+
+                        value_type acc = value_type::zero();
+                        for (std::size_t k = last; k > first; --k) {
+                            acc = acc * z + poly[k - 1];
+                            horner[k - 1] = acc;
+                        }
+                    });
+
+                    // carries[block] is horner[last] of the block, zero for the highest block
+                    std::vector<value_type> carries(num_blocks, value_type::zero());
+                    for (std::size_t block = num_blocks - 1; block > 0; --block) {
+                        const std::size_t first = block * block_size;
+                        const std::size_t last = std::min(size, first + block_size);
+                        carries[block - 1] = horner[first] + z.pow(last - first) * carries[block];
+                    }
+
+                    executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                        if (carries[block] == value_type::zero()) {
+                            return;
+                        }
+                        const std::size_t first = block * block_size;
+                        const std::size_t last = std::min(size, first + block_size);
+
+                        value_type carry = carries[block] * z;
+                        for (std::size_t k = last; k > first; --k) {
+                            horner[k - 1] = horner[k - 1] + carry;
+                            carry = carry * z;
+                        }
+                    });
+
+                    remainder = horner.front();
+                    horner.erase(horner.begin());
+                    horner.emplace_back(value_type::zero());
+                    return horner;
+                }
+
+                /// Cost in a multiexp_task_list of a term of the multi-exponentiations in GroupType.
+                template<typename GroupType>
+                constexpr std::size_t commitment_key_kzg_opening_weight() {
+                    return std::is_same<GroupType, typename GroupType::curve_type::g2_type>::value ?
+                               multiexp_task_list::g2_cost :
+                               multiexp_task_list::g1_cost;
+                }
+
+                /// Adds to tasks the multi-exponentiations of the KZG opening proof for quotient,
+                /// one over the powers of alpha and one over the powers of beta, whose parts are
+                /// stored in parts_alpha and parts_beta.
+                template<typename GroupType, typename InputGroupIterator, typename InputScalarRange>
+                void add_commitment_key_kzg_opening(multiexp_task_list &tasks,
+                                                    std::vector<typename GroupType::value_type> &parts_alpha,
+                                                    std::vector<typename GroupType::value_type> &parts_beta,
+                                                    InputGroupIterator srs_powers_alpha_first,
+                                                    InputGroupIterator srs_powers_beta_first,
+                                                    const InputScalarRange &quotient) {
+                    const std::size_t weight = commitment_key_kzg_opening_weight<GroupType>();
+
+                    tasks.add(parts_alpha, quotient.size(), weight,
+                              [=, &quotient](std::size_t first, std::size_t last) {
+                                  return dispatch_multiexp<multiexp_method_auto>(
+                                      srs_powers_alpha_first + first, srs_powers_alpha_first + last,
+                                      quotient.begin() + first, quotient.begin() + last, 1);
+                              });
+                    tasks.add(parts_beta, quotient.size(), weight,
+                              [=, &quotient](std::size_t first, std::size_t last) {
+                                  return dispatch_multiexp<multiexp_method_auto>(
+                                      srs_powers_beta_first + first, srs_powers_beta_first + last,
+                                      quotient.begin() + first, quotient.begin() + last, 1);
+                              });
+                }
+
+                /// Returns the KZG opening proof for quotient, running the two multi-exponentiations
+                /// of add_commitment_key_kzg_opening in a task list of their own.
+                template<typename GroupType, typename InputGroupIterator, typename InputScalarRange>
+                kzg_opening<GroupType> commitment_key_kzg_opening(InputGroupIterator srs_powers_alpha_first,
+                                                                  InputGroupIterator srs_powers_beta_first,
+                                                                  const InputScalarRange &quotient) {
+                    std::vector<typename GroupType::value_type> parts_alpha, parts_beta;
+                    multiexp_task_list tasks(2 * quotient.size() * commitment_key_kzg_opening_weight<GroupType>());
+                    add_commitment_key_kzg_opening<GroupType>(tasks, parts_alpha, parts_beta, srs_powers_alpha_first,
+                                                              srs_powers_beta_first, quotient);
+                    tasks.run();
+
+                    return kzg_opening<GroupType> {multiexp_task_list::sum(parts_alpha),
+                                                   multiexp_task_list::sum(parts_beta)};
+                }
+
                 /// Returns the KZG opening proof for the given commitment key. Specifically, it
                 /// returns $g^{f(alpha) - f(z) / (alpha - z)}$ for $a$ and $b$.
                 template<typename GroupType, typename InputGroupIterator, typename InputScalarRange>
@@ -176,42 +313,71 @@ namespace nil {
                         const InputScalarRange &poly,
                         const typename GroupType::curve_type::scalar_field_type::value_type &eval_poly,
                         const typename GroupType::curve_type::scalar_field_type::value_type &kzg_challenge) {
-                    typename GroupType::curve_type::scalar_field_type::value_type neg_kzg_challenge = -kzg_challenge;
-
                     BOOST_ASSERT(poly.size() == std::distance(srs_powers_alpha_first, srs_powers_alpha_last));
                     BOOST_ASSERT(poly.size() == std::distance(srs_powers_beta_first, srs_powers_beta_last));
 
-                    // f_v(X) - f_v(z) / (X - z)
-                    std::vector<typename GroupType::curve_type::scalar_field_type::value_type> f_vX_sub_f_vZ;
-                    fft::_polynomial_subtraction<typename GroupType::curve_type::scalar_field_type>(f_vX_sub_f_vZ, poly,
-                                                                                                    {{
-                                                                                                        eval_poly,
-                                                                                                    }});
-                    std::vector<typename GroupType::curve_type::scalar_field_type::value_type> quotient_polynomial,
-                        remainder_polynomial;
-                    fft::_polynomial_division<typename GroupType::curve_type::scalar_field_type>(
-                        quotient_polynomial, remainder_polynomial, f_vX_sub_f_vZ,
-                        {{
-                            neg_kzg_challenge,
-                            GroupType::curve_type::scalar_field_type::value_type::one(),
-                        }});
-
-                    if (quotient_polynomial.size() < poly.size()) {
-                        quotient_polynomial.resize(poly.size(),
-                                                   GroupType::curve_type::scalar_field_type::value_type::zero());
-                    }
-                    BOOST_ASSERT(quotient_polynomial.size() == poly.size());
+                    // f_v(X) - f_v(z) / (X - z), the remainder of the division being f_v(z)
+                    typename GroupType::curve_type::scalar_field_type::value_type remainder;
+                    std::vector<typename GroupType::curve_type::scalar_field_type::value_type> quotient_polynomial =
+                        synthetic_division<typename GroupType::curve_type::scalar_field_type>(poly, kzg_challenge,
+                                                                                              remainder);
+                    BOOST_ASSERT(remainder == eval_poly);
 
                     // we do one proof over h^a and one proof over h^b (or g^a and g^b depending
                     // on the curve we are on). that's the extra cost of the commitment scheme
                     // used which is compatible with Groth16 CRS insteaf of the original paper
                     // of Bunz'19
-                    return kzg_opening<GroupType> {algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                                       srs_powers_alpha_first, srs_powers_alpha_last,
-                                                       quotient_polynomial.begin(), quotient_polynomial.end(), 1),
-                                                   algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                                       srs_powers_beta_first, srs_powers_beta_last,
-                                                       quotient_polynomial.begin(), quotient_polynomial.end(), 1)};
+                    return commitment_key_kzg_opening<GroupType>(srs_powers_alpha_first, srs_powers_beta_first,
+                                                                 quotient_polynomial);
+                }
+
+                /// Returns the quotient of the KZG opening of the final v key, the polynomial
+                /// $f_v(X) = \prod (1 + x X^{2^j})$ divided by (X - z).
+                template<typename CurveType, typename InputScalarIterator>
+                std::vector<typename CurveType::scalar_field_type::value_type>
+                    commitment_v_quotient(InputScalarIterator transcript_first, InputScalarIterator transcript_last,
+                                          const typename CurveType::scalar_field_type::value_type &kzg_challenge) {
+                    std::vector<typename CurveType::scalar_field_type::value_type> vkey_poly =
+                        polynomial_coefficients_from_transcript<typename CurveType::scalar_field_type>(
+                            transcript_first, transcript_last, CurveType::scalar_field_type::value_type::one());
+                    BOOST_ASSERT(!fft::_is_zero(vkey_poly));
+
+                    typename CurveType::scalar_field_type::value_type remainder;
+                    std::vector<typename CurveType::scalar_field_type::value_type> quotient =
+                        synthetic_division<typename CurveType::scalar_field_type>(vkey_poly, kzg_challenge, remainder);
+                    BOOST_ASSERT(remainder ==
+                                 polynomial_evaluation_product_form_from_transcript<
+                                     typename CurveType::scalar_field_type>(
+                                     transcript_first, transcript_last, kzg_challenge,
+                                     CurveType::scalar_field_type::value_type::one()));
+                    return quotient;
+                }
+
+                /// Returns the quotient of the KZG opening of the final w key, the polynomial
+                /// $f_w(X) = X^n \prod (1 + x (rX)^{2^j})$ divided by (X - z).
+                template<typename CurveType, typename InputScalarIterator>
+                std::vector<typename CurveType::scalar_field_type::value_type>
+                    commitment_w_quotient(std::size_t n, InputScalarIterator transcript_first,
+                                          InputScalarIterator transcript_last,
+                                          const typename CurveType::scalar_field_type::value_type &r_shift,
+                                          const typename CurveType::scalar_field_type::value_type &kzg_challenge) {
+                    // this computes f(X) = \prod (1 + x (rX)^{2^j})
+                    std::vector<typename CurveType::scalar_field_type::value_type> fcoeffs =
+                        polynomial_coefficients_from_transcript<typename CurveType::scalar_field_type>(
+                            transcript_first, transcript_last, r_shift);
+                    // this computes f_w(X) = X^n * f(X) - it simply shifts all coefficients to by n
+                    fcoeffs.insert(fcoeffs.begin(), n, CurveType::scalar_field_type::value_type::zero());
+
+                    typename CurveType::scalar_field_type::value_type remainder;
+                    std::vector<typename CurveType::scalar_field_type::value_type> quotient =
+                        synthetic_division<typename CurveType::scalar_field_type>(fcoeffs, kzg_challenge, remainder);
+                    // f_w(z) is f(z) times the "shift" z^n
+                    BOOST_ASSERT(remainder ==
+                                 polynomial_evaluation_product_form_from_transcript<
+                                     typename CurveType::scalar_field_type>(transcript_first, transcript_last,
+                                                                            kzg_challenge, r_shift) *
+                                     kzg_challenge.pow(n));
+                    return quotient;
                 }
 
                 template<typename CurveType, typename InputG2Iterator, typename InputScalarIterator>
@@ -225,20 +391,13 @@ namespace nil {
                                        InputG2Iterator srs_powers_beta_first, InputG2Iterator srs_powers_beta_last,
                                        InputScalarIterator transcript_first, InputScalarIterator transcript_last,
                                        const typename CurveType::scalar_field_type::value_type &kzg_challenge) {
-                    std::vector<typename CurveType::scalar_field_type::value_type> vkey_poly =
-                        polynomial_coefficients_from_transcript<typename CurveType::scalar_field_type>(
-                            transcript_first, transcript_last, CurveType::scalar_field_type::value_type::one());
-                    fft::_condense(vkey_poly);
-                    BOOST_ASSERT(!fft::_is_zero(vkey_poly));
-
-                    typename CurveType::scalar_field_type::value_type vkey_poly_z =
-                        polynomial_evaluation_product_form_from_transcript<typename CurveType::scalar_field_type>(
-                            transcript_first, transcript_last, kzg_challenge,
-                            CurveType::scalar_field_type::value_type::one());
+                    std::vector<typename CurveType::scalar_field_type::value_type> quotient =
+                        commitment_v_quotient<CurveType>(transcript_first, transcript_last, kzg_challenge);
+                    BOOST_ASSERT(quotient.size() == std::distance(srs_powers_alpha_first, srs_powers_alpha_last));
+                    BOOST_ASSERT(quotient.size() == std::distance(srs_powers_beta_first, srs_powers_beta_last));
 
-                    return prove_commitment_key_kzg_opening<typename CurveType::g2_type>(
-                        srs_powers_alpha_first, srs_powers_alpha_last, srs_powers_beta_first, srs_powers_beta_last,
-                        vkey_poly, vkey_poly_z, kzg_challenge);
+                    return commitment_key_kzg_opening<typename CurveType::g2_type>(srs_powers_alpha_first,
+                                                                                   srs_powers_beta_first, quotient);
                 }
 
                 template<typename CurveType, typename InputG1Iterator, typename InputScalarIterator>
@@ -256,31 +415,103 @@ namespace nil {
                     std::size_t n = std::distance(srs_powers_beta_first, srs_powers_beta_last) / 2;
                     BOOST_ASSERT(2 * n == std::distance(srs_powers_alpha_first, srs_powers_alpha_last));
 
-                    // this computes f(X) = \prod (1 + x (rX)^{2^j})
-                    std::vector<typename CurveType::scalar_field_type::value_type> fcoeffs =
-                        polynomial_coefficients_from_transcript<typename CurveType::scalar_field_type>(
-                            transcript_first, transcript_last, r_shift);
-                    // this computes f_w(X) = X^n * f(X) - it simply shifts all coefficients to by n
-                    fcoeffs.insert(fcoeffs.begin(), n, CurveType::scalar_field_type::value_type::zero());
+                    std::vector<typename CurveType::scalar_field_type::value_type> quotient =
+                        commitment_w_quotient<CurveType>(n, transcript_first, transcript_last, r_shift, kzg_challenge);
+                    BOOST_ASSERT(quotient.size() == 2 * n);
+
+                    return commitment_key_kzg_opening<typename CurveType::g1_type>(srs_powers_alpha_first,
+                                                                                   srs_powers_beta_first, quotient);
+                }
 
-                    // this computes f(z)
-                    typename CurveType::scalar_field_type::value_type fz =
-                        polynomial_evaluation_product_form_from_transcript<typename CurveType::scalar_field_type>(
-                            transcript_first, transcript_last, kzg_challenge, r_shift);
-                    // this computes the "shift" z^n
-                    typename CurveType::scalar_field_type::value_type zn = kzg_challenge.pow(n);
-                    // this computes f_w(z) by multiplying by zn
-                    typename CurveType::scalar_field_type::value_type fwz = fz * zn;
-
-                    return prove_commitment_key_kzg_opening<typename CurveType::g1_type>(
-                        srs_powers_alpha_first, srs_powers_alpha_last, srs_powers_beta_first, srs_powers_beta_last,
-                        fcoeffs, fwz, kzg_challenge);
+                /// Returns the KZG openings of the final v and w keys at once: the four
+                /// multi-exponentiations, over the powers of alpha and beta in G2 for v and in G1
+                /// for w, are split into the tasks of a single task list.
+                template<typename CurveType, typename InputScalarIterator>
+                std::pair<kzg_opening<typename CurveType::g2_type>, kzg_opening<typename CurveType::g1_type>>
+                    prove_commitment_keys(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
+                                          InputScalarIterator challenges_first, InputScalarIterator challenges_last,
+                                          InputScalarIterator challenges_inv_first,
+                                          InputScalarIterator challenges_inv_last,
+                                          const typename CurveType::scalar_field_type::value_type &r_shift,
+                                          const typename CurveType::scalar_field_type::value_type &kzg_challenge) {
+                    const std::size_t n = srs.g_beta_powers.size() / 2;
+
+                    std::vector<typename CurveType::scalar_field_type::value_type> quotient_v =
+                        commitment_v_quotient<CurveType>(challenges_inv_first, challenges_inv_last, kzg_challenge);
+                    std::vector<typename CurveType::scalar_field_type::value_type> quotient_w =
+                        commitment_w_quotient<CurveType>(n, challenges_first, challenges_last, r_shift, kzg_challenge);
+                    BOOST_ASSERT(quotient_v.size() == srs.h_alpha_powers.size());
+                    BOOST_ASSERT(quotient_v.size() == srs.h_beta_powers.size());
+                    BOOST_ASSERT(quotient_w.size() == srs.g_alpha_powers.size());
+                    BOOST_ASSERT(quotient_w.size() == srs.g_beta_powers.size());
+
+                    std::vector<typename CurveType::g2_type::value_type> parts_v_alpha, parts_v_beta;
+                    std::vector<typename CurveType::g1_type::value_type> parts_w_alpha, parts_w_beta;
+                    multiexp_task_list tasks(
+                        2 * quotient_v.size() * commitment_key_kzg_opening_weight<typename CurveType::g2_type>() +
+                        2 * quotient_w.size() * commitment_key_kzg_opening_weight<typename CurveType::g1_type>());
+                    add_commitment_key_kzg_opening<typename CurveType::g2_type>(
+                        tasks, parts_v_alpha, parts_v_beta, srs.h_alpha_powers.begin(), srs.h_beta_powers.begin(),
+                        quotient_v);
+                    add_commitment_key_kzg_opening<typename CurveType::g1_type>(
+                        tasks, parts_w_alpha, parts_w_beta, srs.g_alpha_powers.begin(), srs.g_beta_powers.begin(),
+                        quotient_w);
+                    tasks.run();
+
+                    return std::make_pair(
+                        kzg_opening<typename CurveType::g2_type> {multiexp_task_list::sum(parts_v_alpha),
+                                                                  multiexp_task_list::sum(parts_v_beta)},
+                        kzg_opening<typename CurveType::g1_type> {multiexp_task_list::sum(parts_w_alpha),
+                                                                  multiexp_task_list::sum(parts_w_beta)});
                 }
 
+                /// Bound on the number of values of each commitment key the GIPA recursion of the calling thread
+                /// materialises, unbounded by default. Above it, the rounds derive the values of the folded keys
+                /// they need by chunks from the SRS and the challenges so far, instead of holding rescaled copies
+                /// of the keys: every such round costs as many exponentiations as the size of the SRS.
+                ///
+                ///     gipa_memory_bound::scope bound(1 << 12);
+                ///     auto proof = aggregate_proofs<curve_type>(srs, ...);
+                class gipa_memory_bound {
+                public:
+                    static std::size_t current() {
+                        return state();
+                    }
+
+                    /// Sets the bound of the calling thread for the lifetime of the scope.
+                    class scope {
+                    public:
+                        explicit scope(std::size_t max_key_size) : previous(state()) {
+                            state() = max_key_size;
+                        }
+
+                        scope(const scope &) = delete;
+                        scope &operator=(const scope &) = delete;
+
+                        ~scope() {
+                            state() = previous;
+                        }
+
+                    private:
+                        std::size_t previous;
+                    };
+
+                private:
+                    static std::size_t &state() {
+                        thread_local std::size_t max_key_size = std::numeric_limits<std::size_t>::max();
+                        return max_key_size;
+                    }
+                };
+
                 /// gipa_tipp_mipp peforms the recursion of the GIPA protocol for TIPP and MIPP.
                 /// It returns a proof containing all intermdiate committed values, as well as
                 /// the challenges generated necessary to do the polynomial commitment proof
                 /// later in TIPP.
+                /// The keys and r are of a power of two size n, A, B and C may hold fewer values: the
+                /// missing ones are the identity. Their pairings and multiples vanish, so they are neither
+                /// stored nor computed, and the first round only pays for the values actually given.
+                /// The keys are folded as r1cs_gg_ppzksnark_ipp2_folded_commitment_key, so the rounds hold them by
+                /// chunks as long as they are larger than the bound the keys were built with.
                 template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputG1Iterator1,
                          typename InputG2Iterator, typename InputG1Iterator2, typename InputScalarIterator>
                 typename std::enable_if<
@@ -296,15 +527,18 @@ namespace nil {
                                std::vector<typename CurveType::scalar_field_type::value_type>>>::type
                     gipa_tipp_mipp(transcript<CurveType, Hash> &tr, InputG1Iterator1 a_first, InputG1Iterator1 a_last,
                                    InputG2Iterator b_first, InputG2Iterator b_last, InputG1Iterator2 c_first,
-                                   InputG1Iterator2 c_last, const r1cs_gg_ppzksnark_ipp2_vkey<CurveType> &vkey_input,
-                                   const r1cs_gg_ppzksnark_ipp2_wkey<CurveType> &wkey_input,
+                                   InputG1Iterator2 c_last,
+                                   r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g2_type> vkey,
+                                   r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g1_type> wkey,
                                    InputScalarIterator r_first, InputScalarIterator r_last) {
-                    std::size_t input_len = std::distance(a_first, a_last);
+                    std::size_t input_len = std::distance(r_first, r_last);
+                    std::size_t num_values = std::distance(a_first, a_last);
                     BOOST_ASSERT(input_len >= 2);
                     BOOST_ASSERT((input_len & (input_len - 1)) == 0);
-                    BOOST_ASSERT(input_len == std::distance(b_first, b_last));
-                    BOOST_ASSERT(input_len == std::distance(r_first, r_last));
-                    BOOST_ASSERT(input_len == std::distance(c_first, c_last));
+                    BOOST_ASSERT(num_values >= 1 && num_values <= input_len);
+                    BOOST_ASSERT(num_values == std::distance(b_first, b_last));
+                    BOOST_ASSERT(num_values == std::distance(c_first, c_last));
+                    BOOST_ASSERT(vkey.size() == input_len && wkey.size() == input_len);
 
                     // the values of vectors A and B rescaled at each step of the loop
                     // the values of vectors C and r rescaled at each step of the loop
@@ -312,9 +546,13 @@ namespace nil {
                     std::vector<typename CurveType::g2_type::value_type> m_b {b_first, b_last};
                     std::vector<typename CurveType::scalar_field_type::value_type> m_r {r_first, r_last};
 
-                    // the values of the commitment keys rescaled at each step of the loop
-                    r1cs_gg_ppzksnark_ipp2_vkey<CurveType> vkey = vkey_input;
-                    r1cs_gg_ppzksnark_ipp2_wkey<CurveType> wkey = wkey_input;
+                    // all of them, the commitment keys included, are folded in place, so the loop only holds a
+                    // single copy of its inputs
+
+                    std::size_t num_rounds = 0;
+                    for (std::size_t n = input_len; n > 1; n /= 2) {
+                        ++num_rounds;
+                    }
 
                     // storing the values for including in the proof
                     std::vector<std::pair<typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type,
@@ -330,66 +568,100 @@ namespace nil {
                         std::pair<typename CurveType::g1_type::value_type, typename CurveType::g1_type::value_type>>
                         z_c;
                     std::vector<typename CurveType::scalar_field_type::value_type> challenges, challenges_inv;
-
+                    comms_ab.reserve(num_rounds);
+                    comms_c.reserve(num_rounds);
+                    z_ab.reserve(num_rounds);
+                    z_c.reserve(num_rounds);
+                    challenges.reserve(num_rounds);
+                    challenges_inv.reserve(num_rounds);
+
+                    stage_profiler::timer gipa_timer("gipa", input_len);
                     constexpr std::array<std::uint8_t, 4> domain_separator {'g', 'i', 'p', 'a'};
                     tr.write_domain_separator(domain_separator.begin(), domain_separator.end());
                     typename CurveType::scalar_field_type::value_type _i = tr.read_challenge();
 
-                    while (m_a.size() > 1) {
+                    while (vkey.size() > 1) {
+                        aggregation_trace::round_timer round_timer(vkey.size());
+
                         // recursive step
                         // Recurse with problem of half size
-                        std::size_t split = m_a.size() / 2;
-
-                        auto [vk_left, vk_right] = vkey.split(split);
-                        auto [wk_left, wk_right] = wkey.split(split);
+                        std::size_t split = vkey.size() / 2;
+                        // A, B and C hold left values in their left half and tail values in the right one,
+                        // the others being the identity
+                        const std::size_t left = std::min(m_a.size(), split);
+                        const std::size_t tail = m_a.size() - left;
 
-                        // TODO: parallel
                         // See section 3.3 for paper version with equivalent names
-                        // TIPP part
-                        typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type tab_l =
-                            r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::pair(
-                                vk_left, wk_right, m_a.begin() + split, m_a.end(), m_b.begin(), m_b.begin() + split);
-                        typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type tab_r =
-                            r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::pair(
-                                vk_right, wk_left, m_a.begin(), m_a.begin() + split, m_b.begin() + split, m_b.end());
+                        // Every product below is split across the current executor: the pairing
+                        // products through multi_miller_loop, the multi-exponentiations by chunks
+                        const std::size_t chunks = executor::current().concurrency();
+
+                        // TIPP and MIPP commitments, by chunks of the key halves: the left values [first, last)
+                        // of A, B and C are committed with the values [first, last) of the key halves, as are
+                        // their tail values. Chunks past the left values only have identities to commit to.
+                        stage_profiler::timer pairing_timer("pairing_product", 6 * left + 6 * tail);
+                        const typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type one {
+                            CurveType::gt_type::value_type::one(), CurveType::gt_type::value_type::one()};
+                        typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type tab_l = one, tab_r = one,
+                                                                                          tuc_l = one, tuc_r = one;
+                        const auto accumulate =
+                            [](typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type &result,
+                               const typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type &chunk) {
+                                result.first = result.first * chunk.first;
+                                result.second = result.second * chunk.second;
+                            };
+                        const std::size_t chunk_size = std::min(vkey.chunk_size(split), wkey.chunk_size(split));
+                        for (std::size_t first = 0; first < left; first += chunk_size) {
+                            const std::size_t last = std::min(first + chunk_size, split);
+                            const std::size_t left_first = first, left_last = std::min(last, left);
+                            const std::size_t tail_first = left + std::min(first, tail),
+                                              tail_last = left + std::min(last, tail);
+
+                            // views on the chunks of the key halves, valid until the next chunk
+                            auto [vk_left, vk_right] = vkey.split_view(split, first, last);
+                            auto [wk_left, wk_right] = wkey.split_view(split, first, last);
+
+                            // TIPP part
+                            accumulate(tab_l, r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::pair(
+                                                  vk_left, wk_right, m_a.begin() + tail_first,
+                                                  m_a.begin() + tail_last, m_b.begin() + left_first,
+                                                  m_b.begin() + left_last));
+                            accumulate(tab_r, r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::pair(
+                                                  vk_right, wk_left, m_a.begin() + left_first,
+                                                  m_a.begin() + left_last, m_b.begin() + tail_first,
+                                                  m_b.begin() + tail_last));
+
+                            // MIPP part
+                            // u_l = c[n':] * v[:n']
+                            accumulate(tuc_l, r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::single(
+                                                  vk_left, m_c.begin() + tail_first, m_c.begin() + tail_last));
+                            // u_r = c[:n'] * v[n':]
+                            accumulate(tuc_r, r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::single(
+                                                  vk_right, m_c.begin() + left_first, m_c.begin() + left_last));
+                        }
 
                         // \prod e(A_right,B_left)
-                        typename CurveType::gt_type::value_type zab_l = CurveType::gt_type::value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(m_a.begin() + split, m_b.begin())),
-                                      boost::make_zip_iterator(boost::make_tuple(m_a.end(), m_b.begin() + split)),
-                                      [&](const boost::tuple<const typename CurveType::g1_type::value_type &,
-                                                             const typename CurveType::g2_type::value_type &> &t) {
-                                          zab_l = zab_l *
-                                                  algebra::pair<CurveType>(t.template get<0>(), t.template get<1>());
-                                      });
-                        zab_l = algebra::final_exponentiation<CurveType>(zab_l);
-                        typename CurveType::gt_type::value_type zab_r = CurveType::gt_type::value_type::one();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(m_a.begin(), m_b.begin() + split)),
-                                      boost::make_zip_iterator(boost::make_tuple(m_a.begin() + split, m_b.end())),
-                                      [&](const boost::tuple<const typename CurveType::g1_type::value_type &,
-                                                             const typename CurveType::g2_type::value_type &> &t) {
-                                          zab_r = zab_r *
-                                                  algebra::pair<CurveType>(t.template get<0>(), t.template get<1>());
-                                      });
-                        zab_r = algebra::final_exponentiation<CurveType>(zab_r);
-
-                        // MIPP part
+                        operation_counter::add(operation_counter::final_exponentiation, 2);
+                        const typename CurveType::gt_type::value_type zab_l = algebra::final_exponentiation<CurveType>(
+                            multi_miller_loop<CurveType>(m_a.begin() + left, m_a.end(), m_b.begin()));
+                        // \prod e(A_left,B_right)
+                        const typename CurveType::gt_type::value_type zab_r = algebra::final_exponentiation<CurveType>(
+                            multi_miller_loop<CurveType>(m_a.begin(), m_a.begin() + tail, m_b.begin() + left));
+                        pairing_timer.stop();
+
                         // z_l = c[n':] ^ r[:n']
+                        stage_profiler::timer multiexp_timer("multiexp", left + tail);
+                        operation_counter::add(operation_counter::g1_exp_term, left + tail);
                         typename CurveType::g1_type::value_type zc_l =
-                            algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                m_c.begin() + split, m_c.end(), m_r.begin(), m_r.begin() + split, 1);
+                            tail ? dispatch_multiexp<multiexp_method_auto>(m_c.begin() + left, m_c.end(), m_r.begin(),
+                                                                           m_r.begin() + tail, chunks) :
+                                   CurveType::g1_type::value_type::zero();
                         // Z_r = c[:n'] ^ r[n':]
                         typename CurveType::g1_type::value_type zc_r =
-                            algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                m_c.begin(), m_c.begin() + split, m_r.begin() + split, m_r.end(), 1);
-                        // u_l = c[n':] * v[:n']
-                        typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type tuc_l =
-                            r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::single(vk_left, m_c.begin() + split,
-                                                                                 m_c.end());
-                        // u_r = c[:n'] * v[n':]
-                        typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type tuc_r =
-                            r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::single(vk_right, m_c.begin(),
-                                                                                 m_c.begin() + split);
+                            dispatch_multiexp<multiexp_method_auto>(m_c.begin(), m_c.begin() + left,
+                                                                    m_r.begin() + split, m_r.begin() + split + left,
+                                                                    chunks);
+                        multiexp_timer.stop();
 
                         // Fiat-Shamir challenge
                         // combine both TIPP and MIPP transcript
@@ -414,6 +686,7 @@ namespace nil {
 
                         // Set up values for next step of recursion
                         // A[:n'] + A[n':] ^ x
+                        stage_profiler::timer compress_timer("compress", split + tail);
                         compress<CurveType>(m_a, split, c);
                         // B[:n'] + B[n':] ^ x^-1
                         compress<CurveType>(m_b, split, c_inv);
@@ -423,9 +696,10 @@ namespace nil {
                         compress<CurveType>(m_r, split, c_inv);
 
                         // v_left + v_right^x^-1
-                        vkey = vk_left.compress(vk_right, c_inv);
+                        vkey.fold(split, c_inv);
                         // w_left + w_right^x
-                        wkey = wk_left.compress(wk_right, c);
+                        wkey.fold(split, c);
+                        compress_timer.stop();
 
                         comms_ab.emplace_back(std::make_pair(tab_l, tab_r));
                         comms_c.emplace_back(std::make_pair(tuc_l, tuc_r));
@@ -435,18 +709,53 @@ namespace nil {
                         challenges_inv.emplace_back(c_inv);
                     }
 
+                    gipa_timer.stop();
+
                     BOOST_ASSERT(m_a.size() == 1 && m_b.size() == 1);
                     BOOST_ASSERT(m_c.size() == 1 && m_r.size() == 1);
-                    BOOST_ASSERT(vkey.a.size() == 1 && vkey.b.size() == 1);
-                    BOOST_ASSERT(wkey.a.size() == 1 && wkey.b.size() == 1);
+                    BOOST_ASSERT(vkey.size() == 1 && wkey.size() == 1);
 
-                    return std::make_tuple(gipa_proof<CurveType> {input_len, comms_ab, comms_c, z_ab, z_c, m_a[0],
-                                                                  m_b[0], m_c[0], vkey.first(), wkey.first()},
-                                           challenges, challenges_inv);
+                    return std::make_tuple(gipa_proof<CurveType> {input_len, std::move(comms_ab), std::move(comms_c),
+                                                                  std::move(z_ab), std::move(z_c), m_a[0], m_b[0],
+                                                                  m_c[0], vkey.first(), wkey.first()},
+                                           std::move(challenges), std::move(challenges_inv));
+                }
+
+                /// Same as above with the keys folded from vkey_input and wkey_input under the bound of
+                /// gipa_memory_bound.
+                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputG1Iterator1,
+                         typename InputG2Iterator, typename InputG1Iterator2, typename InputScalarIterator>
+                typename std::enable_if<
+                    std::is_same<typename CurveType::g1_type::value_type,
+                                 typename std::iterator_traits<InputG1Iterator1>::value_type>::value &&
+                        std::is_same<typename CurveType::g2_type::value_type,
+                                     typename std::iterator_traits<InputG2Iterator>::value_type>::value &&
+                        std::is_same<typename CurveType::scalar_field_type::value_type,
+                                     typename std::iterator_traits<InputScalarIterator>::value_type>::value &&
+                        std::is_same<typename CurveType::g1_type::value_type,
+                                     typename std::iterator_traits<InputG1Iterator2>::value_type>::value,
+                    std::tuple<gipa_proof<CurveType>, std::vector<typename CurveType::scalar_field_type::value_type>,
+                               std::vector<typename CurveType::scalar_field_type::value_type>>>::type
+                    gipa_tipp_mipp(transcript<CurveType, Hash> &tr, InputG1Iterator1 a_first, InputG1Iterator1 a_last,
+                                   InputG2Iterator b_first, InputG2Iterator b_last, InputG1Iterator2 c_first,
+                                   InputG1Iterator2 c_last, const r1cs_gg_ppzksnark_ipp2_vkey<CurveType> &vkey_input,
+                                   const r1cs_gg_ppzksnark_ipp2_wkey<CurveType> &wkey_input,
+                                   InputScalarIterator r_first, InputScalarIterator r_last) {
+                    BOOST_ASSERT(vkey_input.has_correct_len(std::distance(r_first, r_last)));
+                    BOOST_ASSERT(wkey_input.has_correct_len(std::distance(r_first, r_last)));
+
+                    const std::size_t max_key_size = gipa_memory_bound::current();
+                    return gipa_tipp_mipp<CurveType, Hash>(
+                        tr, a_first, a_last, b_first, b_last, c_first, c_last,
+                        r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g2_type>(vkey_input,
+                                                                                                  max_key_size),
+                        r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g1_type>(wkey_input,
+                                                                                                  max_key_size),
+                        r_first, r_last);
                 }
 
                 /// Proves a TIPP relation between A and B as well as a MIPP relation with C and
-                /// r. Commitment keys must be of size of A, B and C. In the context of Groth16
+                /// r. Commitment keys must be of size of r, A, B and C at most as long. In the context of Groth16
                 /// aggregation, we have that B = B^r and wkey is scaled by r^{-1}. The
                 /// commitment key v is used to commit to A and C recursively in GIPA such that
                 /// only one KZG proof is needed for v. In the original paper version, since the
@@ -466,12 +775,16 @@ namespace nil {
                     prove_tipp_mipp(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
                                     transcript<CurveType, Hash> &tr, InputG1Iterator1 a_first, InputG1Iterator1 a_last,
                                     InputG2Iterator b_first, InputG2Iterator b_last, InputG1Iterator2 c_first,
-                                    InputG1Iterator2 c_last, const r1cs_gg_ppzksnark_ipp2_wkey<CurveType> &wkey,
+                                    InputG1Iterator2 c_last,
+                                    r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g1_type> wkey,
                                     InputScalarIterator r_first, InputScalarIterator r_last) {
                     typename CurveType::scalar_field_type::value_type r_shift = *(r_first + 1);
                     // Run GIPA
-                    auto [proof, challenges, challenges_inv] = gipa_tipp_mipp<CurveType>(
-                        tr, a_first, a_last, b_first, b_last, c_first, c_last, srs.vkey, wkey, r_first, r_last);
+                    auto [proof, challenges, challenges_inv] = gipa_tipp_mipp<CurveType, Hash>(
+                        tr, a_first, a_last, b_first, b_last, c_first, c_last,
+                        r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g2_type>(
+                            srs.vkey, gipa_memory_bound::current()),
+                        std::move(wkey), r_first, r_last);
 
                     // Prove final commitment keys are wellformed
                     // we reverse the transcript so the polynomial in kzg opening is constructed
@@ -492,62 +805,62 @@ namespace nil {
                     typename CurveType::scalar_field_type::value_type z = tr.read_challenge();
 
                     // Complete KZG proofs
-                    return tipp_mipp_proof<CurveType> {
-                        proof,
-                        prove_commitment_v<CurveType>(srs.h_alpha_powers.begin(), srs.h_alpha_powers.end(),
-                                                      srs.h_beta_powers.begin(), srs.h_beta_powers.end(),
-                                                      challenges_inv.begin(), challenges_inv.end(), z),
-                        prove_commitment_w<CurveType>(srs.g_alpha_powers.begin(), srs.g_alpha_powers.end(),
-                                                      srs.g_beta_powers.begin(), srs.g_beta_powers.end(),
-                                                      challenges.begin(), challenges.end(), r_inverse, z)};
+                    stage_profiler::timer opening_timer("kzg_opening", srs.g_alpha_powers.size());
+                    operation_counter::add(operation_counter::g1_exp_term, 2 * srs.g_alpha_powers.size());
+                    operation_counter::add(operation_counter::g2_exp_term, 2 * srs.h_alpha_powers.size());
+                    auto [vkey_opening, wkey_opening] =
+                        prove_commitment_keys<CurveType>(srs, challenges.begin(), challenges.end(),
+                                                         challenges_inv.begin(), challenges_inv.end(), r_inverse, z);
+                    return tipp_mipp_proof<CurveType> {proof, vkey_opening, wkey_opening};
                 }
 
-                /// Aggregate `n` zkSnark proofs, where `n` must be a power of two.
-                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputTranscriptIncludeIterator,
-                         typename InputProofIterator>
+                /// Same as above with wkey folded under the bound of gipa_memory_bound.
+                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputG1Iterator1,
+                         typename InputG2Iterator, typename InputG1Iterator2, typename InputScalarIterator>
+                typename std::enable_if<
+                    std::is_same<typename CurveType::g1_type::value_type,
+                                 typename std::iterator_traits<InputG1Iterator1>::value_type>::value &&
+                        std::is_same<typename CurveType::g2_type::value_type,
+                                     typename std::iterator_traits<InputG2Iterator>::value_type>::value &&
+                        std::is_same<typename CurveType::g1_type::value_type,
+                                     typename std::iterator_traits<InputG1Iterator2>::value_type>::value &&
+                        std::is_same<typename CurveType::scalar_field_type::value_type,
+                                     typename std::iterator_traits<InputScalarIterator>::value_type>::value,
+                    tipp_mipp_proof<CurveType>>::type
+                    prove_tipp_mipp(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
+                                    transcript<CurveType, Hash> &tr, InputG1Iterator1 a_first, InputG1Iterator1 a_last,
+                                    InputG2Iterator b_first, InputG2Iterator b_last, InputG1Iterator2 c_first,
+                                    InputG1Iterator2 c_last, const r1cs_gg_ppzksnark_ipp2_wkey<CurveType> &wkey,
+                                    InputScalarIterator r_first, InputScalarIterator r_last) {
+                    return prove_tipp_mipp(
+                        srs, tr, a_first, a_last, b_first, b_last, c_first, c_last,
+                        r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g1_type>(
+                            wkey, gipa_memory_bound::current()),
+                        r_first, r_last);
+                }
+
+                /// Second part of the aggregation of the proofs (a_i, b_i, c_i), once A and B, and C, are
+                /// committed to with the keys of srs. There may be fewer proofs than srs.n, the missing
+                /// ones being the identity.
+                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputTranscriptIncludeIterator>
                 typename std::enable_if<
                     std::is_same<std::uint8_t,
-                                 typename std::iterator_traits<InputTranscriptIncludeIterator>::value_type>::value &&
-                        std::is_same<typename std::iterator_traits<InputProofIterator>::value_type,
-                                     r1cs_gg_ppzksnark_proof<CurveType>>::value,
+                                 typename std::iterator_traits<InputTranscriptIncludeIterator>::value_type>::value,
                     r1cs_gg_ppzksnark_aggregate_proof<CurveType>>::type
-                    aggregate_proofs(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
-                                     InputTranscriptIncludeIterator tr_include_first,
-                                     InputTranscriptIncludeIterator tr_include_last, InputProofIterator proofs_first,
-                                     InputProofIterator proofs_last) {
-                    std::size_t nproofs = std::distance(proofs_first, proofs_last);
-                    BOOST_ASSERT(nproofs >= 2);
-                    BOOST_ASSERT((nproofs & (nproofs - 1)) == 0);
-                    BOOST_ASSERT(srs.has_correct_len(nproofs));
-
-                    // TODO: parallel
-                    // We first commit to A B and C - these commitments are what the verifier
-                    // will use later to verify the TIPP and MIPP proofs
-                    std::vector<typename CurveType::g1_type::value_type> a, c;
-                    std::vector<typename CurveType::g2_type::value_type> b;
-                    auto proofs_it = proofs_first;
-                    while (proofs_it != proofs_last) {
-                        a.emplace_back(proofs_it->g_A);
-                        b.emplace_back(proofs_it->g_B);
-                        c.emplace_back(proofs_it->g_C);
-                        ++proofs_it;
-                    }
-
-                    // A and B are committed together in this scheme
-                    // we need to take the reference so the macro doesn't consume the value
-                    // first
-                    typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type com_ab =
-                        r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::pair(srs.vkey, srs.wkey, a.begin(), a.end(),
-                                                                           b.begin(), b.end());
-                    typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type com_c =
-                        r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::single(srs.vkey, c.begin(), c.end());
+                    aggregate_committed_proofs(
+                        const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
+                        InputTranscriptIncludeIterator tr_include_first, InputTranscriptIncludeIterator tr_include_last,
+                        const std::vector<typename CurveType::g1_type::value_type> &a,
+                        const std::vector<typename CurveType::g2_type::value_type> &b,
+                        const std::vector<typename CurveType::g1_type::value_type> &c,
+                        const typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type &com_ab,
+                        const typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type &com_c) {
+                    BOOST_ASSERT(a.size() == b.size() && a.size() == c.size());
+                    BOOST_ASSERT(a.size() >= 1 && a.size() <= srs.n);
+                    BOOST_ASSERT(srs.has_correct_len(srs.n));
 
                     // Derive a random scalar to perform a linear combination of proofs
-                    constexpr std::array<std::uint8_t, 9> application_tag = {'s', 'n', 'a', 'r', 'k',
-                                                                             'p', 'a', 'c', 'k'};
-                    constexpr std::array<std::uint8_t, 8> domain_separator {'r', 'a', 'n', 'd', 'o', 'm', '-', 'r'};
-                    transcript<CurveType, Hash> tr(application_tag.begin(), application_tag.end());
-                    tr.write_domain_separator(domain_separator.begin(), domain_separator.end());
+                    transcript<CurveType, Hash> tr(transcript_prefix<CurveType, Hash, random_r_transcript_prefix>());
                     tr.template write<typename CurveType::gt_type>(com_ab.first);
                     tr.template write<typename CurveType::gt_type>(com_ab.second);
                     tr.template write<typename CurveType::gt_type>(com_c.first);
@@ -557,25 +870,23 @@ namespace nil {
 
                     // 1,r, r^2, r^3, r^4 ...
                     std::vector<typename CurveType::scalar_field_type::value_type> r_vec =
-                        structured_scalar_power<typename CurveType::scalar_field_type>(
-                            std::distance(proofs_first, proofs_last), r);
-                    // 1,r^-1, r^-2, r^-3
-                    std::vector<typename CurveType::scalar_field_type::value_type> r_inv;
-                    std::transform(r_vec.begin(), r_vec.end(), std::back_inserter(r_inv),
-                                   [](const auto &r_i) { return r_i.inversed(); });
+                        structured_scalar_power<typename CurveType::scalar_field_type>(srs.n, r);
+                    // 1,r^-1, r^-2, r^-3, as the powers of r^-1 rather than one inversion per power
+                    std::vector<typename CurveType::scalar_field_type::value_type> r_inv =
+                        structured_scalar_power<typename CurveType::scalar_field_type>(srs.n, r.inversed());
 
                     // B^{r}
-                    std::vector<typename CurveType::g2_type::value_type> b_r;
-                    std::for_each(
-                        boost::make_zip_iterator(boost::make_tuple(b.begin(), r_vec.begin())),
-                        boost::make_zip_iterator(boost::make_tuple(b.end(), r_vec.end())),
-                        [&](const boost::tuple<const typename CurveType::g2_type::value_type &,
-                                               const typename CurveType::scalar_field_type::value_type &> &t) {
-                            b_r.emplace_back((t.template get<0>() * t.template get<1>()));
-                        });
+                    stage_profiler::timer rescale_timer("rescale_B", b.size());
+                    std::vector<typename CurveType::g2_type::value_type> b_r =
+                        batch_scalar_mul<typename CurveType::g2_type, typename CurveType::scalar_field_type>(
+                            b.begin(), b.end(), r_vec.begin());
+                    rescale_timer.stop();
                     // TODO: parallel
                     // compute A * B^r for the verifier
                     // auto ip_ab = algebra::pair<CurveType>(a, b_r);
+                    stage_profiler::timer pairing_timer("pairing_product", a.size());
+                    operation_counter::add(operation_counter::miller_loop, a.size());
+                    operation_counter::add(operation_counter::final_exponentiation);
                     typename CurveType::gt_type::value_type ip_ab = CurveType::gt_type::value_type::one();
                     std::for_each(boost::make_zip_iterator(boost::make_tuple(a.begin(), b_r.begin())),
                                   boost::make_zip_iterator(boost::make_tuple(a.end(), b_r.end())),
@@ -585,29 +896,281 @@ namespace nil {
                                           ip_ab * algebra::pair<CurveType>(t.template get<0>(), t.template get<1>());
                                   });
                     ip_ab = algebra::final_exponentiation<CurveType>(ip_ab);
+                    pairing_timer.stop();
                     // compute C^r for the verifier
+                    stage_profiler::timer multiexp_timer("multiexp", c.size());
+                    operation_counter::add(operation_counter::g1_exp_term, c.size());
                     typename CurveType::g1_type::value_type agg_c =
-                        algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(c.begin(), c.end(),
-                                                                                         r_vec.begin(), r_vec.end(), 1);
+                        endomorphism_multiexp<typename CurveType::g1_type, multiexp_method_auto>(
+                            c.begin(), c.end(), r_vec.begin(), r_vec.begin() + c.size(),
+                            executor::current().concurrency());
+                    multiexp_timer.stop();
                     tr.template write<typename CurveType::gt_type>(ip_ab);
                     tr.template write<typename CurveType::g1_type>(agg_c);
 
-                    // w^{r^{-1}}
-                    r1cs_gg_ppzksnark_ipp2_commitment_key<typename CurveType::g1_type> wkey_r_inv =
-                        srs.wkey.scale(r_inv.begin(), r_inv.end());
+                    // w^{r^{-1}}, only materialised by GIPA once it fits the bound of gipa_memory_bound
+                    r1cs_gg_ppzksnark_ipp2_folded_commitment_key<typename CurveType::g1_type> wkey_r_inv(
+                        srs.wkey, gipa_memory_bound::current(), &r_inv);
 
                     // we prove tipp and mipp using the same recursive loop
                     tipp_mipp_proof<CurveType> proof =
                         prove_tipp_mipp(srs, tr, a.begin(), a.end(), b_r.begin(), b_r.end(), c.begin(), c.end(),
-                                        wkey_r_inv, r_vec.begin(), r_vec.end());
+                                        std::move(wkey_r_inv), r_vec.begin(), r_vec.end());
 
                     // debug assert
                     BOOST_ASSERT(com_ab == r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::pair(
-                                               srs.vkey, wkey_r_inv, a.begin(), a.end(), b_r.begin(), b_r.end()));
+                                               srs.vkey, srs.wkey.scale(r_inv.begin(), r_inv.end()), a.begin(),
+                                               a.end(), b_r.begin(), b_r.end()));
 
                     return {com_ab, com_c, ip_ab, agg_c, proof};
                 }
 
+                /// Commits to the proofs of a batch, with vkey being srs.vkey or its precomputed lines, and
+                /// aggregates them. The proofs are implicitly padded up to srs.n with the identity, which
+                /// costs nothing.
+                template<typename CurveType, typename Hash, typename VKey, typename InputTranscriptIncludeIterator>
+                r1cs_gg_ppzksnark_aggregate_proof<CurveType>
+                    commit_and_aggregate_proofs(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
+                                                const VKey &vkey, InputTranscriptIncludeIterator tr_include_first,
+                                                InputTranscriptIncludeIterator tr_include_last,
+                                                const r1cs_gg_ppzksnark_proof_batch<CurveType> &proofs) {
+                    std::size_t nproofs = proofs.size();
+                    BOOST_ASSERT(nproofs >= 1 && nproofs <= srs.n);
+                    BOOST_ASSERT(srs.n >= 2 && (srs.n & (srs.n - 1)) == 0);
+                    BOOST_ASSERT(srs.has_correct_len(srs.n));
+
+                    // We first commit to A B and C - these commitments are what the verifier
+                    // will use later to verify the TIPP and MIPP proofs
+                    // A and B are committed together in this scheme
+                    stage_profiler::timer commit_timer("commit", nproofs);
+                    typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type com_ab =
+                        r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::pair(
+                            vkey, srs.wkey, proofs.g_A.begin(), proofs.g_A.end(), proofs.g_B.begin(), proofs.g_B.end());
+                    typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type com_c =
+                        r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::single(vkey, proofs.g_C.begin(),
+                                                                             proofs.g_C.end());
+                    commit_timer.stop();
+
+                    return aggregate_committed_proofs<CurveType, Hash>(srs, tr_include_first, tr_include_last,
+                                                                       proofs.g_A, proofs.g_B, proofs.g_C, com_ab,
+                                                                       com_c);
+                }
+
+                /// Same as above for the proofs in [proofs_first, proofs_last).
+                template<typename CurveType, typename Hash, typename VKey, typename InputTranscriptIncludeIterator,
+                         typename InputProofIterator>
+                r1cs_gg_ppzksnark_aggregate_proof<CurveType>
+                    commit_and_aggregate_proofs(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
+                                                const VKey &vkey, InputTranscriptIncludeIterator tr_include_first,
+                                                InputTranscriptIncludeIterator tr_include_last,
+                                                InputProofIterator proofs_first, InputProofIterator proofs_last) {
+                    return commit_and_aggregate_proofs<CurveType, Hash>(
+                        srs, vkey, tr_include_first, tr_include_last,
+                        r1cs_gg_ppzksnark_proof_batch<CurveType>(proofs_first, proofs_last));
+                }
+
+                /// Aggregate up to `srs.n` zkSnark proofs, `srs.n` being a power of two. The verifier is
+                /// given the primary inputs of the aggregated proofs only, whatever their number.
+                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputTranscriptIncludeIterator,
+                         typename InputProofIterator>
+                typename std::enable_if<
+                    std::is_same<std::uint8_t,
+                                 typename std::iterator_traits<InputTranscriptIncludeIterator>::value_type>::value &&
+                        std::is_same<typename std::iterator_traits<InputProofIterator>::value_type,
+                                     r1cs_gg_ppzksnark_proof<CurveType>>::value,
+                    r1cs_gg_ppzksnark_aggregate_proof<CurveType>>::type
+                    aggregate_proofs(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
+                                     InputTranscriptIncludeIterator tr_include_first,
+                                     InputTranscriptIncludeIterator tr_include_last, InputProofIterator proofs_first,
+                                     InputProofIterator proofs_last) {
+                    return commit_and_aggregate_proofs<CurveType, Hash>(srs, srs.vkey, tr_include_first,
+                                                                        tr_include_last, proofs_first, proofs_last);
+                }
+
+                /// Same as above, the commitments to the proofs using the precomputed lines of the vkey.
+                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputTranscriptIncludeIterator,
+                         typename InputProofIterator>
+                typename std::enable_if<
+                    std::is_same<std::uint8_t,
+                                 typename std::iterator_traits<InputTranscriptIncludeIterator>::value_type>::value &&
+                        std::is_same<typename std::iterator_traits<InputProofIterator>::value_type,
+                                     r1cs_gg_ppzksnark_proof<CurveType>>::value,
+                    r1cs_gg_ppzksnark_aggregate_proof<CurveType>>::type
+                    aggregate_proofs(const r1cs_gg_ppzksnark_aggregate_prepared_proving_srs<CurveType> &prepared_srs,
+                                     InputTranscriptIncludeIterator tr_include_first,
+                                     InputTranscriptIncludeIterator tr_include_last, InputProofIterator proofs_first,
+                                     InputProofIterator proofs_last) {
+                    return commit_and_aggregate_proofs<CurveType, Hash>(prepared_srs.srs, prepared_srs.vkey,
+                                                                        tr_include_first, tr_include_last,
+                                                                        proofs_first, proofs_last);
+                }
+
+                /// Same as above for the proofs of a batch, whose A, B and C are committed to in place.
+                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputTranscriptIncludeIterator>
+                typename std::enable_if<
+                    std::is_same<std::uint8_t,
+                                 typename std::iterator_traits<InputTranscriptIncludeIterator>::value_type>::value,
+                    r1cs_gg_ppzksnark_aggregate_proof<CurveType>>::type
+                    aggregate_proofs(const r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> &srs,
+                                     InputTranscriptIncludeIterator tr_include_first,
+                                     InputTranscriptIncludeIterator tr_include_last,
+                                     const r1cs_gg_ppzksnark_proof_batch<CurveType> &proofs) {
+                    return commit_and_aggregate_proofs<CurveType, Hash>(srs, srs.vkey, tr_include_first,
+                                                                        tr_include_last, proofs);
+                }
+
+                /// Same as above, the commitments to the proofs using the precomputed lines of the vkey.
+                template<typename CurveType, typename Hash = hashes::sha2<256>, typename InputTranscriptIncludeIterator>
+                typename std::enable_if<
+                    std::is_same<std::uint8_t,
+                                 typename std::iterator_traits<InputTranscriptIncludeIterator>::value_type>::value,
+                    r1cs_gg_ppzksnark_aggregate_proof<CurveType>>::type
+                    aggregate_proofs(const r1cs_gg_ppzksnark_aggregate_prepared_proving_srs<CurveType> &prepared_srs,
+                                     InputTranscriptIncludeIterator tr_include_first,
+                                     InputTranscriptIncludeIterator tr_include_last,
+                                     const r1cs_gg_ppzksnark_proof_batch<CurveType> &proofs) {
+                    return commit_and_aggregate_proofs<CurveType, Hash>(prepared_srs.srs, prepared_srs.vkey,
+                                                                        tr_include_first, tr_include_last, proofs);
+                }
+
+                /// Incremental version of aggregate_proofs, for proofs produced one at a time.
+                ///
+                /// The aggregator is bound to a proving SRS specialized for n proofs, n being a power of two.
+                /// Each appended proof is folded into the Miller loops of the commitments to A and B, and to C,
+                /// so finalize only runs their final exponentiations before the rest of the aggregation.
+                /// Missing proofs are padded with copies of the last appended one, the verifier being given
+                /// its primary input as many times.
+                template<typename CurveType, typename Hash = hashes::sha2<256>>
+                class r1cs_gg_ppzksnark_ipp2_aggregator {
+                    typedef typename CurveType::pairing pairing_policy;
+
+                    typedef typename CurveType::g1_type::value_type g1_value_type;
+                    typedef typename CurveType::g2_type::value_type g2_value_type;
+                    typedef typename pairing_policy::fqk_type::value_type fqk_value_type;
+
+                public:
+                    typedef r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> proving_srs_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_prepared_proving_srs<CurveType> prepared_proving_srs_type;
+                    typedef typename prepared_proving_srs_type::prepared_vkey_type prepared_vkey_type;
+                    typedef r1cs_gg_ppzksnark_proof<CurveType> proof_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_proof<CurveType> aggregate_proof_type;
+
+                    explicit r1cs_gg_ppzksnark_ipp2_aggregator(const proving_srs_type &srs) :
+                        r1cs_gg_ppzksnark_ipp2_aggregator(srs, nullptr) {
+                    }
+
+                    /// The aggregator uses the precomputed lines of the vkey of prepared_srs, which must
+                    /// outlive it.
+                    explicit r1cs_gg_ppzksnark_ipp2_aggregator(const prepared_proving_srs_type &prepared_srs) :
+                        r1cs_gg_ppzksnark_ipp2_aggregator(prepared_srs.srs, &prepared_srs.vkey) {
+                    }
+
+                private:
+                    r1cs_gg_ppzksnark_ipp2_aggregator(const proving_srs_type &srs, const prepared_vkey_type *vkey) :
+                        srs(srs), prepared_vkey(vkey), t_ab(fqk_value_type::one()), u_ab(fqk_value_type::one()),
+                        t_c(fqk_value_type::one()), u_c(fqk_value_type::one()) {
+                        BOOST_ASSERT(capacity() >= 2);
+                        BOOST_ASSERT((capacity() & (capacity() - 1)) == 0);
+                        BOOST_ASSERT(srs.has_correct_len(capacity()));
+
+                        a.reserve(capacity());
+                        b.reserve(capacity());
+                        c.reserve(capacity());
+                    }
+
+                public:
+                    /// Number of proofs appended so far.
+                    std::size_t size() const {
+                        return a.size();
+                    }
+
+                    /// Number of proofs aggregated by finalize, padding included.
+                    std::size_t capacity() const {
+                        return srs.vkey.a.size();
+                    }
+
+                    void append(const proof_type &proof) {
+                        BOOST_ASSERT(size() < capacity());
+
+                        accumulate(proof.g_A, proof.g_B, proof.g_C);
+                    }
+
+                    /// Pads the appended proofs up to capacity() and aggregates them; the aggregator is full
+                    /// afterwards.
+                    template<typename InputTranscriptIncludeIterator>
+                    typename std::enable_if<
+                        std::is_same<std::uint8_t,
+                                     typename std::iterator_traits<InputTranscriptIncludeIterator>::value_type>::value,
+                        aggregate_proof_type>::type
+                        finalize(InputTranscriptIncludeIterator tr_include_first,
+                                 InputTranscriptIncludeIterator tr_include_last) {
+                        BOOST_ASSERT(size() > 0);
+
+                        while (size() < capacity()) {
+                            const g1_value_type last_a = a.back(), last_c = c.back();
+                            const g2_value_type last_b = b.back();
+                            accumulate(last_a, last_b, last_c);
+                        }
+
+                        operation_counter::add(operation_counter::final_exponentiation, 4);
+                        const typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type com_ab =
+                            std::make_pair(algebra::final_exponentiation<CurveType>(t_ab),
+                                           algebra::final_exponentiation<CurveType>(u_ab));
+                        const typename r1cs_gg_ppzksnark_ipp2_commitment<CurveType>::output_type com_c =
+                            std::make_pair(algebra::final_exponentiation<CurveType>(t_c),
+                                           algebra::final_exponentiation<CurveType>(u_c));
+
+                        return aggregate_committed_proofs<CurveType, Hash>(srs, tr_include_first, tr_include_last, a,
+                                                                           b, c, com_ab, com_c);
+                    }
+
+                private:
+                    /// Multiplies in the i-th terms of the commitments of r1cs_gg_ppzksnark_ipp2_commitment:
+                    /// e(a_i, v_{1,i})e(w_{1,i}, b_i) and e(a_i, v_{2,i})e(w_{2,i}, b_i) for A and B,
+                    /// e(c_i, v_{1,i}) and e(c_i, v_{2,i}) for C.
+                    void accumulate(const g1_value_type &g_A, const g2_value_type &g_B, const g1_value_type &g_C) {
+                        const std::size_t i = size();
+
+                        const typename pairing_policy::g1_precomp a_precomp = pairing_policy::precompute_g1(g_A);
+                        const typename pairing_policy::g2_precomp b_precomp = pairing_policy::precompute_g2(g_B);
+                        const typename pairing_policy::g1_precomp c_precomp = pairing_policy::precompute_g1(g_C);
+                        typename pairing_policy::g2_precomp v1_lines, v2_lines;
+                        if (!prepared_vkey) {
+                            v1_lines = pairing_policy::precompute_g2(srs.vkey.a[i]);
+                            v2_lines = pairing_policy::precompute_g2(srs.vkey.b[i]);
+                        }
+                        const typename pairing_policy::g2_precomp &v1_precomp =
+                            prepared_vkey ? prepared_vkey->a[i] : v1_lines;
+                        const typename pairing_policy::g2_precomp &v2_precomp =
+                            prepared_vkey ? prepared_vkey->b[i] : v2_lines;
+
+                        t_ab = t_ab * pairing_policy::double_miller_loop(
+                                          a_precomp, v1_precomp, pairing_policy::precompute_g1(srs.wkey.a[i]),
+                                          b_precomp);
+                        u_ab = u_ab * pairing_policy::double_miller_loop(
+                                          a_precomp, v2_precomp, pairing_policy::precompute_g1(srs.wkey.b[i]),
+                                          b_precomp);
+                        t_c = t_c * pairing_policy::miller_loop(c_precomp, v1_precomp);
+                        u_c = u_c * pairing_policy::miller_loop(c_precomp, v2_precomp);
+                        operation_counter::add(operation_counter::miller_loop, 6);
+
+                        a.emplace_back(g_A);
+                        b.emplace_back(g_B);
+                        c.emplace_back(g_C);
+                    }
+
+                    const proving_srs_type &srs;
+                    /// lines of srs.vkey, if precomputed
+                    const prepared_vkey_type *prepared_vkey;
+
+                    std::vector<g1_value_type> a, c;
+                    std::vector<g2_value_type> b;
+
+                    /// Miller loop products of the commitments to A and B, and to C
+                    fqk_value_type t_ab, u_ab;
+                    fqk_value_type t_c, u_c;
+                };
+
                 template<typename CurveType, typename BasicProver>
                 class r1cs_gg_ppzksnark_aggregate_prover {
                     typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Aggregate> policy_type;
@@ -623,20 +1186,27 @@ namespace nil {
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
 
                     typedef typename policy_type::srs_type srs_type;
                     typedef typename policy_type::proving_srs_type proving_srs_type;
+                    typedef typename policy_type::prepared_proving_srs_type prepared_proving_srs_type;
                     typedef typename policy_type::verification_srs_type verification_srs_type;
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::srs_pair_type srs_pair_type;
 
                     typedef typename policy_type::proof_type proof_type;
+                    typedef typename policy_type::proof_batch_type proof_batch_type;
                     typedef typename policy_type::aggregate_proof_type aggregate_proof_type;
 
+                    template<typename Hash>
+                    using aggregator_type = r1cs_gg_ppzksnark_ipp2_aggregator<CurveType, Hash>;
+
                     // Aggregate prove
                     template<typename Hash, typename InputTranscriptIncludeIterator, typename InputProofIterator>
                     static inline aggregate_proof_type process(const proving_srs_type &srs,
@@ -648,10 +1218,41 @@ namespace nil {
                                                                  proofs_first, proofs_last);
                     }
 
+                    // Aggregate prove with the precomputed lines of the vkey
+                    template<typename Hash, typename InputTranscriptIncludeIterator, typename InputProofIterator>
+                    static inline aggregate_proof_type process(const prepared_proving_srs_type &prepared_srs,
+                                                               InputTranscriptIncludeIterator transcript_include_first,
+                                                               InputTranscriptIncludeIterator transcript_include_last,
+                                                               InputProofIterator proofs_first,
+                                                               InputProofIterator proofs_last) {
+                        return aggregate_proofs<CurveType, Hash>(prepared_srs, transcript_include_first,
+                                                                 transcript_include_last, proofs_first, proofs_last);
+                    }
+
+                    // Aggregate prove of a proof batch
+                    template<typename Hash, typename InputTranscriptIncludeIterator>
+                    static inline aggregate_proof_type process(const proving_srs_type &srs,
+                                                               InputTranscriptIncludeIterator transcript_include_first,
+                                                               InputTranscriptIncludeIterator transcript_include_last,
+                                                               const proof_batch_type &proofs) {
+                        return aggregate_proofs<CurveType, Hash>(srs, transcript_include_first, transcript_include_last,
+                                                                 proofs);
+                    }
+
+                    // Aggregate prove of a proof batch with the precomputed lines of the vkey
+                    template<typename Hash, typename InputTranscriptIncludeIterator>
+                    static inline aggregate_proof_type process(const prepared_proving_srs_type &prepared_srs,
+                                                               InputTranscriptIncludeIterator transcript_include_first,
+                                                               InputTranscriptIncludeIterator transcript_include_last,
+                                                               const proof_batch_type &proofs) {
+                        return aggregate_proofs<CurveType, Hash>(prepared_srs, transcript_include_first,
+                                                                 transcript_include_last, proofs);
+                    }
+
                     // Basic prove
                     static inline proof_type process(const proving_key_type &pk,
-                                                     const primary_input_type &primary_input,
-                                                     const auxiliary_input_type &auxiliary_input) {
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
 
                         return BasicProver::process(pk, primary_input, auxiliary_input);
                     }
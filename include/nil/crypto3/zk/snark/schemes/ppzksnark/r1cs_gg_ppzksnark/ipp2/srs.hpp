@@ -27,9 +27,21 @@
 #ifndef CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_SRS_HPP
 #define CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_SRS_HPP
 
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <tuple>
+#include <utility>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/keypair.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/commitment.hpp>
@@ -38,17 +50,32 @@ namespace nil {
     namespace crypto3 {
         namespace zk {
             namespace snark {
+                /// Returns $\{g^{s^i}\}_{i=0}^{n-1}$, g being the generator of GroupType.
+                /// The powers of s are computed per block of the current executor, from $s^{first}$ on,
+                /// and every $g^{s^i}$ is a fixed-base exponentiation through the shared engine of g.
                 template<typename GroupType,
                          typename ScalarFieldType = typename GroupType::curve_type::scalar_field_type>
                 std::vector<typename GroupType::value_type>
                     structured_generators_scalar_power(std::size_t n, const typename ScalarFieldType::value_type &s) {
                     BOOST_ASSERT(n > 0);
 
-                    std::vector<typename GroupType::value_type> powers_of_g {GroupType::value_type::one()};
+                    const std::shared_ptr<const fixed_base_engine<GroupType, ScalarFieldType>> engine =
+                        fixed_base_engine<GroupType, ScalarFieldType>::shared(GroupType::value_type::one(), n);
 
-                    for (std::size_t i = 1; i < n; i++) {
-                        powers_of_g.emplace_back(powers_of_g.back() * s);
-                    }
+                    std::vector<typename GroupType::value_type> powers_of_g(n);
+
+                    const std::size_t num_blocks = std::min(n, executor::current().concurrency());
+                    const std::size_t block_size = (n + num_blocks - 1) / num_blocks;
+                    executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                        const std::size_t first = block * block_size;
+                        const std::size_t last = std::min(n, first + block_size);
+
+                        typename ScalarFieldType::value_type power = s.pow(first);
+                        for (std::size_t i = first; i < last; ++i) {
+                            powers_of_g[i] = engine->exp(power);
+                            power = power * s;
+                        }
+                    });
 
                     return powers_of_g;
                 }
@@ -110,6 +137,51 @@ namespace nil {
                     typename CurveType::g2_type::value_type h_beta;
                 };
 
+                /// Proving SRS along with the Miller loop lines of its fixed vkey, which every aggregation
+                /// pairs the proofs against when committing to them. Preparing it once saves the G2 line
+                /// computations of these commitments, at the cost of the memory of 2n lines.
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_aggregate_prepared_proving_srs {
+                    typedef CurveType curve_type;
+
+                    typedef r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> proving_srs_type;
+                    typedef typename proving_srs_type::commitment_type::prepared_vkey_type prepared_vkey_type;
+
+                    explicit r1cs_gg_ppzksnark_aggregate_prepared_proving_srs(const proving_srs_type &srs) :
+                        srs(srs), vkey(srs.vkey) {
+                    }
+
+                    explicit r1cs_gg_ppzksnark_aggregate_prepared_proving_srs(proving_srs_type &&srs) :
+                        srs(std::move(srs)), vkey(this->srs.vkey) {
+                    }
+
+                    proving_srs_type srs;
+                    /// lines of srs.vkey
+                    prepared_vkey_type vkey;
+                };
+
+                /// Verification SRS along with the Miller loop lines of h, h^a and h^b, the fixed G2
+                /// elements of the KZG checks of the final w key.
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_aggregate_prepared_verification_srs {
+                    typedef CurveType curve_type;
+                    typedef typename curve_type::pairing pairing_policy;
+                    typedef typename pairing_policy::g2_precomp g2_precomp;
+
+                    typedef r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> verification_srs_type;
+
+                    explicit r1cs_gg_ppzksnark_aggregate_prepared_verification_srs(const verification_srs_type &srs) :
+                        srs(srs), h_precomp(pairing_policy::precompute_g2(srs.h)),
+                        h_alpha_precomp(pairing_policy::precompute_g2(srs.h_alpha)),
+                        h_beta_precomp(pairing_policy::precompute_g2(srs.h_beta)) {
+                    }
+
+                    verification_srs_type srs;
+                    g2_precomp h_precomp;
+                    g2_precomp h_alpha_precomp;
+                    g2_precomp h_beta_precomp;
+                };
+
                 /// It contains the maximum number of raw elements of the SRS needed to aggregate and verify
                 /// Groth16 proofs. One can derive specialized prover and verifier key for _specific_ size of
                 /// aggregations by calling `srs.specialize(n)`. The specialized prover key also contains
@@ -131,6 +203,9 @@ namespace nil {
                     typedef r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> verification_srs_type;
                     typedef std::pair<proving_srs_type, verification_srs_type> srs_pair_type;
 
+                    /// the largest number of proofs an aggregate proof may claim, as in bellperson
+                    static constexpr const std::size_t MAX_SRS_SIZE = (std::size_t(2) << 19) + 1;
+
                     /// $\{g^a^i\}_{i=0}^{N}$ where N is the smallest size of the two Groth16 CRS.
                     std::vector<g1_value_type> g_alpha_powers;
                     /// $\{h^a^i\}_{i=0}^{N}$ where N is the smallest size of the two Groth16 CRS.
@@ -153,14 +228,26 @@ namespace nil {
                     /// proofs to aggregate. The number of proofs MUST BE a power of two, it
                     /// panics otherwise. The number of proofs must be inferior to half of the
                     /// size of the generic srs otherwise it panics.
-                    srs_pair_type specialize(std::size_t num_proofs) {
+                    srs_pair_type specialize(std::size_t num_proofs) const {
+                        return specialize(num_proofs, g_alpha_powers.begin(), g_alpha_powers.end(),
+                                          h_alpha_powers.begin(), h_alpha_powers.end(), g_beta_powers.begin(),
+                                          g_beta_powers.end(), h_beta_powers.begin(), h_beta_powers.end());
+                    }
+
+                    /// Same as above, for the powers of a generic srs stored elsewhere, such as a mapped file.
+                    template<typename InputG1Iterator, typename InputG2Iterator>
+                    static srs_pair_type specialize(std::size_t num_proofs, InputG1Iterator g_alpha_first,
+                                                    InputG1Iterator g_alpha_last, InputG2Iterator h_alpha_first,
+                                                    InputG2Iterator h_alpha_last, InputG1Iterator g_beta_first,
+                                                    InputG1Iterator g_beta_last, InputG2Iterator h_beta_first,
+                                                    InputG2Iterator h_beta_last) {
                         BOOST_ASSERT(num_proofs > 0 && (num_proofs & (num_proofs - 1)) == 0);
 
                         std::size_t tn = 2 * num_proofs;    // size of the CRS we need
-                        BOOST_ASSERT(g_alpha_powers.size() >= tn);
-                        BOOST_ASSERT(h_alpha_powers.size() >= tn);
-                        BOOST_ASSERT(g_beta_powers.size() >= tn);
-                        BOOST_ASSERT(h_beta_powers.size() >= tn);
+                        BOOST_ASSERT(static_cast<std::size_t>(std::distance(g_alpha_first, g_alpha_last)) >= tn);
+                        BOOST_ASSERT(static_cast<std::size_t>(std::distance(h_alpha_first, h_alpha_last)) >= tn);
+                        BOOST_ASSERT(static_cast<std::size_t>(std::distance(g_beta_first, g_beta_last)) >= tn);
+                        BOOST_ASSERT(static_cast<std::size_t>(std::distance(h_beta_first, h_beta_last)) >= tn);
 
                         std::size_t n = num_proofs;
                         // when doing the KZG opening we need _all_ coefficients from 0
@@ -169,38 +256,82 @@ namespace nil {
                         std::size_t g_up = tn;
                         std::size_t h_low = 0;
                         std::size_t h_up = h_low + n;
-                        std::vector<typename CurveType::g2_type::value_type> v1 = {h_alpha_powers.begin() + h_low,
-                                                                                   h_alpha_powers.begin() + h_up};
-                        std::vector<typename CurveType::g2_type::value_type> v2 = {h_beta_powers.begin() + h_low,
-                                                                                   h_beta_powers.begin() + h_up};
+                        std::vector<typename CurveType::g2_type::value_type> v1 = {h_alpha_first + h_low,
+                                                                                   h_alpha_first + h_up};
+                        std::vector<typename CurveType::g2_type::value_type> v2 = {h_beta_first + h_low,
+                                                                                   h_beta_first + h_up};
                         typename proving_srs_type::vkey_type vkey = {v1, v2};
                         BOOST_ASSERT(vkey.has_correct_len(n));
                         // however, here we only need the "right" shifted bases for the
                         // commitment scheme.
-                        std::vector<typename CurveType::g1_type::value_type> w1 = {g_alpha_powers.begin() + n,
-                                                                                   g_alpha_powers.begin() + g_up};
-                        std::vector<typename CurveType::g1_type::value_type> w2 = {g_beta_powers.begin() + n,
-                                                                                   g_beta_powers.begin() + g_up};
+                        std::vector<typename CurveType::g1_type::value_type> w1 = {g_alpha_first + n,
+                                                                                   g_alpha_first + g_up};
+                        std::vector<typename CurveType::g1_type::value_type> w2 = {g_beta_first + n,
+                                                                                   g_beta_first + g_up};
                         typename proving_srs_type::wkey_type wkey = {w1, w2};
                         BOOST_ASSERT(wkey.has_correct_len(n));
 
                         proving_srs_type pk = {n,
-                                               {g_alpha_powers.begin() + g_low, g_alpha_powers.begin() + g_up},
-                                               {h_alpha_powers.begin() + h_low, h_alpha_powers.begin() + h_up},
-                                               {g_beta_powers.begin() + g_low, g_beta_powers.begin() + g_up},
-                                               {h_beta_powers.begin() + h_low, h_beta_powers.begin() + h_up},
+                                               {g_alpha_first + g_low, g_alpha_first + g_up},
+                                               {h_alpha_first + h_low, h_alpha_first + h_up},
+                                               {g_beta_first + g_low, g_beta_first + g_up},
+                                               {h_beta_first + h_low, h_beta_first + h_up},
                                                vkey,
                                                wkey};
                         verification_srs_type vk = {n,
-                                                    g_alpha_powers[0],
-                                                    h_alpha_powers[0],
-                                                    g_alpha_powers[1],
-                                                    g_beta_powers[1],
-                                                    h_alpha_powers[1],
-                                                    h_beta_powers[1]};
+                                                    *g_alpha_first,
+                                                    *h_alpha_first,
+                                                    *(g_alpha_first + 1),
+                                                    *(g_beta_first + 1),
+                                                    *(h_alpha_first + 1),
+                                                    *(h_beta_first + 1)};
                         return std::make_pair(pk, vk);
                     }
                 };
+
+                /// Cache of the prover and verifier SRS specialized from a generic SRS, one per number of
+                /// proofs. Each size is specialized once, on first use, and the specialized SRS is shared by
+                /// all the aggregations of that size afterwards. SRSType is either
+                /// r1cs_gg_pp_zksnark_aggregate_srs or its memory-mapped counterpart; the cache keeps it
+                /// alive. It may be used from several threads.
+                template<typename SRSType>
+                class r1cs_gg_pp_zksnark_aggregate_srs_cache {
+                public:
+                    typedef SRSType srs_type;
+                    typedef typename srs_type::srs_pair_type srs_pair_type;
+
+                    explicit r1cs_gg_pp_zksnark_aggregate_srs_cache(std::shared_ptr<const srs_type> srs) :
+                        srs(std::move(srs)) {
+                        BOOST_ASSERT(this->srs);
+                    }
+
+                    /// Returns the prover and verifier SRS for num_proofs, specializing them on the first call.
+                    std::shared_ptr<const srs_pair_type> specialize(std::size_t num_proofs) const {
+                        std::lock_guard<std::mutex> lock(mutex);
+
+                        std::shared_ptr<const srs_pair_type> &specialized = cache[num_proofs];
+                        if (!specialized) {
+                            specialized = std::make_shared<const srs_pair_type>(srs->specialize(num_proofs));
+                        }
+                        return specialized;
+                    }
+
+                    /// Drops the specialized SRS for num_proofs; it lives on as long as a caller holds it.
+                    void erase(std::size_t num_proofs) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        cache.erase(num_proofs);
+                    }
+
+                    const srs_type &generic_srs() const {
+                        return *srs;
+                    }
+
+                private:
+                    std::shared_ptr<const srs_type> srs;
+
+                    mutable std::mutex mutex;
+                    mutable std::map<std::size_t, std::shared_ptr<const srs_pair_type>> cache;
+                };
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
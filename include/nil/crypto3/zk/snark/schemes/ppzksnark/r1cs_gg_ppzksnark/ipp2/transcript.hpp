@@ -27,6 +27,8 @@
 #ifndef CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_TRANSCRIPT_HPP
 #define CRYPTO3_R1CS_GG_PPZKSNARK_AGGREGATE_IPP2_TRANSCRIPT_HPP
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <type_traits>
 #include <iterator>
@@ -38,10 +40,21 @@
 
 #include <nil/crypto3/algebra/marshalling.hpp>
 
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
             namespace snark {
+                /// Fiat-Shamir transcript of the aggregation, hashing with Hash every value it is given.
+                ///
+                /// Values are serialized into a buffer reserved once, and bytes are hashed in place, so writing
+                /// to the transcript does not allocate. Consecutive field and group elements are serialized
+                /// one after another and absorbed together once the buffer is full or before anything else
+                /// updates or reads the hasher; the hash is streamed, so this gives the same state as
+                /// absorbing them one at a time, with one hasher update per batch_bytes instead of one per
+                /// element.
                 template<typename CurveType = algebra::curves::bls12<381>, typename Hash = hashes::sha2<256>>
                 struct transcript {
                     typedef CurveType curve_type;
@@ -49,6 +62,12 @@ namespace nil {
 
                     typedef marshalling::curve_bincode<curve_type> bincode;
 
+                    /// State of a transcript, from which others are forked.
+                    typedef ::nil::crypto3::accumulator_set<Hash> snapshot_type;
+
+                    /// Bytes of elements absorbed at once, unless a single element is larger.
+                    constexpr static const std::size_t batch_bytes = 4096;
+
                     std::vector<std::uint8_t> buffer;
                     ::nil::crypto3::accumulator_set<Hash> hasher_acc;
 
@@ -58,9 +77,26 @@ namespace nil {
                             std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
                             bool>::type = true>
                     transcript(InputIterator first, InputIterator last) {
-                        buffer.insert(buffer.end(), first, last);
-                        hash<hash_type>(buffer, hasher_acc);
-                        buffer.clear();
+                        reserve_buffer();
+                        operation_counter::add(operation_counter::hash_byte, std::distance(first, last));
+                        hash<hash_type>(first, last, hasher_acc);
+                    }
+
+                    /// Forks a transcript from snapshot: it goes on from the state of the transcript the
+                    /// snapshot was taken of, without hashing again what was written to it.
+                    explicit transcript(const snapshot_type &snapshot) : hasher_acc(snapshot) {
+                        reserve_buffer();
+                    }
+
+                    /// The state after everything written so far, the pending bytes being absorbed into a copy
+                    /// of the hasher state. That state is fixed-size, so taking a snapshot or forking one does
+                    /// not allocate.
+                    snapshot_type snapshot() const {
+                        snapshot_type state = hasher_acc;
+                        if (!buffer.empty()) {
+                            hash<hash_type>(buffer.begin(), buffer.end(), state);
+                        }
+                        return state;
                     }
 
                     template<
@@ -69,9 +105,10 @@ namespace nil {
                             std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
                             bool>::type = true>
                     inline void write_domain_separator(InputIterator first, InputIterator last) {
-                        buffer.insert(buffer.end(), first, last);
-                        hash<hash_type>(buffer, hasher_acc);
-                        buffer.clear();
+                        stage_profiler::timer transcript_timer("transcript", std::distance(first, last));
+                        flush();
+                        operation_counter::add(operation_counter::hash_byte, std::distance(first, last));
+                        hash<hash_type>(first, last, hasher_acc);
                     }
 
                     template<typename FieldType>
@@ -80,20 +117,32 @@ namespace nil {
                         std::is_same<typename curve_type::scalar_field_type, FieldType>::value ||
                         std::is_same<typename curve_type::gt_type, FieldType>::value>::type
                         write(const typename FieldType::value_type &x) {
-                        buffer.resize(bincode::template get_element_size<FieldType>());
-                        bincode::template field_element_to_bytes<FieldType>(x, buffer.begin(), buffer.end());
-                        hash<hash_type>(buffer, hasher_acc);
-                        buffer.clear();
+                        stage_profiler::timer transcript_timer("transcript",
+                                                               bincode::template get_element_size<FieldType>());
+                        const auto out = append(bincode::template get_element_size<FieldType>());
+                        bincode::template field_element_to_bytes<FieldType>(x, out, buffer.end());
                     }
 
                     template<typename GroupType>
                     inline typename std::enable_if<std::is_same<typename curve_type::g1_type, GroupType>::value ||
                                                    std::is_same<typename curve_type::g2_type, GroupType>::value>::type
                         write(const typename GroupType::value_type &x) {
-                        buffer.resize(bincode::template get_element_size<GroupType>());
-                        bincode::template point_to_bytes<GroupType>(x, buffer.begin(), buffer.end());
-                        hash<hash_type>(buffer, hasher_acc);
-                        buffer.clear();
+                        stage_profiler::timer transcript_timer("transcript",
+                                                               bincode::template get_element_size<GroupType>());
+                        const auto out = append(bincode::template get_element_size<GroupType>());
+                        bincode::template point_to_bytes<GroupType>(x, out, buffer.end());
+                    }
+
+                    /// Writes the elements [first, last) of FieldOrGroupType one after another, absorbed
+                    /// batch_bytes at a time; the result is the same as writing them one at a time.
+                    template<typename FieldOrGroupType, typename InputIterator>
+                    inline typename std::enable_if<
+                        std::is_same<typename FieldOrGroupType::value_type,
+                                     typename std::iterator_traits<InputIterator>::value_type>::value>::type
+                        write(InputIterator first, InputIterator last) {
+                        for (; first != last; ++first) {
+                            write<FieldOrGroupType>(*first);
+                        }
                     }
 
                     template<typename InputIterator>
@@ -101,22 +150,26 @@ namespace nil {
                         std::is_same<std::uint8_t,
                                      typename std::iterator_traits<InputIterator>::value_type>::value>::type
                         write(InputIterator first, InputIterator last) {
+                        stage_profiler::timer transcript_timer("transcript", std::distance(first, last));
+                        flush();
                         std::array<std::uint8_t, sizeof(std::uint64_t)> len_bytes;
                         nil::crypto3::detail::pack<stream_endian::little_byte_big_bit,
                                                    stream_endian::big_byte_big_bit,
                                                    sizeof(std::uint64_t) * 8,
                                                    8>(
-                            std::vector<std::uint64_t> {
+                            std::array<std::uint64_t, 1> {
                                 static_cast<std::uint64_t>(std::distance(first, last)),
                             },
                             len_bytes);
-                        buffer.insert(buffer.end(), len_bytes.begin(), len_bytes.end());
-                        buffer.insert(buffer.end(), first, last);
-                        hash<hash_type>(buffer, hasher_acc);
-                        buffer.clear();
+                        operation_counter::add(operation_counter::hash_byte,
+                                               len_bytes.size() + std::distance(first, last));
+                        hash<hash_type>(len_bytes.begin(), len_bytes.end(), hasher_acc);
+                        hash<hash_type>(first, last, hasher_acc);
                     }
 
                     inline typename curve_type::scalar_field_type::value_type read_challenge() {
+                        stage_profiler::timer transcript_timer("transcript");
+                        flush();
                         auto hasher_state = hasher_acc;
                         std::size_t counter_nonce = 0;
                         std::array<std::uint8_t, sizeof(std::size_t)> counter_nonce_bytes;
@@ -126,11 +179,12 @@ namespace nil {
                                                        stream_endian::little_byte_big_bit,
                                                        sizeof(std::size_t) * 8,
                                                        8>(
-                                std::vector<std::size_t> {
+                                std::array<std::size_t, 1> {
                                     counter_nonce,
                                 },
                                 counter_nonce_bytes);
 
+                            operation_counter::add(operation_counter::hash_byte, counter_nonce_bytes.size());
                             hash<hash_type>(counter_nonce_bytes, hasher_state);
                             typename hash_type::digest_type hasher_res =
                                 boost::accumulators::extract_result<typename boost::mpl::front<
@@ -147,7 +201,60 @@ namespace nil {
                             return hasher_res_deser.second;
                         }
                     }
+
+                private:
+                    void reserve_buffer() {
+                        const std::size_t gt_size = bincode::template get_element_size<typename curve_type::gt_type>();
+                        buffer.reserve(std::max(batch_bytes, gt_size));
+                    }
+
+                    /* Grows the pending bytes by size, absorbing them first if they would not fit. */
+                    std::vector<std::uint8_t>::iterator append(const std::size_t size) {
+                        if (buffer.size() + size > buffer.capacity()) {
+                            flush();
+                        }
+                        operation_counter::add(operation_counter::hash_byte, size);
+                        buffer.resize(buffer.size() + size);
+                        return buffer.end() - size;
+                    }
+
+                    void flush() {
+                        if (buffer.empty()) {
+                            return;
+                        }
+                        hash<hash_type>(buffer.begin(), buffer.end(), hasher_acc);
+                        buffer.clear();
+                    }
+                };
+
+                /// The static prefix of the transcript of the random linear combination of the proofs,
+                /// shared by the aggregation and the verification of an aggregate.
+                struct random_r_transcript_prefix {
+                    constexpr static const std::array<std::uint8_t, 9> application_tag = {'s', 'n', 'a', 'r', 'k',
+                                                                                          'p', 'a', 'c', 'k'};
+                    constexpr static const std::array<std::uint8_t, 8> domain_separator = {'r', 'a', 'n', 'd',
+                                                                                           'o', 'm', '-', 'r'};
+                };
+
+                /// The static prefix of the transcript of the coefficients of a batch of aggregates.
+                struct aggregate_batch_transcript_prefix {
+                    constexpr static const std::array<std::uint8_t, 9> application_tag = {'s', 'n', 'a', 'r', 'k',
+                                                                                          'p', 'a', 'c', 'k'};
+                    constexpr static const std::array<std::uint8_t, 15> domain_separator = {
+                        'a', 'g', 'g', 'r', 'e', 'g', 'a', 't', 'e', '-', 'b', 'a', 't', 'c', 'h'};
                 };
+
+                /// Snapshot of a transcript after the application tag and the domain separator of Prefix,
+                /// hashed once per process; the transcripts starting with them are forked from it.
+                template<typename CurveType, typename Hash, typename Prefix>
+                const typename transcript<CurveType, Hash>::snapshot_type &transcript_prefix() {
+                    static const typename transcript<CurveType, Hash>::snapshot_type snapshot = [] {
+                        transcript<CurveType, Hash> tr(Prefix::application_tag.begin(), Prefix::application_tag.end());
+                        tr.write_domain_separator(Prefix::domain_separator.begin(), Prefix::domain_separator.end());
+                        return tr.snapshot();
+                    }();
+                    return snapshot;
+                }
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -26,9 +26,14 @@
 #ifndef CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_VERIFICATION_KEY_HPP
 #define CRYPTO3_R1CS_GG_PPZKSNARK_IPP2_VERIFICATION_KEY_HPP
 
+#include <vector>
+
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verification_key.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -67,6 +72,62 @@ namespace nil {
                             algebra::pair_reduced<curve_type>(alpha_g1, beta_g2, gamma_g2, delta_g2, gamma_ABC_g1));
                     }
                 };
+
+                /// Groth16 verifying key prepared together with the verifier SRS for repeated
+                /// verifications of aggregates: it holds the Miller loop lines of all the fixed G2
+                /// elements the aggregate verifier pairs against, those of the SRS and beta, gamma
+                /// and delta of the key. A non-zero window additionally expands gamma_ABC_g1 into
+                /// fixed-base tables, each taking ceil(scalar_bits / window) times the memory of its
+                /// element, which turns the r-weighted multi-exponentiation of the public inputs
+                /// into a single bucket pass.
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_aggregate_processed_verification_key {
+                    typedef CurveType curve_type;
+                    typedef typename curve_type::pairing pairing_policy;
+                    typedef typename pairing_policy::g2_precomp g2_precomp;
+
+                    typedef r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> verification_srs_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_prepared_verification_srs<CurveType>
+                        prepared_verification_srs_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_verification_key<CurveType> verification_key_type;
+
+                    r1cs_gg_ppzksnark_aggregate_processed_verification_key(const prepared_verification_srs_type &srs,
+                                                                           const verification_key_type &vk,
+                                                                           std::size_t window = 0) :
+                        srs(srs),
+                        alpha_g1(vk.alpha_g1), beta_g2_precomp(pairing_policy::precompute_g2(vk.beta_g2)),
+                        gamma_g2_precomp(pairing_policy::precompute_g2(vk.gamma_g2)),
+                        delta_g2_precomp(pairing_policy::precompute_g2(vk.delta_g2)), gamma_ABC_g1(vk.gamma_ABC_g1) {
+                        if (window) {
+                            const std::vector<typename curve_type::g1_type::value_type> &bases =
+                                gamma_ABC_g1.rest.values;
+                            gamma_ABC_g1_precomp =
+                                fixed_base_precompute<typename curve_type::g1_type,
+                                                      typename curve_type::scalar_field_type>(
+                                    bases.begin(), bases.end(), window, executor::current().concurrency());
+                        }
+                    }
+
+                    r1cs_gg_ppzksnark_aggregate_processed_verification_key(const verification_srs_type &srs,
+                                                                           const verification_key_type &vk,
+                                                                           std::size_t window = 0) :
+                        r1cs_gg_ppzksnark_aggregate_processed_verification_key(
+                            prepared_verification_srs_type(srs), vk, window) {
+                    }
+
+                    prepared_verification_srs_type srs;
+
+                    typename curve_type::g1_type::value_type alpha_g1;
+                    g2_precomp beta_g2_precomp;
+                    g2_precomp gamma_g2_precomp;
+                    g2_precomp delta_g2_precomp;
+
+                    accumulation_vector<typename CurveType::g1_type> gamma_ABC_g1;
+
+                    /// Optional fixed-base precomputation of gamma_ABC_g1.rest, empty unless a window
+                    /// was given.
+                    fixed_base_precomputation<typename CurveType::g1_type> gamma_ABC_g1_precomp;
+                };
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -31,8 +31,12 @@
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/verification_key.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/compressed_proof.hpp>
 
-#include <nil/crypto3/algebra/random_element.hpp>
+#include <nil/crypto3/zk/snark/execution_policy.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/gt_multiexp.hpp>
+#include <nil/crypto3/zk/snark/pairing_check.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -78,128 +82,6 @@ namespace nil {
                     }
                 };
 
-                /// TODO: optimize this simple version of pairing checker
-                /// PairingCheck represents a check of the form e(A,B)e(C,D)... = T. Checks can
-                /// be aggregated together using random linear combination. The efficiency comes
-                /// from keeping the results from the miller loop output before proceding to a final
-                /// exponentiation when verifying if all checks are verified.
-                /// It is a tuple:
-                /// - a miller loop result that is to be multiplied by other miller loop results
-                /// before going into a final exponentiation result
-                /// - a right side result which is already in the right subgroup Gt which is to
-                /// be compared to the left side when "final_exponentiatiat"-ed
-                template<typename CurveType, typename DistributionType, typename GeneratorType>
-                struct pairing_check {
-                    typedef CurveType curve_type;
-
-                    typedef typename curve_type::g1_type g1_type;
-                    typedef typename curve_type::g2_type g2_type;
-                    typedef typename curve_type::gt_type gt_type;
-                    typedef typename curve_type::scalar_field_type scalar_field_type;
-
-                    typedef typename g1_type::value_type g1_value_type;
-                    typedef typename g2_type::value_type g2_value_type;
-                    typedef typename gt_type::value_type gt_value_type;
-                    typedef typename scalar_field_type::value_type scalar_field_value_type;
-
-                    gt_value_type left;
-                    gt_value_type right;
-                    bool non_random_check_done;
-                    bool valid;
-
-                    inline pairing_check() :
-                        left(gt_value_type::one()), right(gt_value_type::one()), non_random_check_done(false),
-                        valid(true) {
-                    }
-
-                    /// returns a pairing tuple that is scaled by a random element.
-                    /// When aggregating pairing checks, this creates a random linear
-                    /// combination of all checks so that it is secure. Specifically
-                    /// we have e(A,B)e(C,D)... = out <=> e(g,h)^{ab + cd} = out
-                    /// We rescale using a random element $r$ to give
-                    /// e(rA,B)e(rC,D) ... = out^r <=>
-                    /// e(A,B)^r e(C,D)^r = out^r <=> e(g,h)^{abr + cdr} = out^r
-                    /// (e(g,h)^{ab + cd})^r = out^r
-                    template<typename InputG1Iterator, typename InputG2Iterator,
-                             typename std::enable_if<
-                                 std::is_same<g1_value_type,
-                                              typename std::iterator_traits<InputG1Iterator>::value_type>::value &&
-                                     std::is_same<g2_value_type,
-                                                  typename std::iterator_traits<InputG2Iterator>::value_type>::value,
-                                 bool>::type = true>
-                    inline pairing_check(InputG1Iterator a_first, InputG1Iterator a_last, InputG2Iterator b_first,
-                                         InputG2Iterator b_last, const gt_value_type &out) :
-                        left(gt_value_type::one()),
-                        right(gt_value_type::one()), non_random_check_done(false), valid(true) {
-                        merge_random(a_first, a_last, b_first, b_last, out);
-                    }
-
-                    void merge() {
-                    }
-
-                    template<typename InputG1Iterator, typename InputG2Iterator>
-                    inline typename std::enable_if<
-                        std::is_same<g1_value_type,
-                                     typename std::iterator_traits<InputG1Iterator>::value_type>::value &&
-                        std::is_same<g2_value_type,
-                                     typename std::iterator_traits<InputG2Iterator>::value_type>::value>::type
-                        merge_random(InputG1Iterator a_first, InputG1Iterator a_last, InputG2Iterator b_first,
-                                     InputG2Iterator b_last, const gt_value_type &out) {
-                        std::size_t len = std::distance(a_first, a_last);
-                        BOOST_ASSERT(len > 0);
-                        BOOST_ASSERT(len == std::distance(b_first, b_last));
-
-                        if (!valid) {
-                            return;
-                        }
-
-                        scalar_field_value_type coeff = derive_non_zero();
-                        std::for_each(boost::make_zip_iterator(boost::make_tuple(a_first, b_first)),
-                                      boost::make_zip_iterator(boost::make_tuple(a_last, b_last)),
-                                      [&](const boost::tuple<const g1_value_type &, const g2_value_type &> &t) {
-                                          left = left * algebra::pair<curve_type>(coeff * t.template get<0>(),
-                                                                                  t.template get<1>());
-                                      });
-                        right = right * (out == CurveType::gt_type::value_type::one() ? out : out.pow(coeff.data));
-                    }
-
-                    template<typename InputGTIterator>
-                    inline typename std::enable_if<std::is_same<
-                        gt_value_type, typename std::iterator_traits<InputGTIterator>::value_type>::value>::type
-                        merge_nonrandom(InputGTIterator a_first, InputGTIterator a_last, const gt_value_type &out) {
-                        BOOST_ASSERT(!non_random_check_done);
-                        BOOST_ASSERT(std::distance(a_first, a_last) > 0);
-
-                        if (!valid) {
-                            return;
-                        }
-
-                        for (auto a_it = a_first; a_it != a_last; ++a_it) {
-                            left = left * (*a_it);
-                        }
-                        right = right * out;
-
-                        non_random_check_done = true;
-                    }
-
-                    inline bool verify() {
-                        return valid && (algebra::final_exponentiation<curve_type>(left) == right);
-                    }
-
-                    inline scalar_field_value_type derive_non_zero() {
-                        scalar_field_value_type coeff =
-                            algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
-                        while (coeff.is_zero()) {
-                            coeff = algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
-                        }
-                        return coeff;
-                    }
-
-                    inline void invalidate() {
-                        valid = false;
-                    }
-                };
-
                 /// verify_kzg_opening_g2 takes a KZG opening, the final commitment key, SRS and
                 /// any shift (in TIPP we shift the v commitment by r^-1) and returns a pairing
                 /// tuple to check if the opening is correct or not.
@@ -215,6 +97,8 @@ namespace nil {
                                  InputScalarIterator challenges_first, InputScalarIterator challenges_last,
                                  const typename CurveType::scalar_field_type::value_type &kzg_challenge,
                                  pairing_check<CurveType, DistributionType, GeneratorType> &pc) {
+                    stage_profiler::timer opening_timer("kzg_opening",
+                                                        std::distance(challenges_first, challenges_last));
                     // f_v(z)
                     typename CurveType::scalar_field_type::value_type vpoly_eval_z =
                         polynomial_evaluation_product_form_from_transcript<typename CurveType::scalar_field_type>(
@@ -264,7 +148,7 @@ namespace nil {
                 inline typename std::enable_if<
                     std::is_same<typename CurveType::scalar_field_type::value_type,
                                  typename std::iterator_traits<InputScalarIterator>::value_type>::value>::type
-                    verify_kzg_w(const r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> &v_srs,
+                    verify_kzg_w(const r1cs_gg_ppzksnark_aggregate_prepared_verification_srs<CurveType> &prepared_srs,
                                  const std::pair<typename CurveType::g1_type::value_type,
                                                  typename CurveType::g1_type::value_type> &final_wkey,
                                  const kzg_opening<typename CurveType::g1_type> &wkey_opening,
@@ -272,6 +156,10 @@ namespace nil {
                                  const typename CurveType::scalar_field_type::value_type &r_shift,
                                  const typename CurveType::scalar_field_type::value_type &kzg_challenge,
                                  pairing_check<CurveType, DistributionType, GeneratorType> &pc) {
+                    stage_profiler::timer opening_timer("kzg_opening",
+                                                        std::distance(challenges_first, challenges_last));
+                    const r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> &v_srs = prepared_srs.srs;
+
                     // TODO: parallel
                     // compute in parallel f(z) and z^n and then combines into f_w(z) = z^n * f(z)
                     typename CurveType::scalar_field_type::value_type fwz =
@@ -283,14 +171,16 @@ namespace nil {
                     // first check on w1
                     // e(w_1 / g^{f_w(z)},h) == e(\pi_{w,1},h^a/h^z) \\
                     // e(g^{f_w(a) - f_w(z)},
+                    // which is written e(g^{f_w(z)} / w_1 / \pi_{w,1}^z, h) e(\pi_{w,1}, h^a) == 1, so that
+                    // both G2 elements are fixed and their lines precomputed
                     std::vector<typename CurveType::g1_type::value_type> a_input1 {
-                        final_wkey.first - (v_srs.g * fwz),
-                        // e(opening, h^{a - z})
+                        (v_srs.g * fwz) - final_wkey.first - (wkey_opening.first * kzg_challenge),
+                        // e(opening, h^a)
                         wkey_opening.first,
                     };
-                    std::vector<typename CurveType::g2_type::value_type> b_input1 {
-                        -v_srs.h,
-                        v_srs.h_alpha - (v_srs.h * kzg_challenge),
+                    std::vector<typename CurveType::pairing::g2_precomp> b_input1 {
+                        prepared_srs.h_precomp,
+                        prepared_srs.h_alpha_precomp,
                     };
                     pc.merge_random(a_input1.begin(), a_input1.end(), b_input1.begin(), b_input1.end(),
                                     CurveType::gt_type::value_type::one());
@@ -298,12 +188,12 @@ namespace nil {
                     // then do second check
                     // e(w_2 / g^{f_w(z)},h) == e(\pi_{w,2},h^b/h^z)
                     std::vector<typename CurveType::g1_type::value_type> a_input2 {
-                        final_wkey.second - (v_srs.g * fwz),
+                        (v_srs.g * fwz) - final_wkey.second - (wkey_opening.second * kzg_challenge),
                         wkey_opening.second,
                     };
-                    std::vector<typename CurveType::g2_type::value_type> b_input2 {
-                        -v_srs.h,
-                        v_srs.h_beta - (v_srs.h * kzg_challenge),
+                    std::vector<typename CurveType::pairing::g2_precomp> b_input2 {
+                        prepared_srs.h_precomp,
+                        prepared_srs.h_beta_precomp,
                     };
                     pc.merge_random(a_input2.begin(), a_input2.end(), b_input2.begin(), b_input2.end(),
                                     CurveType::gt_type::value_type::one());
@@ -325,6 +215,7 @@ namespace nil {
                     gipa_verify_tipp_mipp(transcript<CurveType, Hash> &tr,
                                           const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof,
                                           const typename CurveType::scalar_field_type::value_type &r_shift) {
+                    stage_profiler::timer gipa_timer("gipa", proof.tmipp.gipa.nproofs);
                     std::vector<typename CurveType::scalar_field_type::value_type> challenges;
                     std::vector<typename CurveType::scalar_field_type::value_type> challenges_inv;
 
@@ -388,54 +279,46 @@ namespace nil {
 
                     // we first multiply each entry of the Z U and L vectors by the respective
                     // challenges independently
-                    // Since at the end we want to multiple all "t" values together, we do
-                    // multiply all of them in parrallel and then merge then back at the end.
-                    // same for u and z.
-                    gipa_tuz<CurveType> res;
-                    std::for_each(
-                        boost::make_zip_iterator(
-                            boost::make_tuple(proof.tmipp.gipa.comms_ab.begin(), proof.tmipp.gipa.z_ab.begin(),
-                                              proof.tmipp.gipa.comms_c.begin(), proof.tmipp.gipa.z_c.begin(),
-                                              challenges.begin(), challenges_inv.begin())),
-                        boost::make_zip_iterator(
-                            boost::make_tuple(proof.tmipp.gipa.comms_ab.end(), proof.tmipp.gipa.z_ab.end(),
-                                              proof.tmipp.gipa.comms_c.end(), proof.tmipp.gipa.z_c.end(),
-                                              challenges.end(), challenges_inv.end())),
-                        [&](const boost::tuple<const std::pair<r1cs_gg_ppzksnark_ipp2_commitment_output<CurveType>,
-                                                               r1cs_gg_ppzksnark_ipp2_commitment_output<CurveType>> &,
-                                               const std::pair<typename CurveType::gt_type::value_type,
-                                                               typename CurveType::gt_type::value_type> &,
-                                               const std::pair<r1cs_gg_ppzksnark_ipp2_commitment_output<CurveType>,
-                                                               r1cs_gg_ppzksnark_ipp2_commitment_output<CurveType>> &,
-                                               const std::pair<typename CurveType::g1_type::value_type,
-                                                               typename CurveType::g1_type::value_type> &,
-                                               const typename CurveType::scalar_field_type::value_type &,
-                                               const typename CurveType::scalar_field_type::value_type &> &t) {
-                            // Op::TAB::<E>(tab_l, c_repr),
-                            res.tab = res.tab * t.template get<0>().first.first.pow(t.template get<4>().data);
-                            // Op::TAB(tab_r, c_inv_repr),
-                            res.tab = res.tab * t.template get<0>().second.first.pow(t.template get<5>().data);
-                            // Op::UAB(uab_l, c_repr),
-                            res.uab = res.uab * t.template get<0>().first.second.pow(t.template get<4>().data);
-                            // Op::UAB(uab_r, c_inv_repr),
-                            res.uab = res.uab * t.template get<0>().second.second.pow(t.template get<5>().data);
-                            // Op::ZAB(zab_l, c_repr),
-                            res.zab = res.zab * t.template get<1>().first.pow(t.template get<4>().data);
-                            // Op::ZAB(zab_r, c_inv_repr),
-                            res.zab = res.zab * t.template get<1>().second.pow(t.template get<5>().data);
-                            // Op::TC::<E>(tc_l, c_repr),
-                            res.tc = res.tc * t.template get<2>().first.first.pow(t.template get<4>().data);
-                            // Op::TC(tc_r, c_inv_repr),
-                            res.tc = res.tc * t.template get<2>().second.first.pow(t.template get<5>().data);
-                            // Op::UC(uc_l, c_repr),
-                            res.uc = res.uc * t.template get<2>().first.second.pow(t.template get<4>().data);
-                            // Op::UC(uc_r, c_inv_repr),
-                            res.uc = res.uc * t.template get<2>().second.second.pow(t.template get<5>().data);
-                            // Op::ZC(zc_l, c_repr),
-                            res.zc = res.zc + (t.template get<4>() * t.template get<3>().first);
-                            // Op::ZC(zc_r, c_inv_repr),
-                            res.zc = res.zc + (t.template get<5>() * t.template get<3>().second);
-                        });
+                    // Since at the end we want to multiple all "t" values together, the left
+                    // and right values of all rounds are raised to c and c^{-1} in one Gt
+                    // multi-exponentiation per commitment, all of them sharing the windows of
+                    // the challenges. same for u and z.
+                    const std::size_t num_rounds = challenges.size();
+                    std::vector<typename CurveType::scalar_field_type::value_type> exponents;
+                    std::vector<std::vector<typename CurveType::gt_type::value_type>> gt_bases(5);
+                    std::vector<typename CurveType::g1_type::value_type> zc_bases;
+                    exponents.reserve(2 * num_rounds);
+                    for (std::vector<typename CurveType::gt_type::value_type> &bases : gt_bases) {
+                        bases.reserve(2 * num_rounds);
+                    }
+                    zc_bases.reserve(2 * num_rounds);
+                    for (std::size_t i = 0; i < num_rounds; ++i) {
+                        const auto &comm_ab = proof.tmipp.gipa.comms_ab[i];
+                        const auto &z_ab = proof.tmipp.gipa.z_ab[i];
+                        const auto &comm_c = proof.tmipp.gipa.comms_c[i];
+                        const auto &z_c = proof.tmipp.gipa.z_c[i];
+
+                        exponents.emplace_back(challenges[i]);
+                        exponents.emplace_back(challenges_inv[i]);
+                        // Op::TAB::<E>(tab_l, c_repr) * Op::TAB(tab_r, c_inv_repr)
+                        gt_bases[0].emplace_back(comm_ab.first.first);
+                        gt_bases[0].emplace_back(comm_ab.second.first);
+                        // Op::UAB(uab_l, c_repr) * Op::UAB(uab_r, c_inv_repr)
+                        gt_bases[1].emplace_back(comm_ab.first.second);
+                        gt_bases[1].emplace_back(comm_ab.second.second);
+                        // Op::ZAB(zab_l, c_repr) * Op::ZAB(zab_r, c_inv_repr)
+                        gt_bases[2].emplace_back(z_ab.first);
+                        gt_bases[2].emplace_back(z_ab.second);
+                        // Op::TC::<E>(tc_l, c_repr) * Op::TC(tc_r, c_inv_repr)
+                        gt_bases[3].emplace_back(comm_c.first.first);
+                        gt_bases[3].emplace_back(comm_c.second.first);
+                        // Op::UC(uc_l, c_repr) * Op::UC(uc_r, c_inv_repr)
+                        gt_bases[4].emplace_back(comm_c.first.second);
+                        gt_bases[4].emplace_back(comm_c.second.second);
+                        // Op::ZC(zc_l, c_repr) + Op::ZC(zc_r, c_inv_repr)
+                        zc_bases.emplace_back(z_c.first);
+                        zc_bases.emplace_back(z_c.second);
+                    }
 
                     // we reverse the order because the polynomial evaluation routine expects
                     // the challenges in reverse order.Doing it here allows us to compute the final_r
@@ -443,7 +326,14 @@ namespace nil {
                     std::reverse(challenges.begin(), challenges.end());
                     std::reverse(challenges_inv.begin(), challenges_inv.end());
 
-                    final_res.merge(res);
+                    if (num_rounds > 0) {
+                        const std::vector<typename CurveType::gt_type::value_type> folded =
+                            gt_multiexp<typename CurveType::scalar_field_type>(gt_bases, exponents.begin());
+                        final_res.merge(gipa_tuz<CurveType>(
+                            folded[0], folded[1], folded[2], folded[3], folded[4],
+                            dispatch_multiexp<variable_time_execution::multiexp_method>(
+                                zc_bases.begin(), zc_bases.end(), exponents.begin(), exponents.end(), 1)));
+                    }
                     typename CurveType::scalar_field_type::value_type final_r =
                         polynomial_evaluation_product_form_from_transcript<typename CurveType::scalar_field_type>(
                             challenges_inv.begin(), challenges_inv.end(), r_shift,
@@ -457,11 +347,13 @@ namespace nil {
                 /// used in the MIPP part with C
                 template<typename CurveType, typename DistributionType, typename GeneratorType,
                          typename Hash = hashes::sha2<256>>
-                inline void verify_tipp_mipp(transcript<CurveType, Hash> &tr,
-                                             const r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> &v_srs,
-                                             const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof,
-                                             const typename CurveType::scalar_field_type::value_type &r_shift,
-                                             pairing_check<CurveType, DistributionType, GeneratorType> &pc) {
+                inline void
+                    verify_tipp_mipp(transcript<CurveType, Hash> &tr,
+                                     const r1cs_gg_ppzksnark_aggregate_prepared_verification_srs<CurveType>
+                                         &prepared_srs,
+                                     const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof,
+                                     const typename CurveType::scalar_field_type::value_type &r_shift,
+                                     pairing_check<CurveType, DistributionType, GeneratorType> &pc) {
                     // (T,U), Z for TIPP and MIPP  and all challenges
                     auto [final_res, final_r, challenges, challenges_inv] =
                         gipa_verify_tipp_mipp<CurveType, Hash>(tr, proof, r_shift);
@@ -477,14 +369,13 @@ namespace nil {
                     tr.template write<typename CurveType::g1_type>(proof.tmipp.gipa.final_wkey.second);
                     typename CurveType::scalar_field_type::value_type c = tr.read_challenge();
 
-                    // TODO: parallel
                     // check the opening proof for v
                     verify_kzg_v<CurveType, DistributionType, GeneratorType>(
-                        v_srs, proof.tmipp.gipa.final_vkey, proof.tmipp.vkey_opening, challenges_inv.begin(),
+                        prepared_srs.srs, proof.tmipp.gipa.final_vkey, proof.tmipp.vkey_opening, challenges_inv.begin(),
                         challenges_inv.end(), c, pc);
                     // check the opening proof for w - note that w has been rescaled by $r^{-1}$
                     verify_kzg_w<CurveType, DistributionType, GeneratorType>(
-                        v_srs, proof.tmipp.gipa.final_wkey, proof.tmipp.wkey_opening, challenges.begin(),
+                        prepared_srs, proof.tmipp.gipa.final_wkey, proof.tmipp.wkey_opening, challenges.begin(),
                         challenges.end(), r_shift.inversed(), c, pc);
                     //
                     // We create a sequence of pairing tuple that we aggregate together at
@@ -537,19 +428,9 @@ namespace nil {
                     }
                 }
 
-                /// Verifies the aggregated proofs thanks to the Groth16 verifying key, the
-                /// verifier SRS from the aggregation scheme, all the public inputs of the
-                /// proofs and the aggregated proof.
-                /// WARNING: transcript_include represents everything that should be included in
-                /// the transcript from outside the boundary of this function. This is especially
-                /// relevant for ALL public inputs of ALL individual proofs. In the regular case,
-                /// one should input ALL public inputs from ALL proofs aggregated. However, IF ALL the
-                /// public inputs are **fixed, and public before the aggregation time**, then there is
-                /// no need to hash those. The reason we specify this extra assumption is because hashing
-                /// the public inputs from the decoded form can take quite some time depending on the
-                /// number of proofs and public inputs (+100ms in our case). In the case of Filecoin, the only
-                /// non-fixed part of the public inputs are the challenges derived from a seed. Even though this
-                /// seed comes from a random beeacon, we are hashing this as a safety precaution.
+                /// Merges the pairing checks of an aggregated proof into pc and returns the seed of their
+                /// coefficients, derived from the transcript. The Groth16 equation is merged randomized
+                /// when pc also holds the checks of other aggregates.
                 template<typename CurveType,
                          typename DistributionType = boost::random::uniform_int_distribution<
                              typename CurveType::scalar_field_type::modulus_type>,
@@ -560,24 +441,26 @@ namespace nil {
                                  typename std::iterator_traits<typename std::iterator_traits<
                                      typename InputRangesRange::iterator>::value_type::iterator>::value_type>::value &&
                         std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
-                    bool>::type
-                    verify_aggregate_proof(
-                        const r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> &ip_verifier_srs,
-                        const r1cs_gg_ppzksnark_aggregate_verification_key<CurveType> &pvk,
+                    typename CurveType::scalar_field_type::value_type>::type
+                    merge_aggregate_proof(
+                        const r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType> &processed_vk,
                         const InputRangesRange &public_inputs,
                         const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof,
                         InputIterator transcript_include_first,
-                        InputIterator transcript_include_last) {
+                        InputIterator transcript_include_last,
+                        pairing_check<CurveType, DistributionType, GeneratorType> &pc,
+                        bool randomize_groth16) {
                     for (const auto &public_input : public_inputs) {
-                        BOOST_ASSERT((public_input.size()) == pvk.gamma_ABC_g1.size());
+                        BOOST_ASSERT((public_input.size()) == processed_vk.gamma_ABC_g1.size());
+                    }
+                    // the proofs past the public inputs are the identity padding of the prover
+                    if (public_inputs.size() == 0 || public_inputs.size() > proof.tmipp.gipa.nproofs) {
+                        pc.invalidate();
+                        return CurveType::scalar_field_type::value_type::zero();
                     }
 
                     // Random linear combination of proofs
-                    constexpr std::array<std::uint8_t, 9> application_tag = {'s', 'n', 'a', 'r', 'k',
-                                                                             'p', 'a', 'c', 'k'};
-                    constexpr std::array<std::uint8_t, 8> domain_separator {'r', 'a', 'n', 'd', 'o', 'm', '-', 'r'};
-                    transcript<CurveType, Hash> tr(application_tag.begin(), application_tag.end());
-                    tr.write_domain_separator(domain_separator.begin(), domain_separator.end());
+                    transcript<CurveType, Hash> tr(transcript_prefix<CurveType, Hash, random_r_transcript_prefix>());
                     tr.template write<typename CurveType::gt_type>(proof.com_ab.first);
                     tr.template write<typename CurveType::gt_type>(proof.com_ab.second);
                     tr.template write<typename CurveType::gt_type>(proof.com_c.first);
@@ -587,14 +470,12 @@ namespace nil {
                     tr.template write<typename CurveType::gt_type>(proof.ip_ab);
                     tr.template write<typename CurveType::g1_type>(proof.agg_c);
 
-                    pairing_check<CurveType, DistributionType, GeneratorType> pc;
-
                     // TODO: parallel
                     // 1.Check TIPA proof ab
                     // 2.Check TIPA proof c
                     verify_tipp_mipp<CurveType, DistributionType, GeneratorType, Hash>(
                         tr,
-                        ip_verifier_srs,
+                        processed_vk.srs,
                         proof,
                         // we give the extra r as it's not part of the proof itself - it is simply used on top for the
                         // groth16 aggregation
@@ -614,7 +495,7 @@ namespace nil {
                     // NOTE From this point on, we are only checking *one* pairing check (the Groth16
                     // verification equation) so we don't need to randomize as all other checks are being
                     // randomized already. When merging all pairing checks together, this will be the only one
-                    // non-randomized.
+                    // non-randomized, unless the checks of other aggregates are merged in the same pc.
                     //
                     // now we do the multi exponentiation
                     std::vector<typename CurveType::scalar_field_type::value_type> powers =
@@ -630,11 +511,10 @@ namespace nil {
                     }
 
                     // 3. Compute left part of the final pairing equation
-                    typename CurveType::gt_type::value_type left =
-                        algebra::pair<CurveType>(pvk.alpha_g1 * r_sum, pvk.beta_g2);
+                    typename CurveType::g1_type::value_type left = processed_vk.alpha_g1 * r_sum;
 
                     // 4. Compute right part of the final pairing equation
-                    typename CurveType::gt_type::value_type right = algebra::pair<CurveType>(proof.agg_c, pvk.delta_g2);
+                    const typename CurveType::g1_type::value_type &right = proof.agg_c;
 
                     // 5. compute the middle part of the final pairing equation, the one
                     //    with the public inputs
@@ -645,17 +525,263 @@ namespace nil {
                     // input element
                     // We incrementally build the r vector and the table
                     // NOTE: in this version it's not r^2j but simply r^j
-                    typename CurveType::g1_type::value_type g_ic = pvk.gamma_ABC_g1.first * r_sum;
-                    // TODO: do without using of accumulation_vector
+                    stage_profiler::timer multiexp_timer("multiexp", multi_r_vec.size());
+                    typename CurveType::g1_type::value_type g_ic = processed_vk.gamma_ABC_g1.first * r_sum;
                     typename CurveType::g1_type::value_type totsi =
-                        pvk.gamma_ABC_g1.accumulate_chunk(multi_r_vec.begin(), multi_r_vec.end(), 0).first -
-                        pvk.gamma_ABC_g1.first;
+                        processed_vk.gamma_ABC_g1_precomp.empty() ?
+                            processed_vk.gamma_ABC_g1.accumulate_chunk(multi_r_vec.begin(), multi_r_vec.end(), 0)
+                                    .first -
+                                processed_vk.gamma_ABC_g1.first :
+                            fixed_base_sparse_multiexp(processed_vk.gamma_ABC_g1_precomp,
+                                                       processed_vk.gamma_ABC_g1.rest.indices, 0, multi_r_vec.size(),
+                                                       multi_r_vec.begin(), multi_r_vec.end(),
+                                                       executor::current().concurrency());
                     g_ic = g_ic + totsi;
-                    typename CurveType::gt_type::value_type middle = algebra::pair<CurveType>(g_ic, pvk.gamma_g2);
+                    multiexp_timer.stop();
+
+                    // the three pairings are left to the multi Miller loop of the pairing check
+                    std::vector<typename CurveType::g1_type::value_type> a_input {left, g_ic, right};
+                    std::vector<typename CurveType::pairing::g2_precomp> b_input {
+                        processed_vk.beta_g2_precomp, processed_vk.gamma_g2_precomp, processed_vk.delta_g2_precomp};
+                    if (randomize_groth16) {
+                        pc.merge_random(a_input.begin(), a_input.end(), b_input.begin(), b_input.end(), proof.ip_ab);
+                    } else {
+                        pc.merge_nonrandom(a_input.begin(), a_input.end(), b_input.begin(), b_input.end(),
+                                           proof.ip_ab);
+                    }
+
+                    // The coefficients of the batched checks are derived from the transcript once
+                    // all the elements they involve are fixed, which makes the verification
+                    // deterministic. Only the final GIPA values and the KZG openings are not yet in it.
+                    constexpr std::array<std::uint8_t, 13> pairing_check_domain_separator {
+                        'p', 'a', 'i', 'r', 'i', 'n', 'g', '-', 'c', 'h', 'e', 'c', 'k'};
+                    tr.write_domain_separator(pairing_check_domain_separator.begin(),
+                                              pairing_check_domain_separator.end());
+                    tr.template write<typename CurveType::g1_type>(proof.tmipp.gipa.final_a);
+                    tr.template write<typename CurveType::g2_type>(proof.tmipp.gipa.final_b);
+                    tr.template write<typename CurveType::g1_type>(proof.tmipp.gipa.final_c);
+                    tr.template write<typename CurveType::g2_type>(proof.tmipp.vkey_opening.first);
+                    tr.template write<typename CurveType::g2_type>(proof.tmipp.vkey_opening.second);
+                    tr.template write<typename CurveType::g1_type>(proof.tmipp.wkey_opening.first);
+                    tr.template write<typename CurveType::g1_type>(proof.tmipp.wkey_opening.second);
+                    return tr.read_challenge();
+                }
+
+                /// Verifies the aggregated proofs thanks to the Groth16 verifying key, the
+                /// verifier SRS from the aggregation scheme, all the public inputs of the
+                /// proofs and the aggregated proof.
+                /// WARNING: transcript_include represents everything that should be included in
+                /// the transcript from outside the boundary of this function. This is especially
+                /// relevant for ALL public inputs of ALL individual proofs. In the regular case,
+                /// one should input ALL public inputs from ALL proofs aggregated. However, IF ALL the
+                /// public inputs are **fixed, and public before the aggregation time**, then there is
+                /// no need to hash those. The reason we specify this extra assumption is because hashing
+                /// the public inputs from the decoded form can take quite some time depending on the
+                /// number of proofs and public inputs (+100ms in our case). In the case of Filecoin, the only
+                /// non-fixed part of the public inputs are the challenges derived from a seed. Even though this
+                /// seed comes from a random beeacon, we are hashing this as a safety precaution.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                         typename InputRangesRange, typename InputIterator>
+                inline typename std::enable_if<
+                    std::is_same<typename CurveType::scalar_field_type::value_type,
+                                 typename std::iterator_traits<typename std::iterator_traits<
+                                     typename InputRangesRange::iterator>::value_type::iterator>::value_type>::value &&
+                        std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
+                    bool>::type
+                    verify_aggregate_proof(
+                        const r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType> &processed_vk,
+                        const InputRangesRange &public_inputs,
+                        const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof,
+                        InputIterator transcript_include_first,
+                        InputIterator transcript_include_last) {
+                    // 4 KZG, 3 TIPP and 2 MIPP randomized checks, then the Groth16 equation
+                    pairing_check<CurveType, DistributionType, GeneratorType> pc;
+                    pc.reserve(10, 18);
+
+                    return pc.verify(merge_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                        processed_vk, public_inputs, proof, transcript_include_first, transcript_include_last, pc,
+                        false));
+                }
+
+                /// Same as above, with the lines of the G2 elements of the Groth16 verifying key
+                /// computed on the fly.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                         typename InputRangesRange, typename InputIterator>
+                inline typename std::enable_if<
+                    std::is_same<typename CurveType::scalar_field_type::value_type,
+                                 typename std::iterator_traits<typename std::iterator_traits<
+                                     typename InputRangesRange::iterator>::value_type::iterator>::value_type>::value &&
+                        std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
+                    bool>::type
+                    verify_aggregate_proof(
+                        const r1cs_gg_ppzksnark_aggregate_prepared_verification_srs<CurveType> &ip_verifier_srs,
+                        const r1cs_gg_ppzksnark_aggregate_verification_key<CurveType> &pvk,
+                        const InputRangesRange &public_inputs,
+                        const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof,
+                        InputIterator transcript_include_first,
+                        InputIterator transcript_include_last) {
+                    return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                        r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType>(ip_verifier_srs, pvk),
+                        public_inputs, proof, transcript_include_first, transcript_include_last);
+                }
+
+                /// Same as above, with the lines of the fixed G2 elements of the srs computed on
+                /// the fly as well. Callers verifying several aggregates against one srs and key
+                /// should process them once instead.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                         typename InputRangesRange, typename InputIterator>
+                inline typename std::enable_if<
+                    std::is_same<typename CurveType::scalar_field_type::value_type,
+                                 typename std::iterator_traits<typename std::iterator_traits<
+                                     typename InputRangesRange::iterator>::value_type::iterator>::value_type>::value &&
+                        std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
+                    bool>::type
+                    verify_aggregate_proof(
+                        const r1cs_gg_ppzksnark_aggregate_verification_srs<CurveType> &ip_verifier_srs,
+                        const r1cs_gg_ppzksnark_aggregate_verification_key<CurveType> &pvk,
+                        const InputRangesRange &public_inputs,
+                        const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof,
+                        InputIterator transcript_include_first,
+                        InputIterator transcript_include_last) {
+                    return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                        r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType>(ip_verifier_srs, pvk),
+                        public_inputs, proof, transcript_include_first, transcript_include_last);
+                }
+
+                /// Same as above for a proof with compressed Gt elements, which are only expanded here.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                         typename VerificationSrs, typename InputRangesRange, typename InputIterator>
+                inline typename std::enable_if<
+                    std::is_same<typename CurveType::scalar_field_type::value_type,
+                                 typename std::iterator_traits<typename std::iterator_traits<
+                                     typename InputRangesRange::iterator>::value_type::iterator>::value_type>::value &&
+                        std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
+                    bool>::type
+                    verify_aggregate_proof(const VerificationSrs &ip_verifier_srs,
+                                           const r1cs_gg_ppzksnark_aggregate_verification_key<CurveType> &pvk,
+                                           const InputRangesRange &public_inputs,
+                                           const r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> &proof,
+                                           InputIterator transcript_include_first,
+                                           InputIterator transcript_include_last) {
+                    if (!proof.has_correct_len()) {
+                        return false;
+                    }
+                    const std::pair<bool, r1cs_gg_ppzksnark_aggregate_proof<CurveType>> decompressed =
+                        proof.decompress();
+                    if (!decompressed.first) {
+                        return false;
+                    }
+                    return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                        ip_verifier_srs, pvk, public_inputs, decompressed.second, transcript_include_first,
+                        transcript_include_last);
+                }
+
+                /// Same as above for a compressed proof and a processed verifying key.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                         typename InputRangesRange, typename InputIterator>
+                inline typename std::enable_if<
+                    std::is_same<typename CurveType::scalar_field_type::value_type,
+                                 typename std::iterator_traits<typename std::iterator_traits<
+                                     typename InputRangesRange::iterator>::value_type::iterator>::value_type>::value &&
+                        std::is_same<std::uint8_t, typename std::iterator_traits<InputIterator>::value_type>::value,
+                    bool>::type
+                    verify_aggregate_proof(
+                        const r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType> &processed_vk,
+                        const InputRangesRange &public_inputs,
+                        const r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> &proof,
+                        InputIterator transcript_include_first,
+                        InputIterator transcript_include_last) {
+                    if (!proof.has_correct_len()) {
+                        return false;
+                    }
+                    const std::pair<bool, r1cs_gg_ppzksnark_aggregate_proof<CurveType>> decompressed =
+                        proof.decompress();
+                    if (!decompressed.first) {
+                        return false;
+                    }
+                    return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                        processed_vk, public_inputs, decompressed.second, transcript_include_first,
+                        transcript_include_last);
+                }
+
+                /// Verifies at once several aggregated proofs, one per circuit, each with its own processed
+                /// Groth16 verifying key, public inputs and transcript_include (see above). Every aggregate
+                /// keeps its TIPP/MIPP: the Groth16 equation pairs the aggregated C with the delta of its
+                /// key, so proofs of different keys cannot share one MIPP. All the pairing checks of all the
+                /// aggregates, Groth16 equations randomized as well, are however merged into one multi
+                /// Miller loop and one final exponentiation, with coefficients derived from the
+                /// transcripts of all the aggregates.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                         typename ProcessedVerificationKeyRange, typename InputRangesRangeRange, typename ProofRange,
+                         typename TranscriptIncludeRange>
+                inline bool verify_aggregate_proofs(const ProcessedVerificationKeyRange &processed_vks,
+                                                    const InputRangesRangeRange &public_inputs,
+                                                    const ProofRange &proofs,
+                                                    const TranscriptIncludeRange &transcript_includes) {
+                    const std::size_t num_aggregates = std::distance(std::begin(proofs), std::end(proofs));
+                    BOOST_ASSERT(std::distance(std::begin(processed_vks), std::end(processed_vks)) ==
+                                 num_aggregates);
+                    BOOST_ASSERT(std::distance(std::begin(public_inputs), std::end(public_inputs)) == num_aggregates);
+                    BOOST_ASSERT(std::distance(std::begin(transcript_includes), std::end(transcript_includes)) ==
+                                 num_aggregates);
 
-                    std::vector<typename CurveType::gt_type::value_type> a_input {left, middle, right};
-                    pc.merge_nonrandom(a_input.begin(), a_input.end(), proof.ip_ab);
-                    return pc.verify();
+                    pairing_check<CurveType, DistributionType, GeneratorType> pc;
+                    pc.reserve(10 * num_aggregates, 18 * num_aggregates);
+
+                    transcript<CurveType, Hash> tr(
+                        transcript_prefix<CurveType, Hash, aggregate_batch_transcript_prefix>());
+
+                    auto processed_vk_it = std::begin(processed_vks);
+                    auto public_inputs_it = std::begin(public_inputs);
+                    auto transcript_include_it = std::begin(transcript_includes);
+                    for (auto proof_it = std::begin(proofs); proof_it != std::end(proofs);
+                         ++proof_it, ++processed_vk_it, ++public_inputs_it, ++transcript_include_it) {
+                        tr.template write<typename CurveType::scalar_field_type>(
+                            merge_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                                *processed_vk_it, *public_inputs_it, *proof_it, std::begin(*transcript_include_it),
+                                std::end(*transcript_include_it), pc, true));
+                    }
+                    return pc.verify(tr.read_challenge());
+                }
+
+                /// Same as above for plain Groth16 verifying keys against a common verifier SRS.
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = boost::random::mt19937, typename Hash = hashes::sha2<256>,
+                         typename VerificationKeyRange, typename InputRangesRangeRange, typename ProofRange,
+                         typename TranscriptIncludeRange>
+                inline bool verify_aggregate_proofs(
+                    const r1cs_gg_ppzksnark_aggregate_prepared_verification_srs<CurveType> &ip_verifier_srs,
+                    const VerificationKeyRange &pvks,
+                    const InputRangesRangeRange &public_inputs,
+                    const ProofRange &proofs,
+                    const TranscriptIncludeRange &transcript_includes) {
+                    std::vector<r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType>> processed_vks;
+                    processed_vks.reserve(std::distance(std::begin(pvks), std::end(pvks)));
+                    for (const auto &pvk : pvks) {
+                        processed_vks.emplace_back(ip_verifier_srs, pvk);
+                    }
+                    return verify_aggregate_proofs<CurveType, DistributionType, GeneratorType, Hash>(
+                        processed_vks, public_inputs, proofs, transcript_includes);
                 }
 
                 template<typename CurveType, typename BasicVerifier>
@@ -675,6 +801,7 @@ namespace nil {
 
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
@@ -683,12 +810,16 @@ namespace nil {
                     typedef typename policy_type::srs_type srs_type;
                     typedef typename policy_type::proving_srs_type proving_srs_type;
                     typedef typename policy_type::verification_srs_type verification_srs_type;
+                    typedef typename policy_type::prepared_verification_srs_type prepared_verification_srs_type;
+                    typedef typename policy_type::processed_aggregate_verification_key_type
+                        processed_aggregate_verification_key_type;
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::srs_pair_type srs_pair_type;
 
                     typedef typename policy_type::proof_type proof_type;
                     typedef typename policy_type::aggregate_proof_type aggregate_proof_type;
+                    typedef typename policy_type::compressed_aggregate_proof_type compressed_aggregate_proof_type;
 
                     // Aggregate verify
                     template<typename DistributionType, typename GeneratorType, typename Hash,
@@ -709,10 +840,78 @@ namespace nil {
                             transcript_include_last);
                     }
 
+                    template<typename DistributionType, typename GeneratorType, typename Hash,
+                             typename InputPrimaryInputRange, typename InputIterator>
+                    static inline typename std::enable_if<
+                        std::is_same<primary_input_type,
+                                     typename std::iterator_traits<
+                                         typename InputPrimaryInputRange::iterator>::value_type>::value,
+                        bool>::type
+                        process(const prepared_verification_srs_type &ip_verifier_srs,
+                                const verification_key_type &pvk,
+                                const InputPrimaryInputRange &public_inputs,
+                                const aggregate_proof_type &proof,
+                                InputIterator transcript_include_first,
+                                InputIterator transcript_include_last) {
+                        return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                            ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first,
+                            transcript_include_last);
+                    }
+
+                    template<typename DistributionType, typename GeneratorType, typename Hash,
+                             typename VerificationSrs, typename InputPrimaryInputRange, typename InputIterator>
+                    static inline typename std::enable_if<
+                        std::is_same<primary_input_type,
+                                     typename std::iterator_traits<
+                                         typename InputPrimaryInputRange::iterator>::value_type>::value,
+                        bool>::type
+                        process(const VerificationSrs &ip_verifier_srs,
+                                const verification_key_type &pvk,
+                                const InputPrimaryInputRange &public_inputs,
+                                const compressed_aggregate_proof_type &proof,
+                                InputIterator transcript_include_first,
+                                InputIterator transcript_include_last) {
+                        return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                            ip_verifier_srs, pvk, public_inputs, proof, transcript_include_first,
+                            transcript_include_last);
+                    }
+
+                    template<typename DistributionType, typename GeneratorType, typename Hash,
+                             typename InputPrimaryInputRange, typename InputIterator>
+                    static inline typename std::enable_if<
+                        std::is_same<primary_input_type,
+                                     typename std::iterator_traits<
+                                         typename InputPrimaryInputRange::iterator>::value_type>::value,
+                        bool>::type
+                        process(const processed_aggregate_verification_key_type &processed_vk,
+                                const InputPrimaryInputRange &public_inputs,
+                                const aggregate_proof_type &proof,
+                                InputIterator transcript_include_first,
+                                InputIterator transcript_include_last) {
+                        return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                            processed_vk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                    }
+
+                    template<typename DistributionType, typename GeneratorType, typename Hash,
+                             typename InputPrimaryInputRange, typename InputIterator>
+                    static inline typename std::enable_if<
+                        std::is_same<primary_input_type,
+                                     typename std::iterator_traits<
+                                         typename InputPrimaryInputRange::iterator>::value_type>::value,
+                        bool>::type
+                        process(const processed_aggregate_verification_key_type &processed_vk,
+                                const InputPrimaryInputRange &public_inputs,
+                                const compressed_aggregate_proof_type &proof,
+                                InputIterator transcript_include_first,
+                                InputIterator transcript_include_last) {
+                        return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                            processed_vk, public_inputs, proof, transcript_include_first, transcript_include_last);
+                    }
+
                     // Basic verify
                     template<typename VerificationKey>
                     static inline bool process(const VerificationKey &vk,
-                                               const primary_input_type &primary_input,
+                                               const primary_input_span_type &primary_input,
                                                const proof_type &proof) {
                         return BasicVerifier::process(vk, primary_input, proof);
                     }
@@ -0,0 +1,555 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the sectioned keypair file of the R1CS GG-ppzkSNARK.
+//
+// The keypair file stores the verification key, the points and each query of the proving
+// key, and its constraint system, as separate sections of a sectioned file (see
+// sectioned_file.hpp), each one holding the TVM encoding of its part (see marshalling.hpp).
+// A loader opens the file and reads only the table of contents, and then the sections it
+// uses: a verifier reads the verification key alone, a device prover the queries it keeps
+// resident, and a full prover everything:
+//
+//     r1cs_gg_ppzksnark_keypair_file<scheme_type>::write(path, keypair);
+//
+//     const r1cs_gg_ppzksnark_keypair_file<scheme_type> file(path);
+//     const auto vk = file.verification_key(status);
+//     const auto A_query = file.A_query(status);
+//
+// The constraint system is stored in the full-width or compact format of the marshalling,
+// one section name per format.
+//
+// The points are stored compressed, about half the size of the memory-mapped layout of
+// mapped_proving_key.hpp, which makes the keypair file the one to distribute. A prover
+// node expands it into that layout once, on first use, and maps the expansion from then
+// on, all its processes sharing the pages:
+//
+//     const auto pk = file.expanded_proving_key(mapped_path, status);
+//
+// The expansion decompresses each query by chunks across the current executor, so its
+// memory is bounded by a chunk of the query being expanded, B_query aside, rather than by
+// the whole key. It records the sizes of the constraint system and the source digest of
+// the keypair file in the header of the expansion: the SHA-256 digest of the table of
+// contents, the verification key and the points of the proving key, which differ between
+// any two setups. An expansion left by another keypair, or truncated, is expanded again.
+// It is written under a temporary name, synced and renamed, the directory being synced
+// last, so a crash leaves either no expansion or a complete one.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_KEYPAIR_FILE_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_KEYPAIR_FILE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include <nil/marshalling/status_type.hpp>
+
+#include <nil/crypto3/hash/algorithm/hash.hpp>
+#include <nil/crypto3/hash/sha2.hpp>
+
+#include <nil/crypto3/zk/snark/durable_file.hpp>
+#include <nil/crypto3/zk/snark/sectioned_file.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_digest.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_proving_key.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/marshalling.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                template<typename ProofSystem>
+                class r1cs_gg_ppzksnark_keypair_file {
+                    typedef ProofSystem scheme_type;
+                    typedef typename scheme_type::proving_key_type::curve_type curve_type;
+                    typedef typename curve_type::g1_type g1_type;
+                    typedef typename curve_type::g2_type g2_type;
+
+                    typedef nil::marshalling::verifier_input_serializer_tvm<scheme_type> serializer_type;
+                    typedef nil::marshalling::verifier_input_deserializer_tvm<scheme_type> deserializer_type;
+                    typedef nil::marshalling::status_type status_type;
+                    typedef nil::marshalling::constraint_system_format constraint_system_format;
+                    typedef std::vector<std::uint8_t> byteblob_type;
+                    typedef typename deserializer_type::point_validation point_validation;
+
+                    static byteblob_type g1_vector_byteblob(const std::vector<typename g1_type::value_type> &v) {
+                        byteblob_type result(serializer_type::std_size_t_byteblob_size +
+                                             v.size() * serializer_type::g1_byteblob_size);
+                        typename byteblob_type::iterator write_iter = result.begin();
+                        serializer_type::std_size_t_process(v.size(), write_iter);
+                        for (const typename g1_type::value_type &point : v) {
+                            serializer_type::template g1_group_type_process<g1_type>(point, write_iter);
+                        }
+                        return result;
+                    }
+
+                    std::vector<typename g1_type::value_type> g1_vector(const std::string &name, status_type &status,
+                                                                        const point_validation validation) const {
+                        const byteblob_type bytes = file.read(name);
+                        const std::size_t count = deserializer_type::std_size_t_process(bytes.cbegin(), bytes.cend(),
+                                                                                        status);
+                        if (status != status_type::success) {
+                            return {};
+                        }
+                        return deserializer_type::template g1_group_type_vector_process<g1_type>(
+                            bytes.cbegin() + deserializer_type::std_size_t_byteblob_size, bytes.cend(), count, status,
+                            validation);
+                    }
+
+                    /**
+                     * Decompresses the G1 query of section name by chunks of chunk_points points, each
+                     * one handed to write(first, values, count) before the next one is read.
+                     */
+                    template<typename Function>
+                    std::size_t expand_g1_vector(const std::string &name, status_type &status,
+                                                 const point_validation validation, const std::size_t chunk_points,
+                                                 Function write) const {
+                        const std::size_t count = g1_vector_size(name, status);
+                        for (std::size_t first = 0; first < count && status == status_type::success;
+                             first += chunk_points) {
+                            const std::size_t chunk_count = std::min(chunk_points, count - first);
+                            const byteblob_type bytes =
+                                file.read(name, deserializer_type::std_size_t_byteblob_size +
+                                                    first * deserializer_type::g1_byteblob_size,
+                                          chunk_count * deserializer_type::g1_byteblob_size);
+                            const std::vector<typename g1_type::value_type> values =
+                                deserializer_type::template g1_group_type_vector_process<g1_type>(
+                                    bytes.cbegin(), bytes.cend(), chunk_count, status, validation);
+                            if (status == status_type::success) {
+                                write(first, values.data(), chunk_count);
+                            }
+                        }
+                        return count;
+                    }
+
+                    std::size_t g1_vector_size(const std::string &name, status_type &status) const {
+                        const std::uint64_t size = file.section(name).size;
+                        if (size < deserializer_type::std_size_t_byteblob_size) {
+                            status = status_type::not_enough_data;
+                            return 0;
+                        }
+                        const byteblob_type bytes = file.read(name, 0, deserializer_type::std_size_t_byteblob_size);
+                        const std::size_t count =
+                            deserializer_type::std_size_t_process(bytes.cbegin(), bytes.cend(), status);
+                        if (status == status_type::success &&
+                            (size - deserializer_type::std_size_t_byteblob_size) / deserializer_type::g1_byteblob_size <
+                                count) {
+                            status = status_type::not_enough_data;
+                        }
+                        return status == status_type::success ? count : 0;
+                    }
+
+                    sectioned_file file;
+
+                public:
+                    typedef typename scheme_type::proving_key_type proving_key_type;
+                    typedef typename scheme_type::verification_key_type verification_key_type;
+                    typedef typename scheme_type::keypair_type keypair_type;
+                    typedef r1cs_gg_ppzksnark_mapped_proving_key<curve_type,
+                                                                 typename proving_key_type::constraint_system_type>
+                        mapped_proving_key_type;
+                    typedef typename mapped_proving_key_type::source_digest_type source_digest_type;
+
+                    /* points decompressed at a time by an expansion, 48 MiB of BLS12-381 G1 affine points */
+                    static constexpr const std::size_t expansion_chunk_points = std::size_t(1) << 18;
+
+                    static constexpr const char *verification_key_section = "verification_key";
+                    static constexpr const char *points_section = "proving_key.points";
+                    static constexpr const char *A_query_section = "proving_key.A_query";
+                    static constexpr const char *B_query_section = "proving_key.B_query";
+                    static constexpr const char *H_query_section = "proving_key.H_query";
+                    static constexpr const char *L_query_section = "proving_key.L_query";
+                    static constexpr const char *constraint_system_section = "proving_key.constraint_system";
+                    static constexpr const char *compact_constraint_system_section =
+                        "proving_key.compact_constraint_system";
+
+                    /**
+                     * Opens the keypair file at path, previously produced by write(), reading its table of
+                     * contents only.
+                     */
+                    explicit r1cs_gg_ppzksnark_keypair_file(const std::string &path) : file(path) {
+                    }
+
+                    static void write(const std::string &path, const proving_key_type &proving_key,
+                                      const verification_key_type &verification_key,
+                                      const constraint_system_format format = constraint_system_format::full_width) {
+                        sectioned_file_writer out(path, 7);
+                        out.write_section(verification_key_section, serializer_type::process(verification_key));
+
+                        byteblob_type points(3 * serializer_type::g1_byteblob_size +
+                                             2 * serializer_type::g2_byteblob_size);
+                        typename byteblob_type::iterator write_iter = points.begin();
+                        serializer_type::template g1_group_type_process<g1_type>(proving_key.alpha_g1, write_iter);
+                        serializer_type::template g1_group_type_process<g1_type>(proving_key.beta_g1, write_iter);
+                        serializer_type::template g2_group_type_process<g2_type>(proving_key.beta_g2, write_iter);
+                        serializer_type::template g1_group_type_process<g1_type>(proving_key.delta_g1, write_iter);
+                        serializer_type::template g2_group_type_process<g2_type>(proving_key.delta_g2, write_iter);
+                        out.write_section(points_section, points);
+
+                        out.write_section(A_query_section, g1_vector_byteblob(proving_key.A_query));
+                        byteblob_type B_query(serializer_type::get_g2g1_knowledge_commitment_vector_size(
+                            proving_key.B_query));
+                        write_iter = B_query.begin();
+                        serializer_type::g2g1_knowledge_commitment_vector_process(proving_key.B_query, write_iter);
+                        out.write_section(B_query_section, B_query);
+                        out.write_section(H_query_section, g1_vector_byteblob(proving_key.H_query));
+                        out.write_section(L_query_section, g1_vector_byteblob(proving_key.L_query));
+
+                        out.write_section(format == constraint_system_format::compact ?
+                                              compact_constraint_system_section :
+                                              constraint_system_section,
+                                          serializer_type::process(proving_key.constraint_system, format));
+                        out.close();
+                    }
+
+                    static void write(const std::string &path, const keypair_type &keypair,
+                                      const constraint_system_format format = constraint_system_format::full_width) {
+                        write(path, keypair.first, keypair.second, format);
+                    }
+
+                    const sectioned_file &sections() const {
+                        return file;
+                    }
+
+                    verification_key_type
+                        verification_key(status_type &status,
+                                         const point_validation validation = point_validation::subgroup_check) const {
+                        const byteblob_type bytes = file.read(verification_key_section);
+                        return deserializer_type::verification_key_process(bytes.cbegin(), bytes.cend(), status,
+                                                                           validation);
+                    }
+
+                    std::vector<typename g1_type::value_type>
+                        A_query(status_type &status,
+                                const point_validation validation = point_validation::subgroup_check) const {
+                        return g1_vector(A_query_section, status, validation);
+                    }
+
+                    knowledge_commitment_vector<g2_type, g1_type>
+                        B_query(status_type &status,
+                                const point_validation validation = point_validation::subgroup_check) const {
+                        const byteblob_type bytes = file.read(B_query_section);
+                        return deserializer_type::g2g1_knowledge_commitment_vector_process(bytes.cbegin(),
+                                                                                           bytes.cend(), status,
+                                                                                           validation);
+                    }
+
+                    std::vector<typename g1_type::value_type>
+                        H_query(status_type &status,
+                                const point_validation validation = point_validation::subgroup_check) const {
+                        return g1_vector(H_query_section, status, validation);
+                    }
+
+                    std::vector<typename g1_type::value_type>
+                        L_query(status_type &status,
+                                const point_validation validation = point_validation::subgroup_check) const {
+                        return g1_vector(L_query_section, status, validation);
+                    }
+
+                    typename proving_key_type::constraint_system_type constraint_system(status_type &status) const {
+                        const bool compact = file.contains(compact_constraint_system_section);
+                        const byteblob_type bytes =
+                            file.read(compact ? compact_constraint_system_section : constraint_system_section);
+                        return deserializer_type::r1cs_constraint_system_process(
+                            bytes.cbegin(), bytes.cend(), status,
+                            compact ? constraint_system_format::compact : constraint_system_format::full_width);
+                    }
+
+                    /**
+                     * Reads every section of the proving key.
+                     */
+                    proving_key_type proving_key(status_type &status,
+                                                 const point_validation validation =
+                                                     point_validation::subgroup_check) const {
+                        const byteblob_type points = file.read(points_section);
+                        if (points.size() != 3 * deserializer_type::g1_byteblob_size +
+                                                 2 * deserializer_type::g2_byteblob_size) {
+                            status = status_type::not_enough_data;
+                            return proving_key_type();
+                        }
+
+                        /* every point resets the status, so the first failure is kept aside */
+                        typename byteblob_type::const_iterator read_iter = points.cbegin();
+                        status_type points_status = status_type::success;
+                        const auto g1_point = [&]() {
+                            const typename g1_type::value_type point =
+                                deserializer_type::template g1_group_type_process<g1_type>(
+                                    read_iter, read_iter + deserializer_type::g1_byteblob_size, status, validation);
+                            read_iter += deserializer_type::g1_byteblob_size;
+                            points_status = points_status == status_type::success ? status : points_status;
+                            return point;
+                        };
+                        const auto g2_point = [&]() {
+                            const typename g2_type::value_type point =
+                                deserializer_type::template g2_group_type_process<g2_type>(
+                                    read_iter, read_iter + deserializer_type::g2_byteblob_size, status, validation);
+                            read_iter += deserializer_type::g2_byteblob_size;
+                            points_status = points_status == status_type::success ? status : points_status;
+                            return point;
+                        };
+
+                        typename g1_type::value_type alpha_g1 = g1_point();
+                        typename g1_type::value_type beta_g1 = g1_point();
+                        typename g2_type::value_type beta_g2 = g2_point();
+                        typename g1_type::value_type delta_g1 = g1_point();
+                        typename g2_type::value_type delta_g2 = g2_point();
+                        status = points_status;
+                        if (status != status_type::success) {
+                            return proving_key_type();
+                        }
+
+                        std::vector<typename g1_type::value_type> A = A_query(status, validation);
+                        if (status != status_type::success) {
+                            return proving_key_type();
+                        }
+                        knowledge_commitment_vector<g2_type, g1_type> B = B_query(status, validation);
+                        if (status != status_type::success) {
+                            return proving_key_type();
+                        }
+                        std::vector<typename g1_type::value_type> H = H_query(status, validation);
+                        if (status != status_type::success) {
+                            return proving_key_type();
+                        }
+                        std::vector<typename g1_type::value_type> L = L_query(status, validation);
+                        if (status != status_type::success) {
+                            return proving_key_type();
+                        }
+                        typename proving_key_type::constraint_system_type cs = constraint_system(status);
+                        if (status != status_type::success) {
+                            return proving_key_type();
+                        }
+
+                        return proving_key_type(std::move(alpha_g1), std::move(beta_g1), std::move(beta_g2),
+                                                std::move(delta_g1), std::move(delta_g2), std::move(A), std::move(B),
+                                                std::move(H), std::move(L), std::move(cs));
+                    }
+
+                    /**
+                     * The digest an expansion of this file is recorded with, see the file comment.
+                     */
+                    source_digest_type source_digest() const {
+                        typedef hashes::sha2<256> hash_type;
+
+                        byteblob_type bytes;
+                        for (const sectioned_file::entry_type &entry : file.sections()) {
+                            detail::append_r1cs_digest_size(entry.name.size(), bytes);
+                            bytes.insert(bytes.end(), entry.name.begin(), entry.name.end());
+                            detail::append_r1cs_digest_size(entry.size, bytes);
+                        }
+                        for (const char *name : {verification_key_section, points_section}) {
+                            const byteblob_type section = file.read(name);
+                            bytes.insert(bytes.end(), section.begin(), section.end());
+                        }
+
+                        accumulator_set<hash_type> acc;
+                        hash<hash_type>(bytes.begin(), bytes.end(), acc);
+                        const typename hash_type::digest_type digest = detail::extract_r1cs_digest(acc);
+                        source_digest_type result;
+                        BOOST_ASSERT(digest.size() == result.size());
+                        std::copy(digest.begin(), digest.end(), result.begin());
+                        return result;
+                    }
+
+                    /**
+                     * Writes the proving key in the memory-mapped layout of r1cs_gg_ppzksnark_mapped_proving_key
+                     * to mapped_path, decompressing its queries by chunks of chunk_points points. The file
+                     * is written under a temporary name and renamed once complete, so concurrent expansions
+                     * by several processes leave one complete file. Nothing is left on failure.
+                     */
+                    void expand_proving_key(const std::string &mapped_path, status_type &status,
+                                            const point_validation validation = point_validation::subgroup_check,
+                                            const std::size_t chunk_points = expansion_chunk_points) const {
+                        const typename proving_key_type::constraint_system_type cs = constraint_system(status);
+                        if (status == status_type::success) {
+                            expand_proving_key(mapped_path, cs, status, validation, chunk_points);
+                        }
+                    }
+
+                    /**
+                     * The proving key mapped from mapped_path, which is expanded first, see
+                     * expand_proving_key, unless it already holds the expansion of this file. The
+                     * constraint system is read from this file.
+                     */
+                    mapped_proving_key_type
+                        expanded_proving_key(const std::string &mapped_path, status_type &status,
+                                             const point_validation validation = point_validation::subgroup_check,
+                                             const std::size_t chunk_points = expansion_chunk_points) const {
+                        typename proving_key_type::constraint_system_type cs = constraint_system(status);
+                        if (status != status_type::success) {
+                            return mapped_proving_key_type();
+                        }
+
+                        if (::access(mapped_path.c_str(), F_OK) == 0) {
+                            try {
+                                mapped_proving_key_type mapped(mapped_path, std::move(cs));
+                                if (expands(mapped)) {
+                                    return mapped;
+                                }
+                                cs = std::move(mapped.constraint_system);
+                            } catch (const std::exception &) {
+                                // truncated or of another build: expanded again below, the constraint
+                                // system being read again as the failed mapping may have taken it
+                                cs = constraint_system(status);
+                                if (status != status_type::success) {
+                                    return mapped_proving_key_type();
+                                }
+                            }
+                        }
+                        expand_proving_key(mapped_path, cs, status, validation, chunk_points);
+                        if (status != status_type::success) {
+                            return mapped_proving_key_type();
+                        }
+                        return mapped_proving_key_type(mapped_path, std::move(cs));
+                    }
+
+                private:
+                    /* whether mapped is the expansion of this file */
+                    bool expands(const mapped_proving_key_type &mapped) const {
+                        const typename proving_key_type::constraint_system_type &cs = mapped.constraint_system;
+                        return mapped.num_constraints() == cs.num_constraints() &&
+                               mapped.num_inputs() == cs.num_inputs() && mapped.num_variables() == cs.num_variables() &&
+                               mapped.source_digest() == source_digest();
+                    }
+
+                    void expand_proving_key(const std::string &mapped_path,
+                                            const typename proving_key_type::constraint_system_type &cs,
+                                            status_type &status, const point_validation validation,
+                                            const std::size_t chunk_points) const {
+                        BOOST_ASSERT(chunk_points > 0);
+
+                        status = status_type::success;
+                        const byteblob_type points = file.read(points_section);
+                        if (points.size() != 3 * deserializer_type::g1_byteblob_size +
+                                                 2 * deserializer_type::g2_byteblob_size) {
+                            status = status_type::not_enough_data;
+                            return;
+                        }
+                        std::vector<typename g1_type::value_type> g1_points =
+                            deserializer_type::template g1_group_type_vector_process<g1_type>(
+                                points.cbegin(), points.cbegin() + 2 * deserializer_type::g1_byteblob_size, 2, status,
+                                validation);
+                        if (status != status_type::success) {
+                            return;
+                        }
+                        const auto delta_g1_first = points.cbegin() + 2 * deserializer_type::g1_byteblob_size +
+                                                    deserializer_type::g2_byteblob_size;
+                        const typename g1_type::value_type delta_g1 =
+                            deserializer_type::template g1_group_type_process<g1_type>(
+                                delta_g1_first, delta_g1_first + deserializer_type::g1_byteblob_size, status,
+                                validation);
+                        if (status != status_type::success) {
+                            return;
+                        }
+                        const auto beta_g2_first = points.cbegin() + 2 * deserializer_type::g1_byteblob_size;
+                        const typename g2_type::value_type beta_g2 =
+                            deserializer_type::template g2_group_type_process<g2_type>(
+                                beta_g2_first, beta_g2_first + deserializer_type::g2_byteblob_size, status,
+                                validation);
+                        if (status != status_type::success) {
+                            return;
+                        }
+                        const auto delta_g2_first = delta_g1_first + deserializer_type::g1_byteblob_size;
+                        const typename g2_type::value_type delta_g2 =
+                            deserializer_type::template g2_group_type_process<g2_type>(
+                                delta_g2_first, delta_g2_first + deserializer_type::g2_byteblob_size, status,
+                                validation);
+                        if (status != status_type::success) {
+                            return;
+                        }
+
+                        const knowledge_commitment_vector<g2_type, g1_type> B = B_query(status, validation);
+                        const std::size_t A_size =
+                            status == status_type::success ? g1_vector_size(A_query_section, status) : 0;
+                        const std::size_t H_size =
+                            status == status_type::success ? g1_vector_size(H_query_section, status) : 0;
+                        const std::size_t L_size =
+                            status == status_type::success ? g1_vector_size(L_query_section, status) : 0;
+                        if (status != status_type::success) {
+                            return;
+                        }
+
+                        const std::string temporary_path = mapped_path + ".tmp." + std::to_string(::getpid());
+                        try {
+                            typename mapped_proving_key_type::writer out(temporary_path, A_size, B.size(),
+                                                                         B.domain_size(), H_size, L_size);
+                            out.write_source(cs.num_constraints(), cs.num_inputs(), cs.num_variables(),
+                                             source_digest());
+                            out.write_points(g1_points[0], g1_points[1], delta_g1, beta_g2, delta_g2);
+
+                            std::vector<std::uint64_t> B_indices(B.indices.begin(), B.indices.end());
+                            std::vector<typename g2_type::value_type> B_g;
+                            std::vector<typename g1_type::value_type> B_h;
+                            B_g.reserve(B.size());
+                            B_h.reserve(B.size());
+                            for (const auto &value : B.values) {
+                                B_g.emplace_back(value.g);
+                                B_h.emplace_back(value.h);
+                            }
+                            out.write_B_query(0, B_indices.data(), B_g.data(), B_h.data(), B_indices.size());
+
+                            expand_g1_vector(A_query_section, status, validation, chunk_points,
+                                             [&](const std::size_t first, const typename g1_type::value_type *values,
+                                                 const std::size_t count) { out.write_A_query(first, values, count); });
+                            if (status == status_type::success) {
+                                expand_g1_vector(
+                                    H_query_section, status, validation, chunk_points,
+                                    [&](const std::size_t first, const typename g1_type::value_type *values,
+                                        const std::size_t count) { out.write_H_query(first, values, count); });
+                            }
+                            if (status == status_type::success) {
+                                expand_g1_vector(
+                                    L_query_section, status, validation, chunk_points,
+                                    [&](const std::size_t first, const typename g1_type::value_type *values,
+                                        const std::size_t count) { out.write_L_query(first, values, count); });
+                            }
+                            out.close();
+                        } catch (...) {
+                            std::remove(temporary_path.c_str());
+                            throw;
+                        }
+
+                        if (status != status_type::success) {
+                            std::remove(temporary_path.c_str());
+                            return;
+                        }
+                        if (!durable_rename(temporary_path, mapped_path)) {
+                            std::remove(temporary_path.c_str());
+                            throw std::runtime_error("r1cs_gg_ppzksnark_keypair_file: cannot write " + mapped_path);
+                        }
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_KEYPAIR_FILE_HPP
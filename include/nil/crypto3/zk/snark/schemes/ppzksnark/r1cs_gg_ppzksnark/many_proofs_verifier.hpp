@@ -0,0 +1,370 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the verifier of many proofs of the R1CS GG-ppzkSNARK.
+//
+// n proofs of one circuit can be checked directly, with the randomized batch
+// verifier, or aggregated with IPP2 and checked through their aggregate. Batch
+// verification is linear in n with a small constant; aggregation costs the prover
+// far more but its aggregate is checked in logarithmic time by every later verifier
+// and is what has to be stored or relayed in place of the proofs. The verifier of
+// many proofs picks the cheaper way from linear cost models of the three operations
+// and from the demand of the caller: whether an aggregate is needed at all, and how
+// many verifiers downstream will check the same proofs. When an aggregate is needed,
+// batch verifying the proofs first rejects invalid batches before they are
+// aggregated, which pays off whenever the batch check is cheaper than checking the
+// aggregate.
+//
+// The cost models depend on the curve, the circuit through its number of primary
+// inputs, the proving SRS through its size and the executor, so calibrate() measures
+// them on the keys in use; the defaults are only rough figures.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_MANY_PROOFS_VERIFIER_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_MANY_PROOFS_VERIFIER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <nil/crypto3/hash/sha2.hpp>
+
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verifier.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verification_key_registry.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/verifier.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                enum class r1cs_gg_ppzksnark_verification_strategy {
+                    /* the proofs are batch verified, by every verifier */
+                    batch_verification,
+                    /* the proofs are aggregated and every verifier checks the aggregate */
+                    aggregation,
+                    /* the proofs are batch verified, then aggregated for the verifiers downstream */
+                    batch_verification_then_aggregation
+                };
+
+                /**
+                 * What the caller needs besides the verdict: whether an aggregate of the proofs must be
+                 * produced, to be stored or relayed, and how many verifiers downstream will check the same
+                 * proofs, through the aggregate if there is one and directly otherwise.
+                 */
+                struct r1cs_gg_ppzksnark_verification_demand {
+                    bool aggregate_required = false;
+                    std::size_t downstream_verifiers = 0;
+                };
+
+                /* Seconds taken by an operation on n proofs. */
+                struct r1cs_gg_ppzksnark_linear_cost {
+                    double fixed = 0;
+                    double per_proof = 0;
+
+                    double operator()(const std::size_t n) const {
+                        return fixed + per_proof * n;
+                    }
+
+                    /* the line through the times t1 and t2 measured on n1 < n2 proofs, clamped to non-negative */
+                    static r1cs_gg_ppzksnark_linear_cost fit(const std::size_t n1, const double t1,
+                                                             const std::size_t n2, const double t2) {
+                        r1cs_gg_ppzksnark_linear_cost result;
+                        result.per_proof = std::max(0.0, (t2 - t1) / (n2 - n1));
+                        result.fixed = std::max(0.0, t2 - result.per_proof * n2);
+                        return result;
+                    }
+                };
+
+                /**
+                 * Cost models of the batch verification of n proofs, of their aggregation and of the
+                 * verification of their aggregate, for one circuit and one proving SRS. The SRS size
+                 * only enters the fixed costs of the last two, their logarithmic GIPA rounds included.
+                 * The defaults are rough single-core figures for BLS12-381 and a small SRS.
+                 *
+                 * current() is a copy of the models shared by all the threads, which set_current()
+                 * replaces, typically by the result of calibrate(); both take the same lock.
+                 */
+                struct r1cs_gg_ppzksnark_verification_costs {
+                    r1cs_gg_ppzksnark_linear_cost batch_verification {2e-3, 0.6e-3};
+                    r1cs_gg_ppzksnark_linear_cost aggregation {0.1, 1.5e-3};
+                    r1cs_gg_ppzksnark_linear_cost aggregate_verification {20e-3, 20e-6};
+
+                    static r1cs_gg_ppzksnark_verification_costs current() {
+                        std::lock_guard<std::mutex> lock(shared_mutex());
+                        return shared();
+                    }
+
+                    static void set_current(const r1cs_gg_ppzksnark_verification_costs &costs) {
+                        std::lock_guard<std::mutex> lock(shared_mutex());
+                        shared() = costs;
+                    }
+
+                    /* Seconds spent on n proofs by strategy, over the caller and the verifiers downstream. */
+                    double cost(const r1cs_gg_ppzksnark_verification_strategy strategy, const std::size_t n,
+                                const r1cs_gg_ppzksnark_verification_demand &demand) const {
+                        const double verifiers = 1.0 + demand.downstream_verifiers;
+                        switch (strategy) {
+                            case r1cs_gg_ppzksnark_verification_strategy::batch_verification:
+                                return verifiers * batch_verification(n);
+                            case r1cs_gg_ppzksnark_verification_strategy::aggregation:
+                                return aggregation(n) + verifiers * aggregate_verification(n);
+                            case r1cs_gg_ppzksnark_verification_strategy::batch_verification_then_aggregation:
+                                return batch_verification(n) + aggregation(n) +
+                                       (verifiers - 1) * aggregate_verification(n);
+                        }
+                        return 0;
+                    }
+
+                    /**
+                     * The cheapest strategy for n proofs and a proving SRS of capacity proofs. Proofs that
+                     * cannot be aggregated, none or more than capacity, are batch verified whatever the
+                     * demand, and batch verification alone is only chosen when no aggregate is required.
+                     */
+                    r1cs_gg_ppzksnark_verification_strategy choose(const std::size_t n, const std::size_t capacity,
+                                                                   const r1cs_gg_ppzksnark_verification_demand
+                                                                       &demand) const {
+                        typedef r1cs_gg_ppzksnark_verification_strategy strategy_type;
+
+                        if (n == 0 || n > capacity) {
+                            return strategy_type::batch_verification;
+                        }
+                        strategy_type result = strategy_type::aggregation;
+                        const auto consider = [&](const strategy_type strategy) {
+                            if (cost(strategy, n, demand) < cost(result, n, demand)) {
+                                result = strategy;
+                            }
+                        };
+                        consider(strategy_type::batch_verification_then_aggregation);
+                        if (!demand.aggregate_required) {
+                            consider(strategy_type::batch_verification);
+                        }
+                        return result;
+                    }
+
+                private:
+                    static r1cs_gg_ppzksnark_verification_costs &shared() {
+                        static r1cs_gg_ppzksnark_verification_costs costs;
+                        return costs;
+                    }
+
+                    static std::mutex &shared_mutex() {
+                        static std::mutex mutex;
+                        return mutex;
+                    }
+                };
+
+                /**
+                 * Verifier of many proofs of one circuit, with strong input consistency, which batch
+                 * verifies them, aggregates them or both as chosen by r1cs_gg_ppzksnark_verification_costs.
+                 * The proving SRS may be prepared or not, the transcript inclusion is the one of
+                 * aggregate_proofs and verify_aggregate_proof.
+                 */
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = random_device_generator, typename Hash = hashes::sha2<256>>
+                class r1cs_gg_ppzksnark_many_proofs_verifier {
+                    typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
+                    typedef r1cs_gg_ppzksnark_verifier_strong_input_consistency<CurveType> batch_verifier_type;
+
+                public:
+                    typedef typename policy_type::primary_input_type primary_input_type;
+                    typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
+                    typedef typename policy_type::proof_type proof_type;
+                    typedef r1cs_gg_ppzksnark_proof_batch<CurveType> proof_batch_type;
+
+                    typedef r1cs_gg_ppzksnark_aggregate_proving_srs<CurveType> proving_srs_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_prepared_proving_srs<CurveType> prepared_proving_srs_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_processed_verification_key<CurveType>
+                        processed_aggregate_verification_key_type;
+                    typedef r1cs_gg_ppzksnark_aggregate_proof<CurveType> aggregate_proof_type;
+
+                    struct result_type {
+                        bool verified = false;
+                        r1cs_gg_ppzksnark_verification_strategy strategy =
+                            r1cs_gg_ppzksnark_verification_strategy::batch_verification;
+                        /* the aggregate of the proofs, when the strategy produced one and they verified */
+                        boost::optional<aggregate_proof_type> aggregate;
+                    };
+
+                    /**
+                     * Verifies proofs against their public_inputs, one range per proof, following the
+                     * strategy costs chooses for demand. With batch_verification_then_aggregation, proofs
+                     * failing the batch check are not aggregated.
+                     */
+                    template<typename ProvingSrs, typename InputRangesRange, typename InputIterator>
+                    static result_type
+                        process(const ProvingSrs &srs,
+                                const processed_verification_key_type &processed_verification_key,
+                                const processed_aggregate_verification_key_type &processed_aggregate_vk,
+                                const InputRangesRange &public_inputs,
+                                const proof_batch_type &proofs,
+                                InputIterator transcript_include_first,
+                                InputIterator transcript_include_last,
+                                const r1cs_gg_ppzksnark_verification_demand &demand = {},
+                                const r1cs_gg_ppzksnark_verification_costs &costs =
+                                    r1cs_gg_ppzksnark_verification_costs::current()) {
+                        typedef r1cs_gg_ppzksnark_verification_strategy strategy_type;
+
+                        result_type result;
+                        result.strategy = costs.choose(proofs.size(), capacity(srs), demand);
+                        if (std::size_t(std::distance(std::begin(public_inputs), std::end(public_inputs))) !=
+                            proofs.size()) {
+                            return result;
+                        }
+
+                        if (result.strategy != strategy_type::aggregation) {
+                            result.verified = batch_verifier_type::template process_batch<DistributionType,
+                                                                                          GeneratorType>(
+                                processed_verification_key, std::begin(public_inputs), std::end(public_inputs),
+                                proofs);
+                            if (!result.verified || result.strategy == strategy_type::batch_verification) {
+                                return result;
+                            }
+                        }
+
+                        result.aggregate =
+                            aggregate_proofs<CurveType, Hash>(srs, transcript_include_first, transcript_include_last,
+                                                             proofs);
+                        if (result.strategy == strategy_type::aggregation) {
+                            result.verified = verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                                processed_aggregate_vk, public_inputs, *result.aggregate, transcript_include_first,
+                                transcript_include_last);
+                            if (!result.verified) {
+                                result.aggregate = boost::none;
+                            }
+                        }
+                        return result;
+                    }
+
+                    /**
+                     * Same as above with the processed verification key of the proofs held by registry
+                     * under key_digest, see r1cs_gg_ppzksnark_verification_key_registry::at.
+                     */
+                    template<typename ProvingSrs, typename RegistryHash, typename InputRangesRange,
+                             typename InputIterator>
+                    static result_type
+                        process(const ProvingSrs &srs,
+                                const r1cs_gg_ppzksnark_verification_key_registry<CurveType, RegistryHash> &registry,
+                                const typename RegistryHash::digest_type &key_digest,
+                                const processed_aggregate_verification_key_type &processed_aggregate_vk,
+                                const InputRangesRange &public_inputs,
+                                const proof_batch_type &proofs,
+                                InputIterator transcript_include_first,
+                                InputIterator transcript_include_last,
+                                const r1cs_gg_ppzksnark_verification_demand &demand = {},
+                                const r1cs_gg_ppzksnark_verification_costs &costs =
+                                    r1cs_gg_ppzksnark_verification_costs::current()) {
+                        return process(srs, *registry.at(key_digest), processed_aggregate_vk, public_inputs, proofs,
+                                       transcript_include_first, transcript_include_last, demand, costs);
+                    }
+
+                    /**
+                     * Cost models measured on this machine, on the current executor, with valid proofs and
+                     * their public_inputs, at least two and at most the capacity of srs. Every operation is
+                     * timed on all the proofs and on their first half, the best of repetitions runs, and
+                     * the line through both times is its model.
+                     */
+                    template<typename ProvingSrs, typename InputIterator>
+                    static r1cs_gg_ppzksnark_verification_costs
+                        calibrate(const ProvingSrs &srs,
+                                  const processed_verification_key_type &processed_verification_key,
+                                  const processed_aggregate_verification_key_type &processed_aggregate_vk,
+                                  const std::vector<primary_input_type> &public_inputs,
+                                  const std::vector<proof_type> &proofs,
+                                  InputIterator transcript_include_first,
+                                  InputIterator transcript_include_last,
+                                  const std::size_t repetitions = 3) {
+                        BOOST_ASSERT(proofs.size() >= 2 && proofs.size() <= capacity(srs));
+                        BOOST_ASSERT(public_inputs.size() == proofs.size());
+
+                        const auto seconds = [&](auto operation) {
+                            double best = 0;
+                            for (std::size_t r = 0; r < repetitions; ++r) {
+                                const auto start = std::chrono::steady_clock::now();
+                                operation();
+                                const double elapsed =
+                                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                                best = r ? std::min(best, elapsed) : elapsed;
+                            }
+                            return best;
+                        };
+
+                        const std::size_t sizes[] = {proofs.size() / 2, proofs.size()};
+                        double batch_verification[2], aggregation[2], aggregate_verification[2];
+                        for (std::size_t i = 0; i < 2; ++i) {
+                            const std::vector<primary_input_type> inputs(public_inputs.begin(),
+                                                                         public_inputs.begin() + sizes[i]);
+                            const proof_batch_type batch(proofs.begin(), proofs.begin() + sizes[i]);
+
+                            batch_verification[i] = seconds([&]() {
+                                return batch_verifier_type::template process_batch<DistributionType, GeneratorType>(
+                                    processed_verification_key, inputs.begin(), inputs.end(), batch);
+                            });
+                            aggregation[i] = seconds([&]() {
+                                return aggregate_proofs<CurveType, Hash>(srs, transcript_include_first,
+                                                                         transcript_include_last, batch);
+                            });
+                            const aggregate_proof_type aggregate = aggregate_proofs<CurveType, Hash>(
+                                srs, transcript_include_first, transcript_include_last, batch);
+                            aggregate_verification[i] = seconds([&]() {
+                                return verify_aggregate_proof<CurveType, DistributionType, GeneratorType, Hash>(
+                                    processed_aggregate_vk, inputs, aggregate, transcript_include_first,
+                                    transcript_include_last);
+                            });
+                        }
+
+                        r1cs_gg_ppzksnark_verification_costs result;
+                        result.batch_verification = r1cs_gg_ppzksnark_linear_cost::fit(
+                            sizes[0], batch_verification[0], sizes[1], batch_verification[1]);
+                        result.aggregation =
+                            r1cs_gg_ppzksnark_linear_cost::fit(sizes[0], aggregation[0], sizes[1], aggregation[1]);
+                        result.aggregate_verification = r1cs_gg_ppzksnark_linear_cost::fit(
+                            sizes[0], aggregate_verification[0], sizes[1], aggregate_verification[1]);
+                        return result;
+                    }
+
+                private:
+                    static std::size_t capacity(const proving_srs_type &srs) {
+                        return srs.n;
+                    }
+
+                    static std::size_t capacity(const prepared_proving_srs_type &prepared_srs) {
+                        return prepared_srs.srs.n;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_MANY_PROOFS_VERIFIER_HPP
@@ -0,0 +1,618 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a memory-mapped storage of the R1CS GG-ppzkSNARK proving key.
+//
+// The query vectors of the proving key are written once into a file with a fixed
+// binary layout (a header followed by 64-byte aligned sections holding the native
+// representation of the group elements). Opening the file maps it into memory, so the
+// key is usable without deserialization and its pages are shared by every process
+// mapping the same file. The layout is tied to the in-memory representation of the
+// group elements, hence to the build that produced it.
+//
+// The header may also record where the key comes from: the sizes of its constraint system
+// and a digest of its source, such as the keypair file it was expanded from (see
+// keypair_file.hpp), so a stale file left by another key is told apart from the one
+// expected. Both are zero when they are not set.
+//
+// Read over the page cache, the queries are backed by normal pages. advise_huge_pages asks
+// for transparent huge pages over the mapping, which kernels with huge pages for read-only
+// file mappings use; load_into_huge_pages instead copies the file into private memory of
+// explicit huge pages, see huge_pages.hpp, at the cost of a copy of the key per process.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_MAPPED_PROVING_KEY_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_MAPPED_PROVING_KEY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/assert.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nil/crypto3/hash/algorithm/hash.hpp>
+#include <nil/crypto3/hash/sha2.hpp>
+
+#include <nil/crypto3/zk/snark/huge_pages.hpp>
+#include <nil/crypto3/zk/snark/memory_residency.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_digest.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proving_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType,
+                         typename ConstraintSystem = r1cs_constraint_system<typename CurveType::scalar_field_type>>
+                class r1cs_gg_ppzksnark_mapped_proving_key {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef typename g1_type::value_type g1_value_type;
+                    typedef typename g2_type::value_type g2_value_type;
+
+                    static constexpr const std::uint64_t magic = 0x4b50363147474e5aULL;    // "ZNGG16PK"
+                    static constexpr const std::uint64_t version = 2;
+                    static constexpr const std::size_t alignment = 64;
+                    static constexpr const std::size_t source_digest_size = 32;
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t g1_value_size;
+                        std::uint64_t g2_value_size;
+
+                        std::uint64_t A_query_size;
+                        std::uint64_t B_query_size;
+                        std::uint64_t B_query_domain_size;
+                        std::uint64_t H_query_size;
+                        std::uint64_t L_query_size;
+
+                        std::uint64_t num_constraints;
+                        std::uint64_t num_inputs;
+                        std::uint64_t num_variables;
+                        std::uint8_t source_digest[source_digest_size];
+
+                        std::uint64_t g1_points_offset;
+                        std::uint64_t g2_points_offset;
+                        std::uint64_t A_query_offset;
+                        std::uint64_t B_query_indices_offset;
+                        std::uint64_t B_query_g_offset;
+                        std::uint64_t B_query_h_offset;
+                        std::uint64_t H_query_offset;
+                        std::uint64_t L_query_offset;
+                        std::uint64_t file_size;
+                    };
+
+                    static_assert(std::is_trivially_copyable<header_type>::value, "header must be trivially copyable");
+
+                    static std::uint64_t align(std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    /* the mapped file, or its copy once loaded into huge pages */
+                    const char *data() const {
+                        return copy.empty() ? static_cast<const char *>(region.get_address()) : copy.data();
+                    }
+
+                    template<typename T>
+                    const T *section(std::uint64_t offset) const {
+                        return reinterpret_cast<const T *>(data() + offset);
+                    }
+
+                    const header_type &header() const {
+                        return *section<header_type>(0);
+                    }
+
+                    /* the sections of a file whose queries have the sizes given in h, laid out by the writer */
+                    static header_type layout(const header_type &h) {
+                        header_type result = h;
+                        result.g1_points_offset = align(sizeof(header_type));
+                        result.g2_points_offset = align(result.g1_points_offset + 3 * sizeof(g1_value_type));
+                        result.A_query_offset = align(result.g2_points_offset + 2 * sizeof(g2_value_type));
+                        result.B_query_indices_offset =
+                            align(result.A_query_offset + h.A_query_size * sizeof(g1_value_type));
+                        result.B_query_g_offset =
+                            align(result.B_query_indices_offset + h.B_query_size * sizeof(std::uint64_t));
+                        result.B_query_h_offset =
+                            align(result.B_query_g_offset + h.B_query_size * sizeof(g2_value_type));
+                        result.H_query_offset = align(result.B_query_h_offset + h.B_query_size * sizeof(g1_value_type));
+                        result.L_query_offset = align(result.H_query_offset + h.H_query_size * sizeof(g1_value_type));
+                        result.file_size = align(result.L_query_offset + h.L_query_size * sizeof(g1_value_type));
+                        return result;
+                    }
+
+                    /*
+                     * Checks the header of the file mapped by region, once the mapping is known to hold
+                     * one, and that every section it announces is where the writer puts it, within the
+                     * mapping. The query sizes are bounded by the mapping size before the layout is
+                     * computed, so it cannot overflow. The stored indices of B_query must increase and
+                     * lie in its domain, as the prover uses them to index the assignment.
+                     */
+                    static void check(const boost::interprocess::mapped_region &region, const std::string &path) {
+                        const std::uint64_t size = region.get_size();
+                        if (size < sizeof(header_type)) {
+                            throw std::runtime_error("r1cs_gg_ppzksnark_mapped_proving_key: incompatible file " +
+                                                     path);
+                        }
+                        const char *base = static_cast<const char *>(region.get_address());
+                        const header_type &h = *reinterpret_cast<const header_type *>(base);
+                        bool valid = h.magic == magic && h.version == version &&
+                                     h.g1_value_size == sizeof(g1_value_type) &&
+                                     h.g2_value_size == sizeof(g2_value_type) && h.file_size == size &&
+                                     h.A_query_size <= size && h.B_query_size <= size && h.H_query_size <= size &&
+                                     h.L_query_size <= size;
+                        if (valid) {
+                            const header_type expected = layout(h);
+                            valid = expected.file_size == size && h.g1_points_offset == expected.g1_points_offset &&
+                                    h.g2_points_offset == expected.g2_points_offset &&
+                                    h.A_query_offset == expected.A_query_offset &&
+                                    h.B_query_indices_offset == expected.B_query_indices_offset &&
+                                    h.B_query_g_offset == expected.B_query_g_offset &&
+                                    h.B_query_h_offset == expected.B_query_h_offset &&
+                                    h.H_query_offset == expected.H_query_offset &&
+                                    h.L_query_offset == expected.L_query_offset;
+                        }
+                        if (valid) {
+                            const std::uint64_t *indices =
+                                reinterpret_cast<const std::uint64_t *>(base + h.B_query_indices_offset);
+                            for (std::size_t i = 0; valid && i < h.B_query_size; ++i) {
+                                valid = indices[i] < h.B_query_domain_size && (i == 0 || indices[i] > indices[i - 1]);
+                            }
+                        }
+                        if (!valid) {
+                            throw std::runtime_error("r1cs_gg_ppzksnark_mapped_proving_key: incompatible file " +
+                                                     path);
+                        }
+                    }
+
+                    template<typename T>
+                    static void write_section(std::ofstream &out, std::uint64_t offset, const T *data,
+                                              std::size_t count) {
+                        out.seekp(offset);
+                        out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+                    }
+
+                    boost::interprocess::file_mapping mapping;
+                    boost::interprocess::mapped_region region;
+                    std::vector<char, huge_page_allocator<char>> copy;
+
+                public:
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType, ConstraintSystem> proving_key_type;
+                    typedef std::array<std::uint8_t, source_digest_size> source_digest_type;
+
+                    /**
+                     * The constraint system is not part of the mapped file: the prover only needs it
+                     * for the witness map, and it is provided by the caller.
+                     */
+                    constraint_system_type constraint_system;
+
+                    r1cs_gg_ppzksnark_mapped_proving_key() = default;
+                    r1cs_gg_ppzksnark_mapped_proving_key(r1cs_gg_ppzksnark_mapped_proving_key &&other) = default;
+                    r1cs_gg_ppzksnark_mapped_proving_key &
+                        operator=(r1cs_gg_ppzksnark_mapped_proving_key &&other) = default;
+
+                    /**
+                     * Maps the proving key file at path, previously produced by write().
+                     */
+                    r1cs_gg_ppzksnark_mapped_proving_key(const std::string &path,
+                                                         constraint_system_type &&constraint_system) :
+                        mapping(path.c_str(), boost::interprocess::read_only),
+                        region(mapping, boost::interprocess::read_only),
+                        constraint_system(std::move(constraint_system)) {
+                        check(region, path);
+                    }
+
+                    /**
+                     * SHA-256 of the header and the points of the proving key file at path, which are written
+                     * first and tell apart the files of two keys of the same layout. Returns false when path
+                     * holds no proving key file of this build.
+                     */
+                    static bool prefix_digest(const std::string &path, source_digest_type &digest) {
+                        typedef hashes::sha2<256> hash_type;
+
+                        std::ifstream in(path, std::ios::binary);
+                        header_type h;
+                        if (!in.read(reinterpret_cast<char *>(&h), sizeof(h)) || h.magic != magic ||
+                            h.version != version || h.g1_value_size != sizeof(g1_value_type) ||
+                            h.g2_value_size != sizeof(g2_value_type) || h.A_query_offset < sizeof(header_type) ||
+                            h.A_query_offset > h.file_size) {
+                            return false;
+                        }
+                        std::vector<std::uint8_t> bytes(h.A_query_offset);
+                        in.seekg(0);
+                        if (!in.read(reinterpret_cast<char *>(bytes.data()), bytes.size())) {
+                            return false;
+                        }
+
+                        accumulator_set<hash_type> acc;
+                        hash<hash_type>(bytes.begin(), bytes.end(), acc);
+                        const typename hash_type::digest_type result = detail::extract_r1cs_digest(acc);
+                        BOOST_ASSERT(result.size() == digest.size());
+                        std::copy(result.begin(), result.end(), digest.begin());
+                        return true;
+                    }
+
+                    /**
+                     * Writable mapping of a proving key file, for the tools updating a key in place,
+                     * such as the delta update of a phase-2 contribution (see delta_update.hpp). Only
+                     * the group elements can be changed, the layout is fixed by the file.
+                     */
+                    class updater {
+                    public:
+                        explicit updater(const std::string &path) :
+                            mapping(path.c_str(), boost::interprocess::read_write),
+                            region(mapping, boost::interprocess::read_write) {
+                            check(region, path);
+                        }
+
+                        g1_value_type &delta_g1() {
+                            return section<g1_value_type>(header().g1_points_offset)[2];
+                        }
+
+                        g2_value_type &delta_g2() {
+                            return section<g2_value_type>(header().g2_points_offset)[1];
+                        }
+
+                        g1_value_type *H_query_begin() {
+                            return section<g1_value_type>(header().H_query_offset);
+                        }
+
+                        g1_value_type *H_query_end() {
+                            return H_query_begin() + header().H_query_size;
+                        }
+
+                        g1_value_type *L_query_begin() {
+                            return section<g1_value_type>(header().L_query_offset);
+                        }
+
+                        g1_value_type *L_query_end() {
+                            return L_query_begin() + header().L_query_size;
+                        }
+
+                        /* Writes the changes back to the file. */
+                        void flush() {
+                            if (!region.flush(0, 0, false)) {
+                                throw std::runtime_error("r1cs_gg_ppzksnark_mapped_proving_key: flush failed");
+                            }
+                        }
+
+                    private:
+                        template<typename T>
+                        T *section(std::uint64_t offset) {
+                            return reinterpret_cast<T *>(static_cast<char *>(region.get_address()) + offset);
+                        }
+
+                        const header_type &header() const {
+                            return *reinterpret_cast<const header_type *>(region.get_address());
+                        }
+
+                        boost::interprocess::file_mapping mapping;
+                        boost::interprocess::mapped_region region;
+                    };
+
+                    /**
+                     * Incremental writer of a proving key file.
+                     *
+                     * The sizes of the query vectors fix the layout, so they are given up front; the
+                     * sections can then be written piecewise and in any order, which lets a generator
+                     * store every block of a query as soon as it is computed.
+                     *
+                     * A resuming writer reopens the file of an interrupted generation instead of
+                     * truncating it, after checking that it has the layout of these sizes, so the
+                     * sections already written are kept.
+                     */
+                    class writer {
+                    public:
+                        writer(const std::string &path, const std::size_t A_query_size,
+                               const std::size_t B_query_size, const std::size_t B_query_domain_size,
+                               const std::size_t H_query_size, const std::size_t L_query_size,
+                               const bool resume = false) :
+                            path(path),
+                            out(path, resume ? std::ios::binary | std::ios::in | std::ios::out :
+                                               std::ios::binary | std::ios::trunc) {
+                            static_assert(std::is_trivially_copyable<g1_value_type>::value &&
+                                              std::is_trivially_copyable<g2_value_type>::value,
+                                          "group elements must be trivially copyable to be memory-mapped");
+
+                            if (!out) {
+                                throw std::runtime_error("r1cs_gg_ppzksnark_mapped_proving_key: cannot write " + path);
+                            }
+
+                            std::memset(&h, 0, sizeof(h));
+                            h.magic = magic;
+                            h.version = version;
+                            h.g1_value_size = sizeof(g1_value_type);
+                            h.g2_value_size = sizeof(g2_value_type);
+                            h.A_query_size = A_query_size;
+                            h.B_query_size = B_query_size;
+                            h.B_query_domain_size = B_query_domain_size;
+                            h.H_query_size = H_query_size;
+                            h.L_query_size = L_query_size;
+                            h = layout(h);
+
+                            if (resume) {
+                                header_type existing;
+                                std::ifstream in(path, std::ios::binary);
+                                if (!in.read(reinterpret_cast<char *>(&existing), sizeof(existing)) ||
+                                    std::memcmp(&existing, &h, sizeof(h)) != 0) {
+                                    throw std::runtime_error("r1cs_gg_ppzksnark_mapped_proving_key: cannot resume " +
+                                                             path);
+                                }
+                                return;
+                            }
+
+                            write_section(out, 0, &h, 1);
+                            // pad the file up to its announced size
+                            out.seekp(h.file_size - 1);
+                            out.put(0);
+                        }
+
+                        /**
+                         * Records the sizes of the constraint system of the key and the digest of its
+                         * source in the header, see the file comment.
+                         */
+                        void write_source(const std::size_t num_constraints, const std::size_t num_inputs,
+                                          const std::size_t num_variables, const source_digest_type &digest) {
+                            h.num_constraints = num_constraints;
+                            h.num_inputs = num_inputs;
+                            h.num_variables = num_variables;
+                            std::copy(digest.begin(), digest.end(), h.source_digest);
+                            write_section(out, 0, &h, 1);
+                        }
+
+                        void write_points(const g1_value_type &alpha_g1, const g1_value_type &beta_g1,
+                                          const g1_value_type &delta_g1, const g2_value_type &beta_g2,
+                                          const g2_value_type &delta_g2) {
+                            const g1_value_type g1_points[3] = {alpha_g1, beta_g1, delta_g1};
+                            const g2_value_type g2_points[2] = {beta_g2, delta_g2};
+
+                            write_section(out, h.g1_points_offset, g1_points, 3);
+                            write_section(out, h.g2_points_offset, g2_points, 2);
+                        }
+
+                        /* Writes A_query[first, first + count) */
+                        void write_A_query(const std::size_t first, const g1_value_type *values,
+                                           const std::size_t count) {
+                            BOOST_ASSERT(first + count <= h.A_query_size);
+                            write_section(out, h.A_query_offset + first * sizeof(g1_value_type), values, count);
+                        }
+
+                        /* Writes the stored entries [first, first + count) of B_query */
+                        void write_B_query(const std::size_t first, const std::uint64_t *indices,
+                                           const g2_value_type *g_values, const g1_value_type *h_values,
+                                           const std::size_t count) {
+                            BOOST_ASSERT(first + count <= h.B_query_size);
+                            write_section(out, h.B_query_indices_offset + first * sizeof(std::uint64_t), indices,
+                                          count);
+                            write_section(out, h.B_query_g_offset + first * sizeof(g2_value_type), g_values, count);
+                            write_section(out, h.B_query_h_offset + first * sizeof(g1_value_type), h_values, count);
+                        }
+
+                        /* Writes H_query[first, first + count) */
+                        void write_H_query(const std::size_t first, const g1_value_type *values,
+                                           const std::size_t count) {
+                            BOOST_ASSERT(first + count <= h.H_query_size);
+                            write_section(out, h.H_query_offset + first * sizeof(g1_value_type), values, count);
+                        }
+
+                        /* Writes L_query[first, first + count) */
+                        void write_L_query(const std::size_t first, const g1_value_type *values,
+                                           const std::size_t count) {
+                            BOOST_ASSERT(first + count <= h.L_query_size);
+                            write_section(out, h.L_query_offset + first * sizeof(g1_value_type), values, count);
+                        }
+
+                        /* Makes the sections written so far durable, for a checkpoint to refer to them. */
+                        void sync() {
+                            out.flush();
+                            const int fd = ::open(path.c_str(), O_RDONLY);
+                            const bool synced = fd >= 0 && ::fsync(fd) == 0;
+                            if (fd >= 0) {
+                                ::close(fd);
+                            }
+                            if (!out || !synced) {
+                                throw std::runtime_error("r1cs_gg_ppzksnark_mapped_proving_key: sync failed");
+                            }
+                        }
+
+                        void close() {
+                            out.close();
+                            if (!out) {
+                                throw std::runtime_error("r1cs_gg_ppzksnark_mapped_proving_key: write failed");
+                            }
+                        }
+
+                    private:
+                        std::string path;
+                        std::ofstream out;
+                        header_type h;
+                    };
+
+                    /**
+                     * Writes the query vectors and the group elements of proving_key to path in the
+                     * layout expected by the mapping constructor.
+                     */
+                    static void write(const std::string &path, const proving_key_type &proving_key) {
+                        writer w(path, proving_key.A_query.size(), proving_key.B_query.size(),
+                                 proving_key.B_query.domain_size(), proving_key.H_query.size(),
+                                 proving_key.L_query.size());
+
+                        std::vector<std::uint64_t> B_query_indices(proving_key.B_query.indices.begin(),
+                                                                   proving_key.B_query.indices.end());
+                        std::vector<g2_value_type> B_query_g;
+                        std::vector<g1_value_type> B_query_h;
+                        B_query_g.reserve(proving_key.B_query.size());
+                        B_query_h.reserve(proving_key.B_query.size());
+                        for (const auto &value : proving_key.B_query.values) {
+                            B_query_g.emplace_back(value.g);
+                            B_query_h.emplace_back(value.h);
+                        }
+
+                        w.write_points(proving_key.alpha_g1, proving_key.beta_g1, proving_key.delta_g1,
+                                       proving_key.beta_g2, proving_key.delta_g2);
+                        w.write_A_query(0, proving_key.A_query.data(), proving_key.A_query.size());
+                        w.write_B_query(0, B_query_indices.data(), B_query_g.data(), B_query_h.data(),
+                                        B_query_indices.size());
+                        w.write_H_query(0, proving_key.H_query.data(), proving_key.H_query.size());
+                        w.write_L_query(0, proving_key.L_query.data(), proving_key.L_query.size());
+                        w.close();
+                    }
+
+                    const g1_value_type &alpha_g1() const {
+                        return section<g1_value_type>(header().g1_points_offset)[0];
+                    }
+
+                    const g1_value_type &beta_g1() const {
+                        return section<g1_value_type>(header().g1_points_offset)[1];
+                    }
+
+                    const g1_value_type &delta_g1() const {
+                        return section<g1_value_type>(header().g1_points_offset)[2];
+                    }
+
+                    const g2_value_type &beta_g2() const {
+                        return section<g2_value_type>(header().g2_points_offset)[0];
+                    }
+
+                    const g2_value_type &delta_g2() const {
+                        return section<g2_value_type>(header().g2_points_offset)[1];
+                    }
+
+                    const g1_value_type *A_query_begin() const {
+                        return section<g1_value_type>(header().A_query_offset);
+                    }
+
+                    const g1_value_type *A_query_end() const {
+                        return A_query_begin() + header().A_query_size;
+                    }
+
+                    const std::uint64_t *B_query_indices_begin() const {
+                        return section<std::uint64_t>(header().B_query_indices_offset);
+                    }
+
+                    const std::uint64_t *B_query_indices_end() const {
+                        return B_query_indices_begin() + header().B_query_size;
+                    }
+
+                    const g2_value_type *B_query_g_begin() const {
+                        return section<g2_value_type>(header().B_query_g_offset);
+                    }
+
+                    const g1_value_type *B_query_h_begin() const {
+                        return section<g1_value_type>(header().B_query_h_offset);
+                    }
+
+                    std::size_t B_query_domain_size() const {
+                        return header().B_query_domain_size;
+                    }
+
+                    /* The sizes of the constraint system and the source digest recorded by the writer. */
+                    std::size_t num_constraints() const {
+                        return header().num_constraints;
+                    }
+
+                    std::size_t num_inputs() const {
+                        return header().num_inputs;
+                    }
+
+                    std::size_t num_variables() const {
+                        return header().num_variables;
+                    }
+
+                    source_digest_type source_digest() const {
+                        source_digest_type result;
+                        std::copy(header().source_digest, header().source_digest + source_digest_size,
+                                  result.begin());
+                        return result;
+                    }
+
+                    const g1_value_type *H_query_begin() const {
+                        return section<g1_value_type>(header().H_query_offset);
+                    }
+
+                    const g1_value_type *H_query_end() const {
+                        return H_query_begin() + header().H_query_size;
+                    }
+
+                    const g1_value_type *L_query_begin() const {
+                        return section<g1_value_type>(header().L_query_offset);
+                    }
+
+                    const g1_value_type *L_query_end() const {
+                        return L_query_begin() + header().L_query_size;
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return region.get_size() * 8;
+                    }
+
+                    /**
+                     * Asks for transparent huge pages over the mapping. Returns whether the kernel
+                     * accepted the advice.
+                     */
+                    bool advise_huge_pages() const {
+                        return snark::advise_huge_pages(region.get_address(), region.get_size());
+                    }
+
+                    /**
+                     * Copies the mapped file into private memory of huge pages, which the queries are
+                     * read from from then on. The copy starts on a page boundary, so the sections keep
+                     * their alignment. A file smaller than a huge page stays read from the mapping.
+                     */
+                    void load_into_huge_pages() {
+                        if (region.get_size() < huge_page_2mb) {
+                            return;
+                        }
+                        const char *first = static_cast<const char *>(region.get_address());
+                        copy.assign(first, first + region.get_size());
+                    }
+
+                    /**
+                     * Faults in every page of the mapping, or of its copy, in parallel on the current
+                     * executor, and locks them in memory if lock is set, see memory_residency.hpp.
+                     */
+                    memory_residency prefault(const bool lock = false) const {
+                        return prefault_memory(data(), region.get_size(), lock);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_MAPPED_PROVING_KEY_HPP
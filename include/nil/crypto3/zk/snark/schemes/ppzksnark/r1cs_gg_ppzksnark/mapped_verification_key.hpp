@@ -0,0 +1,285 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a memory-mapped storage of the R1CS GG-ppzkSNARK verification key.
+//
+// The verification key is written with the layout of the mapped proving key: a
+// header followed by 64-byte aligned sections holding the native representation
+// of alpha_g1_beta_g2, gamma_g2, delta_g2 and of the accumulation vector
+// gamma_ABC_g1. Opening the file touches no group element, only checks that every
+// section lies where write puts it within the file and that the stored indices of
+// gamma_ABC_g1 lie in its domain, and the in-memory verification key is rebuilt
+// from the sections by plain copies.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_MAPPED_VERIFICATION_KEY_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_MAPPED_VERIFICATION_KEY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verification_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_mapped_verification_key {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef typename CurveType::gt_type gt_type;
+                    typedef typename g1_type::value_type g1_value_type;
+                    typedef typename g2_type::value_type g2_value_type;
+                    typedef typename gt_type::value_type gt_value_type;
+
+                    static constexpr const std::uint64_t magic = 0x4b56363147474e5aULL;    // "ZNGG16VK"
+                    static constexpr const std::uint64_t version = 1;
+                    static constexpr const std::size_t alignment = 64;
+
+                    struct header_type {
+                        std::uint64_t magic;
+                        std::uint64_t version;
+                        std::uint64_t g1_value_size;
+                        std::uint64_t g2_value_size;
+                        std::uint64_t gt_value_size;
+
+                        std::uint64_t gamma_ABC_g1_rest_size;
+                        std::uint64_t gamma_ABC_g1_domain_size;
+
+                        std::uint64_t gt_points_offset;
+                        std::uint64_t g2_points_offset;
+                        std::uint64_t g1_points_offset;
+                        std::uint64_t gamma_ABC_g1_indices_offset;
+                        std::uint64_t gamma_ABC_g1_values_offset;
+                        std::uint64_t file_size;
+                    };
+
+                    static_assert(std::is_trivially_copyable<header_type>::value, "header must be trivially copyable");
+
+                    static std::uint64_t align(std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    /* the sections of a file whose accumulation vector has the size given in h, laid out by write */
+                    static header_type layout(const header_type &h) {
+                        header_type result = h;
+                        result.gt_points_offset = align(sizeof(header_type));
+                        result.g2_points_offset = align(result.gt_points_offset + sizeof(gt_value_type));
+                        result.g1_points_offset = align(result.g2_points_offset + 2 * sizeof(g2_value_type));
+                        result.gamma_ABC_g1_indices_offset = align(result.g1_points_offset + sizeof(g1_value_type));
+                        result.gamma_ABC_g1_values_offset = align(result.gamma_ABC_g1_indices_offset +
+                                                                  h.gamma_ABC_g1_rest_size * sizeof(std::uint64_t));
+                        result.file_size = align(result.gamma_ABC_g1_values_offset +
+                                                 h.gamma_ABC_g1_rest_size * sizeof(g1_value_type));
+                        return result;
+                    }
+
+                    /*
+                     * Whether the mapping holds a verification key file in the layout of write, the size
+                     * of the accumulation vector being bounded by the file size before it is multiplied.
+                     */
+                    bool well_formed() const {
+                        const std::uint64_t size = region.get_size();
+                        if (size < sizeof(header_type)) {
+                            return false;
+                        }
+                        const header_type &h = header();
+                        if (h.magic != magic || h.version != version || h.g1_value_size != sizeof(g1_value_type) ||
+                            h.g2_value_size != sizeof(g2_value_type) || h.gt_value_size != sizeof(gt_value_type) ||
+                            h.file_size != size || h.gamma_ABC_g1_rest_size > size) {
+                            return false;
+                        }
+                        const header_type expected = layout(h);
+                        if (expected.file_size != size || h.gt_points_offset != expected.gt_points_offset ||
+                            h.g2_points_offset != expected.g2_points_offset ||
+                            h.g1_points_offset != expected.g1_points_offset ||
+                            h.gamma_ABC_g1_indices_offset != expected.gamma_ABC_g1_indices_offset ||
+                            h.gamma_ABC_g1_values_offset != expected.gamma_ABC_g1_values_offset) {
+                            return false;
+                        }
+                        const std::uint64_t *indices = section<std::uint64_t>(h.gamma_ABC_g1_indices_offset);
+                        for (std::size_t i = 0; i < h.gamma_ABC_g1_rest_size; ++i) {
+                            if (indices[i] >= h.gamma_ABC_g1_domain_size || (i > 0 && indices[i] <= indices[i - 1])) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+
+                    template<typename T>
+                    const T *section(std::uint64_t offset) const {
+                        return reinterpret_cast<const T *>(static_cast<const char *>(region.get_address()) + offset);
+                    }
+
+                    const header_type &header() const {
+                        return *section<header_type>(0);
+                    }
+
+                    template<typename T>
+                    static void write_section(std::ofstream &out, std::uint64_t offset, const T *data,
+                                              std::size_t count) {
+                        out.seekp(offset);
+                        out.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+                    }
+
+                    boost::interprocess::file_mapping mapping;
+                    boost::interprocess::mapped_region region;
+
+                public:
+                    typedef CurveType curve_type;
+                    typedef r1cs_gg_ppzksnark_verification_key<CurveType> verification_key_type;
+
+                    r1cs_gg_ppzksnark_mapped_verification_key() = default;
+                    r1cs_gg_ppzksnark_mapped_verification_key(r1cs_gg_ppzksnark_mapped_verification_key &&other) =
+                        default;
+                    r1cs_gg_ppzksnark_mapped_verification_key &
+                        operator=(r1cs_gg_ppzksnark_mapped_verification_key &&other) = default;
+
+                    /**
+                     * Maps the verification key file at path, previously produced by write().
+                     */
+                    explicit r1cs_gg_ppzksnark_mapped_verification_key(const std::string &path) :
+                        mapping(path.c_str(), boost::interprocess::read_only),
+                        region(mapping, boost::interprocess::read_only) {
+                        if (!well_formed()) {
+                            throw std::runtime_error("r1cs_gg_ppzksnark_mapped_verification_key: incompatible file " +
+                                                     path);
+                        }
+                    }
+
+                    /**
+                     * Writes the group elements of verification_key to path in the layout expected by
+                     * the mapping constructor.
+                     */
+                    static void write(const std::string &path, const verification_key_type &verification_key) {
+                        static_assert(std::is_trivially_copyable<g1_value_type>::value &&
+                                          std::is_trivially_copyable<g2_value_type>::value &&
+                                          std::is_trivially_copyable<gt_value_type>::value,
+                                      "group elements must be trivially copyable to be memory-mapped");
+
+                        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                        if (!out) {
+                            throw std::runtime_error("r1cs_gg_ppzksnark_mapped_verification_key: cannot write " +
+                                                     path);
+                        }
+
+                        const sparse_vector<g1_type> &rest = verification_key.gamma_ABC_g1.rest;
+
+                        header_type h;
+                        std::memset(&h, 0, sizeof(h));
+                        h.magic = magic;
+                        h.version = version;
+                        h.g1_value_size = sizeof(g1_value_type);
+                        h.g2_value_size = sizeof(g2_value_type);
+                        h.gt_value_size = sizeof(gt_value_type);
+                        h.gamma_ABC_g1_rest_size = rest.size();
+                        h.gamma_ABC_g1_domain_size = rest.domain_size();
+                        h = layout(h);
+
+                        const std::vector<std::uint64_t> indices(rest.indices.begin(), rest.indices.end());
+                        const g2_value_type g2_points[2] = {verification_key.gamma_g2, verification_key.delta_g2};
+
+                        write_section(out, 0, &h, 1);
+                        write_section(out, h.gt_points_offset, &verification_key.alpha_g1_beta_g2, 1);
+                        write_section(out, h.g2_points_offset, g2_points, 2);
+                        write_section(out, h.g1_points_offset, &verification_key.gamma_ABC_g1.first, 1);
+                        write_section(out, h.gamma_ABC_g1_indices_offset, indices.data(), indices.size());
+                        write_section(out, h.gamma_ABC_g1_values_offset, rest.values.data(), rest.values.size());
+                        // pad the file up to its announced size
+                        out.seekp(h.file_size - 1);
+                        out.put(0);
+
+                        out.close();
+                        if (!out) {
+                            throw std::runtime_error("r1cs_gg_ppzksnark_mapped_verification_key: write failed");
+                        }
+                    }
+
+                    /**
+                     * Rebuilds the in-memory verification key from the mapped sections.
+                     */
+                    verification_key_type verification_key() const {
+                        sparse_vector<g1_type> rest;
+                        rest.indices.assign(gamma_ABC_g1_indices_begin(), gamma_ABC_g1_indices_end());
+                        rest.values.assign(gamma_ABC_g1_values_begin(),
+                                           gamma_ABC_g1_values_begin() + header().gamma_ABC_g1_rest_size);
+                        rest.domain_size_ = header().gamma_ABC_g1_domain_size;
+
+                        g1_value_type first = gamma_ABC_g1_first();
+                        return verification_key_type(
+                            alpha_g1_beta_g2(), gamma_g2(), delta_g2(),
+                            accumulation_vector<g1_type>(std::move(first), std::move(rest)));
+                    }
+
+                    const gt_value_type &alpha_g1_beta_g2() const {
+                        return *section<gt_value_type>(header().gt_points_offset);
+                    }
+
+                    const g2_value_type &gamma_g2() const {
+                        return section<g2_value_type>(header().g2_points_offset)[0];
+                    }
+
+                    const g2_value_type &delta_g2() const {
+                        return section<g2_value_type>(header().g2_points_offset)[1];
+                    }
+
+                    const g1_value_type &gamma_ABC_g1_first() const {
+                        return *section<g1_value_type>(header().g1_points_offset);
+                    }
+
+                    const std::uint64_t *gamma_ABC_g1_indices_begin() const {
+                        return section<std::uint64_t>(header().gamma_ABC_g1_indices_offset);
+                    }
+
+                    const std::uint64_t *gamma_ABC_g1_indices_end() const {
+                        return gamma_ABC_g1_indices_begin() + header().gamma_ABC_g1_rest_size;
+                    }
+
+                    const g1_value_type *gamma_ABC_g1_values_begin() const {
+                        return section<g1_value_type>(header().gamma_ABC_g1_values_offset);
+                    }
+
+                    std::size_t gamma_ABC_g1_domain_size() const {
+                        return header().gamma_ABC_g1_domain_size;
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return region.get_size() * 8;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_MAPPED_VERIFICATION_KEY_HPP
@@ -56,14 +56,23 @@
 #ifndef CRYPTO3_MARSHALLING_R1CS_GG_PPZKSNARK_TYPES_HPP
 #define CRYPTO3_MARSHALLING_R1CS_GG_PPZKSNARK_TYPES_HPP
 
+#include <algorithm>
+#include <array>
+#include <iterator>
 #include <vector>
 #include <tuple>
 
+#include <boost/assert.hpp>
+
 #include <nil/crypto3/multiprecision/number.hpp>
 #include <nil/crypto3/multiprecision/cpp_int.hpp>
 #include <nil/crypto3/multiprecision/modular/modular_adaptor.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/prepared_verifier_input.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/compressed_proof.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/packed_field_vector.hpp>
 #include <nil/crypto3/zk/snark/sparse_vector.hpp>
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
@@ -94,30 +103,76 @@ namespace nil {
 
         /************************ TON Virtual Machine compatible serialization *************************/
 
+        /**
+         * Encoding of a constraint system in a byteblob. The full-width format stores a 4-byte index
+         * and a full field element per linear term. The compact format stores each term as one varint
+         * holding the zigzag-encoded index delta and a coefficient tag, followed by the coefficient
+         * only when it is not +-1. Constraints are grouped in blocks whose byte offsets are listed up
+         * front, so that the blocks are decoded in parallel.
+         */
+        enum class constraint_system_format { full_width, compact };
+
+        struct compact_constraint_system_layout {
+            /// coefficient tags, in the low tag_bits bits of the first varint of a term
+            constexpr static const std::uint64_t tag_one = 0;
+            constexpr static const std::uint64_t tag_minus_one = 1;
+            /// coefficient or its negation below 2^63, a varint of (magnitude << 1 | negated) follows
+            constexpr static const std::uint64_t tag_small = 2;
+            /// full-width coefficient follows
+            constexpr static const std::uint64_t tag_full_width = 3;
+            constexpr static const std::size_t tag_bits = 2;
+            constexpr static const std::uint64_t tag_mask = (1u << tag_bits) - 1;
+            /// default number of constraints per block
+            constexpr static const std::size_t block_size = 1024;
+            /// smallest encoding of a constraint, three empty linear combinations
+            constexpr static const std::size_t min_constraint_byteblob_size = 3;
+        };
+
         template<typename ProofSystem>
         struct verifier_input_deserializer_tvm;
 
-        template<>
-        struct verifier_input_deserializer_tvm<
-            nil::crypto3::zk::snark::r1cs_gg_ppzksnark<algebra::curves::bls12<381>>> {
+        /**
+         * Decoding of the GG keys, proofs and inputs of any curve with a curve_element_serializer.
+         * The element sizes are compile-time constants of the curve, so the per-element loops have
+         * constant bounds.
+         */
+        template<typename CurveType, typename Generator, typename Prover, typename Verifier>
+        struct verifier_input_deserializer_tvm<nil::crypto3::zk::snark::r1cs_gg_ppzksnark<
+            CurveType, Generator, Prover, Verifier, nil::crypto3::zk::snark::ProvingMode::Basic>> {
 
-            using CurveType = typename algebra::curves::bls12<381>;
-            using scheme_type = nil::crypto3::zk::snark::r1cs_gg_ppzksnark<CurveType>;
+            using scheme_type = nil::crypto3::zk::snark::r1cs_gg_ppzksnark<
+                CurveType, Generator, Prover, Verifier, nil::crypto3::zk::snark::ProvingMode::Basic>;
 
             using chunk_type = std::uint8_t;
             constexpr static const std::size_t chunk_size = 8;
 
-            static const std::size_t std_size_t_byteblob_size = 4;
-            static const std::size_t g1_byteblob_size = curve_element_serializer<CurveType>::sizeof_field_element;
-            static const std::size_t g2_byteblob_size = 2 * curve_element_serializer<CurveType>::sizeof_field_element;
-            static const std::size_t fp_byteblob_size = CurveType::base_field_type::modulus_bits / chunk_size +
-                                                        (CurveType::base_field_type::modulus_bits % chunk_size ? 1 : 0);
-            static const std::size_t gt_byteblob_size = 2 * 3 * 2 * fp_byteblob_size;
-            static const std::size_t fr_byteblob_size =
+            constexpr static const std::size_t std_size_t_byteblob_size = 4;
+            /// compressed points are one base field element per coefficient of their field of definition
+            constexpr static const std::size_t g1_byteblob_size =
+                curve_element_serializer<CurveType>::sizeof_field_element;
+            constexpr static const std::size_t g2_byteblob_size =
+                CurveType::g2_type::field_type::arity * curve_element_serializer<CurveType>::sizeof_field_element;
+            constexpr static const std::size_t fp_byteblob_size =
+                CurveType::base_field_type::modulus_bits / chunk_size +
+                (CurveType::base_field_type::modulus_bits % chunk_size ? 1 : 0);
+            constexpr static const std::size_t gt_byteblob_size = CurveType::gt_type::arity * fp_byteblob_size;
+            constexpr static const std::size_t fr_byteblob_size =
                 CurveType::scalar_field_type::modulus_bits / chunk_size +
                 (CurveType::scalar_field_type::modulus_bits % chunk_size ? 1 : 0);
-            static const std::size_t linear_term_byteblob_size = std_size_t_byteblob_size + fr_byteblob_size;
-            static const std::size_t g2g1_element_kc_byteblob_size = g2_byteblob_size + g1_byteblob_size;
+            constexpr static const std::size_t linear_term_byteblob_size = std_size_t_byteblob_size + fr_byteblob_size;
+            constexpr static const std::size_t g2g1_element_kc_byteblob_size = g2_byteblob_size + g1_byteblob_size;
+            constexpr static const std::size_t proof_byteblob_size = 2 * g1_byteblob_size + g2_byteblob_size;
+            /// form byte, Gt element and the two G2 points of the key, accumulated input and proof
+            constexpr static const std::size_t prepared_verifier_input_byteblob_size =
+                1 + gt_byteblob_size + 2 * g2_byteblob_size + g1_byteblob_size + proof_byteblob_size;
+
+            typedef std::array<chunk_type, proof_byteblob_size> proof_byteblob_type;
+
+            /**
+             * Whether the decompressed points are checked to lie in the prime order subgroup.
+             * Points from a trusted source, such as keys generated locally, may skip the check.
+             */
+            enum class point_validation { subgroup_check, trusted };
 
             template<typename FieldType>
             static inline typename std::enable_if<!::nil::crypto3::algebra::is_extended_field<FieldType>::value,
@@ -167,11 +222,72 @@ namespace nil {
                 return std::get<1>(processed);
             }
 
+            template<typename GroupValueType>
+            static inline bool is_in_prime_order_subgroup(const GroupValueType &point) {
+                return (point * typename CurveType::scalar_field_type::modulus_type(
+                                    CurveType::scalar_field_type::modulus))
+                    .is_zero();
+            }
+
+            /**
+             * Whether [read_iter_begin, read_iter_end) holds overhead bytes followed by count elements of
+             * element_size bytes. The length is divided rather than the count multiplied, so a count read
+             * from the input cannot overflow the comparison.
+             */
+            static inline bool holds(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                     typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                     std::size_t count,
+                                     std::size_t element_size,
+                                     std::size_t overhead = 0) {
+                if (std::distance(read_iter_begin, read_iter_end) < 0) {
+                    return false;
+                }
+                const std::size_t available = std::distance(read_iter_begin, read_iter_end);
+                return available >= overhead && count <= (available - overhead) / element_size;
+            }
+
+            /**
+             * Computes f(i, status) for i in [0, count) across the current executor, each block
+             * stopping at its first failure. The status is the first failure, if any.
+             */
+            template<typename ValueType, typename Function>
+            static inline std::vector<ValueType> batch_process(std::size_t count, status_type &processingStatus,
+                                                               Function f) {
+                std::vector<ValueType> result(count);
+
+                const std::size_t num_blocks =
+                    std::max<std::size_t>(1, std::min(count, crypto3::zk::snark::executor::current().concurrency()));
+                const std::size_t block_size = (count + num_blocks - 1) / num_blocks;
+                std::vector<status_type> statuses(num_blocks, status_type::success);
+                crypto3::zk::snark::executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                    const std::size_t end = std::min(count, (block + 1) * block_size);
+                    for (std::size_t i = block * block_size; i < end && statuses[block] == status_type::success;
+                         ++i) {
+                        result[i] = f(i, statuses[block]);
+                    }
+                });
+
+                processingStatus = status_type::success;
+                for (const status_type &status : statuses) {
+                    if (status != status_type::success) {
+                        processingStatus = status;
+                        break;
+                    }
+                }
+                return result;
+            }
+
             template<typename GroupType>
             static inline typename GroupType::value_type
                 g1_group_type_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                       typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                      status_type &processingStatus) {
+                                      status_type &processingStatus,
+                                      point_validation validation = point_validation::subgroup_check) {
+
+                if (std::distance(read_iter_begin, read_iter_end) < g1_byteblob_size) {
+                    processingStatus = status_type::not_enough_data;
+                    return typename GroupType::value_type();
+                }
 
                 processingStatus = status_type::success;
 
@@ -181,14 +297,51 @@ namespace nil {
                     input_array[i] = read_iter_begin[i];
                 }
 
-                return curve_element_serializer<CurveType>::octets_to_g1_point(input_array);
+                typename GroupType::value_type point =
+                    curve_element_serializer<CurveType>::octets_to_g1_point(input_array);
+                if (validation == point_validation::subgroup_check && !is_in_prime_order_subgroup(point)) {
+                    processingStatus = status_type::invalid_msg_data;
+                }
+                return point;
+            }
+
+            /**
+             * Decompresses the count consecutive G1 points starting at read_iter_begin,
+             * splitting them across the current executor.
+             */
+            template<typename GroupType>
+            static inline std::vector<typename GroupType::value_type>
+                g1_group_type_vector_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                             typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                             std::size_t count,
+                                             status_type &processingStatus,
+                                             point_validation validation = point_validation::subgroup_check) {
+
+                if (!holds(read_iter_begin, read_iter_end, count, g1_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return std::vector<typename GroupType::value_type>();
+                }
+
+                return batch_process<typename GroupType::value_type>(
+                    count, processingStatus, [&](std::size_t i, status_type &status) {
+                        return g1_group_type_process<GroupType>(read_iter_begin + i * g1_byteblob_size,
+                                                                read_iter_begin + (i + 1) * g1_byteblob_size,
+                                                                status,
+                                                                validation);
+                    });
             }
 
             template<typename GroupType>
             static inline typename GroupType::value_type
                 g2_group_type_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                       typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                      status_type &processingStatus) {
+                                      status_type &processingStatus,
+                                      point_validation validation = point_validation::subgroup_check) {
+
+                if (std::distance(read_iter_begin, read_iter_end) < g2_byteblob_size) {
+                    processingStatus = status_type::not_enough_data;
+                    return typename GroupType::value_type();
+                }
 
                 processingStatus = status_type::success;
 
@@ -198,7 +351,38 @@ namespace nil {
                     input_array[i] = read_iter_begin[i];
                 }
 
-                return curve_element_serializer<CurveType>::octets_to_g2_point(input_array);
+                typename GroupType::value_type point =
+                    curve_element_serializer<CurveType>::octets_to_g2_point(input_array);
+                if (validation == point_validation::subgroup_check && !is_in_prime_order_subgroup(point)) {
+                    processingStatus = status_type::invalid_msg_data;
+                }
+                return point;
+            }
+
+            /**
+             * Decompresses the count consecutive G2 points starting at read_iter_begin,
+             * splitting them across the current executor.
+             */
+            template<typename GroupType>
+            static inline std::vector<typename GroupType::value_type>
+                g2_group_type_vector_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                             typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                             std::size_t count,
+                                             status_type &processingStatus,
+                                             point_validation validation = point_validation::subgroup_check) {
+
+                if (!holds(read_iter_begin, read_iter_end, count, g2_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return std::vector<typename GroupType::value_type>();
+                }
+
+                return batch_process<typename GroupType::value_type>(
+                    count, processingStatus, [&](std::size_t i, status_type &status) {
+                        return g2_group_type_process<GroupType>(read_iter_begin + i * g2_byteblob_size,
+                                                                read_iter_begin + (i + 1) * g2_byteblob_size,
+                                                                status,
+                                                                validation);
+                    });
             }
 
             static inline linear_term<typename CurveType::scalar_field_type>
@@ -239,6 +423,12 @@ namespace nil {
                     return linear_combination<typename CurveType::scalar_field_type>();
                 }
 
+                if (!holds(read_iter_begin, read_iter_end, terms_count, linear_term_byteblob_size,
+                           std_size_t_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return linear_combination<typename CurveType::scalar_field_type>();
+                }
+
                 std::vector<linear_term<typename CurveType::scalar_field_type>> terms(terms_count);
 
                 for (std::size_t i = 0; i < terms_count; i++) {
@@ -260,13 +450,18 @@ namespace nil {
                                         typename std::vector<chunk_type>::const_iterator read_iter_end,
                                         status_type &processingStatus) {
 
-                std::size_t a_terms_count =
-                    std_size_t_process(read_iter_begin, read_iter_begin + std_size_t_byteblob_size, processingStatus);
+                std::size_t a_terms_count = std_size_t_process(read_iter_begin, read_iter_end, processingStatus);
 
                 if (processingStatus != status_type::success) {
                     return r1cs_constraint<typename CurveType::scalar_field_type>();
                 }
 
+                if (!holds(read_iter_begin, read_iter_end, a_terms_count, linear_term_byteblob_size,
+                           std_size_t_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return r1cs_constraint<typename CurveType::scalar_field_type>();
+                }
+
                 std::size_t a_byte_size = a_terms_count * linear_term_byteblob_size + std_size_t_byteblob_size;
                 linear_combination<typename CurveType::scalar_field_type> a =
                     linear_combination_process(read_iter_begin, read_iter_begin + a_byte_size, processingStatus);
@@ -274,14 +469,19 @@ namespace nil {
                     return r1cs_constraint<typename CurveType::scalar_field_type>();
                 }
 
-                std::size_t b_terms_count = std_size_t_process(read_iter_begin + a_byte_size,
-                                                               read_iter_begin + a_byte_size + std_size_t_byteblob_size,
-                                                               processingStatus);
+                std::size_t b_terms_count =
+                    std_size_t_process(read_iter_begin + a_byte_size, read_iter_end, processingStatus);
 
                 if (processingStatus != status_type::success) {
                     return r1cs_constraint<typename CurveType::scalar_field_type>();
                 }
 
+                if (!holds(read_iter_begin + a_byte_size, read_iter_end, b_terms_count, linear_term_byteblob_size,
+                           std_size_t_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return r1cs_constraint<typename CurveType::scalar_field_type>();
+                }
+
                 std::size_t b_byte_size = b_terms_count * linear_term_byteblob_size + std_size_t_byteblob_size;
                 linear_combination<typename CurveType::scalar_field_type> b = linear_combination_process(
                     read_iter_begin + a_byte_size, read_iter_begin + a_byte_size + b_byte_size, processingStatus);
@@ -290,14 +490,18 @@ namespace nil {
                 }
 
                 std::size_t c_terms_count =
-                    std_size_t_process(read_iter_begin + a_byte_size + b_byte_size,
-                                       read_iter_begin + a_byte_size + b_byte_size + std_size_t_byteblob_size,
-                                       processingStatus);
+                    std_size_t_process(read_iter_begin + a_byte_size + b_byte_size, read_iter_end, processingStatus);
 
                 if (processingStatus != status_type::success) {
                     return r1cs_constraint<typename CurveType::scalar_field_type>();
                 }
 
+                if (!holds(read_iter_begin + a_byte_size + b_byte_size, read_iter_end, c_terms_count,
+                           linear_term_byteblob_size, std_size_t_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return r1cs_constraint<typename CurveType::scalar_field_type>();
+                }
+
                 std::size_t c_byte_size = c_terms_count * linear_term_byteblob_size + std_size_t_byteblob_size;
                 linear_combination<typename CurveType::scalar_field_type> c =
                     linear_combination_process(read_iter_begin + a_byte_size + b_byte_size,
@@ -313,7 +517,12 @@ namespace nil {
             static inline r1cs_constraint_system<typename CurveType::scalar_field_type>
                 r1cs_constraint_system_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                                typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                               status_type &processingStatus) {
+                                               status_type &processingStatus,
+                                               constraint_system_format format = constraint_system_format::full_width) {
+
+                if (format == constraint_system_format::compact) {
+                    return compact_r1cs_constraint_system_process(read_iter_begin, read_iter_end, processingStatus);
+                }
 
                 std::size_t primary_input_size =
                     std_size_t_process(read_iter_begin, read_iter_begin + std_size_t_byteblob_size, processingStatus);
@@ -338,21 +547,40 @@ namespace nil {
                     return r1cs_constraint_system<typename CurveType::scalar_field_type>();
                 }
 
-                std::vector<r1cs_constraint<typename CurveType::scalar_field_type>> constraints(rc_count);
-
                 auto read_iter_current_begin = read_iter_begin + 3 * std_size_t_byteblob_size;
 
+                if (!holds(read_iter_current_begin, read_iter_end, rc_count, std_size_t_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                }
+
+                std::vector<r1cs_constraint<typename CurveType::scalar_field_type>> constraints(rc_count);
+
                 for (std::size_t i = 0; i < rc_count; i++) {
 
                     std::size_t total_r1cs_constraint_byteblob_size = std_size_t_process(
-                        read_iter_current_begin, read_iter_current_begin + std_size_t_byteblob_size, processingStatus);
+                        read_iter_current_begin, read_iter_end, processingStatus);
+
+                    if (processingStatus != status_type::success) {
+                        return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                    }
 
                     read_iter_current_begin += std_size_t_byteblob_size;
 
+                    if (!holds(read_iter_current_begin, read_iter_end, total_r1cs_constraint_byteblob_size, 1)) {
+                        processingStatus = status_type::not_enough_data;
+                        return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                    }
+
                     constraints[i] =
                         r1cs_constraint_process(read_iter_current_begin,
                                                 read_iter_current_begin + total_r1cs_constraint_byteblob_size,
                                                 processingStatus);
+
+                    if (processingStatus != status_type::success) {
+                        return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                    }
+
                     read_iter_current_begin += total_r1cs_constraint_byteblob_size;
                 }
 
@@ -366,19 +594,229 @@ namespace nil {
                 return res;
             }
 
+            /**
+             * Reads the LEB128 varint at read_iter and moves read_iter past it.
+             */
+            static inline std::uint64_t varint_process(typename std::vector<chunk_type>::const_iterator &read_iter,
+                                                       typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                                       status_type &processingStatus) {
+
+                processingStatus = status_type::success;
+
+                std::uint64_t value = 0;
+                for (std::size_t shift = 0; shift < 64; shift += 7) {
+                    if (read_iter == read_iter_end) {
+                        processingStatus = status_type::not_enough_data;
+                        return 0;
+                    }
+                    const chunk_type chunk = *read_iter++;
+                    value |= std::uint64_t(chunk & 0x7f) << shift;
+                    if (!(chunk & 0x80)) {
+                        return value;
+                    }
+                }
+
+                processingStatus = status_type::invalid_msg_data;
+                return 0;
+            }
+
+            static inline linear_combination<typename CurveType::scalar_field_type>
+                compact_linear_combination_process(typename std::vector<chunk_type>::const_iterator &read_iter,
+                                                   typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                                   status_type &processingStatus) {
+                typedef typename CurveType::scalar_field_type field_type;
+                typedef compact_constraint_system_layout layout;
+
+                const std::uint64_t terms_count = varint_process(read_iter, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return linear_combination<field_type>();
+                }
+                // every term takes at least one byte
+                if (terms_count > std::uint64_t(std::distance(read_iter, read_iter_end))) {
+                    processingStatus = status_type::not_enough_data;
+                    return linear_combination<field_type>();
+                }
+
+                std::vector<linear_term<field_type>> terms;
+                terms.reserve(terms_count);
+
+                std::uint64_t index = 0;
+                for (std::uint64_t i = 0; i < terms_count; ++i) {
+                    const std::uint64_t head = varint_process(read_iter, read_iter_end, processingStatus);
+                    if (processingStatus != status_type::success) {
+                        return linear_combination<field_type>();
+                    }
+                    const std::uint64_t zigzag_delta = head >> layout::tag_bits;
+                    index += (zigzag_delta >> 1) ^ (0 - (zigzag_delta & 1));
+
+                    typename field_type::value_type coeff;
+                    const std::uint64_t tag = head & layout::tag_mask;
+                    if (tag == layout::tag_one) {
+                        coeff = field_type::value_type::one();
+                    } else if (tag == layout::tag_minus_one) {
+                        coeff = -field_type::value_type::one();
+                    } else if (tag == layout::tag_small) {
+                        const std::uint64_t small = varint_process(read_iter, read_iter_end, processingStatus);
+                        if (processingStatus != status_type::success) {
+                            return linear_combination<field_type>();
+                        }
+                        coeff = typename field_type::value_type(typename field_type::modulus_type(small >> 1));
+                        if (small & 1) {
+                            coeff = -coeff;
+                        }
+                    } else {
+                        if (std::distance(read_iter, read_iter_end) < fr_byteblob_size) {
+                            processingStatus = status_type::not_enough_data;
+                            return linear_combination<field_type>();
+                        }
+                        coeff = field_type_process<field_type>(read_iter, read_iter + fr_byteblob_size,
+                                                               processingStatus);
+                        if (processingStatus != status_type::success) {
+                            return linear_combination<field_type>();
+                        }
+                        read_iter += fr_byteblob_size;
+                    }
+
+                    terms.emplace_back(variable<field_type>(index), coeff);
+                }
+
+                return linear_combination<field_type>(terms);
+            }
+
+            static inline r1cs_constraint<typename CurveType::scalar_field_type>
+                compact_r1cs_constraint_process(typename std::vector<chunk_type>::const_iterator &read_iter,
+                                                typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                                status_type &processingStatus) {
+
+                linear_combination<typename CurveType::scalar_field_type> a =
+                    compact_linear_combination_process(read_iter, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return r1cs_constraint<typename CurveType::scalar_field_type>();
+                }
+
+                linear_combination<typename CurveType::scalar_field_type> b =
+                    compact_linear_combination_process(read_iter, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return r1cs_constraint<typename CurveType::scalar_field_type>();
+                }
+
+                linear_combination<typename CurveType::scalar_field_type> c =
+                    compact_linear_combination_process(read_iter, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return r1cs_constraint<typename CurveType::scalar_field_type>();
+                }
+
+                return r1cs_constraint<typename CurveType::scalar_field_type>(a, b, c);
+            }
+
+            /**
+             * Decodes a constraint system in the compact format, the blocks of constraints being
+             * split across the current executor.
+             */
+            static inline r1cs_constraint_system<typename CurveType::scalar_field_type>
+                compact_r1cs_constraint_system_process(
+                    typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                    typename std::vector<chunk_type>::const_iterator read_iter_end,
+                    status_type &processingStatus) {
+                typedef r1cs_constraint<typename CurveType::scalar_field_type> constraint_type;
+                typedef compact_constraint_system_layout layout;
+
+                if (std::distance(read_iter_begin, read_iter_end) < 5 * std_size_t_byteblob_size) {
+                    processingStatus = status_type::not_enough_data;
+                    return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                }
+
+                std::size_t header[4];
+                for (std::size_t i = 0; i < 4; ++i) {
+                    header[i] = std_size_t_process(read_iter_begin + i * std_size_t_byteblob_size,
+                                                   read_iter_begin + (i + 1) * std_size_t_byteblob_size,
+                                                   processingStatus);
+                }
+                const std::size_t rc_count = header[2];
+                const std::size_t block_size = header[3];
+
+                if (rc_count && !block_size) {
+                    processingStatus = status_type::invalid_msg_data;
+                    return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                }
+
+                const std::size_t num_blocks = rc_count ? (rc_count - 1) / block_size + 1 : 0;
+                const auto block_index_begin = read_iter_begin + 4 * std_size_t_byteblob_size;
+                if (!holds(block_index_begin, read_iter_end, num_blocks, std_size_t_byteblob_size,
+                           std_size_t_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                }
+
+                const auto payload_begin = block_index_begin + (num_blocks + 1) * std_size_t_byteblob_size;
+                const std::size_t payload_size = std::distance(payload_begin, read_iter_end);
+                std::vector<std::size_t> offsets(num_blocks + 1);
+                for (std::size_t block = 0; block <= num_blocks; ++block) {
+                    offsets[block] =
+                        std_size_t_process(block_index_begin + block * std_size_t_byteblob_size,
+                                           block_index_begin + (block + 1) * std_size_t_byteblob_size,
+                                           processingStatus);
+                    if ((block && offsets[block] < offsets[block - 1]) || offsets[block] > payload_size) {
+                        processingStatus = status_type::invalid_msg_data;
+                        return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                    }
+                }
+
+                std::vector<std::vector<constraint_type>> blocks = batch_process<std::vector<constraint_type>>(
+                    num_blocks, processingStatus, [&](std::size_t block, status_type &status) {
+                        auto read_iter = payload_begin + offsets[block];
+                        const auto block_end = payload_begin + offsets[block + 1];
+                        const std::size_t count = std::min(block_size, rc_count - block * block_size);
+
+                        std::vector<constraint_type> constraints;
+                        if (count > (offsets[block + 1] - offsets[block]) / layout::min_constraint_byteblob_size) {
+                            status = status_type::not_enough_data;
+                            return constraints;
+                        }
+                        constraints.reserve(count);
+                        for (std::size_t i = 0; i < count && status == status_type::success; ++i) {
+                            constraints.emplace_back(compact_r1cs_constraint_process(read_iter, block_end, status));
+                        }
+                        if (status == status_type::success && read_iter != block_end) {
+                            status = status_type::invalid_msg_data;
+                        }
+                        return constraints;
+                    });
+
+                if (processingStatus != status_type::success) {
+                    return r1cs_constraint_system<typename CurveType::scalar_field_type>();
+                }
+
+                r1cs_constraint_system<typename CurveType::scalar_field_type> res;
+                res.primary_input_size = header[0];
+                res.auxiliary_input_size = header[1];
+                res.constraints.reserve(rc_count);
+                for (std::vector<constraint_type> &block : blocks) {
+                    std::move(block.begin(), block.end(), std::back_inserter(res.constraints));
+                }
+
+                return res;
+            }
+
             static inline crypto3::zk::snark::detail::element_kc<typename CurveType::g2_type,
                                                                  typename CurveType::g1_type>
                 g2g1_element_kc_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                         typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                        status_type &processingStatus) {
+                                        status_type &processingStatus,
+                                        point_validation validation = point_validation::subgroup_check) {
 
                 typename CurveType::g2_type::value_type g = g2_group_type_process<typename CurveType::g2_type>(
-                    read_iter_begin, read_iter_begin + g2_byteblob_size, processingStatus);
+                    read_iter_begin, read_iter_begin + g2_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return crypto3::zk::snark::detail::element_kc<typename CurveType::g2_type,
+                                                                  typename CurveType::g1_type>();
+                }
 
                 typename CurveType::g1_type::value_type h = g1_group_type_process<typename CurveType::g1_type>(
                     read_iter_begin + g2_byteblob_size,
                     read_iter_begin + g2_byteblob_size + g1_byteblob_size,
-                    processingStatus);
+                    processingStatus,
+                    validation);
                 return crypto3::zk::snark::detail::element_kc<typename CurveType::g2_type, typename CurveType::g1_type>(
                     g, h);
             }
@@ -387,7 +825,8 @@ namespace nil {
                 g2g1_knowledge_commitment_vector_process(
                     typename std::vector<chunk_type>::const_iterator read_iter_begin,
                     typename std::vector<chunk_type>::const_iterator read_iter_end,
-                    status_type &processingStatus) {
+                    status_type &processingStatus,
+                    point_validation validation = point_validation::subgroup_check) {
 
                 using T = knowledge_commitment<typename CurveType::g2_type, typename CurveType::g1_type>;
 
@@ -405,6 +844,14 @@ namespace nil {
                     return sparse_vector<T>();
                 }
 
+                if (!holds(read_iter_begin, read_iter_end, indices_count,
+                           std_size_t_byteblob_size + g2g1_element_kc_byteblob_size, 2 * std_size_t_byteblob_size)) {
+
+                    processingStatus = status_type::not_enough_data;
+
+                    return sparse_vector<T>();
+                }
+
                 std::vector<std::size_t> indices(indices_count, 0);
 
                 for (std::size_t i = 0; i < indices_count; i++) {
@@ -417,18 +864,17 @@ namespace nil {
                     }
                 }
 
-                std::vector<typename T::value_type> values(indices_count);
-
-                for (std::size_t i = 0; i < indices_count; i++) {
-                    values[i] = g2g1_element_kc_process(
-                        read_iter_begin + std_size_t_byteblob_size + indices_count * std_size_t_byteblob_size +
-                            i * g2g1_element_kc_byteblob_size,
-                        read_iter_begin + std_size_t_byteblob_size + indices_count * std_size_t_byteblob_size +
-                            (i + 1) * g2g1_element_kc_byteblob_size,
-                        processingStatus);
-                    if (processingStatus != status_type::success) {
-                        return sparse_vector<T>();
-                    }
+                const auto values_begin =
+                    read_iter_begin + std_size_t_byteblob_size + indices_count * std_size_t_byteblob_size;
+                std::vector<typename T::value_type> values = batch_process<typename T::value_type>(
+                    indices_count, processingStatus, [&](std::size_t i, status_type &status) {
+                        return g2g1_element_kc_process(values_begin + i * g2g1_element_kc_byteblob_size,
+                                                       values_begin + (i + 1) * g2g1_element_kc_byteblob_size,
+                                                       status,
+                                                       validation);
+                    });
+                if (processingStatus != status_type::success) {
+                    return sparse_vector<T>();
                 }
 
                 std::size_t domain_size_ = std_size_t_process(
@@ -485,7 +931,8 @@ namespace nil {
             static inline sparse_vector<T>
                 g1_sparse_vector_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                          typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                         status_type &processingStatus) {
+                                         status_type &processingStatus,
+                                         point_validation validation = point_validation::subgroup_check) {
 
                 if (std::distance(read_iter_begin, read_iter_end) < std_size_t_byteblob_size) {
 
@@ -501,9 +948,8 @@ namespace nil {
                     return sparse_vector<T>();
                 }
 
-                if (std::distance(read_iter_begin, read_iter_end) <
-                    std_size_t_byteblob_size + indices_count * std_size_t_byteblob_size +
-                        indices_count * g1_byteblob_size + std_size_t_byteblob_size) {
+                if (!holds(read_iter_begin, read_iter_end, indices_count, std_size_t_byteblob_size + g1_byteblob_size,
+                           2 * std_size_t_byteblob_size)) {
 
                     processingStatus = status_type::not_enough_data;
 
@@ -522,18 +968,14 @@ namespace nil {
                     }
                 }
 
-                std::vector<typename T::value_type> values(indices_count);
-
-                for (std::size_t i = 0; i < indices_count; i++) {
-                    values[i] = g1_group_type_process<T>(
-                        read_iter_begin + std_size_t_byteblob_size + indices_count * std_size_t_byteblob_size +
-                            i * g1_byteblob_size,
-                        read_iter_begin + std_size_t_byteblob_size + indices_count * std_size_t_byteblob_size +
-                            (i + 1) * g1_byteblob_size,
-                        processingStatus);
-                    if (processingStatus != status_type::success) {
-                        return sparse_vector<T>();
-                    }
+                std::vector<typename T::value_type> values = g1_group_type_vector_process<T>(
+                    read_iter_begin + std_size_t_byteblob_size + indices_count * std_size_t_byteblob_size,
+                    read_iter_end,
+                    indices_count,
+                    processingStatus,
+                    validation);
+                if (processingStatus != status_type::success) {
+                    return sparse_vector<T>();
                 }
 
                 std::size_t domain_size_ = std_size_t_process(
@@ -562,7 +1004,8 @@ namespace nil {
             static inline accumulation_vector<T>
                 g1_accumulation_vector_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                                typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                               status_type &processingStatus) {
+                                               status_type &processingStatus,
+                                               point_validation validation = point_validation::subgroup_check) {
 
                 if (std::distance(read_iter_begin, read_iter_end) < g1_byteblob_size) {
 
@@ -572,14 +1015,16 @@ namespace nil {
                 }
 
                 typename T::value_type first =
-                    g1_group_type_process<T>(read_iter_begin, read_iter_begin + g1_byteblob_size, processingStatus);
+                    g1_group_type_process<T>(read_iter_begin, read_iter_begin + g1_byteblob_size, processingStatus,
+                                             validation);
 
                 if (processingStatus != status_type::success) {
                     return accumulation_vector<T>();
                 }
 
                 sparse_vector<T> rest =
-                    g1_sparse_vector_process<T>(read_iter_begin + g1_byteblob_size, read_iter_end, processingStatus);
+                    g1_sparse_vector_process<T>(read_iter_begin + g1_byteblob_size, read_iter_end, processingStatus,
+                                                validation);
 
                 if (processingStatus != status_type::success) {
                     return accumulation_vector<T>();
@@ -591,7 +1036,8 @@ namespace nil {
             static inline typename scheme_type::verification_key_type
                 verification_key_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                          typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                         status_type &processingStatus) {
+                                         status_type &processingStatus,
+                                         point_validation validation = point_validation::subgroup_check) {
 
                 if (std::distance(read_iter_begin, read_iter_end) <
                     gt_byteblob_size + g2_byteblob_size + g2_byteblob_size) {
@@ -612,7 +1058,8 @@ namespace nil {
                 typename CurveType::g2_type::value_type gamma_g2 = g2_group_type_process<typename CurveType::g2_type>(
                     read_iter_begin + gt_byteblob_size,
                     read_iter_begin + gt_byteblob_size + g2_byteblob_size,
-                    processingStatus);
+                    processingStatus,
+                    validation);
                 if (processingStatus != status_type::success) {
                     return typename scheme_type::verification_key_type();
                 }
@@ -620,7 +1067,8 @@ namespace nil {
                 typename CurveType::g2_type::value_type delta_g2 = g2_group_type_process<typename CurveType::g2_type>(
                     read_iter_begin + gt_byteblob_size + g2_byteblob_size,
                     read_iter_begin + gt_byteblob_size + g2_byteblob_size + g2_byteblob_size,
-                    processingStatus);
+                    processingStatus,
+                    validation);
                 if (processingStatus != status_type::success) {
                     return typename scheme_type::verification_key_type();
                 }
@@ -629,7 +1077,8 @@ namespace nil {
                     g1_accumulation_vector_process<typename CurveType::g1_type>(read_iter_begin + gt_byteblob_size +
                                                                                     g2_byteblob_size + g2_byteblob_size,
                                                                                 read_iter_end,
-                                                                                processingStatus);
+                                                                                processingStatus,
+                                                                                validation);
 
                 if (processingStatus != status_type::success) {
                     return typename scheme_type::verification_key_type();
@@ -641,76 +1090,116 @@ namespace nil {
             static inline typename scheme_type::proving_key_type
                 proving_key_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                     typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                    status_type &processingStatus) {
+                                    status_type &processingStatus,
+                                    point_validation validation = point_validation::subgroup_check,
+                                    constraint_system_format format = constraint_system_format::full_width) {
+
+                typedef typename scheme_type::proving_key_type proving_key_type;
+
+                if (std::distance(read_iter_begin, read_iter_end) <
+                    3 * g1_byteblob_size + 2 * g2_byteblob_size + std_size_t_byteblob_size) {
+                    processingStatus = status_type::not_enough_data;
+                    return proving_key_type();
+                }
 
                 auto read_iter_current_begin = read_iter_begin;
 
                 typename CurveType::g1_type::value_type alpha_g1 = g1_group_type_process<typename CurveType::g1_type>(
-                    read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus);
+                    read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += g1_byteblob_size;
                 typename CurveType::g1_type::value_type beta_g1 = g1_group_type_process<typename CurveType::g1_type>(
-                    read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus);
+                    read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += g1_byteblob_size;
                 typename CurveType::g2_type::value_type beta_g2 = g2_group_type_process<typename CurveType::g2_type>(
-                    read_iter_current_begin, read_iter_current_begin + g2_byteblob_size, processingStatus);
+                    read_iter_current_begin, read_iter_current_begin + g2_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += g2_byteblob_size;
                 typename CurveType::g1_type::value_type delta_g1 = g1_group_type_process<typename CurveType::g1_type>(
-                    read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus);
+                    read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += g1_byteblob_size;
                 typename CurveType::g2_type::value_type delta_g2 = g2_group_type_process<typename CurveType::g2_type>(
-                    read_iter_current_begin, read_iter_current_begin + g2_byteblob_size, processingStatus);
+                    read_iter_current_begin, read_iter_current_begin + g2_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += g2_byteblob_size;
-                std::size_t A_query_size = std_size_t_process(
-                    read_iter_current_begin, read_iter_current_begin + std_size_t_byteblob_size, processingStatus);
 
+                std::size_t A_query_size = std_size_t_process(read_iter_current_begin, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += std_size_t_byteblob_size;
-                std::vector<typename CurveType::g1_type::value_type> A_query(A_query_size);
-
-                for (std::size_t i = 0; i < A_query_size; ++i) {
-                    A_query[i] = g1_group_type_process<typename CurveType::g1_type>(
-                        read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus);
-                    read_iter_current_begin += g1_byteblob_size;
+                std::vector<typename CurveType::g1_type::value_type> A_query =
+                    g1_group_type_vector_process<typename CurveType::g1_type>(
+                        read_iter_current_begin, read_iter_end, A_query_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
                 }
+                read_iter_current_begin += A_query_size * g1_byteblob_size;
 
-                std::size_t total_B_query_size = std_size_t_process(
-                    read_iter_current_begin, read_iter_current_begin + std_size_t_byteblob_size, processingStatus);
-
+                std::size_t total_B_query_size =
+                    std_size_t_process(read_iter_current_begin, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += std_size_t_byteblob_size;
-
+                if (!holds(read_iter_current_begin, read_iter_end, total_B_query_size, 1)) {
+                    processingStatus = status_type::not_enough_data;
+                    return proving_key_type();
+                }
                 knowledge_commitment_vector<typename CurveType::g2_type, typename CurveType::g1_type> B_query =
                     g2g1_knowledge_commitment_vector_process(
-                        read_iter_current_begin, read_iter_current_begin + total_B_query_size, processingStatus);
-
+                        read_iter_current_begin, read_iter_current_begin + total_B_query_size, processingStatus,
+                        validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += total_B_query_size;
 
-                std::size_t H_query_size = std_size_t_process(
-                    read_iter_current_begin, read_iter_current_begin + std_size_t_byteblob_size, processingStatus);
-
+                std::size_t H_query_size = std_size_t_process(read_iter_current_begin, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += std_size_t_byteblob_size;
-                std::vector<typename CurveType::g1_type::value_type> H_query(H_query_size);
-
-                for (std::size_t i = 0; i < H_query_size; ++i) {
-                    H_query[i] = g1_group_type_process<typename CurveType::g1_type>(
-                        read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus);
-                    read_iter_current_begin += g1_byteblob_size;
+                std::vector<typename CurveType::g1_type::value_type> H_query =
+                    g1_group_type_vector_process<typename CurveType::g1_type>(
+                        read_iter_current_begin, read_iter_end, H_query_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
                 }
+                read_iter_current_begin += H_query_size * g1_byteblob_size;
 
-                std::size_t L_query_size = std_size_t_process(
-                    read_iter_current_begin, read_iter_current_begin + std_size_t_byteblob_size, processingStatus);
-
+                std::size_t L_query_size = std_size_t_process(read_iter_current_begin, read_iter_end, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
                 read_iter_current_begin += std_size_t_byteblob_size;
-                std::vector<typename CurveType::g1_type::value_type> L_query(L_query_size);
-
-                for (std::size_t i = 0; i < L_query_size; ++i) {
-                    L_query[i] = g1_group_type_process<typename CurveType::g1_type>(
-                        read_iter_current_begin, read_iter_current_begin + g1_byteblob_size, processingStatus);
-                    read_iter_current_begin += g1_byteblob_size;
+                std::vector<typename CurveType::g1_type::value_type> L_query =
+                    g1_group_type_vector_process<typename CurveType::g1_type>(
+                        read_iter_current_begin, read_iter_end, L_query_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
                 }
+                read_iter_current_begin += L_query_size * g1_byteblob_size;
 
                 r1cs_constraint_system<typename CurveType::scalar_field_type> constraint_system =
-                    r1cs_constraint_system_process(read_iter_current_begin, read_iter_end, processingStatus);
+                    r1cs_constraint_system_process(read_iter_current_begin, read_iter_end, processingStatus, format);
+                if (processingStatus != status_type::success) {
+                    return proving_key_type();
+                }
 
-                return typename scheme_type::proving_key_type(
+                return proving_key_type(
                     std::move(alpha_g1), std::move(beta_g1), std::move(beta_g2), std::move(delta_g1),
                     std::move(delta_g2), std::move(A_query), std::move(B_query), std::move(H_query), std::move(L_query),
                     std::move(constraint_system));
@@ -735,8 +1224,7 @@ namespace nil {
                     return typename scheme_type::primary_input_type();
                 }
 
-                if (std::distance(read_iter_begin, read_iter_end) <
-                    std_size_t_byteblob_size + pi_count * fr_byteblob_size) {
+                if (!holds(read_iter_begin, read_iter_end, pi_count, fr_byteblob_size, std_size_t_byteblob_size)) {
 
                     processingStatus = status_type::not_enough_data;
 
@@ -762,7 +1250,8 @@ namespace nil {
             static inline typename scheme_type::proof_type
                 proof_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                               typename std::vector<chunk_type>::const_iterator read_iter_end,
-                              status_type &processingStatus) {
+                              status_type &processingStatus,
+                              point_validation validation = point_validation::subgroup_check) {
 
                 if (std::distance(read_iter_begin, read_iter_end) <
                     g1_byteblob_size + g2_byteblob_size + g1_byteblob_size) {
@@ -773,7 +1262,7 @@ namespace nil {
                 }
 
                 typename CurveType::g1_type::value_type g_A = g1_group_type_process<typename CurveType::g1_type>(
-                    read_iter_begin, read_iter_begin + g1_byteblob_size, processingStatus);
+                    read_iter_begin, read_iter_begin + g1_byteblob_size, processingStatus, validation);
 
                 if (processingStatus != status_type::success) {
                     return typename scheme_type::proof_type();
@@ -782,7 +1271,8 @@ namespace nil {
                 typename CurveType::g2_type::value_type g_B = g2_group_type_process<typename CurveType::g2_type>(
                     read_iter_begin + g1_byteblob_size,
                     read_iter_begin + g1_byteblob_size + g2_byteblob_size,
-                    processingStatus);
+                    processingStatus,
+                    validation);
 
                 if (processingStatus != status_type::success) {
                     return typename scheme_type::proof_type();
@@ -791,7 +1281,8 @@ namespace nil {
                 typename CurveType::g1_type::value_type g_C = g1_group_type_process<typename CurveType::g1_type>(
                     read_iter_begin + g1_byteblob_size + g2_byteblob_size,
                     read_iter_begin + g1_byteblob_size + g2_byteblob_size + g1_byteblob_size,
-                    processingStatus);
+                    processingStatus,
+                    validation);
 
                 if (processingStatus != status_type::success) {
                     return typename scheme_type::proof_type();
@@ -800,13 +1291,322 @@ namespace nil {
                 return typename scheme_type::proof_type(std::move(g_A), std::move(g_B), std::move(g_C));
             }
 
+            /**
+             * Reads count consecutive proofs, in the layout of proof_process, into a proof batch. Each
+             * of A, B and C is decompressed in its own pass split across the current executor.
+             */
+            static inline typename scheme_type::proof_batch_type
+                proof_batch_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                    typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                    std::size_t count,
+                                    status_type &processingStatus,
+                                    point_validation validation = point_validation::subgroup_check) {
+
+                if (!holds(read_iter_begin, read_iter_end, count, proof_byteblob_size)) {
+                    processingStatus = status_type::not_enough_data;
+                    return typename scheme_type::proof_batch_type();
+                }
+
+                std::vector<typename CurveType::g1_type::value_type> g_A =
+                    batch_process<typename CurveType::g1_type::value_type>(
+                        count, processingStatus, [&](std::size_t i, status_type &status) {
+                            return g1_group_type_process<typename CurveType::g1_type>(
+                                read_iter_begin + i * proof_byteblob_size,
+                                read_iter_begin + i * proof_byteblob_size + g1_byteblob_size,
+                                status,
+                                validation);
+                        });
+                if (processingStatus != status_type::success) {
+                    return typename scheme_type::proof_batch_type();
+                }
+
+                std::vector<typename CurveType::g2_type::value_type> g_B =
+                    batch_process<typename CurveType::g2_type::value_type>(
+                        count, processingStatus, [&](std::size_t i, status_type &status) {
+                            return g2_group_type_process<typename CurveType::g2_type>(
+                                read_iter_begin + i * proof_byteblob_size + g1_byteblob_size,
+                                read_iter_begin + i * proof_byteblob_size + g1_byteblob_size + g2_byteblob_size,
+                                status,
+                                validation);
+                        });
+                if (processingStatus != status_type::success) {
+                    return typename scheme_type::proof_batch_type();
+                }
+
+                std::vector<typename CurveType::g1_type::value_type> g_C =
+                    batch_process<typename CurveType::g1_type::value_type>(
+                        count, processingStatus, [&](std::size_t i, status_type &status) {
+                            return g1_group_type_process<typename CurveType::g1_type>(
+                                read_iter_begin + i * proof_byteblob_size + g1_byteblob_size + g2_byteblob_size,
+                                read_iter_begin + (i + 1) * proof_byteblob_size,
+                                status,
+                                validation);
+                        });
+                if (processingStatus != status_type::success) {
+                    return typename scheme_type::proof_batch_type();
+                }
+
+                return typename scheme_type::proof_batch_type(std::move(g_A), std::move(g_B), std::move(g_C));
+            }
+
+            static inline r1cs_gg_ppzksnark_partial_evaluation<CurveType>
+                partial_evaluation_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                           typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                           status_type &processingStatus,
+                                           point_validation validation = point_validation::subgroup_check) {
+
+                r1cs_gg_ppzksnark_partial_evaluation<CurveType> result;
+
+                if (std::distance(read_iter_begin, read_iter_end) <
+                    std_size_t_byteblob_size + 4 * g1_byteblob_size + g2_byteblob_size) {
+
+                    processingStatus = status_type::not_enough_data;
+
+                    return result;
+                }
+
+                result.shard_index =
+                    std_size_t_process(read_iter_begin, read_iter_begin + std_size_t_byteblob_size, processingStatus);
+
+                if (processingStatus != status_type::success) {
+                    return r1cs_gg_ppzksnark_partial_evaluation<CurveType>();
+                }
+                read_iter_begin += std_size_t_byteblob_size;
+
+                for (typename CurveType::g1_type::value_type *evaluation :
+                     {&result.evaluation_At, &result.evaluation_Ht, &result.evaluation_Lt}) {
+                    *evaluation = g1_group_type_process<typename CurveType::g1_type>(
+                        read_iter_begin, read_iter_begin + g1_byteblob_size, processingStatus, validation);
+
+                    if (processingStatus != status_type::success) {
+                        return r1cs_gg_ppzksnark_partial_evaluation<CurveType>();
+                    }
+                    read_iter_begin += g1_byteblob_size;
+                }
+
+                result.evaluation_Bt = g2g1_element_kc_process(
+                    read_iter_begin, read_iter_begin + g2g1_element_kc_byteblob_size, processingStatus, validation);
+
+                if (processingStatus != status_type::success) {
+                    return r1cs_gg_ppzksnark_partial_evaluation<CurveType>();
+                }
+
+                return result;
+            }
+
+            /**
+             * Decodes the shard job of a distributed prover: the seven indices of its shard, then the
+             * assignment, H and L scalars, each as a count followed by its elements.
+             */
+            static inline r1cs_gg_ppzksnark_shard_job<CurveType>
+                shard_job_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                  typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                  status_type &processingStatus) {
+
+                typedef r1cs_gg_ppzksnark_shard_job<CurveType> job_type;
+
+                job_type result;
+
+                std::size_t *const ranges[] = {&result.shard.index,         &result.shard.variables_first,
+                                               &result.shard.variables_last, &result.shard.H_first,
+                                               &result.shard.H_last,         &result.shard.L_first,
+                                               &result.shard.L_last};
+                for (std::size_t *range : ranges) {
+                    *range = std_size_t_process(read_iter_begin, read_iter_end, processingStatus);
+
+                    if (processingStatus != status_type::success) {
+                        return job_type();
+                    }
+                    read_iter_begin += std_size_t_byteblob_size;
+                }
+
+                for (std::vector<typename CurveType::scalar_field_type::value_type> *scalars :
+                     {&result.assignment, &result.H, &result.L}) {
+                    const std::size_t count = std_size_t_process(read_iter_begin, read_iter_end, processingStatus);
+
+                    if (processingStatus != status_type::success) {
+                        return job_type();
+                    }
+                    read_iter_begin += std_size_t_byteblob_size;
+
+                    if (std::size_t(std::distance(read_iter_begin, read_iter_end)) / fr_byteblob_size < count) {
+
+                        processingStatus = status_type::not_enough_data;
+
+                        return job_type();
+                    }
+
+                    scalars->resize(count);
+                    for (std::size_t i = 0; i < count; i++) {
+                        (*scalars)[i] = field_type_process<typename CurveType::scalar_field_type>(
+                            read_iter_begin, read_iter_begin + fr_byteblob_size, processingStatus);
+
+                        if (processingStatus != status_type::success) {
+                            return job_type();
+                        }
+                        read_iter_begin += fr_byteblob_size;
+                    }
+                }
+
+                return result;
+            }
+
+            /**
+             * Decodes the prepared verifier input written by the serializer, see
+             * r1cs_gg_ppzksnark_prepared_verifier_input.
+             */
+            static inline r1cs_gg_ppzksnark_prepared_verifier_input<CurveType>
+                prepared_verifier_input_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                                typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                                status_type &processingStatus,
+                                                point_validation validation = point_validation::subgroup_check) {
+                typedef r1cs_gg_ppzksnark_prepared_verifier_input<CurveType> prepared_type;
+
+                if (std::distance(read_iter_begin, read_iter_end) < prepared_verifier_input_byteblob_size) {
+                    processingStatus = status_type::not_enough_data;
+                    return prepared_type();
+                }
+
+                if (*read_iter_begin > 1) {
+                    processingStatus = status_type::invalid_msg_data;
+                    return prepared_type();
+                }
+
+                auto read_iter = read_iter_begin + 1;
+
+                typename CurveType::gt_type::value_type alpha_g1_beta_g2 =
+                    field_type_process<typename CurveType::gt_type>(read_iter, read_iter + gt_byteblob_size,
+                                                                    processingStatus);
+                if (processingStatus != status_type::success) {
+                    return prepared_type();
+                }
+                read_iter += gt_byteblob_size;
+
+                typename CurveType::g2_type::value_type gamma_g2 = g2_group_type_process<typename CurveType::g2_type>(
+                    read_iter, read_iter + g2_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return prepared_type();
+                }
+                read_iter += g2_byteblob_size;
+
+                typename CurveType::g2_type::value_type delta_g2 = g2_group_type_process<typename CurveType::g2_type>(
+                    read_iter, read_iter + g2_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return prepared_type();
+                }
+                read_iter += g2_byteblob_size;
+
+                typename CurveType::g1_type::value_type accumulated_input =
+                    g1_group_type_process<typename CurveType::g1_type>(read_iter, read_iter + g1_byteblob_size,
+                                                                       processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return prepared_type();
+                }
+                read_iter += g1_byteblob_size;
+
+                typename scheme_type::proof_type proof =
+                    proof_process(read_iter, read_iter + proof_byteblob_size, processingStatus, validation);
+                if (processingStatus != status_type::success) {
+                    return prepared_type();
+                }
+
+                return prepared_type(*read_iter_begin == 1, alpha_g1_beta_g2, gamma_g2, delta_g2, accumulated_input,
+                                     proof);
+            }
+
+            /**
+             * Decodes the aggregate proof with compressed Gt elements written by the serializer. The
+             * G1 and G2 elements are checked as the validation asks; the compressed Gt elements are
+             * only checked to be well encoded, their membership in Gt being checked when the proof is
+             * decompressed.
+             */
+            static inline r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType>
+                aggregate_compressed_proof_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
+                                                   typename std::vector<chunk_type>::const_iterator read_iter_end,
+                                                   status_type &processingStatus,
+                                                   point_validation validation = point_validation::subgroup_check) {
+                typedef r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> compressed_proof_type;
+                typedef typename compressed_proof_type::compression_type compression_type;
+
+                if (std::distance(read_iter_begin, read_iter_end) < std_size_t_byteblob_size) {
+                    processingStatus = status_type::not_enough_data;
+                    return compressed_proof_type();
+                }
+
+                const std::size_t nproofs =
+                    std_size_t_process(read_iter_begin, read_iter_begin + std_size_t_byteblob_size, processingStatus);
+                if (processingStatus != status_type::success) {
+                    return compressed_proof_type();
+                }
+                if (nproofs < 2 || nproofs > r1cs_gg_pp_zksnark_aggregate_srs<CurveType>::MAX_SRS_SIZE ||
+                    (nproofs & (nproofs - 1)) != 0) {
+                    processingStatus = status_type::invalid_msg_data;
+                    return compressed_proof_type();
+                }
+
+                compressed_proof_type proof;
+                gipa_proof<CurveType> &gipa = proof.body.tmipp.gipa;
+                const std::size_t rounds = gipa_proof<CurveType>::log_proofs(nproofs);
+                gipa.nproofs = nproofs;
+                gipa.comms_ab.resize(rounds);
+                gipa.comms_c.resize(rounds);
+                gipa.z_ab.resize(rounds);
+                gipa.z_c.resize(rounds);
+                nil::crypto3::zk::snark::detail::for_each_gt_element(
+                    proof.body, [](typename CurveType::gt_type::value_type &x) {
+                        x = CurveType::gt_type::value_type::one();
+                    });
+                proof.gt_elements.resize(compressed_proof_type::num_gt_elements(proof.body));
+
+                const std::size_t gt_element_size = compression_type::element_size();
+                if (std::distance(read_iter_begin, read_iter_end) <
+                    std_size_t_byteblob_size + (7 + 2 * rounds) * g1_byteblob_size + 5 * g2_byteblob_size +
+                        proof.gt_elements.size() * gt_element_size) {
+                    processingStatus = status_type::not_enough_data;
+                    return compressed_proof_type();
+                }
+
+                auto read_iter = read_iter_begin + std_size_t_byteblob_size;
+                nil::crypto3::zk::snark::detail::for_each_group_element(
+                    proof.body,
+                    [&](typename CurveType::g1_type::value_type &point) {
+                        if (processingStatus == status_type::success) {
+                            point = g1_group_type_process<typename CurveType::g1_type>(
+                                read_iter, read_iter + g1_byteblob_size, processingStatus, validation);
+                            read_iter += g1_byteblob_size;
+                        }
+                    },
+                    [&](typename CurveType::g2_type::value_type &point) {
+                        if (processingStatus == status_type::success) {
+                            point = g2_group_type_process<typename CurveType::g2_type>(
+                                read_iter, read_iter + g2_byteblob_size, processingStatus, validation);
+                            read_iter += g2_byteblob_size;
+                        }
+                    });
+                if (processingStatus != status_type::success) {
+                    return compressed_proof_type();
+                }
+
+                for (typename compression_type::compressed_type &element : proof.gt_elements) {
+                    std::pair<bool, typename compression_type::compressed_type> read =
+                        compression_type::from_bytes(read_iter, read_iter + gt_element_size);
+                    if (!read.first) {
+                        processingStatus = status_type::invalid_msg_data;
+                        return compressed_proof_type();
+                    }
+                    element = read.second;
+                    read_iter += gt_element_size;
+                }
+
+                return proof;
+            }
+
             static inline std::tuple<typename scheme_type::verification_key_type,
                                      typename scheme_type::primary_input_type, typename scheme_type::proof_type>
                 verifier_input_process(typename std::vector<chunk_type>::const_iterator read_iter_begin,
                                        typename std::vector<chunk_type>::const_iterator read_iter_end,
-                                       status_type &processingStatus) {
-
-                const std::size_t proof_byteblob_size = g1_byteblob_size + g2_byteblob_size + g1_byteblob_size;
+                                       status_type &processingStatus,
+                                       point_validation validation = point_validation::subgroup_check) {
 
                 if (std::distance(read_iter_begin, read_iter_end) < proof_byteblob_size) {
 
@@ -818,7 +1618,7 @@ namespace nil {
                 }
 
                 typename scheme_type::proof_type de_prf =
-                    proof_process(read_iter_begin, read_iter_begin + proof_byteblob_size, processingStatus);
+                    proof_process(read_iter_begin, read_iter_begin + proof_byteblob_size, processingStatus, validation);
 
                 if (processingStatus != status_type::success) {
                     return std::make_tuple(typename scheme_type::verification_key_type(),
@@ -853,7 +1653,8 @@ namespace nil {
                 typename scheme_type::verification_key_type de_vk =
                     verification_key_process(read_iter_begin + proof_byteblob_size + primary_input_byteblob_size,
                                              read_iter_end,
-                                             processingStatus);
+                                             processingStatus,
+                                             validation);
 
                 if (processingStatus != status_type::success) {
                     return std::make_tuple(typename scheme_type::verification_key_type(),
@@ -868,26 +1669,41 @@ namespace nil {
         template<typename ProofSystem>
         struct verifier_input_serializer_tvm;
 
-        template<>
-        struct verifier_input_serializer_tvm<nil::crypto3::zk::snark::r1cs_gg_ppzksnark<algebra::curves::bls12<381>>> {
+        /**
+         * Encoding of the GG keys, proofs and inputs of any curve with a curve_element_serializer,
+         * into buffers whose sizes are compile-time constants of the curve.
+         */
+        template<typename CurveType, typename Generator, typename Prover, typename Verifier>
+        struct verifier_input_serializer_tvm<nil::crypto3::zk::snark::r1cs_gg_ppzksnark<
+            CurveType, Generator, Prover, Verifier, nil::crypto3::zk::snark::ProvingMode::Basic>> {
 
-            using CurveType = typename algebra::curves::bls12<381>;
-            using scheme_type = nil::crypto3::zk::snark::r1cs_gg_ppzksnark<CurveType>;
+            using scheme_type = nil::crypto3::zk::snark::r1cs_gg_ppzksnark<
+                CurveType, Generator, Prover, Verifier, nil::crypto3::zk::snark::ProvingMode::Basic>;
 
             using chunk_type = std::uint8_t;
             constexpr static const std::size_t chunk_size = 8;
 
-            static const std::size_t std_size_t_byteblob_size = 4;
-            static const std::size_t g1_byteblob_size = curve_element_serializer<CurveType>::sizeof_field_element;
-            static const std::size_t g2_byteblob_size = 2 * curve_element_serializer<CurveType>::sizeof_field_element;
-            static const std::size_t fp_byteblob_size = CurveType::base_field_type::modulus_bits / chunk_size +
-                                                        (CurveType::base_field_type::modulus_bits % chunk_size ? 1 : 0);
-            static const std::size_t gt_byteblob_size = 2 * 3 * 2 * fp_byteblob_size;
-            static const std::size_t fr_byteblob_size =
+            constexpr static const std::size_t std_size_t_byteblob_size = 4;
+            /// compressed points are one base field element per coefficient of their field of definition
+            constexpr static const std::size_t g1_byteblob_size =
+                curve_element_serializer<CurveType>::sizeof_field_element;
+            constexpr static const std::size_t g2_byteblob_size =
+                CurveType::g2_type::field_type::arity * curve_element_serializer<CurveType>::sizeof_field_element;
+            constexpr static const std::size_t fp_byteblob_size =
+                CurveType::base_field_type::modulus_bits / chunk_size +
+                (CurveType::base_field_type::modulus_bits % chunk_size ? 1 : 0);
+            constexpr static const std::size_t gt_byteblob_size = CurveType::gt_type::arity * fp_byteblob_size;
+            constexpr static const std::size_t fr_byteblob_size =
                 CurveType::scalar_field_type::modulus_bits / chunk_size +
                 (CurveType::scalar_field_type::modulus_bits % chunk_size ? 1 : 0);
-            static const std::size_t linear_term_byteblob_size = std_size_t_byteblob_size + fr_byteblob_size;
-            static const std::size_t g2g1_element_kc_byteblob_size = g2_byteblob_size + g1_byteblob_size;
+            constexpr static const std::size_t linear_term_byteblob_size = std_size_t_byteblob_size + fr_byteblob_size;
+            constexpr static const std::size_t g2g1_element_kc_byteblob_size = g2_byteblob_size + g1_byteblob_size;
+            constexpr static const std::size_t proof_byteblob_size = 2 * g1_byteblob_size + g2_byteblob_size;
+            /// form byte, Gt element and the two G2 points of the key, accumulated input and proof
+            constexpr static const std::size_t prepared_verifier_input_byteblob_size =
+                1 + gt_byteblob_size + 2 * g2_byteblob_size + g1_byteblob_size + proof_byteblob_size;
+
+            typedef std::array<chunk_type, proof_byteblob_size> proof_byteblob_type;
 
             template<typename FieldType>
             static inline
@@ -948,7 +1764,6 @@ namespace nil {
 
             static inline void std_size_t_process(std::size_t input_s, std::vector<chunk_type>::iterator &write_iter) {
 
-                std::size_t std_size_t_byteblob_size = 4;
                 std::vector<std::size_t> vector_s = {input_s};
 
                 auto internal_write_iter = write_iter;
@@ -1046,6 +1861,114 @@ namespace nil {
                 }
             }
 
+            /**
+             * Appends input_v to output as a LEB128 varint.
+             */
+            static inline void varint_process(std::uint64_t input_v, std::vector<chunk_type> &output) {
+                while (input_v >= 0x80) {
+                    output.push_back(chunk_type(input_v | 0x80));
+                    input_v >>= 7;
+                }
+                output.push_back(chunk_type(input_v));
+            }
+
+            template<typename T>
+            static inline bool is_compact_small(const typename T::value_type &input_fp) {
+                typedef nil::crypto3::multiprecision::number<nil::crypto3::multiprecision::backends::cpp_int_backend<>>
+                    modulus_type;
+
+                return input_fp.is_zero() || nil::crypto3::multiprecision::msb(modulus_type(input_fp.data)) < 63;
+            }
+
+            template<typename T>
+            static inline void compact_linear_combination_process(const linear_combination<T> &input_cm,
+                                                                  std::vector<chunk_type> &output) {
+                typedef nil::crypto3::multiprecision::number<nil::crypto3::multiprecision::backends::cpp_int_backend<>>
+                    modulus_type;
+                typedef compact_constraint_system_layout layout;
+
+                varint_process(input_cm.terms.size(), output);
+
+                std::uint64_t previous_index = 0;
+                for (const linear_term<T> &term : input_cm.terms) {
+                    // zigzag keeps the negative deltas of unsorted combinations short
+                    const std::uint64_t delta = std::uint64_t(term.index) - previous_index;
+                    const std::uint64_t head = ((delta << 1) ^ (0 - (delta >> 63))) << layout::tag_bits;
+                    previous_index = term.index;
+
+                    const typename T::value_type negated = -term.coeff;
+                    if (term.coeff == T::value_type::one()) {
+                        varint_process(head | layout::tag_one, output);
+                    } else if (negated == T::value_type::one()) {
+                        varint_process(head | layout::tag_minus_one, output);
+                    } else if (is_compact_small<T>(term.coeff) || is_compact_small<T>(negated)) {
+                        const bool is_negated = !is_compact_small<T>(term.coeff);
+                        const std::uint64_t magnitude =
+                            static_cast<std::uint64_t>(modulus_type((is_negated ? negated : term.coeff).data));
+                        varint_process(head | layout::tag_small, output);
+                        varint_process(magnitude << 1 | std::uint64_t(is_negated), output);
+                    } else {
+                        varint_process(head | layout::tag_full_width, output);
+                        const std::size_t offset = output.size();
+                        output.resize(offset + fr_byteblob_size);
+                        typename std::vector<chunk_type>::iterator write_iter = output.begin() + offset;
+                        field_type_process<T>(term.coeff, write_iter);
+                    }
+                }
+            }
+
+            /**
+             * Appends input_rs to output in the compact format. The blocks of block_size constraints
+             * are encoded across the current executor.
+             */
+            template<typename T>
+            static inline void
+                compact_r1cs_constraint_system_process(const r1cs_constraint_system<T> &input_rs,
+                                                       std::vector<chunk_type> &output,
+                                                       std::size_t block_size =
+                                                           compact_constraint_system_layout::block_size) {
+                assert(block_size > 0);
+
+                const std::size_t rc_count = input_rs.constraints.size();
+                const std::size_t num_blocks = rc_count ? (rc_count - 1) / block_size + 1 : 0;
+
+                std::vector<std::vector<chunk_type>> blocks(num_blocks);
+                crypto3::zk::snark::executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                    const std::size_t end = std::min(rc_count, (block + 1) * block_size);
+                    for (std::size_t i = block * block_size; i < end; ++i) {
+                        compact_linear_combination_process<T>(input_rs.constraints[i].a, blocks[block]);
+                        compact_linear_combination_process<T>(input_rs.constraints[i].b, blocks[block]);
+                        compact_linear_combination_process<T>(input_rs.constraints[i].c, blocks[block]);
+                    }
+                });
+
+                std::size_t payload_size = 0;
+                for (const std::vector<chunk_type> &block : blocks) {
+                    payload_size += block.size();
+                }
+                const std::size_t header_size = (5 + num_blocks) * std_size_t_byteblob_size;
+                const std::size_t offset = output.size();
+                output.reserve(offset + header_size + payload_size);
+                output.resize(offset + header_size);
+
+                typename std::vector<chunk_type>::iterator write_iter = output.begin() + offset;
+                std_size_t_process(input_rs.primary_input_size, write_iter);
+                std_size_t_process(input_rs.auxiliary_input_size, write_iter);
+                std_size_t_process(rc_count, write_iter);
+                std_size_t_process(block_size, write_iter);
+
+                std::size_t block_offset = 0;
+                std_size_t_process(block_offset, write_iter);
+                for (const std::vector<chunk_type> &block : blocks) {
+                    block_offset += block.size();
+                    std_size_t_process(block_offset, write_iter);
+                }
+
+                for (const std::vector<chunk_type> &block : blocks) {
+                    output.insert(output.end(), block.begin(), block.end());
+                }
+            }
+
             static inline void g2g1_element_kc_process(
                 crypto3::zk::snark::detail::element_kc<typename CurveType::g2_type, typename CurveType::g1_type>
                     input_ek,
@@ -1084,25 +2007,19 @@ namespace nil {
                 std_size_t_process(input_kv.domain_size(), write_iter);
             }
 
-            static inline std::vector<chunk_type> process(typename scheme_type::proving_key_type pk) {
-
-                std::size_t proving_key_size = 3*g1_byteblob_size + 
-                    2*g2_byteblob_size + pk.A_query.size()*g1_byteblob_size +
-                    get_g2g1_knowledge_commitment_vector_size(pk.B_query) + 
-                    pk.H_query.size()*g1_byteblob_size + 
-                    pk.L_query.size()*g1_byteblob_size +
-                    2 * std_size_t_byteblob_size;
-
-                for (auto it = pk.constraint_system.constraints.begin(); 
-                        it != pk.constraint_system.constraints.end(); it++) {
-                    proving_key_size += get_r1cs_constraint_byteblob_size(*it);
-                }
-
-                proving_key_size *= 2;
+            /**
+             * Size of the proving key byteblob up to its constraint system.
+             */
+            static inline std::size_t
+                get_proving_key_points_byteblob_size(const typename scheme_type::proving_key_type &pk) {
 
-                std::vector<chunk_type> output(proving_key_size);
+                return 3 * g1_byteblob_size + 2 * g2_byteblob_size + 4 * std_size_t_byteblob_size +
+                       (pk.A_query.size() + pk.H_query.size() + pk.L_query.size()) * g1_byteblob_size +
+                       get_g2g1_knowledge_commitment_vector_size(pk.B_query);
+            }
 
-                typename std::vector<chunk_type>::iterator write_iter = output.begin();
+            static inline void proving_key_points_process(const typename scheme_type::proving_key_type &pk,
+                                                          std::vector<chunk_type>::iterator &write_iter) {
 
                 g1_group_type_process<typename CurveType::g1_type>(pk.alpha_g1, write_iter);
                 g1_group_type_process<typename CurveType::g1_type>(pk.beta_g1, write_iter);
@@ -1129,26 +2046,73 @@ namespace nil {
                 for (auto it = pk.L_query.begin(); it != pk.L_query.end(); it++) {
                     g1_group_type_process<typename CurveType::g1_type>(*it, write_iter);
                 }
+            }
+
+            static inline std::vector<chunk_type>
+                process(typename scheme_type::proving_key_type pk,
+                        constraint_system_format format = constraint_system_format::full_width) {
+
+                if (format == constraint_system_format::compact) {
+                    std::vector<chunk_type> output(get_proving_key_points_byteblob_size(pk));
+                    typename std::vector<chunk_type>::iterator write_iter = output.begin();
+                    proving_key_points_process(pk, write_iter);
+                    compact_r1cs_constraint_system_process(pk.constraint_system, output);
+                    return output;
+                }
+
+                std::size_t proving_key_size = 3*g1_byteblob_size + 
+                    2*g2_byteblob_size + pk.A_query.size()*g1_byteblob_size +
+                    get_g2g1_knowledge_commitment_vector_size(pk.B_query) + 
+                    pk.H_query.size()*g1_byteblob_size + 
+                    pk.L_query.size()*g1_byteblob_size +
+                    2 * std_size_t_byteblob_size;
+
+                for (auto it = pk.constraint_system.constraints.begin(); 
+                        it != pk.constraint_system.constraints.end(); it++) {
+                    proving_key_size += get_r1cs_constraint_byteblob_size(*it);
+                }
+
+                proving_key_size *= 2;
+
+                std::vector<chunk_type> output(proving_key_size);
+
+                typename std::vector<chunk_type>::iterator write_iter = output.begin();
+
+                proving_key_points_process(pk, write_iter);
 
                 r1cs_constraint_system_process<typename CurveType::scalar_field_type>(pk.constraint_system, write_iter);
 
                 return output;
             }
 
-            static inline std::vector<chunk_type> process(typename scheme_type::verification_key_type vk) {
+            static inline std::vector<chunk_type>
+                process(const r1cs_constraint_system<typename CurveType::scalar_field_type> &cs,
+                        constraint_system_format format = constraint_system_format::full_width) {
 
-                constexpr const std::size_t modulus_bits = CurveType::base_field_type::modulus_bits;
+                std::vector<chunk_type> output;
 
-                constexpr const std::size_t modulus_chunks =
-                    modulus_bits / chunk_size + (modulus_bits % chunk_size ? 1 : 0);
+                if (format == constraint_system_format::compact) {
+                    compact_r1cs_constraint_system_process(cs, output);
+                    return output;
+                }
 
-                std::size_t ic_size = 1 + vk.gamma_ABC_g1.rest.values.size();
+                std::size_t constraint_system_size = 3 * std_size_t_byteblob_size;
+                for (auto it = cs.constraints.begin(); it != cs.constraints.end(); it++) {
+                    constraint_system_size += std_size_t_byteblob_size + get_r1cs_constraint_byteblob_size(*it);
+                }
+
+                output.resize(constraint_system_size);
+
+                typename std::vector<chunk_type>::iterator write_iter = output.begin();
 
-                std::size_t g1_byteblob_size = curve_element_serializer<CurveType>::sizeof_field_element;
-                std::size_t g2_byteblob_size = 2 * curve_element_serializer<CurveType>::sizeof_field_element;
-                std::size_t std_size_t_byteblob_size = 4;
+                r1cs_constraint_system_process<typename CurveType::scalar_field_type>(cs, write_iter);
 
-                std::size_t gt_byteblob_size = modulus_chunks * CurveType::gt_type::arity;
+                return output;
+            }
+
+            static inline std::vector<chunk_type> process(typename scheme_type::verification_key_type vk) {
+
+                std::size_t ic_size = 1 + vk.gamma_ABC_g1.rest.values.size();
 
                 std::size_t ic_byteblob_size = std_size_t_byteblob_size + ic_size * g1_byteblob_size;
                 std::size_t sparse_vector_byteblob_size =
@@ -1182,16 +2146,9 @@ namespace nil {
 
             static inline std::vector<chunk_type> process(typename scheme_type::primary_input_type pi) {
 
-                constexpr const std::size_t modulus_bits = CurveType::scalar_field_type::modulus_bits;
-
-                constexpr const std::size_t modulus_chunks =
-                    modulus_bits / chunk_size + (modulus_bits % chunk_size ? 1 : 0);
-
-                std::size_t std_size_t_byteblob_size = 4;
-
                 std::size_t pi_count = pi.size();
 
-                std::size_t primary_byteblob_input_size = std_size_t_byteblob_size + pi_count * modulus_chunks;
+                std::size_t primary_byteblob_input_size = std_size_t_byteblob_size + pi_count * fr_byteblob_size;
 
                 std::vector<chunk_type> output(primary_byteblob_input_size);
 
@@ -1206,20 +2163,179 @@ namespace nil {
                 return output;
             }
 
+            /**
+             * Same byteblob as for the unpacked primary input. The little-endian chunks of every
+             * element are read off its limbs directly instead of going through a big integer.
+             */
+            static inline std::vector<chunk_type>
+                process(const crypto3::zk::snark::packed_field_vector<typename CurveType::scalar_field_type> &pi) {
+                typedef crypto3::zk::snark::packed_field_vector<typename CurveType::scalar_field_type>
+                    packed_vector_type;
+
+                const std::size_t pi_count = pi.size();
+
+                std::vector<chunk_type> output(std_size_t_byteblob_size + pi_count * fr_byteblob_size);
+
+                typename std::vector<chunk_type>::iterator write_iter = output.begin();
+
+                std_size_t_process(pi_count, write_iter);
+
+                crypto3::zk::snark::executor::current().parallel_for(pi_count, [&](const std::size_t i) {
+                    const typename packed_vector_type::word_type *words =
+                        pi.words().data() + i * packed_vector_type::words_per_element;
+                    for (std::size_t j = 0; j < fr_byteblob_size; ++j) {
+                        write_iter[i * fr_byteblob_size + j] = chunk_type(words[j / 8] >> (8 * (j % 8)));
+                    }
+                });
+
+                return output;
+            }
+
+            /**
+             * Writes the proof into a buffer of proof_byteblob_size chunks, with no allocation.
+             */
+            template<typename OutputIterator>
+            static inline OutputIterator proof_process(const typename scheme_type::proof_type &pr,
+                                                       OutputIterator write_iter) {
+
+                const auto g_A = curve_element_serializer<CurveType>::point_to_octets_compress(pr.g_A);
+                const auto g_B = curve_element_serializer<CurveType>::point_to_octets_compress(pr.g_B);
+                const auto g_C = curve_element_serializer<CurveType>::point_to_octets_compress(pr.g_C);
+
+                write_iter = std::copy(g_A.begin(), g_A.end(), write_iter);
+                write_iter = std::copy(g_B.begin(), g_B.end(), write_iter);
+                return std::copy(g_C.begin(), g_C.end(), write_iter);
+            }
+
+            /**
+             * Writes the proofs of a batch one after the other, each in the layout of proof_process.
+             */
+            template<typename OutputIterator>
+            static inline OutputIterator proof_batch_process(const typename scheme_type::proof_batch_type &proofs,
+                                                             OutputIterator write_iter) {
+
+                for (std::size_t i = 0; i < proofs.size(); ++i) {
+                    const auto g_A = curve_element_serializer<CurveType>::point_to_octets_compress(proofs.g_A[i]);
+                    const auto g_B = curve_element_serializer<CurveType>::point_to_octets_compress(proofs.g_B[i]);
+                    const auto g_C = curve_element_serializer<CurveType>::point_to_octets_compress(proofs.g_C[i]);
+
+                    write_iter = std::copy(g_A.begin(), g_A.end(), write_iter);
+                    write_iter = std::copy(g_B.begin(), g_B.end(), write_iter);
+                    write_iter = std::copy(g_C.begin(), g_C.end(), write_iter);
+                }
+                return write_iter;
+            }
+
+            static inline proof_byteblob_type fixed_size_process(const typename scheme_type::proof_type &pr) {
+
+                proof_byteblob_type output;
+                proof_process(pr, output.begin());
+                return output;
+            }
+
             static inline std::vector<chunk_type> process(typename scheme_type::proof_type pr) {
 
-                std::size_t g1_byteblob_size = curve_element_serializer<CurveType>::sizeof_field_element;
-                std::size_t g2_byteblob_size = 2 * curve_element_serializer<CurveType>::sizeof_field_element;
+                std::vector<chunk_type> output(proof_byteblob_size);
+
+                proof_process(pr, output.begin());
+
+                return output;
+            }
+
+            /**
+             * Fixed-size layout of a prepared verifier input: a form byte, 1 when accumulated_input
+             * and g_C are negated, then alpha_g1_beta_g2, gamma_g2, delta_g2, accumulated_input and
+             * the proof.
+             */
+            static inline std::vector<chunk_type>
+                process(const r1cs_gg_ppzksnark_prepared_verifier_input<CurveType> &prepared) {
+
+                std::vector<chunk_type> output(prepared_verifier_input_byteblob_size);
+
+                typename std::vector<chunk_type>::iterator write_iter = output.begin();
+
+                *write_iter++ = chunk_type(prepared.pairing_inputs);
+                field_type_process<typename CurveType::gt_type>(prepared.alpha_g1_beta_g2, write_iter);
+                g2_group_type_process<typename CurveType::g2_type>(prepared.gamma_g2, write_iter);
+                g2_group_type_process<typename CurveType::g2_type>(prepared.delta_g2, write_iter);
+                g1_group_type_process<typename CurveType::g1_type>(prepared.accumulated_input, write_iter);
+                proof_process(prepared.proof, write_iter);
+
+                return output;
+            }
+
+            /**
+             * Layout of an aggregate proof with compressed Gt elements: the number of aggregated proofs,
+             * the G1 and G2 elements in the order of detail::for_each_group_element, then the compressed
+             * Gt elements in the order of detail::for_each_gt_element.
+             */
+            static inline std::vector<chunk_type>
+                process(const r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> &proof) {
+                typedef typename r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType>::compression_type
+                    compression_type;
+
+                BOOST_ASSERT(proof.has_correct_len());
+
+                const std::size_t rounds = proof.body.tmipp.gipa.z_c.size();
+                const std::size_t gt_element_size = compression_type::element_size();
+                std::vector<chunk_type> output(std_size_t_byteblob_size + (7 + 2 * rounds) * g1_byteblob_size +
+                                               5 * g2_byteblob_size + proof.gt_elements.size() * gt_element_size);
+
+                typename std::vector<chunk_type>::iterator write_iter = output.begin();
+
+                std_size_t_process(proof.body.tmipp.gipa.nproofs, write_iter);
+                nil::crypto3::zk::snark::detail::for_each_group_element(
+                    proof.body,
+                    [&](const typename CurveType::g1_type::value_type &point) {
+                        g1_group_type_process<typename CurveType::g1_type>(point, write_iter);
+                    },
+                    [&](const typename CurveType::g2_type::value_type &point) {
+                        g2_group_type_process<typename CurveType::g2_type>(point, write_iter);
+                    });
+                for (const typename compression_type::compressed_type &element : proof.gt_elements) {
+                    compression_type::to_bytes(element, write_iter, write_iter + gt_element_size);
+                    write_iter += gt_element_size;
+                }
+
+                return output;
+            }
+
+            static inline std::vector<chunk_type> process(const r1cs_gg_ppzksnark_shard_job<CurveType> &job) {
+
+                const std::size_t num_scalars = job.assignment.size() + job.H.size() + job.L.size();
+
+                std::vector<chunk_type> output(10 * std_size_t_byteblob_size + num_scalars * fr_byteblob_size);
+
+                typename std::vector<chunk_type>::iterator write_iter = output.begin();
+
+                for (const std::size_t range : {job.shard.index, job.shard.variables_first, job.shard.variables_last,
+                                                job.shard.H_first, job.shard.H_last, job.shard.L_first,
+                                                job.shard.L_last}) {
+                    std_size_t_process(range, write_iter);
+                }
+
+                for (const std::vector<typename CurveType::scalar_field_type::value_type> *scalars :
+                     {&job.assignment, &job.H, &job.L}) {
+                    std_size_t_process(scalars->size(), write_iter);
+                    for (const typename CurveType::scalar_field_type::value_type &scalar : *scalars) {
+                        field_type_process<typename CurveType::scalar_field_type>(scalar, write_iter);
+                    }
+                }
+
+                return output;
+            }
 
-                std::size_t proof_size = g1_byteblob_size + g2_byteblob_size + g1_byteblob_size;
+            static inline std::vector<chunk_type> process(r1cs_gg_ppzksnark_partial_evaluation<CurveType> pe) {
 
-                std::vector<chunk_type> output(proof_size);
+                std::vector<chunk_type> output(std_size_t_byteblob_size + 4 * g1_byteblob_size + g2_byteblob_size);
 
                 typename std::vector<chunk_type>::iterator write_iter = output.begin();
 
-                g1_group_type_process<typename CurveType::g1_type>(pr.g_A, write_iter);
-                g2_group_type_process<typename CurveType::g2_type>(pr.g_B, write_iter);
-                g1_group_type_process<typename CurveType::g1_type>(pr.g_C, write_iter);
+                std_size_t_process(pe.shard_index, write_iter);
+                g1_group_type_process<typename CurveType::g1_type>(pe.evaluation_At, write_iter);
+                g1_group_type_process<typename CurveType::g1_type>(pe.evaluation_Ht, write_iter);
+                g1_group_type_process<typename CurveType::g1_type>(pe.evaluation_Lt, write_iter);
+                g2g1_element_kc_process(pe.evaluation_Bt, write_iter);
 
                 return output;
             }
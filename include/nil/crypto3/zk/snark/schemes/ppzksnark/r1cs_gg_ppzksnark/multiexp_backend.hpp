@@ -0,0 +1,303 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Multi-exponentiation backends of the R1CS GG-ppzkSNARK prover.
+//
+// A backend evaluates the five query multi-exponentiations of a proof (A_query, the G2 and
+// G1 halves of B_query, H_query and L_query) on behalf of r1cs_gg_ppzksnark_prover. The
+// queries are handed to the backend once, when a proving key is made resident with it, so
+// a backend running on an accelerator keeps them in device memory across proofs and only
+// the scalars of each proof cross over.
+//
+// A backend is a policy type providing:
+// - fft_backend_type, the FFT backend of the witness map (see r1cs_to_qap_fft_backend.hpp),
+//   so that a device backend computes H where its H_query multi-exponentiation reads it;
+// - resident_queries_type, the backend's copy of (or handle to) the queries of a key;
+// - static resident_queries_type upload(const proving_key_type &);
+// - static g1 multiexp_A, multiexp_H and multiexp_L(resident, proving_key, scalars_first, scalars_last);
+// - static knowledge_commitment multiexp_B(resident, proving_key, scalars_first, scalars_last).
+// The scalars of A and B are the constant-padded assignment, those of L the auxiliary
+// input and those of H the coefficients of H; each call returns the sum over its query.
+// A backend may also provide each multiexp member with a query offset first after the
+// proving key, returning the sum over the terms [first, first + (scalars_last - scalars_first))
+// of the query only; the split backend of split_multiexp_backend.hpp shares the range of a
+// query between two backends through these members.
+//
+// The CPU backend below reads the queries in place from the proving key. The endomorphism
+// backend keeps the G1 queries with their images under the GLV endomorphism of G1, for the
+// curves that have one, see glv_endomorphism.hpp. A CUDA or OpenCL backend plugs in by
+// providing the same members, with upload copying the queries to the device and the
+// multiexp members launching the device kernels.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_MULTIEXP_BACKEND_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_MULTIEXP_BACKEND_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+#include <nil/crypto3/algebra/multiexp/policies.hpp>
+
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/glv_endomorphism.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap_fft_backend.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proving_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Evaluates the query multi-exponentiations on the cores of the current executor.
+                 *
+                 * The queries are not copied: the resident queries are empty and the proving key the
+                 * prover passes along is read in place.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_cpu_multiexp_backend {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType> proving_key_type;
+                    typedef reductions::r1cs_to_qap_cpu_fft_backend<typename CurveType::scalar_field_type>
+                        fft_backend_type;
+
+                    struct resident_queries_type { };
+
+                    static inline resident_queries_type upload(const proving_key_type &) {
+                        return resident_queries_type();
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_A(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_A(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_A(const resident_queries_type &, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            proving_key.A_query.begin() + first,
+                            proving_key.A_query.begin() + first + std::distance(scalars_first, scalars_last),
+                            scalars_first, scalars_last, executor::current().concurrency());
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename knowledge_commitment<g2_type, g1_type>::value_type
+                        multiexp_B(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                   InputFieldIterator scalars_first, InputFieldIterator scalars_last) {
+                        return multiexp_B(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename knowledge_commitment<g2_type, g1_type>::value_type
+                        multiexp_B(const resident_queries_type &, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            proving_key.B_query, first, first + std::distance(scalars_first, scalars_last),
+                            scalars_first, scalars_last, executor::current().concurrency());
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_H(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_H(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_H(const resident_queries_type &, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return dispatch_multiexp<multiexp_method_auto>(
+                            proving_key.H_query.begin() + first,
+                            proving_key.H_query.begin() + first + std::distance(scalars_first, scalars_last),
+                            scalars_first, scalars_last, executor::current().concurrency());
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_L(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_L(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_L(const resident_queries_type &, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            proving_key.L_query.begin() + first,
+                            proving_key.L_query.begin() + first + std::distance(scalars_first, scalars_last),
+                            scalars_first, scalars_last, executor::current().concurrency());
+                    }
+                };
+
+                /**
+                 * Evaluates the G1 query multi-exponentiations over half-length scalars, with the
+                 * endomorphism of G1, on the cores of the current executor.
+                 *
+                 * The images of A_query, H_query and L_query are computed once, when a key is made
+                 * resident, and kept with the queries. B_query, whose G2 half has no endomorphism here,
+                 * is evaluated as by the CPU backend.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_endomorphism_multiexp_backend {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType> proving_key_type;
+                    typedef reductions::r1cs_to_qap_cpu_fft_backend<typename CurveType::scalar_field_type>
+                        fft_backend_type;
+
+                    static_assert(glv_endomorphism<g1_type>::available, "G1 has no GLV endomorphism");
+
+                    struct resident_queries_type {
+                        glv_bases<g1_type> A_query, H_query, L_query;
+                    };
+
+                    static inline resident_queries_type upload(const proving_key_type &proving_key) {
+                        return resident_queries_type {glv_bases<g1_type>(proving_key.A_query),
+                                                      glv_bases<g1_type>(proving_key.H_query),
+                                                      glv_bases<g1_type>(proving_key.L_query)};
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_A(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_A(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_A(const resident_queries_type &resident, const proving_key_type &,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return glv_multiexp<multiexp_method_auto>(
+                            resident.A_query, first, first + std::distance(scalars_first, scalars_last),
+                            scalars_first, executor::current().concurrency());
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename knowledge_commitment<g2_type, g1_type>::value_type
+                        multiexp_B(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                   InputFieldIterator scalars_first, InputFieldIterator scalars_last) {
+                        return multiexp_B(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename knowledge_commitment<g2_type, g1_type>::value_type
+                        multiexp_B(const resident_queries_type &, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            proving_key.B_query, first, first + std::distance(scalars_first, scalars_last),
+                            scalars_first, scalars_last, executor::current().concurrency());
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_H(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_H(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_H(const resident_queries_type &resident, const proving_key_type &,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return glv_multiexp<multiexp_method_auto>(
+                            resident.H_query, first, first + std::distance(scalars_first, scalars_last),
+                            scalars_first, executor::current().concurrency());
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_L(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_L(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_L(const resident_queries_type &resident, const proving_key_type &,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return glv_multiexp<multiexp_method_auto>(
+                            resident.L_query, first, first + std::distance(scalars_first, scalars_last),
+                            scalars_first, executor::current().concurrency());
+                    }
+                };
+
+                /**
+                 * A proving key made resident with a multi-exponentiation backend.
+                 *
+                 * The queries are uploaded once, on construction; every proof against the key then
+                 * reuses them.
+                 */
+                template<typename CurveType, typename MultiexpBackend>
+                struct r1cs_gg_ppzksnark_resident_proving_key {
+                    typedef CurveType curve_type;
+                    typedef MultiexpBackend backend_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType> proving_key_type;
+                    typedef typename MultiexpBackend::resident_queries_type resident_queries_type;
+
+                    proving_key_type proving_key;
+                    resident_queries_type queries;
+
+                    r1cs_gg_ppzksnark_resident_proving_key(const proving_key_type &proving_key) :
+                        r1cs_gg_ppzksnark_resident_proving_key(proving_key_type(proving_key)) {
+                    }
+
+                    r1cs_gg_ppzksnark_resident_proving_key(proving_key_type &&proving_key) :
+                        proving_key(std::move(proving_key)), queries(MultiexpBackend::upload(this->proving_key)) {
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_MULTIEXP_BACKEND_HPP
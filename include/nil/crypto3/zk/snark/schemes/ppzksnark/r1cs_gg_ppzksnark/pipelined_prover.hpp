@@ -0,0 +1,264 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the pipelined R1CS GG-ppzkSNARK prover, overlapping the stages of consecutive proofs.
+//
+// A proof goes through three stages that stress different resources: the witness map,
+// bound by the memory bandwidth of its FFTs, the query multi-exponentiations, bound by the
+// group arithmetic, and the finalization combining their results. A prover service proving
+// one request after the other leaves each resource idle while the other stages run. The
+// pipelined prover runs every stage on a thread of its own, with an executor bounding the
+// threads of that stage, and hands the proofs in progress from one stage to the next through
+// bounded queues, so the witness map of proof i + 1 runs while the multi-exponentiations of
+// proof i are in progress:
+//
+//     r1cs_gg_ppzksnark_pipelined_prover<CurveType> prover(pk, executor(4), executor(12));
+//     std::future<proof_type> first = prover.submit(primary_input_1, auxiliary_input_1);
+//     std::future<proof_type> second = prover.submit(primary_input_2, auxiliary_input_2);
+//     proof_type proof = first.get();
+//
+// submit blocks while the queue of the first stage is full. An exception thrown while
+// proving a request is stored in its future; the pipeline keeps serving the next ones. The
+// destructor finishes the requests already submitted.
+//
+// The multi-exponentiations run on the queries made resident with MultiexpBackend (see
+// multiexp_backend.hpp), the CPU backend by default.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_PIPELINED_PROVER_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_PIPELINED_PROVER_HPP
+
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/concurrent_queue.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_const_padded_assignment.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/multiexp_backend.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/prover.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /**
+                 * Proves the requests submitted to it in a three-stage pipeline: the witness map on the
+                 * reduction executor, the query multi-exponentiations on the multiexp executor and the
+                 * finalization on the finalize executor, each stage on a thread of its own.
+                 */
+                template<typename CurveType,
+                         typename MultiexpBackend = r1cs_gg_ppzksnark_cpu_multiexp_backend<CurveType>>
+                class r1cs_gg_ppzksnark_pipelined_prover {
+                    typedef r1cs_gg_ppzksnark_prover<CurveType> prover_type;
+
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
+                    typedef reductions::r1cs_to_qap<scalar_field_type, typename MultiexpBackend::fft_backend_type>
+                        reduction_type;
+
+                public:
+                    typedef typename prover_type::primary_input_type primary_input_type;
+                    typedef typename prover_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename prover_type::proving_key_type proving_key_type;
+                    typedef typename prover_type::proof_type proof_type;
+                    typedef r1cs_gg_ppzksnark_resident_proving_key<CurveType, MultiexpBackend>
+                        resident_proving_key_type;
+
+                    /**
+                     * Starts the stage threads. Each queue between two stages holds at most queue_capacity
+                     * proofs in progress.
+                     */
+                    r1cs_gg_ppzksnark_pipelined_prover(const proving_key_type &proving_key,
+                                                       const executor &reduction_executor,
+                                                       const executor &multiexp_executor,
+                                                       const executor &finalize_executor = executor(1),
+                                                       const std::size_t queue_capacity = 2) :
+                        resident_key(proving_key),
+                        context(reduction_type::make_context(resident_key.proving_key.constraint_system)),
+                        reduction_executor(reduction_executor), multiexp_executor(multiexp_executor),
+                        finalize_executor(finalize_executor), requests(queue_capacity), witnesses(queue_capacity),
+                        evaluations(queue_capacity) {
+                        reduction_thread = std::thread([this] { reduce(); });
+                        multiexp_thread = std::thread([this] { evaluate(); });
+                        finalize_thread = std::thread([this] { finalize(); });
+                    }
+
+                    r1cs_gg_ppzksnark_pipelined_prover(const r1cs_gg_ppzksnark_pipelined_prover &) = delete;
+                    r1cs_gg_ppzksnark_pipelined_prover &operator=(const r1cs_gg_ppzksnark_pipelined_prover &) = delete;
+
+                    /**
+                     * Proves the requests submitted so far, then stops the stage threads.
+                     */
+                    ~r1cs_gg_ppzksnark_pipelined_prover() {
+                        requests.close();
+                        reduction_thread.join();
+                        multiexp_thread.join();
+                        finalize_thread.join();
+                    }
+
+                    /**
+                     * Queues the proof of a request, blocking while the first stage is full.
+                     */
+                    std::future<proof_type> submit(primary_input_type primary_input,
+                                                   auxiliary_input_type auxiliary_input) {
+                        request_type request;
+                        request.primary_input = std::move(primary_input);
+                        request.auxiliary_input = std::move(auxiliary_input);
+                        std::future<proof_type> result = request.proof.get_future();
+                        requests.push(std::move(request));
+                        return result;
+                    }
+
+                private:
+                    struct request_type {
+                        primary_input_type primary_input;
+                        auxiliary_input_type auxiliary_input;
+                        std::promise<proof_type> proof;
+                    };
+
+                    /* qap_witness has no empty state, hence the pointer */
+                    struct witness_type {
+                        std::unique_ptr<const qap_witness<scalar_field_type>> qap_wit;
+                        std::promise<proof_type> proof;
+                    };
+
+                    struct evaluation_type {
+                        typename g1_type::value_type evaluation_At;
+                        typename knowledge_commitment<g2_type, g1_type>::value_type evaluation_Bt;
+                        typename g1_type::value_type evaluation_Ht;
+                        typename g1_type::value_type evaluation_Lt;
+                        std::promise<proof_type> proof;
+                    };
+
+                    void reduce() {
+                        executor::scope guard(reduction_executor);
+                        const proving_key_type &proving_key = resident_key.proving_key;
+                        typename reduction_type::workspace scratch;
+
+                        request_type request;
+                        while (requests.pop(request)) {
+                            try {
+                                BOOST_ASSERT(proving_key.constraint_system.is_satisfied(request.primary_input,
+                                                                                        request.auxiliary_input));
+
+                                stage_profiler::timer witness_timer("witness_map",
+                                                                    proving_key.constraint_system.num_constraints());
+                                witness_type witness;
+                                witness.qap_wit.reset(new qap_witness<scalar_field_type>(reduction_type::witness_map(
+                                    proving_key.constraint_system, request.primary_input, request.auxiliary_input,
+                                    context, scratch)));
+                                witness_timer.stop();
+
+                                witness.proof = std::move(request.proof);
+                                witnesses.push(std::move(witness));
+                            } catch (...) {
+                                request.proof.set_exception(std::current_exception());
+                            }
+                        }
+                        witnesses.close();
+                    }
+
+                    void evaluate() {
+                        executor::scope guard(multiexp_executor);
+                        const proving_key_type &proving_key = resident_key.proving_key;
+
+                        witness_type witness;
+                        while (witnesses.pop(witness)) {
+                            try {
+                                const qap_witness<scalar_field_type> &qap_wit = *witness.qap_wit;
+                                stage_profiler::timer multiexp_timer("multiexp", qap_wit.num_variables + 1);
+                                prover_type::count_exp_terms(qap_wit.num_variables, qap_wit.num_inputs,
+                                                             qap_wit.degree);
+
+                                const r1cs_const_padded_assignment<scalar_field_type> const_padded_assignment(
+                                    qap_wit.coefficients_for_ABCs);
+
+                                evaluation_type evaluation;
+                                evaluation.evaluation_At = MultiexpBackend::multiexp_A(
+                                    resident_key.queries, proving_key, const_padded_assignment.begin(),
+                                    const_padded_assignment.begin() + qap_wit.num_variables + 1);
+                                evaluation.evaluation_Bt = MultiexpBackend::multiexp_B(
+                                    resident_key.queries, proving_key, const_padded_assignment.begin(),
+                                    const_padded_assignment.begin() + qap_wit.num_variables + 1);
+                                evaluation.evaluation_Ht = MultiexpBackend::multiexp_H(
+                                    resident_key.queries, proving_key, qap_wit.coefficients_for_H.begin(),
+                                    qap_wit.coefficients_for_H.begin() + (qap_wit.degree - 1));
+                                evaluation.evaluation_Lt = MultiexpBackend::multiexp_L(
+                                    resident_key.queries, proving_key,
+                                    qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_inputs,
+                                    qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables);
+                                multiexp_timer.stop();
+
+                                evaluation.proof = std::move(witness.proof);
+                                evaluations.push(std::move(evaluation));
+                            } catch (...) {
+                                witness.proof.set_exception(std::current_exception());
+                            }
+                        }
+                        evaluations.close();
+                    }
+
+                    void finalize() {
+                        executor::scope guard(finalize_executor);
+
+                        evaluation_type evaluation;
+                        while (evaluations.pop(evaluation)) {
+                            try {
+                                evaluation.proof.set_value(prover_type::make_proof(
+                                    resident_key.proving_key, evaluation.evaluation_At, evaluation.evaluation_Bt,
+                                    evaluation.evaluation_Ht, evaluation.evaluation_Lt));
+                            } catch (...) {
+                                evaluation.proof.set_exception(std::current_exception());
+                            }
+                        }
+                    }
+
+                    const resident_proving_key_type resident_key;
+                    const reductions::reduction_context<scalar_field_type> context;
+                    const executor reduction_executor, multiexp_executor, finalize_executor;
+
+                    detail::bounded_queue<request_type> requests;
+                    detail::bounded_queue<witness_type> witnesses;
+                    detail::bounded_queue<evaluation_type> evaluations;
+
+                    std::thread reduction_thread, multiexp_thread, finalize_thread;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_PIPELINED_PROVER_HPP
@@ -0,0 +1,99 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the prepared verifier input of the R1CS GG-ppzkSNARK.
+//
+// A prepared input is what remains of a verification once the primary input has been
+// accumulated off-chain into gamma_ABC_g1: the proof, the accumulated input and the
+// three elements of the key the pairing check takes. Checking it costs the three
+// Miller loops and the final exponentiation of
+//     e(A, B) = e(alpha, beta) * e(acc, gamma) * e(C, delta),
+// without any scalar multiplication. In the pairing-input form acc and C are stored
+// negated, so the check is the product of three pairings against e(alpha, beta).
+//
+// A prepared input comes from the prover, so the verifier only takes its proof as is:
+// its key elements must match the trusted key, and its accumulated input the one of the
+// primary input the verifier holds.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_PREPARED_VERIFIER_INPUT_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_PREPARED_VERIFIER_INPUT_HPP
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_prepared_verifier_input {
+                    typedef CurveType curve_type;
+                    typedef r1cs_gg_ppzksnark_proof<CurveType> proof_type;
+
+                    /**
+                     * Whether accumulated_input and proof.g_C are stored negated, so that every
+                     * pairing of the check is taken as is.
+                     */
+                    bool pairing_inputs;
+
+                    typename CurveType::gt_type::value_type alpha_g1_beta_g2;
+                    typename CurveType::g2_type::value_type gamma_g2;
+                    typename CurveType::g2_type::value_type delta_g2;
+
+                    /// gamma_ABC_g1.first + \sum_i primary_input[i] * gamma_ABC_g1.rest[i]
+                    typename CurveType::g1_type::value_type accumulated_input;
+                    proof_type proof;
+
+                    r1cs_gg_ppzksnark_prepared_verifier_input() : pairing_inputs(false) {
+                    }
+
+                    r1cs_gg_ppzksnark_prepared_verifier_input(
+                        bool pairing_inputs,
+                        const typename CurveType::gt_type::value_type &alpha_g1_beta_g2,
+                        const typename CurveType::g2_type::value_type &gamma_g2,
+                        const typename CurveType::g2_type::value_type &delta_g2,
+                        const typename CurveType::g1_type::value_type &accumulated_input,
+                        const proof_type &proof) :
+                        pairing_inputs(pairing_inputs),
+                        alpha_g1_beta_g2(alpha_g1_beta_g2), gamma_g2(gamma_g2), delta_g2(delta_g2),
+                        accumulated_input(accumulated_input), proof(proof) {
+                    }
+
+                    bool is_well_formed() const {
+                        return gamma_g2.is_well_formed() && delta_g2.is_well_formed() &&
+                               accumulated_input.is_well_formed() && proof.is_well_formed();
+                    }
+
+                    bool operator==(const r1cs_gg_ppzksnark_prepared_verifier_input &other) const {
+                        return pairing_inputs == other.pairing_inputs && alpha_g1_beta_g2 == other.alpha_g1_beta_g2 &&
+                               gamma_g2 == other.gamma_g2 && delta_g2 == other.delta_g2 &&
+                               accumulated_input == other.accumulated_input && proof == other.proof;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_PREPARED_VERIFIER_INPUT_HPP
@@ -0,0 +1,125 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a structure-of-arrays batch of R1CS GG-ppzkSNARK proofs.
+//
+// The batch verifier and the aggregation read the A, B and C elements of a batch of proofs
+// as three separate sequences: the aggregation commits to each of them and folds them
+// independently, and the batch verifier pairs the scaled A with the B and sums the C. A
+// batch holding them in three contiguous vectors is consumed by both without first
+// splitting an array of proofs, and the marshalling decodes a sequence of proofs straight
+// into it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_PROOF_BATCH_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_PROOF_BATCH_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_proof_batch {
+                    typedef CurveType curve_type;
+                    typedef r1cs_gg_ppzksnark_proof<CurveType> proof_type;
+
+                    typedef typename CurveType::g1_type::value_type g1_value_type;
+                    typedef typename CurveType::g2_type::value_type g2_value_type;
+
+                    std::vector<g1_value_type> g_A;
+                    std::vector<g2_value_type> g_B;
+                    std::vector<g1_value_type> g_C;
+
+                    r1cs_gg_ppzksnark_proof_batch() = default;
+
+                    template<typename InputProofIterator>
+                    r1cs_gg_ppzksnark_proof_batch(InputProofIterator proofs_first, InputProofIterator proofs_last) {
+                        reserve(std::distance(proofs_first, proofs_last));
+                        for (; proofs_first != proofs_last; ++proofs_first) {
+                            push_back(*proofs_first);
+                        }
+                    }
+
+                    r1cs_gg_ppzksnark_proof_batch(std::vector<g1_value_type> &&g_A, std::vector<g2_value_type> &&g_B,
+                                                  std::vector<g1_value_type> &&g_C) :
+                        g_A(std::move(g_A)),
+                        g_B(std::move(g_B)), g_C(std::move(g_C)) {
+                        BOOST_ASSERT(this->g_A.size() == this->g_B.size() && this->g_A.size() == this->g_C.size());
+                    }
+
+                    std::size_t size() const {
+                        return g_A.size();
+                    }
+
+                    bool empty() const {
+                        return g_A.empty();
+                    }
+
+                    void reserve(const std::size_t n) {
+                        g_A.reserve(n);
+                        g_B.reserve(n);
+                        g_C.reserve(n);
+                    }
+
+                    void push_back(const proof_type &proof) {
+                        g_A.emplace_back(proof.g_A);
+                        g_B.emplace_back(proof.g_B);
+                        g_C.emplace_back(proof.g_C);
+                    }
+
+                    void clear() {
+                        g_A.clear();
+                        g_B.clear();
+                        g_C.clear();
+                    }
+
+                    /* A copy of the i-th proof */
+                    proof_type operator[](const std::size_t i) const {
+                        BOOST_ASSERT(i < size());
+                        return proof_type(g1_value_type(g_A[i]), g2_value_type(g_B[i]), g1_value_type(g_C[i]));
+                    }
+
+                    bool is_well_formed(const std::size_t i) const {
+                        return g_A[i].is_well_formed() && g_B[i].is_well_formed() && g_C[i].is_well_formed();
+                    }
+
+                    bool operator==(const r1cs_gg_ppzksnark_proof_batch &other) const {
+                        return g_A == other.g_A && g_B == other.g_B && g_C == other.g_C;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_PROOF_BATCH_HPP
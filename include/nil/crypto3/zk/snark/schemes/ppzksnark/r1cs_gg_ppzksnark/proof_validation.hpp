@@ -0,0 +1,285 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the batch validation of incoming R1CS GG-ppzkSNARK proofs.
+//
+// A verifier under adversarial load should reject malformed proofs before spending
+// any pairing on them. The validation runs the on-curve tests of all the group
+// elements of a vector of proofs on the threads of the current executor, then
+// checks the prime order subgroup membership of all the elements of the remaining
+// proofs at once with batch_subgroup_check. When the batch check fails, the proofs
+// are bisected until the offending ones are found, so k invalid proofs among n cost
+// O(k log n) batch checks.
+//
+// Aggregate proofs are checked for the consistency of their lengths first. Their Gt
+// elements are left to the verifier: a wrong one fails its pairing checks.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_PROOF_VALIDATION_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_PROOF_VALIDATION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <nil/crypto3/zk/snark/batch_subgroup_check.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/compressed_proof.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/proof.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace detail {
+                    /**
+                     * The G1 and G2 elements of a sequence of proofs, proof by proof, and the positions
+                     * of the proofs that fail validation.
+                     */
+                    template<typename CurveType, typename DistributionType, typename GeneratorType>
+                    class proof_points {
+                        typedef typename CurveType::g1_type g1_type;
+                        typedef typename CurveType::g2_type g2_type;
+                        typedef typename CurveType::scalar_field_type scalar_field_type;
+
+                    public:
+                        typedef typename g1_type::value_type g1_value_type;
+                        typedef typename g2_type::value_type g2_value_type;
+
+                        explicit proof_points(const std::size_t num_proofs) {
+                            g1_ends.reserve(num_proofs);
+                            g2_ends.reserve(num_proofs);
+                            consistent.reserve(num_proofs);
+                        }
+
+                        /* starts the points of the next proof, which is rejected as is when inconsistent */
+                        void next_proof(const bool is_consistent) {
+                            g1_ends.emplace_back(g1_points.size());
+                            g2_ends.emplace_back(g2_points.size());
+                            consistent.emplace_back(is_consistent);
+                        }
+
+                        void add(const g1_value_type &point) {
+                            g1_points.emplace_back(point);
+                            ++g1_ends.back();
+                        }
+
+                        void add(const g2_value_type &point) {
+                            g2_points.emplace_back(point);
+                            ++g2_ends.back();
+                        }
+
+                        template<typename GroupValueType>
+                        void add(const std::pair<GroupValueType, GroupValueType> &points) {
+                            add(points.first);
+                            add(points.second);
+                        }
+
+                        /**
+                         * The positions, in increasing order, of the proofs that are inconsistent, have
+                         * an element off the curve or an element outside the prime order subgroup.
+                         */
+                        std::vector<std::size_t> rejected(const std::size_t rounds) const {
+                            const std::size_t num_proofs = consistent.size();
+
+                            std::vector<char> on_curve(num_proofs, 0);
+                            executor::current().parallel_for(num_proofs, [&](const std::size_t i) {
+                                on_curve[i] =
+                                    consistent[i] &&
+                                    std::all_of(g1_points.begin() + g1_begin(i), g1_points.begin() + g1_ends[i],
+                                                [](const g1_value_type &p) { return p.is_well_formed(); }) &&
+                                    std::all_of(g2_points.begin() + g2_begin(i), g2_points.begin() + g2_ends[i],
+                                                [](const g2_value_type &p) { return p.is_well_formed(); });
+                            });
+
+                            std::vector<std::size_t> result;
+                            std::vector<std::size_t> candidates;
+                            for (std::size_t i = 0; i < num_proofs; ++i) {
+                                if (on_curve[i]) {
+                                    candidates.emplace_back(i);
+                                } else {
+                                    result.emplace_back(i);
+                                }
+                            }
+
+                            if (!candidates.empty() && !in_subgroup(candidates, 0, candidates.size(), rounds)) {
+                                bisect(candidates, 0, candidates.size(), rounds, result);
+                            }
+                            std::sort(result.begin(), result.end());
+                            return result;
+                        }
+
+                    private:
+                        std::size_t g1_begin(const std::size_t i) const {
+                            return i ? g1_ends[i - 1] : 0;
+                        }
+
+                        std::size_t g2_begin(const std::size_t i) const {
+                            return i ? g2_ends[i - 1] : 0;
+                        }
+
+                        /* whether the elements of the proofs candidates[first, last) lie in the subgroup */
+                        bool in_subgroup(const std::vector<std::size_t> &candidates, const std::size_t first,
+                                         const std::size_t last, const std::size_t rounds) const {
+                            std::vector<g1_value_type> g1_range;
+                            std::vector<g2_value_type> g2_range;
+                            for (std::size_t k = first; k < last; ++k) {
+                                const std::size_t i = candidates[k];
+                                g1_range.insert(g1_range.end(), g1_points.begin() + g1_begin(i),
+                                                g1_points.begin() + g1_ends[i]);
+                                g2_range.insert(g2_range.end(), g2_points.begin() + g2_begin(i),
+                                                g2_points.begin() + g2_ends[i]);
+                            }
+                            return batch_subgroup_check<g1_type, scalar_field_type, DistributionType, GeneratorType>(
+                                       g1_range.begin(), g1_range.end(), rounds) &&
+                                   batch_subgroup_check<g2_type, scalar_field_type, DistributionType, GeneratorType>(
+                                       g2_range.begin(), g2_range.end(), rounds);
+                        }
+
+                        /* candidates[first, last) hold at least one proof outside the subgroup */
+                        void bisect(const std::vector<std::size_t> &candidates, const std::size_t first,
+                                    const std::size_t last, const std::size_t rounds,
+                                    std::vector<std::size_t> &result) const {
+                            if (last - first == 1) {
+                                result.emplace_back(candidates[first]);
+                                return;
+                            }
+
+                            const std::size_t middle = first + (last - first) / 2;
+                            if (in_subgroup(candidates, first, middle, rounds)) {
+                                bisect(candidates, middle, last, rounds, result);
+                                return;
+                            }
+                            bisect(candidates, first, middle, rounds, result);
+                            if (!in_subgroup(candidates, middle, last, rounds)) {
+                                bisect(candidates, middle, last, rounds, result);
+                            }
+                        }
+
+                        std::vector<g1_value_type> g1_points;
+                        std::vector<g2_value_type> g2_points;
+                        std::vector<std::size_t> g1_ends;
+                        std::vector<std::size_t> g2_ends;
+                        std::vector<char> consistent;
+                    };
+
+                    template<typename CurveType>
+                    const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &
+                        aggregate_proof_body(const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof) {
+                        return proof;
+                    }
+
+                    template<typename CurveType>
+                    const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &
+                        aggregate_proof_body(const r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> &proof) {
+                        return proof.body;
+                    }
+
+                    template<typename CurveType>
+                    bool aggregate_proof_is_consistent(const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof) {
+                        return proof.is_valid();
+                    }
+
+                    template<typename CurveType>
+                    bool aggregate_proof_is_consistent(
+                        const r1cs_gg_ppzksnark_aggregate_compressed_proof<CurveType> &proof) {
+                        return proof.has_correct_len() && proof.body.is_valid();
+                    }
+
+                    template<typename PointsType, typename CurveType>
+                    void add_aggregate_proof_points(PointsType &points,
+                                                    const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof) {
+                        const gipa_proof<CurveType> &gipa = proof.tmipp.gipa;
+                        points.add(proof.agg_c);
+                        for (const auto &z_c : gipa.z_c) {
+                            points.add(z_c);
+                        }
+                        points.add(gipa.final_a);
+                        points.add(gipa.final_b);
+                        points.add(gipa.final_c);
+                        points.add(gipa.final_vkey);
+                        points.add(gipa.final_wkey);
+                        points.add(proof.tmipp.vkey_opening);
+                        points.add(proof.tmipp.wkey_opening);
+                    }
+                }    // namespace detail
+
+                /**
+                 * Validates the proofs of [proofs_first, proofs_last) before their verification and
+                 * returns the positions, in increasing order, of those to reject: with an element
+                 * off the curve or, up to a probability of 2^-rounds, outside the prime order subgroup.
+                 */
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = random_device_generator, typename InputProofIterator>
+                std::vector<std::size_t> validate_proofs(InputProofIterator proofs_first,
+                                                         InputProofIterator proofs_last,
+                                                         const std::size_t rounds = default_subgroup_check_rounds) {
+                    detail::proof_points<CurveType, DistributionType, GeneratorType> points(
+                        std::distance(proofs_first, proofs_last));
+                    for (InputProofIterator it = proofs_first; it != proofs_last; ++it) {
+                        const r1cs_gg_ppzksnark_proof<CurveType> &proof = *it;
+                        points.next_proof(true);
+                        points.add(proof.g_A);
+                        points.add(proof.g_B);
+                        points.add(proof.g_C);
+                    }
+                    return points.rejected(rounds);
+                }
+
+                /**
+                 * Same as above for aggregate proofs, plain or with compressed Gt elements, which are
+                 * also rejected when the lengths of their elements are inconsistent.
+                 */
+                template<typename CurveType,
+                         typename DistributionType = boost::random::uniform_int_distribution<
+                             typename CurveType::scalar_field_type::modulus_type>,
+                         typename GeneratorType = random_device_generator, typename InputProofIterator>
+                std::vector<std::size_t>
+                    validate_aggregate_proofs(InputProofIterator proofs_first,
+                                              InputProofIterator proofs_last,
+                                              const std::size_t rounds = default_subgroup_check_rounds) {
+                    detail::proof_points<CurveType, DistributionType, GeneratorType> points(
+                        std::distance(proofs_first, proofs_last));
+                    for (InputProofIterator it = proofs_first; it != proofs_last; ++it) {
+                        const r1cs_gg_ppzksnark_aggregate_proof<CurveType> &proof = detail::aggregate_proof_body(*it);
+                        points.next_proof(detail::aggregate_proof_is_consistent(*it));
+                        detail::add_aggregate_proof_points(points, proof);
+                    }
+                    return points.rejected(rounds);
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_PROOF_VALIDATION_HPP
@@ -26,30 +26,130 @@
 #ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_BASIC_PROVER_HPP
 #define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_BASIC_PROVER_HPP
 
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/relations/arithmetic_programs/qap_witness_buffer.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_const_padded_assignment.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_mapped_witness.hpp>
 
 #include <nil/crypto3/algebra/multiexp/multiexp.hpp>
 #include <nil/crypto3/algebra/multiexp/policies.hpp>
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/zk/snark/affine_point_vector.hpp>
+#include <nil/crypto3/zk/snark/execution_policy.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
 
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+#include <nil/crypto3/zk/snark/memory_budget.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/scalar_size_multiexp.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/detail/basic_policy.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_proving_key.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/multiexp_backend.hpp>
 
 namespace nil {
     namespace crypto3 {
         namespace zk {
             namespace snark {
 
+                /**
+                 * Convert a (non-processed) proving key into a processed proving key.
+                 *
+                 * The window parameter sizes the fixed-base tables: every query takes
+                 * ceil(scalar_bits / window) times its own memory, and a multi-exponentiation over it
+                 * costs one group addition per non-zero window digit. Use fixed_base_window_for_budget
+                 * to derive the window from a memory budget.
+                 */
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_process_proving_key {
+                    typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
+
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
+                public:
+                    typedef typename policy_type::constraint_system_type constraint_system_type;
+                    typedef typename policy_type::primary_input_type primary_input_type;
+                    typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
+
+                    typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
+                    typedef typename policy_type::verification_key_type verification_key_type;
+                    typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
+
+                    typedef typename policy_type::keypair_type keypair_type;
+                    typedef typename policy_type::proof_type proof_type;
+
+                    static constexpr const std::size_t default_window = 8;
+
+                    static inline processed_proving_key_type process(const proving_key_type &proving_key,
+                                                                     const std::size_t window = default_window) {
+                        return process(proving_key_type(proving_key), window);
+                    }
+
+                    static inline processed_proving_key_type process(proving_key_type &&proving_key,
+                                                                     const std::size_t window = default_window) {
+                        const std::size_t chunks = executor::current().concurrency();
+
+                        processed_proving_key_type processed_proving_key;
+                        processed_proving_key.proving_key = std::move(proving_key);
+
+                        const proving_key_type &pk = processed_proving_key.proving_key;
+
+                        std::vector<typename g2_type::value_type> B_query_g;
+                        std::vector<typename g1_type::value_type> B_query_h;
+                        B_query_g.reserve(pk.B_query.values.size());
+                        B_query_h.reserve(pk.B_query.values.size());
+                        for (const auto &value : pk.B_query.values) {
+                            B_query_g.emplace_back(value.g);
+                            B_query_h.emplace_back(value.h);
+                        }
+
+                        processed_proving_key.A_query_precomp = fixed_base_precompute<g1_type, scalar_field_type>(
+                            pk.A_query.begin(), pk.A_query.end(), window, chunks);
+                        processed_proving_key.B_query_g_precomp = fixed_base_precompute<g2_type, scalar_field_type>(
+                            B_query_g.begin(), B_query_g.end(), window, chunks);
+                        processed_proving_key.B_query_h_precomp = fixed_base_precompute<g1_type, scalar_field_type>(
+                            B_query_h.begin(), B_query_h.end(), window, chunks);
+                        processed_proving_key.H_query_precomp = fixed_base_precompute<g1_type, scalar_field_type>(
+                            pk.H_query.begin(), pk.H_query.end(), window, chunks);
+                        processed_proving_key.L_query_precomp = fixed_base_precompute<g1_type, scalar_field_type>(
+                            pk.L_query.begin(), pk.L_query.end(), window, chunks);
+                        processed_proving_key.precompute_delta_combs();
+                        processed_proving_key.context =
+                            reductions::r1cs_to_qap<scalar_field_type>::shared_context(pk.constraint_system);
+
+                        return processed_proving_key;
+                    }
+                };
+
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_distributed_prover;
+
+                template<typename CurveType, typename MultiexpBackend>
+                class r1cs_gg_ppzksnark_pipelined_prover;
+
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_incremental_prover;
+
                 /**
                  * A prover algorithm for the R1CS GG-ppzkSNARK.
                  *
@@ -62,6 +162,11 @@ namespace nil {
                 class r1cs_gg_ppzksnark_prover {
                     typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
 
+                    friend class r1cs_gg_ppzksnark_distributed_prover<CurveType>;
+                    template<typename, typename>
+                    friend class r1cs_gg_ppzksnark_pipelined_prover;
+                    friend class r1cs_gg_ppzksnark_incremental_prover<CurveType>;
+
                     typedef typename CurveType::scalar_field_type scalar_field_type;
                     typedef typename CurveType::g1_type g1_type;
                     typedef typename CurveType::g2_type g2_type;
@@ -71,8 +176,17 @@ namespace nil {
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
+                    typedef typename policy_type::compact_proving_key_type compact_proving_key_type;
+                    typedef typename policy_type::bytecode_proving_key_type bytecode_proving_key_type;
+                    typedef typename policy_type::mapped_proving_key_type mapped_proving_key_type;
+                    typedef typename policy_type::affine_proving_key_type affine_proving_key_type;
+                    typedef typename policy_type::sparse_proving_key_type sparse_proving_key_type;
+                    typedef typename policy_type::lagrange_proving_key_type lagrange_proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
                     typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
 
@@ -80,91 +194,1008 @@ namespace nil {
                     typedef typename policy_type::proof_type proof_type;
 
                     static inline proof_type process(const proving_key_type &proving_key,
-                                                     const primary_input_type &primary_input,
-                                                     const auxiliary_input_type &auxiliary_input) {
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+                        return basic_process(proving_key, primary_input, auxiliary_input);
+                    }
+
+                    /**
+                     * Produces a proof from a compact proving key, whose constraint system is replaced by
+                     * its compiled witness evaluation program.
+                     */
+                    static inline proof_type process(const compact_proving_key_type &proving_key,
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+                        return basic_process(proving_key, primary_input, auxiliary_input);
+                    }
+
+                    /**
+                     * Produces a proof from a proving key whose constraint system is replaced by the
+                     * bytecode of its matrices, which the witness map runs row by row.
+                     */
+                    static inline proof_type process(const bytecode_proving_key_type &proving_key,
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+                        return basic_process(proving_key, primary_input, auxiliary_input);
+                    }
+
+                    /**
+                     * Produces a proof from a proving key with packed affine G1 queries, which are
+                     * expanded window by window as the multi-exponentiations read them.
+                     */
+                    static inline proof_type process(const affine_proving_key_type &proving_key,
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+                        return basic_process(proving_key, primary_input, auxiliary_input);
+                    }
+
+                    /**
+                     * Produces a proof from a proving key with a sparse A_query, whose multi-exponentiation
+                     * only visits the variables with a non-zero A_i(t).
+                     */
+                    static inline proof_type process(const sparse_proving_key_type &proving_key,
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+                        return basic_process(proving_key, primary_input, auxiliary_input);
+                    }
+
+                    /**
+                     * Produces a proof from a proving key whose H_query is in the Lagrange basis of the
+                     * coset: the H_query multi-exponentiation runs on the evaluations of H on the coset,
+                     * without the inverse FFT and the coset pass of the witness map.
+                     */
+                    static inline proof_type process(const lagrange_proving_key_type &lagrange_proving_key,
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+                        return basic_process(lagrange_proving_key.proving_key, primary_input, auxiliary_input,
+                                             std::true_type());
+                    }
+
+                    static inline proof_type process(const processed_proving_key_type &processed_proving_key,
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+
+                        const proving_key_type &proving_key = processed_proving_key.proving_key;
 
                         BOOST_ASSERT(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
 
+                        stage_profiler::timer witness_timer("witness_map",
+                                                            proving_key.constraint_system.num_constraints());
                         const qap_witness<scalar_field_type> qap_wit =
                             reductions::r1cs_to_qap<scalar_field_type>::witness_map(
                                 proving_key.constraint_system, primary_input, auxiliary_input,
-                                scalar_field_type::value_type::zero(), scalar_field_type::value_type::zero(),
-                                scalar_field_type::value_type::zero());
+                                *context_of(processed_proving_key));
+                        witness_timer.stop();
 
-                        /* We are dividing degree 2(d-1) polynomial by degree d polynomial
-                           and not adding a PGHR-style ZK-patch, so our H is degree d-2 */
-                        // BOOST_ASSERT(!qap_wit.coefficients_for_H[qap_wit.degree - 2].is_zero());
                         BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree - 1].is_zero());
                         BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree].is_zero());
 
-                        /* Choose two random field elements for prover zero-knowledge. */
-                        const typename scalar_field_type::value_type r = algebra::random_element<scalar_field_type>();
-                        const typename scalar_field_type::value_type s = algebra::random_element<scalar_field_type>();
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                             // var or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
-
-                        // TODO: sort out indexing
-                        std::vector<typename scalar_field_type::value_type> const_padded_assignment(
-                            1, scalar_field_type::value_type::one());
-                        const_padded_assignment.insert(const_padded_assignment.end(),
-                                                       qap_wit.coefficients_for_ABCs.begin(),
-                                                       qap_wit.coefficients_for_ABCs.end());
+                        const std::size_t chunks = executor::current().concurrency();
+                        stage_profiler::timer multiexp_timer("multiexp", qap_wit.num_variables + 1);
+                        count_exp_terms(qap_wit.num_variables, qap_wit.num_inputs, qap_wit.degree);
+
+                        const r1cs_const_padded_assignment<scalar_field_type> const_padded_assignment(
+                            qap_wit.coefficients_for_ABCs);
 
                         typename g1_type::value_type evaluation_At =
-                            algebra::multiexp_with_mixed_addition<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.A_query.begin(),
-                                proving_key.A_query.begin() + qap_wit.num_variables + 1,
-                                const_padded_assignment.begin(),
-                                const_padded_assignment.begin() + qap_wit.num_variables + 1,
-                                chunks);
+                            fixed_base_multiexp(processed_proving_key.A_query_precomp,
+                                                const_padded_assignment.begin(),
+                                                const_padded_assignment.begin() + qap_wit.num_variables + 1,
+                                                chunks);
 
-                        typename knowledge_commitment<g2_type, g1_type>::value_type evaluation_Bt =
-                            kc_multiexp_with_mixed_addition<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.B_query,
-                                0,
-                                qap_wit.num_variables + 1,
-                                const_padded_assignment.begin(),
-                                const_padded_assignment.begin() + qap_wit.num_variables + 1,
-                                chunks);
+                        typename knowledge_commitment<g2_type, g1_type>::value_type evaluation_Bt(
+                            fixed_base_sparse_multiexp(processed_proving_key.B_query_g_precomp,
+                                                       proving_key.B_query.indices, 0, qap_wit.num_variables + 1,
+                                                       const_padded_assignment.begin(),
+                                                       const_padded_assignment.begin() + qap_wit.num_variables + 1,
+                                                       chunks),
+                            fixed_base_sparse_multiexp(processed_proving_key.B_query_h_precomp,
+                                                       proving_key.B_query.indices, 0, qap_wit.num_variables + 1,
+                                                       const_padded_assignment.begin(),
+                                                       const_padded_assignment.begin() + qap_wit.num_variables + 1,
+                                                       chunks));
 
                         typename g1_type::value_type evaluation_Ht =
-                            algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.H_query.begin(),
-                                proving_key.H_query.begin() + (qap_wit.degree - 1),
-                                qap_wit.coefficients_for_H.begin(),
-                                qap_wit.coefficients_for_H.begin() + (qap_wit.degree - 1),
-                                chunks);
+                            fixed_base_multiexp(processed_proving_key.H_query_precomp,
+                                                qap_wit.coefficients_for_H.begin(),
+                                                qap_wit.coefficients_for_H.begin() + (qap_wit.degree - 1),
+                                                chunks);
 
                         typename g1_type::value_type evaluation_Lt =
-                            algebra::multiexp_with_mixed_addition<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.L_query.begin(),
-                                proving_key.L_query.end(),
-                                const_padded_assignment.begin() + qap_wit.num_inputs + 1,
-                                const_padded_assignment.begin() + qap_wit.num_variables + 1,
-                                chunks);
+                            fixed_base_multiexp(processed_proving_key.L_query_precomp,
+                                                qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_inputs,
+                                                qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables,
+                                                chunks);
+
+                        return make_proof(processed_proving_key, evaluation_At, evaluation_Bt, evaluation_Ht,
+                                          evaluation_Lt);
+                    }
+
+                    /**
+                     * Produces a proof from a QAP witness computed elsewhere, e.g. read in place from a
+                     * qap_witness_buffer received from the node running the witness map: only the four
+                     * multi-exponentiations run here, split into tasks as in basic_process. Throws
+                     * std::invalid_argument if the witness does not fit proving_key.
+                     */
+                    static inline proof_type process_witness(const proving_key_type &proving_key,
+                                                             const qap_witness_view<scalar_field_type> &qap_wit) {
+
+                        typedef r1cs_const_padded_iterator<const typename scalar_field_type::value_type *>
+                            padded_iterator;
+
+                        const std::size_t num_variables = qap_wit.num_variables;
+                        const std::size_t num_inputs = qap_wit.num_inputs;
+                        const std::size_t num_H_terms = qap_wit.degree - 1;
+
+                        /* the witness comes from another node, so its sizes are checked in every build */
+                        if (num_variables != proving_key.constraint_system.num_variables() ||
+                            num_inputs != proving_key.constraint_system.num_inputs() ||
+                            qap_wit.coefficients_for_ABCs_size != num_variables || qap_wit.degree < 2 ||
+                            qap_wit.coefficients_for_H_size != qap_wit.degree + 1 ||
+                            proving_key.H_query.size() != num_H_terms) {
+                            throw std::invalid_argument(
+                                "r1cs_gg_ppzksnark_prover: the QAP witness does not fit the proving key");
+                        }
+                        if (!qap_wit.d1.is_zero() || !qap_wit.d2.is_zero() || !qap_wit.d3.is_zero()) {
+                            throw std::invalid_argument(
+                                "r1cs_gg_ppzksnark_prover: the QAP witness is not the one of d1 = d2 = d3 = 0");
+                        }
+
+                        const padded_iterator const_padded_assignment(qap_wit.coefficients_for_ABCs, 0);
+                        const typename scalar_field_type::value_type *assignment = qap_wit.coefficients_for_ABCs;
+                        const typename scalar_field_type::value_type *scalars_H = qap_wit.coefficients_for_H;
+
+                        multiexp_task_list tasks(
+                            (num_variables + 1) * (2 * multiexp_task_list::g1_cost + multiexp_task_list::g2_cost) +
+                                (num_H_terms + (num_variables - num_inputs)) * multiexp_task_list::g1_cost,
+                            max_task_cost(memory_budget::current()));
+                        count_exp_terms(num_variables, num_inputs, qap_wit.degree);
+
+                        std::vector<typename g1_type::value_type> parts_At, parts_Ht, parts_Lt;
+                        std::vector<typename knowledge_commitment<g2_type, g1_type>::value_type> parts_Bt;
+
+                        tasks.add(
+                            parts_Bt, num_variables + 1, multiexp_task_list::g1_cost + multiexp_task_list::g2_cost,
+                            [&](std::size_t first, std::size_t last) {
+                                return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                    proving_key.B_query, first, last, const_padded_assignment + first,
+                                    const_padded_assignment + last, 1);
+                            });
+
+                        tasks.add(parts_At, num_variables + 1, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return query_multiexp(std::true_type(), proving_key.A_query, first, last,
+                                                            const_padded_assignment + first);
+                                  });
+
+                        tasks.add(parts_Lt, num_variables - num_inputs, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return query_multiexp(std::true_type(), proving_key.L_query, first, last,
+                                                            assignment + num_inputs + first);
+                                  });
+
+                        tasks.add(parts_Ht, num_H_terms, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return query_multiexp(std::false_type(), proving_key.H_query, first, last,
+                                                            scalars_H + first);
+                                  });
+
+                        stage_profiler::timer multiexp_timer("multiexp", num_variables + 1);
+                        tasks.run();
+                        multiexp_timer.stop();
+
+                        return make_proof(proving_key, multiexp_task_list::sum(parts_At),
+                                          multiexp_task_list::sum(parts_Bt), multiexp_task_list::sum(parts_Ht),
+                                          multiexp_task_list::sum(parts_Lt));
+                    }
+
+                    /**
+                     * Produces a proof from a witness source, such as an r1cs_mapped_witness filled by
+                     * a witness generator running in another process, read in place.
+                     *
+                     * The A, B and L multi-exponentiations only read the variables of their terms, so
+                     * they run over each window of stream_window_size variables as soon as it is
+                     * committed, while the next ones are being written. The witness map needs every
+                     * constraint, hence the whole witness; it runs last, followed by the H_query
+                     * multi-exponentiation.
+                     */
+                    template<typename WitnessSource>
+                    static inline proof_type process_streamed(const proving_key_type &proving_key,
+                                                              const WitnessSource &witness) {
+
+                        typedef r1cs_const_padded_iterator<const typename scalar_field_type::value_type *>
+                            padded_iterator;
+
+                        const std::size_t num_variables = witness.num_variables();
+                        const std::size_t num_inputs = witness.num_inputs();
+                        BOOST_ASSERT(num_variables == proving_key.constraint_system.num_variables());
+                        BOOST_ASSERT(num_inputs == proving_key.constraint_system.num_inputs());
+
+                        const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain =
+                            reductions::r1cs_to_qap<scalar_field_type>::get_domain(proving_key.constraint_system);
+                        const std::size_t num_H_terms = domain->m - 1;
+                        const std::size_t task_cost = max_task_cost(memory_budget::current());
+                        count_exp_terms(num_variables, num_inputs, domain->m);
+
+                        typename g1_type::value_type evaluation_At = g1_type::value_type::zero();
+                        typename g1_type::value_type evaluation_Lt = g1_type::value_type::zero();
+                        typename knowledge_commitment<g2_type, g1_type>::value_type evaluation_Bt =
+                            knowledge_commitment<g2_type, g1_type>::value_type::zero();
+
+                        stage_profiler::timer multiexp_timer("multiexp", num_variables + 1);
+                        /* [first, last) are indices into the assignment padded with the constant 1, whose
+                           variable k > 0 is x_k; L_query[j] goes with x_{num_inputs + 1 + j} */
+                        for (std::size_t first = 0, last = 0; first <= num_variables; first = last) {
+                            last = std::min(num_variables + 1, first + stream_window_size);
+                            const padded_iterator const_padded_assignment(witness.wait_for(last - 1), 0);
+                            const std::size_t L_first = std::max(first, num_inputs + 1) - (num_inputs + 1);
+                            const std::size_t L_last = std::max(last, num_inputs + 1) - (num_inputs + 1);
+
+                            multiexp_task_list tasks(
+                                (last - first) * (2 * multiexp_task_list::g1_cost + multiexp_task_list::g2_cost) +
+                                    (L_last - L_first) * multiexp_task_list::g1_cost,
+                                task_cost);
+                            std::vector<typename g1_type::value_type> parts_At, parts_Lt;
+                            std::vector<typename knowledge_commitment<g2_type, g1_type>::value_type> parts_Bt;
+
+                            tasks.add(parts_Bt, last - first,
+                                      multiexp_task_list::g1_cost + multiexp_task_list::g2_cost,
+                                      [&](std::size_t f, std::size_t l) {
+                                          return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                              proving_key.B_query, first + f, first + l,
+                                              const_padded_assignment + first + f,
+                                              const_padded_assignment + first + l, 1);
+                                      });
+                            tasks.add(parts_At, last - first, multiexp_task_list::g1_cost,
+                                      [&](std::size_t f, std::size_t l) {
+                                          return query_multiexp(std::true_type(), proving_key.A_query, first + f,
+                                                                first + l, const_padded_assignment + first + f);
+                                      });
+                            if (L_first < L_last) {
+                                tasks.add(parts_Lt, L_last - L_first, multiexp_task_list::g1_cost,
+                                          [&](std::size_t f, std::size_t l) {
+                                              return query_multiexp(
+                                                  std::true_type(), proving_key.L_query, L_first + f, L_first + l,
+                                                  const_padded_assignment + (num_inputs + 1 + L_first + f));
+                                          });
+                            }
+                            tasks.run();
+
+                            evaluation_At = evaluation_At + multiexp_task_list::sum(parts_At);
+                            evaluation_Bt = evaluation_Bt + multiexp_task_list::sum(parts_Bt);
+                            evaluation_Lt = evaluation_Lt + multiexp_task_list::sum(parts_Lt);
+                        }
+                        multiexp_timer.stop();
+
+                        const r1cs_variable_assignment_span<scalar_field_type> full_variable_assignment(
+                            witness.wait_for(num_variables), num_variables);
+                        BOOST_ASSERT(proving_key.constraint_system.is_satisfied(
+                            full_variable_assignment.subspan(0, num_inputs),
+                            full_variable_assignment.subspan(num_inputs)));
+
+                        stage_profiler::timer witness_timer("witness_map",
+                                                            proving_key.constraint_system.num_constraints());
+                        const std::vector<typename scalar_field_type::value_type> scalars_H =
+                            H_scalars(std::false_type(), proving_key.constraint_system, full_variable_assignment,
+                                      domain);
+                        witness_timer.stop();
+
+                        BOOST_ASSERT(proving_key.H_query.size() == num_H_terms);
+                        multiexp_task_list tasks(num_H_terms * multiexp_task_list::g1_cost, task_cost);
+                        std::vector<typename g1_type::value_type> parts_Ht;
+                        tasks.add(parts_Ht, num_H_terms, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return query_multiexp(std::false_type(), proving_key.H_query, first, last,
+                                                            scalars_H.begin() + first);
+                                  });
+                        stage_profiler::timer multiexp_H_timer("multiexp_H", num_H_terms);
+                        tasks.run();
+                        multiexp_H_timer.stop();
+
+                        return make_proof(proving_key, evaluation_At, evaluation_Bt,
+                                          multiexp_task_list::sum(parts_Ht), evaluation_Lt);
+                    }
+
+                    /**
+                     * Produces a proof from a proving key made resident with a multi-exponentiation
+                     * backend: the witness map computes H with the FFT backend of MultiexpBackend, then
+                     * the backend evaluates the queries it holds against the assignment and H.
+                     */
+                    template<typename MultiexpBackend>
+                    static inline proof_type
+                        process(const r1cs_gg_ppzksnark_resident_proving_key<CurveType, MultiexpBackend> &resident_key,
+                                const primary_input_span_type &primary_input,
+                                const auxiliary_input_span_type &auxiliary_input) {
+
+                        typedef reductions::r1cs_to_qap<scalar_field_type, typename MultiexpBackend::fft_backend_type>
+                            reduction_type;
+
+                        const proving_key_type &proving_key = resident_key.proving_key;
+
+                        BOOST_ASSERT(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
+
+                        stage_profiler::timer witness_timer("witness_map",
+                                                            proving_key.constraint_system.num_constraints());
+                        const qap_witness<scalar_field_type> qap_wit = reduction_type::witness_map(
+                            proving_key.constraint_system, primary_input, auxiliary_input);
+                        witness_timer.stop();
+
+                        BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree - 1].is_zero());
+                        BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree].is_zero());
+
+                        stage_profiler::timer multiexp_timer("multiexp", qap_wit.num_variables + 1);
+                        count_exp_terms(qap_wit.num_variables, qap_wit.num_inputs, qap_wit.degree);
+
+                        const r1cs_const_padded_assignment<scalar_field_type> const_padded_assignment(
+                            qap_wit.coefficients_for_ABCs);
+
+                        typename g1_type::value_type evaluation_At = MultiexpBackend::multiexp_A(
+                            resident_key.queries, proving_key, const_padded_assignment.begin(),
+                            const_padded_assignment.begin() + qap_wit.num_variables + 1);
+
+                        typename knowledge_commitment<g2_type, g1_type>::value_type evaluation_Bt =
+                            MultiexpBackend::multiexp_B(resident_key.queries, proving_key,
+                                                        const_padded_assignment.begin(),
+                                                        const_padded_assignment.begin() + qap_wit.num_variables + 1);
+
+                        typename g1_type::value_type evaluation_Ht = MultiexpBackend::multiexp_H(
+                            resident_key.queries, proving_key, qap_wit.coefficients_for_H.begin(),
+                            qap_wit.coefficients_for_H.begin() + (qap_wit.degree - 1));
+
+                        typename g1_type::value_type evaluation_Lt = MultiexpBackend::multiexp_L(
+                            resident_key.queries, proving_key,
+                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_inputs,
+                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables);
+                        multiexp_timer.stop();
+
+                        return make_proof(proving_key, evaluation_At, evaluation_Bt, evaluation_Ht, evaluation_Lt);
+                    }
+
+                    /**
+                     * Proves every (primary input, auxiliary input) pair of [witnesses_first, witnesses_last)
+                     * for the same proving key.
+                     *
+                     * The evaluation domain is built once for the whole batch, and the multi-exponentiations
+                     * are run query by query, so consecutive multi-exponentiations share their bases.
+                     */
+                    template<typename InputWitnessIterator>
+                    static inline std::vector<proof_type> process_batch(const proving_key_type &proving_key,
+                                                                        InputWitnessIterator witnesses_first,
+                                                                        InputWitnessIterator witnesses_last) {
+                        const std::size_t chunks = executor::current().concurrency();
+                        const std::vector<qap_witness<scalar_field_type>> qap_wits =
+                            batch_witnesses(proving_key, witnesses_first, witnesses_last);
+                        stage_profiler::timer multiexp_timer("multiexp", qap_wits.size());
+                        std::vector<r1cs_const_padded_assignment<scalar_field_type>> padded_assignments;
+                        for (const qap_witness<scalar_field_type> &qap_wit : qap_wits) {
+                            padded_assignments.emplace_back(qap_wit.coefficients_for_ABCs);
+                        }
+                        const std::size_t batch_size = qap_wits.size();
+                        for (const qap_witness<scalar_field_type> &qap_wit : qap_wits) {
+                            count_exp_terms(qap_wit.num_variables, qap_wit.num_inputs, qap_wit.degree);
+                        }
+
+                        std::vector<typename g1_type::value_type> evaluations_At, evaluations_Ht, evaluations_Lt;
+                        std::vector<typename knowledge_commitment<g2_type, g1_type>::value_type> evaluations_Bt;
+
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_At.emplace_back(
+                                dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                    proving_key.A_query.begin(),
+                                    proving_key.A_query.begin() + qap_wits[i].num_variables + 1,
+                                    padded_assignments[i].begin(),
+                                    padded_assignments[i].begin() + qap_wits[i].num_variables + 1, chunks));
+                        }
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_Bt.emplace_back(
+                                kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                    proving_key.B_query, 0, qap_wits[i].num_variables + 1,
+                                    padded_assignments[i].begin(),
+                                    padded_assignments[i].begin() + qap_wits[i].num_variables + 1, chunks));
+                        }
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_Ht.emplace_back(dispatch_multiexp<multiexp_method_auto>(
+                                proving_key.H_query.begin(), proving_key.H_query.begin() + (qap_wits[i].degree - 1),
+                                qap_wits[i].coefficients_for_H.begin(),
+                                qap_wits[i].coefficients_for_H.begin() + (qap_wits[i].degree - 1), chunks));
+                        }
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_Lt.emplace_back(
+                                dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                    proving_key.L_query.begin(), proving_key.L_query.end(),
+                                    qap_wits[i].coefficients_for_ABCs.begin() + qap_wits[i].num_inputs,
+                                    qap_wits[i].coefficients_for_ABCs.begin() + qap_wits[i].num_variables, chunks));
+                        }
+
+                        std::vector<proof_type> proofs;
+                        proofs.reserve(batch_size);
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            proofs.emplace_back(make_proof(proving_key, evaluations_At[i], evaluations_Bt[i],
+                                                           evaluations_Ht[i], evaluations_Lt[i]));
+                        }
+
+                        return proofs;
+                    }
+
+                    /**
+                     * Proves every (primary input, auxiliary input) pair of [witnesses_first, witnesses_last)
+                     * for the same processed proving key.
+                     *
+                     * Each precomputed table is traversed once for the whole batch: every base feeds the
+                     * buckets of all witnesses before the next base is loaded.
+                     */
+                    template<typename InputWitnessIterator>
+                    static inline std::vector<proof_type>
+                        process_batch(const processed_proving_key_type &processed_proving_key,
+                                      InputWitnessIterator witnesses_first, InputWitnessIterator witnesses_last) {
+                        const std::size_t chunks = executor::current().concurrency();
+                        typedef typename std::vector<typename scalar_field_type::value_type>::const_iterator
+                            scalar_iterator;
+                        typedef typename r1cs_const_padded_assignment<scalar_field_type>::const_iterator
+                            padded_scalar_iterator;
+
+                        const proving_key_type &proving_key = processed_proving_key.proving_key;
+
+                        const std::vector<qap_witness<scalar_field_type>> qap_wits = batch_witnesses(
+                            proving_key, *context_of(processed_proving_key), witnesses_first, witnesses_last);
+                        std::vector<r1cs_const_padded_assignment<scalar_field_type>> padded_assignments;
+                        for (const qap_witness<scalar_field_type> &qap_wit : qap_wits) {
+                            padded_assignments.emplace_back(qap_wit.coefficients_for_ABCs);
+                        }
+                        const std::size_t batch_size = qap_wits.size();
+                        if (!batch_size) {
+                            return {};
+                        }
+                        stage_profiler::timer multiexp_timer("multiexp", batch_size);
 
+                        const std::size_t num_variables = qap_wits[0].num_variables;
+                        const std::size_t num_inputs = qap_wits[0].num_inputs;
+                        const std::size_t degree = qap_wits[0].degree;
+                        count_exp_terms(num_variables, num_inputs, degree, batch_size);
+
+                        std::vector<padded_scalar_iterator> assignments;
+                        std::vector<scalar_iterator> inputs_shifted, coefficients_for_H;
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            assignments.emplace_back(padded_assignments[i].begin());
+                            inputs_shifted.emplace_back(qap_wits[i].coefficients_for_ABCs.cbegin() + num_inputs);
+                            coefficients_for_H.emplace_back(qap_wits[i].coefficients_for_H.cbegin());
+                        }
+
+                        const std::vector<typename g1_type::value_type> evaluations_At = fixed_base_multiexp_batch(
+                            processed_proving_key.A_query_precomp, assignments, num_variables + 1, chunks);
+                        const std::vector<typename g2_type::value_type> evaluations_Bt_g =
+                            fixed_base_sparse_multiexp_batch(processed_proving_key.B_query_g_precomp,
+                                                             proving_key.B_query.indices, 0, num_variables + 1,
+                                                             assignments, chunks);
+                        const std::vector<typename g1_type::value_type> evaluations_Bt_h =
+                            fixed_base_sparse_multiexp_batch(processed_proving_key.B_query_h_precomp,
+                                                             proving_key.B_query.indices, 0, num_variables + 1,
+                                                             assignments, chunks);
+                        const std::vector<typename g1_type::value_type> evaluations_Ht = fixed_base_multiexp_batch(
+                            processed_proving_key.H_query_precomp, coefficients_for_H, degree - 1, chunks);
+                        const std::vector<typename g1_type::value_type> evaluations_Lt =
+                            fixed_base_multiexp_batch(processed_proving_key.L_query_precomp, inputs_shifted,
+                                                      num_variables - num_inputs, chunks);
+
+                        std::vector<proof_type> proofs;
+                        proofs.reserve(batch_size);
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            proofs.emplace_back(make_proof(
+                                processed_proving_key, evaluations_At[i],
+                                typename knowledge_commitment<g2_type, g1_type>::value_type(evaluations_Bt_g[i],
+                                                                                            evaluations_Bt_h[i]),
+                                evaluations_Ht[i], evaluations_Lt[i]));
+                        }
+
+                        return proofs;
+                    }
+
+                    /**
+                     * Produces a proof from a memory-mapped proving key.
+                     *
+                     * The multi-exponentiations walk the mapped sections in windows of
+                     * stream_window_size bases, so only the window being processed has to be resident.
+                     * Within a memory budget, the windows shrink so that they fit besides the witness.
+                     */
+                    static inline proof_type process(const mapped_proving_key_type &proving_key,
+                                                     const primary_input_span_type &primary_input,
+                                                     const auxiliary_input_span_type &auxiliary_input) {
+
+                        BOOST_ASSERT(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
+
+                        stage_profiler::timer witness_timer("witness_map",
+                                                            proving_key.constraint_system.num_constraints());
+                        const qap_witness<scalar_field_type> qap_wit =
+                            reductions::r1cs_to_qap<scalar_field_type>::witness_map(
+                                proving_key.constraint_system, primary_input, auxiliary_input);
+                        witness_timer.stop();
+
+                        BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree - 1].is_zero());
+                        BOOST_ASSERT(qap_wit.coefficients_for_H[qap_wit.degree].is_zero());
+
+                        const std::size_t chunks = executor::current().concurrency();
+                        stage_profiler::timer multiexp_timer("multiexp", qap_wit.num_variables + 1);
+                        count_exp_terms(qap_wit.num_variables, qap_wit.num_inputs, qap_wit.degree);
+
+                        const r1cs_const_padded_assignment<scalar_field_type> const_padded_assignment(
+                            qap_wit.coefficients_for_ABCs);
+
+                        const std::size_t held_size = (qap_wit.num_variables + 1 + qap_wit.degree + 1) * scalar_size;
+                        const std::size_t window = stream_window(held_size, sizeof(typename g1_type::value_type));
+                        const std::size_t B_window = stream_window(
+                            held_size, sizeof(typename g2_type::value_type) + sizeof(typename g1_type::value_type));
+
+                        typename g1_type::value_type evaluation_At = streamed_multiexp<g1_type>(
+                            proving_key.A_query_begin(), proving_key.A_query_begin() + qap_wit.num_variables + 1,
+                            const_padded_assignment.begin(), window, chunks);
+
+                        /* B_query is sparse: gather the scalars of each window of stored indices */
+                        typename knowledge_commitment<g2_type, g1_type>::value_type evaluation_Bt =
+                            knowledge_commitment<g2_type, g1_type>::value_type::zero();
+                        const std::size_t B_query_size =
+                            std::lower_bound(proving_key.B_query_indices_begin(), proving_key.B_query_indices_end(),
+                                             std::uint64_t(qap_wit.num_variables + 1)) -
+                            proving_key.B_query_indices_begin();
+                        std::vector<typename scalar_field_type::value_type> B_scalars;
+                        for (std::size_t first = 0; first < B_query_size; first += B_window) {
+                            const std::size_t last = std::min(B_query_size, first + B_window);
+                            B_scalars.clear();
+                            for (std::size_t i = first; i < last; ++i) {
+                                B_scalars.emplace_back(
+                                    const_padded_assignment[proving_key.B_query_indices_begin()[i]]);
+                            }
+                            evaluation_Bt.g = evaluation_Bt.g + dispatch_multiexp<multiexp_method_auto>(
+                                                                    proving_key.B_query_g_begin() + first,
+                                                                    proving_key.B_query_g_begin() + last,
+                                                                    B_scalars.begin(), B_scalars.end(), chunks);
+                            evaluation_Bt.h = evaluation_Bt.h + dispatch_multiexp<multiexp_method_auto>(
+                                                                    proving_key.B_query_h_begin() + first,
+                                                                    proving_key.B_query_h_begin() + last,
+                                                                    B_scalars.begin(), B_scalars.end(), chunks);
+                        }
+
+                        typename g1_type::value_type evaluation_Ht = streamed_multiexp<g1_type>(
+                            proving_key.H_query_begin(), proving_key.H_query_begin() + (qap_wit.degree - 1),
+                            qap_wit.coefficients_for_H.begin(), window, chunks);
+
+                        typename g1_type::value_type evaluation_Lt = streamed_multiexp<g1_type>(
+                            proving_key.L_query_begin(), proving_key.L_query_end(),
+                            qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_inputs, window, chunks);
+
+                        /* Choose two random field elements for prover zero-knowledge. */
+                        const typename scalar_field_type::value_type r = algebra::random_element<scalar_field_type>();
+                        const typename scalar_field_type::value_type s = algebra::random_element<scalar_field_type>();
+
+                        typename g1_type::value_type g1_A =
+                            proving_key.alpha_g1() + evaluation_At + secret_mul(proving_key.delta_g1(), r);
+
+                        typename g1_type::value_type g1_B =
+                            proving_key.beta_g1() + evaluation_Bt.h + secret_mul(proving_key.delta_g1(), s);
+                        typename g2_type::value_type g2_B =
+                            proving_key.beta_g2() + evaluation_Bt.g + secret_mul(proving_key.delta_g2(), s);
+
+                        typename g1_type::value_type g1_C = evaluation_Ht + evaluation_Lt + secret_mul(g1_A, s) +
+                                                            secret_mul(g1_B, r) -
+                                                            secret_mul(proving_key.delta_g1(), r * s);
+
+                        return proof_type(std::move(g1_A), std::move(g2_B), std::move(g1_C));
+                    }
+
+                private:
+                    /**
+                     * The four multi-exponentiations are split into tasks of similar cost and run together
+                     * on the current executor, so the small ones fill the cores the large G2 part of B_query
+                     * leaves idle. They only depend on the variable assignment, except for the one over
+                     * H_query: its scalars come from the FFTs of the witness map, which run meanwhile on a
+                     * thread of their own, with an executor on a share of the threads, see
+                     * multiexp_task_list::add_alongside; the H_query tasks follow once H is known.
+                     *
+                     * LagrangeH is std::true_type for an H_query in the Lagrange basis of the coset, see
+                     * H_scalars.
+                     */
+                    template<typename ProvingKeyType, typename LagrangeH = std::false_type>
+                    static inline proof_type basic_process(const ProvingKeyType &proving_key,
+                                                           const primary_input_span_type &primary_input,
+                                                           const auxiliary_input_span_type &auxiliary_input,
+                                                           LagrangeH lagrange_H = LagrangeH()) {
+
+                        typedef r1cs_const_padded_iterator<const typename scalar_field_type::value_type *>
+                            padded_iterator;
+
+                        BOOST_ASSERT(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
+
+                        /* the multi-exponentiations read the assignment as one sequence: inputs that already
+                           are, e.g. the two parts of one buffer, are read in place, others are joined once */
+                        r1cs_variable_assignment<scalar_field_type> joined_assignment;
+                        r1cs_variable_assignment_span<scalar_field_type> full_variable_assignment;
+                        if (!join_adjacent(primary_input, auxiliary_input, full_variable_assignment)) {
+                            joined_assignment.reserve(primary_input.size() + auxiliary_input.size());
+                            joined_assignment.insert(joined_assignment.end(), primary_input.begin(),
+                                                     primary_input.end());
+                            joined_assignment.insert(joined_assignment.end(), auxiliary_input.begin(),
+                                                     auxiliary_input.end());
+                            full_variable_assignment = joined_assignment;
+                        }
+                        const padded_iterator const_padded_assignment(full_variable_assignment.data(), 0);
+
+                        const std::size_t num_variables = full_variable_assignment.size();
+                        const std::size_t num_inputs = primary_input.size();
+
+                        const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain =
+                            reductions::r1cs_to_qap<scalar_field_type>::get_domain(proving_key.constraint_system);
+                        const std::size_t degree = domain->m;
+                        const std::size_t num_H_terms = LagrangeH::value ? degree : degree - 1;
+
+                        /* Within a memory budget, the assignment and H are held throughout and the witness
+                           map takes three more domain-sized vectors; it only runs alongside the multiexps
+                           if the smallest tasks still fit next to it. */
+                        const memory_budget &budget = memory_budget::current();
+                        const std::size_t held_size = (num_variables + 1 + degree + 1) * scalar_size;
+                        const std::size_t witness_map_size = 3 * degree * scalar_size;
+                        const bool overlap_witness_map =
+                            budget.fits(held_size + witness_map_size + min_task_terms * concurrent_task_term_size());
+
+                        multiexp_task_list tasks(
+                            (num_variables + 1) * (2 * multiexp_task_list::g1_cost + multiexp_task_list::g2_cost) +
+                                (num_H_terms + (num_variables - num_inputs)) * multiexp_task_list::g1_cost,
+                            max_task_cost(budget.remaining(held_size + (overlap_witness_map ? witness_map_size : 0))));
+                        count_exp_terms(num_variables, num_inputs, num_H_terms + 1);
+
+                        std::vector<typename scalar_field_type::value_type> scalars_H;
+                        std::vector<typename g1_type::value_type> parts_At, parts_Ht, parts_Lt;
+                        std::vector<typename knowledge_commitment<g2_type, g1_type>::value_type> parts_Bt;
+
+                        /* the witness map, three FFTs and three coset FFTs and an inverse one for the
+                           coefficients, runs on its own executor alongside the assignment-only multiexps */
+                        tasks.add_alongside(
+                            [&]() {
+                                stage_profiler::timer witness_timer("witness_map",
+                                                                    proving_key.constraint_system.num_constraints());
+                                scalars_H = H_scalars(lagrange_H, proving_key.constraint_system,
+                                                      full_variable_assignment, domain);
+                            },
+                            multiexp_task_list::fft_cost(degree, LagrangeH::value ? 6 : 7));
+                        if (!overlap_witness_map) {
+                            tasks.run();
+                        }
+
+                        tasks.add(
+                            parts_Bt, num_variables + 1, multiexp_task_list::g1_cost + multiexp_task_list::g2_cost,
+                            [&](std::size_t first, std::size_t last) {
+                                return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                    proving_key.B_query, first, last, const_padded_assignment + first,
+                                    const_padded_assignment + last, 1);
+                            });
+
+                        tasks.add(parts_At, num_variables + 1, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return query_multiexp(std::true_type(), proving_key.A_query, first, last,
+                                                            const_padded_assignment + first);
+                                  });
+
+                        tasks.add(parts_Lt, num_variables - num_inputs, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return query_multiexp(std::true_type(), proving_key.L_query, first, last,
+                                                            full_variable_assignment.begin() + num_inputs + first);
+                                  });
+
+                        stage_profiler::timer multiexp_timer("multiexp", num_variables + 1);
+                        tasks.run();
+                        multiexp_timer.stop();
+
+                        /* the H_query tasks only read H */
+                        r1cs_variable_assignment<scalar_field_type>().swap(joined_assignment);
+
+                        BOOST_ASSERT(proving_key.H_query.size() == num_H_terms);
+                        tasks.add(parts_Ht, num_H_terms, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return query_multiexp(std::false_type(), proving_key.H_query, first, last,
+                                                            scalars_H.begin() + first);
+                                  });
+                        stage_profiler::timer multiexp_H_timer("multiexp_H", num_H_terms);
+                        tasks.run();
+                        multiexp_H_timer.stop();
+
+                        return make_proof(proving_key, multiexp_task_list::sum(parts_At),
+                                          multiexp_task_list::sum(parts_Bt), multiexp_task_list::sum(parts_Ht),
+                                          multiexp_task_list::sum(parts_Lt));
+                    }
+
+                    /* Coefficients of H, the scalars of an H_query t^i * Z(t) / delta. */
+                    template<typename ConstraintSystemType>
+                    static inline std::vector<typename scalar_field_type::value_type>
+                        H_scalars(std::false_type, const ConstraintSystemType &constraint_system,
+                                  const r1cs_variable_assignment_span<scalar_field_type> &full_variable_assignment,
+                                  const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> &domain) {
+                        typename reductions::r1cs_to_qap<scalar_field_type>::workspace scratch;
+                        std::vector<typename scalar_field_type::value_type> coefficients_for_H =
+                            reductions::r1cs_to_qap<scalar_field_type>::coefficients_for_H(
+                                constraint_system, full_variable_assignment, domain, scratch);
+
+                        /* We are dividing degree 2(d-1) polynomial by degree d polynomial
+                           and not adding a PGHR-style ZK-patch, so our H is degree d-2 */
+                        // BOOST_ASSERT(!coefficients_for_H[domain->m - 2].is_zero());
+                        BOOST_ASSERT(coefficients_for_H[domain->m - 1].is_zero());
+                        BOOST_ASSERT(coefficients_for_H[domain->m].is_zero());
+
+                        return coefficients_for_H;
+                    }
+
+                    /* Evaluations of H on the coset g*S, the scalars of an H_query L_j(t / g) * Z(t) / delta. */
+                    static inline std::vector<typename scalar_field_type::value_type>
+                        H_scalars(std::true_type, const constraint_system_type &constraint_system,
+                                  const r1cs_variable_assignment_span<scalar_field_type> &full_variable_assignment,
+                                  const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> &domain) {
+                        typename reductions::r1cs_to_qap<scalar_field_type>::workspace scratch;
+                        return reductions::r1cs_to_qap<scalar_field_type>::evaluations_for_H_on_coset(
+                            constraint_system, full_variable_assignment, domain, scratch);
+                    }
+
+                    static constexpr const std::size_t stream_window_size = std::size_t(1) << 16;
+
+                    /* The fewest terms a task or a stream window is cut to within a memory budget. */
+                    static constexpr const std::size_t min_task_terms = 1024;
+
+                    static constexpr const std::size_t scalar_size = sizeof(typename scalar_field_type::value_type);
+
+                    /**
+                     * Working memory a multi-exponentiation term takes, a base and a scalar, times the
+                     * number of tasks running at once.
+                     */
+                    static inline std::size_t concurrent_task_term_size() {
+                        return executor::current().concurrency() * (sizeof(typename g1_type::value_type) + scalar_size);
+                    }
+
+                    /* The cost of a task whose working memory fits budget with the others running at once. */
+                    static inline std::size_t max_task_cost(const memory_budget &budget) {
+                        return budget.limited() ? budget.items(concurrent_task_term_size(), min_task_terms) *
+                                                      multiexp_task_list::g1_cost :
+                                                  memory_budget::unlimited;
+                    }
+
+                    /**
+                     * The number of bases a window of a memory-mapped proving key streams at once: every
+                     * base takes base_size bytes and a scalar, besides held_size bytes of the prover.
+                     */
+                    static inline std::size_t stream_window(const std::size_t held_size, const std::size_t base_size) {
+                        return std::min(stream_window_size, memory_budget::current()
+                                                                .remaining(held_size)
+                                                                .items(base_size + scalar_size, min_task_terms));
+                    }
+
+                    /* Counts the multi-exponentiation terms of num_proofs proofs over the same QAP. */
+                    static inline void count_exp_terms(const std::size_t num_variables, const std::size_t num_inputs,
+                                                       const std::size_t degree, const std::size_t num_proofs = 1) {
+                        /* A, the G1 part of B, H and L over G1; the G2 part of B over G2 */
+                        operation_counter::add(operation_counter::g1_exp_term,
+                                               num_proofs * (2 * (num_variables + 1) + (degree - 1) +
+                                                             (num_variables - num_inputs)));
+                        operation_counter::add(operation_counter::g2_exp_term, num_proofs * (num_variables + 1));
+                    }
+
+                    /* Multi-exponentiation over [bases_first, bases_last), one window of bases at a time. */
+                    template<typename GroupType, typename InputBaseIterator, typename InputFieldIterator>
+                    static inline typename GroupType::value_type streamed_multiexp(InputBaseIterator bases_first,
+                                                                                   InputBaseIterator bases_last,
+                                                                                   InputFieldIterator scalars_first,
+                                                                                   const std::size_t window,
+                                                                                   const std::size_t chunks) {
+                        typename GroupType::value_type result = GroupType::value_type::zero();
+                        const std::size_t size = std::distance(bases_first, bases_last);
+
+                        for (std::size_t first = 0; first < size; first += window) {
+                            const std::size_t last = std::min(size, first + window);
+                            result = result + dispatch_multiexp<multiexp_method_auto>(
+                                                  bases_first + first, bases_first + last, scalars_first + first,
+                                                  scalars_first + last, chunks);
+                        }
+
+                        return result;
+                    }
+
+                    /**
+                     * Single-threaded multi-exponentiation, using mixed addition when tagged std::true_type.
+                     * The assignment scalars are then partitioned after their sizes, so the bits and small
+                     * integers of the witness skip the full-width windows, see scalar_size_multiexp.hpp.
+                     */
+                    template<typename InputBaseIterator, typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        window_multiexp(std::true_type, InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                        InputFieldIterator scalars_first, InputFieldIterator scalars_last) {
+                        return scalar_size_multiexp(
+                            bases_first, scalars_first, scalars_last,
+                            scalar_size_partition::classify(scalars_first, scalars_last), 1,
+                            [&](auto wide_scalars_first, auto wide_scalars_last) {
+                                return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                    bases_first, bases_last, wide_scalars_first, wide_scalars_last, 1);
+                            });
+                    }
+
+                    template<typename InputBaseIterator, typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        window_multiexp(std::false_type, InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                        InputFieldIterator scalars_first, InputFieldIterator scalars_last) {
+                        return dispatch_multiexp<multiexp_method_auto>(bases_first, bases_last, scalars_first,
+                                                                       scalars_last, 1);
+                    }
+
+                    /* Multi-exponentiation over the bases [first, last) of a G1 query. */
+                    template<typename MixedAddition, typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        query_multiexp(MixedAddition mixed_addition,
+                                       const std::vector<typename g1_type::value_type> &query, const std::size_t first,
+                                       const std::size_t last, InputFieldIterator scalars_first) {
+                        return window_multiexp(mixed_addition, query.begin() + first, query.begin() + last,
+                                               scalars_first, scalars_first + (last - first));
+                    }
+
+                    /* The packed affine bases are expanded into a reused buffer, one window at a time. */
+                    template<typename MixedAddition, typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        query_multiexp(MixedAddition mixed_addition, const affine_point_vector<g1_type> &query,
+                                       const std::size_t first, const std::size_t last,
+                                       InputFieldIterator scalars_first) {
+                        typename g1_type::value_type result = g1_type::value_type::zero();
+                        std::vector<typename g1_type::value_type> window;
+
+                        for (std::size_t window_first = first; window_first < last;
+                             window_first += stream_window_size) {
+                            const std::size_t window_last = std::min(last, window_first + stream_window_size);
+                            query.decode(window_first, window_last, window);
+                            result = result + window_multiexp(mixed_addition, window.begin(), window.end(),
+                                                              scalars_first + (window_first - first),
+                                                              scalars_first + (window_last - first));
+                        }
+
+                        return result;
+                    }
+
+                    /* Only the stored bases of a sparse query are visited; the mixed addition tag is implied. */
+                    template<typename MixedAddition, typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        query_multiexp(MixedAddition, const sparse_vector<g1_type> &query, const std::size_t first,
+                                       const std::size_t last, InputFieldIterator scalars_first) {
+                        return sparse_multiexp_with_mixed_addition<multiexp_method_auto>(query, first, last,
+                                                                                         scalars_first, 1);
+                    }
+
+                    /* Combines the query evaluations of a single witness into a proof. */
+                    template<typename ProvingKeyType>
+                    static inline proof_type
+                        make_proof(const ProvingKeyType &proving_key,
+                                   const typename g1_type::value_type &evaluation_At,
+                                   const typename knowledge_commitment<g2_type, g1_type>::value_type &evaluation_Bt,
+                                   const typename g1_type::value_type &evaluation_Ht,
+                                   const typename g1_type::value_type &evaluation_Lt) {
+                        /* Choose two random field elements for prover zero-knowledge. */
+                        const typename scalar_field_type::value_type r = algebra::random_element<scalar_field_type>();
+                        const typename scalar_field_type::value_type s = algebra::random_element<scalar_field_type>();
+
+                        return make_proof(proving_key, evaluation_At, evaluation_Bt, evaluation_Ht, evaluation_Lt, r,
+                                          s, {secret_mul(proving_key.delta_g1, r), secret_mul(proving_key.delta_g1, s),
+                                              secret_mul(proving_key.delta_g1, r * s)},
+                                          secret_mul(proving_key.delta_g2, s));
+                    }
+
+                    /**
+                     * make_proof over the combs of delta of a processed proving key: the three multiples of
+                     * delta_g1 are read in a single pass over its comb, with no doublings. Keys processed
+                     * without the combs take the generic scalar multiplications.
+                     */
+                    static inline proof_type
+                        make_proof(const processed_proving_key_type &processed_proving_key,
+                                   const typename g1_type::value_type &evaluation_At,
+                                   const typename knowledge_commitment<g2_type, g1_type>::value_type &evaluation_Bt,
+                                   const typename g1_type::value_type &evaluation_Ht,
+                                   const typename g1_type::value_type &evaluation_Lt) {
+                        if (processed_proving_key.delta_g1_comb.empty() ||
+                            processed_proving_key.delta_g2_comb.empty()) {
+                            return make_proof(processed_proving_key.proving_key, evaluation_At, evaluation_Bt,
+                                              evaluation_Ht, evaluation_Lt);
+                        }
+
+                        /* Choose two random field elements for prover zero-knowledge. */
+                        const typename scalar_field_type::value_type r = algebra::random_element<scalar_field_type>();
+                        const typename scalar_field_type::value_type s = algebra::random_element<scalar_field_type>();
+
+                        return make_proof(
+                            processed_proving_key.proving_key, evaluation_At, evaluation_Bt, evaluation_Ht,
+                            evaluation_Lt, r, s,
+                            constant_time_execution::scalar_mul<scalar_field_type>(
+                                processed_proving_key.delta_g1_comb,
+                                std::array<typename scalar_field_type::value_type, 3> {r, s, r * s}),
+                            constant_time_execution::scalar_mul<scalar_field_type>(
+                                processed_proving_key.delta_g2_comb,
+                                std::array<typename scalar_field_type::value_type, 1> {s})[0]);
+                    }
+
+                    /**
+                     * Combines the query evaluations of a single witness with the randomness r and s into a
+                     * proof, delta_g1_multiples being r, s and r * s times delta_g1.
+                     */
+                    template<typename ProvingKeyType>
+                    static inline proof_type
+                        make_proof(const ProvingKeyType &proving_key,
+                                   const typename g1_type::value_type &evaluation_At,
+                                   const typename knowledge_commitment<g2_type, g1_type>::value_type &evaluation_Bt,
+                                   const typename g1_type::value_type &evaluation_Ht,
+                                   const typename g1_type::value_type &evaluation_Lt,
+                                   const typename scalar_field_type::value_type &r,
+                                   const typename scalar_field_type::value_type &s,
+                                   const std::array<typename g1_type::value_type, 3> &delta_g1_multiples,
+                                   const typename g2_type::value_type &s_delta_g2) {
                         /* A = alpha + sum_i(a_i*A_i(t)) + r*delta */
                         typename g1_type::value_type g1_A =
-                            proving_key.alpha_g1 + evaluation_At + r * proving_key.delta_g1;
+                            proving_key.alpha_g1 + evaluation_At + delta_g1_multiples[0];
 
                         /* B = beta + sum_i(a_i*B_i(t)) + s*delta */
                         typename g1_type::value_type g1_B =
-                            proving_key.beta_g1 + evaluation_Bt.h + s * proving_key.delta_g1;
-                        typename g2_type::value_type g2_B =
-                            proving_key.beta_g2 + evaluation_Bt.g + s * proving_key.delta_g2;
+                            proving_key.beta_g1 + evaluation_Bt.h + delta_g1_multiples[1];
+                        typename g2_type::value_type g2_B = proving_key.beta_g2 + evaluation_Bt.g + s_delta_g2;
 
                         /* C = sum_i(a_i*((beta*A_i(t) + alpha*B_i(t) + C_i(t)) + H(t)*Z(t))/delta) + A*s + r*b -
                          * r*s*delta
                          */
-                        typename g1_type::value_type g1_C =
-                            evaluation_Ht + evaluation_Lt + s * g1_A + r * g1_B - (r * s) * proving_key.delta_g1;
+                        typename g1_type::value_type g1_C = evaluation_Ht + evaluation_Lt + secret_mul(g1_A, s) +
+                                                            secret_mul(g1_B, r) - delta_g1_multiples[2];
 
                         return proof_type(std::move(g1_A), std::move(g2_B), std::move(g1_C));
                     }
+
+                    /**
+                     * scalar * point for the randomness of a proof, which must not leak through the
+                     * running time, see execution_policy.hpp.
+                     */
+                    template<typename GroupValueType>
+                    static inline GroupValueType secret_mul(const GroupValueType &point,
+                                                            const typename scalar_field_type::value_type &scalar) {
+                        return constant_time_execution::scalar_mul<scalar_field_type>(point, scalar);
+                    }
+
+                    /* QAP witnesses of a batch. */
+                    template<typename InputWitnessIterator>
+                    static inline std::vector<qap_witness<scalar_field_type>>
+                        batch_witnesses(const proving_key_type &proving_key, InputWitnessIterator witnesses_first,
+                                        InputWitnessIterator witnesses_last) {
+                        return batch_witnesses(
+                            proving_key,
+                            reductions::r1cs_to_qap<scalar_field_type>::get_domain(proving_key.constraint_system),
+                            witnesses_first, witnesses_last);
+                    }
+
+                    /* QAP witnesses of a batch, over the reduction context of the constraint system. */
+                    template<typename InputWitnessIterator>
+                    static inline std::vector<qap_witness<scalar_field_type>>
+                        batch_witnesses(const proving_key_type &proving_key,
+                                        const reductions::reduction_context<scalar_field_type> &context,
+                                        InputWitnessIterator witnesses_first, InputWitnessIterator witnesses_last) {
+                        /* all witness maps of the batch share the scratch buffers allocated by the first one */
+                        typename reductions::r1cs_to_qap<scalar_field_type>::workspace scratch;
+
+                        std::vector<qap_witness<scalar_field_type>> qap_wits;
+
+                        stage_profiler::timer witness_timer("witness_map",
+                                                            std::distance(witnesses_first, witnesses_last));
+                        for (InputWitnessIterator it = witnesses_first; it != witnesses_last; ++it) {
+                            BOOST_ASSERT(proving_key.constraint_system.is_satisfied(it->first, it->second));
+
+                            qap_wits.emplace_back(reductions::r1cs_to_qap<scalar_field_type>::witness_map(
+                                proving_key.constraint_system, it->first, it->second, context, scratch));
+                        }
+
+                        return qap_wits;
+                    }
+
+                    /* Reduction context of a processed proving key, built on the fly for keys processed without one. */
+                    static inline std::shared_ptr<const reductions::reduction_context<scalar_field_type>>
+                        context_of(const processed_proving_key_type &processed_proving_key) {
+                        if (processed_proving_key.context) {
+                            return processed_proving_key.context;
+                        }
+                        return std::make_shared<const reductions::reduction_context<scalar_field_type>>(
+                            reductions::r1cs_to_qap<scalar_field_type>::get_domain(
+                                processed_proving_key.proving_key.constraint_system));
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
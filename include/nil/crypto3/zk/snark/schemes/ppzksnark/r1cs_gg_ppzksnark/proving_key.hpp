@@ -27,11 +27,18 @@
 #define CRYPTO3_R1CS_GG_PPZKSNARK_PROVING_KEY_HPP
 
 #include <memory>
+#include <type_traits>
 
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
+#include <nil/crypto3/zk/snark/affine_point_vector.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+#include <nil/crypto3/zk/snark/sparse_vector.hpp>
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/reductions/reduction_context.hpp>
 
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_bytecode.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -50,7 +57,7 @@ namespace nil {
                     typename CurveType::g2_type::value_type delta_g2;
 
                     std::vector<typename CurveType::g1_type::value_type>
-                        A_query;    // this could be a sparse vector if we had multiexp for those
+                        A_query;    // see r1cs_gg_ppzksnark_sparse_proving_key for a sparse one
                     knowledge_commitment_vector<typename CurveType::g2_type, typename CurveType::g1_type> B_query;
                     std::vector<typename CurveType::g1_type::value_type> H_query;
                     std::vector<typename CurveType::g1_type::value_type> L_query;
@@ -78,6 +85,22 @@ namespace nil {
                         delta_g2(std::move(delta_g2)), A_query(std::move(A_query)), B_query(std::move(B_query)),
                         H_query(std::move(H_query)), L_query(std::move(L_query)), constraint_system(std::move(constraint_system)) {};
 
+                    /**
+                     * Converts a proving key over another constraint system representation, e.g. to
+                     * replace the constraint system by its compiled r1cs_witness_program or r1cs_bytecode.
+                     */
+                    template<typename OtherConstraintSystem,
+                             typename = typename std::enable_if<
+                                 !std::is_same<OtherConstraintSystem, ConstraintSystem>::value>::type>
+                    explicit r1cs_gg_ppzksnark_proving_key(
+                        r1cs_gg_ppzksnark_proving_key<CurveType, OtherConstraintSystem> &&other) :
+                        alpha_g1(std::move(other.alpha_g1)),
+                        beta_g1(std::move(other.beta_g1)), beta_g2(std::move(other.beta_g2)),
+                        delta_g1(std::move(other.delta_g1)), delta_g2(std::move(other.delta_g2)),
+                        A_query(std::move(other.A_query)), B_query(std::move(other.B_query)),
+                        H_query(std::move(other.H_query)), L_query(std::move(other.L_query)),
+                        constraint_system(other.constraint_system) {};
+
                     std::size_t G1_size() const {
                         return 1 + A_query.size() + B_query.domain_size() + H_query.size() + L_query.size();
                     }
@@ -109,6 +132,300 @@ namespace nil {
                                 this->L_query == other.L_query && this->constraint_system == other.constraint_system);
                     }
                 };
+
+                /**
+                 * A proving key extended with fixed-base precomputation of its queries.
+                 *
+                 * Each of A_query, B_query (both of its groups), H_query and L_query is expanded into
+                 * window-shifted multiples of its bases. The window width controls the trade-off:
+                 * a table takes ceil(scalar_bits / window) times the memory of its query.
+                 *
+                 * delta_g1 and delta_g2 are expanded into combs, see fixed_base_comb, for the
+                 * multiplications by the randomness of every proof.
+                 *
+                 * The reduction context of the constraint system is built with the tables, so the
+                 * witness maps of all the proofs share its domain and coset tables. It is derived
+                 * from the constraint system and left out of the comparison.
+                 */
+                template<typename CurveType,
+                         typename ConstraintSystem = r1cs_constraint_system<typename CurveType::scalar_field_type>>
+                struct r1cs_gg_ppzksnark_processed_proving_key {
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType, ConstraintSystem> proving_key_type;
+
+                    proving_key_type proving_key;
+
+                    fixed_base_precomputation<typename CurveType::g1_type> A_query_precomp;
+                    fixed_base_precomputation<typename CurveType::g2_type> B_query_g_precomp;
+                    fixed_base_precomputation<typename CurveType::g1_type> B_query_h_precomp;
+                    fixed_base_precomputation<typename CurveType::g1_type> H_query_precomp;
+                    fixed_base_precomputation<typename CurveType::g1_type> L_query_precomp;
+
+                    /* width of the windows of the combs, 2^window multiples being scanned per window */
+                    static constexpr const std::size_t delta_comb_window = 4;
+
+                    fixed_base_comb<typename CurveType::g1_type> delta_g1_comb;
+                    fixed_base_comb<typename CurveType::g2_type> delta_g2_comb;
+
+                    std::shared_ptr<const reductions::reduction_context<typename CurveType::scalar_field_type>> context;
+
+                    r1cs_gg_ppzksnark_processed_proving_key() = default;
+                    r1cs_gg_ppzksnark_processed_proving_key &
+                        operator=(const r1cs_gg_ppzksnark_processed_proving_key &other) = default;
+                    r1cs_gg_ppzksnark_processed_proving_key(const r1cs_gg_ppzksnark_processed_proving_key &other) =
+                        default;
+                    r1cs_gg_ppzksnark_processed_proving_key(r1cs_gg_ppzksnark_processed_proving_key &&other) =
+                        default;
+
+                    /* Expands delta_g1 and delta_g2 of proving_key into their combs. */
+                    void precompute_delta_combs() {
+                        typedef typename CurveType::scalar_field_type scalar_field_type;
+
+                        delta_g1_comb = fixed_base_comb_precompute<typename CurveType::g1_type, scalar_field_type>(
+                            proving_key.delta_g1, delta_comb_window);
+                        delta_g2_comb = fixed_base_comb_precompute<typename CurveType::g2_type, scalar_field_type>(
+                            proving_key.delta_g2, delta_comb_window);
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return proving_key.size_in_bits() + A_query_precomp.size_in_bits() +
+                               B_query_g_precomp.size_in_bits() + B_query_h_precomp.size_in_bits() +
+                               H_query_precomp.size_in_bits() + L_query_precomp.size_in_bits() +
+                               delta_g1_comb.size_in_bits() + delta_g2_comb.size_in_bits() +
+                               (context ? context->size_in_bits() : 0);
+                    }
+
+                    bool operator==(const r1cs_gg_ppzksnark_processed_proving_key &other) const {
+                        return (this->proving_key == other.proving_key &&
+                                this->A_query_precomp == other.A_query_precomp &&
+                                this->B_query_g_precomp == other.B_query_g_precomp &&
+                                this->B_query_h_precomp == other.B_query_h_precomp &&
+                                this->H_query_precomp == other.H_query_precomp &&
+                                this->L_query_precomp == other.L_query_precomp &&
+                                this->delta_g1_comb == other.delta_g1_comb &&
+                                this->delta_g2_comb == other.delta_g2_comb);
+                    }
+                };
+                /**
+                 * A proving key whose G1 queries A_query, H_query and L_query are stored as packed
+                 * affine points.
+                 *
+                 * It is obtained by converting a proving key once, after generation or loading.
+                 * B_query, which is sparse and partly over G2, is split into its G2 and G1 halves.
+                 */
+                template<typename CurveType,
+                         typename ConstraintSystem = r1cs_constraint_system<typename CurveType::scalar_field_type>>
+                struct r1cs_gg_ppzksnark_affine_proving_key {
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType, ConstraintSystem> proving_key_type;
+
+                    typename CurveType::g1_type::value_type alpha_g1;
+                    typename CurveType::g1_type::value_type beta_g1;
+                    typename CurveType::g2_type::value_type beta_g2;
+                    typename CurveType::g1_type::value_type delta_g1;
+                    typename CurveType::g2_type::value_type delta_g2;
+
+                    affine_point_vector<typename CurveType::g1_type> A_query;
+                    split_knowledge_commitment_vector<typename CurveType::g2_type, typename CurveType::g1_type>
+                        B_query;
+                    affine_point_vector<typename CurveType::g1_type> H_query;
+                    affine_point_vector<typename CurveType::g1_type> L_query;
+
+                    constraint_system_type constraint_system;
+
+                    r1cs_gg_ppzksnark_affine_proving_key() = default;
+                    r1cs_gg_ppzksnark_affine_proving_key &
+                        operator=(const r1cs_gg_ppzksnark_affine_proving_key &other) = default;
+                    r1cs_gg_ppzksnark_affine_proving_key(const r1cs_gg_ppzksnark_affine_proving_key &other) = default;
+                    r1cs_gg_ppzksnark_affine_proving_key(r1cs_gg_ppzksnark_affine_proving_key &&other) = default;
+
+                    explicit r1cs_gg_ppzksnark_affine_proving_key(const proving_key_type &other) :
+                        alpha_g1(other.alpha_g1), beta_g1(other.beta_g1), beta_g2(other.beta_g2),
+                        delta_g1(other.delta_g1), delta_g2(other.delta_g2), A_query(other.A_query),
+                        B_query(other.B_query), H_query(other.H_query), L_query(other.L_query),
+                        constraint_system(other.constraint_system) {};
+
+                    explicit r1cs_gg_ppzksnark_affine_proving_key(proving_key_type &&other) :
+                        alpha_g1(std::move(other.alpha_g1)), beta_g1(std::move(other.beta_g1)),
+                        beta_g2(std::move(other.beta_g2)), delta_g1(std::move(other.delta_g1)),
+                        delta_g2(std::move(other.delta_g2)), A_query(other.A_query),
+                        B_query(other.B_query), H_query(other.H_query), L_query(other.L_query),
+                        constraint_system(std::move(other.constraint_system)) {
+                        // the projective queries are released, only the packed ones are kept
+                        other.A_query = {};
+                        other.B_query = {};
+                        other.H_query = {};
+                        other.L_query = {};
+                    };
+
+                    /**
+                     * Expands the key back to its projective representation.
+                     */
+                    proving_key_type to_proving_key() const {
+                        return proving_key_type(typename CurveType::g1_type::value_type(alpha_g1),
+                                                typename CurveType::g1_type::value_type(beta_g1),
+                                                typename CurveType::g2_type::value_type(beta_g2),
+                                                typename CurveType::g1_type::value_type(delta_g1),
+                                                typename CurveType::g2_type::value_type(delta_g2),
+                                                A_query.to_vector(), B_query.to_knowledge_commitment_vector(),
+                                                H_query.to_vector(), L_query.to_vector(),
+                                                constraint_system_type(constraint_system));
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return A_query.size_in_bits() + B_query.size_in_bits() + H_query.size_in_bits() +
+                               L_query.size_in_bits() + 1 * CurveType::g1_type::value_bits +
+                               1 * CurveType::g2_type::value_bits;
+                    }
+
+                    bool operator==(const r1cs_gg_ppzksnark_affine_proving_key &other) const {
+                        return (this->alpha_g1 == other.alpha_g1 && this->beta_g1 == other.beta_g1 &&
+                                this->beta_g2 == other.beta_g2 && this->delta_g1 == other.delta_g1 &&
+                                this->delta_g2 == other.delta_g2 && this->A_query == other.A_query &&
+                                this->B_query == other.B_query && this->H_query == other.H_query &&
+                                this->L_query == other.L_query && this->constraint_system == other.constraint_system);
+                    }
+                };
+
+                /**
+                 * A proving key whose A_query is a sparse vector holding only its non-zero points.
+                 *
+                 * The point A_query[i] is zero whenever A_i(t) is, i.e. for every variable that no
+                 * constraint uses on its A side; such variables are dropped from the key and from the
+                 * A_query multi-exponentiation of the prover. It is obtained by converting a proving key.
+                 */
+                template<typename CurveType,
+                         typename ConstraintSystem = r1cs_constraint_system<typename CurveType::scalar_field_type>>
+                struct r1cs_gg_ppzksnark_sparse_proving_key {
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType, ConstraintSystem> proving_key_type;
+
+                    typename CurveType::g1_type::value_type alpha_g1;
+                    typename CurveType::g1_type::value_type beta_g1;
+                    typename CurveType::g2_type::value_type beta_g2;
+                    typename CurveType::g1_type::value_type delta_g1;
+                    typename CurveType::g2_type::value_type delta_g2;
+
+                    sparse_vector<typename CurveType::g1_type> A_query;
+                    knowledge_commitment_vector<typename CurveType::g2_type, typename CurveType::g1_type> B_query;
+                    std::vector<typename CurveType::g1_type::value_type> H_query;
+                    std::vector<typename CurveType::g1_type::value_type> L_query;
+
+                    constraint_system_type constraint_system;
+
+                    r1cs_gg_ppzksnark_sparse_proving_key() = default;
+                    r1cs_gg_ppzksnark_sparse_proving_key &
+                        operator=(const r1cs_gg_ppzksnark_sparse_proving_key &other) = default;
+                    r1cs_gg_ppzksnark_sparse_proving_key(const r1cs_gg_ppzksnark_sparse_proving_key &other) = default;
+                    r1cs_gg_ppzksnark_sparse_proving_key(r1cs_gg_ppzksnark_sparse_proving_key &&other) = default;
+
+                    explicit r1cs_gg_ppzksnark_sparse_proving_key(const proving_key_type &other) :
+                        alpha_g1(other.alpha_g1), beta_g1(other.beta_g1), beta_g2(other.beta_g2),
+                        delta_g1(other.delta_g1), delta_g2(other.delta_g2), A_query(sparse_A_query(other.A_query)),
+                        B_query(other.B_query), H_query(other.H_query), L_query(other.L_query),
+                        constraint_system(other.constraint_system) {};
+
+                    explicit r1cs_gg_ppzksnark_sparse_proving_key(proving_key_type &&other) :
+                        alpha_g1(std::move(other.alpha_g1)), beta_g1(std::move(other.beta_g1)),
+                        beta_g2(std::move(other.beta_g2)), delta_g1(std::move(other.delta_g1)),
+                        delta_g2(std::move(other.delta_g2)), A_query(sparse_A_query(other.A_query)),
+                        B_query(std::move(other.B_query)), H_query(std::move(other.H_query)),
+                        L_query(std::move(other.L_query)), constraint_system(std::move(other.constraint_system)) {
+                        other.A_query = {};
+                    };
+
+                    /**
+                     * Expands the key back to its dense representation.
+                     */
+                    proving_key_type to_proving_key() const {
+                        std::vector<typename CurveType::g1_type::value_type> dense_A_query(
+                            A_query.domain_size(), CurveType::g1_type::value_type::zero());
+                        for (std::size_t i = 0; i < A_query.size(); ++i) {
+                            dense_A_query[A_query.indices[i]] = A_query.values[i];
+                        }
+
+                        return proving_key_type(typename CurveType::g1_type::value_type(alpha_g1),
+                                                typename CurveType::g1_type::value_type(beta_g1),
+                                                typename CurveType::g2_type::value_type(beta_g2),
+                                                typename CurveType::g1_type::value_type(delta_g1),
+                                                typename CurveType::g2_type::value_type(delta_g2),
+                                                std::move(dense_A_query),
+                                                knowledge_commitment_vector<typename CurveType::g2_type,
+                                                                            typename CurveType::g1_type>(B_query),
+                                                std::vector<typename CurveType::g1_type::value_type>(H_query),
+                                                std::vector<typename CurveType::g1_type::value_type>(L_query),
+                                                constraint_system_type(constraint_system));
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return A_query.size_in_bits() + B_query.size_in_bits() +
+                               H_query.size() * CurveType::g1_type::value_bits +
+                               L_query.size() * CurveType::g1_type::value_bits + 1 * CurveType::g1_type::value_bits +
+                               1 * CurveType::g2_type::value_bits;
+                    }
+
+                    bool operator==(const r1cs_gg_ppzksnark_sparse_proving_key &other) const {
+                        return (this->alpha_g1 == other.alpha_g1 && this->beta_g1 == other.beta_g1 &&
+                                this->beta_g2 == other.beta_g2 && this->delta_g1 == other.delta_g1 &&
+                                this->delta_g2 == other.delta_g2 && this->A_query == other.A_query &&
+                                this->B_query == other.B_query && this->H_query == other.H_query &&
+                                this->L_query == other.L_query && this->constraint_system == other.constraint_system);
+                    }
+
+                private:
+                    static sparse_vector<typename CurveType::g1_type>
+                        sparse_A_query(const std::vector<typename CurveType::g1_type::value_type> &dense_A_query) {
+                        sparse_vector<typename CurveType::g1_type> result;
+                        result.domain_size_ = dense_A_query.size();
+                        for (std::size_t i = 0; i < dense_A_query.size(); ++i) {
+                            if (!dense_A_query[i].is_zero()) {
+                                result.indices.emplace_back(i);
+                                result.values.emplace_back(dense_A_query[i]);
+                            }
+                        }
+                        return result;
+                    }
+                };
+
+                /**
+                 * A proving key whose H_query is in the Lagrange basis of the coset g*S of the QAP domain S.
+                 *
+                 * proving_key.H_query[j] is L_j(t / g) * Z(t) / delta, L_j being the j-th Lagrange polynomial
+                 * of S, instead of t^j * Z(t) / delta: the H_query multi-exponentiation then runs on the
+                 * evaluations of H on the coset, so the prover skips the inverse FFT and the coset pass
+                 * that turn them into coefficients. Such a key is only made by the generator, and its
+                 * H_query has one point per element of S.
+                 */
+                template<typename CurveType,
+                         typename ConstraintSystem = r1cs_constraint_system<typename CurveType::scalar_field_type>>
+                struct r1cs_gg_ppzksnark_lagrange_proving_key {
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType, ConstraintSystem> proving_key_type;
+
+                    proving_key_type proving_key;
+
+                    r1cs_gg_ppzksnark_lagrange_proving_key() = default;
+                    r1cs_gg_ppzksnark_lagrange_proving_key &
+                        operator=(const r1cs_gg_ppzksnark_lagrange_proving_key &other) = default;
+                    r1cs_gg_ppzksnark_lagrange_proving_key(const r1cs_gg_ppzksnark_lagrange_proving_key &other) =
+                        default;
+                    r1cs_gg_ppzksnark_lagrange_proving_key(r1cs_gg_ppzksnark_lagrange_proving_key &&other) = default;
+
+                    explicit r1cs_gg_ppzksnark_lagrange_proving_key(proving_key_type &&proving_key) :
+                        proving_key(std::move(proving_key)) {};
+
+                    std::size_t size_in_bits() const {
+                        return proving_key.size_in_bits();
+                    }
+
+                    bool operator==(const r1cs_gg_ppzksnark_lagrange_proving_key &other) const {
+                        return this->proving_key == other.proving_key;
+                    }
+                };
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
@@ -0,0 +1,313 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a memory-bounded cache of memory-mapped R1CS GG-ppzkSNARK proving keys.
+//
+// A prover service hosting many circuits registers the key file of each of them, written by
+// r1cs_gg_ppzksnark_mapped_proving_key::write or by the streaming generator, with the loader
+// of its constraint system. acquire() maps the key on its first use, read-only, so that the
+// pages of the file are shared by every process proving the same circuit, and hands out a
+// shared pointer to it: the concurrent provers of a circuit share one mapping, and a key is
+// pinned for as long as one of them holds it.
+//
+// The footprint of a key is the mapped file, from size_in_bits(), and its constraint system.
+// Before a key is mapped, the least recently used unpinned keys are unmapped until the
+// loaded keys fit into the budget with it. Pinned keys are never unmapped, so the budget is
+// exceeded while they alone hold it; footprint() tells by how much. The key of an erased
+// circuit is counted until the last prover holding it releases it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_PROVING_KEY_CACHE_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_PROVING_KEY_CACHE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_proving_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                /**
+                 * Memory-mapped proving keys of CurveType by circuit name, the keys loaded at a time taking
+                 * at most budget bytes unless pinned keys take more.
+                 */
+                template<typename CurveType,
+                         typename ConstraintSystem = r1cs_constraint_system<typename CurveType::scalar_field_type>>
+                class r1cs_gg_ppzksnark_proving_key_cache {
+                public:
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+                    typedef r1cs_gg_ppzksnark_mapped_proving_key<CurveType, ConstraintSystem> proving_key_type;
+                    typedef std::shared_ptr<const proving_key_type> proving_key_pointer;
+                    typedef std::function<constraint_system_type()> constraint_system_loader;
+
+                    explicit r1cs_gg_ppzksnark_proving_key_cache(const std::size_t budget) :
+                        budget_(budget), footprint_(0), clock_(0) {
+                    }
+
+                    r1cs_gg_ppzksnark_proving_key_cache(const r1cs_gg_ppzksnark_proving_key_cache &) = delete;
+                    r1cs_gg_ppzksnark_proving_key_cache &operator=(const r1cs_gg_ppzksnark_proving_key_cache &) =
+                        delete;
+
+                    /**
+                     * Registers the key file at path for the circuit name, its constraint system being
+                     * loaded along with the key. A circuit registered again keeps its loaded key until it
+                     * is evicted.
+                     */
+                    void insert(const std::string &name, const std::string &path,
+                                constraint_system_loader load_constraint_system) {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        std::shared_ptr<entry_type> &entry = entries_[name];
+                        if (!entry) {
+                            entry = std::make_shared<entry_type>();
+                        }
+                        std::lock_guard<std::mutex> entry_lock(entry->mutex);
+                        entry->path = path;
+                        entry->load_constraint_system = std::move(load_constraint_system);
+                    }
+
+                    void insert(const std::string &name, const std::string &path,
+                                const constraint_system_type &constraint_system) {
+                        insert(name, path, [constraint_system]() { return constraint_system; });
+                    }
+
+                    /**
+                     * The key of the circuit name, mapped first if it is not loaded. Concurrent callers for
+                     * the same circuit wait for a single mapping. Throws std::out_of_range for a circuit that
+                     * is not registered, and what the mapping throws for a missing or incompatible file.
+                     */
+                    proving_key_pointer acquire(const std::string &name) {
+                        std::shared_ptr<entry_type> entry;
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            const typename entry_map::const_iterator it = entries_.find(name);
+                            if (it == entries_.end()) {
+                                throw std::out_of_range("r1cs_gg_ppzksnark_proving_key_cache: unknown circuit " +
+                                                        name);
+                            }
+                            entry = it->second;
+                            if (entry->key) {
+                                entry->last_use = ++clock_;
+                                return entry->key;
+                            }
+                        }
+
+                        /* the file is mapped outside of the cache mutex, under the one of the circuit */
+                        std::lock_guard<std::mutex> entry_lock(entry->mutex);
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            if (entry->key) {
+                                entry->last_use = ++clock_;
+                                return entry->key;
+                            }
+                        }
+                        proving_key_pointer key =
+                            std::make_shared<const proving_key_type>(entry->path, entry->load_constraint_system());
+                        const std::size_t key_footprint = footprint_of(*key);
+
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        /* a circuit erased meanwhile gets its key, which the cache no longer keeps */
+                        const typename entry_map::const_iterator it = entries_.find(name);
+                        if (it == entries_.end() || it->second != entry) {
+                            return key;
+                        }
+                        evict_to_fit(key_footprint);
+                        entry->key = key;
+                        entry->footprint = key_footprint;
+                        entry->last_use = ++clock_;
+                        footprint_ += key_footprint;
+                        return key;
+                    }
+
+                    /**
+                     * The key of the circuit name if it is loaded, a null pointer otherwise.
+                     */
+                    proving_key_pointer find(const std::string &name) {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        const typename entry_map::const_iterator it = entries_.find(name);
+                        if (it == entries_.end() || !it->second->key) {
+                            return proving_key_pointer();
+                        }
+                        it->second->last_use = ++clock_;
+                        return it->second->key;
+                    }
+
+                    /**
+                     * Unmaps the key of the circuit name unless it is pinned. Returns whether the key is
+                     * no longer loaded.
+                     */
+                    bool evict(const std::string &name) {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        const typename entry_map::const_iterator it = entries_.find(name);
+                        if (it == entries_.end() || !it->second->key) {
+                            return true;
+                        }
+                        if (is_pinned(*it->second)) {
+                            return false;
+                        }
+                        unload(*it->second);
+                        return true;
+                    }
+
+                    /**
+                     * Forgets the circuit name. Its key stays mapped, and counted in the footprint, for
+                     * the provers still holding it.
+                     */
+                    void erase(const std::string &name) {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        const typename entry_map::iterator it = entries_.find(name);
+                        if (it == entries_.end()) {
+                            return;
+                        }
+                        if (it->second->key && is_pinned(*it->second)) {
+                            retired_.push_back(it->second);
+                        } else {
+                            unload(*it->second);
+                        }
+                        entries_.erase(it);
+                    }
+
+                    /**
+                     * The bytes taken by the loaded keys and the still pinned keys of erased circuits.
+                     */
+                    std::size_t footprint() const {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        return footprint_ - released_footprint();
+                    }
+
+                    std::size_t budget() const {
+                        return budget_;
+                    }
+
+                    /**
+                     * The number of loaded keys.
+                     */
+                    std::size_t size() const {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        return std::count_if(entries_.begin(), entries_.end(),
+                                             [](const typename entry_map::value_type &entry) {
+                                                 return static_cast<bool>(entry.second->key);
+                                             });
+                    }
+
+                private:
+                    struct entry_type {
+                        std::string path;
+                        constraint_system_loader load_constraint_system;
+                        /* serializes the mappings of the circuit */
+                        std::mutex mutex;
+
+                        /* the loaded key and its footprint, guarded by the cache mutex */
+                        proving_key_pointer key;
+                        std::size_t footprint = 0;
+                        std::uint64_t last_use = 0;
+                    };
+
+                    typedef std::map<std::string, std::shared_ptr<entry_type>> entry_map;
+
+                    static std::size_t footprint_of(const proving_key_type &key) {
+                        std::size_t terms = 0;
+                        for (const auto &constraint : key.constraint_system.constraints) {
+                            terms += constraint.a.terms.size() + constraint.b.terms.size() +
+                                     constraint.c.terms.size();
+                        }
+                        return key.size_in_bits() / 8 +
+                               key.constraint_system.constraints.size() * sizeof(key.constraint_system.constraints[0]) +
+                               terms * sizeof(key.constraint_system.constraints[0].a.terms[0]);
+                    }
+
+                    /* the cache holds one reference to a loaded key, the provers using it the others */
+                    static bool is_pinned(const entry_type &entry) {
+                        return entry.key.use_count() > 1;
+                    }
+
+                    void unload(entry_type &entry) {
+                        footprint_ -= entry.footprint;
+                        entry.key.reset();
+                        entry.footprint = 0;
+                    }
+
+                    /* the footprint of the keys of erased circuits that the provers have released */
+                    std::size_t released_footprint() const {
+                        std::size_t released = 0;
+                        for (const std::shared_ptr<entry_type> &entry : retired_) {
+                            released += is_pinned(*entry) ? 0 : entry->footprint;
+                        }
+                        return released;
+                    }
+
+                    /* unloads the keys of erased circuits that the provers have released */
+                    void unload_released() {
+                        const typename std::vector<std::shared_ptr<entry_type>>::iterator released =
+                            std::partition(retired_.begin(), retired_.end(),
+                                           [](const std::shared_ptr<entry_type> &entry) { return is_pinned(*entry); });
+                        for (typename std::vector<std::shared_ptr<entry_type>>::iterator it = released;
+                             it != retired_.end(); ++it) {
+                            unload(**it);
+                        }
+                        retired_.erase(released, retired_.end());
+                    }
+
+                    /* evicts the least recently used unpinned keys until key_footprint more bytes fit */
+                    void evict_to_fit(const std::size_t key_footprint) {
+                        unload_released();
+                        while (footprint_ + key_footprint > budget_) {
+                            entry_type *victim = nullptr;
+                            for (const typename entry_map::value_type &entry : entries_) {
+                                if (entry.second->key && !is_pinned(*entry.second) &&
+                                    (!victim || entry.second->last_use < victim->last_use)) {
+                                    victim = entry.second.get();
+                                }
+                            }
+                            if (!victim) {
+                                return;
+                            }
+                            unload(*victim);
+                        }
+                    }
+
+                    const std::size_t budget_;
+                    std::size_t footprint_;
+                    std::uint64_t clock_;
+                    entry_map entries_;
+                    /* the erased circuits whose keys were pinned, counted in footprint_ until released */
+                    std::vector<std::shared_ptr<entry_type>> retired_;
+                    mutable std::mutex mutex_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_PROVING_KEY_CACHE_HPP
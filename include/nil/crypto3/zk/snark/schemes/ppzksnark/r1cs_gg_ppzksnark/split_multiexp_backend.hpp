@@ -0,0 +1,387 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Multi-exponentiation backend sharing every query between two backends.
+//
+// The split backend evaluates the range of every query in two parts concurrently: the
+// first share of the terms on a device backend, from a thread of its own, and the rest on
+// a host backend, on the executor of the caller. A prover node with a GPU backend then
+// keeps its cores busy on the queries too:
+//
+//     typedef r1cs_gg_ppzksnark_split_multiexp_backend<curve_type, gpu_backend> backend_type;
+//     const r1cs_gg_ppzksnark_resident_proving_key<curve_type, backend_type> rpk(pk);
+//     backend_type::calibrate(rpk.queries, rpk.proving_key, scalars.begin(), 1 << 16);
+//     proof = scheme_type::prove(rpk, primary_input, auxiliary_input);
+//
+// The share of each query is the fraction its device part takes; by default the G1
+// queries go mostly to the device and B_query, whose G2 half is the costlier one, stays
+// with the host. A share of 0 or 1 pins the query to one backend. calibrate times both
+// backends on a prefix of the queries and sets the shares after their throughputs, and
+// every split call then moves the share halfway towards the balance it measured, so the
+// two parts keep finishing together as the load of the node changes.
+//
+// Both backends provide the multiexp members with a query offset, see multiexp_backend.hpp,
+// and so does the split backend itself: more devices are shared out by nesting split
+// backends, as the device or the host backend of another one.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_SPLIT_MULTIEXP_BACKEND_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_SPLIT_MULTIEXP_BACKEND_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/memory_budget.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/multiexp_backend.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Fractions of the terms of each query evaluated by the device backend of a split
+                 * backend.
+                 */
+                struct multiexp_split_shares {
+                    double A = 0.875;
+                    double B = 0;
+                    double H = 0.875;
+                    double L = 0.875;
+                };
+
+                /**
+                 * The shares of the queries of a resident key, shared by the threads proving against it.
+                 *
+                 * A share strictly between 0 and 1 is rebalanced after every split call when adaptive is
+                 * set, and never leaves [min_share, 1 - min_share], so that either part is still timed.
+                 */
+                class multiexp_split_balance {
+                public:
+                    typedef double multiexp_split_shares::*share_type;
+
+                    static constexpr double min_share = 1.0 / 64;
+
+                    explicit multiexp_split_balance(const multiexp_split_shares &shares = multiexp_split_shares(),
+                                                    const bool adaptive = true) :
+                        adaptive(adaptive),
+                        current(shares) {
+                    }
+
+                    multiexp_split_shares shares() const {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        return current;
+                    }
+
+                    void set_shares(const multiexp_split_shares &shares) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        current = shares;
+                    }
+
+                    double share(const share_type query) const {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        return current.*query;
+                    }
+
+                    /**
+                     * Sets the share of a query which is not pinned to the balance of the given throughputs.
+                     */
+                    void calibrate(const share_type query, const double device_rate, const double host_rate) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        double &share = current.*query;
+                        if (share > 0 && share < 1 && device_rate > 0 && host_rate > 0) {
+                            share = clamp(device_rate / (device_rate + host_rate));
+                        }
+                    }
+
+                    /**
+                     * Moves the share of a query halfway towards the balance of the last split call.
+                     */
+                    void update(const share_type query, const std::size_t device_terms, const double device_seconds,
+                                const std::size_t host_terms, const double host_seconds) {
+                        if (!adaptive || device_seconds <= 0 || host_seconds <= 0) {
+                            return;
+                        }
+                        const double device_rate = device_terms / device_seconds;
+                        const double host_rate = host_terms / host_seconds;
+
+                        std::lock_guard<std::mutex> lock(mutex);
+                        double &share = current.*query;
+                        if (share > 0 && share < 1) {
+                            share = clamp((share + device_rate / (device_rate + host_rate)) / 2);
+                        }
+                    }
+
+                    bool adaptive;
+
+                private:
+                    static double clamp(const double share) {
+                        return std::min(std::max(share, min_share), 1 - min_share);
+                    }
+
+                    mutable std::mutex mutex;
+                    multiexp_split_shares current;
+                };
+
+                /**
+                 * Evaluates every query in two parts, on DeviceBackend and on HostBackend concurrently,
+                 * after the shares of the resident key.
+                 *
+                 * The device part runs on a thread of its own under the sequential executor, as a device
+                 * backend only launches its kernels and waits for them; the host part runs on the
+                 * executor of the caller. The H coefficients are computed by the FFT backend of the
+                 * device backend.
+                 */
+                template<typename CurveType, typename DeviceBackend,
+                         typename HostBackend = r1cs_gg_ppzksnark_cpu_multiexp_backend<CurveType>>
+                struct r1cs_gg_ppzksnark_split_multiexp_backend {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef r1cs_gg_ppzksnark_proving_key<CurveType> proving_key_type;
+                    typedef typename DeviceBackend::fft_backend_type fft_backend_type;
+
+                    struct resident_queries_type {
+                        typename DeviceBackend::resident_queries_type device;
+                        typename HostBackend::resident_queries_type host;
+                        std::shared_ptr<multiexp_split_balance> balance;
+                    };
+
+                    static inline resident_queries_type upload(const proving_key_type &proving_key) {
+                        return resident_queries_type {DeviceBackend::upload(proving_key),
+                                                      HostBackend::upload(proving_key),
+                                                      std::make_shared<multiexp_split_balance>()};
+                    }
+
+                    /**
+                     * Times both backends on the first terms of each G1 query, at most max_terms of them,
+                     * and sets the shares of the queries which are not pinned after their throughputs.
+                     */
+                    template<typename InputFieldIterator>
+                    static void calibrate(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                          InputFieldIterator scalars_first, const std::size_t max_terms) {
+                        const auto rate = [](const std::size_t terms, auto multiexp) {
+                            const auto start = std::chrono::steady_clock::now();
+                            const auto sum = multiexp();
+                            const double elapsed =
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                            (void)sum;
+                            return elapsed > 0 ? terms / elapsed : 0;
+                        };
+                        const auto calibrate_query = [&](const multiexp_split_balance::share_type query,
+                                                         const std::size_t query_size, auto device, auto host) {
+                            const std::size_t n = std::min(max_terms, query_size);
+                            if (n > 0) {
+                                resident.balance->calibrate(query, rate(n, [&]() { return device(n); }),
+                                                            rate(n, [&]() { return host(n); }));
+                            }
+                        };
+
+                        calibrate_query(
+                            &multiexp_split_shares::A, proving_key.A_query.size(),
+                            [&](const std::size_t n) {
+                                return DeviceBackend::multiexp_A(resident.device, proving_key, 0, scalars_first,
+                                                                 scalars_first + n);
+                            },
+                            [&](const std::size_t n) {
+                                return HostBackend::multiexp_A(resident.host, proving_key, 0, scalars_first,
+                                                               scalars_first + n);
+                            });
+                        calibrate_query(
+                            &multiexp_split_shares::H, proving_key.H_query.size(),
+                            [&](const std::size_t n) {
+                                return DeviceBackend::multiexp_H(resident.device, proving_key, 0, scalars_first,
+                                                                 scalars_first + n);
+                            },
+                            [&](const std::size_t n) {
+                                return HostBackend::multiexp_H(resident.host, proving_key, 0, scalars_first,
+                                                               scalars_first + n);
+                            });
+                        calibrate_query(
+                            &multiexp_split_shares::L, proving_key.L_query.size(),
+                            [&](const std::size_t n) {
+                                return DeviceBackend::multiexp_L(resident.device, proving_key, 0, scalars_first,
+                                                                 scalars_first + n);
+                            },
+                            [&](const std::size_t n) {
+                                return HostBackend::multiexp_L(resident.host, proving_key, 0, scalars_first,
+                                                               scalars_first + n);
+                            });
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_A(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_A(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_A(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return split(
+                            *resident.balance, &multiexp_split_shares::A, first, scalars_first, scalars_last,
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return DeviceBackend::multiexp_A(resident.device, proving_key, f, sf, sl);
+                            },
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return HostBackend::multiexp_A(resident.host, proving_key, f, sf, sl);
+                            });
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename knowledge_commitment<g2_type, g1_type>::value_type
+                        multiexp_B(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                   InputFieldIterator scalars_first, InputFieldIterator scalars_last) {
+                        return multiexp_B(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename knowledge_commitment<g2_type, g1_type>::value_type
+                        multiexp_B(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return split(
+                            *resident.balance, &multiexp_split_shares::B, first, scalars_first, scalars_last,
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return DeviceBackend::multiexp_B(resident.device, proving_key, f, sf, sl);
+                            },
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return HostBackend::multiexp_B(resident.host, proving_key, f, sf, sl);
+                            });
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_H(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_H(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_H(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return split(
+                            *resident.balance, &multiexp_split_shares::H, first, scalars_first, scalars_last,
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return DeviceBackend::multiexp_H(resident.device, proving_key, f, sf, sl);
+                            },
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return HostBackend::multiexp_H(resident.host, proving_key, f, sf, sl);
+                            });
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type multiexp_L(const resident_queries_type &resident,
+                                                                          const proving_key_type &proving_key,
+                                                                          InputFieldIterator scalars_first,
+                                                                          InputFieldIterator scalars_last) {
+                        return multiexp_L(resident, proving_key, 0, scalars_first, scalars_last);
+                    }
+
+                    template<typename InputFieldIterator>
+                    static inline typename g1_type::value_type
+                        multiexp_L(const resident_queries_type &resident, const proving_key_type &proving_key,
+                                   const std::size_t first, InputFieldIterator scalars_first,
+                                   InputFieldIterator scalars_last) {
+                        return split(
+                            *resident.balance, &multiexp_split_shares::L, first, scalars_first, scalars_last,
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return DeviceBackend::multiexp_L(resident.device, proving_key, f, sf, sl);
+                            },
+                            [&](const std::size_t f, InputFieldIterator sf, InputFieldIterator sl) {
+                                return HostBackend::multiexp_L(resident.host, proving_key, f, sf, sl);
+                            });
+                    }
+
+                private:
+                    /**
+                     * Sums the device part, over the share of the terms of [first, first + n), and the host part,
+                     * over the rest, and rebalances the share after their timings.
+                     */
+                    template<typename InputFieldIterator, typename DeviceMultiexp, typename HostMultiexp>
+                    static auto split(multiexp_split_balance &balance, const multiexp_split_balance::share_type query,
+                                      const std::size_t first, InputFieldIterator scalars_first,
+                                      InputFieldIterator scalars_last, DeviceMultiexp device, HostMultiexp host)
+                        -> decltype(host(first, scalars_first, scalars_last)) {
+                        typedef decltype(host(first, scalars_first, scalars_last)) value_type;
+                        typedef std::chrono::steady_clock clock_type;
+
+                        const std::size_t n = std::distance(scalars_first, scalars_last);
+                        const double share = balance.share(query);
+                        const std::size_t device_terms =
+                            share <= 0 ? 0 : share >= 1 ? n : static_cast<std::size_t>(share * n);
+                        if (device_terms == 0) {
+                            return host(first, scalars_first, scalars_last);
+                        }
+                        if (device_terms == n) {
+                            return device(first, scalars_first, scalars_last);
+                        }
+
+                        const InputFieldIterator scalars_middle = scalars_first + device_terms;
+                        const stage_profiler::context stages;
+                        operation_counter *const counter = operation_counter::current();
+                        const memory_budget &budget = memory_budget::current();
+                        std::future<std::pair<value_type, double>> device_part =
+                            std::async(std::launch::async, [&]() {
+                                executor::scope guard(executor::sequential());
+                                stage_profiler::context::scope stages_guard(stages);
+                                operation_counter::scope counter_guard(counter);
+                                memory_budget::scope budget_guard(budget);
+                                const clock_type::time_point start = clock_type::now();
+                                value_type sum = device(first, scalars_first, scalars_middle);
+                                return std::make_pair(std::move(sum),
+                                                      std::chrono::duration<double>(clock_type::now() - start).count());
+                            });
+
+                        const clock_type::time_point start = clock_type::now();
+                        const value_type host_sum = host(first + device_terms, scalars_middle, scalars_last);
+                        const double host_seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+                        const std::pair<value_type, double> device_sum = device_part.get();
+                        balance.update(query, device_terms, device_sum.second, n - device_terms, host_seconds);
+                        return device_sum.first + host_sum;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_SPLIT_MULTIEXP_BACKEND_HPP
@@ -31,6 +31,7 @@
 
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
 
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
@@ -93,11 +94,18 @@ namespace nil {
 
                     accumulation_vector<typename CurveType::g1_type> gamma_ABC_g1;
 
+                    /**
+                     * Optional fixed-base precomputation of gamma_ABC_g1.rest, empty unless requested
+                     * when processing the verification key.
+                     */
+                    fixed_base_precomputation<typename CurveType::g1_type> gamma_ABC_g1_precomp;
+
                     bool operator==(const r1cs_gg_ppzksnark_processed_verification_key &other) const {
                         return (this->vk_alpha_g1_beta_g2 == other.vk_alpha_g1_beta_g2 &&
                                 this->vk_gamma_g2_precomp == other.vk_gamma_g2_precomp &&
                                 this->vk_delta_g2_precomp == other.vk_delta_g2_precomp &&
-                                this->gamma_ABC_g1 == other.gamma_ABC_g1);
+                                this->gamma_ABC_g1 == other.gamma_ABC_g1 &&
+                                this->gamma_ABC_g1_precomp == other.gamma_ABC_g1_precomp);
                     }
                 };
             }    // namespace snark
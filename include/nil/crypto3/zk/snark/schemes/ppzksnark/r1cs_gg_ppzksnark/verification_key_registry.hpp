@@ -0,0 +1,344 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a registry of processed R1CS GG-ppzkSNARK verification keys.
+//
+// A verifier service checking proofs of many circuits processes every verification
+// key once and keeps the result in a registry, keyed by a Hash digest of the key.
+// The registry publishes its entries as an immutable snapshot: lookups load the
+// current snapshot with std::atomic_load and never take the registry mutex, which
+// only serializes insertions. The atomic operations on shared_ptr are not lock-free:
+// the standard library guards them with a small pool of mutexes, held for the copy
+// of the pointer only, so lookups never wait for an insertion to process its key or
+// to copy the snapshot. Once the registry holds its capacity, an insertion evicts
+// the least recently used key; processed keys still referenced by a verifier stay
+// alive with it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_R1CS_GG_PPZKSNARK_VERIFICATION_KEY_REGISTRY_HPP
+#define CRYPTO3_R1CS_GG_PPZKSNARK_VERIFICATION_KEY_REGISTRY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include <nil/crypto3/algebra/multiexp/multiexp.hpp>
+#include <nil/crypto3/algebra/type_traits.hpp>
+
+#include <nil/crypto3/multiprecision/cpp_int.hpp>
+
+#include <nil/crypto3/hash/algorithm/hash.hpp>
+#include <nil/crypto3/hash/sha2.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verification_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_process_verification_key;
+
+                /**
+                 * Processed verification keys of CurveType, at most capacity of them, by the Hash digest
+                 * of their verification key. The digest returned by insert() is the handle verifiers
+                 * take along with the registry.
+                 */
+                template<typename CurveType, typename Hash = hashes::sha2<256>>
+                class r1cs_gg_ppzksnark_verification_key_registry {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+                    typedef typename g1_type::value_type g1_value_type;
+                    typedef typename g2_type::value_type g2_value_type;
+
+                public:
+                    typedef CurveType curve_type;
+                    typedef Hash hash_type;
+                    typedef typename Hash::digest_type digest_type;
+
+                    typedef r1cs_gg_ppzksnark_verification_key<CurveType> verification_key_type;
+                    typedef r1cs_gg_ppzksnark_processed_verification_key<CurveType> processed_verification_key_type;
+                    typedef std::shared_ptr<const processed_verification_key_type> processed_verification_key_pointer;
+
+                    explicit r1cs_gg_ppzksnark_verification_key_registry(const std::size_t capacity) :
+                        capacity_(std::max<std::size_t>(capacity, 1)), clock_(0),
+                        snapshot_(std::make_shared<const snapshot_type>()) {
+                    }
+
+                    r1cs_gg_ppzksnark_verification_key_registry(const r1cs_gg_ppzksnark_verification_key_registry &) =
+                        delete;
+                    r1cs_gg_ppzksnark_verification_key_registry &
+                        operator=(const r1cs_gg_ppzksnark_verification_key_registry &) = delete;
+
+                    /**
+                     * The digest of verification_key, over the special form of its group elements, so
+                     * that equal keys have equal digests whatever their projective coordinates. Field
+                     * elements are written as little-endian integers of the byte size of their modulus
+                     * and sizes as 64-bit little-endian integers, so the digest of a key is the same
+                     * across runs, builds and platforms.
+                     */
+                    static digest_type digest(const verification_key_type &verification_key) {
+                        const sparse_vector<g1_type> &rest = verification_key.gamma_ABC_g1.rest;
+
+                        std::vector<g1_value_type> g1_points;
+                        g1_points.reserve(1 + rest.values.size());
+                        g1_points.emplace_back(verification_key.gamma_ABC_g1.first);
+                        g1_points.insert(g1_points.end(), rest.values.begin(), rest.values.end());
+                        const std::vector<g2_value_type> g2_points = {verification_key.gamma_g2,
+                                                                      verification_key.delta_g2};
+
+                        accumulator_set<Hash> acc;
+                        write_field_element<typename CurveType::gt_type>(verification_key.alpha_g1_beta_g2, acc);
+                        write_points<g2_type>(g2_points, acc);
+                        write_points<g1_type>(g1_points, acc);
+                        for (const std::size_t index : rest.indices) {
+                            write_size(index, acc);
+                        }
+                        write_size(rest.domain_size(), acc);
+
+                        return boost::accumulators::extract_result<
+                            typename boost::mpl::front<typename accumulator_set<Hash>::features_type>::type>(acc);
+                    }
+
+                    /**
+                     * Processes verification_key, with fixed-base tables of the given window (see
+                     * r1cs_gg_ppzksnark_process_verification_key), unless the registry already holds
+                     * it, and returns its digest. The key is processed outside of the registry mutex.
+                     */
+                    digest_type insert(const verification_key_type &verification_key, const std::size_t window = 0) {
+                        const digest_type key_digest = digest(verification_key);
+                        acquire(key_digest, verification_key, window);
+                        return key_digest;
+                    }
+
+                    /**
+                     * The processed verification_key, inserted first when the registry does not hold it.
+                     */
+                    processed_verification_key_pointer get(const verification_key_type &verification_key,
+                                                           const std::size_t window = 0) {
+                        return acquire(digest(verification_key), verification_key, window);
+                    }
+
+                    /**
+                     * The processed verification key of digest key_digest, or a null pointer when the
+                     * registry does not hold it, either never inserted or evicted since.
+                     */
+                    processed_verification_key_pointer find(const digest_type &key_digest) const {
+                        const std::shared_ptr<const snapshot_type> snapshot = std::atomic_load(&snapshot_);
+                        const typename snapshot_type::const_iterator it = lower_bound(*snapshot, key_digest);
+                        if (it == snapshot->end() || !same_digest((*it)->digest, key_digest)) {
+                            return processed_verification_key_pointer();
+                        }
+                        (*it)->last_use.store(++clock_, std::memory_order_relaxed);
+                        return (*it)->processed_verification_key;
+                    }
+
+                    /**
+                     * As find(), but throws std::out_of_range when the registry does not hold the key.
+                     */
+                    processed_verification_key_pointer at(const digest_type &key_digest) const {
+                        processed_verification_key_pointer processed_verification_key = find(key_digest);
+                        if (!processed_verification_key) {
+                            throw std::out_of_range("r1cs_gg_ppzksnark_verification_key_registry: unknown key");
+                        }
+                        return processed_verification_key;
+                    }
+
+                    void erase(const digest_type &key_digest) {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        const std::shared_ptr<const snapshot_type> snapshot = std::atomic_load(&snapshot_);
+                        const typename snapshot_type::const_iterator it = lower_bound(*snapshot, key_digest);
+                        if (it == snapshot->end() || !same_digest((*it)->digest, key_digest)) {
+                            return;
+                        }
+                        std::shared_ptr<snapshot_type> next = std::make_shared<snapshot_type>(*snapshot);
+                        next->erase(next->begin() + (it - snapshot->begin()));
+                        std::atomic_store(&snapshot_, std::shared_ptr<const snapshot_type>(std::move(next)));
+                    }
+
+                    void clear() {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        std::atomic_store(&snapshot_, std::make_shared<const snapshot_type>());
+                    }
+
+                    std::size_t size() const {
+                        return std::atomic_load(&snapshot_)->size();
+                    }
+
+                    std::size_t capacity() const {
+                        return capacity_;
+                    }
+
+                private:
+                    struct entry_type {
+                        entry_type(const digest_type &digest,
+                                   processed_verification_key_pointer processed_verification_key,
+                                   const std::uint64_t last_use) :
+                            digest(digest),
+                            processed_verification_key(std::move(processed_verification_key)), last_use(last_use) {
+                        }
+
+                        digest_type digest;
+                        processed_verification_key_pointer processed_verification_key;
+                        /* the registry clock at the last lookup, updated by concurrent readers */
+                        mutable std::atomic<std::uint64_t> last_use;
+                    };
+
+                    /* the entries sorted by digest */
+                    typedef std::vector<std::shared_ptr<const entry_type>> snapshot_type;
+
+                    static bool less_digest(const digest_type &a, const digest_type &b) {
+                        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+                    }
+
+                    static bool same_digest(const digest_type &a, const digest_type &b) {
+                        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+                    }
+
+                    static typename snapshot_type::const_iterator lower_bound(const snapshot_type &snapshot,
+                                                                              const digest_type &key_digest) {
+                        return std::lower_bound(snapshot.begin(), snapshot.end(), key_digest,
+                                                [](const std::shared_ptr<const entry_type> &entry,
+                                                   const digest_type &key_digest) {
+                                                    return less_digest(entry->digest, key_digest);
+                                                });
+                    }
+
+                    /* an element of a prime field as a little-endian integer of the byte size of its modulus */
+                    template<typename FieldType>
+                    static typename std::enable_if<!algebra::is_extended_field<FieldType>::value>::type
+                        write_field_element(const typename FieldType::value_type &value, accumulator_set<Hash> &acc) {
+                        typedef multiprecision::number<multiprecision::backends::cpp_int_backend<>> integral_type;
+                        constexpr static const std::size_t element_bytes = (FieldType::modulus_bits + 7) / 8;
+
+                        std::vector<std::uint8_t> bytes;
+                        bytes.reserve(element_bytes);
+                        multiprecision::export_bits(integral_type(value.data), std::back_inserter(bytes), 8, false);
+                        BOOST_ASSERT(bytes.size() <= element_bytes);
+                        bytes.resize(element_bytes, 0);
+                        hash<Hash>(bytes.begin(), bytes.end(), acc);
+                    }
+
+                    /* an element of an extension field as its coefficients over the underlying field */
+                    template<typename FieldType>
+                    static typename std::enable_if<algebra::is_extended_field<FieldType>::value>::type
+                        write_field_element(const typename FieldType::value_type &value, accumulator_set<Hash> &acc) {
+                        constexpr static const std::size_t data_dimension =
+                            FieldType::arity / FieldType::underlying_field_type::arity;
+                        for (std::size_t n = 0; n < data_dimension; ++n) {
+                            write_field_element<typename FieldType::underlying_field_type>(value.data[n], acc);
+                        }
+                    }
+
+                    static void write_size(const std::uint64_t size, accumulator_set<Hash> &acc) {
+                        std::uint8_t bytes[sizeof(std::uint64_t)];
+                        for (std::size_t i = 0; i < sizeof(std::uint64_t); ++i) {
+                            bytes[i] = static_cast<std::uint8_t>(size >> (8 * i));
+                        }
+                        hash<Hash>(bytes, bytes + sizeof(bytes), acc);
+                    }
+
+                    /* the finite points as a tag byte and the coordinates of their special form, Z being one,
+                       and the point at infinity, which has no special form, as a single tag byte */
+                    template<typename GroupType>
+                    static void write_points(const std::vector<typename GroupType::value_type> &points,
+                                             accumulator_set<Hash> &acc) {
+                        std::vector<typename GroupType::value_type> finite_points;
+                        finite_points.reserve(points.size());
+                        for (const typename GroupType::value_type &point : points) {
+                            if (!point.is_zero()) {
+                                finite_points.emplace_back(point);
+                            }
+                        }
+                        algebra::batch_to_special<GroupType>(finite_points);
+
+                        std::size_t finite_idx = 0;
+                        for (const typename GroupType::value_type &point : points) {
+                            const std::uint8_t tag = point.is_zero() ? 0 : 1;
+                            hash<Hash>(&tag, &tag + 1, acc);
+                            if (tag) {
+                                const typename GroupType::value_type &special = finite_points[finite_idx++];
+                                write_field_element<typename GroupType::field_type>(special.X, acc);
+                                write_field_element<typename GroupType::field_type>(special.Y, acc);
+                            }
+                        }
+                    }
+
+                    processed_verification_key_pointer acquire(const digest_type &key_digest,
+                                                               const verification_key_type &verification_key,
+                                                               const std::size_t window) {
+                        processed_verification_key_pointer processed_verification_key = find(key_digest);
+                        if (processed_verification_key) {
+                            return processed_verification_key;
+                        }
+
+                        processed_verification_key = std::make_shared<const processed_verification_key_type>(
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(verification_key, window));
+
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        const std::shared_ptr<const snapshot_type> snapshot = std::atomic_load(&snapshot_);
+                        typename snapshot_type::const_iterator it = lower_bound(*snapshot, key_digest);
+                        // another thread may have inserted the same key meanwhile: keep the first one
+                        if (it != snapshot->end() && same_digest((*it)->digest, key_digest)) {
+                            (*it)->last_use.store(++clock_, std::memory_order_relaxed);
+                            return (*it)->processed_verification_key;
+                        }
+
+                        std::shared_ptr<snapshot_type> next = std::make_shared<snapshot_type>(*snapshot);
+                        next->emplace(next->begin() + (it - snapshot->begin()),
+                                      std::make_shared<const entry_type>(key_digest, processed_verification_key,
+                                                                         ++clock_));
+                        if (next->size() > capacity_) {
+                            next->erase(std::min_element(
+                                next->begin(), next->end(),
+                                [](const std::shared_ptr<const entry_type> &a,
+                                   const std::shared_ptr<const entry_type> &b) {
+                                    return a->last_use.load(std::memory_order_relaxed) <
+                                           b->last_use.load(std::memory_order_relaxed);
+                                }));
+                        }
+                        std::atomic_store(&snapshot_, std::shared_ptr<const snapshot_type>(std::move(next)));
+                        return processed_verification_key;
+                    }
+
+                    const std::size_t capacity_;
+                    mutable std::atomic<std::uint64_t> clock_;
+                    std::shared_ptr<const snapshot_type> snapshot_;
+                    std::mutex mutex_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_R1CS_GG_PPZKSNARK_VERIFICATION_KEY_REGISTRY_HPP
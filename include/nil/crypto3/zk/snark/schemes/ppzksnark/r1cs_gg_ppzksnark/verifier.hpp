@@ -50,15 +50,32 @@
 #ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_BASIC_VERIFIER_HPP
 #define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_BASIC_VERIFIER_HPP
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <vector>
+
+#include <nil/crypto3/algebra/random_element.hpp>
 
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
+#include <nil/crypto3/zk/snark/batch_scalar_mul.hpp>
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
+
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/detail/basic_policy.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/prepared_verifier_input.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/verification_key_registry.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -67,17 +84,25 @@ namespace nil {
 
                 /**
                  * Convert a (non-processed) verification key into a processed verification key.
+                 *
+                 * A non-zero window additionally expands the elements of gamma_ABC_g1 into fixed-base
+                 * tables, each taking ceil(scalar_bits / window) times the memory of its element, which
+                 * turns the accumulation of the primary input into a single bucket pass.
                  */
                 template<typename CurveType>
                 class r1cs_gg_ppzksnark_process_verification_key {
                     typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
 
                     typedef typename CurveType::pairing pairing_policy;
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
 
                 public:
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
@@ -86,8 +111,11 @@ namespace nil {
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
 
+                    /* The shortest primary input whose accumulation is split across threads. */
+                    static constexpr const std::size_t min_split_input_size = 1024;
+
                     static inline processed_verification_key_type
-                        process(const verification_key_type &verification_key) {
+                        process(const verification_key_type &verification_key, const std::size_t window = 0) {
 
                         processed_verification_key_type processed_verification_key;
                         processed_verification_key.vk_alpha_g1_beta_g2 = verification_key.alpha_g1_beta_g2;
@@ -97,8 +125,52 @@ namespace nil {
                             pairing_policy::precompute_g2(verification_key.delta_g2);
                         processed_verification_key.gamma_ABC_g1 = verification_key.gamma_ABC_g1;
 
+                        if (window) {
+                            const std::vector<typename g1_type::value_type> &bases =
+                                verification_key.gamma_ABC_g1.rest.values;
+                            processed_verification_key.gamma_ABC_g1_precomp =
+                                fixed_base_precompute<g1_type, scalar_field_type>(
+                                    bases.begin(), bases.end(), window, executor::current().concurrency());
+                        }
+
                         return processed_verification_key;
                     }
+
+                    /**
+                     * gamma_ABC_g1.first + \sum_i primary_input[i] * gamma_ABC_g1.rest[i], through the
+                     * fixed-base tables of the key when it has them. Otherwise a long primary input is
+                     * split into tasks for the threads of the current executor, see multiexp_tasks.hpp.
+                     */
+                    static inline typename g1_type::value_type
+                        accumulate_primary_input(const processed_verification_key_type &processed_verification_key,
+                                                 const primary_input_span_type &primary_input) {
+                        stage_profiler::timer input_timer("input_multiexp", primary_input.size());
+                        operation_counter::add(operation_counter::g1_exp_term, primary_input.size());
+                        if (processed_verification_key.gamma_ABC_g1_precomp.empty()) {
+                            const sparse_vector<g1_type> &rest = processed_verification_key.gamma_ABC_g1.rest;
+                            if (primary_input.size() < min_split_input_size) {
+                                return processed_verification_key.gamma_ABC_g1.first +
+                                       sparse_multiexp<multiexp_method_auto>(rest, 0, primary_input.size(),
+                                                                             primary_input.begin(), 1);
+                            }
+
+                            multiexp_task_list tasks(primary_input.size() * multiexp_task_list::g1_cost);
+                            std::vector<typename g1_type::value_type> parts;
+                            tasks.add(parts, primary_input.size(), multiexp_task_list::g1_cost,
+                                      [&](std::size_t first, std::size_t last) {
+                                          return sparse_multiexp<multiexp_method_auto>(
+                                              rest, first, last, primary_input.begin() + first, 1);
+                                      });
+                            tasks.run();
+                            return processed_verification_key.gamma_ABC_g1.first + multiexp_task_list::sum(parts);
+                        }
+
+                        return processed_verification_key.gamma_ABC_g1.first +
+                               fixed_base_sparse_multiexp(processed_verification_key.gamma_ABC_g1_precomp,
+                                                          processed_verification_key.gamma_ABC_g1.rest.indices, 0,
+                                                          primary_input.size(), primary_input.begin(),
+                                                          primary_input.end(), executor::current().concurrency());
+                    }
                 };
 
                 /**
@@ -122,6 +194,7 @@ namespace nil {
                     typedef typename CurveType::pairing pairing_policy;
                     typedef typename CurveType::scalar_field_type scalar_field_type;
                     typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
                     typedef typename CurveType::gt_type gt_type;
                     typedef typename pairing_policy::g1_precomp g1_precomp;
                     typedef typename pairing_policy::g2_precomp g2_precomp;
@@ -131,6 +204,8 @@ namespace nil {
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
@@ -138,6 +213,8 @@ namespace nil {
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
+                    typedef typename policy_type::proof_batch_type proof_batch_type;
+                    typedef r1cs_gg_ppzksnark_prepared_verifier_input<CurveType> prepared_verifier_input_type;
 
                     /**
                      * A verifier algorithm for the R1CS GG-ppzkSNARK that:
@@ -145,7 +222,7 @@ namespace nil {
                      * (2) has weak input consistency.
                      */
                     static inline bool process(const verification_key_type &verification_key,
-                                               const primary_input_type &primary_input,
+                                               const primary_input_span_type &primary_input,
                                                const proof_type &proof) {
                         return process(r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(verification_key),
                                        primary_input, proof);
@@ -157,33 +234,298 @@ namespace nil {
                      * (2) has weak input consistency.
                      */
                     static inline bool process(const processed_verification_key_type &processed_verification_key,
-                                               const primary_input_type &primary_input,
+                                               const primary_input_span_type &primary_input,
                                                const proof_type &proof) {
 
                         assert(processed_verification_key.gamma_ABC_g1.domain_size() >= primary_input.size());
 
-                        const accumulation_vector<g1_type> accumulated_IC =
-                            processed_verification_key.gamma_ABC_g1.accumulate_chunk(primary_input.begin(),
-                                                                                     primary_input.end(), 0);
+                        return process_accumulated(
+                            processed_verification_key,
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::accumulate_primary_input(
+                                processed_verification_key, primary_input),
+                            proof);
+                    }
 
-                        const typename g1_type::value_type &acc = accumulated_IC.first;
+                    /**
+                     * A verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts the digest of a verification key held by a registry, and
+                     * (2) has weak input consistency.
+                     *
+                     * Throws std::out_of_range when the registry does not hold the key.
+                     */
+                    template<typename Hash>
+                    static inline bool
+                        process(const r1cs_gg_ppzksnark_verification_key_registry<CurveType, Hash> &registry,
+                                const typename r1cs_gg_ppzksnark_verification_key_registry<CurveType,
+                                                                                           Hash>::digest_type &digest,
+                                const primary_input_span_type &primary_input,
+                                const proof_type &proof) {
+                        return process(*registry.at(digest), primary_input, proof);
+                    }
 
-                        bool result = true;
+                    /**
+                     * A verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts a processed verification key,
+                     * (2) has weak input consistency, and
+                     * (3) takes the primary input accumulated, chunk by chunk, by a cursor started at index 0
+                     * of the gamma_ABC_g1 query of the key.
+                     */
+                    static inline bool process(const processed_verification_key_type &processed_verification_key,
+                                               const accumulation_cursor<g1_type> &accumulated_input,
+                                               const proof_type &proof) {
 
-                        if (!proof.is_well_formed()) {
-                            result = false;
+                        assert(accumulated_input.start() == 0);
+                        assert(processed_verification_key.gamma_ABC_g1.domain_size() >= accumulated_input.offset());
+
+                        return process_accumulated(processed_verification_key, accumulated_input.value(), proof);
+                    }
+
+                    /**
+                     * Off-chain part of the verification: accumulates the primary input into the
+                     * gamma_ABC_g1 query of the key and keeps the elements the pairing check takes.
+                     * With pairing_inputs, the accumulated input and C are negated as well.
+                     */
+                    static inline prepared_verifier_input_type prepare(const verification_key_type &verification_key,
+                                                                       const primary_input_span_type &primary_input,
+                                                                       const proof_type &proof,
+                                                                       bool pairing_inputs = false) {
+
+                        assert(verification_key.gamma_ABC_g1.domain_size() >= primary_input.size());
+
+                        /* the accumulation only reads the query, the Miller loop precomputation is skipped */
+                        processed_verification_key_type processed_verification_key;
+                        processed_verification_key.gamma_ABC_g1 = verification_key.gamma_ABC_g1;
+                        const typename g1_type::value_type acc =
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::accumulate_primary_input(
+                                processed_verification_key, primary_input);
+
+                        prepared_verifier_input_type prepared(pairing_inputs, verification_key.alpha_g1_beta_g2,
+                                                              verification_key.gamma_g2, verification_key.delta_g2,
+                                                              pairing_inputs ? -acc : acc, proof);
+                        if (pairing_inputs) {
+                            prepared.proof.g_C = -prepared.proof.g_C;
+                        }
+                        return prepared;
+                    }
+
+                    /**
+                     * A verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts a processed verification key,
+                     * (2) has weak input consistency, and
+                     * (3) takes the proof from a prepared input.
+                     *
+                     * Only the proof of the prepared input is taken as is: the pairing check runs against
+                     * the trusted key, and the elements of the key and the accumulated input the prepared
+                     * input carries must match those of the trusted key and of primary_input.
+                     */
+                    static inline bool process(const processed_verification_key_type &processed_verification_key,
+                                               const primary_input_span_type &primary_input,
+                                               const prepared_verifier_input_type &prepared) {
+
+                        assert(processed_verification_key.gamma_ABC_g1.domain_size() >= primary_input.size());
+
+                        if (!prepared.is_well_formed() ||
+                            prepared.alpha_g1_beta_g2 != processed_verification_key.vk_alpha_g1_beta_g2) {
+                            return false;
+                        }
+
+                        const typename g1_type::value_type acc =
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::accumulate_primary_input(
+                                processed_verification_key, primary_input);
+                        if (prepared.accumulated_input != (prepared.pairing_inputs ? -acc : acc)) {
+                            return false;
+                        }
+
+                        proof_type proof = prepared.proof;
+                        if (prepared.pairing_inputs) {
+                            proof.g_C = -proof.g_C;
+                        }
+                        return process_accumulated(processed_verification_key, acc, proof);
+                    }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has weak input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(verification_key),
+                            primary_inputs_first, primary_inputs_last, proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has weak input consistency.
+                     *
+                     * Verifies every proof of [proofs_first, proofs_last) against the primary input at the
+                     * same position of [primary_inputs_first, primary_inputs_last). The verification
+                     * equations are combined with random non-zero coefficients r_i into
+                     *     \prod_i e(r_i A_i, B_i) = e(alpha, beta)^{\sum_i r_i} *
+                     *                               e(\sum_i r_i acc_i, gamma) * e(\sum_i r_i C_i, delta),
+                     * whose Miller loops run two proofs at a time (see multi_miller_loop). The G1 sides of
+                     * the fixed gamma and delta are single multi-exponentiations over the batch, so they
+                     * cost one double Miller loop for the whole batch, and e(alpha, beta) one exponentiation
+                     * of vk_alpha_g1_beta_g2; a single final exponentiation follows. A batch
+                     * with an invalid proof passes with negligible probability over the choice of the r_i,
+                     * as long as they cannot be predicted by the prover: they are drawn from GeneratorType,
+                     * the entropy of the system by default. A batch of more or fewer primary inputs than
+                     * proofs, or with a primary input longer than the key, is rejected.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &processed_verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            processed_verification_key, primary_inputs_first, primary_inputs_last,
+                            proof_batch_type(proofs_first, proofs_last));
+                    }
+
+                    /**
+                     * Same as above for a non-processed verification key and the proofs of a batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator>
+                    static inline bool process_batch(const verification_key_type &verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     const proof_batch_type &proofs) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(verification_key),
+                            primary_inputs_first, primary_inputs_last, proofs);
+                    }
+
+                    /**
+                     * Same as above for the proofs of a batch, whose B elements are paired in place.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator>
+                    static inline bool process_batch(const processed_verification_key_type &processed_verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     const proof_batch_type &proofs) {
+                        std::vector<const primary_input_type *> primary_inputs;
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            primary_inputs.emplace_back(&*it);
                         }
 
-                        const g1_precomp proof_g_A_precomp = pairing_policy::precompute_g1(proof.g_A);
-                        const g2_precomp proof_g_B_precomp = pairing_policy::precompute_g2(proof.g_B);
-                        const g1_precomp proof_g_C_precomp = pairing_policy::precompute_g1(proof.g_C);
-                        const g1_precomp acc_precomp = pairing_policy::precompute_g1(acc);
+                        if (primary_inputs.size() != proofs.size()) {
+                            return false;
+                        }
+                        const std::size_t batch_size = proofs.size();
+                        if (!batch_size) {
+                            return true;
+                        }
+
+                        /* the coefficients are drawn up front, in the order of the batch */
+                        std::vector<typename scalar_field_type::value_type> coefficients;
+                        coefficients.reserve(batch_size);
+                        typename scalar_field_type::value_type coefficients_sum = scalar_field_type::value_type::zero();
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            if (processed_verification_key.gamma_ABC_g1.domain_size() < primary_inputs[i]->size() ||
+                                !proofs.is_well_formed(i)) {
+                                return false;
+                            }
+
+                            typename scalar_field_type::value_type coefficient =
+                                algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                            while (coefficient.is_zero()) {
+                                coefficient =
+                                    algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                            }
+                            coefficients.emplace_back(coefficient);
+                            coefficients_sum += coefficient;
+                        }
 
+                        /* \sum_i r_i acc_i is a single accumulation of the primary input \sum_i r_i x_i, whose
+                           multi-exponentiation is split across threads instead of the batch running one
+                           multi-exponentiation per proof; gamma_ABC_g1.first is then counted \sum_i r_i times */
+                        std::size_t input_size = 0;
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            input_size = std::max(input_size, primary_inputs[i]->size());
+                        }
+                        primary_input_type combined_input(input_size);
+                        executor::current().parallel_for(input_size, [&](const std::size_t j) {
+                            typename scalar_field_type::value_type x = scalar_field_type::value_type::zero();
+                            for (std::size_t i = 0; i < batch_size; ++i) {
+                                if (j < primary_inputs[i]->size()) {
+                                    x += coefficients[i] * (*primary_inputs[i])[j];
+                                }
+                            }
+                            combined_input[j] = x;
+                        });
+                        const typename g1_type::value_type acc_sum =
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::accumulate_primary_input(
+                                processed_verification_key, combined_input) +
+                            (coefficients_sum - scalar_field_type::value_type::one()) *
+                                processed_verification_key.gamma_ABC_g1.first;
+
+                        /* the r_i A_i are paired one by one with the B_i, while \sum_i r_i C_i only meets delta
+                           and is one multi-exponentiation over the batch */
+                        const std::vector<typename g1_type::value_type> scaled_g_A =
+                            batch_scalar_mul<g1_type, scalar_field_type>(proofs.g_A.begin(), proofs.g_A.end(),
+                                                                         coefficients.begin());
+                        const typename g1_type::value_type g_C_sum = dispatch_multiexp<multiexp_method_auto>(
+                            proofs.g_C.begin(), proofs.g_C.end(), coefficients.begin(), coefficients.end(),
+                            executor::current().concurrency());
+
+                        stage_profiler::timer pairing_timer("pairing", batch_size + 2);
+                        operation_counter::add(operation_counter::miller_loop, 2);
+                        operation_counter::add(operation_counter::final_exponentiation);
                         const typename fqk_type::value_type QAP1 =
-                            pairing_policy::miller_loop(proof_g_A_precomp, proof_g_B_precomp);
+                            multi_miller_loop<CurveType>(scaled_g_A.begin(), scaled_g_A.end(), proofs.g_B.begin());
                         const typename fqk_type::value_type QAP2 = pairing_policy::double_miller_loop(
-                            acc_precomp, processed_verification_key.vk_gamma_g2_precomp, proof_g_C_precomp,
-                            processed_verification_key.vk_delta_g2_precomp);
+                            pairing_policy::precompute_g1(acc_sum), processed_verification_key.vk_gamma_g2_precomp,
+                            pairing_policy::precompute_g1(g_C_sum), processed_verification_key.vk_delta_g2_precomp);
+                        const typename gt_type::value_type QAP =
+                            pairing_policy::final_exponentiation(QAP1 * QAP2.unitary_inversed());
+
+                        return QAP == processed_verification_key.vk_alpha_g1_beta_g2.pow(coefficients_sum.data);
+                    }
+
+                private:
+                    static inline bool process_accumulated(
+                        const processed_verification_key_type &processed_verification_key,
+                        const typename g1_type::value_type &acc, const proof_type &proof) {
+                        bool result = true;
+
+                        if (!proof.is_well_formed()) {
+                            result = false;
+                        }
+
+                        stage_profiler::timer pairing_timer("pairing", 3);
+                        operation_counter::add(operation_counter::miller_loop, 3);
+                        operation_counter::add(operation_counter::final_exponentiation);
+                        /* the Miller loop of the proof and the double one against the key run side by side */
+                        typename fqk_type::value_type QAP1 = fqk_type::value_type::one(),
+                                                      QAP2 = fqk_type::value_type::one();
+                        executor::current().bulk(2, [&](const std::size_t i) {
+                            if (i == 0) {
+                                QAP1 = pairing_policy::miller_loop(pairing_policy::precompute_g1(proof.g_A),
+                                                                   pairing_policy::precompute_g2(proof.g_B));
+                            } else {
+                                QAP2 = pairing_policy::double_miller_loop(
+                                    pairing_policy::precompute_g1(acc), processed_verification_key.vk_gamma_g2_precomp,
+                                    pairing_policy::precompute_g1(proof.g_C),
+                                    processed_verification_key.vk_delta_g2_precomp);
+                            }
+                        });
                         const typename gt_type::value_type QAP =
                             pairing_policy::final_exponentiation(QAP1 * QAP2.unitary_inversed());
 
@@ -199,10 +541,15 @@ namespace nil {
                 class r1cs_gg_ppzksnark_verifier_strong_input_consistency {
                     typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
 
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+
                 public:
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
@@ -210,6 +557,7 @@ namespace nil {
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
+                    typedef typename policy_type::proof_batch_type proof_batch_type;
 
                     /**
                      * A verifier algorithm for the R1CS GG-ppzkSNARK that:
@@ -217,7 +565,7 @@ namespace nil {
                      * (2) has strong input consistency.
                      */
                     static inline bool process(const verification_key_type &verification_key,
-                                               const primary_input_type &primary_input,
+                                               const primary_input_span_type &primary_input,
                                                const proof_type &proof) {
 
                         return process(r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(verification_key),
@@ -230,7 +578,7 @@ namespace nil {
                      * (2) has strong input consistency.
                      */
                     static inline bool process(const processed_verification_key_type &processed_verification_key,
-                                               const primary_input_type &primary_input,
+                                               const primary_input_span_type &primary_input,
                                                const proof_type &proof) {
                         bool result = true;
 
@@ -243,6 +591,124 @@ namespace nil {
 
                         return result;
                     }
+
+                    /**
+                     * A verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts the digest of a verification key held by a registry, and
+                     * (2) has strong input consistency.
+                     *
+                     * Throws std::out_of_range when the registry does not hold the key.
+                     */
+                    template<typename Hash>
+                    static inline bool
+                        process(const r1cs_gg_ppzksnark_verification_key_registry<CurveType, Hash> &registry,
+                                const typename r1cs_gg_ppzksnark_verification_key_registry<CurveType,
+                                                                                           Hash>::digest_type &digest,
+                                const primary_input_span_type &primary_input,
+                                const proof_type &proof) {
+                        return process(*registry.at(digest), primary_input, proof);
+                    }
+
+                    /**
+                     * A verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts a processed verification key,
+                     * (2) has strong input consistency, and
+                     * (3) takes the primary input accumulated, chunk by chunk, by a cursor started at index 0
+                     * of the gamma_ABC_g1 query of the key.
+                     */
+                    static inline bool process(const processed_verification_key_type &processed_verification_key,
+                                               const accumulation_cursor<g1_type> &accumulated_input,
+                                               const proof_type &proof) {
+                        /* the whole input, from index 0, and every entry of the query were accumulated */
+                        if (accumulated_input.start() != 0 ||
+                            processed_verification_key.gamma_ABC_g1.domain_size() != accumulated_input.offset() ||
+                            accumulated_input.remaining() != 0) {
+                            return false;
+                        }
+
+                        return r1cs_gg_ppzksnark_verifier_weak_input_consistency<CurveType>::process(
+                            processed_verification_key, accumulated_input, proof);
+                    }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(verification_key),
+                            primary_inputs_first, primary_inputs_last, proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS GG-ppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &processed_verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (processed_verification_key.gamma_ABC_g1.domain_size() != it->size()) {
+                                return false;
+                            }
+                        }
+
+                        return r1cs_gg_ppzksnark_verifier_weak_input_consistency<CurveType>::template process_batch<
+                            DistributionType, GeneratorType>(processed_verification_key, primary_inputs_first,
+                                                             primary_inputs_last, proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * Same as above for a non-processed verification key and the proofs of a batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator>
+                    static inline bool process_batch(const verification_key_type &verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     const proof_batch_type &proofs) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(verification_key),
+                            primary_inputs_first, primary_inputs_last, proofs);
+                    }
+
+                    /**
+                     * Same as above for the proofs of a batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator>
+                    static inline bool process_batch(const processed_verification_key_type &processed_verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     const proof_batch_type &proofs) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (processed_verification_key.gamma_ABC_g1.domain_size() != it->size()) {
+                                return false;
+                            }
+                        }
+
+                        return r1cs_gg_ppzksnark_verifier_weak_input_consistency<CurveType>::template process_batch<
+                            DistributionType, GeneratorType>(processed_verification_key, primary_inputs_first,
+                                                             primary_inputs_last, proofs);
+                    }
                 };
 
                 /**
@@ -269,6 +735,8 @@ namespace nil {
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
+                    typedef typename policy_type::primary_input_span_type primary_input_span_type;
+                    typedef typename policy_type::auxiliary_input_span_type auxiliary_input_span_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
@@ -278,7 +746,7 @@ namespace nil {
                     typedef typename policy_type::proof_type proof_type;
 
                     static inline bool process(const verification_key_type &verification_key,
-                                               const primary_input_type &primary_input,
+                                               const primary_input_span_type &primary_input,
                                                const proof_type &proof) {
 
                         BOOST_ASSERT(verification_key.gamma_ABC_g1.domain_size() >= primary_input.size());
@@ -292,6 +760,9 @@ namespace nil {
                             verification_key.gamma_ABC_g1.accumulate_chunk(primary_input.begin(), primary_input.end(),
                                                                            0);
                         const typename g1_type::value_type &acc = accumulated_IC.first;
+                        operation_counter::add(operation_counter::g1_exp_term, primary_input.size());
+                        operation_counter::add(operation_counter::miller_loop, 3);
+                        operation_counter::add(operation_counter::final_exponentiation);
 
                         bool result = true;
 
@@ -0,0 +1,117 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the warm-up of R1CS GG-ppzkSNARK proving keys.
+//
+// The first proofs after a key is loaded pay for its page faults, for the start of the thread
+// pool of the executor and, with a processed key read back without its reduction context, for
+// the tables of that context. A worker warms its key up once, before it reports ready:
+//
+//     const memory_residency residency = r1cs_gg_ppzksnark_warm_up<CurveType>::process(pk, true);
+//
+// which faults in, and with lock set locks, the queries of an in-memory key, the precomputed
+// tables of a processed key or the whole file of a memory-mapped key, in parallel on the current
+// executor, see memory_residency.hpp. The constraint system is left as it is. Plain and mapped
+// keys carry no precomputation: their witness maps build the evaluation domain on every proof,
+// a processed key keeping it in its reduction context.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_R1CS_GG_PPZKSNARK_WARM_UP_HPP
+#define CRYPTO3_ZK_R1CS_GG_PPZKSNARK_WARM_UP_HPP
+
+#include <memory>
+
+#include <nil/crypto3/zk/snark/memory_residency.hpp>
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/detail/basic_policy.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_proving_key.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                template<typename CurveType>
+                class r1cs_gg_ppzksnark_warm_up {
+                    typedef detail::r1cs_gg_ppzksnark_basic_policy<CurveType, ProvingMode::Basic> policy_type;
+
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+
+                public:
+                    typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
+                    typedef typename policy_type::mapped_proving_key_type mapped_proving_key_type;
+
+                    static inline memory_residency process(const proving_key_type &proving_key,
+                                                           const bool lock = false) {
+                        warm_up_executor();
+
+                        memory_residency residency;
+                        residency += prefault_memory(proving_key.A_query, lock);
+                        residency += prefault_memory(proving_key.B_query.indices, lock);
+                        residency += prefault_memory(proving_key.B_query.values, lock);
+                        residency += prefault_memory(proving_key.H_query, lock);
+                        residency += prefault_memory(proving_key.L_query, lock);
+                        return residency;
+                    }
+
+                    /**
+                     * Also builds the reduction context and the combs of delta of a key processed without
+                     * them, e.g. after it was read back, which the prover would otherwise build on every
+                     * proof or do without.
+                     */
+                    static inline memory_residency process(processed_proving_key_type &processed_proving_key,
+                                                           const bool lock = false) {
+                        if (!processed_proving_key.context) {
+                            processed_proving_key.context = reductions::r1cs_to_qap<scalar_field_type>::shared_context(
+                                processed_proving_key.proving_key.constraint_system);
+                        }
+                        if (processed_proving_key.delta_g1_comb.empty() ||
+                            processed_proving_key.delta_g2_comb.empty()) {
+                            processed_proving_key.precompute_delta_combs();
+                        }
+
+                        memory_residency residency = process(processed_proving_key.proving_key, lock);
+                        residency += prefault_memory(processed_proving_key.A_query_precomp.table, lock);
+                        residency += prefault_memory(processed_proving_key.B_query_g_precomp.table, lock);
+                        residency += prefault_memory(processed_proving_key.B_query_h_precomp.table, lock);
+                        residency += prefault_memory(processed_proving_key.H_query_precomp.table, lock);
+                        residency += prefault_memory(processed_proving_key.L_query_precomp.table, lock);
+                        residency += prefault_memory(processed_proving_key.delta_g1_comb.table, lock);
+                        residency += prefault_memory(processed_proving_key.delta_g2_comb.table, lock);
+                        return residency;
+                    }
+
+                    static inline memory_residency process(const mapped_proving_key_type &proving_key,
+                                                           const bool lock = false) {
+                        warm_up_executor();
+                        return proving_key.prefault(lock);
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_R1CS_GG_PPZKSNARK_WARM_UP_HPP
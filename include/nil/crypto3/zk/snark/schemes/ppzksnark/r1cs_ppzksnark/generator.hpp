@@ -34,9 +34,9 @@
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/zk/snark/batch_normalizer.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
 
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
@@ -149,45 +149,34 @@ namespace nil {
                                                          non_zero_Bt + non_zero_Ht + Kt.size();
                         const std::size_t g2_exp_count = non_zero_Bt;
 
-                        std::size_t g1_window = algebra::get_exp_window_size<g1_type>(g1_exp_count);
-                        std::size_t g2_window = algebra::get_exp_window_size<g2_type>(g2_exp_count);
-
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                             // var or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
-
-                        algebra::window_table<g1_type> g1_table = algebra::get_window_table<g1_type>(
-                            scalar_field_type::value_bits, g1_window, g1_type::value_type::one());
-
-                        algebra::window_table<g2_type> g2_table = algebra::get_window_table<g2_type>(
-                            scalar_field_type::value_bits, g2_window, g2_type::value_type::one());
+                        /* the tables of the group generators are shared with the other generator calls */
+                        const std::shared_ptr<const fixed_base_engine<g1_type, scalar_field_type>> g1_engine =
+                            fixed_base_engine<g1_type, scalar_field_type>::shared(g1_type::value_type::one(),
+                                                                                  g1_exp_count);
+                        const std::shared_ptr<const fixed_base_engine<g2_type, scalar_field_type>> g2_engine =
+                            fixed_base_engine<g2_type, scalar_field_type>::shared(g2_type::value_type::one(),
+                                                                                  g2_exp_count);
 
                         knowledge_commitment_vector<g1_type, g1_type> A_query =
-                            kc_batch_exp<g1_type, g1_type, scalar_field_type>(scalar_field_type::value_bits, g1_window, g1_window, g1_table,
-                                                  g1_table, rA, rA * alphaA, At, chunks);
+                            kc_batch_exp(*g1_engine, *g1_engine, rA, rA * alphaA, At);
 
                         knowledge_commitment_vector<g2_type, g1_type> B_query =
-                            kc_batch_exp<g2_type, g1_type, scalar_field_type>(scalar_field_type::value_bits, g2_window, g1_window, g2_table, g1_table, rB,
-                                           rB * alphaB, Bt, chunks);
+                            kc_batch_exp(*g2_engine, *g1_engine, rB, rB * alphaB, Bt);
 
                         knowledge_commitment_vector<g1_type, g1_type> C_query =
-                            kc_batch_exp<g1_type, g1_type, scalar_field_type>(scalar_field_type::value_bits, g1_window, g1_window, g1_table, g1_table, rC,
-                                           rC * alphaC, Ct, chunks);
+                            kc_batch_exp(*g1_engine, *g1_engine, rC, rC * alphaC, Ct);
+
+                        typename std::vector<typename g1_type::value_type> H_query = g1_engine->batch_exp(Ht);
 
-                        typename std::vector<typename g1_type::value_type> H_query =
-                            algebra::batch_exp<g1_type, scalar_field_type>(scalar_field_type::value_bits, g1_window, g1_table, Ht);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<g1_type>(H_query);
-#endif
+                        typename std::vector<typename g1_type::value_type> K_query = g1_engine->batch_exp(Kt);
 
-                        typename std::vector<typename g1_type::value_type> K_query =
-                            algebra::batch_exp<g1_type, scalar_field_type>(scalar_field_type::value_bits, g1_window, g1_table, Kt);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<g1_type>(K_query);
-#endif
+                        key_normalizer<g1_type, g2_type> normalizer;
+                        normalizer.add(A_query);
+                        normalizer.add(B_query);
+                        normalizer.add(C_query);
+                        normalizer.add(H_query);
+                        normalizer.add(K_query);
+                        normalizer.run();
 
                         typename g2_type::value_type alphaA_g2 = alphaA * g2_type::value_type::one();
                         typename g1_type::value_type alphaB_g1 = alphaB * g1_type::value_type::one();
@@ -205,7 +194,7 @@ namespace nil {
                             multiplied_IC_coefficients.emplace_back(rA * IC_coefficients[i]);
                         }
                         typename std::vector<typename g1_type::value_type> encoded_IC_values =
-                            algebra::batch_exp<g1_type, scalar_field_type>(scalar_field_type::value_bits, g1_window, g1_table, multiplied_IC_coefficients);
+                            g1_engine->batch_exp(multiplied_IC_coefficients);
 
                         accumulation_vector<g1_type> encoded_IC_query(std::move(encoded_IC_base),
                                                                       std::move(encoded_IC_values));
@@ -27,6 +27,7 @@
 #define CRYPTO3_R1CS_PPZKSNARK_BASIC_PROVER_HPP
 
 #include <memory>
+#include <vector>
 
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
@@ -36,9 +37,10 @@
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
 #include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
@@ -80,63 +82,106 @@ namespace nil {
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
 
+                    /**
+                     * The four multi-exponentiations over the queries A, B, C and K only depend on the
+                     * variable assignment, built once and shared by all of them. They are split into tasks
+                     * of similar cost and run together on the current executor, alongside the FFTs of the
+                     * witness map computing the scalars of H_query, whose tasks follow once H is known.
+                     */
                     static inline proof_type process(const proving_key_type &proving_key,
                                                      const primary_input_type &primary_input,
                                                      const auxiliary_input_type &auxiliary_input) {
 
+                        /* sanity check */
+                        assert(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
+
                         const typename scalar_field_type::value_type d1 = algebra::random_element<scalar_field_type>(),
                                                                      d2 = algebra::random_element<scalar_field_type>(),
                                                                      d3 = algebra::random_element<scalar_field_type>();
 
-                        const qap_witness<scalar_field_type> qap_wit =
-                            reductions::r1cs_to_qap<scalar_field_type>::witness_map(proving_key.constraint_system, primary_input,
-                                                                                    auxiliary_input, d1, d2, d3);
+                        r1cs_variable_assignment<scalar_field_type> assignment = primary_input;
+                        assignment.insert(assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+
+                        const std::size_t num_variables = assignment.size();
+                        const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain =
+                            reductions::r1cs_to_qap<scalar_field_type>::get_domain(proving_key.constraint_system);
+                        const std::size_t degree = domain->m;
+
+                        const std::size_t g1 = multiexp_task_list::g1_cost, g2 = multiexp_task_list::g2_cost;
+                        multiexp_task_list tasks(num_variables * (2 * g1 + (g2 + g1) + 2 * g1 + g1) +
+                                                 (degree + 1) * g1);
+                        /* both parts of A and C, the G1 part of B, K and H over G1; the G2 part of B over G2 */
+                        operation_counter::add(operation_counter::g1_exp_term, 6 * num_variables + (degree + 1));
+                        operation_counter::add(operation_counter::g2_exp_term, num_variables);
+
+                        std::vector<typename scalar_field_type::value_type> coefficients_for_H;
+                        std::vector<typename knowledge_commitment<g1_type, g1_type>::value_type> parts_A, parts_C;
+                        std::vector<typename knowledge_commitment<g2_type, g1_type>::value_type> parts_B;
+                        std::vector<g1_value_type> parts_H, parts_K;
+
+                        /* the witness map, seven FFTs, runs on its own executor alongside the assignment-only
+                           multiexps */
+                        tasks.add_alongside(
+                            [&]() {
+                                typename reductions::r1cs_to_qap<scalar_field_type>::workspace scratch;
+                                coefficients_for_H = reductions::r1cs_to_qap<scalar_field_type>::coefficients_for_H(
+                                    proving_key.constraint_system, assignment, d1, d2, d3, domain, scratch);
+                            },
+                            multiexp_task_list::fft_cost(degree, 7));
+
+                        /* variable i + 1 of the queries is scaled by assignment[i] */
+                        tasks.add(parts_B, num_variables, g2 + g1, [&](std::size_t first, std::size_t last) {
+                            return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                proving_key.B_query, 1 + first, 1 + last, assignment.begin() + first,
+                                assignment.begin() + last, 1);
+                        });
+
+                        tasks.add(parts_A, num_variables, 2 * g1, [&](std::size_t first, std::size_t last) {
+                            return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                proving_key.A_query, 1 + first, 1 + last, assignment.begin() + first,
+                                assignment.begin() + last, 1);
+                        });
+
+                        tasks.add(parts_C, num_variables, 2 * g1, [&](std::size_t first, std::size_t last) {
+                            return kc_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                proving_key.C_query, 1 + first, 1 + last, assignment.begin() + first,
+                                assignment.begin() + last, 1);
+                        });
+
+                        tasks.add(parts_K, num_variables, g1, [&](std::size_t first, std::size_t last) {
+                            return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                proving_key.K_query.begin() + 1 + first, proving_key.K_query.begin() + 1 + last,
+                                assignment.begin() + first, assignment.begin() + last, 1);
+                        });
+
+                        stage_profiler::timer multiexp_timer("multiexp", num_variables + 1);
+                        tasks.run();
+                        multiexp_timer.stop();
+
+                        tasks.add(parts_H, degree + 1, g1, [&](std::size_t first, std::size_t last) {
+                            return dispatch_multiexp<multiexp_method_auto>(
+                                proving_key.H_query.begin() + first, proving_key.H_query.begin() + last,
+                                coefficients_for_H.begin() + first, coefficients_for_H.begin() + last, 1);
+                        });
+
+                        stage_profiler::timer multiexp_H_timer("multiexp_H", degree + 1);
+                        tasks.run();
+                        multiexp_H_timer.stop();
 
                         typename knowledge_commitment<g1_type, g1_type>::value_type g_A =
-                            proving_key.A_query[0] + qap_wit.d1 * proving_key.A_query[qap_wit.num_variables + 1];
+                            proving_key.A_query[0] + d1 * proving_key.A_query[num_variables + 1] +
+                            multiexp_task_list::sum(parts_A);
                         typename knowledge_commitment<g2_type, g1_type>::value_type g_B =
-                            proving_key.B_query[0] + qap_wit.d2 * proving_key.B_query[qap_wit.num_variables + 1];
+                            proving_key.B_query[0] + d2 * proving_key.B_query[num_variables + 1] +
+                            multiexp_task_list::sum(parts_B);
                         typename knowledge_commitment<g1_type, g1_type>::value_type g_C =
-                            proving_key.C_query[0] + qap_wit.d3 * proving_key.C_query[qap_wit.num_variables + 1];
-
-                        g1_value_type g_H = g1_value_type::zero();
-                        g1_value_type g_K =
-                            (proving_key.K_query[0] + qap_wit.d1 * proving_key.K_query[qap_wit.num_variables + 1] +
-                             qap_wit.d2 * proving_key.K_query[qap_wit.num_variables + 2] +
-                             qap_wit.d3 * proving_key.K_query[qap_wit.num_variables + 3]);
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                             // var or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
-
-                        g_A = g_A + kc_multiexp_with_mixed_addition<algebra::policies::multiexp_method_bos_coster>(
-                                        proving_key.A_query, 1, 1 + qap_wit.num_variables,
-                                        qap_wit.coefficients_for_ABCs.begin(),
-                                        qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables + 1, chunks);
-
-                        g_B = g_B + kc_multiexp_with_mixed_addition<algebra::policies::multiexp_method_bos_coster>(
-                                        proving_key.B_query, 1, 1 + qap_wit.num_variables,
-                                        qap_wit.coefficients_for_ABCs.begin(),
-                                        qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables + 1, chunks);
-
-                        g_C = g_C + kc_multiexp_with_mixed_addition<algebra::policies::multiexp_method_bos_coster>(
-                                        proving_key.C_query, 1, 1 + qap_wit.num_variables,
-                                        qap_wit.coefficients_for_ABCs.begin(),
-                                        qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables + 1, chunks);
-
-                        g_H = g_H + algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                        proving_key.H_query.begin(), proving_key.H_query.begin() + qap_wit.degree + 1,
-                                        qap_wit.coefficients_for_H.begin(),
-                                        qap_wit.coefficients_for_H.begin() + qap_wit.degree + 1, chunks);
-
-                        g_K =
-                            g_K + algebra::multiexp_with_mixed_addition<algebra::policies::multiexp_method_bos_coster>(
-                                      proving_key.K_query.begin() + 1,
-                                      proving_key.K_query.begin() + 1 + qap_wit.num_variables,
-                                      qap_wit.coefficients_for_ABCs.begin(),
-                                      qap_wit.coefficients_for_ABCs.begin() + qap_wit.num_variables, chunks);
+                            proving_key.C_query[0] + d3 * proving_key.C_query[num_variables + 1] +
+                            multiexp_task_list::sum(parts_C);
+                        g1_value_type g_H = multiexp_task_list::sum(parts_H);
+                        g1_value_type g_K = proving_key.K_query[0] + d1 * proving_key.K_query[num_variables + 1] +
+                                            d2 * proving_key.K_query[num_variables + 2] +
+                                            d3 * proving_key.K_query[num_variables + 3] +
+                                            multiexp_task_list::sum(parts_K);
 
                         return proof_type(std::move(g_A), std::move(g_B), std::move(g_C), std::move(g_H),
                                           std::move(g_K));
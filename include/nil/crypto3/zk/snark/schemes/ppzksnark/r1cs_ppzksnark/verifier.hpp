@@ -26,11 +26,21 @@
 #ifndef CRYPTO3_R1CS_PPZKSNARK_BASIC_VERIFIER_HPP
 #define CRYPTO3_R1CS_PPZKSNARK_BASIC_VERIFIER_HPP
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <vector>
+
+#include <nil/crypto3/algebra/random_element.hpp>
 
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
+
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_ppzksnark/detail/basic_policy.hpp>
@@ -132,84 +142,218 @@ namespace nil {
                      * A verifier algorithm for the R1CS ppzkSNARK that:
                      * (1) accepts a processed verification key, and
                      * (2) has weak input consistency.
+                     *
+                     * The five verification equations are combined as in a batch of one proof, see
+                     * accumulate_batch, so a proof costs nine Miller loops and a single final
+                     * exponentiation instead of twelve and five.
                      */
                     static inline bool process(const processed_verification_key_type &processed_verification_key,
                                                const primary_input_type &primary_input,
                                                const proof_type &proof) {
+                        return process_batch(processed_verification_key, &primary_input, &primary_input + 1, &proof,
+                                             &proof + 1);
+                    }
 
-                        assert(processed_verification_key.encoded_IC_query.domain_size() >= primary_input.size());
+                    /**
+                     * A batch verifier algorithm for the R1CS ppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has weak input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_ppzksnark_process_verification_key<CurveType>::process(verification_key),
+                            primary_inputs_first, primary_inputs_last, proofs_first, proofs_last);
+                    }
 
-                        const accumulation_vector<g1_type> accumulated_IC =
-                            processed_verification_key.encoded_IC_query.accumulate_chunk(
-                                primary_input.begin(), primary_input.end(), 0);
-                        const g1_value_type &acc = accumulated_IC.first;
+                    /**
+                     * A batch verifier algorithm for the R1CS ppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has weak input consistency.
+                     *
+                     * Verifies every proof of [proofs_first, proofs_last) against the primary input at the
+                     * same position of [primary_inputs_first, primary_inputs_last), with the Miller loops of
+                     * accumulate_batch and a single final exponentiation for the whole batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &processed_verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        typename fqk_type::value_type miller_loop_product = fqk_type::value_type::one();
+                        if (!accumulate_batch<DistributionType, GeneratorType>(
+                                processed_verification_key, primary_inputs_first, primary_inputs_last, proofs_first,
+                                proofs_last, miller_loop_product)) {
+                            return false;
+                        }
 
-                        bool result = true;
+                        operation_counter::add(operation_counter::final_exponentiation);
+                        return pairing_policy::final_exponentiation(miller_loop_product) == gt_value_type::one();
+                    }
 
-                        if (!proof.is_well_formed()) {
-                            result = false;
+                    /**
+                     * Multiplies into miller_loop_product the Miller loops checking a batch of proofs of the
+                     * R1CS ppzkSNARK against a processed verification key, with weak input consistency.
+                     * The batch verifies iff the final exponentiation of the product is one, so batches
+                     * against different keys are accumulated into the same product and share one final
+                     * exponentiation. Returns false if a proof is not well formed or a primary input is
+                     * longer than the key.
+                     *
+                     * The five verification equations of every proof are scaled by their own random non-zero
+                     * coefficients and summed over the batch. The pairings against the fixed elements of the
+                     * key then take the sums of their other sides, so that besides the pairings e(A_i + acc_i,
+                     * B_i), which run two proofs at a time (see multi_miller_loop), a batch costs eight Miller
+                     * loops whatever its size. A batch with an invalid proof passes with negligible
+                     * probability over the choice of the coefficients, drawn from GeneratorType, the entropy
+                     * of the system by default. Returns false as well when the batch holds more or fewer
+                     * primary inputs than proofs.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool
+                        accumulate_batch(const processed_verification_key_type &processed_verification_key,
+                                         InputPrimaryInputIterator primary_inputs_first,
+                                         InputPrimaryInputIterator primary_inputs_last,
+                                         InputProofIterator proofs_first,
+                                         InputProofIterator proofs_last,
+                                         typename fqk_type::value_type &miller_loop_product) {
+                        typedef typename scalar_field_type::value_type scalar_field_value_type;
+
+                        std::vector<const primary_input_type *> primary_inputs;
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            primary_inputs.emplace_back(&*it);
                         }
-                        g1_precomp proof_g_A_g_precomp = pairing_policy::precompute_g1(proof.g_A.g);
-                        g1_precomp proof_g_A_h_precomp = pairing_policy::precompute_g1(proof.g_A.h);
-                        typename fqk_type::value_type kc_A_1 = pairing_policy::miller_loop(
-                            proof_g_A_g_precomp, processed_verification_key.vk_alphaA_g2_precomp);
-                        typename fqk_type::value_type kc_A_2 = pairing_policy::miller_loop(
-                            proof_g_A_h_precomp, processed_verification_key.pp_G2_one_precomp);
-                        gt_value_type kc_A = pairing_policy::final_exponentiation(kc_A_1 * kc_A_2.unitary_inversed());
-                        if (kc_A != gt_value_type::one()) {
-                            result = false;
+                        std::vector<const proof_type *> proofs;
+                        for (InputProofIterator it = proofs_first; it != proofs_last; ++it) {
+                            proofs.emplace_back(&*it);
                         }
 
-                        g2_precomp proof_g_B_g_precomp = pairing_policy::precompute_g2(proof.g_B.g);
-                        g1_precomp proof_g_B_h_precomp = pairing_policy::precompute_g1(proof.g_B.h);
-                        typename fqk_type::value_type kc_B_1 = pairing_policy::miller_loop(
-                            processed_verification_key.vk_alphaB_g1_precomp, proof_g_B_g_precomp);
-                        typename fqk_type::value_type kc_B_2 = pairing_policy::miller_loop(
-                            proof_g_B_h_precomp, processed_verification_key.pp_G2_one_precomp);
-                        gt_value_type kc_B = pairing_policy::final_exponentiation(kc_B_1 * kc_B_2.unitary_inversed());
-                        if (kc_B != gt_value_type::one()) {
-                            result = false;
+                        if (primary_inputs.size() != proofs.size()) {
+                            return false;
                         }
-
-                        g1_precomp proof_g_C_g_precomp = pairing_policy::precompute_g1(proof.g_C.g);
-                        g1_precomp proof_g_C_h_precomp = pairing_policy::precompute_g1(proof.g_C.h);
-                        typename fqk_type::value_type kc_C_1 = pairing_policy::miller_loop(
-                            proof_g_C_g_precomp, processed_verification_key.vk_alphaC_g2_precomp);
-                        typename fqk_type::value_type kc_C_2 = pairing_policy::miller_loop(
-                            proof_g_C_h_precomp, processed_verification_key.pp_G2_one_precomp);
-                        gt_value_type kc_C = pairing_policy::final_exponentiation(kc_C_1 * kc_C_2.unitary_inversed());
-                        if (kc_C != gt_value_type::one()) {
-                            result = false;
+                        const std::size_t batch_size = proofs.size();
+                        if (!batch_size) {
+                            return true;
                         }
 
-                        // check that g^((A+acc)*B)=g^(H*\Prod(t-\sigma)+C)
-                        // equivalently, via pairings, that e(g^(A+acc), g^B) = e(g^H, g^Z) + e(g^C, g^1)
-                        g1_precomp proof_g_A_g_acc_precomp = pairing_policy::precompute_g1(proof.g_A.g + acc);
-                        g1_precomp proof_g_H_precomp = pairing_policy::precompute_g1(proof.g_H);
-                        typename fqk_type::value_type QAP_1 =
-                            pairing_policy::miller_loop(proof_g_A_g_acc_precomp, proof_g_B_g_precomp);
-                        typename fqk_type::value_type QAP_23 = pairing_policy::double_miller_loop(
-                            proof_g_H_precomp, processed_verification_key.vk_rC_Z_g2_precomp, proof_g_C_g_precomp,
-                            processed_verification_key.pp_G2_one_precomp);
-                        gt_value_type QAP = pairing_policy::final_exponentiation(QAP_1 * QAP_23.unitary_inversed());
-                        if (QAP != gt_value_type::one()) {
-                            result = false;
+                        /* the coefficients of the knowledge commitment checks of A, B and C, of the QAP check
+                         * and of the K check are drawn up front, in the order of the batch */
+                        constexpr const std::size_t num_checks = 5;
+                        std::vector<scalar_field_value_type> coefficients;
+                        coefficients.reserve(num_checks * batch_size);
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            if (processed_verification_key.encoded_IC_query.domain_size() <
+                                    primary_inputs[i]->size() ||
+                                !proofs[i]->is_well_formed()) {
+                                return false;
+                            }
+
+                            for (std::size_t k = 0; k < num_checks; ++k) {
+                                scalar_field_value_type coefficient =
+                                    algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                while (coefficient.is_zero()) {
+                                    coefficient =
+                                        algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                }
+                                coefficients.emplace_back(coefficient);
+                            }
                         }
 
-                        g1_precomp proof_g_K_precomp = pairing_policy::precompute_g1(proof.g_K);
-                        g1_precomp proof_g_A_g_acc_C_precomp =
-                            pairing_policy::precompute_g1((proof.g_A.g + acc) + proof.g_C.g);
-                        typename fqk_type::value_type K_1 = pairing_policy::miller_loop(
-                            proof_g_K_precomp, processed_verification_key.vk_gamma_g2_precomp);
-                        typename fqk_type::value_type K_23 = pairing_policy::double_miller_loop(
-                            proof_g_A_g_acc_C_precomp, processed_verification_key.vk_gamma_beta_g2_precomp,
-                            processed_verification_key.vk_gamma_beta_g1_precomp, proof_g_B_g_precomp);
-                        gt_value_type K = pairing_policy::final_exponentiation(K_1 * K_23.unitary_inversed());
-                        if (K != gt_value_type::one()) {
-                            result = false;
+                        /* the sides paired with the fixed elements of the key, accumulated per block of proofs */
+                        struct sums_type {
+                            g1_value_type A_g, C_g, K, H, A_acc_C, one;
+                            g2_value_type B_g_alpha, B_g_gamma;
+                        };
+                        const std::size_t num_blocks = std::min(batch_size, executor::current().concurrency());
+                        const std::size_t block_size = (batch_size + num_blocks - 1) / num_blocks;
+
+                        std::vector<g1_value_type> scaled_A_acc(batch_size);
+                        std::vector<g2_value_type> B_g(batch_size);
+                        std::vector<sums_type> block_sums(
+                            num_blocks,
+                            {g1_value_type::zero(), g1_value_type::zero(), g1_value_type::zero(),
+                             g1_value_type::zero(), g1_value_type::zero(), g1_value_type::zero(),
+                             g2_value_type::zero(), g2_value_type::zero()});
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            sums_type &sums = block_sums[block];
+                            const std::size_t end = std::min(batch_size, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                const proof_type &proof = *proofs[i];
+                                const scalar_field_value_type *r = &coefficients[num_checks * i];
+
+                                const g1_value_type A_acc =
+                                    proof.g_A.g + processed_verification_key.encoded_IC_query
+                                                      .accumulate_chunk(primary_inputs[i]->begin(),
+                                                                        primary_inputs[i]->end(), 0)
+                                                      .first;
+                                operation_counter::add(operation_counter::g1_exp_term, primary_inputs[i]->size());
+
+                                // e(A_g, alphaA) = e(A_h, 1), e(alphaB, B_g) = e(B_h, 1), e(C_g, alphaC) = e(C_h, 1)
+                                sums.A_g = sums.A_g + r[0] * proof.g_A.g;
+                                sums.B_g_alpha = sums.B_g_alpha + r[1] * proof.g_B.g;
+                                sums.C_g = sums.C_g + r[2] * proof.g_C.g;
+                                sums.one = sums.one + r[0] * proof.g_A.h + r[1] * proof.g_B.h + r[2] * proof.g_C.h;
+
+                                // e(A + acc, B) = e(H, rC_Z) e(C, 1)
+                                scaled_A_acc[i] = r[3] * A_acc;
+                                B_g[i] = proof.g_B.g;
+                                sums.H = sums.H + r[3] * proof.g_H;
+                                sums.one = sums.one + r[3] * proof.g_C.g;
+
+                                // e(K, gamma) = e(A + acc + C, gamma_beta) e(gamma_beta, B)
+                                sums.K = sums.K + r[4] * proof.g_K;
+                                sums.A_acc_C = sums.A_acc_C + r[4] * (A_acc + proof.g_C.g);
+                                sums.B_g_gamma = sums.B_g_gamma + r[4] * proof.g_B.g;
+                            }
+                        });
+
+                        sums_type sums = block_sums[0];
+                        for (std::size_t block = 1; block < num_blocks; ++block) {
+                            sums.A_g = sums.A_g + block_sums[block].A_g;
+                            sums.C_g = sums.C_g + block_sums[block].C_g;
+                            sums.K = sums.K + block_sums[block].K;
+                            sums.H = sums.H + block_sums[block].H;
+                            sums.A_acc_C = sums.A_acc_C + block_sums[block].A_acc_C;
+                            sums.one = sums.one + block_sums[block].one;
+                            sums.B_g_alpha = sums.B_g_alpha + block_sums[block].B_g_alpha;
+                            sums.B_g_gamma = sums.B_g_gamma + block_sums[block].B_g_gamma;
                         }
 
-                        return result;
+                        const typename fqk_type::value_type QAP_1 =
+                            multi_miller_loop<CurveType>(scaled_A_acc.begin(), scaled_A_acc.end(), B_g.begin());
+                        const typename fqk_type::value_type left_1 = pairing_policy::double_miller_loop(
+                            pairing_policy::precompute_g1(sums.A_g), processed_verification_key.vk_alphaA_g2_precomp,
+                            processed_verification_key.vk_alphaB_g1_precomp,
+                            pairing_policy::precompute_g2(sums.B_g_alpha));
+                        const typename fqk_type::value_type left_2 = pairing_policy::double_miller_loop(
+                            pairing_policy::precompute_g1(sums.C_g), processed_verification_key.vk_alphaC_g2_precomp,
+                            pairing_policy::precompute_g1(sums.K), processed_verification_key.vk_gamma_g2_precomp);
+                        const typename fqk_type::value_type right_1 = pairing_policy::double_miller_loop(
+                            pairing_policy::precompute_g1(sums.one), processed_verification_key.pp_G2_one_precomp,
+                            pairing_policy::precompute_g1(sums.H), processed_verification_key.vk_rC_Z_g2_precomp);
+                        const typename fqk_type::value_type right_2 = pairing_policy::double_miller_loop(
+                            pairing_policy::precompute_g1(sums.A_acc_C),
+                            processed_verification_key.vk_gamma_beta_g2_precomp,
+                            processed_verification_key.vk_gamma_beta_g1_precomp,
+                            pairing_policy::precompute_g2(sums.B_g_gamma));
+
+                        operation_counter::add(operation_counter::miller_loop, 8);
+                        miller_loop_product =
+                            miller_loop_product * QAP_1 * left_1 * left_2 * (right_1 * right_2).unitary_inversed();
+                        return true;
                     }
                 };
 
@@ -217,6 +361,10 @@ namespace nil {
                 class r1cs_ppzksnark_verifier_strong_input_consistency {
                     typedef detail::r1cs_ppzksnark_policy<CurveType> policy_type;
 
+                    using pairing_policy = typename CurveType::pairing;
+                    using scalar_field_type = typename CurveType::scalar_field_type;
+                    using fqk_type = typename pairing_policy::fqk_type;
+
                 public:
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
@@ -261,6 +409,77 @@ namespace nil {
 
                         return result;
                     }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS ppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_ppzksnark_process_verification_key<CurveType>::process(verification_key),
+                            primary_inputs_first, primary_inputs_last, proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS ppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &processed_verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (processed_verification_key.encoded_IC_query.domain_size() != it->size()) {
+                                return false;
+                            }
+                        }
+
+                        return r1cs_ppzksnark_verifier_weak_input_consistency<CurveType>::template process_batch<
+                            DistributionType, GeneratorType>(processed_verification_key, primary_inputs_first,
+                                                             primary_inputs_last, proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * Accumulates the Miller loops of a batch with strong input consistency, see
+                     * r1cs_ppzksnark_verifier_weak_input_consistency::accumulate_batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool
+                        accumulate_batch(const processed_verification_key_type &processed_verification_key,
+                                         InputPrimaryInputIterator primary_inputs_first,
+                                         InputPrimaryInputIterator primary_inputs_last,
+                                         InputProofIterator proofs_first,
+                                         InputProofIterator proofs_last,
+                                         typename fqk_type::value_type &miller_loop_product) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (processed_verification_key.encoded_IC_query.domain_size() != it->size()) {
+                                return false;
+                            }
+                        }
+
+                        return r1cs_ppzksnark_verifier_weak_input_consistency<CurveType>::template accumulate_batch<
+                            DistributionType, GeneratorType>(processed_verification_key, primary_inputs_first,
+                                                             primary_inputs_last, proofs_first, proofs_last,
+                                                             miller_loop_product);
+                    }
                 };
 
                 /**
@@ -26,6 +26,8 @@
 #ifndef CRYPTO3_R1CS_SE_PPZKSNARK_HPP
 #define CRYPTO3_R1CS_SE_PPZKSNARK_HPP
 
+#include <vector>
+
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_se_ppzksnark/detail/basic_policy.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_se_ppzksnark/generator.hpp>
@@ -79,6 +81,7 @@ namespace nil {
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
                     typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
 
@@ -96,12 +99,37 @@ namespace nil {
                         return Prover::process(pk, primary_input, auxiliary_input);
                     }
 
+                    static inline proof_type prove(const processed_proving_key_type &ppk,
+                                                   const primary_input_type &primary_input,
+                                                   const auxiliary_input_type &auxiliary_input) {
+
+                        return Prover::process(ppk, primary_input, auxiliary_input);
+                    }
+
+                    template<typename ProvingKey, typename InputWitnessIterator>
+                    static inline std::vector<proof_type> prove_batch(const ProvingKey &pk,
+                                                                      InputWitnessIterator witnesses_first,
+                                                                      InputWitnessIterator witnesses_last) {
+
+                        return Prover::process_batch(pk, witnesses_first, witnesses_last);
+                    }
+
                     template<typename VerificationKey>
                     static inline bool verify(const VerificationKey &vk,
                                               const primary_input_type &primary_input,
                                               const proof_type &proof) {
                         return Verifier::process(vk, primary_input, proof);
                     }
+
+                    template<typename VerificationKey, typename InputPrimaryInputIterator, typename InputProofIterator>
+                    static inline bool verify_batch(const VerificationKey &vk,
+                                                    InputPrimaryInputIterator primary_inputs_first,
+                                                    InputPrimaryInputIterator primary_inputs_last,
+                                                    InputProofIterator proofs_first,
+                                                    InputProofIterator proofs_last) {
+                        return Verifier::process_batch(vk, primary_inputs_first, primary_inputs_last, proofs_first,
+                                                       proofs_last);
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
@@ -103,6 +103,18 @@ namespace nil {
                          */
                         typedef r1cs_se_ppzksnark_proving_key<CurveType, constraint_system_type> proving_key_type;
 
+                        /************************** Processed proving key ****************************/
+
+                        /**
+                         * A processed proving key for the R1CS SEppzkSNARK.
+                         *
+                         * Compared to a (non-processed) proving key, a processed proving key contains
+                         * fixed-base precomputation of the query vectors that trades memory for a
+                         * faster proving time.
+                         */
+                        typedef r1cs_se_ppzksnark_processed_proving_key<CurveType, constraint_system_type>
+                            processed_proving_key_type;
+
                         /******************************* Verification key ****************************/
 
                         /**
@@ -32,6 +32,9 @@
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
+#include <nil/crypto3/zk/snark/batch_normalizer.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
+
 #ifdef MULTICORE
 #include <omp.h>
 #endif
@@ -117,19 +120,14 @@ namespace nil {
                                                   1    // G_gamma2_Z_t
                                                   // C_query_1
                                                   + sap_inst.num_variables - sap_inst.num_inputs +
-                                                  sap_inst.num_variables + 1,    // C_query_2
-                            G_window = algebra::get_exp_window_size<typename CurveType::g1_type>(G_exp_count);
-
-                        algebra::window_table<typename CurveType::g1_type> G_table =
-                            algebra::get_window_table<typename CurveType::g1_type>(CurveType::scalar_field_type::value_bits, G_window, G);
+                                                  sap_inst.num_variables + 1;    // C_query_2
+                        const fixed_base_engine<typename CurveType::g1_type, typename CurveType::scalar_field_type>
+                            G_engine(G, G_exp_count);
 
                         typename CurveType::g2_type::value_type H_gamma = gamma * H;
-                        std::size_t H_gamma_exp_count = non_zero_At,    // B_query
-                            H_gamma_window =
-                                algebra::get_exp_window_size<typename CurveType::g2_type>(H_gamma_exp_count);
-                        algebra::window_table<typename CurveType::g2_type> H_gamma_table = algebra::get_window_table<
-                            typename CurveType::g2_type>(
-                            CurveType::scalar_field_type::value_bits, H_gamma_window, H_gamma);
+                        std::size_t H_gamma_exp_count = non_zero_At;    // B_query
+                        const fixed_base_engine<typename CurveType::g2_type, typename CurveType::scalar_field_type>
+                            H_gamma_engine(H_gamma, H_gamma_exp_count);
 
                         typename CurveType::g1_type::value_type G_alpha = alpha * G;
                         typename CurveType::g2_type::value_type H_beta = beta * H;
@@ -140,8 +138,7 @@ namespace nil {
                             tmp_exponents.emplace_back(gamma * Ct[i] + (alpha + beta) * At[i]);
                         }
                         typename std::vector<typename CurveType::g1_type::value_type> verifier_query =
-                            algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(
-                                CurveType::scalar_field_type::value_bits, G_window, G_table, tmp_exponents);
+                            G_engine.batch_exp(tmp_exponents);
                         tmp_exponents.clear();
 
                         tmp_exponents.reserve(sap_inst.num_variables + 1);
@@ -150,18 +147,10 @@ namespace nil {
                         }
 
                         typename std::vector<typename CurveType::g1_type::value_type> A_query =
-                            algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(
-                                CurveType::scalar_field_type::value_bits, G_window, G_table, tmp_exponents);
+                            G_engine.batch_exp(tmp_exponents);
                         tmp_exponents.clear();
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g1_type>(A_query);
-#endif
                         typename std::vector<typename CurveType::g2_type::value_type> B_query =
-                            algebra::batch_exp<typename CurveType::g2_type, typename CurveType::scalar_field_type>(
-                                CurveType::scalar_field_type::value_bits, H_gamma_window, H_gamma_table, At);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g2_type>(B_query);
-#endif
+                            H_gamma_engine.batch_exp(At);
                         typename CurveType::g1_type::value_type G_gamma = gamma * G;
                         typename CurveType::g1_type::value_type G_gamma_Z = sap_inst.Zt * G_gamma;
                         typename CurveType::g2_type::value_type H_gamma_Z = sap_inst.Zt * H_gamma;
@@ -177,23 +166,15 @@ namespace nil {
                             gamma2_Z_t *= t;
                         }
                         typename std::vector<typename CurveType::g1_type::value_type> G_gamma2_Z_t =
-                            algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(
-                                CurveType::scalar_field_type::value_bits, G_window, G_table, tmp_exponents);
+                            G_engine.batch_exp(tmp_exponents);
                         tmp_exponents.clear();
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g1_type>(G_gamma2_Z_t);
-#endif
                         tmp_exponents.reserve(sap_inst.num_variables - sap_inst.num_inputs);
                         for (std::size_t i = sap_inst.num_inputs + 1; i <= sap_inst.num_variables; ++i) {
                             tmp_exponents.emplace_back(gamma * (gamma * Ct[i] + (alpha + beta) * At[i]));
                         }
                         typename std::vector<typename CurveType::g1_type::value_type> C_query_1 =
-                            algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(
-                                CurveType::scalar_field_type::value_bits, G_window, G_table, tmp_exponents);
+                            G_engine.batch_exp(tmp_exponents);
                         tmp_exponents.clear();
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g1_type>(C_query_1);
-#endif
 
                         tmp_exponents.reserve(sap_inst.num_variables + 1);
                         typename CurveType::scalar_field_type::value_type double_gamma2_Z = gamma * gamma * sap_inst.Zt;
@@ -202,12 +183,16 @@ namespace nil {
                             tmp_exponents.emplace_back(double_gamma2_Z * At[i]);
                         }
                         typename std::vector<typename CurveType::g1_type::value_type> C_query_2 =
-                            algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(
-                                CurveType::scalar_field_type::value_bits, G_window, G_table, tmp_exponents);
+                            G_engine.batch_exp(tmp_exponents);
                         tmp_exponents.clear();
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g1_type>(C_query_2);
-#endif
+
+                        key_normalizer<typename CurveType::g1_type, typename CurveType::g2_type> normalizer;
+                        normalizer.add(A_query);
+                        normalizer.add(B_query);
+                        normalizer.add(C_query_1);
+                        normalizer.add(C_query_2);
+                        normalizer.add(G_gamma2_Z_t);
+                        normalizer.run();
 
                         verification_key_type vk =
                             verification_key_type(H, G_alpha, H_beta, G_gamma, H_gamma, std::move(verifier_query));
@@ -26,7 +26,9 @@
 #ifndef CRYPTO3_ZK_R1CS_SE_PPZKSNARK_BASIC_PROVER_HPP
 #define CRYPTO3_ZK_R1CS_SE_PPZKSNARK_BASIC_PROVER_HPP
 
+#include <iterator>
 #include <memory>
+#include <vector>
 
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
 
@@ -35,9 +37,10 @@
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
 
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_sap.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_se_ppzksnark/detail/basic_policy.hpp>
@@ -47,6 +50,58 @@ namespace nil {
         namespace zk {
             namespace snark {
 
+                /**
+                 * Convert a (non-processed) proving key into a processed proving key.
+                 *
+                 * The window parameter sizes the fixed-base tables, as for the GG-ppzkSNARK: every
+                 * query takes ceil(scalar_bits / window) times its own memory. Use
+                 * fixed_base_window_for_budget to derive the window from a memory budget.
+                 */
+                template<typename CurveType>
+                class r1cs_se_ppzksnark_process_proving_key {
+                    typedef detail::r1cs_se_ppzksnark_types_policy<CurveType> policy_type;
+
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
+                public:
+                    typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
+
+                    static constexpr const std::size_t default_window = 8;
+
+                    static inline processed_proving_key_type process(const proving_key_type &proving_key,
+                                                                     const std::size_t window = default_window) {
+                        return process(proving_key_type(proving_key), window);
+                    }
+
+                    static inline processed_proving_key_type process(proving_key_type &&proving_key,
+                                                                     const std::size_t window = default_window) {
+                        const std::size_t chunks = executor::current().concurrency();
+
+                        processed_proving_key_type processed_proving_key;
+                        processed_proving_key.proving_key = std::move(proving_key);
+
+                        const proving_key_type &pk = processed_proving_key.proving_key;
+
+                        /* the terms at index 0 have a unit scalar and are added by the prover directly */
+                        processed_proving_key.A_query_precomp = fixed_base_precompute<g1_type, scalar_field_type>(
+                            pk.A_query.begin() + 1, pk.A_query.end(), window, chunks);
+                        processed_proving_key.B_query_precomp = fixed_base_precompute<g2_type, scalar_field_type>(
+                            pk.B_query.begin() + 1, pk.B_query.end(), window, chunks);
+                        processed_proving_key.C_query_1_precomp = fixed_base_precompute<g1_type, scalar_field_type>(
+                            pk.C_query_1.begin(), pk.C_query_1.end(), window, chunks);
+                        processed_proving_key.C_query_2_precomp = fixed_base_precompute<g1_type, scalar_field_type>(
+                            pk.C_query_2.begin() + 1, pk.C_query_2.end(), window, chunks);
+                        processed_proving_key.G_gamma2_Z_t_precomp =
+                            fixed_base_precompute<g1_type, scalar_field_type>(pk.G_gamma2_Z_t.begin(),
+                                                                              pk.G_gamma2_Z_t.end(), window, chunks);
+
+                        return processed_proving_key;
+                    }
+                };
+
                 /**
                  * A prover algorithm for the R1CS SEppzkSNARK.
                  *
@@ -59,39 +114,286 @@ namespace nil {
                 class r1cs_se_ppzksnark_prover {
                     typedef detail::r1cs_se_ppzksnark_types_policy<CurveType> policy_type;
 
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef typename CurveType::g2_type g2_type;
+
                 public:
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
                     typedef typename policy_type::auxiliary_input_type auxiliary_input_type;
 
                     typedef typename policy_type::proving_key_type proving_key_type;
+                    typedef typename policy_type::processed_proving_key_type processed_proving_key_type;
                     typedef typename policy_type::verification_key_type verification_key_type;
                     typedef typename policy_type::processed_verification_key_type processed_verification_key_type;
 
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
 
+                    /**
+                     * The multi-exponentiations over A_query, B_query, C_query_1 and C_query_2 only depend
+                     * on the variable assignment of the SAP. They are split into tasks of similar cost and
+                     * run together on the current executor, alongside the FFTs of the witness map computing
+                     * the scalars of G_gamma2_Z_t, whose tasks follow once H is known.
+                     */
                     static inline proof_type process(const proving_key_type &proving_key,
                                                      const primary_input_type &primary_input,
                                                      const auxiliary_input_type &auxiliary_input) {
+                        typedef reductions::r1cs_to_sap<scalar_field_type> reduction_type;
+
+                        /* sanity check */
+                        assert(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
+
+                        const typename scalar_field_type::value_type d1 = algebra::random_element<scalar_field_type>(),
+                                                                     d2 = algebra::random_element<scalar_field_type>();
+
+                        const r1cs_variable_assignment<scalar_field_type> assignment =
+                            reduction_type::variable_assignment(proving_key.constraint_system, primary_input,
+                                                                auxiliary_input);
+                        const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain =
+                            reduction_type::get_domain(proving_key.constraint_system);
+
+                        const std::size_t num_variables = assignment.size();
+                        const std::size_t num_inputs = primary_input.size();
+                        const std::size_t num_H_terms = proving_key.G_gamma2_Z_t.size();
+
+                        const std::size_t g1 = multiexp_task_list::g1_cost, g2 = multiexp_task_list::g2_cost;
+                        multiexp_task_list tasks(num_variables * (g1 + g2 + g1) + (num_variables - num_inputs) * g1 +
+                                                 num_H_terms * g1);
+
+                        std::vector<typename scalar_field_type::value_type> coefficients_for_H;
+                        std::vector<typename g1_type::value_type> parts_A, parts_C_1, parts_C_2, parts_H;
+                        std::vector<typename g2_type::value_type> parts_B;
+
+                        /* the witness map, five FFTs, runs on its own executor alongside the assignment-only
+                           multiexps */
+                        tasks.add_alongside(
+                            [&]() {
+                                coefficients_for_H = reduction_type::coefficients_for_H(
+                                    proving_key.constraint_system, assignment, d1, d2, domain);
+                            },
+                            multiexp_task_list::fft_cost(domain->m, 5));
+
+                        /* variable i + 1 of A_query, B_query and C_query_2 is scaled by assignment[i] */
+                        tasks.add(parts_B, num_variables, g2, [&](std::size_t first, std::size_t last) {
+                            return window_multiexp(proving_key.B_query.begin() + 1 + first,
+                                                   proving_key.B_query.begin() + 1 + last,
+                                                   assignment.begin() + first, assignment.begin() + last);
+                        });
+
+                        tasks.add(parts_A, num_variables, g1, [&](std::size_t first, std::size_t last) {
+                            return window_multiexp(proving_key.A_query.begin() + 1 + first,
+                                                   proving_key.A_query.begin() + 1 + last,
+                                                   assignment.begin() + first, assignment.begin() + last);
+                        });
+
+                        tasks.add(parts_C_2, num_variables, g1, [&](std::size_t first, std::size_t last) {
+                            return window_multiexp(proving_key.C_query_2.begin() + 1 + first,
+                                                   proving_key.C_query_2.begin() + 1 + last,
+                                                   assignment.begin() + first, assignment.begin() + last);
+                        });
+
+                        tasks.add(parts_C_1, num_variables - num_inputs, g1, [&](std::size_t first, std::size_t last) {
+                            return window_multiexp(proving_key.C_query_1.begin() + first,
+                                                   proving_key.C_query_1.begin() + last,
+                                                   assignment.begin() + num_inputs + first,
+                                                   assignment.begin() + num_inputs + last);
+                        });
+
+                        tasks.run();
+
+                        tasks.add(parts_H, num_H_terms, g1, [&](std::size_t first, std::size_t last) {
+                            return window_multiexp(proving_key.G_gamma2_Z_t.begin() + first,
+                                                   proving_key.G_gamma2_Z_t.begin() + last,
+                                                   coefficients_for_H.begin() + first,
+                                                   coefficients_for_H.begin() + last);
+                        });
+                        tasks.run();
+
+                        return make_proof(proving_key, d1, d2, multiexp_task_list::sum(parts_A),
+                                          multiexp_task_list::sum(parts_B), multiexp_task_list::sum(parts_C_1),
+                                          multiexp_task_list::sum(parts_C_2), multiexp_task_list::sum(parts_H));
+                    }
+
+                    static inline proof_type process(const processed_proving_key_type &processed_proving_key,
+                                                     const primary_input_type &primary_input,
+                                                     const auxiliary_input_type &auxiliary_input) {
+                        const proving_key_type &proving_key = processed_proving_key.proving_key;
+
+                        const sap_witness<scalar_field_type> sap_wit =
+                            reductions::r1cs_to_sap<scalar_field_type>::witness_map(
+                                proving_key.constraint_system, primary_input, auxiliary_input,
+                                algebra::random_element<scalar_field_type>(),
+                                algebra::random_element<scalar_field_type>());
+
+                        const std::size_t chunks = executor::current().concurrency();
+
+                        const typename std::vector<typename scalar_field_type::value_type>::const_iterator
+                            assignment = sap_wit.coefficients_for_ACs.begin();
+
+                        return make_proof(
+                            proving_key, sap_wit.d1, sap_wit.d2,
+                            fixed_base_multiexp(processed_proving_key.A_query_precomp, assignment,
+                                                assignment + sap_wit.num_variables, chunks),
+                            fixed_base_multiexp(processed_proving_key.B_query_precomp, assignment,
+                                                assignment + sap_wit.num_variables, chunks),
+                            fixed_base_multiexp(processed_proving_key.C_query_1_precomp,
+                                                assignment + sap_wit.num_inputs, assignment + sap_wit.num_variables,
+                                                chunks),
+                            fixed_base_multiexp(processed_proving_key.C_query_2_precomp, assignment,
+                                                assignment + sap_wit.num_variables, chunks),
+                            fixed_base_multiexp(processed_proving_key.G_gamma2_Z_t_precomp,
+                                                sap_wit.coefficients_for_H.begin(),
+                                                sap_wit.coefficients_for_H.begin() + proving_key.G_gamma2_Z_t.size(),
+                                                chunks));
+                    }
+
+                    /**
+                     * Proves every (primary input, auxiliary input) pair of [witnesses_first, witnesses_last)
+                     * for the same proving key.
+                     *
+                     * The evaluation domain is built once for the whole batch, and the multi-exponentiations
+                     * are run query by query, so consecutive multi-exponentiations share their bases.
+                     */
+                    template<typename InputWitnessIterator>
+                    static inline std::vector<proof_type> process_batch(const proving_key_type &proving_key,
+                                                                        InputWitnessIterator witnesses_first,
+                                                                        InputWitnessIterator witnesses_last) {
+                        const std::size_t chunks = executor::current().concurrency();
+                        const std::vector<sap_witness<scalar_field_type>> sap_wits =
+                            batch_witnesses(proving_key, witnesses_first, witnesses_last);
+                        const std::size_t batch_size = sap_wits.size();
+
+                        std::vector<typename g1_type::value_type> evaluations_A, evaluations_C_1, evaluations_C_2,
+                            evaluations_H;
+                        std::vector<typename g2_type::value_type> evaluations_B;
+
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_A.emplace_back(window_multiexp(
+                                proving_key.A_query.begin() + 1, proving_key.A_query.end(),
+                                sap_wits[i].coefficients_for_ACs.begin(), sap_wits[i].coefficients_for_ACs.end(),
+                                chunks));
+                        }
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_B.emplace_back(window_multiexp(
+                                proving_key.B_query.begin() + 1, proving_key.B_query.end(),
+                                sap_wits[i].coefficients_for_ACs.begin(), sap_wits[i].coefficients_for_ACs.end(),
+                                chunks));
+                        }
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_C_1.emplace_back(window_multiexp(
+                                proving_key.C_query_1.begin(), proving_key.C_query_1.end(),
+                                sap_wits[i].coefficients_for_ACs.begin() + sap_wits[i].num_inputs,
+                                sap_wits[i].coefficients_for_ACs.end(), chunks));
+                        }
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_C_2.emplace_back(window_multiexp(
+                                proving_key.C_query_2.begin() + 1, proving_key.C_query_2.end(),
+                                sap_wits[i].coefficients_for_ACs.begin(), sap_wits[i].coefficients_for_ACs.end(),
+                                chunks));
+                        }
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            evaluations_H.emplace_back(window_multiexp(
+                                proving_key.G_gamma2_Z_t.begin(), proving_key.G_gamma2_Z_t.end(),
+                                sap_wits[i].coefficients_for_H.begin(),
+                                sap_wits[i].coefficients_for_H.begin() + proving_key.G_gamma2_Z_t.size(), chunks));
+                        }
+
+                        std::vector<proof_type> proofs;
+                        proofs.reserve(batch_size);
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            proofs.emplace_back(make_proof(proving_key, sap_wits[i].d1, sap_wits[i].d2,
+                                                           evaluations_A[i], evaluations_B[i], evaluations_C_1[i],
+                                                           evaluations_C_2[i], evaluations_H[i]));
+                        }
 
-                        const typename CurveType::scalar_field_type::value_type
-                            d1 = algebra::random_element<typename CurveType::scalar_field_type>(),
-                            d2 = algebra::random_element<typename CurveType::scalar_field_type>();
+                        return proofs;
+                    }
+
+                    /**
+                     * Proves every (primary input, auxiliary input) pair of [witnesses_first, witnesses_last)
+                     * for the same processed proving key.
+                     *
+                     * Each precomputed table is traversed once for the whole batch: every base feeds the
+                     * buckets of all witnesses before the next base is loaded.
+                     */
+                    template<typename InputWitnessIterator>
+                    static inline std::vector<proof_type>
+                        process_batch(const processed_proving_key_type &processed_proving_key,
+                                      InputWitnessIterator witnesses_first, InputWitnessIterator witnesses_last) {
+                        const std::size_t chunks = executor::current().concurrency();
+                        typedef typename std::vector<typename scalar_field_type::value_type>::const_iterator
+                            scalar_iterator;
+
+                        const proving_key_type &proving_key = processed_proving_key.proving_key;
+
+                        const std::vector<sap_witness<scalar_field_type>> sap_wits =
+                            batch_witnesses(proving_key, witnesses_first, witnesses_last);
+                        const std::size_t batch_size = sap_wits.size();
+                        if (!batch_size) {
+                            return {};
+                        }
+
+                        const std::size_t num_variables = sap_wits[0].num_variables;
+                        const std::size_t num_inputs = sap_wits[0].num_inputs;
+
+                        std::vector<scalar_iterator> assignments, inputs_shifted, coefficients_for_H;
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            assignments.emplace_back(sap_wits[i].coefficients_for_ACs.cbegin());
+                            inputs_shifted.emplace_back(sap_wits[i].coefficients_for_ACs.cbegin() + num_inputs);
+                            coefficients_for_H.emplace_back(sap_wits[i].coefficients_for_H.cbegin());
+                        }
+
+                        const std::vector<typename g1_type::value_type> evaluations_A = fixed_base_multiexp_batch(
+                            processed_proving_key.A_query_precomp, assignments, num_variables, chunks);
+                        const std::vector<typename g2_type::value_type> evaluations_B = fixed_base_multiexp_batch(
+                            processed_proving_key.B_query_precomp, assignments, num_variables, chunks);
+                        const std::vector<typename g1_type::value_type> evaluations_C_1 =
+                            fixed_base_multiexp_batch(processed_proving_key.C_query_1_precomp, inputs_shifted,
+                                                      num_variables - num_inputs, chunks);
+                        const std::vector<typename g1_type::value_type> evaluations_C_2 = fixed_base_multiexp_batch(
+                            processed_proving_key.C_query_2_precomp, assignments, num_variables, chunks);
+                        const std::vector<typename g1_type::value_type> evaluations_H =
+                            fixed_base_multiexp_batch(processed_proving_key.G_gamma2_Z_t_precomp, coefficients_for_H,
+                                                      proving_key.G_gamma2_Z_t.size(), chunks);
+
+                        std::vector<proof_type> proofs;
+                        proofs.reserve(batch_size);
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            proofs.emplace_back(make_proof(proving_key, sap_wits[i].d1, sap_wits[i].d2,
+                                                           evaluations_A[i], evaluations_B[i], evaluations_C_1[i],
+                                                           evaluations_C_2[i], evaluations_H[i]));
+                        }
 
-                        const sap_witness<typename CurveType::scalar_field_type> sap_wit =
-                            reductions::r1cs_to_sap<typename CurveType::scalar_field_type>::witness_map(
-                                proving_key.constraint_system, primary_input, auxiliary_input, d1, d2);
+                        return proofs;
+                    }
 
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                             // var or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
+                private:
+                    /* Multi-exponentiation with mixed addition, over bases normalized by the generator. */
+                    template<typename InputBaseIterator, typename InputFieldIterator>
+                    static inline typename std::iterator_traits<InputBaseIterator>::value_type
+                        window_multiexp(InputBaseIterator bases_first, InputBaseIterator bases_last,
+                                        InputFieldIterator scalars_first, InputFieldIterator scalars_last,
+                                        const std::size_t chunks = 1) {
+                        return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                            bases_first, bases_last, scalars_first, scalars_last, chunks);
+                    }
 
-                        const typename CurveType::scalar_field_type::value_type r =
-                            algebra::random_element<typename CurveType::scalar_field_type>();
+                    /**
+                     * Assembles the proof from the multi-exponentiations over the queries past their
+                     * constant terms, evaluation_A = \sum_{i=1}^m A_query[i] * input_i and so on, with
+                     * evaluation_H over G_gamma2_Z_t.
+                     */
+                    static inline proof_type make_proof(const proving_key_type &proving_key,
+                                                        const typename scalar_field_type::value_type &d1,
+                                                        const typename scalar_field_type::value_type &d2,
+                                                        const typename g1_type::value_type &evaluation_A,
+                                                        const typename g2_type::value_type &evaluation_B,
+                                                        const typename g1_type::value_type &evaluation_C_1,
+                                                        const typename g1_type::value_type &evaluation_C_2,
+                                                        const typename g1_type::value_type &evaluation_H) {
+                        const typename scalar_field_type::value_type r = algebra::random_element<scalar_field_type>();
 
                         /**
                          * compute A = G^{gamma * (\sum_{i=0}^m input_i * A_i(t) + r * Z(t))}
@@ -99,30 +401,21 @@ namespace nil {
                          *             * (G^{gamma * Z(t)})^r
                          *           = \prod_{i=0}^m A_query[i]^{input_i} * G_gamma_Z^r
                          */
-                        typename CurveType::g1_type::value_type A =
+                        typename g1_type::value_type A =
                             r * proving_key.G_gamma_Z +
-                            proving_key.A_query[0] +                // i = 0 is a special case because input_i = 1
-                            sap_wit.d1 * proving_key.G_gamma_Z +    // ZK-patch
-                            algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.A_query.begin() + 1,
-                                proving_key.A_query.end(),
-                                sap_wit.coefficients_for_ACs.begin(),
-                                sap_wit.coefficients_for_ACs.end(),
-                                chunks);
+                            proving_key.A_query[0] +        // i = 0 is a special case because input_i = 1
+                            d1 * proving_key.G_gamma_Z +    // ZK-patch
+                            evaluation_A;
 
                         /**
                          * compute B exactly as A, except with H as the base
                          */
-                        typename CurveType::g2_type::value_type B =
+                        typename g2_type::value_type B =
                             r * proving_key.H_gamma_Z +
-                            proving_key.B_query[0] +                // i = 0 is a special case because input_i = 1
-                            sap_wit.d1 * proving_key.H_gamma_Z +    // ZK-patch
-                            algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.B_query.begin() + 1,
-                                proving_key.B_query.end(),
-                                sap_wit.coefficients_for_ACs.begin(),
-                                sap_wit.coefficients_for_ACs.end(),
-                                chunks);
+                            proving_key.B_query[0] +        // i = 0 is a special case because input_i = 1
+                            d1 * proving_key.H_gamma_Z +    // ZK-patch
+                            evaluation_B;
+
                         /**
                          * compute C = G^{f(input) +
                          *                r^2 * gamma^2 * Z(t)^2 +
@@ -133,33 +426,38 @@ namespace nil {
                          * and G^{2 * r * gamma^2 * Z(t) * \sum_{i=0}^m input_i A_i(t)} =
                          *              = \prod_{i=0}^m C_query_2 * input_i
                          */
-                        typename CurveType::g1_type::value_type C =
-                            algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.C_query_1.begin(),
-                                proving_key.C_query_1.end(),
-                                sap_wit.coefficients_for_ACs.begin() + sap_wit.num_inputs,
-                                sap_wit.coefficients_for_ACs.end(),
-                                chunks) +
-                            (r * r) * proving_key.G_gamma2_Z2 + r * proving_key.G_ab_gamma_Z +
-                            sap_wit.d1 * proving_key.G_ab_gamma_Z +             // ZK-patch
-                            r * proving_key.C_query_2[0] +                      // i = 0 is a special case for C_query_2
-                            (r + r) * sap_wit.d1 * proving_key.G_gamma2_Z2 +    // ZK-patch for C_query_2
-                            r * algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                    proving_key.C_query_2.begin() + 1,
-                                    proving_key.C_query_2.end(),
-                                    sap_wit.coefficients_for_ACs.begin(),
-                                    sap_wit.coefficients_for_ACs.end(),
-                                    chunks) +
-                            sap_wit.d2 * proving_key.G_gamma2_Z_t[0] +    // ZK-patch
-                            algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.G_gamma2_Z_t.begin(),
-                                proving_key.G_gamma2_Z_t.end(),
-                                sap_wit.coefficients_for_H.begin(),
-                                sap_wit.coefficients_for_H.end(),
-                                chunks);
+                        typename g1_type::value_type C =
+                            evaluation_C_1 + (r * r) * proving_key.G_gamma2_Z2 + r * proving_key.G_ab_gamma_Z +
+                            d1 * proving_key.G_ab_gamma_Z +                // ZK-patch
+                            r * proving_key.C_query_2[0] +                 // i = 0 is a special case for C_query_2
+                            (r + r) * d1 * proving_key.G_gamma2_Z2 +       // ZK-patch for C_query_2
+                            r * evaluation_C_2 + d2 * proving_key.G_gamma2_Z_t[0] +    // ZK-patch
+                            evaluation_H;
 
                         return {std::move(A), std::move(B), std::move(C)};
                     }
+
+                    /* SAP witnesses of a batch, each with its own zero-knowledge randomness. */
+                    template<typename InputWitnessIterator>
+                    static inline std::vector<sap_witness<scalar_field_type>>
+                        batch_witnesses(const proving_key_type &proving_key, InputWitnessIterator witnesses_first,
+                                        InputWitnessIterator witnesses_last) {
+                        const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain =
+                            reductions::r1cs_to_sap<scalar_field_type>::get_domain(proving_key.constraint_system);
+                        /* all witness maps of the batch share the same scratch buffers */
+                        typename reductions::r1cs_to_sap<scalar_field_type>::workspace scratch(domain->m);
+
+                        std::vector<sap_witness<scalar_field_type>> sap_wits;
+
+                        for (InputWitnessIterator it = witnesses_first; it != witnesses_last; ++it) {
+                            sap_wits.emplace_back(reductions::r1cs_to_sap<scalar_field_type>::witness_map(
+                                proving_key.constraint_system, it->first, it->second,
+                                algebra::random_element<scalar_field_type>(),
+                                algebra::random_element<scalar_field_type>(), domain, scratch));
+                        }
+
+                        return sap_wits;
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
@@ -29,6 +29,8 @@
 #include <memory>
 #include <vector>
 
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -110,6 +112,52 @@ namespace nil {
                                 this->G_gamma2_Z_t == other.G_gamma2_Z_t && this->constraint_system == other.constraint_system);
                     }
                 };
+
+                /**
+                 * A proving key extended with fixed-base precomputation of its queries.
+                 *
+                 * Each of A_query, B_query and C_query_2 past their constant term at index 0, C_query_1
+                 * and G_gamma2_Z_t is expanded into window-shifted multiples of its bases. The window
+                 * width controls the trade-off: a table takes ceil(scalar_bits / window) times the memory
+                 * of its query.
+                 */
+                template<typename CurveType, typename ConstraintSystem>
+                struct r1cs_se_ppzksnark_processed_proving_key {
+                    typedef CurveType curve_type;
+                    typedef ConstraintSystem constraint_system_type;
+                    typedef r1cs_se_ppzksnark_proving_key<CurveType, ConstraintSystem> proving_key_type;
+
+                    proving_key_type proving_key;
+
+                    fixed_base_precomputation<typename CurveType::g1_type> A_query_precomp;
+                    fixed_base_precomputation<typename CurveType::g2_type> B_query_precomp;
+                    fixed_base_precomputation<typename CurveType::g1_type> C_query_1_precomp;
+                    fixed_base_precomputation<typename CurveType::g1_type> C_query_2_precomp;
+                    fixed_base_precomputation<typename CurveType::g1_type> G_gamma2_Z_t_precomp;
+
+                    r1cs_se_ppzksnark_processed_proving_key() = default;
+                    r1cs_se_ppzksnark_processed_proving_key &
+                        operator=(const r1cs_se_ppzksnark_processed_proving_key &other) = default;
+                    r1cs_se_ppzksnark_processed_proving_key(const r1cs_se_ppzksnark_processed_proving_key &other) =
+                        default;
+                    r1cs_se_ppzksnark_processed_proving_key(r1cs_se_ppzksnark_processed_proving_key &&other) =
+                        default;
+
+                    std::size_t size_in_bits() const {
+                        return proving_key.size_in_bits() + A_query_precomp.size_in_bits() +
+                               B_query_precomp.size_in_bits() + C_query_1_precomp.size_in_bits() +
+                               C_query_2_precomp.size_in_bits() + G_gamma2_Z_t_precomp.size_in_bits();
+                    }
+
+                    bool operator==(const r1cs_se_ppzksnark_processed_proving_key &other) const {
+                        return (this->proving_key == other.proving_key &&
+                                this->A_query_precomp == other.A_query_precomp &&
+                                this->B_query_precomp == other.B_query_precomp &&
+                                this->C_query_1_precomp == other.C_query_1_precomp &&
+                                this->C_query_2_precomp == other.C_query_2_precomp &&
+                                this->G_gamma2_Z_t_precomp == other.G_gamma2_Z_t_precomp);
+                    }
+                };
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
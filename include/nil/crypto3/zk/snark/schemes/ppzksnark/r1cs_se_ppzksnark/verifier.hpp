@@ -26,16 +26,22 @@
 #ifndef CRYPTO3_ZK_R1CS_SE_PPZKSNARK_BASIC_VERIFIER_HPP
 #define CRYPTO3_ZK_R1CS_SE_PPZKSNARK_BASIC_VERIFIER_HPP
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
 
 #include <nil/crypto3/algebra/multiexp/multiexp.hpp>
 #include <nil/crypto3/algebra/multiexp/policies.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
 
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_sap.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_se_ppzksnark/detail/basic_policy.hpp>
@@ -107,6 +113,10 @@ namespace nil {
                     typedef detail::r1cs_se_ppzksnark_types_policy<CurveType> policy_type;
 
                     typedef typename CurveType::pairing pairing_policy;
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type::value_type g1_value_type;
+                    typedef typename CurveType::g2_type::value_type g2_value_type;
+                    typedef typename pairing_policy::fqk_type fqk_type;
 
                 public:
                     typedef CurveType curve_type;
@@ -135,71 +145,220 @@ namespace nil {
                     }
 
                     /**
-                     * A verifier algorithm for the R1CS ppzkSNARK that:
+                     * A verifier algorithm for the R1CS SEppzkSNARK that:
                      * (1) accepts a processed verification key, and
                      * (2) has weak input consistency.
+                     *
+                     * The two verification equations are combined as in a batch of one proof, see
+                     * accumulate_batch, for four Miller loops and a single final exponentiation.
                      */
                     static inline bool process(const processed_verification_key_type &processed_verification_key,
                                                const primary_input_type &primary_input,
                                                const proof_type &proof) {
+                        return process_batch(processed_verification_key, &primary_input, &primary_input + 1, &proof,
+                                             &proof + 1);
+                    }
 
-                        bool result = true;
+                    /**
+                     * A batch verifier algorithm for the R1CS SEppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has weak input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &vk,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_se_ppzksnark_process_verification_key<CurveType>::process(vk), primary_inputs_first,
+                            primary_inputs_last, proofs_first, proofs_last);
+                    }
 
-                        if (!proof.is_well_formed()) {
-                            result = false;
+                    /**
+                     * A batch verifier algorithm for the R1CS SEppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has weak input consistency.
+                     *
+                     * Verifies every proof of [proofs_first, proofs_last) against the primary input at the
+                     * same position of [primary_inputs_first, primary_inputs_last), with the Miller loops of
+                     * accumulate_batch and a single final exponentiation for the whole batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &processed_verification_key,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        typename fqk_type::value_type miller_loop_product = fqk_type::value_type::one();
+                        if (!accumulate_batch<DistributionType, GeneratorType>(
+                                processed_verification_key, primary_inputs_first, primary_inputs_last, proofs_first,
+                                proofs_last, miller_loop_product)) {
+                            return false;
                         }
 
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                             // var or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
-
-                        /**
-                         * e(A*G^{alpha}, B*H^{beta}) = e(G^{alpha}, H^{beta}) * e(G^{psi}, H^{gamma})
-                         *                              * e(C, H)
-                         * where psi = \sum_{i=0}^l input_i processed_verification_key.query[i]
-                         */
-                        typename CurveType::g1_type::value_type G_psi =
-                            processed_verification_key.query[0] +
-                            algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                processed_verification_key.query.begin() + 1, processed_verification_key.query.end(),
-                                primary_input.begin(), primary_input.end(), chunks);
-
-                        typename pairing_policy::fqk_type::value_type
-                            test1_l = pairing_policy::miller_loop(
-                                pairing_policy::precompute_g1(proof.A + processed_verification_key.G_alpha),
-                                pairing_policy::precompute_g2(proof.B + processed_verification_key.H_beta)),
-                            test1_r1 = processed_verification_key.G_alpha_H_beta_ml,
-                            test1_r2 = pairing_policy::miller_loop(pairing_policy::precompute_g1(G_psi),
-                                                                   processed_verification_key.H_gamma_pc),
-                            test1_r3 = pairing_policy::miller_loop(pairing_policy::precompute_g1(proof.C),
-                                                                   processed_verification_key.H_pc);
-                        typename CurveType::gt_type::value_type test1 = pairing_policy::final_exponentiation(
-                            test1_l.unitary_inversed() * test1_r1 * test1_r2 * test1_r3);
-
-                        if (test1 != CurveType::gt_type::value_type::one()) {
-                            result = false;
+                        operation_counter::add(operation_counter::final_exponentiation);
+                        return pairing_policy::final_exponentiation(miller_loop_product) ==
+                               CurveType::gt_type::value_type::one();
+                    }
+
+                    /**
+                     * Multiplies into miller_loop_product the Miller loops checking a batch of proofs of the
+                     * R1CS SEppzkSNARK against a processed verification key, with weak input consistency.
+                     * The batch verifies iff the final exponentiation of the product is one. Returns false if
+                     * a proof is not well formed, a primary input is longer than the key or the batch holds
+                     * more or fewer primary inputs than proofs.
+                     *
+                     * The equations of every proof,
+                     *     e(A + G^{alpha}, B + H^{beta}) = e(G^{alpha}, H^{beta}) e(G^{psi}, H^{gamma}) e(C, H),
+                     *     e(A, H^{gamma}) = e(G^{gamma}, B),
+                     * are raised to random non-zero coefficients r_i and s_i and multiplied over the batch:
+                     *     \prod_i e(r_i (A_i + G^{alpha}), B_i + H^{beta}) e(G^{gamma}, \sum_i s_i B_i) =
+                     *         e(G^{alpha}, H^{beta})^{\sum_i r_i} e(\sum_i r_i G^{psi_i} + s_i A_i, H^{gamma})
+                     *         e(\sum_i r_i C_i, H).
+                     * Besides the pairings of the proofs, which run two at a time (see multi_miller_loop), a
+                     * batch costs three Miller loops whatever its size. A batch with an invalid proof passes
+                     * with negligible probability over the choice of the coefficients, drawn from
+                     * GeneratorType, the entropy of the system by default.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool
+                        accumulate_batch(const processed_verification_key_type &processed_verification_key,
+                                         InputPrimaryInputIterator primary_inputs_first,
+                                         InputPrimaryInputIterator primary_inputs_last,
+                                         InputProofIterator proofs_first,
+                                         InputProofIterator proofs_last,
+                                         typename fqk_type::value_type &miller_loop_product) {
+                        typedef typename scalar_field_type::value_type scalar_field_value_type;
+
+                        std::vector<const primary_input_type *> primary_inputs;
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            primary_inputs.emplace_back(&*it);
+                        }
+                        std::vector<const proof_type *> proofs;
+                        for (InputProofIterator it = proofs_first; it != proofs_last; ++it) {
+                            proofs.emplace_back(&*it);
                         }
 
-                        /**
-                         * e(A, H^{gamma}) = e(G^{gamma}, B)
-                         */
-                        typename pairing_policy::fqk_type::value_type test2_l = pairing_policy::miller_loop(
-                                                              pairing_policy::precompute_g1(proof.A),
-                                                              processed_verification_key.H_gamma_pc),
-                                                          test2_r = pairing_policy::miller_loop(
-                                                              processed_verification_key.G_gamma_pc,
-                                                              pairing_policy::precompute_g2(proof.B));
-                        typename CurveType::gt_type::value_type test2 =
-                            pairing_policy::final_exponentiation(test2_l * test2_r.unitary_inversed());
-
-                        if (test2 != CurveType::gt_type::value_type::one()) {
-                            result = false;
+                        if (primary_inputs.size() != proofs.size()) {
+                            return false;
+                        }
+                        const std::size_t batch_size = proofs.size();
+                        if (!batch_size) {
+                            return true;
                         }
 
-                        return result;
+                        /* the coefficients of both equations are drawn up front, in the order of the batch */
+                        constexpr const std::size_t num_checks = 2;
+                        std::vector<scalar_field_value_type> coefficients;
+                        coefficients.reserve(num_checks * batch_size);
+                        scalar_field_value_type coefficients_sum = scalar_field_value_type::zero();
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            if (processed_verification_key.query.size() < primary_inputs[i]->size() + 1 ||
+                                !proofs[i]->is_well_formed()) {
+                                return false;
+                            }
+
+                            for (std::size_t k = 0; k < num_checks; ++k) {
+                                scalar_field_value_type coefficient =
+                                    algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                while (coefficient.is_zero()) {
+                                    coefficient =
+                                        algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                }
+                                coefficients.emplace_back(coefficient);
+                            }
+                            coefficients_sum += coefficients[num_checks * i];
+                        }
+
+                        /* \sum_i r_i G^{psi_i} is a single multi-exponentiation of the primary input
+                           \sum_i r_i x_i, split across threads, rather than one per proof */
+                        std::size_t input_size = 0;
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            input_size = std::max(input_size, primary_inputs[i]->size());
+                        }
+                        std::vector<scalar_field_value_type> combined_input(input_size);
+                        executor::current().parallel_for(input_size, [&](const std::size_t j) {
+                            scalar_field_value_type x = scalar_field_value_type::zero();
+                            for (std::size_t i = 0; i < batch_size; ++i) {
+                                if (j < primary_inputs[i]->size()) {
+                                    x += coefficients[num_checks * i] * (*primary_inputs[i])[j];
+                                }
+                            }
+                            combined_input[j] = x;
+                        });
+
+                        multiexp_task_list tasks(input_size * multiexp_task_list::g1_cost);
+                        std::vector<g1_value_type> parts_psi;
+                        tasks.add(parts_psi, input_size, multiexp_task_list::g1_cost,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return dispatch_multiexp<multiexp_method_auto>(
+                                          processed_verification_key.query.begin() + 1 + first,
+                                          processed_verification_key.query.begin() + 1 + last,
+                                          combined_input.begin() + first, combined_input.begin() + last, 1);
+                                  });
+                        tasks.run();
+                        operation_counter::add(operation_counter::g1_exp_term, input_size);
+
+                        /* the other sides paired with the fixed elements of the key, accumulated per block of
+                           proofs */
+                        struct sums_type {
+                            g1_value_type psi_A, C;
+                            g2_value_type B;
+                        };
+                        const std::size_t num_blocks = std::min(batch_size, executor::current().concurrency());
+                        const std::size_t block_size = (batch_size + num_blocks - 1) / num_blocks;
+
+                        std::vector<g1_value_type> scaled_A_alpha(batch_size);
+                        std::vector<g2_value_type> B_beta(batch_size);
+                        std::vector<sums_type> block_sums(
+                            num_blocks, {g1_value_type::zero(), g1_value_type::zero(), g2_value_type::zero()});
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            sums_type &sums = block_sums[block];
+                            const std::size_t end = std::min(batch_size, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                const proof_type &proof = *proofs[i];
+                                const scalar_field_value_type *r = &coefficients[num_checks * i];
+
+                                scaled_A_alpha[i] = r[0] * (proof.A + processed_verification_key.G_alpha);
+                                B_beta[i] = proof.B + processed_verification_key.H_beta;
+                                sums.psi_A = sums.psi_A + r[1] * proof.A;
+                                sums.C = sums.C + r[0] * proof.C;
+                                sums.B = sums.B + r[1] * proof.B;
+                            }
+                        });
+
+                        sums_type sums = {coefficients_sum * processed_verification_key.query[0] +
+                                              multiexp_task_list::sum(parts_psi),
+                                          g1_value_type::zero(), g2_value_type::zero()};
+                        for (std::size_t block = 0; block < num_blocks; ++block) {
+                            sums.psi_A = sums.psi_A + block_sums[block].psi_A;
+                            sums.C = sums.C + block_sums[block].C;
+                            sums.B = sums.B + block_sums[block].B;
+                        }
+
+                        const typename fqk_type::value_type left_1 =
+                            multi_miller_loop<CurveType>(scaled_A_alpha.begin(), scaled_A_alpha.end(), B_beta.begin());
+                        const typename fqk_type::value_type left_2 = pairing_policy::miller_loop(
+                            processed_verification_key.G_gamma_pc, pairing_policy::precompute_g2(sums.B));
+                        const typename fqk_type::value_type right = pairing_policy::double_miller_loop(
+                            pairing_policy::precompute_g1(sums.psi_A), processed_verification_key.H_gamma_pc,
+                            pairing_policy::precompute_g1(sums.C), processed_verification_key.H_pc);
+
+                        operation_counter::add(operation_counter::miller_loop, 3);
+                        miller_loop_product = miller_loop_product *
+                                              processed_verification_key.G_alpha_H_beta_ml.pow(coefficients_sum.data) *
+                                              right * (left_1 * left_2).unitary_inversed();
+                        return true;
                     }
                 };
 
@@ -207,6 +366,9 @@ namespace nil {
                 class r1cs_se_ppzksnark_verifier_strong_input_consistency {
                     typedef detail::r1cs_se_ppzksnark_types_policy<CurveType> policy_type;
 
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::pairing::fqk_type fqk_type;
+
                 public:
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
@@ -251,6 +413,75 @@ namespace nil {
 
                         return result;
                     }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS SEppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &vk,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            r1cs_se_ppzksnark_process_verification_key<CurveType>::process(vk), primary_inputs_first,
+                            primary_inputs_last, proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * A batch verifier algorithm for the R1CS SEppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &pvk,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (pvk.query.size() != it->size() + 1) {
+                                return false;
+                            }
+                        }
+
+                        return r1cs_se_ppzksnark_verifier_weak_input_consistency<CurveType>::template process_batch<
+                            DistributionType, GeneratorType>(pvk, primary_inputs_first, primary_inputs_last,
+                                                             proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * Accumulates the Miller loops of a batch with strong input consistency, see
+                     * r1cs_se_ppzksnark_verifier_weak_input_consistency::accumulate_batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool accumulate_batch(const processed_verification_key_type &pvk,
+                                                        InputPrimaryInputIterator primary_inputs_first,
+                                                        InputPrimaryInputIterator primary_inputs_last,
+                                                        InputProofIterator proofs_first,
+                                                        InputProofIterator proofs_last,
+                                                        typename fqk_type::value_type &miller_loop_product) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (pvk.query.size() != it->size() + 1) {
+                                return false;
+                            }
+                        }
+
+                        return r1cs_se_ppzksnark_verifier_weak_input_consistency<CurveType>::template accumulate_batch<
+                            DistributionType, GeneratorType>(pvk, primary_inputs_first, primary_inputs_last,
+                                                             proofs_first, proofs_last, miller_loop_product);
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
@@ -67,13 +67,12 @@ namespace nil {
                                                      const auxiliary_input_type &auxiliary_input) {
                         typedef typename CurveType::scalar_field_type FieldType;
 
-                        const uscs_variable_assignment<FieldType> uscs_va =
-                            reductions::tbcs_to_uscs<FieldType>::witness_map(pk.circuit, primary_input, auxiliary_input);
+                        /* the evaluator compiled into the proving key maps the circuit to the USCS variables */
                         const uscs_primary_input<FieldType> uscs_pi =
                             algebra::convert_bit_vector_to_field_element_vector<FieldType>(primary_input);
-                        const uscs_auxiliary_input<FieldType> uscs_ai(
-                            uscs_va.begin() + primary_input.size(),
-                            uscs_va.end());    // TODO: faster to just change bacs_to_r1cs<field_type>::witness_map into two :(
+                        const uscs_auxiliary_input<FieldType> uscs_ai =
+                            reductions::tbcs_to_uscs<FieldType>::auxiliary_witness_map(pk.evaluator, primary_input,
+                                                                                       auxiliary_input);
 
                         return prove<uscs_ppzksnark<CurveType>>(pk.uscs_pk, uscs_pi, uscs_ai);
                     }
@@ -29,6 +29,7 @@
 #include <memory>
 #include <vector>
 
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/tbcs_evaluator.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/uscs_ppzksnark.hpp>
 
 namespace nil {
@@ -36,7 +37,10 @@ namespace nil {
         namespace zk {
             namespace snark {
                 /**
-                 * A proving key for the R1CS ppzkSNARK.
+                 * A proving key for the TBCS ppzkSNARK.
+                 *
+                 * Along with the circuit, the key holds an evaluator compiled for it once, whose flat
+                 * schedule of gate wires maps the circuit to the USCS variables in every proof.
                  */
                 template<typename CurveType, typename CircuitType>
                 struct tbcs_ppzksnark_proving_key {
@@ -47,6 +51,7 @@ namespace nil {
 
                     circuit_type circuit;
                     uscs_ppzksnark_proving_key<CurveType, circuit_type> uscs_pk;
+                    tbcs_circuit_evaluator evaluator;
 
                     tbcs_ppzksnark_proving_key() {};
                     tbcs_ppzksnark_proving_key(const tbcs_ppzksnark_proving_key &other) = default;
@@ -54,12 +59,12 @@ namespace nil {
                     tbcs_ppzksnark_proving_key(const circuit_type &circuit,
                                                const uscs_ppzksnark_proving_key<CurveType, circuit_type> &uscs_pk) :
                         circuit(circuit),
-                        uscs_pk(uscs_pk) {
+                        uscs_pk(uscs_pk), evaluator(this->circuit) {
                     }
                     tbcs_ppzksnark_proving_key(circuit_type &&circuit,
                                                uscs_ppzksnark_proving_key<CurveType, circuit_type> &&uscs_pk) :
                         circuit(std::move(circuit)),
-                        uscs_pk(std::move(uscs_pk)) {
+                        uscs_pk(std::move(uscs_pk)), evaluator(this->circuit) {
                     }
 
                     tbcs_ppzksnark_proving_key &operator=(const tbcs_ppzksnark_proving_key &other) = default;
@@ -100,6 +100,16 @@ namespace nil {
                                               const proof_type &proof) {
                         return Verifier::process(vk, primary_input, proof);
                     }
+
+                    template<typename VerificationKey, typename InputPrimaryInputIterator, typename InputProofIterator>
+                    static inline bool verify_batch(const VerificationKey &vk,
+                                                    InputPrimaryInputIterator primary_inputs_first,
+                                                    InputPrimaryInputIterator primary_inputs_last,
+                                                    InputProofIterator proofs_first,
+                                                    InputProofIterator proofs_last) {
+                        return Verifier::process_batch(vk, primary_inputs_first, primary_inputs_last, proofs_first,
+                                                       proofs_last);
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
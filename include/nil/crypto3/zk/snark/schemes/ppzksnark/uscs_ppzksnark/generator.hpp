@@ -33,6 +33,9 @@
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
+#include <nil/crypto3/zk/snark/batch_normalizer.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
+
 #include <nil/crypto3/zk/snark/reductions/uscs_to_ssp.hpp>
 #include <nil/crypto3/zk/snark/relations/arithmetic_programs/ssp.hpp>
 
@@ -112,41 +115,34 @@ namespace nil {
                             Vt_table.size() + Vt_table_minus_Xt_table.size() + Ht_table.size();
                         const std::size_t g2_exp_count = Vt_table_minus_Xt_table.size();
 
-                        std::size_t g1_window = algebra::get_exp_window_size<typename CurveType::g1_type>(g1_exp_count);
-                        std::size_t g2_window = algebra::get_exp_window_size<typename CurveType::g2_type>(g2_exp_count);
-
-                        algebra::window_table<typename CurveType::g1_type> g1_table = algebra::get_window_table<
-                            typename CurveType::g1_type>(
-                            CurveType::scalar_field_type::value_bits, g1_window, CurveType::g1_type::value_type::one());
-
-                        algebra::window_table<typename CurveType::g2_type> g2_table = algebra::get_window_table<
-                            typename CurveType::g2_type>(
-                            CurveType::scalar_field_type::value_bits, g2_window, CurveType::g2_type::value_type::one());
+                        /* the tables of the group generators are shared with the other generator calls */
+                        typedef fixed_base_engine<typename CurveType::g1_type, typename CurveType::scalar_field_type>
+                            g1_engine_type;
+                        typedef fixed_base_engine<typename CurveType::g2_type, typename CurveType::scalar_field_type>
+                            g2_engine_type;
+                        const std::shared_ptr<const g1_engine_type> g1_engine =
+                            g1_engine_type::shared(CurveType::g1_type::value_type::one(), g1_exp_count);
+                        const std::shared_ptr<const g2_engine_type> g2_engine =
+                            g2_engine_type::shared(CurveType::g2_type::value_type::one(), g2_exp_count);
 
-                        typename std::vector<typename CurveType::g1_type::value_type> V_g1_query = algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(
-                            CurveType::scalar_field_type::value_bits, g1_window, g1_table, Vt_table_minus_Xt_table);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g1_type>(V_g1_query);
-#endif
+                        typename std::vector<typename CurveType::g1_type::value_type> V_g1_query =
+                            g1_engine->batch_exp(Vt_table_minus_Xt_table);
 
                         typename std::vector<typename CurveType::g1_type::value_type> alpha_V_g1_query =
-                            algebra::batch_exp_with_coeff<typename CurveType::g1_type, typename CurveType::scalar_field_type>(CurveType::scalar_field_type::value_bits, g1_window, g1_table, alpha,
-                                                 Vt_table_minus_Xt_table);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g1_type>(alpha_V_g1_query);
-#endif
+                            g1_engine->batch_exp(alpha, Vt_table_minus_Xt_table, 0, Vt_table_minus_Xt_table.size());
 
                         typename std::vector<typename CurveType::g1_type::value_type> H_g1_query =
-                            algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(CurveType::scalar_field_type::value_bits, g1_window, g1_table, Ht_table);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g1_type>(H_g1_query);
-#endif
+                            g1_engine->batch_exp(Ht_table);
 
                         typename std::vector<typename CurveType::g2_type::value_type> V_g2_query =
-                            algebra::batch_exp<typename CurveType::g2_type, typename CurveType::scalar_field_type>(CurveType::scalar_field_type::value_bits, g2_window, g2_table, Vt_table);
-#ifdef USE_MIXED_ADDITION
-                        algebra::batch_to_special<typename CurveType::g2_type>(V_g2_query);
-#endif
+                            g2_engine->batch_exp(Vt_table);
+
+                        key_normalizer<typename CurveType::g1_type, typename CurveType::g2_type> normalizer;
+                        normalizer.add(V_g1_query);
+                        normalizer.add(alpha_V_g1_query);
+                        normalizer.add(H_g1_query);
+                        normalizer.add(V_g2_query);
+                        normalizer.run();
                         const typename CurveType::scalar_field_type::value_type tilde =
                             algebra::random_element<typename CurveType::scalar_field_type>();
                         typename CurveType::g2_type::value_type tilde_g2 =
@@ -159,9 +155,8 @@ namespace nil {
                         typename CurveType::g1_type::value_type encoded_IC_base =
                             Xt_table[0] * CurveType::g1_type::value_type::one();
                         typename std::vector<typename CurveType::g1_type::value_type> encoded_IC_values =
-                            algebra::batch_exp<typename CurveType::g1_type, typename CurveType::scalar_field_type>(CurveType::scalar_field_type::value_bits, g1_window, g1_table,
-                                      std::vector<typename CurveType::scalar_field_type::value_type>(
-                                          Xt_table.begin() + 1, Xt_table.end()));
+                            g1_engine->batch_exp(CurveType::scalar_field_type::value_type::one(), Xt_table, 1,
+                                                 Xt_table.size());
 
                         accumulation_vector<typename CurveType::g1_type> encoded_IC_query(std::move(encoded_IC_base),
                                                                                           std::move(encoded_IC_values));
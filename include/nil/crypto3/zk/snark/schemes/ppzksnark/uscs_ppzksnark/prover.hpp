@@ -27,6 +27,7 @@
 #define CRYPTO3_ZK_USCS_PPZKSNARK_BASIC_PROVER_HPP
 
 #include <memory>
+#include <vector>
 
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/uscs.hpp>
 
@@ -35,9 +36,8 @@
 
 #include <nil/crypto3/algebra/random_element.hpp>
 
-#ifdef MULTICORE
-#include <omp.h>
-#endif
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/multiexp_tasks.hpp>
 
 #include <nil/crypto3/zk/snark/reductions/uscs_to_ssp.hpp>
 #include <nil/crypto3/zk/snark/relations/arithmetic_programs/ssp.hpp>
@@ -72,68 +72,96 @@ namespace nil {
                     typedef typename policy_type::keypair_type keypair_type;
                     typedef typename policy_type::proof_type proof_type;
 
+                    /**
+                     * The multi-exponentiations over V_g1_query, alpha_V_g1_query and V_g2_query only depend
+                     * on the variable assignment. They are split into tasks of similar cost and run together
+                     * on the current executor, alongside the FFTs of the witness map computing the scalars
+                     * of H_g1_query, whose tasks follow once H is known.
+                     */
                     static inline proof_type process(const proving_key_type &proving_key,
                                                      const primary_input_type &primary_input,
                                                      const auxiliary_input_type &auxiliary_input) {
+                        typedef typename CurveType::scalar_field_type scalar_field_type;
+                        typedef typename CurveType::g1_type::value_type g1_value_type;
+                        typedef typename CurveType::g2_type::value_type g2_value_type;
+                        typedef reductions::uscs_to_ssp<scalar_field_type> reduction_type;
 
-                        const typename CurveType::scalar_field_type::value_type d =
-                            algebra::random_element<typename CurveType::scalar_field_type>();
+                        const typename scalar_field_type::value_type d = algebra::random_element<scalar_field_type>();
 
-                        const ssp_witness<typename CurveType::scalar_field_type> ssp_wit =
-                            reductions::uscs_to_ssp<typename CurveType::scalar_field_type>::witness_map(
-                                proving_key.constraint_system, primary_input, auxiliary_input, d);
+                        uscs_variable_assignment<scalar_field_type> assignment = primary_input;
+                        assignment.insert(assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+
+                        const std::shared_ptr<fft::evaluation_domain<scalar_field_type>> domain =
+                            reduction_type::get_domain(proving_key.constraint_system);
+
+                        const std::size_t num_variables = assignment.size();
+                        const std::size_t num_inputs = primary_input.size();
+                        const std::size_t degree = domain->m;
 
                         /* sanity checks */
                         assert(proving_key.constraint_system.is_satisfied(primary_input, auxiliary_input));
-                        assert(proving_key.V_g1_query.size() == ssp_wit.num_variables + 2 - ssp_wit.num_inputs - 1);
-                        assert(proving_key.alpha_V_g1_query.size() ==
-                               ssp_wit.num_variables + 2 - ssp_wit.num_inputs - 1);
-                        assert(proving_key.H_g1_query.size() == ssp_wit.degree + 1);
-                        assert(proving_key.V_g2_query.size() == ssp_wit.num_variables + 2);
-
-                        typename CurveType::g1_type::value_type V_g1 =
-                            ssp_wit.d * proving_key.V_g1_query[proving_key.V_g1_query.size() - 1];
-                        typename CurveType::g1_type::value_type alpha_V_g1 =
-                            ssp_wit.d * proving_key.alpha_V_g1_query[proving_key.alpha_V_g1_query.size() - 1];
-                        typename CurveType::g1_type::value_type H_g1 = CurveType::g1_type::value_type::zero();
-                        typename CurveType::g2_type::value_type V_g2 =
-                            proving_key.V_g2_query[0] +
-                            ssp_wit.d * proving_key.V_g2_query[proving_key.V_g2_query.size() - 1];
-
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env
-                                                                             // var or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
-
-                        // MAYBE LATER: do queries 1,2,4 at once for slightly better speed
-
-                        V_g1 = V_g1 + algebra::multiexp_with_mixed_addition<algebra::policies::multiexp_method_BDLO12>(
-                                          proving_key.V_g1_query.begin(),
-                                          proving_key.V_g1_query.begin() + (ssp_wit.num_variables - ssp_wit.num_inputs),
-                                          ssp_wit.coefficients_for_Vs.begin() + ssp_wit.num_inputs,
-                                          ssp_wit.coefficients_for_Vs.begin() + ssp_wit.num_variables, chunks);
-
-                        alpha_V_g1 =
-                            alpha_V_g1 +
-                            algebra::multiexp_with_mixed_addition<algebra::policies::multiexp_method_BDLO12>(
-                                proving_key.alpha_V_g1_query.begin(),
-                                proving_key.alpha_V_g1_query.begin() + (ssp_wit.num_variables - ssp_wit.num_inputs),
-                                ssp_wit.coefficients_for_Vs.begin() + ssp_wit.num_inputs,
-                                ssp_wit.coefficients_for_Vs.begin() + ssp_wit.num_variables, chunks);
-
-                        H_g1 = H_g1 + algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                          proving_key.H_g1_query.begin(),
-                                          proving_key.H_g1_query.begin() + ssp_wit.degree + 1,
-                                          ssp_wit.coefficients_for_H.begin(),
-                                          ssp_wit.coefficients_for_H.begin() + ssp_wit.degree + 1, chunks);
-
-                        V_g2 = V_g2 + algebra::multiexp<algebra::policies::multiexp_method_BDLO12>(
-                                          proving_key.V_g2_query.begin() + 1,
-                                          proving_key.V_g2_query.begin() + ssp_wit.num_variables + 1,
-                                          ssp_wit.coefficients_for_Vs.begin(),
-                                          ssp_wit.coefficients_for_Vs.begin() + ssp_wit.num_variables, chunks);
+                        assert(proving_key.V_g1_query.size() == num_variables + 2 - num_inputs - 1);
+                        assert(proving_key.alpha_V_g1_query.size() == num_variables + 2 - num_inputs - 1);
+                        assert(proving_key.H_g1_query.size() == degree + 1);
+                        assert(proving_key.V_g2_query.size() == num_variables + 2);
+
+                        const std::size_t g1 = multiexp_task_list::g1_cost, g2 = multiexp_task_list::g2_cost;
+                        multiexp_task_list tasks((num_variables - num_inputs) * 2 * g1 + num_variables * g2 +
+                                                 (degree + 1) * g1);
+
+                        std::vector<typename scalar_field_type::value_type> coefficients_for_H;
+                        std::vector<g1_value_type> parts_V_g1, parts_alpha_V_g1, parts_H_g1;
+                        std::vector<g2_value_type> parts_V_g2;
+
+                        /* the witness map, three FFTs, runs on its own executor alongside the assignment-only
+                           multiexps */
+                        tasks.add_alongside(
+                            [&]() {
+                                typename reduction_type::workspace scratch;
+                                coefficients_for_H = reduction_type::coefficients_for_H(
+                                    proving_key.constraint_system, assignment, d, domain, scratch);
+                            },
+                            multiexp_task_list::fft_cost(degree, 3));
+
+                        tasks.add(parts_V_g2, num_variables, g2, [&](std::size_t first, std::size_t last) {
+                            return dispatch_multiexp<multiexp_method_auto>(
+                                proving_key.V_g2_query.begin() + 1 + first, proving_key.V_g2_query.begin() + 1 + last,
+                                assignment.begin() + first, assignment.begin() + last, 1);
+                        });
+
+                        tasks.add(parts_V_g1, num_variables - num_inputs, g1, [&](std::size_t first, std::size_t last) {
+                            return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                proving_key.V_g1_query.begin() + first, proving_key.V_g1_query.begin() + last,
+                                assignment.begin() + num_inputs + first, assignment.begin() + num_inputs + last, 1);
+                        });
+
+                        tasks.add(parts_alpha_V_g1, num_variables - num_inputs, g1,
+                                  [&](std::size_t first, std::size_t last) {
+                                      return dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                                          proving_key.alpha_V_g1_query.begin() + first,
+                                          proving_key.alpha_V_g1_query.begin() + last,
+                                          assignment.begin() + num_inputs + first,
+                                          assignment.begin() + num_inputs + last, 1);
+                                  });
+
+                        tasks.run();
+
+                        tasks.add(parts_H_g1, degree + 1, g1, [&](std::size_t first, std::size_t last) {
+                            return dispatch_multiexp<multiexp_method_auto>(
+                                proving_key.H_g1_query.begin() + first, proving_key.H_g1_query.begin() + last,
+                                coefficients_for_H.begin() + first, coefficients_for_H.begin() + last, 1);
+                        });
+                        tasks.run();
+
+                        g1_value_type V_g1 = d * proving_key.V_g1_query[proving_key.V_g1_query.size() - 1] +
+                                             multiexp_task_list::sum(parts_V_g1);
+                        g1_value_type alpha_V_g1 =
+                            d * proving_key.alpha_V_g1_query[proving_key.alpha_V_g1_query.size() - 1] +
+                            multiexp_task_list::sum(parts_alpha_V_g1);
+                        g1_value_type H_g1 = multiexp_task_list::sum(parts_H_g1);
+                        g2_value_type V_g2 = proving_key.V_g2_query[0] +
+                                             d * proving_key.V_g2_query[proving_key.V_g2_query.size() - 1] +
+                                             multiexp_task_list::sum(parts_V_g2);
 
                         proof_type proof =
                             proof_type(std::move(V_g1), std::move(alpha_V_g1), std::move(H_g1), std::move(V_g2));
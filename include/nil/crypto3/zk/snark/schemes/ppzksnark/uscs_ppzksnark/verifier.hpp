@@ -26,9 +26,17 @@
 #ifndef CRYPTO3_ZK_USCS_PPZKSNARK_BASIC_VERIFIER_HPP
 #define CRYPTO3_ZK_USCS_PPZKSNARK_BASIC_VERIFIER_HPP
 
+#include <algorithm>
 #include <memory>
+#include <vector>
+
+#include <nil/crypto3/algebra/random_element.hpp>
 
 #include <nil/crypto3/zk/snark/accumulation_vector.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multi_miller_loop.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/random_device_generator.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/uscs.hpp>
 
 #ifdef MULTICORE
@@ -104,6 +112,12 @@ namespace nil {
                 class uscs_ppzksnark_verifier_weak_input_consistency {
                     typedef detail::uscs_ppzksnark_policy<CurveType> policy_type;
 
+                    typedef typename CurveType::pairing pairing_policy;
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::g1_type::value_type g1_value_type;
+                    typedef typename CurveType::g2_type::value_type g2_value_type;
+                    typedef typename pairing_policy::fqk_type fqk_type;
+
                 public:
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
@@ -134,70 +148,201 @@ namespace nil {
                      * A verifier algorithm for the USCS ppzkSNARK that:
                      * (1) accepts a processed verification key, and
                      * (2) has weak input consistency.
+                     *
+                     * The three verification equations are combined as in a batch of one proof, see
+                     * accumulate_batch, for six Miller loops and a single final exponentiation.
                      */
                     static inline bool process(const processed_verification_key_type &pvk,
                                                const primary_input_type &primary_input,
                                                const proof_type &proof) {
-                        typedef typename CurveType::pairing pairing_policy;
+                        return process_batch(pvk, &primary_input, &primary_input + 1, &proof, &proof + 1);
+                    }
 
-                        assert(pvk.encoded_IC_query.domain_size() >= primary_input.size());
+                    /**
+                     * A batch verifier algorithm for the USCS ppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has weak input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &vk,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            uscs_ppzksnark_process_verification_key<CurveType>::process(vk), primary_inputs_first,
+                            primary_inputs_last, proofs_first, proofs_last);
+                    }
 
-                        const accumulation_vector<typename CurveType::g1_type> accumulated_IC =
-                            pvk.encoded_IC_query.accumulate_chunk(
-                                primary_input.begin(), primary_input.end(), 0);
-                        assert(accumulated_IC.is_fully_accumulated());
-                        const typename CurveType::g1_type::value_type &acc = accumulated_IC.first;
+                    /**
+                     * A batch verifier algorithm for the USCS ppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has weak input consistency.
+                     *
+                     * Verifies every proof of [proofs_first, proofs_last) against the primary input at the
+                     * same position of [primary_inputs_first, primary_inputs_last), with the Miller loops of
+                     * accumulate_batch and a single final exponentiation for the whole batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &pvk,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        typename fqk_type::value_type miller_loop_product = fqk_type::value_type::one();
+                        if (!accumulate_batch<DistributionType, GeneratorType>(pvk, primary_inputs_first,
+                                                                               primary_inputs_last, proofs_first,
+                                                                               proofs_last, miller_loop_product)) {
+                            return false;
+                        }
 
-                        bool result = true;
+                        operation_counter::add(operation_counter::final_exponentiation);
+                        return pairing_policy::final_exponentiation(miller_loop_product) ==
+                               CurveType::gt_type::value_type::one();
+                    }
 
-                        if (!proof.is_well_formed()) {
-                            result = false;
+                    /**
+                     * Multiplies into miller_loop_product the Miller loops checking a batch of proofs of the
+                     * USCS ppzkSNARK against a processed verification key, with weak input consistency.
+                     * The batch verifies iff the final exponentiation of the product is one. Returns false if
+                     * a proof is not well formed, a primary input is longer than the key or the batch holds
+                     * more or fewer primary inputs than proofs.
+                     *
+                     * With V'_i = V_g1 + acc_i, the equations of every proof,
+                     *     e(V'_i, 1) = e(1, V_g2), e(V'_i, V_g2) = e(H_g1, Z) e(1, 1),
+                     *     e(V_g1, alpha_tilde) = e(alpha_V_g1, tilde),
+                     * are raised to random non-zero coefficients a_i, b_i and c_i and multiplied over the
+                     * batch, so that the pairings against the same fixed element of the key take the sums of
+                     * their other sides. Besides the pairings e(b_i V'_i, V_g2), which run two proofs at a
+                     * time (see multi_miller_loop), a batch costs five Miller loops whatever its size. A
+                     * batch with an invalid proof passes with negligible probability over the choice of the
+                     * coefficients, drawn from GeneratorType, the entropy of the system by default.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool accumulate_batch(const processed_verification_key_type &pvk,
+                                                        InputPrimaryInputIterator primary_inputs_first,
+                                                        InputPrimaryInputIterator primary_inputs_last,
+                                                        InputProofIterator proofs_first,
+                                                        InputProofIterator proofs_last,
+                                                        typename fqk_type::value_type &miller_loop_product) {
+                        typedef typename scalar_field_type::value_type scalar_field_value_type;
+
+                        std::vector<const primary_input_type *> primary_inputs;
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            primary_inputs.emplace_back(&*it);
                         }
-
-                        typename pairing_policy::g1_precomp proof_V_g1_with_acc_precomp =
-                            pairing_policy::precompute_g1(proof.V_g1 + acc);
-                        typename pairing_policy::g2_precomp proof_V_g2_precomp =
-                            pairing_policy::precompute_g2(proof.V_g2);
-                        typename pairing_policy::fqk_type::value_type V_1 =
-                            pairing_policy::miller_loop(proof_V_g1_with_acc_precomp, pvk.pp_G2_one_precomp);
-                        typename pairing_policy::fqk_type::value_type V_2 =
-                            pairing_policy::miller_loop(pvk.pp_G1_one_precomp, proof_V_g2_precomp);
-                        typename CurveType::gt_type::value_type V =
-                            pairing_policy::final_exponentiation(V_1 * V_2.unitary_inversed());
-
-                        if (V != CurveType::gt_type::value_type::one()) {
-                            result = false;
+                        std::vector<const proof_type *> proofs;
+                        for (InputProofIterator it = proofs_first; it != proofs_last; ++it) {
+                            proofs.emplace_back(&*it);
                         }
 
-                        typename pairing_policy::g1_precomp proof_H_g1_precomp =
-                            pairing_policy::precompute_g1(proof.H_g1);
-                        typename pairing_policy::fqk_type::value_type SSP_1 =
-                            pairing_policy::miller_loop(proof_V_g1_with_acc_precomp, proof_V_g2_precomp);
-                        typename pairing_policy::fqk_type::value_type SSP_2 =
-                            pairing_policy::miller_loop(proof_H_g1_precomp, pvk.vk_Z_g2_precomp);
-                        typename CurveType::gt_type::value_type SSP = pairing_policy::final_exponentiation(
-                            SSP_1.unitary_inversed() * SSP_2 * pvk.pairing_of_g1_and_g2);
+                        if (primary_inputs.size() != proofs.size()) {
+                            return false;
+                        }
+                        const std::size_t batch_size = proofs.size();
+                        if (!batch_size) {
+                            return true;
+                        }
 
-                        if (SSP != CurveType::gt_type::value_type::one()) {
-                            result = false;
+                        /* the coefficients of the V, SSP and alpha checks are drawn up front, in the order of
+                         * the batch */
+                        constexpr const std::size_t num_checks = 3;
+                        std::vector<scalar_field_value_type> coefficients;
+                        coefficients.reserve(num_checks * batch_size);
+                        for (std::size_t i = 0; i < batch_size; ++i) {
+                            if (pvk.encoded_IC_query.domain_size() < primary_inputs[i]->size() ||
+                                !proofs[i]->is_well_formed()) {
+                                return false;
+                            }
+
+                            for (std::size_t k = 0; k < num_checks; ++k) {
+                                scalar_field_value_type coefficient =
+                                    algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                while (coefficient.is_zero()) {
+                                    coefficient =
+                                        algebra::random_element<scalar_field_type, DistributionType, GeneratorType>();
+                                }
+                                coefficients.emplace_back(coefficient);
+                            }
                         }
 
-                        typename pairing_policy::g1_precomp proof_V_g1_precomp =
-                            pairing_policy::precompute_g1(proof.V_g1);
-                        typename pairing_policy::g1_precomp proof_alpha_V_g1_precomp =
-                            pairing_policy::precompute_g1(proof.alpha_V_g1);
-                        typename pairing_policy::fqk_type::value_type alpha_V_1 =
-                            pairing_policy::miller_loop(proof_V_g1_precomp, pvk.vk_alpha_tilde_g2_precomp);
-                        typename pairing_policy::fqk_type::value_type alpha_V_2 =
-                            pairing_policy::miller_loop(proof_alpha_V_g1_precomp, pvk.vk_tilde_g2_precomp);
-                        typename CurveType::gt_type::value_type alpha_V =
-                            pairing_policy::final_exponentiation(alpha_V_1 * alpha_V_2.unitary_inversed());
-
-                        if (alpha_V != CurveType::gt_type::value_type::one()) {
-                            result = false;
+                        /* the sides paired with the fixed elements of the key, accumulated per block of proofs */
+                        struct sums_type {
+                            g1_value_type one, H, V, alpha_V;
+                            g2_value_type V_g2;
+                        };
+                        const std::size_t num_blocks = std::min(batch_size, executor::current().concurrency());
+                        const std::size_t block_size = (batch_size + num_blocks - 1) / num_blocks;
+
+                        std::vector<g1_value_type> scaled_V_acc(batch_size);
+                        std::vector<g2_value_type> V_g2(batch_size);
+                        std::vector<sums_type> block_sums(num_blocks,
+                                                          {g1_value_type::zero(), g1_value_type::zero(),
+                                                           g1_value_type::zero(), g1_value_type::zero(),
+                                                           g2_value_type::zero()});
+                        executor::current().bulk(num_blocks, [&](const std::size_t block) {
+                            sums_type &sums = block_sums[block];
+                            const std::size_t end = std::min(batch_size, (block + 1) * block_size);
+                            for (std::size_t i = block * block_size; i < end; ++i) {
+                                const proof_type &proof = *proofs[i];
+                                const scalar_field_value_type *r = &coefficients[num_checks * i];
+
+                                const g1_value_type V_acc =
+                                    proof.V_g1 + pvk.encoded_IC_query
+                                                     .accumulate_chunk(primary_inputs[i]->begin(),
+                                                                       primary_inputs[i]->end(), 0)
+                                                     .first;
+                                operation_counter::add(operation_counter::g1_exp_term, primary_inputs[i]->size());
+
+                                // e(V', 1) = e(1, V_g2)
+                                sums.one = sums.one + r[0] * V_acc;
+                                sums.V_g2 = sums.V_g2 + r[0] * proof.V_g2;
+
+                                // e(V', V_g2) = e(H, Z) e(1, 1)
+                                scaled_V_acc[i] = r[1] * V_acc;
+                                V_g2[i] = proof.V_g2;
+                                sums.H = sums.H + r[1] * proof.H_g1;
+                                sums.one = sums.one + r[1] * g1_value_type::one();
+
+                                // e(V, alpha_tilde) = e(alpha_V, tilde)
+                                sums.V = sums.V + r[2] * proof.V_g1;
+                                sums.alpha_V = sums.alpha_V + r[2] * proof.alpha_V_g1;
+                            }
+                        });
+
+                        sums_type sums = block_sums[0];
+                        for (std::size_t block = 1; block < num_blocks; ++block) {
+                            sums.one = sums.one + block_sums[block].one;
+                            sums.H = sums.H + block_sums[block].H;
+                            sums.V = sums.V + block_sums[block].V;
+                            sums.alpha_V = sums.alpha_V + block_sums[block].alpha_V;
+                            sums.V_g2 = sums.V_g2 + block_sums[block].V_g2;
                         }
 
-                        return result;
+                        const typename fqk_type::value_type SSP_1 =
+                            multi_miller_loop<CurveType>(scaled_V_acc.begin(), scaled_V_acc.end(), V_g2.begin());
+                        const typename fqk_type::value_type left_1 = pairing_policy::double_miller_loop(
+                            pairing_policy::precompute_g1(sums.one), pvk.pp_G2_one_precomp,
+                            pairing_policy::precompute_g1(sums.V), pvk.vk_alpha_tilde_g2_precomp);
+                        const typename fqk_type::value_type right = pairing_policy::double_miller_loop(
+                            pvk.pp_G1_one_precomp, pairing_policy::precompute_g2(sums.V_g2),
+                            pairing_policy::precompute_g1(sums.alpha_V), pvk.vk_tilde_g2_precomp);
+                        const typename fqk_type::value_type left_2 =
+                            pairing_policy::miller_loop(pairing_policy::precompute_g1(sums.H), pvk.vk_Z_g2_precomp);
+
+                        operation_counter::add(operation_counter::miller_loop, 5);
+                        miller_loop_product =
+                            miller_loop_product * left_1 * left_2 * (SSP_1 * right).unitary_inversed();
+                        return true;
                     }
                 };
 
@@ -205,6 +350,9 @@ namespace nil {
                 class uscs_ppzksnark_verifier_strong_input_consistency {
                     typedef detail::uscs_ppzksnark_policy<CurveType> policy_type;
 
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    typedef typename CurveType::pairing::fqk_type fqk_type;
+
                 public:
                     typedef typename policy_type::constraint_system_type constraint_system_type;
                     typedef typename policy_type::primary_input_type primary_input_type;
@@ -249,6 +397,75 @@ namespace nil {
 
                         return result;
                     }
+
+                    /**
+                     * A batch verifier algorithm for the USCS ppzkSNARK that:
+                     * (1) accepts a non-processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const verification_key_type &vk,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        return process_batch<DistributionType, GeneratorType>(
+                            uscs_ppzksnark_process_verification_key<CurveType>::process(vk), primary_inputs_first,
+                            primary_inputs_last, proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * A batch verifier algorithm for the USCS ppzkSNARK that:
+                     * (1) accepts a processed verification key, and
+                     * (2) has strong input consistency.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool process_batch(const processed_verification_key_type &pvk,
+                                                     InputPrimaryInputIterator primary_inputs_first,
+                                                     InputPrimaryInputIterator primary_inputs_last,
+                                                     InputProofIterator proofs_first,
+                                                     InputProofIterator proofs_last) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (pvk.encoded_IC_query.domain_size() != it->size()) {
+                                return false;
+                            }
+                        }
+
+                        return uscs_ppzksnark_verifier_weak_input_consistency<CurveType>::template process_batch<
+                            DistributionType, GeneratorType>(pvk, primary_inputs_first, primary_inputs_last,
+                                                             proofs_first, proofs_last);
+                    }
+
+                    /**
+                     * Accumulates the Miller loops of a batch with strong input consistency, see
+                     * uscs_ppzksnark_verifier_weak_input_consistency::accumulate_batch.
+                     */
+                    template<typename DistributionType =
+                                 boost::random::uniform_int_distribution<typename scalar_field_type::modulus_type>,
+                             typename GeneratorType = random_device_generator, typename InputPrimaryInputIterator,
+                             typename InputProofIterator>
+                    static inline bool accumulate_batch(const processed_verification_key_type &pvk,
+                                                        InputPrimaryInputIterator primary_inputs_first,
+                                                        InputPrimaryInputIterator primary_inputs_last,
+                                                        InputProofIterator proofs_first,
+                                                        InputProofIterator proofs_last,
+                                                        typename fqk_type::value_type &miller_loop_product) {
+                        for (InputPrimaryInputIterator it = primary_inputs_first; it != primary_inputs_last; ++it) {
+                            if (pvk.encoded_IC_query.domain_size() != it->size()) {
+                                return false;
+                            }
+                        }
+
+                        return uscs_ppzksnark_verifier_weak_input_consistency<CurveType>::template accumulate_batch<
+                            DistributionType, GeneratorType>(pvk, primary_inputs_first, primary_inputs_last,
+                                                             proofs_first, proofs_last, miller_loop_product);
+                    }
                 };
             }    // namespace snark
         }        // namespace zk
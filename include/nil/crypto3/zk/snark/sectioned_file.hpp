@@ -0,0 +1,287 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of a container file of named sections with a table of contents.
+//
+// A sectioned file is a header, a table of contents and the sections themselves, each one
+// starting at a 64-byte aligned offset. The table gives the name, offset and size of every
+// section, so a reader opening the file reads the header and the table only, and then reads
+// or maps the sections it needs; the cost of loading scales with what is used rather than
+// with the size of the file. The header and the table are little-endian 64-bit integers and
+// fixed-size names, so the container itself is portable; what the sections hold is up to
+// the format writing them, see r1cs_gg_ppzksnark/keypair_file.hpp.
+//
+//     sectioned_file_writer out(path, 2);
+//     out.write_section("verification_key", vk_bytes.data(), vk_bytes.size());
+//     out.write_section("A_query", a_bytes.data(), a_bytes.size());
+//     out.close();
+//
+//     const sectioned_file in(path);
+//     const std::vector<std::uint8_t> vk_bytes = in.read("verification_key");
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_SECTIONED_FILE_HPP
+#define CRYPTO3_ZK_SECTIONED_FILE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                struct sectioned_file_layout {
+                    static constexpr const std::uint64_t magic = 0x5443455345544b5aULL;    // "ZKTESECT"
+                    static constexpr const std::uint64_t version = 1;
+                    static constexpr const std::size_t alignment = 64;
+                    static constexpr const std::size_t max_name_size = 40;
+
+                    /* Name, offset and size of a section, 56 bytes on disk. */
+                    struct entry_type {
+                        std::string name;
+                        std::uint64_t offset;
+                        std::uint64_t size;
+                    };
+
+                    static constexpr const std::size_t header_size = 3 * sizeof(std::uint64_t);
+                    static constexpr const std::size_t entry_size = max_name_size + 2 * sizeof(std::uint64_t);
+
+                    static std::uint64_t align(const std::uint64_t offset) {
+                        return (offset + alignment - 1) / alignment * alignment;
+                    }
+
+                    static void put(std::ostream &out, const std::uint64_t value) {
+                        std::array<char, sizeof(std::uint64_t)> bytes;
+                        for (std::size_t i = 0; i < bytes.size(); ++i) {
+                            bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+                        }
+                        out.write(bytes.data(), bytes.size());
+                    }
+
+                    static std::uint64_t get(std::istream &in) {
+                        std::array<unsigned char, sizeof(std::uint64_t)> bytes {};
+                        in.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+                        std::uint64_t value = 0;
+                        for (std::size_t i = bytes.size(); i-- > 0;) {
+                            value = (value << 8) | bytes[i];
+                        }
+                        return value;
+                    }
+                };
+
+                /**
+                 * Writer of a sectioned file with room for at most max_sections sections, written one after
+                 * the other; the table of contents is written by close().
+                 */
+                class sectioned_file_writer {
+                public:
+                    typedef sectioned_file_layout layout_type;
+
+                    sectioned_file_writer(const std::string &path, const std::size_t max_sections) :
+                        path(path), out(path, std::ios::binary | std::ios::trunc), max_sections(max_sections),
+                        offset(layout_type::align(layout_type::header_size + max_sections * layout_type::entry_size)),
+                        closed(false) {
+                        if (!out) {
+                            throw std::runtime_error("sectioned_file_writer: cannot write " + path);
+                        }
+                    }
+
+                    sectioned_file_writer(const sectioned_file_writer &) = delete;
+                    sectioned_file_writer &operator=(const sectioned_file_writer &) = delete;
+
+                    ~sectioned_file_writer() {
+                        if (!closed) {
+                            try {
+                                close();
+                            } catch (...) {
+                            }
+                        }
+                    }
+
+                    void write_section(const std::string &name, const std::uint8_t *data, const std::size_t size) {
+                        BOOST_ASSERT(!closed);
+                        if (entries.size() == max_sections || name.empty() ||
+                            name.size() > layout_type::max_name_size) {
+                            throw std::invalid_argument("sectioned_file_writer: cannot add section " + name);
+                        }
+                        for (const layout_type::entry_type &entry : entries) {
+                            if (entry.name == name) {
+                                throw std::invalid_argument("sectioned_file_writer: duplicate section " + name);
+                            }
+                        }
+
+                        entries.push_back({name, offset, size});
+                        out.seekp(offset);
+                        out.write(reinterpret_cast<const char *>(data), size);
+                        offset = layout_type::align(offset + size);
+                    }
+
+                    void write_section(const std::string &name, const std::vector<std::uint8_t> &data) {
+                        write_section(name, data.data(), data.size());
+                    }
+
+                    /**
+                     * Writes the header and the table of contents, and pads the file to its last aligned
+                     * offset.
+                     */
+                    void close() {
+                        closed = true;
+                        out.seekp(0);
+                        layout_type::put(out, layout_type::magic);
+                        layout_type::put(out, layout_type::version);
+                        layout_type::put(out, entries.size());
+                        for (const layout_type::entry_type &entry : entries) {
+                            std::array<char, layout_type::max_name_size> name {};
+                            std::copy(entry.name.begin(), entry.name.end(), name.begin());
+                            out.write(name.data(), name.size());
+                            layout_type::put(out, entry.offset);
+                            layout_type::put(out, entry.size);
+                        }
+                        out.seekp(offset - 1);
+                        out.put(0);
+
+                        out.close();
+                        if (!out) {
+                            throw std::runtime_error("sectioned_file_writer: cannot write " + path);
+                        }
+                    }
+
+                private:
+                    std::string path;
+                    std::ofstream out;
+                    std::size_t max_sections;
+                    std::uint64_t offset;
+                    std::vector<layout_type::entry_type> entries;
+                    bool closed;
+                };
+
+                /**
+                 * Reader of a sectioned file. Opening it reads the table of contents only; every section is
+                 * read on demand.
+                 */
+                class sectioned_file {
+                public:
+                    typedef sectioned_file_layout layout_type;
+                    typedef layout_type::entry_type entry_type;
+
+                    explicit sectioned_file(const std::string &path) : path(path) {
+                        std::ifstream in(path, std::ios::binary);
+                        in.seekg(0, std::ios::end);
+                        const std::uint64_t file_size = in ? static_cast<std::uint64_t>(in.tellg()) : 0;
+                        in.seekg(0);
+
+                        const bool compatible = file_size >= layout_type::header_size &&
+                                                layout_type::get(in) == layout_type::magic &&
+                                                layout_type::get(in) == layout_type::version;
+                        const std::uint64_t count = compatible ? layout_type::get(in) : 0;
+                        if (!compatible || !in ||
+                            count > (file_size - layout_type::header_size) / layout_type::entry_size) {
+                            throw std::runtime_error("sectioned_file: incompatible file " + path);
+                        }
+
+                        entries.resize(count);
+                        for (entry_type &entry : entries) {
+                            std::array<char, layout_type::max_name_size> name {};
+                            in.read(name.data(), name.size());
+                            entry.name.assign(name.data(), std::find(name.begin(), name.end(), 0));
+                            entry.offset = layout_type::get(in);
+                            entry.size = layout_type::get(in);
+                            if (!in || entry.offset > file_size || entry.size > file_size - entry.offset) {
+                                throw std::runtime_error("sectioned_file: truncated file " + path);
+                            }
+                        }
+                    }
+
+                    const std::vector<entry_type> &sections() const {
+                        return entries;
+                    }
+
+                    bool contains(const std::string &name) const {
+                        return find(name) != nullptr;
+                    }
+
+                    /* The section called name, which must exist. */
+                    const entry_type &section(const std::string &name) const {
+                        const entry_type *entry = find(name);
+                        if (!entry) {
+                            throw std::out_of_range("sectioned_file: no section " + name + " in " + path);
+                        }
+                        return *entry;
+                    }
+
+                    /**
+                     * Reads the bytes [first, first + size) of the section called name.
+                     */
+                    std::vector<std::uint8_t> read(const std::string &name, const std::uint64_t first,
+                                                   const std::uint64_t size) const {
+                        const entry_type &entry = section(name);
+                        BOOST_ASSERT(first <= entry.size && size <= entry.size - first);
+
+                        std::vector<std::uint8_t> result(size);
+                        std::ifstream in(path, std::ios::binary);
+                        in.seekg(entry.offset + first);
+                        in.read(reinterpret_cast<char *>(result.data()), size);
+                        if (!in) {
+                            throw std::runtime_error("sectioned_file: cannot read section " + name + " of " + path);
+                        }
+                        return result;
+                    }
+
+                    std::vector<std::uint8_t> read(const std::string &name) const {
+                        return read(name, 0, section(name).size);
+                    }
+
+                    const std::string &file_path() const {
+                        return path;
+                    }
+
+                private:
+                    const entry_type *find(const std::string &name) const {
+                        for (const entry_type &entry : entries) {
+                            if (entry.name == name) {
+                                return &entry;
+                            }
+                        }
+                        return nullptr;
+                    }
+
+                    std::string path;
+                    std::vector<entry_type> entries;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_SECTIONED_FILE_HPP
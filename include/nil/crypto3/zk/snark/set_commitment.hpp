@@ -26,7 +26,19 @@
 #ifndef CRYPTO3_ZK_SNARK_SET_COMMITMENT_HPP
 #define CRYPTO3_ZK_SNARK_SET_COMMITMENT_HPP
 
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/merkle_frontier.hpp>
 #include <nil/crypto3/zk/snark/merkle_tree.hpp>
+#include <nil/crypto3/zk/snark/multi_buffer_hash.hpp>
+#include <nil/crypto3/zk/snark/packed_digest.hpp>
 #include <nil/crypto3/zk/snark/components/hashes/hash_io.hpp>
 
 namespace nil {
@@ -53,11 +65,182 @@ namespace nil {
                     }
                 };
 
-                template<typename Hash>
+                /**
+                 * Membership proof of several values at once: the address of every value, in the order
+                 * of the values, and the multi-path of these addresses, in which the nodes that several
+                 * of their paths share appear once.
+                 */
+                struct set_membership_batch_proof {
+                    std::vector<std::size_t> addresses;
+                    merkle_authentication_multi_path merkle_multi_path;
+
+                    bool operator==(const set_membership_batch_proof &other) const {
+                        return (this->addresses == other.addresses &&
+                                this->merkle_multi_path == other.merkle_multi_path);
+                    }
+
+                    std::size_t size_in_bits() const {
+                        std::size_t result = 8 * sizeof(std::size_t) * addresses.size();
+                        for (const merkle_authentication_node &node : merkle_multi_path) {
+                            result += node.size();
+                        }
+                        return result;
+                    }
+                };
+
+                namespace detail {
+
+                    /* Adds node at position to nodes, which must not hold another node there. */
+                    inline bool merge_set_membership_node(std::map<std::size_t, std::vector<bool>> &nodes,
+                                                          const std::size_t position, const std::vector<bool> &node) {
+                        const auto inserted = nodes.emplace(position, node);
+                        return inserted.second || inserted.first->second == node;
+                    }
+
+                    inline bool is_set_membership_address(const std::size_t depth, const std::size_t address) {
+                        return depth >= 8 * sizeof(std::size_t) || address < (std::size_t(1) << depth);
+                    }
+
+                    /* Digests of the values of [first, last) by Hash, hashed in parallel batches. */
+                    template<typename Hash, typename InputIterator>
+                    std::vector<std::vector<bool>> set_membership_leaves(InputIterator first, InputIterator last) {
+                        const std::vector<std::vector<bool>> values(first, last);
+                        std::vector<std::vector<bool>> hashes(values.size());
+                        multi_buffer_hash_each<Hash>(
+                            values.size(), [&](const std::size_t i) -> const std::vector<bool> & { return values[i]; },
+                            [&](const std::size_t i, std::vector<bool> hash) { hashes[i] = std::move(hash); });
+                        return hashes;
+                    }
+
+                    /*
+                     * Open-addressing hash table from packed digests of DigestBits bits to positions.
+                     * The keys are stored back to back in one array and probed linearly; the table
+                     * is kept at most half full.
+                     */
+                    template<std::size_t DigestBits>
+                    class digest_position_table {
+                        constexpr static const std::size_t key_bytes = packed_digest<DigestBits>::bytes;
+
+                    public:
+                        typedef packed_digest<DigestBits> key_type;
+
+                        static constexpr const std::size_t npos = std::size_t(-1);
+
+                        std::size_t size() const {
+                            return count;
+                        }
+
+                        void reserve(const std::size_t n) {
+                            std::size_t capacity = std::max<std::size_t>(16, slots.size());
+                            while (capacity < 2 * n) {
+                                capacity *= 2;
+                            }
+                            if (capacity != slots.size()) {
+                                rehash(capacity);
+                            }
+                        }
+
+                        std::size_t find(const key_type &key) const {
+                            if (slots.empty()) {
+                                return npos;
+                            }
+                            for (std::size_t slot = first_slot(key);; slot = (slot + 1) & (slots.size() - 1)) {
+                                if (!slots[slot]) {
+                                    return npos;
+                                }
+                                if (std::memcmp(keys.data() + slot * key_bytes, key.data.data(), key_bytes) == 0) {
+                                    return slots[slot] - 1;
+                                }
+                            }
+                        }
+
+                        /* Maps key to position unless it is already present; returns whether it was added. */
+                        bool insert(const key_type &key, const std::size_t position) {
+                            reserve(count + 1);
+                            for (std::size_t slot = first_slot(key);; slot = (slot + 1) & (slots.size() - 1)) {
+                                if (!slots[slot]) {
+                                    std::memcpy(keys.data() + slot * key_bytes, key.data.data(), key_bytes);
+                                    slots[slot] = position + 1;
+                                    ++count;
+                                    return true;
+                                }
+                                if (std::memcmp(keys.data() + slot * key_bytes, key.data.data(), key_bytes) == 0) {
+                                    return false;
+                                }
+                            }
+                        }
+
+                    private:
+                        /* the keys are digests, so their leading bytes are already uniformly distributed */
+                        std::size_t first_slot(const key_type &key) const {
+                            std::uint64_t h = 0;
+                            std::memcpy(&h, key.data.data(), std::min<std::size_t>(sizeof(h), key_bytes));
+                            return std::size_t(h * 0x9e3779b97f4a7c15ULL >> 17) & (slots.size() - 1);
+                        }
+
+                        void rehash(const std::size_t capacity) {
+                            std::vector<std::uint8_t> old_keys(capacity * key_bytes);
+                            std::vector<std::size_t> old_slots(capacity);
+                            old_keys.swap(keys);
+                            old_slots.swap(slots);
+
+                            key_type key;
+                            for (std::size_t slot = 0; slot < old_slots.size(); ++slot) {
+                                if (old_slots[slot]) {
+                                    std::memcpy(key.data.data(), old_keys.data() + slot * key_bytes, key_bytes);
+                                    std::size_t new_slot = first_slot(key);
+                                    while (slots[new_slot]) {
+                                        new_slot = (new_slot + 1) & (slots.size() - 1);
+                                    }
+                                    std::memcpy(keys.data() + new_slot * key_bytes, key.data.data(), key_bytes);
+                                    slots[new_slot] = old_slots[slot];
+                                }
+                            }
+                        }
+
+                        std::vector<std::uint8_t> keys;
+                        /* position + 1 of the key of each slot, 0 for an empty slot */
+                        std::vector<std::size_t> slots;
+                        std::size_t count = 0;
+                    };
+                }    // namespace detail
+
+                /**
+                 * A set membership proof whose authentication path is made of packed digests.
+                 */
+                template<std::size_t DigestBits>
+                struct packed_set_membership_proof {
+                    std::size_t address;
+                    std::vector<packed_digest<DigestBits>> merkle_path;
+
+                    bool operator==(const packed_set_membership_proof &other) const {
+                        return (this->address == other.address && this->merkle_path == other.merkle_path);
+                    }
+
+                    set_membership_proof to_set_membership_proof() const {
+                        return {address, to_bits(merkle_path)};
+                    }
+
+                    std::size_t size_in_bits() const {
+                        return 8 * sizeof(address) + DigestBits * merkle_path.size();
+                    }
+                };
+
+                /**
+                 * Commits to a set of values with a Merkle tree over their hashes, in insertion
+                 * order. TreeType is flat_merkle_tree by default, which can prove the membership of
+                 * any value, or merkle_frontier, which keeps O(depth) nodes and only proves the
+                 * membership of the values added with add_tracked.
+                 */
+                template<typename Hash, typename TreeType = flat_merkle_tree<Hash>>
                 class set_commitment_accumulator {
                 private:
-                    std::shared_ptr<merkle_tree<Hash>> tree;
-                    std::map<std::vector<bool>, std::size_t> hash_to_pos;
+                    typedef TreeType tree_type;
+                    typedef typename tree_type::packed_digest_type packed_digest_type;
+                    typedef detail::digest_position_table<Hash::digest_bits> table_type;
+
+                    std::shared_ptr<tree_type> tree;
+                    table_type hash_to_pos;
 
                 public:
                     std::size_t depth;
@@ -69,42 +252,287 @@ namespace nil {
                         depth = static_cast<std::size_t>(std::ceil(std::log2(max_entries)));
                         digest_size = Hash::get_digest_len();
 
-                        tree.reset(new merkle_tree<Hash>(depth, digest_size));
+                        tree.reset(new tree_type(depth, digest_size));
                     }
 
                     void add(const std::vector<bool> &value) {
                         assert(value_size == 0 || value.size() == value_size);
-                        const std::vector<bool> hash = Hash::get_hash(value);
-                        if (hash_to_pos.find(hash) == hash_to_pos.end()) {
-                            const std::size_t pos = hash_to_pos.size();
+                        const packed_digest_type hash(Hash::get_hash(value));
+                        const std::size_t pos = hash_to_pos.size();
+                        if (hash_to_pos.insert(hash, pos)) {
                             tree->set_value(pos, hash);
-                            hash_to_pos[hash] = pos;
+                        }
+                    }
+
+                    /**
+                     * Adds value and keeps its membership proof up to date as the set grows, with
+                     * a merkle_frontier tree. A value already in the set was not tracked when added
+                     * and is left as is; the result tells whether value was added.
+                     */
+                    bool add_tracked(const std::vector<bool> &value) {
+                        assert(value_size == 0 || value.size() == value_size);
+                        const packed_digest_type hash(Hash::get_hash(value));
+                        const std::size_t pos = hash_to_pos.size();
+                        if (!hash_to_pos.insert(hash, pos)) {
+                            return false;
+                        }
+                        tree->append(hash, true);
+                        return true;
+                    }
+
+                    /**
+                     * Adds the values of [first, last), which are hashed in parallel batches on the
+                     * current executor, see multi_buffer_hash_each. The new leaves are then written
+                     * into the Merkle tree at once: an empty tree is built in one pass, otherwise
+                     * their shared ancestors are hashed once.
+                     */
+                    template<typename InputIterator>
+                    void add_range(InputIterator first, InputIterator last) {
+                        const std::vector<std::vector<bool>> values(first, last);
+                        std::vector<std::vector<bool>> hashes(values.size());
+                        multi_buffer_hash_each<Hash>(
+                            values.size(),
+                            [&](const std::size_t i) -> const std::vector<bool> & {
+                                assert(value_size == 0 || values[i].size() == value_size);
+                                return values[i];
+                            },
+                            [&](const std::size_t i, std::vector<bool> hash) { hashes[i] = std::move(hash); });
+
+                        const bool was_empty = hash_to_pos.size() == 0;
+                        hash_to_pos.reserve(hash_to_pos.size() + hashes.size());
+
+                        std::vector<std::vector<bool>> leaves;
+                        std::map<std::size_t, std::vector<bool>> batch;
+                        for (std::vector<bool> &hash : hashes) {
+                            const std::size_t pos = hash_to_pos.size();
+                            if (hash_to_pos.insert(packed_digest_type(hash), pos)) {
+                                if (was_empty) {
+                                    leaves.emplace_back(std::move(hash));
+                                } else {
+                                    batch.emplace(pos, std::move(hash));
+                                }
+                            }
+                        }
+
+                        if (was_empty) {
+                            if (!leaves.empty()) {
+                                tree.reset(new tree_type(depth, digest_size, leaves));
+                            }
+                        } else {
+                            tree->set_values(batch);
                         }
                     }
 
                     bool is_in_set(const std::vector<bool> &value) const {
                         assert(value_size == 0 || value.size() == value_size);
                         const std::vector<bool> hash = Hash::get_hash(value);
-                        return (hash_to_pos.find(hash) != hash_to_pos.end());
+                        return (hash_to_pos.find(packed_digest_type(hash)) != table_type::npos);
                     }
 
                     set_commitment get_commitment() const {
                         return tree->get_root();
                     }
 
+                    /**
+                     * Membership proof of value with its path in packed form.
+                     */
+                    packed_set_membership_proof<Hash::digest_bits>
+                        get_packed_membership_proof(const std::vector<bool> &value) const {
+                        const std::size_t pos = hash_to_pos.find(packed_digest_type(Hash::get_hash(value)));
+                        assert(pos != table_type::npos);
+
+                        packed_set_membership_proof<Hash::digest_bits> proof;
+                        proof.address = pos;
+                        proof.merkle_path = tree->get_packed_path(pos);
+
+                        return proof;
+                    }
+
                     set_membership_proof get_membership_proof(const std::vector<bool> &value) const {
                         const std::vector<bool> hash = Hash::get_hash(value);
-                        auto it = hash_to_pos.find(hash);
-                        assert(it != hash_to_pos.end());
+                        const std::size_t pos = hash_to_pos.find(packed_digest_type(hash));
+                        assert(pos != table_type::npos);
 
                         set_membership_proof proof;
-                        proof.address = it->second;
-                        proof.merkle_path = tree->get_path(it->second);
+                        proof.address = pos;
+                        proof.merkle_path = tree->get_path(pos);
 
                         return proof;
                     }
+
+                    /**
+                     * Membership proofs of the values of [first, last), in order. The values are hashed
+                     * and looked up in parallel batches, and their paths read, on the current executor.
+                     * Throws std::runtime_error if one of the values is not in the set.
+                     */
+                    template<typename InputIterator>
+                    std::vector<set_membership_proof> get_membership_proofs(InputIterator first,
+                                                                            InputIterator last) const {
+                        const std::vector<std::size_t> positions = find_positions(first, last);
+
+                        std::vector<set_membership_proof> proofs(positions.size());
+                        executor::current().parallel_for(positions.size(), [&](const std::size_t i) {
+                            proofs[i].address = positions[i];
+                            proofs[i].merkle_path = tree->get_path(positions[i]);
+                        });
+                        return proofs;
+                    }
+
+                    /**
+                     * Membership proof of all the values of [first, last) at once, whose multi-path holds
+                     * every node shared by their paths once, see set_membership_batch_proof. Throws
+                     * std::runtime_error if one of the values is not in the set.
+                     */
+                    template<typename InputIterator>
+                    set_membership_batch_proof get_batch_membership_proof(InputIterator first,
+                                                                          InputIterator last) const {
+                        set_membership_batch_proof proof;
+                        proof.addresses = find_positions(first, last);
+                        proof.merkle_multi_path = tree->get_multi_path(proof.addresses);
+                        return proof;
+                    }
+
+                private:
+                    template<typename InputIterator>
+                    std::vector<std::size_t> find_positions(InputIterator first, InputIterator last) const {
+                        const std::vector<std::vector<bool>> values(first, last);
+                        std::vector<std::size_t> positions(values.size());
+                        multi_buffer_hash_each<Hash>(
+                            values.size(),
+                            [&](const std::size_t i) -> const std::vector<bool> & {
+                                assert(value_size == 0 || values[i].size() == value_size);
+                                return values[i];
+                            },
+                            [&](const std::size_t i, const std::vector<bool> &hash) {
+                                positions[i] = hash_to_pos.find(packed_digest_type(hash));
+                            });
+                        for (const std::size_t position : positions) {
+                            if (position == table_type::npos) {
+                                throw std::runtime_error("set_commitment_accumulator: value not in the set");
+                            }
+                        }
+                        return positions;
+                    }
                 };
 
+                /**
+                 * Checks the membership proofs of the values of [values_first, values_last), in order,
+                 * against commitment, the root of a tree with depth layers over the leaves.
+                 *
+                 * The paths are checked together, layer by layer from the leaves up: a node shared by
+                 * several of them is hashed once and must be the same in all of them, and the nodes of a
+                 * layer are hashed in parallel batches.
+                 */
+                template<typename Hash, typename InputIterator>
+                bool verify_set_membership_proofs(const set_commitment &commitment, const std::size_t depth,
+                                                  InputIterator values_first, InputIterator values_last,
+                                                  const std::vector<set_membership_proof> &proofs) {
+                    const std::size_t digest_size = Hash::get_digest_len();
+                    const std::vector<std::vector<bool>> leaves =
+                        detail::set_membership_leaves<Hash>(values_first, values_last);
+                    if (leaves.size() != proofs.size()) {
+                        return false;
+                    }
+
+                    std::vector<std::size_t> positions;
+                    std::map<std::size_t, std::vector<bool>> nodes;
+                    for (std::size_t i = 0; i < proofs.size(); ++i) {
+                        const set_membership_proof &proof = proofs[i];
+                        if (!detail::is_set_membership_address(depth, proof.address) ||
+                            proof.merkle_path.size() != depth ||
+                            !detail::merge_set_membership_node(nodes, proof.address, leaves[i])) {
+                            return false;
+                        }
+                        positions.emplace_back(proof.address);
+                    }
+
+                    for (std::size_t layer = depth; layer > 0; --layer) {
+                        for (std::size_t i = 0; i < proofs.size(); ++i) {
+                            const merkle_authentication_node &sibling = proofs[i].merkle_path[layer - 1];
+                            if (sibling.size() != digest_size ||
+                                !detail::merge_set_membership_node(nodes, positions[i] ^ 1, sibling)) {
+                                return false;
+                            }
+                            positions[i] /= 2;
+                        }
+
+                        /* every node of the layer now comes with its sibling, the left one first */
+                        std::vector<std::pair<std::size_t, const std::vector<bool> *>> children;
+                        for (const auto &node : nodes) {
+                            children.emplace_back(node.first, &node.second);
+                        }
+                        std::vector<std::vector<bool>> parents(children.size() / 2);
+                        multi_buffer_hash_each<Hash>(
+                            parents.size(),
+                            [&](const std::size_t i) {
+                                return two_to_one_CRH_input<Hash>(*children[2 * i].second,
+                                                                  *children[2 * i + 1].second);
+                            },
+                            [&](const std::size_t i, std::vector<bool> hash) { parents[i] = std::move(hash); });
+
+                        std::map<std::size_t, std::vector<bool>> parent_nodes;
+                        for (std::size_t i = 0; i < parents.size(); ++i) {
+                            parent_nodes.emplace_hint(parent_nodes.end(), children[2 * i].first / 2,
+                                                      std::move(parents[i]));
+                        }
+                        nodes = std::move(parent_nodes);
+                    }
+
+                    return nodes.size() == 1 && nodes.begin()->second == commitment;
+                }
+
+                /**
+                 * Checks the batch membership proof of the values of [values_first, values_last) against
+                 * commitment, the root of a tree with depth layers over the leaves. The root is computed
+                 * once from all the leaves and the multi-path, every node being hashed once.
+                 */
+                template<typename Hash, typename InputIterator>
+                bool verify_set_membership_batch_proof(const set_commitment &commitment, const std::size_t depth,
+                                                       InputIterator values_first, InputIterator values_last,
+                                                       const set_membership_batch_proof &proof) {
+                    const std::size_t digest_size = Hash::get_digest_len();
+                    const std::vector<std::vector<bool>> leaves =
+                        detail::set_membership_leaves<Hash>(values_first, values_last);
+                    if (leaves.empty() || leaves.size() != proof.addresses.size()) {
+                        return false;
+                    }
+
+                    std::map<std::size_t, std::vector<bool>> leaf_nodes;
+                    for (std::size_t i = 0; i < leaves.size(); ++i) {
+                        if (!detail::is_set_membership_address(depth, proof.addresses[i]) ||
+                            !detail::merge_set_membership_node(leaf_nodes, proof.addresses[i], leaves[i])) {
+                            return false;
+                        }
+                    }
+
+                    /* the multi-path holds exactly the nodes the leaves do not determine */
+                    std::vector<std::size_t> positions;
+                    for (const auto &leaf : leaf_nodes) {
+                        positions.emplace_back(leaf.first);
+                    }
+                    std::size_t multi_path_size = 0;
+                    merkle_multi_path_positions(depth, std::move(positions),
+                                                [&](std::size_t, std::size_t) { ++multi_path_size; });
+                    if (proof.merkle_multi_path.size() != multi_path_size) {
+                        return false;
+                    }
+                    for (const merkle_authentication_node &node : proof.merkle_multi_path) {
+                        if (node.size() != digest_size) {
+                            return false;
+                        }
+                    }
+
+                    return merkle_multi_path_root<Hash>(depth, digest_size, leaf_nodes, proof.merkle_multi_path) ==
+                           commitment;
+                }
+
+                /**
+                 * A set commitment that only keeps the frontier of its Merkle tree, see
+                 * merkle_frontier. Its root costs depth hashes per added value.
+                 */
+                template<typename Hash>
+                using set_commitment_frontier_accumulator = set_commitment_accumulator<Hash, merkle_frontier<Hash>>;
+
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
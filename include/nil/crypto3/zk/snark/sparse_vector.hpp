@@ -28,13 +28,19 @@
 #ifndef CRYPTO3_ZK_SPARSE_VECTOR_HPP
 #define CRYPTO3_ZK_SPARSE_VECTOR_HPP
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <vector>
 #include <numeric>
 
 #include <nil/crypto3/algebra/multiexp/multiexp.hpp>
 #include <nil/crypto3/algebra/multiexp/policies.hpp>
 
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/prefetch.hpp>
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -181,77 +187,116 @@ namespace nil {
                     template<typename InputBaseIterator>
                     std::pair<underlying_value_type, sparse_vector<Type>>
                         accumulate(InputBaseIterator it_begin, InputBaseIterator it_end, std::size_t offset) const {
-#ifdef MULTICORE
-                        const std::size_t chunks = omp_get_max_threads();    // to override, set OMP_NUM_THREADS env var
-                                                                             // or call omp_set_num_threads()
-#else
-                        const std::size_t chunks = 1;
-#endif
-
-                        underlying_value_type accumulated_value = underlying_value_type::zero();
-                        sparse_vector<Type> resulting_vector;
-                        resulting_vector.domain_size_ = domain_size_;
+                        typedef typename std::iterator_traits<InputBaseIterator>::value_type scalar_value_type;
 
+                        const std::size_t chunks = executor::current().concurrency();
                         const std::size_t range_len = std::distance(it_begin, it_end);
-                        bool in_block = false;
-                        std::size_t first_pos = -1,
-                                    last_pos = -1;    // g++ -flto emits unitialized warning, even though in_block
-                        // guards for such cases.
-
-                        for (std::size_t i = 0; i < indices.size(); ++i) {
-                            const bool matching_pos = (offset <= indices[i] && indices[i] < offset + range_len);
-                            // printf("i = %zu, pos[i] = %zu, offset = %zu, w_size = %zu\n", i, indices[i], offset,
-                            // w_size);
-                            bool copy_over;
-
-                            if (in_block) {
-                                if (matching_pos && last_pos == i - 1) {
-                                    // block can be extended, do it
-                                    last_pos = i;
-                                    copy_over = false;
-                                } else {
-                                    // block has ended here
-                                    in_block = false;
-                                    copy_over = true;
-
-                                    accumulated_value =
-                                        accumulated_value +
-                                        algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                            values.begin() + first_pos, values.begin() + last_pos + 1,
-                                            it_begin + (indices[first_pos] - offset),
-                                            it_begin + (indices[last_pos] - offset) + 1, chunks);
-                                }
-                            } else {
-                                if (matching_pos) {
-                                    // block can be started
-                                    first_pos = i;
-                                    last_pos = i;
-                                    in_block = true;
-                                    copy_over = false;
-                                } else {
-                                    copy_over = true;
-                                }
-                            }
 
-                            if (copy_over) {
-                                resulting_vector.indices.emplace_back(indices[i]);
-                                resulting_vector.values.emplace_back(values[i]);
-                            }
-                        }
+                        // indices are sorted, so the entries falling into [offset, offset + range_len) are a single
+                        // contiguous run of the vector: gather their scalars and accumulate them in one multiexp
+                        const std::size_t first_pos =
+                            std::lower_bound(indices.begin(), indices.end(), offset) - indices.begin();
+                        const std::size_t last_pos =
+                            std::lower_bound(indices.begin() + first_pos, indices.end(), offset + range_len) -
+                            indices.begin();
 
-                        if (in_block) {
-                            accumulated_value =
-                                accumulated_value + algebra::multiexp<algebra::policies::multiexp_method_bos_coster>(
-                                                        values.begin() + first_pos,
-                                                        values.begin() + last_pos + 1,
-                                                        it_begin + (indices[first_pos] - offset),
-                                                        it_begin + (indices[last_pos] - offset) + 1,
-                                                        chunks);
+                        underlying_value_type accumulated_value = underlying_value_type::zero();
+                        if (first_pos != last_pos) {
+                            std::vector<scalar_value_type> scalars(last_pos - first_pos);
+                            prefetched_gather(indices.begin() + first_pos, indices.begin() + last_pos, it_begin,
+                                              offset, [&](const std::size_t k, const scalar_value_type &scalar) {
+                                                  scalars[k] = scalar;
+                                              });
+                            accumulated_value = dispatch_multiexp<multiexp_method_auto>(
+                                values.begin() + first_pos, values.begin() + last_pos, scalars.begin(), scalars.end(),
+                                chunks);
                         }
 
+                        sparse_vector<Type> resulting_vector;
+                        resulting_vector.domain_size_ = domain_size_;
+                        resulting_vector.indices.reserve(indices.size() - (last_pos - first_pos));
+                        resulting_vector.values.reserve(indices.size() - (last_pos - first_pos));
+                        resulting_vector.indices.insert(resulting_vector.indices.end(), indices.begin(),
+                                                        indices.begin() + first_pos);
+                        resulting_vector.indices.insert(resulting_vector.indices.end(), indices.begin() + last_pos,
+                                                        indices.end());
+                        resulting_vector.values.insert(resulting_vector.values.end(), values.begin(),
+                                                       values.begin() + first_pos);
+                        resulting_vector.values.insert(resulting_vector.values.end(), values.begin() + last_pos,
+                                                       values.end());
+
                         return std::make_pair(accumulated_value, resulting_vector);
                     }
                 };
+
+                /**
+                 * Multi-exponentiation over the terms of vec with indices in [min_idx, max_idx), the scalar
+                 * of index i being *(scalar_start + (i - min_idx)).
+                 *
+                 * Only the stored bases are visited, so the zero entries left out of vec cost nothing; of
+                 * the stored ones, terms with a zero scalar are skipped and terms with a unit scalar are
+                 * added with mixed addition, see algebra::multiexp_with_mixed_addition.
+                 */
+                template<typename MultiexpMethod, typename Type, typename InputFieldIterator>
+                typename Type::value_type sparse_multiexp_with_mixed_addition(const sparse_vector<Type> &vec,
+                                                                              const std::size_t min_idx,
+                                                                              const std::size_t max_idx,
+                                                                              InputFieldIterator scalar_start,
+                                                                              const std::size_t chunks) {
+                    typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
+
+                    const std::size_t first =
+                        std::lower_bound(vec.indices.begin(), vec.indices.end(), min_idx) - vec.indices.begin();
+                    const std::size_t last =
+                        std::lower_bound(vec.indices.begin() + first, vec.indices.end(), max_idx) -
+                        vec.indices.begin();
+                    if (first == last) {
+                        return Type::value_type::zero();
+                    }
+
+                    thread_local std::vector<field_value_type> scalars;
+                    scalars.clear();
+                    prefetched_gather(vec.indices.begin() + first, vec.indices.begin() + last, scalar_start, min_idx,
+                                      [&](std::size_t, const field_value_type &scalar) {
+                                          scalars.emplace_back(scalar);
+                                      });
+
+                    return dispatch_multiexp_with_mixed_addition<MultiexpMethod>(
+                        vec.values.begin() + first, vec.values.begin() + last, scalars.begin(), scalars.end(), chunks);
+                }
+
+                /**
+                 * Multi-exponentiation over the terms of vec with indices in [min_idx, max_idx), as
+                 * sparse_multiexp_with_mixed_addition but without mixed addition, so that the stored
+                 * bases need not be normalized.
+                 */
+                template<typename MultiexpMethod, typename Type, typename InputFieldIterator>
+                typename Type::value_type sparse_multiexp(const sparse_vector<Type> &vec,
+                                                          const std::size_t min_idx,
+                                                          const std::size_t max_idx,
+                                                          InputFieldIterator scalar_start,
+                                                          const std::size_t chunks) {
+                    typedef typename std::iterator_traits<InputFieldIterator>::value_type field_value_type;
+
+                    const std::size_t first =
+                        std::lower_bound(vec.indices.begin(), vec.indices.end(), min_idx) - vec.indices.begin();
+                    const std::size_t last =
+                        std::lower_bound(vec.indices.begin() + first, vec.indices.end(), max_idx) -
+                        vec.indices.begin();
+                    if (first == last) {
+                        return Type::value_type::zero();
+                    }
+
+                    thread_local std::vector<field_value_type> scalars;
+                    scalars.clear();
+                    prefetched_gather(vec.indices.begin() + first, vec.indices.begin() + last, scalar_start, min_idx,
+                                      [&](std::size_t, const field_value_type &scalar) {
+                                          scalars.emplace_back(scalar);
+                                      });
+
+                    return dispatch_multiexp<MultiexpMethod>(vec.values.begin() + first, vec.values.begin() + last,
+                                                             scalars.begin(), scalars.end(), chunks);
+                }
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
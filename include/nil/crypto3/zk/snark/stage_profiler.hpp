@@ -0,0 +1,346 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the stage profiler timing the stages of generators, provers and reductions.
+//
+// The code of a stage is bracketed by a stage_profiler::timer, which does nothing
+// unless a sink is installed as the current one of the calling thread. The stage
+// profiler is the sink aggregating the stages by path:
+//
+//     stage_profiler profiler;
+//     {
+//         stage_profiler::scope guard(profiler);
+//         proof = prove<scheme_type>(pk, primary_input, auxiliary_input);
+//     }
+//     profiler.write_json(std::cout);
+//
+// Any other stage_sink, e.g. one forwarding the begin and end events as spans to
+// a tracing system, is installed the same way.
+//
+// Timers nest, and a stage is recorded under the path of the stages enclosing it
+// on the calling thread, e.g. "translation_step.prover/multiexp_H", so the same
+// inner stage of different callers is accounted for separately. Like the current
+// executor, the current sink is a property of the thread; the tasks run by the
+// current executor inherit the sink and the path of the thread starting them, so
+// the stages of concurrent tasks are recorded under the stage running the tasks.
+//
+// Defining CRYPTO3_ZK_DISABLE_STAGE_PROFILER compiles the timers out entirely.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_STAGE_PROFILER_HPP
+#define CRYPTO3_ZK_STAGE_PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /**
+                 * Receives the begin and end events of the stages timed on the threads it is installed on,
+                 * possibly concurrently from the threads running the tasks of a stage. size is the size of
+                 * the input of the stage given to its timer, e.g. the number of terms of a multi-exponentiation,
+                 * 0 if none is given.
+                 */
+                class stage_sink {
+                public:
+                    virtual ~stage_sink() = default;
+
+                    virtual void begin(const std::string &, std::size_t) {
+                    }
+
+                    virtual void end(const std::string &path, std::size_t size, double seconds) = 0;
+
+                    /**
+                     * completed of the total units of work of the stage at path are done, as reported by the
+                     * stages splitting their work into tasks, e.g. the multi-exponentiation task lists.
+                     */
+                    virtual void progress(const std::string &, std::size_t, std::size_t) {
+                    }
+
+                    /* Whether the work of the stages should be abandoned; the pending tasks are then skipped. */
+                    virtual bool cancelled() const {
+                        return false;
+                    }
+
+                    /**
+                     * Called where the work can be abandoned, after the tasks of a task list have run. An
+                     * implementation may throw from it to abandon the work, unless executor::in_task().
+                     */
+                    virtual void checkpoint() {
+                    }
+                };
+
+                class stage_profiler : public stage_sink {
+                    /* the sink current on a thread and the path of its innermost running stage */
+                    struct thread_state {
+                        stage_sink *sink;
+                        std::string path;
+                    };
+
+                public:
+                    typedef std::chrono::steady_clock clock_type;
+
+                    struct stage_type {
+                        std::size_t calls;
+                        double seconds;
+                        std::size_t size;
+                    };
+
+                    typedef std::map<std::string, stage_type> stages_type;
+
+                    stage_profiler() = default;
+                    stage_profiler(const stage_profiler &) = delete;
+                    stage_profiler &operator=(const stage_profiler &) = delete;
+
+                    /**
+                     * Adds one call of seconds over an input of the given size to the stage at path. Safe to
+                     * call from the threads the profiler is installed on concurrently.
+                     */
+                    void record(const std::string &path, const double seconds, const std::size_t size = 0) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stage_type &stage = stages_.insert({path, stage_type {0, 0, 0}}).first->second;
+                        ++stage.calls;
+                        stage.seconds += seconds;
+                        stage.size += size;
+                    }
+
+                    void end(const std::string &path, const std::size_t size, const double seconds) override {
+                        record(path, seconds, size);
+                    }
+
+                    stages_type stages() const {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        return stages_;
+                    }
+
+                    void clear() {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stages_.clear();
+                    }
+
+                    /**
+                     * Writes the stages as a JSON object mapping every path to its number of calls, total
+                     * time in seconds and total input size.
+                     */
+                    void write_json(std::ostream &os) const {
+                        write_json(os, stages());
+                    }
+
+                    /**
+                     * Writes a snapshot of stages in the format of the member write_json.
+                     */
+                    static void write_json(std::ostream &os, const stages_type &snapshot) {
+                        os << "{";
+                        for (auto it = snapshot.begin(); it != snapshot.end(); ++it) {
+                            os << (it == snapshot.begin() ? "" : ",") << "\"";
+                            for (const char c : it->first) {
+                                if (c == '"' || c == '\\') {
+                                    os << '\\';
+                                }
+                                os << c;
+                            }
+                            os << "\":{\"calls\":" << it->second.calls << ",\"seconds\":" << it->second.seconds
+                               << ",\"size\":" << it->second.size << "}";
+                        }
+                        os << "}";
+                    }
+
+                    /**
+                     * Installs a sink as the current one of the calling thread for the lifetime of the
+                     * scope, the stages of the thread starting from the root path.
+                     */
+                    class scope {
+                    public:
+                        explicit scope(stage_sink &sink) : previous(state()) {
+                            state() = thread_state {&sink, std::string()};
+                        }
+
+                        scope(const scope &) = delete;
+                        scope &operator=(const scope &) = delete;
+
+                        ~scope() {
+                            state() = std::move(previous);
+                        }
+
+                    private:
+                        thread_state previous;
+                    };
+
+                    /**
+                     * The sink and the stage path of a thread, captured to be installed on the threads running
+                     * the tasks it starts.
+                     */
+                    class context {
+                    public:
+                        /**
+                         * Captures the context of the calling thread.
+                         */
+                        context() : captured {state().sink, state().sink ? state().path : std::string()} {
+                        }
+
+                        /**
+                         * Installs a captured context on the calling thread for the lifetime of the scope.
+                         */
+                        class scope {
+                        public:
+                            explicit scope(const context &c) :
+                                installed(c.captured.sink || state().sink),
+                                previous(installed ? state() : thread_state {nullptr, std::string()}) {
+                                if (installed) {
+                                    state() = c.captured;
+                                }
+                            }
+
+                            scope(const scope &) = delete;
+                            scope &operator=(const scope &) = delete;
+
+                            ~scope() {
+                                if (installed) {
+                                    state() = std::move(previous);
+                                }
+                            }
+
+                        private:
+                            bool installed;
+                            thread_state previous;
+                        };
+
+                    private:
+                        thread_state captured;
+                    };
+
+#ifdef CRYPTO3_ZK_DISABLE_STAGE_PROFILER
+                    class timer {
+                    public:
+                        explicit timer(const char *, std::size_t = 0) {
+                        }
+
+                        timer(const timer &) = delete;
+                        timer &operator=(const timer &) = delete;
+
+                        void stop() {
+                        }
+                    };
+#else
+                    /**
+                     * Times the stage name, over an input of the given size, from its construction to stop()
+                     * or its destruction, if a sink is current on the calling thread.
+                     */
+                    class timer {
+                    public:
+                        explicit timer(const char *name, const std::size_t size = 0) : sink(state().sink), size(size) {
+                            if (!sink) {
+                                return;
+                            }
+                            std::string &path = state().path;
+                            parent_length = path.size();
+                            if (!path.empty()) {
+                                path += '/';
+                            }
+                            path += name;
+                            sink->begin(path, size);
+                            start = clock_type::now();
+                        }
+
+                        timer(const timer &) = delete;
+                        timer &operator=(const timer &) = delete;
+
+                        ~timer() {
+                            stop();
+                        }
+
+                        void stop() {
+                            if (!sink) {
+                                return;
+                            }
+                            const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+                            std::string &path = state().path;
+                            sink->end(path, size, seconds);
+                            path.resize(parent_length);
+                            sink = nullptr;
+                        }
+
+                    private:
+                        stage_sink *sink;
+                        std::size_t size;
+                        std::size_t parent_length;
+                        clock_type::time_point start;
+                    };
+#endif
+
+                    /**
+                     * Runs f() as the stage name over an input of the given size.
+                     */
+                    template<typename Function>
+                    static void run_stage(const char *name, const std::size_t size, Function f) {
+                        timer stage_timer(name, size);
+                        f();
+                    }
+
+                    static stage_sink *current() {
+                        return state().sink;
+                    }
+
+                    /* Reports the progress of the innermost stage of the calling thread to its sink, if any. */
+                    static void report_progress(const std::size_t completed, const std::size_t total) {
+                        if (stage_sink *const sink = state().sink) {
+                            sink->progress(state().path, completed, total);
+                        }
+                    }
+
+                    /* Calls the checkpoint of the sink of the calling thread, if any. */
+                    static void current_checkpoint() {
+                        if (stage_sink *const sink = state().sink) {
+                            sink->checkpoint();
+                        }
+                    }
+
+                    /* Whether the sink of the calling thread asks to abandon the work. */
+                    static bool current_cancelled() {
+                        const stage_sink *const sink = state().sink;
+                        return sink && sink->cancelled();
+                    }
+
+                private:
+                    static thread_state &state() {
+                        thread_local thread_state current {nullptr, std::string()};
+                        return current;
+                    }
+
+                    mutable std::mutex mutex;
+                    stages_type stages_;
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_STAGE_PROFILER_HPP
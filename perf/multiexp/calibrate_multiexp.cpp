@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Calibrates the multi-exponentiation dispatcher on this machine.
+//
+// Measures the thresholds of multiexp_method_auto (see multiexp_dispatch.hpp) for the G1 and
+// G2 groups of MNT4-298 and prints them as one JSON object per group:
+//
+//     {"group":"g1","threads":8,"naive_max_terms":4,"bos_coster_max_terms":512,"min_terms_per_chunk":256,
+//      "batch_affine_min_terms":8192}
+//
+// A batch_affine_min_terms of 0 means the batched affine additions never beat BDLO12 up to
+// the largest number of terms timed.
+//
+// The values are meant to be installed in multiexp_tuning<...>::current() by the application
+// before proving. The first argument is the largest number of terms timed, 2^14 by default.
+//---------------------------------------------------------------------------//
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/mnt4.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/scalar_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+
+using namespace nil::crypto3::zk::snark;
+using namespace nil::crypto3::algebra;
+
+typedef curves::mnt4<298> curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
+
+template<typename GroupType>
+void calibrate(const char *name, const std::size_t max_terms) {
+    typedef typename GroupType::value_type value_type;
+
+    std::vector<value_type> bases;
+    std::vector<typename scalar_field_type::value_type> scalars;
+    bases.reserve(max_terms);
+    scalars.reserve(max_terms);
+    for (std::size_t i = 0; i < max_terms; ++i) {
+        bases.emplace_back(random_element<GroupType>());
+        scalars.emplace_back(random_element<scalar_field_type>());
+    }
+
+    const multiexp_tuning<value_type> tuning =
+        multiexp_tuning<value_type>::calibrate(bases.begin(), scalars.begin(), max_terms);
+    std::cout << "{\"group\":\"" << name << "\",\"threads\":" << executor::current().concurrency()
+              << ",\"naive_max_terms\":" << tuning.naive_max_terms
+              << ",\"bos_coster_max_terms\":" << tuning.bos_coster_max_terms
+              << ",\"min_terms_per_chunk\":" << tuning.min_terms_per_chunk << ",\"batch_affine_min_terms\":"
+              << (tuning.batch_affine_min_terms <= max_terms ? tuning.batch_affine_min_terms : 0) << "}"
+              << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+    const std::size_t max_terms = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 14;
+    if (max_terms < 2) {
+        std::cerr << "usage: " << argv[0] << " [max_terms >= 2]" << std::endl;
+        return 1;
+    }
+
+    calibrate<typename curve_type::g1_type>("g1", max_terms);
+    calibrate<typename curve_type::g2_type>("g2", max_terms);
+    return 0;
+}
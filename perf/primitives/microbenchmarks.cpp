@@ -0,0 +1,373 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Microbenchmarks of the building blocks the proof systems are made of.
+//
+// Each primitive is timed on its own, over BLS12-381, for every size of the sweep
+// and every thread count, the inputs being built beforehand and not timed. The
+// primitives and what a size stands for are:
+//
+//     kc_multiexp_with_mixed_addition   terms of a knowledge commitment vector
+//     kc_batch_exp                      scalars exponentiated by two fixed-base engines
+//     sparse_vector_accumulate          terms of a sparse vector of G1 elements
+//     accumulation_vector_accumulate_chunk  terms of an accumulation vector of G1 elements
+//     r1cs_to_qap_witness_map           constraints of an R1CS instance
+//     r1cs_to_qap_instance_map_with_evaluation  constraints of an R1CS instance
+//     merkle_tree_build                 leaves of a flat_merkle_tree built at once
+//     merkle_tree_update                leaves written one by one into a flat_merkle_tree
+//     merkle_tree_path                  authentication paths queried from a flat_merkle_tree
+//     set_commitment_add                values added one by one to a set_commitment_accumulator
+//     transcript_write                  G1 elements written to an IPP2 transcript
+//     transcript_read_challenge         challenges read from an IPP2 transcript
+//     ipp2_commitment_key_compress      elements of each half of a G1 commitment key
+//     ipp2_commitment_pair              G1 and G2 elements committed to
+//     integer_permutation_random_shuffle  elements of an integer_permutation
+//     integer_permutation_inverse       elements of an integer_permutation
+//     integer_permutation_is_valid      elements of an integer_permutation
+//
+// One JSON object is printed per primitive, size and thread count, its keys always
+// in this order, with the latencies in seconds as in benchmark.hpp and the
+// throughput in runs per second:
+//
+//     {"primitive":"kc_batch_exp","size":1024,"threads":4,"repetitions":5,
+//      "latency":{"min":...,"mean":...,"p50":...,"p90":...,"p99":...,"max":...,"throughput":...},
+//      "peak_memory_kb":...}
+//
+// The sweep is read from the command line:
+//
+//     --sizes 256,1024,4096  sizes, 2^8 to 2^14 by powers of four by default
+//     --threads 1,2,4        thread counts, 1 and the default concurrency by default
+//     --repetitions 5        runs of every primitive per size and thread count
+//     --primitives a,b       names of the primitives to run, all of them by default
+//---------------------------------------------------------------------------//
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/fields/bls12/base_field.hpp>
+#include <nil/crypto3/algebra/fields/bls12/scalar_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/accumulation_vector.hpp>
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
+#include <nil/crypto3/zk/snark/components/hashes/crh_component.hpp>
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
+#include <nil/crypto3/zk/snark/integer_permutation.hpp>
+#include <nil/crypto3/zk/snark/merkle_tree.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/set_commitment.hpp>
+#include <nil/crypto3/zk/snark/sparse_vector.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/commitment.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/transcript.hpp>
+
+#include "../proof_systems/benchmark.hpp"
+#include "../proof_systems/examples.hpp"
+
+using namespace nil::crypto3;
+using namespace nil::crypto3::zk::snark;
+
+typedef algebra::curves::bls12_381 curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
+typedef typename scalar_field_type::value_type scalar_value_type;
+typedef typename curve_type::g1_type g1_type;
+typedef typename curve_type::g2_type g2_type;
+typedef typename g1_type::value_type g1_value_type;
+typedef typename g2_type::value_type g2_value_type;
+
+typedef crh_with_bit_out_component<scalar_field_type> hash_type;
+
+struct microbenchmark_options {
+    std::vector<std::size_t> sizes;
+    std::vector<std::size_t> threads;
+    std::size_t repetitions;
+    std::vector<std::string> primitives;
+};
+
+/**
+ * Reads the command line described above, returns false, after printing the usage, if it is malformed.
+ */
+bool parse_microbenchmark_options(int argc, const char *argv[], microbenchmark_options &options) {
+    options.sizes = {1 << 8, 1 << 10, 1 << 12, 1 << 14};
+    options.threads.clear();
+    options.repetitions = 5;
+    options.primitives.clear();
+
+    perf::command_line_parser parser;
+    parser.sizes("--sizes", options.sizes);
+    parser.sizes("--threads", options.threads);
+    parser.size("--repetitions", options.repetitions);
+    parser.names("--primitives", options.primitives);
+    if (!parser.parse(argc, argv)) {
+        return false;
+    }
+
+    if (options.threads.empty()) {
+        options.threads = perf::single_and_max_threads(executor::default_concurrency());
+    }
+    return true;
+}
+
+class microbenchmark_runner {
+public:
+    microbenchmark_runner(std::ostream &os, const microbenchmark_options &options) : os(os), options(options) {
+    }
+
+    bool selected(const char *primitive) const {
+        return perf::name_selected(options.primitives, primitive);
+    }
+
+    /**
+     * Times f, which must return a value, the given number of times with every thread count and
+     * prints one line per thread count.
+     */
+    template<typename Function>
+    void run(const char *primitive, const std::size_t size, Function f) const {
+        if (!selected(primitive)) {
+            return;
+        }
+        perf::run_thread_sweep(
+            options.threads, options.repetitions, [&](std::size_t) { return f(); },
+            [&](const std::size_t threads, const perf::latency_samples &latency, double) {
+                os << "{\"primitive\":\"" << primitive << "\",\"size\":" << size << ",\"threads\":" << threads
+                   << ",\"repetitions\":" << options.repetitions << ",\"latency\":";
+                latency.write_json(os);
+                os << ",\"peak_memory_kb\":" << perf::peak_memory_kb() << "}" << std::endl;
+            });
+    }
+
+private:
+    std::ostream &os;
+    const microbenchmark_options &options;
+};
+
+template<typename FieldType>
+std::vector<typename FieldType::value_type> random_field_elements(const std::size_t n) {
+    std::vector<typename FieldType::value_type> result(n);
+    executor::current().parallel_for(n, [&](const std::size_t i) { result[i] = algebra::random_element<FieldType>(); });
+    return result;
+}
+
+template<typename GroupType>
+std::vector<typename GroupType::value_type> random_group_elements(const std::size_t n) {
+    std::vector<typename GroupType::value_type> result(n);
+    executor::current().parallel_for(n, [&](const std::size_t i) { result[i] = algebra::random_element<GroupType>(); });
+    return result;
+}
+
+std::vector<bool> random_bits(std::mt19937_64 &engine, const std::size_t n) {
+    std::vector<bool> result(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        result[i] = engine() & 1;
+    }
+    return result;
+}
+
+std::size_t ceil_log2(const std::size_t n) {
+    return static_cast<std::size_t>(std::ceil(std::log2(n)));
+}
+
+void run_multiexps(const microbenchmark_runner &runner, const std::size_t n) {
+    if (!runner.selected("kc_multiexp_with_mixed_addition") && !runner.selected("kc_batch_exp") &&
+        !runner.selected("sparse_vector_accumulate") && !runner.selected("accumulation_vector_accumulate_chunk")) {
+        return;
+    }
+
+    const std::vector<scalar_value_type> scalars = random_field_elements<scalar_field_type>(n);
+    const std::shared_ptr<const fixed_base_engine<g1_type, scalar_field_type>> g1_engine =
+        fixed_base_engine<g1_type, scalar_field_type>::shared(g1_value_type::one(), 2 * n);
+    const scalar_value_type c1 = algebra::random_element<scalar_field_type>(),
+                            c2 = algebra::random_element<scalar_field_type>();
+
+    runner.run("kc_batch_exp", n, [&]() { return kc_batch_exp(*g1_engine, *g1_engine, c1, c2, scalars); });
+
+    const knowledge_commitment_vector<g1_type, g1_type> query = kc_batch_exp(*g1_engine, *g1_engine, c1, c2, scalars);
+    runner.run("kc_multiexp_with_mixed_addition", n, [&]() {
+        return kc_multiexp_with_mixed_addition<multiexp_method_auto>(query, 0, n, scalars.begin(), scalars.end(), 1);
+    });
+
+    std::vector<g1_value_type> bases = random_group_elements<g1_type>(n);
+    const sparse_vector<g1_type> sparse(std::vector<g1_value_type>(bases));
+    runner.run("sparse_vector_accumulate", n,
+               [&]() { return sparse.accumulate(scalars.begin(), scalars.end(), 0).first; });
+
+    const accumulation_vector<g1_type> accumulation(std::move(bases));
+    runner.run("accumulation_vector_accumulate_chunk", n,
+               [&]() { return accumulation.accumulate_chunk(scalars.begin(), scalars.end(), 0).first; });
+}
+
+void run_r1cs_to_qap(const microbenchmark_runner &runner, const std::size_t n) {
+    if (!runner.selected("r1cs_to_qap_witness_map") && !runner.selected("r1cs_to_qap_instance_map_with_evaluation")) {
+        return;
+    }
+
+    typedef reductions::r1cs_to_qap<scalar_field_type> reduction_type;
+
+    const perf::r1cs_example<scalar_field_type> example = perf::generate_r1cs_example<scalar_field_type>(n, 10);
+    const scalar_value_type d1 = algebra::random_element<scalar_field_type>(),
+                            d2 = algebra::random_element<scalar_field_type>(),
+                            d3 = algebra::random_element<scalar_field_type>(),
+                            t = algebra::random_element<scalar_field_type>();
+
+    runner.run("r1cs_to_qap_witness_map", n, [&]() {
+        return reduction_type::witness_map(example.constraint_system, example.primary_input, example.auxiliary_input,
+                                           d1, d2, d3);
+    });
+    runner.run("r1cs_to_qap_instance_map_with_evaluation", n,
+               [&]() { return reduction_type::instance_map_with_evaluation(example.constraint_system, t); });
+}
+
+void run_merkle_tree(const microbenchmark_runner &runner, const std::size_t n) {
+    if (!runner.selected("merkle_tree_build") && !runner.selected("merkle_tree_update") &&
+        !runner.selected("merkle_tree_path") && !runner.selected("set_commitment_add")) {
+        return;
+    }
+
+    const std::size_t digest_size = hash_type::get_digest_len();
+    const std::size_t value_size = 2 * digest_size;
+    hash_type::sample_randomness(value_size);
+
+    const std::size_t depth = ceil_log2(n);
+    std::mt19937_64 engine(n);
+    std::vector<std::vector<bool>> leaves(n);
+    std::vector<std::vector<bool>> values(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        leaves[i] = random_bits(engine, digest_size);
+        values[i] = random_bits(engine, value_size);
+    }
+
+    runner.run("merkle_tree_build", n,
+               [&]() { return flat_merkle_tree<hash_type>(depth, digest_size, leaves).get_packed_root(); });
+
+    runner.run("merkle_tree_update", n, [&]() {
+        flat_merkle_tree<hash_type> tree(depth, digest_size);
+        for (std::size_t i = 0; i < n; ++i) {
+            tree.set_value(i, leaves[i]);
+        }
+        return tree.get_packed_root();
+    });
+
+    const flat_merkle_tree<hash_type> tree(depth, digest_size, leaves);
+    runner.run("merkle_tree_path", n, [&]() {
+        std::size_t path_size = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            path_size += tree.get_packed_path(i).size();
+        }
+        return path_size;
+    });
+
+    runner.run("set_commitment_add", n, [&]() {
+        set_commitment_accumulator<hash_type> accumulator(n, value_size);
+        for (const std::vector<bool> &value : values) {
+            accumulator.add(value);
+        }
+        return accumulator.get_commitment();
+    });
+}
+
+void run_ipp2(const microbenchmark_runner &runner, const std::size_t n) {
+    if (!runner.selected("transcript_write") && !runner.selected("transcript_read_challenge") &&
+        !runner.selected("ipp2_commitment_key_compress") && !runner.selected("ipp2_commitment_pair")) {
+        return;
+    }
+
+    typedef r1cs_gg_ppzksnark_ipp2_commitment<curve_type> commitment_type;
+
+    const std::vector<std::uint8_t> domain_separator = {'m', 'i', 'c', 'r', 'o'};
+    const std::vector<g1_value_type> a = random_group_elements<g1_type>(n);
+    const std::vector<g2_value_type> b = random_group_elements<g2_type>(n);
+
+    runner.run("transcript_write", n, [&]() {
+        transcript<curve_type> tr(domain_separator.begin(), domain_separator.end());
+        tr.write<g1_type>(a.begin(), a.end());
+        return tr.read_challenge();
+    });
+
+    runner.run("transcript_read_challenge", n, [&]() {
+        transcript<curve_type> tr(domain_separator.begin(), domain_separator.end());
+        scalar_value_type challenge = scalar_value_type::zero();
+        for (std::size_t i = 0; i < n; ++i) {
+            challenge = tr.read_challenge();
+            tr.write<scalar_field_type>(challenge);
+        }
+        return challenge;
+    });
+
+    typename commitment_type::wkey_type wkey;
+    wkey.a = random_group_elements<g1_type>(n);
+    wkey.b = random_group_elements<g1_type>(n);
+    typename commitment_type::vkey_type vkey;
+    vkey.a = random_group_elements<g2_type>(n);
+    vkey.b = random_group_elements<g2_type>(n);
+
+    const typename commitment_type::wkey_type right = wkey;
+    const scalar_value_type scale = algebra::random_element<scalar_field_type>();
+    runner.run("ipp2_commitment_key_compress", n, [&]() { return wkey.compress(right, scale).a.size(); });
+
+    runner.run("ipp2_commitment_pair", n, [&]() {
+        return commitment_type::pair(typename commitment_type::vkey_span_type(vkey),
+                                     typename commitment_type::wkey_span_type(wkey), a.begin(), a.end(), b.begin(),
+                                     b.end());
+    });
+}
+
+void run_integer_permutation(const microbenchmark_runner &runner, const std::size_t n) {
+    integer_permutation permutation(n);
+    permutation.random_shuffle();
+
+    runner.run("integer_permutation_random_shuffle", n, [&]() {
+        permutation.random_shuffle();
+        return permutation.get(0);
+    });
+    runner.run("integer_permutation_inverse", n, [&]() { return permutation.inverse().get(0); });
+    runner.run("integer_permutation_is_valid", n, [&]() { return permutation.is_valid(); });
+}
+
+int main(int argc, const char *argv[]) {
+    microbenchmark_options options;
+    if (!parse_microbenchmark_options(argc, argv, options)) {
+        return 1;
+    }
+
+    const microbenchmark_runner runner(std::cout, options);
+    for (const std::size_t size : options.sizes) {
+        run_multiexps(runner, size);
+        run_r1cs_to_qap(runner, size);
+        run_merkle_tree(runner, size);
+        run_ipp2(runner, size);
+        run_integer_permutation(runner, size);
+    }
+    return 0;
+}
@@ -0,0 +1,311 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the allocation profiler of the benchmarks.
+//
+// Including this header replaces the global operator new and operator delete of
+// the program by versions counting the heap blocks and bytes the process holds,
+// so it must be included by a single translation unit, which every benchmark is.
+// The library's containers allocate through std::allocator, so everything they
+// hold is accounted for.
+//
+// The allocation profiler is the stage_sink attributing the allocations to the
+// stages of the library (see stage_profiler.hpp) by path: the number of blocks
+// and bytes allocated while the stage ran, and its peak, the largest number of
+// bytes held by the process during the stage above what it held when the stage
+// started, i.e. the transient memory of the stage. The heap is shared by the
+// threads, so a stage also accounts for what concurrent stages allocate.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_PERF_ALLOCATION_PROFILER_HPP
+#define CRYPTO3_PERF_ALLOCATION_PROFILER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+
+#include <malloc.h>
+
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace perf {
+                    namespace detail {
+
+                        /* stages tracked concurrently for their peak, one bit of active_peaks each */
+                        constexpr std::size_t max_tracked_stages = 64;
+
+                        inline std::atomic<std::size_t> held_bytes {0};
+                        inline std::atomic<std::size_t> peak_held_bytes {0};
+                        inline std::atomic<std::size_t> allocated_blocks {0};
+                        inline std::atomic<std::size_t> allocated_bytes {0};
+                        inline std::atomic<std::uint64_t> active_peaks {0};
+                        inline std::atomic<std::size_t> stage_peaks[max_tracked_stages];
+
+                        inline void update_max(std::atomic<std::size_t> &peak, const std::size_t value) {
+                            std::size_t previous = peak.load(std::memory_order_relaxed);
+                            while (previous < value &&
+                                   !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+                            }
+                        }
+
+                        inline void *on_allocate(void *p) {
+                            if (!p) {
+                                throw std::bad_alloc();
+                            }
+                            const std::size_t n = malloc_usable_size(p);
+                            const std::size_t held = held_bytes.fetch_add(n, std::memory_order_relaxed) + n;
+                            allocated_blocks.fetch_add(1, std::memory_order_relaxed);
+                            allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+                            update_max(peak_held_bytes, held);
+                            for (std::uint64_t active = active_peaks.load(std::memory_order_relaxed); active;
+                                 active &= active - 1) {
+                                update_max(stage_peaks[__builtin_ctzll(active)], held);
+                            }
+                            return p;
+                        }
+
+                        inline void on_deallocate(void *p) {
+                            if (p) {
+                                held_bytes.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+                                std::free(p);
+                            }
+                        }
+                    }    // namespace detail
+
+                    class allocation_profiler : public stage_sink {
+                        /* a running stage of the calling thread */
+                        struct frame {
+                            std::size_t slot;
+                            std::size_t held_bytes;
+                            std::size_t allocated_blocks;
+                            std::size_t allocated_bytes;
+                        };
+
+                        /* stages nest on a thread, the frames are kept without allocating */
+                        static constexpr std::size_t max_depth = 32;
+
+                    public:
+                        struct stage_type {
+                            std::size_t calls;
+                            std::size_t allocations;
+                            std::size_t bytes;
+                            std::size_t peak_bytes;
+                        };
+
+                        typedef std::map<std::string, stage_type> stages_type;
+
+                        allocation_profiler() = default;
+                        allocation_profiler(const allocation_profiler &) = delete;
+                        allocation_profiler &operator=(const allocation_profiler &) = delete;
+
+                        void begin(const std::string &, std::size_t) override {
+                            thread_stack &stack = frames();
+                            if (stack.depth++ >= max_depth) {
+                                return;
+                            }
+
+                            /* claim a free peak slot, the stage peak is then only tracked at its end if none */
+                            std::size_t slot = detail::max_tracked_stages;
+                            std::uint64_t active = detail::active_peaks.load();
+                            while (~active) {
+                                const std::size_t candidate = __builtin_ctzll(~active);
+                                if (detail::active_peaks.compare_exchange_weak(
+                                        active, active | (std::uint64_t(1) << candidate))) {
+                                    slot = candidate;
+                                    break;
+                                }
+                            }
+                            const std::size_t held = detail::held_bytes.load();
+                            if (slot < detail::max_tracked_stages) {
+                                detail::stage_peaks[slot].store(held);
+                            }
+                            stack.frames[stack.depth - 1] =
+                                frame {slot, held, detail::allocated_blocks.load(), detail::allocated_bytes.load()};
+                        }
+
+                        void end(const std::string &path, std::size_t, double) override {
+                            thread_stack &stack = frames();
+                            if (stack.depth-- > max_depth) {
+                                return;
+                            }
+
+                            const frame &f = stack.frames[stack.depth];
+                            std::size_t peak = detail::held_bytes.load();
+                            if (f.slot < detail::max_tracked_stages) {
+                                peak = std::max(peak, detail::stage_peaks[f.slot].load());
+                                detail::active_peaks.fetch_and(~(std::uint64_t(1) << f.slot));
+                            }
+                            const stage_type call {1, detail::allocated_blocks.load() - f.allocated_blocks,
+                                                   detail::allocated_bytes.load() - f.allocated_bytes,
+                                                   peak > f.held_bytes ? peak - f.held_bytes : 0};
+
+                            std::lock_guard<std::mutex> lock(mutex);
+                            stage_type &stage = stages_.insert({path, stage_type {0, 0, 0, 0}}).first->second;
+                            stage.calls += call.calls;
+                            stage.allocations += call.allocations;
+                            stage.bytes += call.bytes;
+                            stage.peak_bytes = std::max(stage.peak_bytes, call.peak_bytes);
+                        }
+
+                        stages_type stages() const {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            return stages_;
+                        }
+
+                        void clear() {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            stages_.clear();
+                        }
+
+                        /**
+                         * Writes the stages as a JSON object mapping every path to its number of calls, the
+                         * blocks and bytes allocated over all the calls and the largest peak of a call.
+                         */
+                        void write_json(std::ostream &os) const {
+                            const stages_type snapshot = stages();
+
+                            os << "{";
+                            for (auto it = snapshot.begin(); it != snapshot.end(); ++it) {
+                                os << (it == snapshot.begin() ? "" : ",") << "\"" << it->first
+                                   << "\":{\"calls\":" << it->second.calls
+                                   << ",\"allocations\":" << it->second.allocations
+                                   << ",\"bytes\":" << it->second.bytes
+                                   << ",\"peak_bytes\":" << it->second.peak_bytes << "}";
+                            }
+                            os << "}";
+                        }
+
+                        /**
+                         * Bytes of heap the process holds, and the most it held so far.
+                         */
+                        static std::size_t held_bytes() {
+                            return detail::held_bytes.load();
+                        }
+
+                        static std::size_t peak_held_bytes() {
+                            return detail::peak_held_bytes.load();
+                        }
+
+                    private:
+                        struct thread_stack {
+                            frame frames[max_depth];
+                            std::size_t depth;
+                        };
+
+                        static thread_stack &frames() {
+                            thread_local thread_stack stack {};
+                            return stack;
+                        }
+
+                        mutable std::mutex mutex;
+                        stages_type stages_;
+                    };
+                }    // namespace perf
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+void *operator new(std::size_t n) {
+    return nil::crypto3::zk::snark::perf::detail::on_allocate(std::malloc(n ? n : 1));
+}
+
+void *operator new[](std::size_t n) {
+    return operator new(n);
+}
+
+void *operator new(std::size_t n, std::align_val_t alignment) {
+    const std::size_t a = static_cast<std::size_t>(alignment);
+    const std::size_t size = (std::max<std::size_t>(n, 1) + a - 1) / a * a;
+    return nil::crypto3::zk::snark::perf::detail::on_allocate(std::aligned_alloc(a, size));
+}
+
+void *operator new[](std::size_t n, std::align_val_t alignment) {
+    return operator new(n, alignment);
+}
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept {
+    try {
+        return operator new(n);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t n, const std::nothrow_t &tag) noexcept {
+    return operator new(n, tag);
+}
+
+void operator delete(void *p) noexcept {
+    nil::crypto3::zk::snark::perf::detail::on_deallocate(p);
+}
+
+void operator delete[](void *p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    operator delete(p);
+}
+
+#endif    // CRYPTO3_PERF_ALLOCATION_PROFILER_HPP
@@ -0,0 +1,647 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the harness shared by the ppzkSNARK benchmarks.
+//
+// A benchmark builds one instance per size of the sweep and, for every thread
+// count of the sweep, runs the generator, the prover and the verifier of the
+// scheme on it the given number of times with an executor limited to that many
+// threads installed on the main thread. It prints one JSON object per size and
+// thread count on the standard output, anything the library prints going to the
+// standard error:
+//
+//     {"scheme":"r1cs_gg_ppzksnark","size":1024,"inputs":10,"threads":4,"repetitions":5,"verified":true,
+//      "generator":{"min":...,"mean":...,"p50":...,"p90":...,"p99":...,"max":...,"throughput":...},
+//      "prover":{...},"verifier":{...},"peak_heap_bytes":...,"peak_memory_kb":...}
+//
+// The latencies are in seconds, the percentiles taken by nearest rank, and the
+// throughput is the number of runs per second of the stage. "peak_heap_bytes" and
+// "peak_memory_kb" are the peak heap and resident memory of the process so far,
+// so they are the peaks of the largest size swept up to this line.
+//
+// With --scaling, a benchmark instead proves the same instance with every thread
+// count, 1, 2, 4, ... up to the default concurrency by default, with a
+// stage_profiler installed, and reports the time per proof of the prover and of
+// each of its stages (witness map, FFTs, multiexps) by path, with its speedup and
+// parallel efficiency relative to the first thread count of the sweep. A stage
+// run by several concurrent tasks sums the time of the tasks, so its speedup
+// stays at 1 as long as the tasks do not slow each other down:
+//
+//     {"scheme":"r1cs_gg_ppzksnark","size":1024,"inputs":10,"threads":4,"repetitions":5,"verified":true,
+//      "prover":{"seconds":...,"speedup":...,"efficiency":...},
+//      "stages":{"multiexp":{"seconds":...,"speedup":...,"efficiency":...},...},"peak_memory_kb":...}
+//
+// With --memory, a benchmark runs the generator and the prover once per size and
+// thread count with an allocation_profiler installed and reports, for them and
+// each of their stages by path, the heap blocks and bytes they allocated and
+// their peak, the most heap the process held during the stage above what it held
+// when the stage started (see allocation_profiler.hpp):
+//
+//     {"scheme":"r1cs_gg_ppzksnark","size":1024,"inputs":10,"threads":4,"verified":true,
+//      "stages":{"generator":{"calls":1,"allocations":...,"bytes":...,"peak_bytes":...},...},
+//      "peak_heap_bytes":...,"peak_memory_kb":...}
+//
+// The sweep is read from the command line:
+//
+//     --sizes 256,1024,4096  constraints (or gates) of the instances
+//     --threads 1,2,4        thread counts, 1 and the default concurrency by default
+//     --repetitions 5        runs of every stage per size and thread count
+//     --inputs 10            primary input size of the instances
+//     --density mixed        density of the R1CS instances, see examples.hpp
+//     --scaling              thread-scaling report of the prover stages
+//     --memory               allocation report of the generator and prover stages
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_PERF_BENCHMARK_HPP
+#define CRYPTO3_PERF_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include <nil/crypto3/zk/snark/algorithms/generate.hpp>
+#include <nil/crypto3/zk/snark/algorithms/prove.hpp>
+#include <nil/crypto3/zk/snark/algorithms/verify.hpp>
+
+#include "allocation_profiler.hpp"
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace perf {
+
+                    struct benchmark_options {
+                        std::vector<std::size_t> sizes;
+                        std::vector<std::size_t> threads;
+                        std::size_t repetitions;
+                        std::size_t inputs;
+                        bool scaling;
+                        bool memory;
+                        const char *density;
+                    };
+
+                    /**
+                     * Reads a comma-separated list of positive integers, returns false if it is malformed.
+                     */
+                    inline bool parse_size_list(const char *list, std::vector<std::size_t> &values) {
+                        values.clear();
+                        const char *p = list;
+                        while (*p) {
+                            char *end;
+                            const unsigned long long value = std::strtoull(p, &end, 10);
+                            if (end == p || !value || (*end && *end != ',')) {
+                                return false;
+                            }
+                            values.push_back(value);
+                            p = *end ? end + 1 : end;
+                        }
+                        return !values.empty();
+                    }
+
+                    /**
+                     * Reads a comma-separated list of names, returns false if it is empty.
+                     */
+                    inline bool parse_name_list(const char *list, std::vector<std::string> &names) {
+                        names.clear();
+                        for (const char *p = list; *p;) {
+                            const char *end = std::strchr(p, ',');
+                            names.emplace_back(p, end ? end : p + std::strlen(p));
+                            p = end ? end + 1 : p + std::strlen(p);
+                        }
+                        return !names.empty();
+                    }
+
+                    /**
+                     * Whether name is one of names, every name being selected if there are none.
+                     */
+                    inline bool name_selected(const std::vector<std::string> &names, const char *name) {
+                        return names.empty() || std::find(names.begin(), names.end(), name) != names.end();
+                    }
+
+                    /**
+                     * 1, 2, 4, ... up to max_threads, max_threads included.
+                     */
+                    inline std::vector<std::size_t> doubling_threads(const std::size_t max_threads) {
+                        std::vector<std::size_t> threads;
+                        for (std::size_t t = 1; t < max_threads; t *= 2) {
+                            threads.push_back(t);
+                        }
+                        threads.push_back(std::max<std::size_t>(1, max_threads));
+                        return threads;
+                    }
+
+                    /**
+                     * 1 and max_threads, 1 alone if max_threads is 1.
+                     */
+                    inline std::vector<std::size_t> single_and_max_threads(const std::size_t max_threads) {
+                        return max_threads > 1 ? std::vector<std::size_t> {1, max_threads} :
+                                                 std::vector<std::size_t> {1};
+                    }
+
+                    /**
+                     * The options of a benchmark command line, each read into the variable it is declared
+                     * with: --name alone for a flag, or --name followed by a list of sizes, a size, a list
+                     * of names or a name. The variables keep their value when an option is absent.
+                     */
+                    class command_line_parser {
+                    public:
+                        void flag(const char *name, bool &value) {
+                            add(name, "", false, [&value](const char *) {
+                                value = true;
+                                return true;
+                            });
+                        }
+
+                        void sizes(const char *name, std::vector<std::size_t> &values) {
+                            add(name, " n,...", true, [&values](const char *arg) {
+                                return parse_size_list(arg, values);
+                            });
+                        }
+
+                        void size(const char *name, std::size_t &value) {
+                            add(name, " n", true, [&value](const char *arg) {
+                                std::vector<std::size_t> values;
+                                if (!parse_size_list(arg, values) || values.size() != 1) {
+                                    return false;
+                                }
+                                value = values[0];
+                                return true;
+                            });
+                        }
+
+                        void names(const char *name, std::vector<std::string> &values) {
+                            add(name, " name,...", true, [&values](const char *arg) {
+                                return parse_name_list(arg, values);
+                            });
+                        }
+
+                        void word(const char *name, const char *&value) {
+                            add(name, " name", true, [&value](const char *arg) {
+                                value = arg;
+                                return true;
+                            });
+                        }
+
+                        /**
+                         * Reads the command line into the variables of the options. Returns false, after
+                         * printing the usage, if an option is unknown, lacks its argument or the argument
+                         * is malformed.
+                         */
+                        bool parse(int argc, const char *argv[]) const {
+                            bool valid = true;
+                            for (int i = 1; valid && i < argc; ++i) {
+                                const auto it = std::find_if(options.begin(), options.end(), [&](const option &o) {
+                                    return !std::strcmp(argv[i], o.name);
+                                });
+                                valid = it != options.end() && (!it->takes_argument || i + 1 < argc) &&
+                                        it->read(it->takes_argument ? argv[++i] : nullptr);
+                            }
+                            if (!valid) {
+                                std::string usage;
+                                for (const option &o : options) {
+                                    usage += std::string(" [") + o.name + o.argument + "]";
+                                }
+                                std::fprintf(stderr, "usage: %s%s\n", argv[0], usage.c_str());
+                            }
+                            return valid;
+                        }
+
+                    private:
+                        struct option {
+                            const char *name;
+                            const char *argument;
+                            bool takes_argument;
+                            std::function<bool(const char *)> read;
+                        };
+
+                        void add(const char *name, const char *argument, const bool takes_argument,
+                                 std::function<bool(const char *)> read) {
+                            options.push_back({name, argument, takes_argument, std::move(read)});
+                        }
+
+                        std::vector<option> options;
+                    };
+
+                    /**
+                     * Reads [--sizes list] [--threads list] [--repetitions n] [--inputs n] [--density name]
+                     * [--scaling] [--memory] from the command line, default_sizes, 5, 10 and "chain" by
+                     * default, the threads being 1 and the default concurrency, or 1, 2, 4, ... up to the
+                     * default concurrency with --scaling. Returns false, after printing the usage, if the
+                     * arguments are malformed; the density is checked by the benchmarks using it.
+                     */
+                    inline bool parse_benchmark_options(int argc, const char *argv[], benchmark_options &options,
+                                                        const std::vector<std::size_t> &default_sizes) {
+                        options.sizes = default_sizes;
+                        options.threads.clear();
+                        options.repetitions = 5;
+                        options.inputs = 10;
+                        options.scaling = false;
+                        options.memory = false;
+                        options.density = "chain";
+
+                        command_line_parser parser;
+                        parser.sizes("--sizes", options.sizes);
+                        parser.sizes("--threads", options.threads);
+                        parser.size("--repetitions", options.repetitions);
+                        parser.size("--inputs", options.inputs);
+                        parser.word("--density", options.density);
+                        parser.flag("--scaling", options.scaling);
+                        parser.flag("--memory", options.memory);
+                        if (!parser.parse(argc, argv)) {
+                            return false;
+                        }
+
+                        if (options.threads.empty()) {
+                            const std::size_t max_threads = executor::default_concurrency();
+                            options.threads =
+                                options.scaling ? doubling_threads(max_threads) : single_and_max_threads(max_threads);
+                        }
+                        return true;
+                    }
+
+                    /**
+                     * Sends what the library writes to std::cout to std::cerr for the lifetime of the
+                     * guard, so that the report is the only output on std::cout.
+                     */
+                    class library_output_guard {
+                    public:
+                        library_output_guard() : previous(std::cout.rdbuf(std::cerr.rdbuf())) {
+                        }
+
+                        library_output_guard(const library_output_guard &) = delete;
+                        library_output_guard &operator=(const library_output_guard &) = delete;
+
+                        ~library_output_guard() {
+                            std::cout.rdbuf(previous);
+                        }
+
+                    private:
+                        std::streambuf *previous;
+                    };
+
+                    /**
+                     * Peak resident memory of the process so far, in kilobytes.
+                     */
+                    inline long peak_memory_kb() {
+                        struct rusage usage;
+                        getrusage(RUSAGE_SELF, &usage);
+                        return usage.ru_maxrss;
+                    }
+
+                    /**
+                     * Current resident memory of the process, in kilobytes, read from /proc/self/statm, the
+                     * peak resident memory where it cannot be read.
+                     */
+                    inline long resident_memory_kb() {
+                        std::FILE *statm = std::fopen("/proc/self/statm", "r");
+                        long size = 0, resident = 0;
+                        const bool read = statm && std::fscanf(statm, "%ld %ld", &size, &resident) == 2;
+                        if (statm) {
+                            std::fclose(statm);
+                        }
+                        return read ? resident * (sysconf(_SC_PAGESIZE) / 1024) : peak_memory_kb();
+                    }
+
+                    /**
+                     * Latencies of the runs of a stage, in seconds.
+                     */
+                    class latency_samples {
+                    public:
+                        /**
+                         * Runs f, records its latency and returns its result.
+                         */
+                        template<typename Function>
+                        auto measure(Function f) -> decltype(f()) {
+                            const auto start = std::chrono::steady_clock::now();
+                            auto result = f();
+                            seconds.push_back(
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                            return result;
+                        }
+
+                        /**
+                         * Records a latency measured by the caller.
+                         */
+                        void record(const double latency) {
+                            seconds.push_back(latency);
+                        }
+
+                        /**
+                         * Adds the latencies recorded by other, e.g. by another thread.
+                         */
+                        void merge(const latency_samples &other) {
+                            seconds.insert(seconds.end(), other.seconds.begin(), other.seconds.end());
+                        }
+
+                        std::size_t size() const {
+                            return seconds.size();
+                        }
+
+                        double total() const {
+                            double total = 0;
+                            for (const double s : seconds) {
+                                total += s;
+                            }
+                            return total;
+                        }
+
+                        double mean() const {
+                            return seconds.empty() ? 0 : total() / seconds.size();
+                        }
+
+                        /**
+                         * Writes {"min":...,"mean":...,"p50":...,"p90":...,"p99":...,"max":...,"throughput":...}.
+                         */
+                        void write_json(std::ostream &os) const {
+                            std::vector<double> sorted(seconds);
+                            std::sort(sorted.begin(), sorted.end());
+                            const double total = this->total();
+
+                            os << "{\"min\":" << percentile(sorted, 0) << ",\"mean\":" << mean()
+                               << ",\"p50\":" << percentile(sorted, 50) << ",\"p90\":" << percentile(sorted, 90)
+                               << ",\"p99\":" << percentile(sorted, 99) << ",\"max\":" << percentile(sorted, 100)
+                               << ",\"throughput\":" << (total > 0 ? sorted.size() / total : 0) << "}";
+                        }
+
+                    private:
+                        /**
+                         * Nearest-rank percentile of sorted samples, the minimum for p = 0.
+                         */
+                        static double percentile(const std::vector<double> &sorted, const std::size_t p) {
+                            if (sorted.empty()) {
+                                return 0;
+                            }
+                            const std::size_t rank = (p * sorted.size() + 99) / 100;
+                            return sorted[rank ? rank - 1 : 0];
+                        }
+
+                        std::vector<double> seconds;
+                    };
+
+                    /**
+                     * Times runs calls of f(i), i in [0, runs), which must return a value, with an executor
+                     * of every thread count installed in turn, what the library prints going to std::cerr,
+                     * and calls report(threads, latency, wall_seconds) after each thread count.
+                     */
+                    template<typename Function, typename Report>
+                    void run_thread_sweep(const std::vector<std::size_t> &threads, const std::size_t runs,
+                                          Function f, Report report) {
+                        for (const std::size_t t : threads) {
+                            const executor pool(t);
+                            executor::scope executor_guard(pool);
+
+                            latency_samples latency;
+                            const auto start = std::chrono::steady_clock::now();
+                            {
+                                library_output_guard output_guard;
+                                for (std::size_t i = 0; i < runs; ++i) {
+                                    latency.measure([&]() { return f(i); });
+                                }
+                            }
+                            const double wall_seconds =
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                            report(pool.concurrency(), latency, wall_seconds);
+                        }
+                    }
+
+                    /**
+                     * Writes {"seconds":...,"speedup":...,"efficiency":...}, the speedup and the parallel
+                     * efficiency being relative to baseline_seconds with baseline_threads threads, 0 if there
+                     * is no baseline.
+                     */
+                    inline void write_scaling_json(std::ostream &os, const double seconds, const std::size_t threads,
+                                                   const double baseline_seconds,
+                                                   const std::size_t baseline_threads) {
+                        const double speedup = seconds > 0 ? baseline_seconds / seconds : 0;
+                        os << "{\"seconds\":" << seconds << ",\"speedup\":" << speedup
+                           << ",\"efficiency\":" << speedup * baseline_threads / threads << "}";
+                    }
+
+                    /**
+                     * Runs the prover of ProofSystem on the same instance with every thread count of the
+                     * options, with a stage_profiler installed, and reports the time per proof of the prover
+                     * and of each of its stages with their speedup and parallel efficiency relative to the
+                     * first thread count. See run_ppzksnark_benchmark for make_example and relation.
+                     */
+                    template<typename ProofSystem, typename MakeExample, typename Relation>
+                    bool run_scaling_benchmark(std::ostream &os, const char *scheme, const benchmark_options &options,
+                                               MakeExample make_example, Relation relation) {
+                        bool all_verified = true;
+                        for (const std::size_t size : options.sizes) {
+                            const auto example = [&]() {
+                                library_output_guard output_guard;
+                                return make_example(size, options.inputs);
+                            }();
+                            const typename ProofSystem::keypair_type keypair = [&]() {
+                                library_output_guard output_guard;
+                                return generate<ProofSystem>(relation(example));
+                            }();
+
+                            stage_profiler::stages_type baseline_stages;
+                            double baseline_seconds = 0;
+                            std::size_t baseline_threads = 0;
+                            for (const std::size_t threads : options.threads) {
+                                const executor pool(threads);
+                                executor::scope executor_guard(pool);
+
+                                stage_profiler profiler;
+                                latency_samples prover;
+                                bool verified = true;
+                                for (std::size_t i = 0; i < options.repetitions; ++i) {
+                                    library_output_guard output_guard;
+                                    const typename ProofSystem::proof_type proof = [&]() {
+                                        stage_profiler::scope profiler_guard(profiler);
+                                        return prover.measure([&]() {
+                                            return prove<ProofSystem>(keypair.first, example.primary_input,
+                                                                      example.auxiliary_input);
+                                        });
+                                    }();
+                                    verified = verify<ProofSystem>(keypair.second, example.primary_input, proof) &&
+                                               verified;
+                                }
+                                all_verified = all_verified && verified;
+
+                                const stage_profiler::stages_type stages = profiler.stages();
+                                if (!baseline_threads) {
+                                    baseline_stages = stages;
+                                    baseline_seconds = prover.mean();
+                                    baseline_threads = pool.concurrency();
+                                }
+
+                                os << "{\"scheme\":\"" << scheme << "\",\"size\":" << size
+                                   << ",\"inputs\":" << options.inputs << ",\"threads\":" << pool.concurrency()
+                                   << ",\"repetitions\":" << options.repetitions
+                                   << ",\"verified\":" << (verified ? "true" : "false") << ",\"prover\":";
+                                write_scaling_json(os, prover.mean(), pool.concurrency(), baseline_seconds,
+                                                   baseline_threads);
+                                os << ",\"stages\":{";
+                                for (auto it = stages.begin(); it != stages.end(); ++it) {
+                                    const auto baseline = baseline_stages.find(it->first);
+                                    os << (it == stages.begin() ? "" : ",") << "\"" << it->first << "\":";
+                                    write_scaling_json(os, it->second.seconds / options.repetitions,
+                                                       pool.concurrency(),
+                                                       baseline == baseline_stages.end() ?
+                                                           0 :
+                                                           baseline->second.seconds / options.repetitions,
+                                                       baseline_threads);
+                                }
+                                os << "},\"peak_memory_kb\":" << peak_memory_kb() << "}" << std::endl;
+                            }
+                        }
+                        return all_verified;
+                    }
+
+                    /**
+                     * Runs the generator and the prover of ProofSystem once per size and thread count of the
+                     * options with an allocation_profiler installed, as the stages "generator" and "prover",
+                     * and reports the allocations and the peak of each of their stages. See
+                     * run_ppzksnark_benchmark for make_example and relation.
+                     */
+                    template<typename ProofSystem, typename MakeExample, typename Relation>
+                    bool run_memory_benchmark(std::ostream &os, const char *scheme, const benchmark_options &options,
+                                              MakeExample make_example, Relation relation) {
+                        bool all_verified = true;
+                        for (const std::size_t size : options.sizes) {
+                            const auto example = [&]() {
+                                library_output_guard output_guard;
+                                return make_example(size, options.inputs);
+                            }();
+
+                            for (const std::size_t threads : options.threads) {
+                                const executor pool(threads);
+                                executor::scope executor_guard(pool);
+
+                                allocation_profiler profiler;
+                                bool verified;
+                                {
+                                    library_output_guard output_guard;
+                                    std::unique_ptr<stage_profiler::scope> profiler_guard(
+                                        new stage_profiler::scope(profiler));
+                                    stage_profiler::timer generator_timer("generator");
+                                    const typename ProofSystem::keypair_type keypair =
+                                        generate<ProofSystem>(relation(example));
+                                    generator_timer.stop();
+
+                                    stage_profiler::timer prover_timer("prover");
+                                    const typename ProofSystem::proof_type proof = prove<ProofSystem>(
+                                        keypair.first, example.primary_input, example.auxiliary_input);
+                                    prover_timer.stop();
+
+                                    profiler_guard.reset();
+                                    verified = verify<ProofSystem>(keypair.second, example.primary_input, proof);
+                                }
+                                all_verified = all_verified && verified;
+
+                                os << "{\"scheme\":\"" << scheme << "\",\"size\":" << size
+                                   << ",\"inputs\":" << options.inputs << ",\"threads\":" << pool.concurrency()
+                                   << ",\"verified\":" << (verified ? "true" : "false") << ",\"stages\":";
+                                profiler.write_json(os);
+                                os << ",\"peak_heap_bytes\":" << allocation_profiler::peak_held_bytes()
+                                   << ",\"peak_memory_kb\":" << peak_memory_kb() << "}" << std::endl;
+                            }
+                        }
+                        return all_verified;
+                    }
+
+                    /**
+                     * Sweeps the sizes and thread counts of the options for ProofSystem, make_example(size,
+                     * inputs) building the instance of a size and relation(example) selecting what the
+                     * generator takes (constraint system or circuit). Returns whether every proof verified.
+                     * With --scaling or --memory, runs run_scaling_benchmark or run_memory_benchmark instead.
+                     */
+                    template<typename ProofSystem, typename MakeExample, typename Relation>
+                    bool run_ppzksnark_benchmark(std::ostream &os, const char *scheme,
+                                                 const benchmark_options &options, MakeExample make_example,
+                                                 Relation relation) {
+                        if (options.scaling) {
+                            return run_scaling_benchmark<ProofSystem>(os, scheme, options, make_example, relation);
+                        }
+                        if (options.memory) {
+                            return run_memory_benchmark<ProofSystem>(os, scheme, options, make_example, relation);
+                        }
+
+                        bool all_verified = true;
+                        for (const std::size_t size : options.sizes) {
+                            const auto example = [&]() {
+                                library_output_guard output_guard;
+                                return make_example(size, options.inputs);
+                            }();
+
+                            for (const std::size_t threads : options.threads) {
+                                const executor pool(threads);
+                                executor::scope executor_guard(pool);
+
+                                latency_samples generator, prover, verifier;
+                                bool verified = true;
+                                for (std::size_t i = 0; i < options.repetitions; ++i) {
+                                    library_output_guard output_guard;
+                                    const typename ProofSystem::keypair_type keypair = generator.measure(
+                                        [&]() { return generate<ProofSystem>(relation(example)); });
+                                    const typename ProofSystem::proof_type proof = prover.measure([&]() {
+                                        return prove<ProofSystem>(keypair.first, example.primary_input,
+                                                                  example.auxiliary_input);
+                                    });
+                                    verified = verifier.measure([&]() {
+                                        return verify<ProofSystem>(keypair.second, example.primary_input, proof);
+                                    }) && verified;
+                                }
+                                all_verified = all_verified && verified;
+
+                                os << "{\"scheme\":\"" << scheme << "\",\"size\":" << size
+                                   << ",\"inputs\":" << options.inputs << ",\"threads\":" << pool.concurrency()
+                                   << ",\"repetitions\":" << options.repetitions
+                                   << ",\"verified\":" << (verified ? "true" : "false") << ",\"generator\":";
+                                generator.write_json(os);
+                                os << ",\"prover\":";
+                                prover.write_json(os);
+                                os << ",\"verifier\":";
+                                verifier.write_json(os);
+                                os << ",\"peak_heap_bytes\":" << allocation_profiler::peak_held_bytes()
+                                   << ",\"peak_memory_kb\":" << peak_memory_kb() << "}" << std::endl;
+                            }
+                        }
+                        return all_verified;
+                    }
+                }    // namespace perf
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_PERF_BENCHMARK_HPP
@@ -0,0 +1,474 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the synthetic instances of the ppzkSNARK benchmarks.
+//
+// These follow the generators of the tests (see test/schemes/ppzksnark), with
+// their checks as assertions since the benchmarks do not run under Boost.Test.
+// The BACS generator of the tests has no such checks and is used as is.
+//
+// generate_r1cs_density_example builds large R1CS instances in parallel with
+// the current executor, writing every constraint and every value of the witness
+// straight into its slot. Its instances are made of blocks of constraints with
+// the density of a kind of circuit:
+//
+//     sparse       one product of a sum of two wires by a third one
+//     poseidon     a partial round of a width-3 Poseidon-like permutation: the
+//                  x^5 S-box of one state wire as three products, then the three
+//                  dense rows of the MDS mix as linear constraints
+//     range_check  the decomposition of a 32-bit value into booleanity checked
+//                  bits and the linear constraint packing them back
+//     mixed        a range check heavy mix, about 60% of the constraints range
+//                  checks, 15% Poseidon rounds and 25% sparse products
+//
+// The operands of the blocks are the primary inputs and free auxiliary wires.
+// Every block draws its wires and values from its own generator seeded from the
+// seed and its index, so an instance depends on its size, number of inputs,
+// density and seed only, not on the number of threads building it.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_PERF_EXAMPLES_HPP
+#define CRYPTO3_PERF_EXAMPLES_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/tbcs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/uscs.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace perf {
+
+                    template<typename FieldType>
+                    struct r1cs_example {
+                        r1cs_constraint_system<FieldType> constraint_system;
+                        r1cs_primary_input<FieldType> primary_input;
+                        r1cs_auxiliary_input<FieldType> auxiliary_input;
+                    };
+
+                    template<typename FieldType>
+                    struct uscs_example {
+                        uscs_constraint_system<FieldType> constraint_system;
+                        uscs_primary_input<FieldType> primary_input;
+                        uscs_auxiliary_input<FieldType> auxiliary_input;
+                    };
+
+                    struct tbcs_example {
+                        tbcs_circuit circuit;
+                        tbcs_primary_input primary_input;
+                        tbcs_auxiliary_input auxiliary_input;
+                    };
+
+                    /**
+                     * R1CS instance of num_constraints constraints over about as many variables, the
+                     * num_inputs primary inputs being full field elements: a Fibonacci-like chain
+                     * alternating additions and multiplications closed by the square of the sum of all
+                     * the variables.
+                     */
+                    template<typename FieldType>
+                    r1cs_example<FieldType> generate_r1cs_example(const std::size_t num_constraints,
+                                                                  const std::size_t num_inputs) {
+                        typedef typename FieldType::value_type value_type;
+                        assert(num_constraints >= 1 && num_inputs <= num_constraints + 2);
+
+                        r1cs_example<FieldType> example;
+                        r1cs_constraint_system<FieldType> &cs = example.constraint_system;
+                        cs.primary_input_size = num_inputs;
+                        cs.auxiliary_input_size = 2 + num_constraints - num_inputs;
+
+                        r1cs_variable_assignment<FieldType> full_variable_assignment;
+                        value_type a = algebra::random_element<FieldType>();
+                        value_type b = algebra::random_element<FieldType>();
+                        full_variable_assignment.push_back(a);
+                        full_variable_assignment.push_back(b);
+
+                        for (std::size_t i = 0; i < num_constraints - 1; ++i) {
+                            linear_combination<FieldType> A, B, C;
+                            value_type tmp;
+                            if (i % 2) {
+                                // a * b = c
+                                A.add_term(i + 1, 1);
+                                B.add_term(i + 2, 1);
+                                tmp = a * b;
+                            } else {
+                                // a + b = c
+                                B.add_term(0, 1);
+                                A.add_term(i + 1, 1);
+                                A.add_term(i + 2, 1);
+                                tmp = a + b;
+                            }
+                            C.add_term(i + 3, 1);
+                            full_variable_assignment.push_back(tmp);
+                            a = b;
+                            b = tmp;
+
+                            cs.add_constraint(r1cs_constraint<FieldType>(A, B, C));
+                        }
+
+                        linear_combination<FieldType> A, B, C;
+                        value_type fin = value_type::zero();
+                        for (std::size_t i = 1; i < cs.num_variables(); ++i) {
+                            A.add_term(i, 1);
+                            B.add_term(i, 1);
+                            fin = fin + full_variable_assignment[i - 1];
+                        }
+                        C.add_term(cs.num_variables(), 1);
+                        cs.add_constraint(r1cs_constraint<FieldType>(A, B, C));
+                        full_variable_assignment.push_back(fin.squared());
+
+                        example.primary_input.assign(full_variable_assignment.begin(),
+                                                     full_variable_assignment.begin() + num_inputs);
+                        example.auxiliary_input.assign(full_variable_assignment.begin() + num_inputs,
+                                                       full_variable_assignment.end());
+
+                        assert(cs.num_variables() == full_variable_assignment.size());
+                        assert(cs.num_constraints() == num_constraints);
+                        assert(cs.is_satisfied(example.primary_input, example.auxiliary_input));
+                        return example;
+                    }
+
+                    enum class r1cs_density { chain, sparse, poseidon, range_check, mixed };
+
+                    /**
+                     * Reads the density named "chain" (the instances of generate_r1cs_example), "sparse",
+                     * "poseidon", "range_check" or "mixed", returns false if the name is none of them.
+                     */
+                    inline bool parse_r1cs_density(const char *name, r1cs_density &density) {
+                        const char *names[] = {"chain", "sparse", "poseidon", "range_check", "mixed"};
+                        for (std::size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+                            if (!std::strcmp(name, names[i])) {
+                                density = static_cast<r1cs_density>(i);
+                                return true;
+                            }
+                        }
+                        return false;
+                    }
+
+                    namespace detail {
+
+                        inline std::uint64_t splitmix64(std::uint64_t x) {
+                            x += 0x9e3779b97f4a7c15ull;
+                            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+                            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+                            return x ^ (x >> 31);
+                        }
+
+                        /* the generator of a block, a counter hashed by splitmix64 */
+                        struct synthetic_rng {
+                            std::uint64_t state;
+
+                            std::uint64_t operator()() {
+                                return splitmix64(state++);
+                            }
+                        };
+
+                        enum class synthetic_block { sparse, poseidon, range_check };
+
+                        inline std::size_t synthetic_block_size(const synthetic_block kind) {
+                            return kind == synthetic_block::sparse ? 1 : kind == synthetic_block::poseidon ? 6 : 33;
+                        }
+
+                        /**
+                         * Writes the constraints [first, first + synthetic_block_size(kind)) of a block and the
+                         * values of their outputs, the output of constraint k being the variable
+                         * num_operands + 1 + k and the operands the variables 1, ..., num_operands.
+                         */
+                        template<typename FieldType>
+                        void generate_synthetic_block(const synthetic_block kind, const std::size_t first,
+                                                      const std::size_t num_operands, synthetic_rng &rng,
+                                                      r1cs_constraint_system<FieldType> &cs,
+                                                      r1cs_variable_assignment<FieldType> &assignment) {
+                            typedef typename FieldType::value_type value_type;
+
+                            const auto operand = [&]() { return 1 + rng() % num_operands; };
+                            const auto output = [&](const std::size_t k) { return num_operands + 1 + first + k; };
+                            const auto value = [&](const std::size_t index) -> value_type & {
+                                return assignment[index - 1];
+                            };
+                            const auto lc = [](std::vector<linear_term<FieldType>> terms) {
+                                std::sort(terms.begin(), terms.end(),
+                                          [](const linear_term<FieldType> &x, const linear_term<FieldType> &y) {
+                                              return x.index < y.index;
+                                          });
+                                linear_combination<FieldType> result;
+                                result.terms = std::move(terms);
+                                return result;
+                            };
+                            const auto term = [](const std::size_t index, const value_type &coeff) {
+                                return linear_term<FieldType>(variable<FieldType>(index), coeff);
+                            };
+                            const value_type one = value_type::one();
+
+                            switch (kind) {
+                                case synthetic_block::sparse: {
+                                    const std::size_t u = operand(), v = operand(), w = operand();
+                                    const linear_combination<FieldType> a =
+                                        u == v ? lc({term(u, one + one)}) : lc({term(u, one), term(v, one)});
+                                    cs.constraints[first] =
+                                        r1cs_constraint<FieldType>(a, lc({term(w, one)}), lc({term(output(0), one)}));
+                                    value(output(0)) = (value(u) + value(v)) * value(w);
+                                    break;
+                                }
+                                case synthetic_block::poseidon: {
+                                    std::size_t s0 = operand(), s1 = operand(), s2 = operand();
+                                    while (s1 == s0) {
+                                        s1 = operand();
+                                    }
+                                    while (s2 == s0 || s2 == s1) {
+                                        s2 = operand();
+                                    }
+
+                                    /* x^2, x^4 and x^5 of the S-box */
+                                    const std::size_t factors[3][2] = {
+                                        {s0, s0}, {output(0), output(0)}, {output(1), s0}};
+                                    for (std::size_t k = 0; k < 3; ++k) {
+                                        cs.constraints[first + k] =
+                                            r1cs_constraint<FieldType>(lc({term(factors[k][0], one)}),
+                                                                       lc({term(factors[k][1], one)}),
+                                                                       lc({term(output(k), one)}));
+                                        value(output(k)) = value(factors[k][0]) * value(factors[k][1]);
+                                    }
+
+                                    /* the rows of the MDS mix of (x^5, s1, s2) */
+                                    for (std::size_t k = 3; k < 6; ++k) {
+                                        const value_type c0 = value_type(rng()), c1 = value_type(rng()),
+                                                         c2 = value_type(rng());
+                                        cs.constraints[first + k] = r1cs_constraint<FieldType>(
+                                            lc({term(output(2), c0), term(s1, c1), term(s2, c2)}), lc({term(0, one)}),
+                                            lc({term(output(k), one)}));
+                                        value(output(k)) = c0 * value(output(2)) + c1 * value(s1) + c2 * value(s2);
+                                    }
+                                    break;
+                                }
+                                case synthetic_block::range_check: {
+                                    const std::uint64_t x = rng() & 0xffffffffull;
+                                    std::vector<linear_term<FieldType>> packing;
+                                    value_type power = one;
+                                    for (std::size_t k = 0; k < 32; ++k) {
+                                        /* b * (1 - b) = 0 */
+                                        cs.constraints[first + k] = r1cs_constraint<FieldType>(
+                                            lc({term(output(k), one)}), lc({term(0, one), term(output(k), -one)}),
+                                            linear_combination<FieldType>());
+                                        value(output(k)) = ((x >> k) & 1) ? one : value_type::zero();
+                                        packing.emplace_back(term(output(k), power));
+                                        power = power + power;
+                                    }
+                                    cs.constraints[first + 32] = r1cs_constraint<FieldType>(
+                                        lc(std::move(packing)), lc({term(0, one)}), lc({term(output(32), one)}));
+                                    value(output(32)) = value_type(x);
+                                    break;
+                                }
+                            }
+                        }
+                    }    // namespace detail
+
+                    /**
+                     * R1CS instance of num_constraints constraints of the given density over num_inputs
+                     * primary inputs, built in parallel with the current executor, see above. The chain
+                     * density stands for generate_r1cs_example and ignores the seed.
+                     */
+                    template<typename FieldType>
+                    r1cs_example<FieldType> generate_r1cs_density_example(const std::size_t num_constraints,
+                                                                          const std::size_t num_inputs,
+                                                                          const r1cs_density density,
+                                                                          const std::uint64_t seed = 0) {
+                        typedef typename FieldType::value_type value_type;
+                        using detail::synthetic_block;
+
+                        if (density == r1cs_density::chain) {
+                            return generate_r1cs_example<FieldType>(num_constraints, num_inputs);
+                        }
+
+                        /* the kinds of the blocks, drawn serially, the last ones sparse to fill the instance */
+                        std::vector<std::pair<synthetic_block, std::size_t>> blocks;
+                        detail::synthetic_rng planner {detail::splitmix64(seed)};
+                        for (std::size_t first = 0; first < num_constraints;) {
+                            synthetic_block kind = density == r1cs_density::sparse   ? synthetic_block::sparse :
+                                                   density == r1cs_density::poseidon ? synthetic_block::poseidon :
+                                                                                        synthetic_block::range_check;
+                            if (density == r1cs_density::mixed) {
+                                const std::size_t draw = planner() % 1000;
+                                kind = draw < 62 ? synthetic_block::range_check :
+                                       draw < 147 ? synthetic_block::poseidon :
+                                                     synthetic_block::sparse;
+                            }
+                            if (first + detail::synthetic_block_size(kind) > num_constraints) {
+                                kind = synthetic_block::sparse;
+                            }
+                            blocks.emplace_back(kind, first);
+                            first += detail::synthetic_block_size(kind);
+                        }
+
+                        const std::size_t num_operands = std::max<std::size_t>(3, num_inputs + num_constraints / 4);
+                        r1cs_example<FieldType> example;
+                        r1cs_constraint_system<FieldType> &cs = example.constraint_system;
+                        cs.primary_input_size = num_inputs;
+                        cs.auxiliary_input_size = num_operands + num_constraints - num_inputs;
+                        cs.constraints.resize(num_constraints);
+
+                        r1cs_variable_assignment<FieldType> assignment(num_operands + num_constraints);
+                        const executor &e = executor::current();
+                        e.parallel_for(num_operands, [&](const std::size_t i) {
+                            assignment[i] = value_type(detail::splitmix64(seed ^ (i << 1 | 1)));
+                        });
+                        e.parallel_for(blocks.size(), [&](const std::size_t i) {
+                            detail::synthetic_rng rng {detail::splitmix64(seed + (std::uint64_t(i) << 32))};
+                            detail::generate_synthetic_block(blocks[i].first, blocks[i].second, num_operands, rng,
+                                                             cs, assignment);
+                        });
+
+                        example.primary_input.assign(assignment.begin(), assignment.begin() + num_inputs);
+                        example.auxiliary_input.assign(assignment.begin() + num_inputs, assignment.end());
+
+                        assert(cs.num_constraints() == num_constraints);
+                        assert(cs.is_satisfied(example.primary_input, example.auxiliary_input));
+                        return example;
+                    }
+
+                    /**
+                     * USCS instance of num_constraints constraints over as many variables, the num_inputs
+                     * primary inputs being full field elements: every constraint combines three random
+                     * variables, the coefficient of the last one chosen so that the constraint evaluates
+                     * to 1 or -1.
+                     */
+                    template<typename FieldType>
+                    uscs_example<FieldType> generate_uscs_example(const std::size_t num_constraints,
+                                                                  const std::size_t num_inputs) {
+                        typedef typename FieldType::value_type value_type;
+                        assert(num_inputs >= 1 && num_constraints >= num_inputs && num_constraints >= 2);
+
+                        uscs_example<FieldType> example;
+                        uscs_constraint_system<FieldType> &cs = example.constraint_system;
+                        cs.primary_input_size = num_inputs;
+                        cs.auxiliary_input_size = num_constraints - num_inputs;
+
+                        uscs_variable_assignment<FieldType> full_variable_assignment;
+                        for (std::size_t i = 0; i < num_constraints; ++i) {
+                            value_type value;
+                            do {
+                                value = algebra::random_element<FieldType>();
+                            } while (value == value_type::zero());
+                            full_variable_assignment.push_back(value);
+                        }
+
+                        for (std::size_t i = 0; i < num_constraints; ++i) {
+                            std::size_t x, y, z;
+                            do {
+                                x = std::rand() % num_constraints;
+                                y = std::rand() % num_constraints;
+                                z = std::rand() % num_constraints;
+                            } while (x == z || y == z);
+
+                            const value_type x_coeff = algebra::random_element<FieldType>();
+                            const value_type y_coeff = algebra::random_element<FieldType>();
+                            const value_type val = (std::rand() % 2 == 0 ? value_type::one() : -value_type::one());
+                            const value_type z_coeff =
+                                (val - x_coeff * full_variable_assignment[x] - y_coeff * full_variable_assignment[y]) *
+                                full_variable_assignment[z].inversed();
+
+                            uscs_constraint<FieldType> constraint;
+                            constraint.add_term(x + 1, x_coeff);
+                            constraint.add_term(y + 1, y_coeff);
+                            constraint.add_term(z + 1, z_coeff);
+                            cs.add_constraint(constraint);
+                        }
+
+                        example.primary_input.assign(full_variable_assignment.begin(),
+                                                     full_variable_assignment.begin() + num_inputs);
+                        example.auxiliary_input.assign(full_variable_assignment.begin() + num_inputs,
+                                                       full_variable_assignment.end());
+
+                        assert(cs.num_variables() == full_variable_assignment.size());
+                        assert(cs.num_constraints() == num_constraints);
+                        assert(cs.is_satisfied(example.primary_input, example.auxiliary_input));
+                        return example;
+                    }
+
+                    /**
+                     * TBCS instance of num_gates random gates over random primary and auxiliary inputs and
+                     * the outputs of the previous gates, the last num_outputs of them being circuit outputs
+                     * of a type chosen so that they evaluate to 0.
+                     */
+                    inline tbcs_example generate_tbcs_example(const std::size_t primary_input_size,
+                                                              const std::size_t auxiliary_input_size,
+                                                              const std::size_t num_gates,
+                                                              const std::size_t num_outputs) {
+                        assert(num_outputs <= num_gates);
+
+                        tbcs_example example;
+                        for (std::size_t i = 0; i < primary_input_size; ++i) {
+                            example.primary_input.push_back(std::rand() % 2 != 0);
+                        }
+                        for (std::size_t i = 0; i < auxiliary_input_size; ++i) {
+                            example.auxiliary_input.push_back(std::rand() % 2 != 0);
+                        }
+
+                        example.circuit.primary_input_size = primary_input_size;
+                        example.circuit.auxiliary_input_size = auxiliary_input_size;
+
+                        tbcs_variable_assignment all_vals;
+                        all_vals.insert(all_vals.end(), example.primary_input.begin(), example.primary_input.end());
+                        all_vals.insert(all_vals.end(), example.auxiliary_input.begin(),
+                                        example.auxiliary_input.end());
+
+                        for (std::size_t i = 0; i < num_gates; ++i) {
+                            const std::size_t num_variables = primary_input_size + auxiliary_input_size + i;
+                            tbcs_gate gate;
+                            gate.left_wire = std::rand() % (num_variables + 1);
+                            gate.right_wire = std::rand() % (num_variables + 1);
+                            gate.output = num_variables + 1;
+
+                            gate.is_circuit_output = (i >= num_gates - num_outputs);
+                            do {
+                                gate.type = (tbcs_gate_type)(std::rand() % num_tbcs_gate_types);
+                            } while (gate.is_circuit_output && gate.evaluate(all_vals));
+
+                            example.circuit.add_gate(gate);
+                            all_vals.push_back(gate.evaluate(all_vals));
+                        }
+
+                        assert(example.circuit.is_satisfied(example.primary_input, example.auxiliary_input));
+                        return example;
+                    }
+                }    // namespace perf
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_PERF_EXAMPLES_HPP
@@ -0,0 +1,184 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the helpers shared by the ppzkPCD profilers.
+//
+// A profiler proves the tally computation over a complete tree of the given arity
+// and depth, node by node from the leaves to the root, with a stage_profiler
+// installed on the main thread, and prints a single JSON report on the standard
+// output, anything the library prints going to the standard error:
+//
+//     {"scheme":"r1cs_sp_ppzkpcd","arity":2,"depth":2,"wordsize":32,"nodes":7,"threads":8,
+//      "verified":true,"seconds":...,"peak_memory_kb":...,
+//      "stages":{"generator":{"calls":1,"seconds":...,"size":0},...}}
+//
+// The profilers run on the mnt4/mnt6 cycle of 298 bits (see pcd_pp), with the
+// threads of the default executor, OMP_NUM_THREADS setting their number.
+//
+// The stage paths name the step ("compliance_step", "translation_step") and its
+// part: "witness" for the witness generation of the step circuit, "prover" for the
+// ppzkSNARK prover, itself split into "multiexp", the multi-exponentiations over
+// the assignment run alongside the witness map, and "multiexp_H". The witness map
+// records under the task that runs it, its "evaluate" and "fft" stages the latter
+// split into every "iFFT", "coset_FFT" and "divide_by_Z". "size" sums the sizes
+// the stage reported: constraints, domain points or exponentiations.
+// "circuits" is the construction of the step circuits, "predicate.witness" the
+// witness generation of the compliance predicate, "verifier" the online verifier
+// run on every node and "batch_verifier" the batched online verifier run on the
+// whole tree.
+//
+// The profilers define CRYPTO3_ZK_COUNT_OPERATIONS before any include and count
+// the operations of the library (see operation_counter.hpp) over all the proofs,
+// the online verifications and the batched verification of the tree, reported as
+// "operations":{"prover":{...},"verifier":{...},"batch_verifier":{...}}.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_PERF_PCD_PROFILE_HPP
+#define CRYPTO3_PERF_PCD_PROFILE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/mnt6.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt6.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt6.hpp>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include "../../benchmark.hpp"
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace perf {
+
+                    /**
+                     * The cycle of curves the profilers run on, the predicate being over the scalar field
+                     * of curve_A_pp.
+                     */
+                    struct pcd_pp {
+                        typedef algebra::curves::mnt4<298> curve_A_pp;
+                        typedef algebra::curves::mnt6<298> curve_B_pp;
+                    };
+
+                    struct pcd_profile_options {
+                        std::size_t arity;
+                        std::size_t depth;
+                        std::size_t wordsize;
+                    };
+
+                    /**
+                     * Reads [arity depth [wordsize]] from the command line, 2, 2 and 32 by default.
+                     * Returns false, after printing the usage, if the arguments are malformed.
+                     */
+                    inline bool parse_pcd_profile_options(int argc, const char *argv[], pcd_profile_options &options) {
+                        options = pcd_profile_options {2, 2, 32};
+                        if (argc != 1 && argc != 3 && argc != 4) {
+                            std::fprintf(stderr, "usage: %s [arity depth [wordsize]]\n", argv[0]);
+                            return false;
+                        }
+                        if (argc >= 3) {
+                            options.arity = std::atoi(argv[1]);
+                            options.depth = std::atoi(argv[2]);
+                        }
+                        if (argc == 4) {
+                            options.wordsize = std::atoi(argv[3]);
+                        }
+                        if (!options.arity || !options.wordsize) {
+                            std::fprintf(stderr, "arity and wordsize must be positive\n");
+                            return false;
+                        }
+                        return true;
+                    }
+
+                    /**
+                     * The children of every node of the complete tree of the given arity and depth, node i
+                     * having nodes arity * i + 1, ..., arity * i + arity as children unless it is a leaf.
+                     * Children always come after their parent, so the nodes are proven in reverse order.
+                     */
+                    inline std::vector<std::vector<std::size_t>> pcd_tree(const std::size_t arity,
+                                                                          const std::size_t depth) {
+                        std::size_t tree_size = 0;
+                        std::size_t nodes_in_layer = 1;
+                        for (std::size_t layer = 0; layer <= depth; ++layer) {
+                            tree_size += nodes_in_layer;
+                            nodes_in_layer *= arity;
+                        }
+
+                        std::vector<std::vector<std::size_t>> incoming_nodes(tree_size);
+                        for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+                            const bool base_case = (arity * cur_idx + arity >= tree_size);
+                            for (std::size_t i = 0; !base_case && i < arity; ++i) {
+                                incoming_nodes[cur_idx].emplace_back(arity * cur_idx + i + 1);
+                            }
+                        }
+                        return incoming_nodes;
+                    }
+
+                    /**
+                     * The operations of the proofs, of the online verifications node by node and of the
+                     * batched online verification of the tree.
+                     */
+                    struct pcd_operation_counts {
+                        operation_counter prover;
+                        operation_counter verifier;
+                        operation_counter batch_verifier;
+                    };
+
+                    inline void write_pcd_profile_report(std::ostream &os, const char *scheme,
+                                                         const pcd_profile_options &options,
+                                                         const std::size_t num_nodes, const bool verified,
+                                                         const double seconds, const stage_profiler &profiler,
+                                                         const pcd_operation_counts &operations) {
+                        os << "{\"scheme\":\"" << scheme << "\",\"arity\":" << options.arity
+                           << ",\"depth\":" << options.depth << ",\"wordsize\":" << options.wordsize
+                           << ",\"nodes\":" << num_nodes << ",\"threads\":" << executor::current().concurrency()
+                           << ",\"verified\":" << (verified ? "true" : "false") << ",\"seconds\":" << seconds
+                           << ",\"peak_memory_kb\":" << peak_memory_kb() << ",\"stages\":";
+                        profiler.write_json(os);
+                        os << ",\"operations\":{\"prover\":";
+                        operations.prover.write_json(os);
+                        os << ",\"verifier\":";
+                        operations.verifier.write_json(os);
+                        os << ",\"batch_verifier\":";
+                        operations.batch_verifier.write_json(os);
+                        os << "}}" << std::endl;
+                    }
+                }    // namespace perf
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_PERF_PCD_PROFILE_HPP
@@ -22,27 +22,121 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //---------------------------------------------------------------------------//
+// Profiles the R1CS multi-predicate ppzkPCD on the tally computation over a
+// complete tree of configurable arity and depth, the nodes alternating between two
+// tally predicates of different types, see pcd_profile.hpp for the arguments and
+// the JSON report.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_COUNT_OPERATIONS
+#define CRYPTO3_ZK_COUNT_OPERATIONS
+#endif
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
 
-#include <nil/crypto3/zk/snark/default_types/r1cs_ppzkpcd_pp.hpp>
-#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/examples/run_r1cs_mp_ppzkpcd.hpp>
 #include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/r1cs_mp_ppzkpcd.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
+
+#include "../../../../../test/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/tally_cp.hpp"
+#include "../pcd_profile.hpp"
 
 using namespace nil::crypto3::zk::snark;
 
 template<typename PCD_ppT>
-void profile_tally(const std::size_t arity, const std::size_t max_layer) {
-    const std::size_t wordsize = 32;
-    const bool test_multi_type = true;
-    const bool test_same_type_optimization = false;
-    const bool bit = run_r1cs_mp_ppzkpcd_tally_example<PCD_ppT>(wordsize, arity, max_layer, test_multi_type,
-                                                                test_same_type_optimization);
-    assert(bit);
-}
+bool profile_tally(const perf::pcd_profile_options &options) {
+    typedef algebra::Fr<typename PCD_ppT::curve_A_pp> FieldType;
+
+    const std::size_t arity = options.arity;
+    const std::vector<std::vector<std::size_t>> incoming_nodes = perf::pcd_tree(arity, options.depth);
+    const std::size_t tree_size = incoming_nodes.size();
+
+    stage_profiler profiler;
+    perf::pcd_operation_counts operations;
+    const auto start = std::chrono::steady_clock::now();
+    bool verified = true;
+    {
+        perf::library_output_guard output_guard;
+        stage_profiler::scope guard(profiler);
+
+        tally_cp_handler<FieldType> tally_1(1, arity, options.wordsize);
+        tally_cp_handler<FieldType> tally_2(2, arity, options.wordsize);
+        tally_1.generate_r1cs_constraints();
+        tally_2.generate_r1cs_constraints();
+        const r1cs_pcd_compliance_predicate<FieldType> cp_1 = tally_1.get_compliance_predicate();
+        const r1cs_pcd_compliance_predicate<FieldType> cp_2 = tally_2.get_compliance_predicate();
+        const std::shared_ptr<r1cs_pcd_message<FieldType>> base_msg = tally_1.get_base_case_message();
+
+        stage_profiler::timer generator_timer("generator");
+        const r1cs_mp_ppzkpcd_keypair<PCD_ppT> keypair = r1cs_mp_ppzkpcd_generator<PCD_ppT>({cp_1, cp_2});
+        generator_timer.stop();
+
+        stage_profiler::timer process_vk_timer("process_vk");
+        const r1cs_mp_ppzkpcd_processed_verification_key<PCD_ppT> pvk =
+            r1cs_mp_ppzkpcd_process_vk<PCD_ppT>(keypair.vk);
+        process_vk_timer.stop();
 
-int main(void) {
+        /* the step circuits of a predicate are built, as the "circuits" stage, by its first proof */
+        r1cs_mp_ppzkpcd_prover_context<PCD_ppT> prover_context(keypair.pk);
+
+        std::vector<r1cs_mp_ppzkpcd_primary_input<PCD_ppT>> tree_primary_inputs;
+        std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> tree_proofs(tree_size);
+        std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> tree_messages(tree_size);
+        for (std::size_t cur_idx = tree_size; cur_idx-- > 0;) {
+            tally_cp_handler<FieldType> &cur_tally = (cur_idx % 2 ? tally_2 : tally_1);
+            const r1cs_pcd_compliance_predicate<FieldType> &cur_cp = (cur_idx % 2 ? cp_2 : cp_1);
+
+            std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> msgs(arity, base_msg);
+            std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> proofs(arity);
+            for (std::size_t i = 0; i < incoming_nodes[cur_idx].size(); ++i) {
+                msgs[i] = tree_messages[incoming_nodes[cur_idx][i]];
+                proofs[i] = tree_proofs[incoming_nodes[cur_idx][i]];
+            }
+
+            stage_profiler::timer predicate_timer("predicate.witness");
+            std::shared_ptr<r1cs_pcd_local_data<FieldType>> ld(new tally_pcd_local_data<FieldType>(std::rand() % 100));
+            cur_tally.generate_r1cs_witness(msgs, ld);
+            const r1cs_pcd_compliance_predicate_primary_input<FieldType> tally_primary_input(
+                cur_tally.get_outgoing_message());
+            const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType> tally_auxiliary_input(
+                msgs, ld, cur_tally.get_witness());
+            predicate_timer.stop();
+
+            operation_counter::scope prover_counter_guard(operations.prover);
+            tree_proofs[cur_idx] =
+                prover_context.prove(cur_cp.name, tally_primary_input, tally_auxiliary_input, proofs);
+            tree_messages[cur_idx] = cur_tally.get_outgoing_message();
+        }
+
+        for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+            tree_primary_inputs.emplace_back(tree_messages[cur_idx]);
+
+            stage_profiler::timer verifier_timer("verifier");
+            operation_counter::scope verifier_counter_guard(operations.verifier);
+            verified = r1cs_mp_ppzkpcd_online_verifier<PCD_ppT>(pvk, tree_primary_inputs.back(),
+                                                                tree_proofs[cur_idx]) &&
+                       verified;
+        }
+
+        stage_profiler::timer batch_verifier_timer("batch_verifier");
+        operation_counter::scope batch_verifier_counter_guard(operations.batch_verifier);
+        verified = r1cs_mp_ppzkpcd_online_batch_verifier<PCD_ppT>(pvk, tree_primary_inputs, tree_proofs) && verified;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    perf::write_pcd_profile_report(std::cout, "r1cs_mp_ppzkpcd", options, tree_size, verified, seconds, profiler,
+                                   operations);
+    return verified;
+}
 
-    const std::size_t arity = 2;
-    const std::size_t max_layer = 2;
+int main(int argc, const char *argv[]) {
+    perf::pcd_profile_options options;
+    if (!perf::parse_pcd_profile_options(argc, argv, options)) {
+        return 1;
+    }
 
-    profile_tally<PCD_pp>(arity, max_layer);
+    return profile_tally<perf::pcd_pp>(options) ? 0 : 1;
 }
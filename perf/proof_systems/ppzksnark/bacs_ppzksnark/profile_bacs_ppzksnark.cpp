@@ -22,36 +22,43 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //---------------------------------------------------------------------------//
+// Benchmarks the BACS ppzkSNARK generator, prover and verifier on synthetic
+// circuits of the given numbers of gates (2^8, 2^10 and 2^12 by default), half
+// of them outputs, for the given thread counts, see benchmark.hpp for the
+// arguments and the JSON report.
+//---------------------------------------------------------------------------//
+
+#include <iostream>
 
-#include <cstdio>
+#include <nil/crypto3/algebra/curves/mnt4.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/scalar_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
 
-#include <nil/crypto3/zk/snark/default_types/bacs_ppzksnark_pp.hpp>
-#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/bacs/examples/bacs_examples.hpp>
-#include <nil/crypto3/zk/snark/schemes/ppzksnark/bacs_ppzksnark/examples/run_bacs_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/bacs_ppzksnark.hpp>
+
+#include "../../../../test/schemes/ppzksnark/bacs_ppzksnark/bacs_examples.hpp"
+#include "../../benchmark.hpp"
 
 using namespace nil::crypto3::zk::snark;
+using namespace nil::crypto3::algebra;
 
-int main(int argc, const char *argv[]) {
-    if (argc == 2 && strcmp(argv[1], "-v") == 0) {
-        algebra::print_compilation_info();
-        return 0;
-    }
+typedef curves::mnt4<298> curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
 
-    if (argc != 3) {
-        printf("usage: %s num_gates primary_input_size\n", argv[0]);
+int main(int argc, const char *argv[]) {
+    perf::benchmark_options options;
+    if (!perf::parse_benchmark_options(argc, argv, options, {1 << 8, 1 << 10, 1 << 12})) {
         return 1;
     }
-    const int num_gates = atoi(argv[1]);
-    int primary_input_size = atoi(argv[2]);
-
-    const std::size_t auxiliary_input_size = 0;
-    const std::size_t num_outputs = num_gates / 2;
-
-    std::cout << "Generate BACS example" << std::endl;
-    bacs_example<typename default_bacs_ppzksnark_pp::scalar_field_type> example =
-        generate_bacs_example<typename default_bacs_ppzksnark_pp::scalar_field_type>(
-            primary_input_size, auxiliary_input_size, num_gates, num_outputs);
 
-    std::cout << "(enter) Profile BACS ppzkSNARK" << std::endl;
-    run_bacs_ppzksnark<default_bacs_ppzksnark_pp>(example);
+    const bool verified = perf::run_ppzksnark_benchmark<bacs_ppzksnark<curve_type>>(
+        std::cout, "bacs_ppzksnark", options,
+        [](const std::size_t size, const std::size_t inputs) {
+            return generate_bacs_example<scalar_field_type>(inputs, 0, size, size / 2);
+        },
+        [](const auto &example) -> const auto & { return example.circuit; });
+    return verified ? 0 : 1;
 }
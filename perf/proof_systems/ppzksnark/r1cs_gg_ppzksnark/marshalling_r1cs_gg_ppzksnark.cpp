@@ -0,0 +1,393 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Benchmark of the serialization and deserialization of the R1CS GG-ppzkSNARK.
+//
+// Times the byteblob encoding of marshalling.hpp on BLS12-381 for the proving key, the
+// verification key, the constraint system and the proof of synthetic instances of the
+// given numbers of constraints (2^12, 2^14 and 2^16 by default) and density, see
+// benchmark.hpp for the arguments, together with the encoding of an aggregate proof
+// of 64 proofs of the smallest instance. The encodings are
+//
+//- proving_key: "compressed" (compressed points and the full-width constraint system),
+//  "compressed_compact" (compressed points and the compact constraint system), both read
+//  with and without the subgroup checks of the points, and "native", the memory-mapped
+//  layout of mapped_proving_key.hpp, written to a file and mapped back;
+//- verification_key: "compressed", read with and without the subgroup checks, and "native",
+//  the layout of mapped_verification_key.hpp;
+//- proof: "compressed", read with and without the subgroup checks;
+//- constraint_system: "full_width" and "compact";
+//- aggregate_proof: the Gt elements of the proof, which are most of its size, "plain" or
+//  torus-compressed (see compressed_proof.hpp), the group elements not having a byteblob
+//  encoding.
+//
+// For every artifact, encoding, validation, size and thread count it prints the JSON line
+// {"artifact":...,"encoding":...,"validation":...,"constraints":...,"threads":...,"bytes":...,
+//  "elements":...,"serialize":{...},"deserialize":{...},"serialize_mb_per_second":...,
+//  "deserialize_mb_per_second":...,"serialize_elements_per_second":...,
+//  "deserialize_elements_per_second":...,"decoded":...}
+// the elements being the group elements of the keys and proofs, the Gt elements of the
+// aggregate proof and the constraints of the constraint system, the rates being those of
+// the mean latencies and decoded whether every deserialization succeeded.
+//---------------------------------------------------------------------------//
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <string>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/compressed_proof.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_proving_key.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/mapped_verification_key.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/marshalling.hpp>
+
+#include "../../benchmark.hpp"
+#include "../../examples.hpp"
+
+using namespace nil::crypto3;
+using namespace nil::crypto3::zk::snark;
+
+typedef algebra::curves::bls12_381 curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
+typedef r1cs_gg_ppzksnark<curve_type> scheme_type;
+typedef r1cs_gg_ppzksnark<
+    curve_type, r1cs_gg_ppzksnark_aggregate_generator<curve_type>,
+    r1cs_gg_ppzksnark_aggregate_prover<curve_type, r1cs_gg_ppzksnark_prover<curve_type>>,
+    r1cs_gg_ppzksnark_aggregate_verifier<curve_type, r1cs_gg_ppzksnark_verifier_strong_input_consistency<curve_type>>,
+    ProvingMode::Aggregate>
+    aggregate_scheme_type;
+typedef hashes::sha2<256> hash_type;
+
+typedef nil::marshalling::verifier_input_serializer_tvm<scheme_type> serializer_type;
+typedef nil::marshalling::verifier_input_deserializer_tvm<scheme_type> deserializer_type;
+typedef typename deserializer_type::point_validation point_validation;
+typedef std::vector<std::uint8_t> byteblob_type;
+
+/* the aggregate proof has 2 log2(aggregate_proofs) rounds */
+const std::size_t aggregate_proofs = 64;
+
+struct marshalling_case {
+    const char *artifact;
+    const char *encoding;
+    const char *validation;
+    std::size_t constraints;
+    std::size_t elements;
+};
+
+const char *validation_name(const point_validation validation) {
+    return validation == point_validation::subgroup_check ? "subgroup_check" : "trusted";
+}
+
+/**
+ * Times serialize(), which returns the number of bytes it wrote, and deserialize(), which returns
+ * whether it decoded them, the given number of times with every thread count of the options, and
+ * writes the report described above. Returns whether every deserialization succeeded.
+ */
+template<typename Serialize, typename Deserialize>
+bool run_marshalling(std::ostream &os, const perf::benchmark_options &options, const marshalling_case &instance,
+                     Serialize serialize, Deserialize deserialize) {
+    bool all_decoded = true;
+    for (const std::size_t threads : options.threads) {
+        executor pool(threads);
+        executor::scope guard(pool);
+
+        perf::latency_samples serialization, deserialization;
+        std::size_t bytes = 0;
+        bool decoded = true;
+        for (std::size_t r = 0; r < options.repetitions; ++r) {
+            bytes = serialization.measure(serialize);
+            decoded = deserialization.measure(deserialize) && decoded;
+        }
+        all_decoded = all_decoded && decoded;
+
+        const auto rate = [](const double amount, const perf::latency_samples &samples) {
+            return samples.mean() > 0 ? amount / samples.mean() : 0;
+        };
+        os << "{\"artifact\":\"" << instance.artifact << "\",\"encoding\":\"" << instance.encoding
+           << "\",\"validation\":\"" << instance.validation << "\",\"constraints\":" << instance.constraints
+           << ",\"threads\":" << threads << ",\"bytes\":" << bytes << ",\"elements\":" << instance.elements
+           << ",\"serialize\":";
+        serialization.write_json(os);
+        os << ",\"deserialize\":";
+        deserialization.write_json(os);
+        os << ",\"serialize_mb_per_second\":" << rate(bytes / 1e6, serialization)
+           << ",\"deserialize_mb_per_second\":" << rate(bytes / 1e6, deserialization)
+           << ",\"serialize_elements_per_second\":" << rate(instance.elements, serialization)
+           << ",\"deserialize_elements_per_second\":" << rate(instance.elements, deserialization)
+           << ",\"decoded\":" << (decoded ? "true" : "false") << "}" << std::endl;
+    }
+    return all_decoded;
+}
+
+/**
+ * Times the encodings of the keys, the constraint system and the proof of an instance of the given
+ * number of constraints.
+ */
+bool run_instance_marshalling(std::ostream &os, const perf::benchmark_options &options,
+                              const perf::r1cs_density density, const std::size_t constraints) {
+    const perf::r1cs_example<scalar_field_type> example = [&]() {
+        perf::library_output_guard output_guard;
+        return perf::generate_r1cs_density_example<scalar_field_type>(constraints, options.inputs, density);
+    }();
+    const typename scheme_type::keypair_type keypair = [&]() {
+        perf::library_output_guard output_guard;
+        return generate<scheme_type>(example.constraint_system);
+    }();
+    const typename scheme_type::proof_type proof = [&]() {
+        perf::library_output_guard output_guard;
+        return prove<scheme_type>(keypair.first, example.primary_input, example.auxiliary_input);
+    }();
+    const typename scheme_type::proving_key_type &pk = keypair.first;
+    const typename scheme_type::verification_key_type &vk = keypair.second;
+
+    bool decoded = true;
+    byteblob_type blob;
+    for (const point_validation validation : {point_validation::subgroup_check, point_validation::trusted}) {
+        for (const nil::marshalling::constraint_system_format format :
+             {nil::marshalling::constraint_system_format::full_width,
+              nil::marshalling::constraint_system_format::compact}) {
+            const bool compact = format == nil::marshalling::constraint_system_format::compact;
+            decoded = run_marshalling(
+                          os, options,
+                          {"proving_key", compact ? "compressed_compact" : "compressed", validation_name(validation),
+                           constraints, pk.G1_size() + pk.G2_size()},
+                          [&]() {
+                              blob = serializer_type::process(pk, format);
+                              return blob.size();
+                          },
+                          [&]() {
+                              nil::marshalling::status_type status;
+                              deserializer_type::proving_key_process(blob.cbegin(), blob.cend(), status, validation,
+                                                                     format);
+                              return status == nil::marshalling::status_type::success;
+                          }) &&
+                      decoded;
+        }
+
+        decoded = run_marshalling(
+                      os, options,
+                      {"verification_key", "compressed", validation_name(validation), constraints,
+                       vk.G1_size() + vk.G2_size()},
+                      [&]() {
+                          blob = serializer_type::process(vk);
+                          return blob.size();
+                      },
+                      [&]() {
+                          nil::marshalling::status_type status;
+                          return deserializer_type::verification_key_process(blob.cbegin(), blob.cend(), status,
+                                                                             validation) == vk &&
+                                 status == nil::marshalling::status_type::success;
+                      }) &&
+                  decoded;
+
+        decoded = run_marshalling(
+                      os, options, {"proof", "compressed", validation_name(validation), constraints, 3},
+                      [&]() {
+                          blob = serializer_type::process(proof);
+                          return blob.size();
+                      },
+                      [&]() {
+                          nil::marshalling::status_type status;
+                          return deserializer_type::proof_process(blob.cbegin(), blob.cend(), status, validation) ==
+                                     proof &&
+                                 status == nil::marshalling::status_type::success;
+                      }) &&
+                  decoded;
+    }
+
+    for (const nil::marshalling::constraint_system_format format :
+         {nil::marshalling::constraint_system_format::full_width,
+          nil::marshalling::constraint_system_format::compact}) {
+        decoded = run_marshalling(
+                      os, options,
+                      {"constraint_system",
+                       format == nil::marshalling::constraint_system_format::compact ? "compact" : "full_width",
+                       "none", constraints, example.constraint_system.num_constraints()},
+                      [&]() {
+                          blob = serializer_type::process(example.constraint_system, format);
+                          return blob.size();
+                      },
+                      [&]() {
+                          nil::marshalling::status_type status;
+                          deserializer_type::r1cs_constraint_system_process(blob.cbegin(), blob.cend(), status,
+                                                                            format);
+                          return status == nil::marshalling::status_type::success;
+                      }) &&
+                  decoded;
+    }
+
+    /* the native layouts are written to the working directory and mapped back */
+    const std::string path = "r1cs_gg_ppzksnark_marshalling.bin";
+    const auto file_size = [&]() {
+        return static_cast<std::size_t>(std::ifstream(path, std::ios::binary | std::ios::ate).tellg());
+    };
+    decoded = run_marshalling(
+                  os, options, {"proving_key", "native", "none", constraints, pk.G1_size() + pk.G2_size()},
+                  [&]() {
+                      r1cs_gg_ppzksnark_mapped_proving_key<curve_type>::write(path, pk);
+                      return file_size();
+                  },
+                  [&]() {
+                      /* the constraint system is not part of the layout, only the mapping is timed */
+                      const r1cs_gg_ppzksnark_mapped_proving_key<curve_type> mapped(
+                          path, r1cs_constraint_system<scalar_field_type>());
+                      return mapped.alpha_g1() == pk.alpha_g1;
+                  }) &&
+              decoded;
+    decoded = run_marshalling(
+                  os, options, {"verification_key", "native", "none", constraints, vk.G1_size() + vk.G2_size()},
+                  [&]() {
+                      r1cs_gg_ppzksnark_mapped_verification_key<curve_type>::write(path, vk);
+                      return file_size();
+                  },
+                  [&]() {
+                      const r1cs_gg_ppzksnark_mapped_verification_key<curve_type> mapped(path);
+                      return mapped.verification_key() == vk;
+                  }) &&
+              decoded;
+    std::remove(path.c_str());
+    return decoded;
+}
+
+/**
+ * Times the plain and the torus-compressed encodings of the Gt elements of an aggregate proof of
+ * aggregate_proofs proofs of an instance of the given number of constraints.
+ */
+bool run_aggregate_marshalling(std::ostream &os, const perf::benchmark_options &options,
+                               const std::size_t constraints) {
+    typedef typename aggregate_scheme_type::aggregate_proof_type aggregate_proof_type;
+    typedef r1cs_gg_ppzksnark_aggregate_compressed_proof<curve_type> compressed_proof_type;
+    typedef typename compressed_proof_type::compression_type compression_type;
+    typedef typename curve_type::gt_type gt_type;
+    typedef typename gt_type::value_type gt_value_type;
+    typedef nil::marshalling::curve_bincode<curve_type> bincode;
+
+    const aggregate_proof_type aggregate_proof = [&]() {
+        perf::library_output_guard output_guard;
+        const perf::r1cs_example<scalar_field_type> example =
+            perf::generate_r1cs_example<scalar_field_type>(constraints, options.inputs);
+        const typename aggregate_scheme_type::keypair_type keypair =
+            generate<aggregate_scheme_type>(example.constraint_system);
+        const std::vector<typename aggregate_scheme_type::proof_type> proofs(
+            aggregate_proofs,
+            prove<aggregate_scheme_type>(keypair.first, example.primary_input, example.auxiliary_input));
+
+        const r1cs_gg_pp_zksnark_aggregate_srs<curve_type> srs(aggregate_proofs,
+                                                               algebra::random_element<scalar_field_type>(),
+                                                               algebra::random_element<scalar_field_type>());
+        const std::array<std::uint8_t, 3> transcript_include {1, 2, 3};
+        return prove<aggregate_scheme_type, hash_type>(srs.specialize(aggregate_proofs).first,
+                                                       transcript_include.begin(), transcript_include.end(),
+                                                       proofs.begin(), proofs.end());
+    }();
+    const std::size_t gt_elements = compressed_proof_type::num_gt_elements(aggregate_proof);
+
+    bool decoded = true;
+    byteblob_type blob;
+    aggregate_proof_type body = aggregate_proof;
+    const std::size_t gt_size = bincode::template get_element_size<gt_type>();
+    decoded = run_marshalling(
+                  os, options, {"aggregate_proof", "plain", "none", constraints, gt_elements},
+                  [&]() {
+                      blob.resize(gt_elements * gt_size);
+                      byteblob_type::iterator out = blob.begin();
+                      detail::for_each_gt_element(body, [&](const gt_value_type &x) {
+                          bincode::template field_element_to_bytes<gt_type>(x, out, out + gt_size);
+                          out += gt_size;
+                      });
+                      return blob.size();
+                  },
+                  [&]() {
+                      byteblob_type::const_iterator in = blob.cbegin();
+                      bool valid = true;
+                      detail::for_each_gt_element(body, [&](gt_value_type &x) {
+                          const std::pair<bool, gt_value_type> read =
+                              bincode::template field_element_from_bytes<gt_type>(in, in + gt_size);
+                          in += gt_size;
+                          x = read.second;
+                          valid = valid && read.first;
+                      });
+                      return valid;
+                  }) &&
+              decoded;
+
+    compressed_proof_type compressed;
+    decoded = run_marshalling(
+                  os, options, {"aggregate_proof", "compressed", "none", constraints, gt_elements},
+                  [&]() {
+                      compressed = compressed_proof_type(aggregate_proof);
+                      blob.resize(compressed.gt_elements.size() * compression_type::element_size());
+                      byteblob_type::iterator out = blob.begin();
+                      for (const auto &c : compressed.gt_elements) {
+                          compression_type::to_bytes(c, out, out + compression_type::element_size());
+                          out += compression_type::element_size();
+                      }
+                      return blob.size();
+                  },
+                  [&]() {
+                      byteblob_type::const_iterator in = blob.cbegin();
+                      bool valid = true;
+                      for (auto &c : compressed.gt_elements) {
+                          const auto read = compression_type::from_bytes(in, in + compression_type::element_size());
+                          in += compression_type::element_size();
+                          c = read.second;
+                          valid = valid && read.first;
+                      }
+                      body = compressed.decompress();
+                      return valid;
+                  }) &&
+              decoded;
+    return decoded;
+}
+
+int main(int argc, const char *argv[]) {
+    perf::benchmark_options options;
+    if (!perf::parse_benchmark_options(argc, argv, options, {1 << 12, 1 << 14, 1 << 16})) {
+        return 1;
+    }
+    perf::r1cs_density density;
+    if (!perf::parse_r1cs_density(options.density, density)) {
+        std::cerr << "unknown density " << options.density << std::endl;
+        return 1;
+    }
+
+    bool decoded = true;
+    for (const std::size_t constraints : options.sizes) {
+        decoded = run_instance_marshalling(std::cout, options, density, constraints) && decoded;
+    }
+    decoded = run_aggregate_marshalling(std::cout, options, options.sizes.front()) && decoded;
+    return decoded ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// Profiles the IPP2 aggregation of Groth16 proofs for 2^min_log_n up to
+// 2^max_log_n proofs (2^3 to 2^14 by default). For every size it reports the
+// time of the SRS setup and specialization, of the GIPA recursion, of the KZG
+// openings of the final commitment keys, of the whole aggregation and of the
+// verification of the aggregate proof, along with the peak resident memory of
+// the process so far. The operations of the aggregation and of the verification
+// (see operation_counter.hpp) follow every line as JSON objects.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_COUNT_OPERATIONS
+#define CRYPTO3_ZK_COUNT_OPERATIONS
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/transcript.hpp>
+
+#include <nil/crypto3/zk/snark/algorithms/generate.hpp>
+#include <nil/crypto3/zk/snark/algorithms/prove.hpp>
+#include <nil/crypto3/zk/snark/algorithms/verify.hpp>
+
+#include <nil/crypto3/zk/snark/operation_counter.hpp>
+
+using namespace nil::crypto3;
+using namespace nil::crypto3::zk::snark;
+
+using curve_type = algebra::curves::bls12_381;
+using scheme_type = r1cs_gg_ppzksnark<
+    curve_type, r1cs_gg_ppzksnark_aggregate_generator<curve_type>,
+    r1cs_gg_ppzksnark_aggregate_prover<curve_type, r1cs_gg_ppzksnark_prover<curve_type>>,
+    r1cs_gg_ppzksnark_aggregate_verifier<curve_type, r1cs_gg_ppzksnark_verifier_strong_input_consistency<curve_type>>,
+    ProvingMode::Aggregate>;
+
+using scalar_field_type = typename curve_type::scalar_field_type;
+using scalar_field_value_type = typename scalar_field_type::value_type;
+using hash_type = hashes::sha2<256>;
+
+double elapsed_seconds(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+long peak_memory_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc != 1 && argc != 3) {
+        printf("usage: %s [min_log_n max_log_n]\n", argv[0]);
+        return 1;
+    }
+    const std::size_t min_log_n = argc == 3 ? atoi(argv[1]) : 3;
+    const std::size_t max_log_n = argc == 3 ? atoi(argv[2]) : 14;
+    if (min_log_n < 1 || min_log_n > max_log_n) {
+        printf("min_log_n must be positive and at most max_log_n\n");
+        return 1;
+    }
+
+    // x_2 * x_2 = x_1, with x_1 as primary input: all the aggregated proofs are proofs of this statement
+    r1cs_constraint_system<scalar_field_type> constraint_system;
+    constraint_system.primary_input_size = 1;
+    constraint_system.auxiliary_input_size = 1;
+    constraint_system.add_constraint(r1cs_constraint<scalar_field_type>(
+        variable<scalar_field_type>(2), variable<scalar_field_type>(2), variable<scalar_field_type>(1)));
+    const r1cs_primary_input<scalar_field_type> primary_input {scalar_field_value_type(9)};
+    const r1cs_auxiliary_input<scalar_field_type> auxiliary_input {scalar_field_value_type(3)};
+
+    std::cout << "Generate Groth16 proof" << std::endl;
+    typename scheme_type::keypair_type keypair = generate<scheme_type>(constraint_system);
+    const typename scheme_type::proof_type proof =
+        prove<scheme_type>(keypair.first, primary_input, auxiliary_input);
+
+    const std::array<std::uint8_t, 3> transcript_include {1, 2, 3};
+
+    printf("%8s %12s %12s %12s %12s %12s %12s %14s\n", "proofs", "setup (s)", "special (s)", "gipa (s)",
+           "kzg (s)", "aggregate (s)", "verify (s)", "peak mem (KB)");
+
+    for (std::size_t log_n = min_log_n; log_n <= max_log_n; ++log_n) {
+        const std::size_t n = std::size_t(1) << log_n;
+
+        auto start = std::chrono::steady_clock::now();
+        r1cs_gg_pp_zksnark_aggregate_srs<curve_type> srs(n, algebra::random_element<scalar_field_type>(),
+                                                         algebra::random_element<scalar_field_type>());
+        const double setup_time = elapsed_seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        auto [pk, vk] = srs.specialize(n);
+        const double specialization_time = elapsed_seconds(start);
+
+        const std::vector<typename scheme_type::proof_type> proofs(n, proof);
+        const std::vector<r1cs_primary_input<scalar_field_type>> statements(n, primary_input);
+
+        // GIPA and the KZG openings are run on their own on the inputs they get during aggregation
+        std::vector<typename curve_type::g1_type::value_type> a(n, proof.g_A), c(n, proof.g_C);
+        std::vector<typename curve_type::g2_type::value_type> b_r;
+        const std::vector<scalar_field_value_type> r_vec =
+            structured_scalar_power<scalar_field_type>(n, algebra::random_element<scalar_field_type>());
+        std::vector<scalar_field_value_type> r_inv;
+        std::transform(r_vec.begin(), r_vec.end(), std::back_inserter(r_inv),
+                       [](const scalar_field_value_type &r_i) { return r_i.inversed(); });
+        std::transform(r_vec.begin(), r_vec.end(), std::back_inserter(b_r),
+                       [&](const scalar_field_value_type &r_i) { return proof.g_B * r_i; });
+        const r1cs_gg_ppzksnark_ipp2_wkey<curve_type> wkey_r_inv = pk.wkey.scale(r_inv.begin(), r_inv.end());
+
+        transcript<curve_type, hash_type> tr(transcript_include.begin(), transcript_include.end());
+        start = std::chrono::steady_clock::now();
+        auto [gipa, challenges, challenges_inv] =
+            gipa_tipp_mipp<curve_type, hash_type>(tr, a.begin(), a.end(), b_r.begin(), b_r.end(), c.begin(), c.end(),
+                                                  pk.vkey, wkey_r_inv, r_vec.begin(), r_vec.end());
+        const double gipa_time = elapsed_seconds(start);
+
+        std::reverse(challenges.begin(), challenges.end());
+        std::reverse(challenges_inv.begin(), challenges_inv.end());
+        const scalar_field_value_type z = algebra::random_element<scalar_field_type>();
+        start = std::chrono::steady_clock::now();
+        prove_commitment_v<curve_type>(pk.h_alpha_powers.begin(), pk.h_alpha_powers.end(), pk.h_beta_powers.begin(),
+                                       pk.h_beta_powers.end(), challenges_inv.begin(), challenges_inv.end(), z);
+        prove_commitment_w<curve_type>(pk.g_alpha_powers.begin(), pk.g_alpha_powers.end(), pk.g_beta_powers.begin(),
+                                       pk.g_beta_powers.end(), challenges.begin(), challenges.end(),
+                                       r_vec[1].inversed(), z);
+        const double kzg_time = elapsed_seconds(start);
+
+        operation_counter aggregation_operations, verification_operations;
+        std::unique_ptr<operation_counter::scope> counter_guard(new operation_counter::scope(aggregation_operations));
+        start = std::chrono::steady_clock::now();
+        const typename scheme_type::aggregate_proof_type aggregate_proof = prove<scheme_type, hash_type>(
+            pk, transcript_include.begin(), transcript_include.end(), proofs.begin(), proofs.end());
+        const double aggregation_time = elapsed_seconds(start);
+
+        counter_guard.reset(new operation_counter::scope(verification_operations));
+        start = std::chrono::steady_clock::now();
+        const bool verified = verify<scheme_type, boost::random::uniform_int_distribution<
+                                                      typename scalar_field_type::modulus_type>,
+                                     boost::random::mt19937, hash_type>(
+            vk, keypair.second, statements, aggregate_proof, transcript_include.begin(), transcript_include.end());
+        const double verification_time = elapsed_seconds(start);
+        counter_guard.reset();
+
+        if (!verified) {
+            printf("verification of the aggregate proof of %zu proofs failed\n", n);
+            return 1;
+        }
+
+        printf("%8zu %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %14ld\n", n, setup_time, specialization_time,
+               gipa_time, kzg_time, aggregation_time, verification_time, peak_memory_kb());
+        std::cout << "         aggregate ";
+        aggregation_operations.write_json(std::cout);
+        std::cout << "\n         verify ";
+        verification_operations.write_json(std::cout);
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,307 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Closed-loop load generator simulating a proving service.
+//
+// Runs the given numbers of concurrent clients (1, 2, 4, ... up to the default
+// concurrency by default) against one shared R1CS GG-ppzkSNARK keypair for
+// --duration seconds. Every client owns an executor of --threads threads and
+// issues a request, a proof or, with --mode verify, a verification, as soon as
+// its previous one completed, or at the client's share of --rate requests per
+// second if it is given. A paced request is scheduled at a fixed time whether or
+// not the previous one completed, a late one being issued as soon as the client
+// is free, and its latency is measured from its scheduled time, so that the time
+// it waited behind the previous ones is counted.
+//
+// Usage: zk_proving_service_r1cs_gg_ppzksnark_perf [--constraints n] [--inputs n] [--clients n,...]
+//            [--threads n] [--rate requests_per_second] [--duration seconds] [--interval seconds]
+//            [--mode prove|verify]
+//
+// For every number of clients it prints the JSON line
+// {"scheme":...,"mode":...,"constraints":...,"inputs":...,"clients":...,"threads_per_client":...,
+//  "offered_rate":...,"duration":...,"requests":...,"failed":...,"requests_per_second":...,
+//  "latency":{...},"peak_memory_kb":...,"timeline":[{"seconds":...,"requests":...,
+//  "requests_per_second":...,"latency":{...},"resident_memory_kb":...},...]}
+// the timeline splitting the run into intervals of --interval seconds (1 by default),
+// the resident memory being sampled at the end of each interval.
+//---------------------------------------------------------------------------//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/mnt4.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/scalar_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
+
+#include "../../benchmark.hpp"
+#include "../../examples.hpp"
+
+using namespace nil::crypto3::zk::snark;
+using namespace nil::crypto3::algebra;
+
+typedef curves::mnt4<298> curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
+typedef r1cs_gg_ppzksnark<curve_type> scheme_type;
+
+typedef std::chrono::steady_clock clock_type;
+
+struct service_options {
+    std::size_t constraints;
+    std::size_t inputs;
+    std::vector<std::size_t> clients;
+    std::size_t threads;
+    double rate;
+    double duration;
+    double interval;
+    bool verify;
+};
+
+/**
+ * Reads the command line described above, returns false, after printing the usage, if it is malformed.
+ */
+bool parse_service_options(int argc, const char *argv[], service_options &options) {
+    options.constraints = 1 << 10;
+    options.inputs = 10;
+    options.clients = perf::doubling_threads(executor::default_concurrency());
+    options.threads = 1;
+    options.rate = 0;
+    options.duration = 10;
+    options.interval = 1;
+    options.verify = false;
+
+    bool valid = true;
+    for (int i = 1; valid && i < argc; ++i) {
+        valid = i + 1 < argc;
+        if (!valid) {
+            break;
+        }
+        const char *value = argv[++i];
+        if (!std::strcmp(argv[i - 1], "--mode")) {
+            valid = !std::strcmp(value, "prove") || !std::strcmp(value, "verify");
+            options.verify = !std::strcmp(value, "verify");
+            continue;
+        }
+        if (!std::strcmp(argv[i - 1], "--rate") || !std::strcmp(argv[i - 1], "--duration") ||
+            !std::strcmp(argv[i - 1], "--interval")) {
+            char *end;
+            const double seconds = std::strtod(value, &end);
+            valid = end != value && !*end && seconds >= 0;
+            if (!std::strcmp(argv[i - 1], "--rate")) {
+                options.rate = seconds;
+            } else {
+                valid = valid && seconds > 0;
+                (!std::strcmp(argv[i - 1], "--duration") ? options.duration : options.interval) = seconds;
+            }
+            continue;
+        }
+        std::vector<std::size_t> values;
+        valid = perf::parse_size_list(value, values);
+        if (!valid) {
+            break;
+        }
+        if (!std::strcmp(argv[i - 1], "--clients")) {
+            options.clients = values;
+        } else if (!std::strcmp(argv[i - 1], "--constraints") && values.size() == 1) {
+            options.constraints = values[0];
+        } else if (!std::strcmp(argv[i - 1], "--inputs") && values.size() == 1) {
+            options.inputs = values[0];
+        } else if (!std::strcmp(argv[i - 1], "--threads") && values.size() == 1) {
+            options.threads = values[0];
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid) {
+        std::fprintf(stderr,
+                     "usage: %s [--constraints n] [--inputs n] [--clients n,...] [--threads n] "
+                     "[--rate requests_per_second] [--duration seconds] [--interval seconds] "
+                     "[--mode prove|verify]\n",
+                     argv[0]);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * A completed request, its completion time being relative to the start of the run.
+ */
+struct completion {
+    double seconds;
+    double latency;
+};
+
+/**
+ * Runs the given number of clients issuing request(), which returns whether it succeeded, for the
+ * duration of the options and writes the report described above.
+ */
+template<typename Request>
+bool run_service(std::ostream &os, const service_options &options, const std::size_t clients, Request request) {
+    const clock_type::time_point start = clock_type::now();
+    const clock_type::time_point deadline =
+        start + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(options.duration));
+    const clock_type::duration period = options.rate > 0 ?
+                                            std::chrono::duration_cast<clock_type::duration>(
+                                                std::chrono::duration<double>(clients / options.rate)) :
+                                            clock_type::duration::zero();
+    const bool paced = period > clock_type::duration::zero();
+    const clock_type::duration interval =
+        std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(options.interval));
+
+    std::atomic<std::size_t> failed(0);
+    std::mutex completions_mutex;
+    std::vector<completion> completions;
+
+    bool finished = false;
+    std::mutex sampler_mutex;
+    std::condition_variable sampler_stop;
+    std::vector<long> memory;
+    std::thread sampler([&]() {
+        std::unique_lock<std::mutex> lock(sampler_mutex);
+        for (clock_type::time_point next = start + interval;
+             !sampler_stop.wait_until(lock, next, [&]() { return finished; }); next += interval) {
+            memory.push_back(perf::resident_memory_kb());
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (std::size_t c = 0; c < clients; ++c) {
+        workers.emplace_back([&, c]() {
+            executor pool(options.threads);
+            executor::scope guard(pool);
+
+            std::vector<completion> local;
+            /* the paced clients are staggered over the period */
+            clock_type::time_point next = start + period * c / clients;
+            for (;;) {
+                std::this_thread::sleep_until(next);
+                /* a paced request is late from its scheduled time, an unpaced one is issued on completion */
+                const clock_type::time_point scheduled = paced ? next : clock_type::now();
+                if (scheduled >= deadline) {
+                    break;
+                }
+                if (!request()) {
+                    ++failed;
+                }
+                const clock_type::time_point completed = clock_type::now();
+                local.push_back({std::chrono::duration<double>(completed - start).count(),
+                                 std::chrono::duration<double>(completed - scheduled).count()});
+                next = paced ? next + period : completed;
+            }
+
+            std::lock_guard<std::mutex> lock(completions_mutex);
+            completions.insert(completions.end(), local.begin(), local.end());
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    const double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(sampler_mutex);
+        finished = true;
+    }
+    sampler_stop.notify_one();
+    sampler.join();
+
+    /* the requests in flight at the deadline complete in the last, partial, interval */
+    perf::latency_samples latency;
+    std::vector<perf::latency_samples> timeline(std::max<std::size_t>(std::ceil(elapsed / options.interval), 1));
+    for (const completion &c : completions) {
+        latency.record(c.latency);
+        timeline[std::min<std::size_t>(c.seconds / options.interval, timeline.size() - 1)].record(c.latency);
+    }
+
+    os << "{\"scheme\":\"r1cs_gg_ppzksnark\",\"mode\":\"" << (options.verify ? "verify" : "prove")
+       << "\",\"constraints\":" << options.constraints << ",\"inputs\":" << options.inputs
+       << ",\"clients\":" << clients << ",\"threads_per_client\":" << options.threads
+       << ",\"offered_rate\":" << options.rate << ",\"duration\":" << elapsed
+       << ",\"requests\":" << completions.size() << ",\"failed\":" << failed.load()
+       << ",\"requests_per_second\":" << (elapsed > 0 ? completions.size() / elapsed : 0) << ",\"latency\":";
+    latency.write_json(os);
+    os << ",\"peak_memory_kb\":" << perf::peak_memory_kb() << ",\"timeline\":[";
+    for (std::size_t k = 0; k < timeline.size(); ++k) {
+        const double end = std::min((k + 1) * options.interval, elapsed);
+        os << (k ? "," : "") << "{\"seconds\":" << end << ",\"requests\":" << timeline[k].size()
+           << ",\"requests_per_second\":" << timeline[k].size() / std::max(end - k * options.interval, 1e-9)
+           << ",\"latency\":";
+        timeline[k].write_json(os);
+        os << ",\"resident_memory_kb\":" << (k < memory.size() ? memory[k] : perf::resident_memory_kb()) << "}";
+    }
+    os << "]}" << std::endl;
+    return !failed.load();
+}
+
+int main(int argc, const char *argv[]) {
+    service_options options;
+    if (!parse_service_options(argc, argv, options)) {
+        return 1;
+    }
+
+    std::unique_ptr<perf::library_output_guard> output_guard(new perf::library_output_guard);
+    const perf::r1cs_example<scalar_field_type> example =
+        perf::generate_r1cs_example<scalar_field_type>(options.constraints, options.inputs);
+    const typename scheme_type::keypair_type keypair = generate<scheme_type>(example.constraint_system);
+    const typename scheme_type::proof_type proof =
+        prove<scheme_type>(keypair.first, example.primary_input, example.auxiliary_input);
+    output_guard.reset();
+
+    bool succeeded = true;
+    for (const std::size_t clients : options.clients) {
+        /* the library logs to std::cout from the clients, the report is written once they joined */
+        output_guard.reset(new perf::library_output_guard);
+        std::ostringstream report;
+        if (options.verify) {
+            succeeded = run_service(report, options, clients, [&]() {
+                            return verify<scheme_type>(keypair.second, example.primary_input, proof);
+                        }) &&
+                        succeeded;
+        } else {
+            succeeded = run_service(report, options, clients, [&]() {
+                            prove<scheme_type>(keypair.first, example.primary_input, example.auxiliary_input);
+                            return true;
+                        }) &&
+                        succeeded;
+        }
+        output_guard.reset();
+        std::cout << report.str();
+    }
+    return succeeded ? 0 : 1;
+}
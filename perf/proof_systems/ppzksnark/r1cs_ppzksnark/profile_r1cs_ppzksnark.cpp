@@ -22,41 +22,48 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //---------------------------------------------------------------------------//
+// Benchmarks the R1CS ppzkSNARK generator, prover and verifier on synthetic
+// instances of the given numbers of constraints (2^8, 2^10 and 2^12 by
+// default) and density (see examples.hpp) for the given thread counts, see
+// benchmark.hpp for the arguments and the JSON report.
+//---------------------------------------------------------------------------//
+
+#include <iostream>
 
-#include <cassert>
-#include <cstdio>
+#include <nil/crypto3/algebra/curves/mnt4.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/scalar_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
 
-#include <nil/crypto3/zk/snark/default_types/r1cs_ppzksnark_pp.hpp>
-#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs/examples/r1cs_examples.hpp>
-#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_ppzksnark/examples/run_r1cs_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_ppzksnark.hpp>
+
+#include "../../benchmark.hpp"
+#include "../../examples.hpp"
 
 using namespace nil::crypto3::zk::snark;
+using namespace nil::crypto3::algebra;
 
-int main(int argc, const char *argv[]) {
-    if (argc == 2 && strcmp(argv[1], "-v") == 0) {
-        algebra::print_compilation_info();
-        return 0;
-    }
+typedef curves::mnt4<298> curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
 
-    if (argc != 3 && argc != 4) {
-        printf("usage: %s num_constraints input_size [Fr|bytes]\n", argv[0]);
+int main(int argc, const char *argv[]) {
+    perf::benchmark_options options;
+    if (!perf::parse_benchmark_options(argc, argv, options, {1 << 8, 1 << 10, 1 << 12})) {
         return 1;
     }
-    const int num_constraints = atoi(argv[1]);
-    int input_size = atoi(argv[2]);
-    if (argc == 4) {
-        assert(strcmp(argv[3], "Fr") == 0 || strcmp(argv[3], "bytes") == 0);
-        if (strcmp(argv[3], "bytes") == 0) {
-            input_size = (8 * input_size + (typename algebra::default_ec_pp::scalar_field_type::capacity()) - 1) /
-                         typename algebra::default_ec_pp::scalar_field_type::capacity();
-        }
+    perf::r1cs_density density;
+    if (!perf::parse_r1cs_density(options.density, density)) {
+        std::cerr << "unknown density " << options.density << std::endl;
+        return 1;
     }
 
-    std::cout << "Generate R1CS example" << std::endl;
-    r1cs_example<typename default_r1cs_ppzksnark_pp::scalar_field_type> example =
-        generate_r1cs_example_with_field_input<typename default_r1cs_ppzksnark_pp::scalar_field_type>(num_constraints,
-                                                                                                      input_size);
-
-    std::cout << "Profile R1CS ppzkSNARK" << std::endl;
-    run_r1cs_ppzksnark<default_r1cs_ppzksnark_pp>(example);
+    const bool verified = perf::run_ppzksnark_benchmark<r1cs_ppzksnark<curve_type>>(
+        std::cout, "r1cs_ppzksnark", options,
+        [&](const std::size_t size, const std::size_t inputs) {
+            return perf::generate_r1cs_density_example<scalar_field_type>(size, inputs, density);
+        },
+        [](const auto &example) -> const auto & { return example.constraint_system; });
+    return verified ? 0 : 1;
 }
@@ -22,35 +22,43 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //---------------------------------------------------------------------------//
+// Benchmarks the USCS ppzkSNARK generator, prover and verifier on synthetic
+// instances of the given numbers of constraints (2^8, 2^10 and 2^12 by
+// default) for the given thread counts, see benchmark.hpp for the arguments and
+// the JSON report.
+//---------------------------------------------------------------------------//
+
+#include <iostream>
 
-#include <cassert>
-#include <cstdio>
+#include <nil/crypto3/algebra/curves/mnt4.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/scalar_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
 
-#include <nil/crypto3/zk/snark/default_types/uscs_ppzksnark_pp.hpp>
-#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/uscs/examples/uscs_examples.hpp>
-#include <nil/crypto3/zk/snark/schemes/ppzksnark/uscs_ppzksnark/examples/run_uscs_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/uscs_ppzksnark.hpp>
+
+#include "../../benchmark.hpp"
+#include "../../examples.hpp"
 
 using namespace nil::crypto3::zk::snark;
+using namespace nil::crypto3::algebra;
 
-int main(int argc, const char *argv[]) {
-    if (argc == 2 && strcmp(argv[1], "-v") == 0) {
-        algebra::print_compilation_info();
-        return 0;
-    }
+typedef curves::mnt4<298> curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
 
-    if (argc != 3) {
-        printf("usage: %s num_constraints input_size\n", argv[0]);
+int main(int argc, const char *argv[]) {
+    perf::benchmark_options options;
+    if (!perf::parse_benchmark_options(argc, argv, options, {1 << 8, 1 << 10, 1 << 12})) {
         return 1;
     }
 
-    const int num_constraints = atoi(argv[1]);
-    const int input_size = atoi(argv[2]);
-
-    std::cout << "Generate USCS example" << std::endl;
-    uscs_example<typename default_uscs_ppzksnark_pp::scalar_field_type> example =
-        generate_uscs_example_with_field_input<typename default_uscs_ppzksnark_pp::scalar_field_type>(num_constraints,
-                                                                                                      input_size);
-
-    std::cout << "Profile USCS ppzkSNARK" << std::endl;
-    run_uscs_ppzksnark<default_uscs_ppzksnark_pp>(example);
+    const bool verified = perf::run_ppzksnark_benchmark<uscs_ppzksnark<curve_type>>(
+        std::cout, "uscs_ppzksnark", options,
+        [](const std::size_t size, const std::size_t inputs) {
+            return perf::generate_uscs_example<scalar_field_type>(size, inputs);
+        },
+        [](const auto &example) -> const auto & { return example.constraint_system; });
+    return verified ? 0 : 1;
 }
@@ -0,0 +1,297 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the harness of the verification throughput benchmark.
+//
+// The verifiers are timed on proofs made beforehand, several distinct proofs of the
+// same statement being verified in turn. A verification is one call of a verifier:
+// a single proof, a batch of proofs or an aggregate proof. It is timed in three ways:
+//
+//     single    every proof on its own, with an executor of the given number of
+//               threads installed, so intra-proof parallelism only
+//     batch     all the proofs in one call of the batch verifier, same executor
+//     parallel  the given number of threads each verifying proofs on their own,
+//               with a single-threaded executor each
+//
+// One JSON object is printed per scheme, primary input size, mode and thread count,
+// with the latencies of the verifications, in seconds, as in benchmark.hpp:
+//
+//     {"scheme":"r1cs_gg_ppzksnark","constraints":1024,"inputs":10,"mode":"parallel","threads":4,
+//      "batch":1,"verifications":40,"verified":true,"latency":{"min":...,"p50":...,...},
+//      "proofs_per_second":...,"proofs_per_second_per_thread":...,"peak_memory_kb":...}
+//
+// "batch" is the number of proofs per verification and "proofs_per_second" the
+// number of proofs verified over the wall-clock time of the run, so that of the
+// parallel mode gives the throughput of a verifier with that many cores.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_PERF_VERIFICATION_BENCHMARK_HPP
+#define CRYPTO3_PERF_VERIFICATION_BENCHMARK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+#include <nil/crypto3/zk/snark/algorithms/generate.hpp>
+#include <nil/crypto3/zk/snark/algorithms/prove.hpp>
+#include <nil/crypto3/zk/snark/algorithms/verify.hpp>
+
+#include "benchmark.hpp"
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+                namespace perf {
+
+                    struct verification_options {
+                        std::size_t constraints;
+                        std::vector<std::size_t> inputs;
+                        std::vector<std::size_t> threads;
+                        std::size_t proofs;
+                        std::size_t repetitions;
+                        std::vector<std::string> schemes;
+                    };
+
+                    /**
+                     * Reads [--constraints n] [--inputs list] [--threads list] [--proofs n] [--repetitions n]
+                     * [--schemes name,...] from the command line, 1024, 1,10,100, 1, 2, 4, ... up to the
+                     * default concurrency, 8, 5 and all the schemes by default. Returns false, after
+                     * printing the usage, if the arguments are malformed.
+                     */
+                    inline bool parse_verification_options(int argc, const char *argv[],
+                                                           verification_options &options) {
+                        options.constraints = 1024;
+                        options.inputs = {1, 10, 100};
+                        options.threads = doubling_threads(executor::default_concurrency());
+                        options.proofs = 8;
+                        options.repetitions = 5;
+                        options.schemes.clear();
+
+                        command_line_parser parser;
+                        parser.size("--constraints", options.constraints);
+                        parser.sizes("--inputs", options.inputs);
+                        parser.sizes("--threads", options.threads);
+                        parser.size("--proofs", options.proofs);
+                        parser.size("--repetitions", options.repetitions);
+                        parser.names("--schemes", options.schemes);
+                        return parser.parse(argc, argv);
+                    }
+
+                    /**
+                     * The statement a line of the report is about.
+                     */
+                    struct verification_case {
+                        const char *scheme;
+                        std::size_t constraints;
+                        std::size_t inputs;
+                    };
+
+                    inline void write_verification_report(std::ostream &os, const verification_case &instance,
+                                                          const char *mode, const std::size_t threads,
+                                                          const std::size_t batch, const bool verified,
+                                                          const latency_samples &latency,
+                                                          const double wall_seconds) {
+                        const double proofs_per_second =
+                            wall_seconds > 0 ? batch * latency.size() / wall_seconds : 0;
+                        os << "{\"scheme\":\"" << instance.scheme << "\",\"constraints\":" << instance.constraints
+                           << ",\"inputs\":" << instance.inputs << ",\"mode\":\"" << mode
+                           << "\",\"threads\":" << threads << ",\"batch\":" << batch
+                           << ",\"verifications\":" << latency.size()
+                           << ",\"verified\":" << (verified ? "true" : "false") << ",\"latency\":";
+                        latency.write_json(os);
+                        os << ",\"proofs_per_second\":" << proofs_per_second
+                           << ",\"proofs_per_second_per_thread\":" << proofs_per_second / threads
+                           << ",\"peak_memory_kb\":" << peak_memory_kb() << "}" << std::endl;
+                    }
+
+                    /**
+                     * Times the repetitions of verify(i) for i in [0, calls), each verifying batch proofs,
+                     * with an executor of every thread count of the options installed in turn. Returns
+                     * whether every verification succeeded.
+                     */
+                    template<typename Verify>
+                    bool run_verifications(std::ostream &os, const verification_case &instance,
+                                           const verification_options &options, const char *mode,
+                                           const std::size_t batch, const std::size_t calls, Verify verify) {
+                        bool all_verified = true;
+                        bool verified = true;
+                        run_thread_sweep(
+                            options.threads, options.repetitions * calls,
+                            [&](const std::size_t i) { return verified = verify(i % calls) && verified; },
+                            [&](const std::size_t threads, const latency_samples &latency, const double wall_seconds) {
+                                write_verification_report(os, instance, mode, threads, batch, verified, latency,
+                                                          wall_seconds);
+                                all_verified = all_verified && verified;
+                                verified = true;
+                            });
+                        return all_verified;
+                    }
+
+                    /**
+                     * Same as run_verifications, the calls being shared by as many threads as the thread
+                     * count, each with a single-threaded executor installed; verify must be safe to call
+                     * from several threads at once.
+                     */
+                    template<typename Verify>
+                    bool run_parallel_verifications(std::ostream &os, const verification_case &instance,
+                                                    const verification_options &options, const char *mode,
+                                                    const std::size_t batch, const std::size_t calls,
+                                                    Verify verify) {
+                        bool all_verified = true;
+                        for (const std::size_t threads : options.threads) {
+                            const std::size_t total = options.repetitions * calls;
+                            std::atomic<std::size_t> next(0);
+                            std::vector<latency_samples> latencies(threads);
+                            std::vector<char> verified(threads, 1);
+
+                            const auto start = std::chrono::steady_clock::now();
+                            {
+                                library_output_guard output_guard;
+                                std::vector<std::thread> workers;
+                                for (std::size_t w = 0; w < threads; ++w) {
+                                    workers.emplace_back([&, w]() {
+                                        const executor pool(1);
+                                        executor::scope executor_guard(pool);
+                                        for (std::size_t k; (k = next++) < total;) {
+                                            verified[w] =
+                                                latencies[w].measure([&]() { return verify(k % calls); }) &&
+                                                verified[w];
+                                        }
+                                    });
+                                }
+                                for (std::thread &worker : workers) {
+                                    worker.join();
+                                }
+                            }
+                            const double wall_seconds =
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                            latency_samples latency;
+                            bool all_workers_verified = true;
+                            for (std::size_t w = 0; w < threads; ++w) {
+                                latency.merge(latencies[w]);
+                                all_workers_verified = all_workers_verified && verified[w];
+                            }
+                            all_verified = all_verified && all_workers_verified;
+
+                            write_verification_report(os, instance, mode, threads, batch, all_workers_verified,
+                                                      latency, wall_seconds);
+                        }
+                        return all_verified;
+                    }
+
+                    /**
+                     * Stands for the batch verifier of a scheme that has none.
+                     */
+                    struct no_batch_verifier { };
+
+                    template<typename BatchVerifier, typename VerificationKey, typename PrimaryInput,
+                             typename Proof>
+                    bool run_batch_verifications(std::ostream &os, const verification_case &instance,
+                                                 const verification_options &options, BatchVerifier batch_verifier,
+                                                 const VerificationKey &vk,
+                                                 const std::vector<PrimaryInput> &primary_inputs,
+                                                 const std::vector<Proof> &proofs) {
+                        return run_verifications(os, instance, options, "batch", proofs.size(), 1,
+                                                 [&](std::size_t) {
+                                                     return batch_verifier(vk, primary_inputs, proofs);
+                                                 });
+                    }
+
+                    template<typename VerificationKey, typename PrimaryInput, typename Proof>
+                    bool run_batch_verifications(std::ostream &, const verification_case &,
+                                                 const verification_options &, no_batch_verifier,
+                                                 const VerificationKey &, const std::vector<PrimaryInput> &,
+                                                 const std::vector<Proof> &) {
+                        return true;
+                    }
+
+                    /**
+                     * Runs the three modes for ProofSystem on the proofs of every primary input size of the
+                     * options, make_example and relation being as for run_ppzksnark_benchmark.
+                     * batch_verifier(vk, primary_inputs, proofs) verifies a batch, no_batch_verifier skips
+                     * the batch mode. Returns whether every verification succeeded.
+                     */
+                    template<typename ProofSystem, typename MakeExample, typename Relation, typename BatchVerifier>
+                    bool run_ppzksnark_verification_benchmark(std::ostream &os, const char *scheme,
+                                                              const verification_options &options,
+                                                              MakeExample make_example, Relation relation,
+                                                              BatchVerifier batch_verifier) {
+                        if (!name_selected(options.schemes, scheme)) {
+                            return true;
+                        }
+
+                        bool all_verified = true;
+                        for (const std::size_t inputs : options.inputs) {
+                            const auto example = [&]() {
+                                library_output_guard output_guard;
+                                return make_example(options.constraints, inputs);
+                            }();
+                            const typename ProofSystem::keypair_type keypair = [&]() {
+                                library_output_guard output_guard;
+                                return generate<ProofSystem>(relation(example));
+                            }();
+
+                            std::vector<typename ProofSystem::proof_type> proofs;
+                            {
+                                library_output_guard output_guard;
+                                for (std::size_t i = 0; i < options.proofs; ++i) {
+                                    proofs.emplace_back(prove<ProofSystem>(keypair.first, example.primary_input,
+                                                                           example.auxiliary_input));
+                                }
+                            }
+                            const std::vector<typename std::decay<decltype(example.primary_input)>::type>
+                                primary_inputs(proofs.size(), example.primary_input);
+
+                            const auto verify_one = [&](const std::size_t i) {
+                                return verify<ProofSystem>(keypair.second, example.primary_input, proofs[i]);
+                            };
+                            const verification_case instance {scheme, options.constraints, inputs};
+                            all_verified = run_verifications(os, instance, options, "single", 1, proofs.size(),
+                                                             verify_one) &&
+                                           all_verified;
+                            all_verified = run_batch_verifications(os, instance, options, batch_verifier,
+                                                                   keypair.second, primary_inputs, proofs) &&
+                                           all_verified;
+                            all_verified = run_parallel_verifications(os, instance, options, "parallel", 1,
+                                                                      proofs.size(), verify_one) &&
+                                           all_verified;
+                        }
+                        return all_verified;
+                    }
+                }    // namespace perf
+            }        // namespace snark
+        }            // namespace zk
+    }                // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_PERF_VERIFICATION_BENCHMARK_HPP
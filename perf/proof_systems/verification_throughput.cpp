@@ -0,0 +1,365 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Benchmark of the verification throughput of the proof systems.
+//
+// Times the verifiers of the ppzkSNARKs (GG, BCTV14, SE, USCS, TBCS and BACS) over
+// MNT4-298 for every primary input size of the sweep, the single-predicate and
+// multi-predicate ppzkPCD over the MNT4/MNT6 cycle, and the verifier of IPP2
+// aggregate proofs of Groth16 proofs over BLS12-381, see verification_benchmark.hpp
+// for the modes and the JSON report. The GG and BCTV14 schemes and the PCDs are also
+// timed with their batch verifier.
+//
+// The ppzkPCD proofs are those of the tally computation over a complete binary tree
+// of depth 1, their primary input being the message of a node, so they are swept
+// neither over the primary input sizes nor over --proofs. The IPP2 case aggregates
+// --proofs proofs, rounded up to a power of two, and is timed per aggregate proof
+// in the modes "aggregate" and "parallel_aggregate".
+//
+// Usage: zk_verification_throughput_perf [--constraints n] [--inputs n,...] [--threads n,...]
+//            [--proofs n] [--repetitions n] [--schemes name,...]
+//
+// the names of the schemes being r1cs_gg_ppzksnark, r1cs_ppzksnark, r1cs_se_ppzksnark,
+// uscs_ppzksnark, tbcs_ppzksnark, bacs_ppzksnark, r1cs_sp_ppzkpcd, r1cs_mp_ppzkpcd and
+// r1cs_gg_ppzksnark_aggregate.
+//---------------------------------------------------------------------------//
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/curves/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/mnt4.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
+#include <nil/crypto3/algebra/fields/mnt4/scalar_field.hpp>
+#include <nil/crypto3/algebra/fields/arithmetic_params/mnt4.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/r1cs_mp_ppzkpcd.hpp>
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_sp_ppzkpcd/r1cs_sp_ppzkpcd.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/bacs_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/transcript.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_se_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/tbcs_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/uscs_ppzksnark.hpp>
+
+#include "../../test/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/tally_cp.hpp"
+#include "../../test/schemes/ppzksnark/bacs_ppzksnark/bacs_examples.hpp"
+#include "pcd/r1cs_pcd/pcd_profile.hpp"
+#include "examples.hpp"
+#include "verification_benchmark.hpp"
+
+using namespace nil::crypto3;
+using namespace nil::crypto3::zk::snark;
+
+typedef algebra::curves::mnt4<298> curve_type;
+typedef typename curve_type::scalar_field_type scalar_field_type;
+
+/**
+ * The single-predicate ppzkPCD, seen by run_ppzkpcd_verification.
+ */
+template<typename PCD_ppT>
+struct sp_ppzkpcd {
+    typedef algebra::Fr<typename PCD_ppT::curve_A_pp> field_type;
+    typedef r1cs_sp_ppzkpcd_keypair<PCD_ppT> keypair_type;
+    typedef r1cs_sp_ppzkpcd_processed_verification_key<PCD_ppT> processed_verification_key_type;
+    typedef r1cs_sp_ppzkpcd_prover_context<PCD_ppT> prover_context_type;
+    typedef r1cs_sp_ppzkpcd_primary_input<PCD_ppT> primary_input_type;
+    typedef r1cs_sp_ppzkpcd_proof<PCD_ppT> proof_type;
+
+    static constexpr const char *scheme = "r1cs_sp_ppzkpcd";
+    static constexpr std::size_t num_predicates = 1;
+
+    static keypair_type generate(const std::vector<r1cs_pcd_compliance_predicate<field_type>> &predicates) {
+        return r1cs_sp_ppzkpcd_generator<PCD_ppT>(predicates[0]);
+    }
+
+    static processed_verification_key_type process_vk(const keypair_type &keypair) {
+        return r1cs_sp_ppzkpcd_process_vk<PCD_ppT>(keypair.vk);
+    }
+
+    static proof_type prove(prover_context_type &context, const r1cs_pcd_compliance_predicate<field_type> &,
+                            const r1cs_pcd_compliance_predicate_primary_input<field_type> &primary_input,
+                            const r1cs_pcd_compliance_predicate_auxiliary_input<field_type> &auxiliary_input,
+                            const std::vector<proof_type> &incoming_proofs) {
+        return context.prove(primary_input, auxiliary_input, incoming_proofs);
+    }
+
+    static bool verify(const processed_verification_key_type &pvk, const primary_input_type &primary_input,
+                       const proof_type &proof) {
+        return r1cs_sp_ppzkpcd_online_verifier<PCD_ppT>(pvk, primary_input, proof);
+    }
+
+    static bool verify_batch(const processed_verification_key_type &pvk,
+                             const std::vector<primary_input_type> &primary_inputs,
+                             const std::vector<proof_type> &proofs) {
+        return r1cs_sp_ppzkpcd_online_batch_verifier<PCD_ppT>(pvk, primary_inputs, proofs);
+    }
+};
+
+/**
+ * The multi-predicate ppzkPCD, seen by run_ppzkpcd_verification.
+ */
+template<typename PCD_ppT>
+struct mp_ppzkpcd {
+    typedef algebra::Fr<typename PCD_ppT::curve_A_pp> field_type;
+    typedef r1cs_mp_ppzkpcd_keypair<PCD_ppT> keypair_type;
+    typedef r1cs_mp_ppzkpcd_processed_verification_key<PCD_ppT> processed_verification_key_type;
+    typedef r1cs_mp_ppzkpcd_prover_context<PCD_ppT> prover_context_type;
+    typedef r1cs_mp_ppzkpcd_primary_input<PCD_ppT> primary_input_type;
+    typedef r1cs_mp_ppzkpcd_proof<PCD_ppT> proof_type;
+
+    static constexpr const char *scheme = "r1cs_mp_ppzkpcd";
+    static constexpr std::size_t num_predicates = 2;
+
+    static keypair_type generate(const std::vector<r1cs_pcd_compliance_predicate<field_type>> &predicates) {
+        return r1cs_mp_ppzkpcd_generator<PCD_ppT>(predicates);
+    }
+
+    static processed_verification_key_type process_vk(const keypair_type &keypair) {
+        return r1cs_mp_ppzkpcd_process_vk<PCD_ppT>(keypair.vk);
+    }
+
+    static proof_type prove(prover_context_type &context, const r1cs_pcd_compliance_predicate<field_type> &predicate,
+                            const r1cs_pcd_compliance_predicate_primary_input<field_type> &primary_input,
+                            const r1cs_pcd_compliance_predicate_auxiliary_input<field_type> &auxiliary_input,
+                            const std::vector<proof_type> &incoming_proofs) {
+        return context.prove(predicate.name, primary_input, auxiliary_input, incoming_proofs);
+    }
+
+    static bool verify(const processed_verification_key_type &pvk, const primary_input_type &primary_input,
+                       const proof_type &proof) {
+        return r1cs_mp_ppzkpcd_online_verifier<PCD_ppT>(pvk, primary_input, proof);
+    }
+
+    static bool verify_batch(const processed_verification_key_type &pvk,
+                             const std::vector<primary_input_type> &primary_inputs,
+                             const std::vector<proof_type> &proofs) {
+        return r1cs_mp_ppzkpcd_online_batch_verifier<PCD_ppT>(pvk, primary_inputs, proofs);
+    }
+};
+
+/**
+ * Proves the tally computation over a complete binary tree of depth 1 with the ppzkPCD PCD,
+ * sp_ppzkpcd or mp_ppzkpcd, the nodes alternating between PCD::num_predicates tally predicates
+ * of different types, and times the online verifier on the proofs of its nodes.
+ */
+template<typename PCD>
+bool run_ppzkpcd_verification(std::ostream &os, const perf::verification_options &options) {
+    typedef typename PCD::field_type FieldType;
+
+    const std::size_t arity = 2, wordsize = 32;
+    const std::vector<std::vector<std::size_t>> incoming_nodes = perf::pcd_tree(arity, 1);
+    const std::size_t tree_size = incoming_nodes.size();
+
+    std::unique_ptr<perf::library_output_guard> output_guard(new perf::library_output_guard);
+    std::vector<std::unique_ptr<tally_cp_handler<FieldType>>> tallies;
+    std::vector<r1cs_pcd_compliance_predicate<FieldType>> predicates;
+    for (std::size_t type = 1; type <= PCD::num_predicates; ++type) {
+        tallies.emplace_back(new tally_cp_handler<FieldType>(type, arity, wordsize));
+        tallies.back()->generate_r1cs_constraints();
+        predicates.emplace_back(tallies.back()->get_compliance_predicate());
+    }
+    const std::shared_ptr<r1cs_pcd_message<FieldType>> base_msg = tallies[0]->get_base_case_message();
+
+    const typename PCD::keypair_type keypair = PCD::generate(predicates);
+    const typename PCD::processed_verification_key_type pvk = PCD::process_vk(keypair);
+    typename PCD::prover_context_type prover_context(keypair.pk);
+
+    std::vector<typename PCD::primary_input_type> primary_inputs;
+    std::vector<typename PCD::proof_type> proofs(tree_size);
+    std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> messages(tree_size);
+    for (std::size_t cur_idx = tree_size; cur_idx-- > 0;) {
+        tally_cp_handler<FieldType> &cur_tally = *tallies[cur_idx % PCD::num_predicates];
+
+        std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> msgs(arity, base_msg);
+        std::vector<typename PCD::proof_type> incoming_proofs(arity);
+        for (std::size_t i = 0; i < incoming_nodes[cur_idx].size(); ++i) {
+            msgs[i] = messages[incoming_nodes[cur_idx][i]];
+            incoming_proofs[i] = proofs[incoming_nodes[cur_idx][i]];
+        }
+
+        std::shared_ptr<r1cs_pcd_local_data<FieldType>> ld(new tally_pcd_local_data<FieldType>(std::rand() % 10));
+        cur_tally.generate_r1cs_witness(msgs, ld);
+        const r1cs_pcd_compliance_predicate_primary_input<FieldType> tally_primary_input(
+            cur_tally.get_outgoing_message());
+        const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType> tally_auxiliary_input(msgs, ld,
+                                                                                           cur_tally.get_witness());
+        proofs[cur_idx] = PCD::prove(prover_context, predicates[cur_idx % PCD::num_predicates], tally_primary_input,
+                                     tally_auxiliary_input, incoming_proofs);
+        messages[cur_idx] = cur_tally.get_outgoing_message();
+    }
+    for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+        primary_inputs.emplace_back(messages[cur_idx]);
+    }
+    output_guard.reset();
+
+    const auto verify_one = [&](const std::size_t i) { return PCD::verify(pvk, primary_inputs[i], proofs[i]); };
+    const perf::verification_case instance {PCD::scheme, predicates[0].constraint_system.num_constraints(),
+                                             primary_inputs[0].as_r1cs_primary_input().size()};
+    bool verified = perf::run_verifications(os, instance, options, "single", 1, tree_size, verify_one);
+    verified = perf::run_verifications(os, instance, options, "batch", tree_size, 1,
+                                       [&](std::size_t) { return PCD::verify_batch(pvk, primary_inputs, proofs); }) &&
+               verified;
+    return perf::run_parallel_verifications(os, instance, options, "parallel", 1, tree_size, verify_one) && verified;
+}
+
+/**
+ * Aggregates --proofs Groth16 proofs, rounded up to a power of two, for every primary input size
+ * and times the verifier of the aggregate proof.
+ */
+bool run_aggregate_verification(std::ostream &os, const perf::verification_options &options) {
+    typedef algebra::curves::bls12_381 aggregate_curve_type;
+    typedef typename aggregate_curve_type::scalar_field_type aggregate_field_type;
+    typedef r1cs_gg_ppzksnark<
+        aggregate_curve_type, r1cs_gg_ppzksnark_aggregate_generator<aggregate_curve_type>,
+        r1cs_gg_ppzksnark_aggregate_prover<aggregate_curve_type, r1cs_gg_ppzksnark_prover<aggregate_curve_type>>,
+        r1cs_gg_ppzksnark_aggregate_verifier<
+            aggregate_curve_type, r1cs_gg_ppzksnark_verifier_strong_input_consistency<aggregate_curve_type>>,
+        ProvingMode::Aggregate>
+        scheme_type;
+    typedef hashes::sha2<256> hash_type;
+
+    std::size_t num_proofs = 1;
+    while (num_proofs < std::max<std::size_t>(options.proofs, 2)) {
+        num_proofs *= 2;
+    }
+    const std::array<std::uint8_t, 3> transcript_include {1, 2, 3};
+
+    bool all_verified = true;
+    for (const std::size_t inputs : options.inputs) {
+        std::unique_ptr<perf::library_output_guard> output_guard(new perf::library_output_guard);
+        const perf::r1cs_example<aggregate_field_type> example =
+            perf::generate_r1cs_example<aggregate_field_type>(options.constraints, inputs);
+        const typename scheme_type::keypair_type keypair = generate<scheme_type>(example.constraint_system);
+
+        std::vector<typename scheme_type::proof_type> proofs;
+        for (std::size_t i = 0; i < num_proofs; ++i) {
+            proofs.emplace_back(prove<scheme_type>(keypair.first, example.primary_input, example.auxiliary_input));
+        }
+        const std::vector<r1cs_primary_input<aggregate_field_type>> statements(num_proofs, example.primary_input);
+
+        const r1cs_gg_pp_zksnark_aggregate_srs<aggregate_curve_type> srs(
+            num_proofs, algebra::random_element<aggregate_field_type>(),
+            algebra::random_element<aggregate_field_type>());
+        const auto specialized = srs.specialize(num_proofs);
+        const typename scheme_type::aggregate_proof_type aggregate_proof = prove<scheme_type, hash_type>(
+            specialized.first, transcript_include.begin(), transcript_include.end(), proofs.begin(), proofs.end());
+        output_guard.reset();
+
+        const auto verify_aggregate = [&](std::size_t) {
+            return verify<scheme_type,
+                          boost::random::uniform_int_distribution<typename aggregate_field_type::modulus_type>,
+                          boost::random::mt19937, hash_type>(specialized.second, keypair.second, statements,
+                                                             aggregate_proof, transcript_include.begin(),
+                                                             transcript_include.end());
+        };
+        const perf::verification_case instance {"r1cs_gg_ppzksnark_aggregate", options.constraints, inputs};
+        all_verified =
+            perf::run_verifications(os, instance, options, "aggregate", num_proofs, 1, verify_aggregate) &&
+            all_verified;
+        all_verified = perf::run_parallel_verifications(os, instance, options, "parallel_aggregate", num_proofs, 1,
+                                                        verify_aggregate) &&
+                       all_verified;
+    }
+    return all_verified;
+}
+
+int main(int argc, const char *argv[]) {
+    perf::verification_options options;
+    if (!perf::parse_verification_options(argc, argv, options)) {
+        return 1;
+    }
+
+    const auto make_r1cs_example = [](const std::size_t size, const std::size_t inputs) {
+        return perf::generate_r1cs_example<scalar_field_type>(size, inputs);
+    };
+    const auto constraint_system = [](const auto &example) -> const auto & { return example.constraint_system; };
+    const auto circuit = [](const auto &example) -> const auto & { return example.circuit; };
+
+    bool verified = true;
+    verified = perf::run_ppzksnark_verification_benchmark<r1cs_gg_ppzksnark<curve_type>>(
+                   std::cout, "r1cs_gg_ppzksnark", options, make_r1cs_example, constraint_system,
+                   [](const auto &vk, const auto &primary_inputs, const auto &proofs) {
+                       return r1cs_gg_ppzksnark<curve_type>::verify_batch(vk, primary_inputs.begin(),
+                                                                          primary_inputs.end(), proofs.begin(),
+                                                                          proofs.end());
+                   }) &&
+               verified;
+    verified = perf::run_ppzksnark_verification_benchmark<r1cs_ppzksnark<curve_type>>(
+                   std::cout, "r1cs_ppzksnark", options, make_r1cs_example, constraint_system,
+                   [](const auto &vk, const auto &primary_inputs, const auto &proofs) {
+                       return r1cs_ppzksnark<curve_type>::verify_batch(vk, primary_inputs.begin(), primary_inputs.end(),
+                                                                       proofs.begin(), proofs.end());
+                   }) &&
+               verified;
+    verified = perf::run_ppzksnark_verification_benchmark<r1cs_se_ppzksnark<curve_type>>(
+                   std::cout, "r1cs_se_ppzksnark", options, make_r1cs_example, constraint_system,
+                   perf::no_batch_verifier()) &&
+               verified;
+    verified = perf::run_ppzksnark_verification_benchmark<uscs_ppzksnark<curve_type>>(
+                   std::cout, "uscs_ppzksnark", options,
+                   [](const std::size_t size, const std::size_t inputs) {
+                       return perf::generate_uscs_example<scalar_field_type>(size, inputs);
+                   },
+                   constraint_system, perf::no_batch_verifier()) &&
+               verified;
+    verified = perf::run_ppzksnark_verification_benchmark<tbcs_ppzksnark<curve_type>>(
+                   std::cout, "tbcs_ppzksnark", options,
+                   [](const std::size_t size, const std::size_t inputs) {
+                       return perf::generate_tbcs_example(inputs, 0, size, size / 2);
+                   },
+                   circuit, perf::no_batch_verifier()) &&
+               verified;
+    verified = perf::run_ppzksnark_verification_benchmark<bacs_ppzksnark<curve_type>>(
+                   std::cout, "bacs_ppzksnark", options,
+                   [](const std::size_t size, const std::size_t inputs) {
+                       return generate_bacs_example<scalar_field_type>(inputs, 0, size, size / 2);
+                   },
+                   circuit, perf::no_batch_verifier()) &&
+               verified;
+
+    if (perf::name_selected(options.schemes, "r1cs_sp_ppzkpcd")) {
+        verified = run_ppzkpcd_verification<sp_ppzkpcd<perf::pcd_pp>>(std::cout, options) && verified;
+    }
+    if (perf::name_selected(options.schemes, "r1cs_mp_ppzkpcd")) {
+        verified = run_ppzkpcd_verification<mp_ppzkpcd<perf::pcd_pp>>(std::cout, options) && verified;
+    }
+    if (perf::name_selected(options.schemes, "r1cs_gg_ppzksnark_aggregate")) {
+        verified = run_aggregate_verification(std::cout, options) && verified;
+    }
+    return verified ? 0 : 1;
+}
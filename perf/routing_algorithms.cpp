@@ -22,42 +22,146 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 //---------------------------------------------------------------------------//
-// @file Functions to profile the algorithms that route on Benes and AS-Waksman networks.
+// @file End-to-end benchmark of the routing of permutations on Benes and AS-Waksman networks.
+//
+// For each network and every power of two number of packets from 2^10 to 2^24,
+// the phases a circuit builder goes through are timed separately: building the
+// topology, routing a random permutation into a packed routing, validating it
+// against the topology, and extracting the switch bits, one per switch, into a
+// witness bit vector. Each phase runs as a stage of an allocation_profiler
+// (see proof_systems/allocation_profiler.hpp), so its peak reports the heap it
+// held above what the process held when it started; the topology is the cached
+// one and is released before the next size.
+//
+// Usage: zk_routing_algorithms_perf [min_log2 [max_log2]]
+//
+// At 2^24 packets the AS-Waksman topology alone takes about 16 GB, lower
+// max_log2 on smaller machines.
 //---------------------------------------------------------------------------//
 
-#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <sys/resource.h>
 
 #include <nil/crypto3/zk/snark/routing/as_waksman.hpp>
-#include <nil/crypto3/zk/snark/routing/benes_routing_algorithm.hpp>
+#include <nil/crypto3/zk/snark/routing/benes.hpp>
+#include <nil/crypto3/zk/snark/stage_profiler.hpp>
 
-using namespace nil::crypto3::zk::snark;
+#include "proof_systems/allocation_profiler.hpp"
 
-void profile_benes_algorithm(const std::size_t n) {
-    printf("* Size: %zu\n", n);
+using namespace nil::crypto3::zk::snark;
 
-    assert(n == 1ul << static_cast<std::size_t>(std::ceil(std::log2(n))));
+double elapsed_seconds(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
-    integer_permutation permutation(n);
-    permutation.random_shuffle();
+long peak_memory_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
 
-    const benes_routing routing = get_benes_routing(permutation);
+/**
+ * The switch bits of a routing, in column order and, within a column, in the order of the
+ * switches' top packets. Both packets of a switch carry its setting in a packed routing; the
+ * top one is the packet whose straight destination precedes its cross destination.
+ */
+std::vector<bool> extract_switch_bits(const routing_topology &topology, const packed_routing &routing) {
+    std::vector<bool> bits;
+    bits.reserve(topology.num_columns() * topology.num_packets() / 2);
+    for (std::size_t column_idx = 0; column_idx < topology.num_columns(); ++column_idx) {
+        for (std::size_t packet_idx = 0; packet_idx < topology.num_packets(); ++packet_idx) {
+            const routing_topology::destinations_type &destinations = topology(column_idx, packet_idx);
+            if (destinations.first < destinations.second) {
+                bits.push_back(routing.get(column_idx, packet_idx));
+            }
+        }
+    }
+    return bits;
 }
 
-void profile_as_waksman_algorithm(const std::size_t n) {
-    printf("* Size: %zu\n", n);
+struct phase_type {
+    double seconds;
+    std::size_t peak_bytes;
+};
 
+template<typename Function>
+phase_type run_phase(perf::allocation_profiler &profiler, const char *name, Function f) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+        stage_profiler::timer phase_timer(name);
+        f();
+    }
+    const double seconds = elapsed_seconds(start);
+    return phase_type {seconds, profiler.stages()[name].peak_bytes};
+}
+
+template<typename GetTopology, typename GetRouting, typename ValidRouting>
+void profile_network(const char *network, const std::size_t n, GetTopology get_topology, GetRouting get_routing,
+                     ValidRouting valid_routing) {
     integer_permutation permutation(n);
     permutation.random_shuffle();
 
-    const as_waksman_routing routing = get_as_waksman_routing(permutation);
+    perf::allocation_profiler profiler;
+    stage_profiler::scope profiler_guard(profiler);
+
+    std::shared_ptr<const routing_topology> topology;
+    packed_routing routing;
+    bool valid = false;
+    std::vector<bool> switch_bits;
+
+    const phase_type topology_phase = run_phase(profiler, "topology", [&]() { topology = get_topology(n); });
+    const phase_type routing_phase = run_phase(profiler, "routing", [&]() { routing = get_routing(permutation); });
+    const phase_type validation_phase =
+        run_phase(profiler, "validation", [&]() { valid = valid_routing(permutation, routing); });
+    const phase_type extraction_phase =
+        run_phase(profiler, "extraction", [&]() { switch_bits = extract_switch_bits(*topology, routing); });
+
+    if (!valid) {
+        fprintf(stderr, "invalid %s routing for %zu packets\n", network, n);
+        std::exit(EXIT_FAILURE);
+    }
+
+    const phase_type phases[] = {topology_phase, routing_phase, validation_phase, extraction_phase};
+    printf("%-10s %10zu", network, n);
+    for (const phase_type &phase : phases) {
+        printf(" %10.3f %10zu", phase.seconds, phase.peak_bytes / 1024);
+    }
+    printf(" %10zu %12ld\n", switch_bits.size(), peak_memory_kb());
+    fflush(stdout);
 }
 
-int main() {
-    for (std::size_t n = 1ul << 10; n <= 1ul << 20; n <<= 1) {
-        profile_benes_algorithm(n);
+int main(int argc, char *argv[]) {
+    const std::size_t min_log2 = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10;
+    const std::size_t max_log2 = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 24;
+
+    printf("%-10s %10s %21s %21s %21s %21s %10s %12s\n", "", "", "topology", "routing", "validation",
+           "extraction", "", "");
+    printf("%-10s %10s", "network", "packets");
+    for (std::size_t phase = 0; phase < 4; ++phase) {
+        printf(" %10s %10s", "time (s)", "peak (KB)");
+    }
+    printf(" %10s %12s\n", "switches", "max RSS (KB)");
+
+    for (std::size_t log2 = min_log2; log2 <= max_log2; ++log2) {
+        profile_network(
+            "benes", std::size_t(1) << log2, get_benes_topology, get_benes_packed_routing,
+            [](const integer_permutation &permutation, const packed_routing &routing) {
+                return valid_benes_routing(permutation, routing);
+            });
+        routing_topology_cache<benes_network_tag>::clear();
     }
 
-    for (std::size_t n = 1ul << 10; n <= 1ul << 20; n <<= 1) {
-        profile_as_waksman_algorithm(n);
+    for (std::size_t log2 = min_log2; log2 <= max_log2; ++log2) {
+        profile_network(
+            "as_waksman", std::size_t(1) << log2, get_as_waksman_topology, get_as_waksman_packed_routing,
+            [](const integer_permutation &permutation, const packed_routing &routing) {
+                return valid_as_waksman_routing(permutation, routing);
+            });
+        routing_topology_cache<as_waksman_network_tag>::clear();
     }
 }
@@ -0,0 +1,96 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE concurrent_queue_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/concurrent_queue.hpp>
+
+using namespace nil::crypto3::zk::snark;
+
+BOOST_AUTO_TEST_SUITE(concurrent_queue_test_suite)
+
+BOOST_AUTO_TEST_CASE(mpsc_queue_producer_order_test) {
+    constexpr std::size_t producers = 8;
+    constexpr std::size_t pushes = 20000;
+
+    // an element is its producer and its rank among the elements of that producer
+    detail::mpsc_queue<std::pair<std::size_t, std::size_t>> queue;
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p]() {
+            for (std::size_t i = 0; i < pushes; ++i) {
+                queue.push(std::make_pair(p, i));
+            }
+        });
+    }
+
+    std::vector<std::size_t> next(producers, 0);
+    std::size_t popped = 0, out_of_order = 0;
+    std::pair<std::size_t, std::size_t> element;
+    while (popped < producers * pushes) {
+        if (!queue.try_pop(element)) {
+            std::this_thread::yield();
+            continue;
+        }
+        out_of_order += element.second != next[element.first];
+        next[element.first] = element.second + 1;
+        ++popped;
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(out_of_order, 0);
+    BOOST_CHECK(next == std::vector<std::size_t>(producers, pushes));
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK(!queue.try_pop(element));
+}
+
+BOOST_AUTO_TEST_CASE(bounded_queue_drain_test) {
+    detail::bounded_queue<std::size_t> queue(2);
+    std::thread producer([&queue]() {
+        for (std::size_t i = 0; i < 1000; ++i) {
+            queue.push(std::size_t(i));
+        }
+        queue.close();
+    });
+
+    std::size_t value, expected = 0;
+    while (queue.pop(value)) {
+        BOOST_CHECK_EQUAL(value, expected);
+        ++expected;
+    }
+    producer.join();
+    BOOST_CHECK_EQUAL(expected, 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
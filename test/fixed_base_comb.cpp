@@ -0,0 +1,112 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Test of the scalar multiplication over a fixed-base comb.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE fixed_base_comb_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/execution_policy.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_multiexp.hpp>
+
+using namespace nil::crypto3::algebra;
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef curves::bls12<381> curve_type;
+    typedef curve_type::g1_type g1_type;
+    typedef curve_type::g2_type g2_type;
+    typedef curve_type::scalar_field_type scalar_field_type;
+    typedef scalar_field_type::value_type scalar_field_value_type;
+
+    /* random scalars and 0, 1 and r - 1 */
+    std::vector<scalar_field_value_type> test_scalars() {
+        std::vector<scalar_field_value_type> scalars = {scalar_field_value_type::zero(),
+                                                        scalar_field_value_type::one(),
+                                                        -scalar_field_value_type::one()};
+        for (std::size_t i = 0; i < 8; ++i) {
+            scalars.push_back(random_element<scalar_field_type>());
+        }
+        return scalars;
+    }
+
+    /* the comb multiplications of a random base by every test scalar, one and three at a time, against scalar_mul */
+    template<typename GroupType>
+    bool agrees_with_scalar_mul(const std::size_t window) {
+        typedef typename GroupType::value_type group_value_type;
+
+        const group_value_type base = random_element<GroupType>();
+        const fixed_base_comb<GroupType> comb = fixed_base_comb_precompute<GroupType, scalar_field_type>(base, window);
+        const std::vector<scalar_field_value_type> scalars = test_scalars();
+
+        bool agrees = true;
+        for (std::size_t i = 0; i < scalars.size(); ++i) {
+            const group_value_type expected =
+                variable_time_execution::scalar_mul<scalar_field_type>(base, scalars[i]);
+            agrees = agrees && constant_time_execution::scalar_mul<scalar_field_type>(base, scalars[i]) == expected;
+
+            const std::array<scalar_field_value_type, 1> one = {scalars[i]};
+            agrees = agrees && constant_time_execution::scalar_mul<scalar_field_type>(comb, one)[0] == expected;
+
+            const std::array<scalar_field_value_type, 3> three = {scalars[i], scalars[(i + 1) % scalars.size()],
+                                                                  scalars[(i + 2) % scalars.size()]};
+            const std::array<group_value_type, 3> results =
+                constant_time_execution::scalar_mul<scalar_field_type>(comb, three);
+            for (std::size_t k = 0; k < three.size(); ++k) {
+                agrees = agrees &&
+                         results[k] == variable_time_execution::scalar_mul<scalar_field_type>(base, three[k]);
+            }
+        }
+        return agrees;
+    }
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(fixed_base_comb_test_suite)
+
+BOOST_AUTO_TEST_CASE(fixed_base_comb_g1_test) {
+    // the window of the delta combs of a proving key, one bit, and one that does not divide the scalar size
+    BOOST_CHECK(agrees_with_scalar_mul<g1_type>(4));
+    BOOST_CHECK(agrees_with_scalar_mul<g1_type>(1));
+    BOOST_CHECK(agrees_with_scalar_mul<g1_type>(7));
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_comb_g2_test) {
+    BOOST_CHECK(agrees_with_scalar_mul<g2_type>(4));
+    BOOST_CHECK(agrees_with_scalar_mul<g2_type>(1));
+    BOOST_CHECK(agrees_with_scalar_mul<g2_type>(7));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Test of the GLV endomorphism multi-exponentiation on the G1 groups of BLS12-381
+// and BN254.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE glv_endomorphism_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/alt_bn128.hpp>
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/glv_endomorphism.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+
+using namespace nil::crypto3::algebra;
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    template<typename CurveType>
+    void test_glv_endomorphism(const char *lambda_string) {
+        typedef typename CurveType::g1_type g1_type;
+        typedef typename g1_type::value_type g1_value_type;
+        typedef typename CurveType::scalar_field_type scalar_field_type;
+        typedef typename scalar_field_type::value_type scalar_field_value_type;
+        typedef policies::multiexp_method_naive_plain naive_method_type;
+
+        const scalar_field_value_type lambda((typename scalar_field_type::modulus_type(lambda_string)));
+
+        // phi(P) = lambda * P
+        const g1_value_type point = g1_value_type::one() * random_element<scalar_field_type>();
+        BOOST_CHECK(glv_image<g1_type>(point) == point * lambda);
+        BOOST_CHECK(glv_image<g1_type>(point.to_affine()) == (point * lambda).to_affine());
+
+        // k = k1 + k2 * lambda with halves of about half the length of r
+        std::vector<scalar_field_value_type> scalars = {
+            scalar_field_value_type::zero(), scalar_field_value_type::one(), -scalar_field_value_type::one(),
+            lambda, -lambda};
+        for (std::size_t i = 0; i < 32; ++i) {
+            scalars.emplace_back(random_element<scalar_field_type>());
+        }
+        const detail::glv_integral_type half_bound = detail::glv_integral_type(1)
+                                                     << (scalar_field_type::modulus_bits / 2 + 2);
+        for (const scalar_field_value_type &k : scalars) {
+            const glv_decomposition<g1_type> decomposition = glv_decompose<g1_type>(k);
+            const scalar_field_value_type k1 = decomposition.negative1 ? -decomposition.k1 : decomposition.k1;
+            const scalar_field_value_type k2 = decomposition.negative2 ? -decomposition.k2 : decomposition.k2;
+            BOOST_CHECK(k1 + k2 * lambda == k);
+            BOOST_CHECK(detail::glv_integral_type(decomposition.k1.data) < half_bound);
+            BOOST_CHECK(detail::glv_integral_type(decomposition.k2.data) < half_bound);
+        }
+
+        // the split multi-exponentiations against a naive one, over all the bases and over a range
+        std::vector<g1_value_type> bases;
+        for (std::size_t i = 0; i < scalars.size(); ++i) {
+            bases.emplace_back(g1_value_type::one() * random_element<scalar_field_type>());
+        }
+        const g1_value_type expected = dispatch_multiexp<naive_method_type>(bases.begin(), bases.end(),
+                                                                           scalars.begin(), scalars.end(), 1);
+        BOOST_CHECK(endomorphism_multiexp<g1_type, multiexp_method_auto>(bases.begin(), bases.end(),
+                                                                         scalars.begin(), scalars.end(), 2) ==
+                    expected);
+
+        const glv_bases<g1_type> precomputed(bases);
+        BOOST_CHECK(precomputed.size() == bases.size());
+        BOOST_CHECK(glv_multiexp<multiexp_method_auto>(precomputed, 0, bases.size(), scalars.begin(), 1) ==
+                    expected);
+        // a shorter call between two full ones, the scratch buffers being reused
+        BOOST_CHECK(glv_multiexp<multiexp_method_auto>(precomputed, 3, 10, scalars.begin() + 3, 1) ==
+                    dispatch_multiexp<naive_method_type>(bases.begin() + 3, bases.begin() + 10,
+                                                         scalars.begin() + 3, scalars.begin() + 10, 1));
+        BOOST_CHECK(glv_multiexp<multiexp_method_auto>(precomputed, 0, bases.size(), scalars.begin(), 2) ==
+                    expected);
+    }
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(glv_endomorphism_test_suite)
+
+BOOST_AUTO_TEST_CASE(bls12_381_glv_endomorphism_test) {
+    // lambda = z^2 - 1
+    test_glv_endomorphism<curves::bls12<381>>("228988810152649578064853576960394133503");
+}
+
+BOOST_AUTO_TEST_CASE(bn254_glv_endomorphism_test) {
+    test_glv_endomorphism<curves::alt_bn128<254>>(
+        "21888242871839275217838484774961031246154997185409878258781734729429964517155");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
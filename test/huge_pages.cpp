@@ -0,0 +1,161 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE huge_pages_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/huge_pages.hpp>
+
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+    /* Restores huge_page_policy::current() at the end of a test. */
+    struct policy_guard {
+        huge_page_policy saved = huge_page_policy::current();
+
+        ~policy_guard() {
+            huge_page_policy::current() = saved;
+        }
+    };
+
+    struct test_proving_key {
+        struct {
+            std::vector<std::uint64_t> values;
+        } B_query;
+        std::vector<std::uint64_t> A_query, H_query, L_query;
+    };
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(huge_pages_test_suite)
+
+BOOST_AUTO_TEST_CASE(reserve_with_huge_pages_test) {
+    policy_guard guard;
+    const std::size_t size = 2 * huge_page_2mb / sizeof(std::uint64_t);
+
+    // disabled by default: the vector is left as it is
+    BOOST_CHECK(!huge_page_policy::current().enabled);
+    std::vector<std::uint64_t> values(10, 7);
+    reserve_with_huge_pages(values, size);
+    BOOST_CHECK_EQUAL(values.size(), 10);
+    BOOST_CHECK_LT(values.capacity(), size);
+
+    huge_page_policy::current().enabled = true;
+
+    // below min_size
+    reserve_with_huge_pages(values, huge_page_2mb / sizeof(std::uint64_t) / 2);
+    BOOST_CHECK_EQUAL(values.size(), 10);
+    BOOST_CHECK(values == std::vector<std::uint64_t>(10, 7));
+
+    // a vector without the room is emptied, then reserved
+    reserve_with_huge_pages(values, size);
+    BOOST_CHECK(values.empty());
+    BOOST_CHECK_GE(values.capacity(), size);
+    const std::uint64_t *const data = values.data();
+    for (std::size_t i = 0; i < size; ++i) {
+        values.emplace_back(i ^ 0x5555);
+    }
+    BOOST_CHECK_EQUAL(values.data(), data);
+
+    // one with the room is left with its elements
+    reserve_with_huge_pages(values, size / 2);
+    BOOST_CHECK_EQUAL(values.size(), size);
+    BOOST_CHECK_EQUAL(values.data(), data);
+    for (std::size_t i = 0; i < size; ++i) {
+        BOOST_CHECK_EQUAL(values[i], i ^ 0x5555);
+    }
+
+    // a lower min_size applies to smaller vectors
+    huge_page_policy::current().min_size = 1024;
+    std::vector<std::uint64_t> small(3, 1);
+    reserve_with_huge_pages(small, 512);
+    BOOST_CHECK(small.empty());
+    BOOST_CHECK_GE(small.capacity(), 512);
+}
+
+BOOST_AUTO_TEST_CASE(advise_huge_pages_test) {
+    // nothing to advise within a single huge page
+    std::vector<std::uint64_t> small(100, 3);
+    BOOST_CHECK(!advise_huge_pages(small));
+    BOOST_CHECK(!advise_huge_pages(small.data(), 0));
+
+    // the advice is a hint, which the kernel may refuse: the data is unchanged either way
+    test_proving_key pk;
+    const std::size_t size = 3 * huge_page_2mb / sizeof(std::uint64_t);
+    for (std::vector<std::uint64_t> *query : {&pk.A_query, &pk.B_query.values, &pk.H_query, &pk.L_query}) {
+        for (std::size_t i = 0; i < size; ++i) {
+            query->emplace_back(3 * i + 1);
+        }
+    }
+    advise_proving_key_huge_pages(pk);
+    for (const std::vector<std::uint64_t> *query : {&pk.A_query, &pk.B_query.values, &pk.H_query, &pk.L_query}) {
+        BOOST_CHECK_EQUAL(query->size(), size);
+        for (std::size_t i = 0; i < size; ++i) {
+            BOOST_CHECK_EQUAL((*query)[i], 3 * i + 1);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(huge_page_allocator_test) {
+    typedef std::vector<std::uint64_t, huge_page_allocator<std::uint64_t>> vector_type;
+
+    // sizes below a page, of exactly a page and across several, growing through both kinds of storage
+    vector_type values;
+    const std::size_t page_elements = huge_page_2mb / sizeof(std::uint64_t);
+    for (const std::size_t size : {std::size_t(1), std::size_t(1000), page_elements, 3 * page_elements + 5}) {
+        const std::size_t begin = values.size();
+        for (std::size_t i = begin; i < size; ++i) {
+            values.emplace_back(i * 77);
+        }
+        BOOST_CHECK_EQUAL(values.size(), size);
+        for (std::size_t i = 0; i < size; ++i) {
+            BOOST_CHECK_EQUAL(values[i], i * 77);
+        }
+        if (size * sizeof(std::uint64_t) >= huge_page_2mb) {
+            // the mappings are aligned on pages
+            BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(values.data()) % 4096, 0);
+        }
+    }
+
+    const vector_type copy(values);
+    BOOST_CHECK(copy == values);
+    values.resize(10);
+    values.shrink_to_fit();
+    for (std::size_t i = 0; i < 10; ++i) {
+        BOOST_CHECK_EQUAL(values[i], copy[i]);
+    }
+
+    // rebound allocators compare equal
+    const huge_page_allocator<char> chars;
+    BOOST_CHECK(huge_page_allocator<std::uint64_t>(chars) == huge_page_allocator<std::uint64_t>());
+    std::vector<char, huge_page_allocator<char>> bytes(huge_page_2mb + 1, 'x');
+    BOOST_CHECK_EQUAL(bytes.back(), 'x');
+}
+
+BOOST_AUTO_TEST_SUITE_END()
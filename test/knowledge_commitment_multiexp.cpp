@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Test of the batched fixed-base exponentiation of knowledge commitments.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE knowledge_commitment_multiexp_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/commitments/knowledge_commitment_multiexp.hpp>
+#include <nil/crypto3/zk/snark/fixed_base_engine.hpp>
+
+using namespace nil::crypto3::algebra;
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef curves::bls12<381> curve_type;
+    typedef curve_type::g1_type g1_type;
+    typedef curve_type::g2_type g2_type;
+    typedef curve_type::scalar_field_type scalar_field_type;
+    typedef scalar_field_type::value_type scalar_field_value_type;
+
+    /* kc_batch_exp of v split into the given number of chunks, against the commitments of its entries one by one */
+    bool agrees_with_naive(const std::vector<scalar_field_value_type> &v, const std::size_t chunks) {
+        const fixed_base_engine<g1_type, scalar_field_type> g1_engine(g1_type::value_type::one(), v.size() + 1);
+        const fixed_base_engine<g2_type, scalar_field_type> g2_engine(g2_type::value_type::one(), v.size() + 1);
+        const scalar_field_value_type c1 = random_element<scalar_field_type>(),
+                                      c2 = random_element<scalar_field_type>();
+
+        const knowledge_commitment_vector<g1_type, g2_type> result = kc_batch_exp<g1_type, g2_type, scalar_field_type>(
+            scalar_field_type::value_bits, g1_engine.window_size(), g2_engine.window_size(), g1_engine.table(),
+            g2_engine.table(), c1, c2, v, chunks);
+
+        std::vector<std::size_t> indices;
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            if (!v[i].is_zero()) {
+                indices.push_back(i);
+            }
+        }
+        if (result.domain_size_ != v.size() || result.indices != indices ||
+            result.values.size() != indices.size()) {
+            return false;
+        }
+        for (std::size_t k = 0; k < indices.size(); ++k) {
+            if (result.values[k].g != g1_type::value_type::one() * (c1 * v[indices[k]]) ||
+                result.values[k].h != g2_type::value_type::one() * (c2 * v[indices[k]])) {
+                return false;
+            }
+        }
+        return true;
+    }
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(knowledge_commitment_multiexp_test_suite)
+
+BOOST_AUTO_TEST_CASE(kc_batch_exp_sparse_test) {
+    // one entry in seven non-zero, more than a tile of them, and more chunks than non-zero entries
+    std::vector<scalar_field_value_type> v(500, scalar_field_value_type::zero());
+    for (std::size_t i = 3; i < v.size(); i += 7) {
+        v[i] = random_element<scalar_field_type>();
+    }
+    BOOST_CHECK(agrees_with_naive(v, 1));
+    BOOST_CHECK(agrees_with_naive(v, 3));
+    BOOST_CHECK(agrees_with_naive(v, 8));
+    BOOST_CHECK(agrees_with_naive(v, 100));
+
+    // a single non-zero entry, at either end
+    std::vector<scalar_field_value_type> first(100, scalar_field_value_type::zero());
+    first.front() = random_element<scalar_field_type>();
+    BOOST_CHECK(agrees_with_naive(first, 4));
+    std::vector<scalar_field_value_type> last(100, scalar_field_value_type::zero());
+    last.back() = random_element<scalar_field_type>();
+    BOOST_CHECK(agrees_with_naive(last, 4));
+}
+
+BOOST_AUTO_TEST_CASE(kc_batch_exp_empty_blocks_test) {
+    // 4 chunks count the non-zero entries of 32 blocks of 8: the non-zero entries fill the first two
+    // blocks and the last one, the blocks in between being empty
+    std::vector<scalar_field_value_type> v(256, scalar_field_value_type::zero());
+    for (std::size_t i = 0; i < 16; ++i) {
+        v[i] = random_element<scalar_field_type>();
+    }
+    for (std::size_t i = 248; i < v.size(); ++i) {
+        v[i] = random_element<scalar_field_type>();
+    }
+    BOOST_CHECK(agrees_with_naive(v, 4));
+    BOOST_CHECK(agrees_with_naive(v, 5));
+
+    // every other block empty, a chunk starting in an empty block
+    std::vector<scalar_field_value_type> alternating(256, scalar_field_value_type::zero());
+    for (std::size_t i = 0; i < alternating.size(); ++i) {
+        if ((i / 8) % 2) {
+            alternating[i] = random_element<scalar_field_type>();
+        }
+    }
+    BOOST_CHECK(agrees_with_naive(alternating, 4));
+    BOOST_CHECK(agrees_with_naive(alternating, 7));
+
+    // no non-zero entry at all, and no entry at all
+    BOOST_CHECK(agrees_with_naive(std::vector<scalar_field_value_type>(64, scalar_field_value_type::zero()), 4));
+    BOOST_CHECK(agrees_with_naive(std::vector<scalar_field_value_type>(), 4));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
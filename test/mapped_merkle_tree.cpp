@@ -0,0 +1,219 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE mapped_merkle_tree_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/mapped_merkle_tree.hpp>
+
+#include "temporary_path.hpp"
+#include "test_hash.hpp"
+
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef mapped_merkle_tree<test_hash> tree_type;
+    typedef flat_merkle_tree<test_hash> reference_type;
+
+    constexpr std::size_t depth = 6;
+    constexpr std::size_t value_size = 16;
+    // two levels held in memory, so paths cross from the upper nodes to the mapping
+    constexpr std::size_t memory_depth = 2;
+
+    std::vector<bool> test_value(const std::size_t i) {
+        std::vector<bool> value(value_size);
+        for (std::size_t bit = 0; bit < value_size; ++bit) {
+            value[bit] = ((7 * i + 3) >> bit) & 1;
+        }
+        return value;
+    }
+
+    /* A tree file removed, with its journal, when the test ends. */
+    struct tree_file {
+        const std::string path = temporary_path("mapped_merkle_tree");
+
+        ~tree_file() {
+            std::remove(path.c_str());
+            std::remove((path + ".journal").c_str());
+        }
+
+        std::string journal() const {
+            return path + ".journal";
+        }
+    };
+
+    void check_equal(const tree_type &tree, const reference_type &reference) {
+        BOOST_CHECK(tree.get_root() == reference.get_root());
+        for (std::size_t address = 0; address < (std::size_t(1) << depth); ++address) {
+            BOOST_CHECK(tree.get_value(address) == reference.get_value(address));
+            BOOST_CHECK(tree.get_path(address) == reference.get_path(address));
+        }
+        const std::vector<std::size_t> addresses = {0, 1, 9, 33, 62};
+        BOOST_CHECK(tree.get_multi_path(addresses) == reference.get_multi_path(addresses));
+    }
+
+    /* Writes a journal in the layout of mapped_merkle_tree: a header padded to 64 bytes, then the entries. */
+    void write_journal(const std::string &path, const std::vector<std::pair<std::uint64_t, std::uint64_t>> &entries,
+                       const bool valid_checksum = true) {
+        std::vector<unsigned char> body;
+        for (const auto &entry : entries) {
+            const unsigned char *index = reinterpret_cast<const unsigned char *>(&entry.first);
+            const unsigned char *digest = reinterpret_cast<const unsigned char *>(&entry.second);
+            body.insert(body.end(), index, index + sizeof(entry.first));
+            body.insert(body.end(), digest, digest + sizeof(entry.second));
+        }
+        std::uint64_t checksum = 0xcbf29ce484222325ULL;
+        for (const unsigned char byte : body) {
+            checksum = (checksum ^ byte) * 0x100000001b3ULL;
+        }
+        const std::uint64_t header[3] = {0x4c4e524a544d4e5aULL, entries.size(), checksum + !valid_checksum};
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        out.write(std::string(64 - sizeof(header), '\0').data(), 64 - sizeof(header));
+        out.write(reinterpret_cast<const char *>(body.data()), body.size());
+    }
+
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(mapped_merkle_tree_test_suite)
+
+BOOST_AUTO_TEST_CASE(round_trip_test) {
+    tree_file file;
+    tree_type tree(file.path, depth, value_size, memory_depth);
+    reference_type reference(depth, value_size);
+    check_equal(tree, reference);
+
+    for (const std::size_t address : {5, 0, 63, 32}) {
+        tree.set_value(address, test_value(address));
+        reference.set_value(address, test_value(address));
+    }
+    check_equal(tree, reference);
+
+    std::map<std::size_t, std::vector<bool>> batch;
+    for (std::size_t address = 8; address < 24; address += 3) {
+        batch[address] = test_value(address + 100);
+    }
+    batch[5] = test_value(1);
+    tree.set_values(batch);
+    reference.set_values(batch);
+    check_equal(tree, reference);
+    BOOST_CHECK(!std::ifstream(file.journal()).good());
+}
+
+BOOST_AUTO_TEST_CASE(reopen_test) {
+    tree_file file;
+    reference_type reference(depth, value_size);
+    {
+        tree_type tree(file.path, depth, value_size, memory_depth);
+        for (std::size_t address = 0; address < 40; address += 7) {
+            tree.set_value(address, test_value(address));
+            reference.set_value(address, test_value(address));
+        }
+    }
+
+    // reopening reads the stored nodes, whatever part of them is held in memory
+    for (const std::size_t reopened_memory_depth : {std::size_t(0), memory_depth, depth}) {
+        const tree_type tree(file.path, depth, value_size, reopened_memory_depth);
+        check_equal(tree, reference);
+    }
+
+    {
+        tree_type tree(file.path, depth, value_size, memory_depth);
+        tree.set_value(1, test_value(1));
+        reference.set_value(1, test_value(1));
+    }
+    check_equal(tree_type(file.path, depth, value_size, memory_depth), reference);
+
+    BOOST_CHECK_THROW(tree_type(file.path, depth + 1, value_size), std::runtime_error);
+    BOOST_CHECK_THROW(tree_type(file.path, depth, value_size - 1), std::runtime_error);
+
+    // a truncated file is rejected, not read past its end
+    std::ofstream(file.path, std::ios::binary | std::ios::trunc).write("ZNMETREE", 8);
+    BOOST_CHECK_THROW(tree_type(file.path, depth, value_size), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(bounds_test) {
+    tree_file file;
+    tree_type tree(file.path, depth, value_size, memory_depth);
+    const std::size_t leaves = std::size_t(1) << depth;
+
+    BOOST_CHECK_THROW(tree.get_value(leaves), std::out_of_range);
+    BOOST_CHECK_THROW(tree.get_path(leaves), std::out_of_range);
+    BOOST_CHECK_THROW(tree.get_multi_path({1, leaves}), std::out_of_range);
+    BOOST_CHECK_THROW(tree.set_value(leaves, test_value(0)), std::out_of_range);
+    BOOST_CHECK_THROW(tree.set_values({{0, test_value(0)}, {leaves, test_value(1)}}), std::out_of_range);
+
+    // nothing of a rejected batch is written
+    BOOST_CHECK(tree.get_root() == reference_type(depth, value_size).get_root());
+}
+
+BOOST_AUTO_TEST_CASE(journal_replay_test) {
+    tree_file file;
+    const std::size_t leaf = 3;
+    const std::size_t leaf_index = (std::size_t(1) << depth) - 1 + leaf;
+    std::vector<bool> replayed(value_size);
+    replayed[0] = replayed[7] = true;
+    {
+        tree_type tree(file.path, depth, value_size, memory_depth);
+    }
+
+    // a journal whose checksum does not match was torn by a crash and is dropped
+    write_journal(file.journal(), {{leaf_index, 0x81}}, false);
+    BOOST_CHECK(tree_type(file.path, depth, value_size, memory_depth).get_value(leaf) ==
+                std::vector<bool>(value_size));
+    BOOST_CHECK(!std::ifstream(file.journal()).good());
+
+    // so is one addressing a node past the end of the tree
+    const std::size_t num_nodes = (std::size_t(2) << depth) - 1;
+    write_journal(file.journal(), {{leaf_index, 0x81}, {num_nodes, 0x81}});
+    BOOST_CHECK(tree_type(file.path, depth, value_size, memory_depth).get_value(leaf) ==
+                std::vector<bool>(value_size));
+    BOOST_CHECK(!std::ifstream(file.journal()).good());
+
+    // and an empty one
+    std::ofstream(file.journal(), std::ios::binary | std::ios::trunc).close();
+    BOOST_CHECK_NO_THROW(tree_type(file.path, depth, value_size, memory_depth));
+    BOOST_CHECK(!std::ifstream(file.journal()).good());
+
+    // a whole journal is written into the tree; 0x81 is the first byte of the digest, bits 0 and 7
+    write_journal(file.journal(), {{leaf_index, 0x81}});
+    BOOST_CHECK(tree_type(file.path, depth, value_size, memory_depth).get_value(leaf) == replayed);
+    BOOST_CHECK(!std::ifstream(file.journal()).good());
+    BOOST_CHECK(tree_type(file.path, depth, value_size, memory_depth).get_value(leaf) == replayed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
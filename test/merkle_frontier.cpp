@@ -0,0 +1,150 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE merkle_frontier_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/merkle_frontier.hpp>
+
+#include "test_hash.hpp"
+
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef merkle_frontier<test_hash> frontier_type;
+    typedef flat_merkle_tree<test_hash> reference_type;
+
+    constexpr std::size_t depth = 5;
+    constexpr std::size_t value_size = 16;
+    constexpr std::size_t leaves = std::size_t(1) << depth;
+
+    std::vector<bool> test_value(const std::size_t i) {
+        std::vector<bool> value(value_size);
+        for (std::size_t bit = 0; bit < value_size; ++bit) {
+            value[bit] = ((5 * i + 11) >> bit) & 1;
+        }
+        return value;
+    }
+
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(merkle_frontier_test_suite)
+
+BOOST_AUTO_TEST_CASE(append_test) {
+    frontier_type frontier(depth, value_size);
+    reference_type reference(depth, value_size);
+    BOOST_CHECK(frontier.get_root() == reference.get_root());
+
+    // the first and last leaves, and both children of some parents, are tracked from the start
+    const std::vector<std::size_t> tracked = {0, 6, 7, 13, 16, leaves - 1};
+    for (std::size_t address = 0; address < leaves; ++address) {
+        const bool track = std::find(tracked.begin(), tracked.end(), address) != tracked.end();
+        frontier.append(frontier_type::packed_digest_type(test_value(address)), track);
+        reference.set_value(address, test_value(address));
+
+        BOOST_CHECK_EQUAL(frontier.size(), address + 1);
+        BOOST_CHECK(frontier.get_root() == reference.get_root());
+        BOOST_CHECK(frontier.get_packed_root() == reference.get_packed_root());
+        for (const std::size_t leaf : tracked) {
+            if (leaf <= address) {
+                BOOST_CHECK(frontier.get_path(leaf) == reference.get_path(leaf));
+                BOOST_CHECK(frontier.get_packed_path(leaf) == reference.get_packed_path(leaf));
+            }
+        }
+    }
+
+    BOOST_CHECK_THROW(frontier.append(frontier_type::packed_digest_type(test_value(0))), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(track_last_test) {
+    frontier_type frontier(depth, value_size);
+    reference_type reference(depth, value_size);
+    BOOST_CHECK_THROW(frontier.track_last(), std::out_of_range);
+
+    // leaves tracked after the fact, once their left siblings are only in the frontier
+    for (std::size_t address = 0; address < 21; ++address) {
+        frontier.set_value(address, test_value(address));
+        reference.set_value(address, test_value(address));
+        if (address % 4 == 3) {
+            frontier.track_last();
+        }
+    }
+    for (std::size_t leaf = 3; leaf < 21; leaf += 4) {
+        BOOST_REQUIRE(frontier.is_tracked(leaf));
+        BOOST_CHECK(frontier.get_path(leaf) == reference.get_path(leaf));
+    }
+
+    frontier.untrack(7);
+    BOOST_CHECK(!frontier.is_tracked(7));
+    BOOST_CHECK_THROW(frontier.get_path(7), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(untracked_path_test) {
+    std::vector<std::vector<bool>> contents;
+    for (std::size_t address = 0; address < 9; ++address) {
+        contents.emplace_back(test_value(address));
+    }
+    const frontier_type frontier(depth, value_size, contents);
+    const reference_type reference(depth, value_size, contents);
+    BOOST_CHECK(frontier.get_root() == reference.get_root());
+
+    BOOST_CHECK_THROW(frontier.get_packed_path(0), std::out_of_range);
+    BOOST_CHECK_THROW(frontier.get_path(8), std::out_of_range);
+    BOOST_CHECK_THROW(frontier.get_path(leaves), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(set_values_test) {
+    frontier_type frontier(depth, value_size);
+    reference_type reference(depth, value_size);
+
+    std::map<std::size_t, std::vector<bool>> batch;
+    for (std::size_t address = 0; address < 6; ++address) {
+        batch[address] = test_value(address);
+    }
+    frontier.set_values(batch);
+    reference.set_values(batch);
+    BOOST_CHECK(frontier.get_root() == reference.get_root());
+
+    // writes anywhere but at the next positions are rejected, and leave the tree as it was
+    BOOST_CHECK_THROW(frontier.set_value(7, test_value(7)), std::invalid_argument);
+    BOOST_CHECK_THROW(frontier.set_value(2, test_value(2)), std::invalid_argument);
+    BOOST_CHECK_THROW(frontier.set_values({{6, test_value(6)}, {8, test_value(8)}}), std::invalid_argument);
+    BOOST_CHECK_EQUAL(frontier.size(), 6);
+    BOOST_CHECK(frontier.get_root() == reference.get_root());
+
+    frontier.set_values({{6, test_value(6)}, {7, test_value(7)}});
+    reference.set_values({{6, test_value(6)}, {7, test_value(7)}});
+    BOOST_CHECK(frontier.get_root() == reference.get_root());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
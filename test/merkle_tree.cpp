@@ -0,0 +1,318 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE merkle_tree_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/merkle_tree.hpp>
+
+#include "test_hash.hpp"
+#include "thread_executor.hpp"
+
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef flat_merkle_tree<test_hash> flat_tree_type;
+    typedef merkle_tree<test_hash, 0, 0, 0, merkle_default_leaf::zero_digest> map_tree_type;
+
+    constexpr std::size_t value_size = 16;
+
+    std::vector<bool> test_value(const std::size_t i) {
+        std::vector<bool> value(value_size);
+        for (std::size_t bit = 0; bit < value_size; ++bit) {
+            value[bit] = ((7 * i + 3) >> bit) & 1;
+        }
+        return value;
+    }
+
+    void check_same_tree(const flat_tree_type &flat, const map_tree_type &reference,
+                         const std::vector<std::size_t> &addresses) {
+        BOOST_CHECK(flat.get_root() == reference.get_root());
+        BOOST_CHECK(flat.get_packed_root() == flat_tree_type::packed_digest_type(reference.get_root()));
+        for (const std::size_t address : addresses) {
+            BOOST_CHECK(flat.get_value(address) == reference.get_value(address));
+            BOOST_CHECK(flat.get_path(address) == reference.get_path(address));
+            BOOST_CHECK(to_bits(flat.get_packed_path(address)) == reference.get_path(address));
+        }
+    }
+
+    /*
+     * Root given by the authentication path of value at address in a tree of the given arities, computed
+     * independently of the trees: get_path lists the siblings layer after layer from the root down.
+     */
+    std::vector<bool> path_root(const std::vector<std::size_t> &arities, std::size_t address,
+                                const std::vector<bool> &value, const merkle_authentication_path &path) {
+        std::vector<bool> node = value;
+        node.resize(test_hash::get_digest_len());
+        std::size_t end = path.size();
+        for (std::size_t layer = arities.size(); layer > 0; --layer) {
+            const std::size_t arity = arities[layer - 1];
+            end -= arity - 1;
+            std::size_t j = end;
+
+            const std::size_t first_child = address - address % arity;
+            std::vector<bool> input;
+            for (std::size_t child = first_child; child < first_child + arity; ++child) {
+                const std::vector<bool> &digest = (child == address ? node : path[j++]);
+                input.insert(input.end(), digest.begin(), digest.end());
+            }
+            node = test_hash::get_hash(input);
+            address /= arity;
+        }
+        return node;
+    }
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(merkle_tree_test_suite)
+
+BOOST_AUTO_TEST_CASE(flat_tree_test) {
+    constexpr std::size_t depth = 6;
+    flat_tree_type flat(depth, value_size);
+    map_tree_type reference(depth, value_size);
+    check_same_tree(flat, reference, {0, 1, 63});
+
+    // a dense run from the start, a few far apart leaves and rewrites of earlier ones
+    const std::vector<std::size_t> addresses = {0, 1, 2, 3, 4, 40, 63, 17, 2, 0, 41};
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        flat.set_value(addresses[i], test_value(i));
+        reference.set_value(addresses[i], test_value(i));
+        check_same_tree(flat, reference, {0, 2, 5, 17, 40, 41, 62, 63});
+    }
+}
+
+BOOST_AUTO_TEST_CASE(flat_tree_sparse_test) {
+    // the leaves lie far beyond the dense prefix of their level, so they are kept in the sparse maps
+    constexpr std::size_t depth = 24;
+    flat_tree_type flat(depth, value_size);
+    map_tree_type reference(depth, value_size);
+
+    const std::vector<std::size_t> addresses = {5, (std::size_t(1) << 20) + 3, (std::size_t(1) << depth) - 1};
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        flat.set_value(addresses[i], test_value(i));
+        reference.set_value(addresses[i], test_value(i));
+    }
+    check_same_tree(flat, reference, {0, 4, 5, (std::size_t(1) << 20) + 2, (std::size_t(1) << depth) - 1});
+}
+
+BOOST_AUTO_TEST_CASE(parallel_construction_test) {
+    // more leaves than a hash batch, in a tree that is not full, so the last parents have default children
+    constexpr std::size_t depth = 10;
+    std::vector<std::vector<bool>> contents;
+    for (std::size_t i = 0; i < 700; ++i) {
+        contents.emplace_back(test_value(i));
+    }
+
+    flat_tree_type incremental(depth, value_size);
+    map_tree_type reference(depth, value_size);
+    for (std::size_t address = 0; address < contents.size(); ++address) {
+        incremental.set_value(address, contents[address]);
+        reference.set_value(address, contents[address]);
+    }
+
+    for (const std::size_t concurrency : {1, 3, 8}) {
+        const executor threads = thread_executor(concurrency);
+        executor::scope guard(threads);
+
+        const flat_tree_type flat(depth, value_size, contents);
+        check_same_tree(flat, reference, {0, 1, 255, 256, 512, 698, 699, 700, 1023});
+        BOOST_CHECK(flat.get_root() == incremental.get_root());
+
+        const map_tree_type bulk(depth, value_size, contents);
+        BOOST_CHECK(bulk.get_root() == reference.get_root());
+        BOOST_CHECK(bulk.get_path(699) == reference.get_path(699));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(set_values_test) {
+    constexpr std::size_t depth = 7;
+    flat_tree_type flat(depth, value_size);
+    map_tree_type reference(depth, value_size);
+    for (const std::size_t address : {2, 9, 64}) {
+        flat.set_value(address, test_value(address));
+        reference.set_value(address, test_value(address));
+    }
+
+    // siblings, leaves sharing upper layers only, a far one and the rewrite of a set leaf
+    const std::map<std::size_t, std::vector<bool>> batch = {
+        {8, test_value(100)}, {9, test_value(101)}, {11, test_value(102)}, {127, test_value(103)}};
+    const executor threads = thread_executor(4);
+    executor::scope guard(threads);
+    flat.set_values(batch);
+    for (const auto &content : batch) {
+        reference.set_value(content.first, content.second);
+    }
+    check_same_tree(flat, reference, {2, 8, 9, 10, 11, 64, 127});
+
+    map_tree_type batched(depth, value_size, {{2, test_value(2)}, {9, test_value(9)}, {64, test_value(64)}});
+    batched.set_values(batch);
+    BOOST_CHECK(batched.get_root() == reference.get_root());
+    BOOST_CHECK(batched.get_path(11) == reference.get_path(11));
+}
+
+BOOST_AUTO_TEST_CASE(multi_path_test) {
+    constexpr std::size_t depth = 5;
+    flat_tree_type flat(depth, value_size);
+    map_tree_type reference(depth, value_size);
+    for (std::size_t address = 0; address < 20; ++address) {
+        flat.set_value(address, test_value(address));
+        reference.set_value(address, test_value(address));
+    }
+
+    const std::vector<std::vector<std::size_t>> subsets = {{3}, {4, 5}, {12, 0, 7, 0}, {19, 31}, {0, 1, 2, 3}};
+    for (const std::vector<std::size_t> &addresses : subsets) {
+        std::map<std::size_t, std::vector<bool>> leaves;
+        for (const std::size_t address : addresses) {
+            leaves[address] = flat.get_value(address);
+        }
+
+        merkle_authentication_multi_path multi_path = flat.get_multi_path(addresses);
+        BOOST_CHECK(multi_path == reference.get_multi_path(addresses));
+        BOOST_CHECK(merkle_multi_path_root<test_hash>(depth, test_hash::get_digest_len(), leaves, multi_path) ==
+                    flat.get_root());
+
+        // the nodes the leaves share are listed once, so the multi-path is not longer than one path per leaf
+        BOOST_CHECK_LE(multi_path.size(), depth * leaves.size());
+
+        std::map<std::size_t, std::vector<bool>> wrong_leaves = leaves;
+        wrong_leaves.begin()->second = test_value(1000);
+        BOOST_CHECK(merkle_multi_path_root<test_hash>(depth, test_hash::get_digest_len(), wrong_leaves,
+                                                      multi_path) != flat.get_root());
+    }
+
+    // the multi-path of a single leaf is its path, listed from the leaves up
+    const merkle_authentication_path path = flat.get_path(13);
+    BOOST_CHECK(flat.get_multi_path({13}) == merkle_authentication_multi_path(path.rbegin(), path.rend()));
+
+    // a multi-path with a node missing or a node left over is rejected
+    const std::map<std::size_t, std::vector<bool>> leaves = {{4, flat.get_value(4)}, {5, flat.get_value(5)}};
+    merkle_authentication_multi_path short_path = flat.get_multi_path({4, 5});
+    short_path.pop_back();
+    BOOST_CHECK(merkle_multi_path_root<test_hash>(depth, test_hash::get_digest_len(), leaves, short_path).empty());
+    merkle_authentication_multi_path long_path = flat.get_multi_path({4, 5});
+    long_path.emplace_back(flat.get_root());
+    BOOST_CHECK(merkle_multi_path_root<test_hash>(depth, test_hash::get_digest_len(), leaves, long_path).empty());
+}
+
+BOOST_AUTO_TEST_CASE(arity_test) {
+    // two base layers of arity 4 under a layer of arity 3 and a top layer of arity 2
+    typedef merkle_tree<test_hash, 4, 3, 2, merkle_default_leaf::zero_digest> tree_type;
+    tree_type tree(2, value_size);
+    BOOST_CHECK(tree.arities == std::vector<std::size_t>({2, 3, 4, 4}));
+    BOOST_CHECK_EQUAL(tree.get_path(0).size(), 1 + 2 + 3 + 3);
+
+    const std::vector<std::size_t> addresses = {0, 5, 6, 47, 48, 95};
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        tree.set_value(addresses[i], test_value(i));
+    }
+    for (const std::size_t address : {0, 1, 5, 6, 47, 48, 50, 95}) {
+        BOOST_CHECK(path_root(tree.arities, address, tree.get_value(address), tree.get_path(address)) ==
+                    tree.get_root());
+    }
+
+    std::vector<std::vector<bool>> contents(96, std::vector<bool>(value_size));
+    std::map<std::size_t, std::vector<bool>> batch;
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        contents[addresses[i]] = test_value(i);
+        batch[addresses[i]] = test_value(i);
+    }
+    BOOST_CHECK(tree_type(2, value_size, contents).get_root() == tree.get_root());
+    BOOST_CHECK(tree_type(2, value_size, batch).get_root() == tree.get_root());
+
+    std::map<std::size_t, std::vector<bool>> leaves;
+    for (const std::size_t address : {5, 6, 50}) {
+        leaves[address] = tree.get_value(address);
+    }
+    BOOST_CHECK(merkle_multi_path_root<test_hash>(tree.arities, test_hash::get_digest_len(), leaves,
+                                                  tree.get_multi_path({5, 6, 50})) == tree.get_root());
+}
+
+BOOST_AUTO_TEST_CASE(empty_digest_default_test) {
+    // the default trees hash empty digests for the unset leaves, as they always have
+    merkle_tree<test_hash> tree(2, value_size);
+    tree.set_value(1, test_value(1));
+
+    std::vector<bool> leaf = test_value(1);
+    leaf.resize(test_hash::get_digest_len());
+    const std::vector<bool> left = test_hash::get_hash(leaf);
+    const std::vector<bool> right = test_hash::get_hash({});
+    std::vector<bool> input = left;
+    input.insert(input.end(), right.begin(), right.end());
+    BOOST_CHECK(tree.get_root() == test_hash::get_hash(input));
+
+    // their paths verify once every leaf is set
+    merkle_tree<test_hash, 3> full(2, value_size);
+    for (std::size_t address = 0; address < 9; ++address) {
+        full.set_value(address, test_value(address));
+    }
+    for (std::size_t address = 0; address < 9; ++address) {
+        BOOST_CHECK(path_root(full.arities, address, test_value(address), full.get_path(address)) ==
+                    full.get_root());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(packed_digest_test) {
+    typedef packed_digest<12> digest_type;
+    BOOST_CHECK_EQUAL(digest_type::bytes, 2);
+
+    std::vector<bool> bits(12);
+    bits[0] = bits[3] = bits[8] = bits[11] = true;
+    const digest_type digest(bits);
+
+    // the bits are packed most significant bit of each byte first
+    BOOST_CHECK_EQUAL(unsigned(digest.data[0]), 0x90u);
+    BOOST_CHECK_EQUAL(unsigned(digest.data[1]), 0x90u);
+    BOOST_CHECK(digest.to_bits() == bits);
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        BOOST_CHECK_EQUAL(digest.bit(i), bits[i]);
+    }
+
+    // shorter bit vectors are padded with zeros and longer ones truncated
+    const std::vector<bool> prefix(bits.begin(), bits.begin() + 5);
+    BOOST_CHECK(digest.to_bits(5) == prefix);
+    std::vector<bool> padded = prefix;
+    padded.resize(12);
+    BOOST_CHECK(digest_type(prefix).to_bits() == padded);
+    std::vector<bool> longer = bits;
+    longer.resize(20, true);
+    BOOST_CHECK(digest_type(longer) == digest);
+    std::vector<bool> extended = bits;
+    extended.resize(16);
+    BOOST_CHECK(digest.to_bits(16) == extended);
+
+    BOOST_CHECK(digest_type(prefix) != digest);
+    BOOST_CHECK(digest_type() == digest_type(std::vector<bool>(12)));
+
+    const std::vector<digest_type> digests = {digest, digest_type(prefix)};
+    BOOST_CHECK(to_bits(digests) == std::vector<std::vector<bool>>({bits, padded}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
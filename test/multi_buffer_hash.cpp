@@ -0,0 +1,197 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE multi_buffer_hash_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/multi_buffer_hash.hpp>
+
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    std::vector<bool> to_bits(const std::string &message) {
+        std::vector<bool> bits;
+        for (const char c : message) {
+            for (std::size_t i = 0; i < 8; ++i) {
+                bits.push_back((std::uint8_t(c) >> (7 - i)) & 1);
+            }
+        }
+        return bits;
+    }
+
+    std::string to_hex(const std::vector<bool> &digest) {
+        static const char digits[] = "0123456789abcdef";
+        std::string result;
+        for (std::size_t i = 0; i < digest.size(); i += 4) {
+            result += digits[digest[i] << 3 | digest[i + 1] << 2 | digest[i + 2] << 1 | digest[i + 3]];
+        }
+        return result;
+    }
+
+    // a one-message SHA-256 of a bit string, padded bit by bit, as an independent reference for the lanes
+    std::vector<bool> reference_sha256(std::vector<bool> message) {
+        static const std::uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        const auto rotr = [](const std::uint32_t x, const unsigned n) { return (x >> n) | (x << (32 - n)); };
+
+        const std::uint64_t length = message.size();
+        message.push_back(true);
+        while (message.size() % 512 != 448) {
+            message.push_back(false);
+        }
+        for (std::size_t i = 64; i-- > 0;) {
+            message.push_back((length >> i) & 1);
+        }
+
+        std::uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        for (std::size_t block = 0; block < message.size(); block += 512) {
+            std::uint32_t w[64] = {};
+            for (std::size_t i = 0; i < 512; ++i) {
+                w[i / 32] |= std::uint32_t(message[block + i]) << (31 - i % 32);
+            }
+            for (std::size_t t = 16; t < 64; ++t) {
+                w[t] = w[t - 16] + (rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3)) + w[t - 7] +
+                       (rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10));
+            }
+            std::uint32_t v[8];
+            std::copy(h, h + 8, v);
+            for (std::size_t t = 0; t < 64; ++t) {
+                const std::uint32_t t1 = v[7] + (rotr(v[4], 6) ^ rotr(v[4], 11) ^ rotr(v[4], 25)) +
+                                         ((v[4] & v[5]) ^ (~v[4] & v[6])) + k[t] + w[t];
+                const std::uint32_t t2 =
+                    (rotr(v[0], 2) ^ rotr(v[0], 13) ^ rotr(v[0], 22)) + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+                std::copy_backward(v, v + 7, v + 8);
+                v[4] += t1;
+                v[0] = t1 + t2;
+            }
+            for (std::size_t i = 0; i < 8; ++i) {
+                h[i] += v[i];
+            }
+        }
+
+        std::vector<bool> digest(256);
+        for (std::size_t i = 0; i < 256; ++i) {
+            digest[i] = (h[i / 32] >> (31 - i % 32)) & 1;
+        }
+        return digest;
+    }
+
+    std::vector<bool> test_message(const std::size_t bits, const std::size_t seed) {
+        std::vector<bool> message(bits);
+        std::uint64_t state = 0x9e3779b97f4a7c15ULL * (seed + 1);
+        for (std::size_t i = 0; i < bits; ++i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            message[i] = state & 1;
+        }
+        return message;
+    }
+
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(multi_buffer_hash_test_suite)
+
+BOOST_AUTO_TEST_CASE(sha256_multi_buffer_known_answer_test) {
+    BOOST_CHECK_EQUAL(to_hex(sha256_multi_buffer::get_hash(to_bits(""))),
+                      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    BOOST_CHECK_EQUAL(to_hex(sha256_multi_buffer::get_hash(to_bits("abc"))),
+                      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    // 448 bits, so the padding takes a block of its own
+    BOOST_CHECK_EQUAL(
+        to_hex(sha256_multi_buffer::get_hash(to_bits("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"))),
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    BOOST_CHECK_EQUAL(to_hex(sha256_multi_buffer::get_hash(to_bits(std::string(1000000, 'a')))),
+                      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+    BOOST_CHECK_EQUAL(to_hex(reference_sha256(to_bits("abc"))),
+                      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+BOOST_AUTO_TEST_CASE(sha256_multi_buffer_padding_boundaries_test) {
+    // around the lengths at which the padding spills into another block, including lengths that are not
+    // a multiple of 8 bits
+    for (const std::size_t bits : {1, 7, 9, 255, 446, 447, 448, 449, 455, 456, 504, 511, 512, 513, 959, 960, 1023,
+                                   1024, 1025, 1471, 1472}) {
+        const std::vector<bool> message = test_message(bits, bits);
+        BOOST_CHECK_MESSAGE(sha256_multi_buffer::get_hash(message) == reference_sha256(message),
+                            "message of " << bits << " bits");
+    }
+    for (std::size_t bits = 0; bits <= 2 * 512 + 8; ++bits) {
+        const std::vector<bool> message = test_message(bits, 0);
+        BOOST_CHECK_MESSAGE(sha256_multi_buffer::get_hash(message) == reference_sha256(message),
+                            "message of " << bits << " bits");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sha256_multi_buffer_lanes_test) {
+    // every number of messages up to a few groups of lanes, so every partial group is hashed, with
+    // messages of different numbers of blocks side by side
+    for (std::size_t count = 1; count <= 3 * multi_buffer_lanes + 1; ++count) {
+        std::vector<std::vector<bool>> messages;
+        for (std::size_t i = 0; i < count; ++i) {
+            messages.emplace_back(test_message((97 * i + 31 * count) % 1500, i));
+        }
+        const std::vector<std::vector<bool>> digests = sha256_multi_buffer::get_hashes(messages);
+        BOOST_REQUIRE_EQUAL(digests.size(), count);
+        for (std::size_t i = 0; i < count; ++i) {
+            BOOST_CHECK_MESSAGE(digests[i] == reference_sha256(messages[i]),
+                                "message " << i << " of " << count);
+        }
+    }
+    BOOST_CHECK(sha256_multi_buffer::get_hashes({}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(multi_buffer_hash_each_test) {
+    const std::size_t n = 5 * detail::multi_buffer_batch_size<sha256_multi_buffer>() + 3;
+    std::vector<std::vector<bool>> messages;
+    for (std::size_t i = 0; i < n; ++i) {
+        messages.emplace_back(test_message(i % 700, i));
+    }
+    std::vector<std::vector<bool>> digests(n);
+    multi_buffer_hash_each<sha256_multi_buffer>(
+        n, [&](const std::size_t i) -> const std::vector<bool> & { return messages[i]; },
+        [&](const std::size_t i, std::vector<bool> digest) { digests[i] = std::move(digest); });
+    for (std::size_t i = 0; i < n; ++i) {
+        BOOST_CHECK(digests[i] == reference_sha256(messages[i]));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
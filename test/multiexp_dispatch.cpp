@@ -0,0 +1,192 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Test of the dispatcher choosing the multi-exponentiation method of every call.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE multiexp_dispatch_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/multiexp/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/execution_policy.hpp>
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+
+using namespace nil::crypto3::algebra;
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef curves::bls12<381> curve_type;
+    typedef curve_type::g1_type::value_type g1_value_type;
+    typedef curve_type::scalar_field_type scalar_field_type;
+    typedef scalar_field_type::value_type scalar_field_value_type;
+
+    /* installs small thresholds as the current ones of G1 for the duration of a test */
+    struct small_tuning_fixture {
+        small_tuning_fixture() : previous(multiexp_tuning<g1_value_type>::current()) {
+            multiexp_tuning<g1_value_type> &tuning = multiexp_tuning<g1_value_type>::current();
+            tuning.naive_max_terms = 2;
+            tuning.bos_coster_max_terms = 8;
+            tuning.min_terms_per_chunk = 4;
+            tuning.batch_affine_min_terms = 16;
+        }
+
+        ~small_tuning_fixture() {
+            multiexp_tuning<g1_value_type>::current() = previous;
+        }
+
+        multiexp_tuning<g1_value_type> previous;
+    };
+
+    /* n random terms, of which the first num_trivial scalars alternate between zero and one */
+    struct random_terms {
+        random_terms(const std::size_t n, const std::size_t num_trivial) : bases(n), scalars(n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                bases[i] = g1_value_type::one() * random_element<scalar_field_type>();
+                scalars[i] = i >= num_trivial ? random_element<scalar_field_type>() :
+                             i % 2            ? scalar_field_value_type::one() :
+                                                scalar_field_value_type::zero();
+            }
+        }
+
+        multiexp_plan plan(const std::size_t chunks) const {
+            return plan_multiexp<multiexp_method_auto, g1_value_type>(scalars.begin(), scalars.end(), chunks);
+        }
+
+        /* the dispatched call, plain and with mixed addition, against a naive one */
+        bool agrees_with_naive(const std::size_t chunks) const {
+            const g1_value_type expected = dispatch_multiexp<policies::multiexp_method_naive_plain>(
+                bases.begin(), bases.end(), scalars.begin(), scalars.end(), 1);
+            return dispatch_multiexp<multiexp_method_auto>(bases.begin(), bases.end(), scalars.begin(),
+                                                           scalars.end(), chunks) == expected &&
+                   dispatch_multiexp_with_mixed_addition<multiexp_method_auto>(
+                       bases.begin(), bases.end(), scalars.begin(), scalars.end(), chunks) == expected;
+        }
+
+        multiexp_plan constant_time_plan(const std::size_t chunks) const {
+            return plan_multiexp<constant_time_execution::multiexp_method, g1_value_type>(scalars.begin(),
+                                                                                           scalars.end(), chunks);
+        }
+
+        /* the call of the constant-time policy against the one of the variable-time policy */
+        bool constant_time_agrees(const std::size_t chunks) const {
+            return dispatch_multiexp<constant_time_execution::multiexp_method>(
+                       bases.begin(), bases.end(), scalars.begin(), scalars.end(), chunks) ==
+                   dispatch_multiexp<variable_time_execution::multiexp_method>(
+                       bases.begin(), bases.end(), scalars.begin(), scalars.end(), chunks);
+        }
+
+        std::vector<g1_value_type> bases;
+        std::vector<scalar_field_value_type> scalars;
+    };
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(multiexp_dispatch_test_suite)
+
+BOOST_AUTO_TEST_CASE(multiexp_tuning_plan_test) {
+    const multiexp_tuning<g1_value_type> tuning;
+
+    // the bounds of every method, on a single chunk
+    BOOST_CHECK(tuning.plan(4, 4, 1).algorithm == multiexp_algorithm::naive);
+    BOOST_CHECK(tuning.plan(5, 5, 1).algorithm == multiexp_algorithm::bos_coster);
+    BOOST_CHECK(tuning.plan(1024, 1024, 1).algorithm == multiexp_algorithm::bos_coster);
+    BOOST_CHECK(tuning.plan(1025, 1025, 1).algorithm == multiexp_algorithm::BDLO12);
+    BOOST_CHECK(tuning.plan(1 << 14, 1 << 14, 1).algorithm == multiexp_algorithm::batch_affine);
+
+    // the trivial terms neither count for the method nor for the chunks
+    BOOST_CHECK(tuning.plan(1 << 20, 4, 8).algorithm == multiexp_algorithm::naive);
+    BOOST_CHECK(tuning.plan(1 << 20, 4, 8).chunks == 1);
+
+    // a chunk per min_terms_per_chunk non-trivial terms, at most max_chunks of them
+    BOOST_CHECK(tuning.plan(4096, 4096, 8).chunks == 4);
+    BOOST_CHECK(tuning.plan(4096, 4096, 3).chunks == 3);
+
+    // the batched affine additions only take chunks of batch_affine_min_terms terms
+    BOOST_CHECK(tuning.plan(1 << 15, 1 << 15, 2).algorithm == multiexp_algorithm::batch_affine);
+    BOOST_CHECK(tuning.plan(1 << 15, 1 << 15, 4).algorithm == multiexp_algorithm::BDLO12);
+    BOOST_CHECK(tuning.plan(1 << 15, 1 << 15, 4).chunks == 4);
+}
+
+// every method the current thresholds choose, on few enough terms to check them all
+BOOST_FIXTURE_TEST_CASE(multiexp_dispatch_path_test, small_tuning_fixture) {
+    const random_terms naive_terms(2, 0), bos_coster_terms(8, 0), BDLO12_terms(24, 0), batch_affine_terms(40, 0);
+    BOOST_CHECK(naive_terms.plan(4).algorithm == multiexp_algorithm::naive);
+    BOOST_CHECK(bos_coster_terms.plan(4).algorithm == multiexp_algorithm::bos_coster);
+    BOOST_CHECK(BDLO12_terms.plan(4).algorithm == multiexp_algorithm::BDLO12);
+    BOOST_CHECK(BDLO12_terms.plan(4).chunks == 4);
+    BOOST_CHECK(batch_affine_terms.plan(2).algorithm == multiexp_algorithm::batch_affine);
+    BOOST_CHECK(batch_affine_terms.plan(2).chunks == 2);
+
+    // the zeros and ones of a long call leave it to the method of its non-trivial terms
+    const random_terms sparse_terms(40, 38);
+    BOOST_CHECK(sparse_terms.plan(4).algorithm == multiexp_algorithm::naive);
+    BOOST_CHECK(sparse_terms.plan(4).chunks == 1);
+
+    for (const random_terms *t : {&naive_terms, &bos_coster_terms, &BDLO12_terms, &batch_affine_terms, &sparse_terms}) {
+        BOOST_CHECK(t->agrees_with_naive(1));
+        BOOST_CHECK(t->agrees_with_naive(2));
+        BOOST_CHECK(t->agrees_with_naive(4));
+    }
+}
+
+// the constant-time policy plans a call from its length alone, for the result of the variable-time one
+BOOST_FIXTURE_TEST_CASE(constant_time_multiexp_test, small_tuning_fixture) {
+    BOOST_CHECK((std::is_same<constant_time_execution::multiexp_method, multiexp_method_uniform>::value));
+    BOOST_CHECK((std::is_same<variable_time_execution::multiexp_method, multiexp_method_auto>::value));
+
+    // the zeros and ones count as terms, so a sparse call takes the plan of a dense one
+    const random_terms sparse_terms(40, 38), dense_terms(40, 0);
+    BOOST_CHECK(sparse_terms.plan(4).algorithm == multiexp_algorithm::naive);
+    BOOST_CHECK(sparse_terms.constant_time_plan(4).algorithm == multiexp_algorithm::BDLO12);
+    BOOST_CHECK(sparse_terms.constant_time_plan(4).chunks == 4);
+    BOOST_CHECK(dense_terms.constant_time_plan(4).algorithm == multiexp_algorithm::BDLO12);
+    BOOST_CHECK(dense_terms.constant_time_plan(4).chunks == 4);
+
+    // nor does it take the batched affine additions
+    BOOST_CHECK(dense_terms.plan(2).algorithm == multiexp_algorithm::batch_affine);
+    BOOST_CHECK(dense_terms.constant_time_plan(2).algorithm == multiexp_algorithm::BDLO12);
+    BOOST_CHECK(dense_terms.constant_time_plan(2).chunks == 2);
+
+    const random_terms short_terms(6, 4);
+    BOOST_CHECK(short_terms.plan(1).algorithm == multiexp_algorithm::naive);
+    BOOST_CHECK(short_terms.constant_time_plan(1).algorithm == multiexp_algorithm::bos_coster);
+
+    for (const random_terms *t : {&sparse_terms, &dense_terms, &short_terms}) {
+        BOOST_CHECK(t->constant_time_agrees(1));
+        BOOST_CHECK(t->constant_time_agrees(2));
+        BOOST_CHECK(t->constant_time_agrees(4));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,207 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE numa_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/numa.hpp>
+
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+    /* A topology of nodes of the given number of processors each, without pinning. */
+    numa_topology unpinned_topology(const std::vector<std::size_t> &node_sizes) {
+        numa_topology result;
+        result.node_ids.clear();
+        result.cpus.clear();
+        for (std::size_t node = 0; node < node_sizes.size(); ++node) {
+            result.node_ids.emplace_back(int(node));
+            result.cpus.emplace_back(node_sizes[node], -1);
+        }
+        return result;
+    }
+
+    /* The tasks of a bulk call in the order each thread ran them. */
+    struct task_log {
+        std::mutex mutex;
+        std::map<std::thread::id, std::vector<std::size_t>> tasks;
+
+        void add(const std::size_t task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks[std::this_thread::get_id()].emplace_back(task);
+        }
+    };
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(numa_test_suite)
+
+BOOST_AUTO_TEST_CASE(numa_topology_test) {
+    const numa_topology single(6);
+    BOOST_CHECK_EQUAL(single.num_nodes(), 1);
+    BOOST_CHECK_EQUAL(single.concurrency(), 6);
+    BOOST_CHECK_EQUAL(numa_topology(0).concurrency(), 1);
+    BOOST_CHECK_EQUAL(single.node_of(0.99), 0);
+
+    const numa_topology nodes = unpinned_topology({2, 3, 1, 2});
+    BOOST_CHECK_EQUAL(nodes.num_nodes(), 4);
+    BOOST_CHECK_EQUAL(nodes.concurrency(), 8);
+    BOOST_CHECK_EQUAL(nodes.node_of(0.0), 0);
+    BOOST_CHECK_EQUAL(nodes.node_of(0.2499), 0);
+    BOOST_CHECK_EQUAL(nodes.node_of(0.25), 1);
+    BOOST_CHECK_EQUAL(nodes.node_of(0.6), 2);
+    BOOST_CHECK_EQUAL(nodes.node_of(0.99), 3);
+    // positions outside [0, 1) go to the first and the last nodes
+    BOOST_CHECK_EQUAL(nodes.node_of(-0.5), 0);
+    BOOST_CHECK_EQUAL(nodes.node_of(1.0), 3);
+    BOOST_CHECK_EQUAL(nodes.node_of(7.0), 3);
+
+    const numa_topology host = numa_topology::detect();
+    BOOST_CHECK_GE(host.num_nodes(), 1);
+    BOOST_CHECK_EQUAL(host.cpus.size(), host.num_nodes());
+    for (const std::vector<int> &node_cpus : host.cpus) {
+        BOOST_CHECK(!node_cpus.empty());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(numa_pool_bulk_test) {
+    numa_pool pool(unpinned_topology({2, 3}));
+    BOOST_CHECK_EQUAL(pool.get().concurrency(), 5);
+
+    // every task runs once, over consecutive calls of the same pool
+    for (const std::size_t n : {0, 1, 2, 5, 1000}) {
+        std::vector<std::atomic<std::size_t>> runs(n);
+        for (std::atomic<std::size_t> &r : runs) {
+            r = 0;
+        }
+        pool.get().bulk(n, [&](const std::size_t i) { ++runs[i]; });
+        for (std::size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(runs[i], 1);
+        }
+    }
+
+    // through the current executor, with parallel_for splitting the range
+    std::vector<std::size_t> values(777, 0);
+    std::atomic<std::size_t> nested_concurrency(0);
+    {
+        executor::scope guard(pool.get());
+        executor::current().parallel_for(values.size(), [&](const std::size_t i) {
+            values[i] = 3 * i + 1;
+            nested_concurrency += executor::current().concurrency();
+        });
+    }
+    // the tasks see the sequential executor
+    BOOST_CHECK_EQUAL(nested_concurrency, values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        BOOST_CHECK_EQUAL(values[i], 3 * i + 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(numa_pool_placement_test) {
+    // two nodes of two workers: a worker runs the tasks of its own node, in their order, before those
+    // of the other node
+    const numa_topology topology = unpinned_topology({2, 2});
+    numa_pool pool(topology);
+
+    constexpr std::size_t n = 400;
+    std::vector<double> positions(n);
+    std::vector<std::size_t> nodes(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        // interleaved, with positions outside [0, 1) clamped to the nearest node
+        const std::size_t node = (i * 7) % 3 == 0 ? 1 : 0;
+        positions[i] = node ? 0.5 + (i % 5) * 0.1 + (i % 11 == 0 ? 1.0 : 0.0) :
+                              (i % 5) * 0.1 - (i % 13 == 0 ? 1.0 : 0.0);
+        nodes[i] = node;
+    }
+
+    for (std::size_t round = 0; round < 20; ++round) {
+        task_log log;
+        std::vector<std::atomic<std::size_t>> runs(n);
+        for (std::atomic<std::size_t> &r : runs) {
+            r = 0;
+        }
+        pool.get().bulk(
+            n,
+            [&](const std::size_t i) {
+                ++runs[i];
+                log.add(i);
+            },
+            positions);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(runs[i], 1);
+        }
+        for (const auto &thread_tasks : log.tasks) {
+            const std::vector<std::size_t> &tasks = thread_tasks.second;
+            std::size_t switches = 0;
+            for (std::size_t t = 1; t < tasks.size(); ++t) {
+                if (nodes[tasks[t]] != nodes[tasks[t - 1]]) {
+                    ++switches;
+                } else {
+                    // the tasks of a node are taken in increasing order
+                    BOOST_CHECK_LT(tasks[t - 1], tasks[t]);
+                }
+            }
+            BOOST_CHECK_LE(switches, 1);
+        }
+    }
+
+    // the executors without placement ignore the positions
+    std::vector<std::size_t> runs(n, 0);
+    executor::sequential().bulk(n, [&](const std::size_t i) { ++runs[i]; }, positions);
+    BOOST_CHECK(runs == std::vector<std::size_t>(n, 1));
+}
+
+BOOST_AUTO_TEST_CASE(place_on_nodes_test) {
+    std::vector<std::size_t> values(1 << 16);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = i * i;
+    }
+
+    // nothing to place on a single node or for an empty vector
+    BOOST_CHECK(!place_on_nodes(values, numa_topology(4)));
+    BOOST_CHECK(!place_on_nodes(std::vector<std::size_t>(), unpinned_topology({1, 1})));
+    // nor within a single page, nor on a node out of the masks
+    BOOST_CHECK(!place_on_node(values.data(), 16, 0));
+    BOOST_CHECK(!place_on_node(values.data(), values.size() * sizeof(std::size_t), -1));
+    BOOST_CHECK(!place_on_node(values.data(), values.size() * sizeof(std::size_t), numa_topology::max_nodes));
+
+    // the placement is a hint: whether or not the host has the nodes, the values are unchanged
+    place_on_nodes(values, unpinned_topology({1, 1}));
+    place_on_nodes(values, numa_topology::detect());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        BOOST_CHECK_EQUAL(values[i], i * i);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
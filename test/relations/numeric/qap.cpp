@@ -29,13 +29,24 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <initializer_list>
+#include <utility>
 #include <vector>
 #include <chrono>
 
+#include <nil/crypto3/zk/snark/memory_arena.hpp>
 #include <nil/crypto3/zk/snark/reductions/r1cs_to_qap.hpp>
+#include <nil/crypto3/zk/snark/reductions/r1cs_to_qap_fft_backend.hpp>
+#include <nil/crypto3/zk/snark/relations/arithmetic_programs/qap_witness_buffer.hpp>
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_bytecode.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_digest.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_optimizer.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs_witness_program.hpp>
+#include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/static_r1cs.hpp>
 
 #include <nil/crypto3/algebra/random_element.hpp>
 #include <nil/crypto3/algebra/curves/mnt4.hpp>
@@ -52,10 +63,90 @@
 #include <nil/crypto3/algebra/curves/params/wnaf/mnt6.hpp>
 
 #include "../../schemes/ppzksnark/r1cs_examples.hpp"
+#include "../../thread_executor.hpp"
 
 using namespace nil::crypto3::zk::snark;
 using namespace nil::crypto3::algebra;
 
+namespace {
+
+    /* the first constraint of cs that the assignment violates, checked one by one */
+    template<typename FieldType>
+    std::size_t sequential_first_unsatisfied_constraint(const r1cs_constraint_system<FieldType> &cs,
+                                                        const r1cs_primary_input<FieldType> &primary_input,
+                                                        const r1cs_auxiliary_input<FieldType> &auxiliary_input) {
+        r1cs_variable_assignment<FieldType> assignment = primary_input;
+        assignment.insert(assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+        for (std::size_t i = 0; i < cs.num_constraints(); ++i) {
+            const r1cs_constraint<FieldType> &constraint = cs.constraints[i];
+            if (constraint.a.evaluate(assignment) * constraint.b.evaluate(assignment) !=
+                constraint.c.evaluate(assignment)) {
+                return i;
+            }
+        }
+        return cs.num_constraints();
+    }
+
+    /* an example of num_constraints constraints over num_inputs inputs, bits or field elements */
+    template<typename FieldType>
+    r1cs_example<FieldType> make_example(const std::size_t num_constraints, const std::size_t num_inputs,
+                                         const bool binary_input) {
+        return binary_input ? generate_r1cs_example_with_binary_input<FieldType>(num_constraints, num_inputs) :
+                              generate_r1cs_example_with_field_input<FieldType>(num_constraints, num_inputs);
+    }
+
+    /* an example with a random zero-knowledge patch d1, d2, d3 and its witness map by the default backend */
+    template<typename FieldType>
+    struct patched_qap_example : r1cs_example<FieldType> {
+        patched_qap_example(const std::size_t num_constraints, const std::size_t num_inputs,
+                            const bool binary_input) :
+            r1cs_example<FieldType>(make_example<FieldType>(num_constraints, num_inputs, binary_input)),
+            d1(random_element<FieldType>()), d2(random_element<FieldType>()), d3(random_element<FieldType>()),
+            qap_wit(reductions::r1cs_to_qap<FieldType>::witness_map(this->constraint_system, this->primary_input,
+                                                                    this->auxiliary_input, d1, d2, d3)) {
+        }
+
+        typename FieldType::value_type d1, d2, d3;
+        qap_witness<FieldType> qap_wit;
+    };
+
+    /* an example and a field input one over a larger domain, with their witness maps without patch */
+    template<typename FieldType>
+    struct mixed_domain_examples {
+        typedef reductions::r1cs_to_qap<FieldType> reduction_type;
+
+        mixed_domain_examples(const std::size_t num_constraints, const std::size_t num_inputs,
+                              const bool binary_input) :
+            example(make_example<FieldType>(num_constraints, num_inputs, binary_input)),
+            other_example(generate_r1cs_example_with_field_input<FieldType>(4 * (num_constraints + num_inputs + 1),
+                                                                             num_inputs)),
+            domain_size(reduction_type::get_domain(example.constraint_system)->m),
+            other_domain_size(reduction_type::get_domain(other_example.constraint_system)->m),
+            qap_wit(unpatched_witness_map(example)), other_qap_wit(unpatched_witness_map(other_example)) {
+        }
+
+        static qap_witness<FieldType> unpatched_witness_map(const r1cs_example<FieldType> &example) {
+            return reduction_type::witness_map(example.constraint_system, example.primary_input,
+                                               example.auxiliary_input,
+                                               reduction_type::make_context(example.constraint_system));
+        }
+
+        r1cs_example<FieldType> example, other_example;
+        std::size_t domain_size, other_domain_size;
+        qap_witness<FieldType> qap_wit, other_qap_wit;
+    };
+
+    /* the QAP degrees of the basic domain of FieldType, of a step one, of the extended one and just below it */
+    template<typename FieldType>
+    std::vector<std::size_t> test_qap_degrees() {
+        const std::size_t basic_domain_size = std::size_t(1) << fields::arithmetic_params<FieldType>::s;
+        const std::size_t step_domain_size = (std::size_t(1) << 10) + (std::size_t(1) << 8);
+        const std::size_t extended_domain_size = std::size_t(1) << (fields::arithmetic_params<FieldType>::s + 1);
+        return {basic_domain_size, step_domain_size, extended_domain_size, extended_domain_size - 1};
+    }
+
+}    // namespace
+
 template<typename FieldType>
 void test_qap(const std::size_t qap_degree, const std::size_t num_inputs, const bool binary_input) {
     /*
@@ -126,27 +217,853 @@ void test_qap(const std::size_t qap_degree, const std::size_t num_inputs, const
     BOOST_CHECK(qap_inst_2.is_satisfied(qap_wit));
 }
 
+template<typename FieldType>
+void test_qap_six_step_fft_backend(const std::size_t qap_degree, const std::size_t num_inputs,
+                                   const bool binary_input) {
+    typedef reductions::fft_file_storage<typename FieldType::value_type> storage_type;
+    typedef reductions::r1cs_to_qap_six_step_fft_backend<FieldType, storage_type, 16> six_step_backend_type;
+    typedef reductions::r1cs_to_qap<FieldType, six_step_backend_type> six_step_reduction_type;
+
+    // the out-of-core backend maps to the witness of the default one
+    const patched_qap_example<FieldType> example(qap_degree - num_inputs - 1, num_inputs, binary_input);
+    const qap_witness<FieldType> six_step_qap_wit =
+        six_step_reduction_type::witness_map(example.constraint_system, example.primary_input,
+                                             example.auxiliary_input, example.d1, example.d2, example.d3);
+    BOOST_CHECK(six_step_qap_wit.coefficients_for_H == example.qap_wit.coefficients_for_H);
+}
+
+template<typename FieldType>
+void test_qap_reduction_context(const std::size_t qap_degree, const std::size_t num_inputs, const bool binary_input) {
+    // the domain and coset tables of a context map to the witness of a call building its own
+    const patched_qap_example<FieldType> example(qap_degree - num_inputs - 1, num_inputs, binary_input);
+    const reductions::reduction_context<FieldType> context =
+        reductions::r1cs_to_qap<FieldType>::make_context(example.constraint_system);
+    const qap_witness<FieldType> context_qap_wit =
+        reductions::r1cs_to_qap<FieldType>::witness_map(example.constraint_system, example.primary_input,
+                                                        example.auxiliary_input, example.d1, example.d2,
+                                                        example.d3, context);
+    BOOST_CHECK(context_qap_wit.coefficients_for_H == example.qap_wit.coefficients_for_H);
+}
+
+template<typename FieldType>
+void test_qap_unpatched_witness_map(const std::size_t num_constraints, const std::size_t num_inputs,
+                                    const bool binary_input) {
+    typedef reductions::r1cs_to_qap<FieldType> reduction_type;
+    typedef reductions::fft_file_storage<typename FieldType::value_type> storage_type;
+    typedef reductions::r1cs_to_qap_six_step_fft_backend<FieldType, storage_type, 16> six_step_backend_type;
+
+    const r1cs_example<FieldType> example = make_example<FieldType>(num_constraints, num_inputs, binary_input);
+    const qap_instance_evaluation<FieldType> qap_inst = reduction_type::instance_map_with_evaluation(
+        example.constraint_system, random_element<FieldType>());
+    const reductions::reduction_context<FieldType> context = reduction_type::make_context(example.constraint_system);
+    const std::size_t m = context.domain()->m;
+
+    // the witness map without the zero-knowledge patch is the one with d1 = d2 = d3 = 0, in both backends
+    const typename FieldType::value_type zero = FieldType::value_type::zero();
+    const qap_witness<FieldType> unpatched_qap_wit = reduction_type::witness_map(
+        example.constraint_system, example.primary_input, example.auxiliary_input, context);
+    BOOST_CHECK(qap_inst.is_satisfied(unpatched_qap_wit));
+    BOOST_CHECK(unpatched_qap_wit.coefficients_for_H ==
+                reduction_type::witness_map(example.constraint_system, example.primary_input,
+                                            example.auxiliary_input, zero, zero, zero, context)
+                    .coefficients_for_H);
+    BOOST_CHECK(unpatched_qap_wit.coefficients_for_H ==
+                reductions::r1cs_to_qap<FieldType, six_step_backend_type>::witness_map(
+                    example.constraint_system, example.primary_input, example.auxiliary_input)
+                    .coefficients_for_H);
+
+    // H is copied out of the workspace, which keeps its three buffers from one call to the next
+    typename reduction_type::workspace scratch;
+    for (std::size_t call = 0; call < 2; ++call) {
+        const qap_witness<FieldType> scratch_qap_wit = reduction_type::witness_map(
+            example.constraint_system, example.primary_input, example.auxiliary_input, context, scratch);
+        BOOST_CHECK(scratch_qap_wit.coefficients_for_H == unpatched_qap_wit.coefficients_for_H);
+        BOOST_CHECK_GE(scratch.aA.capacity(), m + 1);
+        BOOST_CHECK_GE(scratch.aB.capacity(), m);
+        BOOST_CHECK_GE(scratch.aC.capacity(), m);
+    }
+    const std::size_t workspace_size = scratch.size_in_bits();
+
+    const std::vector<typename FieldType::value_type> evaluations = reduction_type::evaluations_for_H_on_coset(
+        example.constraint_system, unpatched_qap_wit.coefficients_for_ABCs, context, scratch);
+    BOOST_CHECK_EQUAL(evaluations.size(), m);
+    BOOST_CHECK(std::equal(evaluations.begin(), evaluations.end(), scratch.aA.begin(), scratch.aA.end()));
+    BOOST_CHECK(reduction_type::evaluations_for_H_on_coset(example.constraint_system,
+                                                           unpatched_qap_wit.coefficients_for_ABCs, context,
+                                                           scratch) == evaluations);
+    BOOST_CHECK_EQUAL(scratch.size_in_bits(), workspace_size);
+}
+
+template<typename FieldType>
+void test_qap_batch_witness_map(const std::size_t num_constraints, const std::size_t num_inputs,
+                                const bool binary_input) {
+    typedef reductions::r1cs_to_qap<FieldType> reduction_type;
+
+    const mixed_domain_examples<FieldType> examples(num_constraints, num_inputs, binary_input);
+    const r1cs_example<FieldType> &example = examples.example, &other_example = examples.other_example;
+
+    // systems of the same domain size share a pooled context
+    const r1cs_witness_program<FieldType> program(example.constraint_system);
+    BOOST_CHECK(reduction_type::shared_context(example.constraint_system) == reduction_type::shared_context(program));
+
+    // a batch maps to the witnesses of its requests, mixing two domain sizes, each with a context of its own size
+    BOOST_REQUIRE(examples.domain_size != examples.other_domain_size);
+    typedef typename reduction_type::witness_request witness_request;
+    const witness_request request {&example.constraint_system, example.primary_input, example.auxiliary_input};
+    const witness_request other_request {&other_example.constraint_system, other_example.primary_input,
+                                         other_example.auxiliary_input};
+    const std::vector<witness_request> requests = {request, other_request, request, other_request, other_request};
+    const std::vector<qap_witness<FieldType>> batch_qap_wits = reduction_type::batch_witness_map(requests);
+    BOOST_REQUIRE_EQUAL(batch_qap_wits.size(), requests.size());
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        BOOST_CHECK(batch_qap_wits[i].coefficients_for_H == (requests[i].cs == &example.constraint_system ?
+                                                                 examples.qap_wit.coefficients_for_H :
+                                                                 examples.other_qap_wit.coefficients_for_H));
+    }
+}
+
+template<typename FieldType>
+void test_qap_reduction_context_pool(const std::size_t num_constraints, const std::size_t num_inputs,
+                                     const bool binary_input) {
+    const mixed_domain_examples<FieldType> examples(num_constraints, num_inputs, binary_input);
+    const r1cs_example<FieldType> &example = examples.example;
+    const typename FieldType::value_type zero = FieldType::value_type::zero();
+
+    // the pool is bounded, releasing the least recently requested size first, and contexts outlive their eviction
+    typedef reductions::reduction_context_pool<FieldType> pool_type;
+    const std::size_t capacity = pool_type::capacity();
+    pool_type::clear();
+    pool_type::set_capacity(1);
+    const std::shared_ptr<const reductions::reduction_context<FieldType>> pooled_context =
+        reductions::r1cs_to_qap<FieldType>::shared_context(example.constraint_system);
+    BOOST_CHECK(reductions::r1cs_to_qap<FieldType>::shared_context(example.constraint_system) == pooled_context);
+    reductions::r1cs_to_qap<FieldType>::shared_context(examples.other_example.constraint_system);
+    BOOST_CHECK_EQUAL(pool_type::size(), 1);
+    BOOST_CHECK(!pool_type::contains(examples.domain_size) && pool_type::contains(examples.other_domain_size));
+    BOOST_CHECK(reductions::r1cs_to_qap<FieldType>::witness_map(example.constraint_system, example.primary_input,
+                                                                example.auxiliary_input, zero, zero, zero,
+                                                                *pooled_context)
+                    .coefficients_for_H == examples.qap_wit.coefficients_for_H);
+    BOOST_CHECK(reductions::r1cs_to_qap<FieldType>::shared_context(example.constraint_system) != pooled_context);
+    BOOST_CHECK(pool_type::contains(examples.domain_size) && !pool_type::contains(examples.other_domain_size));
+
+    // without room, every request builds a context of its own and the pool stays empty
+    pool_type::set_capacity(0);
+    BOOST_CHECK_EQUAL(pool_type::size(), 0);
+    BOOST_CHECK(reductions::r1cs_to_qap<FieldType>::witness_map(example.constraint_system, example.primary_input,
+                                                                example.auxiliary_input)
+                    .coefficients_for_H == examples.qap_wit.coefficients_for_H);
+    BOOST_CHECK_EQUAL(pool_type::size(), 0);
+    pool_type::set_capacity(capacity);
+}
+
+template<typename FieldType>
+void test_qap_lagrange_basis(const std::size_t num_constraints, const std::size_t num_inputs,
+                             const bool binary_input) {
+    const r1cs_example<FieldType> example = make_example<FieldType>(num_constraints, num_inputs, binary_input);
+    const typename FieldType::value_type t = random_element<FieldType>();
+
+    const qap_instance<FieldType> qap_inst =
+        reductions::r1cs_to_qap<FieldType>::instance_map(example.constraint_system);
+    const qap_instance_evaluation<FieldType> qap_inst_evaluation =
+        reductions::r1cs_to_qap<FieldType>::instance_map_with_evaluation(example.constraint_system, t);
+
+    // the Lagrange basis rows evaluate to the instance evaluation
+    const std::vector<typename FieldType::value_type> u = qap_inst.domain->evaluate_all_lagrange_polynomials(t);
+    BOOST_CHECK(qap_inst.A_in_Lagrange_basis.evaluate(u) == qap_inst_evaluation.At);
+    BOOST_CHECK(qap_inst.B_in_Lagrange_basis.evaluate(u) == qap_inst_evaluation.Bt);
+    BOOST_CHECK(qap_inst.C_in_Lagrange_basis.evaluate(u) == qap_inst_evaluation.Ct);
+
+    // is_satisfied evaluates the instance through the same rows
+    const qap_witness<FieldType> qap_wit = reductions::r1cs_to_qap<FieldType>::witness_map(
+        example.constraint_system, example.primary_input, example.auxiliary_input);
+    BOOST_CHECK(qap_inst.is_satisfied(qap_wit));
+
+    // the compiled program maps to the same rows
+    const qap_instance<FieldType> program_qap_inst = reductions::r1cs_to_qap<FieldType>::instance_map(
+        r1cs_witness_program<FieldType>(example.constraint_system));
+    BOOST_CHECK(program_qap_inst.A_in_Lagrange_basis == qap_inst.A_in_Lagrange_basis);
+    BOOST_CHECK(program_qap_inst.B_in_Lagrange_basis == qap_inst.B_in_Lagrange_basis);
+    BOOST_CHECK(program_qap_inst.C_in_Lagrange_basis == qap_inst.C_in_Lagrange_basis);
+}
+
+template<typename FieldType>
+void test_r1cs_canonicalize(const std::size_t num_constraints, const std::size_t num_inputs,
+                            const bool binary_input) {
+    typedef typename FieldType::value_type value_type;
+
+    // terms out of order, repeated, cancelling and zero
+    linear_combination<FieldType> lc;
+    lc.add_term(variable<FieldType>(3), 2);
+    lc.add_term(variable<FieldType>(1), 5);
+    lc.add_term(variable<FieldType>(3), -2);
+    lc.add_term(variable<FieldType>(0), 0);
+    lc.add_term(variable<FieldType>(2), 1);
+    lc.add_term(variable<FieldType>(1), 1);
+    BOOST_CHECK(!lc.is_canonical());
+    lc.canonicalize();
+    BOOST_CHECK(lc.is_canonical());
+    BOOST_REQUIRE_EQUAL(lc.terms.size(), 2);
+    BOOST_CHECK_EQUAL(lc.terms[0].index, 1);
+    BOOST_CHECK(lc.terms[0].coeff == value_type(6));
+    BOOST_CHECK_EQUAL(lc.terms[1].index, 2);
+    BOOST_CHECK(lc.terms[1].coeff == value_type::one());
+    // the variables are 1, ..., num_variables
+    BOOST_CHECK(lc.is_valid(2));
+    BOOST_CHECK(!lc.is_valid(1));
+
+    // terms that all cancel leave an empty combination, which is valid and evaluates to zero
+    linear_combination<FieldType> cancelled;
+    cancelled.add_term(variable<FieldType>(4), 3);
+    cancelled.add_term(variable<FieldType>(4), -3);
+    cancelled.canonicalize();
+    BOOST_CHECK(cancelled.terms.empty());
+    BOOST_CHECK(cancelled.is_canonical());
+    BOOST_CHECK(cancelled.is_valid(4));
+    BOOST_CHECK(cancelled.evaluate(std::vector<value_type>(4, value_type(7))) == value_type::zero());
+
+    // unsorted, duplicated and zero terms are folded back into the canonical system
+    const r1cs_example<FieldType> example = make_example<FieldType>(num_constraints, num_inputs, binary_input);
+    r1cs_constraint_system<FieldType> canonical_cs = example.constraint_system;
+    canonical_cs.canonicalize();
+    BOOST_CHECK(canonical_cs.is_valid());
+    BOOST_CHECK(canonical_cs.is_satisfied(example.primary_input, example.auxiliary_input));
+
+    r1cs_constraint_system<FieldType> noisy_cs = canonical_cs;
+    for (r1cs_constraint<FieldType> &constraint : noisy_cs.constraints) {
+        std::reverse(constraint.a.terms.begin(), constraint.a.terms.end());
+        constraint.b.add_term(variable<FieldType>(0), value_type::zero());
+        // a term and its opposite, on a variable of c where it has one
+        const var_index_t index = constraint.c.terms.empty() ? 0 : constraint.c.terms.front().index;
+        const value_type coeff = random_element<FieldType>();
+        constraint.c.add_term(variable<FieldType>(index), coeff);
+        constraint.c.add_term(variable<FieldType>(index), -coeff);
+    }
+    // with a constraint whose c is empty
+    noisy_cs.constraints.front().c.terms.clear();
+    canonical_cs.constraints.front().c.terms.clear();
+    noisy_cs.constraints.front().c.add_term(variable<FieldType>(1), 2);
+    noisy_cs.constraints.front().c.add_term(variable<FieldType>(1), -2);
+
+    noisy_cs.canonicalize();
+    BOOST_CHECK(noisy_cs.is_valid());
+    BOOST_CHECK(noisy_cs == canonical_cs);
+}
+
+template<typename FieldType>
+void test_r1cs_optimizer(const std::size_t num_constraints, const std::size_t num_inputs, const bool binary_input) {
+    typedef typename FieldType::value_type value_type;
+
+    const r1cs_example<FieldType> example = make_example<FieldType>(num_constraints, num_inputs, binary_input);
+
+    // the additions of the field input example are linear, so the optimizer eliminates them
+    const r1cs_optimized_constraint_system<FieldType> optimized(example.constraint_system);
+    if (!binary_input) {
+        BOOST_CHECK(optimized.num_eliminated_constraints() > 0);
+        BOOST_CHECK(optimized.num_eliminated_variables() > 0);
+        BOOST_CHECK(optimized.qap_degree() < optimized.original_qap_degree());
+    }
+    BOOST_CHECK(optimized.qap_degree() + optimized.power_of_two_headroom() == optimized.power_of_two_domain_size());
+    BOOST_CHECK(optimized.constraint_system.is_valid());
+    BOOST_CHECK(optimized.constraint_system.is_satisfied(example.primary_input,
+                                                         optimized.map_auxiliary_input(example.auxiliary_input)));
+
+    // the headroom is the one of the domain the reduction picks
+    typedef reductions::r1cs_to_qap<FieldType> reduction_type;
+    const std::size_t headroom = reduction_type::domain_headroom(optimized.constraint_system);
+    BOOST_CHECK_EQUAL(optimized.qap_degree() + headroom, reduction_type::get_domain(optimized.constraint_system)->m);
+
+    const value_type d1 = random_element<FieldType>(), d2 = random_element<FieldType>(),
+                     d3 = random_element<FieldType>();
+    const qap_instance<FieldType> optimized_qap_inst = reduction_type::instance_map(optimized.constraint_system);
+    const qap_witness<FieldType> optimized_qap_wit = reduction_type::witness_map(
+        optimized, example.primary_input, example.auxiliary_input, d1, d2, d3);
+    BOOST_CHECK(optimized_qap_inst.is_satisfied(optimized_qap_wit));
+
+    // constant rows, and rows that become constant once the variables they use are substituted
+    const variable<FieldType> x1(1), x2(2), x3(3), x4(4), x5(5);
+    r1cs_constraint_system<FieldType> cs;
+    cs.primary_input_size = 1;
+    cs.auxiliary_input_size = 4;
+    cs.add_constraint(r1cs_constraint<FieldType>(1, x2, 3));
+    cs.add_constraint(r1cs_constraint<FieldType>(x2, x2, x3));
+    cs.add_constraint(r1cs_constraint<FieldType>(x3, 1, 9));
+    cs.add_constraint(r1cs_constraint<FieldType>(2, 3, 6));
+    cs.add_constraint(r1cs_constraint<FieldType>(x1, 2, x1 + x1));
+    // on the primary input only, and the same up to a factor
+    cs.add_constraint(r1cs_constraint<FieldType>(x1, 3, 6));
+    cs.add_constraint(r1cs_constraint<FieldType>(x1, 6, 12));
+    cs.add_constraint(r1cs_constraint<FieldType>(x4, x5, x1));
+
+    const r1cs_primary_input<FieldType> primary_input(1, value_type(2));
+    const r1cs_auxiliary_input<FieldType> auxiliary_input = {value_type(3), value_type(9), value_type(1),
+                                                             value_type(2)};
+    BOOST_REQUIRE(cs.is_satisfied(primary_input, auxiliary_input));
+
+    const r1cs_optimized_constraint_system<FieldType> folded(cs);
+    BOOST_CHECK_EQUAL(folded.constraint_system.num_constraints(), 2);
+    BOOST_CHECK_EQUAL(folded.num_eliminated_variables(), 2);
+    BOOST_CHECK(folded.auxiliary_variables == std::vector<std::size_t>({2, 3}));
+    BOOST_CHECK(folded.constraint_system.is_valid());
+    BOOST_CHECK(folded.constraint_system.is_satisfied(primary_input, folded.map_auxiliary_input(auxiliary_input)));
+    // the primary input is still constrained
+    BOOST_CHECK(!folded.constraint_system.is_satisfied(r1cs_primary_input<FieldType>(1, value_type(3)),
+                                                       folded.map_auxiliary_input(auxiliary_input)));
+
+    // failing constant rows are kept, as a single 1 * 1 = 0
+    r1cs_constraint_system<FieldType> unsatisfiable_cs;
+    unsatisfiable_cs.primary_input_size = 1;
+    unsatisfiable_cs.auxiliary_input_size = 1;
+    unsatisfiable_cs.add_constraint(r1cs_constraint<FieldType>(2, 3, 7));
+    unsatisfiable_cs.add_constraint(r1cs_constraint<FieldType>(x1, x1, x2));
+    unsatisfiable_cs.add_constraint(r1cs_constraint<FieldType>(5, 1, 4));
+
+    const r1cs_optimized_constraint_system<FieldType> unsatisfiable(unsatisfiable_cs);
+    BOOST_CHECK_EQUAL(unsatisfiable.constraint_system.num_constraints(), 2);
+    BOOST_CHECK(unsatisfiable.constraint_system.constraints.front() ==
+                r1cs_constraint<FieldType>(1, 1, linear_combination<FieldType>()));
+    const r1cs_auxiliary_input<FieldType> square(1, value_type(4));
+    BOOST_CHECK(!unsatisfiable.constraint_system.is_satisfied(primary_input, square));
+}
+
+template<typename FieldType>
+void test_r1cs_first_unsatisfied_constraint(const std::size_t num_constraints, const std::size_t num_inputs,
+                                            const bool binary_input) {
+    const r1cs_example<FieldType> example = make_example<FieldType>(num_constraints, num_inputs, binary_input);
+    const r1cs_constraint_system<FieldType> &cs = example.constraint_system;
+    const std::size_t n = cs.num_constraints();
+    const executor threads = thread_executor(4);
+
+    BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, example.auxiliary_input), n);
+    {
+        executor::scope guard(threads);
+        BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, example.auxiliary_input), n);
+    }
+
+    // the last auxiliary variable only appears in the last constraint
+    r1cs_auxiliary_input<FieldType> broken_auxiliary_input = example.auxiliary_input;
+    broken_auxiliary_input.back() += FieldType::value_type::one();
+    BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, broken_auxiliary_input), n - 1);
+    BOOST_CHECK(!cs.is_satisfied(example.primary_input, broken_auxiliary_input));
+    BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, broken_auxiliary_input, n, 0), n - 1);
+    const std::size_t sampled_failure = cs.first_unsatisfied_constraint(example.primary_input, broken_auxiliary_input,
+                                                                        16, 1);
+    BOOST_CHECK(sampled_failure == n - 1 || sampled_failure == n);
+
+    // witnesses broken at random places fail first where the constraints checked one by one do
+    for (std::size_t round = 0; round < 10; ++round) {
+        r1cs_auxiliary_input<FieldType> auxiliary_input = example.auxiliary_input;
+        for (std::size_t k = 0; k <= round % 3; ++k) {
+            auxiliary_input[std::rand() % auxiliary_input.size()] += random_element<FieldType>();
+        }
+        const std::size_t expected =
+            sequential_first_unsatisfied_constraint(cs, example.primary_input, auxiliary_input);
+        BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, auxiliary_input), expected);
+        executor::scope guard(threads);
+        BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, auxiliary_input), expected);
+
+        // a sampled check of every constraint is the full check; one of a part of them finds no earlier
+        // failure, and returns the same index for the same seed
+        BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, auxiliary_input, n, round),
+                          expected);
+        const std::size_t sampled =
+            cs.first_unsatisfied_constraint(example.primary_input, auxiliary_input, n / 4, round);
+        BOOST_CHECK(sampled >= expected);
+        BOOST_CHECK_EQUAL(cs.first_unsatisfied_constraint(example.primary_input, auxiliary_input, n / 4, round),
+                          sampled);
+        if (sampled < n) {
+            r1cs_constraint_system<FieldType> single = cs;
+            single.constraints = {cs.constraints[sampled]};
+            BOOST_CHECK(!single.is_satisfied(example.primary_input, auxiliary_input));
+        }
+    }
+}
+
+template<typename FieldType>
+void test_static_qap() {
+    constexpr std::size_t num_constraints = 13, num_inputs = 2, num_auxiliary = 2 + num_constraints - num_inputs;
+    typedef static_r1cs_constraint_system<FieldType, num_constraints, num_inputs, num_auxiliary, 64>
+        static_system_type;
+
+    const patched_qap_example<FieldType> example(num_constraints, num_inputs, false);
+    const static_system_type static_cs(example.constraint_system);
+
+    typename static_system_type::primary_input_type primary_input;
+    typename static_system_type::auxiliary_input_type auxiliary_input;
+    std::copy(example.primary_input.begin(), example.primary_input.end(), primary_input.begin());
+    std::copy(example.auxiliary_input.begin(), example.auxiliary_input.end(), auxiliary_input.begin());
+
+    BOOST_CHECK(static_system_type::qap_degree <= static_system_type::power_of_two_domain_size());
+    BOOST_CHECK(static_cs.is_satisfied(primary_input, auxiliary_input));
+    BOOST_CHECK(static_cs.to_constraint_system() == example.constraint_system);
+
+    auxiliary_input.back() += FieldType::value_type::one();
+    BOOST_CHECK(!static_cs.is_satisfied(primary_input, auxiliary_input));
+    auxiliary_input.back() -= FieldType::value_type::one();
+
+    qap_instance<FieldType> qap_inst = reductions::r1cs_to_qap<FieldType>::instance_map(example.constraint_system);
+    qap_witness<FieldType> static_qap_wit = reductions::r1cs_to_qap<FieldType>::witness_map(
+        static_cs, primary_input, auxiliary_input, example.d1, example.d2, example.d3);
+    BOOST_CHECK(qap_inst.is_satisfied(static_qap_wit));
+    BOOST_CHECK(static_qap_wit.coefficients_for_H == example.qap_wit.coefficients_for_H);
+
+    /* systems which do not fit the type, and indices past its sizes, are rejected in every build */
+    typedef static_r1cs_constraint_system<FieldType, num_constraints, num_inputs, num_auxiliary, 4> small_system_type;
+    typedef static_r1cs_constraint_system<FieldType, num_constraints + 1, num_inputs, num_auxiliary, 64>
+        larger_system_type;
+    BOOST_CHECK_THROW(small_system_type {example.constraint_system}, std::length_error);
+    BOOST_CHECK_THROW(larger_system_type {example.constraint_system}, std::invalid_argument);
+    r1cs_constraint_system<FieldType> out_of_range_cs = example.constraint_system;
+    out_of_range_cs.constraints[0].a.add_term(variable<FieldType>(static_system_type::num_variables() + 1));
+    BOOST_CHECK_THROW(static_system_type {out_of_range_cs}, std::out_of_range);
+
+    typename static_system_type::matrix_type matrix;
+    BOOST_CHECK_THROW(matrix.set_row(1, example.constraint_system.constraints[1].a), std::out_of_range);
+    matrix.set_row(0, example.constraint_system.constraints[0].a);
+    BOOST_CHECK_THROW(matrix.set_row(0, example.constraint_system.constraints[0].a), std::out_of_range);
+    BOOST_CHECK_THROW(static_cs.a.row(num_constraints), std::out_of_range);
+    BOOST_CHECK_THROW(static_cs.is_satisfied(0, std::vector<typename FieldType::value_type>(num_inputs)),
+                      std::invalid_argument);
+}
+
+template<typename FieldType>
+void test_r1cs_bytecode() {
+    typedef typename FieldType::value_type value_type;
+    typedef r1cs_linear_bytecode<FieldType> linear_bytecode_type;
+
+    const auto row = [](std::initializer_list<std::pair<std::size_t, value_type>> terms) {
+        linear_combination<FieldType> lc;
+        for (const std::pair<std::size_t, value_type> &term : terms) {
+            lc.add_term(variable<FieldType>(term.first), term.second);
+        }
+        return lc;
+    };
+    const value_type one = value_type::one();
+
+    // every opcode over x_1, ..., x_6, two constant terms folded into one, constant terms cancelling out, a
+    // zero coefficient, and duplicate rows
+    std::vector<linear_combination<FieldType>> rows(7);
+    rows[0] = row({{1, one}, {2, -one}, {3, value_type(2)}, {4, -value_type(3)}, {5, value_type(4)},
+                   {6, value_type(7)}, {0, value_type(5)}});
+    rows[1] = rows[0];
+    rows[2] = row({{2, -value_type(2)}, {3, -value_type(4)}, {0, value_type(3)}, {0, value_type(4)}});
+    rows[3] = rows[2];
+    rows[4] = row({{1, one}, {0, value_type(5)}, {0, -value_type(5)}, {2, value_type::zero()}});
+    rows[5] = row({{1, one}, {2, -one}, {3, value_type(2)}, {4, -value_type(3)}, {5, value_type(4)},
+                   {6, value_type(7)}, {0, value_type(6)}});
+    rows[6] = rows[0];
+
+    const std::size_t num_base_variables = 6;
+    std::vector<value_type> assignment;
+    for (std::size_t i = 0; i < num_base_variables + rows.size(); ++i) {
+        assignment.emplace_back(random_element<FieldType>());
+    }
+
+    r1cs_constraint_system<FieldType> cs;
+    cs.primary_input_size = 2;
+    cs.auxiliary_input_size = assignment.size() - 2;
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        assignment[num_base_variables + i] = rows[i].evaluate(assignment);
+        cs.add_constraint(r1cs_constraint<FieldType>(rows[i], row({{0, one}}),
+                                                     row({{1 + num_base_variables + i, one}})));
+    }
+    BOOST_REQUIRE(cs.is_satisfied(r1cs_primary_input<FieldType>(assignment.begin(), assignment.begin() + 2),
+                                  r1cs_auxiliary_input<FieldType>(assignment.begin() + 2, assignment.end())));
+
+    const r1cs_bytecode<FieldType> bytecode(cs);
+    BOOST_CHECK(bytecode == r1cs_bytecode<FieldType>(r1cs_witness_program<FieldType>(cs)));
+
+    // rows 1, 3 and 6 of A and every row but the first of B are duplicates; row 5 differs in its constant
+    const linear_bytecode_type &a = bytecode.a;
+    BOOST_REQUIRE_EQUAL(a.duplicates.size(), 3);
+    BOOST_CHECK(a.duplicates[0].row == 1 && a.duplicates[0].source == 0);
+    BOOST_CHECK(a.duplicates[1].row == 3 && a.duplicates[1].source == 2);
+    BOOST_CHECK(a.duplicates[2].row == 6 && a.duplicates[2].source == 0);
+    BOOST_CHECK_EQUAL(bytecode.b.duplicates.size(), rows.size() - 1);
+    BOOST_CHECK(bytecode.c.duplicates.empty());
+
+    std::vector<std::size_t> opcode_counts(6, 0);
+    for (const typename linear_bytecode_type::instruction &op : a.instructions) {
+        ++opcode_counts[op.code];
+    }
+    BOOST_CHECK_EQUAL(opcode_counts[linear_bytecode_type::add], 3);
+    BOOST_CHECK_EQUAL(opcode_counts[linear_bytecode_type::subtract], 2);
+    BOOST_CHECK_EQUAL(opcode_counts[linear_bytecode_type::add_multiple], 4);
+    BOOST_CHECK_EQUAL(opcode_counts[linear_bytecode_type::subtract_multiple], 4);
+    BOOST_CHECK_EQUAL(opcode_counts[linear_bytecode_type::multiply_add], 2);
+    BOOST_CHECK_EQUAL(opcode_counts[linear_bytecode_type::add_constant], 3);
+    BOOST_CHECK_EQUAL(a.row_offsets[5] - a.row_offsets[4], 1);
+
+    // each row evaluates to its linear combination, the duplicates once copied from their sources
+    std::vector<value_type> values(rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        BOOST_CHECK(a.evaluate(i, assignment) == rows[i].evaluate(assignment));
+        values[i] = a.evaluate_row(i, assignment);
+    }
+    BOOST_CHECK(values[1].is_zero());
+    a.copy_duplicates(values.data());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        BOOST_CHECK(values[i] == rows[i].evaluate(assignment));
+    }
+
+    BOOST_CHECK(bytecode.is_satisfied(assignment));
+    const typename FieldType::value_type d1 = random_element<FieldType>(), d2 = random_element<FieldType>(),
+                                         d3 = random_element<FieldType>();
+    const r1cs_primary_input<FieldType> primary_input(assignment.begin(), assignment.begin() + 2);
+    const r1cs_auxiliary_input<FieldType> auxiliary_input(assignment.begin() + 2, assignment.end());
+    BOOST_CHECK(reductions::r1cs_to_qap<FieldType>::witness_map(bytecode, primary_input, auxiliary_input, d1, d2, d3)
+                    .coefficients_for_H ==
+                reductions::r1cs_to_qap<FieldType>::witness_map(cs, primary_input, auxiliary_input, d1, d2, d3)
+                    .coefficients_for_H);
+
+    assignment[num_base_variables + 5] += one;
+    BOOST_CHECK(!bytecode.is_satisfied(assignment));
+
+    // a variable index past the 32-bit operands is rejected in every build
+    const linear_combination<FieldType> out_of_range = row({{(std::size_t(1) << 32) + 1, one}});
+    BOOST_CHECK_THROW(linear_bytecode_type(1,
+                                           [&](std::size_t) -> const linear_combination<FieldType> & {
+                                               return out_of_range;
+                                           }),
+                      std::out_of_range);
+}
+
+template<typename FieldType>
+void test_r1cs_bytecode_witness_map(const std::size_t num_constraints, const std::size_t num_inputs,
+                                    const bool binary_input) {
+    // the bytecode of the system, compiled from it or from its matrices, maps to the same witness
+    const patched_qap_example<FieldType> example(num_constraints, num_inputs, binary_input);
+    const r1cs_bytecode<FieldType> bytecode(example.constraint_system);
+    BOOST_CHECK(bytecode == r1cs_bytecode<FieldType>(r1cs_witness_program<FieldType>(example.constraint_system)));
+    BOOST_CHECK(bytecode.is_satisfied(example.qap_wit.coefficients_for_ABCs));
+    const qap_witness<FieldType> bytecode_qap_wit = reductions::r1cs_to_qap<FieldType>::witness_map(
+        bytecode, example.primary_input, example.auxiliary_input, example.d1, example.d2, example.d3);
+    BOOST_CHECK(bytecode_qap_wit.coefficients_for_H == example.qap_wit.coefficients_for_H);
+}
+
+template<typename FieldType>
+void test_qap_witness_buffer() {
+    const patched_qap_example<FieldType> example(100, 4, false);
+    const qap_witness<FieldType> &qap_wit = example.qap_wit;
+    qap_instance<FieldType> qap_inst = reductions::r1cs_to_qap<FieldType>::instance_map(example.constraint_system);
+
+    std::vector<unsigned char> buffer = qap_witness_buffer<FieldType>::serialize(qap_wit);
+    BOOST_CHECK_EQUAL(buffer.size(), qap_witness_buffer<FieldType>::size(qap_wit));
+
+    const qap_witness_view<FieldType> view = qap_witness_buffer<FieldType>::view(buffer);
+    BOOST_CHECK_EQUAL(view.num_variables, qap_wit.num_variables);
+    BOOST_CHECK_EQUAL(view.degree, qap_wit.degree);
+    BOOST_CHECK_EQUAL(view.coefficients_for_H_size, qap_wit.coefficients_for_H.size());
+    BOOST_CHECK(view.coefficients_for_H[0] == qap_wit.coefficients_for_H[0]);
+
+    const qap_witness<FieldType> copy = qap_witness_buffer<FieldType>::deserialize(buffer);
+    BOOST_CHECK(copy.d1 == example.d1 && copy.d2 == example.d2 && copy.d3 == example.d3);
+    BOOST_CHECK(copy.coefficients_for_ABCs == qap_wit.coefficients_for_ABCs);
+    BOOST_CHECK(copy.coefficients_for_H == qap_wit.coefficients_for_H);
+    BOOST_CHECK(qap_inst.is_satisfied(copy));
+
+    BOOST_CHECK_THROW(qap_witness_buffer<FieldType>::view(buffer.data(), buffer.size() - 64), std::runtime_error);
+
+    /* a header whose sizes are overwritten, the words after magic, version and the value size */
+    const auto patched = [&](const std::size_t word, const std::uint64_t value) {
+        std::vector<unsigned char> copy(buffer);
+        std::memcpy(copy.data() + word * sizeof(std::uint64_t), &value, sizeof(value));
+        return copy;
+    };
+    const std::size_t num_inputs_word = 5, coefficients_for_ABCs_size_word = 6, coefficients_for_H_size_word = 7;
+    BOOST_CHECK_THROW(qap_witness_buffer<FieldType>::view(patched(num_inputs_word, qap_wit.num_variables + 1)),
+                      std::runtime_error);
+    BOOST_CHECK_THROW(
+        qap_witness_buffer<FieldType>::view(patched(coefficients_for_ABCs_size_word, qap_wit.num_variables - 1)),
+        std::runtime_error);
+    BOOST_CHECK_THROW(
+        qap_witness_buffer<FieldType>::view(patched(coefficients_for_H_size_word, std::uint64_t(1) << 62)),
+        std::runtime_error);
+
+    buffer[0] ^= 1;
+    BOOST_CHECK_THROW(qap_witness_buffer<FieldType>::view(buffer), std::runtime_error);
+}
+
+template<typename FieldType>
+void test_r1cs_digest() {
+    const r1cs_example<FieldType> example =
+        generate_r1cs_example_with_field_input<FieldType>(3 * r1cs_digest_block_size + 5, 4);
+    const auto digest = r1cs_constraint_system_digest(example.constraint_system);
+
+    // the blocks are fixed, so the digest does not depend on the number of threads
+    {
+        executor::scope guard(executor::sequential());
+        BOOST_CHECK(r1cs_constraint_system_digest(example.constraint_system) == digest);
+    }
+    {
+        const executor pool(3);
+        executor::scope guard(pool);
+        BOOST_CHECK(r1cs_constraint_system_digest(example.constraint_system) == digest);
+    }
+
+    r1cs_constraint_system<FieldType> changed_cs = example.constraint_system;
+    changed_cs.constraints.back().c.add_term(variable<FieldType>(1), FieldType::value_type::one());
+    BOOST_CHECK(r1cs_constraint_system_digest(changed_cs) != digest);
+
+    changed_cs = example.constraint_system;
+    ++changed_cs.auxiliary_input_size;
+    BOOST_CHECK(r1cs_constraint_system_digest(changed_cs) != digest);
+
+    changed_cs = example.constraint_system;
+    changed_cs.constraints.pop_back();
+    BOOST_CHECK(r1cs_constraint_system_digest(changed_cs) != digest);
+}
+
+template<typename FieldType>
+void test_r1cs_memory_arena() {
+    const r1cs_example<FieldType> example = generate_r1cs_example_with_field_input<FieldType>(100, 4);
+
+    memory_arena arena(1 << 12);
+    {
+        const pmr::r1cs_constraint_system<FieldType> arena_cs(example.constraint_system, &arena);
+        BOOST_CHECK(arena_cs.get_allocator().resource() == &arena);
+        BOOST_CHECK(arena_cs.constraints.back().a.get_allocator().resource() == &arena);
+
+        const pmr::r1cs_primary_input<FieldType> primary_input(example.primary_input.begin(),
+                                                               example.primary_input.end(), &arena);
+        const pmr::r1cs_auxiliary_input<FieldType> auxiliary_input(example.auxiliary_input.begin(),
+                                                                   example.auxiliary_input.end(), &arena);
+        BOOST_CHECK(arena_cs.is_satisfied(primary_input, auxiliary_input));
+
+        BOOST_CHECK(r1cs_constraint_system<FieldType>(arena_cs) == example.constraint_system);
+        BOOST_CHECK(r1cs_witness_program<FieldType>(arena_cs).to_constraint_system() == example.constraint_system);
+        BOOST_CHECK(arena.allocated() > 0);
+
+        // the sums with a constant keep the allocator of the linear combination
+        typedef linear_combination<FieldType> default_linear_combination;
+        const pmr::linear_combination<FieldType> lc(arena_cs.constraints.back().a, &arena);
+        const default_linear_combination default_lc(lc, typename default_linear_combination::allocator_type());
+        const typename FieldType::value_type coeff = random_element<FieldType>();
+        const pmr::linear_combination<FieldType> sums[] = {coeff - lc, coeff + lc, coeff * lc, 3 - lc, 3 + lc, 3 * lc};
+        const default_linear_combination default_sums[] = {coeff - default_lc, coeff + default_lc, coeff * default_lc,
+                                                           3 - default_lc,     3 + default_lc,     3 * default_lc};
+        for (std::size_t i = 0; i < 6; ++i) {
+            BOOST_CHECK(sums[i].get_allocator().resource() == &arena);
+            BOOST_CHECK(default_linear_combination(sums[i], typename default_linear_combination::allocator_type()) ==
+                        default_sums[i]);
+        }
+
+        // the witness of the request is allocated in the arena, the FFTs run in the workspace
+        typedef reductions::r1cs_to_qap<FieldType> reduction_type;
+        const reductions::reduction_context<FieldType> context =
+            reduction_type::make_context(example.constraint_system);
+        const qap_witness<FieldType> qap_wit = reduction_type::witness_map(
+            example.constraint_system, example.primary_input, example.auxiliary_input, context);
+
+        typename reduction_type::workspace scratch;
+        for (std::size_t call = 0; call < 2; ++call) {
+            const std::size_t allocated = arena.allocated();
+            const std::size_t workspace_size = scratch.size_in_bits();
+            const pmr::qap_witness<FieldType> arena_qap_wit = reduction_type::witness_map(
+                example.constraint_system, primary_input, auxiliary_input, context, scratch,
+                std::pmr::polymorphic_allocator<typename FieldType::value_type>(&arena));
+
+            BOOST_CHECK(arena_qap_wit.get_allocator().resource() == &arena);
+            BOOST_CHECK(arena_qap_wit.coefficients_for_ABCs.get_allocator().resource() == &arena);
+            BOOST_CHECK_GE(arena.allocated() - allocated,
+                           (arena_qap_wit.coefficients_for_ABCs.size() + arena_qap_wit.coefficients_for_H.size()) *
+                               sizeof(typename FieldType::value_type));
+            BOOST_CHECK(std::equal(arena_qap_wit.coefficients_for_ABCs.begin(),
+                                   arena_qap_wit.coefficients_for_ABCs.end(), qap_wit.coefficients_for_ABCs.begin(),
+                                   qap_wit.coefficients_for_ABCs.end()));
+            BOOST_CHECK(std::equal(arena_qap_wit.coefficients_for_H.begin(), arena_qap_wit.coefficients_for_H.end(),
+                                   qap_wit.coefficients_for_H.begin(), qap_wit.coefficients_for_H.end()));
+
+            // the workspace keeps its three buffers, so the second call runs in the same memory
+            BOOST_CHECK_GE(scratch.aA.capacity(), context.domain()->m + 1);
+            BOOST_CHECK_GE(scratch.aB.capacity(), context.domain()->m);
+            BOOST_CHECK_GE(scratch.aC.capacity(), context.domain()->m);
+            if (call > 0) {
+                BOOST_CHECK_EQUAL(scratch.size_in_bits(), workspace_size);
+            }
+
+            const qap_witness_view<FieldType> view(arena_qap_wit);
+            BOOST_CHECK(view.coefficients_for_H == arena_qap_wit.coefficients_for_H.data());
+            BOOST_CHECK_EQUAL(view.coefficients_for_H_size, qap_wit.coefficients_for_H.size());
+        }
+    }
+
+    // the request is done with the arena, so all its blocks go back at once
+    arena.release();
+    BOOST_CHECK_EQUAL(arena.allocated(), 0);
+}
+
+/* An FFT backend forwarding to the CPU backend, which counts the calls the witness map makes to it. */
+template<typename FieldType>
+struct counting_fft_backend {
+    inline static std::size_t calls = 0;
+
+    template<typename... Args>
+    static std::vector<typename FieldType::value_type> coefficients_for_H(Args &&...args) {
+        ++calls;
+        return reductions::r1cs_to_qap_cpu_fft_backend<FieldType>::coefficients_for_H(std::forward<Args>(args)...);
+    }
+};
+
+template<typename FieldType>
+void test_r1cs_to_qap_fft_backend() {
+    typedef typename FieldType::value_type value_type;
+    typedef reductions::r1cs_to_qap_cpu_fft_backend<FieldType> backend_type;
+
+    // a 128-point radix-2 domain, whose coset FFT lists the points g * w^i in order
+    const r1cs_example<FieldType> example = generate_r1cs_example_with_field_input<FieldType>(100, 4);
+    const auto domain = reductions::r1cs_to_qap<FieldType>::get_domain(example.constraint_system);
+    const std::size_t m = domain->m;
+    const reductions::reduction_context<FieldType> context(domain);
+
+    // evaluations of A, B and C with A * B = C on the domain, so that Z divides A * B - C
+    std::vector<value_type> aA(m), aB(m), aC(m);
+    for (std::size_t i = 0; i < m; ++i) {
+        aA[i] = random_element<FieldType>();
+        aB[i] = random_element<FieldType>();
+        aC[i] = aA[i] * aB[i];
+    }
+
+    const value_type t = random_element<FieldType>(), d1 = random_element<FieldType>(),
+                     d2 = random_element<FieldType>(), d3 = random_element<FieldType>();
+    const std::vector<value_type> u = domain->evaluate_all_lagrange_polynomials(t);
+    value_type At = value_type::zero(), Bt = value_type::zero(), Ct = value_type::zero();
+    for (std::size_t i = 0; i < m; ++i) {
+        At += u[i] * aA[i];
+        Bt += u[i] * aB[i];
+        Ct += u[i] * aC[i];
+    }
+    const value_type Zt = domain->compute_vanishing_polynomial(t);
+    const auto evaluate = [](const std::vector<value_type> &coefficients, const value_type &x) {
+        value_type result = value_type::zero();
+        for (std::size_t i = coefficients.size(); i-- > 0;) {
+            result = result * x + coefficients[i];
+        }
+        return result;
+    };
+
+    // H * Z = (A + d1 * Z) * (B + d2 * Z) - (C + d3 * Z)
+    std::vector<value_type> A = aA, B = aB, C = aC;
+    const std::vector<value_type> H = backend_type::coefficients_for_H(context, A, B, C, d1, d2, d3);
+    BOOST_CHECK_EQUAL(H.size(), m + 1);
+    BOOST_CHECK(evaluate(H, t) * Zt == (At + d1 * Zt) * (Bt + d2 * Zt) - (Ct + d3 * Zt));
+
+    A = aA, B = aB, C = aC;
+    const std::vector<value_type> unpatched_H = backend_type::coefficients_for_H(context, A, B, C);
+    BOOST_CHECK(evaluate(unpatched_H, t) * Zt == At * Bt - Ct);
+    A = aA, B = aB, C = aC;
+    const value_type zero = value_type::zero();
+    BOOST_CHECK(backend_type::coefficients_for_H(context, A, B, C, zero, zero, zero) == unpatched_H);
+
+    // the evaluations on the coset g*S are those of the same H
+    A = aA, B = aB, C = aC;
+    backend_type::evaluations_for_H_on_coset(context, A, B, C);
+    const value_type g = fields::arithmetic_params<FieldType>::multiplicative_generator;
+    for (const std::size_t i : {std::size_t(0), std::size_t(1), m / 2, m - 1}) {
+        BOOST_CHECK(A[i] == evaluate(unpatched_H, g * domain->get_domain_element(i)));
+    }
+
+    // the witness map hands the whole chain to the backend of the reduction
+    typedef reductions::r1cs_to_qap<FieldType, counting_fft_backend<FieldType>> counting_reduction_type;
+    counting_fft_backend<FieldType>::calls = 0;
+    const qap_witness<FieldType> qap_wit = counting_reduction_type::witness_map(
+        example.constraint_system, example.primary_input, example.auxiliary_input, d1, d2, d3);
+    BOOST_CHECK_EQUAL(counting_fft_backend<FieldType>::calls, 1);
+    BOOST_CHECK(qap_wit.coefficients_for_H ==
+                reductions::r1cs_to_qap<FieldType>::witness_map(example.constraint_system, example.primary_input,
+                                                                example.auxiliary_input, d1, d2, d3)
+                    .coefficients_for_H);
+}
+
 BOOST_AUTO_TEST_SUITE(qap_test_suite)
 
 BOOST_AUTO_TEST_CASE(qap_test_case) {
-    const std::size_t num_inputs = 10;
+    typedef curves::mnt6<298>::scalar_field_type field_type;
+    for (const bool binary_input : {true, false}) {
+        for (const std::size_t qap_degree : test_qap_degrees<field_type>()) {
+            test_qap<field_type>(qap_degree, 10, binary_input);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(qap_six_step_fft_backend_test_case) {
+    typedef curves::mnt6<298>::scalar_field_type field_type;
+    for (const std::size_t qap_degree : test_qap_degrees<field_type>()) {
+        test_qap_six_step_fft_backend<field_type>(qap_degree, 10, true);
+        test_qap_six_step_fft_backend<field_type>(qap_degree, 10, false);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(qap_reduction_context_test_case) {
+    typedef curves::mnt6<298>::scalar_field_type field_type;
+    for (const std::size_t qap_degree : test_qap_degrees<field_type>()) {
+        test_qap_reduction_context<field_type>(qap_degree, 10, true);
+        test_qap_reduction_context<field_type>(qap_degree, 10, false);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(qap_unpatched_witness_map_test_case) {
+    test_qap_unpatched_witness_map<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_qap_unpatched_witness_map<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
+
+BOOST_AUTO_TEST_CASE(qap_batch_witness_map_test_case) {
+    test_qap_batch_witness_map<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_qap_batch_witness_map<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
+
+BOOST_AUTO_TEST_CASE(qap_reduction_context_pool_test_case) {
+    test_qap_reduction_context_pool<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_qap_reduction_context_pool<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
+
+BOOST_AUTO_TEST_CASE(qap_lagrange_basis_test_case) {
+    test_qap_lagrange_basis<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_qap_lagrange_basis<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
+
+BOOST_AUTO_TEST_CASE(r1cs_canonicalize_test_case) {
+    test_r1cs_canonicalize<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_r1cs_canonicalize<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
+
+BOOST_AUTO_TEST_CASE(r1cs_optimizer_test_case) {
+    test_r1cs_optimizer<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_r1cs_optimizer<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
+
+BOOST_AUTO_TEST_CASE(r1cs_first_unsatisfied_constraint_test_case) {
+    test_r1cs_first_unsatisfied_constraint<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_r1cs_first_unsatisfied_constraint<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
+
+BOOST_AUTO_TEST_CASE(static_qap_test_case) {
+    test_static_qap<typename curves::mnt6<298>::scalar_field_type>();
+}
+
+BOOST_AUTO_TEST_CASE(r1cs_bytecode_test_case) {
+    test_r1cs_bytecode<typename curves::mnt6<298>::scalar_field_type>();
+}
+
+BOOST_AUTO_TEST_CASE(r1cs_bytecode_witness_map_test_case) {
+    test_r1cs_bytecode_witness_map<typename curves::mnt6<298>::scalar_field_type>(100, 10, true);
+    test_r1cs_bytecode_witness_map<typename curves::mnt6<298>::scalar_field_type>(100, 10, false);
+}
 
-    using basic_curve_type = curves::mnt6<298>;
+BOOST_AUTO_TEST_CASE(qap_witness_buffer_test_case) {
+    test_qap_witness_buffer<typename curves::mnt6<298>::scalar_field_type>();
+}
 
-    const std::size_t basic_domain_size = 1ul << fields::arithmetic_params<basic_curve_type::scalar_field_type>::s;
-    const std::size_t step_domain_size = (1ul << 10) + (1ul << 8);
-    const std::size_t extended_domain_size = 1ul << (fields::arithmetic_params<basic_curve_type::scalar_field_type>::s + 1);
-    const std::size_t extended_domain_size_special = extended_domain_size - 1;
+BOOST_AUTO_TEST_CASE(r1cs_digest_test_case) {
+    test_r1cs_digest<typename curves::mnt6<298>::scalar_field_type>();
+}
 
-    test_qap<typename basic_curve_type::scalar_field_type>(basic_domain_size, num_inputs, true);
-    test_qap<typename basic_curve_type::scalar_field_type>(step_domain_size, num_inputs, true);
-    test_qap<typename basic_curve_type::scalar_field_type>(extended_domain_size, num_inputs, true);
-    test_qap<typename basic_curve_type::scalar_field_type>(extended_domain_size_special, num_inputs, true);
+BOOST_AUTO_TEST_CASE(r1cs_memory_arena_test_case) {
+    test_r1cs_memory_arena<typename curves::mnt6<298>::scalar_field_type>();
+}
 
-    test_qap<typename basic_curve_type::scalar_field_type>(basic_domain_size, num_inputs, false);
-    test_qap<typename basic_curve_type::scalar_field_type>(step_domain_size, num_inputs, false);
-    test_qap<typename basic_curve_type::scalar_field_type>(extended_domain_size, num_inputs, false);
-    test_qap<typename basic_curve_type::scalar_field_type>(extended_domain_size_special, num_inputs, false);
+BOOST_AUTO_TEST_CASE(r1cs_to_qap_fft_backend_test_case) {
+    test_r1cs_to_qap_fft_backend<typename curves::mnt6<298>::scalar_field_type>();
 }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -89,6 +89,16 @@ void test_sap(const std::size_t sap_degree, const std::size_t num_inputs, const
 
     BOOST_CHECK(sap_inst_1.is_satisfied(sap_wit));
     BOOST_CHECK(sap_inst_2.is_satisfied(sap_wit));
+
+    // every entry is computed by a single thread, so the evaluation does not depend on the executor
+    {
+        const executor pool(3);
+        executor::scope guard(pool);
+        const sap_instance_evaluation<FieldType> sap_inst_3 =
+            reductions::r1cs_to_sap<FieldType>::instance_map_with_evaluation(example.constraint_system, t);
+        BOOST_CHECK(sap_inst_3.At == sap_inst_2.At);
+        BOOST_CHECK(sap_inst_3.Ct == sap_inst_2.Ct);
+    }
 }
 
 BOOST_AUTO_TEST_SUITE(sap_test_suite)
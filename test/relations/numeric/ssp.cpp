@@ -79,6 +79,15 @@ void test_ssp(const std::size_t num_constraints, const std::size_t num_inputs, c
 
     BOOST_CHECK(ssp_inst_1.is_satisfied(ssp_wit));
     BOOST_CHECK(ssp_inst_2.is_satisfied(ssp_wit));
+
+    // every entry is computed by a single thread, so the evaluation does not depend on the executor
+    {
+        const executor pool(3);
+        executor::scope guard(pool);
+        const ssp_instance_evaluation<FieldType> ssp_inst_3 =
+            reductions::uscs_to_ssp<FieldType>::instance_map_with_evaluation(example.constraint_system, t);
+        BOOST_CHECK(ssp_inst_3.Vt == ssp_inst_2.Vt);
+    }
 }
 
 BOOST_AUTO_TEST_SUITE(ssp_test_suite)
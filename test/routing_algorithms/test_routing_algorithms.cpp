@@ -49,17 +49,115 @@ void test_benes(const std::size_t N) {
 }
 
 /**
- * Test AS-Waksman network routing for all permutations on N elements.
+ * Test AS-Waksman network routing for all permutations on N elements, the iterative router
+ * being checked against the recursive one.
  */
 void test_as_waksman(const std::size_t N) {
     integer_permutation permutation(N);
+    const std::size_t width = as_waksman_num_columns(N);
 
     do {
         const as_waksman_routing routing = get_as_waksman_routing(permutation);
         assert(valid_as_waksman_routing(permutation, routing));
+
+        as_waksman_routing recursive_routing(width);
+        as_waksman_route_inner(0, width - 1, 0, N - 1, permutation, permutation.inverse(), recursive_routing);
+        assert(routing == recursive_routing);
     } while (permutation.next_permutation());
 }
 
+/**
+ * Test that routing the subnetworks of every level in blocks, as a multi-threaded executor
+ * does, gives the same routings on N packets.
+ */
+void test_blocked_routing(const std::size_t N) {
+    integer_permutation permutation(N);
+    permutation.random_shuffle();
+
+    const benes_routing sequential_benes = get_benes_routing(permutation);
+    const as_waksman_routing sequential_as_waksman = get_as_waksman_routing(permutation);
+
+    const executor blocked(4, [](std::size_t n, const executor::task_type &f) {
+        for (std::size_t i = n; i > 0; --i) {
+            f(i - 1);
+        }
+    });
+    executor::scope guard(blocked);
+    assert(get_benes_routing(permutation) == sequential_benes);
+    assert(get_as_waksman_routing(permutation) == sequential_as_waksman);
+}
+
+/**
+ * Test that the cached topologies on N packets match the generated ones and are shared.
+ */
+void test_topology_cache(const std::size_t N) {
+    assert(get_as_waksman_topology(N)->to_nested() == generate_as_waksman_topology(N));
+    assert(get_as_waksman_topology(N) == get_as_waksman_topology(N));
+
+    const std::size_t benes_size = 1ul << static_cast<std::size_t>(std::ceil(std::log2(N)));
+    assert(get_benes_topology(benes_size)->to_nested() == generate_benes_topology(benes_size));
+    assert(get_benes_topology(benes_size) == get_benes_topology(benes_size));
+}
+
+/**
+ * Test that the packed routings of a random permutation on N packets hold the settings of the
+ * nested ones, that they are valid and that flipping one switch port invalidates them.
+ */
+void test_packed_routing(const std::size_t N) {
+    const std::size_t benes_size = 1ul << static_cast<std::size_t>(std::ceil(std::log2(N)));
+    integer_permutation benes_permutation(benes_size);
+    benes_permutation.random_shuffle();
+
+    const benes_routing routing = get_benes_routing(benes_permutation);
+    packed_routing packed = get_benes_packed_routing(benes_permutation);
+    for (std::size_t column_idx = 0; column_idx < routing.size(); ++column_idx) {
+        for (std::size_t packet_idx = 0; packet_idx < benes_size; ++packet_idx) {
+            assert(packed.get(column_idx, packet_idx) == routing[column_idx][packet_idx]);
+        }
+    }
+    assert(valid_benes_routing(benes_permutation, packed));
+    packed.set(0, 0, !packed.get(0, 0));
+    assert(!valid_benes_routing(benes_permutation, packed));
+
+    integer_permutation permutation(N);
+    permutation.random_shuffle();
+
+    const as_waksman_routing as_waksman = get_as_waksman_routing(permutation);
+    packed_routing as_waksman_packed = get_as_waksman_packed_routing(permutation);
+    for (std::size_t column_idx = 0; column_idx < as_waksman.size(); ++column_idx) {
+        for (const std::pair<const std::size_t, bool> &setting : as_waksman[column_idx]) {
+            assert(as_waksman_packed.get(column_idx, setting.first) == setting.second);
+            assert(as_waksman_packed.get(column_idx, setting.first + 1) == setting.second);
+        }
+    }
+    assert(valid_as_waksman_routing(permutation, as_waksman_packed));
+    const std::size_t switch_idx = as_waksman[0].begin()->first;
+    as_waksman_packed.set(0, switch_idx, !as_waksman_packed.get(0, switch_idx));
+    assert(!valid_as_waksman_routing(permutation, as_waksman_packed));
+}
+
+/**
+ * Test that the 32-bit permutation on N elements and its views agree with integer_permutation,
+ * and that a repeated element is caught.
+ */
+void test_compact_permutation(const std::size_t N) {
+    integer_permutation permutation(N);
+    permutation.random_shuffle();
+    const compact_integer_permutation compact(permutation);
+
+    assert(compact.is_valid());
+    assert(integer_permutation(compact.inverse()) == permutation.inverse());
+    assert(compact.inverse().inverse() == compact);
+    for (std::size_t position = N / 4; position <= N / 2; ++position) {
+        assert(compact.slice_view(N / 4, N / 2).get(position) == permutation.get(position));
+    }
+    assert(compact.slice_view(N / 4, N / 2).is_valid() == permutation.slice(N / 4, N / 2).is_valid());
+
+    compact_integer_permutation repeated = compact;
+    repeated.set(N - 1, compact.get(0));
+    assert(!repeated.is_valid());
+}
+
 BOOST_AUTO_TEST_SUITE(routing_algorithms_test_suite)
 
 BOOST_AUTO_TEST_CASE(routing_algorithms_test) {
@@ -71,6 +169,11 @@ BOOST_AUTO_TEST_CASE(routing_algorithms_test) {
     for (std::size_t i = 2; i <= asw_max_size; ++i) {
         test_as_waksman(i);
     }
+
+    test_blocked_routing(1ul << 10);
+    test_topology_cache(asw_max_size);
+    test_packed_routing(1000);
+    test_compact_permutation(1000);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,145 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Test of the scalar-size-aware multi-exponentiation.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE scalar_size_multiexp_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
+#include <nil/crypto3/algebra/random_element.hpp>
+
+#include <nil/crypto3/zk/snark/multiexp_dispatch.hpp>
+#include <nil/crypto3/zk/snark/scalar_size_multiexp.hpp>
+
+using namespace nil::crypto3::algebra;
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef curves::bls12<381> curve_type;
+    typedef curve_type::g1_type::value_type g1_value_type;
+    typedef curve_type::scalar_field_type scalar_field_type;
+    typedef scalar_field_type::value_type scalar_field_value_type;
+
+    scalar_field_value_type small_scalar(const std::uint64_t value) {
+        return scalar_field_value_type(scalar_field_type::modulus_type(value));
+    }
+
+    /* scalar_size_multiexp over the bases, its wide terms being evaluated naively, against a naive one */
+    bool agrees_with_naive(const std::vector<g1_value_type> &bases,
+                           const std::vector<scalar_field_value_type> &scalars, const std::size_t chunks) {
+        typedef policies::multiexp_method_naive_plain naive_method_type;
+
+        const g1_value_type result = scalar_size_multiexp(
+            bases.begin(), scalars.begin(), scalars.end(),
+            scalar_size_partition::classify(scalars.begin(), scalars.end()), chunks,
+            [&](auto scalars_first, auto scalars_last) {
+                return dispatch_multiexp<naive_method_type>(bases.begin(), bases.end(), scalars_first,
+                                                            scalars_last, 1);
+            });
+        return result == dispatch_multiexp<naive_method_type>(bases.begin(), bases.end(), scalars.begin(),
+                                                              scalars.end(), 1);
+    }
+}    // namespace
+
+BOOST_AUTO_TEST_SUITE(scalar_size_multiexp_test_suite)
+
+BOOST_AUTO_TEST_CASE(scalar_size_partition_test) {
+    // the bounds of every class, the scalars of at most one bit and the wider ones in none
+    const scalar_field_value_type two_32 = small_scalar(std::uint64_t(1) << 32);
+    const std::vector<scalar_field_value_type> scalars = {small_scalar(0),
+                                                          small_scalar(1),
+                                                          small_scalar(2),
+                                                          small_scalar(255),
+                                                          small_scalar(256),
+                                                          small_scalar(65535),
+                                                          small_scalar(65536),
+                                                          small_scalar(0xffffffff),
+                                                          two_32,
+                                                          small_scalar(~std::uint64_t(0)),
+                                                          two_32 * two_32,
+                                                          -scalar_field_value_type::one()};
+
+    const scalar_size_partition partition = scalar_size_partition::classify(scalars.begin(), scalars.end());
+    BOOST_CHECK(partition.positions[0] == std::vector<std::size_t>({2, 3}));
+    BOOST_CHECK(partition.positions[1] == std::vector<std::size_t>({4, 5}));
+    BOOST_CHECK(partition.positions[2] == std::vector<std::size_t>({6, 7}));
+    BOOST_CHECK(partition.positions[3] == std::vector<std::size_t>({8, 9}));
+    BOOST_CHECK(partition.size() == 8);
+}
+
+BOOST_AUTO_TEST_CASE(scalar_size_multiexp_test) {
+    std::mt19937_64 random_engine(74);
+    const std::size_t n = 300;
+
+    std::vector<g1_value_type> bases(n);
+    for (g1_value_type &base : bases) {
+        base = g1_value_type::one() * random_element<scalar_field_type>();
+    }
+
+    // scalars of every width, with bits, zeros and full-width ones in between
+    std::vector<scalar_field_value_type> scalars(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t kind = i % 7;
+        if (kind < 4) {
+            const std::size_t bits = scalar_size_partition::class_bits(kind);
+            const std::uint64_t value = random_engine();
+            scalars[i] = small_scalar(bits == 64 ? value : value & ((std::uint64_t(1) << bits) - 1));
+        } else if (kind == 4) {
+            scalars[i] = small_scalar(random_engine() & 1);
+        } else if (kind == 5) {
+            scalars[i] = scalar_field_value_type::zero();
+        } else {
+            scalars[i] = random_element<scalar_field_type>();
+        }
+    }
+    BOOST_CHECK(agrees_with_naive(bases, scalars, 1));
+    BOOST_CHECK(agrees_with_naive(bases, scalars, 4));
+
+    // every term small, so that the wide multi-exponentiation only gets zeros
+    std::vector<scalar_field_value_type> small_scalars(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        small_scalars[i] = small_scalar(2 + random_engine() % 254);
+    }
+    BOOST_CHECK(agrees_with_naive(bases, small_scalars, 3));
+
+    // no term small, the partition being empty
+    std::vector<scalar_field_value_type> wide_scalars(n);
+    for (scalar_field_value_type &scalar : wide_scalars) {
+        scalar = random_element<scalar_field_type>();
+    }
+    BOOST_CHECK(scalar_size_partition::classify(wide_scalars.begin(), wide_scalars.end()).size() == 0);
+    BOOST_CHECK(agrees_with_naive(bases, wide_scalars, 2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -30,11 +30,20 @@
 #define CRYPTO3_RUN_R1CS_MP_PPZKPCD_HPP
 
 #include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "tally_cp.hpp"
 
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/pcd_dag_scheduler.hpp>
 #include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/r1cs_mp_ppzkpcd.hpp>
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_mp_ppzkpcd/mapped_keypair.hpp>
+
+#include "../../../../temporary_path.hpp"
 
 namespace nil {
     namespace crypto3 {
@@ -115,34 +124,78 @@ namespace nil {
                     r1cs_pcd_compliance_predicate<FieldType> cp_1 = tally_1.get_compliance_predicate();
                     r1cs_pcd_compliance_predicate<FieldType> cp_2 = tally_2.get_compliance_predicate();
 
-                    r1cs_mp_ppzkpcd_keypair<PCD_ppT> keypair = r1cs_mp_ppzkpcd_generator<PCD_ppT>({cp_1, cp_2});
+                    const r1cs_mp_ppzkpcd_keypair<PCD_ppT> generated_keypair =
+                        r1cs_mp_ppzkpcd_generator<PCD_ppT>({cp_1, cp_2});
+
+                    /* prove and verify with the keypair read back from its mapped file */
+                    const std::string mapped_keypair_path = temporary_path("r1cs_mp_ppzkpcd_keypair.bin");
+                    r1cs_mp_ppzkpcd_mapped_keypair<PCD_ppT>::write(mapped_keypair_path, generated_keypair);
+                    r1cs_mp_ppzkpcd_mapped_keypair<PCD_ppT> mapped_keypair(mapped_keypair_path, {cp_1, cp_2});
+                    BOOST_CHECK(!mapped_keypair.is_loaded(cp_1.name) && !mapped_keypair.is_loaded(cp_2.name));
+                    mapped_keypair.load(cp_1.name);
+                    mapped_keypair.load(cp_2.name);
+                    BOOST_CHECK(mapped_keypair.vk() == generated_keypair.vk);
+                    {
+                        /* a truncated copy of the file is rejected, not read past its end */
+                        std::ifstream in(mapped_keypair_path, std::ios::binary);
+                        const std::string contents((std::istreambuf_iterator<char>(in)),
+                                                   std::istreambuf_iterator<char>());
+                        const std::string truncated_path = temporary_path("r1cs_mp_ppzkpcd_truncated_keypair.bin");
+                        for (const std::size_t size : {contents.size() / 2, std::size_t(32)}) {
+                            std::ofstream(truncated_path, std::ios::binary | std::ios::trunc)
+                                .write(contents.data(), size);
+                            BOOST_CHECK_THROW(
+                                r1cs_mp_ppzkpcd_mapped_keypair<PCD_ppT> truncated(truncated_path, {cp_1, cp_2}),
+                                std::runtime_error);
+                        }
+                        std::remove(truncated_path.c_str());
+                    }
+                    const r1cs_mp_ppzkpcd_keypair<PCD_ppT> keypair(
+                        r1cs_mp_ppzkpcd_proving_key<PCD_ppT>(mapped_keypair.pk()),
+                        r1cs_mp_ppzkpcd_verification_key<PCD_ppT>(mapped_keypair.vk()));
 
                     r1cs_mp_ppzkpcd_processed_verification_key<PCD_ppT> pvk =
                         r1cs_mp_ppzkpcd_process_vk<PCD_ppT>(keypair.vk);
 
                     std::shared_ptr<r1cs_pcd_message<FieldType>> base_msg =
                         tally_1.get_base_case_message(); /* we choose the base to always be tally_1 */
-                    nodes_in_layer /= max_arity;
-                    for (long layer = depth; layer >= 0; --layer, nodes_in_layer /= max_arity) {
-                        for (std::size_t i = 0; i < nodes_in_layer; ++i) {
-                            const std::size_t cur_idx = (nodes_in_layer - 1) / (max_arity - 1) + i;
-
-                            tally_cp_handler<FieldType> &cur_tally = (tree_types[cur_idx] == 1 ? tally_1 : tally_2);
-                            r1cs_pcd_compliance_predicate<FieldType> &cur_cp = (tree_types[cur_idx] == 1 ? cp_1 : cp_2);
-
-                            const bool base_case = (max_arity * cur_idx + max_arity >= tree_size);
 
-                            std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> msgs(max_arity, base_msg);
-                            std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> proofs(max_arity);
+                    /* node i consumes the messages of its first tree_arity[i] children, max_arity * i + 1, ... */
+                    std::vector<std::vector<std::size_t>> incoming_nodes(tree_size);
+                    for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+                        const bool base_case = (max_arity * cur_idx + max_arity >= tree_size);
+                        for (std::size_t i = 0; !base_case && i < tree_arity[cur_idx]; ++i) {
+                            incoming_nodes[cur_idx].emplace_back(max_arity * cur_idx + i + 1);
+                        }
+                    }
 
-                            if (!base_case) {
-                                for (std::size_t i = 0; i < max_arity; ++i) {
-                                    msgs[i] = tree_messages[max_arity * cur_idx + i + 1];
-                                    proofs[i] = tree_proofs[max_arity * cur_idx + i + 1];
-                                }
+                    /* every worker proves its nodes through its own tally handlers and prover context, the step
+                     * circuits being built once per worker for the whole tree */
+                    tree_proofs = prove_pcd_dag<r1cs_mp_ppzkpcd_proof<PCD_ppT>>(incoming_nodes, [&]() {
+                        std::shared_ptr<tally_cp_handler<FieldType>> worker_tally_1(new tally_cp_handler<FieldType>(
+                            1, max_arity, wordsize, test_same_type_optimization, tally_1_accepted_types));
+                        std::shared_ptr<tally_cp_handler<FieldType>> worker_tally_2(new tally_cp_handler<FieldType>(
+                            2, max_arity, wordsize, test_same_type_optimization, tally_2_accepted_types));
+                        worker_tally_1->generate_r1cs_constraints();
+                        worker_tally_2->generate_r1cs_constraints();
+                        std::shared_ptr<r1cs_mp_ppzkpcd_prover_context<PCD_ppT>> prover_context(
+                            new r1cs_mp_ppzkpcd_prover_context<PCD_ppT>(keypair.pk));
+
+                        return [&, worker_tally_1, worker_tally_2, prover_context](
+                                   const std::size_t cur_idx,
+                                   const std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> &incoming_proofs) {
+                            tally_cp_handler<FieldType> &cur_tally =
+                                (tree_types[cur_idx] == 1 ? *worker_tally_1 : *worker_tally_2);
+                            const r1cs_pcd_compliance_predicate<FieldType> &cur_cp =
+                                (tree_types[cur_idx] == 1 ? cp_1 : cp_2);
+
+                            std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> msgs(tree_arity[cur_idx],
+                                                                                          base_msg);
+                            std::vector<r1cs_mp_ppzkpcd_proof<PCD_ppT>> proofs(tree_arity[cur_idx]);
+                            for (std::size_t i = 0; i < incoming_proofs.size(); ++i) {
+                                msgs[i] = tree_messages[incoming_nodes[cur_idx][i]];
+                                proofs[i] = incoming_proofs[i];
                             }
-                            msgs.resize(tree_arity[i]);
-                            proofs.resize(tree_arity[i]);
 
                             std::shared_ptr<r1cs_pcd_local_data<FieldType>> ld;
                             ld.reset(new tally_pcd_local_data<FieldType>(tree_elems[cur_idx]));
@@ -153,38 +206,51 @@ namespace nil {
                             const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType> tally_auxiliary_input(
                                 msgs, ld, cur_tally.get_witness());
 
-                            r1cs_mp_ppzkpcd_proof<PCD_ppT> proof = r1cs_mp_ppzkpcd_prover<PCD_ppT>(
-                                keypair.pk, cur_cp.name, tally_primary_input, tally_auxiliary_input, proofs);
-
-                            tree_proofs[cur_idx] = proof;
                             tree_messages[cur_idx] = cur_tally.get_outgoing_message();
-
-                            const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> pcd_verifier_input(tree_messages[cur_idx]);
-                            const bool ans =
-                                r1cs_mp_ppzkpcd_verifier<PCD_ppT>(keypair.vk, pcd_verifier_input, tree_proofs[cur_idx]);
-
-                            const bool ans2 =
-                                r1cs_mp_ppzkpcd_online_verifier<PCD_ppT>(pvk, pcd_verifier_input, tree_proofs[cur_idx]);
-                            BOOST_CHECK(ans == ans2);
-
-                            all_accept = all_accept && ans;
-
-                            printf("\n");
-                            for (std::size_t i = 0; i < msgs.size(); ++i) {
-                                printf("Message %zu was:\n", i);
-                                msgs[i]->print();
-                            }
-                            printf("Summand at this node:\n%zu\n", tree_elems[cur_idx]);
-                            printf("Outgoing message is:\n");
-                            tree_messages[cur_idx]->print();
-                            printf("\n");
-                            printf("Current node = %zu. Current proof verifies = %s\n", cur_idx, ans ? "YES" : "NO");
-                            printf(
-                                "\n\n\n "
-                                "================================================================================"
-                                "\n\n\n");
+                            return prover_context->prove(cur_cp.name, tally_primary_input, tally_auxiliary_input,
+                                                         proofs);
+                        };
+                    });
+
+                    for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+                        const r1cs_mp_ppzkpcd_primary_input<PCD_ppT> pcd_verifier_input(tree_messages[cur_idx]);
+                        const bool ans =
+                            r1cs_mp_ppzkpcd_verifier<PCD_ppT>(keypair.vk, pcd_verifier_input, tree_proofs[cur_idx]);
+
+                        const bool ans2 =
+                            r1cs_mp_ppzkpcd_online_verifier<PCD_ppT>(pvk, pcd_verifier_input, tree_proofs[cur_idx]);
+                        BOOST_CHECK(ans == ans2);
+
+                        all_accept = all_accept && ans;
+
+                        printf("\n");
+                        for (std::size_t i = 0; i < tree_arity[cur_idx]; ++i) {
+                            printf("Message %zu was:\n", i);
+                            (incoming_nodes[cur_idx].empty() ? base_msg : tree_messages[incoming_nodes[cur_idx][i]])
+                                ->print();
                         }
+                        printf("Summand at this node:\n%zu\n", tree_elems[cur_idx]);
+                        printf("Outgoing message is:\n");
+                        tree_messages[cur_idx]->print();
+                        printf("\n");
+                        printf("Current node = %zu. Current proof verifies = %s\n", cur_idx, ans ? "YES" : "NO");
+                        printf(
+                            "\n\n\n "
+                            "================================================================================"
+                            "\n\n\n");
+                    }
+
+                    /* the whole tree verifies at once iff every node does */
+                    std::vector<r1cs_mp_ppzkpcd_primary_input<PCD_ppT>> tree_primary_inputs;
+                    for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+                        tree_primary_inputs.emplace_back(tree_messages[cur_idx]);
                     }
+                    BOOST_CHECK(r1cs_mp_ppzkpcd_online_batch_verifier<PCD_ppT>(pvk, tree_primary_inputs, tree_proofs) ==
+                                all_accept);
+                    tree_primary_inputs.pop_back();
+                    BOOST_CHECK(!r1cs_mp_ppzkpcd_online_batch_verifier<PCD_ppT>(pvk, tree_primary_inputs, tree_proofs));
+
+                    std::remove(mapped_keypair_path.c_str());
 
                     return all_accept;
                 }
@@ -34,6 +34,8 @@
 
 #include "tally_cp.hpp"
 
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/compiled_compliance_predicate.hpp>
+#include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/pcd_dag_scheduler.hpp>
 #include <nil/crypto3/zk/snark/schemes/pcd/r1cs_pcd/r1cs_sp_ppzkpcd/r1cs_sp_ppzkpcd.hpp>
 
 namespace nil {
@@ -71,6 +73,7 @@ namespace nil {
                     tally_cp_handler<FieldType> tally(type, arity, wordsize);
                     tally.generate_r1cs_constraints();
                     r1cs_pcd_compliance_predicate<FieldType> tally_cp = tally.get_compliance_predicate();
+                    const r1cs_pcd_compiled_compliance_predicate<FieldType> compiled_tally_cp(tally_cp);
 
                     r1cs_sp_ppzkpcd_keypair<PCD_ppT> keypair = r1cs_sp_ppzkpcd_generator<PCD_ppT>(tally_cp);
 
@@ -78,64 +81,113 @@ namespace nil {
                         r1cs_sp_ppzkpcd_process_vk<PCD_ppT>(keypair.vk);
 
                     std::shared_ptr<r1cs_pcd_message<FieldType>> base_msg = tally.get_base_case_message();
-                    nodes_in_layer /= arity;
-                    for (long layer = depth; layer >= 0; --layer, nodes_in_layer /= arity) {
-                        for (std::size_t i = 0; i < nodes_in_layer; ++i) {
-                            const std::size_t cur_idx = (nodes_in_layer - 1) / (arity - 1) + i;
 
+                    /* node i consumes the messages of nodes arity * i + 1, ..., arity * i + arity */
+                    std::vector<std::vector<std::size_t>> incoming_nodes(tree_size);
+                    for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+                        const bool base_case = (arity * cur_idx + arity >= tree_size);
+                        for (std::size_t i = 0; !base_case && i < arity; ++i) {
+                            incoming_nodes[cur_idx].emplace_back(arity * cur_idx + i + 1);
+                        }
+                    }
+
+                    /* whether the compiled predicate and the predicate accept the assignment of every node, and
+                     * that assignment with the count of the outgoing message off by one */
+                    std::vector<char> compiled_cp_accepts(tree_size, false), tally_cp_accepts(tree_size, false);
+                    std::vector<char> compiled_cp_accepts_forged(tree_size, true),
+                        tally_cp_accepts_forged(tree_size, true);
+
+                    /* every worker proves its nodes through its own tally handler and prover context, the step
+                     * circuits being built once per worker for the whole tree */
+                    tree_proofs = prove_pcd_dag<r1cs_sp_ppzkpcd_proof<PCD_ppT>>(incoming_nodes, [&]() {
+                        std::shared_ptr<tally_cp_handler<FieldType>> worker_tally(
+                            new tally_cp_handler<FieldType>(type, arity, wordsize));
+                        worker_tally->generate_r1cs_constraints();
+                        std::shared_ptr<r1cs_sp_ppzkpcd_prover_context<PCD_ppT>> prover_context(
+                            new r1cs_sp_ppzkpcd_prover_context<PCD_ppT>(keypair.pk));
+
+                        return [&, worker_tally, prover_context](
+                                   const std::size_t cur_idx,
+                                   const std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> &incoming_proofs) {
                             std::vector<std::shared_ptr<r1cs_pcd_message<FieldType>>> msgs(arity, base_msg);
                             std::vector<r1cs_sp_ppzkpcd_proof<PCD_ppT>> proofs(arity);
-
-                            const bool base_case = (arity * cur_idx + arity >= tree_size);
-
-                            if (!base_case) {
-                                for (std::size_t i = 0; i < arity; ++i) {
-                                    msgs[i] = tree_messages[arity * cur_idx + i + 1];
-                                    proofs[i] = tree_proofs[arity * cur_idx + i + 1];
-                                }
+                            for (std::size_t i = 0; i < incoming_proofs.size(); ++i) {
+                                msgs[i] = tree_messages[incoming_nodes[cur_idx][i]];
+                                proofs[i] = incoming_proofs[i];
                             }
 
                             std::shared_ptr<r1cs_pcd_local_data<FieldType>> ld;
                             ld.reset(new tally_pcd_local_data<FieldType>(tree_elems[cur_idx]));
-                            tally.generate_r1cs_witness(msgs, ld);
+                            worker_tally->generate_r1cs_witness(msgs, ld);
 
                             const r1cs_pcd_compliance_predicate_primary_input<FieldType> tally_primary_input(
-                                tally.get_outgoing_message());
+                                worker_tally->get_outgoing_message());
                             const r1cs_pcd_compliance_predicate_auxiliary_input<FieldType> tally_auxiliary_input(
-                                msgs, ld, tally.get_witness());
-
-                            r1cs_sp_ppzkpcd_proof<PCD_ppT> proof = r1cs_sp_ppzkpcd_prover<PCD_ppT>(
-                                keypair.pk, tally_primary_input, tally_auxiliary_input, proofs);
-
-                            tree_proofs[cur_idx] = proof;
-                            tree_messages[cur_idx] = tally.get_outgoing_message();
-
-                            const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> pcd_verifier_input(tree_messages[cur_idx]);
-                            const bool ans =
-                                r1cs_sp_ppzkpcd_verifier<PCD_ppT>(keypair.vk, pcd_verifier_input, tree_proofs[cur_idx]);
-
-                            const bool ans2 =
-                                r1cs_sp_ppzkpcd_online_verifier<PCD_ppT>(pvk, pcd_verifier_input, tree_proofs[cur_idx]);
-                            BOOST_CHECK(ans == ans2);
-
-                            all_accept = all_accept && ans;
-
-                            printf("\n");
-                            for (std::size_t i = 0; i < arity; ++i) {
-                                printf("Message %zu was:\n", i);
-                                msgs[i]->print();
-                            }
-                            printf("Summand at this node:\n%zu\n", tree_elems[cur_idx]);
-                            printf("Outgoing message is:\n");
-                            tree_messages[cur_idx]->print();
-                            printf("\n");
-                            printf("Current node = %zu. Current proof verifies = %s\n", cur_idx, ans ? "YES" : "NO");
-                            printf(
-                                "\n\n\n "
-                                "================================================================================"
-                                "\n\n\n");
+                                msgs, ld, worker_tally->get_witness());
+
+                            compiled_cp_accepts[cur_idx] = compiled_tally_cp.is_satisfied(
+                                worker_tally->get_outgoing_message(), msgs, ld, worker_tally->get_witness());
+                            tally_cp_accepts[cur_idx] = tally_cp.is_satisfied(worker_tally->get_outgoing_message(),
+                                                                              msgs, ld, worker_tally->get_witness());
+
+                            const std::shared_ptr<tally_pcd_message<FieldType>> outgoing_msg =
+                                std::dynamic_pointer_cast<tally_pcd_message<FieldType>>(
+                                    worker_tally->get_outgoing_message());
+                            const std::shared_ptr<r1cs_pcd_message<FieldType>> forged_msg(
+                                new tally_pcd_message<FieldType>(outgoing_msg->type, wordsize, outgoing_msg->sum,
+                                                                 outgoing_msg->count + 1));
+                            compiled_cp_accepts_forged[cur_idx] =
+                                compiled_tally_cp.is_satisfied(forged_msg, msgs, ld, worker_tally->get_witness());
+                            tally_cp_accepts_forged[cur_idx] =
+                                tally_cp.is_satisfied(forged_msg, msgs, ld, worker_tally->get_witness());
+
+                            tree_messages[cur_idx] = worker_tally->get_outgoing_message();
+                            return prover_context->prove(tally_primary_input, tally_auxiliary_input, proofs);
+                        };
+                    });
+
+                    for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+                        BOOST_CHECK(tally_cp_accepts[cur_idx]);
+                        BOOST_CHECK(compiled_cp_accepts[cur_idx] == tally_cp_accepts[cur_idx]);
+                        BOOST_CHECK(!tally_cp_accepts_forged[cur_idx]);
+                        BOOST_CHECK(compiled_cp_accepts_forged[cur_idx] == tally_cp_accepts_forged[cur_idx]);
+
+                        const r1cs_sp_ppzkpcd_primary_input<PCD_ppT> pcd_verifier_input(tree_messages[cur_idx]);
+                        const bool ans =
+                            r1cs_sp_ppzkpcd_verifier<PCD_ppT>(keypair.vk, pcd_verifier_input, tree_proofs[cur_idx]);
+
+                        const bool ans2 =
+                            r1cs_sp_ppzkpcd_online_verifier<PCD_ppT>(pvk, pcd_verifier_input, tree_proofs[cur_idx]);
+                        BOOST_CHECK(ans == ans2);
+
+                        all_accept = all_accept && ans;
+
+                        printf("\n");
+                        for (std::size_t i = 0; i < arity; ++i) {
+                            printf("Message %zu was:\n", i);
+                            (incoming_nodes[cur_idx].empty() ? base_msg : tree_messages[incoming_nodes[cur_idx][i]])
+                                ->print();
                         }
+                        printf("Summand at this node:\n%zu\n", tree_elems[cur_idx]);
+                        printf("Outgoing message is:\n");
+                        tree_messages[cur_idx]->print();
+                        printf("\n");
+                        printf("Current node = %zu. Current proof verifies = %s\n", cur_idx, ans ? "YES" : "NO");
+                        printf(
+                            "\n\n\n "
+                            "================================================================================"
+                            "\n\n\n");
+                    }
+
+                    /* the whole tree verifies at once iff every node does */
+                    std::vector<r1cs_sp_ppzkpcd_primary_input<PCD_ppT>> tree_primary_inputs;
+                    for (std::size_t cur_idx = 0; cur_idx < tree_size; ++cur_idx) {
+                        tree_primary_inputs.emplace_back(tree_messages[cur_idx]);
                     }
+                    BOOST_CHECK(r1cs_sp_ppzkpcd_online_batch_verifier<PCD_ppT>(pvk, tree_primary_inputs, tree_proofs) ==
+                                all_accept);
+                    tree_primary_inputs.pop_back();
+                    BOOST_CHECK(!r1cs_sp_ppzkpcd_online_batch_verifier<PCD_ppT>(pvk, tree_primary_inputs, tree_proofs));
 
                     return all_accept;
                 }
@@ -26,9 +26,17 @@
 #ifndef CRYPTO3_RUN_R1CS_PPZKADSNARK_HPP
 #define CRYPTO3_RUN_R1CS_PPZKADSNARK_HPP
 
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
 #include <nil/crypto3/zk/snark/relations/constraint_satisfaction_problems/r1cs/examples/r1cs_examples.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzkadsnark/r1cs_ppzkadsnark/r1cs_ppzkadsnark_params.hpp>
 
+#include "../../../temporary_path.hpp"
+
 namespace nil {
     namespace crypto3 {
         namespace zk {
@@ -76,6 +84,19 @@ namespace nil {
                     bool auth_resp = r1cs_ppzkadsnark_auth_verify<CurveType>(data, auth_data, auth_keys.pak, labels);
                     assert(auth_res == auth_resp);
 
+                    /* the batched public check accepts the signed inputs and rejects them with one term forged */
+                    auth_resp = r1cs_ppzkadsnark<CurveType>::auth_verify_batch(data, auth_data, auth_keys.pak, labels);
+                    assert(auth_res == auth_resp);
+                    if (!auth_data.empty()) {
+                        std::vector<r1cs_ppzkadsnark_auth_data<CurveType>> forged_auth_data = auth_data;
+                        forged_auth_data.back().mu = forged_auth_data.back().mu + 1;
+                        assert(!r1cs_ppzkadsnark<CurveType>::auth_verify_batch(data, forged_auth_data, auth_keys.pak,
+                                                                               labels));
+                        std::vector<label_type> short_labels(labels.begin(), labels.end() - 1);
+                        assert(!r1cs_ppzkadsnark<CurveType>::auth_verify_batch(data, auth_data, auth_keys.pak,
+                                                                               short_labels));
+                    }
+
                     r1cs_ppzkadsnark_proof<CurveType> proof = r1cs_ppzkadsnark_prover<CurveType>(
                         keypair.pk, example.primary_input, example.auxiliary_input, auth_data);
 
@@ -86,6 +107,12 @@ namespace nil {
                     bool ans2 = r1cs_ppzkadsnark_online_verifier<CurveType>(pvk, proof, auth_keys.sak, labels);
                     assert(ans == ans2);
 
+                    /* a batch repeating the proof verifies iff the proof does */
+                    const std::vector<r1cs_ppzkadsnark_proof<CurveType>> proofs(3, proof);
+                    const std::vector<std::vector<label_type>> proof_labels(3, labels);
+                    ans2 = r1cs_ppzkadsnark_online_batch_verifier<CurveType>(pvk, proofs, auth_keys.sak, proof_labels);
+                    assert(ans == ans2);
+
                     ans = r1cs_ppzkadsnark_verifier<CurveType>(keypair.vk, auth_data, proof, auth_keys.pak, labels);
 
                     printf("* The verification result is: %s\n", (ans ? "PASS" : "FAIL"));
@@ -93,6 +120,95 @@ namespace nil {
                     ans2 = r1cs_ppzkadsnark_online_verifier<CurveType>(pvk, auth_data, proof, auth_keys.pak, labels);
                     assert(ans == ans2);
 
+                    const std::vector<std::vector<r1cs_ppzkadsnark_auth_data<CurveType>>> proof_auth_data(3, auth_data);
+                    ans2 = r1cs_ppzkadsnark_online_batch_verifier<CurveType>(pvk, proof_auth_data, proofs,
+                                                                             auth_keys.pak, proof_labels);
+                    assert(ans == ans2);
+
+                    /* a batch with one tampered proof, or with one wrong label, is rejected */
+                    std::vector<r1cs_ppzkadsnark_proof<CurveType>> tampered_proofs = proofs;
+                    tampered_proofs.back().g_C.g = tampered_proofs.back().g_C.g + CurveType::g1_type::value_type::one();
+                    assert(!r1cs_ppzkadsnark_online_batch_verifier<CurveType>(pvk, tampered_proofs, auth_keys.sak,
+                                                                              proof_labels));
+                    assert(!r1cs_ppzkadsnark_online_batch_verifier<CurveType>(pvk, proof_auth_data, tampered_proofs,
+                                                                              auth_keys.pak, proof_labels));
+                    if (!labels.empty()) {
+                        std::vector<std::vector<label_type>> wrong_labels = proof_labels;
+                        wrong_labels.back().back().label_bytes[0] ^= 1;
+                        assert(!r1cs_ppzkadsnark_online_batch_verifier<CurveType>(pvk, proofs, auth_keys.sak,
+                                                                                  wrong_labels));
+                        assert(!r1cs_ppzkadsnark_online_batch_verifier<CurveType>(pvk, proof_auth_data, proofs,
+                                                                                  auth_keys.pak, wrong_labels));
+                    }
+                    const std::vector<std::vector<label_type>> missing_labels(2, labels);
+                    assert(!r1cs_ppzkadsnark_online_batch_verifier<CurveType>(pvk, proofs, auth_keys.sak,
+                                                                              missing_labels));
+
+                    /* the second proof through a workspace reuses the input terms of the first one */
+                    typename r1cs_ppzkadsnark<CurveType>::prover_workspace_type workspace(keypair.pk);
+                    for (std::size_t i = 0; i < 2; ++i) {
+                        r1cs_ppzkadsnark_proof<CurveType> workspace_proof = r1cs_ppzkadsnark_prover<CurveType>(
+                            keypair.pk, example.primary_input, example.auxiliary_input, auth_data, workspace);
+                        ans2 = r1cs_ppzkadsnark_online_verifier<CurveType>(pvk, auth_data, workspace_proof,
+                                                                           auth_keys.pak, labels);
+                        assert(ans == ans2);
+                    }
+
+                    /* a changed data point is committed to again, and the earlier data is reused when it returns */
+                    if (!labels.empty()) {
+                        std::vector<label_type> changed_labels = labels;
+                        changed_labels.back().label_bytes[0] ^= 1;
+                        const std::vector<r1cs_ppzkadsnark_auth_data<CurveType>> changed_auth_data =
+                            r1cs_ppzkadsnark_auth_sign<CurveType>(data, auth_keys.sak, changed_labels);
+                        assert(!(changed_auth_data.back().mu == auth_data.back().mu));
+
+                        for (const bool changed : {true, false, true}) {
+                            r1cs_ppzkadsnark_proof<CurveType> workspace_proof = r1cs_ppzkadsnark_prover<CurveType>(
+                                keypair.pk, example.primary_input, example.auxiliary_input,
+                                changed ? changed_auth_data : auth_data, workspace);
+                            ans2 = r1cs_ppzkadsnark_online_verifier<CurveType>(
+                                pvk, changed ? changed_auth_data : auth_data, workspace_proof, auth_keys.pak,
+                                changed ? changed_labels : labels);
+                            assert(ans == ans2);
+                        }
+                    }
+
+                    /* a proving key streamed to disk proves like the one held in memory */
+                    const std::string mapped_key_path = temporary_path("r1cs_ppzkadsnark_streamed_proving_key.bin");
+                    auto mapped_keypair = r1cs_ppzkadsnark<CurveType>::generator(example.constraint_system,
+                                                                                 auth_keys.pap, mapped_key_path);
+                    r1cs_ppzkadsnark_proving_key<CurveType> mapped_pk =
+                        mapped_keypair.first.template load<r1cs_ppzkadsnark_proving_key<CurveType>>();
+                    r1cs_ppzkadsnark_proof<CurveType> mapped_proof = r1cs_ppzkadsnark_prover<CurveType>(
+                        mapped_pk, example.primary_input, example.auxiliary_input, auth_data);
+                    ans2 = r1cs_ppzkadsnark_verifier<CurveType>(mapped_keypair.second, auth_data, mapped_proof,
+                                                                auth_keys.pak, labels);
+                    assert(ans == ans2);
+
+                    /* a truncated key file is rejected when it is opened, not read past its end */
+                    typedef decltype(mapped_keypair.first) mapped_proving_key_type;
+                    std::string contents;
+                    {
+                        std::ifstream in(mapped_key_path, std::ios::binary);
+                        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                    }
+                    const std::string truncated_key_path = temporary_path("r1cs_ppzkadsnark_truncated_proving_key.bin");
+                    for (const std::size_t size : {contents.size() / 2, std::size_t(64), contents.size() - 1}) {
+                        std::ofstream(truncated_key_path, std::ios::binary | std::ios::trunc)
+                            .write(contents.data(), size);
+                        bool rejected = false;
+                        try {
+                            mapped_proving_key_type truncated(
+                                truncated_key_path,
+                                typename mapped_proving_key_type::constraint_system_type(example.constraint_system));
+                        } catch (const std::runtime_error &) {
+                            rejected = true;
+                        }
+                        assert(rejected);
+                    }
+                    std::remove(truncated_key_path.c_str());
+                    std::remove(mapped_key_path.c_str());
+
                     return ans;
                 }
 
@@ -27,11 +27,17 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
+#include <vector>
 
 #include "bacs_examples.hpp"
 #include "run_bacs_ppzksnark.hpp"
+#include "../../../thread_executor.hpp"
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/reductions/bacs_to_r1cs.hpp>
 
 #include <nil/crypto3/algebra/curves/mnt4.hpp>
 #include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
@@ -59,4 +65,47 @@ BOOST_AUTO_TEST_CASE(bacs_ppzksnark_test) {
     test_bacs_ppzksnark<curves::mnt4<298>>(10, 10, 20, 5);
 }
 
+BOOST_AUTO_TEST_CASE(bacs_to_r1cs_test) {
+    typedef typename curves::mnt4<298>::scalar_field_type field_type;
+    typedef reductions::bacs_to_r1cs<field_type> reduction_type;
+
+    const bacs_example<field_type> example = generate_bacs_example<field_type>(10, 10, 20, 5);
+    const bacs_circuit<field_type> &circuit = example.circuit;
+
+    // one constraint per gate, then one per output forcing it to zero
+    r1cs_constraint_system<field_type> expected;
+    expected.primary_input_size = circuit.primary_input_size;
+    expected.auxiliary_input_size = circuit.auxiliary_input_size + circuit.gates.size();
+    for (const bacs_gate<field_type> &gate : circuit.gates) {
+        expected.constraints.emplace_back(r1cs_constraint<field_type>(gate.lhs, gate.rhs, gate.output));
+    }
+    for (const bacs_gate<field_type> &gate : circuit.gates) {
+        if (gate.is_circuit_output) {
+            expected.constraints.emplace_back(r1cs_constraint<field_type>(1, gate.output, 0));
+        }
+    }
+
+    BOOST_CHECK(reduction_type::instance_map(circuit) == expected);
+    {
+        const executor threads = thread_executor(4);
+        executor::scope guard(threads);
+        BOOST_CHECK(reduction_type::instance_map(circuit) == expected);
+    }
+
+    const r1cs_variable_assignment<field_type> assignment =
+        reduction_type::witness_map(circuit, example.primary_input, example.auxiliary_input);
+    const r1cs_primary_input<field_type> primary_input(assignment.begin(),
+                                                       assignment.begin() + circuit.primary_input_size);
+    r1cs_auxiliary_input<field_type> auxiliary_input(assignment.begin() + circuit.primary_input_size,
+                                                     assignment.end());
+    BOOST_CHECK(expected.is_satisfied(primary_input, auxiliary_input));
+    BOOST_CHECK(reduction_type::auxiliary_witness_map(bacs_circuit_evaluator<field_type>(circuit),
+                                                      example.primary_input,
+                                                      example.auxiliary_input) == auxiliary_input);
+
+    // the last wire is an output, which the reduced system forces to zero
+    auxiliary_input.back() += field_type::value_type::one();
+    BOOST_CHECK(!expected.is_satisfied(primary_input, auxiliary_input));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
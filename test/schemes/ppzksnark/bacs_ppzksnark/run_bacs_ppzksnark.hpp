@@ -28,6 +28,7 @@
 
 #include "bacs_examples.hpp"
 
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/bacs_evaluator.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/bacs_ppzksnark.hpp>
 
 #include "../r1cs_examples.hpp"
@@ -60,10 +61,20 @@ namespace nil {
                     
                     std::cout << "Call to run_bacs_ppzksnark" << std::endl;
 
+                    std::cout << "BACS level-scheduled evaluator" << std::endl;
+                    const bacs_circuit_evaluator<typename CurveType::scalar_field_type> evaluator(example.circuit);
+                    BOOST_CHECK(evaluator.get_all_wires(example.primary_input, example.auxiliary_input) ==
+                                example.circuit.get_all_wires(example.primary_input, example.auxiliary_input));
+
                     std::cout << "BACS ppzkSNARK Generator" << std::endl;
                     typename basic_proof_system::keypair_type keypair =
                         generate<basic_proof_system>(example.circuit);
 
+                    /* the evaluator compiled into the proving key survives copies of the key */
+                    const typename basic_proof_system::proving_key_type pk_copy = keypair.first;
+                    BOOST_CHECK(pk_copy.evaluator.get_all_wires(example.primary_input, example.auxiliary_input) ==
+                                evaluator.get_all_wires(example.primary_input, example.auxiliary_input));
+
                     std::cout << "Preprocess verification key" << std::endl;
                     typename basic_proof_system::processed_verification_key_type pvk =
                         bacs_ppzksnark_process_verification_key<CurveType>::process(keypair.second);
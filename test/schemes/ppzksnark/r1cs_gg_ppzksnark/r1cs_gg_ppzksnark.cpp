@@ -32,10 +32,13 @@
 
 #include <cassert>
 #include <cstdio>
+#include <vector>
 
 #include "../r1cs_examples.hpp"
 #include "run_r1cs_gg_ppzksnark.hpp"
 
+#include <nil/crypto3/algebra/curves/bls12.hpp>
+#include <nil/crypto3/algebra/curves/params/wnaf/bls12.hpp>
 #include <nil/crypto3/algebra/curves/mnt4.hpp>
 #include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
 #include <nil/crypto3/algebra/fields/mnt4/scalar_field.hpp>
@@ -54,10 +57,230 @@ void run_r1cs_gg_ppzksnark_basic_test(std::size_t num_constraints, std::size_t i
     BOOST_CHECK(bit);
 }
 
+template<typename FieldType>
+std::vector<typename FieldType::value_type> random_scalars(const std::size_t n) {
+    std::vector<typename FieldType::value_type> scalars(n);
+    for (typename FieldType::value_type &scalar : scalars) {
+        scalar = random_element<FieldType>();
+    }
+    return scalars;
+}
+
+template<typename CurveType, typename BackendType>
+void run_r1cs_gg_ppzksnark_multiexp_backend_test(std::size_t num_constraints, std::size_t input_size) {
+    typedef typename CurveType::scalar_field_type scalar_field_type;
+    typedef r1cs_gg_ppzksnark<CurveType> proof_system_type;
+    typedef BackendType backend_type;
+    typedef nil::crypto3::algebra::policies::multiexp_method_naive_plain naive_method_type;
+
+    const r1cs_example<scalar_field_type> example =
+        generate_r1cs_example_with_binary_input<scalar_field_type>(num_constraints, input_size);
+    const typename proof_system_type::keypair_type keypair = generate<proof_system_type>(example.constraint_system);
+    const typename proof_system_type::proving_key_type &pk = keypair.first;
+    const typename backend_type::resident_queries_type resident = backend_type::upload(pk);
+
+    // every query sum against a naive single-threaded one, over the whole query and over a range of it
+    const std::vector<typename scalar_field_type::value_type> A_scalars =
+        random_scalars<scalar_field_type>(pk.A_query.size());
+    BOOST_CHECK(backend_type::multiexp_A(resident, pk, A_scalars.begin(), A_scalars.end()) ==
+                dispatch_multiexp<naive_method_type>(pk.A_query.begin(), pk.A_query.end(), A_scalars.begin(),
+                                                     A_scalars.end(), 1));
+    BOOST_CHECK(backend_type::multiexp_A(resident, pk, 3, A_scalars.begin() + 3, A_scalars.begin() + 10) ==
+                dispatch_multiexp<naive_method_type>(pk.A_query.begin() + 3, pk.A_query.begin() + 10,
+                                                     A_scalars.begin() + 3, A_scalars.begin() + 10, 1));
+
+    const std::vector<typename scalar_field_type::value_type> H_scalars =
+        random_scalars<scalar_field_type>(pk.H_query.size());
+    BOOST_CHECK(backend_type::multiexp_H(resident, pk, H_scalars.begin(), H_scalars.end()) ==
+                dispatch_multiexp<naive_method_type>(pk.H_query.begin(), pk.H_query.end(), H_scalars.begin(),
+                                                     H_scalars.end(), 1));
+
+    const std::vector<typename scalar_field_type::value_type> L_scalars =
+        random_scalars<scalar_field_type>(pk.L_query.size());
+    BOOST_CHECK(backend_type::multiexp_L(resident, pk, L_scalars.begin(), L_scalars.end()) ==
+                dispatch_multiexp<naive_method_type>(pk.L_query.begin(), pk.L_query.end(), L_scalars.begin(),
+                                                     L_scalars.end(), 1));
+
+    // the two ranges of a split add up to the whole B_query sum
+    const std::size_t B_size = pk.B_query.domain_size();
+    const std::vector<typename scalar_field_type::value_type> B_scalars = random_scalars<scalar_field_type>(B_size);
+    const auto B = backend_type::multiexp_B(resident, pk, B_scalars.begin(), B_scalars.end());
+    BOOST_CHECK(B == kc_multiexp_with_mixed_addition<naive_method_type>(pk.B_query, 0, B_size, B_scalars.begin(),
+                                                                          B_scalars.end(), 1));
+    BOOST_CHECK(B == backend_type::multiexp_B(resident, pk, 0, B_scalars.begin(), B_scalars.begin() + B_size / 2) +
+                         backend_type::multiexp_B(resident, pk, B_size / 2, B_scalars.begin() + B_size / 2,
+                                                  B_scalars.end()));
+
+    // a key made resident with the backend proves as the key itself
+    const r1cs_gg_ppzksnark_resident_proving_key<CurveType, backend_type> resident_key(pk);
+    BOOST_CHECK(verify<proof_system_type>(
+        keypair.second, example.primary_input,
+        proof_system_type::prove(resident_key, example.primary_input, example.auxiliary_input)));
+}
+
+/* the example of the basic test with its keys and a proof, which the other paths are checked against */
+struct r1cs_gg_ppzksnark_fixture : r1cs_gg_ppzksnark_run<curves::mnt4<298>> {
+    r1cs_gg_ppzksnark_fixture() :
+        r1cs_gg_ppzksnark_run<curves::mnt4<298>>(
+            generate_r1cs_example_with_binary_input<curves::mnt4<298>::scalar_field_type>(1000, 100)) {
+    }
+};
+
 BOOST_AUTO_TEST_SUITE(r1cs_gg_ppzksnark_test_suite)
 
 BOOST_AUTO_TEST_CASE(r1cs_gg_ppzksnark_basic_test) {
     run_r1cs_gg_ppzksnark_basic_test<curves::mnt4<298>>(1000, 100);
 }
 
+BOOST_AUTO_TEST_CASE(r1cs_gg_ppzksnark_cpu_multiexp_backend_test) {
+    run_r1cs_gg_ppzksnark_multiexp_backend_test<curves::mnt4<298>,
+                                                r1cs_gg_ppzksnark_cpu_multiexp_backend<curves::mnt4<298>>>(100, 10);
+}
+
+BOOST_AUTO_TEST_CASE(r1cs_gg_ppzksnark_endomorphism_multiexp_backend_test) {
+    run_r1cs_gg_ppzksnark_multiexp_backend_test<curves::bls12<381>,
+                                                r1cs_gg_ppzksnark_endomorphism_multiexp_backend<curves::bls12<381>>>(
+        100, 10);
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_processed_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_processed_proving_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_batch_prover_test, r1cs_gg_ppzksnark_fixture) {
+    test_batch_prover();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_mapped_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_mapped_proving_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_compact_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_compact_proving_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_executor_test, r1cs_gg_ppzksnark_fixture) {
+    test_executor();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_streamed_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_streamed_proving_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_moved_constraint_system_test, r1cs_gg_ppzksnark_fixture) {
+    test_moved_constraint_system();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_batch_verifier_test, r1cs_gg_ppzksnark_fixture) {
+    test_batch_verifier();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_input_tables_test, r1cs_gg_ppzksnark_fixture) {
+    test_input_tables();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_mapped_verification_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_mapped_verification_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_affine_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_affine_proving_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_streamed_primary_input_test, r1cs_gg_ppzksnark_fixture) {
+    test_streamed_primary_input();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_input_cursor_verifier_test, r1cs_gg_ppzksnark_fixture) {
+    test_input_cursor_verifier();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_witness_program_test, r1cs_gg_ppzksnark_fixture) {
+    test_witness_program();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_distributed_prover_test, r1cs_gg_ppzksnark_fixture) {
+    test_distributed_prover();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_lagrange_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_lagrange_proving_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_sparse_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_sparse_proving_key();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_pipelined_prover_test, r1cs_gg_ppzksnark_fixture) {
+    test_pipelined_prover();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_incremental_prover_test, r1cs_gg_ppzksnark_fixture) {
+    test_incremental_prover();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_async_prover_test, r1cs_gg_ppzksnark_fixture) {
+    test_async_prover();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_memory_budget_test, r1cs_gg_ppzksnark_fixture) {
+    test_memory_budget();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_delta_update_test, r1cs_gg_ppzksnark_fixture) {
+    test_delta_update();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_qap_witness_prover_test, r1cs_gg_ppzksnark_fixture) {
+    test_qap_witness_prover();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_verification_key_registry_test, r1cs_gg_ppzksnark_fixture) {
+    test_verification_key_registry();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_deferred_verifier_test, r1cs_gg_ppzksnark_fixture) {
+    test_deferred_verifier();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_proof_validation_test, r1cs_gg_ppzksnark_fixture) {
+    test_proof_validation();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_span_inputs_test, r1cs_gg_ppzksnark_fixture) {
+    test_span_inputs();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_streamed_witness_test, r1cs_gg_ppzksnark_fixture) {
+    test_streamed_witness();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_warm_up_test, r1cs_gg_ppzksnark_fixture) {
+    test_warm_up();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_proving_key_cache_test, r1cs_gg_ppzksnark_fixture) {
+    test_proving_key_cache();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_generator_checkpoint_test, r1cs_gg_ppzksnark_fixture) {
+    test_generator_checkpoint();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_batch_affine_multiexp_test, r1cs_gg_ppzksnark_fixture) {
+    test_batch_affine_multiexp();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_split_multiexp_backend_test, r1cs_gg_ppzksnark_fixture) {
+    test_split_multiexp_backend();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_circuit_analytics_test, r1cs_gg_ppzksnark_fixture) {
+    test_circuit_analytics();
+}
+
+BOOST_FIXTURE_TEST_CASE(r1cs_gg_ppzksnark_bytecode_proving_key_test, r1cs_gg_ppzksnark_fixture) {
+    test_bytecode_proving_key();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
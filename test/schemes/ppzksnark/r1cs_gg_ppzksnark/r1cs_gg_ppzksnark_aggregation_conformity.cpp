@@ -25,11 +25,19 @@
 
 #define BOOST_TEST_MODULE r1cs_gg_ppzksnark_aggregation_test
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <memory>
 #include <vector>
 #include <tuple>
 #include <string>
 #include <utility>
 #include <random>
+#include <stdexcept>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/data/test_case.hpp>
@@ -44,15 +52,26 @@
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/commitment.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/srs.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/mapped_srs.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/prover.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/verifier.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/transcript.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/ipp2/aggregation_service.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/deferred_verifier.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/marshalling.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/many_proofs_verifier.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof_validation.hpp>
 
 #include <nil/crypto3/zk/snark/algorithms/prove.hpp>
 #include <nil/crypto3/zk/snark/algorithms/verify.hpp>
 
+#include <nil/crypto3/zk/snark/glv_endomorphism.hpp>
+
+#include "../r1cs_examples.hpp"
+#include "../../../temporary_path.hpp"
+
 using namespace nil::crypto3::algebra;
 using namespace nil::crypto3::zk::snark;
 
@@ -245,6 +264,16 @@ BOOST_AUTO_TEST_CASE(bls381_commitment_test) {
     BOOST_CHECK_EQUAL(vkey_compressed.b, et_v2_compressed);
     BOOST_CHECK_EQUAL(wkey_compressed.a, et_w1_compressed);
     BOOST_CHECK_EQUAL(wkey_compressed.b, et_w2_compressed);
+
+    r1cs_gg_ppzksnark_ipp2_commitment_key<g2_type> vkey_folded = vkey;
+    vkey_folded.fold(n / 2, c);
+    r1cs_gg_ppzksnark_ipp2_commitment_key<g1_type> wkey_folded = wkey;
+    wkey_folded.fold(n / 2, c);
+
+    BOOST_CHECK_EQUAL(vkey_folded.a, et_v1_compressed);
+    BOOST_CHECK_EQUAL(vkey_folded.b, et_v2_compressed);
+    BOOST_CHECK_EQUAL(wkey_folded.a, et_w1_compressed);
+    BOOST_CHECK_EQUAL(wkey_folded.b, et_w2_compressed);
 }
 
 BOOST_AUTO_TEST_CASE(bls381_polynomial_test) {
@@ -464,6 +493,59 @@ BOOST_AUTO_TEST_CASE(bls381_transcript_test) {
     tr.write<g2_type>(c);
     tr.write<gt_type>(d);
     BOOST_CHECK_EQUAL(et_res, tr.read_challenge());
+
+    // batch writes absorb the same bytes as the sequential ones
+    std::vector<fq12_value_type> ds = {d, d.inversed(), d * d};
+    transcript<> tr_seq(application_tag.begin(), application_tag.end());
+    transcript<> tr_batch(application_tag.begin(), application_tag.end());
+    for (const auto &d_i : ds) {
+        tr_seq.write<gt_type>(d_i);
+    }
+    tr_batch.write<gt_type>(ds.begin(), ds.end());
+    BOOST_CHECK_EQUAL(tr_seq.read_challenge(), tr_batch.read_challenge());
+
+    // transcripts forked from the static prefix go on like the ones hashing it
+    transcript<> tr_fork(transcript_prefix<curve_type, hash_type, random_r_transcript_prefix>());
+    tr_fork.write<scalar_field_type>(a);
+    tr_fork.write<g1_type>(b);
+    tr_fork.write<g2_type>(c);
+    tr_fork.write<gt_type>(d);
+    BOOST_CHECK_EQUAL(et_res, tr_fork.read_challenge());
+
+    transcript<> tr_prefix(tr_fork.snapshot());
+    BOOST_CHECK_EQUAL(tr_fork.read_challenge(), tr_prefix.read_challenge());
+
+    // buffered writes absorb the same bytes as hashing every element as soon as it is written, across
+    // the batch_bytes boundaries and the flushes of snapshots, domain separators and challenges
+    typedef nil::marshalling::curve_bincode<curve_type> bincode;
+    transcript<> tr_buffered(application_tag.begin(), application_tag.end());
+    transcript<> tr_unbuffered(application_tag.begin(), application_tag.end());
+    std::vector<std::uint8_t> bytes;
+    const std::size_t g1_size = bincode::get_element_size<g1_type>();
+    const std::size_t num_points = 3 * transcript<>::batch_bytes / g1_size + 1;
+    G1_value_type point = b;
+    for (std::size_t i = 0; i < num_points; ++i) {
+        tr_buffered.write<g1_type>(point);
+        bytes.resize(g1_size);
+        bincode::point_to_bytes<g1_type>(point, bytes.begin(), bytes.end());
+        tr_unbuffered.write_domain_separator(bytes.begin(), bytes.end());
+        point = point + b;
+
+        if (i == num_points / 3) {
+            transcript<> tr_snapshot(tr_buffered.snapshot());
+            BOOST_CHECK_EQUAL(tr_snapshot.read_challenge(), transcript<>(tr_unbuffered.snapshot()).read_challenge());
+        }
+        if (i == num_points / 2) {
+            tr_buffered.write_domain_separator(domain_separator.begin(), domain_separator.end());
+            tr_unbuffered.write_domain_separator(domain_separator.begin(), domain_separator.end());
+        }
+        if (i == 2 * num_points / 3) {
+            BOOST_CHECK_EQUAL(tr_buffered.read_challenge(), tr_unbuffered.read_challenge());
+        }
+    }
+    BOOST_CHECK_EQUAL(tr_buffered.read_challenge(), tr_unbuffered.read_challenge());
+    tr_buffered.write<scalar_field_type>(a);
+    BOOST_CHECK(tr_buffered.read_challenge() != tr_unbuffered.read_challenge());
 }
 
 BOOST_AUTO_TEST_CASE(bls381_gipa_tipp_mipp_test) {
@@ -598,30 +680,61 @@ BOOST_AUTO_TEST_CASE(bls381_prove_tipp_mipp_test) {
     BOOST_CHECK_EQUAL(tmp.gipa.final_wkey, tmipp_gp_final_wkey);
 }
 
-BOOST_AUTO_TEST_CASE(bls381_aggregate_proofs) {
-    constexpr std::size_t n = 8;
-
-    // setup_fake_srs
-    constexpr scalar_field_value_type alpha =
-        0x57aa5df37b9bd97a5e5f84f4797eac33e5ebe0c6e2ca2fbca1b3b3d7052ce35d_cppui255;
-    constexpr scalar_field_value_type beta =
-        0x43131d0617d95a6fbd46c1f9055f60e8028acaae2e6e7e500a471ed47553ecfe_cppui255;
-    r1cs_gg_pp_zksnark_aggregate_srs<curve_type> srs(n, alpha, beta);
-    auto [pk, vk] = srs.specialize(n);
-
-    r1cs_gg_ppzksnark_proof<curve_type> proof0 { G1_value_type(0x0ad9ab904d539e688d51dfd985c3ae5b48fe28b95503191282d47d6b366e2a53e21ae890306f52749d21666b98371708_cppui381, 0x1345e24d804d6be02cf1b3a941b916446d137b97c1a92fd36d3ea125d2faf000dcf622e3f602f558524c87546bc11483_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x026aeb313ea0d77bcfb724fd0898bb830365001a6b17c10e6926511c59af9c36dee091f5c5a8ef1dcaa2c242ca013159_cppui381, 0x1954c22621c04f4e80283616ca8e024a86c58062aed69c053849584a17ea39baefe2e3a6d9a81d771cf5240bf277bfc7_cppui381), fq2_value_type(0x00c2b1a57ca24010cd4b5eb1b7a3765bba0e16bba8e79bd137b5f3ee7b93c72f2a6f19aa74b30c05de75314c6027af8d_cppui381, 0x01334537a911f0f56d111198f3d1fa4f6d229e67acc36239e3880cbc298b2b400d75d2a35b9b190c31223e8dc77df6df_cppui381), fq2_value_type::one()),G1_value_type(0x01fa9d8671ec6696ae5766c83d7bfa9508ad0d94b36df00ada865979bfd005c60113655fcd19f37992eb842bb4bcae66_cppui381, 0x17df4c2aa0d841a72cc3187eb82ad56f83dcd1a392bfa175ef7da90a26963ab3f1cf3b364a0f1a9c8f1e74902451a96d_cppui381, fq_value_type::one()) };
-    r1cs_gg_ppzksnark_proof<curve_type> proof1 { G1_value_type(0x04950b72c0fbc98ed63bf338d331f95018e65821b0b63fe4776c8e189453da8a71de4ed86be50c3729f17642dcac7579_cppui381, 0x00b1f015a6c9c93805ecb0a8143e0c202d5b086f31f4420d91d7eda4e19d744f29b5dcae6313d088098a7376e7f1d38d_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x0dce4e7e35ed6949e7132c280ead2bd33bea3d5afd8d5ae33ddd71fd81b6624d4baa4aa50bb4fc61ab3b6475dce4ecc3_cppui381, 0x08da12416a18cb4fad2a56ae2be196187d48b9f733c4a9f8f0383fddf6b06e37e46c41d5b62ddb976315864ee51a351f_cppui381), fq2_value_type(0x14f633126ba39da981d4f3676c0ad2d0879abcdfba33c122bab88ff0494a7c425793164cc07b42d13127f26b28301e01_cppui381, 0x0c7d788fbb2a93b89bee19a9f51903507a3b1bade0045d4827fc52d4ad9effc6a972bc55ae8a4418949bf582a7e57f3f_cppui381), fq2_value_type::one()),G1_value_type(0x100fad40d4778047cb2c02c53afecd6b25204d7cce9d11e3ea2f7844accf6380ec9b421d5f0656a8c9be03a58ac0e78b_cppui381, 0x0ebc959bd8afb8eefe2904f9cf7831fe95bc946f8dfeb7c2f6f4e3d39bb99f2d966df2ed51580b8536cbd24cd042037e_cppui381, fq_value_type::one()) };
-    r1cs_gg_ppzksnark_proof<curve_type> proof2 { G1_value_type(0x13959f8f1cf314f0d36de6fcf1a37e3c8c3fc31c7087613d6e209a56e48b6cad49d1ac0b9a522a1e397b05e33a606496_cppui381, 0x0e1ce1604e9a6bab679a7a6e60c2d8ca1553e5daa493b14a652817c903b0db4e923a483fd31eb433e2c26e28d669d3fd_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x0371fb9497ccc88fd0a002f32b7b25dfafabda8f1e199e3b782bf298bd6e3090ca1e2428017ec810c1f8e230a23199b0_cppui381, 0x0d0ba3656cc98288785f04078f95f26d44a4986998cf70566e2fb951abb12dd597f650f9cfb2ccb0ea02d009b00d71d1_cppui381), fq2_value_type(0x18878ec7f9cc8af17133d57bc9037e5f85959d60354c499c60f28d09835e25bcbe3d1cc51a0afba06272ac4d48e46c64_cppui381, 0x0e35c4a708d02101b8aff1356e580f5b5ef57d6be16502002d5576bdb2210450a46db93e1fff3161064d486b92b086d7_cppui381), fq2_value_type::one()),G1_value_type(0x049ec2af3342cc36e49f5533488d495cb7222121d0836952fc879f3fb46f073a3f6c4328a4acac5d86a99a784c188718_cppui381, 0x02c9a8fe286b1b976549d57fd3d677f393b630cc1357b5f90c11b0482cebaa97e8e0b927a4b2b8c39eb4b1af85c144ba_cppui381, fq_value_type::one()) };
-    r1cs_gg_ppzksnark_proof<curve_type> proof3 { G1_value_type(0x09f1a68bb0428c34179c3c375ebb2c3f8c8b25975163ecaa6e71e690f76c2fa2d5022e20ca8035f6ae4231e36c9194c8_cppui381, 0x06df98360b6aa4f1ca6c3e96dad4544be0119c7ed208224a1201ce03759813daec68d5a940e1095cd5f1661c2c6c68a2_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x06aab594ec527722a6541fad603b5fb788e1806d750560e1c4ad95e43305de35f1fc56ad9e45458df56c9fa78936cdac_cppui381, 0x1988328897e57d1fa847d2dbacbc46e0ab1c936e595e726d81a451e932de637420d8499a11fea29a50792fd8ef4347e1_cppui381), fq2_value_type(0x106c544e28d5d00accc9f6ac307d3ef08933969cf352682baab21e60589e8581115131207b18280026b78807d6a49f1e_cppui381, 0x03082285d382aaa13230a4895dd3da142a25fdce91165eac137901ac2c1964278fa9de8313039bc1f28e8f3af0e5f6e8_cppui381), fq2_value_type::one()),G1_value_type(0x1140867bb1399cc013b41291e4127f926e1400281e533e4eb0586052622d51ae135f91eb21c4aa8ed5d85cb68129cc4a_cppui381, 0x0e59f5f7cdf0605c0bb524256c3fa9c8186ec31024b6eb71c01ee9da576678a7d83f777feebf11c470484daf2e78c04f_cppui381, fq_value_type::one()) };
-    r1cs_gg_ppzksnark_proof<curve_type> proof4 { G1_value_type(0x07eebe2a51ff54027dc2e9333736203449cf0fef6cc7b4539f8962e8f803e98d01d308984c8a437cf38636586c954646_cppui381, 0x09677592e47aaf01cb77fa2fd567389c3c06ab63944fd43d6538b5da3405d9c152869535abfe1bae1820f0ae744e71f6_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x15276efc1aa8908a0e13029274887e6e599603cf6ec63c3293f2178bf282fc5cd8ad4e2ee971eb945063719cdc67b655_cppui381, 0x13164f607512d0035923ac0f34333328917f598fb74e30fba45bfae098ed39e43a7b299fa871a91f1d2e3aa28d546577_cppui381), fq2_value_type(0x0234b5566ba1443b3d71a4d597b984c5e0401ab0c92394521152ffed6a15e6bb616cf454b2597f37d1d6d0825d99a460_cppui381, 0x0c28c5010a6ac31f5af16ce861fef465d978c534d602b3042e42b766997521a965afb25a00e3d91aa393482f81e87a2a_cppui381), fq2_value_type::one()),G1_value_type(0x0b39ea2f3908a057e90045269c343aa12c7c755fd7cb5f23a6774f4dd0e23097ae77b984d4b59d5e585161e759777c79_cppui381, 0x0c76a611c26bf59d9edc44baac48a21ddb3e45c65ec845da57c5d7c683bb18154459b42aa305bed45462014157dcbe5f_cppui381, fq_value_type::one()) };
-    r1cs_gg_ppzksnark_proof<curve_type> proof5 { G1_value_type(0x0e6d89bd7ef0b93907916d3903b6c49adb1535071d6f681e03e687dfe90d9c7e74a0f55be0bcc42c9b16e2e99653504c_cppui381, 0x03413cf7e4d3c43f02ffbce3682dc7886793f821efb7bb28000537b1f7b4951f34f3293013f6fd3c211979966b5fac69_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x058ecb344b1465e18c0ef4893bd06f7f323a56120e948c04488fdffd27b511db0bac296a81b46c660957dd3a923ba51d_cppui381, 0x10c18ef70e107e145a254406337969dc20cc85bc22ea6acb14d39394760ed95f5a37b8fa6495bb347986e50678b9432d_cppui381), fq2_value_type(0x04c87764181d768e4b6ae9997cc9c62188e856fd650cfdfb260ff4a917da064d9429978b33012de0caafb1b3d4134547_cppui381, 0x07bee15dbe062c38b2dd97bad78c2bcd36b1d09228a0581fd38493873b4e22654114d2320e25afb7136857355bfe3bc8_cppui381), fq2_value_type::one()),G1_value_type(0x095b0c84330dbd160a40254ecadf867204780ac0324b4912a90e75e0224c4457dfa4d4d4d6231f6520d93480b0b43a63_cppui381, 0x0430bc5b9127edd363bd0adcc3f957dd4fae7410a36a0b599f87eebaaf304fa23c8c392ad6902793f358f57e1acfa5ec_cppui381, fq_value_type::one()) };
-    r1cs_gg_ppzksnark_proof<curve_type> proof6 { G1_value_type(0x16dafd3b138ce9789864f661810d80f3a27559d59fc7c7c2423a8a2e5d12c319d362f74d6231d998a8b1d3f5858b85a2_cppui381, 0x0d68d83c3beb8e6ae1bae0f6069246d9138a39bb49714fe1dbdac7ec72db27b2535cf62d9d316a2715c0be92df37c9c4_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x063473ae18d079f24f7fde90e0e613e7d1d736f761c00399767260637fad11ab995c6f45c600307f8b43e9e39db3efb1_cppui381, 0x091f08c799bb8ee1e3e3e9a7aed1bfe320e2a44db3b09e35fc72647155af6d11dc45661a4a231bde00b1750cf8f5fd94_cppui381), fq2_value_type(0x162465ff561f7eddb102f9b79ff9022c2046489602dad7ce1a6347c10868324d2f0bff43dd3cbcd637050afe6813588f_cppui381, 0x0eba1cc671c6e28c2558a8a8de94ca3828b6ef68821d0329becd029d57a4dedc4b6b8e107512b95d8b0864d017c91f75_cppui381), fq2_value_type::one()),G1_value_type(0x0c65859ee85e435fd159631a5cdb53c81746d75b8bd39bcda4290b774cdef5a45fc136e29e85ae604065f2a95ee120c4_cppui381, 0x10044930ad3a76b06c0965b63e3ce70777bc5e0e1a471cdcf60cbbbbd85bde3cabea6def846ff8b29824ba6ab8e0fe70_cppui381, fq_value_type::one()) };
-    r1cs_gg_ppzksnark_proof<curve_type> proof7 { G1_value_type(0x14b8d9ff73badbeb796cf47a06178948d6f2aae6115dc7033e2f24835c3d81a0abb143c13cd4f5ec97bd7972008572ea_cppui381, 0x16743804ee158723da1b39a549bdbfc29ab503f4e8015e7f83cb0f7e486e9907e721b5319ba117b54a81712a7029b1fc_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x0be8424bd528ad671ec62204e1d8bf1a633e40a9271535fab37992aaa2523003e2e8fb22136f4e5b5205c2df7a0f40e8_cppui381, 0x092c9c93a278821ce9d7d0dad3dd01457ef2acbedf3d51596180ebfeac0f49956690c84b09d66f05287632c1b98edd5f_cppui381), fq2_value_type(0x06b7812dac5bd4cdc995e6a07972aae556e0a1f63e8402b8b6f64064a57d27fee410079e5a1f64dea586903ebab7d4c5_cppui381, 0x0e83148931c3a1e5215f68bca10b70fe0c1ae09e1de0f3076d19532a08877af35c12ae87b1dcee68cb7d089d70c37d77_cppui381), fq2_value_type::one()),G1_value_type(0x0661e59a523ad7c7a6753f1e70a6aa3eca1a1a650dcc6941e18194821681719496b8f2c10b976db51fc9e296418e1ae7_cppui381, 0x13727560e334f46eff7575d562ef0aebd34d9b174767a8fa99e0c96afce0749cd629a801bf2951a28b8e15238044a655_cppui381, fq_value_type::one()) };
-    std::array<r1cs_gg_ppzksnark_proof<curve_type>, n> proofs_vec {
-        {proof0, proof1, proof2, proof3, proof4, proof5, proof6, proof7}};
-
+/* The generic srs of the aggregation of random proofs, and its keys for n proofs. */
+struct bls381_srs_fixture {
+    static constexpr std::size_t n = 8;
+
+    static r1cs_gg_pp_zksnark_aggregate_srs<curve_type> generic_srs() {
+        constexpr scalar_field_value_type alpha =
+            0x57aa5df37b9bd97a5e5f84f4797eac33e5ebe0c6e2ca2fbca1b3b3d7052ce35d_cppui255;
+        constexpr scalar_field_value_type beta =
+            0x43131d0617d95a6fbd46c1f9055f60e8028acaae2e6e7e500a471ed47553ecfe_cppui255;
+
+        // setup_fake_srs
+        return r1cs_gg_pp_zksnark_aggregate_srs<curve_type>(n, alpha, beta);
+    }
+
+    bls381_srs_fixture() : srs(generic_srs()), keys(srs.specialize(n)) {
+    }
+
+    r1cs_gg_pp_zksnark_aggregate_srs<curve_type> srs;
+    r1cs_gg_pp_zksnark_aggregate_srs<curve_type>::srs_pair_type keys;
+    const r1cs_gg_ppzksnark_aggregate_proving_srs<curve_type> &pk = keys.first;
+    const r1cs_gg_ppzksnark_aggregate_verification_srs<curve_type> &vk = keys.second;
+};
+
+/* Random proofs to aggregate over the srs of bls381_srs_fixture. */
+struct bls381_proofs_fixture : bls381_srs_fixture {
+    bls381_proofs_fixture() {
+        r1cs_gg_ppzksnark_proof<curve_type> proof0 { G1_value_type(0x0ad9ab904d539e688d51dfd985c3ae5b48fe28b95503191282d47d6b366e2a53e21ae890306f52749d21666b98371708_cppui381, 0x1345e24d804d6be02cf1b3a941b916446d137b97c1a92fd36d3ea125d2faf000dcf622e3f602f558524c87546bc11483_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x026aeb313ea0d77bcfb724fd0898bb830365001a6b17c10e6926511c59af9c36dee091f5c5a8ef1dcaa2c242ca013159_cppui381, 0x1954c22621c04f4e80283616ca8e024a86c58062aed69c053849584a17ea39baefe2e3a6d9a81d771cf5240bf277bfc7_cppui381), fq2_value_type(0x00c2b1a57ca24010cd4b5eb1b7a3765bba0e16bba8e79bd137b5f3ee7b93c72f2a6f19aa74b30c05de75314c6027af8d_cppui381, 0x01334537a911f0f56d111198f3d1fa4f6d229e67acc36239e3880cbc298b2b400d75d2a35b9b190c31223e8dc77df6df_cppui381), fq2_value_type::one()),G1_value_type(0x01fa9d8671ec6696ae5766c83d7bfa9508ad0d94b36df00ada865979bfd005c60113655fcd19f37992eb842bb4bcae66_cppui381, 0x17df4c2aa0d841a72cc3187eb82ad56f83dcd1a392bfa175ef7da90a26963ab3f1cf3b364a0f1a9c8f1e74902451a96d_cppui381, fq_value_type::one()) };
+        r1cs_gg_ppzksnark_proof<curve_type> proof1 { G1_value_type(0x04950b72c0fbc98ed63bf338d331f95018e65821b0b63fe4776c8e189453da8a71de4ed86be50c3729f17642dcac7579_cppui381, 0x00b1f015a6c9c93805ecb0a8143e0c202d5b086f31f4420d91d7eda4e19d744f29b5dcae6313d088098a7376e7f1d38d_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x0dce4e7e35ed6949e7132c280ead2bd33bea3d5afd8d5ae33ddd71fd81b6624d4baa4aa50bb4fc61ab3b6475dce4ecc3_cppui381, 0x08da12416a18cb4fad2a56ae2be196187d48b9f733c4a9f8f0383fddf6b06e37e46c41d5b62ddb976315864ee51a351f_cppui381), fq2_value_type(0x14f633126ba39da981d4f3676c0ad2d0879abcdfba33c122bab88ff0494a7c425793164cc07b42d13127f26b28301e01_cppui381, 0x0c7d788fbb2a93b89bee19a9f51903507a3b1bade0045d4827fc52d4ad9effc6a972bc55ae8a4418949bf582a7e57f3f_cppui381), fq2_value_type::one()),G1_value_type(0x100fad40d4778047cb2c02c53afecd6b25204d7cce9d11e3ea2f7844accf6380ec9b421d5f0656a8c9be03a58ac0e78b_cppui381, 0x0ebc959bd8afb8eefe2904f9cf7831fe95bc946f8dfeb7c2f6f4e3d39bb99f2d966df2ed51580b8536cbd24cd042037e_cppui381, fq_value_type::one()) };
+        r1cs_gg_ppzksnark_proof<curve_type> proof2 { G1_value_type(0x13959f8f1cf314f0d36de6fcf1a37e3c8c3fc31c7087613d6e209a56e48b6cad49d1ac0b9a522a1e397b05e33a606496_cppui381, 0x0e1ce1604e9a6bab679a7a6e60c2d8ca1553e5daa493b14a652817c903b0db4e923a483fd31eb433e2c26e28d669d3fd_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x0371fb9497ccc88fd0a002f32b7b25dfafabda8f1e199e3b782bf298bd6e3090ca1e2428017ec810c1f8e230a23199b0_cppui381, 0x0d0ba3656cc98288785f04078f95f26d44a4986998cf70566e2fb951abb12dd597f650f9cfb2ccb0ea02d009b00d71d1_cppui381), fq2_value_type(0x18878ec7f9cc8af17133d57bc9037e5f85959d60354c499c60f28d09835e25bcbe3d1cc51a0afba06272ac4d48e46c64_cppui381, 0x0e35c4a708d02101b8aff1356e580f5b5ef57d6be16502002d5576bdb2210450a46db93e1fff3161064d486b92b086d7_cppui381), fq2_value_type::one()),G1_value_type(0x049ec2af3342cc36e49f5533488d495cb7222121d0836952fc879f3fb46f073a3f6c4328a4acac5d86a99a784c188718_cppui381, 0x02c9a8fe286b1b976549d57fd3d677f393b630cc1357b5f90c11b0482cebaa97e8e0b927a4b2b8c39eb4b1af85c144ba_cppui381, fq_value_type::one()) };
+        r1cs_gg_ppzksnark_proof<curve_type> proof3 { G1_value_type(0x09f1a68bb0428c34179c3c375ebb2c3f8c8b25975163ecaa6e71e690f76c2fa2d5022e20ca8035f6ae4231e36c9194c8_cppui381, 0x06df98360b6aa4f1ca6c3e96dad4544be0119c7ed208224a1201ce03759813daec68d5a940e1095cd5f1661c2c6c68a2_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x06aab594ec527722a6541fad603b5fb788e1806d750560e1c4ad95e43305de35f1fc56ad9e45458df56c9fa78936cdac_cppui381, 0x1988328897e57d1fa847d2dbacbc46e0ab1c936e595e726d81a451e932de637420d8499a11fea29a50792fd8ef4347e1_cppui381), fq2_value_type(0x106c544e28d5d00accc9f6ac307d3ef08933969cf352682baab21e60589e8581115131207b18280026b78807d6a49f1e_cppui381, 0x03082285d382aaa13230a4895dd3da142a25fdce91165eac137901ac2c1964278fa9de8313039bc1f28e8f3af0e5f6e8_cppui381), fq2_value_type::one()),G1_value_type(0x1140867bb1399cc013b41291e4127f926e1400281e533e4eb0586052622d51ae135f91eb21c4aa8ed5d85cb68129cc4a_cppui381, 0x0e59f5f7cdf0605c0bb524256c3fa9c8186ec31024b6eb71c01ee9da576678a7d83f777feebf11c470484daf2e78c04f_cppui381, fq_value_type::one()) };
+        r1cs_gg_ppzksnark_proof<curve_type> proof4 { G1_value_type(0x07eebe2a51ff54027dc2e9333736203449cf0fef6cc7b4539f8962e8f803e98d01d308984c8a437cf38636586c954646_cppui381, 0x09677592e47aaf01cb77fa2fd567389c3c06ab63944fd43d6538b5da3405d9c152869535abfe1bae1820f0ae744e71f6_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x15276efc1aa8908a0e13029274887e6e599603cf6ec63c3293f2178bf282fc5cd8ad4e2ee971eb945063719cdc67b655_cppui381, 0x13164f607512d0035923ac0f34333328917f598fb74e30fba45bfae098ed39e43a7b299fa871a91f1d2e3aa28d546577_cppui381), fq2_value_type(0x0234b5566ba1443b3d71a4d597b984c5e0401ab0c92394521152ffed6a15e6bb616cf454b2597f37d1d6d0825d99a460_cppui381, 0x0c28c5010a6ac31f5af16ce861fef465d978c534d602b3042e42b766997521a965afb25a00e3d91aa393482f81e87a2a_cppui381), fq2_value_type::one()),G1_value_type(0x0b39ea2f3908a057e90045269c343aa12c7c755fd7cb5f23a6774f4dd0e23097ae77b984d4b59d5e585161e759777c79_cppui381, 0x0c76a611c26bf59d9edc44baac48a21ddb3e45c65ec845da57c5d7c683bb18154459b42aa305bed45462014157dcbe5f_cppui381, fq_value_type::one()) };
+        r1cs_gg_ppzksnark_proof<curve_type> proof5 { G1_value_type(0x0e6d89bd7ef0b93907916d3903b6c49adb1535071d6f681e03e687dfe90d9c7e74a0f55be0bcc42c9b16e2e99653504c_cppui381, 0x03413cf7e4d3c43f02ffbce3682dc7886793f821efb7bb28000537b1f7b4951f34f3293013f6fd3c211979966b5fac69_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x058ecb344b1465e18c0ef4893bd06f7f323a56120e948c04488fdffd27b511db0bac296a81b46c660957dd3a923ba51d_cppui381, 0x10c18ef70e107e145a254406337969dc20cc85bc22ea6acb14d39394760ed95f5a37b8fa6495bb347986e50678b9432d_cppui381), fq2_value_type(0x04c87764181d768e4b6ae9997cc9c62188e856fd650cfdfb260ff4a917da064d9429978b33012de0caafb1b3d4134547_cppui381, 0x07bee15dbe062c38b2dd97bad78c2bcd36b1d09228a0581fd38493873b4e22654114d2320e25afb7136857355bfe3bc8_cppui381), fq2_value_type::one()),G1_value_type(0x095b0c84330dbd160a40254ecadf867204780ac0324b4912a90e75e0224c4457dfa4d4d4d6231f6520d93480b0b43a63_cppui381, 0x0430bc5b9127edd363bd0adcc3f957dd4fae7410a36a0b599f87eebaaf304fa23c8c392ad6902793f358f57e1acfa5ec_cppui381, fq_value_type::one()) };
+        r1cs_gg_ppzksnark_proof<curve_type> proof6 { G1_value_type(0x16dafd3b138ce9789864f661810d80f3a27559d59fc7c7c2423a8a2e5d12c319d362f74d6231d998a8b1d3f5858b85a2_cppui381, 0x0d68d83c3beb8e6ae1bae0f6069246d9138a39bb49714fe1dbdac7ec72db27b2535cf62d9d316a2715c0be92df37c9c4_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x063473ae18d079f24f7fde90e0e613e7d1d736f761c00399767260637fad11ab995c6f45c600307f8b43e9e39db3efb1_cppui381, 0x091f08c799bb8ee1e3e3e9a7aed1bfe320e2a44db3b09e35fc72647155af6d11dc45661a4a231bde00b1750cf8f5fd94_cppui381), fq2_value_type(0x162465ff561f7eddb102f9b79ff9022c2046489602dad7ce1a6347c10868324d2f0bff43dd3cbcd637050afe6813588f_cppui381, 0x0eba1cc671c6e28c2558a8a8de94ca3828b6ef68821d0329becd029d57a4dedc4b6b8e107512b95d8b0864d017c91f75_cppui381), fq2_value_type::one()),G1_value_type(0x0c65859ee85e435fd159631a5cdb53c81746d75b8bd39bcda4290b774cdef5a45fc136e29e85ae604065f2a95ee120c4_cppui381, 0x10044930ad3a76b06c0965b63e3ce70777bc5e0e1a471cdcf60cbbbbd85bde3cabea6def846ff8b29824ba6ab8e0fe70_cppui381, fq_value_type::one()) };
+        r1cs_gg_ppzksnark_proof<curve_type> proof7 { G1_value_type(0x14b8d9ff73badbeb796cf47a06178948d6f2aae6115dc7033e2f24835c3d81a0abb143c13cd4f5ec97bd7972008572ea_cppui381, 0x16743804ee158723da1b39a549bdbfc29ab503f4e8015e7f83cb0f7e486e9907e721b5319ba117b54a81712a7029b1fc_cppui381, fq_value_type::one()),G2_value_type(fq2_value_type(0x0be8424bd528ad671ec62204e1d8bf1a633e40a9271535fab37992aaa2523003e2e8fb22136f4e5b5205c2df7a0f40e8_cppui381, 0x092c9c93a278821ce9d7d0dad3dd01457ef2acbedf3d51596180ebfeac0f49956690c84b09d66f05287632c1b98edd5f_cppui381), fq2_value_type(0x06b7812dac5bd4cdc995e6a07972aae556e0a1f63e8402b8b6f64064a57d27fee410079e5a1f64dea586903ebab7d4c5_cppui381, 0x0e83148931c3a1e5215f68bca10b70fe0c1ae09e1de0f3076d19532a08877af35c12ae87b1dcee68cb7d089d70c37d77_cppui381), fq2_value_type::one()),G1_value_type(0x0661e59a523ad7c7a6753f1e70a6aa3eca1a1a650dcc6941e18194821681719496b8f2c10b976db51fc9e296418e1ae7_cppui381, 0x13727560e334f46eff7575d562ef0aebd34d9b174767a8fa99e0c96afce0749cd629a801bf2951a28b8e15238044a655_cppui381, fq_value_type::one()) };
+        proofs_vec = {{proof0, proof1, proof2, proof3, proof4, proof5, proof6, proof7}};
+    }
+
+    std::array<r1cs_gg_ppzksnark_proof<curve_type>, n> proofs_vec;
     std::array<std::uint8_t, 3> tr_inc {1, 2, 3};
+};
+
+/* The aggregate of the proofs of bls381_proofs_fixture, which the other ways of aggregating them must give. */
+struct bls381_aggregate_fixture : bls381_proofs_fixture {
+    r1cs_gg_ppzksnark_aggregate_proof<curve_type> agg_proof =
+        aggregate_proofs<curve_type>(pk, tr_inc.begin(), tr_inc.end(), proofs_vec.begin(), proofs_vec.end());
+};
+
+// two aggregates of the same proofs agree on their commitments, their aggregated products and first GIPA round
+bool same_aggregate(const r1cs_gg_ppzksnark_aggregate_proof<curve_type> &a,
+                    const r1cs_gg_ppzksnark_aggregate_proof<curve_type> &b) {
+    return a.com_ab == b.com_ab && a.com_c == b.com_c && a.ip_ab == b.ip_ab && a.agg_c == b.agg_c &&
+           a.tmipp.gipa.comms_ab == b.tmipp.gipa.comms_ab;
+}
 
+BOOST_FIXTURE_TEST_CASE(bls381_aggregate_proofs, bls381_proofs_fixture) {
     // r1cs_gg_ppzksnark_aggregate_proof<curve_type> agg_proof =
     //     aggregate_proofs<curve_type>(pk, tr_inc.begin(), tr_inc.end(), proofs_vec.begin(), proofs_vec.end());
     auto agg_proof =
@@ -664,17 +777,75 @@ BOOST_AUTO_TEST_CASE(bls381_aggregate_proofs) {
 
 }
 
-BOOST_AUTO_TEST_CASE(bls381_verification) {
-    constexpr std::size_t n = 8;
-    constexpr scalar_field_value_type alpha =
-        0x57aa5df37b9bd97a5e5f84f4797eac33e5ebe0c6e2ca2fbca1b3b3d7052ce35d_cppui255;
-    constexpr scalar_field_value_type beta =
-        0x43131d0617d95a6fbd46c1f9055f60e8028acaae2e6e7e500a471ed47553ecfe_cppui255;
+// appending the proofs one by one to an aggregator gives the proof of aggregate_proofs
+BOOST_FIXTURE_TEST_CASE(bls381_streamed_aggregate_proofs, bls381_aggregate_fixture) {
+    scheme_type::aggregator_type<hashes::sha2<256>> aggregator(pk);
+    for (const auto &proof : proofs_vec) {
+        aggregator.append(proof);
+    }
+    BOOST_CHECK(same_aggregate(aggregator.finalize(tr_inc.begin(), tr_inc.end()), agg_proof));
+}
 
-    // setup_fake_srs
-    r1cs_gg_pp_zksnark_aggregate_srs<curve_type> srs(n, alpha, beta);
-    auto [pk, vk] = srs.specialize(n);
+// an aggregator given fewer proofs than the srs pads them with the last one
+BOOST_FIXTURE_TEST_CASE(bls381_padded_aggregate_proofs, bls381_proofs_fixture) {
+    std::array<r1cs_gg_ppzksnark_proof<curve_type>, n> padded_proofs_vec {{proofs_vec[0], proofs_vec[1], proofs_vec[2],
+                                                                           proofs_vec[3], proofs_vec[4], proofs_vec[5],
+                                                                           proofs_vec[5], proofs_vec[5]}};
+    auto padded_agg_proof = aggregate_proofs<curve_type>(pk, tr_inc.begin(), tr_inc.end(), padded_proofs_vec.begin(),
+                                                         padded_proofs_vec.end());
+    scheme_type::aggregator_type<hashes::sha2<256>> padding_aggregator(pk);
+    for (std::size_t i = 0; i < 6; ++i) {
+        padding_aggregator.append(proofs_vec[i]);
+    }
+    auto streamed_padded_agg_proof = padding_aggregator.finalize(tr_inc.begin(), tr_inc.end());
+    BOOST_CHECK_EQUAL(padding_aggregator.size(), n);
+    BOOST_CHECK(same_aggregate(padded_agg_proof, streamed_padded_agg_proof));
+}
+
+// the precomputed lines of the commitment key give the same proof, aggregated at once or streamed
+BOOST_FIXTURE_TEST_CASE(bls381_prepared_aggregate_proofs, bls381_aggregate_fixture) {
+    scheme_type::prepared_proving_srs_type prepared_pk(pk);
+    BOOST_CHECK(same_aggregate(
+        aggregate_proofs<curve_type>(prepared_pk, tr_inc.begin(), tr_inc.end(), proofs_vec.begin(), proofs_vec.end()),
+        agg_proof));
+    scheme_type::aggregator_type<hashes::sha2<256>> prepared_aggregator(prepared_pk);
+    for (const auto &proof : proofs_vec) {
+        prepared_aggregator.append(proof);
+    }
+    BOOST_CHECK(same_aggregate(prepared_aggregator.finalize(tr_inc.begin(), tr_inc.end()), agg_proof));
+}
 
+// aggregating a proof batch gives the same proof as aggregating its proofs
+BOOST_FIXTURE_TEST_CASE(bls381_proof_batch_aggregate_proofs, bls381_aggregate_fixture) {
+    const scheme_type::proof_batch_type proof_batch(proofs_vec.begin(), proofs_vec.end());
+    BOOST_CHECK(same_aggregate(
+        prove<scheme_type, hashes::sha2<256>>(pk, tr_inc.begin(), tr_inc.end(), proof_batch), agg_proof));
+}
+
+// a traced aggregation gives the same proof and one round per halving of the proofs
+BOOST_FIXTURE_TEST_CASE(bls381_traced_aggregate_proofs, bls381_aggregate_fixture) {
+    auto traced = trace_aggregation([&] {
+        return aggregate_proofs<curve_type>(pk, tr_inc.begin(), tr_inc.end(), proofs_vec.begin(), proofs_vec.end());
+    });
+    BOOST_CHECK(same_aggregate(traced.first, agg_proof));
+    BOOST_CHECK_EQUAL(traced.second.rounds.size(), 3);
+    BOOST_CHECK_EQUAL(traced.second.rounds.front().size, n);
+    BOOST_CHECK_EQUAL(traced.second.rounds.back().size, 2);
+}
+
+// a GIPA deriving the commitment keys by chunks until they fit the bound gives the same proof
+BOOST_FIXTURE_TEST_CASE(bls381_memory_bound_aggregate_proofs, bls381_aggregate_fixture) {
+    for (std::size_t max_key_size : {1, 2, 4}) {
+        gipa_memory_bound::scope bound(max_key_size);
+        auto bounded_agg_proof =
+            aggregate_proofs<curve_type>(pk, tr_inc.begin(), tr_inc.end(), proofs_vec.begin(), proofs_vec.end());
+        BOOST_CHECK(same_aggregate(bounded_agg_proof, agg_proof));
+        BOOST_CHECK(bounded_agg_proof.tmipp.gipa.final_vkey == agg_proof.tmipp.gipa.final_vkey);
+        BOOST_CHECK(bounded_agg_proof.tmipp.gipa.final_wkey == agg_proof.tmipp.gipa.final_wkey);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(bls381_verification, bls381_srs_fixture) {
     std::vector<G2_value_type> pk_vkey_a = {G2_value_type(fq2_value_type(0x024aa2b2f08f0a91260805272dc51051c6e47ad4fa403b02b4510b647ae3d1770bac0326a805bbefd48056c8c121bdb8_cppui381, 0x13e02b6052719f607dacd3a088274f65596bd0d09920b61ab5da61bbdc7f5049334cf11213945d57e5ac7d055d042b7e_cppui381), fq2_value_type(0x0ce5d527727d6e118cc9cdc6da2e351aadfd9baa8cbdd3a76d429a695160d12c923ac9cc3baca289e193548608b82801_cppui381, 0x0606c4a02ea734cc32acd2b02bc28b99cb3e287e85a763af267492ab572e99ab3f370d275cec1da1aaa9075ff05f79be_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x13e5257ffce3eed808841bcaba1a63f907e51c5452ed1d712d2a80ad5b25054a85b921708f89c7192344e81ef4c2d18e_cppui381, 0x09843c0db7c3e6376559357d41d1d17049e22557e678eca1eeb8d46edb02049159a2a16f3a74aa49fb2b1aabe13e882f_cppui381), fq2_value_type(0x08f60d805b4372d432b2083614477fc24ba9bfcd450f86d05e4634139ad11307fb8a39679f837db216620320c40dd10d_cppui381, 0x0059498ec17559ff4e7f19c9601a8fc6d1100680acdad1b332575bdef424daed6b989e18ad96e7f15858a336730d23a0_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x07cc3cecf1bf7b4302b549e6094806c3e92c83ab71885ea649d7bea56722a79cd5001ecc8bd7719f5dac452fde2dc27d_cppui381, 0x155ba4651c0c2b45d4791035947c0416579d9dfe604c94e26f15acfe1c6a4bb3ba5193ef7ef31dbf458571704f8beee5_cppui381), fq2_value_type(0x14f94da9ed09785f1041a7b998cabd45f472f3f499f9f48d6aac1660809c8a6d0dfb4f16a4ddca70125b61369d4e96b0_cppui381, 0x04272ed3d067c55f4c3e140e8333ae3711e6b82db32fc5a1f7f7da144499b8a7af62f7fcbf49b53f1b0f068be7eccfd0_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x09825619542ee8320ff4f5ba380fd3282ec16026beff6651648162cce26452e187c30be5fbd5f929f3f32c0c02860ca1_cppui381, 0x0cc2ee914ca20bf39af2e0f3c0193ae301a2a3b978f55df8f87d2c7b9512ec0d83185450ce7b83e4da4a5276bf1de448_cppui381), fq2_value_type(0x135a5110ab1d4581f1d213909b0e36efa8e0009de0065a6bd68374429ea80a9767172f12420ad616d4edd7346942cb6e_cppui381, 0x0317f9c89ca98f293f8c52b8350938fdd1cd9de5d0e7fd67db5ee0daaf60dedd7504741a7dd2548520eab87a082739c8_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x02e1b72552a6bb211c01ca8701d58a62d9e43110853bd12bac43b76244b41ed90a112585169938ce675106e205b9f984_cppui381, 0x017a3560faca0a1a19017debea64721060a4299ab0e9839a7cbc436d47ad8551652fdb9b34814d8fd4d56d191f7f965a_cppui381), fq2_value_type(0x0e14db737c6803325d53f89823090a4310ab2deaa428cfb07dbc8563ff3dee66d67c5872923c863c03a44f7e73fadcbc_cppui381, 0x04893331cc41c22fc44daadfbaa8ee50757ca1ae5753fb8ff92323fd1da33459974bb3eb433b54076e52a2ec85ab0ba8_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x01ff99b80855d463be989bf8afe767a8dd3d99ba24e26d337c5ed0c8cb52aed049354122e55a58215783a539ff6f14e7_cppui381, 0x082ca3714156b517d6554fe1ff1a68a8684e988c0bf359bc5373cbd63724da39197f1590f83efd437d81e5dc66dfc05f_cppui381), fq2_value_type(0x06b7875ef9235e62a37801738d05502341ee0a0a407ba1a85918f5cc3c31f0c62b6ba63169c1fb03230995527eda1b32_cppui381, 0x0ba03538196408591e4ac5335ecd09d104a18944d81d0fd174f9d2beaafe4b65efedb88b514589ae615f0549cadca6a8_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x05cb7cb2ff51aa91b53e62decb5170e2bd6646aec10c729aae308b9601d961b2f2a8d360e247ed6b8e32dbfbc186ecfc_cppui381, 0x13c560f1b44a70ab6cb5543bbe006e729c6d47f6ebf264561aad33aa057be5cd63152d0fb309be094ce5a4a64eb8a74a_cppui381), fq2_value_type(0x170c77d828c1a5a7c8b26646a3efdc37090f0462a4c16018a0b87767e1267ba474c7b0209651b9fedd4529a1eabb3be1_cppui381, 0x0950f2624a4f3a5005c5af43de19cd884629310e9cf62c1f837e2817909facd930ff58736b852fbcdda8a3f67be12cc5_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x1292443c76f4a68cf038d74fb109f8d53b9f0e3b3be75212eea3e25c5386f89fb68ab9d4561c1a534a02adf161fe2cc8_cppui381, 0x03b936274a14066ee633a18d73cf519dbaa84e92053d589d86387ff6a8cf97d3737be7bb903392a2d8510fa2f5983ca4_cppui381), fq2_value_type(0x03b395cd1c619f2802fae59fd092f65ee7aaede32a92c7d7748ea6676e9348c817144a08e768f7efe5c6b2d13cb54303_cppui381, 0x198d3968741b6c662dce9942866b4fff9522b8184f1e7456da72e89c5721916416a981e2413499b942713cf09fcdf99d_cppui381), fq2_value_type::one()), };
     std::vector<G2_value_type> pk_vkey_b = {G2_value_type(fq2_value_type(0x024aa2b2f08f0a91260805272dc51051c6e47ad4fa403b02b4510b647ae3d1770bac0326a805bbefd48056c8c121bdb8_cppui381, 0x13e02b6052719f607dacd3a088274f65596bd0d09920b61ab5da61bbdc7f5049334cf11213945d57e5ac7d055d042b7e_cppui381), fq2_value_type(0x0ce5d527727d6e118cc9cdc6da2e351aadfd9baa8cbdd3a76d429a695160d12c923ac9cc3baca289e193548608b82801_cppui381, 0x0606c4a02ea734cc32acd2b02bc28b99cb3e287e85a763af267492ab572e99ab3f370d275cec1da1aaa9075ff05f79be_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x1092d6886f816dad06c1d0ee93a168d5523a293d7c3e96a817ba1e5936b3837d37bd3d7d8b452e69c042422ccff49730_cppui381, 0x107e20fcd6e9794de121a9d4105059576811160e1995e6d72fe9a8a1b61079eb144d41bf2e72a2fec9bdafac618fdfd6_cppui381), fq2_value_type(0x0759d4b33c9d00e6dcc14b95259490cc57b47ed16790904cebb6bf0f7233e15914acc00010efbfe06620e91e623100da_cppui381, 0x11cdaa6f9efba3c17423d84313e24f411f5a571870943eb488521c3286c0896281275340ba0d4b0ed5ac93fa9fa6f454_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x0a76040f2f322bbe0b4c5c158f353f8187aa17b7f29e5d92fbafa17444dd46fcdb8053a6991609178964e185f7010416_cppui381, 0x109886af215cbcb89e8eb03285e5af5be32e7594a71d6e8f76cab81c165516afa1c729d5d3cbaa18f32b888e4dc8b8e3_cppui381), fq2_value_type(0x085bfd4c5f113ebe52cfb78900438aa67f2e515f729f72b5d01ebb6a7b2fb238f1519912f1ee07948faa2182455155b4_cppui381, 0x19cb1b61514f2293a7eded56d7ed72e6f5e701f69c1aaa443e53fea17489c305c142df0c7856b363fdfb6b6807662713_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x0ef902393a8a91fda1a7f2a309007aa05734166b37e5c4be462444da3193c18ca7cc486cbb8b283ea2988e0f8915a2db_cppui381, 0x02202489dee2f690205cdf8c2c574ecd39dd1ec3aee67ab0eeddbdd64dc40db580ce52c473ca3116a74e5610be62498f_cppui381), fq2_value_type(0x02b12927688ca7378015b66eec9bb70261d9ddd0dd12ca910dfff26c37e4b12164fa75b356d61ef1ddebb3c949af0956_cppui381, 0x0b8fc8269fe35645cf44a8b50d268939f9ff91e8a3e5c330d005e51db2af3a8da8682b116bd4d42598b710ea42422cc2_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x177fa050dc1878e000b4b04db340284dd026e7cadedbdf8dc126cafbdc4bb7ad329f0acc1b19260a92f1f680c85dc0cf_cppui381, 0x063380010a1e3cdb9445952921485e4e3ce6ae21b9eae41e108f96f105123a8c7e3b95b5ae43e3923b9afbcbb213a414_cppui381), fq2_value_type(0x050ee2081d62b70dfc3681f20461d7f0419d5dd77d05da0eaa76f07d6d0a12fcffc4c9246f1160d86392c3dceeb06d6d_cppui381, 0x0153c9fccfb018f4bc403458ca1ad2c50214746df68e3bd5254e2e6710e7fc621cf3b4e41aad46bbe1c9683728411fc4_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x10e5eee5ade590a567426ff7d9f536ccd9bcf1f4778b8523e226ee72e323ea0755b9703d99aa41c88ade3553400ce5b5_cppui381, 0x07543c642fcb2c1be9452002fca1f841b882ff49e9ac3d7f376e19b470ba9055fd311772fb811159b6449f9263e42142_cppui381), fq2_value_type(0x19b89423df5fdf0556acbda2683ddf03692af4fe843b940d8e792c1869448c152608d726652dea0016d111a29103e59b_cppui381, 0x0f560b3e1647ba37816a1fcafe8cb7924177ad8839d0dfd4eb767b6a6f07b76ba1e4415303e6a52d16ba6a5f7485f25c_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x0ef5d4e85c3a8fa73f4e7262599a9f7bac7243a9fed5650e58b4c00a7a908975126fbd20df4830c22d7a8a4299894891_cppui381, 0x01e51e57dfb30ccfc5d6a0bcd574747e70e9c87fce5c198dd46318bd81e34fd6ef0c2380878e71ae330ea7f6d0e998f7_cppui381), fq2_value_type(0x123ac807285a456cce114701b10230d169bd0ed876d7624f7a4c9824e2b53d97c2cd09d8cbe1d7c362007a2aeefa01a6_cppui381, 0x061947176e5c9f8f650bd781d51015369cbe9fdb1c5fb6711ef37b66e4705837116c3c71c53cbfaa1e44814b1a0442fa_cppui381), fq2_value_type::one()), G2_value_type(fq2_value_type(0x0b0b09a27a9c6aa5a68773934499882058b9b5a2ce4f873ec70de8a8fbe586d409537fd14add0cf2bb3c4b2749f0306f_cppui381, 0x064cb42e6c5bc8891c044cb5695c3b3824a926d66fbf9806a3811b072a1ea46e0fc1dcb8c7b4df902b6f86bd5d497063_cppui381), fq2_value_type(0x0b9e9bcaa0c3ce9b91e0dbb85d3fbf21674c93bd26c64c22445ca9819b1a7139f45b4422dc13c0239acaada16f8b1c23_cppui381, 0x128acf27eab87ac625ff0ca89705c8fc4c26d35cc645dd87145ff244a859bd1d706790c07122a4203e0016a1e472fd39_cppui381), fq2_value_type::one()), };
     std::vector<G1_value_type> pk_wkey_a = {G1_value_type(0x0b522ca98912012126ad986195512d8d9259553fabd1cfdd926d671c4aa8db8b6427f2479e18dfdba1c9b46c81bb5e17_cppui381, 0x014cd687b9641dc21b9bae8a26ec95c9501a5bc5c7d710878ae81bbe2cf7ec14e17d7188882a571edcc3e185815414bd_cppui381, fq_value_type::one()), G1_value_type(0x0d806df34d7ba36af7569b2c936b27c8a292242e0da0f9dfd0d6bcb0bf858401c949fd1b7bbe391b306f5d95e126916a_cppui381, 0x082fdd273edffa8a82960b9a77685c9edaa202ac9ded5f6a40bbfc83901baac57e84001ca731ce2dd28ceab9299d1023_cppui381, fq_value_type::one()), G1_value_type(0x015d332f8ae2a232e0e41eaee8e718db07d360aa4e7efa10524b97f2e209e03405910e94abf3cbaa91ea54ebed391b99_cppui381, 0x04dbab44c5d1a057a65fb4c98d88e43358e4de735e0fc575379a99764167fb34b05558e093ddcf81c10e48c791213f5c_cppui381, fq_value_type::one()), G1_value_type(0x009ab2fa2fc3c370245b8e860672efb118248c8851566dde51e979e78a3fe7925bf0c1286a8091b70498b14695257263_cppui381, 0x1321ecd8b5990ff6519e090b033f3a6a3e57f501bb71b359acd0a9521219b559f6a2b3354f93928385eda276e84e6530_cppui381, fq_value_type::one()), G1_value_type(0x017e3a7e26a60a6edcb460c79f337f37b292029ea396fcfde82bafed31edc205937bc145e5d69c8eecf87d894584c791_cppui381, 0x127975318f793df99a10a3ace2b49706a29bbb9a6a974d205aad427d3e98ea263fc2a0dcd8b647d9b36b9241d3e653f9_cppui381, fq_value_type::one()), G1_value_type(0x0a9d2406465e2197ea5ad674fbf51cd16d6f885a98c6500dfe572dffcd31cbaf4063778692a4f6111118627cb24437c6_cppui381, 0x048c954b203cd7403f46be13699c0bd8b295c0e5a112e56fe37f367a9115cdb72ce8d7691e9869a92b51f3556258f52c_cppui381, fq_value_type::one()), G1_value_type(0x087b91d367dbc6b564d8b43e4370e22bba590d5c56c21c23ff16d7a8b220b30f5e46f6ab8104ff9193b5edd93bd37044_cppui381, 0x1105d394dcc72fdbc1e4609c98b59f33979be317305ae2ab1e10a9ffd58c4dcf2484cd1842d7b02575358b552b1155fb_cppui381, fq_value_type::one()), G1_value_type(0x12e26639adc0ea9afb6a833e9e5fa60f7315787803189d438a4070371a011623c47718f34e24656d9fa105c54b0e327a_cppui381, 0x0c84c30fc69070f4d367010b6a07a604446144af73a8a7c681d35a5e43f8be9d327b324a699464fdd57cfa5248e5196f_cppui381, fq_value_type::one()), };
@@ -816,52 +987,277 @@ BOOST_AUTO_TEST_CASE(bls381_verification) {
     agg_proof.tmipp.gipa.final_a = gp_final_a;
 }
 
-BOOST_AUTO_TEST_CASE(bls381_verification_mimc) {
-    constexpr std::size_t n = 8;
-    constexpr scalar_field_value_type alpha = 0x70cf8b38ee6c80d852532b676a1a9a6bcb5c730acf8d374603aa7a3f7582a318_cppui255;
-    constexpr scalar_field_value_type beta = 0x252c17e40f6978eddcfcf95e3134923554ff29176eba269cfa22d647230b12a8_cppui255;
+// a mapped srs file specializes to the keys of the srs it was written from
+BOOST_FIXTURE_TEST_CASE(bls381_mapped_srs, bls381_srs_fixture) {
+    const std::string mapped_srs_path = temporary_path("r1cs_gg_ppzksnark_aggregate_srs.bin");
+    r1cs_gg_pp_zksnark_aggregate_mapped_srs<curve_type>::write(mapped_srs_path, srs);
+    {
+        r1cs_gg_pp_zksnark_aggregate_mapped_srs<curve_type> mapped_srs(mapped_srs_path);
+        auto [mapped_pk, mapped_vk] = mapped_srs.specialize(n);
+        BOOST_CHECK(mapped_pk.vkey.a == pk.vkey.a);
+        BOOST_CHECK(mapped_pk.vkey.b == pk.vkey.b);
+        BOOST_CHECK(mapped_pk.wkey.a == pk.wkey.a);
+        BOOST_CHECK(mapped_pk.wkey.b == pk.wkey.b);
+        BOOST_CHECK(mapped_pk.h_beta_powers == pk.h_beta_powers);
+        BOOST_CHECK_EQUAL(mapped_vk.h_alpha, vk.h_alpha);
+    }
+    {
+        // a file shorter than its header announces is rejected before any power is read
+        std::ifstream in(mapped_srs_path, std::ios::binary);
+        const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const std::string truncated_path = temporary_path("r1cs_gg_ppzksnark_truncated_aggregate_srs.bin");
+        for (const std::size_t size : {contents.size() - 64, std::size_t(32)}) {
+            std::ofstream(truncated_path, std::ios::binary | std::ios::trunc).write(contents.data(), size);
+            BOOST_CHECK_THROW(r1cs_gg_pp_zksnark_aggregate_mapped_srs<curve_type> truncated(truncated_path),
+                              std::runtime_error);
+        }
+        std::remove(truncated_path.c_str());
+    }
+    std::remove(mapped_srs_path.c_str());
+}
 
-    // setup_fake_srs
-    r1cs_gg_pp_zksnark_aggregate_srs<curve_type> srs(n, alpha, beta);
-    auto [pk, vk] = srs.specialize(n);
+// an srs cache specializes the srs once per number of proofs
+BOOST_FIXTURE_TEST_CASE(bls381_srs_cache, bls381_srs_fixture) {
+    r1cs_gg_pp_zksnark_aggregate_srs_cache<r1cs_gg_pp_zksnark_aggregate_srs<curve_type>> srs_cache(
+        std::make_shared<const r1cs_gg_pp_zksnark_aggregate_srs<curve_type>>(srs));
+    auto cached_srs = srs_cache.specialize(n);
+    BOOST_CHECK(cached_srs == srs_cache.specialize(n));
+    BOOST_CHECK(cached_srs->first.vkey.a == pk.vkey.a);
+    BOOST_CHECK(cached_srs->first.wkey.b == pk.wkey.b);
+    BOOST_CHECK_EQUAL(cached_srs->second.g_beta, vk.g_beta);
+}
 
-    r1cs_gg_ppzksnark_proof<curve_type> proof0(G1_value_type(0x1399f72bba486cd041f2ba7355b8b989c2d3a0f88ce2585e00e70e556da1a25f07215556ff951d8ccfda5b12f3ac90cf_cppui381, 0x0a75ffef452c78ff85c7eac1e7341a9c76c251b856fa14ee2eff9d078c70f064b3d06c0b8b6e00bc41f2333a1307164f_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x0668d14a879e05415e963933971291f7d463bded5b0c7f569ac21d1c18047206107e41485f7633c2fb6b50155675ecdc_cppui381, 0x0d4caa0f825d207f175bdf853165324ced69244027f3f25d99791aee0fb605941d1e691b304fdff532d5a1cbbdefaba8_cppui381), fq2_value_type(0x08f758fb9760a5121ee6899e9253c0bbc344fc52c6e1a4f53a621100b5beaf53a860c07d347fadef5e715008b87560b3_cppui381, 0x093b43b47f9a581a05fe203d8039a85c91d01dfc110aef48127c6c97ec537dcdc4c8d020b6e5e1f7feaa6ac25df8b149_cppui381), fq2_value_type::one()), G1_value_type(0x09f277c9c245679f4917f03f032d107745136a36553c6664dfaafb33b8010667cec0fab82d816ff62fdc93264431498b_cppui381, 0x15f870848e4534ecbd74702e6d79e8b61b68395b6d5f72721b0cf4c9c296f20f72a80f40e8069af926e87ae67341f47b_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement0(0x676d98b785b2289a12720011f76b9891eddc6e3d77c8eb2fe97b5f5511208065_cppui255);
-    r1cs_gg_ppzksnark_proof<curve_type> proof1(G1_value_type(0x02ef1ec1a2d0c37897dabe8b13d2fa2fcfa9c915097eb91745d6d4e54be221dd367b24d11c522ae2a16fe1a92bbba3f9_cppui381, 0x0c74829f28e9adf5b4313c02734ee878d2ef7fe0458b0aa7baff576dd204d3d20c3db4eace869bb2445d7c3694581d8b_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x0a0cb52de299b7fda5bea1266d9278a1a3c66666cdd121d62bdbc48a45322d79eddd3af032282b49d7f38c41d5ba0afe_cppui381, 0x08e675240eaa1ca4d8bc73ab280c9263196bdc9785136422b07c69b38fd594a12a2ca922db16c0fa5bbb9dd7409f4ea4_cppui381), fq2_value_type(0x105990daac7ce1b7094e5ed6a9ec8a76f76a73823ab272e1274d7c2be5cbe353401b71fd12205db66862b6f80e27ccde_cppui381, 0x17704237a1535078a657e1f9e950c773615c105a52c071ab290299da5d267ea9cdcdb441bc2bb5f5a8b3c610217c8e2b_cppui381), fq2_value_type::one()), G1_value_type(0x08d2e6e5680aaabe762712d2beb827c0a459d9d000ca6c386842389a9aa9b36e7d438cf9dca4b5f5935798797c851db6_cppui381, 0x179452ac9b2dbe5b4fdc942678f5b529d1270872fef5232bce94ca2c4f5b04cef4c9b1deb1870e4433ef73c333824a1f_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement1(0x1adf834e2bb0455f07b7293cd301a59ee0489e8ea89ab2b268ca62905b60910a_cppui255);
-    r1cs_gg_ppzksnark_proof<curve_type> proof2(G1_value_type(0x0329ae094857dfec93a6bc51e28b606f1d935e22dbf2284d280200e5c00025c13778a153729225b36e95301a26ba36b6_cppui381, 0x17c3bb71db38454d4453ec60560a265af5cc516deefbb2525268ae9170a843786ab7bdd64e47a530c0af1ad455374bce_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x12f18e127906c95a9820038a6282f01ad57865e031fb520cd9dc4b3c426a5c256491b16cf6d6f638589ff29e6255f104_cppui381, 0x0601b0633b944f6788db5231c8d51ecc9b6480eff808befcdb9346c80837592d3e9de1fe025e5cf6badf83c752070485_cppui381), fq2_value_type(0x1150fbbe8eb6d0c662263c3f8853d1a65b73276937f90f214c9130859cf8c451c031b703935a41a2eb655693fb36bf56_cppui381, 0x01d8458efe86f4cde17645930a66e22145b5a1cefc3b323ed251a52e963ad4e7222757462b9621af0ef52915dcbb169e_cppui381), fq2_value_type::one()), G1_value_type(0x04c9e7133e46f37ad3b4200cdc1606abbf130db8e168af114bfa12b4cd7abd4de9bc50f7a28d242662ec47b16022ce66_cppui381, 0x0449b00806db1d5eaddcdaaefe794c0ee5f2aaa7c01d1f7df1fd9b7971cdb76ec755c227f87bc5935fccd6a4716058ac_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement2(0x3f2738f0b087b2967e479483e052b614671802a0ad3ddf6a04fb86e32a125c77_cppui255);
-    r1cs_gg_ppzksnark_proof<curve_type> proof3(G1_value_type(0x0e54089a438030c10200850c8f900f2cc631270044d4bb607f59bf84564d6be3bf315e7b6c253de1060adad71b5d42e3_cppui381, 0x0844609d89967590354634de4b93e3a1f187c9a8919859278009ba506cb48346926bd072fc30241a0fc771d707bdf99f_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x022c9f24480c22d736c37c973fe696be08c533f598c4401b82288bfe62cafd920deb3b8536e4c0cd00933163a1830b68_cppui381, 0x0c0a72697a5820fc5388f3a92871d2881431e0978c90f5bbb2f6a313cd063b25850178e159271229f2e963f9233a30b4_cppui381), fq2_value_type(0x1377a842ab4bb30d8299315bb763cb617af6904526c1a6a90a6b3b443a2ffc57883f83a006328599070ba30ad9c68194_cppui381, 0x0c92ab2f18bdcc2178d9fd56ba783bd942f7311ca1d1634db2b645b2ff8a2d1ab733558b6f4836dce626d7f2b8517ec3_cppui381), fq2_value_type::one()), G1_value_type(0x0213ef2fdde74b15b2b066829a331cab1d8a7e6d7efa0094be4ef7f2f5658209b09627ff3ddbddd96b69d992853cf889_cppui381, 0x040dc8edacc46608f9587f9c9b658f1b2c2627f570c538f428423c731aa10ef8e828531f4bda6b0734ad35a2a9d7d51f_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement3(0x69be6aab659e93cbd70e94cb23ff4be9d42cfbcdf9c955145a2d2f20c8a9b031_cppui255);
-    r1cs_gg_ppzksnark_proof<curve_type> proof4(G1_value_type(0x0d6eece4630b049c30c50ccdc9750f11c9cd15aca43554700045ebc81b03cdaf8a7daed7a9c5870189c4c593fa109f05_cppui381, 0x0b085d537ad0cca263d560dce8d041bde490c95d2ff29cbf9fcd7c376ca3ab554d219ca9633f0b5e056aa35ef6e887ae_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x181c65c65ad8c0b504942f5740a7c175e0142226b7d441cc8cac836b4b6f713056cef60dca010d4d5e775fdd8bd339fa_cppui381, 0x1515267c97507db065a264c0d5a1b4f22b2d87502ecda11771fc097ab2665406ccdd0feb7ba57e53c4c3e8415d6bc6d3_cppui381), fq2_value_type(0x0fd7ffd768080edbc6830400f159e681c596a619746795ba5a9ad03b6dfd18047d3d1738784405c3c05e4bd9c5150790_cppui381, 0x17191a92cbe9c9acc873872162ab60ce5d01dab26280a96bec0cc04c628c47ed56d643906428de68fd5696b8bf39078d_cppui381), fq2_value_type::one()), G1_value_type(0x128ef42d1399ba429d4c79606321b98bfbeb984342221fe8b231bdc3a6a47673bcddb5205f5cc7a501034931a3ed08e3_cppui381, 0x0d515563f0840600c7b863b16536a3901084ea4714ca4fee4c906079c5c8d6acb28c1617d762a20e155f3cd9b9ac75ea_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement4(0x668f0a74247e78898b4b160ad3d63d8a209ab4bd151ebd93d04178c803e8bbfb_cppui255);
-    r1cs_gg_ppzksnark_proof<curve_type> proof5(G1_value_type(0x0f464d0971c96b7f52196d111a389350682c5758f941e0425c041fbac3593121ffb0c5e20249c790edfafe160f7d7106_cppui381, 0x1980374d3f569b32cb8b001b8ba9eec741e4835336e145263cc84ee14239f2fa38c9bf4f1c0c16638276518f5b8bb901_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x196a554c6af4aae8c58e871e453f9134ab8755a1dbdf10ee88ff0e7b678b8c0c696f5d2a7c9d0bbdf6bc44c9f039d552_cppui381, 0x115ca6da99922e86fe7d58317ba8e106dc23b1b970eee21f11a07fd2962fccb69c4a26fcaf8e17f04030e2c2c10df817_cppui381), fq2_value_type(0x002c3d0ee2f62aa0c44eb32c913472e6c1e86b372337f21ecb1e44d00b99a2b6f2de78df7c2ba6a4fb5c36f0e03d7cc1_cppui381, 0x0d4115c34a549c05223076219c2d030756511433c8e428ef26446847e427dd3c78706375df5df02378b9e212a69fc584_cppui381), fq2_value_type::one()), G1_value_type(0x04a89866a20de75b2a326f4c4a5b283cbfc431a51eb4bf2a9230ae66edd772179dd4e0c74b4ec59f0017ad5f21fbfaef_cppui381, 0x056c29dee82c9cec67fce45e4eba0484e4ce47722d7ddf4f62e827f580770777999926017fb5fa2481c04f7aaa787d20_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement5(0x3f2202b2e3a6f87cc7bd57565b30b78f08dc1ad79e1cc6a9f372dc7639bc1aaf_cppui255);
-    r1cs_gg_ppzksnark_proof<curve_type> proof6(G1_value_type(0x170695ec2cd19303a822fb5480f19e82721af04b18d38bb9a8c71f816c47c7bedc6c2866b9581437a93e14f289573699_cppui381, 0x07dd012681a3ad0cc0859a73a3be4bddcf5bbf6b504d058fb0e3ba7fc0e9536ebab103cb5d7d2287e62604feef4afb96_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x16b5a5d6209f8fcbd6df06790f3f6c2f34322a4c7f52a5e3c2a1ffc9f0f1782278a63794571b3169181d8412457dc3bf_cppui381, 0x0ab1b302be43dbaa4a136eea7c8c484d4b144880ced9e474cdc7ee77c493761653c280612a7b4da8fc6cf03dc5c07a1f_cppui381), fq2_value_type(0x0e7f082279be6fb5447314329fae7e72986b263cf47b292c141ca662a0302481f14905648ab45679d9fe93a8d5fff627_cppui381, 0x046d0d3a1f489f32e8bf8f7cbb90a99ab17cdfb1b06194c9a60d2aa78bde45e26911b54451741aae28eec06ad96ba5ba_cppui381), fq2_value_type::one()), G1_value_type(0x118ed7dab64142f556effee3cbc5e4b7a71c28a98caa84767909bb7e367dff5c4ed49cd1c463aeac9058724e52132d9e_cppui381, 0x103cff37739ac1fb7b244ab5055ca49af28360127d33245e8f986417761b33afbe44a9ebd453092e364d87339c5cd0c2_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement6(0x10103523c670a127c25e5d5ff5d3eacf87cc5a5671a7833901b2a1fcf678df65_cppui255);
-    r1cs_gg_ppzksnark_proof<curve_type> proof7(G1_value_type(0x19d92ff555f7086784eeccd0c272a0baa68643a24a0df76621b84fb7c54501fa2397b02e91349837a2ea4edda2552ee8_cppui381, 0x14f218d14352a62d689cdf649feccfab09893969105dd073cab767ed9a2e18deb47a7f7fd02d8d7f9de33615fb62543f_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x110bf3f7b38d9777d3e66add2abc886823ce7fd89131fa1fe02c2c78aa12db5a4bd0d6f38d4122a68d2bcd3d9d64247f_cppui381, 0x0b0344d55966166e208754977ac8770a2e5b41e4a32dc73ca9171c5a0cba8cdddacce5627661539804409a6babbff97a_cppui381), fq2_value_type(0x16d3135e5907b37b87aa965128413ba872bbb2150b463a8f502693a95c6dce0031aa73479bccbfaabed12945656d50e4_cppui381, 0x0fc6d03d2b43fffab73cb912fc16274d8cf57d6474f3458f09fc8d6fc8bea4bd552c6aafed6b87c120407188da3dcbf9_cppui381), fq2_value_type::one()), G1_value_type(0x18a8945437db0c8a921e9cf68d32c325ccc401105bb00b4e0982b3f4706417b911a1d6db4aa92eabc4422e61ae08a638_cppui381, 0x198b25f849acdb8344d14e206457b051c90bf9b03b71e4523950a31b9b7a026f035c3fa4a4797e8d5ca5ba511492c2be_cppui381, fq_value_type::one()));
-    constexpr scalar_field_value_type statement7(0x4e2f20ac210798cc3c691edbdca3cd7ba6fc4fc706a49ecf26aa326517e35634_cppui255);
-    std::vector<r1cs_gg_ppzksnark_proof<curve_type>> proofs {
-        proof0, proof1, proof2, proof3, proof4, proof5, proof6, proof7,
-    };
-    std::vector<std::vector<scalar_field_value_type>> statements {
-        {statement0}, {statement1}, {statement2}, {statement3}, {statement4}, {statement5}, {statement6}, {statement7},
-    };
-    std::vector<std::uint8_t> tr_include {1, 2, 3};
+BOOST_AUTO_TEST_CASE(bls381_pairing_check_test) {
+    scalar_field_value_type x = random_element<scalar_field_type>();
+    std::vector<G1_value_type> a {G1_value_type::one() * x, -G1_value_type::one()};
+    std::vector<G2_value_type> b {G2_value_type::one(), G2_value_type::one() * x};
+    // e(g, h)^x
+    fq12_value_type out = final_exponentiation<curve_type>(
+                              nil::crypto3::algebra::pair<curve_type>(G1_value_type::one(), G2_value_type::one()))
+                              .pow(x.data);
+
+    pairing_check<curve_type, DistributionType, GeneratorType> pc;
+    pc.reserve(2, 3);
+    pc.merge_random(a.begin(), a.end(), b.begin(), b.end(), fq12_value_type::one());
+    pc.merge_random(a.begin(), a.begin() + 1, b.begin(), b.begin() + 1, out);
+    BOOST_CHECK(pc.verify());
+    BOOST_CHECK(pc.verify(random_element<scalar_field_type>()));
+
+    // the buffers are reused for the next checks
+    pc.clear();
+    pc.merge_random(a.begin(), a.end(), b.begin(), b.end(), out);
+    BOOST_CHECK(!pc.verify());
+    BOOST_CHECK(!pc.verify(random_element<scalar_field_type>()));
+
+    pc.clear();
+    pc.merge_nonrandom(a.begin(), a.begin() + 1, b.begin(), b.begin() + 1, out);
+    pc.merge_random(a.begin(), a.end(), b.begin(), b.end(), fq12_value_type::one());
+    BOOST_CHECK(pc.verify(random_element<scalar_field_type>()));
+
+    // precomputed lines can be mixed with points
+    std::vector<typename curve_type::pairing::g2_precomp> b_lines {curve_type::pairing::precompute_g2(b[0]),
+                                                                  curve_type::pairing::precompute_g2(b[1])};
+    pc.clear();
+    pc.merge_random(a.begin(), a.end(), b_lines.begin(), b_lines.end(), fq12_value_type::one());
+    pc.merge_random(a.begin(), a.begin() + 1, b.begin(), b.begin() + 1, out);
+    BOOST_CHECK(pc.verify(random_element<scalar_field_type>()));
+
+    // mismatched or empty pairs invalidate the checker in release builds too
+    pc.clear();
+    pc.merge_random(a.begin(), a.end(), b.begin(), b.begin() + 1, fq12_value_type::one());
+    BOOST_CHECK(!pc.verify());
+    pc.clear();
+    pc.merge_random(a.begin(), a.begin(), b.begin(), b.begin(), fq12_value_type::one());
+    BOOST_CHECK(!pc.verify());
+
+    // the checks merged from another checker are randomized again, with the default generator
+    pairing_check<curve_type> valid_pc, merged_pc;
+    valid_pc.merge_random(a.begin(), a.end(), b.begin(), b.end(), fq12_value_type::one());
+    merged_pc.merge_random(valid_pc);
+    BOOST_CHECK(merged_pc.verify());
+    pairing_check<curve_type> invalid_pc;
+    invalid_pc.merge_random(a.begin(), a.end(), b.begin(), b.end(), out);
+    merged_pc.merge_random(invalid_pc);
+    BOOST_CHECK(!merged_pc.verify());
+}
 
-    fq12_value_type vk_alpha_g1_beta_g2 = fq12_value_type(fq6_value_type(fq2_value_type(0x185e44039dfb814a94541ffc8d1d34c8cbc3c4aff9694d7a433aa811afe2ff0b6bbd5d486791706c73d34f7891c7b7b1_cppui381, 0x0dc20dafd483fc2d0c4400819f63dc880c7987c59d45e30343ab523e1298352d0477ca225e44d39d3839489287944e3b_cppui381), fq2_value_type(0x0ceed0815b9184e3eddfc01ad9049088a6bc7ed11240eddc9f5c9904aa895bf41dc652d6140a8afae2727012801f5322_cppui381, 0x0ec1abeec3a7dfc704d6b18f402f95fee082e6f79a493cadf5bba38713b23dba7f66e5cdcf35e277622304003273bd04_cppui381), fq2_value_type(0x02433b5eda2f4ceea8ff8b1d57dcbff43a7a7d569e57283bf6413c4db1c4b810305d24e304a294ac3f27d096fcc0c84b_cppui381, 0x06fda28b12cd3c65b51d10162b32317047f28228f96ed0c46b76a22120974b88b1508915e0fc27572185c7e8d9caa6f0_cppui381)), fq6_value_type(fq2_value_type(0x0c41e2862295b03b61a7c1181843698347f2c9e2b0de45442b7262f02886f954bd4d442f5cb37ec87c5a1716522d3442_cppui381, 0x056fe72dfc01d18d31b19349cb5718120ddd96a82fbefc1d4ed986372d4dcbbfab113fce0a097f44df81addf083f9b92_cppui381), fq2_value_type(0x0f2bab80d7b0eb6d20a4c894e20974b412bfdfbc9b6f0a2dc140310374fef821d6f9ea8e675760f16adb86bf2b983645_cppui381, 0x0f174bb36f12cce1f13195cb47f7dd9f49d82f07f78d8f022c2091b01e818cea2bdb3c23b0dcb16d4b8631d9149a60cd_cppui381), fq2_value_type(0x11d09591eebb8787e4a74fd31863ed716cf2ee57e3d7b82a5b7bffabffa78830b0f2e0137fe6b2db1c745b811f1cf7a2_cppui381, 0x006fae93c5e4b31f21082e3bc097c316b216810f6ccde888075654753304578b6c721318bf21da6d73bd8d257cebc5f4_cppui381)));
-    G2_value_type vk_gamma_g2 = G2_value_type(fq2_value_type(0x0d545a55b2391f0f4e8b5ff92df2190b32c6f8e3c99aefd96204e2e3e245c23fab958a0a53d71cd6b6ecdb93c1e21174_cppui381, 0x0084f673066de86c62f4475e32eeca0f359e8e177b2e67f216a26318cfdd0bcd14dda9124f2ff372effc94c0a319c8bb_cppui381), fq2_value_type(0x04da577f4c3e1a1719730427ba645211ba3645a05e1ba3fbf27baf6d88e582234e04c22657ff48b4947bc68557258249_cppui381, 0x0074a994e0677c68e0df1e75ef45caf6af2994795608be411e7a09f8398cfc32f0078a531e04379c0654e1dcab4ba55c_cppui381), fq2_value_type::one());
-    G2_value_type vk_delta_g2 = G2_value_type(fq2_value_type(0x0ab77c38fa7cfbae21eaf2c682b337ff7ec5262a48974748e322ee4bd80c5a0df3a3966a4626881625db1d1a49fbc222_cppui381, 0x13c483b705659cf7fae52464298ec0c34f0f875cd4ae30d3c6d493a5d397b4e1a5b14cace259d4a809afd3064a930175_cppui381), fq2_value_type(0x16a71a9e52003641067339931c2b3a687d418e15d1cdc9fed776863d764fccf7b25b7dc284be6d376bc5811ee185ba8c_cppui381, 0x18cf536fcc888c50a2f3dd9433b960971d8ac3c2e014db7b202edffdb0aa25d4399f97944ad6880fac3eedb3fca1dc46_cppui381), fq2_value_type::one());
-    G1_value_type vk_alpha_g1 = G1_value_type(0x055b3e622b91e71857f1d93940d54c5ab3cdf5f766fd478dad7894a003a78f1638d9552c494808d3263961052ef031ee_cppui381, 0x0f4e76ff6aa08eac42a244a7af07758858fbbd6f78d26df16440b6492e54a07cc0034767ec91ee0159cddf2aec3a0ab7_cppui381, fq_value_type::one());
-    G2_value_type vk_beta_g2 = G2_value_type(fq2_value_type(0x04d8589ff38165e0e0171b53869216805a30dedc3cd04642df29240bc98a51ff3d4db7e902ccfc7fc186113e68b553d7_cppui381, 0x17e9145008e5cf84f69519a84181d7e41519d241f12c553bb4a2cc7e74634f22041387926a88c5aa73f643b85314db24_cppui381), fq2_value_type(0x152dd5fa53c95960dfe8a7b8214668d577c832ea7eff9f4344eef321770aabb74e2b4f33a7b11c146a4d1109184c594c_cppui381, 0x0e48183088c9f0bedc1a8fd899fc8fc9a000fa42bf68c0c0d2edaea7c2d5b05d9f54be402deb2f989f499cdefc258add_cppui381), fq2_value_type::one());
-    std::vector<G1_value_type> vk_ic = {G1_value_type(0x072d9bf38d16790fe06dd960d90ae1e33095eb56e77703ae87324de7cc0691fbb0cf4029da532bb0202e64046efbe8aa_cppui381, 0x19314e160e79ae8c86f55e826183ec1b1b8530e72e62df12dab45cc82bcaa49c30a7483459a29b522b1c8238dc2e7f11_cppui381, fq_value_type::one()), G1_value_type(0x06aab200db211c7c93d63929be9170d4b063f76f689d975d7d33cb8132f7b7fd90c9f8e7542658a2483c4fff6dfbf074_cppui381, 0x0e41380a7c46a9245def32d330144cd99d8516ee38fb021555843f1e0fa2b4e3a4f9b12ad1af0f4727d23b108c72ccbc_cppui381, fq_value_type::one()), };
-    accumulation_vector<g1_type> vk_acc_ic(std::forward<G1_value_type>(vk_ic[0]),
-                                           std::vector<G1_value_type>(vk_ic.begin() + 1, vk_ic.end()));
-    r1cs_gg_ppzksnark_aggregate_verification_key<curve_type> pvk(vk_alpha_g1, vk_beta_g2, vk_gamma_g2, vk_delta_g2, vk_acc_ic);
+// a point of the curve of G1 outside its prime order subgroup, y^2 = x^3 + b with b read off the generator
+G1_value_type g1_off_subgroup_point(fq_value_type x) {
+    const G1_value_type generator = G1_value_type::one().to_affine();
+    const fq_value_type b = generator.Y.squared() - generator.X.squared() * generator.X;
+    for (;; x = x + fq_value_type::one()) {
+        const fq_value_type y_squared = x.squared() * x + b;
+        if (!y_squared.is_square()) {
+            continue;
+        }
+        const G1_value_type point(x, y_squared.sqrt(), fq_value_type::one());
+        if (!(point * scalar_field_type::modulus_type(scalar_field_type::modulus)).is_zero()) {
+            return point;
+        }
+    }
+}
 
-    auto agg_proof =
-        prove<scheme_type, hashes::sha2<256>>(pk, tr_include.begin(), tr_include.end(), proofs.begin(), proofs.end());
+BOOST_AUTO_TEST_CASE(bls381_batch_subgroup_check_test) {
+    std::vector<G1_value_type> points;
+    for (std::size_t i = 0; i < 8; ++i) {
+        points.emplace_back(random_element<g1_type>());
+    }
+    BOOST_CHECK(batch_subgroup_check<g1_type, scalar_field_type>(points.begin(), points.end()));
+
+    const G1_value_type off_subgroup = g1_off_subgroup_point(fq_value_type(5));
+    BOOST_CHECK(off_subgroup.is_well_formed());
+    points[5] = off_subgroup;
+    BOOST_CHECK(!batch_subgroup_check<g1_type, scalar_field_type>(points.begin(), points.end()));
+    // a single point, checked as a batch of one
+    BOOST_CHECK(!batch_subgroup_check<g1_type, scalar_field_type>(points.begin() + 5, points.begin() + 6));
+}
+
+BOOST_AUTO_TEST_CASE(bls381_validate_proofs_test) {
+    std::vector<r1cs_gg_ppzksnark_proof<curve_type>> proofs;
+    for (std::size_t i = 0; i < 11; ++i) {
+        proofs.emplace_back(random_element<g1_type>(), random_element<g2_type>(), random_element<g1_type>());
+    }
+    BOOST_CHECK(validate_proofs<curve_type>(proofs.begin(), proofs.end()).empty());
+
+    // the bisection finds every proof with an element off the subgroup, in order
+    proofs[2].g_A = g1_off_subgroup_point(fq_value_type(7));
+    proofs[9].g_C = g1_off_subgroup_point(fq_value_type(11));
+    BOOST_CHECK(validate_proofs<curve_type>(proofs.begin(), proofs.end()) == std::vector<std::size_t>({2, 9}));
+
+    // and those off the curve among them
+    proofs[4].g_B.X = proofs[4].g_B.X + proofs[4].g_B.Z;
+    BOOST_CHECK(validate_proofs<curve_type>(proofs.begin(), proofs.end()) == std::vector<std::size_t>({2, 4, 9}));
+}
+
+BOOST_AUTO_TEST_CASE(bls381_glv_endomorphism_test) {
+    // phi(P) = lambda * P, lambda = z^2 - 1
+    const scalar_field_value_type lambda(0xac45a4010001a40200000000ffffffff_cppui255);
+    const G1_value_type point = G1_value_type::one() * random_element<scalar_field_type>();
+    BOOST_CHECK(glv_image<g1_type>(point) == point * lambda);
+
+    for (std::size_t i = 0; i < 16; ++i) {
+        const scalar_field_value_type k = random_element<scalar_field_type>();
+        const glv_decomposition<g1_type> decomposition = glv_decompose<g1_type>(k);
+        const scalar_field_value_type k1 = decomposition.negative1 ? -decomposition.k1 : decomposition.k1;
+        const scalar_field_value_type k2 = decomposition.negative2 ? -decomposition.k2 : decomposition.k2;
+        BOOST_CHECK(k1 + k2 * lambda == k);
+    }
+
+    std::vector<G1_value_type> bases;
+    std::vector<scalar_field_value_type> scalars;
+    for (std::size_t i = 0; i < 64; ++i) {
+        bases.emplace_back(G1_value_type::one() * random_element<scalar_field_type>());
+        scalars.emplace_back(random_element<scalar_field_type>());
+    }
+    const G1_value_type expected = dispatch_multiexp<multiexp_method_auto>(bases.begin(), bases.end(),
+                                                                          scalars.begin(), scalars.end(), 1);
+    BOOST_CHECK(endomorphism_multiexp<g1_type, multiexp_method_auto>(bases.begin(), bases.end(), scalars.begin(),
+                                                                     scalars.end(), 2) == expected);
+    const glv_bases<g1_type> precomputed(bases);
+    BOOST_CHECK(glv_multiexp<multiexp_method_auto>(precomputed, 0, bases.size(), scalars.begin(), 1) == expected);
+}
 
+BOOST_AUTO_TEST_CASE(bls381_gt_multiexp_test) {
+    const fq12_value_type e = final_exponentiation<curve_type>(
+        nil::crypto3::algebra::pair<curve_type>(G1_value_type::one(), G2_value_type::one()));
+    std::vector<fq12_value_type> bases;
+    std::vector<scalar_field_value_type> scalars;
+    fq12_value_type expected = fq12_value_type::one();
+    for (std::size_t i = 0; i < 9; ++i) {
+        bases.emplace_back(e.pow(random_element<scalar_field_type>().data));
+        scalars.emplace_back(random_element<scalar_field_type>());
+        expected = expected * bases.back().pow(scalars.back().data);
+    }
+    BOOST_CHECK(detail::is_cyclotomic(bases.front()));
+    BOOST_CHECK(gt_multiexp<scalar_field_type>(bases.begin(), bases.end(), scalars.begin()) == expected);
+
+    // a base off the cyclotomic subgroup, where cyclotomic squaring would be wrong
+    const fq12_value_type off_subgroup = random_element<fq12_type>();
+    BOOST_CHECK(!detail::is_cyclotomic(off_subgroup));
+    expected = expected * bases[4].pow(scalars[4].data).inversed() * off_subgroup.pow(scalars[4].data);
+    bases[4] = off_subgroup;
+    BOOST_CHECK(gt_multiexp<scalar_field_type>(bases.begin(), bases.end(), scalars.begin()) == expected);
+}
+
+/* The generic srs, the proofs of a MiMC circuit and their key. */
+struct bls381_mimc_fixture {
+    static constexpr std::size_t n = 8;
+
+    static r1cs_gg_pp_zksnark_aggregate_srs<curve_type> generic_srs() {
+        constexpr scalar_field_value_type alpha = 0x70cf8b38ee6c80d852532b676a1a9a6bcb5c730acf8d374603aa7a3f7582a318_cppui255;
+        constexpr scalar_field_value_type beta = 0x252c17e40f6978eddcfcf95e3134923554ff29176eba269cfa22d647230b12a8_cppui255;
+
+        // setup_fake_srs
+        return r1cs_gg_pp_zksnark_aggregate_srs<curve_type>(n, alpha, beta);
+    }
+
+    static r1cs_gg_ppzksnark_aggregate_verification_key<curve_type> verification_key() {
+        fq12_value_type vk_alpha_g1_beta_g2 = fq12_value_type(fq6_value_type(fq2_value_type(0x185e44039dfb814a94541ffc8d1d34c8cbc3c4aff9694d7a433aa811afe2ff0b6bbd5d486791706c73d34f7891c7b7b1_cppui381, 0x0dc20dafd483fc2d0c4400819f63dc880c7987c59d45e30343ab523e1298352d0477ca225e44d39d3839489287944e3b_cppui381), fq2_value_type(0x0ceed0815b9184e3eddfc01ad9049088a6bc7ed11240eddc9f5c9904aa895bf41dc652d6140a8afae2727012801f5322_cppui381, 0x0ec1abeec3a7dfc704d6b18f402f95fee082e6f79a493cadf5bba38713b23dba7f66e5cdcf35e277622304003273bd04_cppui381), fq2_value_type(0x02433b5eda2f4ceea8ff8b1d57dcbff43a7a7d569e57283bf6413c4db1c4b810305d24e304a294ac3f27d096fcc0c84b_cppui381, 0x06fda28b12cd3c65b51d10162b32317047f28228f96ed0c46b76a22120974b88b1508915e0fc27572185c7e8d9caa6f0_cppui381)), fq6_value_type(fq2_value_type(0x0c41e2862295b03b61a7c1181843698347f2c9e2b0de45442b7262f02886f954bd4d442f5cb37ec87c5a1716522d3442_cppui381, 0x056fe72dfc01d18d31b19349cb5718120ddd96a82fbefc1d4ed986372d4dcbbfab113fce0a097f44df81addf083f9b92_cppui381), fq2_value_type(0x0f2bab80d7b0eb6d20a4c894e20974b412bfdfbc9b6f0a2dc140310374fef821d6f9ea8e675760f16adb86bf2b983645_cppui381, 0x0f174bb36f12cce1f13195cb47f7dd9f49d82f07f78d8f022c2091b01e818cea2bdb3c23b0dcb16d4b8631d9149a60cd_cppui381), fq2_value_type(0x11d09591eebb8787e4a74fd31863ed716cf2ee57e3d7b82a5b7bffabffa78830b0f2e0137fe6b2db1c745b811f1cf7a2_cppui381, 0x006fae93c5e4b31f21082e3bc097c316b216810f6ccde888075654753304578b6c721318bf21da6d73bd8d257cebc5f4_cppui381)));
+        G2_value_type vk_gamma_g2 = G2_value_type(fq2_value_type(0x0d545a55b2391f0f4e8b5ff92df2190b32c6f8e3c99aefd96204e2e3e245c23fab958a0a53d71cd6b6ecdb93c1e21174_cppui381, 0x0084f673066de86c62f4475e32eeca0f359e8e177b2e67f216a26318cfdd0bcd14dda9124f2ff372effc94c0a319c8bb_cppui381), fq2_value_type(0x04da577f4c3e1a1719730427ba645211ba3645a05e1ba3fbf27baf6d88e582234e04c22657ff48b4947bc68557258249_cppui381, 0x0074a994e0677c68e0df1e75ef45caf6af2994795608be411e7a09f8398cfc32f0078a531e04379c0654e1dcab4ba55c_cppui381), fq2_value_type::one());
+        G2_value_type vk_delta_g2 = G2_value_type(fq2_value_type(0x0ab77c38fa7cfbae21eaf2c682b337ff7ec5262a48974748e322ee4bd80c5a0df3a3966a4626881625db1d1a49fbc222_cppui381, 0x13c483b705659cf7fae52464298ec0c34f0f875cd4ae30d3c6d493a5d397b4e1a5b14cace259d4a809afd3064a930175_cppui381), fq2_value_type(0x16a71a9e52003641067339931c2b3a687d418e15d1cdc9fed776863d764fccf7b25b7dc284be6d376bc5811ee185ba8c_cppui381, 0x18cf536fcc888c50a2f3dd9433b960971d8ac3c2e014db7b202edffdb0aa25d4399f97944ad6880fac3eedb3fca1dc46_cppui381), fq2_value_type::one());
+        G1_value_type vk_alpha_g1 = G1_value_type(0x055b3e622b91e71857f1d93940d54c5ab3cdf5f766fd478dad7894a003a78f1638d9552c494808d3263961052ef031ee_cppui381, 0x0f4e76ff6aa08eac42a244a7af07758858fbbd6f78d26df16440b6492e54a07cc0034767ec91ee0159cddf2aec3a0ab7_cppui381, fq_value_type::one());
+        G2_value_type vk_beta_g2 = G2_value_type(fq2_value_type(0x04d8589ff38165e0e0171b53869216805a30dedc3cd04642df29240bc98a51ff3d4db7e902ccfc7fc186113e68b553d7_cppui381, 0x17e9145008e5cf84f69519a84181d7e41519d241f12c553bb4a2cc7e74634f22041387926a88c5aa73f643b85314db24_cppui381), fq2_value_type(0x152dd5fa53c95960dfe8a7b8214668d577c832ea7eff9f4344eef321770aabb74e2b4f33a7b11c146a4d1109184c594c_cppui381, 0x0e48183088c9f0bedc1a8fd899fc8fc9a000fa42bf68c0c0d2edaea7c2d5b05d9f54be402deb2f989f499cdefc258add_cppui381), fq2_value_type::one());
+        std::vector<G1_value_type> vk_ic = {G1_value_type(0x072d9bf38d16790fe06dd960d90ae1e33095eb56e77703ae87324de7cc0691fbb0cf4029da532bb0202e64046efbe8aa_cppui381, 0x19314e160e79ae8c86f55e826183ec1b1b8530e72e62df12dab45cc82bcaa49c30a7483459a29b522b1c8238dc2e7f11_cppui381, fq_value_type::one()), G1_value_type(0x06aab200db211c7c93d63929be9170d4b063f76f689d975d7d33cb8132f7b7fd90c9f8e7542658a2483c4fff6dfbf074_cppui381, 0x0e41380a7c46a9245def32d330144cd99d8516ee38fb021555843f1e0fa2b4e3a4f9b12ad1af0f4727d23b108c72ccbc_cppui381, fq_value_type::one()), };
+        accumulation_vector<g1_type> vk_acc_ic(std::forward<G1_value_type>(vk_ic[0]),
+                                               std::vector<G1_value_type>(vk_ic.begin() + 1, vk_ic.end()));
+        return r1cs_gg_ppzksnark_aggregate_verification_key<curve_type>(vk_alpha_g1, vk_beta_g2, vk_gamma_g2, vk_delta_g2, vk_acc_ic);
+    }
+
+    bls381_mimc_fixture() : srs(generic_srs()), keys(srs.specialize(n)), pvk(verification_key()) {
+        r1cs_gg_ppzksnark_proof<curve_type> proof0(G1_value_type(0x1399f72bba486cd041f2ba7355b8b989c2d3a0f88ce2585e00e70e556da1a25f07215556ff951d8ccfda5b12f3ac90cf_cppui381, 0x0a75ffef452c78ff85c7eac1e7341a9c76c251b856fa14ee2eff9d078c70f064b3d06c0b8b6e00bc41f2333a1307164f_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x0668d14a879e05415e963933971291f7d463bded5b0c7f569ac21d1c18047206107e41485f7633c2fb6b50155675ecdc_cppui381, 0x0d4caa0f825d207f175bdf853165324ced69244027f3f25d99791aee0fb605941d1e691b304fdff532d5a1cbbdefaba8_cppui381), fq2_value_type(0x08f758fb9760a5121ee6899e9253c0bbc344fc52c6e1a4f53a621100b5beaf53a860c07d347fadef5e715008b87560b3_cppui381, 0x093b43b47f9a581a05fe203d8039a85c91d01dfc110aef48127c6c97ec537dcdc4c8d020b6e5e1f7feaa6ac25df8b149_cppui381), fq2_value_type::one()), G1_value_type(0x09f277c9c245679f4917f03f032d107745136a36553c6664dfaafb33b8010667cec0fab82d816ff62fdc93264431498b_cppui381, 0x15f870848e4534ecbd74702e6d79e8b61b68395b6d5f72721b0cf4c9c296f20f72a80f40e8069af926e87ae67341f47b_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement0(0x676d98b785b2289a12720011f76b9891eddc6e3d77c8eb2fe97b5f5511208065_cppui255);
+        r1cs_gg_ppzksnark_proof<curve_type> proof1(G1_value_type(0x02ef1ec1a2d0c37897dabe8b13d2fa2fcfa9c915097eb91745d6d4e54be221dd367b24d11c522ae2a16fe1a92bbba3f9_cppui381, 0x0c74829f28e9adf5b4313c02734ee878d2ef7fe0458b0aa7baff576dd204d3d20c3db4eace869bb2445d7c3694581d8b_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x0a0cb52de299b7fda5bea1266d9278a1a3c66666cdd121d62bdbc48a45322d79eddd3af032282b49d7f38c41d5ba0afe_cppui381, 0x08e675240eaa1ca4d8bc73ab280c9263196bdc9785136422b07c69b38fd594a12a2ca922db16c0fa5bbb9dd7409f4ea4_cppui381), fq2_value_type(0x105990daac7ce1b7094e5ed6a9ec8a76f76a73823ab272e1274d7c2be5cbe353401b71fd12205db66862b6f80e27ccde_cppui381, 0x17704237a1535078a657e1f9e950c773615c105a52c071ab290299da5d267ea9cdcdb441bc2bb5f5a8b3c610217c8e2b_cppui381), fq2_value_type::one()), G1_value_type(0x08d2e6e5680aaabe762712d2beb827c0a459d9d000ca6c386842389a9aa9b36e7d438cf9dca4b5f5935798797c851db6_cppui381, 0x179452ac9b2dbe5b4fdc942678f5b529d1270872fef5232bce94ca2c4f5b04cef4c9b1deb1870e4433ef73c333824a1f_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement1(0x1adf834e2bb0455f07b7293cd301a59ee0489e8ea89ab2b268ca62905b60910a_cppui255);
+        r1cs_gg_ppzksnark_proof<curve_type> proof2(G1_value_type(0x0329ae094857dfec93a6bc51e28b606f1d935e22dbf2284d280200e5c00025c13778a153729225b36e95301a26ba36b6_cppui381, 0x17c3bb71db38454d4453ec60560a265af5cc516deefbb2525268ae9170a843786ab7bdd64e47a530c0af1ad455374bce_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x12f18e127906c95a9820038a6282f01ad57865e031fb520cd9dc4b3c426a5c256491b16cf6d6f638589ff29e6255f104_cppui381, 0x0601b0633b944f6788db5231c8d51ecc9b6480eff808befcdb9346c80837592d3e9de1fe025e5cf6badf83c752070485_cppui381), fq2_value_type(0x1150fbbe8eb6d0c662263c3f8853d1a65b73276937f90f214c9130859cf8c451c031b703935a41a2eb655693fb36bf56_cppui381, 0x01d8458efe86f4cde17645930a66e22145b5a1cefc3b323ed251a52e963ad4e7222757462b9621af0ef52915dcbb169e_cppui381), fq2_value_type::one()), G1_value_type(0x04c9e7133e46f37ad3b4200cdc1606abbf130db8e168af114bfa12b4cd7abd4de9bc50f7a28d242662ec47b16022ce66_cppui381, 0x0449b00806db1d5eaddcdaaefe794c0ee5f2aaa7c01d1f7df1fd9b7971cdb76ec755c227f87bc5935fccd6a4716058ac_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement2(0x3f2738f0b087b2967e479483e052b614671802a0ad3ddf6a04fb86e32a125c77_cppui255);
+        r1cs_gg_ppzksnark_proof<curve_type> proof3(G1_value_type(0x0e54089a438030c10200850c8f900f2cc631270044d4bb607f59bf84564d6be3bf315e7b6c253de1060adad71b5d42e3_cppui381, 0x0844609d89967590354634de4b93e3a1f187c9a8919859278009ba506cb48346926bd072fc30241a0fc771d707bdf99f_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x022c9f24480c22d736c37c973fe696be08c533f598c4401b82288bfe62cafd920deb3b8536e4c0cd00933163a1830b68_cppui381, 0x0c0a72697a5820fc5388f3a92871d2881431e0978c90f5bbb2f6a313cd063b25850178e159271229f2e963f9233a30b4_cppui381), fq2_value_type(0x1377a842ab4bb30d8299315bb763cb617af6904526c1a6a90a6b3b443a2ffc57883f83a006328599070ba30ad9c68194_cppui381, 0x0c92ab2f18bdcc2178d9fd56ba783bd942f7311ca1d1634db2b645b2ff8a2d1ab733558b6f4836dce626d7f2b8517ec3_cppui381), fq2_value_type::one()), G1_value_type(0x0213ef2fdde74b15b2b066829a331cab1d8a7e6d7efa0094be4ef7f2f5658209b09627ff3ddbddd96b69d992853cf889_cppui381, 0x040dc8edacc46608f9587f9c9b658f1b2c2627f570c538f428423c731aa10ef8e828531f4bda6b0734ad35a2a9d7d51f_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement3(0x69be6aab659e93cbd70e94cb23ff4be9d42cfbcdf9c955145a2d2f20c8a9b031_cppui255);
+        r1cs_gg_ppzksnark_proof<curve_type> proof4(G1_value_type(0x0d6eece4630b049c30c50ccdc9750f11c9cd15aca43554700045ebc81b03cdaf8a7daed7a9c5870189c4c593fa109f05_cppui381, 0x0b085d537ad0cca263d560dce8d041bde490c95d2ff29cbf9fcd7c376ca3ab554d219ca9633f0b5e056aa35ef6e887ae_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x181c65c65ad8c0b504942f5740a7c175e0142226b7d441cc8cac836b4b6f713056cef60dca010d4d5e775fdd8bd339fa_cppui381, 0x1515267c97507db065a264c0d5a1b4f22b2d87502ecda11771fc097ab2665406ccdd0feb7ba57e53c4c3e8415d6bc6d3_cppui381), fq2_value_type(0x0fd7ffd768080edbc6830400f159e681c596a619746795ba5a9ad03b6dfd18047d3d1738784405c3c05e4bd9c5150790_cppui381, 0x17191a92cbe9c9acc873872162ab60ce5d01dab26280a96bec0cc04c628c47ed56d643906428de68fd5696b8bf39078d_cppui381), fq2_value_type::one()), G1_value_type(0x128ef42d1399ba429d4c79606321b98bfbeb984342221fe8b231bdc3a6a47673bcddb5205f5cc7a501034931a3ed08e3_cppui381, 0x0d515563f0840600c7b863b16536a3901084ea4714ca4fee4c906079c5c8d6acb28c1617d762a20e155f3cd9b9ac75ea_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement4(0x668f0a74247e78898b4b160ad3d63d8a209ab4bd151ebd93d04178c803e8bbfb_cppui255);
+        r1cs_gg_ppzksnark_proof<curve_type> proof5(G1_value_type(0x0f464d0971c96b7f52196d111a389350682c5758f941e0425c041fbac3593121ffb0c5e20249c790edfafe160f7d7106_cppui381, 0x1980374d3f569b32cb8b001b8ba9eec741e4835336e145263cc84ee14239f2fa38c9bf4f1c0c16638276518f5b8bb901_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x196a554c6af4aae8c58e871e453f9134ab8755a1dbdf10ee88ff0e7b678b8c0c696f5d2a7c9d0bbdf6bc44c9f039d552_cppui381, 0x115ca6da99922e86fe7d58317ba8e106dc23b1b970eee21f11a07fd2962fccb69c4a26fcaf8e17f04030e2c2c10df817_cppui381), fq2_value_type(0x002c3d0ee2f62aa0c44eb32c913472e6c1e86b372337f21ecb1e44d00b99a2b6f2de78df7c2ba6a4fb5c36f0e03d7cc1_cppui381, 0x0d4115c34a549c05223076219c2d030756511433c8e428ef26446847e427dd3c78706375df5df02378b9e212a69fc584_cppui381), fq2_value_type::one()), G1_value_type(0x04a89866a20de75b2a326f4c4a5b283cbfc431a51eb4bf2a9230ae66edd772179dd4e0c74b4ec59f0017ad5f21fbfaef_cppui381, 0x056c29dee82c9cec67fce45e4eba0484e4ce47722d7ddf4f62e827f580770777999926017fb5fa2481c04f7aaa787d20_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement5(0x3f2202b2e3a6f87cc7bd57565b30b78f08dc1ad79e1cc6a9f372dc7639bc1aaf_cppui255);
+        r1cs_gg_ppzksnark_proof<curve_type> proof6(G1_value_type(0x170695ec2cd19303a822fb5480f19e82721af04b18d38bb9a8c71f816c47c7bedc6c2866b9581437a93e14f289573699_cppui381, 0x07dd012681a3ad0cc0859a73a3be4bddcf5bbf6b504d058fb0e3ba7fc0e9536ebab103cb5d7d2287e62604feef4afb96_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x16b5a5d6209f8fcbd6df06790f3f6c2f34322a4c7f52a5e3c2a1ffc9f0f1782278a63794571b3169181d8412457dc3bf_cppui381, 0x0ab1b302be43dbaa4a136eea7c8c484d4b144880ced9e474cdc7ee77c493761653c280612a7b4da8fc6cf03dc5c07a1f_cppui381), fq2_value_type(0x0e7f082279be6fb5447314329fae7e72986b263cf47b292c141ca662a0302481f14905648ab45679d9fe93a8d5fff627_cppui381, 0x046d0d3a1f489f32e8bf8f7cbb90a99ab17cdfb1b06194c9a60d2aa78bde45e26911b54451741aae28eec06ad96ba5ba_cppui381), fq2_value_type::one()), G1_value_type(0x118ed7dab64142f556effee3cbc5e4b7a71c28a98caa84767909bb7e367dff5c4ed49cd1c463aeac9058724e52132d9e_cppui381, 0x103cff37739ac1fb7b244ab5055ca49af28360127d33245e8f986417761b33afbe44a9ebd453092e364d87339c5cd0c2_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement6(0x10103523c670a127c25e5d5ff5d3eacf87cc5a5671a7833901b2a1fcf678df65_cppui255);
+        r1cs_gg_ppzksnark_proof<curve_type> proof7(G1_value_type(0x19d92ff555f7086784eeccd0c272a0baa68643a24a0df76621b84fb7c54501fa2397b02e91349837a2ea4edda2552ee8_cppui381, 0x14f218d14352a62d689cdf649feccfab09893969105dd073cab767ed9a2e18deb47a7f7fd02d8d7f9de33615fb62543f_cppui381, fq_value_type::one()), G2_value_type(fq2_value_type(0x110bf3f7b38d9777d3e66add2abc886823ce7fd89131fa1fe02c2c78aa12db5a4bd0d6f38d4122a68d2bcd3d9d64247f_cppui381, 0x0b0344d55966166e208754977ac8770a2e5b41e4a32dc73ca9171c5a0cba8cdddacce5627661539804409a6babbff97a_cppui381), fq2_value_type(0x16d3135e5907b37b87aa965128413ba872bbb2150b463a8f502693a95c6dce0031aa73479bccbfaabed12945656d50e4_cppui381, 0x0fc6d03d2b43fffab73cb912fc16274d8cf57d6474f3458f09fc8d6fc8bea4bd552c6aafed6b87c120407188da3dcbf9_cppui381), fq2_value_type::one()), G1_value_type(0x18a8945437db0c8a921e9cf68d32c325ccc401105bb00b4e0982b3f4706417b911a1d6db4aa92eabc4422e61ae08a638_cppui381, 0x198b25f849acdb8344d14e206457b051c90bf9b03b71e4523950a31b9b7a026f035c3fa4a4797e8d5ca5ba511492c2be_cppui381, fq_value_type::one()));
+        constexpr scalar_field_value_type statement7(0x4e2f20ac210798cc3c691edbdca3cd7ba6fc4fc706a49ecf26aa326517e35634_cppui255);
+        proofs = {
+            proof0, proof1, proof2, proof3, proof4, proof5, proof6, proof7,
+        };
+        statements = {
+            {statement0}, {statement1}, {statement2}, {statement3}, {statement4}, {statement5}, {statement6}, {statement7},
+        };
+    }
+
+    r1cs_gg_pp_zksnark_aggregate_srs<curve_type> srs;
+    r1cs_gg_pp_zksnark_aggregate_srs<curve_type>::srs_pair_type keys;
+    const r1cs_gg_ppzksnark_aggregate_proving_srs<curve_type> &pk = keys.first;
+    const r1cs_gg_ppzksnark_aggregate_verification_srs<curve_type> &vk = keys.second;
+    std::vector<r1cs_gg_ppzksnark_proof<curve_type>> proofs;
+    std::vector<std::vector<scalar_field_value_type>> statements;
+    std::vector<std::uint8_t> tr_include {1, 2, 3};
+    r1cs_gg_ppzksnark_aggregate_verification_key<curve_type> pvk;
+};
+
+/* The aggregate of the MiMC proofs, its compressed form, and the verification srs prepared with the lines of its
+ * pairings. */
+struct bls381_mimc_aggregate_fixture : bls381_mimc_fixture {
+    scheme_type::aggregate_proof_type agg_proof =
+        prove<scheme_type, hashes::sha2<256>>(pk, tr_include.begin(), tr_include.end(), proofs.begin(), proofs.end());
+    scheme_type::prepared_verification_srs_type prepared_vk = scheme_type::prepared_verification_srs_type(vk);
+    scheme_type::compressed_aggregate_proof_type compressed_agg_proof =
+        scheme_type::compressed_aggregate_proof_type(agg_proof);
+};
+
+/* The MiMC aggregate, and the key processed for light clients without and with fixed-base tables of
+ * gamma_ABC_g1. */
+struct bls381_mimc_processed_fixture : bls381_mimc_aggregate_fixture {
+    scheme_type::processed_aggregate_verification_key_type processed_vk =
+        scheme_type::processed_aggregate_verification_key_type(prepared_vk, pvk);
+    scheme_type::processed_aggregate_verification_key_type windowed_processed_vk =
+        scheme_type::processed_aggregate_verification_key_type(vk, pvk, 4);
+};
+
+BOOST_FIXTURE_TEST_CASE(bls381_verification_mimc, bls381_mimc_aggregate_fixture) {
     fq12_value_type ip_ab = fq12_value_type(fq6_value_type(fq2_value_type(0x0b651d531af67c48741c2896e21acb272c89d2cb0288a84a82c569a80b17317db12b3bcdbc20504bf18110f1a1f65cea_cppui381, 0x0318fca5b0e3cda6844c3bff03e2dc641cc8243b6ea5961689de891b2f4ac4fe461ac31bb9ad743cd7763f99a2516a12_cppui381), fq2_value_type(0x1079cb3f7b20a45f1a9efc0185b80c89e931bd60a34fc01ac40c34c0c59488deb5f07d9e2db09f96a436543c3c642835_cppui381, 0x0d1ac7b85bf328ee7d74c6ae7d44f714f9754d3f2fc0a4dbb759ec40a05ef2e41cadb93949d8303b32d291c6d6ebe517_cppui381), fq2_value_type(0x0a280ff5b37af55776eb9870ed1fddff8c1707dbf4d424097a9569d5ae1b439c36cc1b3b609177d7068eeef0e58bafdb_cppui381, 0x14b95a9296cffbc9b123bf554b3c82720b10f8b572f1e8fb85c7bca9a6b81652c94623f6a20a57d80b057446f999f5ac_cppui381)), fq6_value_type(fq2_value_type(0x047e72bee4172c3531c10746fd6ad73fe047d8f4aaa7c9e050e7c15f0bb2a70ef3a3c39e73cac32d433e4a7e87b7481d_cppui381, 0x16751d310b7f8bd98200210627da1f6b74b1c9e5e2d3c733f0ac34ebf2760b23b9aefef3ce745a9c52168a8f35593bdc_cppui381), fq2_value_type(0x11bf60e0012119678199196ce43fbd538c69e34c31b48efef70653ca7b8fcb4bd6b3dbdedb53d365c25117a19d777ae2_cppui381, 0x148b01af1c9d3da2a8811c0d1d428a2bd48c083d33383c89bcebd5e3990eca6b7b1a3c80880ecb49aed4acd1d2b2acf6_cppui381), fq2_value_type(0x1207d04dcbe7dfce8588b618f9fe26f6b5b82be8ac4e08438aff014dea82b5ada7905e2f44bae34814ac1b124804ab53_cppui381, 0x188cc860b35dea3244e17f0c5184ff3f07644690a02b5d31ea0952e8f4f63d7fc7789179ba834d42ec26432774fbdc1f_cppui381)));
     G1_value_type agg_c = G1_value_type(0x0034802068b3d1e4182f9b4a9aba124693d02599cdcb98a556f5835f6f81ce6071743f64e4054dca9beca6a98e93d11b_cppui381, 0x0c3b7c4e47a76f90ad22c5000ef930de2b6be5aed847ecca569b7d3bd35bfef71fd0f3c71a3c3857c8d0392d6a2925d6_cppui381, fq_value_type::one());
     std::size_t gp_n = 8;
@@ -901,4 +1297,315 @@ BOOST_AUTO_TEST_CASE(bls381_verification_mimc) {
     BOOST_CHECK(verify_res);
 }
 
+// the prepared verification srs verifies the aggregate as the plain one does
+BOOST_FIXTURE_TEST_CASE(bls381_prepared_verification_mimc, bls381_mimc_aggregate_fixture) {
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, pvk, statements, agg_proof, tr_include.begin(), tr_include.end())));
+}
+
+// the Gt elements of the proof are stored at half their size
+BOOST_FIXTURE_TEST_CASE(bls381_compressed_verification_mimc, bls381_mimc_aggregate_fixture) {
+    BOOST_CHECK(compressed_agg_proof.has_correct_len());
+    auto decompressed = compressed_agg_proof.decompress();
+    BOOST_CHECK(decompressed.first);
+    const auto &decompressed_agg_proof = decompressed.second;
+    BOOST_CHECK(decompressed_agg_proof.com_ab == agg_proof.com_ab);
+    BOOST_CHECK(decompressed_agg_proof.com_c == agg_proof.com_c);
+    BOOST_CHECK_EQUAL(decompressed_agg_proof.ip_ab, agg_proof.ip_ab);
+    BOOST_CHECK(decompressed_agg_proof.tmipp.gipa.comms_ab == agg_proof.tmipp.gipa.comms_ab);
+    BOOST_CHECK(decompressed_agg_proof.tmipp.gipa.comms_c == agg_proof.tmipp.gipa.comms_c);
+    BOOST_CHECK(decompressed_agg_proof.tmipp.gipa.z_ab == agg_proof.tmipp.gipa.z_ab);
+    typedef gt_compression<curve_type> gt_compression_type;
+    std::vector<std::uint8_t> compressed_ip_ab(gt_compression_type::element_size());
+    gt_compression_type::to_bytes(gt_compression_type::compress(agg_proof.ip_ab), compressed_ip_ab.begin(),
+                                  compressed_ip_ab.end());
+    auto read_ip_ab = gt_compression_type::from_bytes(compressed_ip_ab.begin(), compressed_ip_ab.end());
+    BOOST_CHECK(read_ip_ab.first);
+    BOOST_CHECK(gt_compression_type::decompress(read_ip_ab.second) == std::make_pair(true, agg_proof.ip_ab));
+    BOOST_CHECK(gt_compression_type::decompress(gt_compression_type::compress(fq12_value_type::one())) ==
+                std::make_pair(true, fq12_value_type::one()));
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, pvk, statements, compressed_agg_proof, tr_include.begin(), tr_include.end())));
+}
+
+// a compressed element of the torus outside Gt is rejected by the decompression
+BOOST_FIXTURE_TEST_CASE(bls381_off_subgroup_compressed_proof_mimc, bls381_mimc_aggregate_fixture) {
+    typedef gt_compression<curve_type> gt_compression_type;
+    scheme_type::compressed_aggregate_proof_type off_subgroup_agg_proof = compressed_agg_proof;
+    off_subgroup_agg_proof.gt_elements[4] = random_element<gt_compression_type::compressed_field_type>();
+    BOOST_CHECK(!gt_compression_type::decompress(off_subgroup_agg_proof.gt_elements[4]).first);
+    BOOST_CHECK(!off_subgroup_agg_proof.decompress().first);
+    BOOST_CHECK(!(verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, pvk, statements, off_subgroup_agg_proof, tr_include.begin(), tr_include.end())));
+}
+
+// the compressed proof round-trips through its byte encoding
+BOOST_FIXTURE_TEST_CASE(bls381_compressed_proof_marshalling_mimc, bls381_mimc_aggregate_fixture) {
+    typedef r1cs_gg_ppzksnark<curve_type> basic_scheme_type;
+    const std::vector<std::uint8_t> compressed_agg_proof_bytes =
+        nil::marshalling::verifier_input_serializer_tvm<basic_scheme_type>::process(compressed_agg_proof);
+    typedef nil::marshalling::verifier_input_deserializer_tvm<basic_scheme_type> deserializer_type;
+    nil::marshalling::status_type status;
+    scheme_type::compressed_aggregate_proof_type read_agg_proof = deserializer_type::aggregate_compressed_proof_process(
+        compressed_agg_proof_bytes.cbegin(), compressed_agg_proof_bytes.cend(), status);
+    BOOST_CHECK(status == nil::marshalling::status_type::success);
+    BOOST_CHECK(read_agg_proof.has_correct_len());
+    BOOST_CHECK(read_agg_proof.gt_elements == compressed_agg_proof.gt_elements);
+    BOOST_CHECK(read_agg_proof.decompress().second.tmipp.gipa.z_c == agg_proof.tmipp.gipa.z_c);
+    BOOST_CHECK(read_agg_proof.body.agg_c == agg_proof.agg_c);
+    BOOST_CHECK(read_agg_proof.body.tmipp.vkey_opening == agg_proof.tmipp.vkey_opening);
+    BOOST_CHECK(read_agg_proof.body.tmipp.wkey_opening == agg_proof.tmipp.wkey_opening);
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, pvk, statements, read_agg_proof, tr_include.begin(), tr_include.end())));
+
+    // truncated encodings and a number of proofs that is not a power of two are rejected
+    deserializer_type::aggregate_compressed_proof_process(
+        compressed_agg_proof_bytes.cbegin(), compressed_agg_proof_bytes.cend() - 1, status);
+    BOOST_CHECK(status == nil::marshalling::status_type::not_enough_data);
+    deserializer_type::aggregate_compressed_proof_process(
+        compressed_agg_proof_bytes.cbegin(), compressed_agg_proof_bytes.cbegin() + 2, status);
+    BOOST_CHECK(status == nil::marshalling::status_type::not_enough_data);
+    std::vector<std::uint8_t> bad_nproofs_bytes = compressed_agg_proof_bytes;
+    bad_nproofs_bytes[3] = 3;
+    deserializer_type::aggregate_compressed_proof_process(bad_nproofs_bytes.cbegin(), bad_nproofs_bytes.cend(), status);
+    BOOST_CHECK(status == nil::marshalling::status_type::invalid_msg_data);
+}
+
+// light clients process the srs and key once, optionally with fixed-base tables of gamma_ABC_g1
+BOOST_FIXTURE_TEST_CASE(bls381_processed_verification_mimc, bls381_mimc_processed_fixture) {
+    BOOST_CHECK(processed_vk.gamma_ABC_g1_precomp.empty());
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        processed_vk, statements, agg_proof, tr_include.begin(), tr_include.end())));
+    BOOST_CHECK(!windowed_processed_vk.gamma_ABC_g1_precomp.empty());
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        windowed_processed_vk, statements, agg_proof, tr_include.begin(), tr_include.end())));
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        windowed_processed_vk, statements, compressed_agg_proof, tr_include.begin(), tr_include.end())));
+    std::vector<std::uint8_t> wrong_tr_include {4, 5, 6};
+    BOOST_CHECK(!(verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        windowed_processed_vk, statements, agg_proof, wrong_tr_include.begin(), wrong_tr_include.end())));
+}
+
+// aggregates of several keys share a single final exponentiation: the MiMC proofs with a batch of
+// proofs of another circuit, under its own key
+BOOST_FIXTURE_TEST_CASE(bls381_multi_key_verification_mimc, bls381_mimc_processed_fixture) {
+    const r1cs_example<scalar_field_type> other_example =
+        generate_r1cs_example_with_field_input<scalar_field_type>(20, 2);
+    const scheme_type::keypair_type other_keypair = scheme_type::generate(other_example.constraint_system);
+    std::vector<r1cs_gg_ppzksnark_proof<curve_type>> other_proofs;
+    for (std::size_t i = 0; i < n; ++i) {
+        other_proofs.emplace_back(
+            scheme_type::prove(other_keypair.first, other_example.primary_input, other_example.auxiliary_input));
+    }
+    const std::vector<std::vector<scalar_field_value_type>> other_statements(n, other_example.primary_input);
+    const auto other_agg_proof = prove<scheme_type, hashes::sha2<256>>(
+        pk, tr_include.begin(), tr_include.end(), other_proofs.begin(), other_proofs.end());
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, other_keypair.second, other_statements, other_agg_proof, tr_include.begin(),
+        tr_include.end())));
+
+    std::vector<r1cs_gg_ppzksnark_aggregate_verification_key<curve_type>> batch_pvks {pvk, other_keypair.second};
+    std::vector<std::vector<std::vector<scalar_field_value_type>>> batch_statements {statements, other_statements};
+    std::vector<r1cs_gg_ppzksnark_aggregate_proof<curve_type>> batch_proofs {agg_proof, other_agg_proof};
+    std::vector<std::vector<std::uint8_t>> batch_tr_includes {tr_include, tr_include};
+    BOOST_CHECK((verify_aggregate_proofs<curve_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, batch_pvks, batch_statements, batch_proofs, batch_tr_includes)));
+    const scheme_type::processed_aggregate_verification_key_type other_processed_vk(prepared_vk,
+                                                                                   other_keypair.second);
+    std::vector<scheme_type::processed_aggregate_verification_key_type> batch_processed_vks {windowed_processed_vk,
+                                                                                           other_processed_vk};
+    BOOST_CHECK((verify_aggregate_proofs<curve_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        batch_processed_vks, batch_statements, batch_proofs, batch_tr_includes)));
+    // each aggregate is checked against its own key
+    std::vector<r1cs_gg_ppzksnark_aggregate_verification_key<curve_type>> swapped_pvks {other_keypair.second, pvk};
+    BOOST_CHECK(!(verify_aggregate_proofs<curve_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, swapped_pvks, batch_statements, batch_proofs, batch_tr_includes)));
+    batch_tr_includes[1] = {4, 5, 6};
+    BOOST_CHECK(!(verify_aggregate_proofs<curve_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, batch_pvks, batch_statements, batch_proofs, batch_tr_includes)));
+}
+
+// incoming aggregates are validated before any pairing
+BOOST_FIXTURE_TEST_CASE(bls381_validate_aggregate_proofs_mimc, bls381_mimc_aggregate_fixture) {
+    std::vector<r1cs_gg_ppzksnark_aggregate_proof<curve_type>> incoming_proofs {agg_proof, agg_proof, agg_proof};
+    BOOST_CHECK(validate_aggregate_proofs<curve_type>(incoming_proofs.begin(), incoming_proofs.end()).empty());
+    incoming_proofs[1].tmipp.gipa.z_c.pop_back();
+    BOOST_CHECK(validate_aggregate_proofs<curve_type>(incoming_proofs.begin(), incoming_proofs.end()) ==
+                std::vector<std::size_t> {1});
+    std::vector<scheme_type::compressed_aggregate_proof_type> incoming_compressed_proofs {compressed_agg_proof};
+    BOOST_CHECK(validate_aggregate_proofs<curve_type>(incoming_compressed_proofs.begin(),
+                                                      incoming_compressed_proofs.end())
+                    .empty());
+}
+
+// deferred settlement: all the checks of all the aggregates go through one final exponentiation, and the
+// invalid aggregate of a failed settlement is found by bisection
+BOOST_FIXTURE_TEST_CASE(bls381_deferred_verification_mimc, bls381_mimc_processed_fixture) {
+    r1cs_gg_ppzksnark_deferred_verifier<curve_type, DistributionType, GeneratorType> deferred;
+    for (std::size_t i = 0; i < 3; ++i) {
+        BOOST_CHECK_EQUAL(deferred.add(processed_vk, statements, agg_proof, tr_include.begin(), tr_include.end()), i);
+    }
+    BOOST_CHECK(deferred.settle());
+    BOOST_CHECK(deferred.failed().empty());
+    BOOST_CHECK_EQUAL(deferred.size(), 0);
+    std::vector<std::uint8_t> wrong_tr_include {4, 5, 6};
+    deferred.add(processed_vk, statements, agg_proof, tr_include.begin(), tr_include.end());
+    deferred.add(windowed_processed_vk, statements, agg_proof, wrong_tr_include.begin(), wrong_tr_include.end());
+    deferred.add(windowed_processed_vk, statements, compressed_agg_proof, tr_include.begin(), tr_include.end());
+    BOOST_CHECK(!deferred.settle());
+    BOOST_CHECK(deferred.failed() == std::vector<std::size_t> {1});
+}
+
+// fewer proofs than the srs is specialized for are padded with the identity
+BOOST_FIXTURE_TEST_CASE(bls381_partial_aggregate_proofs_mimc, bls381_mimc_aggregate_fixture) {
+    auto partial_agg_proof = prove<scheme_type, hashes::sha2<256>>(pk, tr_include.begin(), tr_include.end(),
+                                                                   proofs.begin(), proofs.begin() + 5);
+    BOOST_CHECK_EQUAL(partial_agg_proof.tmipp.gipa.nproofs, n);
+    std::vector<std::vector<scalar_field_value_type>> partial_statements(statements.begin(), statements.begin() + 5);
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, pvk, partial_statements, partial_agg_proof, tr_include.begin(), tr_include.end())));
+    BOOST_CHECK(!(verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        prepared_vk, pvk, statements, partial_agg_proof, tr_include.begin(), tr_include.end())));
+}
+
+// many proofs are batch verified, aggregated or both depending on their demand
+BOOST_FIXTURE_TEST_CASE(bls381_many_proofs_verifier_mimc, bls381_mimc_processed_fixture) {
+    typedef r1cs_gg_ppzksnark_many_proofs_verifier<curve_type, DistributionType, GeneratorType> many_verifier_type;
+    const auto groth16_processed_vk = r1cs_gg_ppzksnark_process_verification_key<curve_type>::process(
+        r1cs_gg_ppzksnark_verification_key<curve_type>(pvk));
+    const r1cs_gg_ppzksnark_proof_batch<curve_type> proof_batch(proofs.begin(), proofs.end());
+    auto many_res = many_verifier_type::process(pk, groth16_processed_vk, processed_vk, statements, proof_batch,
+                                                tr_include.begin(), tr_include.end());
+    BOOST_CHECK(many_res.verified);
+    BOOST_CHECK(many_res.strategy == r1cs_gg_ppzksnark_verification_strategy::batch_verification);
+    BOOST_CHECK(!many_res.aggregate);
+    r1cs_gg_ppzksnark_verification_demand relayed_demand;
+    relayed_demand.aggregate_required = true;
+    relayed_demand.downstream_verifiers = 100;
+    many_res = many_verifier_type::process(pk, groth16_processed_vk, processed_vk, statements, proof_batch,
+                                           tr_include.begin(), tr_include.end(), relayed_demand);
+    BOOST_CHECK(many_res.verified);
+    BOOST_CHECK(many_res.strategy != r1cs_gg_ppzksnark_verification_strategy::batch_verification);
+    BOOST_CHECK(many_res.aggregate);
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        processed_vk, statements, *many_res.aggregate, tr_include.begin(), tr_include.end())));
+    std::vector<std::vector<scalar_field_value_type>> swapped_statements(statements);
+    std::swap(swapped_statements[0], swapped_statements[1]);
+    for (const auto strategy : {r1cs_gg_ppzksnark_verification_strategy::aggregation,
+                                r1cs_gg_ppzksnark_verification_strategy::batch_verification_then_aggregation}) {
+        r1cs_gg_ppzksnark_verification_costs forced_costs;
+        (strategy == r1cs_gg_ppzksnark_verification_strategy::aggregation ? forced_costs.batch_verification :
+                                                                             forced_costs.aggregate_verification)
+            .fixed = 1e6;
+        many_res = many_verifier_type::process(pk, groth16_processed_vk, processed_vk, swapped_statements,
+                                               proof_batch, tr_include.begin(), tr_include.end(), relayed_demand,
+                                               forced_costs);
+        BOOST_CHECK(many_res.strategy == strategy);
+        BOOST_CHECK(!many_res.verified);
+        BOOST_CHECK(!many_res.aggregate);
+    }
+    // the shared models are replaced as a whole and picked up by later calls
+    {
+        const r1cs_gg_ppzksnark_verification_costs default_costs = r1cs_gg_ppzksnark_verification_costs::current();
+        r1cs_gg_ppzksnark_verification_costs forced_costs;
+        forced_costs.aggregate_verification.fixed = 1e6;
+        r1cs_gg_ppzksnark_verification_costs::set_current(forced_costs);
+        many_res = many_verifier_type::process(pk, groth16_processed_vk, processed_vk, statements, proof_batch,
+                                               tr_include.begin(), tr_include.end(), relayed_demand);
+        BOOST_CHECK(many_res.strategy ==
+                    r1cs_gg_ppzksnark_verification_strategy::batch_verification_then_aggregation);
+        BOOST_CHECK(many_res.verified);
+        r1cs_gg_ppzksnark_verification_costs::set_current(default_costs);
+    }
+}
+
+typedef r1cs_gg_ppzksnark_ipp2_aggregation_service<curve_type> service_type;
+
+// proofs submitted concurrently are aggregated by batches, each padded up to the srs
+BOOST_FIXTURE_TEST_CASE(bls381_aggregation_service_test, bls381_mimc_fixture) {
+    const scheme_type::processed_aggregate_verification_key_type processed_vk(vk, pvk);
+    std::vector<std::future<service_type::submission_type>> submissions(proofs.size());
+    {
+        r1cs_gg_ppzksnark_ipp2_aggregation_options service_options;
+        service_options.max_batch_size = 4;
+        service_type service(pk, tr_include, service_options);
+        std::vector<std::thread> provers;
+        for (std::size_t t = 0; t < 2; ++t) {
+            provers.emplace_back([&, t]() {
+                for (std::size_t i = t; i < proofs.size(); i += 2) {
+                    submissions[i] = service.submit(proofs[i], statements[i]);
+                }
+            });
+        }
+        for (std::thread &prover : provers) {
+            prover.join();
+        }
+    }
+    for (std::size_t i = 0; i < proofs.size(); ++i) {
+        const service_type::submission_type submission = submissions[i].get();
+        BOOST_CHECK_EQUAL(submission.batch->public_inputs.size(), n);
+        BOOST_CHECK(submission.batch->public_inputs[submission.position] == statements[i]);
+        BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+            processed_vk, submission.batch->public_inputs, submission.batch->aggregate, tr_include.begin(),
+            tr_include.end())));
+    }
+}
+
+// a batch left open is sealed after max_delay, fewer proofs than the srs being padded with the last one
+BOOST_FIXTURE_TEST_CASE(bls381_aggregation_service_delay_test, bls381_mimc_fixture) {
+    const scheme_type::processed_aggregate_verification_key_type processed_vk(vk, pvk);
+    constexpr std::size_t submitted = 3;
+
+    r1cs_gg_ppzksnark_ipp2_aggregation_options service_options;
+    service_options.max_delay = std::chrono::milliseconds(10);
+    service_type service(pk, tr_include, service_options);
+    BOOST_CHECK_EQUAL(service.max_batch_size(), n);
+    std::vector<std::future<service_type::submission_type>> submissions;
+    for (std::size_t i = 0; i < submitted; ++i) {
+        submissions.emplace_back(service.submit(proofs[i], statements[i]));
+    }
+    // the service is still running: the batch is sealed by its deadline, not by the destructor
+    for (std::size_t i = 0; i < submitted; ++i) {
+        BOOST_REQUIRE(submissions[i].wait_for(std::chrono::seconds(60)) == std::future_status::ready);
+        const service_type::submission_type submission = submissions[i].get();
+        BOOST_CHECK_EQUAL(submission.position, i);
+        BOOST_CHECK_EQUAL(submission.batch->public_inputs.size(), n);
+        for (std::size_t j = 0; j < n; ++j) {
+            BOOST_CHECK(submission.batch->public_inputs[j] == statements[std::min(j, submitted - 1)]);
+        }
+        BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+            processed_vk, submission.batch->public_inputs, submission.batch->aggregate, tr_include.begin(),
+            tr_include.end())));
+    }
+}
+
+// an invalid proof fails its own submission only
+BOOST_FIXTURE_TEST_CASE(bls381_aggregation_service_invalid_proof_test, bls381_mimc_fixture) {
+    const scheme_type::processed_aggregate_verification_key_type processed_vk(vk, pvk);
+    r1cs_gg_ppzksnark_proof<curve_type> off_subgroup = proofs[1];
+    off_subgroup.g_C = g1_off_subgroup_point(fq_value_type(3));
+    r1cs_gg_ppzksnark_proof<curve_type> at_infinity = proofs[1];
+    at_infinity.g_A = G1_value_type::zero();
+
+    std::vector<std::future<service_type::submission_type>> submissions;
+    {
+        r1cs_gg_ppzksnark_ipp2_aggregation_options service_options;
+        service_options.max_batch_size = 4;
+        service_type service(pk, tr_include, service_options);
+        submissions.emplace_back(service.submit(proofs[0], statements[0]));
+        submissions.emplace_back(service.submit(off_subgroup, statements[1]));
+        submissions.emplace_back(service.submit(at_infinity, statements[1]));
+        submissions.emplace_back(service.submit(proofs[2], statements[2]));
+    }
+    BOOST_CHECK_THROW(submissions[1].get(), std::runtime_error);
+    BOOST_CHECK_THROW(submissions[2].get(), std::runtime_error);
+    const service_type::submission_type first = submissions[0].get(), last = submissions[3].get();
+    BOOST_CHECK(first.batch == last.batch);
+    BOOST_CHECK_EQUAL(first.position, 0);
+    BOOST_CHECK_EQUAL(last.position, 1);
+    BOOST_CHECK(first.batch->public_inputs[1] == statements[2]);
+    BOOST_CHECK((verify<scheme_type, DistributionType, GeneratorType, hashes::sha2<256>>(
+        processed_vk, first.batch->public_inputs, first.batch->aggregate, tr_include.begin(), tr_include.end())));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,15 +29,37 @@
 #ifndef CRYPTO3_RUN_R1CS_GG_PPZKSNARK_HPP
 #define CRYPTO3_RUN_R1CS_GG_PPZKSNARK_HPP
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include <boost/config.hpp>
 
+#include <boost/accumulators/accumulators.hpp>
+
+#include <nil/crypto3/zk/snark/job_control.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/circuit_analytics.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/deferred_verifier.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/generator_checkpoint.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proof_validation.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/proving_key_cache.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/split_multiexp_backend.hpp>
+#include <nil/crypto3/zk/snark/accumulators/sparse.hpp>
 
 #include "../r1cs_examples.hpp"
+#include "../../../temporary_path.hpp"
 
 #include <nil/crypto3/zk/snark/algorithms/generate.hpp>
 #include <nil/crypto3/zk/snark/algorithms/verify.hpp>
 #include <nil/crypto3/zk/snark/algorithms/prove.hpp>
+#include <nil/crypto3/zk/snark/algorithms/async.hpp>
 
 namespace nil {
     namespace crypto3 {
@@ -149,6 +171,1050 @@ namespace nil {
 
                     return ans;
                 }
+
+                /**
+                 * A R1CS example with its keys and a proof of it, which the checks below run the other proving
+                 * and verification paths of the R1CS GG-ppzkSNARK against.
+                 */
+                template<typename CurveType>
+                struct r1cs_gg_ppzksnark_run {
+                    using basic_proof_system = r1cs_gg_ppzksnark<CurveType>;
+
+                    r1cs_gg_ppzksnark_run(const r1cs_example<typename CurveType::scalar_field_type> &example) :
+                        example(example), keypair(generate<basic_proof_system>(example.constraint_system)),
+                        pvk(r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(keypair.second)),
+                        proof(prove<basic_proof_system>(keypair.first, example.primary_input,
+                                                        example.auxiliary_input)),
+                        input_buffer(example.primary_input),
+                        ans(verify<basic_proof_system>(keypair.second, example.primary_input, proof)) {
+                        input_buffer.insert(input_buffer.end(), example.auxiliary_input.begin(),
+                                            example.auxiliary_input.end());
+                    }
+
+                    /* the proof with g_C moved by delta_g1, which no verifier accepts */
+                    typename basic_proof_system::proof_type tampered_proof() const {
+                        typename basic_proof_system::proof_type tampered = proof;
+                        tampered.g_C = tampered.g_C + keypair.first.delta_g1;
+                        return tampered;
+                    }
+
+                    /* n proofs of the example through the batch prover */
+                    std::vector<typename basic_proof_system::proof_type> proofs_of_batch(const std::size_t n) const {
+                        const std::vector<std::pair<typename basic_proof_system::primary_input_type,
+                                                    typename basic_proof_system::auxiliary_input_type>>
+                            witnesses(n, std::make_pair(example.primary_input, example.auxiliary_input));
+                        return prove_batch<basic_proof_system>(keypair.first, witnesses);
+                    }
+
+                    void test_processed_proving_key() const;
+                    void test_batch_prover() const;
+                    void test_mapped_proving_key() const;
+                    void test_compact_proving_key() const;
+                    void test_executor() const;
+                    void test_streamed_proving_key() const;
+                    void test_moved_constraint_system() const;
+                    void test_batch_verifier() const;
+                    void test_input_tables() const;
+                    void test_mapped_verification_key() const;
+                    void test_affine_proving_key() const;
+                    void test_streamed_primary_input() const;
+                    void test_input_cursor_verifier() const;
+                    void test_witness_program() const;
+                    void test_distributed_prover() const;
+                    void test_lagrange_proving_key() const;
+                    void test_sparse_proving_key() const;
+                    void test_pipelined_prover() const;
+                    void test_incremental_prover() const;
+                    void test_async_prover() const;
+                    void test_memory_budget() const;
+                    void test_delta_update() const;
+                    void test_qap_witness_prover() const;
+                    void test_verification_key_registry() const;
+                    void test_deferred_verifier() const;
+                    void test_proof_validation() const;
+                    void test_span_inputs() const;
+                    void test_streamed_witness() const;
+                    void test_warm_up() const;
+                    void test_proving_key_cache() const;
+                    void test_generator_checkpoint() const;
+                    void test_batch_affine_multiexp() const;
+                    void test_split_multiexp_backend() const;
+                    void test_circuit_analytics() const;
+                    void test_bytecode_proving_key() const;
+
+                    r1cs_example<typename CurveType::scalar_field_type> example;
+                    typename basic_proof_system::keypair_type keypair;
+                    typename basic_proof_system::processed_verification_key_type pvk;
+                    typename basic_proof_system::proof_type proof;
+                    /* primary and auxiliary input back to back in one buffer, as received */
+                    std::vector<typename CurveType::scalar_field_type::value_type> input_buffer;
+                    /* whether the basic verifier accepts the proof, which every other path agrees with */
+                    bool ans;
+                };
+
+                /* the prover with a processed proving key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_processed_proving_key() const {
+                    typename basic_proof_system::processed_proving_key_type ppk =
+                        r1cs_gg_ppzksnark_process_proving_key<CurveType>::process(keypair.first);
+
+                    typename basic_proof_system::proof_type processed_proof =
+                        prove<basic_proof_system>(ppk, example.primary_input, example.auxiliary_input);
+
+                    const bool ans5 = verify<basic_proof_system>(pvk, example.primary_input, processed_proof);
+
+                    std::cout << "Processed proving key proof verified, result: " << ans5 << std::endl;
+
+                    BOOST_CHECK(ans == ans5);
+                }
+
+                /* the batch prover, with a proving key and a processed one */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_batch_prover() const {
+                    const typename basic_proof_system::processed_proving_key_type ppk =
+                        r1cs_gg_ppzksnark_process_proving_key<CurveType>::process(keypair.first);
+
+                    std::vector<std::pair<typename basic_proof_system::primary_input_type,
+                                          typename basic_proof_system::auxiliary_input_type>>
+                        witnesses(2, std::make_pair(example.primary_input, example.auxiliary_input));
+
+                    std::vector<typename basic_proof_system::proof_type> batch_proofs =
+                        prove_batch<basic_proof_system>(keypair.first, witnesses);
+                    std::vector<typename basic_proof_system::proof_type> processed_batch_proofs =
+                        prove_batch<basic_proof_system>(ppk, witnesses);
+
+                    BOOST_CHECK(batch_proofs.size() == witnesses.size());
+                    BOOST_CHECK(processed_batch_proofs.size() == witnesses.size());
+                    for (std::size_t i = 0; i < witnesses.size(); ++i) {
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, batch_proofs[i]));
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input,
+                                                                      processed_batch_proofs[i]));
+                    }
+                }
+
+                /* the prover with a memory-mapped proving key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_mapped_proving_key() const {
+                    {
+                        const std::string mapped_pk_path = temporary_path("r1cs_gg_ppzksnark_mapped_proving_key.bin");
+                        r1cs_gg_ppzksnark_mapped_proving_key<CurveType>::write(mapped_pk_path, keypair.first);
+                        {
+                            const r1cs_gg_ppzksnark_mapped_proving_key<CurveType> mapped_pk(
+                                mapped_pk_path, typename basic_proof_system::constraint_system_type(
+                                                    keypair.first.constraint_system));
+                            BOOST_CHECK(mapped_pk.alpha_g1() == keypair.first.alpha_g1);
+                            BOOST_CHECK(mapped_pk.beta_g1() == keypair.first.beta_g1);
+                            BOOST_CHECK(mapped_pk.delta_g1() == keypair.first.delta_g1);
+                            BOOST_CHECK(mapped_pk.beta_g2() == keypair.first.beta_g2);
+                            BOOST_CHECK(mapped_pk.delta_g2() == keypair.first.delta_g2);
+                            BOOST_CHECK(std::equal(mapped_pk.A_query_begin(), mapped_pk.A_query_end(),
+                                                   keypair.first.A_query.begin(), keypair.first.A_query.end()));
+                            BOOST_CHECK(std::equal(mapped_pk.B_query_indices_begin(), mapped_pk.B_query_indices_end(),
+                                                   keypair.first.B_query.indices.begin(),
+                                                   keypair.first.B_query.indices.end()));
+                            BOOST_CHECK(mapped_pk.B_query_domain_size() == keypair.first.B_query.domain_size());
+                            for (std::size_t i = 0; i < keypair.first.B_query.size(); ++i) {
+                                BOOST_CHECK(mapped_pk.B_query_g_begin()[i] == keypair.first.B_query.values[i].g);
+                                BOOST_CHECK(mapped_pk.B_query_h_begin()[i] == keypair.first.B_query.values[i].h);
+                            }
+                            BOOST_CHECK(std::equal(mapped_pk.H_query_begin(), mapped_pk.H_query_end(),
+                                                   keypair.first.H_query.begin(), keypair.first.H_query.end()));
+                            BOOST_CHECK(std::equal(mapped_pk.L_query_begin(), mapped_pk.L_query_end(),
+                                                   keypair.first.L_query.begin(), keypair.first.L_query.end()));
+                            BOOST_CHECK(ans == verify<basic_proof_system>(
+                                                   keypair.second, example.primary_input,
+                                                   prove<basic_proof_system>(mapped_pk, example.primary_input,
+                                                                             example.auxiliary_input)));
+                        }
+
+                        /* a file shorter than its header announces is rejected before any section is read */
+                        std::string contents;
+                        {
+                            std::ifstream in(mapped_pk_path, std::ios::binary);
+                            contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                        }
+                        const std::string truncated_path =
+                            temporary_path("r1cs_gg_ppzksnark_truncated_proving_key.bin");
+                        for (const std::size_t size : {contents.size() - 64, std::size_t(32)}) {
+                            std::ofstream(truncated_path, std::ios::binary | std::ios::trunc)
+                                .write(contents.data(), size);
+                            typename basic_proof_system::constraint_system_type constraint_system =
+                                keypair.first.constraint_system;
+                            BOOST_CHECK_THROW(r1cs_gg_ppzksnark_mapped_proving_key<CurveType> truncated(
+                                                  truncated_path, std::move(constraint_system)),
+                                              std::runtime_error);
+                        }
+                        std::remove(truncated_path.c_str());
+                        std::remove(mapped_pk_path.c_str());
+                    }
+                }
+
+                /* the prover with a compact proving key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_compact_proving_key() const {
+                    typename basic_proof_system::compact_proving_key_type cpk(
+                        typename basic_proof_system::proving_key_type(keypair.first));
+
+                    typename basic_proof_system::proof_type compact_proof =
+                        prove<basic_proof_system>(cpk, example.primary_input, example.auxiliary_input);
+
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, compact_proof));
+                }
+
+                /* the prover on a caller-supplied executor */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_executor() const {
+                    std::size_t executor_tasks = 0;
+                    const executor pool_executor(4, [&](std::size_t n, const executor::task_type &f) {
+                        for (std::size_t i = 0; i < n; ++i, ++executor_tasks) {
+                            f(i);
+                        }
+                    });
+                    {
+                        executor::scope guard(pool_executor);
+
+                        typename basic_proof_system::proof_type executor_proof =
+                            prove<basic_proof_system>(keypair.first, example.primary_input, example.auxiliary_input);
+
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, executor_proof));
+                    }
+                    BOOST_CHECK(executor_tasks > 0);
+                }
+
+                /* the generator streaming the proving key to disk */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_streamed_proving_key() const {
+                    const std::string mapped_key_path = temporary_path("r1cs_gg_ppzksnark_streamed_proving_key.bin");
+                    {
+                        auto mapped_keypair = generate<basic_proof_system>(example.constraint_system, mapped_key_path);
+                        BOOST_CHECK(r1cs_gg_ppzksnark_warm_up<CurveType>::process(mapped_keypair.first).bytes > 0);
+
+                        typename basic_proof_system::proof_type mapped_proof = prove<basic_proof_system>(
+                            mapped_keypair.first, example.primary_input, example.auxiliary_input);
+
+                        BOOST_CHECK(ans == verify<basic_proof_system>(mapped_keypair.second, example.primary_input,
+                                                                      mapped_proof));
+                    }
+                    std::remove(mapped_key_path.c_str());
+                }
+
+                /* the generator on a moved constraint system */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_moved_constraint_system() const {
+                    typename basic_proof_system::constraint_system_type moved_constraint_system =
+                        example.constraint_system;
+                    typename basic_proof_system::keypair_type moved_keypair =
+                        basic_proof_system::generate(std::move(moved_constraint_system));
+                    BOOST_CHECK(moved_keypair.first.constraint_system == keypair.first.constraint_system);
+
+                    typename basic_proof_system::proof_type moved_proof =
+                        prove<basic_proof_system>(moved_keypair.first, example.primary_input, example.auxiliary_input);
+                    BOOST_CHECK(ans == verify<basic_proof_system>(moved_keypair.second, example.primary_input,
+                                                                  moved_proof));
+                }
+
+                /* the batch verifier, on valid, tampered and short batches */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_batch_verifier() const {
+                    const typename basic_proof_system::processed_proving_key_type ppk =
+                        r1cs_gg_ppzksnark_process_proving_key<CurveType>::process(keypair.first);
+                    const std::vector<std::pair<typename basic_proof_system::primary_input_type,
+                                                typename basic_proof_system::auxiliary_input_type>>
+                        witnesses(2, std::make_pair(example.primary_input, example.auxiliary_input));
+                    const std::vector<typename basic_proof_system::proof_type> batch_proofs =
+                        prove_batch<basic_proof_system>(keypair.first, witnesses);
+                    const std::vector<typename basic_proof_system::proof_type> processed_batch_proofs =
+                        prove_batch<basic_proof_system>(ppk, witnesses);
+
+                    const std::vector<typename basic_proof_system::primary_input_type> batch_primary_inputs(
+                        batch_proofs.size(), example.primary_input);
+                    BOOST_CHECK(ans == verify_batch<basic_proof_system>(pvk, batch_primary_inputs, batch_proofs));
+                    BOOST_CHECK(ans == verify_batch<basic_proof_system>(keypair.second, batch_primary_inputs,
+                                                                        processed_batch_proofs));
+
+                    std::vector<typename basic_proof_system::proof_type> tampered_batch_proofs = batch_proofs;
+                    tampered_batch_proofs.back().g_C = tampered_batch_proofs.back().g_C + keypair.first.delta_g1;
+                    BOOST_CHECK(!verify_batch<basic_proof_system>(pvk, batch_primary_inputs, tampered_batch_proofs));
+
+                    const std::vector<typename basic_proof_system::proof_type> short_batch_proofs(
+                        batch_proofs.begin(), batch_proofs.end() - 1);
+                    BOOST_CHECK(!verify_batch<basic_proof_system>(pvk, batch_primary_inputs, short_batch_proofs));
+
+                    const typename basic_proof_system::proof_batch_type proof_batch(batch_proofs.begin(),
+                                                                                   batch_proofs.end());
+                    BOOST_CHECK(proof_batch.size() == batch_proofs.size());
+                    BOOST_CHECK(proof_batch[1] == batch_proofs[1]);
+                    BOOST_CHECK(ans == verify_batch<basic_proof_system>(pvk, batch_primary_inputs.begin(),
+                                                                        batch_primary_inputs.end(), proof_batch));
+                }
+
+                /* the online verifier with fixed-base tables of gamma_ABC_g1 */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_input_tables() const {
+                    const typename basic_proof_system::processed_verification_key_type table_pvk =
+                        r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(keypair.second, 4);
+                    BOOST_CHECK(!table_pvk.gamma_ABC_g1_precomp.empty());
+                    BOOST_CHECK(ans == verify<basic_proof_system>(table_pvk, example.primary_input, proof));
+                }
+
+                /* the verifier with a memory-mapped verification key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_mapped_verification_key() const {
+                    const std::string mapped_vk_path = temporary_path("r1cs_gg_ppzksnark_verification_key.bin");
+                    r1cs_gg_ppzksnark_mapped_verification_key<CurveType>::write(mapped_vk_path, keypair.second);
+                    {
+                        r1cs_gg_ppzksnark_mapped_verification_key<CurveType> mapped_vk(mapped_vk_path);
+                        BOOST_CHECK(mapped_vk.verification_key() == keypair.second);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(mapped_vk.verification_key(),
+                                                                      example.primary_input, proof));
+                    }
+                    {
+                        /* a file shorter than its header announces is rejected before any section is read */
+                        std::ifstream in(mapped_vk_path, std::ios::binary);
+                        const std::string contents((std::istreambuf_iterator<char>(in)),
+                                                   std::istreambuf_iterator<char>());
+                        const std::string truncated_path =
+                            temporary_path("r1cs_gg_ppzksnark_truncated_verification_key.bin");
+                        for (const std::size_t size : {contents.size() - 64, std::size_t(32)}) {
+                            std::ofstream(truncated_path, std::ios::binary | std::ios::trunc)
+                                .write(contents.data(), size);
+                            BOOST_CHECK_THROW(
+                                r1cs_gg_ppzksnark_mapped_verification_key<CurveType> truncated(truncated_path),
+                                std::runtime_error);
+                        }
+                        std::remove(truncated_path.c_str());
+                    }
+                    std::remove(mapped_vk_path.c_str());
+                }
+
+                /* the prover with an affine proving key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_affine_proving_key() const {
+                    const typename basic_proof_system::affine_proving_key_type affine_pk(keypair.first);
+                    BOOST_CHECK(affine_pk.to_proving_key() == keypair.first);
+
+                    typename basic_proof_system::proof_type affine_proof =
+                        prove<basic_proof_system>(affine_pk, example.primary_input, example.auxiliary_input);
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, affine_proof));
+                }
+
+                /* the streamed accumulation of the primary input */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_streamed_primary_input() const {
+                    typedef typename CurveType::g1_type g1_type;
+                    typedef std::vector<typename CurveType::scalar_field_type::value_type> input_chunk_type;
+                    typedef boost::accumulators::features<accumulators::tag::sparse<g1_type>> input_features_type;
+
+                    const std::size_t half = example.primary_input.size() / 2;
+                    boost::accumulators::accumulator_set<input_chunk_type, input_features_type> input_acc(
+                        accumulators::bases = keypair.second.gamma_ABC_g1);
+                    input_acc(input_chunk_type(example.primary_input.begin(), example.primary_input.begin() + half),
+                              accumulators::offset = 0);
+                    input_acc(input_chunk_type(example.primary_input.begin() + half, example.primary_input.end()));
+
+                    const accumulation_vector<g1_type> streamed_input =
+                        accumulators::extract::sparse<g1_type>(input_acc);
+                    BOOST_CHECK(streamed_input == keypair.second.gamma_ABC_g1.accumulate_chunk(
+                                                      example.primary_input.begin(), example.primary_input.end(), 0));
+                }
+
+                /* the verifier with a streamed primary input */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_input_cursor_verifier() const {
+                    typedef typename CurveType::g1_type g1_type;
+                    const std::size_t half = example.primary_input.size() / 2;
+
+                    accumulation_cursor<g1_type> input_cursor(pvk.gamma_ABC_g1);
+                    input_cursor.accumulate(example.primary_input.begin(), example.primary_input.begin() + half)
+                        .accumulate(example.primary_input.begin() + half, example.primary_input.end());
+                    BOOST_CHECK(input_cursor.result() ==
+                                keypair.second.gamma_ABC_g1.accumulate_chunk(example.primary_input.begin(),
+                                                                             example.primary_input.end(), 0));
+                    BOOST_CHECK(ans == r1cs_gg_ppzksnark_verifier_strong_input_consistency<CurveType>::process(
+                                           pvk, input_cursor, proof));
+
+                    /* a cursor short of the end of the input, or started past its beginning, is rejected */
+                    if (half < example.primary_input.size()) {
+                        accumulation_cursor<g1_type> partial_cursor(pvk.gamma_ABC_g1);
+                        partial_cursor.accumulate(example.primary_input.begin(), example.primary_input.begin() + half);
+                        BOOST_CHECK(!r1cs_gg_ppzksnark_verifier_strong_input_consistency<CurveType>::process(
+                            pvk, partial_cursor, proof));
+                    }
+                    if (half > 0) {
+                        accumulation_cursor<g1_type> shifted_cursor(pvk.gamma_ABC_g1, half);
+                        shifted_cursor.accumulate(example.primary_input.begin() + half, example.primary_input.end());
+                        BOOST_CHECK(!r1cs_gg_ppzksnark_verifier_strong_input_consistency<CurveType>::process(
+                            pvk, shifted_cursor, proof));
+                    }
+                }
+
+                /* the columnar constraint system against the one it is built from */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_witness_program() const {
+                    r1cs_witness_program<typename CurveType::scalar_field_type> program;
+                    program.primary_input_size = example.constraint_system.primary_input_size;
+                    program.auxiliary_input_size = example.constraint_system.auxiliary_input_size;
+                    for (const auto &constraint : example.constraint_system.constraints) {
+                        program.add_constraint(constraint);
+                    }
+                    BOOST_CHECK(program.to_constraint_system() == example.constraint_system);
+                    BOOST_CHECK(program.is_valid() == example.constraint_system.is_valid());
+                    BOOST_CHECK(program.is_satisfied(example.primary_input, example.auxiliary_input));
+                    BOOST_CHECK(program.is_AB_swap_beneficial() == example.constraint_system.is_AB_swap_beneficial());
+                }
+
+                /* the distributed prover over sharded queries */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_distributed_prover() const {
+                    typedef r1cs_gg_ppzksnark_distributed_prover<CurveType> distributed_prover_type;
+
+                    const std::size_t num_shards = 3;
+                    std::vector<typename distributed_prover_type::shard_proving_key_type> shard_keys;
+                    for (const auto &shard : distributed_prover_type::plan(keypair.first, num_shards)) {
+                        shard_keys.emplace_back(distributed_prover_type::shard_proving_key(keypair.first, shard));
+                    }
+
+                    typename basic_proof_system::proof_type distributed_proof = distributed_prover_type::process(
+                        keypair.first, example.primary_input, example.auxiliary_input, num_shards,
+                        [&](const std::vector<typename distributed_prover_type::job_type> &jobs) {
+                            /* answer the shards in reverse order, as remote workers may */
+                            std::vector<typename distributed_prover_type::partial_evaluation_type> partials;
+                            for (std::size_t i = jobs.size(); i-- > 0;) {
+                                partials.emplace_back(distributed_prover_type::evaluate(shard_keys[i], jobs[i]));
+                            }
+                            return partials;
+                        });
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, distributed_proof));
+                }
+
+                /* the prover with a Lagrange-basis H_query */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_lagrange_proving_key() const {
+                    auto lagrange_keypair = basic_proof_system::generate_lagrange(example.constraint_system);
+                    typename basic_proof_system::proof_type lagrange_proof = prove<basic_proof_system>(
+                        lagrange_keypair.first, example.primary_input, example.auxiliary_input);
+                    BOOST_CHECK(ans == verify<basic_proof_system>(lagrange_keypair.second, example.primary_input,
+                                                                  lagrange_proof));
+                }
+
+                /* the prover with a sparse A_query */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_sparse_proving_key() const {
+                    const typename basic_proof_system::sparse_proving_key_type sparse_pk(keypair.first);
+                    BOOST_CHECK(sparse_pk.to_proving_key() == keypair.first);
+
+                    typename basic_proof_system::proof_type sparse_proof =
+                        prove<basic_proof_system>(sparse_pk, example.primary_input, example.auxiliary_input);
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, sparse_proof));
+                }
+
+                /* the pipelined prover */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_pipelined_prover() const {
+                    {
+                        r1cs_gg_ppzksnark_pipelined_prover<CurveType> pipelined_prover(keypair.first, executor(2),
+                                                                                      executor(2));
+                        std::vector<std::future<typename basic_proof_system::proof_type>> pipelined_proofs;
+                        for (std::size_t i = 0; i < 3; ++i) {
+                            pipelined_proofs.emplace_back(
+                                pipelined_prover.submit(example.primary_input, example.auxiliary_input));
+                        }
+                        for (auto &pipelined_proof : pipelined_proofs) {
+                            BOOST_CHECK(ans ==
+                                        verify<basic_proof_system>(pvk, example.primary_input, pipelined_proof.get()));
+                        }
+                    }
+                }
+
+                /* the incremental prover */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_incremental_prover() const {
+                    typedef r1cs_gg_ppzksnark_incremental_prover<CurveType> incremental_prover_type;
+                    typename incremental_prover_type::state_type incremental_state;
+                    for (std::size_t i = 0; i < 2; ++i) {
+                        typename basic_proof_system::proof_type incremental_proof = incremental_prover_type::process(
+                            keypair.first, example.primary_input, example.auxiliary_input, incremental_state);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, incremental_proof));
+                    }
+                    {
+                        /* a state left by an assignment whose first auxiliary variable was one larger */
+                        const std::size_t changed = example.primary_input.size();
+                        typename incremental_prover_type::state_type stale_state = incremental_state;
+                        stale_state.full_variable_assignment[changed] =
+                            stale_state.full_variable_assignment[changed] +
+                            CurveType::scalar_field_type::value_type::one();
+                        stale_state.evaluation_At = stale_state.evaluation_At + keypair.first.A_query[changed + 1];
+                        stale_state.evaluation_Bt = stale_state.evaluation_Bt + keypair.first.B_query[changed + 1];
+                        stale_state.evaluation_Lt = stale_state.evaluation_Lt + keypair.first.L_query[0];
+
+                        typename basic_proof_system::proof_type updated_proof = incremental_prover_type::process(
+                            keypair.first, example.primary_input, example.auxiliary_input, stale_state);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, updated_proof));
+                        BOOST_CHECK(stale_state.evaluation_At == incremental_state.evaluation_At);
+                        BOOST_CHECK(stale_state.evaluation_Bt == incremental_state.evaluation_Bt);
+                        BOOST_CHECK(stale_state.evaluation_Lt == incremental_state.evaluation_Lt);
+                    }
+                    {
+                        /* a state of another key of the same circuit starts over under the new key */
+                        const typename basic_proof_system::keypair_type other_keypair =
+                            generate<basic_proof_system>(example.constraint_system);
+                        const typename basic_proof_system::processed_verification_key_type other_pvk =
+                            r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(other_keypair.second);
+                        typename incremental_prover_type::state_type other_state = incremental_state;
+                        BOOST_CHECK(other_state.belongs_to(keypair.first));
+                        BOOST_CHECK(!other_state.belongs_to(other_keypair.first));
+                        typename basic_proof_system::proof_type other_proof = incremental_prover_type::process(
+                            other_keypair.first, example.primary_input, example.auxiliary_input, other_state);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(other_pvk, example.primary_input, other_proof));
+                        BOOST_CHECK(other_state.belongs_to(other_keypair.first));
+
+                        /* a proof which throws leaves the state at its last proof */
+                        typename incremental_prover_type::state_type failed_state = incremental_state;
+                        const typename basic_proof_system::auxiliary_input_type short_auxiliary_input(
+                            example.auxiliary_input.begin(), example.auxiliary_input.end() - 1);
+                        BOOST_CHECK_THROW(incremental_prover_type::process(keypair.first, example.primary_input,
+                                                                           short_auxiliary_input, failed_state),
+                                          std::invalid_argument);
+                        BOOST_CHECK(failed_state.belongs_to(keypair.first));
+                        BOOST_CHECK(failed_state.full_variable_assignment ==
+                                    incremental_state.full_variable_assignment);
+                        BOOST_CHECK(failed_state.evaluation_At == incremental_state.evaluation_At);
+                        BOOST_CHECK(failed_state.evaluation_Lt == incremental_state.evaluation_Lt);
+                    }
+                }
+
+                /* the asynchronous prover */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_async_prover() const {
+                    {
+                        job_options options;
+                        options.progress = [](const std::string &, std::size_t completed, std::size_t total) {
+                            BOOST_CHECK(completed <= total);
+                        };
+                        std::future<typename basic_proof_system::proof_type> async_proof =
+                            prove_async<basic_proof_system>(keypair.first, example.primary_input,
+                                                            example.auxiliary_input, options);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, async_proof.get()));
+
+                        job_options cancelled_options;
+                        cancelled_options.token.cancel();
+                        std::future<typename basic_proof_system::proof_type> cancelled_proof =
+                            prove_async<basic_proof_system>(keypair.first, example.primary_input,
+                                                            example.auxiliary_input, cancelled_options);
+                        BOOST_CHECK_THROW(cancelled_proof.get(), operation_cancelled);
+                    }
+                }
+
+                /* the prover within a memory budget */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_memory_budget() const {
+                    {
+                        const memory_budget budget(1);
+                        memory_budget::scope budget_guard(budget);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(
+                                               pvk, example.primary_input,
+                                               prove<basic_proof_system>(keypair.first, example.primary_input,
+                                                                         example.auxiliary_input)));
+                    }
+                }
+
+                /* the prover with a delta-updated key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_delta_update() const {
+                    {
+                        typedef typename CurveType::scalar_field_type scalar_field_type;
+                        const typename scalar_field_type::value_type ratio =
+                            algebra::random_element<scalar_field_type>();
+
+                        const std::string mapped_pk_path = "r1cs_gg_ppzksnark_proving_key.bin";
+                        r1cs_gg_ppzksnark_mapped_proving_key<CurveType>::write(mapped_pk_path, keypair.first);
+                        r1cs_gg_ppzksnark_delta_update<CurveType>::update_file(mapped_pk_path, ratio);
+
+                        typename basic_proof_system::keypair_type updated_keypair = keypair;
+                        r1cs_gg_ppzksnark_delta_update<CurveType>::update(updated_keypair, ratio);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(
+                                               updated_keypair.second, example.primary_input,
+                                               prove<basic_proof_system>(updated_keypair.first, example.primary_input,
+                                                                         example.auxiliary_input)));
+                        {
+                            r1cs_gg_ppzksnark_mapped_proving_key<CurveType> mapped_pk(
+                                mapped_pk_path, typename basic_proof_system::constraint_system_type(
+                                                    keypair.first.constraint_system));
+                            BOOST_CHECK(mapped_pk.delta_g1() == updated_keypair.first.delta_g1);
+                            BOOST_CHECK(std::equal(mapped_pk.H_query_begin(), mapped_pk.H_query_end(),
+                                                   updated_keypair.first.H_query.begin()));
+                            BOOST_CHECK(ans == verify<basic_proof_system>(
+                                                   updated_keypair.second, example.primary_input,
+                                                   prove<basic_proof_system>(mapped_pk, example.primary_input,
+                                                                             example.auxiliary_input)));
+                        }
+                        std::remove(mapped_pk_path.c_str());
+                    }
+                }
+
+                /* the prover from a serialized QAP witness */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_qap_witness_prover() const {
+                    typedef typename CurveType::scalar_field_type scalar_field_type;
+                    const std::vector<unsigned char> witness_buffer = qap_witness_buffer<scalar_field_type>::serialize(
+                        reductions::r1cs_to_qap<scalar_field_type>::witness_map(
+                            example.constraint_system, example.primary_input, example.auxiliary_input,
+                            scalar_field_type::value_type::zero(), scalar_field_type::value_type::zero(),
+                            scalar_field_type::value_type::zero()));
+                    typename basic_proof_system::proof_type witness_proof =
+                        r1cs_gg_ppzksnark_prover<CurveType>::process_witness(
+                            keypair.first, qap_witness_buffer<scalar_field_type>::view(witness_buffer));
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, witness_proof));
+                    {
+                        /* a witness with the zero-knowledge patch, or of another circuit, is rejected */
+                        const qap_witness<scalar_field_type> patched_witness =
+                            reductions::r1cs_to_qap<scalar_field_type>::witness_map(
+                                example.constraint_system, example.primary_input, example.auxiliary_input,
+                                scalar_field_type::value_type::one(), scalar_field_type::value_type::zero(),
+                                scalar_field_type::value_type::zero());
+                        BOOST_CHECK_THROW(r1cs_gg_ppzksnark_prover<CurveType>::process_witness(
+                                              keypair.first, qap_witness_view<scalar_field_type>(patched_witness)),
+                                          std::invalid_argument);
+                        qap_witness_view<scalar_field_type> short_witness =
+                            qap_witness_buffer<scalar_field_type>::view(witness_buffer);
+                        --short_witness.num_variables;
+                        BOOST_CHECK_THROW(
+                            r1cs_gg_ppzksnark_prover<CurveType>::process_witness(keypair.first, short_witness),
+                            std::invalid_argument);
+                    }
+                }
+
+                /* the verifier through a verification key registry */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_verification_key_registry() const {
+                    r1cs_gg_ppzksnark_verification_key_registry<CurveType> registry(1);
+                    const typename r1cs_gg_ppzksnark_verification_key_registry<CurveType>::digest_type digest =
+                        registry.insert(keypair.second);
+                    BOOST_CHECK(registry.insert(keypair.second) == digest);
+                    // the digest is over the values of the points, whatever their projective coordinates
+                    typename basic_proof_system::verification_key_type projective_vk = keypair.second;
+                    projective_vk.gamma_g2 = projective_vk.gamma_g2.doubled() - projective_vk.gamma_g2;
+                    projective_vk.gamma_ABC_g1.first =
+                        projective_vk.gamma_ABC_g1.first.doubled() - projective_vk.gamma_ABC_g1.first;
+                    BOOST_CHECK(r1cs_gg_ppzksnark_verification_key_registry<CurveType>::digest(projective_vk) ==
+                                digest);
+                    BOOST_CHECK(registry.size() == 1);
+                    BOOST_CHECK(*registry.find(digest) == pvk);
+                    BOOST_CHECK(ans == verify<basic_proof_system>(registry, digest, example.primary_input, proof));
+                    BOOST_CHECK(!verify<basic_proof_system>(registry, digest, example.primary_input, tampered_proof()));
+
+                    typename basic_proof_system::verification_key_type other_vk = keypair.second;
+                    other_vk.delta_g2 = other_vk.delta_g2 + other_vk.gamma_g2;
+                    const typename r1cs_gg_ppzksnark_verification_key_registry<CurveType>::digest_type other_digest =
+                        registry.insert(other_vk);
+                    BOOST_CHECK(other_digest != digest);
+                    // the registry holds a single key: the first one was evicted
+                    BOOST_CHECK(registry.size() == 1);
+                    BOOST_CHECK(!registry.find(digest));
+                    BOOST_CHECK(!verify<basic_proof_system>(registry, other_digest, example.primary_input, proof));
+                }
+
+                /* the deferred-settlement verifier */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_deferred_verifier() const {
+                    const std::vector<typename basic_proof_system::proof_type> batch_proofs = proofs_of_batch(2);
+
+                    r1cs_gg_ppzksnark_deferred_verifier<CurveType> deferred;
+                    for (const typename basic_proof_system::proof_type &batch_proof : batch_proofs) {
+                        deferred.add(pvk, example.primary_input, batch_proof);
+                    }
+                    BOOST_CHECK(ans == deferred.settle());
+                    deferred.add(pvk, example.primary_input, proof);
+                    deferred.add(pvk, example.primary_input, tampered_proof());
+                    deferred.add(pvk, typename basic_proof_system::primary_input_type(), proof);
+                    deferred.add(pvk, example.primary_input, proof);
+                    BOOST_CHECK(!deferred.settle());
+                    BOOST_CHECK(deferred.failed() == std::vector<std::size_t>({1, 2}));
+                }
+
+                /* the validation of the points of a batch of proofs */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_proof_validation() const {
+                    const std::vector<typename basic_proof_system::proof_type> batch_proofs = proofs_of_batch(2);
+
+                    BOOST_CHECK(validate_proofs<CurveType>(batch_proofs.begin(), batch_proofs.end()).empty());
+                    std::vector<typename basic_proof_system::proof_type> malformed_proofs = batch_proofs;
+                    // moves g_B off the curve
+                    malformed_proofs[1].g_B.X = malformed_proofs[1].g_B.X + malformed_proofs[1].g_B.Z;
+                    BOOST_CHECK(validate_proofs<CurveType>(malformed_proofs.begin(), malformed_proofs.end()) ==
+                                std::vector<std::size_t>({1}));
+                }
+
+                /* the prover and verifier on inputs read in place */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_span_inputs() const {
+                    const typename basic_proof_system::primary_input_span_type primary_input_span(
+                        input_buffer.data(), example.primary_input.size());
+                    const typename basic_proof_system::auxiliary_input_span_type auxiliary_input_span(
+                        input_buffer.data() + example.primary_input.size(), example.auxiliary_input.size());
+
+                    BOOST_CHECK(example.constraint_system.is_satisfied(primary_input_span, auxiliary_input_span));
+                    const typename basic_proof_system::proof_type span_proof =
+                        prove<basic_proof_system>(keypair.first, primary_input_span, auxiliary_input_span);
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, primary_input_span, span_proof));
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, span_proof));
+                }
+
+                /* the prover on a witness streamed through a mapped file */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_streamed_witness() const {
+                    {
+                        typedef typename CurveType::scalar_field_type scalar_field_type;
+                        const std::string witness_path = temporary_path("r1cs_gg_ppzksnark_witness.bin");
+                        typename r1cs_mapped_witness<scalar_field_type>::writer witness_writer(
+                            witness_path, example.primary_input.size(), input_buffer.size());
+                        const r1cs_mapped_witness<scalar_field_type> mapped_witness(witness_path);
+                        BOOST_CHECK(mapped_witness.available() == 0);
+
+                        /* the witness generator commits the assignment in two parts while the prover runs */
+                        std::thread generator([&]() {
+                            const std::size_t half = input_buffer.size() / 2;
+                            witness_writer.write(0, input_buffer.data(), half);
+                            witness_writer.commit(half);
+                            witness_writer.write(half, input_buffer.data() + half, input_buffer.size() - half);
+                            witness_writer.commit(input_buffer.size());
+                        });
+                        const typename basic_proof_system::proof_type streamed_proof =
+                            basic_proof_system::prove_streamed(keypair.first, mapped_witness);
+                        generator.join();
+
+                        BOOST_CHECK(mapped_witness.complete());
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, mapped_witness.primary_input(),
+                                                                      streamed_proof));
+                        const qap_witness<scalar_field_type> mapped_qap_wit =
+                            reductions::r1cs_to_qap<scalar_field_type>::witness_map(
+                                example.constraint_system, mapped_witness, scalar_field_type::value_type::zero(),
+                                scalar_field_type::value_type::zero(), scalar_field_type::value_type::zero(),
+                                reductions::r1cs_to_qap<scalar_field_type>::make_context(example.constraint_system));
+                        BOOST_CHECK(mapped_qap_wit.coefficients_for_ABCs == input_buffer);
+
+                        /* a witness file shorter than its header announces is rejected when mapped */
+                        std::string contents;
+                        {
+                            std::ifstream in(witness_path, std::ios::binary);
+                            contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                        }
+                        const std::string truncated_path = temporary_path("r1cs_gg_ppzksnark_truncated_witness.bin");
+                        for (const std::size_t size : {contents.size() - 64, std::size_t(32)}) {
+                            std::ofstream(truncated_path, std::ios::binary | std::ios::trunc)
+                                .write(contents.data(), size);
+                            BOOST_CHECK_THROW(r1cs_mapped_witness<scalar_field_type> truncated(truncated_path),
+                                              std::runtime_error);
+                        }
+                        std::remove(truncated_path.c_str());
+                        std::remove(witness_path.c_str());
+                    }
+                }
+
+                /* the prover with a warmed-up processed proving key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_warm_up() const {
+                    const typename basic_proof_system::processed_proving_key_type ppk =
+                        r1cs_gg_ppzksnark_process_proving_key<CurveType>::process(keypair.first);
+
+                    {
+                        typename basic_proof_system::processed_proving_key_type warm_ppk = ppk;
+                        warm_ppk.context.reset();
+                        const memory_residency residency = r1cs_gg_ppzksnark_warm_up<CurveType>::process(warm_ppk);
+                        BOOST_CHECK(warm_ppk.context);
+                        BOOST_CHECK(residency.locked);
+                        BOOST_CHECK(residency.bytes >= keypair.first.H_query.size() *
+                                                           sizeof(typename CurveType::g1_type::value_type));
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input,
+                                                                      prove<basic_proof_system>(
+                                                                          warm_ppk, example.primary_input,
+                                                                          example.auxiliary_input)));
+                    }
+                }
+
+                /* the prover with keys from a proving key cache */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_proving_key_cache() const {
+                    const std::string cached_pk_path = "r1cs_gg_ppzksnark_cached_proving_key.bin";
+                    r1cs_gg_ppzksnark_mapped_proving_key<CurveType>::write(cached_pk_path, keypair.first);
+                    {
+                        /* room for a single key */
+                        r1cs_gg_ppzksnark_proving_key_cache<CurveType> cache(1);
+                        cache.insert("first", cached_pk_path, keypair.first.constraint_system);
+                        cache.insert("second", cached_pk_path, keypair.first.constraint_system);
+
+                        auto first_key = cache.acquire("first");
+                        BOOST_CHECK(cache.acquire("first") == first_key);
+                        BOOST_CHECK(ans == verify<basic_proof_system>(
+                                               keypair.second, example.primary_input,
+                                               prove<basic_proof_system>(*first_key, example.primary_input,
+                                                                         example.auxiliary_input)));
+
+                        /* the pinned first key stays loaded beyond the budget */
+                        auto second_key = cache.acquire("second");
+                        BOOST_CHECK(cache.size() == 2);
+                        BOOST_CHECK(!cache.evict("first"));
+
+                        /* once released, the least recently used key makes room for the other one */
+                        first_key.reset();
+                        second_key.reset();
+                        BOOST_CHECK(cache.evict("first"));
+                        BOOST_CHECK(cache.size() == 1);
+                        cache.acquire("first");
+                        BOOST_CHECK(cache.size() == 1);
+                        BOOST_CHECK(!cache.find("second"));
+                    }
+                    {
+                        /* room for two keys, evicted in least recently used order */
+                        std::size_t key_footprint = 0;
+                        {
+                            r1cs_gg_ppzksnark_proving_key_cache<CurveType> sizing_cache(0);
+                            sizing_cache.insert("key", cached_pk_path, keypair.first.constraint_system);
+                            sizing_cache.acquire("key");
+                            key_footprint = sizing_cache.footprint();
+                        }
+                        BOOST_CHECK(key_footprint > 0);
+
+                        r1cs_gg_ppzksnark_proving_key_cache<CurveType> cache(2 * key_footprint);
+                        for (const char *name : {"a", "b", "c"}) {
+                            cache.insert(name, cached_pk_path, keypair.first.constraint_system);
+                        }
+                        cache.acquire("a");
+                        cache.acquire("b");
+                        BOOST_CHECK(cache.find("a"));
+                        cache.acquire("c");
+                        BOOST_CHECK(cache.find("a") && !cache.find("b") && cache.find("c"));
+                        BOOST_CHECK(cache.footprint() == 2 * key_footprint);
+                        cache.acquire("b");
+                        BOOST_CHECK(!cache.find("a") && cache.find("b") && cache.find("c"));
+
+                        /* an erased key leaves the footprint, once released if it is pinned */
+                        cache.erase("b");
+                        BOOST_CHECK(cache.size() == 1 && cache.footprint() == key_footprint);
+                        auto c_key = cache.acquire("c");
+                        cache.erase("c");
+                        BOOST_CHECK(cache.size() == 0 && cache.footprint() == key_footprint);
+                        c_key.reset();
+                        BOOST_CHECK(cache.footprint() == 0);
+                        cache.acquire("a");
+                        BOOST_CHECK(cache.size() == 1 && cache.footprint() == key_footprint);
+                    }
+                    std::remove(cached_pk_path.c_str());
+                }
+
+                /* the generator resuming from a checkpoint */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_generator_checkpoint() const {
+                    const std::string mapped_key_path = temporary_path("r1cs_gg_ppzksnark_streamed_proving_key.bin");
+
+                    typedef r1cs_gg_ppzksnark_generator_checkpoint<CurveType> checkpoint_type;
+                    const std::string checkpoint_path = temporary_path("r1cs_gg_ppzksnark_generator_checkpoint.bin");
+                    const checkpoint_type checkpoint(checkpoint_path);
+                    const typename checkpoint_type::digest_type constraint_system_digest =
+                        checkpoint_type::digest(example.constraint_system);
+                    typename checkpoint_type::state_type state;
+                    const auto check_streamed_keypair = [&](const auto &streamed_keypair) {
+                        BOOST_CHECK(!checkpoint.load(constraint_system_digest, state));
+                        BOOST_CHECK(ans == verify<basic_proof_system>(
+                                               streamed_keypair.second, example.primary_input,
+                                               prove<basic_proof_system>(streamed_keypair.first,
+                                                                         example.primary_input,
+                                                                         example.auxiliary_input)));
+                    };
+                    {
+                        /* generations cancelled at every progress report in turn, then resumed */
+                        bool completed = false;
+                        std::size_t resumed = 0;
+                        for (std::size_t interruption = 1; !completed && interruption <= 256; ++interruption) {
+                            job_options options;
+                            const cancellation_token token = options.token;
+                            std::size_t reports = 0;
+                            options.progress = [&](const std::string &, std::size_t, std::size_t) {
+                                if (++reports == interruption) {
+                                    token.cancel();
+                                }
+                            };
+                            try {
+                                auto streamed_keypair = job_control::run(options, [&]() {
+                                    return generate<basic_proof_system>(example.constraint_system, mapped_key_path,
+                                                                        checkpoint_path);
+                                });
+                                completed = true;
+                                check_streamed_keypair(streamed_keypair);
+                                continue;
+                            } catch (const operation_cancelled &) {
+                            }
+
+                            const bool interrupted = checkpoint.load(constraint_system_digest, state);
+                            auto resumed_keypair =
+                                generate<basic_proof_system>(example.constraint_system, mapped_key_path,
+                                                             checkpoint_path);
+                            if (interrupted) {
+                                ++resumed;
+                                BOOST_CHECK(resumed_keypair.second.gamma_g2 == state.gamma * state.g2_generator);
+                            }
+                            check_streamed_keypair(resumed_keypair);
+                        }
+                        BOOST_CHECK(completed);
+                        BOOST_CHECK(resumed > 0);
+                    }
+                    for (const bool remove_key_file : {false, true}) {
+                        /* a checkpoint whose key file belongs to another generation, or is missing, starts over */
+                        state = checkpoint_type::make_state(constraint_system_digest);
+                        state.t = algebra::random_element<typename CurveType::scalar_field_type>();
+                        state.alpha = algebra::random_element<typename CurveType::scalar_field_type>();
+                        state.beta = algebra::random_element<typename CurveType::scalar_field_type>();
+                        state.gamma = algebra::random_element<typename CurveType::scalar_field_type>();
+                        state.delta = algebra::random_element<typename CurveType::scalar_field_type>();
+                        state.g1_generator = algebra::random_element<typename CurveType::g1_type>();
+                        state.g2_generator = algebra::random_element<typename CurveType::g2_type>();
+                        checkpoint.save(state);
+                        if (remove_key_file) {
+                            std::remove(mapped_key_path.c_str());
+                        }
+
+                        auto fresh_keypair =
+                            generate<basic_proof_system>(example.constraint_system, mapped_key_path, checkpoint_path);
+                        BOOST_CHECK(!(fresh_keypair.second.gamma_g2 == state.gamma * state.g2_generator));
+                        check_streamed_keypair(fresh_keypair);
+                    }
+                    std::remove(mapped_key_path.c_str());
+                }
+
+                /* the prover with batched affine multi-exponentiations */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_batch_affine_multiexp() const {
+                    {
+                        typedef typename CurveType::g1_type::value_type g1_value_type;
+                        typedef typename CurveType::scalar_field_type::value_type scalar_field_value_type;
+
+                        std::vector<scalar_field_value_type> H_scalars(keypair.first.H_query.size());
+                        for (scalar_field_value_type &scalar : H_scalars) {
+                            scalar = algebra::random_element<typename CurveType::scalar_field_type>();
+                        }
+                        BOOST_CHECK(batch_affine_multiexp(keypair.first.H_query.begin(), keypair.first.H_query.end(),
+                                                          H_scalars.begin(), H_scalars.end(), 2) ==
+                                    dispatch_multiexp<algebra::policies::multiexp_method_naive_plain>(
+                                        keypair.first.H_query.begin(), keypair.first.H_query.end(),
+                                        H_scalars.begin(), H_scalars.end(), 1));
+
+                        /* two chunks of batch_affine_min_terms affine bases each, which the default tuning
+                         * plans onto the batched affine additions, with random scalars and with a constant
+                         * one, whose terms all collide in the same buckets */
+                        const std::size_t n = 2 * multiexp_tuning<g1_value_type>::current().batch_affine_min_terms;
+                        BOOST_CHECK(multiexp_tuning<g1_value_type>::current().plan(n, n, 2).algorithm ==
+                                    multiexp_algorithm::batch_affine);
+
+                        const g1_value_type step =
+                            g1_value_type::one() * algebra::random_element<typename CurveType::scalar_field_type>();
+                        std::vector<g1_value_type> bases(n);
+                        g1_value_type base = step, bases_sum = g1_value_type::zero();
+                        for (std::size_t i = 0; i < n; ++i, base = base + step) {
+                            bases[i] = base.to_affine();
+                            bases_sum = bases_sum + base;
+                        }
+                        std::vector<scalar_field_value_type> scalars(n);
+                        for (scalar_field_value_type &scalar : scalars) {
+                            scalar = algebra::random_element<typename CurveType::scalar_field_type>();
+                        }
+                        const std::vector<scalar_field_value_type> constant_scalars(n, scalars.front());
+
+                        BOOST_CHECK(dispatch_multiexp<multiexp_method_auto>(bases.begin(), bases.end(),
+                                                                            scalars.begin(), scalars.end(), 2) ==
+                                    dispatch_multiexp<algebra::policies::multiexp_method_BDLO12>(
+                                        bases.begin(), bases.end(), scalars.begin(), scalars.end(), 2));
+                        BOOST_CHECK(dispatch_multiexp<multiexp_method_auto>(bases.begin(), bases.end(),
+                                                                            constant_scalars.begin(),
+                                                                            constant_scalars.end(),
+                                                                            2) == bases_sum * scalars.front());
+
+                        const multiexp_tuning<g1_value_type> tuning = multiexp_tuning<g1_value_type>::current();
+                        multiexp_tuning<g1_value_type>::current().bos_coster_max_terms = 1;
+                        multiexp_tuning<g1_value_type>::current().batch_affine_min_terms = 1;
+                        BOOST_CHECK(ans == verify<basic_proof_system>(
+                                               pvk, example.primary_input,
+                                               prove<basic_proof_system>(keypair.first, example.primary_input,
+                                                                         example.auxiliary_input)));
+                        multiexp_tuning<g1_value_type>::current() = tuning;
+                    }
+                }
+
+                /* the prover with multi-exponentiations split between two backends */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_split_multiexp_backend() const {
+                    {
+                        typedef r1cs_gg_ppzksnark_cpu_multiexp_backend<CurveType> cpu_backend_type;
+                        typedef r1cs_gg_ppzksnark_split_multiexp_backend<CurveType, cpu_backend_type>
+                            split_backend_type;
+
+                        const r1cs_gg_ppzksnark_resident_proving_key<CurveType, split_backend_type> split_key(
+                            keypair.first);
+                        split_key.queries.balance->set_shares({0.5, 0.5, 0.5, 0.5});
+                        for (std::size_t i = 0; i < 2; ++i) {
+                            BOOST_CHECK(ans == verify<basic_proof_system>(
+                                                   pvk, example.primary_input,
+                                                   basic_proof_system::prove(split_key, example.primary_input,
+                                                                             example.auxiliary_input)));
+                        }
+                        const multiexp_split_shares shares = split_key.queries.balance->shares();
+                        BOOST_CHECK(shares.A >= multiexp_split_balance::min_share &&
+                                    shares.A <= 1 - multiexp_split_balance::min_share);
+
+                        const std::vector<typename CurveType::scalar_field_type::value_type> H_scalars(
+                            keypair.first.H_query.size(),
+                            algebra::random_element<typename CurveType::scalar_field_type>());
+                        BOOST_CHECK(split_backend_type::multiexp_H(split_key.queries, split_key.proving_key,
+                                                                   H_scalars.begin(), H_scalars.end()) ==
+                                    cpu_backend_type::multiexp_H(cpu_backend_type::upload(keypair.first),
+                                                                 keypair.first, H_scalars.begin(), H_scalars.end()));
+                    }
+                }
+
+                /* the circuit analytics of the constraint system and of its proving key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_circuit_analytics() const {
+                    {
+                        typedef r1cs_gg_ppzksnark_circuit_analytics<CurveType> analytics_type;
+
+                        const analytics_type projected = analytics_type::of(example.constraint_system);
+                        const analytics_type generated = analytics_type::of(keypair.first);
+                        BOOST_CHECK(projected.A_query.non_zero == generated.A_query.non_zero);
+                        BOOST_CHECK(projected.B_query.non_zero == generated.B_query.non_zero);
+                        BOOST_CHECK(projected.H_query.size == generated.H_query.size);
+                        BOOST_CHECK(projected.L_query.size == generated.L_query.size);
+                        BOOST_CHECK(projected.domain_size == generated.domain_size);
+                        BOOST_CHECK(projected.g1_additions() == generated.g1_additions());
+                        BOOST_CHECK(projected.proving_key_bytes == generated.proving_key_bytes);
+
+                        /* the swap flags are those of the constraint system and of the layout the key stores */
+                        BOOST_CHECK(projected.AB_swap_beneficial ==
+                                    example.constraint_system.is_AB_swap_beneficial());
+                        BOOST_CHECK(generated.AB_swap_beneficial ==
+                                    keypair.first.constraint_system.is_AB_swap_beneficial());
+                        r1cs_constraint_system<typename CurveType::scalar_field_type> swapped =
+                            example.constraint_system;
+                        swapped.swap_AB();
+                        BOOST_CHECK(analytics_type::of(swapped).AB_swap_beneficial == swapped.is_AB_swap_beneficial());
+
+                        const r1cs_scalar_size_histogram sizes = r1cs_scalar_size_histogram::of(
+                            example.auxiliary_input.begin(), example.auxiliary_input.end());
+                        BOOST_CHECK(sizes.size() == example.auxiliary_input.size());
+                    }
+                }
+
+                /* the prover with a bytecode proving key */
+                template<typename CurveType>
+                void r1cs_gg_ppzksnark_run<CurveType>::test_bytecode_proving_key() const {
+                    const typename basic_proof_system::bytecode_proving_key_type bpk(
+                        typename basic_proof_system::proving_key_type(keypair.first));
+                    BOOST_CHECK(bpk.constraint_system ==
+                                r1cs_bytecode<typename CurveType::scalar_field_type>(keypair.first.constraint_system));
+
+                    typename basic_proof_system::proof_type bytecode_proof =
+                        prove<basic_proof_system>(bpk, example.primary_input, example.auxiliary_input);
+
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, bytecode_proof));
+                }
             }    // namespace snark
         }        // namespace zk
     }            // namespace crypto3
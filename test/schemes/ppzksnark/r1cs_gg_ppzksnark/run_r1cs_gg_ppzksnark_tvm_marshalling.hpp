@@ -29,17 +29,25 @@
 #ifndef CRYPTO3_RUN_R1CS_GG_PPZKSNARK_TVM_MARSHALLING_HPP
 #define CRYPTO3_RUN_R1CS_GG_PPZKSNARK_TVM_MARSHALLING_HPP
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
 #include <tuple>
 
+#include <unistd.h>
+
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark.hpp>
 #include <nil/crypto3/zk/snark/algorithms/generate.hpp>
 #include <nil/crypto3/zk/snark/algorithms/verify.hpp>
 #include <nil/crypto3/zk/snark/algorithms/prove.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/marshalling.hpp>
+#include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_gg_ppzksnark/keypair_file.hpp>
 
 #include <nil/marshalling/status_type.hpp>
 #include "../r1cs_examples.hpp"
+#include "../../../temporary_path.hpp"
 
 namespace nil {
     namespace crypto3 {
@@ -163,6 +171,16 @@ namespace nil {
                     print_proving_key(other);
 
                     BOOST_CHECK(keypair.first == other);
+                    BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+
+                    typename scheme_type::proving_key_type trusted_other =
+                        nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::proving_key_process(
+                            proving_key_byteblob.cbegin(),
+                            proving_key_byteblob.cend(),
+                            provingProcessingStatus,
+                            nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::point_validation::trusted);
+                    BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+                    BOOST_CHECK(keypair.first == trusted_other);
                     BOOST_CHECK(keypair.first.alpha_g1 == other.alpha_g1 && keypair.first.beta_g1 == other.beta_g1);
                     BOOST_CHECK(keypair.first.beta_g2 == other.beta_g2 && keypair.first.delta_g1 == other.delta_g1);
                     BOOST_CHECK(keypair.first.delta_g2 == other.delta_g2 && keypair.first.A_query == other.A_query);
@@ -180,6 +198,149 @@ namespace nil {
                         BOOST_CHECK(keypair.first.constraint_system.constraints[i] == other.constraint_system.constraints[i]);
                     }
 
+                    std::vector<std::uint8_t> compact_proving_key_byteblob =
+                        nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(
+                            keypair.first, nil::marshalling::constraint_system_format::compact);
+                    typename scheme_type::proving_key_type compact_other =
+                        nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::proving_key_process(
+                            compact_proving_key_byteblob.cbegin(),
+                            compact_proving_key_byteblob.cend(),
+                            provingProcessingStatus,
+                            nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::point_validation::trusted,
+                            nil::marshalling::constraint_system_format::compact);
+                    BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+                    BOOST_CHECK(keypair.first == compact_other);
+
+                    std::vector<std::uint8_t> constraint_system_byteblob =
+                        nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(
+                            keypair.first.constraint_system);
+                    std::vector<std::uint8_t> compact_constraint_system_byteblob =
+                        nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(
+                            keypair.first.constraint_system, nil::marshalling::constraint_system_format::compact);
+                    BOOST_CHECK(compact_constraint_system_byteblob.size() < constraint_system_byteblob.size());
+                    BOOST_CHECK(keypair.first.constraint_system ==
+                                nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::
+                                    r1cs_constraint_system_process(constraint_system_byteblob.cbegin(),
+                                                                   constraint_system_byteblob.cend(),
+                                                                   provingProcessingStatus));
+                    BOOST_CHECK(keypair.first.constraint_system ==
+                                nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::
+                                    r1cs_constraint_system_process(compact_constraint_system_byteblob.cbegin(),
+                                                                   compact_constraint_system_byteblob.cend(),
+                                                                   provingProcessingStatus,
+                                                                   nil::marshalling::constraint_system_format::compact));
+                    BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+
+                    compact_constraint_system_byteblob.pop_back();
+                    nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::r1cs_constraint_system_process(
+                        compact_constraint_system_byteblob.cbegin(), compact_constraint_system_byteblob.cend(),
+                        provingProcessingStatus, nil::marshalling::constraint_system_format::compact);
+                    BOOST_CHECK(provingProcessingStatus != marshalling::status_type::success);
+
+                    typedef nil::marshalling::verifier_input_deserializer_tvm<scheme_type> deserializer_type;
+                    const std::size_t A_query_size_position =
+                        3 * deserializer_type::g1_byteblob_size + 2 * deserializer_type::g2_byteblob_size;
+                    const std::size_t B_query_size_position =
+                        A_query_size_position + deserializer_type::std_size_t_byteblob_size +
+                        keypair.first.A_query.size() * deserializer_type::g1_byteblob_size;
+                    for (const std::size_t position : {A_query_size_position, B_query_size_position}) {
+                        std::vector<std::uint8_t> corrupted_byteblob = proving_key_byteblob;
+                        std::fill(corrupted_byteblob.begin() + position,
+                                  corrupted_byteblob.begin() + position + deserializer_type::std_size_t_byteblob_size,
+                                  0xff);
+                        deserializer_type::proving_key_process(corrupted_byteblob.cbegin(), corrupted_byteblob.cend(),
+                                                               provingProcessingStatus);
+                        BOOST_CHECK(provingProcessingStatus == marshalling::status_type::not_enough_data);
+                    }
+                    for (const std::size_t size : {std::size_t(0), A_query_size_position + 1, B_query_size_position,
+                                                   proving_key_byteblob.size() / 2, proving_key_byteblob.size() - 1}) {
+                        const std::vector<std::uint8_t> truncated_byteblob(proving_key_byteblob.begin(),
+                                                                           proving_key_byteblob.begin() + size);
+                        deserializer_type::proving_key_process(truncated_byteblob.cbegin(), truncated_byteblob.cend(),
+                                                               provingProcessingStatus);
+                        BOOST_CHECK(provingProcessingStatus != marshalling::status_type::success);
+                    }
+
+                    const std::string keypair_file_path = temporary_path("r1cs_gg_ppzksnark_keypair.bin");
+                    r1cs_gg_ppzksnark_keypair_file<scheme_type>::write(keypair_file_path, keypair,
+                                                                       nil::marshalling::constraint_system_format::compact);
+                    {
+                        const r1cs_gg_ppzksnark_keypair_file<scheme_type> keypair_file(keypair_file_path);
+                        BOOST_CHECK(keypair_file.verification_key(provingProcessingStatus) == keypair.second);
+                        BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+                        BOOST_CHECK(keypair_file.A_query(provingProcessingStatus) == keypair.first.A_query);
+                        BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+                        BOOST_CHECK(keypair_file.proving_key(provingProcessingStatus) == keypair.first);
+                        BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+                        BOOST_CHECK(keypair_file.sections().section("proving_key.H_query").offset % 64 == 0);
+
+                        // expanded by chunks into the mapped layout on first use, mapped as is afterwards
+                        const std::string mapped_pk_path =
+                            temporary_path("r1cs_gg_ppzksnark_expanded_proving_key.bin");
+                        const auto check_expansion = [&]() {
+                            const auto mapped_pk = keypair_file.expanded_proving_key(
+                                mapped_pk_path, provingProcessingStatus,
+                                nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::point_validation::trusted,
+                                3);
+                            BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+                            BOOST_CHECK(mapped_pk.source_digest() == keypair_file.source_digest());
+                            BOOST_CHECK_EQUAL(mapped_pk.num_constraints(),
+                                              keypair.first.constraint_system.num_constraints());
+                            BOOST_CHECK(mapped_pk.delta_g1() == keypair.first.delta_g1);
+                            BOOST_CHECK(mapped_pk.beta_g2() == keypair.first.beta_g2);
+                            BOOST_CHECK(std::size_t(mapped_pk.A_query_end() - mapped_pk.A_query_begin()) ==
+                                        keypair.first.A_query.size());
+                            BOOST_CHECK(std::equal(mapped_pk.A_query_begin(), mapped_pk.A_query_end(),
+                                                   keypair.first.A_query.begin()));
+                            const auto &B_query = keypair.first.B_query;
+                            BOOST_CHECK(std::size_t(mapped_pk.B_query_indices_end() -
+                                                    mapped_pk.B_query_indices_begin()) == B_query.size());
+                            BOOST_CHECK(std::equal(mapped_pk.B_query_indices_begin(), mapped_pk.B_query_indices_end(),
+                                                   B_query.indices.begin()));
+                            for (std::size_t i = 0; i < B_query.size(); ++i) {
+                                BOOST_CHECK(mapped_pk.B_query_g_begin()[i] == B_query.values[i].g);
+                                BOOST_CHECK(mapped_pk.B_query_h_begin()[i] == B_query.values[i].h);
+                            }
+                            BOOST_CHECK_EQUAL(mapped_pk.B_query_domain_size(), B_query.domain_size());
+                            BOOST_CHECK(std::size_t(mapped_pk.H_query_end() - mapped_pk.H_query_begin()) ==
+                                        keypair.first.H_query.size());
+                            BOOST_CHECK(std::equal(mapped_pk.H_query_begin(), mapped_pk.H_query_end(),
+                                                   keypair.first.H_query.begin()));
+                            BOOST_CHECK(std::size_t(mapped_pk.L_query_end() - mapped_pk.L_query_begin()) ==
+                                        keypair.first.L_query.size());
+                            BOOST_CHECK(std::equal(mapped_pk.L_query_begin(), mapped_pk.L_query_end(),
+                                                   keypair.first.L_query.begin()));
+                        };
+                        // expanded by chunks into the mapped layout on first use, mapped as is afterwards
+                        check_expansion();
+                        check_expansion();
+
+                        // an expansion of another keypair of the same circuit is stale and expanded again
+                        const std::string other_keypair_file_path = temporary_path("r1cs_gg_ppzksnark_keypair.bin");
+                        r1cs_gg_ppzksnark_keypair_file<scheme_type>::write(
+                            other_keypair_file_path, generate<scheme_type>(example.constraint_system));
+                        {
+                            const r1cs_gg_ppzksnark_keypair_file<scheme_type> other_keypair_file(
+                                other_keypair_file_path);
+                            BOOST_CHECK(other_keypair_file.source_digest() != keypair_file.source_digest());
+                            other_keypair_file.expand_proving_key(mapped_pk_path, provingProcessingStatus);
+                            BOOST_CHECK(provingProcessingStatus == marshalling::status_type::success);
+                        }
+                        std::remove(other_keypair_file_path.c_str());
+                        check_expansion();
+
+                        // so is a truncated expansion
+                        {
+                            std::ifstream in(mapped_pk_path, std::ios::binary | std::ios::ate);
+                            const std::streamoff size = in.tellg();
+                            in.close();
+                            BOOST_CHECK(::truncate(mapped_pk_path.c_str(), size / 2) == 0);
+                        }
+                        check_expansion();
+                        std::remove(mapped_pk_path.c_str());
+                    }
+                    std::remove(keypair_file_path.c_str());
+
                     std::vector<std::uint8_t> verification_key_byteblob = nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(
                         keypair.second);
                     std::vector<std::uint8_t> primary_input_byteblob = nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(
@@ -187,6 +348,58 @@ namespace nil {
                     std::vector<std::uint8_t> proof_byteblob = nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(
                         proof);
 
+                    const packed_field_vector<typename CurveType::scalar_field_type> packed_primary_input(
+                        example.primary_input);
+                    BOOST_CHECK(packed_primary_input.to_vector() == example.primary_input);
+                    BOOST_CHECK(nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(
+                                    packed_primary_input) == primary_input_byteblob);
+
+                    const typename nil::marshalling::verifier_input_serializer_tvm<scheme_type>::proof_byteblob_type
+                        fixed_size_proof_byteblob =
+                            nil::marshalling::verifier_input_serializer_tvm<scheme_type>::fixed_size_process(proof);
+                    BOOST_CHECK(proof_byteblob.size() == fixed_size_proof_byteblob.size());
+                    BOOST_CHECK(std::equal(proof_byteblob.begin(), proof_byteblob.end(),
+                                           fixed_size_proof_byteblob.begin()));
+
+                    // the proof is its three compressed points one after the other, 48 bytes a G1 point
+                    // and 96 a G2 point on BLS12-381
+                    std::vector<std::uint8_t> reference_proof_byteblob;
+                    const auto g_A_octets =
+                        nil::marshalling::curve_element_serializer<CurveType>::point_to_octets_compress(proof.g_A);
+                    const auto g_B_octets =
+                        nil::marshalling::curve_element_serializer<CurveType>::point_to_octets_compress(proof.g_B);
+                    const auto g_C_octets =
+                        nil::marshalling::curve_element_serializer<CurveType>::point_to_octets_compress(proof.g_C);
+                    BOOST_CHECK(g_A_octets.size() == 48 && g_B_octets.size() == 96 && g_C_octets.size() == 48);
+                    reference_proof_byteblob.insert(reference_proof_byteblob.end(), g_A_octets.begin(),
+                                                    g_A_octets.end());
+                    reference_proof_byteblob.insert(reference_proof_byteblob.end(), g_B_octets.begin(),
+                                                    g_B_octets.end());
+                    reference_proof_byteblob.insert(reference_proof_byteblob.end(), g_C_octets.begin(),
+                                                    g_C_octets.end());
+                    BOOST_CHECK(fixed_size_proof_byteblob.size() == 192);
+                    BOOST_CHECK(std::equal(reference_proof_byteblob.begin(), reference_proof_byteblob.end(),
+                                           fixed_size_proof_byteblob.begin(), fixed_size_proof_byteblob.end()));
+                    marshalling::status_type proofProcessingStatus = marshalling::status_type::success;
+                    BOOST_CHECK(nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::proof_process(
+                                    reference_proof_byteblob.cbegin(), reference_proof_byteblob.cend(),
+                                    proofProcessingStatus) == proof);
+                    BOOST_CHECK(proofProcessingStatus == marshalling::status_type::success);
+
+                    const std::vector<typename scheme_type::proof_type> batch_proofs(2, proof);
+                    const typename scheme_type::proof_batch_type proof_batch(batch_proofs.begin(), batch_proofs.end());
+                    std::vector<std::uint8_t> proof_batch_byteblob(2 * proof_byteblob.size());
+                    nil::marshalling::verifier_input_serializer_tvm<scheme_type>::proof_batch_process(
+                        proof_batch, proof_batch_byteblob.begin());
+                    BOOST_CHECK(std::equal(proof_byteblob.begin(), proof_byteblob.end(), proof_batch_byteblob.begin()));
+                    BOOST_CHECK(std::equal(proof_byteblob.begin(), proof_byteblob.end(),
+                                           proof_batch_byteblob.begin() + proof_byteblob.size()));
+                    marshalling::status_type proofBatchProcessingStatus = marshalling::status_type::success;
+                    BOOST_CHECK(nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::proof_batch_process(
+                                    proof_batch_byteblob.cbegin(), proof_batch_byteblob.cend(), 2,
+                                    proofBatchProcessingStatus) == proof_batch);
+                    BOOST_CHECK(proofBatchProcessingStatus == marshalling::status_type::success);
+
                     std::cout << "Verification key byteblob, size " << std::dec << verification_key_byteblob.size() << std::endl;
 
                     for (auto it = verification_key_byteblob.begin(); it != verification_key_byteblob.end(); ++it){
@@ -231,6 +444,121 @@ namespace nil {
 
                     std::cout << "Verifier with plain input finished, result: " << ans << std::endl;
 
+                    std::cout << "Starting distributed prover over serialized jobs" << std::endl;
+
+                    {
+                        typedef r1cs_gg_ppzksnark_distributed_prover<CurveType> distributed_prover_type;
+                        typedef nil::marshalling::verifier_input_serializer_tvm<scheme_type> serializer_type;
+                        typedef nil::marshalling::verifier_input_deserializer_tvm<scheme_type> deserializer_type;
+
+                        const std::size_t num_shards = 3;
+                        const auto shards = distributed_prover_type::plan(keypair.first, num_shards);
+                        const auto jobs = distributed_prover_type::jobs(keypair.first, shards, example.primary_input,
+                                                                        example.auxiliary_input);
+
+                        // every job crosses the wire to its worker and its partial evaluation back
+                        std::vector<typename distributed_prover_type::partial_evaluation_type> partials;
+                        for (std::size_t i = 0; i < num_shards; ++i) {
+                            marshalling::status_type status = marshalling::status_type::success;
+                            const std::vector<std::uint8_t> job_byteblob = serializer_type::process(jobs[i]);
+                            const typename distributed_prover_type::job_type job =
+                                deserializer_type::shard_job_process(job_byteblob.cbegin(), job_byteblob.cend(),
+                                                                     status);
+                            BOOST_CHECK(status == marshalling::status_type::success);
+                            BOOST_CHECK(job.shard == shards[i] && job.assignment == jobs[i].assignment);
+                            BOOST_CHECK(job.H == jobs[i].H && job.L == jobs[i].L);
+
+                            const std::vector<std::uint8_t> partial_byteblob = serializer_type::process(
+                                distributed_prover_type::evaluate(
+                                    distributed_prover_type::shard_proving_key(keypair.first, shards[i]), job));
+                            partials.emplace_back(deserializer_type::partial_evaluation_process(
+                                partial_byteblob.cbegin(), partial_byteblob.cend(), status));
+                            BOOST_CHECK(status == marshalling::status_type::success);
+
+                            // a truncated job or partial evaluation is reported, not decoded
+                            deserializer_type::shard_job_process(job_byteblob.cbegin(), job_byteblob.cend() - 1,
+                                                                 status);
+                            BOOST_CHECK(status != marshalling::status_type::success);
+                            deserializer_type::partial_evaluation_process(partial_byteblob.cbegin(),
+                                                                          partial_byteblob.cend() - 1, status);
+                            BOOST_CHECK(status != marshalling::status_type::success);
+                        }
+                        BOOST_CHECK(verify<scheme_type>(
+                            keypair.second, example.primary_input,
+                            distributed_prover_type::combine(keypair.first, num_shards, partials)));
+
+                        // shards, jobs and partial evaluations which do not fit are rejected
+                        BOOST_CHECK_THROW(distributed_prover_type::plan(keypair.first, 0), std::invalid_argument);
+                        auto out_of_range_shard = shards.back();
+                        ++out_of_range_shard.variables_last;
+                        BOOST_CHECK_THROW(distributed_prover_type::shard_proving_key(keypair.first, out_of_range_shard),
+                                          std::invalid_argument);
+                        BOOST_CHECK_THROW(distributed_prover_type::jobs(keypair.first, {out_of_range_shard},
+                                                                        example.primary_input,
+                                                                        example.auxiliary_input),
+                                          std::invalid_argument);
+                        auto short_job = jobs[0];
+                        short_job.H.pop_back();
+                        BOOST_CHECK_THROW(distributed_prover_type::evaluate(
+                                              distributed_prover_type::shard_proving_key(keypair.first, shards[0]),
+                                              short_job),
+                                          std::invalid_argument);
+                        BOOST_CHECK_THROW(distributed_prover_type::evaluate(
+                                              distributed_prover_type::shard_proving_key(keypair.first, shards[1]),
+                                              jobs[0]),
+                                          std::invalid_argument);
+                        auto repeated_partials = partials;
+                        repeated_partials.back() = repeated_partials.front();
+                        BOOST_CHECK_THROW(
+                            distributed_prover_type::combine(keypair.first, num_shards, repeated_partials),
+                            std::invalid_argument);
+                        repeated_partials.pop_back();
+                        BOOST_CHECK_THROW(
+                            distributed_prover_type::combine(keypair.first, num_shards, repeated_partials),
+                            std::invalid_argument);
+                    }
+
+                    typedef r1cs_gg_ppzksnark_verifier_weak_input_consistency<CurveType> weak_verifier_type;
+                    const typename weak_verifier_type::processed_verification_key_type processed_vk =
+                        r1cs_gg_ppzksnark_process_verification_key<CurveType>::process(keypair.second);
+                    for (const bool pairing_inputs : {false, true}) {
+                        const typename weak_verifier_type::prepared_verifier_input_type prepared =
+                            weak_verifier_type::prepare(keypair.second, example.primary_input, proof, pairing_inputs);
+                        BOOST_CHECK(weak_verifier_type::process(processed_vk, example.primary_input, prepared) == ans);
+
+                        const std::vector<std::uint8_t> prepared_byteblob =
+                            nil::marshalling::verifier_input_serializer_tvm<scheme_type>::process(prepared);
+                        marshalling::status_type preparedProcessingStatus = marshalling::status_type::success;
+                        const typename weak_verifier_type::prepared_verifier_input_type de_prepared =
+                            nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::
+                                prepared_verifier_input_process(prepared_byteblob.cbegin(), prepared_byteblob.cend(),
+                                                                preparedProcessingStatus);
+                        BOOST_CHECK(preparedProcessingStatus == marshalling::status_type::success);
+                        BOOST_CHECK(de_prepared == prepared);
+                        BOOST_CHECK(weak_verifier_type::process(processed_vk, example.primary_input, de_prepared) ==
+                                    ans);
+
+                        // the prepared input of another primary input
+                        typename weak_verifier_type::primary_input_type other_input = example.primary_input;
+                        other_input[0] += CurveType::scalar_field_type::value_type::one();
+                        BOOST_CHECK(!weak_verifier_type::process(processed_vk, other_input, prepared));
+                    }
+
+                    // a prepared input whose key element is forged to satisfy its own pairing check
+                    typedef typename CurveType::pairing pairing_policy;
+                    typename weak_verifier_type::prepared_verifier_input_type forged =
+                        weak_verifier_type::prepare(keypair.second, example.primary_input, proof);
+                    forged.proof.g_A = CurveType::g1_type::value_type::one();
+                    forged.proof.g_B = CurveType::g2_type::value_type::one();
+                    forged.alpha_g1_beta_g2 =
+                        pairing_policy::pair_reduced(forged.proof.g_A, forged.proof.g_B) *
+                        (pairing_policy::pair_reduced(forged.accumulated_input, forged.gamma_g2) *
+                         pairing_policy::pair_reduced(forged.proof.g_C, forged.delta_g2))
+                            .unitary_inversed();
+                    BOOST_CHECK(!weak_verifier_type::process(processed_vk, example.primary_input, forged));
+                    forged.alpha_g1_beta_g2 = keypair.second.alpha_g1_beta_g2;
+                    BOOST_CHECK(!weak_verifier_type::process(processed_vk, example.primary_input, forged));
+
                     marshalling::status_type processingStatus = marshalling::status_type::success;
                     
                     auto tup = nil::marshalling::verifier_input_deserializer_tvm<scheme_type>::verifier_input_process(byteblob.cbegin(), 
@@ -29,6 +29,9 @@
 #ifndef CRYPTO3_RUN_R1CS_SE_PPZKSNARK_HPP
 #define CRYPTO3_RUN_R1CS_SE_PPZKSNARK_HPP
 
+#include <utility>
+#include <vector>
+
 #include <boost/config.hpp>
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/r1cs_se_ppzksnark.hpp>
@@ -75,6 +78,45 @@ namespace nil {
 
                     BOOST_CHECK(ans == ans2);
 
+                    /* a primary input longer than the key is rejected, not asserted on */
+                    typename basic_proof_system::primary_input_type long_primary_input = example.primary_input;
+                    long_primary_input.resize(pvk.query.size());
+                    BOOST_CHECK(!r1cs_se_ppzksnark_verifier_weak_input_consistency<CurveType>::process(
+                        pvk, long_primary_input, proof));
+
+                    typename basic_proof_system::processed_proving_key_type ppk =
+                        r1cs_se_ppzksnark_process_proving_key<CurveType>::process(keypair.first);
+
+                    typename basic_proof_system::proof_type processed_proof =
+                        prove<basic_proof_system>(ppk, example.primary_input, example.auxiliary_input);
+
+                    BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, processed_proof));
+
+                    std::vector<std::pair<typename basic_proof_system::primary_input_type,
+                                          typename basic_proof_system::auxiliary_input_type>>
+                        witnesses(2, std::make_pair(example.primary_input, example.auxiliary_input));
+
+                    std::vector<typename basic_proof_system::proof_type> batch_proofs =
+                        prove_batch<basic_proof_system>(keypair.first, witnesses);
+                    std::vector<typename basic_proof_system::proof_type> processed_batch_proofs =
+                        prove_batch<basic_proof_system>(ppk, witnesses);
+
+                    BOOST_CHECK(batch_proofs.size() == witnesses.size());
+                    BOOST_CHECK(processed_batch_proofs.size() == witnesses.size());
+                    for (std::size_t i = 0; i < witnesses.size(); ++i) {
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input, batch_proofs[i]));
+                        BOOST_CHECK(ans == verify<basic_proof_system>(pvk, example.primary_input,
+                                                                      processed_batch_proofs[i]));
+                    }
+
+                    const std::vector<typename basic_proof_system::primary_input_type> primary_inputs(
+                        batch_proofs.size(), example.primary_input);
+                    BOOST_CHECK(ans == verify_batch<basic_proof_system>(pvk, primary_inputs, batch_proofs));
+                    BOOST_CHECK(ans == verify_batch<basic_proof_system>(keypair.second, primary_inputs, batch_proofs));
+
+                    batch_proofs.back().C = batch_proofs.back().C + CurveType::g1_type::value_type::one();
+                    BOOST_CHECK(!verify_batch<basic_proof_system>(pvk, primary_inputs, batch_proofs));
+
                     return ans;
                 }
             }    // namespace snark
@@ -28,6 +28,7 @@
 
 #include "tbcs_examples.hpp"
 
+#include <nil/crypto3/zk/snark/relations/circuit_satisfaction_problems/tbcs_evaluator.hpp>
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/tbcs_ppzksnark.hpp>
 
 #include <nil/crypto3/zk/snark/algorithms/generate.hpp>
@@ -58,9 +59,19 @@ namespace nil {
 
                     std::cout << "Call to run_tbcs_ppzksnark" << std::endl;
 
+                    std::cout << "TBCS bit-packed evaluator" << std::endl;
+                    const tbcs_circuit_evaluator evaluator(example.circuit);
+                    BOOST_CHECK(evaluator.get_all_wires(example.primary_input, example.auxiliary_input) ==
+                                example.circuit.get_all_wires(example.primary_input, example.auxiliary_input));
+
                     std::cout << "TBCS ppzkSNARK Generator" << std::endl;
                     typename basic_proof_system::keypair_type keypair = generate<basic_proof_system>(example.circuit);
 
+                    /* the evaluator compiled into the proving key survives copies of the key */
+                    const typename basic_proof_system::proving_key_type pk_copy = keypair.first;
+                    BOOST_CHECK(pk_copy.evaluator.get_all_wires(example.primary_input, example.auxiliary_input) ==
+                                evaluator.get_all_wires(example.primary_input, example.auxiliary_input));
+
                     std::cout << "Preprocess verification key" << std::endl;
                     typename basic_proof_system::processed_verification_key_type pvk =
                         tbcs_ppzksnark_process_verification_key<CurveType>::process(keypair.second);
@@ -30,11 +30,19 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdio>
+#include <vector>
 
 #include "tbcs_examples.hpp"
 #include "run_tbcs_ppzksnark.hpp"
+#include "../../../thread_executor.hpp"
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+#include <nil/crypto3/zk/snark/reductions/detail/compile_circuit.hpp>
+#include <nil/crypto3/zk/snark/reductions/tbcs_to_uscs.hpp>
 
 #include <nil/crypto3/algebra/curves/mnt4.hpp>
 #include <nil/crypto3/algebra/fields/mnt4/base_field.hpp>
@@ -44,6 +52,7 @@
 #include <nil/crypto3/algebra/curves/params/wnaf/mnt4.hpp>
 
 using namespace nil::crypto3::zk::snark;
+using namespace nil::crypto3::algebra;
 
 template<typename CurveType>
 void test_tbcs_ppzksnark(std::size_t primary_input_size, std::size_t auxiliary_input_size, std::size_t num_gates,
@@ -61,4 +70,78 @@ BOOST_AUTO_TEST_CASE(tbcs_ppzksnark_test) {
     test_tbcs_ppzksnark<curves::mnt4<298>>(10, 10, 20, 5);
 }
 
+BOOST_AUTO_TEST_CASE(sorted_combination_test) {
+    typedef typename curves::mnt4<298>::scalar_field_type field_type;
+    const variable<field_type> x(3), y(1);
+
+    // the terms are sorted by index and merged as operator+ merges them, zero coefficients included
+    const std::array<linear_term<field_type>, 5> terms = {-2 * x, 0 * y, 4 * variable<field_type>(5), 3 * x,
+                                                          -1 * variable<field_type>(0)};
+    BOOST_CHECK(reductions::detail::sorted_combination<field_type>(terms) ==
+                -2 * x + 0 * y + 4 * variable<field_type>(5) + 3 * x + -1);
+}
+
+BOOST_AUTO_TEST_CASE(tbcs_gate_constraints_test) {
+    typedef typename curves::mnt4<298>::scalar_field_type field_type;
+    typedef typename field_type::value_type value_type;
+
+    // a gate constraint is in {-1, 1} exactly when the output wire is the gate of the input wires
+    for (int type = 0; type < num_tbcs_gate_types; ++type) {
+        tbcs_gate gate;
+        gate.left_wire = 1;
+        gate.right_wire = 2;
+        gate.type = tbcs_gate_type(type);
+        gate.output = 3;
+        gate.is_circuit_output = false;
+
+        tbcs_circuit circuit;
+        circuit.primary_input_size = 0;
+        circuit.auxiliary_input_size = 2;
+        circuit.add_gate(gate);
+
+        const uscs_constraint<field_type> constraint =
+            reductions::tbcs_to_uscs<field_type>::instance_map(circuit).constraints[0];
+        for (const bool x : {false, true}) {
+            for (const bool y : {false, true}) {
+                for (const bool z : {false, true}) {
+                    const uscs_variable_assignment<field_type> assignment = {
+                        x ? value_type::one() : value_type::zero(), y ? value_type::one() : value_type::zero(),
+                        z ? value_type::one() : value_type::zero()};
+                    BOOST_CHECK_EQUAL(constraint.evaluate(assignment).squared() == value_type::one(),
+                                      z == gate.evaluate({x, y}));
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tbcs_to_uscs_test) {
+    typedef typename curves::mnt4<298>::scalar_field_type field_type;
+    typedef reductions::tbcs_to_uscs<field_type> reduction_type;
+
+    const tbcs_example example = generate_tbcs_example(10, 10, 20, 5);
+    const tbcs_circuit &circuit = example.circuit;
+
+    const uscs_constraint_system<field_type> constraint_system = reduction_type::instance_map(circuit);
+    // one constraint per gate and per wire, and one per output
+    BOOST_CHECK_EQUAL(constraint_system.constraints.size(), 20 + (10 + 10 + 20) + 5);
+    {
+        const executor threads = thread_executor(4);
+        executor::scope guard(threads);
+        BOOST_CHECK(reduction_type::instance_map(circuit) == constraint_system);
+    }
+
+    const uscs_variable_assignment<field_type> assignment =
+        reduction_type::witness_map(circuit, example.primary_input, example.auxiliary_input);
+    const uscs_primary_input<field_type> primary_input(assignment.begin(),
+                                                       assignment.begin() + circuit.primary_input_size);
+    uscs_auxiliary_input<field_type> auxiliary_input(assignment.begin() + circuit.primary_input_size,
+                                                     assignment.end());
+    BOOST_CHECK(constraint_system.is_satisfied(primary_input, auxiliary_input));
+
+    // the last wire is an output, which the reduced system forces to zero
+    auxiliary_input.back() = field_type::value_type::one();
+    BOOST_CHECK(!constraint_system.is_satisfied(primary_input, auxiliary_input));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
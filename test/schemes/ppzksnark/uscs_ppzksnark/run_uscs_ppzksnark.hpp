@@ -29,6 +29,8 @@
 #ifndef CRYPTO3_RUN_USCS_PPZKSNARK_HPP
 #define CRYPTO3_RUN_USCS_PPZKSNARK_HPP
 
+#include <vector>
+
 #include "uscs_examples.hpp"
 
 #include <nil/crypto3/zk/snark/schemes/ppzksnark/uscs_ppzksnark.hpp>
@@ -72,6 +74,20 @@ namespace nil {
                     bool ans2 = verify<basic_proof_system>(pvk, example.primary_input, proof);
                     BOOST_CHECK(ans == ans2);
 
+                    /* a primary input longer than the key is rejected, not asserted on */
+                    typename basic_proof_system::primary_input_type long_primary_input = example.primary_input;
+                    long_primary_input.resize(pvk.encoded_IC_query.domain_size() + 1);
+                    BOOST_CHECK(!uscs_ppzksnark_verifier_weak_input_consistency<CurveType>::process(
+                        pvk, long_primary_input, proof));
+
+                    std::vector<typename basic_proof_system::proof_type> proofs(2, proof);
+                    const std::vector<typename basic_proof_system::primary_input_type> primary_inputs(
+                        proofs.size(), example.primary_input);
+                    BOOST_CHECK(ans == verify_batch<basic_proof_system>(pvk, primary_inputs, proofs));
+
+                    proofs.back().H_g1 = proofs.back().H_g1 + CurveType::g1_type::value_type::one();
+                    BOOST_CHECK(!verify_batch<basic_proof_system>(pvk, primary_inputs, proofs));
+
                     return ans;
                 }
             }    // namespace snark
@@ -0,0 +1,262 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+
+#define BOOST_TEST_MODULE set_commitment_test
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/set_commitment.hpp>
+
+#include "test_hash.hpp"
+
+using namespace nil::crypto3::zk::snark;
+
+namespace {
+
+    typedef set_commitment_accumulator<test_hash> accumulator_type;
+
+    constexpr std::size_t value_size = 16;
+    constexpr std::size_t max_entries = 16;
+
+    std::vector<bool> test_value(const std::size_t i) {
+        std::vector<bool> value(value_size);
+        for (std::size_t bit = 0; bit < value_size; ++bit) {
+            value[bit] = ((3 * i + 1) >> bit) & 1;
+        }
+        return value;
+    }
+
+    struct set_fixture {
+        accumulator_type accumulator {max_entries, value_size};
+        std::vector<std::vector<bool>> elements;
+
+        set_fixture() {
+            for (std::size_t i = 0; i < 11; ++i) {
+                elements.emplace_back(test_value(i));
+            }
+            accumulator.add_range(elements.begin(), elements.end());
+        }
+
+        bool verify(const std::vector<std::vector<bool>> &values,
+                    const std::vector<set_membership_proof> &proofs) const {
+            return verify_set_membership_proofs<test_hash>(accumulator.get_commitment(), accumulator.depth,
+                                                           values.begin(), values.end(), proofs);
+        }
+
+        bool verify(const std::vector<std::vector<bool>> &values, const set_membership_batch_proof &proof) const {
+            return verify_set_membership_batch_proof<test_hash>(accumulator.get_commitment(), accumulator.depth,
+                                                                values.begin(), values.end(), proof);
+        }
+    };
+
+}    // namespace
+
+BOOST_FIXTURE_TEST_SUITE(set_commitment_test_suite, set_fixture)
+
+BOOST_AUTO_TEST_CASE(membership_proofs_test) {
+    // elements 4 and 5 are siblings and 0 shares the upper layers with both
+    const std::vector<std::vector<bool>> values = {elements[4], elements[5], elements[0], elements[10]};
+    const std::vector<set_membership_proof> proofs = accumulator.get_membership_proofs(values.begin(), values.end());
+    BOOST_REQUIRE_EQUAL(proofs.size(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        BOOST_CHECK(proofs[i] == accumulator.get_membership_proof(values[i]));
+    }
+    BOOST_CHECK(verify(values, proofs));
+
+    const std::vector<std::vector<bool>> single = {elements[7]};
+    BOOST_CHECK(verify(single, accumulator.get_membership_proofs(single.begin(), single.end())));
+
+    const std::vector<std::vector<bool>> duplicates = {elements[3], elements[3], elements[2]};
+    BOOST_CHECK(verify(duplicates, accumulator.get_membership_proofs(duplicates.begin(), duplicates.end())));
+}
+
+BOOST_AUTO_TEST_CASE(membership_proofs_rejection_test) {
+    const std::vector<std::vector<bool>> values = {elements[4], elements[5], elements[0]};
+    const std::vector<set_membership_proof> proofs = accumulator.get_membership_proofs(values.begin(), values.end());
+
+    std::vector<set_membership_proof> tampered = proofs;
+    tampered[2].merkle_path[1][7] = !tampered[2].merkle_path[1][7];
+    BOOST_CHECK(!verify(values, tampered));
+
+    // a node the paths of 4 and 5 share, which must agree in both
+    tampered = proofs;
+    tampered[1].merkle_path[0][0] = !tampered[1].merkle_path[0][0];
+    BOOST_CHECK(!verify(values, tampered));
+
+    tampered = proofs;
+    tampered[0].address = 6;
+    BOOST_CHECK(!verify(values, tampered));
+
+    tampered = proofs;
+    tampered[0].address = max_entries;
+    BOOST_CHECK(!verify(values, tampered));
+
+    // one value at two addresses
+    const std::vector<std::vector<bool>> duplicates = {elements[4], elements[4]};
+    tampered = {proofs[0], proofs[1]};
+    BOOST_CHECK(!verify(duplicates, tampered));
+
+    const std::vector<std::vector<bool>> other_values = {elements[4], elements[5], test_value(100)};
+    BOOST_CHECK(!verify(other_values, proofs));
+
+    tampered = proofs;
+    tampered.pop_back();
+    BOOST_CHECK(!verify(values, tampered));
+
+    tampered = proofs;
+    tampered[2].merkle_path.pop_back();
+    BOOST_CHECK(!verify(values, tampered));
+}
+
+BOOST_AUTO_TEST_CASE(batch_membership_proof_test) {
+    const std::vector<std::vector<bool>> values = {elements[5], elements[4], elements[0], elements[10]};
+    const set_membership_batch_proof proof = accumulator.get_batch_membership_proof(values.begin(), values.end());
+    BOOST_CHECK_EQUAL(proof.addresses.size(), values.size());
+    BOOST_CHECK(verify(values, proof));
+
+    // the siblings 4 and 5 share their whole path, which the multi-path holds once
+    std::size_t separate_size = 0;
+    for (const std::vector<bool> &value : values) {
+        separate_size += accumulator.get_membership_proof(value).merkle_path.size();
+    }
+    BOOST_CHECK_LT(proof.merkle_multi_path.size(), separate_size);
+
+    const std::vector<std::vector<bool>> duplicates = {elements[3], elements[2], elements[3]};
+    BOOST_CHECK(verify(duplicates, accumulator.get_batch_membership_proof(duplicates.begin(), duplicates.end())));
+}
+
+BOOST_AUTO_TEST_CASE(batch_membership_proof_rejection_test) {
+    const std::vector<std::vector<bool>> values = {elements[5], elements[4], elements[0]};
+    const set_membership_batch_proof proof = accumulator.get_batch_membership_proof(values.begin(), values.end());
+
+    set_membership_batch_proof tampered = proof;
+    tampered.merkle_multi_path[1][3] = !tampered.merkle_multi_path[1][3];
+    BOOST_CHECK(!verify(values, tampered));
+
+    tampered = proof;
+    tampered.addresses[2] = 1;
+    BOOST_CHECK(!verify(values, tampered));
+
+    tampered = proof;
+    tampered.addresses[2] = max_entries;
+    BOOST_CHECK(!verify(values, tampered));
+
+    // one value at two addresses
+    const std::vector<std::vector<bool>> duplicates = {elements[4], elements[4]};
+    tampered = proof;
+    tampered.addresses = {4, 5};
+    BOOST_CHECK(!verify(duplicates, tampered));
+
+    tampered = proof;
+    tampered.merkle_multi_path.emplace_back(tampered.merkle_multi_path.back());
+    BOOST_CHECK(!verify(values, tampered));
+
+    tampered = proof;
+    tampered.merkle_multi_path.pop_back();
+    BOOST_CHECK(!verify(values, tampered));
+
+    tampered = proof;
+    tampered.addresses.pop_back();
+    BOOST_CHECK(!verify(values, tampered));
+
+    const std::vector<std::vector<bool>> no_values;
+    tampered.addresses.clear();
+    tampered.merkle_multi_path.clear();
+    BOOST_CHECK(!verify(no_values, tampered));
+}
+
+BOOST_AUTO_TEST_CASE(missing_value_test) {
+    const std::vector<std::vector<bool>> values = {elements[1], test_value(100)};
+    BOOST_CHECK_THROW(accumulator.get_membership_proofs(values.begin(), values.end()), std::runtime_error);
+    BOOST_CHECK_THROW(accumulator.get_batch_membership_proof(values.begin(), values.end()), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(digest_position_table_test) {
+    typedef detail::digest_position_table<128> table_type;
+    table_type table;
+    BOOST_CHECK_EQUAL(table.find(table_type::key_type()), table_type::npos);
+
+    // the keys share their leading bytes, which pick the first slot, so they all collide
+    std::vector<table_type::key_type> keys(1000);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        keys[i].data[14] = std::uint8_t(i >> 8);
+        keys[i].data[15] = std::uint8_t(i);
+    }
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        BOOST_CHECK(table.insert(keys[i], 3 * i));
+    }
+    BOOST_CHECK_EQUAL(table.size(), keys.size());
+
+    // an inserted key keeps its first position
+    BOOST_CHECK(!table.insert(keys[17], 1));
+    BOOST_CHECK_EQUAL(table.size(), keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        BOOST_CHECK_EQUAL(table.find(keys[i]), 3 * i);
+    }
+
+    table_type::key_type absent = keys[5];
+    absent.data[0] = 1;
+    BOOST_CHECK_EQUAL(table.find(absent), table_type::npos);
+    absent = keys[5];
+    absent.data[13] = 1;
+    BOOST_CHECK_EQUAL(table.find(absent), table_type::npos);
+}
+
+BOOST_AUTO_TEST_CASE(add_range_test) {
+    std::vector<std::vector<bool>> first_range, second_range;
+    for (std::size_t i = 0; i < 6; ++i) {
+        first_range.emplace_back(test_value(i));
+    }
+    first_range.emplace_back(test_value(2));
+    for (std::size_t i = 4; i < 12; ++i) {
+        second_range.emplace_back(test_value(i));
+    }
+
+    accumulator_type one_by_one(max_entries, value_size);
+    for (const std::vector<std::vector<bool>> *range : {&first_range, &second_range}) {
+        for (const std::vector<bool> &value : *range) {
+            one_by_one.add(value);
+        }
+    }
+
+    // the first range goes into an empty accumulator and the second into a filled one
+    accumulator_type ranges(max_entries, value_size);
+    ranges.add_range(first_range.begin(), first_range.end());
+    ranges.add_range(second_range.begin(), second_range.end());
+
+    BOOST_CHECK(ranges.get_commitment() == one_by_one.get_commitment());
+    for (std::size_t i = 0; i < 12; ++i) {
+        BOOST_CHECK(ranges.is_in_set(test_value(i)));
+        BOOST_CHECK(ranges.get_membership_proof(test_value(i)) == one_by_one.get_membership_proof(test_value(i)));
+    }
+    BOOST_CHECK(!ranges.is_in_set(test_value(12)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,57 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the unique paths of the files written by the tests.
+//
+// Every path is in the temporary directory and carries the process identifier and a
+// counter, so test runs in parallel, or left over by a crashed run, do not collide.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_TEST_TEMPORARY_PATH_HPP
+#define CRYPTO3_ZK_TEST_TEMPORARY_PATH_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /* A path no other call, in this process or another, returns, ending with name. */
+                inline std::string temporary_path(const std::string &name) {
+                    static std::atomic<unsigned> counter(0);
+                    const char *directory = std::getenv("TMPDIR");
+                    return std::string(directory && *directory ? directory : "/tmp") + "/" +
+                           std::to_string(::getpid()) + "." + std::to_string(counter++) + "." + name;
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_TEST_TEMPORARY_PATH_HPP
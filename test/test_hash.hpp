@@ -0,0 +1,72 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the toy hash of the Merkle tree tests.
+//
+// The trees only need a hash with the interface of the hash components, whose
+// digests tell their nodes apart; test_hash mixes the bits and the length of its
+// input into 64 bits without pulling in a real hash.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_TEST_TEST_HASH_HPP
+#define CRYPTO3_ZK_TEST_TEST_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                struct test_hash {
+                    typedef std::vector<bool> digest_type;
+                    typedef std::vector<digest_type> merkle_authentication_path_type;
+
+                    constexpr static const std::size_t digest_bits = 64;
+
+                    static std::size_t get_digest_len() {
+                        return digest_bits;
+                    }
+
+                    static digest_type get_hash(const std::vector<bool> &input) {
+                        std::uint64_t h = 0xcbf29ce484222325ULL ^ input.size();
+                        for (const bool bit : input) {
+                            h = (h ^ (bit ? 0x9e3779b97f4a7c15ULL : 0x632be59bd9b4e019ULL)) * 0x100000001b3ULL;
+                            h ^= h >> 29;
+                        }
+                        digest_type result(digest_bits);
+                        for (std::size_t i = 0; i < digest_bits; ++i) {
+                            result[i] = (h >> i) & 1;
+                        }
+                        return result;
+                    }
+                };
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_TEST_TEST_HASH_HPP
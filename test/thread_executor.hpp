@@ -0,0 +1,67 @@
+//---------------------------------------------------------------------------//
+// Copyright (c) 2018-2021 Mikhail Komarov <nemo@nil.foundation>
+// Copyright (c) 2020-2021 Nikita Kaskov <nbering@nil.foundation>
+//
+// MIT License
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//---------------------------------------------------------------------------//
+// @file Declaration of the threaded executor the tests run their bulk calls on.
+//
+// Every bulk call starts its own threads, so the tests check their results against
+// concurrent callbacks without depending on the executor the library is built with.
+//---------------------------------------------------------------------------//
+
+#ifndef CRYPTO3_ZK_TEST_THREAD_EXECUTOR_HPP
+#define CRYPTO3_ZK_TEST_THREAD_EXECUTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <nil/crypto3/zk/snark/executor.hpp>
+
+namespace nil {
+    namespace crypto3 {
+        namespace zk {
+            namespace snark {
+
+                /* An executor of concurrency threads that runs every bulk call on freshly started threads. */
+                inline executor thread_executor(const std::size_t concurrency) {
+                    return executor(concurrency, [concurrency](const std::size_t n, const executor::task_type &f) {
+                        std::vector<std::thread> threads;
+                        for (std::size_t t = 0; t < std::min(n, concurrency); ++t) {
+                            threads.emplace_back([&f, n, t, concurrency]() {
+                                for (std::size_t i = t; i < n; i += concurrency) {
+                                    f(i);
+                                }
+                            });
+                        }
+                        for (std::thread &thread : threads) {
+                            thread.join();
+                        }
+                    });
+                }
+            }    // namespace snark
+        }        // namespace zk
+    }            // namespace crypto3
+}    // namespace nil
+
+#endif    // CRYPTO3_ZK_TEST_THREAD_EXECUTOR_HPP